@@ -35,6 +35,10 @@ let package = Package(
             linkerSettings: [
                 .linkedFramework("Foundation"),
                 .linkedFramework("CoreServices"),
+                .linkedFramework("CoreMedia"),
+                .linkedFramework("CoreVideo"),
+                .linkedFramework("IOSurface"),
+                .linkedLibrary("z"),
             ]
         ),
 
@@ -51,6 +55,8 @@ let package = Package(
                 .linkedFramework("Foundation"),
                 .linkedFramework("CoreMedia"),
                 .linkedFramework("AVFoundation"),
+                .linkedFramework("VideoToolbox"),
+                .linkedFramework("ImageIO"),
             ]
         ),
 
@@ -62,5 +68,26 @@ let package = Package(
             dependencies: ["CFBDeviceControl"],
             path: "Sources/FBDeviceControlKit"
         ),
+
+        // MARK: - Benchmarks
+
+        // 视频流写入与数据消费者的基准测试（swift run -c release FBDeviceControlBenchmarks）
+        .executableTarget(
+            name: "FBDeviceControlBenchmarks",
+            dependencies: ["CFBControlCore"],
+            path: "Sources/FBDeviceControlBenchmarks",
+            linkerSettings: [
+                .linkedFramework("CoreGraphics"),
+                .linkedFramework("ImageIO"),
+                .linkedFramework("VideoToolbox"),
+            ]
+        ),
+
+        // 连接真机的设备服务吞吐基准（swift run -c release FBDeviceHardwareBenchmarks --udid <UDID>）
+        .executableTarget(
+            name: "FBDeviceHardwareBenchmarks",
+            dependencies: ["CFBDeviceControl"],
+            path: "Sources/FBDeviceHardwareBenchmarks"
+        ),
     ]
 )
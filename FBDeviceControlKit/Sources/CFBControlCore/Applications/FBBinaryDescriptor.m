@@ -10,15 +10,14 @@
 #import "FBControlCoreError.h"
 #import "FBCollectionInformation.h"
 #import "FBControlCoreGlobalConfiguration.h"
+#import "FBDescriptorCache.h"
 
+#include <libkern/OSByteOrder.h>
 #include <mach/machine.h>
-#include <stdio.h>
+#include <stddef.h>
 
 #include <mach-o/fat.h>
 #include <mach-o/loader.h>
-#include <mach-o/swap.h>
-
-#import "FBControlCoreError.h"
 
 FBBinaryArchitecture const FBBinaryArchitecturei386 = @"i386";
 FBBinaryArchitecture const FBBinaryArchitecturex86_64 = @"x86_64";
@@ -44,7 +43,9 @@ static inline NSString *MagicNameForMagic(uint32_t magic)
     @(MH_MAGIC_64) : @"MH_MAGIC_64",
     @(MH_CIGAM_64) : @"MH_CIGAM_64",
     @(FAT_MAGIC) : @"FAT_MAGIC",
-    @(FAT_CIGAM) : @"FAT_CIGAM"
+    @(FAT_CIGAM) : @"FAT_CIGAM",
+    @(FAT_MAGIC_64) : @"FAT_MAGIC_64",
+    @(FAT_CIGAM_64) : @"FAT_CIGAM_64",
   };
   return lookup[@(magic)];
 }
@@ -61,12 +62,17 @@ static inline BOOL IsMagic64(uint32_t magic)
 
 static inline BOOL IsFatMagic(uint32_t magic)
 {
-  return magic == FAT_MAGIC || magic == FAT_CIGAM;
+  return magic == FAT_MAGIC || magic == FAT_CIGAM || magic == FAT_MAGIC_64 || magic == FAT_CIGAM_64;
+}
+
+static inline BOOL IsFatMagic64(uint32_t magic)
+{
+  return magic == FAT_MAGIC_64 || magic == FAT_CIGAM_64;
 }
 
 static inline BOOL IsSwap(uint32_t magic)
 {
-  return magic == MH_CIGAM || magic == MH_CIGAM_64 || magic == FAT_CIGAM;
+  return magic == MH_CIGAM || magic == MH_CIGAM_64 || magic == FAT_CIGAM || magic == FAT_CIGAM_64;
 }
 
 static inline BOOL IsMagic(uint32_t magic)
@@ -74,275 +80,221 @@ static inline BOOL IsMagic(uint32_t magic)
   return IsMagic32(magic) || IsMagic64(magic) || IsFatMagic(magic);
 }
 
-static inline uint32_t GetMagic(FILE *file)
-{
-  // Get then read from the current position.
-  long position = ftell(file);
-  uint32_t magic;
-  fread(&magic, sizeof(uint32_t), 1, file);
-
-  // Move back to the previous position now we know the magic.
-  fseek(file, position, SEEK_SET);
-  return magic;
+/**
+ The contents of a binary that are read in a single pass over a mapping of it.
+ */
+typedef struct {
+  NSMutableArray<FBBinaryArchitecture> *architectures;
+  NSMutableDictionary<FBBinaryArchitecture, NSUUID *> *uuids;
+  NSUUID *uuid;
+  NSMutableArray<NSString *> *rpaths;
+  NSMutableOrderedSet<NSString *> *linkedLibraries;
+} FBBinaryContents;
+
+// All reads are bounds-checked against the mapping, so that a truncated or malformed binary cannot read outside of it.
+static inline BOOL ReadUInt32(const uint8_t *bytes, uint64_t length, uint64_t offset, BOOL swap, uint32_t *value)
+{
+  if (offset > length || length - offset < sizeof(uint32_t)) {
+    return NO;
+  }
+  memcpy(value, bytes + offset, sizeof(uint32_t));
+  if (swap) {
+    *value = OSSwapInt32(*value);
+  }
+  return YES;
 }
 
-static inline struct mach_header ReadHeader32(FILE *file, uint32_t magic)
+static inline BOOL ReadUInt64(const uint8_t *bytes, uint64_t length, uint64_t offset, BOOL swap, uint64_t *value)
 {
-  // Read the header from the current location.
-  struct mach_header header;
-  fread(&header, sizeof(struct mach_header), 1, file);
-  if (IsSwap(magic)) {
-    swap_mach_header(&header, 0);
+  if (offset > length || length - offset < sizeof(uint64_t)) {
+    return NO;
   }
-  return header;
+  memcpy(value, bytes + offset, sizeof(uint64_t));
+  if (swap) {
+    *value = OSSwapInt64(*value);
+  }
+  return YES;
 }
 
-static inline struct mach_header_64 ReadHeader64(FILE *file, uint32_t magic)
+// Reads a string that is referenced by an lc_str within a load command, which must be terminated within it.
+static inline NSString *ReadLoadCommandString(const uint8_t *command, uint32_t commandSize, uint32_t stringOffset)
 {
-  // Read the header from the current location.
-  struct mach_header_64 header;
-  fread(&header, sizeof(header), 1, file);
-  if (IsSwap(magic)) {
-    swap_mach_header_64(&header, 0);
+  if (stringOffset >= commandSize) {
+    return nil;
   }
-  return header;
+  const char *string = (const char *) command + stringOffset;
+  size_t length = strnlen(string, commandSize - stringOffset);
+  return [[NSString alloc] initWithBytes:string length:length encoding:NSUTF8StringEncoding];
 }
 
-static inline struct fat_header ReadFatHeader(FILE *file, uint32_t fatMagic)
+static BOOL ReadSlice(const uint8_t *bytes, uint64_t length, FBBinaryContents *contents)
 {
-  // Get the Fat Header.
-  struct fat_header header;
-  fread(&header, sizeof(struct fat_header), 1, file);
-  if (IsSwap(fatMagic)) {
-    swap_fat_header(&header, 0);
+  uint32_t magic = 0;
+  if (!ReadUInt32(bytes, length, 0, NO, &magic) || !(IsMagic32(magic) || IsMagic64(magic))) {
+    return NO;
+  }
+  BOOL swap = IsSwap(magic);
+  uint32_t cpuType = 0;
+  uint32_t commandCount = 0;
+  if (!ReadUInt32(bytes, length, offsetof(struct mach_header, cputype), swap, &cpuType) || !ReadUInt32(bytes, length, offsetof(struct mach_header, ncmds), swap, &commandCount)) {
+    return NO;
+  }
+  FBBinaryArchitecture architecture = ArchitectureForCPUType((cpu_type_t) cpuType);
+  if (architecture) {
+    [contents->architectures addObject:architecture];
   }
-  return header;
-}
 
-static inline id EnumerateFat(FILE *file, uint32_t fatMagic, id(^block)(struct fat_arch fatArch, uint32_t magic))
-{
-  // Get the Fat Header.
-  struct fat_header header = ReadFatHeader(file, fatMagic);
-
-  long fatArchPosition = sizeof(struct fat_header);
-  for (uint32_t index = 0; index < header.nfat_arch; index++) {
-    // Seek-to then get the Fat Arch info
-    fseek(file, fatArchPosition, SEEK_SET);
-    struct fat_arch fatArch;
-    fread(&fatArch, sizeof(struct fat_arch), 1, file);
-    if (IsSwap(fatMagic)) {
-      swap_fat_arch(&fatArch, 1, 0);
+  // The rpaths of the first slice are used, as the rpaths of the slices of a fat binary are the same.
+  BOOL readRPaths = contents->rpaths.count == 0;
+  uint64_t offset = IsMagic64(magic) ? sizeof(struct mach_header_64) : sizeof(struct mach_header);
+  for (uint32_t index = 0; index < commandCount; index++) {
+    uint32_t command = 0;
+    uint32_t commandSize = 0;
+    if (!ReadUInt32(bytes, length, offset, swap, &command) || !ReadUInt32(bytes, length, offset + sizeof(uint32_t), swap, &commandSize)) {
+      return NO;
     }
-
-    // Seek to the start position of the arch
-    fseek(file, fatArch.offset, SEEK_SET);
-    uint32_t magic = GetMagic(file);
-    if (!IsMagic(magic)){
-      return nil;
+    if (commandSize < sizeof(struct load_command) || length - offset < commandSize) {
+      return NO;
     }
-
-    // Call the block
-    id value = block(fatArch, magic);
-    if (value) {
-      return value;
+    const uint8_t *commandBytes = bytes + offset;
+    switch (command) {
+      case LC_UUID: {
+        if (commandSize < sizeof(struct uuid_command)) {
+          break;
+        }
+        NSUUID *uuid = [[NSUUID alloc] initWithUUIDBytes:((const struct uuid_command *) commandBytes)->uuid];
+        contents->uuid = contents->uuid ?: uuid;
+        if (architecture) {
+          contents->uuids[architecture] = uuid;
+        }
+        break;
+      }
+      case LC_RPATH: {
+        uint32_t pathOffset = 0;
+        if (!readRPaths || !ReadUInt32(bytes, length, offset + offsetof(struct rpath_command, path), swap, &pathOffset)) {
+          break;
+        }
+        NSString *rpath = ReadLoadCommandString(commandBytes, commandSize, pathOffset);
+        if (rpath) {
+          [contents->rpaths addObject:rpath];
+        }
+        break;
+      }
+      case LC_LOAD_DYLIB:
+      case LC_LOAD_WEAK_DYLIB:
+      case LC_REEXPORT_DYLIB:
+      case LC_LAZY_LOAD_DYLIB:
+      case LC_LOAD_UPWARD_DYLIB: {
+        uint32_t nameOffset = 0;
+        if (!ReadUInt32(bytes, length, offset + offsetof(struct dylib_command, dylib.name), swap, &nameOffset)) {
+          break;
+        }
+        NSString *name = ReadLoadCommandString(commandBytes, commandSize, nameOffset);
+        if (name) {
+          [contents->linkedLibraries addObject:name];
+        }
+        break;
+      }
+      default:
+        break;
     }
-    fatArchPosition += sizeof(struct fat_arch);
+    offset += commandSize;
   }
-  return nil;
+  return YES;
 }
 
-static inline id EnumerateLoadCommands64(FILE *file, uint32_t magic, id (^block)(FILE *file, struct load_command command, uint32_t offset) )
+static BOOL ReadContents(const uint8_t *bytes, uint64_t length, FBBinaryContents *contents)
 {
-  struct mach_header_64 header = ReadHeader64(file, magic);
-  // Offset is relative to header length and position in file. In a fat binary it's not right equal to sizeof(header).
-  uint32_t offset = (uint32_t) ftell(file);
-  for (uint32_t i = 0; i < header.ncmds; i++) {
-    struct load_command command = {0x0, 0x0};
-    fseek(file, offset, SEEK_SET);
-    fread(&command, sizeof(command), 1, file);
-    fseek(file, offset, SEEK_SET);
-    id value = block(file, command, offset);
-    if (value) {
-      return value;
-    }
-    offset += command.cmdsize;
+  uint32_t magic = 0;
+  if (!ReadUInt32(bytes, length, 0, NO, &magic)) {
+    return NO;
   }
-  return nil;
-}
-
-static inline id EnumerateLoadCommands32(FILE *file, uint32_t magic, id (^block)(FILE *file, struct load_command command, uint32_t offset) )
-{
-  struct mach_header header = ReadHeader32(file, magic);
-  // Offset is relative to header length and position in file. In a fat binary it's not right equal to sizeof(header).
-  uint32_t offset = (uint32_t) ftell(file);
-  for (uint32_t i = 0; i < header.ncmds; i++) {
-    struct load_command command = {0x0, 0x0};
-    fseek(file, offset, SEEK_SET);
-    fread(&command, sizeof(command), 1, file);
-    fseek(file, offset, SEEK_SET);
-    id value = block(file, command, offset);
-    if (value) {
-      return value;
-    }
-    offset += command.cmdsize;
+  if (!IsFatMagic(magic)) {
+    return ReadSlice(bytes, length, contents);
   }
-  return nil;
-}
-
-static inline NSArray<NSString *> *ReadRPathsSpecific(FILE *file, uint32_t magic, id(*Enumerator)(FILE *, uint32_t magic, id (^)(FILE *, struct load_command, uint32_t)))
-{
-  NSMutableArray<NSString *> *rpaths = NSMutableArray.array;
-  Enumerator(file, magic, ^ id (FILE *_, struct load_command command, uint32_t offset) {
-    if (command.cmd != LC_RPATH) {
-      return nil;
+  BOOL swap = IsSwap(magic);
+  BOOL fat64 = IsFatMagic64(magic);
+  uint32_t archCount = 0;
+  if (!ReadUInt32(bytes, length, offsetof(struct fat_header, nfat_arch), swap, &archCount)) {
+    return NO;
+  }
+  uint64_t archOffset = sizeof(struct fat_header);
+  for (uint32_t index = 0; index < archCount; index++) {
+    uint64_t sliceOffset = 0;
+    uint64_t sliceSize = 0;
+    if (fat64) {
+      if (!ReadUInt64(bytes, length, archOffset + offsetof(struct fat_arch_64, offset), swap, &sliceOffset) || !ReadUInt64(bytes, length, archOffset + offsetof(struct fat_arch_64, size), swap, &sliceSize)) {
+        return NO;
+      }
+      archOffset += sizeof(struct fat_arch_64);
+    } else {
+      uint32_t sliceOffset32 = 0;
+      uint32_t sliceSize32 = 0;
+      if (!ReadUInt32(bytes, length, archOffset + offsetof(struct fat_arch, offset), swap, &sliceOffset32) || !ReadUInt32(bytes, length, archOffset + offsetof(struct fat_arch, size), swap, &sliceSize32)) {
+        return NO;
+      }
+      sliceOffset = sliceOffset32;
+      sliceSize = sliceSize32;
+      archOffset += sizeof(struct fat_arch);
+    }
+    if (sliceOffset > length || length - sliceOffset < sliceSize) {
+      return NO;
+    }
+    if (!ReadSlice(bytes + sliceOffset, sliceSize, contents)) {
+      return NO;
     }
-    // Offset is calculated from the start of the command
-    struct rpath_command rpathCommand;
-    fseek(file, offset, SEEK_SET);
-    fread(&rpathCommand, sizeof(rpathCommand), 1, file);
-
-    // Calculate the offset and move back
-    const uint32_t pathOffset = offset + rpathCommand.path.offset;
-    const uint32_t pathLength = command.cmdsize;
-
-    // Extract the path
-    char *path = alloca(command.cmdsize);
-    fseek(file, pathOffset, SEEK_SET);
-    fread(path, pathLength, 1, file);
-
-    // Create an NSString for the rpaths
-    NSString *string = [[NSString alloc] initWithBytes:path length:strlen(path) encoding:NSASCIIStringEncoding];
-    [rpaths addObject:string];
-
-    return nil;
-  });
-  return rpaths;
-}
-
-static inline NSArray<NSString *> *ReadRPaths(FILE *file, uint32_t magic);
-
-static inline NSArray<NSString *> *ReadRPathsFat(FILE *file, uint32_t fatMagic)
-{
-  return EnumerateFat(file, fatMagic, ^id(struct fat_arch fatArch, uint32_t magic) {
-    return ReadRPaths(file, magic);
-  });
-}
-
-static inline NSUUID *ReadUUID(FILE *file, uint32_t magic);
-
-static id (^UUIDEnumerator)(FILE *, struct load_command, uint32_t) = ^id (FILE *file, struct load_command command, uint32_t offset){
-  if (command.cmd != LC_UUID) {
-    return nil;
   }
-  struct uuid_command uuidCommand;
-  fread(&uuidCommand, sizeof(uuidCommand), 1, file);
-  NSUUID *uuid = [[NSUUID alloc] initWithUUIDBytes:uuidCommand.uuid];
-  return uuid;
-};
-
-static inline NSUUID *ReadUUID64(FILE *file, uint32_t magic)
-{
-  return EnumerateLoadCommands64(file, magic, UUIDEnumerator);
-}
-
-static inline NSUUID *ReadUUID32(FILE *file, uint32_t magic)
-{
-  return EnumerateLoadCommands32(file, magic, UUIDEnumerator);
-}
-
-static inline NSUUID *ReadUUIDFat(FILE *file, uint32_t fatMagic)
-{
-  return EnumerateFat(file, fatMagic, ^ id (struct fat_arch fatArch, uint32_t magic) {
-    // Get the Arch
-    return ReadUUID(file, magic);
-  });
+  return YES;
 }
 
-static inline NSUUID *ReadUUID(FILE *file, uint32_t magic)
+static BOOL ReadContentsOfFile(NSString *path, FBBinaryContents *contents, NSError **error)
 {
-  if (IsFatMagic(magic)) {
-    return ReadUUIDFat(file, magic);
+  // The file is mapped rather than read, only the pages that contain the headers and load commands are touched.
+  NSError *innerError = nil;
+  NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:&innerError];
+  if (!data) {
+    return [[[FBControlCoreError
+      describeFormat:@"Could not map file at path %@", path]
+      causedBy:innerError]
+      failBool:error];
   }
-  if (IsMagic64(magic)) {
-    return ReadUUID64(file, magic);
+  uint32_t magic = 0;
+  if (!ReadUInt32(data.bytes, data.length, 0, NO, &magic) || !IsMagic(magic)) {
+    return [[FBControlCoreError describeFormat:@"Could not interpret magic '%d' in file %@", magic, path] failBool:error];
   }
-  if (IsMagic32(magic)) {
-    return ReadUUID32(file, magic);
+  contents->architectures = [NSMutableArray array];
+  contents->uuids = [NSMutableDictionary dictionary];
+  contents->uuid = nil;
+  contents->rpaths = [NSMutableArray array];
+  contents->linkedLibraries = [NSMutableOrderedSet orderedSet];
+  if (!ReadContents(data.bytes, data.length, contents)) {
+    return [[FBControlCoreError describeFormat:@"Could not read load commands of magic %@ in file %@", MagicNameForMagic(magic), path] failBool:error];
   }
-  return nil;
+  return YES;
 }
 
-static inline FBBinaryArchitecture ReadArch32(FILE *file, uint32_t magic)
-{
-  struct mach_header header = ReadHeader32(file, magic);
-  return ArchitectureForCPUType(header.cputype);
-}
+static NSString *const KeyName = @"name";
+static NSString *const KeyPath = @"path";
+static NSString *const KeyArchitectures = @"architectures";
+static NSString *const KeyUUID = @"uuid";
+static NSString *const KeyUUIDsByArchitecture = @"uuids_by_architecture";
+static NSString *const KeyLinkedLibraries = @"linked_libraries";
+static NSString *const KeyRPaths = @"rpaths";
 
-static inline FBBinaryArchitecture ReadArch64(FILE *file, uint32_t magic)
-{
-  struct mach_header_64 header = ReadHeader64(file, magic);
-  return ArchitectureForCPUType(header.cputype);
-}
+@interface FBBinaryDescriptor ()
 
-static inline FBBinaryArchitecture ReadArch(FILE *file, uint32_t magic)
-{
-  if (IsMagic32(magic)) {
-    return ReadArch32(file, magic);
-  }
-  if (IsMagic64(magic)) {
-    return ReadArch64(file, magic);
-  }
-  return nil;
-}
+@property (nonatomic, copy, nullable, readonly) NSArray<NSString *> *rpaths;
 
-static inline NSArray<FBBinaryArchitecture> *ReadArchsFat(FILE *file, uint32_t fatMagic)
-{
-  NSMutableArray<FBBinaryArchitecture> *array = [NSMutableArray array];
-  EnumerateFat(file, fatMagic, ^id(struct fat_arch fatArch, uint32_t magic) {
-    // Get the Arch
-    NSString *arch = ReadArch(file, magic);
-    if (!arch) {
-      return nil;
-    }
-    [array addObject:arch];
-    return nil;
-  });
-  return array;
-}
+@end
 
-static inline NSArray<FBBinaryArchitecture> *ReadArchs(FILE *file, uint32_t magic)
-{
-  if (IsFatMagic(magic)) {
-    return ReadArchsFat(file, magic);
-  }
-  if (IsMagic32(magic)) {
-    FBBinaryArchitecture arch = ReadArch32(file, magic);
-    return arch ? @[arch] : @[];
-  }
-  if (IsMagic64(magic)) {
-    FBBinaryArchitecture arch = ReadArch64(file, magic);
-    return arch ? @[arch] : @[];
-  }
-  return @[];
-}
+@implementation FBBinaryDescriptor
 
-static inline NSArray<NSString *> *ReadRPaths(FILE *file, uint32_t magic)
+- (instancetype)initWithName:(NSString *)name architectures:(NSSet<FBBinaryArchitecture> *)architectures uuid:(NSUUID *)uuid path:(NSString *)path
 {
-  if (IsFatMagic(magic)) {
-    return ReadRPathsFat(file, magic);
-  }
-  if (IsMagic64(magic)) {
-    return ReadRPathsSpecific(file, magic, EnumerateLoadCommands64);
-  }
-  if (IsMagic32(magic)) {
-    return ReadRPathsSpecific(file, magic, EnumerateLoadCommands32);
-  }
-  return nil;
+  return [self initWithName:name architectures:architectures uuid:uuid uuidsByArchitecture:@{} linkedLibraries:@[] rpaths:nil path:path];
 }
 
-@implementation FBBinaryDescriptor
-
-- (instancetype)initWithName:(NSString *)name architectures:(NSSet<FBBinaryArchitecture> *)architectures uuid:(NSUUID *)uuid path:(NSString *)path
+- (instancetype)initWithName:(NSString *)name architectures:(NSSet<FBBinaryArchitecture> *)architectures uuid:(NSUUID *)uuid uuidsByArchitecture:(NSDictionary<FBBinaryArchitecture, NSUUID *> *)uuidsByArchitecture linkedLibraries:(NSArray<NSString *> *)linkedLibraries rpaths:(nullable NSArray<NSString *> *)rpaths path:(NSString *)path
 {
   NSParameterAssert(name);
   NSParameterAssert(architectures);
@@ -356,6 +308,9 @@ static inline NSArray<NSString *> *ReadRPaths(FILE *file, uint32_t magic)
   _name = name;
   _architectures = architectures;
   _uuid = uuid;
+  _uuidsByArchitecture = uuidsByArchitecture;
+  _linkedLibraries = linkedLibraries;
+  _rpaths = rpaths;
   _path = path;
 
   return self;
@@ -369,39 +324,72 @@ static inline NSArray<NSString *> *ReadRPaths(FILE *file, uint32_t magic)
       fail:error];
   }
 
-  FILE *file = fopen(binaryPath.UTF8String, "rb");
-  if (file == NULL) {
-    return [[FBControlCoreError describeFormat:@"Could not fopen file at path %@", binaryPath] fail:error];
+  FBDescriptorCache *cache = FBDescriptorCache.sharedCache;
+  FBBinaryDescriptor *cached = [cache binaryForPath:binaryPath];
+  if (cached) {
+    return cached;
   }
-
-  // Seek to and read the magic.
-  rewind(file);
-  uint32_t magic = GetMagic(file);
-
-  if (!IsMagic(magic)) {
-    fclose(file);
-    return [[FBControlCoreError describeFormat:@"Could not interpret magic '%d' in file %@", magic, binaryPath] fail:error];
+  FBBinaryDescriptor *binary = [self parseBinaryWithPath:binaryPath error:error];
+  if (!binary) {
+    return nil;
   }
+  [cache cacheBinary:binary];
+  return binary;
+}
 
-  NSArray *archs = ReadArchs(file, magic);
-  if (!archs) {
-    fclose(file);
-    return [[FBControlCoreError describeFormat:@"Could not read architechtures of magic %@ in file %@", MagicNameForMagic(magic), binaryPath] fail:error];
++ (nullable FBBinaryDescriptor *)parseBinaryWithPath:(NSString *)binaryPath error:(NSError **)error
+{
+  FBBinaryContents contents;
+  if (!ReadContentsOfFile(binaryPath, &contents, error)) {
+    return nil;
   }
 
-  // Rewind to the start of the file
-  rewind(file);
-  NSUUID *uuid = ReadUUID(file, magic);
-
-  fclose(file);
-
   return [[FBBinaryDescriptor alloc]
     initWithName:[self binaryNameForBinaryPath:binaryPath]
-    architectures:[NSSet setWithArray:archs]
-    uuid:uuid
+    architectures:[NSSet setWithArray:contents.architectures]
+    uuid:contents.uuid
+    uuidsByArchitecture:[contents.uuids copy]
+    linkedLibraries:contents.linkedLibraries.array
+    rpaths:[contents.rpaths copy]
     path:binaryPath];
 }
 
++ (nullable instancetype)fromPropertyListRepresentation:(NSDictionary<NSString *, id> *)representation
+{
+  NSString *name = representation[KeyName];
+  NSString *path = representation[KeyPath];
+  NSArray<FBBinaryArchitecture> *architectures = representation[KeyArchitectures];
+  NSDictionary<FBBinaryArchitecture, NSString *> *uuidStrings = representation[KeyUUIDsByArchitecture];
+  NSArray<NSString *> *linkedLibraries = representation[KeyLinkedLibraries];
+  if (![name isKindOfClass:NSString.class]
+    || ![path isKindOfClass:NSString.class]
+    || ![architectures isKindOfClass:NSArray.class]
+    || ![uuidStrings isKindOfClass:NSDictionary.class]
+    || ![linkedLibraries isKindOfClass:NSArray.class]) {
+    return nil;
+  }
+  NSString *uuidString = representation[KeyUUID];
+  NSUUID *uuid = [uuidString isKindOfClass:NSString.class] ? [[NSUUID alloc] initWithUUIDString:uuidString] : nil;
+  NSMutableDictionary<FBBinaryArchitecture, NSUUID *> *uuids = NSMutableDictionary.dictionary;
+  for (FBBinaryArchitecture architecture in uuidStrings) {
+    NSString *architectureUUIDString = uuidStrings[architecture];
+    NSUUID *architectureUUID = [architectureUUIDString isKindOfClass:NSString.class] ? [[NSUUID alloc] initWithUUIDString:architectureUUIDString] : nil;
+    if (!architectureUUID) {
+      return nil;
+    }
+    uuids[architecture] = architectureUUID;
+  }
+  NSArray<NSString *> *rpaths = representation[KeyRPaths];
+  return [[FBBinaryDescriptor alloc]
+    initWithName:name
+    architectures:[NSSet setWithArray:architectures]
+    uuid:uuid
+    uuidsByArchitecture:[uuids copy]
+    linkedLibraries:linkedLibraries
+    rpaths:([rpaths isKindOfClass:NSArray.class] ? rpaths : nil)
+    path:path];
+}
+
 #pragma mark NSCopying
 
 - (instancetype)copyWithZone:(NSZone *)zone
@@ -439,26 +427,36 @@ static inline NSArray<NSString *> *ReadRPaths(FILE *file, uint32_t magic)
 
 #pragma mark Public Methods
 
-- (NSArray<NSString *> *)rpathsWithError:(NSError **)error
+- (NSDictionary<NSString *, id> *)propertyListRepresentation
 {
-  FILE *file = fopen(self.path.UTF8String, "rb");
-  if (file == NULL) {
-    return [[FBControlCoreError describeFormat:@"Could not fopen file at path %@", self.path] fail:error];
+  NSMutableDictionary<FBBinaryArchitecture, NSString *> *uuidStrings = NSMutableDictionary.dictionary;
+  for (FBBinaryArchitecture architecture in self.uuidsByArchitecture) {
+    uuidStrings[architecture] = self.uuidsByArchitecture[architecture].UUIDString;
   }
+  NSMutableDictionary<NSString *, id> *representation = [NSMutableDictionary dictionaryWithDictionary:@{
+    KeyName: self.name,
+    KeyPath: self.path,
+    KeyArchitectures: self.architectures.allObjects,
+    KeyUUIDsByArchitecture: uuidStrings,
+    KeyLinkedLibraries: self.linkedLibraries,
+  }];
+  representation[KeyUUID] = self.uuid.UUIDString;
+  representation[KeyRPaths] = self.rpaths;
+  return [representation copy];
+}
 
-  // Seek to and read the magic.
-  rewind(file);
-  uint32_t magic = GetMagic(file);
-
-  if (!IsMagic(magic)) {
-    fclose(file);
-    return [[FBControlCoreError describeFormat:@"Could not interpret magic '%d' in file %@", magic, self.path] fail:error];
+- (NSArray<NSString *> *)rpathsWithError:(NSError **)error
+{
+  // Descriptors that were parsed have the rpaths already, others have to read the binary.
+  NSArray<NSString *> *rpaths = self.rpaths;
+  if (rpaths) {
+    return rpaths;
   }
-
-  NSArray<NSString *> *rpaths = ReadRPaths(file, magic);
-  fclose(file);
-
-  return rpaths;
+  FBBinaryContents contents;
+  if (!ReadContentsOfFile(self.path, &contents, error)) {
+    return nil;
+  }
+  return [contents.rpaths copy];
 }
 
 #pragma mark Private
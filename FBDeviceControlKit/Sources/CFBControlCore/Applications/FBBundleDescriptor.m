@@ -12,6 +12,7 @@
 #import "FBCollectionInformation.h"
 #import "FBControlCoreError.h"
 #import "FBControlCoreLogger.h"
+#import "FBDescriptorCache.h"
 #import "FBProcessBuilder.h"
 #import "FBXcodeConfiguration.h"
 
@@ -55,6 +56,12 @@
       describe:@"Nil file path provided for bundle path"]
       fail:error];
   }
+  // Bundles that are unchanged since they were last inflated are not inflated again.
+  FBDescriptorCache *cache = FBDescriptorCache.sharedCache;
+  FBBundleDescriptor *cached = [cache bundleForPath:path];
+  if ([cached isMemberOfClass:self]) {
+    return cached;
+  }
   NSBundle *bundle = [NSBundle bundleWithPath:path];
   if (!bundle) {
     return [[FBControlCoreError
@@ -75,7 +82,12 @@
   if (!binary) {
     return nil;
   }
-  return [[self alloc] initWithName:bundleName identifier:identifier path:path binary:binary];
+  FBBundleDescriptor *descriptor = [[self alloc] initWithName:bundleName identifier:identifier path:path binary:binary];
+  // Bundles with a fallback identifier are not cached, as they are only valid for callers that permit one.
+  if (bundle.bundleIdentifier) {
+    [cache cacheBundle:descriptor];
+  }
+  return descriptor;
 }
 
 #pragma mark NSCopying
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBBundleManifest.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+#import "FBControlCoreError.h"
+
+static NSString *const KeyEntries = @"entries";
+static NSString *const EntryKeySize = @"size";
+static NSString *const EntryKeyModificationDate = @"modification_date";
+static NSString *const EntryKeyDigest = @"digest";
+
+// Mapped files are hashed in chunks, as CC_SHA256_Update takes a 32-bit length.
+static const NSUInteger DigestChunkSize = 1024 * 1024;
+
+static NSString *HexStringOfDigest(const unsigned char *digest)
+{
+  NSMutableString *string = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+  for (NSUInteger index = 0; index < CC_SHA256_DIGEST_LENGTH; index++) {
+    [string appendFormat:@"%02x", digest[index]];
+  }
+  return [string copy];
+}
+
+static NSString *DigestOfData(NSData *data)
+{
+  CC_SHA256_CTX context;
+  CC_SHA256_Init(&context);
+  const uint8_t *bytes = data.bytes;
+  NSUInteger length = data.length;
+  for (NSUInteger offset = 0; offset < length; offset += DigestChunkSize) {
+    CC_SHA256_Update(&context, bytes + offset, (CC_LONG) MIN(DigestChunkSize, length - offset));
+  }
+  unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+  CC_SHA256_Final(digest, &context);
+  return HexStringOfDigest(digest);
+}
+
+@interface FBBundleManifest ()
+
+@property (nonatomic, copy, readonly) NSDictionary<NSString *, NSDictionary<NSString *, id> *> *entries;
+
+@end
+
+@implementation FBBundleManifest
+
+#pragma mark Initializers
+
+- (instancetype)initWithEntries:(NSDictionary<NSString *, NSDictionary<NSString *, id> *> *)entries
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _entries = entries;
+  NSMutableDictionary<NSString *, NSString *> *digestsByPath = NSMutableDictionary.dictionary;
+  unsigned long long totalSize = 0;
+  for (NSString *path in entries) {
+    digestsByPath[path] = entries[path][EntryKeyDigest];
+    totalSize += [entries[path][EntryKeySize] unsignedLongLongValue];
+  }
+  _digestsByPath = [digestsByPath copy];
+  _totalSize = totalSize;
+
+  // The digest of the bundle covers the paths as well as the contents, so that moving a file changes it.
+  NSMutableData *summary = NSMutableData.data;
+  for (NSString *path in [digestsByPath.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+    [summary appendData:[[NSString stringWithFormat:@"%@\n%@\n", path, digestsByPath[path]] dataUsingEncoding:NSUTF8StringEncoding]];
+  }
+  _digest = DigestOfData(summary);
+
+  return self;
+}
+
++ (nullable instancetype)manifestForBundleAtPath:(NSString *)path previousManifest:(nullable FBBundleManifest *)previousManifest error:(NSError **)error
+{
+  BOOL isDirectory = NO;
+  if (![NSFileManager.defaultManager fileExistsAtPath:path isDirectory:&isDirectory] || !isDirectory) {
+    return [[FBControlCoreError
+      describeFormat:@"No bundle exists at path %@", path]
+      fail:error];
+  }
+  NSDictionary<NSString *, NSDictionary<NSString *, id> *> *previousEntries = previousManifest.entries;
+  NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> *entries = NSMutableDictionary.dictionary;
+  NSDirectoryEnumerator<NSString *> *enumerator = [NSFileManager.defaultManager enumeratorAtPath:path];
+  for (NSString *relativePath in enumerator) {
+    // The attributes are those of the entry itself, symlinks are not followed.
+    NSDictionary<NSFileAttributeKey, id> *attributes = enumerator.fileAttributes;
+    NSFileAttributeType type = attributes.fileType;
+    BOOL isSymlink = [type isEqualToString:NSFileTypeSymbolicLink];
+    if (![type isEqualToString:NSFileTypeRegular] && !isSymlink) {
+      continue;
+    }
+    NSNumber *size = @(attributes.fileSize);
+    NSNumber *modificationDate = @(attributes.fileModificationDate.timeIntervalSinceReferenceDate);
+    NSDictionary<NSString *, id> *previous = previousEntries[relativePath];
+    if ([previous[EntryKeySize] isEqual:size] && [previous[EntryKeyModificationDate] isEqual:modificationDate]) {
+      entries[relativePath] = previous;
+      continue;
+    }
+    NSString *absolutePath = [path stringByAppendingPathComponent:relativePath];
+    NSData *data = nil;
+    if (isSymlink) {
+      NSString *destination = [NSFileManager.defaultManager destinationOfSymbolicLinkAtPath:absolutePath error:error];
+      if (!destination) {
+        return nil;
+      }
+      data = [[@"symlink:" stringByAppendingString:destination] dataUsingEncoding:NSUTF8StringEncoding];
+    } else {
+      data = [NSData dataWithContentsOfFile:absolutePath options:NSDataReadingMappedIfSafe error:error];
+      if (!data) {
+        return nil;
+      }
+    }
+    entries[relativePath] = @{
+      EntryKeySize: size,
+      EntryKeyModificationDate: modificationDate,
+      EntryKeyDigest: DigestOfData(data),
+    };
+  }
+  return [[self alloc] initWithEntries:[entries copy]];
+}
+
++ (nullable instancetype)fromPropertyListRepresentation:(NSDictionary<NSString *, id> *)representation
+{
+  NSDictionary<NSString *, NSDictionary<NSString *, id> *> *entries = representation[KeyEntries];
+  if (![entries isKindOfClass:NSDictionary.class]) {
+    return nil;
+  }
+  for (NSString *path in entries) {
+    NSDictionary<NSString *, id> *entry = entries[path];
+    if (![entry isKindOfClass:NSDictionary.class]
+      || ![entry[EntryKeySize] isKindOfClass:NSNumber.class]
+      || ![entry[EntryKeyModificationDate] isKindOfClass:NSNumber.class]
+      || ![entry[EntryKeyDigest] isKindOfClass:NSString.class]) {
+      return nil;
+    }
+  }
+  return [[self alloc] initWithEntries:entries];
+}
+
+#pragma mark Public Methods
+
+- (NSArray<NSString *> *)pathsChangedFromManifest:(nullable FBBundleManifest *)manifest
+{
+  NSDictionary<NSString *, NSString *> *otherDigests = manifest.digestsByPath ?: @{};
+  NSMutableSet<NSString *> *changed = NSMutableSet.set;
+  for (NSString *path in self.digestsByPath) {
+    if (![self.digestsByPath[path] isEqualToString:otherDigests[path]]) {
+      [changed addObject:path];
+    }
+  }
+  for (NSString *path in otherDigests) {
+    if (!self.digestsByPath[path]) {
+      [changed addObject:path];
+    }
+  }
+  return [changed.allObjects sortedArrayUsingSelector:@selector(compare:)];
+}
+
+- (NSDictionary<NSString *, id> *)propertyListRepresentation
+{
+  return @{
+    KeyEntries: self.entries,
+  };
+}
+
+#pragma mark NSObject
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"Bundle Manifest %@ | %lu files | %llu bytes", self.digest, (unsigned long) self.digestsByPath.count, self.totalSize];
+}
+
+@end
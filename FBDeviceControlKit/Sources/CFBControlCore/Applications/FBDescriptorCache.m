@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBDescriptorCache.h"
+
+#import "FBBinaryDescriptor.h"
+#import "FBBundleDescriptor.h"
+#import "FBControlCoreGlobalConfiguration.h"
+#import "FBControlCoreLogger.h"
+
+#include <sys/stat.h>
+
+static NSString *const PersistedKeyVersion = @"version";
+static NSString *const PersistedKeyBinaries = @"binaries";
+static NSString *const PersistedKeyBundles = @"bundles";
+static NSString *const EntryKeyFingerprints = @"fingerprints";
+static NSString *const EntryKeyBinary = @"binary";
+static NSString *const BundleKeyName = @"name";
+static NSString *const BundleKeyIdentifier = @"identifier";
+
+// Bumped whenever the persisted format or the information in a descriptor changes.
+static const NSUInteger PersistedVersion = 1;
+
+// Changes are coalesced so that caching a bank of descriptors writes the file once.
+static const NSTimeInterval PersistWriteDelay = 1.0;
+
+// Identifies the contents of a file without reading it, a file that is replaced or modified has a different fingerprint.
+static NSString *FingerprintOfFile(NSString *path)
+{
+  struct stat info;
+  if (stat(path.fileSystemRepresentation, &info) != 0) {
+    return nil;
+  }
+  return [NSString stringWithFormat:
+    @"%llu:%llu:%lld:%ld.%09ld",
+    (unsigned long long) info.st_dev,
+    (unsigned long long) info.st_ino,
+    (long long) info.st_size,
+    (long) info.st_mtimespec.tv_sec,
+    (long) info.st_mtimespec.tv_nsec
+  ];
+}
+
+static NSDictionary<NSString *, NSString *> *FingerprintsOfFiles(NSArray<NSString *> *paths)
+{
+  NSMutableDictionary<NSString *, NSString *> *fingerprints = NSMutableDictionary.dictionary;
+  for (NSString *path in paths) {
+    NSString *fingerprint = FingerprintOfFile(path);
+    if (!fingerprint) {
+      return nil;
+    }
+    fingerprints[path] = fingerprint;
+  }
+  return [fingerprints copy];
+}
+
+static BOOL FingerprintsAreCurrent(NSDictionary<NSString *, NSString *> *fingerprints)
+{
+  for (NSString *path in fingerprints) {
+    if (![FingerprintOfFile(path) isEqualToString:fingerprints[path]]) {
+      return NO;
+    }
+  }
+  return YES;
+}
+
+// Application bundles on macOS have their Info.plist in Contents, those on iOS have it at the root.
+static NSString *InfoPlistPathForBundlePath(NSString *bundlePath)
+{
+  NSString *macOSPath = [[bundlePath stringByAppendingPathComponent:@"Contents"] stringByAppendingPathComponent:@"Info.plist"];
+  if ([NSFileManager.defaultManager fileExistsAtPath:macOSPath]) {
+    return macOSPath;
+  }
+  return [bundlePath stringByAppendingPathComponent:@"Info.plist"];
+}
+
+@interface FBDescriptorCache_Entry : NSObject
+
+@property (nonatomic, strong, readonly) id descriptor;
+@property (nonatomic, copy, readonly) NSDictionary<NSString *, NSString *> *fingerprints;
+
+@end
+
+@implementation FBDescriptorCache_Entry
+
+- (instancetype)initWithDescriptor:(id)descriptor fingerprints:(NSDictionary<NSString *, NSString *> *)fingerprints
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _descriptor = descriptor;
+  _fingerprints = fingerprints;
+
+  return self;
+}
+
+@end
+
+@interface FBDescriptorCache ()
+
+@property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, FBDescriptorCache_Entry *> *binaries;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, FBDescriptorCache_Entry *> *bundles;
+@property (nonatomic, copy, nullable, readwrite) NSString *persistencePath;
+@property (nonatomic, assign, readwrite) BOOL writeScheduled;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+
+@end
+
+@implementation FBDescriptorCache
+
+#pragma mark Initializers
+
++ (FBDescriptorCache *)sharedCache
+{
+  static dispatch_once_t onceToken;
+  static FBDescriptorCache *cache;
+  dispatch_once(&onceToken, ^{
+    cache = [self cacheWithLogger:FBControlCoreGlobalConfiguration.defaultLogger];
+  });
+  return cache;
+}
+
++ (instancetype)cacheWithLogger:(nullable id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithLogger:logger];
+}
+
+- (instancetype)initWithLogger:(nullable id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _logger = logger;
+  _binaries = NSMutableDictionary.dictionary;
+  _bundles = NSMutableDictionary.dictionary;
+  _queue = dispatch_queue_create("com.facebook.fbcontrolcore.descriptor_cache", DISPATCH_QUEUE_SERIAL);
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (nullable FBBinaryDescriptor *)binaryForPath:(NSString *)path
+{
+  return [self currentDescriptorForPath:path inEntries:self.binaries];
+}
+
+- (void)cacheBinary:(FBBinaryDescriptor *)binary
+{
+  NSDictionary<NSString *, NSString *> *fingerprints = FingerprintsOfFiles(@[binary.path]);
+  if (!fingerprints) {
+    return;
+  }
+  @synchronized (self) {
+    self.binaries[binary.path] = [[FBDescriptorCache_Entry alloc] initWithDescriptor:binary fingerprints:fingerprints];
+  }
+  [self scheduleWrite];
+}
+
+- (nullable FBBundleDescriptor *)bundleForPath:(NSString *)path
+{
+  return [self currentDescriptorForPath:path inEntries:self.bundles];
+}
+
+- (void)cacheBundle:(FBBundleDescriptor *)bundle
+{
+  // Bundles without an executable are not cached, there is little to be saved in re-reading them.
+  FBBinaryDescriptor *binary = bundle.binary;
+  if (!binary) {
+    return;
+  }
+  NSDictionary<NSString *, NSString *> *fingerprints = FingerprintsOfFiles(@[InfoPlistPathForBundlePath(bundle.path), binary.path]);
+  if (!fingerprints) {
+    return;
+  }
+  @synchronized (self) {
+    self.bundles[bundle.path] = [[FBDescriptorCache_Entry alloc] initWithDescriptor:bundle fingerprints:fingerprints];
+  }
+  [self scheduleWrite];
+}
+
+- (void)persistToPath:(NSString *)path
+{
+  @synchronized (self) {
+    self.persistencePath = path;
+  }
+  [self loadFromPath:path];
+}
+
+- (void)removeAllDescriptors
+{
+  @synchronized (self) {
+    [self.binaries removeAllObjects];
+    [self.bundles removeAllObjects];
+  }
+  [self scheduleWrite];
+}
+
+#pragma mark Private
+
+- (nullable id)currentDescriptorForPath:(NSString *)path inEntries:(NSMutableDictionary<NSString *, FBDescriptorCache_Entry *> *)entries
+{
+  FBDescriptorCache_Entry *entry = nil;
+  @synchronized (self) {
+    entry = entries[path];
+  }
+  if (!entry) {
+    return nil;
+  }
+  // The files are checked outside of the lock, as they may be on slow storage.
+  if (!FingerprintsAreCurrent(entry.fingerprints)) {
+    @synchronized (self) {
+      if (entries[path] == entry) {
+        [entries removeObjectForKey:path];
+      }
+    }
+    return nil;
+  }
+  return entry.descriptor;
+}
+
+#pragma mark Persistence
+
+- (void)loadFromPath:(NSString *)path
+{
+  NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+  if (!data) {
+    return;
+  }
+  NSError *error = nil;
+  NSDictionary<NSString *, id> *persisted = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:nil error:&error];
+  if (![persisted isKindOfClass:NSDictionary.class] || ![persisted[PersistedKeyVersion] isEqual:@(PersistedVersion)]) {
+    [self.logger logFormat:@"Ignoring descriptor cache at %@ %@", path, error];
+    return;
+  }
+  NSDictionary<NSString *, FBDescriptorCache_Entry *> *binaries = [FBDescriptorCache entriesFromPersisted:persisted[PersistedKeyBinaries] descriptor:^ id (NSString *binaryPath, NSDictionary<NSString *, id> *representation) {
+    return [FBBinaryDescriptor fromPropertyListRepresentation:representation[EntryKeyBinary]];
+  }];
+  NSDictionary<NSString *, FBDescriptorCache_Entry *> *bundles = [FBDescriptorCache entriesFromPersisted:persisted[PersistedKeyBundles] descriptor:^ id (NSString *bundlePath, NSDictionary<NSString *, id> *representation) {
+    return [FBDescriptorCache bundleFromRepresentation:representation path:bundlePath];
+  }];
+  @synchronized (self) {
+    // Descriptors that have been cached in this process are more recent than those that were persisted.
+    for (NSString *key in binaries) {
+      self.binaries[key] = self.binaries[key] ?: binaries[key];
+    }
+    for (NSString *key in bundles) {
+      self.bundles[key] = self.bundles[key] ?: bundles[key];
+    }
+  }
+  [self.logger logFormat:@"Loaded %lu binaries and %lu bundles from descriptor cache at %@", (unsigned long) binaries.count, (unsigned long) bundles.count, path];
+}
+
++ (NSDictionary<NSString *, FBDescriptorCache_Entry *> *)entriesFromPersisted:(NSDictionary<NSString *, NSDictionary<NSString *, id> *> *)persisted descriptor:(id (^)(NSString *, NSDictionary<NSString *, id> *))descriptorFromRepresentation
+{
+  if (![persisted isKindOfClass:NSDictionary.class]) {
+    return @{};
+  }
+  NSMutableDictionary<NSString *, FBDescriptorCache_Entry *> *entries = NSMutableDictionary.dictionary;
+  for (NSString *path in persisted) {
+    NSDictionary<NSString *, id> *representation = persisted[path];
+    if (![representation isKindOfClass:NSDictionary.class]) {
+      continue;
+    }
+    NSDictionary<NSString *, NSString *> *fingerprints = representation[EntryKeyFingerprints];
+    id descriptor = descriptorFromRepresentation(path, representation);
+    if (![fingerprints isKindOfClass:NSDictionary.class] || !descriptor) {
+      continue;
+    }
+    entries[path] = [[FBDescriptorCache_Entry alloc] initWithDescriptor:descriptor fingerprints:fingerprints];
+  }
+  return [entries copy];
+}
+
++ (nullable FBBundleDescriptor *)bundleFromRepresentation:(NSDictionary<NSString *, id> *)representation path:(NSString *)path
+{
+  NSString *name = representation[BundleKeyName];
+  NSString *identifier = representation[BundleKeyIdentifier];
+  FBBinaryDescriptor *binary = [FBBinaryDescriptor fromPropertyListRepresentation:representation[EntryKeyBinary]];
+  if (![name isKindOfClass:NSString.class] || ![identifier isKindOfClass:NSString.class] || !binary) {
+    return nil;
+  }
+  return [[FBBundleDescriptor alloc] initWithName:name identifier:identifier path:path binary:binary];
+}
+
+- (void)scheduleWrite
+{
+  @synchronized (self) {
+    if (!self.persistencePath || self.writeScheduled) {
+      return;
+    }
+    self.writeScheduled = YES;
+  }
+  dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t) (PersistWriteDelay * NSEC_PER_SEC)), self.queue, ^{
+    [self write];
+  });
+}
+
+- (void)write
+{
+  NSString *path = nil;
+  NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> *binaries = NSMutableDictionary.dictionary;
+  NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> *bundles = NSMutableDictionary.dictionary;
+  @synchronized (self) {
+    self.writeScheduled = NO;
+    path = self.persistencePath;
+    for (NSString *key in self.binaries) {
+      FBDescriptorCache_Entry *entry = self.binaries[key];
+      FBBinaryDescriptor *binary = entry.descriptor;
+      binaries[key] = @{
+        EntryKeyFingerprints: entry.fingerprints,
+        EntryKeyBinary: binary.propertyListRepresentation,
+      };
+    }
+    for (NSString *key in self.bundles) {
+      FBDescriptorCache_Entry *entry = self.bundles[key];
+      FBBundleDescriptor *bundle = entry.descriptor;
+      bundles[key] = @{
+        EntryKeyFingerprints: entry.fingerprints,
+        BundleKeyName: bundle.name,
+        BundleKeyIdentifier: bundle.identifier,
+        EntryKeyBinary: bundle.binary.propertyListRepresentation,
+      };
+    }
+  }
+  if (!path) {
+    return;
+  }
+  NSError *error = nil;
+  NSData *data = [NSPropertyListSerialization
+    dataWithPropertyList:@{
+      PersistedKeyVersion: @(PersistedVersion),
+      PersistedKeyBinaries: binaries,
+      PersistedKeyBundles: bundles,
+    }
+    format:NSPropertyListBinaryFormat_v1_0
+    options:0
+    error:&error];
+  if (!data) {
+    [self.logger logFormat:@"Failed to serialize descriptor cache %@", error];
+    return;
+  }
+  [NSFileManager.defaultManager createDirectoryAtPath:path.stringByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:nil];
+  if (![data writeToFile:path options:NSDataWritingAtomic error:&error]) {
+    [self.logger logFormat:@"Failed to write descriptor cache to %@ %@", path, error];
+  }
+}
+
+@end
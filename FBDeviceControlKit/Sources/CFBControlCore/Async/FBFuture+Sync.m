@@ -12,6 +12,64 @@
 #import "FBControlCoreGlobalConfiguration.h"
 #import "FBControlCoreLogger.h"
 #import "FBFuture.h"
+#import "FBMetricsRegistry.h"
+
+static FBMetricsHistogram *BlockingWaitHistogram;
+static FBMetricsHistogram *RunLoopWaitHistogram;
+static FBMetricsCounter *DeadlockCounter;
+
+static void SetupWaitMetrics(void)
+{
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    FBMetricsRegistry *registry = FBMetricsRegistry.sharedRegistry;
+    BlockingWaitHistogram = [registry histogramWithName:@"future.sync.blocking_wait_ns"];
+    RunLoopWaitHistogram = [registry histogramWithName:@"future.sync.run_loop_wait_ns"];
+    DeadlockCounter = [registry counterWithName:@"future.sync.deadlocks"];
+  });
+}
+
+/**
+ Blocks the calling thread on a semaphore until the future resolves, without spinning.
+ The semaphore is signalled on the resolving thread, so no queue needs to be serviced by the caller.
+ */
+static BOOL WaitOnSemaphore(FBFuture *future, dispatch_time_t timeout)
+{
+  SetupWaitMetrics();
+  uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+  [future notifyOfCompletionInline:^(FBFuture *_) {
+    dispatch_semaphore_signal(semaphore);
+  }];
+  BOOL completed = dispatch_semaphore_wait(semaphore, timeout) == 0;
+  [BlockingWaitHistogram recordNanosecondsSince:startTime];
+  return completed;
+}
+
+static dispatch_time_t DispatchTimeout(NSTimeInterval timeout)
+{
+  if (timeout <= 0 || timeout >= (NSTimeInterval) (INT64_MAX / NSEC_PER_SEC)) {
+    return DISPATCH_TIME_FOREVER;
+  }
+  return dispatch_time(DISPATCH_TIME_NOW, (int64_t) (timeout * NSEC_PER_SEC));
+}
+
+/**
+ Whether the calling thread has a Run Loop that needs to be serviced whilst waiting.
+ The main thread always does. Other threads only do when they are already inside a run of their Run Loop, as sources scheduled there would otherwise stall.
+ */
+static BOOL ShouldServiceRunLoop(void)
+{
+  if (NSThread.isMainThread) {
+    return YES;
+  }
+  CFRunLoopMode mode = CFRunLoopCopyCurrentMode(CFRunLoopGetCurrent());
+  if (!mode) {
+    return NO;
+  }
+  CFRelease(mode);
+  return YES;
+}
 
 static id ExtractResult(FBFuture *future, NSTimeInterval timeout, BOOL completed, NSError **error)
 {
@@ -79,21 +137,64 @@ static NSString *const KeyIsAwaiting = @"FBCONTROLCORE_IS_AWAITING";
 
 - (nullable id)awaitCompletionOfFuture:(FBFuture *)future timeout:(NSTimeInterval)timeout error:(NSError **)error
 {
+  if (!ShouldServiceRunLoop()) {
+    BOOL completed = WaitOnSemaphore(future, DispatchTimeout(timeout));
+    return ExtractResult(future, timeout, completed, error);
+  }
+
+  SetupWaitMetrics();
+  uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
   [NSRunLoop updateRunLoopIsAwaiting:YES];
-  BOOL completed = [self spinRunLoopWithTimeout:timeout untilTrue:^BOOL{
-    return future.hasCompleted;
-  }];
+  BOOL completed = [self runUntilCompletionOfFuture:future timeout:timeout];
   [NSRunLoop updateRunLoopIsAwaiting:NO];
+  [RunLoopWaitHistogram recordNanosecondsSince:startTime];
   return ExtractResult(future, timeout, completed, error);
 }
 
+/**
+ Runs the Run Loop until the future resolves, waking it on resolution rather than polling.
+ If the Run Loop has nothing to service, the remainder of the wait blocks on a semaphore instead.
+ */
+- (BOOL)runUntilCompletionOfFuture:(FBFuture *)future timeout:(NSTimeInterval)timeout
+{
+  CFRunLoopRef runLoop = self.getCFRunLoop;
+  [future notifyOfCompletionInline:^(FBFuture *_) {
+    // A performed block counts as a handled source, so the run below returns.
+    CFRunLoopPerformBlock(runLoop, kCFRunLoopDefaultMode, ^{});
+    CFRunLoopWakeUp(runLoop);
+  }];
+
+  NSDate *date = [NSDate dateWithTimeIntervalSinceNow:timeout];
+  while (!future.hasCompleted) {
+    @autoreleasepool {
+      NSTimeInterval remaining = timeout > 0 ? [date timeIntervalSinceNow] : DBL_MAX;
+      if (remaining < 0) {
+        return NO;
+      }
+      CFRunLoopRunResult result = CFRunLoopRunInMode(kCFRunLoopDefaultMode, remaining, true);
+      if (result == kCFRunLoopRunFinished) {
+        return WaitOnSemaphore(future, timeout > 0 ? DispatchTimeout(remaining) : DISPATCH_TIME_FOREVER);
+      }
+    }
+  }
+  return YES;
+}
+
 @end
 
 static NSTimeInterval const ForeverTimeout = DBL_MAX;
 
-static dispatch_queue_t blockQueue(void)
+static char const QueueIdentityKey = 0;
+
+/**
+ Whether the calling code is executing on the provided queue (or a queue targeting it).
+ The queue is tagged with its own identity, so the check does not depend upon queue labels.
+ */
+static BOOL IsExecutingOnQueue(dispatch_queue_t queue)
 {
-  return dispatch_queue_create("com.facebook.fbfuture.block", DISPATCH_QUEUE_SERIAL);
+  void *identity = (__bridge void *) queue;
+  dispatch_queue_set_specific(queue, &QueueIdentityKey, identity, NULL);
+  return dispatch_get_specific(&QueueIdentityKey) == identity;
 }
 
 @implementation FBFuture (NSRunLoop)
@@ -110,7 +211,7 @@ static dispatch_queue_t blockQueue(void)
 
 - (BOOL)succeeds:(NSError **)error
 {
-  return [self onQueue:blockQueue() timeout:DISPATCH_TIME_FOREVER succeeds:error];
+  return [self block:error] != nil;
 }
 
 - (BOOL)onQueue:(dispatch_queue_t)queue timeout:(dispatch_time_t)timeout succeeds:(NSError **)error
@@ -124,17 +225,32 @@ static dispatch_queue_t blockQueue(void)
 
 - (nullable id)block:(NSError **)error
 {
-  return [self onQueue:blockQueue() timeout:DISPATCH_TIME_FOREVER block:error];
+  BOOL completed = WaitOnSemaphore(self, DISPATCH_TIME_FOREVER);
+  return ExtractResult(self, ForeverTimeout, completed, error);
 }
 
 - (nullable id)onQueue:(dispatch_queue_t)queue timeout:(dispatch_time_t)timeout block:(NSError **)error
 {
+  // The completion is delivered on the queue, so blocking that queue can only end in a timeout.
+  if (IsExecutingOnQueue(queue)) {
+    SetupWaitMetrics();
+    [DeadlockCounter increment];
+    id<FBControlCoreLogger> logger = FBControlCoreGlobalConfiguration.defaultLogger;
+    [logger logFormat:@"Blocking on future %@ from the queue it notifies on %@", self, [FBCollectionInformation oneLineDescriptionFromArray:NSThread.callStackSymbols]];
+    return [[FBControlCoreError
+      describeFormat:@"Deadlock: waiting for future %@ on %s, the queue its completion is delivered on", self, dispatch_queue_get_label(queue)]
+      fail:error];
+  }
+
+  SetupWaitMetrics();
+  uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
   dispatch_group_t group = dispatch_group_create();
   dispatch_group_enter(group);
   [self onQueue:queue notifyOfCompletion:^(FBFuture *future) {
     dispatch_group_leave(group);
   }];
   BOOL completed = dispatch_group_wait(group, timeout) == 0;
+  [BlockingWaitHistogram recordNanosecondsSince:startTime];
   return ExtractResult(self, timeout, completed, error);
 }
 
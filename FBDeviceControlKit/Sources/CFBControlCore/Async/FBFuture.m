@@ -7,8 +7,21 @@
 
 #import "FBFuture.h"
 
+#import <os/lock.h>
+#import <os/signpost.h>
+#import <stdatomic.h>
+
 #import "FBCollectionOperations.h"
 #import "FBControlCore.h"
+#import "FBFutureProfiler.h"
+#import "FBMetricsRegistry.h"
+
+static FBMetricsCounter *FuturesCreatedCounter;
+static FBMetricsCounter *FuturesSucceededCounter;
+static FBMetricsCounter *FuturesFailedCounter;
+static FBMetricsCounter *FuturesCancelledCounter;
+static FBMetricsGauge *FuturesRunningGauge;
+static FBMetricsHistogram *FutureDurationHistogram;
 
 @class FBFutureContext_Teardown;
 
@@ -19,6 +32,8 @@
 - (FBFutureContext_Teardown *)pop;
 - (void)addObjectsFromArray:(NSArray<FBFutureContext_Teardown *> *)array;
 - (NSArray<FBFutureContext_Teardown *> *)asArray;
+// The time after which the teardowns no longer wait for each other, 0 for no deadline.
+@property (atomic, assign, readwrite) NSTimeInterval deadline;
 @end
 
 @implementation FBFutureTeardowns {
@@ -96,6 +111,11 @@ static FBFutureStateString FBFutureStateStringFromState(FBFutureState state)
   }
 }
 
+// The number of continuations that may run inline, nested within each other on one thread, before falling back to a queue hop.
+// This bounds the stack depth of long chains of futures that have already resolved.
+static NSUInteger const FBFutureMaximumInlineDepth = 16;
+static _Thread_local NSUInteger FBFutureInlineDepth = 0;
+
 dispatch_time_t FBCreateDispatchTimeFromDuration(NSTimeInterval inDuration)
 {
   return dispatch_time(DISPATCH_TIME_NOW, (int64_t)(inDuration * NSEC_PER_SEC));
@@ -126,14 +146,14 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
 
 @interface FBFuture_Handler : NSObject
 
-@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, nullable, readonly) dispatch_queue_t queue;
 @property (nonatomic, strong, readonly) void (^handler)(FBFuture *);
 
 @end
 
 @implementation FBFuture_Handler
 
-- (instancetype)initWithQueue:(dispatch_queue_t)queue handler:(void (^)(FBFuture *))handler
+- (instancetype)initWithQueue:(nullable dispatch_queue_t)queue handler:(void (^)(FBFuture *))handler
 {
   self = [super init];
   if (!self) {
@@ -196,6 +216,11 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
   return self;
 }
 
+- (FBFutureContext_Teardown *)teardownWithFuture:(FBFuture *)future
+{
+  return [[FBFutureContext_Teardown alloc] initWithFuture:future queue:self.queue action:self.action];
+}
+
 - (FBFuture<NSNull *> *)performTeardown:(FBFutureState)endState
 {
   NSAssert(self.future.state != FBFutureStateRunning, @"Performing teardown on an unresolved future is not-permitted.");
@@ -217,10 +242,85 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
 
 @end
 
+@interface FBFutureContext_TeardownRun : NSObject
+
+@property (nonatomic, assign, readonly) uint64_t startedAt;
+@property (nonatomic, assign, readonly) uint64_t deadlineAt;
+@property (atomic, assign, readwrite) NSUInteger deadlineExceededCount;
+
+@end
+
+@implementation FBFutureContext_TeardownRun
+
+- (instancetype)initWithDeadline:(NSTimeInterval)deadline
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _startedAt = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  _deadlineAt = deadline > 0 ? _startedAt + (uint64_t) (deadline * NSEC_PER_SEC) : 0;
+
+  return self;
+}
+
+@end
+
 @interface FBFutureContext ()
 
 @property (nonatomic, readonly) FBFutureTeardowns *teardowns;
 
++ (FBFuture<NSNull *> *)popTeardowns:(NSEnumerator<FBFutureContext_Teardown *> *)teardowns state:(FBFutureState)state run:(FBFutureContext_TeardownRun *)run;
+
+@end
+
+/**
+ The teardown of contexts that were constructed in parallel.
+ The stacks of teardowns are independent of each other, so each stack is unrolled concurrently.
+ */
+@interface FBFutureContext_ConcurrentTeardown : FBFutureContext_Teardown
+
+@property (nonatomic, copy, readonly) NSArray<NSArray<FBFutureContext_Teardown *> *> *stacks;
+
+@end
+
+@implementation FBFutureContext_ConcurrentTeardown
+
+- (instancetype)initWithFuture:(FBFuture *)future stacks:(NSArray<NSArray<FBFutureContext_Teardown *> *> *)stacks
+{
+  self = [super initWithFuture:future queue:FBFuture.internalQueue action:^(id _, FBFutureState __) {
+    return FBFuture.empty;
+  }];
+  if (!self) {
+    return nil;
+  }
+
+  _stacks = stacks;
+
+  return self;
+}
+
+- (FBFutureContext_Teardown *)teardownWithFuture:(FBFuture *)future
+{
+  return [[FBFutureContext_ConcurrentTeardown alloc] initWithFuture:future stacks:self.stacks];
+}
+
+- (FBFuture<NSNull *> *)performTeardown:(FBFutureState)endState
+{
+  FBMutableFuture<NSNull *> *teardownCompleted = FBMutableFuture.future;
+  NSArray<NSArray<FBFutureContext_Teardown *> *> *stacks = self.stacks;
+  [self.future onQueue:self.queue notifyOfCompletion:^(FBFuture *_) {
+    NSMutableArray<FBFuture<NSNull *> *> *futures = NSMutableArray.array;
+    for (NSArray<FBFutureContext_Teardown *> *stack in stacks) {
+      FBFutureContext_TeardownRun *run = [[FBFutureContext_TeardownRun alloc] initWithDeadline:0];
+      [futures addObject:[FBFutureContext popTeardowns:stack.reverseObjectEnumerator state:endState run:run]];
+    }
+    [teardownCompleted resolveFromFuture:[[FBFuture futureWithFutures:futures] mapReplace:NSNull.null]];
+  }];
+  return teardownCompleted;
+}
+
 @end
 
 @implementation FBFutureContext
@@ -245,12 +345,21 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
 + (FBFutureContext<NSArray<id> *> *)futureContextWithFutureContexts:(NSArray<FBFutureContext *> *)contexts
 {
   NSMutableArray<FBFuture *> *futures = NSMutableArray.array;
-  FBFutureTeardowns *teardowns = [[FBFutureTeardowns alloc] init];
+  NSMutableArray<NSArray<FBFutureContext_Teardown *> *> *stacks = NSMutableArray.array;
   for (FBFutureContext *context in contexts) {
     [futures addObject:context.future];
-    [teardowns addObjectsFromArray:[context.teardowns asArray]];
+    NSArray<FBFutureContext_Teardown *> *stack = [context.teardowns asArray];
+    if (stack.count > 0) {
+      [stacks addObject:stack];
+    }
   }
   FBFuture<NSArray<id> *> *future = [FBFuture futureWithFutures:futures];
+  FBFutureTeardowns *teardowns = [[FBFutureTeardowns alloc] init];
+  if (stacks.count == 1) {
+    [teardowns addObjectsFromArray:stacks.firstObject];
+  } else if (stacks.count > 1) {
+    [teardowns addObject:[[FBFutureContext_ConcurrentTeardown alloc] initWithFuture:future stacks:stacks]];
+  }
   return [[FBFutureContext alloc] initWithFuture:future teardowns:teardowns];
 }
 
@@ -275,7 +384,16 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
     onQueue:queue fmap:pop]
     onQueue:queue notifyOfCompletion:^(FBFuture *resolved) {
       NSArray<FBFutureContext_Teardown *> *teardowns = [self.teardowns asArray];
-      [FBFutureContext popTeardowns:teardowns.reverseObjectEnumerator state:resolved.state];
+      FBFutureContext_TeardownRun *run = [[FBFutureContext_TeardownRun alloc] initWithDeadline:self.teardowns.deadline];
+      FBFuture<NSNull *> *completed = [FBFutureContext popTeardowns:teardowns.reverseObjectEnumerator state:resolved.state run:run];
+      void (^metricsHandler)(NSUInteger, NSTimeInterval, NSUInteger) = FBFutureContext.teardownMetricsHandler;
+      if (!metricsHandler || teardowns.count == 0) {
+        return;
+      }
+      [completed onQueue:FBFuture.internalQueue notifyOfCompletion:^(FBFuture *_) {
+        NSTimeInterval duration = (NSTimeInterval) (clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - run.startedAt) / NSEC_PER_SEC;
+        metricsHandler(teardowns.count, duration, run.deadlineExceededCount);
+      }];
     }];
 }
 
@@ -357,40 +475,366 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
   return started;
 }
 
+- (FBFutureContext *)withTeardownDeadline:(NSTimeInterval)deadline
+{
+  self.teardowns.deadline = deadline;
+  return self;
+}
+
+#pragma mark Properties
+
+static void (^FBFutureContextTeardownMetricsHandler)(NSUInteger, NSTimeInterval, NSUInteger) = nil;
+
++ (void (^)(NSUInteger, NSTimeInterval, NSUInteger))teardownMetricsHandler
+{
+  @synchronized (self) {
+    return FBFutureContextTeardownMetricsHandler;
+  }
+}
+
++ (void)setTeardownMetricsHandler:(void (^)(NSUInteger, NSTimeInterval, NSUInteger))teardownMetricsHandler
+{
+  @synchronized (self) {
+    FBFutureContextTeardownMetricsHandler = [teardownMetricsHandler copy];
+  }
+}
+
 #pragma mark Private
 
-+ (FBFuture<NSNull *> *)popTeardowns:(NSEnumerator<FBFutureContext_Teardown *> *)teardowns state:(FBFutureState)state
++ (FBFuture<NSNull *> *)popTeardowns:(NSEnumerator<FBFutureContext_Teardown *> *)teardowns state:(FBFutureState)state run:(FBFutureContext_TeardownRun *)run
 {
   FBFutureContext_Teardown *teardown = teardowns.nextObject;
   if (!teardown) {
     return FBFuture.empty;
   }
-  return [[teardown
-    performTeardown:state]
+  FBFuture<NSNull *> *performed = [teardown performTeardown:state];
+  if (run.deadlineAt > 0) {
+    // The next teardown waits for this one until the deadline, after which it continues without cancelling this one, so that it still completes.
+    FBMutableFuture<NSNull *> *waited = FBMutableFuture.future;
+    [waited resolveFromFuture:performed];
+    uint64_t now = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    int64_t remaining = run.deadlineAt > now ? (int64_t) (run.deadlineAt - now) : 0;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, remaining), FBFuture.internalQueue, ^{
+      if (!performed.hasCompleted) {
+        @synchronized (run) {
+          run.deadlineExceededCount += 1;
+        }
+      }
+      [waited resolveWithResult:NSNull.null];
+    });
+    performed = waited;
+  }
+  return [performed
     onQueue:teardown.queue chain:^(id _) {
-      return [self popTeardowns:teardowns state:state];
+      return [self popTeardowns:teardowns state:state run:run];
     }];
 }
 
 @end
 
-@interface FBFuture ()
+static os_log_t FBFutureProfilerLog(void)
+{
+  static dispatch_once_t onceToken;
+  static os_log_t log;
+  dispatch_once(&onceToken, ^{
+    log = os_log_create("com.facebook.fbcontrolcore", "FBFuture");
+  });
+  return log;
+}
+
+static NSUInteger const FBFutureProfilerRootCapacity = 512;
+static atomic_bool FBFutureProfilerEnabled = false;
+// The profile of the Future whose handler is running on this thread, if any, so that Futures created by the handler become its children.
+static _Thread_local void *FBFutureProfilerCurrentNode = NULL;
+
+@interface FBFutureProfileNode ()
 
 @property (atomic, copy, nullable, readwrite) NSString *name;
-@property (nonatomic, strong, readonly) NSMutableArray<FBFuture_Handler *> *handlers;
-@property (nonatomic, strong, nullable, readwrite) NSMutableArray<FBFuture_Cancellation *> *cancelResponders;
-@property (nonatomic, strong, nullable, readwrite) FBFuture<NSNull *> *resolvedCancellation;
+@property (atomic, assign, readwrite) FBFutureState state;
+@property (atomic, assign, readwrite) NSTimeInterval handlerDuration;
+@property (atomic, assign, readwrite) NSUInteger handlerCount;
+@property (nonatomic, assign, readonly) uint64_t createdAt;
+@property (nonatomic, assign, readwrite) uint64_t resolvedAt;
+@property (nonatomic, assign, readonly) os_signpost_id_t signpostID;
+@property (nonatomic, strong, readonly) NSMutableSet<NSString *> *mutableQueueLabels;
+@property (nonatomic, strong, readonly) NSMutableArray<FBFutureProfileNode *> *mutableChildren;
+
+- (instancetype)initWithName:(nullable NSString *)name;
+- (void)addChild:(FBFutureProfileNode *)child;
+- (void)recordResolution:(FBFutureState)state;
+- (void)runHandler:(dispatch_block_t)handler onQueue:(dispatch_queue_t)queue;
+- (void)appendToDescription:(NSMutableString *)description depth:(NSUInteger)depth;
+
+@end
+
+@implementation FBFutureProfileNode
+
+- (instancetype)initWithName:(nullable NSString *)name
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _name = name;
+  _state = FBFutureStateRunning;
+  _createdAt = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  _mutableQueueLabels = NSMutableSet.set;
+  _mutableChildren = NSMutableArray.array;
+  _signpostID = os_signpost_id_generate(FBFutureProfilerLog());
+  os_signpost_interval_begin(FBFutureProfilerLog(), _signpostID, "Future");
+
+  return self;
+}
+
+#pragma mark Properties
+
+- (NSTimeInterval)pendingDuration
+{
+  uint64_t end = self.resolvedAt ?: clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  return (NSTimeInterval) (end - self.createdAt) / NSEC_PER_SEC;
+}
+
+- (NSSet<NSString *> *)queueLabels
+{
+  @synchronized (self) {
+    return [self.mutableQueueLabels copy];
+  }
+}
+
+- (NSArray<FBFutureProfileNode *> *)children
+{
+  @synchronized (self) {
+    return [self.mutableChildren copy];
+  }
+}
+
+- (NSUInteger)allocationCount
+{
+  NSUInteger count = 1;
+  for (FBFutureProfileNode *child in self.children) {
+    count += child.allocationCount;
+  }
+  return count;
+}
+
+#pragma mark NSObject
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:
+    @"%@ %@ | Pending %.3fms | %lu handlers in %.3fms on %@ | %lu allocations",
+    self.name ?: @"Unnamed",
+    FBFutureStateStringFromState(self.state),
+    self.pendingDuration * 1000,
+    (unsigned long) self.handlerCount,
+    self.handlerDuration * 1000,
+    [FBCollectionInformation oneLineDescriptionFromArray:self.queueLabels.allObjects],
+    (unsigned long) self.allocationCount
+  ];
+}
+
+#pragma mark Private
+
+- (void)addChild:(FBFutureProfileNode *)child
+{
+  @synchronized (self) {
+    [self.mutableChildren addObject:child];
+  }
+}
+
+- (void)recordResolution:(FBFutureState)state
+{
+  self.resolvedAt = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  self.state = state;
+  os_signpost_interval_end(FBFutureProfilerLog(), self.signpostID, "Future", "%{public}@ %{public}@", self.name ?: @"Unnamed", FBFutureStateStringFromState(state));
+}
+
+- (void)runHandler:(dispatch_block_t)handler onQueue:(dispatch_queue_t)queue
+{
+  const char *label = dispatch_queue_get_label(queue);
+  os_signpost_id_t signpostID = os_signpost_id_generate(FBFutureProfilerLog());
+  os_signpost_interval_begin(FBFutureProfilerLog(), signpostID, "Handler", "%{public}@ on %{public}s", self.name ?: @"Unnamed", label);
+  void *previous = FBFutureProfilerCurrentNode;
+  FBFutureProfilerCurrentNode = (__bridge void *) self;
+  uint64_t start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  handler();
+  uint64_t end = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  FBFutureProfilerCurrentNode = previous;
+  os_signpost_interval_end(FBFutureProfilerLog(), signpostID, "Handler");
+
+  @synchronized (self) {
+    self.handlerDuration += (NSTimeInterval) (end - start) / NSEC_PER_SEC;
+    self.handlerCount += 1;
+    [self.mutableQueueLabels addObject:[NSString stringWithUTF8String:label] ?: @""];
+  }
+}
+
+- (void)appendToDescription:(NSMutableString *)description depth:(NSUInteger)depth
+{
+  [description appendFormat:@"%@%@\n", [@"" stringByPaddingToLength:depth * 2 withString:@" " startingAtIndex:0], self];
+  for (FBFutureProfileNode *child in self.children) {
+    [child appendToDescription:description depth:depth + 1];
+  }
+}
+
+@end
+
+@interface FBFutureProfiler ()
+
++ (nullable FBFutureProfileNode *)nodeForFutureWithName:(nullable NSString *)name;
+
+@end
+
+@implementation FBFutureProfiler
+
+#pragma mark Properties
+
++ (BOOL)enabled
+{
+  return atomic_load_explicit(&FBFutureProfilerEnabled, memory_order_relaxed);
+}
+
++ (void)setEnabled:(BOOL)enabled
+{
+  atomic_store(&FBFutureProfilerEnabled, enabled);
+}
+
++ (NSMutableArray<FBFutureProfileNode *> *)mutableRootNodes
+{
+  static dispatch_once_t onceToken;
+  static NSMutableArray<FBFutureProfileNode *> *rootNodes;
+  dispatch_once(&onceToken, ^{
+    rootNodes = NSMutableArray.array;
+  });
+  return rootNodes;
+}
+
++ (NSArray<FBFutureProfileNode *> *)rootNodes
+{
+  NSMutableArray<FBFutureProfileNode *> *rootNodes = self.mutableRootNodes;
+  @synchronized (rootNodes) {
+    return [rootNodes copy];
+  }
+}
+
+#pragma mark Public
+
++ (NSString *)dumpTreeWithMinimumDuration:(NSTimeInterval)minimumDuration
+{
+  NSMutableString *description = NSMutableString.string;
+  for (FBFutureProfileNode *node in self.rootNodes) {
+    if (node.pendingDuration < minimumDuration) {
+      continue;
+    }
+    [node appendToDescription:description depth:0];
+  }
+  return description;
+}
+
++ (void)reset
+{
+  NSMutableArray<FBFutureProfileNode *> *rootNodes = self.mutableRootNodes;
+  @synchronized (rootNodes) {
+    [rootNodes removeAllObjects];
+  }
+}
+
+#pragma mark Private
+
++ (nullable FBFutureProfileNode *)nodeForFutureWithName:(nullable NSString *)name
+{
+  if (!atomic_load_explicit(&FBFutureProfilerEnabled, memory_order_relaxed)) {
+    return nil;
+  }
+  FBFutureProfileNode *node = [[FBFutureProfileNode alloc] initWithName:name];
+  FBFutureProfileNode *parent = (__bridge FBFutureProfileNode *) FBFutureProfilerCurrentNode;
+  if (parent) {
+    [parent addChild:node];
+    return node;
+  }
+  NSMutableArray<FBFutureProfileNode *> *rootNodes = self.mutableRootNodes;
+  @synchronized (rootNodes) {
+    if (rootNodes.count >= FBFutureProfilerRootCapacity) {
+      [rootNodes removeObjectAtIndex:0];
+    }
+    [rootNodes addObject:node];
+  }
+  return node;
+}
 
 @end
 
-@implementation FBFuture
+@interface FBFuture ()
+
+@property (atomic, copy, nullable, readwrite) NSString *name;
+@property (nonatomic, assign, readwrite) BOOL shared;
+@property (nonatomic, strong, nullable, readonly) FBFutureProfileNode *profile;
+@property (nonatomic, assign, readonly) uint64_t startTime;
+
++ (FBFuture *)sharedFutureWithName:(NSString *)name result:(id)result;
+- (void)onCurrentQueue:(dispatch_queue_t)queue notifyOfCompletion:(void (^)(FBFuture *))handler;
+- (void)runHandler:(void (^)(FBFuture *))handler onQueue:(dispatch_queue_t)queue;
 
-@synthesize error = _error, result = _result, state = _state;
+@end
+
+// Most futures have a single continuation, so the first handlers and the first cancellation responder are stored inline.
+// Only futures with more than that allocate FBFuture_Handler and FBFuture_Cancellation wrappers.
+// All of the state below is guarded by the unfair lock, which is never held whilst calling out of the future.
+@implementation FBFuture {
+  os_unfair_lock _lock;
+  FBFutureState _state;
+  id _result;
+  NSError *_error;
+  void (^_firstHandler)(FBFuture *);
+  dispatch_queue_t _firstHandlerQueue;
+  void (^_secondHandler)(FBFuture *);
+  dispatch_queue_t _secondHandlerQueue;
+  NSMutableArray<FBFuture_Handler *> *_additionalHandlers;
+  FBFuture<NSNull *> *(^_firstCancelResponder)(void);
+  dispatch_queue_t _firstCancelResponderQueue;
+  NSMutableArray<FBFuture_Cancellation *> *_additionalCancelResponders;
+  FBFuture<NSNull *> *_resolvedCancellation;
+}
 
 #pragma mark Initializers
 
++ (void)initialize
+{
+  if (self != FBFuture.class) {
+    return;
+  }
+  FBMetricsRegistry *registry = FBMetricsRegistry.sharedRegistry;
+  FuturesCreatedCounter = [registry counterWithName:@"future.created"];
+  FuturesSucceededCounter = [registry counterWithName:@"future.succeeded"];
+  FuturesFailedCounter = [registry counterWithName:@"future.failed"];
+  FuturesCancelledCounter = [registry counterWithName:@"future.cancelled"];
+  FuturesRunningGauge = [registry gaugeWithName:@"future.running"];
+  FutureDurationHistogram = [registry histogramWithName:@"future.duration_ns"];
+}
+
 + (FBFuture *)futureWithResult:(id)result
 {
+  // Common results share a single resolved future, rather than allocating one each time.
+  if (result == NSNull.null) {
+    return FBFuture.empty;
+  }
+  if (result == (id) kCFBooleanTrue) {
+    static dispatch_once_t onceToken;
+    static FBFuture *future;
+    dispatch_once(&onceToken, ^{
+      future = [FBFuture sharedFutureWithName:@"Yes" result:@YES];
+    });
+    return future;
+  }
+  if (result == (id) kCFBooleanFalse) {
+    static dispatch_once_t onceToken;
+    static FBFuture *future;
+    dispatch_once(&onceToken, ^{
+      future = [FBFuture sharedFutureWithName:@"No" result:@NO];
+    });
+    return future;
+  }
   FBMutableFuture *future = FBMutableFuture.future;
   return [future resolveWithResult:result];
 }
@@ -614,6 +1058,78 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
   return compositeFuture;
 }
 
++ (FBFuture *)futureWithFutureGenerators:(NSArray<FBFuture * (^)(void)> *)generators maxConcurrency:(NSUInteger)maxConcurrency
+{
+  NSParameterAssert(maxConcurrency > 0);
+  if (generators.count == 0) {
+    return [FBFuture futureWithResult:@[]];
+  }
+
+  FBMutableFuture *compositeFuture = FBMutableFuture.future;
+  NSMutableArray *results = [[FBCollectionOperations arrayWithObject:NSNull.null count:generators.count] mutableCopy];
+  NSMutableSet<FBFuture *> *pending = NSMutableSet.set;
+  dispatch_queue_t queue = dispatch_queue_create("com.facebook.fbcontrolcore.future.bounded", DISPATCH_QUEUE_SERIAL);
+  __block NSUInteger nextIndex = 0;
+  __block NSUInteger remaining = generators.count;
+
+  // `startPending` and `futureCompleted` must be called on `queue`.
+  // `startPending` and `futureCompleted` reference each other, the cycle is broken by releasing `startPending` once the composite has completed.
+  __block void (^startPending)(void);
+  void (^futureCompleted)(FBFuture *, NSUInteger) = ^(FBFuture *future, NSUInteger index) {
+    [pending removeObject:future];
+    if (compositeFuture.hasCompleted) {
+      startPending = nil;
+      return;
+    }
+    FBFutureState state = future.state;
+    switch (state) {
+      case FBFutureStateDone:
+        results[index] = future.result;
+        remaining--;
+        if (remaining == 0) {
+          [compositeFuture resolveWithResult:[results copy]];
+          startPending = nil;
+          return;
+        }
+        startPending();
+        return;
+      case FBFutureStateFailed:
+        [compositeFuture resolveWithError:future.error];
+        startPending = nil;
+        return;
+      case FBFutureStateCancelled:
+        [compositeFuture cancel];
+        startPending = nil;
+        return;
+      case FBFutureStateRunning:
+      default:
+        NSCAssert(NO, @"Unexpected state in callback %@", FBFutureStateStringFromState(state));
+        return;
+    }
+  };
+  startPending = ^{
+    while (pending.count < maxConcurrency && nextIndex < generators.count && !compositeFuture.hasCompleted) {
+      NSUInteger index = nextIndex++;
+      FBFuture *future = generators[index]();
+      [pending addObject:future];
+      [future onQueue:queue notifyOfCompletion:^(FBFuture *resolved) {
+        futureCompleted(resolved, index);
+      }];
+    }
+  };
+  dispatch_async(queue, ^{
+    startPending();
+  });
+
+  return [compositeFuture onQueue:queue respondToCancellation:^{
+    for (FBFuture *future in [pending copy]) {
+      [future cancel];
+    }
+    startPending = nil;
+    return FBFuture.empty;
+  }];
+}
+
 + (FBFuture *)race:(NSArray<FBFuture *> *)futures
 {
   NSParameterAssert(futures.count > 0);
@@ -668,8 +1184,12 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
 
 + (FBFuture<NSNull *> *)empty
 {
-  FBMutableFuture *future = [FBMutableFuture futureWithName:@"Empty"];
-  return [future resolveWithResult:NSNull.null];
+  static dispatch_once_t onceToken;
+  static FBFuture<NSNull *> *empty;
+  dispatch_once(&onceToken, ^{
+    empty = [FBFuture sharedFutureWithName:@"Empty" result:NSNull.null];
+  });
+  return empty;
 }
 
 - (instancetype)init
@@ -684,11 +1204,14 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
     return nil;
   }
 
+  _lock = OS_UNFAIR_LOCK_INIT;
   _state = FBFutureStateRunning;
-  _handlers = [NSMutableArray array];
-  _cancelResponders = [NSMutableArray array];
 
   _name = name;
+  _profile = [FBFutureProfiler nodeForFutureWithName:name];
+  _startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  [FuturesCreatedCounter increment];
+  [FuturesRunningGauge add:1];
 
   return self;
 }
@@ -709,19 +1232,23 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
 
 - (FBFuture<NSNull *> *)cancel
 {
-  @synchronized (self) {
-    if (self.resolvedCancellation) {
-      return self.resolvedCancellation;
-    }
-    if (self.state != FBFutureStateRunning) {
-      return FBFuture.empty;
-    }
+  os_unfair_lock_lock(&_lock);
+  FBFuture<NSNull *> *resolvedCancellation = _resolvedCancellation;
+  FBFutureState state = _state;
+  os_unfair_lock_unlock(&_lock);
+  if (resolvedCancellation) {
+    return resolvedCancellation;
   }
-  NSArray<FBFuture_Cancellation *> *cancelResponders = [self resolveAsCancelled];
-  @synchronized (self) {
-    self.resolvedCancellation = [FBFuture resolveCancellationResponders:cancelResponders forOriginalName:self.name];
-    return self.resolvedCancellation;
+  if (state != FBFutureStateRunning) {
+    return FBFuture.empty;
   }
+
+  NSArray<FBFuture_Cancellation *> *cancelResponders = [self resolveAsCancelled];
+  resolvedCancellation = [FBFuture resolveCancellationResponders:cancelResponders forOriginalName:self.name];
+  os_unfair_lock_lock(&_lock);
+  _resolvedCancellation = resolvedCancellation;
+  os_unfair_lock_unlock(&_lock);
+  return resolvedCancellation;
 }
 
 - (instancetype)onQueue:(dispatch_queue_t)queue respondToCancellation:(FBFuture<NSNull *> *(^)(void))handler
@@ -729,10 +1256,21 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
   NSParameterAssert(queue);
   NSParameterAssert(handler);
 
-  @synchronized(self) {
-    [self.cancelResponders addObject:[[FBFuture_Cancellation alloc] initWithQueue:queue handler:handler]];
-    return self;
+  os_unfair_lock_lock(&_lock);
+  // Responders are only kept whilst running, as resolution discards them.
+  if (_state == FBFutureStateRunning) {
+    if (!_firstCancelResponder) {
+      _firstCancelResponder = handler;
+      _firstCancelResponderQueue = queue;
+    } else {
+      if (!_additionalCancelResponders) {
+        _additionalCancelResponders = [NSMutableArray array];
+      }
+      [_additionalCancelResponders addObject:[[FBFuture_Cancellation alloc] initWithQueue:queue handler:handler]];
+    }
   }
+  os_unfair_lock_unlock(&_lock);
+  return self;
 }
 
 #pragma mark Completion Notification
@@ -742,16 +1280,24 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
   NSParameterAssert(queue);
   NSParameterAssert(handler);
 
-  @synchronized (self) {
-    if (self.state == FBFutureStateRunning) {
-      FBFuture_Handler *wrapper = [[FBFuture_Handler alloc] initWithQueue:queue handler:handler];
-      [self.handlers addObject:wrapper];
-    } else {
-      dispatch_async(queue, ^{
-        handler(self);
-      });
-    }
+  if ([self addHandler:handler queue:queue]) {
+    return self;
   }
+  dispatch_async(queue, ^{
+    [self runHandler:handler onQueue:queue];
+  });
+  return self;
+}
+
+- (instancetype)notifyOfCompletionInline:(void (^)(FBFuture *))handler
+{
+  NSParameterAssert(handler);
+
+  // A handler without a queue is called by fireHandler:onQueue:, on the resolving thread.
+  if ([self addHandler:handler queue:nil]) {
+    return self;
+  }
+  handler(self);
   return self;
 }
 
@@ -771,7 +1317,7 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
   [self onQueue:queue notifyOfCompletion:^(FBFuture *future) {
     FBFuture *next = chain(future);
     NSCAssert([next isKindOfClass:FBFuture.class], @"chained value is not a Future, got %@", next);
-    [next onQueue:queue notifyOfCompletion:^(FBFuture *final) {
+    [next onCurrentQueue:queue notifyOfCompletion:^(FBFuture *final) {
       FBFutureState state = final.state;
       switch (state) {
         case FBFutureStateFailed:
@@ -814,7 +1360,7 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
     }
     FBFuture *fmapped = fmap(future.result);
     NSCAssert([fmapped isKindOfClass:FBFuture.class], @"fmap'ped value is not a Future, got %@", fmapped);
-    [fmapped onQueue:queue notifyOfCompletion:^(FBFuture *next) {
+    [fmapped onCurrentQueue:queue notifyOfCompletion:^(FBFuture *next) {
       if (next.error) {
         [chained resolveWithError:next.error];
         return;
@@ -906,7 +1452,7 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
   FBFuture *future = [self onQueue:queue fmap:^(id value) {
     FBFutureContext *chained = fmap(value);
     for (FBFutureContext_Teardown *teardown in [chained.teardowns asArray]) {
-      [teardowns addObject:[[FBFutureContext_Teardown alloc] initWithFuture:chained.future queue:teardown.queue action:teardown.action]];
+      [teardowns addObject:[teardown teardownWithFuture:chained.future]];
     }
     return chained.future;
   }];
@@ -917,7 +1463,13 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
 
 - (FBFuture *)named:(NSString *)name
 {
+  // A shared future must not be renamed for all of its users, so a named copy is made.
+  if (self.shared) {
+    FBMutableFuture *future = [FBMutableFuture futureWithName:name];
+    return [future resolveFromFuture:self];
+  }
   self.name = name;
+  self.profile.name = name;
   return self;
 }
 
@@ -953,66 +1505,39 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
 
 - (NSError *)error
 {
-  @synchronized (self) {
-    return self->_error;
-  }
+  os_unfair_lock_lock(&_lock);
+  NSError *error = _error;
+  os_unfair_lock_unlock(&_lock);
+  return error;
 }
 
 - (id)result
 {
-  @synchronized (self) {
-    return self->_result;
-  }
+  os_unfair_lock_lock(&_lock);
+  id result = _result;
+  os_unfair_lock_unlock(&_lock);
+  return result;
 }
 
 - (FBFutureState)state
 {
-  @synchronized (self) {
-    return _state;
-  }
-}
-
-- (void)setError:(NSError *)error
-{
-  _error = error;
-}
-
-- (void)setState:(FBFutureState)state
-{
-  _state = state;
-}
-
-- (void)setResult:(id)result
-{
-  _result = result;
+  os_unfair_lock_lock(&_lock);
+  FBFutureState state = _state;
+  os_unfair_lock_unlock(&_lock);
+  return state;
 }
 
 #pragma mark FBMutableFuture Implementation
 
 - (instancetype)resolveWithResult:(id)result
 {
-  @synchronized (self) {
-    if (self.state == FBFutureStateRunning) {
-      self.result = result;
-      self.state = FBFutureStateDone;
-      [self fireAllHandlers];
-      self.cancelResponders = nil;
-    }
-  }
-
+  [self resolveToState:FBFutureStateDone result:result error:nil cancelResponders:NULL];
   return self;
 }
 
 - (instancetype)resolveWithError:(NSError *)error
 {
-  @synchronized (self) {
-    if (self.state == FBFutureStateRunning) {
-      self.error = error;
-      self.state = FBFutureStateFailed;
-      [self fireAllHandlers];
-      self.cancelResponders = nil;
-    }
-  }
+  [self resolveToState:FBFutureStateFailed result:nil error:error cancelResponders:NULL];
   return self;
 }
 
@@ -1046,27 +1571,159 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
 
 #pragma mark Private
 
++ (FBFuture *)sharedFutureWithName:(NSString *)name result:(id)result
+{
+  FBMutableFuture *future = [FBMutableFuture futureWithName:name];
+  [future resolveWithResult:result];
+  future.shared = YES;
+  return future;
+}
+
+// Only called from within a handler that is already running on the queue.
+// A future that has resolved runs the handler inline, as the queue hop that notifyOfCompletion would otherwise make is to the queue that is already current.
+// This is reserved for internal continuations that do no further work after they are registered, so running the handler early cannot be observed.
+- (void)onCurrentQueue:(dispatch_queue_t)queue notifyOfCompletion:(void (^)(FBFuture *))handler
+{
+  if (self.state == FBFutureStateRunning || FBFutureInlineDepth >= FBFutureMaximumInlineDepth) {
+    [self onQueue:queue notifyOfCompletion:handler];
+    return;
+  }
+  FBFutureInlineDepth++;
+  [self runHandler:handler onQueue:queue];
+  FBFutureInlineDepth--;
+}
+
 - (NSArray<FBFuture_Cancellation *> *)resolveAsCancelled
 {
-  @synchronized (self) {
-    if (self.state == FBFutureStateRunning) {
-      self.state = FBFutureStateCancelled;
-      [self fireAllHandlers];
+  NSArray<FBFuture_Cancellation *> *cancelResponders = nil;
+  [self resolveToState:FBFutureStateCancelled result:nil error:nil cancelResponders:&cancelResponders];
+  return cancelResponders;
+}
+
+// Stores the handler if the future is still running, returning NO if it has resolved and the caller must run the handler itself.
+- (BOOL)addHandler:(void (^)(FBFuture *))handler queue:(nullable dispatch_queue_t)queue
+{
+  os_unfair_lock_lock(&_lock);
+  if (_state != FBFutureStateRunning) {
+    os_unfair_lock_unlock(&_lock);
+    return NO;
+  }
+  if (!_firstHandler) {
+    _firstHandler = handler;
+    _firstHandlerQueue = queue;
+  } else if (!_secondHandler) {
+    _secondHandler = handler;
+    _secondHandlerQueue = queue;
+  } else {
+    if (!_additionalHandlers) {
+      _additionalHandlers = [NSMutableArray array];
     }
-    NSArray<FBFuture_Cancellation *> *cancelResponders = self.cancelResponders;
-    self.cancelResponders = nil;
-    return cancelResponders;
+    [_additionalHandlers addObject:[[FBFuture_Handler alloc] initWithQueue:queue handler:handler]];
   }
+  os_unfair_lock_unlock(&_lock);
+  return YES;
 }
 
-- (void)fireAllHandlers
+// Moves a running future to a resolved state and takes its handlers under the lock.
+// The handlers are then fired with the lock released, as inline handlers can call straight back into the future.
+// Cancellation responders are returned for a cancellation, and discarded otherwise.
+- (BOOL)resolveToState:(FBFutureState)state result:(nullable id)result error:(nullable NSError *)error cancelResponders:(NSArray<FBFuture_Cancellation *> **)cancelRespondersOut
 {
-  for (FBFuture_Handler *handler in self.handlers) {
-    dispatch_async(handler.queue, ^{
-      handler.handler(self);
-    });
+  os_unfair_lock_lock(&_lock);
+  if (_state != FBFutureStateRunning) {
+    os_unfair_lock_unlock(&_lock);
+    return NO;
+  }
+  _state = state;
+  _result = result;
+  _error = error;
+  void (^firstHandler)(FBFuture *) = _firstHandler;
+  dispatch_queue_t firstHandlerQueue = _firstHandlerQueue;
+  void (^secondHandler)(FBFuture *) = _secondHandler;
+  dispatch_queue_t secondHandlerQueue = _secondHandlerQueue;
+  NSArray<FBFuture_Handler *> *additionalHandlers = _additionalHandlers;
+  FBFuture<NSNull *> *(^firstCancelResponder)(void) = _firstCancelResponder;
+  dispatch_queue_t firstCancelResponderQueue = _firstCancelResponderQueue;
+  NSArray<FBFuture_Cancellation *> *additionalCancelResponders = _additionalCancelResponders;
+  _firstHandler = nil;
+  _firstHandlerQueue = nil;
+  _secondHandler = nil;
+  _secondHandlerQueue = nil;
+  _additionalHandlers = nil;
+  _firstCancelResponder = nil;
+  _firstCancelResponderQueue = nil;
+  _additionalCancelResponders = nil;
+  os_unfair_lock_unlock(&_lock);
+
+  if (cancelRespondersOut && firstCancelResponder) {
+    NSMutableArray<FBFuture_Cancellation *> *cancelResponders = [NSMutableArray arrayWithObject:[[FBFuture_Cancellation alloc] initWithQueue:firstCancelResponderQueue handler:firstCancelResponder]];
+    if (additionalCancelResponders) {
+      [cancelResponders addObjectsFromArray:additionalCancelResponders];
+    }
+    *cancelRespondersOut = cancelResponders;
+  }
+
+  // The state is written directly under the lock, so observers are notified once the lock is released.
+  if (self.observationInfo) {
+    NSString *key = NSStringFromSelector(@selector(state));
+    [self willChangeValueForKey:key];
+    [self didChangeValueForKey:key];
+  }
+
+  [self.profile recordResolution:state];
+  [self recordResolution:state];
+  if (firstHandler) {
+    [self fireHandler:firstHandler onQueue:firstHandlerQueue];
+  }
+  if (secondHandler) {
+    [self fireHandler:secondHandler onQueue:secondHandlerQueue];
+  }
+  for (FBFuture_Handler *handler in additionalHandlers) {
+    [self fireHandler:handler.handler onQueue:handler.queue];
   }
-  [self.handlers removeAllObjects];
+  return YES;
+}
+
+- (void)fireHandler:(void (^)(FBFuture *))handler onQueue:(nullable dispatch_queue_t)queue
+{
+  if (!queue) {
+    handler(self);
+    return;
+  }
+  dispatch_async(queue, ^{
+    [self runHandler:handler onQueue:queue];
+  });
+}
+
+- (void)recordResolution:(FBFutureState)state
+{
+  [FuturesRunningGauge add:-1];
+  [FutureDurationHistogram recordNanosecondsSince:self.startTime];
+  switch (state) {
+    case FBFutureStateDone:
+      [FuturesSucceededCounter increment];
+      break;
+    case FBFutureStateFailed:
+      [FuturesFailedCounter increment];
+      break;
+    case FBFutureStateCancelled:
+      [FuturesCancelledCounter increment];
+      break;
+    default:
+      break;
+  }
+}
+
+- (void)runHandler:(void (^)(FBFuture *))handler onQueue:(dispatch_queue_t)queue
+{
+  FBFutureProfileNode *profile = self.profile;
+  if (!profile) {
+    handler(self);
+    return;
+  }
+  [profile runHandler:^{
+    handler(self);
+  } onQueue:queue];
 }
 
 + (FBFuture<NSNull *> *)resolveCancellationResponders:(NSArray<FBFuture_Cancellation *> *)cancelResponders forOriginalName:(NSString *)originalName
@@ -1093,6 +1750,11 @@ static void final_resolveUntil(FBMutableFuture *final, dispatch_queue_t queue, F
 
 #pragma mark KVO
 
++ (BOOL)automaticallyNotifiesObserversOfState
+{
+  return NO;
+}
+
 + (NSSet<NSString *> *)keyPathsForValuesAffectingHasCompleted
 {
   return [NSSet setWithObjects:NSStringFromSelector(@selector(state)), nil];
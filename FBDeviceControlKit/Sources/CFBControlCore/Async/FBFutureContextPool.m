@@ -0,0 +1,402 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBFutureContextPool.h"
+
+#import "FBControlCoreLogger.h"
+#import "FBFuture.h"
+
+@interface FBFutureContextPool_Entry : NSObject
+
+@property (nonatomic, strong, readonly) id context;
+@property (nonatomic, copy, readonly) NSDate *lastUsed;
+@property (nonatomic, assign, readonly) BOOL prewarmed;
+
+- (instancetype)initWithContext:(id)context lastUsed:(NSDate *)lastUsed prewarmed:(BOOL)prewarmed;
+
+@end
+
+@implementation FBFutureContextPool_Entry
+
+- (instancetype)initWithContext:(id)context lastUsed:(NSDate *)lastUsed prewarmed:(BOOL)prewarmed
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _context = context;
+  _lastUsed = lastUsed;
+  _prewarmed = prewarmed;
+
+  return self;
+}
+
+@end
+
+@interface FBFutureContextPool ()
+
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, weak, readonly) id<FBFutureContextPoolDelegate> delegate;
+@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, copy, nullable, readonly) NSNumber *healthCheckInterval;
+
+// Ordered from least to most recently used.
+@property (nonatomic, strong, readonly) NSMutableArray<FBFutureContextPool_Entry *> *idle;
+@property (nonatomic, strong, readonly) NSHashTable *inUse;
+@property (nonatomic, strong, readonly) NSHashTable *stale;
+@property (nonatomic, strong, readonly) NSMutableArray<FBMutableFuture *> *waiters;
+@property (nonatomic, assign, readwrite) NSUInteger preparingCount;
+@property (nonatomic, assign, readwrite) NSUInteger checkingCount;
+@property (nonatomic, assign, readwrite) NSUInteger generation;
+@property (nonatomic, strong, nullable, readwrite) FBFuture<NSNull *> *tick;
+
+@end
+
+@implementation FBFutureContextPool
+
+#pragma mark Initializers
+
++ (instancetype)poolWithQueue:(dispatch_queue_t)queue delegate:(id<FBFutureContextPoolDelegate>)delegate capacity:(NSUInteger)capacity healthCheckInterval:(nullable NSNumber *)healthCheckInterval logger:(id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithQueue:queue delegate:delegate capacity:capacity healthCheckInterval:healthCheckInterval logger:logger];
+}
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue delegate:(id<FBFutureContextPoolDelegate>)delegate capacity:(NSUInteger)capacity healthCheckInterval:(nullable NSNumber *)healthCheckInterval logger:(id<FBControlCoreLogger>)logger
+{
+  NSParameterAssert(capacity > 0);
+
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _queue = queue;
+  _delegate = delegate;
+  _capacity = capacity;
+  _healthCheckInterval = healthCheckInterval;
+  _logger = logger;
+
+  _idle = [NSMutableArray array];
+  _inUse = [NSHashTable hashTableWithOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality];
+  _stale = [NSHashTable hashTableWithOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality];
+  _waiters = [NSMutableArray array];
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (FBFutureContext<id> *)utilizeWithPurpose:(NSString *)purpose
+{
+  id<FBControlCoreLogger> logger = [self loggerWithPurpose:purpose];
+  return [[FBFuture
+    onQueue:self.queue resolve:^{
+      return [self checkoutWithLogger:logger];
+    }]
+    onQueue:self.queue contextualTeardown:^(id context, FBFutureState __) {
+      [self checkinContext:context logger:logger];
+      return FBFuture.empty;
+    }];
+}
+
+- (FBFuture<NSNumber *> *)prewarm:(NSUInteger)count
+{
+  id<FBControlCoreLogger> logger = [self loggerWithPurpose:@"prewarm"];
+  return [FBFuture
+    onQueue:self.queue resolve:^{
+      NSUInteger target = MIN(count, self.capacity);
+      NSUInteger needed = target > self.idle.count ? target - self.idle.count : 0;
+      NSUInteger available = self.capacity - MIN(self.contextCount, self.capacity);
+      NSUInteger preparing = MIN(needed, available);
+      [logger logFormat:@"Prewarming %lu contexts, %lu idle of capacity %lu", preparing, self.idle.count, self.capacity];
+
+      NSMutableArray<FBFuture<NSNull *> *> *futures = [NSMutableArray array];
+      for (NSUInteger index = 0; index < preparing; index++) {
+        FBFuture<NSNull *> *future = [[self
+          prepareWithLogger:logger]
+          onQueue:self.queue chain:^(FBFuture *prepared) {
+            id context = prepared.result;
+            if (context && [self.stale containsObject:context]) {
+              [self checkinContext:context logger:logger];
+            } else if (context) {
+              [self.inUse removeObject:context];
+              [self makeAvailable:[[FBFutureContextPool_Entry alloc] initWithContext:context lastUsed:NSDate.date prewarmed:YES] logger:logger];
+            } else {
+              [logger logFormat:@"Failed to prewarm context %@", prepared.error];
+            }
+            return [FBFuture futureWithResult:NSNull.null];
+          }];
+        [futures addObject:future];
+      }
+      return [[FBFuture
+        futureWithFutures:futures]
+        onQueue:self.queue map:^(id _) {
+          return @(self.idle.count);
+        }];
+    }];
+}
+
+- (FBFuture<NSNull *> *)drain
+{
+  id<FBControlCoreLogger> logger = [self loggerWithPurpose:@"drain"];
+  return [FBFuture
+    onQueue:self.queue resolve:^{
+      [self.tick cancel];
+      self.tick = nil;
+      self.generation += 1;
+      for (id context in self.inUse) {
+        [self.stale addObject:context];
+      }
+      NSArray<FBFutureContextPool_Entry *> *entries = [self.idle copy];
+      [self.idle removeAllObjects];
+      [logger logFormat:@"Draining %lu idle contexts, %lu in use will be torn down when returned", entries.count, self.inUse.count];
+
+      NSMutableArray<FBFuture<NSNull *> *> *futures = [NSMutableArray array];
+      for (FBFutureContextPool_Entry *entry in entries) {
+        [futures addObject:[self teardownContext:entry.context logger:logger]];
+      }
+      return [[FBFuture futureWithFutures:futures] mapReplace:NSNull.null];
+    }];
+}
+
+- (BOOL)evictLeastRecentlyUsed
+{
+  FBFutureContextPool_Entry *entry = self.idle.firstObject;
+  if (!entry) {
+    return NO;
+  }
+  id<FBControlCoreLogger> logger = [self loggerWithPurpose:@"evict"];
+  [self.idle removeObjectAtIndex:0];
+  [logger logFormat:@"Evicting least recently used context %@, last used %@", entry.context, entry.lastUsed];
+  [self teardownContext:entry.context logger:logger];
+  [self serviceWaitersWithLogger:logger];
+  return YES;
+}
+
+#pragma mark Properties
+
+- (NSUInteger)contextCount
+{
+  return self.idle.count + self.inUse.count + self.preparingCount + self.checkingCount;
+}
+
+- (NSDate *)leastRecentlyUsedDate
+{
+  return self.idle.firstObject.lastUsed;
+}
+
+#pragma mark Private
+
+- (id<FBControlCoreLogger>)loggerWithPurpose:(NSString *)purpose
+{
+  return [self.logger withName:[NSString stringWithFormat:@"%@_%@", self.delegate.contextName, purpose]];
+}
+
+- (FBFuture<id> *)checkoutWithLogger:(id<FBControlCoreLogger>)logger
+{
+  // The most recently used context is the most likely to still be healthy and leaves the least recently used to age out.
+  FBFutureContextPool_Entry *entry = self.idle.lastObject;
+  if (entry) {
+    [self.idle removeLastObject];
+    [self.inUse addObject:entry.context];
+    [logger logFormat:@"Re-Using idle context %@, %lu remain idle", entry.context, self.idle.count];
+    if (self.idle.count == 0) {
+      [self.tick cancel];
+      self.tick = nil;
+    }
+    return [FBFuture futureWithResult:entry.context];
+  }
+  if (self.contextCount < self.capacity) {
+    [logger logFormat:@"No idle context, preparing one of capacity %lu", self.capacity];
+    return [self prepareWithLogger:logger];
+  }
+  [logger logFormat:@"All %lu contexts of '%@' in use, waiting for one to be returned", self.capacity, self.delegate.contextName];
+  FBMutableFuture<id> *waiter = FBMutableFuture.future;
+  [self.waiters addObject:waiter];
+  return waiter;
+}
+
+- (void)checkinContext:(id)context logger:(id<FBControlCoreLogger>)logger
+{
+  NSParameterAssert([self.inUse containsObject:context]);
+  [self.inUse removeObject:context];
+
+  if ([self.stale containsObject:context]) {
+    [self.stale removeObject:context];
+    [logger logFormat:@"Context %@ was drained whilst in use, tearing it down", context];
+    [self teardownContext:context logger:logger];
+    [self serviceWaitersWithLogger:logger];
+    return;
+  }
+  if (!self.delegate.contextPoolTimeout && ![self hasRunningWaiter]) {
+    [logger log:@"No more consumers, no timeout tearing down context now"];
+    [self teardownContext:context logger:logger];
+    return;
+  }
+  [self makeAvailable:[[FBFutureContextPool_Entry alloc] initWithContext:context lastUsed:NSDate.date prewarmed:NO] logger:logger];
+}
+
+- (FBFuture<id> *)prepareWithLogger:(id<FBControlCoreLogger>)logger
+{
+  NSUInteger generation = self.generation;
+  self.preparingCount += 1;
+  return [[self.delegate
+    prepare:logger]
+    onQueue:self.queue chain:^(FBFuture *future) {
+      self.preparingCount -= 1;
+      id context = future.result;
+      if (context) {
+        [self.inUse addObject:context];
+        if (generation != self.generation) {
+          [self.stale addObject:context];
+        }
+      } else {
+        [self serviceWaitersWithLogger:logger];
+      }
+      return future;
+    }];
+}
+
+- (void)makeAvailable:(FBFutureContextPool_Entry *)entry logger:(id<FBControlCoreLogger>)logger
+{
+  FBMutableFuture<id> *waiter = [self popRunningWaiter];
+  if (waiter) {
+    [logger logFormat:@"Handing context %@ to a waiting consumer", entry.context];
+    [self.inUse addObject:entry.context];
+    [waiter resolveWithResult:entry.context];
+    return;
+  }
+  NSUInteger index = [self.idle
+    indexOfObject:entry
+    inSortedRange:NSMakeRange(0, self.idle.count)
+    options:NSBinarySearchingInsertionIndex | NSBinarySearchingLastEqual
+    usingComparator:^ NSComparisonResult (FBFutureContextPool_Entry *left, FBFutureContextPool_Entry *right) {
+      return [left.lastUsed compare:right.lastUsed];
+    }];
+  [self.idle insertObject:entry atIndex:index];
+  [self scheduleTickWithLogger:logger];
+}
+
+- (void)serviceWaitersWithLogger:(id<FBControlCoreLogger>)logger
+{
+  while (self.contextCount < self.capacity) {
+    FBMutableFuture<id> *waiter = [self popRunningWaiter];
+    if (!waiter) {
+      return;
+    }
+    [logger log:@"Capacity available, preparing a context for a waiting consumer"];
+    [waiter resolveFromFuture:[self prepareWithLogger:logger]];
+  }
+}
+
+- (nullable FBMutableFuture<id> *)popRunningWaiter
+{
+  while (self.waiters.count > 0) {
+    FBMutableFuture<id> *waiter = self.waiters.firstObject;
+    [self.waiters removeObjectAtIndex:0];
+    // A waiter that has been cancelled will never be torn down, so must not be given a context.
+    if (waiter.state == FBFutureStateRunning) {
+      return waiter;
+    }
+  }
+  return nil;
+}
+
+- (BOOL)hasRunningWaiter
+{
+  for (FBMutableFuture *waiter in self.waiters) {
+    if (waiter.state == FBFutureStateRunning) {
+      return YES;
+    }
+  }
+  return NO;
+}
+
+- (FBFuture<NSNull *> *)teardownContext:(id)context logger:(id<FBControlCoreLogger>)logger
+{
+  return [[self.delegate
+    teardown:context logger:logger]
+    onQueue:self.queue handleError:^(NSError *error) {
+      [logger logFormat:@"Failed to teardown context %@ with error %@", context, error];
+      return FBFuture.empty;
+    }];
+}
+
+#pragma mark Idle Maintenance
+
+- (nullable NSNumber *)tickInterval
+{
+  NSNumber *timeout = self.delegate.contextPoolTimeout;
+  NSNumber *healthCheckInterval = [self.delegate respondsToSelector:@selector(checkHealth:logger:)] ? self.healthCheckInterval : nil;
+  if (timeout && healthCheckInterval) {
+    return @(MIN(timeout.doubleValue, healthCheckInterval.doubleValue));
+  }
+  return timeout ?: healthCheckInterval;
+}
+
+- (void)scheduleTickWithLogger:(id<FBControlCoreLogger>)logger
+{
+  NSNumber *interval = self.tickInterval;
+  if (self.tick || !interval || self.idle.count == 0) {
+    return;
+  }
+  __weak typeof(self) weakSelf = self;
+  self.tick = [[FBFuture
+    futureWithDelay:interval.doubleValue future:FBFuture.empty]
+    onQueue:self.queue notifyOfCompletion:^(FBFuture *future) {
+      if (!future.result) {
+        return;
+      }
+      weakSelf.tick = nil;
+      [weakSelf maintainIdleWithLogger:logger];
+    }];
+}
+
+- (void)maintainIdleWithLogger:(id<FBControlCoreLogger>)logger
+{
+  NSNumber *timeout = self.delegate.contextPoolTimeout;
+  if (timeout) {
+    NSDate *cutoff = [NSDate dateWithTimeIntervalSinceNow:-timeout.doubleValue];
+    for (FBFutureContextPool_Entry *entry in [self.idle copy]) {
+      if (entry.prewarmed || [entry.lastUsed compare:cutoff] != NSOrderedAscending) {
+        continue;
+      }
+      [self.idle removeObjectIdenticalTo:entry];
+      [logger logFormat:@"Context %@ has been idle for more than %f seconds, tearing it down", entry.context, timeout.doubleValue];
+      [self teardownContext:entry.context logger:logger];
+    }
+  }
+  if (self.healthCheckInterval && [self.delegate respondsToSelector:@selector(checkHealth:logger:)]) {
+    [self checkIdleHealthWithLogger:logger];
+  }
+  [self scheduleTickWithLogger:logger];
+}
+
+- (void)checkIdleHealthWithLogger:(id<FBControlCoreLogger>)logger
+{
+  // Entries are taken out of the idle list whilst they are checked, so that they are not handed out mid-check.
+  NSArray<FBFutureContextPool_Entry *> *entries = [self.idle copy];
+  [self.idle removeAllObjects];
+  self.checkingCount += entries.count;
+  for (FBFutureContextPool_Entry *entry in entries) {
+    [[self.delegate
+      checkHealth:entry.context logger:logger]
+      onQueue:self.queue notifyOfCompletion:^(FBFuture *future) {
+        self.checkingCount -= 1;
+        if (future.result) {
+          [self makeAvailable:entry logger:logger];
+          return;
+        }
+        [logger logFormat:@"Idle context %@ failed health check %@, tearing it down", entry.context, future.error];
+        [self teardownContext:entry.context logger:logger];
+        [self serviceWaitersWithLogger:logger];
+      }];
+  }
+}
+
+@end
@@ -7,12 +7,83 @@
 
 #import "FBCodesignProvider.h"
 
+#import <os/lock.h>
+#import <sys/stat.h>
+
 #import "FBControlCore.h"
 
 #import "FBControlCoreError.h"
 
 static NSString *const CDHashPrefix = @"CDHash=";
 
+/**
+ A key that changes whenever the signed content of a bundle does.
+ Signing rewrites the executable and the CodeResources seal, so their identity, size and modification time stand in for hashing the whole bundle.
+ Returns nil if the bundle has no executable that can be found, in which case nothing is cached for it.
+ */
+static NSString *_Nullable ContentKeyForBundle(NSString *bundlePath)
+{
+  NSString *executablePath = bundlePath;
+  NSString *codeResourcesPath = nil;
+  BOOL isDirectory = NO;
+  if (![NSFileManager.defaultManager fileExistsAtPath:bundlePath isDirectory:&isDirectory]) {
+    return nil;
+  }
+  if (isDirectory) {
+    NSString *executableName = [NSDictionary dictionaryWithContentsOfFile:[bundlePath stringByAppendingPathComponent:@"Info.plist"]][@"CFBundleExecutable"];
+    if (!executableName) {
+      return nil;
+    }
+    executablePath = [bundlePath stringByAppendingPathComponent:executableName];
+    codeResourcesPath = [bundlePath stringByAppendingPathComponent:@"_CodeSignature/CodeResources"];
+  }
+
+  NSMutableString *key = [NSMutableString string];
+  for (NSString *path in @[executablePath, codeResourcesPath ?: @""]) {
+    struct stat info;
+    if (path.length == 0 || stat(path.fileSystemRepresentation, &info) != 0) {
+      [key appendString:@"-|"];
+      continue;
+    }
+    [key appendFormat:@"%llu:%llu:%lld:%ld.%ld|", (unsigned long long) info.st_dev, (unsigned long long) info.st_ino, (long long) info.st_size, (long) info.st_mtimespec.tv_sec, (long) info.st_mtimespec.tv_nsec];
+  }
+  if ([key hasPrefix:@"-|"]) {
+    return nil;
+  }
+  return key;
+}
+
+/**
+ Signing identities and CDHashes by content key, shared by all providers in the process.
+ */
+static os_unfair_lock SignatureCacheLock = OS_UNFAIR_LOCK_INIT;
+static NSMutableDictionary<NSString *, NSString *> *IdentityByContentKey = nil;
+static NSMutableDictionary<NSString *, NSString *> *CDHashByContentKey = nil;
+
+static NSString *_Nullable SignatureCacheGet(NSMutableDictionary<NSString *, NSString *> *__strong *cache, NSString *_Nullable contentKey)
+{
+  if (!contentKey) {
+    return nil;
+  }
+  os_unfair_lock_lock(&SignatureCacheLock);
+  NSString *value = (*cache)[contentKey];
+  os_unfair_lock_unlock(&SignatureCacheLock);
+  return value;
+}
+
+static void SignatureCacheSet(NSMutableDictionary<NSString *, NSString *> *__strong *cache, NSString *_Nullable contentKey, NSString *value)
+{
+  if (!contentKey) {
+    return;
+  }
+  os_unfair_lock_lock(&SignatureCacheLock);
+  if (!*cache) {
+    *cache = NSMutableDictionary.dictionary;
+  }
+  (*cache)[contentKey] = value;
+  os_unfair_lock_unlock(&SignatureCacheLock);
+}
+
 @interface FBCodesignProvider ()
 
 @property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
@@ -82,6 +153,7 @@ static NSString *const CDHashPrefix = @"CDHash=";
           failFuture];
       }
       [logger logFormat:@"Successfully signed bundle %@", task.stdErr];
+      SignatureCacheSet(&IdentityByContentKey, ContentKeyForBundle(bundlePath), self.identityName);
       return FBFuture.empty;
     }];
 }
@@ -113,28 +185,67 @@ static NSString *const CDHashPrefix = @"CDHash=";
 
 - (FBFuture<NSNull *> *)recursivelySignBundleAtPath:(NSString *)bundlePath
 {
-  NSMutableArray<NSString *> *pathsToSign = [NSMutableArray arrayWithObject:bundlePath];
+  return [[self signBundleTreeAtPath:bundlePath] mapReplace:NSNull.null];
+}
+
+- (FBFuture<NSNumber *> *)signBundleTreeAtPath:(NSString *)bundlePath
+{
+  NSError *error = nil;
+  NSArray<NSString *> *nestedPaths = [FBCodesignProvider nestedBundlePathsInBundle:bundlePath error:&error];
+  if (!nestedPaths) {
+    return [FBFuture futureWithError:error];
+  }
+
+  // A bundle's seal covers the signatures of the bundles nested within it, so those are signed first.
+  // Nested bundles at the same level don't depend on each other, so they are signed in parallel.
+  NSMutableArray<FBFuture<NSNumber *> * (^)(void)> *generators = NSMutableArray.array;
+  for (NSString *nestedPath in nestedPaths) {
+    [generators addObject:^{
+      return [self signBundleTreeAtPath:nestedPath];
+    }];
+  }
+  id<FBControlCoreLogger> logger = self.logger;
+  return [[FBFuture
+    futureWithFutureGenerators:generators maxConcurrency:NSProcessInfo.processInfo.activeProcessorCount]
+    onQueue:self.queue fmap:^ FBFuture<NSNumber *> * (NSArray<NSNumber *> *nestedResigned) {
+      // Skip bundles this process has already signed with the same identity, provided nothing nested within them has changed since.
+      if (![nestedResigned containsObject:@YES] && [SignatureCacheGet(&IdentityByContentKey, ContentKeyForBundle(bundlePath)) isEqualToString:self.identityName]) {
+        [logger logFormat:@"Bundle %@ is unchanged since it was signed with identity %@", bundlePath, self.identityName];
+        return [FBFuture futureWithResult:@NO];
+      }
+      return [[self signBundleAtPath:bundlePath] mapReplace:@YES];
+    }];
+}
+
++ (nullable NSArray<NSString *> *)nestedBundlePathsInBundle:(NSString *)bundlePath error:(NSError **)error
+{
+  NSMutableArray<NSString *> *nestedPaths = NSMutableArray.array;
   NSFileManager *fileManager = [NSFileManager defaultManager];
-  NSString *frameworksPath = [bundlePath stringByAppendingString:@"/Frameworks/"];
-  if ([fileManager fileExistsAtPath:frameworksPath]) {
-    NSError *fileSystemError;
-    for (NSString *frameworkPath in [fileManager contentsOfDirectoryAtPath:frameworksPath error:&fileSystemError]) {
-      [pathsToSign addObject:[frameworksPath stringByAppendingString:frameworkPath]];
+  for (NSString *directoryName in @[@"Frameworks", @"PlugIns"]) {
+    NSString *directoryPath = [bundlePath stringByAppendingPathComponent:directoryName];
+    if (![fileManager fileExistsAtPath:directoryPath]) {
+      continue;
     }
-    if (fileSystemError) {
-      return [FBControlCoreError failFutureWithError:fileSystemError];
+    NSArray<NSString *> *contents = [fileManager contentsOfDirectoryAtPath:directoryPath error:error];
+    if (!contents) {
+      return nil;
+    }
+    for (NSString *name in contents) {
+      [nestedPaths addObject:[directoryPath stringByAppendingPathComponent:name]];
     }
   }
-  NSMutableArray<FBFuture<NSNull *> *> *futures = [NSMutableArray array];
-  for (NSString *pathToSign in pathsToSign) {
-    [futures addObject:[self signBundleAtPath:pathToSign]];
-  }
-  return [[FBFuture futureWithFutures:futures] mapReplace:NSNull.null];
+  return nestedPaths;
 }
 
 - (FBFuture<NSString *> *)cdHashForBundleAtPath:(NSString *)bundlePath
 {
   id<FBControlCoreLogger> logger = self.logger;
+  NSString *contentKey = ContentKeyForBundle(bundlePath);
+  NSString *cachedCDHash = SignatureCacheGet(&CDHashByContentKey, contentKey);
+  if (cachedCDHash) {
+    [logger logFormat:@"Using cached hash %@ for unchanged bundle %@", cachedCDHash, bundlePath];
+    return [FBFuture futureWithResult:cachedCDHash];
+  }
   [logger logFormat:@"Obtaining CDHash for bundle at path %@", bundlePath];
   return [[[[[[FBProcessBuilder
     withLaunchPath:@"/usr/bin/codesign" arguments:@[@"-dvvvv", bundlePath]]
@@ -158,6 +269,7 @@ static NSString *const CDHashPrefix = @"CDHash=";
       }
       NSString *cdHash = [output substringWithRange:[result rangeAtIndex:1]];
       [logger logFormat:@"Successfully obtained hash %@ from bundle %@", cdHash, bundlePath];
+      SignatureCacheSet(&CDHashByContentKey, contentKey, cdHash);
       return [FBFuture futureWithResult:cdHash];
     }];
 }
@@ -11,6 +11,7 @@
 #import "FBControlCoreError.h"
 #import "FBProcessBuilder.h"
 #import "FBProvisioningProfileCommands.h"
+#import "FBStorageUtils.h"
 
 FBFileContainerKind const FBFileContainerKindApplication = @"application";
 FBFileContainerKind const FBFileContainerKindAuxillary = @"auxillary";
@@ -89,12 +90,12 @@ FBFileContainerKind const FBFileContainerKindWallpaper = @"wallpaper";
 
 - (BOOL)populateWithContentsOfHostPath:(NSString *)path error:(NSError **)error
 {
-  return [self.fileManager copyItemAtPath:path toPath:self.path error:error];
+  return [FBStorageUtils cloneItemAtPath:path toPath:self.path error:error];
 }
 
 - (BOOL)populateHostPathWithContents:(NSString *)path error:(NSError **)error
 {
-  return [self.fileManager copyItemAtPath:self.path toPath:path error:error];
+  return [FBStorageUtils cloneItemAtPath:self.path toPath:path error:error];
 }
 
 - (id<FBContainedFile>)fileByAppendingPathComponent:(NSString *)component error:(NSError **)error
@@ -209,7 +210,7 @@ FBFileContainerKind const FBFileContainerKindWallpaper = @"wallpaper";
   NSString *mappedPath = self.mappingPaths[firstComponent];
   if (!mappedPath) {
     return [[FBControlCoreError
-      describeFormat:@"'%@' is not a valid root path out of %@", firstComponent, [FBCollectionInformation oneLineDescriptionFromArray:self.mappingPaths.allKeys]]
+      describeFormat:@"'%@' is not a valid root path out of %@", firstComponent, [FBCollectionInformation lazyOneLineDescriptionFromArray:self.mappingPaths.allKeys]]
       fail:error];
   }
   id<FBContainedFile> mapped = [[FBContainedFile_Host alloc] initWithFileManager:self.fileManager path:mappedPath];
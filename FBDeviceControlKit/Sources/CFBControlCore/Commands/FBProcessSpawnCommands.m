@@ -50,11 +50,11 @@
     }];
 }
 
-+ (void)resolveProcessFinishedWithStatLoc:(int)statLoc inTeardownOfIOAttachment:(FBProcessIOAttachment *)attachment statLocFuture:(FBMutableFuture<NSNumber *> *)statLocFuture exitCodeFuture:(FBMutableFuture<NSNumber *> *)exitCodeFuture signalFuture:(FBMutableFuture<NSNumber *> *)signalFuture processIdentifier:(pid_t)processIdentifier configuration:(FBProcessSpawnConfiguration *)configuration queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger
++ (void)resolveProcessFinishedWithStatLoc:(int)statLoc inTeardownOfIOAttachment:(nullable FBProcessIOAttachment *)attachment statLocFuture:(FBMutableFuture<NSNumber *> *)statLocFuture exitCodeFuture:(FBMutableFuture<NSNumber *> *)exitCodeFuture signalFuture:(FBMutableFuture<NSNumber *> *)signalFuture processIdentifier:(pid_t)processIdentifier configuration:(FBProcessSpawnConfiguration *)configuration queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger
 {
   [logger logFormat:@"Process %d (%@) has exited, tearing down IO...", processIdentifier, configuration.processName];
-  [[attachment
-    detach]
+  // A process whose streams were all connected directly has no attachment to tear down.
+  [(attachment ? [attachment detach] : FBFuture.empty)
     onQueue:queue notifyOfCompletion:^(id _) {
       [logger logFormat:@"Teardown of IO for process %d (%@) has completed", processIdentifier, configuration.processName];
       [statLocFuture resolveWithResult:@(statLoc)];
@@ -14,13 +14,102 @@
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Warc-performSelector-leaks"
 
+/**
+ The classes that respond to each selector and the protocols that are adopted, for a list of command classes.
+ This is built once for each list, then only read, so lookups don't take a lock.
+ */
+@interface FBiOSTargetCommandForwarder_DispatchTable : NSObject
+
+@property (nonatomic, assign, readonly) CFDictionaryRef classesBySelector;
+@property (nonatomic, copy, readonly) NSSet<Protocol *> *protocols;
+
+@end
+
+@implementation FBiOSTargetCommandForwarder_DispatchTable
+
++ (instancetype)tableForCommandClasses:(NSArray<Class> *)commandClasses
+{
+  static dispatch_once_t onceToken;
+  static NSMutableDictionary<NSArray<Class> *, FBiOSTargetCommandForwarder_DispatchTable *> *tables;
+  dispatch_once(&onceToken, ^{
+    tables = NSMutableDictionary.dictionary;
+  });
+  @synchronized (tables) {
+    FBiOSTargetCommandForwarder_DispatchTable *table = tables[commandClasses];
+    if (!table) {
+      table = [[self alloc] initWithCommandClasses:commandClasses];
+      tables[commandClasses] = table;
+    }
+    return table;
+  }
+}
+
+- (instancetype)initWithCommandClasses:(NSArray<Class> *)commandClasses
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  // Classes are never deallocated, so neither keys nor values need to be retained.
+  CFMutableDictionaryRef classesBySelector = CFDictionaryCreateMutable(NULL, 0, NULL, NULL);
+  NSMutableSet<Protocol *> *protocols = NSMutableSet.set;
+  for (Class commandClass in commandClasses) {
+    NSParameterAssert([commandClass conformsToProtocol:@protocol(FBiOSTargetCommand)]);
+    // Earlier classes take precedence, as they did when each class was asked in turn.
+    for (Class class = commandClass; class && class != NSObject.class; class = class_getSuperclass(class)) {
+      unsigned int methodCount = 0;
+      Method *methods = class_copyMethodList(class, &methodCount);
+      for (unsigned int index = 0; index < methodCount; index++) {
+        SEL selector = method_getName(methods[index]);
+        if (!CFDictionaryContainsKey(classesBySelector, selector)) {
+          CFDictionarySetValue(classesBySelector, selector, (__bridge const void *) commandClass);
+        }
+      }
+      free(methods);
+      unsigned int protocolCount = 0;
+      Protocol * __unsafe_unretained *adopted = class_copyProtocolList(class, &protocolCount);
+      for (unsigned int index = 0; index < protocolCount; index++) {
+        [self.class addProtocol:adopted[index] toSet:protocols];
+      }
+      free(adopted);
+    }
+  }
+  _classesBySelector = CFDictionaryCreateCopy(NULL, classesBySelector);
+  CFRelease(classesBySelector);
+  _protocols = [protocols copy];
+
+  return self;
+}
+
+- (void)dealloc
+{
+  CFRelease(_classesBySelector);
+}
+
++ (void)addProtocol:(Protocol *)protocol toSet:(NSMutableSet<Protocol *> *)protocols
+{
+  if ([protocols containsObject:protocol]) {
+    return;
+  }
+  [protocols addObject:protocol];
+  unsigned int count = 0;
+  Protocol * __unsafe_unretained *inherited = protocol_copyProtocolList(protocol, &count);
+  for (unsigned int index = 0; index < count; index++) {
+    [self addProtocol:inherited[index] toSet:protocols];
+  }
+  free(inherited);
+}
+
+@end
+
 @interface FBiOSTargetCommandForwarder ()
 
 @property (nonatomic, weak, readonly) id<FBiOSTarget> target;
-@property (nonatomic, copy, readonly) NSArray<Class> *commandClasses;
+@property (nonatomic, strong, readonly) FBiOSTargetCommandForwarder_DispatchTable *dispatchTable;
 @property (nonatomic, strong, readonly) NSSet<Class> *statefulCommands; // Stateful command objects that need to be memoized.
 
-@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, id> *memoizedCommands;
+@property (nonatomic, strong, readonly) NSMapTable<Class, id> *memoizedCommands;
 
 @end
 
@@ -42,9 +131,9 @@
   }
 
   _target = target;
-  _commandClasses = commandClasses;
+  _dispatchTable = [FBiOSTargetCommandForwarder_DispatchTable tableForCommandClasses:commandClasses];
   _statefulCommands = statefulCommands;
-  _memoizedCommands = [NSMutableDictionary dictionary];
+  _memoizedCommands = NSMapTable.strongToStrongObjectsMapTable;
 
   return self;
 }
@@ -53,20 +142,13 @@
 
 - (BOOL)respondsToSelector:(SEL)selector
 {
-  for (Class class in self.commandClasses) {
-    if ([class instancesRespondToSelector:selector]) {
-      return YES;
-    }
-  }
-  return NO;
+  return CFDictionaryContainsKey(self.dispatchTable.classesBySelector, selector);
 }
 
 - (id)forwardingTargetForSelector:(SEL)selector
 {
-  for (Class class in self.commandClasses) {
-    if (![class instancesRespondToSelector:selector]) {
-      continue;
-    }
+  Class class = (__bridge Class) CFDictionaryGetValue(self.dispatchTable.classesBySelector, selector);
+  if (class) {
     return [self obtainCommandForClass:class];
   }
   return [super forwardingTargetForSelector:selector];
@@ -74,21 +156,21 @@
 
 - (id<FBiOSTargetCommand>)obtainCommandForClass:(Class)class
 {
-  NSString *key = NSStringFromClass(class);
-  if (self.memoizedCommands[key]){
-    return self.memoizedCommands[key];
+  if (![self.statefulCommands containsObject:class]) {
+    return [self createCommandForClass:class];
   }
-
-  id instance = [self createCommandForClass:class];
-  if ([self.statefulCommands containsObject:class]) {
-    self.memoizedCommands[key] = instance;
+  @synchronized (self.memoizedCommands) {
+    id instance = [self.memoizedCommands objectForKey:class];
+    if (!instance) {
+      instance = [self createCommandForClass:class];
+      [self.memoizedCommands setObject:instance forKey:class];
+    }
+    return instance;
   }
-  return instance;
 }
 
 - (id<FBiOSTargetCommand>)createCommandForClass:(Class)class
 {
-  NSParameterAssert([class conformsToProtocol:@protocol(FBiOSTargetCommand)]);
   return [class commandsWithTarget:self.target];
 }
 
@@ -97,13 +179,7 @@
   if ([super conformsToProtocol:protocol]) {
     return YES;
   }
-  for (Class class in self.commandClasses) {
-    id command = [self obtainCommandForClass:class];
-    if ([command conformsToProtocol:protocol]) {
-      return YES;
-    }
-  }
-  return NO;
+  return [self.dispatchTable.protocols containsObject:protocol];
 }
 
 @end
@@ -12,10 +12,37 @@
 #import "FBCollectionOperations.h"
 
 FBVideoStreamEncoding const FBVideoStreamEncodingH264 = @"h264";
+FBVideoStreamEncoding const FBVideoStreamEncodingHEVC = @"hevc";
 FBVideoStreamEncoding const FBVideoStreamEncodingBGRA = @"bgra";
 FBVideoStreamEncoding const FBVideoStreamEncodingMJPEG = @"mjpeg";
 FBVideoStreamEncoding const FBVideoStreamEncodingMinicap = @"minicap";
 
+static NSString *FBVideoStreamBackpressurePolicyDescription(FBVideoStreamBackpressurePolicy policy)
+{
+  switch (policy) {
+    case FBVideoStreamBackpressurePolicyDropNewest:
+      return @"drop-newest";
+    case FBVideoStreamBackpressurePolicyDropOldest:
+      return @"drop-oldest";
+    case FBVideoStreamBackpressurePolicyPreserveKeyFrames:
+      return @"preserve-key-frames";
+  }
+  return @"unknown";
+}
+
+static NSString *FBVideoStreamPixelFormatDescription(FBVideoStreamPixelFormat pixelFormat)
+{
+  switch (pixelFormat) {
+    case FBVideoStreamPixelFormatBGRA:
+      return @"BGRA";
+    case FBVideoStreamPixelFormat420VideoRange:
+      return @"420v";
+    case FBVideoStreamPixelFormat420FullRange:
+      return @"420f";
+  }
+  return @"unknown";
+}
+
 @implementation FBVideoStreamConfiguration
 
 #pragma mark Initializers
@@ -33,10 +60,72 @@ FBVideoStreamEncoding const FBVideoStreamEncodingMinicap = @"minicap";
   _scaleFactor = scaleFactor;
   _avgBitrate = avgBitrate;
   _keyFrameRate = keyFrameRate ?: @10.0;
+  _realtime = YES;
+  _lowLatencyRateControl = NO;
+  _backpressurePolicy = FBVideoStreamBackpressurePolicyDropNewest;
+  _maxPendingFrames = 2;
+  _matchDisplayRefreshRate = NO;
+  _pixelFormat = FBVideoStreamPixelFormatBGRA;
+  _maxDimension = nil;
+  _framedOutput = NO;
 
   return self;
 }
 
+- (instancetype)withRealtime:(BOOL)realtime lowLatencyRateControl:(BOOL)lowLatencyRateControl
+{
+  FBVideoStreamConfiguration *configuration = [self duplicate];
+  configuration->_realtime = realtime;
+  configuration->_lowLatencyRateControl = lowLatencyRateControl;
+  return configuration;
+}
+
+- (instancetype)withBackpressurePolicy:(FBVideoStreamBackpressurePolicy)backpressurePolicy maxPendingFrames:(NSUInteger)maxPendingFrames
+{
+  FBVideoStreamConfiguration *configuration = [self duplicate];
+  configuration->_backpressurePolicy = backpressurePolicy;
+  configuration->_maxPendingFrames = maxPendingFrames;
+  return configuration;
+}
+
+- (instancetype)withFramesPerSecondMatchingDisplayRefreshRate:(BOOL)matchDisplayRefreshRate
+{
+  FBVideoStreamConfiguration *configuration = [self duplicate];
+  configuration->_matchDisplayRefreshRate = matchDisplayRefreshRate;
+  return configuration;
+}
+
+- (instancetype)withPixelFormat:(FBVideoStreamPixelFormat)pixelFormat maxDimension:(nullable NSNumber *)maxDimension
+{
+  FBVideoStreamConfiguration *configuration = [self duplicate];
+  configuration->_pixelFormat = pixelFormat;
+  configuration->_maxDimension = maxDimension;
+  return configuration;
+}
+
+- (instancetype)withFramedOutput:(BOOL)framedOutput
+{
+  FBVideoStreamConfiguration *configuration = [self duplicate];
+  configuration->_framedOutput = framedOutput;
+  return configuration;
+}
+
+#pragma mark Private
+
+- (instancetype)duplicate
+{
+  FBVideoStreamConfiguration *configuration = [[FBVideoStreamConfiguration alloc] initWithEncoding:self.encoding framesPerSecond:self.framesPerSecond compressionQuality:self.compressionQuality scaleFactor:self.scaleFactor avgBitrate:self.avgBitrate keyFrameRate:self.keyFrameRate];
+  configuration->_realtime = self.realtime;
+  configuration->_lowLatencyRateControl = self.lowLatencyRateControl;
+  configuration->_backpressurePolicy = self.backpressurePolicy;
+  configuration->_maxPendingFrames = self.maxPendingFrames;
+  configuration->_matchDisplayRefreshRate = self.matchDisplayRefreshRate;
+  configuration->_pixelFormat = self.pixelFormat;
+  configuration->_maxDimension = self.maxDimension;
+  configuration->_framedOutput = self.framedOutput;
+  return configuration;
+}
+
 #pragma mark NSCopying
 
 - (instancetype)copyWithZone:(NSZone *)zone
@@ -58,24 +147,40 @@ FBVideoStreamEncoding const FBVideoStreamEncodingMinicap = @"minicap";
       && (self.compressionQuality == object.compressionQuality || [self.compressionQuality isEqualToNumber:object.compressionQuality])
       && (self.scaleFactor == object.scaleFactor || [self.scaleFactor isEqualToNumber:object.scaleFactor])
       && (self.avgBitrate == object.avgBitrate || [self.avgBitrate isEqualToNumber:object.avgBitrate])
-      && (self.keyFrameRate == object.keyFrameRate || [self.keyFrameRate isEqualToNumber:object.keyFrameRate]);
+      && (self.keyFrameRate == object.keyFrameRate || [self.keyFrameRate isEqualToNumber:object.keyFrameRate])
+      && self.realtime == object.realtime
+      && self.lowLatencyRateControl == object.lowLatencyRateControl
+      && self.backpressurePolicy == object.backpressurePolicy
+      && self.maxPendingFrames == object.maxPendingFrames
+      && self.matchDisplayRefreshRate == object.matchDisplayRefreshRate
+      && self.pixelFormat == object.pixelFormat
+      && (self.maxDimension == object.maxDimension || [self.maxDimension isEqualToNumber:object.maxDimension])
+      && self.framedOutput == object.framedOutput;
 }
 
 - (NSUInteger)hash
 {
-  return self.encoding.hash ^ self.framesPerSecond.hash ^ self.compressionQuality.hash ^ self.scaleFactor.hash ^ self.avgBitrate.hash ^ self.keyFrameRate.hash;
+  return self.encoding.hash ^ self.framesPerSecond.hash ^ self.compressionQuality.hash ^ self.scaleFactor.hash ^ self.avgBitrate.hash ^ self.keyFrameRate.hash ^ (NSUInteger) self.realtime ^ ((NSUInteger) self.lowLatencyRateControl << 1) ^ (self.backpressurePolicy << 2) ^ (self.maxPendingFrames << 4) ^ ((NSUInteger) self.matchDisplayRefreshRate << 3) ^ (self.pixelFormat << 6) ^ self.maxDimension.hash ^ ((NSUInteger) self.framedOutput << 8);
 }
 
 - (NSString *)description
 {
   return [NSString stringWithFormat:
-    @"Encoding %@ | FPS %@ | Quality %@ | Scale %@ | Avg Bitrate %@ | Key frame rate %@",
+    @"Encoding %@ | FPS %@%@ | Quality %@ | Scale %@ | Max dimension %@ | Pixel format %@ | Avg Bitrate %@ | Key frame rate %@ | Realtime %@ | Low latency %@ | Backpressure %@ | Max pending %lu | Framed %@",
     self.encoding,
     self.framesPerSecond,
+    self.matchDisplayRefreshRate ? @" (display refresh rate)" : @"",
     self.compressionQuality,
     self.scaleFactor,
+    self.maxDimension,
+    FBVideoStreamPixelFormatDescription(self.pixelFormat),
     self.avgBitrate,
-    self.keyFrameRate
+    self.keyFrameRate,
+    self.realtime ? @"Yes" : @"No",
+    self.lowLatencyRateControl ? @"Yes" : @"No",
+    FBVideoStreamBackpressurePolicyDescription(self.backpressurePolicy),
+    (unsigned long) self.maxPendingFrames,
+    self.framedOutput ? @"Yes" : @"No"
   ];
 }
 
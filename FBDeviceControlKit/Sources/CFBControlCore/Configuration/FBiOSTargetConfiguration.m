@@ -9,6 +9,9 @@
 
 #import "FBArchitecture.h"
 
+#import <os/lock.h>
+#import <stdlib.h>
+
 FBDeviceModel const FBDeviceModeliPhone4s = @"iPhone 4s";
 FBDeviceModel const FBDeviceModeliPhone5 = @"iPhone 5";
 FBDeviceModel const FBDeviceModeliPhone5c = @"iPhone 5c";
@@ -287,31 +290,6 @@ FBOSVersionName const FBOSVersionNamemac = @"macOS";
 
 #pragma mark Helpers
 
-+ (instancetype)iPhoneWithModel:(FBDeviceModel)model productType:(NSString *)productType deviceArchitecture:(FBArchitecture)deviceArchitecture
-{
-  return [self iPhoneWithModel:model productTypes:@[productType] deviceArchitecture:deviceArchitecture];
-}
-
-+ (instancetype)iPhoneWithModel:(FBDeviceModel)model productTypes:(NSArray<NSString *> *)productTypes deviceArchitecture:(FBArchitecture)deviceArchitecture
-{
-  return [[self alloc] initWithModel:model productTypes:[NSSet setWithArray:productTypes] deviceArchitecture:deviceArchitecture family:FBControlCoreProductFamilyiPhone];
-}
-
-+ (instancetype)iPadWithModel:(FBDeviceModel)model productTypes:(NSArray<NSString *> *)productTypes deviceArchitecture:(FBArchitecture)deviceArchitecture
-{
-  return [[self alloc] initWithModel:model productTypes:[NSSet setWithArray:productTypes] deviceArchitecture:deviceArchitecture family:FBControlCoreProductFamilyiPad];
-}
-
-+ (instancetype)tvWithModel:(FBDeviceModel)model productTypes:(NSArray<NSString *> *)productTypes deviceArchitecture:(FBArchitecture)deviceArchitecture
-{
-  return [[self alloc] initWithModel:model productTypes:[NSSet setWithArray:productTypes] deviceArchitecture:deviceArchitecture family:FBControlCoreProductFamilyAppleTV];
-}
-
-+ (instancetype)watchWithModel:(FBDeviceModel)model productTypes:(NSArray<NSString *> *)productTypes deviceArchitecture:(FBArchitecture)deviceArchitecture
-{
-  return [[self alloc] initWithModel:model productTypes:[NSSet setWithArray:productTypes] deviceArchitecture:deviceArchitecture family:FBControlCoreProductFamilyAppleWatch];
-}
-
 + (instancetype)genericWithModel:(NSString *)model
 {
   return [[self alloc] initWithModel:model productTypes:[NSSet set] deviceArchitecture:FBArchitectureArm64 family:FBControlCoreProductFamilyUnknown];
@@ -452,220 +430,413 @@ FBOSVersionName const FBOSVersionNamemac = @"macOS";
 
 @end
 
-@implementation FBiOSTargetConfiguration
+#pragma mark Tables
+
+// The device types and OS versions are plain C data, so that nothing is allocated until a lookup needs it. The ObjC wrappers are created for an entry on first use.
+// The tables are searched through indices that are sorted by key, with binary search. Duplicated keys resolve to the last entry in table order.
+
+enum {
+  MaxProductTypesPerDevice = 6,
+};
+
+typedef struct {
+  FBDeviceModel const *model;
+  FBControlCoreProductFamily family;
+  FBArchitecture const *architecture;
+  NSString *__unsafe_unretained productTypes[MaxProductTypesPerDevice + 1];
+} FBDeviceTypeDescriptor;
+
+typedef NS_ENUM(NSUInteger, FBOSVersionPlatform) {
+  FBOSVersionPlatformiOS,
+  FBOSVersionPlatformtvOS,
+  FBOSVersionPlatformwatchOS,
+  FBOSVersionPlatformmacOS,
+};
+
+typedef struct {
+  FBOSVersionName const *name;
+  FBOSVersionPlatform platform;
+} FBOSVersionDescriptor;
+
+typedef struct {
+  NSString *__unsafe_unretained key;
+  NSUInteger index;
+} FBLookupIndexEntry;
+
+typedef struct {
+  FBLookupIndexEntry *entries;
+  NSUInteger count;
+} FBLookupIndex;
+
+static const FBDeviceTypeDescriptor DeviceTypeDescriptors[] = {
+  {&FBDeviceModeliPhone4s, FBControlCoreProductFamilyiPhone, &FBArchitectureArmv7, {@"iPhone4,1"}},
+  {&FBDeviceModeliPhone5, FBControlCoreProductFamilyiPhone, &FBArchitectureArmv7s, {@"iPhone5,1", @"iPhone5,2"}},
+  {&FBDeviceModeliPhone5c, FBControlCoreProductFamilyiPhone, &FBArchitectureArmv7s, {@"iPhone5,3"}},
+  {&FBDeviceModeliPhone5s, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone6,1", @"iPhone6,2"}},
+  {&FBDeviceModeliPhone6, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone7,2"}},
+  {&FBDeviceModeliPhone6Plus, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone7,1"}},
+  {&FBDeviceModeliPhone6S, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone8,1"}},
+  {&FBDeviceModeliPhone6SPlus, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone8,2"}},
+  {&FBDeviceModeliPhoneSE_1stGeneration, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone8,4"}},
+  {&FBDeviceModeliPhoneSE_2ndGeneration, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone12,8"}},
+  {&FBDeviceModeliPhone7, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone9,1", @"iPhone9,2", @"iPhone9,3"}},
+  {&FBDeviceModeliPhone7Plus, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone9,2", @"iPhone9,4"}},
+  {&FBDeviceModeliPhone8, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone10,1", @"iPhone10,4"}},
+  {&FBDeviceModeliPhone8Plus, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone10,2", @"iPhone10,5"}},
+  {&FBDeviceModeliPhoneX, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone10,3", @"iPhone10,6"}},
+  {&FBDeviceModeliPhoneXs, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone11,2"}},
+  {&FBDeviceModeliPhoneXsMax, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone11,6"}},
+  {&FBDeviceModeliPhoneXr, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone11,8"}},
+  {&FBDeviceModeliPhone11, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone12,1"}},
+  {&FBDeviceModeliPhone11Pro, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone12,3"}},
+  {&FBDeviceModeliPhone11ProMax, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone12,5"}},
+  {&FBDeviceModeliPhone12mini, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone13,1"}},
+  {&FBDeviceModeliPhone12, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone13,2"}},
+  {&FBDeviceModeliPhone12Pro, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone13,3"}},
+  {&FBDeviceModeliPhone12ProMax, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone13,4"}},
+  {&FBDeviceModeliPhone13mini, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone14,4"}},
+  {&FBDeviceModeliPhone13, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone14,5"}},
+  {&FBDeviceModeliPhone13Pro, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone14,2"}},
+  {&FBDeviceModeliPhone13ProMax, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone14,3"}},
+  {&FBDeviceModeliPhone14, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone14,7"}},
+  {&FBDeviceModeliPhone14Plus, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone14,8"}},
+  {&FBDeviceModeliPhone14Pro, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone15,2"}},
+  {&FBDeviceModeliPhone14ProMax, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone15,3"}},
+  {&FBDeviceModeliPhone15, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone15,4"}},
+  {&FBDeviceModeliPhone15Plus, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone15,5"}},
+  {&FBDeviceModeliPhone15Pro, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone16,1"}},
+  {&FBDeviceModeliPhone15ProMax, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone16,2"}},
+  {&FBDeviceModeliPhone16, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone17,3"}},
+  {&FBDeviceModeliPhone16Plus, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone17,4"}},
+  {&FBDeviceModeliPhone16Pro, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone17,1"}},
+  {&FBDeviceModeliPhone16ProMax, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone17,2"}},
+  {&FBDeviceModeliPhone16e, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone17,5"}},
+  {&FBDeviceModeliPhone17, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone18,3"}},
+  {&FBDeviceModeliPhone17Pro, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone18,1"}},
+  {&FBDeviceModeliPhone17ProMax, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPhone18,2"}},
+  {&FBDeviceModeliPodTouch_7thGeneration, FBControlCoreProductFamilyiPhone, &FBArchitectureArm64, {@"iPod9,1"}},
+  {&FBDeviceModeliPad2, FBControlCoreProductFamilyiPad, &FBArchitectureArmv7, {@"iPad2,1", @"iPad2,2", @"iPad2,3", @"iPad2,4"}},
+  {&FBDeviceModeliPadRetina, FBControlCoreProductFamilyiPad, &FBArchitectureArmv7, {@"iPad3,1", @"iPad3,2", @"iPad3,3", @"iPad3,4", @"iPad3,5", @"iPad3,6"}},
+  {&FBDeviceModeliPadAir, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad4,1", @"iPad4,2", @"iPad4,3"}},
+  {&FBDeviceModeliPadAir2, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad5,3", @"iPad5,4"}},
+  {&FBDeviceModeliPadAir_3rdGeneration, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad11,3", @"iPad11,4"}},
+  {&FBDeviceModeliPadAir_4thGeneration, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad13,1", @"iPad13,2"}},
+  {&FBDeviceModeliPadPro, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad6,7", @"iPad6,8", @"iPad6,3", @"iPad6,4"}},
+  {&FBDeviceModeliPadPro_9_7_Inch, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad6,3", @"iPad6,4"}},
+  {&FBDeviceModeliPadPro_12_9_Inch, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad6,7", @"iPad6,8"}},
+  {&FBDeviceModeliPad_5thGeneration, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad6,11", @"iPad6,12"}},
+  {&FBDeviceModeliPadPro_12_9_Inch_2ndGeneration, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad7,1", @"iPad7,2"}},
+  {&FBDeviceModeliPadPro_10_5_Inch, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad7,3", @"iPad7,4"}},
+  {&FBDeviceModeliPad_6thGeneration, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad7,5", @"iPad7,6"}},
+  {&FBDeviceModeliPad_7thGeneration, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad7,11", @"iPad7,12"}},
+  {&FBDeviceModeliPad_8thGeneration, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad11,6", @"iPad11,7"}},
+  {&FBDeviceModeliPadPro_12_9_Inch_3rdGeneration, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad8,5", @"iPad8,6", @"iPad8,7", @"iPad8,8"}},
+  {&FBDeviceModeliPadPro_12_9_Inch_4thGeneration, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad8,11", @"iPad8,12"}},
+  {&FBDeviceModeliPadPro_11_Inch_1stGeneration, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad8,1", @"iPad8,2", @"iPad8,3", @"iPad8,4"}},
+  {&FBDeviceModeliPadPro_12_9nch_1stGeneration, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad8,11", @"iPad8,12"}},
+  {&FBDeviceModeliPadPro_12_9nch_5thGeneration, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad13,8", @"iPad13,9", @"iPad13,10", @"iPad13,11"}},
+  {&FBDeviceModeliPadPro_11_Inch_2ndGeneration, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad8,9", @"iPad8,10"}},
+  {&FBDeviceModeliPadPro_11_Inch_3ndGeneration, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad13,4", @"iPad13,5", @"iPad13,6", @"iPad13,7"}},
+  {&FBDeviceModeliPadMini_2, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad4,4", @"iPad4,5", @"iPad4,6"}},
+  {&FBDeviceModeliPadMini_3, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad4,7", @"iPad4,8", @"iPad4,9"}},
+  {&FBDeviceModeliPadMini_4, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad5,1", @"iPad5,2"}},
+  {&FBDeviceModeliPadMini_5, FBControlCoreProductFamilyiPad, &FBArchitectureArm64, {@"iPad11,1", @"iPad11,2"}},
+  {&FBDeviceModelAppleTV, FBControlCoreProductFamilyAppleTV, &FBArchitectureArm64, {@"AppleTV5,3"}},
+  {&FBDeviceModelAppleTV4K, FBControlCoreProductFamilyAppleTV, &FBArchitectureArm64, {@"AppleTV6,2"}},
+  {&FBDeviceModelAppleTV4KAt1080p, FBControlCoreProductFamilyAppleTV, &FBArchitectureArm64, {@"AppleTV6,2"}},
+  {&FBDeviceModelAppleTV4K_2ndGeneration, FBControlCoreProductFamilyAppleTV, &FBArchitectureArm64, {@"AppleTV11,1"}},
+  {&FBDeviceModelAppleTV4KAt1080p_2ndGeneration, FBControlCoreProductFamilyAppleTV, &FBArchitectureArm64, {@"AppleTV11,1"}},
+  {&FBDeviceModelAppleWatch38mm, FBControlCoreProductFamilyAppleWatch, &FBArchitectureArmv7, {@"Watch1,1"}},
+  {&FBDeviceModelAppleWatch42mm, FBControlCoreProductFamilyAppleWatch, &FBArchitectureArmv7, {@"Watch1,2"}},
+  {&FBDeviceModelAppleWatchSE_40mm, FBControlCoreProductFamilyAppleWatch, &FBArchitectureArmv7, {@"Watch1,1"}},
+  {&FBDeviceModelAppleWatchSE_44mm, FBControlCoreProductFamilyAppleWatch, &FBArchitectureArmv7, {@"Watch1,2"}},
+  {&FBDeviceModelAppleWatchSeries2_38mm, FBControlCoreProductFamilyAppleWatch, &FBArchitectureArmv7, {@"Watch2,1"}},
+  {&FBDeviceModelAppleWatchSeries2_42mm, FBControlCoreProductFamilyAppleWatch, &FBArchitectureArmv7, {@"Watch2,2"}},
+  {&FBDeviceModelAppleWatchSeries3_38mm, FBControlCoreProductFamilyAppleWatch, &FBArchitectureArmv7, {@"Watch3,1"}},
+  {&FBDeviceModelAppleWatchSeries3_42mm, FBControlCoreProductFamilyAppleWatch, &FBArchitectureArmv7, {@"Watch3,2"}},
+  {&FBDeviceModelAppleWatchSeries4_40mm, FBControlCoreProductFamilyAppleWatch, &FBArchitectureArm64, {@"Watch4,1", @"Watch4,3"}},
+  {&FBDeviceModelAppleWatchSeries4_44mm, FBControlCoreProductFamilyAppleWatch, &FBArchitectureArm64, {@"Watch4,2", @"Watch4,4"}},
+  {&FBDeviceModelAppleWatchSeries5_40mm, FBControlCoreProductFamilyAppleWatch, &FBArchitectureArm64, {@"Watch5,1", @"Watch5,3"}},
+  {&FBDeviceModelAppleWatchSeries5_44mm, FBControlCoreProductFamilyAppleWatch, &FBArchitectureArm64, {@"Watch5,2", @"Watch5,4"}},
+  {&FBDeviceModelAppleWatchSeries6_40mm, FBControlCoreProductFamilyAppleWatch, &FBArchitectureArm64, {@"Watch6,1", @"Watch6,3"}},
+  {&FBDeviceModelAppleWatchSeries6_44mm, FBControlCoreProductFamilyAppleWatch, &FBArchitectureArm64, {@"Watch6,2", @"Watch6,4"}},
+};
+
+static const NSUInteger DeviceTypeCount = sizeof(DeviceTypeDescriptors) / sizeof(DeviceTypeDescriptors[0]);
+
+static const FBOSVersionDescriptor OSVersionDescriptors[] = {
+  {&FBOSVersionNameiOS_7_1, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_8_0, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_8_1, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_8_2, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_8_3, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_8_4, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_9_0, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_9_1, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_9_2, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_9_3, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_9_3_1, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_9_3_2, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_10_0, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_10_1, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_10_2, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_10_2_1, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_10_3, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_10_3_1, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_11_0, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_11_1, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_11_2, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_11_3, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_11_4, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_11_4, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_12_0, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_12_1, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_12_2, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_12_4, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_13_0, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_13_1, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_13_2, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_13_3, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_13_4, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_13_5, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_13_6, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_13_7, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_14_0, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_14_1, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_14_2, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_14_3, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_14_4, FBOSVersionPlatformiOS},
+  {&FBOSVersionNameiOS_14_5, FBOSVersionPlatformiOS},
+  {&FBOSVersionNametvOS_9_0, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_9_1, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_9_2, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_10_0, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_10_1, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_10_2, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_11_0, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_11_1, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_11_2, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_11_3, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_11_4, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_12_0, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_12_1, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_12_2, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_12_4, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_13_0, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_13_2, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_13_3, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_13_4, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_14_0, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_14_1, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_14_2, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_14_3, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNametvOS_14_5, FBOSVersionPlatformtvOS},
+  {&FBOSVersionNamewatchOS_2_0, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_2_1, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_2_2, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_3_0, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_3_1, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_3_2, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_4_0, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_4_1, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_4_2, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_5_0, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_5_1, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_5_2, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_5_3, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_6_0, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_6_1, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_6_2, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_7_0, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_7_1, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_7_2, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamewatchOS_7_4, FBOSVersionPlatformwatchOS},
+  {&FBOSVersionNamemac, FBOSVersionPlatformmacOS},
+};
+
+static const NSUInteger OSVersionCount = sizeof(OSVersionDescriptors) / sizeof(OSVersionDescriptors[0]);
+
+static NSComparisonResult CompareLookupKeys(NSString *left, NSString *right)
+{
+  return [left compare:right options:NSLiteralSearch];
+}
+
+// Sorts the entries by key, then by table order, and drops all but the last entry for each key.
+static FBLookupIndex MakeLookupIndex(FBLookupIndexEntry *entries, NSUInteger count)
+{
+  qsort_b(entries, count, sizeof(FBLookupIndexEntry), ^int(const void *leftPointer, const void *rightPointer) {
+    const FBLookupIndexEntry *left = leftPointer;
+    const FBLookupIndexEntry *right = rightPointer;
+    NSComparisonResult result = CompareLookupKeys(left->key, right->key);
+    if (result != NSOrderedSame) {
+      return (int) result;
+    }
+    return left->index < right->index ? -1 : (left->index > right->index ? 1 : 0);
+  });
+  NSUInteger uniqueCount = 0;
+  for (NSUInteger position = 0; position < count; position++) {
+    if (position + 1 < count && CompareLookupKeys(entries[position].key, entries[position + 1].key) == NSOrderedSame) {
+      continue;
+    }
+    entries[uniqueCount++] = entries[position];
+  }
+  return (FBLookupIndex) {.entries = entries, .count = uniqueCount};
+}
 
-#pragma mark Lookup Tables
+static NSUInteger LookupIndexFind(FBLookupIndex lookupIndex, NSString *key)
+{
+  if (!key) {
+    return NSNotFound;
+  }
+  NSUInteger lower = 0;
+  NSUInteger upper = lookupIndex.count;
+  while (lower < upper) {
+    NSUInteger middle = lower + (upper - lower) / 2;
+    NSComparisonResult result = CompareLookupKeys(lookupIndex.entries[middle].key, key);
+    if (result == NSOrderedSame) {
+      return lookupIndex.entries[middle].index;
+    }
+    if (result == NSOrderedAscending) {
+      lower = middle + 1;
+    } else {
+      upper = middle;
+    }
+  }
+  return NSNotFound;
+}
+
+static FBLookupIndex ProductTypeIndex(void)
+{
+  static dispatch_once_t onceToken;
+  static FBLookupIndex lookupIndex;
+  dispatch_once(&onceToken, ^{
+    NSUInteger count = 0;
+    for (NSUInteger index = 0; index < DeviceTypeCount; index++) {
+      for (NSUInteger typeIndex = 0; DeviceTypeDescriptors[index].productTypes[typeIndex]; typeIndex++) {
+        count++;
+      }
+    }
+    FBLookupIndexEntry *entries = calloc(count, sizeof(FBLookupIndexEntry));
+    NSUInteger position = 0;
+    for (NSUInteger index = 0; index < DeviceTypeCount; index++) {
+      for (NSUInteger typeIndex = 0; DeviceTypeDescriptors[index].productTypes[typeIndex]; typeIndex++) {
+        entries[position++] = (FBLookupIndexEntry) {.key = DeviceTypeDescriptors[index].productTypes[typeIndex], .index = index};
+      }
+    }
+    lookupIndex = MakeLookupIndex(entries, count);
+  });
+  return lookupIndex;
+}
 
-+ (NSArray<FBDeviceType *> *)deviceConfigurations
+static FBLookupIndex DeviceModelIndex(void)
 {
   static dispatch_once_t onceToken;
-  static NSArray<FBDeviceType *> *deviceConfigurations;
+  static FBLookupIndex lookupIndex;
   dispatch_once(&onceToken, ^{
-    deviceConfigurations = @[
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone4s productType:@"iPhone4,1" deviceArchitecture:FBArchitectureArmv7],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone5 productTypes:@[@"iPhone5,1", @"iPhone5,2"] deviceArchitecture:FBArchitectureArmv7s],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone5c productTypes:@[@"iPhone5,3"] deviceArchitecture:FBArchitectureArmv7s],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone5s productTypes:@[@"iPhone6,1", @"iPhone6,2"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone6 productType:@"iPhone7,2" deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone6Plus productType:@"iPhone7,1" deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone6S productType:@"iPhone8,1" deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone6SPlus productType:@"iPhone8,2" deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhoneSE_1stGeneration productType:@"iPhone8,4" deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhoneSE_2ndGeneration productType:@"iPhone12,8" deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone7 productTypes:@[@"iPhone9,1", @"iPhone9,2", @"iPhone9,3"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone7Plus productTypes:@[@"iPhone9,2", @"iPhone9,4"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone8 productTypes:@[@"iPhone10,1", @"iPhone10,4"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone8Plus productTypes:@[@"iPhone10,2", @"iPhone10,5"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhoneX productTypes:@[@"iPhone10,3", @"iPhone10,6"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhoneXs productTypes:@[@"iPhone11,2"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhoneXsMax productTypes:@[@"iPhone11,6"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhoneXr productTypes:@[@"iPhone11,8"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone11 productTypes:@[@"iPhone12,1"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone11Pro productTypes:@[@"iPhone12,3"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone11ProMax productTypes:@[@"iPhone12,5"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone12mini productTypes:@[@"iPhone13,1"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone12 productTypes:@[@"iPhone13,2"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone12Pro productTypes:@[@"iPhone13,3"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone12ProMax productTypes:@[@"iPhone13,4"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone13mini productTypes:@[@"iPhone14,4"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone13 productTypes:@[@"iPhone14,5"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone13Pro productTypes:@[@"iPhone14,2"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone13ProMax productTypes:@[@"iPhone14,3"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone14 productTypes:@[@"iPhone14,7"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone14Plus productTypes:@[@"iPhone14,8"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone14Pro productTypes:@[@"iPhone15,2"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone14ProMax productTypes:@[@"iPhone15,3"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone15 productTypes:@[@"iPhone15,4"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone15Plus productTypes:@[@"iPhone15,5"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone15Pro productTypes:@[@"iPhone16,1"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone15ProMax productTypes:@[@"iPhone16,2"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone16 productTypes:@[@"iPhone17,3"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone16Plus productTypes:@[@"iPhone17,4"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone16Pro productTypes:@[@"iPhone17,1"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone16ProMax productTypes:@[@"iPhone17,2"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone16e productTypes:@[@"iPhone17,5"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone17 productTypes:@[@"iPhone18,3"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone17Pro productTypes:@[@"iPhone18,1"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPhone17ProMax productTypes:@[@"iPhone18,2"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPhoneWithModel:FBDeviceModeliPodTouch_7thGeneration productTypes:@[@"iPod9,1"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPad2 productTypes:@[@"iPad2,1", @"iPad2,2", @"iPad2,3", @"iPad2,4"] deviceArchitecture:FBArchitectureArmv7],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadRetina productTypes:@[@"iPad3,1", @"iPad3,2", @"iPad3,3", @"iPad3,4", @"iPad3,5", @"iPad3,6"] deviceArchitecture:FBArchitectureArmv7],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadAir productTypes:@[@"iPad4,1", @"iPad4,2", @"iPad4,3"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadAir2 productTypes:@[@"iPad5,3", @"iPad5,4"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadAir_3rdGeneration productTypes:@[@"iPad11,3", @"iPad11,4"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadAir_4thGeneration productTypes:@[@"iPad13,1", @"iPad13,2"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadPro productTypes:@[@"iPad6,7", @"iPad6,8", @"iPad6,3", @"iPad6,4"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadPro_9_7_Inch productTypes:@[@"iPad6,3", @"iPad6,4"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadPro_12_9_Inch productTypes:@[@"iPad6,7", @"iPad6,8"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPad_5thGeneration productTypes:@[@"iPad6,11", @"iPad6,12"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadPro_12_9_Inch_2ndGeneration productTypes:@[@"iPad7,1", @"iPad7,2"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadPro_10_5_Inch productTypes:@[@"iPad7,3", @"iPad7,4"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPad_6thGeneration productTypes:@[@"iPad7,5", @"iPad7,6"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPad_7thGeneration productTypes:@[@"iPad7,11", @"iPad7,12"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPad_8thGeneration productTypes:@[@"iPad11,6", @"iPad11,7"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadPro_12_9_Inch_3rdGeneration productTypes:@[@"iPad8,5", @"iPad8,6", @"iPad8,7", @"iPad8,8"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadPro_12_9_Inch_4thGeneration productTypes:@[@"iPad8,11", @"iPad8,12"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadPro_11_Inch_1stGeneration productTypes:@[@"iPad8,1", @"iPad8,2", @"iPad8,3", @"iPad8,4"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadPro_12_9nch_1stGeneration productTypes:@[@"iPad8,11", @"iPad8,12"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadPro_12_9nch_5thGeneration productTypes:@[@"iPad13,8", @"iPad13,9", @"iPad13,10", @"iPad13,11"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadPro_11_Inch_2ndGeneration productTypes:@[@"iPad8,9", @"iPad8,10"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadPro_11_Inch_3ndGeneration productTypes:@[@"iPad13,4", @"iPad13,5", @"iPad13,6", @"iPad13,7"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadMini_2 productTypes:@[@"iPad4,4", @"iPad4,5", @"iPad4,6",] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadMini_3 productTypes:@[@"iPad4,7", @"iPad4,8", @"iPad4,9"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadMini_4 productTypes:@[@"iPad5,1", @"iPad5,2"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType iPadWithModel:FBDeviceModeliPadMini_5 productTypes:@[@"iPad11,1", @"iPad11,2"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType tvWithModel:FBDeviceModelAppleTV productTypes:@[@"AppleTV5,3"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType tvWithModel:FBDeviceModelAppleTV4K productTypes:@[@"AppleTV6,2"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType tvWithModel:FBDeviceModelAppleTV4KAt1080p productTypes:@[@"AppleTV6,2"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType tvWithModel:FBDeviceModelAppleTV4K_2ndGeneration productTypes:@[@"AppleTV11,1"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType tvWithModel:FBDeviceModelAppleTV4KAt1080p_2ndGeneration productTypes:@[@"AppleTV11,1"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType watchWithModel:FBDeviceModelAppleWatch38mm productTypes:@[@"Watch1,1"] deviceArchitecture:FBArchitectureArmv7],
-      [FBDeviceType watchWithModel:FBDeviceModelAppleWatch42mm productTypes:@[@"Watch1,2"] deviceArchitecture:FBArchitectureArmv7],
-      [FBDeviceType watchWithModel:FBDeviceModelAppleWatchSE_40mm productTypes:@[@"Watch1,1"] deviceArchitecture:FBArchitectureArmv7],
-      [FBDeviceType watchWithModel:FBDeviceModelAppleWatchSE_44mm productTypes:@[@"Watch1,2"] deviceArchitecture:FBArchitectureArmv7],
-      [FBDeviceType watchWithModel:FBDeviceModelAppleWatchSeries2_38mm productTypes:@[@"Watch2,1"] deviceArchitecture:FBArchitectureArmv7],
-      [FBDeviceType watchWithModel:FBDeviceModelAppleWatchSeries2_42mm productTypes:@[@"Watch2,2"] deviceArchitecture:FBArchitectureArmv7],
-      [FBDeviceType watchWithModel:FBDeviceModelAppleWatchSeries3_38mm productTypes:@[@"Watch3,1"] deviceArchitecture:FBArchitectureArmv7],
-      [FBDeviceType watchWithModel:FBDeviceModelAppleWatchSeries3_42mm productTypes:@[@"Watch3,2"] deviceArchitecture:FBArchitectureArmv7],
-      [FBDeviceType watchWithModel:FBDeviceModelAppleWatchSeries4_40mm productTypes:@[@"Watch4,1", @"Watch4,3"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType watchWithModel:FBDeviceModelAppleWatchSeries4_44mm productTypes:@[@"Watch4,2", @"Watch4,4"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType watchWithModel:FBDeviceModelAppleWatchSeries5_40mm productTypes:@[@"Watch5,1", @"Watch5,3"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType watchWithModel:FBDeviceModelAppleWatchSeries5_44mm productTypes:@[@"Watch5,2", @"Watch5,4"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType watchWithModel:FBDeviceModelAppleWatchSeries6_40mm productTypes:@[@"Watch6,1", @"Watch6,3"] deviceArchitecture:FBArchitectureArm64],
-      [FBDeviceType watchWithModel:FBDeviceModelAppleWatchSeries6_44mm productTypes:@[@"Watch6,2", @"Watch6,4"] deviceArchitecture:FBArchitectureArm64],
-
-    ];
+    FBLookupIndexEntry *entries = calloc(DeviceTypeCount, sizeof(FBLookupIndexEntry));
+    for (NSUInteger index = 0; index < DeviceTypeCount; index++) {
+      entries[index] = (FBLookupIndexEntry) {.key = *DeviceTypeDescriptors[index].model, .index = index};
+    }
+    lookupIndex = MakeLookupIndex(entries, DeviceTypeCount);
   });
-  return deviceConfigurations;
+  return lookupIndex;
 }
 
-+ (NSArray<FBOSVersion *> *)OSConfigurations
+static FBLookupIndex OSVersionNameIndex(void)
 {
   static dispatch_once_t onceToken;
-  static NSArray<FBOSVersion *> *OSConfigurations;
+  static FBLookupIndex lookupIndex;
   dispatch_once(&onceToken, ^{
-    OSConfigurations = @[
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_7_1],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_8_0],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_8_1],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_8_2],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_8_3],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_8_4],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_9_0],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_9_1],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_9_2],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_9_3],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_9_3_1],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_9_3_2],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_10_0],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_10_1],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_10_2],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_10_2_1],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_10_3],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_10_3_1],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_11_0],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_11_1],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_11_2],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_11_3],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_11_4],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_11_4],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_12_0],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_12_1],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_12_2],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_12_4],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_13_0],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_13_1],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_13_2],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_13_3],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_13_4],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_13_5],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_13_6],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_13_7],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_14_0],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_14_1],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_14_2],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_14_3],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_14_4],
-      [FBOSVersion iOSWithName:FBOSVersionNameiOS_14_5],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_9_0],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_9_1],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_9_2],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_10_0],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_10_1],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_10_2],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_11_0],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_11_1],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_11_2],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_11_3],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_11_4],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_12_0],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_12_1],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_12_2],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_12_4],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_13_0],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_13_2],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_13_3],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_13_4],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_14_0],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_14_1],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_14_2],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_14_3],
-      [FBOSVersion tvOSWithName:FBOSVersionNametvOS_14_5],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_2_0],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_2_1],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_2_2],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_3_0],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_3_1],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_3_2],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_4_0],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_4_1],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_4_2],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_5_0],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_5_1],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_5_2],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_5_3],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_6_0],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_6_1],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_6_2],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_7_0],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_7_1],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_7_2],
-      [FBOSVersion tvOSWithName:FBOSVersionNamewatchOS_7_4],
-      [FBOSVersion macOSWithName:FBOSVersionNamemac],
-    ];
+    FBLookupIndexEntry *entries = calloc(OSVersionCount, sizeof(FBLookupIndexEntry));
+    for (NSUInteger index = 0; index < OSVersionCount; index++) {
+      entries[index] = (FBLookupIndexEntry) {.key = *OSVersionDescriptors[index].name, .index = index};
+    }
+    lookupIndex = MakeLookupIndex(entries, OSVersionCount);
   });
-  return OSConfigurations;
+  return lookupIndex;
+}
+
+static os_unfair_lock WrapperLock = OS_UNFAIR_LOCK_INIT;
+static FBDeviceType *DeviceTypes[sizeof(DeviceTypeDescriptors) / sizeof(DeviceTypeDescriptors[0])];
+static FBOSVersion *OSVersions[sizeof(OSVersionDescriptors) / sizeof(OSVersionDescriptors[0])];
+
+static FBDeviceType *DeviceTypeAtIndex(NSUInteger index)
+{
+  os_unfair_lock_lock(&WrapperLock);
+  FBDeviceType *deviceType = DeviceTypes[index];
+  if (!deviceType) {
+    const FBDeviceTypeDescriptor *descriptor = &DeviceTypeDescriptors[index];
+    NSUInteger productTypeCount = 0;
+    while (descriptor->productTypes[productTypeCount]) {
+      productTypeCount++;
+    }
+    NSSet<NSString *> *productTypes = [NSSet setWithObjects:descriptor->productTypes count:productTypeCount];
+    deviceType = [[FBDeviceType alloc] initWithModel:*descriptor->model productTypes:productTypes deviceArchitecture:*descriptor->architecture family:descriptor->family];
+    DeviceTypes[index] = deviceType;
+  }
+  os_unfair_lock_unlock(&WrapperLock);
+  return deviceType;
+}
+
+static FBOSVersion *OSVersionAtIndex(NSUInteger index)
+{
+  os_unfair_lock_lock(&WrapperLock);
+  FBOSVersion *osVersion = OSVersions[index];
+  if (!osVersion) {
+    const FBOSVersionDescriptor *descriptor = &OSVersionDescriptors[index];
+    switch (descriptor->platform) {
+      case FBOSVersionPlatformiOS:
+        osVersion = [FBOSVersion iOSWithName:*descriptor->name];
+        break;
+      case FBOSVersionPlatformtvOS:
+        osVersion = [FBOSVersion tvOSWithName:*descriptor->name];
+        break;
+      case FBOSVersionPlatformwatchOS:
+        osVersion = [FBOSVersion watchOSWithName:*descriptor->name];
+        break;
+      case FBOSVersionPlatformmacOS:
+        osVersion = [FBOSVersion macOSWithName:*descriptor->name];
+        break;
+    }
+    OSVersions[index] = osVersion;
+  }
+  os_unfair_lock_unlock(&WrapperLock);
+  return osVersion;
+}
+
+@implementation FBiOSTargetConfiguration
+
+#pragma mark Lookups
+
++ (nullable FBDeviceType *)deviceTypeForProductType:(NSString *)productType
+{
+  NSUInteger index = LookupIndexFind(ProductTypeIndex(), productType);
+  return index == NSNotFound ? nil : DeviceTypeAtIndex(index);
+}
+
++ (nullable FBDeviceType *)deviceTypeForModel:(FBDeviceModel)model
+{
+  NSUInteger index = LookupIndexFind(DeviceModelIndex(), model);
+  return index == NSNotFound ? nil : DeviceTypeAtIndex(index);
+}
+
++ (nullable FBOSVersion *)OSVersionForName:(FBOSVersionName)name
+{
+  NSUInteger index = LookupIndexFind(OSVersionNameIndex(), name);
+  return index == NSNotFound ? nil : OSVersionAtIndex(index);
 }
 
+#pragma mark Lookup Tables
+
 + (NSDictionary<FBDeviceModel, FBDeviceType *> *)nameToDevice
 {
   static dispatch_once_t onceToken;
   static NSDictionary<FBDeviceModel, FBDeviceType *> *mapping;
   dispatch_once(&onceToken, ^{
-    NSArray *instances = self.deviceConfigurations;
-    NSMutableDictionary<FBDeviceModel, FBDeviceType *> *dictionary = [NSMutableDictionary dictionary];
-    for (FBDeviceType *device in instances) {
-      dictionary[device.model] = device;
+    FBLookupIndex lookupIndex = DeviceModelIndex();
+    NSMutableDictionary<FBDeviceModel, FBDeviceType *> *dictionary = [NSMutableDictionary dictionaryWithCapacity:lookupIndex.count];
+    for (NSUInteger position = 0; position < lookupIndex.count; position++) {
+      dictionary[lookupIndex.entries[position].key] = DeviceTypeAtIndex(lookupIndex.entries[position].index);
     }
     mapping = [dictionary copy];
   });
@@ -677,12 +848,10 @@ FBOSVersionName const FBOSVersionNamemac = @"macOS";
   static dispatch_once_t onceToken;
   static NSDictionary<NSString *, FBDeviceType *> *mapping;
   dispatch_once(&onceToken, ^{
-    NSArray *instances = self.deviceConfigurations;
-    NSMutableDictionary<NSString *, FBDeviceType *> *dictionary = [NSMutableDictionary dictionary];
-    for (FBDeviceType *device in instances) {
-      for (NSString *productType in device.productTypes) {
-        dictionary[productType] = device;
-      }
+    FBLookupIndex lookupIndex = ProductTypeIndex();
+    NSMutableDictionary<NSString *, FBDeviceType *> *dictionary = [NSMutableDictionary dictionaryWithCapacity:lookupIndex.count];
+    for (NSUInteger position = 0; position < lookupIndex.count; position++) {
+      dictionary[lookupIndex.entries[position].key] = DeviceTypeAtIndex(lookupIndex.entries[position].index);
     }
     mapping = [dictionary copy];
   });
@@ -694,10 +863,10 @@ FBOSVersionName const FBOSVersionNamemac = @"macOS";
   static dispatch_once_t onceToken;
   static NSDictionary<FBOSVersionName, FBOSVersion *> *mapping;
   dispatch_once(&onceToken, ^{
-    NSArray *instances = self.OSConfigurations;
-    NSMutableDictionary<FBOSVersionName, FBOSVersion *> *dictionary = [NSMutableDictionary dictionary];
-    for (FBOSVersion *os in instances) {
-      dictionary[os.name] = os;
+    FBLookupIndex lookupIndex = OSVersionNameIndex();
+    NSMutableDictionary<FBOSVersionName, FBOSVersion *> *dictionary = [NSMutableDictionary dictionaryWithCapacity:lookupIndex.count];
+    for (NSUInteger position = 0; position < lookupIndex.count; position++) {
+      dictionary[lookupIndex.entries[position].key] = OSVersionAtIndex(lookupIndex.entries[position].index);
     }
     mapping = [dictionary copy];
   });
@@ -64,6 +64,23 @@
 
 @end
 
+static NSString *const KeyExecutablePath = @"executable_path";
+static NSString *const KeyIdentifier = @"identifier";
+static NSString *const KeyProcessName = @"process_name";
+static NSString *const KeyProcessIdentifier = @"pid";
+static NSString *const KeyParentProcessName = @"parent_process_name";
+static NSString *const KeyParentProcessIdentifier = @"ppid";
+static NSString *const KeyDate = @"date";
+static NSString *const KeyProcessType = @"process_type";
+static NSString *const KeyExceptionDescription = @"exception_description";
+static NSString *const KeyCrashedThreadDescription = @"crashed_thread_description";
+
+@interface FBCrashLogInfo ()
+
+@property (nonatomic, copy, nullable, readwrite) FBCrashLogContentsFetcher contentsFetcher;
+
+@end
+
 @implementation FBCrashLogInfo
 
 #pragma mark Initializers
@@ -84,7 +101,8 @@
       describeFormat:@"Crash file at %@ is not readable", crashPath]
       fail:error];
   }
-  NSData *crashFileData = [NSData dataWithContentsOfFile:crashPath options:0 error:error];
+  // The file is mapped rather than read, as only part of it is needed to parse it.
+  NSData *crashFileData = [NSData dataWithContentsOfFile:crashPath options:NSDataReadingMappedIfSafe error:error];
   if (!crashFileData) {
     return [[FBControlCoreError
       describeFormat:@"Could not read data from %@", crashPath]
@@ -95,25 +113,70 @@
         fail:error];
   }
 
-  NSString *crashString = [[NSString alloc] initWithData:crashFileData encoding:NSUTF8StringEncoding];
-  if (!crashString) {
+
+  return [self fromCrashLogData:crashFileData crashPath:crashPath parser:[self getPreferredCrashLogParserForCrashData:crashFileData] error:error];
+}
+
++ (nullable instancetype)fromCrashLogHeaderData:(NSData *)data crashPath:(NSString *)crashPath contentsFetcher:(FBCrashLogContentsFetcher)contentsFetcher error:(NSError **)error
+{
+  if (![self isParsableFromHeader:data]) {
     return [[FBControlCoreError
-      describeFormat:@"Could not extract string from %@", crashPath]
+      describeFormat:@"Crash log for %@ cannot be parsed from its header", crashPath]
       fail:error];
   }
+  // The header may end part way through a line, or a multi-byte character, so only use the complete lines.
+  NSRange lastNewline = [data rangeOfData:[NSData dataWithBytes:"\n" length:1] options:NSDataSearchBackwards range:NSMakeRange(0, data.length)];
+  NSData *lines = lastNewline.location == NSNotFound ? data : [data subdataWithRange:NSMakeRange(0, lastNewline.location)];
+  FBCrashLogInfo *info = [self fromCrashLogData:lines crashPath:crashPath parser:[self getPreferredCrashLogParserForCrashData:lines] error:error];
+  info.contentsFetcher = contentsFetcher;
+  return info;
+}
 
-  return [self fromCrashLogString:crashString crashPath:crashPath parser:[self getPreferredCrashLogParserForCrashString:crashString] error:error];
++ (nullable instancetype)fromPropertyListRepresentation:(NSDictionary<NSString *, id> *)representation crashPath:(NSString *)crashPath
+{
+  NSString *executablePath = representation[KeyExecutablePath];
+  NSString *identifier = representation[KeyIdentifier];
+  NSString *processName = representation[KeyProcessName];
+  NSNumber *processIdentifier = representation[KeyProcessIdentifier];
+  NSString *parentProcessName = representation[KeyParentProcessName];
+  NSNumber *parentProcessIdentifier = representation[KeyParentProcessIdentifier];
+  NSDate *date = representation[KeyDate];
+  NSNumber *processType = representation[KeyProcessType];
+  if (![executablePath isKindOfClass:NSString.class]
+    || ![identifier isKindOfClass:NSString.class]
+    || ![processName isKindOfClass:NSString.class]
+    || ![processIdentifier isKindOfClass:NSNumber.class]
+    || ![parentProcessName isKindOfClass:NSString.class]
+    || ![parentProcessIdentifier isKindOfClass:NSNumber.class]
+    || ![date isKindOfClass:NSDate.class]
+    || ![processType isKindOfClass:NSNumber.class]) {
+    return nil;
+  }
+  NSString *exceptionDescription = representation[KeyExceptionDescription];
+  NSString *crashedThreadDescription = representation[KeyCrashedThreadDescription];
+  return [[FBCrashLogInfo alloc]
+    initWithCrashPath:crashPath
+    executablePath:executablePath
+    identifier:identifier
+    processName:processName
+    processIdentifier:processIdentifier.intValue
+    parentProcessName:parentProcessName
+    parentProcessIdentifier:parentProcessIdentifier.intValue
+    date:date
+    processType:processType.unsignedIntegerValue
+    exceptionDescription:[exceptionDescription isKindOfClass:NSString.class] ? exceptionDescription : nil
+    crashedThreadDescription:[crashedThreadDescription isKindOfClass:NSString.class] ? crashedThreadDescription : nil];
 }
 
-+ (id<FBCrashLogParser>)getPreferredCrashLogParserForCrashString:(NSString *)crashString {
-  if (crashString.length > 0 && [crashString characterAtIndex:0] == '{') {
++ (id<FBCrashLogParser>)getPreferredCrashLogParserForCrashData:(NSData *)crashData {
+  if (crashData.length > 0 && ((const char *) crashData.bytes)[0] == '{') {
     return [[FBConcatedJSONCrashLogParser alloc] init];
   } else {
     return [[FBPlainTextCrashLogParser alloc] init];
   }
 }
 
-+ (nullable instancetype)fromCrashLogString:(NSString *)crashString crashPath:(NSString *)crashPath parser:(id<FBCrashLogParser>)parser error:(NSError **)error {
++ (nullable instancetype)fromCrashLogData:(NSData *)crashData crashPath:(NSString *)crashPath parser:(id<FBCrashLogParser>)parser error:(NSError **)error {
 
   NSString *executablePath = nil;
   NSString *identifier = nil;
@@ -126,7 +189,7 @@
   NSString *crashedThreadDescription = nil;
 
   NSError *err;
-  [parser parseCrashLogFromString:crashString
+  [parser parseCrashLogFromData:crashData
     executablePathOut:&executablePath
     identifierOut:&identifier
     processNameOut:&processName
@@ -223,14 +286,22 @@
 + (BOOL)isParsableCrashLog:(NSData *)data
 {
 #if defined(__apple_build_version__)
-  NSString *crashString = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
-  FBCrashLogInfo *parsable = [self fromCrashLogString:crashString crashPath:@"" parser:[self getPreferredCrashLogParserForCrashString:crashString] error:nil];
+  FBCrashLogInfo *parsable = [self fromCrashLogData:data crashPath:@"" parser:[self getPreferredCrashLogParserForCrashData:data] error:nil];
   return parsable != nil;
 #else
   return NO;
 #endif
 }
 
++ (BOOL)isParsableFromHeader:(NSData *)data
+{
+  // JSON crash logs have the process information after the header object, so must be parsed in their entirety.
+  if (data.length == 0) {
+    return NO;
+  }
+  return ((const char *) data.bytes)[0] != '{';
+}
+
 #pragma mark NSObject
 
 - (NSString *)description
@@ -265,8 +336,28 @@
   return self.crashPath.lastPathComponent;
 }
 
+- (NSDictionary<NSString *, id> *)propertyListRepresentation
+{
+  NSMutableDictionary<NSString *, id> *representation = [NSMutableDictionary dictionaryWithDictionary:@{
+    KeyExecutablePath: self.executablePath,
+    KeyIdentifier: self.identifier,
+    KeyProcessName: self.processName,
+    KeyProcessIdentifier: @(self.processIdentifier),
+    KeyParentProcessName: self.parentProcessName,
+    KeyParentProcessIdentifier: @(self.parentProcessIdentifier),
+    KeyDate: self.date,
+    KeyProcessType: @(self.processType),
+  }];
+  representation[KeyExceptionDescription] = self.exceptionDescription;
+  representation[KeyCrashedThreadDescription] = self.crashedThreadDescription;
+  return [representation copy];
+}
+
 - (nullable NSString *)loadRawCrashLogStringWithError:(NSError **)error;
 {
+  if (![self fetchContentsIfNeededWithError:error]) {
+    return nil;
+  }
   return [NSString stringWithContentsOfFile:self.crashPath encoding:NSUTF8StringEncoding error:error];
 }
 
@@ -283,7 +374,7 @@
       map:^ FBCrashLogInfo * (NSString *fileName) {
         NSString *path = [basePath stringByAppendingPathComponent:fileName];
         NSError *error = nil;
-        FBCrashLogInfo *info = [FBCrashLogInfo fromCrashLogAtPath:path error:&error];
+        FBCrashLogInfo *info = [FBCrashLogInfo unchangedOrParsedCrashLogAtPath:path error:&error];
         if (!info) {
           [logger logFormat:@"Error parsing log %@", error];
         }
@@ -316,42 +407,32 @@
 
 + (NSPredicate *)predicateForCrashLogsWithProcessID:(pid_t)processID
 {
-  return [NSPredicate predicateWithBlock:^ BOOL (FBCrashLogInfo *crashLog, id _) {
-    return crashLog.processIdentifier == processID;
-  }];
+  return [NSPredicate predicateWithFormat:@"processIdentifier == %d", processID];
 }
 
 + (NSPredicate *)predicateNewerThanDate:(NSDate *)date
 {
-  return [NSPredicate predicateWithBlock:^ BOOL (FBCrashLogInfo *crashLog, id _) {
-    return [date compare:crashLog.date] == NSOrderedAscending;
-  }];
+  return [NSPredicate predicateWithFormat:@"date > %@", date];
 }
 
 + (NSPredicate *)predicateOlderThanDate:(NSDate *)date
 {
-  return [NSCompoundPredicate notPredicateWithSubpredicate:[self predicateNewerThanDate:date]];
+  return [NSPredicate predicateWithFormat:@"date <= %@", date];
 }
 
 + (NSPredicate *)predicateForIdentifier:(NSString *)identifier
 {
-  return [NSPredicate predicateWithBlock:^ BOOL (FBCrashLogInfo *crashLog, id _) {
-    return [identifier isEqualToString:crashLog.identifier];
-  }];
+  return [NSPredicate predicateWithFormat:@"identifier == %@", identifier];
 }
 
 + (NSPredicate *)predicateForName:(NSString *)name
 {
-  return [NSPredicate predicateWithBlock:^ BOOL (FBCrashLogInfo *crashLog, id _) {
-    return [name isEqualToString:crashLog.name];
-  }];
+  return [NSPredicate predicateWithFormat:@"name == %@", name];
 }
 
 + (NSPredicate *)predicateForExecutablePathContains:(NSString *)contains
 {
-  return [NSPredicate predicateWithBlock:^ BOOL (FBCrashLogInfo *crashLog, id _) {
-    return [crashLog.executablePath containsString:contains];
-  }];
+  return [NSPredicate predicateWithFormat:@"executablePath CONTAINS %@", contains];
 }
 
 #pragma mark Helpers
@@ -366,6 +447,52 @@
 
 #pragma mark Private
 
++ (nullable FBCrashLogInfo *)unchangedOrParsedCrashLogAtPath:(NSString *)path error:(NSError **)error
+{
+  // Diagnostic reports are rarely modified once written, so a report is only parsed again when its size or modification date changes.
+  static NSMutableDictionary<NSString *, NSArray *> *parsedByPath = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    parsedByPath = [NSMutableDictionary dictionary];
+  });
+  NSDictionary<NSFileAttributeKey, id> *attributes = [NSFileManager.defaultManager attributesOfItemAtPath:path error:nil];
+  NSArray *fingerprint = @[attributes.fileModificationDate ?: NSDate.distantPast, @(attributes.fileSize)];
+  @synchronized (parsedByPath) {
+    NSArray *parsed = parsedByPath[path];
+    if ([parsed.firstObject isEqual:fingerprint]) {
+      return parsed.lastObject;
+    }
+  }
+  FBCrashLogInfo *info = [self fromCrashLogAtPath:path error:error];
+  if (!info) {
+    return nil;
+  }
+  @synchronized (parsedByPath) {
+    parsedByPath[path] = @[fingerprint, info];
+  }
+  return info;
+}
+
+- (BOOL)fetchContentsIfNeededWithError:(NSError **)error
+{
+  @synchronized (self) {
+    FBCrashLogContentsFetcher contentsFetcher = self.contentsFetcher;
+    if (!contentsFetcher || [NSFileManager.defaultManager fileExistsAtPath:self.crashPath]) {
+      return YES;
+    }
+    NSError *innerError = nil;
+    if (!contentsFetcher(self.crashPath, &innerError)) {
+      return [[[FBControlCoreError
+        describeFormat:@"Failed to fetch contents of crash log %@", self.name]
+        causedBy:innerError]
+        failBool:error];
+    }
+    // Once fetched, the contents are read from the crash path like any other crash log.
+    self.contentsFetcher = nil;
+    return YES;
+  }
+}
+
 + (FBCrashLogInfoProcessType)processTypeForExecutablePath:(NSString *)executablePath
 {
   if ([executablePath containsString:@"Platforms/iPhoneSimulator.platform"]) {
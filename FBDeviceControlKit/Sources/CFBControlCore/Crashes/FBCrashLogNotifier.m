@@ -7,18 +7,77 @@
 
 #import "FBCrashLogNotifier.h"
 
+#import <CoreServices/CoreServices.h>
+
 #import "FBCrashLog.h"
 #import "FBCrashLogStore.h"
 #import "FBControlCoreGlobalConfiguration.h"
 #import "FBControlCoreLogger.h"
 #import "FBControlCoreError.h"
+#import "FBFuture.h"
+
+// Diagnostic reports are written once, so a short latency is enough to batch the events of a single write.
+static CFTimeInterval const CrashLogStreamLatency = 0.05;
+
+@interface FBCrashLogNotifierWaiter : NSObject
+
+@property (nonatomic, strong, readonly) NSPredicate *predicate;
+@property (nonatomic, strong, readonly) FBMutableFuture<FBCrashLogInfo *> *future;
+
+@end
+
+@implementation FBCrashLogNotifierWaiter
+
+- (instancetype)initWithPredicate:(NSPredicate *)predicate
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _predicate = predicate;
+  _future = FBMutableFuture.future;
+
+  return self;
+}
+
+@end
 
 @interface FBCrashLogNotifier ()
 
 @property (nonatomic, copy, readwrite) NSDate *sinceDate;
+@property (nonatomic, copy, readonly) NSArray<NSString *> *directories;
+@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) NSMutableArray<FBCrashLogNotifierWaiter *> *waiters;
+@property (nonatomic, assign, readwrite) FSEventStreamRef stream;
+
+- (void)handleEventPaths:(NSArray<NSString *> *)paths;
 
 @end
 
+static void CrashLogStreamCallback(ConstFSEventStreamRef stream, void *info, size_t count, void *eventPaths, const FSEventStreamEventFlags eventFlags[], const FSEventStreamEventId eventIds[])
+{
+  FBCrashLogNotifier *notifier = (__bridge FBCrashLogNotifier *) info;
+  char **paths = (char **) eventPaths;
+  NSMutableArray<NSString *> *createdPaths = NSMutableArray.array;
+  for (size_t index = 0; index < count; index++) {
+    FSEventStreamEventFlags flags = eventFlags[index];
+    if (!(flags & kFSEventStreamEventFlagItemIsFile)) {
+      continue;
+    }
+    // A report may be written in place or moved into the directory once complete. A partially written report fails to parse and is picked up by the next modification.
+    if (!(flags & (kFSEventStreamEventFlagItemCreated | kFSEventStreamEventFlagItemRenamed | kFSEventStreamEventFlagItemModified))) {
+      continue;
+    }
+    [createdPaths addObject:[NSFileManager.defaultManager stringWithFileSystemRepresentation:paths[index] length:strlen(paths[index])]];
+  }
+  if (createdPaths.count == 0) {
+    return;
+  }
+  [notifier handleEventPaths:createdPaths];
+}
+
 @implementation FBCrashLogNotifier
 
 #pragma mark Initializers
@@ -32,10 +91,28 @@
 
   _store = [FBCrashLogStore storeForDirectories:FBCrashLogInfo.diagnosticReportsPaths logger:logger];
   _sinceDate = NSDate.date;
+  _logger = logger;
+  // FSEvents reports resolved paths.
+  NSMutableArray<NSString *> *directories = NSMutableArray.array;
+  for (NSString *directory in FBCrashLogInfo.diagnosticReportsPaths) {
+    [directories addObject:directory.stringByResolvingSymlinksInPath];
+  }
+  _directories = [directories copy];
+  _queue = dispatch_queue_create("com.facebook.fbcontrolcore.crashlognotifier", DISPATCH_QUEUE_SERIAL);
+  _waiters = NSMutableArray.array;
 
   return self;
 }
 
+- (void)dealloc
+{
+  if (_stream) {
+    FSEventStreamStop(_stream);
+    FSEventStreamInvalidate(_stream);
+    FSEventStreamRelease(_stream);
+  }
+}
+
 + (instancetype)sharedInstance
 {
   static dispatch_once_t onceToken;
@@ -50,8 +127,13 @@
 
 - (BOOL)startListening:(BOOL)onlyNew
 {
-  self.sinceDate = onlyNew ? NSDate.date : [NSDate distantPast];
-  return YES;
+  NSDate *sinceDate = onlyNew ? NSDate.date : [NSDate distantPast];
+  __block BOOL started = NO;
+  dispatch_sync(self.queue, ^{
+    self.sinceDate = sinceDate;
+    started = [self startStreamIfNeeded];
+  });
+  return started;
 }
 
 - (FBFuture<FBCrashLogInfo *> *)nextCrashLogForPredicate:(NSPredicate *)predicate
@@ -62,21 +144,91 @@
       failFuture];
   }
 
-  dispatch_queue_t queue = dispatch_queue_create("com.facebook.fbcontrolcore.crashlogfetch", DISPATCH_QUEUE_SERIAL);
-  return [FBFuture
-   onQueue:queue resolveUntil:^{
-     FBCrashLogInfo *crashInfo = [[[FBCrashLogInfo
-       crashInfoAfterDate:FBCrashLogNotifier.sharedInstance.sinceDate logger:nil]
-       filteredArrayUsingPredicate:predicate]
-       firstObject];
-     if (!crashInfo) {
-       return [[FBControlCoreError
-         describeFormat:@"Crash Log Info for %@ could not be obtained", predicate]
-         failFuture];
-     }
-     [self.store ingestCrashLogAtPath:crashInfo.crashPath];
-     return [FBFuture futureWithResult:crashInfo];
-   }];
+  // Registered on the queue that events are delivered on, so a crash log written from now on can't be missed.
+  FBCrashLogNotifierWaiter *waiter = [[FBCrashLogNotifierWaiter alloc] initWithPredicate:predicate];
+  dispatch_async(self.queue, ^{
+    [self.waiters addObject:waiter];
+  });
+  return [waiter.future onQueue:self.queue respondToCancellation:^{
+    [self.waiters removeObject:waiter];
+    return FBFuture.empty;
+  }];
+}
+
+#pragma mark Private
+
+- (BOOL)startStreamIfNeeded
+{
+  if (self.stream) {
+    return YES;
+  }
+  FSEventStreamContext context = {
+    .version = 0,
+    .info = (__bridge void *) self,
+    .retain = NULL,
+    .release = NULL,
+    .copyDescription = NULL,
+  };
+  FSEventStreamRef stream = FSEventStreamCreate(
+    kCFAllocatorDefault,
+    CrashLogStreamCallback,
+    &context,
+    (__bridge CFArrayRef) self.directories,
+    kFSEventStreamEventIdSinceNow,
+    CrashLogStreamLatency,
+    kFSEventStreamCreateFlagFileEvents | kFSEventStreamCreateFlagNoDefer
+  );
+  if (!stream) {
+    [self.logger logFormat:@"Failed to create a stream for crash logs in %@", self.directories];
+    return NO;
+  }
+  FSEventStreamSetDispatchQueue(stream, self.queue);
+  if (!FSEventStreamStart(stream)) {
+    [self.logger logFormat:@"Failed to start a stream for crash logs in %@", self.directories];
+    FSEventStreamInvalidate(stream);
+    FSEventStreamRelease(stream);
+    return NO;
+  }
+  self.stream = stream;
+  return YES;
+}
+
+- (void)handleEventPaths:(NSArray<NSString *> *)paths
+{
+  NSMutableArray<FBCrashLogInfo *> *crashLogs = NSMutableArray.array;
+  for (NSString *path in paths) {
+    if (![self.directories containsObject:path.stringByDeletingLastPathComponent]) {
+      continue;
+    }
+    if (![@[@"crash", @"ips"] containsObject:path.pathExtension]) {
+      continue;
+    }
+    NSDictionary<NSFileAttributeKey, id> *attributes = [NSFileManager.defaultManager attributesOfItemAtPath:path error:nil];
+    if (!attributes || [attributes.fileModificationDate compare:self.sinceDate] == NSOrderedAscending) {
+      continue;
+    }
+    FBCrashLogInfo *crashLog = [self.store ingestCrashLogAtPath:path] ?: [self.store ingestedCrashLogWithName:path.lastPathComponent];
+    if (crashLog) {
+      [crashLogs addObject:crashLog];
+    }
+  }
+  if (crashLogs.count == 0 || self.waiters.count == 0) {
+    return;
+  }
+
+  // Match every new crash log against every waiter in one pass, each waiter resolving with the first match.
+  NSMutableArray<FBCrashLogNotifierWaiter *> *resolved = NSMutableArray.array;
+  for (FBCrashLogNotifierWaiter *waiter in self.waiters) {
+    for (FBCrashLogInfo *crashLog in crashLogs) {
+      if (![waiter.predicate evaluateWithObject:crashLog]) {
+        continue;
+      }
+      [waiter.future resolveWithResult:crashLog];
+      [resolved addObject:waiter];
+      break;
+    }
+  }
+  [self.waiters removeObjectsInArray:resolved];
 }
 
 @end
@@ -11,33 +11,86 @@
 #import "FBConcatedJsonParser.h"
 #import "FBCrashLog.h"
 
+// The members of the report that are decoded. Everything else is skipped.
+static NSString *const KeyProcessPath = @"procPath";
+static NSString *const KeyProcessName = @"procName";
+static NSString *const KeyProcessIdentifier = @"pid";
+static NSString *const KeyParentProcessName = @"parentProc";
+static NSString *const KeyParentProcessIdentifier = @"parentPid";
+static NSString *const KeyCaptureTime = @"captureTime";
+static NSString *const KeyException = @"exception";
+static NSString *const KeyThreads = @"threads";
+static NSString *const KeyUsedImages = @"usedImages";
+
 @implementation FBConcatedJSONCrashLogParser
 
 -(void)parseCrashLogFromString:(NSString *)str executablePathOut:(NSString *_Nonnull * _Nonnull)executablePathOut identifierOut:(NSString *_Nonnull * _Nonnull)identifierOut processNameOut:(NSString *_Nonnull * _Nonnull)processNameOut parentProcessNameOut:(NSString *_Nonnull * _Nonnull)parentProcessNameOut processIdentifierOut:(pid_t *)processIdentifierOut parentProcessIdentifierOut:(pid_t *)parentProcessIdentifierOut dateOut:(NSDate *_Nonnull * _Nonnull)dateOut  exceptionDescription:(NSString *_Nonnull * _Nonnull)exceptionDescription crashedThreadDescription:(NSString *_Nonnull * _Nonnull)crashedThreadDescription error:(NSError **)error {
-  NSDictionary<NSString *, id> *parsedReport = [FBConcatedJsonParser parseConcatenatedJSONFromString:str error:error];
-  if (!parsedReport) {
+  [self parseCrashLogFromData:[str dataUsingEncoding:NSUTF8StringEncoding]
+    executablePathOut:executablePathOut
+    identifierOut:identifierOut
+    processNameOut:processNameOut
+    parentProcessNameOut:parentProcessNameOut
+    processIdentifierOut:processIdentifierOut
+    parentProcessIdentifierOut:parentProcessIdentifierOut
+    dateOut:dateOut
+    exceptionDescription:exceptionDescription
+    crashedThreadDescription:crashedThreadDescription
+    error:error];
+}
+
+-(void)parseCrashLogFromData:(NSData *)data executablePathOut:(NSString *_Nonnull * _Nonnull)executablePathOut identifierOut:(NSString *_Nonnull * _Nonnull)identifierOut processNameOut:(NSString *_Nonnull * _Nonnull)processNameOut parentProcessNameOut:(NSString *_Nonnull * _Nonnull)parentProcessNameOut processIdentifierOut:(pid_t *)processIdentifierOut parentProcessIdentifierOut:(pid_t *)parentProcessIdentifierOut dateOut:(NSDate *_Nonnull * _Nonnull)dateOut  exceptionDescription:(NSString *_Nonnull * _Nonnull)exceptionDescription crashedThreadDescription:(NSString *_Nonnull * _Nonnull)crashedThreadDescription error:(NSError **)error {
+  NSSet<NSString *> *decodedKeys = [NSSet setWithArray:@[KeyProcessPath, KeyProcessName, KeyProcessIdentifier, KeyParentProcessName, KeyParentProcessIdentifier, KeyCaptureTime, KeyException]];
+  NSMutableDictionary<NSString *, id> *parsedReport = [NSMutableDictionary dictionary];
+  // The threads and images can be large, so they are kept encoded and only the parts that describe the crashed thread are decoded.
+  __block NSData *threads = nil;
+  __block NSData *usedImages = nil;
+  BOOL success = [FBConcatedJsonParser enumerateMembersOfConcatenatedJSONData:data error:error usingBlock:^(NSString *key, NSData *value, BOOL *stop) {
+    if ([key isEqualToString:KeyThreads]) {
+      threads = threads ?: value;
+    } else if ([key isEqualToString:KeyUsedImages]) {
+      usedImages = usedImages ?: value;
+    } else if ([decodedKeys containsObject:key] && !parsedReport[key]) {
+      id decoded = [FBConcatedJsonParser decodeJSONValue:value];
+      if (decoded) {
+        parsedReport[key] = decoded;
+      }
+    }
+    *stop = parsedReport.count == decodedKeys.count && threads && usedImages;
+  }];
+  if (!success) {
     return;
   }
 
-  *executablePathOut = parsedReport[@"procPath"];
+  NSString *executablePath = parsedReport[KeyProcessPath];
+  if ([executablePath isKindOfClass:NSString.class]) {
+    *executablePathOut = executablePath;
+  }
 
   // Name and identifier is the same thing
-  *processNameOut = parsedReport[@"procName"];
-  *identifierOut = parsedReport[@"procName"];
-  if ([parsedReport valueForKey:@"pid"]) {
-    *processIdentifierOut = ((NSNumber *)parsedReport[@"pid"]).intValue;
+  NSString *processName = parsedReport[KeyProcessName];
+  if ([processName isKindOfClass:NSString.class]) {
+    *processNameOut = processName;
+    *identifierOut = processName;
+  }
+  NSNumber *processIdentifier = parsedReport[KeyProcessIdentifier];
+  if ([processIdentifier isKindOfClass:NSNumber.class]) {
+    *processIdentifierOut = processIdentifier.intValue;
   }
 
-  *parentProcessNameOut = parsedReport[@"parentProc"];
-  if ([parsedReport valueForKey:@"parentPid"]) {
-    *parentProcessIdentifierOut = ((NSNumber *)parsedReport[@"parentPid"]).intValue;
+  NSString *parentProcessName = parsedReport[KeyParentProcessName];
+  if ([parentProcessName isKindOfClass:NSString.class]) {
+    *parentProcessNameOut = parentProcessName;
+  }
+  NSNumber *parentProcessIdentifier = parsedReport[KeyParentProcessIdentifier];
+  if ([parentProcessIdentifier isKindOfClass:NSNumber.class]) {
+    *parentProcessIdentifierOut = parentProcessIdentifier.intValue;
   }
-  if ([parsedReport valueForKey:@"captureTime"]) {
-    NSString *dateString = parsedReport[@"captureTime"];
+  NSString *dateString = parsedReport[KeyCaptureTime];
+  if ([dateString isKindOfClass:NSString.class]) {
     *dateOut = [FBCrashLog.dateFormatter dateFromString:dateString];
   }
 
-  NSDictionary *exceptionDictionary = parsedReport[@"exception"];
+  NSDictionary *exceptionDictionary = parsedReport[KeyException];
   if ([exceptionDictionary isKindOfClass:[NSDictionary class]]) {
     NSMutableString *exceptionDescriptionMutable = [NSMutableString new];
     NSString *exceptionType = [exceptionDictionary objectForKey:@"type"];
@@ -58,56 +111,81 @@
     *exceptionDescription = [NSString stringWithString:exceptionDescriptionMutable];
   }
 
-  NSMutableArray *imageNames = [NSMutableArray new];
-  NSArray<NSDictionary*> *imageDictionaries = parsedReport[@"usedImages"];
-  if ([imageDictionaries isKindOfClass:[NSArray class]]) {
-    for (NSDictionary *imageDictionary in imageDictionaries) {
-      NSString *imageName = imageDictionary[@"name"];
-      if ([imageName isKindOfClass:[NSString class]]) {
-        [imageNames addObject:imageName];
+  NSArray<NSDictionary *> *frames = threads ? [FBConcatedJSONCrashLogParser framesOfCrashedThread:threads] : nil;
+  if (frames) {
+    NSDictionary<NSNumber *, NSString *> *imageNames = [FBConcatedJSONCrashLogParser namesOfImages:usedImages usedByFrames:frames];
+    NSMutableString *crashedThreadDescriptionMutable = [NSMutableString new];
+    for (NSDictionary *frameDictionary in frames) {
+      if (![frameDictionary isKindOfClass:[NSDictionary class]]) {
+        continue;
+      }
+      NSString *imageNameString = imageNames[@([frameDictionary[@"imageIndex"] unsignedIntegerValue])];
+      if (imageNameString) {
+        if (imageNameString.length < 30) {
+          imageNameString = [imageNameString stringByPaddingToLength:30 withString:@" " startingAtIndex:0];
+        }
+        [crashedThreadDescriptionMutable appendString:imageNameString];
+        [crashedThreadDescriptionMutable appendString:@"\t"];
+      }
+      NSString *symbol = frameDictionary[@"symbol"];
+      if ([symbol isKindOfClass:[NSString class]]) {
+        [crashedThreadDescriptionMutable appendString:symbol];
+        [crashedThreadDescriptionMutable appendString:@"\n"];
       }
     }
+    *crashedThreadDescription = [NSString stringWithString:[crashedThreadDescriptionMutable stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]]];
   }
+}
 
-  NSArray<NSDictionary*> *threads = parsedReport[@"threads"];
+#pragma mark Public Methods
 
-  if ([threads isKindOfClass:[NSArray class]]) {
-    for (NSDictionary *threadDictionary in threads) {
-      if ([threadDictionary isKindOfClass:[NSDictionary class]] == NO) {
-        continue;
-      }
-      // This thread crashed
-      if ([[threadDictionary objectForKey:@"triggered"] boolValue]) {
-        NSArray<NSDictionary*> *frames = threadDictionary[@"frames"];
-        if ([frames isKindOfClass:[NSArray class]]) {
-          NSMutableString *crashedThreadDescriptionMutable = [NSMutableString new];
-          for (NSDictionary *frameDictionary in frames) {
-            if ([frameDictionary isKindOfClass:[NSDictionary class]]) {
-              NSUInteger imageIndex = [frameDictionary[@"imageIndex"]unsignedIntegerValue];
-              if (imageNames.count > imageIndex) {
-                NSString *imageNameString = imageNames[imageIndex];
-                if (imageNameString.length < 30) {
-                  imageNameString = [imageNameString stringByPaddingToLength:30
-                                                                  withString:@" "
-                                                             startingAtIndex:0];
-                }
-                [crashedThreadDescriptionMutable appendString:imageNameString];
-                [crashedThreadDescriptionMutable appendString:@"\t"];
-              }
-              NSString *symbol = frameDictionary[@"symbol"];
-              if ([symbol isKindOfClass:[NSString class]]) {
-                [crashedThreadDescriptionMutable appendString:symbol];
-                [crashedThreadDescriptionMutable appendString:@"\n"];
-              }
-           }
-         }
-         *crashedThreadDescription = [NSString stringWithString:[crashedThreadDescriptionMutable stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]]];
-       }
-       break;
-     }
-   }
-  }
++ (nullable NSArray<NSDictionary *> *)framesOfCrashedThread:(NSData *)threads
+{
+  // Only a thread that mentions being triggered is decoded, the others are skipped over.
+  NSData *triggered = [@"\"triggered\"" dataUsingEncoding:NSUTF8StringEncoding];
+  __block NSArray<NSDictionary *> *frames = nil;
+  [FBConcatedJsonParser enumerateElementsOfJSONArrayData:threads error:nil usingBlock:^(NSData *element, NSUInteger index, BOOL *stop) {
+    if ([element rangeOfData:triggered options:0 range:NSMakeRange(0, element.length)].location == NSNotFound) {
+      return;
+    }
+    NSDictionary *thread = [FBConcatedJsonParser decodeJSONValue:element];
+    if (![thread isKindOfClass:NSDictionary.class] || ![thread[@"triggered"] boolValue]) {
+      return;
+    }
+    NSArray<NSDictionary *> *threadFrames = thread[@"frames"];
+    frames = [threadFrames isKindOfClass:NSArray.class] ? threadFrames : @[];
+    *stop = YES;
+  }];
+  return frames;
+}
+
+#pragma mark Private
 
++ (NSDictionary<NSNumber *, NSString *> *)namesOfImages:(nullable NSData *)usedImages usedByFrames:(NSArray<NSDictionary *> *)frames
+{
+  // Only the images that the frames refer to are decoded.
+  NSMutableIndexSet *imageIndices = [NSMutableIndexSet indexSet];
+  for (NSDictionary *frameDictionary in frames) {
+    if ([frameDictionary isKindOfClass:NSDictionary.class]) {
+      [imageIndices addIndex:[frameDictionary[@"imageIndex"] unsignedIntegerValue]];
+    }
+  }
+  NSMutableDictionary<NSNumber *, NSString *> *imageNames = [NSMutableDictionary dictionary];
+  if (!usedImages || imageIndices.count == 0) {
+    return imageNames;
+  }
+  [FBConcatedJsonParser enumerateElementsOfJSONArrayData:usedImages error:nil usingBlock:^(NSData *element, NSUInteger index, BOOL *stop) {
+    if (![imageIndices containsIndex:index]) {
+      *stop = index > imageIndices.lastIndex;
+      return;
+    }
+    NSDictionary *imageDictionary = [FBConcatedJsonParser decodeJSONValue:element];
+    NSString *imageName = [imageDictionary isKindOfClass:NSDictionary.class] ? imageDictionary[@"name"] : nil;
+    if ([imageName isKindOfClass:NSString.class]) {
+      imageNames[@(index)] = imageName;
+    }
+  }];
+  return imageNames;
 }
 
 @end
@@ -117,6 +195,31 @@
 
 static NSUInteger MaxLineSearch = 20;
 
+-(void)parseCrashLogFromData:(NSData *)data executablePathOut:(NSString *_Nonnull * _Nonnull)executablePathOut identifierOut:(NSString *_Nonnull * _Nonnull)identifierOut processNameOut:(NSString *_Nonnull * _Nonnull)processNameOut parentProcessNameOut:(NSString *_Nonnull * _Nonnull)parentProcessNameOut processIdentifierOut:(pid_t *)processIdentifierOut parentProcessIdentifierOut:(pid_t *)parentProcessIdentifierOut dateOut:(NSDate *_Nonnull * _Nonnull)dateOut  exceptionDescription:(NSString *_Nonnull * _Nonnull)exceptionDescription crashedThreadDescription:(NSString *_Nonnull * _Nonnull)crashedThreadDescription error:(NSError **)error {
+  // Only the lines that are searched are converted to a string.
+  const char *bytes = data.bytes;
+  NSUInteger length = 0;
+  for (NSUInteger lines = 0; lines < MaxLineSearch && length < data.length; lines++) {
+    const char *newline = memchr(bytes + length, '\n', data.length - length);
+    length = newline ? (NSUInteger) (newline - bytes) + 1 : data.length;
+  }
+  NSString *str = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+  if (!str) {
+    return;
+  }
+  [self parseCrashLogFromString:str
+    executablePathOut:executablePathOut
+    identifierOut:identifierOut
+    processNameOut:processNameOut
+    parentProcessNameOut:parentProcessNameOut
+    processIdentifierOut:processIdentifierOut
+    parentProcessIdentifierOut:parentProcessIdentifierOut
+    dateOut:dateOut
+    exceptionDescription:exceptionDescription
+    crashedThreadDescription:crashedThreadDescription
+    error:error];
+}
+
 -(void)parseCrashLogFromString:(NSString *)str executablePathOut:(NSString *_Nonnull * _Nonnull)executablePathOut identifierOut:(NSString *_Nonnull * _Nonnull)identifierOut processNameOut:(NSString *_Nonnull * _Nonnull)processNameOut parentProcessNameOut:(NSString *_Nonnull * _Nonnull)parentProcessNameOut processIdentifierOut:(pid_t *)processIdentifierOut parentProcessIdentifierOut:(pid_t *)parentProcessIdentifierOut dateOut:(NSDate *_Nonnull * _Nonnull)dateOut  exceptionDescription:(NSString *_Nonnull * _Nonnull)exceptionDescription crashedThreadDescription:(NSString *_Nonnull * _Nonnull)crashedThreadDescription error:(NSError **)error {
 
   // Buffers for the sscanf
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBCrashLogQuery.h"
+
+#import "FBCrashLog.h"
+
+@implementation FBCrashLogQuery
+
+#pragma mark Initializers
+
++ (instancetype)query
+{
+  return [[self alloc] initWithName:nil identifier:nil processNames:nil processIdentifier:nil newerThan:nil olderThan:nil executablePathSubstring:nil];
+}
+
+- (instancetype)initWithName:(nullable NSString *)name identifier:(nullable NSString *)identifier processNames:(nullable NSSet<NSString *> *)processNames processIdentifier:(nullable NSNumber *)processIdentifier newerThan:(nullable NSDate *)newerThan olderThan:(nullable NSDate *)olderThan executablePathSubstring:(nullable NSString *)executablePathSubstring
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _name = [name copy];
+  _identifier = [identifier copy];
+  _processNames = [processNames copy];
+  _processIdentifier = [processIdentifier copy];
+  _newerThan = [newerThan copy];
+  _olderThan = [olderThan copy];
+  _executablePathSubstring = [executablePathSubstring copy];
+
+  return self;
+}
+
+- (instancetype)copyWithZone:(NSZone *)zone
+{
+  // Is immutable
+  return self;
+}
+
+#pragma mark Builders
+
+- (instancetype)withName:(NSString *)name
+{
+  return [[self.class alloc] initWithName:name identifier:self.identifier processNames:self.processNames processIdentifier:self.processIdentifier newerThan:self.newerThan olderThan:self.olderThan executablePathSubstring:self.executablePathSubstring];
+}
+
+- (instancetype)withIdentifier:(NSString *)identifier
+{
+  return [[self.class alloc] initWithName:self.name identifier:identifier processNames:self.processNames processIdentifier:self.processIdentifier newerThan:self.newerThan olderThan:self.olderThan executablePathSubstring:self.executablePathSubstring];
+}
+
+- (instancetype)withProcessNames:(NSSet<NSString *> *)processNames
+{
+  return [[self.class alloc] initWithName:self.name identifier:self.identifier processNames:processNames processIdentifier:self.processIdentifier newerThan:self.newerThan olderThan:self.olderThan executablePathSubstring:self.executablePathSubstring];
+}
+
+- (instancetype)withProcessIdentifier:(pid_t)processIdentifier
+{
+  return [[self.class alloc] initWithName:self.name identifier:self.identifier processNames:self.processNames processIdentifier:@(processIdentifier) newerThan:self.newerThan olderThan:self.olderThan executablePathSubstring:self.executablePathSubstring];
+}
+
+- (instancetype)withDatesNewerThan:(nullable NSDate *)newerThan olderThan:(nullable NSDate *)olderThan
+{
+  return [[self.class alloc] initWithName:self.name identifier:self.identifier processNames:self.processNames processIdentifier:self.processIdentifier newerThan:newerThan olderThan:olderThan executablePathSubstring:self.executablePathSubstring];
+}
+
+- (instancetype)withExecutablePathContaining:(NSString *)substring
+{
+  return [[self.class alloc] initWithName:self.name identifier:self.identifier processNames:self.processNames processIdentifier:self.processIdentifier newerThan:self.newerThan olderThan:self.olderThan executablePathSubstring:substring];
+}
+
+#pragma mark Public Methods
+
+- (BOOL)matchesCrashLog:(FBCrashLogInfo *)crashLog
+{
+  if (self.name && ![crashLog.name isEqualToString:self.name]) {
+    return NO;
+  }
+  if (self.identifier && ![crashLog.identifier isEqualToString:self.identifier]) {
+    return NO;
+  }
+  if (self.processIdentifier && crashLog.processIdentifier != self.processIdentifier.intValue) {
+    return NO;
+  }
+  if (self.processNames && (!crashLog.processName || ![self.processNames containsObject:crashLog.processName])) {
+    return NO;
+  }
+  if (self.newerThan && [crashLog.date compare:self.newerThan] != NSOrderedDescending) {
+    return NO;
+  }
+  if (self.olderThan && [crashLog.date compare:self.olderThan] == NSOrderedDescending) {
+    return NO;
+  }
+  if (self.executablePathSubstring && (!crashLog.executablePath || [crashLog.executablePath rangeOfString:self.executablePathSubstring].location == NSNotFound)) {
+    return NO;
+  }
+  return YES;
+}
+
+- (NSPredicate *)predicate
+{
+  FBCrashLogQuery *query = self;
+  return [NSPredicate predicateWithBlock:^ BOOL (FBCrashLogInfo *crashLog, NSDictionary<NSString *, id> *_) {
+    return [query matchesCrashLog:crashLog];
+  }];
+}
+
+#pragma mark NSObject
+
+- (NSString *)description
+{
+  NSMutableArray<NSString *> *components = NSMutableArray.array;
+  if (self.name) {
+    [components addObject:[NSString stringWithFormat:@"name %@", self.name]];
+  }
+  if (self.identifier) {
+    [components addObject:[NSString stringWithFormat:@"identifier %@", self.identifier]];
+  }
+  if (self.processNames) {
+    [components addObject:[NSString stringWithFormat:@"process names %@", [self.processNames.allObjects componentsJoinedByString:@", "]]];
+  }
+  if (self.processIdentifier) {
+    [components addObject:[NSString stringWithFormat:@"pid %@", self.processIdentifier]];
+  }
+  if (self.newerThan) {
+    [components addObject:[NSString stringWithFormat:@"newer than %@", self.newerThan]];
+  }
+  if (self.olderThan) {
+    [components addObject:[NSString stringWithFormat:@"older than %@", self.olderThan]];
+  }
+  if (self.executablePathSubstring) {
+    [components addObject:[NSString stringWithFormat:@"executable path containing %@", self.executablePathSubstring]];
+  }
+  return components.count == 0 ? @"All crash logs" : [components componentsJoinedByString:@" | "];
+}
+
+@end
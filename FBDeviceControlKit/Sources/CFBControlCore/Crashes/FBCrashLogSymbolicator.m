@@ -0,0 +1,557 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBCrashLogSymbolicator.h"
+
+#import "FBBinaryDescriptor.h"
+#import "FBConcatedJsonParser.h"
+#import "FBControlCoreError.h"
+#import "FBControlCoreLogger.h"
+#import "FBCrashLog.h"
+#import "FBCrashLogParser.h"
+
+#include <libkern/OSByteOrder.h>
+#include <stddef.h>
+
+#include <mach-o/fat.h>
+#include <mach-o/loader.h>
+#include <mach-o/nlist.h>
+
+static NSString *const KeyThreads = @"threads";
+static NSString *const KeyUsedImages = @"usedImages";
+static NSString *const IndexPathExtension = @"symbols";
+
+// 'FBSY', bumped with the version whenever the layout of an index or the symbols that are indexed change.
+static const uint32_t IndexMagic = 0x46425359;
+static const uint32_t IndexVersion = 1;
+
+// Set when the index was built from a dSYM, rather than from a binary that may have had its local symbols stripped.
+static const uint32_t IndexFlagDSYM = 1 << 0;
+
+/**
+ An index is a header, followed by the entries sorted by address, followed by the nul-terminated names of the entries.
+ The layout is the same in memory and on disk, so a persisted index is mapped and searched without being decoded.
+ */
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t flags;
+  uint32_t reserved;
+  uint64_t count;
+  uint64_t namesLength;
+} FBSymbolIndexHeader;
+
+typedef struct {
+  uint64_t address; // Relative to the start of the __TEXT segment, which is the load address of the image.
+  uint64_t nameOffset;
+} FBSymbolIndexEntry;
+
+static int CompareEntries(const void *left, const void *right)
+{
+  const FBSymbolIndexEntry *leftEntry = left;
+  const FBSymbolIndexEntry *rightEntry = right;
+  if (leftEntry->address != rightEntry->address) {
+    return leftEntry->address < rightEntry->address ? -1 : 1;
+  }
+  // Of the symbols at the same address, the first in the symbol table is kept.
+  return leftEntry->nameOffset < rightEntry->nameOffset ? -1 : (leftEntry->nameOffset > rightEntry->nameOffset ? 1 : 0);
+}
+
+static BOOL IndexIsValid(NSData *data)
+{
+  if (data.length < sizeof(FBSymbolIndexHeader)) {
+    return NO;
+  }
+  const FBSymbolIndexHeader *header = data.bytes;
+  if (header->magic != IndexMagic || header->version != IndexVersion) {
+    return NO;
+  }
+  if (header->count > data.length / sizeof(FBSymbolIndexEntry) || header->namesLength > data.length) {
+    return NO;
+  }
+  return data.length == sizeof(FBSymbolIndexHeader) + header->count * sizeof(FBSymbolIndexEntry) + header->namesLength;
+}
+
+// Builds the index of the symbols of a single 64-bit slice, provided that it has the requested UUID.
+// All reads are bounds-checked against the slice, as the binaries come from devices and may be truncated.
+static NSData *IndexOfSlice(const uint8_t *bytes, uint64_t length, NSUUID *uuid, uint32_t flags)
+{
+  if (length < sizeof(struct mach_header_64)) {
+    return nil;
+  }
+  struct mach_header_64 header;
+  memcpy(&header, bytes, sizeof(header));
+  if (header.magic != MH_MAGIC_64) {
+    return nil;
+  }
+
+  BOOL matchesUUID = NO;
+  BOOL hasTextSegment = NO;
+  uint64_t textAddress = 0;
+  struct symtab_command symtab = {0};
+  uint64_t offset = sizeof(struct mach_header_64);
+  for (uint32_t index = 0; index < header.ncmds; index++) {
+    struct load_command command;
+    if (offset > length || length - offset < sizeof(command)) {
+      return nil;
+    }
+    memcpy(&command, bytes + offset, sizeof(command));
+    if (command.cmdsize < sizeof(command) || length - offset < command.cmdsize) {
+      return nil;
+    }
+    if (command.cmd == LC_UUID && command.cmdsize >= sizeof(struct uuid_command)) {
+      struct uuid_command uuidCommand;
+      memcpy(&uuidCommand, bytes + offset, sizeof(uuidCommand));
+      matchesUUID = [[[NSUUID alloc] initWithUUIDBytes:uuidCommand.uuid] isEqual:uuid];
+    } else if (command.cmd == LC_SEGMENT_64 && command.cmdsize >= sizeof(struct segment_command_64)) {
+      struct segment_command_64 segment;
+      memcpy(&segment, bytes + offset, sizeof(segment));
+      if (strncmp(segment.segname, SEG_TEXT, sizeof(segment.segname)) == 0) {
+        textAddress = segment.vmaddr;
+        hasTextSegment = YES;
+      }
+    } else if (command.cmd == LC_SYMTAB && command.cmdsize >= sizeof(struct symtab_command)) {
+      memcpy(&symtab, bytes + offset, sizeof(symtab));
+    }
+    offset += command.cmdsize;
+  }
+  if (!matchesUUID || !hasTextSegment) {
+    return nil;
+  }
+  if (symtab.symoff > length || (length - symtab.symoff) / sizeof(struct nlist_64) < symtab.nsyms) {
+    return nil;
+  }
+  if (symtab.stroff > length || length - symtab.stroff < symtab.strsize) {
+    return nil;
+  }
+
+  // The names are copied out of the string table, as it also holds the names of the symbols that are not indexed.
+  const char *strings = (const char *) bytes + symtab.stroff;
+  FBSymbolIndexEntry *entries = malloc(MAX(symtab.nsyms, 1u) * sizeof(FBSymbolIndexEntry));
+  NSMutableData *names = [NSMutableData data];
+  uint64_t count = 0;
+  for (uint32_t index = 0; index < symtab.nsyms; index++) {
+    struct nlist_64 symbol;
+    memcpy(&symbol, bytes + symtab.symoff + index * sizeof(struct nlist_64), sizeof(symbol));
+    // Debugger entries are skipped, as are undefined and absolute symbols which do not have an address in the image.
+    if ((symbol.n_type & N_STAB) || (symbol.n_type & N_TYPE) != N_SECT) {
+      continue;
+    }
+    if (symbol.n_un.n_strx == 0 || symbol.n_un.n_strx >= symtab.strsize || symbol.n_value < textAddress) {
+      continue;
+    }
+    const char *name = strings + symbol.n_un.n_strx;
+    size_t nameLength = strnlen(name, symtab.strsize - symbol.n_un.n_strx);
+    // C symbols have a leading underscore, which atos does not show.
+    if (nameLength > 1 && name[0] == '_') {
+      name++;
+      nameLength--;
+    }
+    if (nameLength == 0) {
+      continue;
+    }
+    entries[count++] = (FBSymbolIndexEntry) {
+      .address = symbol.n_value - textAddress,
+      .nameOffset = names.length,
+    };
+    [names appendBytes:name length:nameLength];
+    [names appendBytes:"\0" length:1];
+  }
+  qsort(entries, count, sizeof(FBSymbolIndexEntry), CompareEntries);
+
+  // Aliases at the same address are collapsed, so that a search finds a single symbol.
+  uint64_t uniqueCount = 0;
+  for (uint64_t index = 0; index < count; index++) {
+    if (uniqueCount > 0 && entries[uniqueCount - 1].address == entries[index].address) {
+      continue;
+    }
+    entries[uniqueCount++] = entries[index];
+  }
+
+  FBSymbolIndexHeader indexHeader = {
+    .magic = IndexMagic,
+    .version = IndexVersion,
+    .flags = flags,
+    .count = uniqueCount,
+    .namesLength = names.length,
+  };
+  NSMutableData *index = [NSMutableData dataWithCapacity:sizeof(indexHeader) + uniqueCount * sizeof(FBSymbolIndexEntry) + names.length];
+  [index appendBytes:&indexHeader length:sizeof(indexHeader)];
+  [index appendBytes:entries length:uniqueCount * sizeof(FBSymbolIndexEntry)];
+  [index appendData:names];
+  free(entries);
+  return index;
+}
+
+static NSData *IndexOfBinary(NSData *data, NSUUID *uuid, uint32_t flags)
+{
+  const uint8_t *bytes = data.bytes;
+  uint64_t length = data.length;
+  uint32_t magic = 0;
+  if (length < sizeof(magic)) {
+    return nil;
+  }
+  memcpy(&magic, bytes, sizeof(magic));
+  // Fat headers are always big-endian.
+  magic = OSSwapBigToHostInt32(magic);
+  if (magic != FAT_MAGIC && magic != FAT_MAGIC_64) {
+    return IndexOfSlice(bytes, length, uuid, flags);
+  }
+  if (length < sizeof(struct fat_header)) {
+    return nil;
+  }
+  struct fat_header fatHeader;
+  memcpy(&fatHeader, bytes, sizeof(fatHeader));
+  uint32_t archCount = OSSwapBigToHostInt32(fatHeader.nfat_arch);
+  uint64_t archOffset = sizeof(struct fat_header);
+  for (uint32_t index = 0; index < archCount; index++) {
+    uint64_t sliceOffset = 0;
+    uint64_t sliceSize = 0;
+    if (magic == FAT_MAGIC_64) {
+      struct fat_arch_64 arch;
+      if (archOffset > length || length - archOffset < sizeof(arch)) {
+        return nil;
+      }
+      memcpy(&arch, bytes + archOffset, sizeof(arch));
+      sliceOffset = OSSwapBigToHostInt64(arch.offset);
+      sliceSize = OSSwapBigToHostInt64(arch.size);
+      archOffset += sizeof(arch);
+    } else {
+      struct fat_arch arch;
+      if (archOffset > length || length - archOffset < sizeof(arch)) {
+        return nil;
+      }
+      memcpy(&arch, bytes + archOffset, sizeof(arch));
+      sliceOffset = OSSwapBigToHostInt32(arch.offset);
+      sliceSize = OSSwapBigToHostInt32(arch.size);
+      archOffset += sizeof(arch);
+    }
+    if (sliceOffset > length || length - sliceOffset < sliceSize) {
+      return nil;
+    }
+    NSData *index = IndexOfSlice(bytes + sliceOffset, sliceSize, uuid, flags);
+    if (index) {
+      return index;
+    }
+  }
+  return nil;
+}
+
+// Finds the last symbol at or before the address.
+static NSString *SymbolInIndex(NSData *index, uint64_t address)
+{
+  const FBSymbolIndexHeader *header = index.bytes;
+  const FBSymbolIndexEntry *entries = (const FBSymbolIndexEntry *) (header + 1);
+  const char *names = (const char *) (entries + header->count);
+  uint64_t low = 0;
+  uint64_t high = header->count;
+  while (low < high) {
+    uint64_t middle = low + (high - low) / 2;
+    if (entries[middle].address <= address) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  if (low == 0) {
+    return nil;
+  }
+  const FBSymbolIndexEntry *entry = &entries[low - 1];
+  if (entry->nameOffset >= header->namesLength) {
+    return nil;
+  }
+  NSString *name = [[NSString alloc] initWithBytes:names + entry->nameOffset length:strnlen(names + entry->nameOffset, header->namesLength - entry->nameOffset) encoding:NSUTF8StringEncoding];
+  if (!name) {
+    return nil;
+  }
+  return [NSString stringWithFormat:@"%@ + %llu", name, address - entry->address];
+}
+
+@interface FBCrashLogSymbolicator ()
+
+@property (nonatomic, copy, nullable, readonly) NSString *indexDirectory;
+@property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSUUID *, NSString *> *binaryPaths;
+@property (nonatomic, strong, readonly) NSMutableSet<NSUUID *> *dSYMUUIDs;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSUUID *, id> *indices;
+
+@end
+
+@implementation FBCrashLogSymbolicator
+
+#pragma mark Initializers
+
++ (instancetype)symbolicatorWithIndexDirectory:(nullable NSString *)indexDirectory logger:(nullable id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithIndexDirectory:indexDirectory logger:logger];
+}
+
+- (instancetype)initWithIndexDirectory:(nullable NSString *)indexDirectory logger:(nullable id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _indexDirectory = indexDirectory;
+  _logger = logger;
+  _binaryPaths = NSMutableDictionary.dictionary;
+  _dSYMUUIDs = NSMutableSet.set;
+  _indices = NSMutableDictionary.dictionary;
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (BOOL)addBinaryAtPath:(NSString *)path error:(NSError **)error
+{
+  if ([path.pathExtension isEqualToString:@"dSYM"]) {
+    NSString *dwarfDirectory = [[[path stringByAppendingPathComponent:@"Contents"] stringByAppendingPathComponent:@"Resources"] stringByAppendingPathComponent:@"DWARF"];
+    NSArray<NSString *> *names = [NSFileManager.defaultManager contentsOfDirectoryAtPath:dwarfDirectory error:nil];
+    BOOL added = NO;
+    for (NSString *name in names) {
+      added |= [self addBinaryAtPath:[dwarfDirectory stringByAppendingPathComponent:name] isDSYM:YES error:nil];
+    }
+    if (!added) {
+      return [[FBControlCoreError describeFormat:@"dSYM at %@ does not contain any binaries", path] failBool:error];
+    }
+    return YES;
+  }
+  return [self addBinaryAtPath:path isDSYM:NO error:error];
+}
+
+- (NSUInteger)addBinariesInDirectory:(NSString *)directory
+{
+  NSUInteger count = 0;
+  NSDirectoryEnumerator<NSString *> *enumerator = [NSFileManager.defaultManager enumeratorAtPath:directory];
+  for (NSString *relativePath in enumerator) {
+    NSString *path = [directory stringByAppendingPathComponent:relativePath];
+    if ([relativePath.pathExtension isEqualToString:@"dSYM"]) {
+      [enumerator skipDescendants];
+      count += [self addBinaryAtPath:path error:nil] ? 1 : 0;
+      continue;
+    }
+    if (![enumerator.fileAttributes.fileType isEqualToString:NSFileTypeRegular]) {
+      continue;
+    }
+    count += [self addBinaryAtPath:path isDSYM:NO error:nil] ? 1 : 0;
+  }
+  [self.logger logFormat:@"Registered %lu binaries for symbolication in %@", (unsigned long) count, directory];
+  return count;
+}
+
+- (nullable NSString *)symbolForOffset:(uint64_t)offset inImageWithUUID:(NSUUID *)uuid
+{
+  NSData *index = [self indexForUUID:uuid];
+  if (!index) {
+    return nil;
+  }
+  return SymbolInIndex(index, offset);
+}
+
+- (nullable NSString *)symbolicatedCrashedThreadOfCrashLog:(FBCrashLog *)crashLog error:(NSError **)error
+{
+  NSData *data = [crashLog.contents dataUsingEncoding:NSUTF8StringEncoding];
+  __block NSData *threads = nil;
+  __block NSData *usedImages = nil;
+  BOOL success = [FBConcatedJsonParser enumerateMembersOfConcatenatedJSONData:data error:error usingBlock:^(NSString *key, NSData *value, BOOL *stop) {
+    if ([key isEqualToString:KeyThreads]) {
+      threads = threads ?: value;
+    } else if ([key isEqualToString:KeyUsedImages]) {
+      usedImages = usedImages ?: value;
+    }
+    *stop = threads && usedImages;
+  }];
+  if (!success) {
+    return nil;
+  }
+  NSArray<NSDictionary *> *frames = threads ? [FBConcatedJSONCrashLogParser framesOfCrashedThread:threads] : nil;
+  if (!frames) {
+    return [[FBControlCoreError describeFormat:@"Crash log %@ does not have a crashed thread", crashLog.info.name] fail:error];
+  }
+  NSDictionary<NSNumber *, NSDictionary<NSString *, id> *> *images = [FBCrashLogSymbolicator imagesOfUsedImages:usedImages usedByFrames:frames];
+
+  NSMutableString *description = [NSMutableString string];
+  for (NSDictionary *frame in frames) {
+    if (![frame isKindOfClass:NSDictionary.class]) {
+      continue;
+    }
+    NSDictionary<NSString *, id> *image = images[@([frame[@"imageIndex"] unsignedIntegerValue])];
+    NSString *imageName = [image[@"name"] isKindOfClass:NSString.class] ? image[@"name"] : nil;
+    uint64_t offset = [frame[@"imageOffset"] unsignedLongLongValue];
+    NSString *symbol = [self symbolOfFrame:frame image:image offset:offset];
+    if (imageName) {
+      [description appendString:(imageName.length < 30 ? [imageName stringByPaddingToLength:30 withString:@" " startingAtIndex:0] : imageName)];
+      [description appendString:@"\t"];
+    }
+    [description appendString:symbol ?: [NSString stringWithFormat:@"%@ + %llu", imageName ?: @"???", offset]];
+    [description appendString:@"\n"];
+  }
+  return [description stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceAndNewlineCharacterSet];
+}
+
+#pragma mark Private
+
+- (BOOL)addBinaryAtPath:(NSString *)path isDSYM:(BOOL)isDSYM error:(NSError **)error
+{
+  FBBinaryDescriptor *binary = [FBBinaryDescriptor binaryWithPath:path error:error];
+  if (!binary) {
+    return NO;
+  }
+  NSMutableSet<NSUUID *> *uuids = [NSMutableSet setWithArray:binary.uuidsByArchitecture.allValues];
+  if (binary.uuid) {
+    [uuids addObject:binary.uuid];
+  }
+  if (uuids.count == 0) {
+    return [[FBControlCoreError describeFormat:@"Binary at %@ does not have a UUID", path] failBool:error];
+  }
+  @synchronized (self) {
+    for (NSUUID *uuid in uuids) {
+      // A dSYM has the local symbols that are stripped from the binary, so it is preferred to a binary with the same UUID.
+      if (!isDSYM && (self.binaryPaths[uuid] || [self.dSYMUUIDs containsObject:uuid])) {
+        continue;
+      }
+      if (isDSYM) {
+        [self.dSYMUUIDs addObject:uuid];
+        [self.indices removeObjectForKey:uuid];
+      }
+      self.binaryPaths[uuid] = path;
+    }
+  }
+  return YES;
+}
+
+- (nullable NSData *)indexForUUID:(NSUUID *)uuid
+{
+  NSString *binaryPath = nil;
+  BOOL isDSYM = NO;
+  @synchronized (self) {
+    id index = self.indices[uuid];
+    if (index) {
+      return index == NSNull.null ? nil : index;
+    }
+    binaryPath = self.binaryPaths[uuid];
+    isDSYM = [self.dSYMUUIDs containsObject:uuid];
+  }
+  if (!binaryPath) {
+    return nil;
+  }
+
+  // The index is built outside of the lock, so frames in other images can be resolved meanwhile.
+  // Two threads may build the same index, in which case the first one is kept.
+  uint32_t flags = isDSYM ? IndexFlagDSYM : 0;
+  NSData *index = [self persistedIndexForUUID:uuid flags:flags] ?: [self buildIndexForUUID:uuid binaryPath:binaryPath flags:flags];
+  @synchronized (self) {
+    id existing = self.indices[uuid];
+    if (existing) {
+      return existing == NSNull.null ? nil : existing;
+    }
+    // Images that cannot be indexed are remembered, so that the binary is not mapped for every frame.
+    self.indices[uuid] = index ?: NSNull.null;
+  }
+  return index;
+}
+
+- (nullable NSData *)persistedIndexForUUID:(NSUUID *)uuid flags:(uint32_t)flags
+{
+  NSString *indexPath = [self indexPathForUUID:uuid];
+  if (!indexPath) {
+    return nil;
+  }
+  NSData *index = [NSData dataWithContentsOfFile:indexPath options:NSDataReadingMappedIfSafe error:nil];
+  if (!IndexIsValid(index)) {
+    return nil;
+  }
+  // An index that was built from a binary is rebuilt once a dSYM for it is available.
+  const FBSymbolIndexHeader *header = index.bytes;
+  if ((flags & IndexFlagDSYM) && !(header->flags & IndexFlagDSYM)) {
+    return nil;
+  }
+  return index;
+}
+
+- (nullable NSData *)buildIndexForUUID:(NSUUID *)uuid binaryPath:(NSString *)binaryPath flags:(uint32_t)flags
+{
+  // The binary is mapped, only the pages with the load commands and the symbol table are read.
+  NSError *error = nil;
+  NSData *binary = [NSData dataWithContentsOfFile:binaryPath options:NSDataReadingMappedAlways error:&error];
+  if (!binary) {
+    [self.logger logFormat:@"Failed to map %@ for symbolication: %@", binaryPath, error];
+    return nil;
+  }
+  NSData *index = IndexOfBinary(binary, uuid, flags);
+  if (!index) {
+    [self.logger logFormat:@"No symbols for %@ in %@", uuid.UUIDString, binaryPath];
+    return nil;
+  }
+  const FBSymbolIndexHeader *header = index.bytes;
+  [self.logger logFormat:@"Indexed %llu symbols for %@ from %@", header->count, uuid.UUIDString, binaryPath];
+
+  NSString *indexPath = [self indexPathForUUID:uuid];
+  if (!indexPath) {
+    return index;
+  }
+  if (![NSFileManager.defaultManager createDirectoryAtPath:self.indexDirectory withIntermediateDirectories:YES attributes:nil error:&error]
+    || ![index writeToFile:indexPath options:NSDataWritingAtomic error:&error]) {
+    [self.logger logFormat:@"Failed to persist symbol index to %@: %@", indexPath, error];
+    return index;
+  }
+  // The persisted index is mapped, so that its pages can be reclaimed rather than being held in memory.
+  return [self persistedIndexForUUID:uuid flags:flags] ?: index;
+}
+
+- (nullable NSString *)indexPathForUUID:(NSUUID *)uuid
+{
+  if (!self.indexDirectory) {
+    return nil;
+  }
+  return [[self.indexDirectory stringByAppendingPathComponent:uuid.UUIDString] stringByAppendingPathExtension:IndexPathExtension];
+}
+
+- (nullable NSString *)symbolOfFrame:(NSDictionary<NSString *, id> *)frame image:(nullable NSDictionary<NSString *, id> *)image offset:(uint64_t)offset
+{
+  NSString *symbol = frame[@"symbol"];
+  if ([symbol isKindOfClass:NSString.class]) {
+    NSNumber *location = frame[@"symbolLocation"];
+    return [location isKindOfClass:NSNumber.class] ? [NSString stringWithFormat:@"%@ + %@", symbol, location] : symbol;
+  }
+  NSString *uuidString = image[@"uuid"];
+  NSUUID *uuid = [uuidString isKindOfClass:NSString.class] ? [[NSUUID alloc] initWithUUIDString:uuidString] : nil;
+  if (!uuid) {
+    return nil;
+  }
+  return [self symbolForOffset:offset inImageWithUUID:uuid];
+}
+
++ (NSDictionary<NSNumber *, NSDictionary<NSString *, id> *> *)imagesOfUsedImages:(nullable NSData *)usedImages usedByFrames:(NSArray<NSDictionary *> *)frames
+{
+  // Only the images that the frames refer to are decoded.
+  NSMutableIndexSet *imageIndices = [NSMutableIndexSet indexSet];
+  for (NSDictionary *frame in frames) {
+    if ([frame isKindOfClass:NSDictionary.class]) {
+      [imageIndices addIndex:[frame[@"imageIndex"] unsignedIntegerValue]];
+    }
+  }
+  NSMutableDictionary<NSNumber *, NSDictionary<NSString *, id> *> *images = [NSMutableDictionary dictionary];
+  if (!usedImages || imageIndices.count == 0) {
+    return images;
+  }
+  [FBConcatedJsonParser enumerateElementsOfJSONArrayData:usedImages error:nil usingBlock:^(NSData *element, NSUInteger index, BOOL *stop) {
+    if (![imageIndices containsIndex:index]) {
+      *stop = index > imageIndices.lastIndex;
+      return;
+    }
+    NSDictionary<NSString *, id> *image = [FBConcatedJsonParser decodeJSONValue:element];
+    if ([image isKindOfClass:NSDictionary.class]) {
+      images[@(index)] = image;
+    }
+  }];
+  return images;
+}
+
+@end
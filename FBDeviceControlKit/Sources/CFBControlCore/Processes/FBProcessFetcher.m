@@ -41,13 +41,6 @@ static void IterateWith(pid_t *pidBuffer, size_t pidBufferSize, ProcessIterator
   }
 }
 
-static void IterateAllProcesses(pid_t *pidBuffer, size_t pidBufferSize, ProcessIterator iterator)
-{
-  IterateWith(pidBuffer, pidBufferSize, iterator, ^ int () {
-    return proc_listallpids(pidBuffer, (int) pidBufferSize);
-  });
-}
-
 static void IterateSubprocessesOf(pid_t *pidBuffer, size_t pidBufferSize, pid_t parent, ProcessIterator iterator)
 {
   IterateWith(pidBuffer, pidBufferSize, iterator, ^ int () {
@@ -155,6 +148,292 @@ static BOOL ProcessNameForProcessIdentifier(pid_t processIdentifier, char *buffe
   return proc_name(processIdentifier, buffer, (uint32_t) bufferSize) > 1;
 }
 
+static size_t MaxArgumentBufferSize = ARG_MAX; // A temporary value that is filled on load
+static size_t const MaxPidBufferSize = 5568 * 2 * sizeof(int);  // From 'ulimit -u', but twice as large, in ints.
+// The process table can grow between sizing and fetching it, so the fetch is retried a few times.
+static NSUInteger const ProcessTableFetchAttempts = 4;
+
+#pragma mark Snapshots
+
+typedef struct {
+  pid_t processIdentifier;
+  pid_t parentIdentifier;
+  // The kernel truncates this name to MAXCOMLEN, proc_name(3) gives the longer name.
+  char name[MAXCOMLEN + 1];
+} ProcessTableEntry;
+
+static int CompareProcessTableEntries(const void *left, const void *right)
+{
+  pid_t leftIdentifier = ((const ProcessTableEntry *) left)->processIdentifier;
+  pid_t rightIdentifier = ((const ProcessTableEntry *) right)->processIdentifier;
+  return (leftIdentifier > rightIdentifier) - (leftIdentifier < rightIdentifier);
+}
+
+static struct kinfo_proc *FetchProcessTable(size_t *countOut, NSError **error)
+{
+  int name[3] = {CTL_KERN, KERN_PROC, KERN_PROC_ALL};
+  for (NSUInteger attempt = 0; attempt < ProcessTableFetchAttempts; attempt++) {
+    size_t size = 0;
+    if (sysctl(name, 3, NULL, &size, NULL, 0) == -1) {
+      break;
+    }
+    // Leave room for processes that are launched between the two calls.
+    size += size / 8;
+    struct kinfo_proc *processes = malloc(size);
+    if (sysctl(name, 3, processes, &size, NULL, 0) == 0) {
+      *countOut = size / sizeof(struct kinfo_proc);
+      return processes;
+    }
+    free(processes);
+    if (errno != ENOMEM) {
+      break;
+    }
+  }
+  [[FBControlCoreError
+    describeFormat:@"Failed to fetch the process table: %s", strerror(errno)]
+    failBool:error];
+  return NULL;
+}
+
+@interface FBProcessTableSnapshot ()
+
+@property (nonatomic, assign, readonly) ProcessTableEntry *entries;
+@property (nonatomic, copy, readonly) NSDictionary<NSNumber *, NSIndexSet *> *entriesByParent;
+@property (nonatomic, copy, readonly) NSDictionary<NSString *, NSIndexSet *> *entriesByName;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSNumber *, id> *processInfoCache;
+@property (nonatomic, assign, readwrite) char *argumentBuffer;
+
+@end
+
+@implementation FBProcessTableSnapshot
+
+#pragma mark Initializers
+
++ (nullable instancetype)snapshotWithError:(NSError **)error
+{
+  size_t count = 0;
+  struct kinfo_proc *processes = FetchProcessTable(&count, error);
+  if (!processes) {
+    return nil;
+  }
+  ProcessTableEntry *entries = calloc(MAX(count, 1), sizeof(ProcessTableEntry));
+  for (size_t index = 0; index < count; index++) {
+    entries[index].processIdentifier = processes[index].kp_proc.p_pid;
+    entries[index].parentIdentifier = processes[index].kp_eproc.e_ppid;
+    strlcpy(entries[index].name, processes[index].kp_proc.p_comm, sizeof(entries[index].name));
+  }
+  free(processes);
+  // Sorted by identifier, for searching by identifier and so that every index lists processes in ascending order.
+  qsort(entries, count, sizeof(ProcessTableEntry), CompareProcessTableEntries);
+  return [[self alloc] initWithEntries:entries count:count];
+}
+
+- (instancetype)initWithEntries:(ProcessTableEntry *)entries count:(NSUInteger)count
+{
+  self = [super init];
+  if (!self) {
+    free(entries);
+    return nil;
+  }
+
+  _entries = entries;
+  _count = count;
+
+  NSMutableDictionary<NSNumber *, NSMutableIndexSet *> *entriesByParent = [NSMutableDictionary dictionary];
+  NSMutableDictionary<NSString *, NSMutableIndexSet *> *entriesByName = [NSMutableDictionary dictionary];
+  for (NSUInteger index = 0; index < count; index++) {
+    NSNumber *parent = @(entries[index].parentIdentifier);
+    NSMutableIndexSet *children = entriesByParent[parent];
+    if (!children) {
+      children = [NSMutableIndexSet indexSet];
+      entriesByParent[parent] = children;
+    }
+    [children addIndex:index];
+
+    NSString *name = [[NSString alloc] initWithUTF8String:entries[index].name];
+    if (!name) {
+      continue;
+    }
+    NSMutableIndexSet *named = entriesByName[name];
+    if (!named) {
+      named = [NSMutableIndexSet indexSet];
+      entriesByName[name] = named;
+    }
+    [named addIndex:index];
+  }
+  _entriesByParent = [entriesByParent copy];
+  _entriesByName = [entriesByName copy];
+  _processInfoCache = [NSMutableDictionary dictionary];
+
+  return self;
+}
+
+- (void)dealloc
+{
+  free(_entries);
+  free(_argumentBuffer);
+}
+
+#pragma mark Properties
+
+- (NSArray<NSNumber *> *)processIdentifiers
+{
+  return [self processIdentifiersAtIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, self.count)]];
+}
+
+#pragma mark Queries
+
+- (BOOL)containsProcess:(pid_t)processIdentifier
+{
+  return [self entryFor:processIdentifier] != NULL;
+}
+
+- (pid_t)parentOf:(pid_t)child
+{
+  const ProcessTableEntry *entry = [self entryFor:child];
+  return entry ? entry->parentIdentifier : -1;
+}
+
+- (nullable NSString *)nameOf:(pid_t)processIdentifier
+{
+  const ProcessTableEntry *entry = [self entryFor:processIdentifier];
+  if (!entry) {
+    return nil;
+  }
+  char name[2 * MAXCOMLEN + 1];
+  if (strlen(entry->name) == MAXCOMLEN && ProcessNameForProcessIdentifier(processIdentifier, name, sizeof(name))) {
+    return [[NSString alloc] initWithUTF8String:name];
+  }
+  return [[NSString alloc] initWithUTF8String:entry->name];
+}
+
+- (NSArray<NSNumber *> *)subprocessIdentifiersOf:(pid_t)parent
+{
+  return [self processIdentifiersAtIndexes:self.entriesByParent[@(parent)]];
+}
+
+- (NSArray<NSNumber *> *)processIdentifiersWithName:(NSString *)processName
+{
+  const char *needle = processName.UTF8String;
+  if (strlen(needle) < MAXCOMLEN) {
+    return [self processIdentifiersAtIndexes:self.entriesByName[processName]];
+  }
+  // A name this long is truncated in the table, so candidates are confirmed against the full name.
+  NSMutableArray<NSNumber *> *processIdentifiers = [NSMutableArray array];
+  char name[2 * MAXCOMLEN + 1];
+  for (NSUInteger index = 0; index < self.count; index++) {
+    const ProcessTableEntry *entry = &self.entries[index];
+    if (strncmp(entry->name, needle, MAXCOMLEN) != 0) {
+      continue;
+    }
+    if (!ProcessNameForProcessIdentifier(entry->processIdentifier, name, sizeof(name)) || strcmp(name, needle) != 0) {
+      continue;
+    }
+    [processIdentifiers addObject:@(entry->processIdentifier)];
+  }
+  return [processIdentifiers copy];
+}
+
+- (pid_t)subprocessOf:(pid_t)parent withName:(NSString *)name
+{
+  const char *needle = name.UTF8String;
+  __block pid_t foundProcess = -1;
+  [self.entriesByParent[@(parent)] enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+    const ProcessTableEntry *entry = &self.entries[index];
+    char fullName[2 * MAXCOMLEN + 1];
+    if (strstr(entry->name, needle) == NULL) {
+      // The needle may be in the part of the name that was truncated.
+      if (strlen(entry->name) < MAXCOMLEN) {
+        return;
+      }
+      if (!ProcessNameForProcessIdentifier(entry->processIdentifier, fullName, sizeof(fullName)) || strstr(fullName, needle) == NULL) {
+        return;
+      }
+    }
+    foundProcess = entry->processIdentifier;
+    *stop = YES;
+  }];
+  return foundProcess;
+}
+
+- (nullable FBProcessInfo *)processInfoFor:(pid_t)processIdentifier
+{
+  if (![self containsProcess:processIdentifier]) {
+    return nil;
+  }
+  @synchronized (self) {
+    id cached = self.processInfoCache[@(processIdentifier)];
+    if (cached) {
+      return cached == NSNull.null ? nil : cached;
+    }
+    if (!self.argumentBuffer) {
+      self.argumentBuffer = malloc(MaxArgumentBufferSize);
+    }
+    FBProcessInfo *processInfo = ProcessInfoForProcessIdentifier(processIdentifier, self.argumentBuffer, MaxArgumentBufferSize);
+    self.processInfoCache[@(processIdentifier)] = processInfo ?: NSNull.null;
+    return processInfo;
+  }
+}
+
+- (NSArray<FBProcessInfo *> *)processesWithProcessName:(NSString *)processName
+{
+  NSMutableArray<FBProcessInfo *> *processes = [NSMutableArray array];
+  for (NSNumber *processIdentifier in [self processIdentifiersWithName:processName]) {
+    FBProcessInfo *processInfo = [self processInfoFor:processIdentifier.intValue];
+    if (!processInfo) {
+      continue;
+    }
+    [processes addObject:processInfo];
+  }
+  return [processes copy];
+}
+
+#pragma mark NSObject
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"Process Table Snapshot of %lu processes", (unsigned long) self.count];
+}
+
+#pragma mark Private
+
+- (nullable const ProcessTableEntry *)entryFor:(pid_t)processIdentifier
+{
+  ProcessTableEntry key = {.processIdentifier = processIdentifier};
+  return bsearch(&key, self.entries, self.count, sizeof(ProcessTableEntry), CompareProcessTableEntries);
+}
+
+- (NSArray<NSNumber *> *)processIdentifiersAtIndexes:(nullable NSIndexSet *)indexes
+{
+  NSMutableArray<NSNumber *> *processIdentifiers = [NSMutableArray arrayWithCapacity:indexes.count];
+  [indexes enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+    [processIdentifiers addObject:@(self.entries[index].processIdentifier)];
+  }];
+  return [processIdentifiers copy];
+}
+
+@end
+
+static unsigned long DispatchProcFlagsForEvents(FBProcessEvent events)
+{
+  unsigned long flags = 0;
+  flags |= (events & FBProcessEventExit) ? DISPATCH_PROC_EXIT : 0;
+  flags |= (events & FBProcessEventFork) ? DISPATCH_PROC_FORK : 0;
+  flags |= (events & FBProcessEventExec) ? DISPATCH_PROC_EXEC : 0;
+  flags |= (events & FBProcessEventSignal) ? DISPATCH_PROC_SIGNAL : 0;
+  return flags;
+}
+
+static FBProcessEvent EventsForDispatchProcFlags(unsigned long flags)
+{
+  FBProcessEvent events = 0;
+  events |= (flags & DISPATCH_PROC_EXIT) ? FBProcessEventExit : 0;
+  events |= (flags & DISPATCH_PROC_FORK) ? FBProcessEventFork : 0;
+  events |= (flags & DISPATCH_PROC_EXEC) ? FBProcessEventExec : 0;
+  events |= (flags & DISPATCH_PROC_SIGNAL) ? FBProcessEventSignal : 0;
+  return events;
+}
+
 @interface FBProcessFetcher ()
 
 @property (nonatomic, assign, readonly) size_t argumentBufferSize;
@@ -169,9 +448,6 @@ static BOOL ProcessNameForProcessIdentifier(pid_t processIdentifier, char *buffe
 
 #pragma mark Lifecycle
 
-static size_t MaxArgumentBufferSize = ARG_MAX; // A temporary value that is filled on load
-static size_t const MaxPidBufferSize = 5568 * 2 * sizeof(int);  // From 'ulimit -u', but twice as large, in ints.
-
 + (void)load
 {
    int name[2] = {CTL_KERN, KERN_ARGMAX};
@@ -204,6 +480,11 @@ static size_t const MaxPidBufferSize = 5568 * 2 * sizeof(int);  // From 'ulimit
 
 #pragma mark Queries
 
+- (nullable FBProcessTableSnapshot *)snapshotWithError:(NSError **)error
+{
+  return [FBProcessTableSnapshot snapshotWithError:error];
+}
+
 - (nullable FBProcessInfo *)processInfoFor:(pid_t)processIdentifier
 {
   return ProcessInfoForProcessIdentifier(
@@ -230,27 +511,8 @@ static size_t const MaxPidBufferSize = 5568 * 2 * sizeof(int);  // From 'ulimit
 
 - (NSArray<FBProcessInfo *> *)processesWithProcessName:(NSString *)processName
 {
-  NSMutableArray *subprocesses = [NSMutableArray array];
-  size_t bufferSize = self.argumentBufferSize;
-  char *buffer = self.argumentBuffer;
-  const char *needle = processName.UTF8String;
-
-  IterateAllProcesses(self.pidBuffer, self.pidBufferSize, ^ BOOL (pid_t pid) {
-    if (!ProcessNameForProcessIdentifier(pid, buffer, bufferSize)) {
-      return YES;
-    }
-    if (strcmp(needle, buffer) != 0) {
-      return YES;
-    }
-    FBProcessInfo *info = [self processInfoFor:pid];
-    if (!info) {
-      return YES;
-    }
-    [subprocesses addObject:info];
-    return YES;
-  });
-
-  return [subprocesses copy];
+  // A single pass over the process table, rather than a name lookup for every process.
+  return [[self snapshotWithError:nil] processesWithProcessName:processName] ?: @[];
 }
 
 - (pid_t)subprocessOf:(pid_t)parent withName:(NSString *)needleString
@@ -365,6 +627,93 @@ static size_t const MaxPidBufferSize = 5568 * 2 * sizeof(int);  // From 'ulimit
     }];
 }
 
++ (FBFuture<NSNull *> *)onQueue:(dispatch_queue_t)queue observeEvents:(FBProcessEvent)events ofProcess:(pid_t)processIdentifier handler:(nullable void (^)(FBProcessEvent events))handler
+{
+  FBMutableFuture<NSNull *> *exited = [FBMutableFuture futureWithNameFormat:@"Exit of process %d", processIdentifier];
+  // Exit is always observed, so that the source is cancelled along with the process.
+  // libdispatch delivers an exit for a process that has already exited, including one that is a zombie, so there is no window in which an exit is missed.
+  dispatch_source_t source = dispatch_source_create(
+    DISPATCH_SOURCE_TYPE_PROC,
+    (uintptr_t) processIdentifier,
+    DispatchProcFlagsForEvents(events | FBProcessEventExit),
+    queue
+  );
+  dispatch_source_set_event_handler(source, ^{
+    FBProcessEvent delivered = EventsForDispatchProcFlags(dispatch_source_get_data(source));
+    if (handler && (delivered & events)) {
+      handler(delivered & events);
+    }
+    if (delivered & FBProcessEventExit) {
+      // The source references itself in this handler, cancelling releases it.
+      dispatch_cancel(source);
+      [exited resolveWithResult:NSNull.null];
+    }
+  });
+  dispatch_resume(source);
+  return [exited onQueue:queue respondToCancellation:^{
+    dispatch_cancel(source);
+    return FBFuture.empty;
+  }];
+}
+
++ (FBFuture<NSNull *> *)onQueue:(dispatch_queue_t)queue waitForExitOfProcess:(pid_t)processIdentifier
+{
+  return [self onQueue:queue observeEvents:FBProcessEventExit ofProcess:processIdentifier handler:nil];
+}
+
++ (FBFuture<NSNumber *> *)onQueue:(dispatch_queue_t)queue waitForSubprocessOf:(pid_t)parent withName:(NSString *)name
+{
+  dispatch_queue_t observationQueue = dispatch_queue_create("com.facebook.fbcontrolcore.process_fetcher.subprocess_wait", DISPATCH_QUEUE_SERIAL);
+  FBProcessFetcher *fetcher = [[FBProcessFetcher alloc] init];
+  FBMutableFuture<NSNumber *> *found = [FBMutableFuture futureWithNameFormat:@"Subprocess of %d named %@", parent, name];
+  // Accessed on the observation queue.
+  NSMutableDictionary<NSNumber *, FBFuture<NSNull *> *> *childObservations = [NSMutableDictionary dictionary];
+
+  void (^resolveIfFound)(void) = ^{
+    pid_t child = [fetcher subprocessOf:parent withName:name];
+    if (child != -1) {
+      [found resolveWithResult:@(child)];
+    }
+  };
+  // A forked child has the name of its parent until it execs, so each new child is observed until it does.
+  void (^observeNewChildren)(void) = ^{
+    IterateSubprocessesOf(fetcher.pidBuffer, fetcher.pidBufferSize, parent, ^ BOOL (pid_t child) {
+      NSNumber *key = @(child);
+      if (childObservations[key]) {
+        return YES;
+      }
+      FBFuture<NSNull *> *childObservation = [self onQueue:observationQueue observeEvents:FBProcessEventExec ofProcess:child handler:^(FBProcessEvent childEvents) {
+        resolveIfFound();
+      }];
+      childObservations[key] = childObservation;
+      [childObservation onQueue:observationQueue notifyOfCompletion:^(FBFuture *_) {
+        [childObservations removeObjectForKey:key];
+      }];
+      return YES;
+    });
+    resolveIfFound();
+  };
+
+  FBFuture<NSNull *> *parentObservation = [self onQueue:observationQueue observeEvents:FBProcessEventFork ofProcess:parent handler:^(FBProcessEvent events) {
+    observeNewChildren();
+  }];
+  [parentObservation onQueue:observationQueue notifyOfCompletion:^(FBFuture *_) {
+    [found resolveWithError:[[FBControlCoreError
+      describeFormat:@"Process %d exited before a subprocess named %@ appeared", parent, name]
+      build]];
+  }];
+  // Once resolved, failed or cancelled, stop observing.
+  [found onQueue:observationQueue notifyOfCompletion:^(FBFuture *_) {
+    [parentObservation cancel];
+    for (FBFuture<NSNull *> *childObservation in childObservations.allValues) {
+      [childObservation cancel];
+    }
+  }];
+  dispatch_async(observationQueue, observeNewChildren);
+
+  return found;
+}
+
 + (FBFuture<NSString *> *)performSampleStackshotForProcessIdentifier:(pid_t)processIdentifier queue:(dispatch_queue_t)queue
 {
   return [[[[[FBProcessBuilder
@@ -7,6 +7,9 @@
 
 #import "FBProcessTerminationStrategy.h"
 
+#import <libproc.h>
+
+#import "FBCollectionInformation.h"
 #import "FBProcessFetcher.h"
 #import "FBProcessInfo.h"
 #import "FBControlCoreError.h"
@@ -26,6 +29,26 @@
 
 static NSTimeInterval ProcessTableRemovalTimeout = 20.0;
 
+static NSArray<NSNumber *> *ProcessGroupMembers(pid_t processGroup)
+{
+  int size = proc_listpids(PROC_PGRP_ONLY, (uint32_t) processGroup, NULL, 0);
+  if (size <= 0) {
+    return @[];
+  }
+  // Leave room for processes that join the group between the two calls.
+  size += 16 * sizeof(pid_t);
+  pid_t *buffer = malloc((size_t) size);
+  int filled = proc_listpids(PROC_PGRP_ONLY, (uint32_t) processGroup, buffer, size);
+  NSMutableArray<NSNumber *> *members = NSMutableArray.array;
+  for (int index = 0; index < filled / (int) sizeof(pid_t); index++) {
+    if (buffer[index] > 0) {
+      [members addObject:@(buffer[index])];
+    }
+  }
+  free(buffer);
+  return members;
+}
+
 static const FBProcessTerminationStrategyConfiguration FBProcessTerminationStrategyConfigurationDefault = {
   .signo = SIGKILL,
   .options =
@@ -107,7 +130,7 @@ static const FBProcessTerminationStrategyConfiguration FBProcessTerminationStrat
   [self.logger.debug logFormat:@"Waiting on %d to dissappear from the process table", processIdentifier];
   return [[[self
     onQueue:self.workQueue waitForProcessIdentifierToDie:processIdentifier processFetcher:self.processFetcher]
-    timeout:ProcessTableRemovalTimeout waitingFor:@"Process %d to be removed from the process table", processIdentifier]
+    timeout:self.exitTimeout waitingFor:@"Process %d to be removed from the process table", processIdentifier]
     onQueue:self.workQueue chain:^FBFuture *(FBFuture *future) {
       if (future.result) {
         [self.logger.debug logFormat:@"Process %d terminated", processIdentifier];
@@ -132,8 +155,91 @@ static const FBProcessTerminationStrategyConfiguration FBProcessTerminationStrat
     }];
 }
 
+- (FBFuture<NSNull *> *)killProcessIdentifiers:(NSArray<NSNumber *> *)processIdentifiers
+{
+  // Signal every process before waiting on any of them, so that they exit concurrently.
+  NSMutableArray<NSNumber *> *signalled = NSMutableArray.array;
+  for (NSNumber *processIdentifier in processIdentifiers) {
+    if (kill(processIdentifier.intValue, self.configuration.signo) == 0) {
+      [signalled addObject:processIdentifier];
+      continue;
+    }
+    if (errno == ESRCH) {
+      continue;
+    }
+    return [[FBControlCoreError
+      describeFormat:@"Failed to kill %@: '%s'", processIdentifier, strerror(errno)]
+      failFuture];
+  }
+  [self.logger.debug logFormat:@"Signalled %lu processes with %d", (unsigned long) signalled.count, self.configuration.signo];
+  return [self waitForExitOfProcessIdentifiers:signalled];
+}
+
+- (FBFuture<NSNull *> *)killProcessGroup:(pid_t)processGroup
+{
+  NSArray<NSNumber *> *members = ProcessGroupMembers(processGroup);
+  if (killpg(processGroup, self.configuration.signo) != 0 && errno != ESRCH) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to kill process group %d: '%s'", processGroup, strerror(errno)]
+      failFuture];
+  }
+  [self.logger.debug logFormat:@"Signalled process group %d of %lu processes with %d", processGroup, (unsigned long) members.count, self.configuration.signo];
+  return [self waitForExitOfProcessIdentifiers:members];
+}
+
 #pragma mark Private
 
+- (NSTimeInterval)exitTimeout
+{
+  // A SIGKILL can't be backed off from, so it has the full time to be removed from the process table.
+  if (self.configuration.signo == SIGKILL || self.configuration.backoffTimeout <= 0) {
+    return ProcessTableRemovalTimeout;
+  }
+  return self.configuration.backoffTimeout;
+}
+
+- (FBFuture<NSNull *> *)waitForExitOfProcessIdentifiers:(NSArray<NSNumber *> *)processIdentifiers
+{
+  BOOL checkDeath = (self.configuration.options & FBProcessTerminationStrategyOptionsCheckDeathAfterSignal) == FBProcessTerminationStrategyOptionsCheckDeathAfterSignal;
+  if (!checkDeath || processIdentifiers.count == 0) {
+    return FBFuture.empty;
+  }
+
+  NSMutableArray<FBFuture<NSNull *> *> *exits = NSMutableArray.array;
+  for (NSNumber *processIdentifier in processIdentifiers) {
+    [exits addObject:[FBProcessFetcher onQueue:self.workQueue waitForExitOfProcess:processIdentifier.intValue]];
+  }
+  return [[[FBFuture
+    futureWithFutures:exits]
+    timeout:self.exitTimeout waitingFor:@"%lu processes to be removed from the process table", (unsigned long) processIdentifiers.count]
+    onQueue:self.workQueue chain:^ FBFuture<NSNull *> * (FBFuture *future) {
+      if (future.result) {
+        [self.logger.debug logFormat:@"%lu processes terminated", (unsigned long) processIdentifiers.count];
+        return FBFuture.empty;
+      }
+      NSMutableArray<NSNumber *> *survivors = NSMutableArray.array;
+      for (NSUInteger index = 0; index < exits.count; index++) {
+        if (exits[index].state != FBFutureStateDone) {
+          [survivors addObject:processIdentifiers[index]];
+        }
+      }
+      BOOL backoff = (self.configuration.options & FBProcessTerminationStrategyOptionsBackoffToSIGKILL) == FBProcessTerminationStrategyOptionsBackoffToSIGKILL;
+      if (self.configuration.signo == SIGKILL || !backoff) {
+        return [[FBControlCoreError
+          describeFormat:@"Timed out waiting for %@ to dissapear from the process table", [FBCollectionInformation oneLineDescriptionFromArray:survivors]]
+          failFuture];
+      }
+
+      // Try the survivors with SIGKILL instead.
+      FBProcessTerminationStrategyConfiguration configuration = self.configuration;
+      configuration.signo = SIGKILL;
+      [self.logger.debug logFormat:@"Backing off kill of %@ to SIGKILL", [FBCollectionInformation oneLineDescriptionFromArray:survivors]];
+      return [[self
+        strategyWithConfiguration:configuration]
+        killProcessIdentifiers:survivors];
+    }];
+}
+
 - (FBProcessTerminationStrategy *)strategyWithConfiguration:(FBProcessTerminationStrategyConfiguration)configuration
 {
   return [FBProcessTerminationStrategy strategyWithConfiguration:configuration processFetcher:self.processFetcher workQueue:self.workQueue logger:self.logger];
@@ -141,10 +247,7 @@ static const FBProcessTerminationStrategyConfiguration FBProcessTerminationStrat
 
 - (FBFuture<NSNull *> *)onQueue:(dispatch_queue_t)queue waitForProcessIdentifierToDie:(pid_t)processIdentifier processFetcher:(FBProcessFetcher *)processFetcher
 {
-  return [FBFuture onQueue:queue resolveWhen:^ BOOL {
-    FBProcessInfo *polledProcess = [processFetcher processInfoFor:processIdentifier];
-    return polledProcess == nil;
-  }];
+  return [FBProcessFetcher onQueue:queue waitForExitOfProcess:processIdentifier];
 }
 
 @end
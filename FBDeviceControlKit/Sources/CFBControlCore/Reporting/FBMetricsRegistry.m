@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBMetricsRegistry.h"
+
+#import <stdatomic.h>
+
+// Each power of two is split into this many linear sub-buckets, which bounds the relative error of a bucket to 1/16.
+static const unsigned int HistogramSubBucketBits = 4;
+static const unsigned int HistogramSubBucketCount = 1 << HistogramSubBucketBits;
+// Values below the sub-bucket count have a bucket each, then each remaining power of two up to 2^63 has a set of sub-buckets.
+#define HistogramBucketCount ((64 - HistogramSubBucketBits + 1) * (1 << HistogramSubBucketBits))
+
+static unsigned int HistogramBucketIndex(uint64_t value)
+{
+  if (value < HistogramSubBucketCount) {
+    return (unsigned int) value;
+  }
+  unsigned int exponent = 63 - (unsigned int) __builtin_clzll(value);
+  unsigned int subBucket = (unsigned int) (value >> (exponent - HistogramSubBucketBits)) & (HistogramSubBucketCount - 1);
+  return (exponent - HistogramSubBucketBits + 1) * HistogramSubBucketCount + subBucket;
+}
+
+static uint64_t HistogramBucketLowerBound(unsigned int index)
+{
+  if (index < HistogramSubBucketCount) {
+    return index;
+  }
+  unsigned int exponent = index / HistogramSubBucketCount + HistogramSubBucketBits - 1;
+  uint64_t subBucket = index % HistogramSubBucketCount;
+  return (HistogramSubBucketCount + subBucket) << (exponent - HistogramSubBucketBits);
+}
+
+@implementation FBMetricsCounter
+{
+  _Atomic(uint64_t) _value;
+}
+
+- (instancetype)initWithName:(NSString *)name
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _name = [name copy];
+  atomic_init(&_value, 0);
+
+  return self;
+}
+
+- (uint64_t)value
+{
+  return atomic_load_explicit(&_value, memory_order_relaxed);
+}
+
+- (void)increment
+{
+  atomic_fetch_add_explicit(&_value, 1, memory_order_relaxed);
+}
+
+- (void)add:(uint64_t)value
+{
+  atomic_fetch_add_explicit(&_value, value, memory_order_relaxed);
+}
+
+@end
+
+@implementation FBMetricsGauge
+{
+  _Atomic(int64_t) _value;
+}
+
+- (instancetype)initWithName:(NSString *)name
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _name = [name copy];
+  atomic_init(&_value, 0);
+
+  return self;
+}
+
+- (int64_t)value
+{
+  return atomic_load_explicit(&_value, memory_order_relaxed);
+}
+
+- (void)set:(int64_t)value
+{
+  atomic_store_explicit(&_value, value, memory_order_relaxed);
+}
+
+- (void)add:(int64_t)delta
+{
+  atomic_fetch_add_explicit(&_value, delta, memory_order_relaxed);
+}
+
+@end
+
+@interface FBMetricsHistogramSnapshot ()
+
+@property (nonatomic, copy, readonly) NSData *buckets;
+
+@end
+
+@implementation FBMetricsHistogramSnapshot
+
+- (instancetype)initWithBuckets:(NSData *)buckets count:(uint64_t)count sum:(uint64_t)sum minimum:(uint64_t)minimum maximum:(uint64_t)maximum
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _buckets = buckets;
+  _count = count;
+  _sum = sum;
+  _minimum = minimum;
+  _maximum = maximum;
+
+  return self;
+}
+
+- (uint64_t)valueAtPercentile:(double)percentile
+{
+  // The buckets are copied one at a time, so their total can differ slightly from the count.
+  const uint64_t *buckets = self.buckets.bytes;
+  uint64_t total = 0;
+  for (unsigned int index = 0; index < HistogramBucketCount; index++) {
+    total += buckets[index];
+  }
+  if (total == 0) {
+    return 0;
+  }
+  uint64_t target = (uint64_t) ceil(MIN(MAX(percentile, 0), 100) / 100 * total);
+  uint64_t seen = 0;
+  for (unsigned int index = 0; index < HistogramBucketCount; index++) {
+    seen += buckets[index];
+    if (seen >= target && buckets[index] > 0) {
+      return MIN(MAX(HistogramBucketLowerBound(index), self.minimum), self.maximum);
+    }
+  }
+  return self.maximum;
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"count %llu | min %llu | p50 %llu | p99 %llu | max %llu", self.count, self.minimum, [self valueAtPercentile:50], [self valueAtPercentile:99], self.maximum];
+}
+
+@end
+
+@implementation FBMetricsHistogram
+{
+  _Atomic(uint64_t) _buckets[HistogramBucketCount];
+  _Atomic(uint64_t) _count;
+  _Atomic(uint64_t) _sum;
+  _Atomic(uint64_t) _minimum;
+  _Atomic(uint64_t) _maximum;
+}
+
+- (instancetype)initWithName:(NSString *)name
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _name = [name copy];
+  for (unsigned int index = 0; index < HistogramBucketCount; index++) {
+    atomic_init(&_buckets[index], 0);
+  }
+  atomic_init(&_count, 0);
+  atomic_init(&_sum, 0);
+  atomic_init(&_minimum, UINT64_MAX);
+  atomic_init(&_maximum, 0);
+
+  return self;
+}
+
+- (void)record:(uint64_t)value
+{
+  atomic_fetch_add_explicit(&_buckets[HistogramBucketIndex(value)], 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&_count, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&_sum, value, memory_order_relaxed);
+  uint64_t minimum = atomic_load_explicit(&_minimum, memory_order_relaxed);
+  while (value < minimum && !atomic_compare_exchange_weak_explicit(&_minimum, &minimum, value, memory_order_relaxed, memory_order_relaxed)) {
+  }
+  uint64_t maximum = atomic_load_explicit(&_maximum, memory_order_relaxed);
+  while (value > maximum && !atomic_compare_exchange_weak_explicit(&_maximum, &maximum, value, memory_order_relaxed, memory_order_relaxed)) {
+  }
+}
+
+- (void)recordNanosecondsSince:(uint64_t)startTime
+{
+  [self record:clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - startTime];
+}
+
+- (FBMetricsHistogramSnapshot *)snapshot
+{
+  NSMutableData *buckets = [NSMutableData dataWithLength:sizeof(uint64_t) * HistogramBucketCount];
+  uint64_t *copied = buckets.mutableBytes;
+  for (unsigned int index = 0; index < HistogramBucketCount; index++) {
+    copied[index] = atomic_load_explicit(&_buckets[index], memory_order_relaxed);
+  }
+  uint64_t count = atomic_load_explicit(&_count, memory_order_relaxed);
+  uint64_t minimum = atomic_load_explicit(&_minimum, memory_order_relaxed);
+  return [[FBMetricsHistogramSnapshot alloc]
+    initWithBuckets:buckets
+    count:count
+    sum:atomic_load_explicit(&_sum, memory_order_relaxed)
+    minimum:(count == 0 ? 0 : minimum)
+    maximum:atomic_load_explicit(&_maximum, memory_order_relaxed)];
+}
+
+@end
+
+@interface FBMetricsRegistry ()
+
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, id> *metrics;
+
+@end
+
+@implementation FBMetricsRegistry
+
+#pragma mark Initializers
+
++ (FBMetricsRegistry *)sharedRegistry
+{
+  static dispatch_once_t onceToken;
+  static FBMetricsRegistry *registry;
+  dispatch_once(&onceToken, ^{
+    registry = [[self alloc] init];
+  });
+  return registry;
+}
+
+- (instancetype)init
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _metrics = NSMutableDictionary.dictionary;
+
+  return self;
+}
+
+#pragma mark Metrics
+
+- (FBMetricsCounter *)counterWithName:(NSString *)name
+{
+  return [self metricWithName:name class:FBMetricsCounter.class];
+}
+
+- (FBMetricsGauge *)gaugeWithName:(NSString *)name
+{
+  return [self metricWithName:name class:FBMetricsGauge.class];
+}
+
+- (FBMetricsHistogram *)histogramWithName:(NSString *)name
+{
+  return [self metricWithName:name class:FBMetricsHistogram.class];
+}
+
+#pragma mark Export
+
+- (NSDictionary<NSString *, id> *)snapshot
+{
+  NSDictionary<NSString *, id> *metrics = nil;
+  @synchronized (self.metrics) {
+    metrics = [self.metrics copy];
+  }
+  NSMutableDictionary<NSString *, id> *snapshot = NSMutableDictionary.dictionary;
+  for (NSString *name in metrics) {
+    id metric = metrics[name];
+    if ([metric isKindOfClass:FBMetricsCounter.class]) {
+      snapshot[name] = @([(FBMetricsCounter *) metric value]);
+    } else if ([metric isKindOfClass:FBMetricsGauge.class]) {
+      snapshot[name] = @([(FBMetricsGauge *) metric value]);
+    } else if ([metric isKindOfClass:FBMetricsHistogram.class]) {
+      FBMetricsHistogramSnapshot *histogram = [(FBMetricsHistogram *) metric snapshot];
+      snapshot[name] = @{
+        @"count": @(histogram.count),
+        @"sum": @(histogram.sum),
+        @"min": @(histogram.minimum),
+        @"max": @(histogram.maximum),
+        @"p50": @([histogram valueAtPercentile:50]),
+        @"p90": @([histogram valueAtPercentile:90]),
+        @"p99": @([histogram valueAtPercentile:99]),
+        @"p999": @([histogram valueAtPercentile:99.9]),
+      };
+    }
+  }
+  return [snapshot copy];
+}
+
+- (NSData *)JSONDataWithError:(NSError **)error
+{
+  return [NSJSONSerialization dataWithJSONObject:self.snapshot options:NSJSONWritingSortedKeys error:error];
+}
+
+- (NSString *)prometheusText
+{
+  NSDictionary<NSString *, id> *metrics = nil;
+  @synchronized (self.metrics) {
+    metrics = [self.metrics copy];
+  }
+  NSMutableString *text = NSMutableString.string;
+  for (NSString *name in [metrics.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+    id metric = metrics[name];
+    NSString *exportedName = [name stringByReplacingOccurrencesOfString:@"." withString:@"_"];
+    if ([metric isKindOfClass:FBMetricsCounter.class]) {
+      [text appendFormat:@"# TYPE %@ counter\n%@ %llu\n", exportedName, exportedName, [(FBMetricsCounter *) metric value]];
+    } else if ([metric isKindOfClass:FBMetricsGauge.class]) {
+      [text appendFormat:@"# TYPE %@ gauge\n%@ %lld\n", exportedName, exportedName, [(FBMetricsGauge *) metric value]];
+    } else if ([metric isKindOfClass:FBMetricsHistogram.class]) {
+      FBMetricsHistogramSnapshot *histogram = [(FBMetricsHistogram *) metric snapshot];
+      [text appendFormat:@"# TYPE %@ summary\n", exportedName];
+      for (NSNumber *quantile in @[@0.5, @0.9, @0.99, @0.999]) {
+        [text appendFormat:@"%@{quantile=\"%@\"} %llu\n", exportedName, quantile, [histogram valueAtPercentile:quantile.doubleValue * 100]];
+      }
+      [text appendFormat:@"%@_sum %llu\n%@_count %llu\n", exportedName, histogram.sum, exportedName, histogram.count];
+    }
+  }
+  return [text copy];
+}
+
+#pragma mark Private
+
+- (id)metricWithName:(NSString *)name class:(Class)class
+{
+  @synchronized (self.metrics) {
+    id metric = self.metrics[name];
+    if (!metric) {
+      metric = [(FBMetricsCounter *) [class alloc] initWithName:name];
+      self.metrics[name] = metric;
+    }
+    NSAssert([metric isKindOfClass:class], @"Metric %@ is a %@, not a %@", name, [metric class], class);
+    return metric;
+  }
+}
+
+@end
@@ -7,14 +7,146 @@
 
 #import "FBSocketServer.h"
 
+#import <fcntl.h>
+#import <netinet/tcp.h>
+
 #import "FBControlCoreError.h"
+#import "FBDataConsumer.h"
+#import "FBFileWriter.h"
+
+// More accept sources than this contend on the same listening socket without setting up connections any faster.
+static NSUInteger const MaxAcceptSources = 4;
+// Large enough to hold several frames of a high bitrate video stream, so that a client that is briefly slow doesn't stall the writer.
+static int const MultiClientSendBufferSize = 1024 * 1024;
+
+@implementation FBSocketServerConfiguration
+
+#pragma mark Initializers
+
++ (instancetype)configurationWithAcceptSources:(NSUInteger)acceptSources perClientQueues:(BOOL)perClientQueues noDelay:(BOOL)noDelay sendBufferSize:(int)sendBufferSize
+{
+  return [[self alloc] initWithAcceptSources:acceptSources perClientQueues:perClientQueues noDelay:noDelay sendBufferSize:sendBufferSize];
+}
+
++ (FBSocketServerConfiguration *)defaultConfiguration
+{
+  return [self configurationWithAcceptSources:1 perClientQueues:NO noDelay:NO sendBufferSize:0];
+}
+
++ (FBSocketServerConfiguration *)multiClientConfiguration
+{
+  NSUInteger acceptSources = MIN(NSProcessInfo.processInfo.activeProcessorCount, MaxAcceptSources);
+  return [self configurationWithAcceptSources:acceptSources perClientQueues:YES noDelay:YES sendBufferSize:MultiClientSendBufferSize];
+}
+
+- (instancetype)initWithAcceptSources:(NSUInteger)acceptSources perClientQueues:(BOOL)perClientQueues noDelay:(BOOL)noDelay sendBufferSize:(int)sendBufferSize
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _acceptSources = MAX(acceptSources, 1);
+  _perClientQueues = perClientQueues;
+  _noDelay = noDelay;
+  _sendBufferSize = MAX(sendBufferSize, 0);
+
+  return self;
+}
+
+#pragma mark NSCopying
+
+- (instancetype)copyWithZone:(NSZone *)zone
+{
+  return self;
+}
+
+#pragma mark NSObject
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"Accept Sources %lu | Per Client Queues %d | No Delay %d | Send Buffer %d", (unsigned long) self.acceptSources, self.perClientQueues, self.noDelay, self.sendBufferSize];
+}
+
+@end
+
+/**
+ Adds each client of a server to a fan-out, removing it once the client disconnects.
+ */
+@interface FBSocketServer_FanOut : NSObject <FBSocketServerDelegate>
+
+@property (nonatomic, strong, readonly) FBQueuedCompositeDataConsumer *fanOut;
+@property (nonatomic, assign, readonly) size_t maxPendingBytes;
+
+@end
+
+@implementation FBSocketServer_FanOut
+
+@synthesize queue = _queue;
+
+- (instancetype)initWithFanOut:(FBQueuedCompositeDataConsumer *)fanOut maxPendingBytes:(size_t)maxPendingBytes
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _fanOut = fanOut;
+  _maxPendingBytes = maxPendingBytes;
+  _queue = dispatch_queue_create("com.facebook.fbcontrolcore.socket_server.fan_out", DISPATCH_QUEUE_CONCURRENT);
+
+  return self;
+}
+
+- (void)socketServer:(FBSocketServer *)server clientConnected:(struct in6_addr)address fileDescriptor:(int)fileDescriptor
+{
+  dispatch_queue_t queue = dispatch_queue_create("com.facebook.fbcontrolcore.socket_server.fan_out.client", DISPATCH_QUEUE_SERIAL);
+  [self socketServer:server clientConnected:address fileDescriptor:fileDescriptor queue:queue];
+}
+
+- (void)socketServer:(FBSocketServer *)server clientConnected:(struct in6_addr)address fileDescriptor:(int)fileDescriptor queue:(dispatch_queue_t)queue
+{
+  // A write to a client that has gone away should fail the writer, not raise SIGPIPE in this process.
+  int flagTrue = 1;
+  setsockopt(fileDescriptor, SOL_SOCKET, SO_NOSIGPIPE, &flagTrue, sizeof(flagTrue));
+
+  // The fan-out writes from the queue of the client, so a blocking write only holds up this client.
+  id<FBDataConsumer, FBDataConsumerLifecycle> writer = [FBFileWriter syncWriterWithFileDescriptor:fileDescriptor closeOnEndOfFile:NO];
+  FBQueuedCompositeDataConsumer *fanOut = self.fanOut;
+  [fanOut addConsumer:writer policy:FBQueuedDataConsumerPolicyDrop maxPendingBytes:self.maxPendingBytes];
+
+  // Clients of a fan-out only receive, so reads are only to notice the client disconnecting.
+  dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, (uintptr_t) fileDescriptor, 0, queue);
+  dispatch_source_set_event_handler(source, ^{
+    char buffer[512];
+    ssize_t result = read(fileDescriptor, buffer, sizeof(buffer));
+    if (result > 0 || (result < 0 && (errno == EINTR || errno == EAGAIN))) {
+      return;
+    }
+    dispatch_source_cancel(source);
+  });
+  dispatch_source_set_cancel_handler(source, ^{
+    [fanOut removeConsumer:writer];
+    // The descriptor is closed once both the source and the writer are done with it.
+    [writer.finishedConsuming onQueue:queue notifyOfCompletion:^(id _) {
+      close(fileDescriptor);
+    }];
+  });
+  // When the fan-out ends first, the source is no longer needed.
+  [writer.finishedConsuming onQueue:queue notifyOfCompletion:^(id _) {
+    dispatch_source_cancel(source);
+  }];
+  dispatch_resume(source);
+}
+
+@end
 
 @interface FBSocketServer ()
 
 @property (nonatomic, strong, readonly) id<FBSocketServerDelegate> delegate;
 
 @property (nonatomic, assign, readwrite) int socketDescriptor;
-@property (nonatomic, strong, readwrite) dispatch_source_t acceptSource;
+@property (nonatomic, copy, nullable, readwrite) NSArray<dispatch_source_t> *acceptSources;
 
 @end
 
@@ -24,10 +156,21 @@
 
 + (instancetype)socketServerOnPort:(in_port_t)port delegate:(id<FBSocketServerDelegate>)delegate
 {
-  return [[self alloc] initWithPort:port delegate:delegate];
+  return [self socketServerOnPort:port delegate:delegate configuration:FBSocketServerConfiguration.defaultConfiguration];
+}
+
++ (instancetype)socketServerOnPort:(in_port_t)port delegate:(id<FBSocketServerDelegate>)delegate configuration:(FBSocketServerConfiguration *)configuration
+{
+  return [[self alloc] initWithPort:port delegate:delegate configuration:configuration];
 }
 
-- (instancetype)initWithPort:(in_port_t)port delegate:(id<FBSocketServerDelegate>)delegate
++ (instancetype)socketServerOnPort:(in_port_t)port fanOut:(FBQueuedCompositeDataConsumer *)fanOut maxPendingBytes:(size_t)maxPendingBytes configuration:(FBSocketServerConfiguration *)configuration
+{
+  FBSocketServer_FanOut *delegate = [[FBSocketServer_FanOut alloc] initWithFanOut:fanOut maxPendingBytes:maxPendingBytes];
+  return [self socketServerOnPort:port delegate:delegate configuration:configuration];
+}
+
+- (instancetype)initWithPort:(in_port_t)port delegate:(id<FBSocketServerDelegate>)delegate configuration:(FBSocketServerConfiguration *)configuration
 {
   self = [super init];
   if (!self) {
@@ -36,6 +179,7 @@
 
   _port = port;
   _delegate = delegate;
+  _configuration = [configuration copy];
   _socketDescriptor = 0;
 
   return self;
@@ -45,7 +189,7 @@
 
 - (FBFuture<NSNull *> *)startListening
 {
-  if (self.acceptSource) {
+  if (self.acceptSources) {
     return [[FBControlCoreError
       describe:@"Cannot start listening, socket is already listening"]
       failFuture];
@@ -55,17 +199,17 @@
 
 - (FBFuture<NSNull *> *)stopListening
 {
-  if (!self.acceptSource) {
+  if (!self.acceptSources) {
     return [[FBControlCoreError
       describe:@"Cannot stop listening, there is no active socket"]
       failFuture];
   }
-  dispatch_source_cancel(self.acceptSource);
-  self.acceptSource = nil;
-  if (self.socketDescriptor) {
-    close(self.socketDescriptor);
-    self.socketDescriptor = 0;
+  // The socket is closed once the last of the sources has been cancelled.
+  for (dispatch_source_t acceptSource in self.acceptSources) {
+    dispatch_source_cancel(acceptSource);
   }
+  self.acceptSources = nil;
+  self.socketDescriptor = 0;
   return FBFuture.empty;
 }
 
@@ -84,7 +228,7 @@
 {
   // Get the Socket, set some options
   int socketDescriptor = socket(PF_INET6, SOCK_STREAM, IPPROTO_TCP);
-  if (socket <= 0) {
+  if (socketDescriptor < 0) {
     return [[FBControlCoreError
       describeFormat:@"Failed to create a socket with error '%s'", strerror(errno)]
       failFuture];
@@ -101,38 +245,57 @@
   address.sin6_addr = in6addr_any;
   int result = bind(socketDescriptor, (struct sockaddr *)&address, sizeof(address));
   if (result != 0) {
+    close(socketDescriptor);
     return [[FBControlCoreError
       describeFormat:@"Failed to bind the socket on port %d with error '%s'", self.port, strerror(errno)]
       failFuture];
   }
 
-  // Start Listening
-  result = listen(socketDescriptor, 10);
+  // Start Listening, the socket is non-blocking so that each accept event can drain all pending connections.
+  // Non-blocking accepts also mean that accept sources which are woken for the same connection don't block when another source wins it.
+  fcntl(socketDescriptor, F_SETFL, fcntl(socketDescriptor, F_GETFL) | O_NONBLOCK);
+  result = listen(socketDescriptor, SOMAXCONN);
   if (result != 0) {
+    close(socketDescriptor);
     return [[FBControlCoreError
       describeFormat:@"Failed to listen on the socket on port %d error '%s'", self.port, strerror(errno)]
       failFuture];
   }
 
-  // Prepare the Accept Source.
-  // Since the Client Queue may be concurrent, we should construct a serial queue to serialize the accept() calls
-  // The accept() will update internal state so calls *must* be serialized.
+  // Prepare the Accept Sources.
+  // Since the Client Queue may be concurrent, we should construct a serial queue per source to serialize the accept() calls of that source.
+  // Each source accepts independently, so that connection setup is not serialized behind a single queue.
   dispatch_queue_t clientQueue = self.delegate.queue;
-  NSString *acceptQueueName = [NSString stringWithFormat:@"%s.accept", dispatch_queue_get_label(clientQueue)];
-  dispatch_queue_t acceptQueue = dispatch_queue_create(acceptQueueName.UTF8String, DISPATCH_QUEUE_SERIAL);
-  self.acceptSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, (uintptr_t) socketDescriptor, 0, acceptQueue);
+  dispatch_group_t acceptSourcesCancelled = dispatch_group_create();
+  NSMutableArray<dispatch_source_t> *acceptSources = NSMutableArray.array;
   __weak typeof(self) weakSelf = self;
+  for (NSUInteger index = 0; index < self.configuration.acceptSources; index++) {
+    NSString *acceptQueueName = [NSString stringWithFormat:@"%s.accept.%lu", dispatch_queue_get_label(clientQueue), (unsigned long) index];
+    dispatch_queue_t acceptQueue = dispatch_queue_create(acceptQueueName.UTF8String, DISPATCH_QUEUE_SERIAL);
+    dispatch_source_t acceptSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, (uintptr_t) socketDescriptor, 0, acceptQueue);
 
-  // Dispatch read events from the accept source.
-  dispatch_source_set_event_handler(self.acceptSource, ^{
-    [weakSelf accept:socketDescriptor clientQueue:clientQueue error:nil];
-  });
-  dispatch_source_set_cancel_handler(self.acceptSource, ^{
+    // Dispatch read events from the accept source.
+    dispatch_source_set_event_handler(acceptSource, ^{
+      // A burst of connections arrives as a single event, so accept until there are none left rather than one per event.
+      while ([weakSelf accept:socketDescriptor clientQueue:clientQueue error:nil]) {
+      }
+    });
+    dispatch_group_enter(acceptSourcesCancelled);
+    dispatch_source_set_cancel_handler(acceptSource, ^{
+      dispatch_group_leave(acceptSourcesCancelled);
+    });
+    [acceptSources addObject:acceptSource];
+  }
+  dispatch_group_notify(acceptSourcesCancelled, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
     close(socketDescriptor);
   });
+
   // Start reading socket.
   self.socketDescriptor = socketDescriptor;
-  dispatch_resume(self.acceptSource);
+  self.acceptSources = acceptSources;
+  for (dispatch_source_t acceptSource in acceptSources) {
+    dispatch_resume(acceptSource);
+  }
 
   // Update port
   memset(&address, 0, sizeof(address));
@@ -149,12 +312,27 @@
   struct sockaddr_in6 address;
   socklen_t addressLength = sizeof(address);
   int acceptDescriptor = accept(socketDescriptor, (struct sockaddr *) &address, &addressLength);
-  if (!acceptDescriptor) {
+  if (acceptDescriptor < 0) {
     return [[FBControlCoreError
       describeFormat:@"accept() failed with error '%s'", strerror(errno)]
       failBool:error];
   }
 
+  // Accepted sockets inherit the non-blocking flag of the listening socket, delegates expect a blocking socket.
+  fcntl(acceptDescriptor, F_SETFL, fcntl(acceptDescriptor, F_GETFL) & ~O_NONBLOCK);
+  [self configureClientSocket:acceptDescriptor];
+
+  // With a queue per client, the delegate is told of the queue so that all work for the client stays on it.
+  FBSocketServerConfiguration *configuration = self.configuration;
+  if (configuration.perClientQueues && [self.delegate respondsToSelector:@selector(socketServer:clientConnected:fileDescriptor:queue:)]) {
+    NSString *queueName = [NSString stringWithFormat:@"%s.client.%d", dispatch_queue_get_label(clientQueue), acceptDescriptor];
+    dispatch_queue_t queue = dispatch_queue_create(queueName.UTF8String, DISPATCH_QUEUE_SERIAL);
+    dispatch_async(queue, ^{
+      [self.delegate socketServer:self clientConnected:address.sin6_addr fileDescriptor:acceptDescriptor queue:queue];
+    });
+    return YES;
+  }
+
   // Notify the Delegate the queue it wished to be notified on.
   dispatch_async(clientQueue, ^{
     [self.delegate socketServer:self clientConnected:address.sin6_addr fileDescriptor:acceptDescriptor];
@@ -162,4 +340,17 @@
   return YES;
 }
 
+- (void)configureClientSocket:(int)fileDescriptor
+{
+  FBSocketServerConfiguration *configuration = self.configuration;
+  if (configuration.noDelay) {
+    int flagTrue = 1;
+    setsockopt(fileDescriptor, IPPROTO_TCP, TCP_NODELAY, &flagTrue, sizeof(flagTrue));
+  }
+  if (configuration.sendBufferSize > 0) {
+    int sendBufferSize = configuration.sendBufferSize;
+    setsockopt(fileDescriptor, SOL_SOCKET, SO_SNDBUF, &sendBufferSize, sizeof(sendBufferSize));
+  }
+}
+
 @end
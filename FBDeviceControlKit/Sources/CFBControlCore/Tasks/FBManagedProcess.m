@@ -7,6 +7,7 @@
 
 #import "FBManagedProcess.h"
 
+#include <fcntl.h>
 #include <spawn.h>
 
 #import "FBCollectionInformation.h"
@@ -20,10 +21,51 @@
 #import "FBProcessSpawnConfiguration.h"
 #import "FBProcessStream.h"
 
+static BOOL AddOpenFileActions(posix_spawn_file_actions_t *fileActions, NSString *filePath, int flags, int targetFileDescriptor, NSError **error)
+{
+  // The launched process opens the file itself, so nothing is opened in this process.
+  int status = posix_spawn_file_actions_addopen(fileActions, targetFileDescriptor, filePath.fileSystemRepresentation, flags, 0644);
+  if (status != 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to open %@ to %d: %s", filePath, targetFileDescriptor, strerror(status)]
+      failBool:error];
+  }
+  return YES;
+}
+
+static BOOL AddDirectFileActions(posix_spawn_file_actions_t *fileActions, id<FBProcessStreamDirectAttachment> stream, int flags, int targetFileDescriptor, NSError **error)
+{
+  // A missing stream is connected to /dev/null, rather than left closed for the process to open something else in its place.
+  if (!stream) {
+    return AddOpenFileActions(fileActions, @"/dev/null", flags, targetFileDescriptor, error);
+  }
+  int sourceFileDescriptor = stream.directFileDescriptor;
+  if (sourceFileDescriptor < 0) {
+    return AddOpenFileActions(fileActions, stream.directFilePath, flags, targetFileDescriptor, error);
+  }
+  int status = posix_spawn_file_actions_adddup2(fileActions, sourceFileDescriptor, targetFileDescriptor);
+  if (status != 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to dup %d, to %d: %s", sourceFileDescriptor, targetFileDescriptor, strerror(status)]
+      failBool:error];
+  }
+  return YES;
+}
+
+static BOOL CanAttachDirectly(FBProcessIO *io)
+{
+  for (id stream in @[io.stdIn ?: NSNull.null, io.stdOut ?: NSNull.null, io.stdErr ?: NSNull.null]) {
+    if (stream != NSNull.null && ![stream conformsToProtocol:@protocol(FBProcessStreamDirectAttachment)]) {
+      return NO;
+    }
+  }
+  return YES;
+}
+
 static BOOL AddOutputFileActions(posix_spawn_file_actions_t *fileActions, FBProcessStreamAttachment *attachment, int targetFileDescriptor, NSError **error)
 {
-  if (!attachment) {
-    return YES;
+  if (!attachment || attachment.fileDescriptor < 0) {
+    return AddOpenFileActions(fileActions, @"/dev/null", O_WRONLY, targetFileDescriptor, error);
   }
   NSCParameterAssert(attachment.mode == FBProcessStreamAttachmentModeOutput);
   // dup the write end of the pipe to the target file descriptor i.e. stdout
@@ -40,8 +82,8 @@ static BOOL AddOutputFileActions(posix_spawn_file_actions_t *fileActions, FBProc
 
 static BOOL AddInputFileActions(posix_spawn_file_actions_t *fileActions, FBProcessStreamAttachment *attachment, int targetFileDescriptor, NSError **error)
 {
-  if (!attachment) {
-    return YES;
+  if (!attachment || attachment.fileDescriptor < 0) {
+    return AddOpenFileActions(fileActions, @"/dev/null", O_RDONLY, targetFileDescriptor, error);
   }
   NSCParameterAssert(attachment.mode == FBProcessStreamAttachmentModeInput);
   // dup the read end of the pipe to the target file descriptor i.e. stdin
@@ -92,6 +134,13 @@ static BOOL AddInputFileActions(posix_spawn_file_actions_t *fileActions, FBProce
 + (FBFuture<FBManagedProcess *> *)launchProcessWithConfiguration:(FBProcessSpawnConfiguration *)configuration logger:(id<FBControlCoreLogger>)logger
 {
   dispatch_queue_t queue = dispatch_queue_create("com.facebook.fbcontrolcore.task", DISPATCH_QUEUE_SERIAL);
+  // Streams such as /dev/null, files and existing file descriptors need no pipes or readers, so the process is launched without attaching to them.
+  // This keeps the launch of short-lived helper processes cheap.
+  if (CanAttachDirectly(configuration.io)) {
+    return [FBFuture onQueue:queue resolveValue:^ FBManagedProcess * (NSError **error) {
+      return [FBManagedProcess processWithConfiguration:configuration attachment:nil queue:queue logger:logger error:error];
+    }];
+  }
   return [[configuration.io
     attach]
     onQueue:queue fmap:^(FBProcessIOAttachment *attachment) {
@@ -174,7 +223,7 @@ static BOOL AddInputFileActions(posix_spawn_file_actions_t *fileActions, FBProce
     failFuture];
 }
 
-+ (FBManagedProcess *)processWithConfiguration:(FBProcessSpawnConfiguration *)configuration attachment:(FBProcessIOAttachment *)attachment queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger error:(NSError **)error
++ (FBManagedProcess *)processWithConfiguration:(FBProcessSpawnConfiguration *)configuration attachment:(nullable FBProcessIOAttachment *)attachment queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger error:(NSError **)error
 {
   // Convert the arguments to the argv expected by posix_spawn
   NSArray<NSString *> *arguments = configuration.arguments;
@@ -200,14 +249,27 @@ static BOOL AddInputFileActions(posix_spawn_file_actions_t *fileActions, FBProce
   posix_spawn_file_actions_t fileActions;
   posix_spawn_file_actions_init(&fileActions);
 
-  if (!AddInputFileActions(&fileActions, attachment.stdIn, STDIN_FILENO, error)) {
-    return nil;
-  }
-  if (!AddOutputFileActions(&fileActions, attachment.stdOut, STDOUT_FILENO, error)) {
-    return nil;
-  }
-  if (!AddOutputFileActions(&fileActions, attachment.stdErr, STDERR_FILENO, error)) {
-    return nil;
+  if (attachment) {
+    if (!AddInputFileActions(&fileActions, attachment.stdIn, STDIN_FILENO, error)) {
+      return nil;
+    }
+    if (!AddOutputFileActions(&fileActions, attachment.stdOut, STDOUT_FILENO, error)) {
+      return nil;
+    }
+    if (!AddOutputFileActions(&fileActions, attachment.stdErr, STDERR_FILENO, error)) {
+      return nil;
+    }
+  } else {
+    FBProcessIO *io = configuration.io;
+    if (!AddDirectFileActions(&fileActions, (id<FBProcessStreamDirectAttachment>) io.stdIn, O_RDONLY, STDIN_FILENO, error)) {
+      return nil;
+    }
+    if (!AddDirectFileActions(&fileActions, (id<FBProcessStreamDirectAttachment>) io.stdOut, O_WRONLY | O_CREAT | O_TRUNC, STDOUT_FILENO, error)) {
+      return nil;
+    }
+    if (!AddDirectFileActions(&fileActions, (id<FBProcessStreamDirectAttachment>) io.stdErr, O_WRONLY | O_CREAT | O_TRUNC, STDERR_FILENO, error)) {
+      return nil;
+    }
   }
 
   // Make the spawn attributes
@@ -244,7 +306,7 @@ static BOOL AddInputFileActions(posix_spawn_file_actions_t *fileActions, FBProce
   return [[self alloc] initWithProcessIdentifier:processIdentifier statLoc:statLoc exitCode:exitCode signal:signal configuration:configuration queue:queue];
 }
 
-+ (void)resolveProcessCompletion:(pid_t)processIdentifier attachment:(FBProcessIOAttachment *)attachment statLoc:(FBMutableFuture<NSNumber *> *)statLoc exitCode:(FBMutableFuture<NSNumber *> *)exitCode signal:(FBMutableFuture<NSNumber *> *)signal configuration:(FBProcessSpawnConfiguration *)configuration logger:(id<FBControlCoreLogger>)logger
++ (void)resolveProcessCompletion:(pid_t)processIdentifier attachment:(nullable FBProcessIOAttachment *)attachment statLoc:(FBMutableFuture<NSNumber *> *)statLoc exitCode:(FBMutableFuture<NSNumber *> *)exitCode signal:(FBMutableFuture<NSNumber *> *)signal configuration:(FBProcessSpawnConfiguration *)configuration logger:(id<FBControlCoreLogger>)logger
 {
   dispatch_queue_t queue = dispatch_queue_create("com.facebook.fbcontrolcore.task.posix_spawn.wait", DISPATCH_QUEUE_SERIAL);
   dispatch_source_t source = dispatch_source_create(
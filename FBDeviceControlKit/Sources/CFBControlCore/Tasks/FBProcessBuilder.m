@@ -128,6 +128,12 @@
   return self;
 }
 
+- (instancetype)withStdOutInMemoryWithHeadCapacity:(size_t)headCapacity tailCapacity:(size_t)tailCapacity spillToTemporaryFile:(BOOL)spillToTemporaryFile
+{
+  self.stdOut = [FBProcessOutput outputToBoundedBufferWithHeadCapacity:headCapacity tailCapacity:tailCapacity spillToTemporaryFile:spillToTemporaryFile];
+  return self;
+}
+
 - (instancetype)withStdOutPath:(NSString *)stdOutPath
 {
   NSParameterAssert(stdOutPath);
@@ -141,12 +147,24 @@
   return self;
 }
 
+- (instancetype)withStdOutToFileDescriptor:(int)fileDescriptor
+{
+  self.stdOut = [FBProcessOutput outputForFileDescriptor:fileDescriptor];
+  return self;
+}
+
 - (instancetype)withStdOutToInputStream
 {
   self.stdOut = [FBProcessOutput outputToInputStream];
   return self;
 }
 
+- (instancetype)withStdOutToReader
+{
+  self.stdOut = [FBProcessOutput outputToReader];
+  return self;
+}
+
 - (instancetype)withStdOutConsumer:(id<FBDataConsumer>)consumer
 {
   self.stdOut = [FBProcessOutput outputForDataConsumer:consumer];
@@ -184,6 +202,12 @@
   return self;
 }
 
+- (instancetype)withStdErrInMemoryWithHeadCapacity:(size_t)headCapacity tailCapacity:(size_t)tailCapacity spillToTemporaryFile:(BOOL)spillToTemporaryFile
+{
+  self.stdErr = [FBProcessOutput outputToBoundedBufferWithHeadCapacity:headCapacity tailCapacity:tailCapacity spillToTemporaryFile:spillToTemporaryFile];
+  return self;
+}
+
 - (instancetype)withStdErrPath:(NSString *)stdErrPath
 {
   NSParameterAssert(stdErrPath);
@@ -197,6 +221,12 @@
   return self;
 }
 
+- (instancetype)withStdErrToFileDescriptor:(int)fileDescriptor
+{
+  self.stdErr = [FBProcessOutput outputForFileDescriptor:fileDescriptor];
+  return self;
+}
+
 - (instancetype)withStdErrConsumer:(id<FBDataConsumer>)consumer
 {
   self.stdErr = [FBProcessOutput outputForDataConsumer:consumer];
@@ -0,0 +1,608 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBArchiveExtractor.h"
+
+#import <sys/stat.h>
+#import <sys/time.h>
+#import <zlib.h>
+
+#import "FBControlCoreError.h"
+#import "FBControlCoreLogger.h"
+
+// Large enough to inflate a pipe-sized chunk in a couple of passes.
+static const size_t InflateBufferSize = 1024 * 64;
+static const size_t TarBlockSize = 512;
+// Long names and pax headers are held in memory, so are bounded.
+static const uint64_t TarMaximumMetadataSize = 1024 * 1024;
+
+typedef NS_ENUM(NSUInteger, FBArchiveExtractorMode) {
+  FBArchiveExtractorModeTar = 0,
+  FBArchiveExtractorModeFile = 1,
+};
+
+typedef NS_ENUM(NSUInteger, FBArchiveExtractorCompression) {
+  FBArchiveExtractorCompressionUndetermined = 0,
+  FBArchiveExtractorCompressionNone = 1,
+  FBArchiveExtractorCompressionGZIP = 2,
+};
+
+static uint64_t TarParseNumber(const uint8_t *field, size_t length)
+{
+  // GNU tar stores values that don't fit in octal as big-endian base-256, flagged by the high bit.
+  if (field[0] & 0x80) {
+    uint64_t value = field[0] & 0x7f;
+    for (size_t index = 1; index < length; index++) {
+      value = (value << 8) | field[index];
+    }
+    return value;
+  }
+  uint64_t value = 0;
+  for (size_t index = 0; index < length; index++) {
+    uint8_t character = field[index];
+    if (character == ' ' && value == 0) {
+      continue;
+    }
+    if (character < '0' || character > '7') {
+      break;
+    }
+    value = (value << 3) | (uint64_t) (character - '0');
+  }
+  return value;
+}
+
+static NSString *TarParseString(const uint8_t *field, size_t length)
+{
+  size_t stringLength = strnlen((const char *) field, length);
+  // Names that are not UTF-8 are still extracted, rather than being dropped.
+  return [[NSString alloc] initWithBytes:field length:stringLength encoding:NSUTF8StringEncoding]
+    ?: [[NSString alloc] initWithBytes:field length:stringLength encoding:NSISOLatin1StringEncoding];
+}
+
+static BOOL TarHeaderChecksumIsValid(const uint8_t *header)
+{
+  // The checksum is calculated with the checksum field itself as spaces.
+  uint64_t expected = TarParseNumber(header + 148, 8);
+  uint64_t sum = 0;
+  for (size_t index = 0; index < TarBlockSize; index++) {
+    sum += (index >= 148 && index < 156) ? ' ' : header[index];
+  }
+  return sum == expected;
+}
+
+static BOOL WriteAll(int fileDescriptor, const uint8_t *bytes, size_t length)
+{
+  while (length > 0) {
+    ssize_t written = write(fileDescriptor, bytes, length);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written < 0) {
+      return NO;
+    }
+    bytes += written;
+    length -= (size_t) written;
+  }
+  return YES;
+}
+
+@interface FBArchiveExtractor ()
+
+@property (nonatomic, assign, readonly) FBArchiveExtractorMode mode;
+@property (nonatomic, copy, readonly) NSString *path;
+@property (nonatomic, assign, readonly) BOOL overrideModificationTime;
+@property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *finishedConsumingMutable;
+
+@property (nonatomic, assign, readwrite) FBArchiveExtractorCompression compression;
+@property (nonatomic, assign, readwrite) BOOL inflateEnded;
+@property (nonatomic, strong, nullable, readwrite) NSError *error;
+@property (nonatomic, assign, readwrite) uint64_t bytesExtracted;
+
+// The state of the tar entry that is being extracted.
+@property (nonatomic, assign, readwrite) BOOL reachedEndOfArchive;
+@property (nonatomic, assign, readwrite) uint64_t entryRemaining;
+@property (nonatomic, assign, readwrite) uint64_t entryPadding;
+@property (nonatomic, assign, readwrite) char entryType;
+@property (nonatomic, assign, readwrite) mode_t entryMode;
+@property (nonatomic, assign, readwrite) time_t entryModificationTime;
+@property (nonatomic, assign, readwrite) int entryFileDescriptor;
+@property (nonatomic, strong, nullable, readwrite) NSMutableData *entryMetadata;
+@property (nonatomic, copy, nullable, readwrite) NSString *pendingPath;
+@property (nonatomic, copy, nullable, readwrite) NSString *pendingLinkPath;
+@property (nonatomic, assign, readwrite) NSUInteger entriesExtracted;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSNumber *> *directoryModificationTimes;
+
+@end
+
+@implementation FBArchiveExtractor
+{
+  z_stream _inflateStream;
+  uint8_t _header[TarBlockSize];
+  size_t _headerFilled;
+  uint8_t _magic[2];
+  size_t _magicFilled;
+}
+
+#pragma mark Initializers
+
++ (instancetype)tarExtractorToDirectory:(NSString *)directory overrideModificationTime:(BOOL)overrideMTime logger:(nullable id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithMode:FBArchiveExtractorModeTar path:directory compression:FBArchiveExtractorCompressionUndetermined overrideModificationTime:overrideMTime logger:logger];
+}
+
++ (instancetype)gzipExtractorToFile:(NSString *)filePath logger:(nullable id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithMode:FBArchiveExtractorModeFile path:filePath compression:FBArchiveExtractorCompressionGZIP overrideModificationTime:NO logger:logger];
+}
+
+- (instancetype)initWithMode:(FBArchiveExtractorMode)mode path:(NSString *)path compression:(FBArchiveExtractorCompression)compression overrideModificationTime:(BOOL)overrideModificationTime logger:(nullable id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _mode = mode;
+  _path = [path copy];
+  _compression = compression;
+  _overrideModificationTime = overrideModificationTime;
+  _logger = logger;
+  _finishedConsumingMutable = [FBMutableFuture futureWithNameFormat:@"Extraction to %@", path];
+  _entryFileDescriptor = -1;
+  _directoryModificationTimes = NSMutableDictionary.dictionary;
+  if (compression == FBArchiveExtractorCompressionGZIP) {
+    [self startInflating];
+  }
+
+  return self;
+}
+
+- (void)dealloc
+{
+  if (_compression == FBArchiveExtractorCompressionGZIP) {
+    inflateEnd(&_inflateStream);
+  }
+  if (_entryFileDescriptor >= 0) {
+    close(_entryFileDescriptor);
+  }
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+    if (![self consumeCompressedBytes:bytes length:byteRange.length]) {
+      *stop = YES;
+    }
+  }];
+}
+
+- (void)consumeEndOfFile
+{
+  if (self.finishedConsumingMutable.hasCompleted) {
+    return;
+  }
+  if (self.compression == FBArchiveExtractorCompressionGZIP && !self.inflateEnded) {
+    [self failWithError:[[FBControlCoreError describeFormat:@"The gzip stream for %@ ended before it was complete", self.path] build]];
+    return;
+  }
+  if (self.mode == FBArchiveExtractorModeTar && (self.entryRemaining > 0 || _headerFilled > 0)) {
+    [self failWithError:[[FBControlCoreError describeFormat:@"The tar stream for %@ ended part way through an entry", self.path] build]];
+    return;
+  }
+  if (self.mode == FBArchiveExtractorModeFile && ![self openOutputFile]) {
+    return;
+  }
+  if (self.entryFileDescriptor >= 0) {
+    close(self.entryFileDescriptor);
+    self.entryFileDescriptor = -1;
+  }
+  // Directory times are set last, as extracting their contents changes them.
+  if (!self.overrideModificationTime) {
+    for (NSString *directory in self.directoryModificationTimes) {
+      struct timeval times[2] = {{.tv_sec = self.directoryModificationTimes[directory].longValue}, {.tv_sec = self.directoryModificationTimes[directory].longValue}};
+      utimes(directory.fileSystemRepresentation, times);
+    }
+  }
+  [self.logger logFormat:@"Extracted %lu entries, %llu bytes to %@", (unsigned long) self.entriesExtracted, self.bytesExtracted, self.path];
+  [self.finishedConsumingMutable resolveWithResult:NSNull.null];
+}
+
+#pragma mark FBDataConsumerLifecycle
+
+- (FBFuture<NSNull *> *)finishedConsuming
+{
+  return self.finishedConsumingMutable;
+}
+
+#pragma mark Decompression
+
+- (void)startInflating
+{
+  memset(&_inflateStream, 0, sizeof(_inflateStream));
+  // 16 added to the window bits accepts a gzip header and trailer.
+  inflateInit2(&_inflateStream, 15 + 16);
+}
+
+- (BOOL)consumeCompressedBytes:(const uint8_t *)bytes length:(size_t)length
+{
+  if (self.error || self.finishedConsumingMutable.hasCompleted) {
+    return NO;
+  }
+  if (self.compression == FBArchiveExtractorCompressionUndetermined) {
+    // The first two bytes of a gzip stream are fixed, a tar header never starts with them.
+    while (_magicFilled < sizeof(_magic) && length > 0) {
+      _magic[_magicFilled++] = *bytes++;
+      length--;
+    }
+    if (_magicFilled < sizeof(_magic)) {
+      return YES;
+    }
+    if (self.mode == FBArchiveExtractorModeTar && _magic[0] == 'P' && _magic[1] == 'K') {
+      return [self failWithError:[[FBControlCoreError describeFormat:@"The stream for %@ is a zip, which can only be extracted from a file", self.path] build]];
+    }
+    BOOL gzipped = _magic[0] == 0x1f && _magic[1] == 0x8b;
+    self.compression = gzipped ? FBArchiveExtractorCompressionGZIP : FBArchiveExtractorCompressionNone;
+    if (gzipped) {
+      [self startInflating];
+    }
+    if (![self consumeCompressedBytes:_magic length:sizeof(_magic)]) {
+      return NO;
+    }
+  }
+  if (self.compression == FBArchiveExtractorCompressionNone) {
+    return [self consumeBytes:bytes length:length];
+  }
+
+  uint8_t buffer[InflateBufferSize];
+  _inflateStream.next_in = (Bytef *) bytes;
+  _inflateStream.avail_in = (uInt) length;
+  while (_inflateStream.avail_in > 0) {
+    if (self.inflateEnded && self.reachedEndOfArchive) {
+      // Anything after the end of a tar is padding, which need not be a gzip member.
+      break;
+    }
+    if (self.inflateEnded) {
+      // Concatenated gzip members decompress to the concatenation of their contents.
+      inflateReset(&_inflateStream);
+      self.inflateEnded = NO;
+    }
+    _inflateStream.next_out = buffer;
+    _inflateStream.avail_out = sizeof(buffer);
+    int status = inflate(&_inflateStream, Z_NO_FLUSH);
+    if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+      return [self failWithError:[[FBControlCoreError describeFormat:@"Failed to decompress gzip stream for %@: %s", self.path, _inflateStream.msg ?: "unknown error"] build]];
+    }
+    if (![self consumeBytes:buffer length:sizeof(buffer) - _inflateStream.avail_out]) {
+      return NO;
+    }
+    if (status == Z_STREAM_END) {
+      self.inflateEnded = YES;
+    } else if (status == Z_BUF_ERROR) {
+      break;
+    }
+  }
+  return YES;
+}
+
+- (BOOL)consumeBytes:(const uint8_t *)bytes length:(size_t)length
+{
+  if (length == 0) {
+    return YES;
+  }
+  if (self.mode == FBArchiveExtractorModeFile) {
+    if (![self openOutputFile]) {
+      return NO;
+    }
+    if (!WriteAll(self.entryFileDescriptor, bytes, length)) {
+      return [self failWithError:[[FBControlCoreError describeFormat:@"Failed to write to %@: %s", self.path, strerror(errno)] build]];
+    }
+    self.bytesExtracted += length;
+    return YES;
+  }
+  return [self consumeTarBytes:bytes length:length];
+}
+
+- (BOOL)openOutputFile
+{
+  if (self.entryFileDescriptor >= 0) {
+    return YES;
+  }
+  int fileDescriptor = open(self.path.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fileDescriptor < 0) {
+    return [self failWithError:[[FBControlCoreError describeFormat:@"Failed to open %@ for extraction: %s", self.path, strerror(errno)] build]];
+  }
+  self.entryFileDescriptor = fileDescriptor;
+  self.entriesExtracted = 1;
+  return YES;
+}
+
+#pragma mark Tar
+
+- (BOOL)consumeTarBytes:(const uint8_t *)bytes length:(size_t)length
+{
+  while (length > 0) {
+    if (self.reachedEndOfArchive) {
+      // Anything after the end-of-archive blocks is padding.
+      return YES;
+    }
+    if (self.entryRemaining > 0) {
+      size_t size = (size_t) MIN((uint64_t) length, self.entryRemaining);
+      if (![self consumeEntryBytes:bytes length:size]) {
+        return NO;
+      }
+      bytes += size;
+      length -= size;
+      self.entryRemaining -= size;
+      if (self.entryRemaining == 0 && ![self finishEntry]) {
+        return NO;
+      }
+      continue;
+    }
+    if (self.entryPadding > 0) {
+      size_t size = (size_t) MIN((uint64_t) length, self.entryPadding);
+      bytes += size;
+      length -= size;
+      self.entryPadding -= size;
+      continue;
+    }
+    size_t size = MIN(length, TarBlockSize - _headerFilled);
+    memcpy(_header + _headerFilled, bytes, size);
+    _headerFilled += size;
+    bytes += size;
+    length -= size;
+    if (_headerFilled < TarBlockSize) {
+      continue;
+    }
+    _headerFilled = 0;
+    if (![self startEntry]) {
+      return NO;
+    }
+  }
+  return YES;
+}
+
+- (BOOL)startEntry
+{
+  const uint8_t *header = _header;
+  BOOL empty = YES;
+  for (size_t index = 0; index < TarBlockSize; index++) {
+    if (header[index] != 0) {
+      empty = NO;
+      break;
+    }
+  }
+  if (empty) {
+    self.reachedEndOfArchive = YES;
+    return YES;
+  }
+  if (!TarHeaderChecksumIsValid(header)) {
+    return [self failWithError:[[FBControlCoreError describeFormat:@"The stream for %@ is not a tar archive, or is corrupt", self.path] build]];
+  }
+
+  uint64_t size = TarParseNumber(header + 124, 12);
+  self.entryType = (char) header[156];
+  self.entryMode = (mode_t) TarParseNumber(header + 100, 8) & 07777;
+  self.entryModificationTime = (time_t) TarParseNumber(header + 136, 12);
+  self.entryRemaining = size;
+  self.entryPadding = (TarBlockSize - size % TarBlockSize) % TarBlockSize;
+
+  switch (self.entryType) {
+    case 'L':
+    case 'K':
+    case 'x':
+    case 'g':
+      if (size > TarMaximumMetadataSize) {
+        return [self failWithError:[[FBControlCoreError describeFormat:@"A tar metadata entry of %llu bytes in %@ is too large", size, self.path] build]];
+      }
+      self.entryMetadata = [NSMutableData dataWithCapacity:(NSUInteger) size];
+      break;
+    default:
+      if (![self openEntryWithHeader:header]) {
+        return NO;
+      }
+      break;
+  }
+  if (size == 0) {
+    return [self finishEntry];
+  }
+  return YES;
+}
+
+- (BOOL)openEntryWithHeader:(const uint8_t *)header
+{
+  NSString *name = self.pendingPath;
+  if (!name) {
+    name = TarParseString(header, 100);
+    // The ustar format splits long names into a prefix and a name.
+    NSString *prefix = memcmp(header + 257, "ustar", 5) == 0 ? TarParseString(header + 345, 155) : nil;
+    if (prefix.length > 0) {
+      name = [prefix stringByAppendingPathComponent:name];
+    }
+  }
+  NSString *linkName = self.pendingLinkPath ?: TarParseString(header + 157, 100);
+  self.pendingPath = nil;
+  self.pendingLinkPath = nil;
+
+  NSError *error = nil;
+  NSString *path = [self extractionPathForName:name error:&error];
+  if (!path) {
+    return [self failWithError:error];
+  }
+  if (path.length == 0) {
+    // The root of the extraction.
+    return YES;
+  }
+  NSString *parent = path.stringByDeletingLastPathComponent;
+  if (![NSFileManager.defaultManager createDirectoryAtPath:parent withIntermediateDirectories:YES attributes:nil error:&error]) {
+    return [self failWithError:error];
+  }
+
+  switch (self.entryType) {
+    case '0':
+    case '\0':
+    case '7': {
+      unlink(path.fileSystemRepresentation);
+      // Permissions are applied when the file has been written, so that a read-only file can still be written.
+      int fileDescriptor = open(path.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+      if (fileDescriptor < 0) {
+        return [self failWithError:[[FBControlCoreError describeFormat:@"Failed to create %@: %s", path, strerror(errno)] build]];
+      }
+      self.entryFileDescriptor = fileDescriptor;
+      break;
+    }
+    case '5': {
+      if (![NSFileManager.defaultManager createDirectoryAtPath:path withIntermediateDirectories:YES attributes:nil error:&error]) {
+        return [self failWithError:error];
+      }
+      chmod(path.fileSystemRepresentation, self.entryMode | S_IRWXU);
+      self.directoryModificationTimes[path] = @(self.entryModificationTime);
+      break;
+    }
+    case '2': {
+      unlink(path.fileSystemRepresentation);
+      if (symlink(linkName.fileSystemRepresentation, path.fileSystemRepresentation) != 0) {
+        return [self failWithError:[[FBControlCoreError describeFormat:@"Failed to create symbolic link %@ to %@: %s", path, linkName, strerror(errno)] build]];
+      }
+      break;
+    }
+    case '1': {
+      NSString *target = [self extractionPathForName:linkName error:&error];
+      if (!target) {
+        return [self failWithError:error];
+      }
+      unlink(path.fileSystemRepresentation);
+      if (link(target.fileSystemRepresentation, path.fileSystemRepresentation) != 0) {
+        return [self failWithError:[[FBControlCoreError describeFormat:@"Failed to create hard link %@ to %@: %s", path, target, strerror(errno)] build]];
+      }
+      break;
+    }
+    default:
+      // Devices, fifos and unknown types are skipped, as bsdtar does when not running as root.
+      [self.logger logFormat:@"Skipping tar entry %@ of type '%c'", name, self.entryType];
+      return YES;
+  }
+  self.entriesExtracted += 1;
+  return YES;
+}
+
+- (BOOL)consumeEntryBytes:(const uint8_t *)bytes length:(size_t)length
+{
+  if (self.entryMetadata) {
+    [self.entryMetadata appendBytes:bytes length:length];
+    return YES;
+  }
+  if (self.entryFileDescriptor < 0) {
+    return YES;
+  }
+  if (!WriteAll(self.entryFileDescriptor, bytes, length)) {
+    return [self failWithError:[[FBControlCoreError describeFormat:@"Failed to write tar entry in %@: %s", self.path, strerror(errno)] build]];
+  }
+  self.bytesExtracted += length;
+  return YES;
+}
+
+- (BOOL)finishEntry
+{
+  NSData *metadata = self.entryMetadata;
+  self.entryMetadata = nil;
+  if (metadata) {
+    switch (self.entryType) {
+      case 'L':
+        self.pendingPath = TarParseString(metadata.bytes, metadata.length);
+        break;
+      case 'K':
+        self.pendingLinkPath = TarParseString(metadata.bytes, metadata.length);
+        break;
+      case 'x':
+        [self applyPaxHeaders:metadata];
+        break;
+      default:
+        break;
+    }
+    return YES;
+  }
+  int fileDescriptor = self.entryFileDescriptor;
+  if (fileDescriptor < 0) {
+    return YES;
+  }
+  self.entryFileDescriptor = -1;
+  fchmod(fileDescriptor, self.entryMode);
+  if (!self.overrideModificationTime) {
+    struct timeval times[2] = {{.tv_sec = self.entryModificationTime}, {.tv_sec = self.entryModificationTime}};
+    futimes(fileDescriptor, times);
+  }
+  close(fileDescriptor);
+  return YES;
+}
+
+- (void)applyPaxHeaders:(NSData *)metadata
+{
+  // Each record is "<length> <key>=<value>\n", where the length includes the whole record.
+  const char *bytes = metadata.bytes;
+  size_t offset = 0;
+  while (offset < metadata.length) {
+    char *end = NULL;
+    unsigned long recordLength = strtoul(bytes + offset, &end, 10);
+    if (recordLength == 0 || offset + recordLength > metadata.length || end == NULL || *end != ' ') {
+      return;
+    }
+    NSString *record = [[NSString alloc] initWithBytes:end + 1 length:(NSUInteger) (bytes + offset + recordLength - 1 - (end + 1)) encoding:NSUTF8StringEncoding];
+    NSRange separator = [record rangeOfString:@"="];
+    if (separator.location != NSNotFound) {
+      NSString *key = [record substringToIndex:separator.location];
+      NSString *value = [record substringFromIndex:separator.location + 1];
+      if ([key isEqualToString:@"path"]) {
+        self.pendingPath = value;
+      } else if ([key isEqualToString:@"linkpath"]) {
+        self.pendingLinkPath = value;
+      }
+    }
+    offset += recordLength;
+  }
+}
+
+- (nullable NSString *)extractionPathForName:(NSString *)name error:(NSError **)error
+{
+  if (name.isAbsolutePath) {
+    return [[FBControlCoreError
+      describeFormat:@"Refusing to extract tar entry with absolute path %@", name]
+      fail:error];
+  }
+  NSMutableArray<NSString *> *components = NSMutableArray.array;
+  for (NSString *component in [name componentsSeparatedByString:@"/"]) {
+    if (component.length == 0 || [component isEqualToString:@"."]) {
+      continue;
+    }
+    if ([component isEqualToString:@".."]) {
+      return [[FBControlCoreError
+        describeFormat:@"Refusing to extract tar entry %@ outside of %@", name, self.path]
+        fail:error];
+    }
+    [components addObject:component];
+  }
+  if (components.count == 0) {
+    return @"";
+  }
+  return [self.path stringByAppendingPathComponent:[NSString pathWithComponents:components]];
+}
+
+#pragma mark Private
+
+- (BOOL)failWithError:(NSError *)error
+{
+  if (!self.error) {
+    self.error = error;
+    [self.logger logFormat:@"Extraction to %@ failed: %@", self.path, error];
+    [self.finishedConsumingMutable resolveWithError:error];
+  }
+  return NO;
+}
+
+@end
@@ -7,13 +7,87 @@
 
 #import "FBArchiveOperations.h"
 
+#import <sys/stat.h>
+
+#import "FBArchiveExtractor.h"
 #import "FBControlCoreError.h"
 #import "FBControlCoreLogger.h"
+#import "FBDataBuffer.h"
+#import "FBFileReader.h"
+#import "FBGzipCompressor.h"
 #import "FBManagedProcess.h"
 #import "FBProcessBuilder.h"
+#import "FBProcessStream.h"
 
 NSString *const BSDTarPath = @"/usr/bin/bsdtar";
 
+static const size_t TarBlockSize = 512;
+static const size_t TarNameSize = 100;
+static const size_t TarPrefixSize = 155;
+// Files are read in chunks of this size, so that large files aren't held in memory.
+static const size_t TarReadSize = 1024 * 64;
+
+static void TarWriteNumber(char *field, size_t length, uint64_t value)
+{
+  // Values that don't fit in octal are written in base-256, flagged by the high bit, as GNU tar and bsdtar do.
+  if (value >> (3 * (length - 1))) {
+    memset(field, 0, length);
+    for (size_t index = length - 1; index > 0; index--) {
+      field[index] = (char) (value & 0xff);
+      value >>= 8;
+    }
+    field[0] = (char) 0x80;
+    return;
+  }
+  snprintf(field, length, "%0*llo", (int) (length - 1), value);
+}
+
+static NSData *TarHeader(NSData *name, NSData *prefix, NSData *linkName, char type, struct stat info, uint64_t size)
+{
+  NSMutableData *data = [NSMutableData dataWithLength:TarBlockSize];
+  char *header = data.mutableBytes;
+  memcpy(header, name.bytes, MIN(name.length, TarNameSize));
+  TarWriteNumber(header + 100, 8, info.st_mode & 07777);
+  TarWriteNumber(header + 108, 8, info.st_uid);
+  TarWriteNumber(header + 116, 8, info.st_gid);
+  TarWriteNumber(header + 124, 12, size);
+  TarWriteNumber(header + 136, 12, (uint64_t) MAX(info.st_mtimespec.tv_sec, 0));
+  header[156] = type;
+  memcpy(header + 157, linkName.bytes, MIN(linkName.length, TarNameSize));
+  memcpy(header + 257, "ustar", 6);
+  memcpy(header + 263, "00", 2);
+  memcpy(header + 345, prefix.bytes, MIN(prefix.length, TarPrefixSize));
+  // The checksum is calculated with the checksum field itself as spaces, then written as six digits, a NUL and a space.
+  memset(header + 148, ' ', 8);
+  unsigned int checksum = 0;
+  for (size_t index = 0; index < TarBlockSize; index++) {
+    checksum += (uint8_t) header[index];
+  }
+  snprintf(header + 148, 7, "%06o", checksum);
+  header[155] = ' ';
+  return data;
+}
+
+static BOOL TarSplitName(NSData *name, NSData **prefixOut, NSData **nameOut)
+{
+  if (name.length <= TarNameSize) {
+    *prefixOut = NSData.data;
+    *nameOut = name;
+    return YES;
+  }
+  // The ustar format fits longer names by splitting them at a slash into a prefix and a name.
+  const char *bytes = name.bytes;
+  for (NSUInteger index = MIN(name.length - 1, TarPrefixSize); index > 0; index--) {
+    NSUInteger remaining = name.length - index - 1;
+    if (bytes[index] == '/' && remaining > 0 && remaining <= TarNameSize) {
+      *prefixOut = [name subdataWithRange:NSMakeRange(0, index)];
+      *nameOut = [name subdataWithRange:NSMakeRange(index + 1, remaining)];
+      return YES;
+    }
+  }
+  return NO;
+}
+
 @implementation FBArchiveOperations
 
 + (NSArray<NSString *> *)commandToExtractArchiveAtPath:(NSString *)path toPath:(NSString *)extractPath overrideModificationTime:(BOOL)overrideMTime debugLogging:(BOOL)debugLogging
@@ -46,6 +120,11 @@ NSString *const BSDTarPath = @"/usr/bin/bsdtar";
 
 + (FBFuture<NSString *> *)extractArchiveFromStream:(FBProcessInput *)stream toPath:(NSString *)extractPath overrideModificationTime:(BOOL)overrideMTime logger:(id<FBControlCoreLogger>)logger compression:(FBCompressionFormat)compression
 {
+  // Tars and gzipped tars are extracted in-process. zstd isn't available in-process, so is extracted by bsdtar.
+  if (compression == FBCompressionFormatGZIP) {
+    FBArchiveExtractor *extractor = [FBArchiveExtractor tarExtractorToDirectory:extractPath overrideModificationTime:overrideMTime logger:logger.debug];
+    return [[self extractStream:stream withExtractor:extractor logger:logger] mapReplace:extractPath];
+  }
   return [[[[[[[[FBProcessBuilder
     withLaunchPath:BSDTarPath]
     withArguments:[self commandToExtractFromStdInWithExtractPath:extractPath overrideModificationTime:overrideMTime compression:compression debugLogging:NO]]
@@ -59,15 +138,8 @@ NSString *const BSDTarPath = @"/usr/bin/bsdtar";
 
 + (FBFuture<NSString *> *)extractGzipFromStream:(FBProcessInput *)stream toPath:(NSString *)extractPath logger:(id<FBControlCoreLogger>)logger
 {
-  return [[[[[[[[FBProcessBuilder
-    withLaunchPath:@"/usr/bin/gunzip"]
-    withArguments:@[@"--to-stdout"]]
-    withStdIn:stream]
-    withStdErrToLoggerAndErrorMessage:logger.debug]
-    withStdOutPath:extractPath]
-    withTaskLifecycleLoggingTo:logger]
-    runUntilCompletionWithAcceptableExitCodes:[NSSet setWithObject:@0]]
-    mapReplace:extractPath];
+  FBArchiveExtractor *extractor = [FBArchiveExtractor gzipExtractorToFile:extractPath logger:logger.debug];
+  return [[self extractStream:stream withExtractor:extractor logger:logger] mapReplace:extractPath];
 }
 
 + (FBFuture<FBManagedProcess<NSNull *, NSInputStream *, id> *> *)createGzipForPath:(NSString *)path logger:(id<FBControlCoreLogger>)logger
@@ -108,7 +180,7 @@ NSString *const BSDTarPath = @"/usr/bin/bsdtar";
     start];
 }
 
-+ (FBFuture<NSData *> *)createGzippedTarDataForPath:(NSString *)path queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger
++ (FBFuture<FBManagedProcess<NSNull *, FBProcessOutputReader *, id> *> *)createGzippedTarReaderForPath:(NSString *)path logger:(id<FBControlCoreLogger>)logger
 {
   NSError *error = nil;
   FBProcessBuilder<NSNull *, NSData *, id> *builder = [self createGzippedTarTaskBuilderForPath:path logger:logger error:&error];
@@ -116,14 +188,205 @@ NSString *const BSDTarPath = @"/usr/bin/bsdtar";
     return [FBFuture futureWithError:error];
   }
   return [[builder
-    runUntilCompletionWithAcceptableExitCodes:[NSSet setWithObject:@0]]
-    onQueue:queue map:^(FBManagedProcess<NSNull *, NSData *, id<FBControlCoreLogger>> *result) {
-      return [result stdOut];
+    withStdOutToReader]
+    start];
+}
+
++ (FBFuture<NSData *> *)createGzippedTarDataForPath:(NSString *)path queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger
+{
+  id<FBAccumulatingBuffer> buffer = FBDataBuffer.accumulatingBuffer;
+  return [[self
+    writeGzippedTarForPath:path toConsumer:buffer compressionLevel:FBGzipCompressionLevelDefault queue:queue logger:logger]
+    onQueue:queue map:^(id _) {
+      return buffer.data;
+    }];
+}
+
++ (FBFuture<NSNull *> *)writeGzippedTarForPath:(NSString *)path toConsumer:(id<FBDataConsumer>)consumer compressionLevel:(int)compressionLevel queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger
+{
+  return [FBFuture
+    onQueue:queue resolve:^ FBFuture<NSNull *> * {
+      FBGzipCompressor *compressor = [FBGzipCompressor compressorWithConsumer:consumer level:compressionLevel];
+      NSError *error = nil;
+      BOOL success = [self writeTarForPath:path toConsumer:compressor logger:logger error:&error];
+      // The compressor passes on the end-of-file once all compressed output has been written.
+      [compressor consumeEndOfFile];
+      if (!success) {
+        return [FBFuture futureWithError:error];
+      }
+      return [compressor.finishedConsuming
+        onQueue:queue map:^(id _) {
+          [logger.info logFormat:@"Wrote gzipped tar of %@ from %llu bytes", path, compressor.bytesConsumed];
+          return NSNull.null;
+        }];
     }];
 }
 
 #pragma mark Private
 
++ (BOOL)writeTarForPath:(NSString *)path toConsumer:(id<FBDataConsumer>)consumer logger:(id<FBControlCoreLogger>)logger error:(NSError **)error
+{
+  BOOL isDirectory = NO;
+  if (![NSFileManager.defaultManager fileExistsAtPath:path isDirectory:&isDirectory]) {
+    return [[FBControlCoreError
+      describeFormat:@"Path for tarring %@ doesn't exist", path]
+      failBool:error];
+  }
+  // The same layout as 'tar -C <directory> <name>', a directory is archived with itself as the root.
+  NSString *directory = isDirectory ? path : path.stringByDeletingLastPathComponent;
+  NSMutableArray<NSString *> *names = NSMutableArray.array;
+  if (isDirectory) {
+    [names addObject:@"."];
+    for (NSString *relativePath in [NSFileManager.defaultManager enumeratorAtPath:path]) {
+      [names addObject:[@"./" stringByAppendingString:relativePath]];
+    }
+  } else {
+    [names addObject:path.lastPathComponent];
+  }
+  for (NSString *name in names) {
+    if (![self writeTarEntryNamed:name atPath:[directory stringByAppendingPathComponent:name] toConsumer:consumer error:error]) {
+      return NO;
+    }
+  }
+  [logger.debug logFormat:@"Tarred %lu entries of %@", (unsigned long) names.count, path];
+  // Two empty blocks end the archive.
+  [consumer consumeData:[NSMutableData dataWithLength:TarBlockSize * 2]];
+  return YES;
+}
+
++ (BOOL)writeTarEntryNamed:(NSString *)name atPath:(NSString *)path toConsumer:(id<FBDataConsumer>)consumer error:(NSError **)error
+{
+  struct stat info;
+  if (lstat(path.fileSystemRepresentation, &info) != 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to stat %@ for tarring: %s", path, strerror(errno)]
+      failBool:error];
+  }
+  char type = '0';
+  uint64_t size = 0;
+  NSString *linkName = @"";
+  switch (info.st_mode & S_IFMT) {
+    case S_IFREG:
+      size = (uint64_t) info.st_size;
+      break;
+    case S_IFDIR:
+      type = '5';
+      name = [name hasSuffix:@"/"] ? name : [name stringByAppendingString:@"/"];
+      break;
+    case S_IFLNK:
+      type = '2';
+      linkName = [NSFileManager.defaultManager destinationOfSymbolicLinkAtPath:path error:error];
+      if (!linkName) {
+        return NO;
+      }
+      break;
+    default:
+      // Sockets, fifos and devices have no content that can be transferred.
+      return YES;
+  }
+
+  NSData *nameData = [name dataUsingEncoding:NSUTF8StringEncoding];
+  NSData *linkData = [linkName dataUsingEncoding:NSUTF8StringEncoding];
+  // Names that don't fit in the header are written as GNU long name entries before the header, which bsdtar also reads.
+  if (linkData.length > TarNameSize) {
+    [self writeTarLongName:linkData type:'K' toConsumer:consumer];
+  }
+  NSData *prefix = nil;
+  NSData *shortName = nil;
+  if (!TarSplitName(nameData, &prefix, &shortName)) {
+    [self writeTarLongName:nameData type:'L' toConsumer:consumer];
+    prefix = NSData.data;
+    shortName = nameData;
+  }
+  [consumer consumeData:TarHeader(shortName, prefix, linkData, type, info, size)];
+  if (size == 0) {
+    return YES;
+  }
+
+  int fileDescriptor = open(path.fileSystemRepresentation, O_RDONLY);
+  if (fileDescriptor < 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to open %@ for tarring: %s", path, strerror(errno)]
+      failBool:error];
+  }
+  uint64_t remaining = size;
+  while (remaining > 0) {
+    NSMutableData *chunk = [NSMutableData dataWithLength:(NSUInteger) MIN(remaining, (uint64_t) TarReadSize)];
+    ssize_t result = read(fileDescriptor, chunk.mutableBytes, chunk.length);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result < 0) {
+      close(fileDescriptor);
+      return [[FBControlCoreError
+        describeFormat:@"Failed to read %@ for tarring: %s", path, strerror(errno)]
+        failBool:error];
+    }
+    if (result == 0) {
+      // The file was truncated whilst it was being read, the size in the header must still be honoured.
+      chunk = [NSMutableData dataWithLength:(NSUInteger) MIN(remaining, (uint64_t) TarReadSize)];
+    } else {
+      chunk.length = (NSUInteger) result;
+    }
+    [consumer consumeData:chunk];
+    remaining -= chunk.length;
+  }
+  close(fileDescriptor);
+  [self writeTarPaddingForSize:size toConsumer:consumer];
+  return YES;
+}
+
++ (void)writeTarLongName:(NSData *)name type:(char)type toConsumer:(id<FBDataConsumer>)consumer
+{
+  struct stat info;
+  memset(&info, 0, sizeof(info));
+  NSMutableData *data = [name mutableCopy];
+  [data appendBytes:"" length:1];
+  [consumer consumeData:TarHeader([@"././@LongLink" dataUsingEncoding:NSUTF8StringEncoding], NSData.data, NSData.data, type, info, data.length)];
+  [consumer consumeData:data];
+  [self writeTarPaddingForSize:data.length toConsumer:consumer];
+}
+
++ (void)writeTarPaddingForSize:(uint64_t)size toConsumer:(id<FBDataConsumer>)consumer
+{
+  size_t padding = (TarBlockSize - size % TarBlockSize) % TarBlockSize;
+  if (padding > 0) {
+    [consumer consumeData:[NSMutableData dataWithLength:padding]];
+  }
+}
+
++ (FBFuture<NSNull *> *)extractStream:(FBProcessInput *)stream withExtractor:(FBArchiveExtractor *)extractor logger:(id<FBControlCoreLogger>)logger
+{
+  dispatch_queue_t queue = dispatch_queue_create("com.facebook.fbcontrolcore.archive_extraction", DISPATCH_QUEUE_SERIAL);
+  // The stream is attached as it would be to the stdin of a process, the read end is then read directly into the extractor.
+  // The read end is closed when the stream is detached, which happens whether or not extraction succeeds.
+  FBFuture<NSNull *> *extraction = [[[stream
+    attach]
+    onQueue:queue fmap:^(FBProcessStreamAttachment *attachment) {
+      FBFileReader *reader = [FBFileReader readerWithFileDescriptor:attachment.fileDescriptor closeOnEndOfFile:NO consumer:extractor configuration:FBFileReaderConfiguration.throughputConfiguration logger:nil];
+      return [[reader
+        startReading]
+        onQueue:queue fmap:^(id _) {
+          return [reader finishedReading];
+        }];
+    }]
+    onQueue:queue fmap:^ FBFuture<NSNull *> * (NSNumber *readErrorCode) {
+      if (readErrorCode.intValue != 0) {
+        return [[FBControlCoreError
+          describeFormat:@"Failed to read archive stream: %s", strerror(readErrorCode.intValue)]
+          failFuture];
+      }
+      return extractor.finishedConsuming;
+    }];
+  return [extraction
+    onQueue:queue chain:^(FBFuture<NSNull *> *future) {
+      if (future.error) {
+        [logger logFormat:@"Extraction failed: %@", future.error];
+      }
+      return [[stream detach] chainReplace:future];
+    }];
+}
+
 + (NSString *)flagStringForExtractionWithOverrideModificationTime:(BOOL)overrideMTime debugLogging:(BOOL)debugLogging
 {
   NSMutableArray<NSString *> *flags = [@[@"z", @"x", @"p"] mutableCopy];
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBAtomicSnapshot.h"
+
+#import <stdatomic.h>
+
+@implementation FBAtomicSnapshot
+{
+  // An unretained pointer to the current snapshot, which is kept alive by the retired snapshots.
+  _Atomic(void *) _current;
+  // Every snapshot that has been stored, including the current one. Only touched by writers.
+  NSMutableArray *_retired;
+}
+
+#pragma mark Initializers
+
+- (instancetype)initWithSnapshot:(id)snapshot
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _retired = [NSMutableArray arrayWithObject:snapshot];
+  atomic_init(&_current, (__bridge void *) snapshot);
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (id)load
+{
+  // Acquire the writes that built the snapshot before it was published.
+  return (__bridge id) atomic_load_explicit(&_current, memory_order_acquire);
+}
+
+- (void)store:(id)snapshot
+{
+  [_retired addObject:snapshot];
+  atomic_store_explicit(&_current, (__bridge void *) snapshot, memory_order_release);
+}
+
+@end
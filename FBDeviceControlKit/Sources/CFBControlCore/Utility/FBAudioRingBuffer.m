@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBAudioRingBuffer.h"
+
+#import <stdatomic.h>
+#import <stdlib.h>
+#import <string.h>
+
+static NSUInteger RoundUpToPowerOfTwo(NSUInteger value)
+{
+  NSUInteger capacity = 2;
+  while (capacity < value) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+@implementation FBAudioRingBuffer
+{
+  float *_storage;
+  NSUInteger _mask;
+  // Monotonic positions, wrapped into the storage with the mask. The write position is only advanced by the producer, the read position only by the consumer.
+  atomic_uint_fast64_t _writePosition;
+  atomic_uint_fast64_t _readPosition;
+}
+
+#pragma mark Initializers
+
+- (instancetype)initWithMinimumCapacity:(NSUInteger)minimumCapacity
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _capacity = RoundUpToPowerOfTwo(minimumCapacity);
+  _mask = _capacity - 1;
+  _storage = calloc(_capacity, sizeof(float));
+  atomic_init(&_writePosition, 0);
+  atomic_init(&_readPosition, 0);
+
+  return self;
+}
+
+- (void)dealloc
+{
+  free(_storage);
+}
+
+#pragma mark Private
+
+- (FBAudioRingBufferSegments)segmentsFromPosition:(uint64_t)position count:(NSUInteger)count
+{
+  NSUInteger offset = (NSUInteger) (position & _mask);
+  NSUInteger firstCount = MIN(count, _capacity - offset);
+  NSUInteger secondCount = count - firstCount;
+  return (FBAudioRingBufferSegments) {
+    .first = firstCount > 0 ? _storage + offset : NULL,
+    .firstCount = firstCount,
+    .second = secondCount > 0 ? _storage : NULL,
+    .secondCount = secondCount,
+  };
+}
+
+#pragma mark Producer
+
+- (NSUInteger)write:(const float *)samples count:(NSUInteger)count
+{
+  FBAudioRingBufferSegments segments = [self writableSegments];
+  NSUInteger firstCount = MIN(count, segments.firstCount);
+  NSUInteger secondCount = MIN(count - firstCount, segments.secondCount);
+  if (firstCount > 0) {
+    memcpy(segments.first, samples, firstCount * sizeof(float));
+  }
+  if (secondCount > 0) {
+    memcpy(segments.second, samples + firstCount, secondCount * sizeof(float));
+  }
+  [self commitWrite:firstCount + secondCount];
+  return firstCount + secondCount;
+}
+
+- (FBAudioRingBufferSegments)writableSegments
+{
+  uint64_t writePosition = atomic_load_explicit(&_writePosition, memory_order_relaxed);
+  // Acquire the space released by the consumer.
+  uint64_t readPosition = atomic_load_explicit(&_readPosition, memory_order_acquire);
+  return [self segmentsFromPosition:writePosition count:_capacity - (NSUInteger) (writePosition - readPosition)];
+}
+
+- (void)commitWrite:(NSUInteger)count
+{
+  uint64_t writePosition = atomic_load_explicit(&_writePosition, memory_order_relaxed);
+  // Release the written samples to the consumer.
+  atomic_store_explicit(&_writePosition, writePosition + count, memory_order_release);
+}
+
+#pragma mark Consumer
+
+- (NSUInteger)read:(float *)samples count:(NSUInteger)count
+{
+  FBAudioRingBufferSegments segments = [self readableSegments];
+  NSUInteger firstCount = MIN(count, segments.firstCount);
+  NSUInteger secondCount = MIN(count - firstCount, segments.secondCount);
+  if (firstCount > 0) {
+    memcpy(samples, segments.first, firstCount * sizeof(float));
+  }
+  if (secondCount > 0) {
+    memcpy(samples + firstCount, segments.second, secondCount * sizeof(float));
+  }
+  [self commitRead:firstCount + secondCount];
+  return firstCount + secondCount;
+}
+
+- (NSUInteger)skip:(NSUInteger)count
+{
+  NSUInteger skipped = MIN(count, self.availableToRead);
+  [self commitRead:skipped];
+  return skipped;
+}
+
+- (FBAudioRingBufferSegments)readableSegments
+{
+  uint64_t readPosition = atomic_load_explicit(&_readPosition, memory_order_relaxed);
+  // Acquire the samples released by the producer.
+  uint64_t writePosition = atomic_load_explicit(&_writePosition, memory_order_acquire);
+  return [self segmentsFromPosition:readPosition count:(NSUInteger) (writePosition - readPosition)];
+}
+
+- (void)commitRead:(NSUInteger)count
+{
+  uint64_t readPosition = atomic_load_explicit(&_readPosition, memory_order_relaxed);
+  // Release the space to the producer.
+  atomic_store_explicit(&_readPosition, readPosition + count, memory_order_release);
+}
+
+#pragma mark Other
+
+- (void)reset
+{
+  atomic_store_explicit(&_readPosition, atomic_load_explicit(&_writePosition, memory_order_relaxed), memory_order_release);
+}
+
+#pragma mark Properties
+
+- (NSUInteger)availableToRead
+{
+  uint64_t readPosition = atomic_load_explicit(&_readPosition, memory_order_acquire);
+  uint64_t writePosition = atomic_load_explicit(&_writePosition, memory_order_acquire);
+  // The positions are loaded one after the other, so the producer may have run ahead of a stale read position.
+  return MIN((NSUInteger) (writePosition - readPosition), _capacity);
+}
+
+- (NSUInteger)availableToWrite
+{
+  return _capacity - self.availableToRead;
+}
+
+@end
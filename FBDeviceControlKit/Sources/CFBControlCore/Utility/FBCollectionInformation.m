@@ -7,6 +7,33 @@
 
 #import "FBCollectionInformation.h"
 
+@interface FBCollectionInformation_LazyArrayDescription : NSObject
+
+@property (nonatomic, copy, readonly) NSArray *array;
+
+@end
+
+@implementation FBCollectionInformation_LazyArrayDescription
+
+- (instancetype)initWithArray:(NSArray *)array
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _array = [array copy];
+
+  return self;
+}
+
+- (NSString *)description
+{
+  return [FBCollectionInformation oneLineDescriptionFromArray:self.array];
+}
+
+@end
+
 @implementation FBCollectionInformation
 
 + (NSString *)oneLineDescriptionFromArray:(NSArray *)array
@@ -19,6 +46,11 @@
   return [NSString stringWithFormat:@"[%@]", [[array valueForKeyPath:keyPath] componentsJoinedByString:@", "]];
 }
 
++ (id)lazyOneLineDescriptionFromArray:(NSArray *)array
+{
+  return [[FBCollectionInformation_LazyArrayDescription alloc] initWithArray:array];
+}
+
 + (NSString *)oneLineDescriptionFromDictionary:(NSDictionary *)dictionary
 {
   NSMutableArray<NSString *> *pieces = [NSMutableArray array];
@@ -10,62 +10,330 @@
 
 #import "FBConcatedJsonParser.h"
 
+#import "FBControlCoreError.h"
+
+static NSUInteger SkipWhitespace(const uint8_t *bytes, NSUInteger length, NSUInteger index)
+{
+  while (index < length && (bytes[index] == ' ' || bytes[index] == '\n' || bytes[index] == '\r' || bytes[index] == '\t')) {
+    index++;
+  }
+  return index;
+}
+
+// Returns the index after the closing quote of the string that opens at index, NSNotFound if it is unterminated.
+static NSUInteger SkipString(const uint8_t *bytes, NSUInteger length, NSUInteger index)
+{
+  for (index = index + 1; index < length; index++) {
+    if (bytes[index] == '\\') {
+      index++;
+    } else if (bytes[index] == '"') {
+      return index + 1;
+    }
+  }
+  return NSNotFound;
+}
+
+// Returns the index after the value that starts at index, NSNotFound if it is truncated.
+static NSUInteger SkipValue(const uint8_t *bytes, NSUInteger length, NSUInteger index)
+{
+  if (index >= length) {
+    return NSNotFound;
+  }
+  if (bytes[index] == '"') {
+    return SkipString(bytes, length, index);
+  }
+  if (bytes[index] != '{' && bytes[index] != '[') {
+    // A number, boolean or null, which ends at the next delimiter.
+    while (index < length && bytes[index] != ',' && bytes[index] != '}' && bytes[index] != ']' && bytes[index] != ' ' && bytes[index] != '\n' && bytes[index] != '\r' && bytes[index] != '\t') {
+      index++;
+    }
+    return index;
+  }
+  // Containers are skipped by their depth, strings are skipped separately so that brackets within them are ignored.
+  NSUInteger depth = 0;
+  while (index < length) {
+    uint8_t byte = bytes[index];
+    if (byte == '"') {
+      index = SkipString(bytes, length, index);
+      if (index == NSNotFound) {
+        return NSNotFound;
+      }
+      continue;
+    }
+    if (byte == '{' || byte == '[') {
+      depth++;
+    } else if (byte == '}' || byte == ']') {
+      depth--;
+      if (depth == 0) {
+        return index + 1;
+      }
+    }
+    index++;
+  }
+  return NSNotFound;
+}
+
+static NSData *ViewOfBytes(const uint8_t *bytes, NSUInteger start, NSUInteger end)
+{
+  return [NSData dataWithBytesNoCopy:(void *) (bytes + start) length:end - start freeWhenDone:NO];
+}
+
 @implementation FBConcatedJsonParser
 
 #pragma mark Public
 
-+ (nullable NSDictionary<NSString *, id> *)parseConcatenatedJSONFromString:(NSString *)str error:(NSError **)error{
-  __block int bracketCounter = 0;
-  __block BOOL characterEscaped = false;
-  __block BOOL inString = false;
-  __block NSError *err = nil;
-
++ (nullable NSDictionary<NSString *, id> *)parseConcatenatedJSONFromString:(NSString *)str error:(NSError **)error
+{
   NSMutableDictionary<NSString *, id> *concatenatedJson = [NSMutableDictionary new];
-  __block NSMutableString *json = [NSMutableString new];
-  
-  [str enumerateSubstringsInRange:NSMakeRange(0, [str length]) options:NSStringEnumerationByComposedCharacterSequences usingBlock:^(NSString * _Nullable substring, NSRange substringRange, NSRange enclosingRange, BOOL * _Nonnull stop) {
-    if (!substring) {
-      return;
-    }
-    NSString *c = substring;
-    BOOL escaped = characterEscaped;
-    characterEscaped = false;
-    if (escaped) {
-      [json appendString:c];
-      return;
-    }
-    if (!inString) {
-      if ([c isEqualToString: @"\n"]) {
-        return;
+  FBConcatenatedJSONStreamParser *parser = [FBConcatenatedJSONStreamParser parserWithValueHandler:^(id value) {
+    if ([value isKindOfClass:NSDictionary.class]) {
+      [concatenatedJson addEntriesFromDictionary:value];
+    }
+  }];
+  NSData *data = [str dataUsingEncoding:NSUTF8StringEncoding];
+  [parser consumeData:data];
+  [parser consumeEndOfFile];
+  if (parser.error) {
+    if (error) {
+      *error = parser.error;
+    }
+    return nil;
+  }
+  return concatenatedJson;
+}
+
++ (BOOL)enumerateMembersOfConcatenatedJSONData:(NSData *)data error:(NSError **)error usingBlock:(void (^)(NSString *key, NSData *value, BOOL *stop))block
+{
+  const uint8_t *bytes = data.bytes;
+  NSUInteger length = data.length;
+  NSUInteger index = SkipWhitespace(bytes, length, 0);
+  BOOL stop = NO;
+  while (index < length) {
+    if (bytes[index] != '{') {
+      return [[FBControlCoreError
+        describeFormat:@"Expected an object at offset %lu", (unsigned long) index]
+        failBool:error];
+    }
+    index = SkipWhitespace(bytes, length, index + 1);
+    while (index < length && bytes[index] != '}') {
+      if (bytes[index] != '"') {
+        return [[FBControlCoreError
+          describeFormat:@"Expected a key at offset %lu", (unsigned long) index]
+          failBool:error];
+      }
+      NSUInteger keyEnd = SkipString(bytes, length, index);
+      if (keyEnd == NSNotFound) {
+        break;
       }
-      if ([c isEqualToString: @"{"]) {
-        bracketCounter += 1;
-      } else if ([c isEqualToString:@"}"]) {
-        bracketCounter -= 1;
+      NSString *key = [self decodeJSONValue:ViewOfBytes(bytes, index, keyEnd)];
+      index = SkipWhitespace(bytes, length, keyEnd);
+      if (index >= length || bytes[index] != ':' || ![key isKindOfClass:NSString.class]) {
+        return [[FBControlCoreError
+          describeFormat:@"Malformed member at offset %lu", (unsigned long) keyEnd]
+          failBool:error];
+      }
+      index = SkipWhitespace(bytes, length, index + 1);
+      NSUInteger valueEnd = SkipValue(bytes, length, index);
+      if (valueEnd == NSNotFound) {
+        break;
+      }
+      block(key, ViewOfBytes(bytes, index, valueEnd), &stop);
+      if (stop) {
+        return YES;
+      }
+      index = SkipWhitespace(bytes, length, valueEnd);
+      if (index < length && bytes[index] == ',') {
+        index = SkipWhitespace(bytes, length, index + 1);
       }
     }
-    if ([c isEqualToString: @"\\"]) {
-      characterEscaped = true;
+    if (index >= length) {
+      return [[FBControlCoreError
+        describe:@"JSON object is truncated"]
+        failBool:error];
+    }
+    index = SkipWhitespace(bytes, length, index + 1);
+  }
+  return YES;
+}
+
++ (BOOL)enumerateElementsOfJSONArrayData:(NSData *)data error:(NSError **)error usingBlock:(void (^)(NSData *element, NSUInteger index, BOOL *stop))block
+{
+  const uint8_t *bytes = data.bytes;
+  NSUInteger length = data.length;
+  NSUInteger index = SkipWhitespace(bytes, length, 0);
+  if (index >= length || bytes[index] != '[') {
+    return [[FBControlCoreError
+      describe:@"Expected an array"]
+      failBool:error];
+  }
+  index = SkipWhitespace(bytes, length, index + 1);
+  NSUInteger elementIndex = 0;
+  BOOL stop = NO;
+  while (index < length && bytes[index] != ']') {
+    NSUInteger elementEnd = SkipValue(bytes, length, index);
+    if (elementEnd == NSNotFound) {
+      break;
     }
-    if ([c isEqualToString: @"\""]) {
-      inString = !inString;
+    block(ViewOfBytes(bytes, index, elementEnd), elementIndex++, &stop);
+    if (stop) {
+      return YES;
     }
-    [json appendString:c];
-    if (bracketCounter == 0) {
-      NSDictionary<NSString *, id> *parsed = [NSJSONSerialization JSONObjectWithData:[json dataUsingEncoding:NSUTF8StringEncoding] options:0 error:&err];
-      if (!parsed) {
-        *stop = YES;
-      }
-      json = [NSMutableString new];
-      [concatenatedJson addEntriesFromDictionary:parsed];
+    index = SkipWhitespace(bytes, length, elementEnd);
+    if (index < length && bytes[index] == ',') {
+      index = SkipWhitespace(bytes, length, index + 1);
     }
-  }];
-  if (err) {
-    *error = err;
+  }
+  if (index >= length) {
+    return [[FBControlCoreError
+      describe:@"JSON array is truncated"]
+      failBool:error];
+  }
+  return YES;
+}
+
++ (nullable id)decodeJSONValue:(NSData *)data
+{
+  return [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingFragmentsAllowed error:nil];
+}
+
+@end
+
+@interface FBConcatenatedJSONStreamParser ()
+
+@property (nonatomic, copy, readonly) void (^handler)(id value);
+@property (nonatomic, strong, readonly) NSMutableData *pending;
+@property (nonatomic, strong, nullable, readwrite) NSError *error;
+@property (nonatomic, assign, readwrite) NSUInteger valueCount;
+@property (nonatomic, assign, readwrite) NSUInteger depth;
+@property (nonatomic, assign, readwrite) BOOL inString;
+@property (nonatomic, assign, readwrite) BOOL escaped;
+@property (nonatomic, assign, readwrite) uint64_t offset;
+
+@end
+
+@implementation FBConcatenatedJSONStreamParser
+
+#pragma mark Initializers
+
++ (instancetype)parserWithValueHandler:(void (^)(id value))handler
+{
+  return [[self alloc] initWithValueHandler:handler];
+}
+
+- (instancetype)initWithValueHandler:(void (^)(id value))handler
+{
+  self = [super init];
+  if (!self) {
     return nil;
   }
 
-  return concatenatedJson;
+  _handler = handler;
+  _pending = [NSMutableData data];
+
+  return self;
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+    if (![self consumeBytes:bytes length:byteRange.length]) {
+      *stop = YES;
+    }
+  }];
+}
+
+- (void)consumeEndOfFile
+{
+  if (!self.error && self.depth > 0) {
+    self.error = [[FBControlCoreError
+      describeFormat:@"JSON value is truncated at offset %llu", self.offset]
+      build];
+  }
+  self.pending.length = 0;
+}
+
+#pragma mark Private
+
+- (BOOL)consumeBytes:(const uint8_t *)bytes length:(NSUInteger)length
+{
+  if (self.error) {
+    return NO;
+  }
+  NSUInteger depth = self.depth;
+  BOOL inString = self.inString;
+  BOOL escaped = self.escaped;
+  // The start of the bytes of the current value within this chunk, which are appended to the pending bytes in one go.
+  NSUInteger valueStart = 0;
+  BOOL success = YES;
+  for (NSUInteger index = 0; index < length; index++) {
+    uint8_t byte = bytes[index];
+    if (depth == 0) {
+      if (byte == ' ' || byte == '\n' || byte == '\r' || byte == '\t') {
+        continue;
+      }
+      if (byte != '{' && byte != '[') {
+        self.error = [[FBControlCoreError
+          describeFormat:@"Expected an object or array at offset %llu", self.offset + index]
+          build];
+        success = NO;
+        break;
+      }
+      valueStart = index;
+      depth = 1;
+      continue;
+    }
+    if (inString) {
+      if (escaped) {
+        escaped = NO;
+      } else if (byte == '\\') {
+        escaped = YES;
+      } else if (byte == '"') {
+        inString = NO;
+      }
+      continue;
+    }
+    if (byte == '"') {
+      inString = YES;
+    } else if (byte == '{' || byte == '[') {
+      depth++;
+    } else if (byte == '}' || byte == ']') {
+      depth--;
+      if (depth == 0) {
+        [self.pending appendBytes:bytes + valueStart length:index + 1 - valueStart];
+        if (![self emitPendingValueEndingAtOffset:self.offset + index]) {
+          success = NO;
+          break;
+        }
+      }
+    }
+  }
+  if (success && depth > 0) {
+    [self.pending appendBytes:bytes + valueStart length:length - valueStart];
+  }
+  self.depth = depth;
+  self.inString = inString;
+  self.escaped = escaped;
+  self.offset += length;
+  return success;
+}
+
+- (BOOL)emitPendingValueEndingAtOffset:(uint64_t)offset
+{
+  NSError *error = nil;
+  id value = [NSJSONSerialization JSONObjectWithData:self.pending options:0 error:&error];
+  self.pending.length = 0;
+  if (!value) {
+    self.error = [[[FBControlCoreError
+      describeFormat:@"Malformed JSON value ending at offset %llu", offset]
+      causedBy:error]
+      build];
+    return NO;
+  }
+  self.valueCount += 1;
+  self.handler(value);
+  return YES;
 }
 
 @end
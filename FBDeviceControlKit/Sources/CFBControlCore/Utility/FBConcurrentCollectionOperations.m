@@ -7,6 +7,8 @@
 
 #import "FBConcurrentCollectionOperations.h"
 
+#import <stdatomic.h>
+
 @interface FBConcurrentCollectionOperations_FilterTerminal : NSObject
 
 + (instancetype)terminal;
@@ -58,6 +60,40 @@
     }];
 }
 
++ (NSArray *)generate:(NSUInteger)count maxConcurrency:(NSUInteger)maxConcurrency withBlock:( id(^)(NSUInteger index) )block
+{
+  NSParameterAssert(maxConcurrency > 0);
+  NSMutableArray *array = [NSMutableArray array];
+  for (NSUInteger index = 0; index < count; index++) {
+    [array addObject:NSNull.null];
+  }
+
+  // Each of the workers takes the next index until all are taken, so no more than maxConcurrency blocks run at once and a slow block does not hold up the others.
+  size_t workers = (size_t) MIN(maxConcurrency, count);
+  __block atomic_size_t nextIndex = 0;
+  dispatch_apply(workers, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^ (size_t _) {
+    for (size_t index = atomic_fetch_add(&nextIndex, 1); index < count; index = atomic_fetch_add(&nextIndex, 1)) {
+      id object = block(index);
+      if (object) {
+        @synchronized(array) {
+          array[index] = object;
+        }
+      }
+    }
+  });
+  return [array copy];
+}
+
++ (NSArray *)map:(NSArray *)array maxConcurrency:(NSUInteger)maxConcurrency withBlock:( id(^)(id object) )block
+{
+  return [self
+    generate:array.count
+    maxConcurrency:maxConcurrency
+    withBlock:^ id (NSUInteger index) {
+      return block(array[index]);
+    }];
+}
+
 + (NSArray *)filter:(NSArray *)array predicate:(NSPredicate *)predicate
 {
   return [self filterMap:array predicate:predicate map:^ id (id object) {
@@ -7,21 +7,374 @@
 
 #import "FBControlCoreError.h"
 
+#import <os/lock.h>
+
 #import "FBFuture.h"
 #import "FBControlCoreGlobalConfiguration.h"
 #import "FBControlCoreLogger.h"
 
 NSString *const FBControlCoreErrorDomain = @"com.facebook.FBControlCore";
 
+// The userInfo key that a lazily rendered description is stored under, until it is read through NSLocalizedDescriptionKey.
+static NSString *const LazyDescriptionKey = @"FBControlCoreLazyDescription";
+
+#pragma mark Lazy Descriptions
+
+// Renders a description on first use and caches it.
+// Failures that are handled straight away, such as with fallback: or handleError:, never pay for the rendering.
+@interface FBControlCoreError_LazyDescription : NSObject
+
+- (instancetype)initWithRenderer:(NSString *(^)(void))renderer;
+
+@property (nonatomic, copy, readonly) NSString *rendered;
+
+@end
+
+@implementation FBControlCoreError_LazyDescription {
+  os_unfair_lock _lock;
+  NSString *(^_renderer)(void);
+  NSString *_rendered;
+}
+
+- (instancetype)initWithRenderer:(NSString *(^)(void))renderer
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _lock = OS_UNFAIR_LOCK_INIT;
+  _renderer = renderer;
+
+  return self;
+}
+
+- (NSString *)rendered
+{
+  os_unfair_lock_lock(&_lock);
+  NSString *(^renderer)(void) = _renderer;
+  NSString *rendered = _rendered;
+  os_unfair_lock_unlock(&_lock);
+  if (rendered) {
+    return rendered;
+  }
+
+  // Rendered outside the lock, as describing the arguments can call arbitrary code. Concurrent first reads render the same string.
+  rendered = renderer();
+  os_unfair_lock_lock(&_lock);
+  _rendered = rendered;
+  _renderer = nil;
+  os_unfair_lock_unlock(&_lock);
+  return rendered;
+}
+
+- (NSString *)description
+{
+  return self.rendered;
+}
+
+// Coders (such as XPC) see the rendered string, so errors cross process boundaries as plain property lists.
+- (id)replacementObjectForCoder:(NSCoder *)coder
+{
+  return self.rendered;
+}
+
+@end
+
+// A single conversion in a format string, along with the argument captured for it.
+@interface FBControlCoreError_FormatConversion : NSObject
+
+@property (nonatomic, assign, readwrite) NSRange range;
+@property (nonatomic, copy, readwrite) NSString *specifier;
+@property (nonatomic, assign, readwrite) unichar conversion;
+@property (nonatomic, strong, readwrite, nullable) id object;
+@property (nonatomic, assign, readwrite) long long signedValue;
+@property (nonatomic, assign, readwrite) unsigned long long unsignedValue;
+@property (nonatomic, assign, readwrite) double doubleValue;
+
+@end
+
+@implementation FBControlCoreError_FormatConversion
+
+@end
+
+static BOOL IsFormatFlagOrWidth(unichar character)
+{
+  return (character >= '0' && character <= '9') || character == '-' || character == '+' || character == ' ' || character == '#' || character == '\'' || character == '.';
+}
+
+typedef NS_ENUM(NSUInteger, FBFormatLength) {
+  FBFormatLengthDefault,
+  FBFormatLengthChar,
+  FBFormatLengthShort,
+  FBFormatLengthLong,
+  FBFormatLengthLongLong,
+  FBFormatLengthSize,
+  FBFormatLengthPointerDifference,
+  FBFormatLengthMax,
+  FBFormatLengthLongDouble,
+};
+
+// Takes the arguments for the conversions in the format from the va_list, boxing each of them.
+// Returns nil for formats that cannot be captured (positional or '*' arguments, wide strings, long doubles), which are then formatted eagerly.
+static NSArray<FBControlCoreError_FormatConversion *> *CaptureFormatArguments(NSString *format, va_list args)
+{
+  NSMutableArray<FBControlCoreError_FormatConversion *> *conversions = [NSMutableArray array];
+  NSUInteger length = format.length;
+  NSUInteger index = 0;
+  while (index < length) {
+    if ([format characterAtIndex:index] != '%') {
+      index++;
+      continue;
+    }
+    NSUInteger start = index++;
+    if (index < length && [format characterAtIndex:index] == '%') {
+      index++;
+      continue;
+    }
+    // Flags, width and precision are kept in the specifier as-is.
+    while (index < length && IsFormatFlagOrWidth([format characterAtIndex:index])) {
+      index++;
+    }
+    if (index < length && ([format characterAtIndex:index] == '*' || [format characterAtIndex:index] == '$')) {
+      return nil;
+    }
+    NSUInteger lengthStart = index;
+    FBFormatLength lengthModifier = FBFormatLengthDefault;
+    while (index < length) {
+      unichar character = [format characterAtIndex:index];
+      if (character == 'h') {
+        lengthModifier = lengthModifier == FBFormatLengthShort ? FBFormatLengthChar : FBFormatLengthShort;
+      } else if (character == 'l') {
+        lengthModifier = lengthModifier == FBFormatLengthLong ? FBFormatLengthLongLong : FBFormatLengthLong;
+      } else if (character == 'q') {
+        lengthModifier = FBFormatLengthLongLong;
+      } else if (character == 'z') {
+        lengthModifier = FBFormatLengthSize;
+      } else if (character == 't') {
+        lengthModifier = FBFormatLengthPointerDifference;
+      } else if (character == 'j') {
+        lengthModifier = FBFormatLengthMax;
+      } else if (character == 'L') {
+        lengthModifier = FBFormatLengthLongDouble;
+      } else {
+        break;
+      }
+      index++;
+    }
+    if (index >= length) {
+      return nil;
+    }
+
+    FBControlCoreError_FormatConversion *conversion = [FBControlCoreError_FormatConversion new];
+    unichar character = [format characterAtIndex:index];
+    conversion.conversion = character;
+    // Integers are always re-rendered as long long, so the length modifier is dropped from the specifier.
+    NSString *flags = [format substringWithRange:NSMakeRange(start, lengthStart - start)];
+    switch (character) {
+      case '@':
+        conversion.object = va_arg(args, id);
+        conversion.specifier = [flags stringByAppendingString:@"@"];
+        break;
+      case 'd':
+      case 'i':
+        switch (lengthModifier) {
+          case FBFormatLengthLong:
+            conversion.signedValue = va_arg(args, long);
+            break;
+          case FBFormatLengthLongLong:
+            conversion.signedValue = va_arg(args, long long);
+            break;
+          case FBFormatLengthSize:
+            conversion.signedValue = va_arg(args, ssize_t);
+            break;
+          case FBFormatLengthPointerDifference:
+            conversion.signedValue = va_arg(args, ptrdiff_t);
+            break;
+          case FBFormatLengthMax:
+            conversion.signedValue = va_arg(args, intmax_t);
+            break;
+          case FBFormatLengthLongDouble:
+            return nil;
+          default:
+            conversion.signedValue = va_arg(args, int);
+            break;
+        }
+        conversion.specifier = [flags stringByAppendingFormat:@"ll%C", character];
+        break;
+      case 'o':
+      case 'u':
+      case 'x':
+      case 'X':
+        switch (lengthModifier) {
+          case FBFormatLengthLong:
+            conversion.unsignedValue = va_arg(args, unsigned long);
+            break;
+          case FBFormatLengthLongLong:
+            conversion.unsignedValue = va_arg(args, unsigned long long);
+            break;
+          case FBFormatLengthSize:
+            conversion.unsignedValue = va_arg(args, size_t);
+            break;
+          case FBFormatLengthPointerDifference:
+            conversion.unsignedValue = (unsigned long long) va_arg(args, ptrdiff_t);
+            break;
+          case FBFormatLengthMax:
+            conversion.unsignedValue = va_arg(args, uintmax_t);
+            break;
+          case FBFormatLengthLongDouble:
+            return nil;
+          case FBFormatLengthChar:
+            conversion.unsignedValue = (unsigned char) va_arg(args, unsigned int);
+            break;
+          case FBFormatLengthShort:
+            conversion.unsignedValue = (unsigned short) va_arg(args, unsigned int);
+            break;
+          default:
+            conversion.unsignedValue = va_arg(args, unsigned int);
+            break;
+        }
+        conversion.specifier = [flags stringByAppendingFormat:@"ll%C", character];
+        break;
+      case 'c':
+      case 'C':
+        conversion.signedValue = va_arg(args, int);
+        conversion.specifier = [flags stringByAppendingFormat:@"%C", character];
+        break;
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+        if (lengthModifier == FBFormatLengthLongDouble) {
+          return nil;
+        }
+        conversion.doubleValue = va_arg(args, double);
+        conversion.specifier = [flags stringByAppendingFormat:@"%C", character];
+        break;
+      case 's': {
+        // The C string may not outlive the call, so it is copied.
+        const char *string = va_arg(args, const char *);
+        conversion.object = string ? [NSData dataWithBytes:string length:strlen(string) + 1] : nil;
+        conversion.specifier = [flags stringByAppendingString:@"s"];
+        break;
+      }
+      case 'p':
+        conversion.unsignedValue = (unsigned long long) (uintptr_t) va_arg(args, void *);
+        conversion.specifier = [flags stringByAppendingString:@"p"];
+        break;
+      default:
+        return nil;
+    }
+    conversion.range = NSMakeRange(start, index + 1 - start);
+    [conversions addObject:conversion];
+    index++;
+  }
+  return conversions;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wformat-nonliteral"
+
+static NSString *RenderFormatConversion(FBControlCoreError_FormatConversion *conversion)
+{
+  NSString *specifier = conversion.specifier;
+  switch (conversion.conversion) {
+    case '@':
+      return [NSString stringWithFormat:specifier, conversion.object];
+    case 'd':
+    case 'i':
+      return [NSString stringWithFormat:specifier, conversion.signedValue];
+    case 'c':
+    case 'C':
+      return [NSString stringWithFormat:specifier, (int) conversion.signedValue];
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+      return [NSString stringWithFormat:specifier, conversion.unsignedValue];
+    case 's':
+      return [NSString stringWithFormat:specifier, [(NSData *) conversion.object bytes]];
+    case 'p':
+      return [NSString stringWithFormat:specifier, (void *) (uintptr_t) conversion.unsignedValue];
+    default:
+      return [NSString stringWithFormat:specifier, conversion.doubleValue];
+  }
+}
+
+#pragma clang diagnostic pop
+
+// Escaped percent signs in the literal text are unescaped, as they would have been by the formatter.
+static NSString *RenderFormatLiteral(NSString *format, NSRange range)
+{
+  return [[format substringWithRange:range] stringByReplacingOccurrencesOfString:@"%%" withString:@"%"];
+}
+
+static NSString *RenderFormat(NSString *format, NSArray<FBControlCoreError_FormatConversion *> *conversions)
+{
+  NSMutableString *rendered = [NSMutableString string];
+  NSUInteger location = 0;
+  for (FBControlCoreError_FormatConversion *conversion in conversions) {
+    [rendered appendString:RenderFormatLiteral(format, NSMakeRange(location, conversion.range.location - location))];
+    [rendered appendString:RenderFormatConversion(conversion)];
+    location = NSMaxRange(conversion.range);
+  }
+  [rendered appendString:RenderFormatLiteral(format, NSMakeRange(location, format.length - location))];
+  return rendered;
+}
+
+static FBControlCoreError_LazyDescription *LazyDescriptionFromFormat(NSString *format, va_list args)
+{
+  NSArray<FBControlCoreError_FormatConversion *> *conversions = CaptureFormatArguments(format, args);
+  if (!conversions) {
+    return nil;
+  }
+  return [[FBControlCoreError_LazyDescription alloc] initWithRenderer:^{
+    return RenderFormat(format, conversions);
+  }];
+}
+
+// Foundation asks the provider for keys that are missing from the userInfo, so localizedDescription renders the lazy description on first access.
+static void RegisterLazyDescriptionProviderForDomain(NSString *domain)
+{
+  static os_unfair_lock lock = OS_UNFAIR_LOCK_INIT;
+  static NSMutableSet<NSString *> *domains = nil;
+  os_unfair_lock_lock(&lock);
+  if (!domains) {
+    domains = [NSMutableSet set];
+  }
+  BOOL registered = [domains containsObject:domain];
+  [domains addObject:domain];
+  os_unfair_lock_unlock(&lock);
+  if (registered) {
+    return;
+  }
+  [NSError setUserInfoValueProviderForDomain:domain provider:^ id (NSError *error, NSErrorUserInfoKey key) {
+    if (![key isEqualToString:NSLocalizedDescriptionKey]) {
+      return nil;
+    }
+    // Errors that have been through a coder carry the rendered string instead.
+    return [error.userInfo[LazyDescriptionKey] description];
+  }];
+}
+
+#pragma mark FBControlCoreError
+
 @interface FBControlCoreError ()
 
 @property (nonatomic, copy, readwrite) NSString *domain;
 @property (nonatomic, copy, readwrite) NSString *describedAs;
+@property (nonatomic, strong, readwrite, nullable) FBControlCoreError_LazyDescription *lazyDescription;
 @property (nonatomic, copy, readwrite) NSError *cause;
 @property (nonatomic, strong, readwrite) NSMutableDictionary *additionalInfo;
 @property (nonatomic, assign, readwrite) BOOL describeRecursively;
 @property (nonatomic, assign, readwrite) NSInteger code;
 
+- (instancetype)describeFormat:(NSString *)format arguments:(va_list)args;
+
 @end
 
 @implementation FBControlCoreError
@@ -53,6 +406,7 @@ NSString *const FBControlCoreErrorDomain = @"com.facebook.FBControlCore";
 - (instancetype)describe:(NSString *)description
 {
   self.describedAs = description;
+  self.lazyDescription = nil;
   return self;
 }
 
@@ -60,18 +414,33 @@ NSString *const FBControlCoreErrorDomain = @"com.facebook.FBControlCore";
 {
   va_list args;
   va_start(args, format);
-  NSString *string = [[NSString alloc] initWithFormat:format arguments:args];
+  FBControlCoreError *error = [self.new describeFormat:format arguments:args];
   va_end(args);
-  return [self describe:string];
+  return error;
 }
 
 - (instancetype)describeFormat:(NSString *)format, ...
 {
   va_list args;
   va_start(args, format);
-  NSString *string = [[NSString alloc] initWithFormat:format arguments:args];
+  [self describeFormat:format arguments:args];
   va_end(args);
-  return [self describe:string];
+  return self;
+}
+
+// The format and its arguments are kept, and rendered when the built error's localizedDescription is first read.
+- (instancetype)describeFormat:(NSString *)format arguments:(va_list)args
+{
+  va_list capturedArgs;
+  va_copy(capturedArgs, args);
+  FBControlCoreError_LazyDescription *lazyDescription = LazyDescriptionFromFormat(format, capturedArgs);
+  va_end(capturedArgs);
+  if (!lazyDescription) {
+    return [self describe:[[NSString alloc] initWithFormat:format arguments:args]];
+  }
+  self.describedAs = nil;
+  self.lazyDescription = lazyDescription;
+  return self;
 }
 
 + (instancetype)causedBy:(NSError *)cause
@@ -180,13 +549,16 @@ NSString *const FBControlCoreErrorDomain = @"com.facebook.FBControlCore";
 - (NSError *)build
 {
   // If there's just a cause, there's no error to build
-  if (self.cause && !self.describedAs && self.additionalInfo.count == 0) {
+  if (self.cause && !self.describedAs && !self.lazyDescription && self.additionalInfo.count == 0) {
     return self.cause;
   }
 
   NSMutableDictionary *userInfo = [NSMutableDictionary dictionary];
   if (self.describedAs) {
     userInfo[NSLocalizedDescriptionKey] = self.describedAs;
+  } else if (self.lazyDescription) {
+    RegisterLazyDescriptionProviderForDomain(self.domain);
+    userInfo[LazyDescriptionKey] = self.lazyDescription;
   }
   if (self.cause) {
     userInfo[NSUnderlyingErrorKey] = self.underlyingError;
@@ -240,9 +612,9 @@ NSString *const FBControlCoreErrorDomain = @"com.facebook.FBControlCore";
 {
   va_list args;
   va_start(args, format);
-  NSString *string = [[NSString alloc] initWithFormat:format arguments:args];
+  FBControlCoreError *error = [self.new describeFormat:format arguments:args];
   va_end(args);
-  return [self errorForDescription:string];
+  return [error build];
 }
 
 + (id)failWithErrorMessage:(NSString *)errorMessage errorOut:(NSError **)errorOut
@@ -13,6 +13,20 @@
 
 static const char *LoggerSubsystem = "com.facebook.fbcontrolcore";
 
+static os_log_type_t OSLogTypeForLevel(FBControlCoreLogLevel level)
+{
+  switch (level) {
+    case FBControlCoreLogLevelError:
+      return OS_LOG_TYPE_ERROR;
+    case FBControlCoreLogLevelInfo:
+      return OS_LOG_TYPE_INFO;
+    case FBControlCoreLogLevelDebug:
+      return OS_LOG_TYPE_DEBUG;
+    default:
+      return OS_LOG_TYPE_DEFAULT;
+  }
+}
+
 @interface FBControlCoreLogger_OSLog : NSObject <FBControlCoreLogger>
 
 @property (nonatomic, strong, readonly) os_log_t client;
@@ -40,25 +54,17 @@ static const char *LoggerSubsystem = "com.facebook.fbcontrolcore";
 
 - (id<FBControlCoreLogger>)log:(NSString *)message
 {
-  switch (self.level) {
-    case FBControlCoreLogLevelError:
-      os_log_error(self.client, "%{public}s", message.UTF8String);
-      break;
-    case FBControlCoreLogLevelInfo:
-      os_log_info(self.client, "%{public}s", message.UTF8String);
-      break;
-    case FBControlCoreLogLevelDebug:
-      os_log_debug(self.client, "%{public}s", message.UTF8String);
-      break;
-    default:
-      os_log(self.client, "%{public}s", message.UTF8String);
-      break;
-  }
+  // The string object is passed through, so os_log only renders it if the message is recorded.
+  os_log_with_type(self.client, OSLogTypeForLevel(self.level), "%{public}@", message);
   return self;
 }
 
 - (id<FBControlCoreLogger>)logFormat:(NSString *)format, ...
 {
+  // os_log needs a constant format string, so the message has to be built here. Skip that when os_log would discard it.
+  if (!os_log_type_enabled(self.client, OSLogTypeForLevel(self.level))) {
+    return self;
+  }
   va_list args;
   va_start(args, format);
   NSString *string = [[NSString alloc] initWithFormat:format arguments:args];
@@ -93,6 +99,11 @@ static const char *LoggerSubsystem = "com.facebook.fbcontrolcore";
   return self;
 }
 
+- (BOOL)isEnabledForLevel:(FBControlCoreLogLevel)level
+{
+  return os_log_type_enabled(self.client, OSLogTypeForLevel(level));
+}
+
 @end
 
 #endif
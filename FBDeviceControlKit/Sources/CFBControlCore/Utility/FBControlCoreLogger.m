@@ -7,6 +7,8 @@
 
 #import "FBControlCoreLogger.h"
 
+#import <stdatomic.h>
+
 #import "FBDataConsumer.h"
 #import "FBFileWriter.h"
 #import "FBControlCoreLogger+OSLog.h"
@@ -75,6 +77,11 @@
   return self;
 }
 
+- (BOOL)isEnabledForLevel:(FBControlCoreLogLevel)level
+{
+  return YES;
+}
+
 @end
 
 @implementation FBCompositeLogger
@@ -138,6 +145,16 @@
   return [self loggerByApplyingSelector:_cmd object:@(dateFormat)];
 }
 
+- (BOOL)isEnabledForLevel:(FBControlCoreLogLevel)level
+{
+  for (id<FBControlCoreLogger> logger in self.loggers) {
+    if ([logger isEnabledForLevel:(level == FBControlCoreLogLevelMultiple ? logger.level : level)]) {
+      return YES;
+    }
+  }
+  return NO;
+}
+
 - (NSString *)name
 {
   return nil;
@@ -264,6 +281,239 @@
   return [[self.class alloc] initWithConsumer:self.consumer name:self.name dateFormatter:dateFormatter];
 }
 
+- (BOOL)isEnabledForLevel:(FBControlCoreLogLevel)level
+{
+  return YES;
+}
+
+@end
+
+// Messages beyond this rate, for a single logger, are dropped rather than queued without bound.
+static const uint64_t AsyncLoggerMaximumMessagesPerSecond = 200;
+
+typedef struct FBControlCoreLogger_AsyncEntry {
+  struct FBControlCoreLogger_AsyncEntry *next;
+  uint64_t timestamp;
+  CFStringRef message;
+} FBControlCoreLogger_AsyncEntry;
+
+/**
+ The queue of messages behind an async logger.
+ Messages are pushed onto a lock-free list by the caller. Whoever pushes onto an empty list schedules a drain, so messages logged in a burst are formatted and written in a single batch.
+ */
+@interface FBControlCoreLogger_AsyncSink : NSObject
+
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, nullable, readonly) id<FBDataConsumer> consumer;
+@property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, copy, nullable, readonly) NSString *name;
+@property (nonatomic, assign, readonly) BOOL timestamps;
+@property (nonatomic, assign, readonly) uint64_t startTime;
+
+@end
+
+@implementation FBControlCoreLogger_AsyncSink
+{
+  _Atomic(FBControlCoreLogger_AsyncEntry *) _head;
+}
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue consumer:(nullable id<FBDataConsumer>)consumer logger:(nullable id<FBControlCoreLogger>)logger name:(nullable NSString *)name timestamps:(BOOL)timestamps startTime:(uint64_t)startTime
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _queue = queue;
+  _consumer = consumer;
+  _logger = logger;
+  _name = name;
+  _timestamps = timestamps;
+  _startTime = startTime;
+  atomic_init(&_head, NULL);
+
+  return self;
+}
+
+- (void)dealloc
+{
+  FBControlCoreLogger_AsyncEntry *entry = atomic_exchange(&_head, NULL);
+  while (entry) {
+    FBControlCoreLogger_AsyncEntry *next = entry->next;
+    CFRelease(entry->message);
+    free(entry);
+    entry = next;
+  }
+}
+
+- (void)enqueueMessage:(NSString *)message
+{
+  FBControlCoreLogger_AsyncEntry *entry = malloc(sizeof(FBControlCoreLogger_AsyncEntry));
+  entry->timestamp = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  entry->message = CFBridgingRetain([message copy]);
+  FBControlCoreLogger_AsyncEntry *head = atomic_load(&_head);
+  do {
+    entry->next = head;
+  } while (!atomic_compare_exchange_weak(&_head, &head, entry));
+  if (head == NULL) {
+    dispatch_async(self.queue, ^{
+      [self drain];
+    });
+  }
+}
+
+- (void)drain
+{
+  // The list is pushed in reverse, so reverse it back into the order of logging.
+  FBControlCoreLogger_AsyncEntry *entry = atomic_exchange(&_head, NULL);
+  FBControlCoreLogger_AsyncEntry *ordered = NULL;
+  while (entry) {
+    FBControlCoreLogger_AsyncEntry *next = entry->next;
+    entry->next = ordered;
+    ordered = entry;
+    entry = next;
+  }
+  NSMutableString *batch = self.consumer ? [NSMutableString string] : nil;
+  while (ordered) {
+    FBControlCoreLogger_AsyncEntry *next = ordered->next;
+    NSString *message = [FBControlCoreLoggerFactory loggableStringLine:CFBridgingRelease(ordered->message)];
+    if (message && batch) {
+      if (self.timestamps) {
+        [batch appendFormat:@"%.6f ", (double) (ordered->timestamp - self.startTime) / NSEC_PER_SEC];
+      }
+      if (self.name) {
+        [batch appendFormat:@"[%@] ", self.name];
+      }
+      [batch appendString:message];
+      [batch appendString:@"\n"];
+    } else if (message) {
+      [self.logger log:message];
+    }
+    free(ordered);
+    ordered = next;
+  }
+  if (batch.length > 0) {
+    [self.consumer consumeData:[batch dataUsingEncoding:NSUTF8StringEncoding]];
+  }
+}
+
+@end
+
+@interface FBControlCoreLogger_Async : NSObject <FBControlCoreLogger>
+
+@property (nonatomic, strong, readonly) FBControlCoreLogger_AsyncSink *sink;
+
+@end
+
+@implementation FBControlCoreLogger_Async
+{
+  _Atomic(uint64_t) _window;
+  _Atomic(uint64_t) _windowCount;
+  _Atomic(uint64_t) _dropped;
+}
+
+- (instancetype)initWithSink:(FBControlCoreLogger_AsyncSink *)sink
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _sink = sink;
+  atomic_init(&_window, 0);
+  atomic_init(&_windowCount, 0);
+  atomic_init(&_dropped, 0);
+
+  return self;
+}
+
+#pragma mark Protocol Implementation
+
+- (id<FBControlCoreLogger>)log:(NSString *)message
+{
+  if (!message) {
+    return self;
+  }
+  // The limit is applied over whole seconds of uptime, which is approximate when racing with other threads but never blocks them.
+  uint64_t second = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) / NSEC_PER_SEC;
+  uint64_t window = atomic_load(&_window);
+  if (window != second && atomic_compare_exchange_strong(&_window, &window, second)) {
+    atomic_store(&_windowCount, 0);
+    uint64_t dropped = atomic_exchange(&_dropped, 0);
+    if (dropped > 0) {
+      [self.sink enqueueMessage:[NSString stringWithFormat:@"%llu messages were dropped by rate limiting", dropped]];
+    }
+  }
+  if (atomic_fetch_add(&_windowCount, 1) >= AsyncLoggerMaximumMessagesPerSecond) {
+    atomic_fetch_add(&_dropped, 1);
+    return self;
+  }
+  [self.sink enqueueMessage:message];
+  return self;
+}
+
+- (id<FBControlCoreLogger>)logFormat:(NSString *)format, ... NS_FORMAT_FUNCTION(1,2)
+{
+  if (![self isEnabledForLevel:self.level]) {
+    return self;
+  }
+  va_list args;
+  va_start(args, format);
+  NSString *string = [[NSString alloc] initWithFormat:format arguments:args];
+  va_end(args);
+
+  return [self log:string];
+}
+
+- (id<FBControlCoreLogger>)info
+{
+  return [self loggerWithLogger:self.sink.logger.info name:self.sink.name timestamps:self.sink.timestamps];
+}
+
+- (id<FBControlCoreLogger>)debug
+{
+  return [self loggerWithLogger:self.sink.logger.debug name:self.sink.name timestamps:self.sink.timestamps];
+}
+
+- (id<FBControlCoreLogger>)error
+{
+  return [self loggerWithLogger:self.sink.logger.error name:self.sink.name timestamps:self.sink.timestamps];
+}
+
+- (id<FBControlCoreLogger>)withName:(NSString *)name
+{
+  return [self loggerWithLogger:[self.sink.logger withName:name] name:name timestamps:self.sink.timestamps];
+}
+
+- (id<FBControlCoreLogger>)withDateFormatEnabled:(BOOL)enabled __attribute__((no_sanitize("bool")))
+{
+  return [self loggerWithLogger:[self.sink.logger withDateFormatEnabled:enabled] name:self.sink.name timestamps:enabled];
+}
+
+- (BOOL)isEnabledForLevel:(FBControlCoreLogLevel)level
+{
+  return self.sink.logger ? [self.sink.logger isEnabledForLevel:level] : YES;
+}
+
+- (NSString *)name
+{
+  return self.sink.logger ? self.sink.logger.name : self.sink.name;
+}
+
+- (FBControlCoreLogLevel)level
+{
+  return self.sink.logger ? self.sink.logger.level : FBControlCoreLogLevelMultiple;
+}
+
+#pragma mark Private
+
+- (id<FBControlCoreLogger>)loggerWithLogger:(nullable id<FBControlCoreLogger>)logger name:(nullable NSString *)name timestamps:(BOOL)timestamps
+{
+  // Derived loggers share the serial queue, so that their messages are written in the order they are drained.
+  FBControlCoreLogger_AsyncSink *sink = [[FBControlCoreLogger_AsyncSink alloc] initWithQueue:self.sink.queue consumer:self.sink.consumer logger:logger name:name timestamps:timestamps startTime:self.sink.startTime];
+  return [[self.class alloc] initWithSink:sink];
+}
+
 @end
 
 @implementation FBControlCoreLoggerFactory
@@ -315,6 +565,21 @@
   return [[FBControlCoreLogger_Consumer alloc] initWithConsumer:consumer name:nil dateFormatter:nil];
 }
 
++ (id<FBControlCoreLogger>)asyncLoggerToConsumer:(id<FBDataConsumer>)consumer
+{
+  FBControlCoreLogger_AsyncSink *sink = [[FBControlCoreLogger_AsyncSink alloc] initWithQueue:self.asyncLoggerQueue consumer:consumer logger:nil name:nil timestamps:NO startTime:clock_gettime_nsec_np(CLOCK_UPTIME_RAW)];
+  return [[FBControlCoreLogger_Async alloc] initWithSink:sink];
+}
+
++ (id<FBControlCoreLogger>)asyncLoggerWithLogger:(id<FBControlCoreLogger>)logger
+{
+  if ([logger isKindOfClass:FBControlCoreLogger_Async.class]) {
+    return logger;
+  }
+  FBControlCoreLogger_AsyncSink *sink = [[FBControlCoreLogger_AsyncSink alloc] initWithQueue:self.asyncLoggerQueue consumer:nil logger:logger name:nil timestamps:NO startTime:clock_gettime_nsec_np(CLOCK_UPTIME_RAW)];
+  return [[FBControlCoreLogger_Async alloc] initWithSink:sink];
+}
+
 + (NSString *)loggableStringLine:(NSString *)string
 {
   if (!string) {
@@ -327,4 +592,16 @@
   return string;
 }
 
+#pragma mark Private
+
++ (dispatch_queue_t)asyncLoggerQueue
+{
+  static dispatch_once_t onceToken;
+  static dispatch_queue_t queue;
+  dispatch_once(&onceToken, ^{
+    queue = dispatch_queue_create("com.facebook.fbcontrolcore.async_logger", DISPATCH_QUEUE_SERIAL_WITH_AUTORELEASE_POOL);
+  });
+  return queue;
+}
+
 @end
@@ -8,17 +8,38 @@
 #import "FBCrashLogStore.h"
 
 #import "FBCrashLog.h"
+#import "FBCrashLogQuery.h"
 #import "FBControlCoreLogger.h"
 
 typedef NSString *FBCrashLogNotificationName NS_STRING_ENUM;
 
 FBCrashLogNotificationName const FBCrashLogAppeared = @"FBCrashLogAppeared";
 
+static NSString *const IndexKeyVersion = @"version";
+static NSString *const IndexKeyEntries = @"entries";
+static NSString *const IndexKeySeen = @"seen";
+static NSString *const IndexEntryKeySize = @"size";
+static NSString *const IndexEntryKeyModificationDate = @"modification_date";
+static NSString *const IndexEntryKeyInfo = @"info";
+static const NSUInteger IndexVersion = 1;
+// Writes of the index are coalesced, so that ingesting many crash logs at once doesn't write it for each of them.
+static const NSTimeInterval IndexWriteDelay = 1.0;
+
 @interface FBCrashLogStore ()
 
 @property (nonatomic, copy, readonly) NSArray<NSString *> *directories;
+@property (nonatomic, copy, nullable, readonly) NSString *indexPath;
 @property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
 @property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, FBCrashLogInfo *> *ingestedCrashLogs;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSNumber *> *seenCrashLogSizes;
+@property (nonatomic, strong, readonly) NSMutableSet<NSString *> *unfetchedCrashLogNames;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSMutableArray<FBCrashLogInfo *> *> *crashLogsByIdentifier;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSMutableArray<FBCrashLogInfo *> *> *crashLogsByProcessName;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSNumber *, NSMutableArray<FBCrashLogInfo *> *> *crashLogsByProcessIdentifier;
+@property (nonatomic, copy, nullable, readwrite) NSArray<FBCrashLogInfo *> *crashLogsByDate;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> *indexEntries;
+@property (nonatomic, assign, readwrite) BOOL hasLoadedIndex;
+@property (nonatomic, assign, readwrite) BOOL indexWriteScheduled;
 @property (nonatomic, strong, readonly) dispatch_queue_t queue;
 
 @end
@@ -29,10 +50,15 @@ FBCrashLogNotificationName const FBCrashLogAppeared = @"FBCrashLogAppeared";
 
 + (instancetype)storeForDirectories:(NSArray<NSString *> *)directories logger:(id<FBControlCoreLogger>)logger
 {
-  return [[self alloc] initWithDirectories:directories logger:logger];
+  return [self storeForDirectories:directories indexPath:nil logger:logger];
 }
 
-- (instancetype)initWithDirectories:(NSArray<NSString *> *)directories logger:(id<FBControlCoreLogger>)logger
++ (instancetype)storeForDirectories:(NSArray<NSString *> *)directories indexPath:(nullable NSString *)indexPath logger:(id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithDirectories:directories indexPath:indexPath logger:logger];
+}
+
+- (instancetype)initWithDirectories:(NSArray<NSString *> *)directories indexPath:(nullable NSString *)indexPath logger:(id<FBControlCoreLogger>)logger
 {
   self = [super init];
   if (!self) {
@@ -40,8 +66,15 @@ FBCrashLogNotificationName const FBCrashLogAppeared = @"FBCrashLogAppeared";
   }
 
   _directories = directories;
+  _indexPath = indexPath;
   _logger = logger;
   _ingestedCrashLogs = NSMutableDictionary.dictionary;
+  _seenCrashLogSizes = NSMutableDictionary.dictionary;
+  _unfetchedCrashLogNames = NSMutableSet.set;
+  _crashLogsByIdentifier = NSMutableDictionary.dictionary;
+  _crashLogsByProcessName = NSMutableDictionary.dictionary;
+  _crashLogsByProcessIdentifier = NSMutableDictionary.dictionary;
+  _indexEntries = NSMutableDictionary.dictionary;
   _queue = dispatch_queue_create("com.facebook.fbcontrolcore.crash_store", DISPATCH_QUEUE_SERIAL);
 
   return self;
@@ -51,12 +84,15 @@ FBCrashLogNotificationName const FBCrashLogAppeared = @"FBCrashLogAppeared";
 
 - (NSArray<FBCrashLogInfo *> *)ingestAllExistingInDirectory
 {
+  [self loadIndexIfNeeded];
   NSMutableArray<FBCrashLogInfo *> *ingested = NSMutableArray.array;
 
   for (NSString *directory in self.directories) {
     NSArray<FBCrashLogInfo *> *crashLogs = [self ingestCrashLogInDirectory:directory];
     [ingested addObjectsFromArray:crashLogs];
   }
+  [self pruneIndexEntriesForMissingFiles];
+  [self writeIndex];
   return [ingested copy];
 }
 
@@ -98,6 +134,49 @@ FBCrashLogNotificationName const FBCrashLogAppeared = @"FBCrashLogAppeared";
   return nil;
 }
 
+- (nullable FBCrashLogInfo *)ingestCrashLogHeaderData:(NSData *)data name:(NSString *)name contentsFetcher:(FBCrashLogContentsFetcher)contentsFetcher
+{
+  if ([self hasIngestedCrashLogWithName:name]) {
+    return nil;
+  }
+  for (NSString *directory in self.directories) {
+    if (![NSFileManager.defaultManager fileExistsAtPath:directory]) {
+      if (![NSFileManager.defaultManager createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil]) {
+        continue;
+      }
+    }
+    NSError *error = nil;
+    FBCrashLogInfo *crashLog = [FBCrashLogInfo fromCrashLogHeaderData:data crashPath:[directory stringByAppendingPathComponent:name] contentsFetcher:contentsFetcher error:&error];
+    if (!crashLog) {
+      [self.logger logFormat:@"Could not obtain crash info from header of %@ %@", name, error];
+      return nil;
+    }
+    @synchronized (self.indexEntries) {
+      [self.unfetchedCrashLogNames addObject:name];
+    }
+    return [self ingestCrashLog:crashLog];
+  }
+
+  return nil;
+}
+
+- (void)recordSeenCrashLogWithName:(NSString *)name size:(uint64_t)size
+{
+  @synchronized (self.indexEntries) {
+    self.seenCrashLogSizes[name] = @(size);
+  }
+  [self scheduleIndexWrite];
+}
+
+- (BOOL)hasSeenCrashLogWithName:(NSString *)name size:(uint64_t)size
+{
+  [self loadIndexIfNeeded];
+  @synchronized (self.indexEntries) {
+    NSNumber *seenSize = self.seenCrashLogSizes[name];
+    return seenSize != nil && seenSize.unsignedLongLongValue == size;
+  }
+}
+
 - (nullable FBCrashLogInfo *)removeCrashLogAtPath:(NSString *)path
 {
   NSString *key = path.lastPathComponent;
@@ -105,7 +184,7 @@ FBCrashLogNotificationName const FBCrashLogAppeared = @"FBCrashLogAppeared";
   if (!crashLog) {
     return nil;
   }
-  [self.ingestedCrashLogs removeObjectForKey:key];
+  [self forgetCrashLogs:@[crashLog]];
   return crashLog;
 }
 
@@ -131,21 +210,34 @@ FBCrashLogNotificationName const FBCrashLogAppeared = @"FBCrashLogAppeared";
 
 - (NSArray<FBCrashLogInfo *> *)ingestedCrashLogsMatchingPredicate:(NSPredicate *)predicate
 {
-  return [self.ingestedCrashLogs.allValues filteredArrayUsingPredicate:predicate];
+  // The index narrows down the candidates, the predicate is still evaluated against each of them.
+  NSArray<FBCrashLogInfo *> *candidates = [self candidatesForPredicate:predicate] ?: self.ingestedCrashLogs.allValues;
+  return [candidates filteredArrayUsingPredicate:predicate];
 }
 
 - (NSArray<FBCrashLogInfo *> *)pruneCrashLogsMatchingPredicate:(NSPredicate *)predicate
 {
-  NSMutableArray<NSString *> *keys = NSMutableArray.array;
-  NSMutableArray<FBCrashLogInfo *> *crashLogs = NSMutableArray.array;
-  for (FBCrashLogInfo *crashLog in self.ingestedCrashLogs.allValues) {
-    if (![predicate evaluateWithObject:crashLog]) {
-      continue;
+  NSArray<FBCrashLogInfo *> *crashLogs = [self ingestedCrashLogsMatchingPredicate:predicate];
+  [self forgetCrashLogs:crashLogs];
+  return crashLogs;
+}
+
+- (NSArray<FBCrashLogInfo *> *)ingestedCrashLogsMatchingQuery:(FBCrashLogQuery *)query
+{
+  NSArray<FBCrashLogInfo *> *candidates = [self candidatesForQuery:query] ?: self.ingestedCrashLogs.allValues;
+  NSMutableArray<FBCrashLogInfo *> *matching = NSMutableArray.array;
+  for (FBCrashLogInfo *crashLog in candidates) {
+    if ([query matchesCrashLog:crashLog]) {
+      [matching addObject:crashLog];
     }
-    [keys addObject:crashLog.name];
-    [crashLogs addObject:crashLog];
   }
-  [self.ingestedCrashLogs removeObjectsForKeys:keys];
+  return [matching copy];
+}
+
+- (NSArray<FBCrashLogInfo *> *)pruneCrashLogsMatchingQuery:(FBCrashLogQuery *)query
+{
+  NSArray<FBCrashLogInfo *> *crashLogs = [self ingestedCrashLogsMatchingQuery:query];
+  [self forgetCrashLogs:crashLogs];
   return crashLogs;
 }
 
@@ -160,10 +252,328 @@ FBCrashLogNotificationName const FBCrashLogAppeared = @"FBCrashLogAppeared";
 {
   [self.logger logFormat:@"Ingesting Crash Log %@", crashLog];
   self.ingestedCrashLogs[crashLog.name] = crashLog;
+  [self addToLookups:crashLog];
+  [self addIndexEntryForCrashLog:crashLog];
   [NSNotificationCenter.defaultCenter postNotificationName:FBCrashLogAppeared object:crashLog];
   return crashLog;
 }
 
+- (void)forgetCrashLogs:(NSArray<FBCrashLogInfo *> *)crashLogs
+{
+  if (crashLogs.count == 0) {
+    return;
+  }
+  for (FBCrashLogInfo *crashLog in crashLogs) {
+    [self.ingestedCrashLogs removeObjectForKey:crashLog.name];
+    [self removeFromLookups:crashLog];
+    @synchronized (self.indexEntries) {
+      [self.indexEntries removeObjectForKey:crashLog.crashPath];
+      [self.seenCrashLogSizes removeObjectForKey:crashLog.name];
+      [self.unfetchedCrashLogNames removeObject:crashLog.name];
+    }
+  }
+  [self scheduleIndexWrite];
+}
+
+#pragma mark Lookups
+
+- (void)addToLookups:(FBCrashLogInfo *)crashLog
+{
+  [FBCrashLogStore add:crashLog forKey:crashLog.identifier toLookup:self.crashLogsByIdentifier];
+  [FBCrashLogStore add:crashLog forKey:crashLog.processName toLookup:self.crashLogsByProcessName];
+  [FBCrashLogStore add:crashLog forKey:@(crashLog.processIdentifier) toLookup:self.crashLogsByProcessIdentifier];
+  self.crashLogsByDate = nil;
+}
+
+- (void)removeFromLookups:(FBCrashLogInfo *)crashLog
+{
+  [self.crashLogsByIdentifier[crashLog.identifier] removeObjectIdenticalTo:crashLog];
+  [self.crashLogsByProcessName[crashLog.processName] removeObjectIdenticalTo:crashLog];
+  [self.crashLogsByProcessIdentifier[@(crashLog.processIdentifier)] removeObjectIdenticalTo:crashLog];
+  self.crashLogsByDate = nil;
+}
+
++ (void)add:(FBCrashLogInfo *)crashLog forKey:(id<NSCopying>)key toLookup:(NSMutableDictionary *)lookup
+{
+  if (!key) {
+    return;
+  }
+  NSMutableArray<FBCrashLogInfo *> *crashLogs = lookup[key];
+  if (!crashLogs) {
+    crashLogs = NSMutableArray.array;
+    lookup[key] = crashLogs;
+  }
+  [crashLogs addObject:crashLog];
+}
+
+- (nullable NSArray<FBCrashLogInfo *> *)candidatesForPredicate:(NSPredicate *)predicate
+{
+  // A conjunction only matches what each of its parts does, so the smallest set of candidates of any part will do.
+  if ([predicate isKindOfClass:NSCompoundPredicate.class]) {
+    NSCompoundPredicate *compound = (NSCompoundPredicate *) predicate;
+    if (compound.compoundPredicateType != NSAndPredicateType) {
+      return nil;
+    }
+    NSArray<FBCrashLogInfo *> *smallest = nil;
+    for (NSPredicate *subpredicate in compound.subpredicates) {
+      NSArray<FBCrashLogInfo *> *candidates = [self candidatesForPredicate:subpredicate];
+      if (candidates && (!smallest || candidates.count < smallest.count)) {
+        smallest = candidates;
+      }
+    }
+    return smallest;
+  }
+  if (![predicate isKindOfClass:NSComparisonPredicate.class]) {
+    return nil;
+  }
+  NSComparisonPredicate *comparison = (NSComparisonPredicate *) predicate;
+  if (comparison.leftExpression.expressionType != NSKeyPathExpressionType || comparison.rightExpression.expressionType != NSConstantValueExpressionType || comparison.options != 0) {
+    return nil;
+  }
+  NSString *keyPath = comparison.leftExpression.keyPath;
+  id value = comparison.rightExpression.constantValue;
+  if (comparison.predicateOperatorType == NSEqualToPredicateOperatorType) {
+    if ([keyPath isEqualToString:@"name"]) {
+      FBCrashLogInfo *crashLog = value ? self.ingestedCrashLogs[value] : nil;
+      return crashLog ? @[crashLog] : @[];
+    }
+    if ([keyPath isEqualToString:@"identifier"]) {
+      return [(value ? self.crashLogsByIdentifier[value] : nil) copy] ?: @[];
+    }
+    if ([keyPath isEqualToString:@"processName"]) {
+      return [(value ? self.crashLogsByProcessName[value] : nil) copy] ?: @[];
+    }
+    if ([keyPath isEqualToString:@"processIdentifier"] && [value isKindOfClass:NSNumber.class]) {
+      return [self.crashLogsByProcessIdentifier[value] copy] ?: @[];
+    }
+    return nil;
+  }
+  if ([keyPath isEqualToString:@"date"] && [value isKindOfClass:NSDate.class]) {
+    return [self candidatesWithDate:value operator:comparison.predicateOperatorType];
+  }
+  return nil;
+}
+
+- (nullable NSArray<FBCrashLogInfo *> *)candidatesForQuery:(FBCrashLogQuery *)query
+{
+  // As with a conjunction of predicates, the smallest set of candidates of any of the constraints will do.
+  NSMutableArray<NSArray<FBCrashLogInfo *> *> *candidateSets = NSMutableArray.array;
+  if (query.name) {
+    FBCrashLogInfo *crashLog = self.ingestedCrashLogs[query.name];
+    [candidateSets addObject:crashLog ? @[crashLog] : @[]];
+  }
+  if (query.identifier) {
+    [candidateSets addObject:self.crashLogsByIdentifier[query.identifier] ?: @[]];
+  }
+  if (query.processIdentifier) {
+    [candidateSets addObject:self.crashLogsByProcessIdentifier[query.processIdentifier] ?: @[]];
+  }
+  if (query.processNames) {
+    NSMutableArray<FBCrashLogInfo *> *crashLogs = NSMutableArray.array;
+    for (NSString *processName in query.processNames) {
+      [crashLogs addObjectsFromArray:self.crashLogsByProcessName[processName] ?: @[]];
+    }
+    [candidateSets addObject:crashLogs];
+  }
+  if (query.newerThan) {
+    [candidateSets addObject:[self candidatesWithDate:query.newerThan operator:NSGreaterThanPredicateOperatorType]];
+  }
+  if (query.olderThan) {
+    [candidateSets addObject:[self candidatesWithDate:query.olderThan operator:NSLessThanOrEqualToPredicateOperatorType]];
+  }
+  NSArray<FBCrashLogInfo *> *smallest = nil;
+  for (NSArray<FBCrashLogInfo *> *candidates in candidateSets) {
+    if (!smallest || candidates.count < smallest.count) {
+      smallest = candidates;
+    }
+  }
+  // The lookups are mutated as crash logs are ingested, so the candidates are a snapshot of them.
+  return [smallest copy];
+}
+
+- (nullable NSArray<FBCrashLogInfo *> *)candidatesWithDate:(NSDate *)date operator:(NSPredicateOperatorType)operatorType
+{
+  NSArray<FBCrashLogInfo *> *crashLogsByDate = self.crashLogsByDate;
+  if (!crashLogsByDate) {
+    crashLogsByDate = [self.ingestedCrashLogs.allValues sortedArrayUsingDescriptors:@[[NSSortDescriptor sortDescriptorWithKey:@"date" ascending:YES]]];
+    self.crashLogsByDate = crashLogsByDate;
+  }
+  NSBinarySearchingOptions options = 0;
+  BOOL ascending = NO;
+  switch (operatorType) {
+    case NSGreaterThanPredicateOperatorType:
+      options = NSBinarySearchingLastEqual;
+      ascending = YES;
+      break;
+    case NSGreaterThanOrEqualToPredicateOperatorType:
+      options = NSBinarySearchingFirstEqual;
+      ascending = YES;
+      break;
+    case NSLessThanPredicateOperatorType:
+      options = NSBinarySearchingFirstEqual;
+      break;
+    case NSLessThanOrEqualToPredicateOperatorType:
+      options = NSBinarySearchingLastEqual;
+      break;
+    default:
+      return nil;
+  }
+  NSUInteger index = [crashLogsByDate
+    indexOfObject:date
+    inSortedRange:NSMakeRange(0, crashLogsByDate.count)
+    options:options | NSBinarySearchingInsertionIndex
+    usingComparator:^ NSComparisonResult (id left, id right) {
+      NSDate *leftDate = [left isKindOfClass:NSDate.class] ? left : [left date];
+      NSDate *rightDate = [right isKindOfClass:NSDate.class] ? right : [right date];
+      return [leftDate compare:rightDate];
+    }];
+  if (ascending) {
+    return [crashLogsByDate subarrayWithRange:NSMakeRange(index, crashLogsByDate.count - index)];
+  }
+  return [crashLogsByDate subarrayWithRange:NSMakeRange(0, index)];
+}
+
+#pragma mark Index
+
+- (void)loadIndexIfNeeded
+{
+  if (self.hasLoadedIndex) {
+    return;
+  }
+  self.hasLoadedIndex = YES;
+  NSString *indexPath = self.indexPath;
+  if (!indexPath) {
+    return;
+  }
+  NSData *data = [NSData dataWithContentsOfFile:indexPath options:NSDataReadingMappedIfSafe error:nil];
+  if (!data) {
+    return;
+  }
+  NSError *error = nil;
+  NSDictionary<NSString *, id> *index = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:nil error:&error];
+  if (![index isKindOfClass:NSDictionary.class] || ![index[IndexKeyVersion] isEqual:@(IndexVersion)]) {
+    [self.logger logFormat:@"Ignoring crash log index at %@ %@", indexPath, error];
+    return;
+  }
+  NSDictionary<NSString *, NSDictionary<NSString *, id> *> *entries = index[IndexKeyEntries];
+  NSDictionary<NSString *, NSNumber *> *seen = index[IndexKeySeen];
+  @synchronized (self.indexEntries) {
+    if ([entries isKindOfClass:NSDictionary.class]) {
+      [self.indexEntries addEntriesFromDictionary:entries];
+    }
+    if ([seen isKindOfClass:NSDictionary.class]) {
+      [self.seenCrashLogSizes addEntriesFromDictionary:seen];
+    }
+  }
+  [self.logger logFormat:@"Loaded %lu crash logs from index at %@", (unsigned long) self.indexEntries.count, indexPath];
+}
+
+- (nullable FBCrashLogInfo *)indexedCrashLogAtPath:(NSString *)path
+{
+  NSDictionary<NSString *, id> *entry = nil;
+  @synchronized (self.indexEntries) {
+    entry = self.indexEntries[path];
+  }
+  if (!entry) {
+    return nil;
+  }
+  // The entry is only used if the file hasn't changed since it was indexed.
+  NSDictionary<NSFileAttributeKey, id> *attributes = [NSFileManager.defaultManager attributesOfItemAtPath:path error:nil];
+  if (![entry[IndexEntryKeySize] isEqual:@(attributes.fileSize)] || ![entry[IndexEntryKeyModificationDate] isEqual:attributes.fileModificationDate]) {
+    return nil;
+  }
+  NSDictionary<NSString *, id> *info = entry[IndexEntryKeyInfo];
+  if (![info isKindOfClass:NSDictionary.class]) {
+    return nil;
+  }
+  return [FBCrashLogInfo fromPropertyListRepresentation:info crashPath:path];
+}
+
+- (void)addIndexEntryForCrashLog:(FBCrashLogInfo *)crashLog
+{
+  if (!self.indexPath) {
+    return;
+  }
+  // Crash logs that are yet to be fetched have nothing on disk to index.
+  NSDictionary<NSFileAttributeKey, id> *attributes = [NSFileManager.defaultManager attributesOfItemAtPath:crashLog.crashPath error:nil];
+  if (!attributes.fileModificationDate) {
+    return;
+  }
+  NSDictionary<NSString *, id> *entry = @{
+    IndexEntryKeySize: @(attributes.fileSize),
+    IndexEntryKeyModificationDate: attributes.fileModificationDate,
+    IndexEntryKeyInfo: crashLog.propertyListRepresentation,
+  };
+  @synchronized (self.indexEntries) {
+    self.indexEntries[crashLog.crashPath] = entry;
+    [self.unfetchedCrashLogNames removeObject:crashLog.name];
+  }
+  [self scheduleIndexWrite];
+}
+
+- (void)pruneIndexEntriesForMissingFiles
+{
+  @synchronized (self.indexEntries) {
+    NSMutableArray<NSString *> *missing = NSMutableArray.array;
+    for (NSString *path in self.indexEntries) {
+      if (!self.ingestedCrashLogs[path.lastPathComponent]) {
+        [missing addObject:path];
+      }
+    }
+    [self.indexEntries removeObjectsForKeys:missing];
+  }
+}
+
+- (void)scheduleIndexWrite
+{
+  if (!self.indexPath) {
+    return;
+  }
+  @synchronized (self.indexEntries) {
+    if (self.indexWriteScheduled) {
+      return;
+    }
+    self.indexWriteScheduled = YES;
+  }
+  dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t) (IndexWriteDelay * NSEC_PER_SEC)), self.queue, ^{
+    [self writeIndex];
+  });
+}
+
+- (void)writeIndex
+{
+  NSString *indexPath = self.indexPath;
+  if (!indexPath) {
+    return;
+  }
+  NSData *data = nil;
+  NSError *error = nil;
+  @synchronized (self.indexEntries) {
+    self.indexWriteScheduled = NO;
+    // Crash logs whose header has been ingested but whose contents haven't been fetched are not remembered as seen.
+    // Otherwise the next store would skip them on the device, without having them on disk.
+    NSMutableDictionary<NSString *, NSNumber *> *seen = [self.seenCrashLogSizes mutableCopy];
+    [seen removeObjectsForKeys:self.unfetchedCrashLogNames.allObjects];
+    data = [NSPropertyListSerialization
+      dataWithPropertyList:@{
+        IndexKeyVersion: @(IndexVersion),
+        IndexKeyEntries: [self.indexEntries copy],
+        IndexKeySeen: seen,
+      }
+      format:NSPropertyListBinaryFormat_v1_0
+      options:0
+      error:&error];
+  }
+  if (!data) {
+    [self.logger logFormat:@"Failed to serialize crash log index %@", error];
+    return;
+  }
+  [NSFileManager.defaultManager createDirectoryAtPath:indexPath.stringByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:nil];
+  if (![data writeToFile:indexPath options:NSDataWritingAtomic error:&error]) {
+    [self.logger logFormat:@"Failed to write crash log index to %@ %@", indexPath, error];
+  }
+}
+
 + (FBFuture<FBCrashLogInfo *> *)oneshotCrashLogNotificationForPredicate:(NSPredicate *)predicate queue:(dispatch_queue_t)queue
 {
   __weak NSNotificationCenter *notificationCenter = [NSNotificationCenter defaultCenter];
@@ -196,8 +606,14 @@ FBCrashLogNotificationName const FBCrashLogAppeared = @"FBCrashLogAppeared";
   }
 
   NSMutableArray<FBCrashLogInfo *> *ingested = NSMutableArray.array;
-  for (NSString *path in contents) {
-    FBCrashLogInfo *crash = [self ingestCrashLogAtPath:[directory stringByAppendingPathComponent:path]];
+  for (NSString *name in contents) {
+    NSString *path = [directory stringByAppendingPathComponent:name];
+    if ([self hasIngestedCrashLogWithName:name]) {
+      continue;
+    }
+    // Crash logs that have been indexed before don't need to be parsed again.
+    FBCrashLogInfo *indexed = [self indexedCrashLogAtPath:path];
+    FBCrashLogInfo *crash = indexed ? [self ingestCrashLog:indexed] : [self ingestCrashLogAtPath:path];
     if (!crash) {
       continue;
     }
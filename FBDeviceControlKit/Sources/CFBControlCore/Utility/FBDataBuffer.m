@@ -9,12 +9,71 @@
 
 #import "FBControlCoreError.h"
 
-@interface FBDataBuffer_Accumilating : NSObject <FBDataConsumer, FBAccumulatingBuffer>
+static size_t const FBDataBufferNotFound = SIZE_MAX;
 
-@property (nonatomic, strong, readwrite) NSMutableData *buffer;
+static BOOL FBDataBufferMatchesAtOffset(dispatch_data_t data, size_t offset, NSData *terminal)
+{
+  // The terminal may span regions, so it's compared region by region.
+  dispatch_data_t candidate = dispatch_data_create_subrange(data, offset, terminal.length);
+  const uint8_t *terminalBytes = terminal.bytes;
+  __block BOOL matches = YES;
+  dispatch_data_apply(candidate, ^ bool (dispatch_data_t region, size_t regionOffset, const void *buffer, size_t size) {
+    matches = memcmp(buffer, terminalBytes + regionOffset, size) == 0;
+    return matches;
+  });
+  return matches;
+}
+
+// Scans for the terminal from an offset, so that bytes already known not to contain the terminal are not scanned again.
+// memchr is vectorized by libc, so single-byte terminals such as a newline are found without a per-byte loop.
+static size_t FBDataBufferOffsetOfTerminal(dispatch_data_t data, NSData *terminal, size_t fromOffset)
+{
+  size_t size = dispatch_data_get_size(data);
+  size_t terminalLength = terminal.length;
+  if (terminalLength == 0 || size < terminalLength || fromOffset > size - terminalLength) {
+    return FBDataBufferNotFound;
+  }
+  uint8_t firstByte = ((const uint8_t *) terminal.bytes)[0];
+  __block size_t found = FBDataBufferNotFound;
+  dispatch_data_apply(data, ^ bool (dispatch_data_t region, size_t regionOffset, const void *buffer, size_t regionSize) {
+    if (regionOffset + regionSize <= fromOffset) {
+      return true;
+    }
+    const uint8_t *bytes = buffer;
+    size_t start = fromOffset > regionOffset ? fromOffset - regionOffset : 0;
+    while (start < regionSize) {
+      const uint8_t *match = memchr(bytes + start, firstByte, regionSize - start);
+      if (!match) {
+        break;
+      }
+      size_t offset = regionOffset + (size_t) (match - bytes);
+      if (offset + terminalLength > size) {
+        return false;
+      }
+      if (terminalLength == 1 || FBDataBufferMatchesAtOffset(data, offset, terminal)) {
+        found = offset;
+        return false;
+      }
+      start = (size_t) (match - bytes) + 1;
+    }
+    return true;
+  });
+  return found;
+}
+
+@interface FBDataBuffer_Accumilating : NSObject <FBDataConsumer, FBAccumulatingBuffer, FBDataConsumerNonContiguous>
+
+// A caller-provided buffer is appended to directly, otherwise data is held as a chain of dispatch_data regions.
+// Removing bytes from the front of the chain is a sub-range of the regions, rather than a move of all the remaining bytes.
+@property (nonatomic, strong, nullable, readonly) NSMutableData *backingData;
+@property (nonatomic, strong, readwrite) dispatch_data_t contents;
 @property (nonatomic, assign, readonly) size_t capacity;
 @property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *finishedConsumingFuture;
 
+- (size_t)length;
+- (NSData *)takeLength:(size_t)length;
+- (void)removeLength:(size_t)length;
+
 @end
 
 @implementation FBDataBuffer_Accumilating
@@ -23,17 +82,18 @@
 
 - (instancetype)init
 {
-  return [self initWithBackingBuffer:NSMutableData.new capacity:0];
+  return [self initWithBackingBuffer:nil capacity:0];
 }
 
-- (instancetype)initWithBackingBuffer:(NSMutableData *)buffer capacity:(size_t)capacity
+- (instancetype)initWithBackingBuffer:(nullable NSMutableData *)buffer capacity:(size_t)capacity
 {
   self = [super init];
   if (!self) {
     return nil;
   }
 
-  _buffer = buffer;
+  _backingData = buffer;
+  _contents = dispatch_data_empty;
   _capacity = capacity;
   _finishedConsumingFuture = FBMutableFuture.future;
 
@@ -45,7 +105,7 @@
 - (NSString *)description
 {
   @synchronized (self) {
-    return [NSString stringWithFormat:@"Accumilating Buffer %lu Bytes", self.data.length];
+    return [NSString stringWithFormat:@"Accumilating Buffer %lu Bytes", self.length];
   }
 }
 
@@ -54,7 +114,13 @@
 - (NSData *)data
 {
   @synchronized (self) {
-    return [self.buffer copy];
+    if (self.backingData) {
+      return [self.backingData copy];
+    }
+    // The mapped data is contiguous, so it replaces the chain to avoid flattening again on the next call.
+    dispatch_data_t contiguous = dispatch_data_create_map(self.contents, NULL, NULL);
+    self.contents = contiguous;
+    return (NSData *) contiguous;
   }
 }
 
@@ -64,6 +130,25 @@
   return [output componentsSeparatedByCharactersInSet:NSCharacterSet.newlineCharacterSet];
 }
 
+- (void)enumerateLinesUsingBlock:(void (^)(const char *bytes, size_t length, BOOL *stop))block
+{
+  NSData *data = self.data;
+  const char *bytes = data.bytes;
+  size_t remaining = data.length;
+  BOOL stop = NO;
+  while (remaining > 0 && !stop) {
+    const char *newline = memchr(bytes, '\n', remaining);
+    size_t length = newline ? (size_t) (newline - bytes) : remaining;
+    block(bytes, length, &stop);
+    bytes += length;
+    remaining -= length;
+    if (newline) {
+      bytes += 1;
+      remaining -= 1;
+    }
+  }
+}
+
 #pragma mark FBDataConsumer
 
 - (void)consumeData:(NSData *)data
@@ -72,12 +157,16 @@
     if (self.finishedConsuming.hasCompleted) {
       return;
     }
-    [self.buffer appendData:data];
-    if (self.capacity > 0) {
-      NSInteger overrun = (NSInteger) self.buffer.length - (NSInteger) self.capacity;
-      if (overrun > 0) {
-        [self.buffer replaceBytesInRange:NSMakeRange(0, (NSUInteger) overrun) withBytes:NULL length:0];
-      }
+    if (self.backingData) {
+      // Each region is appended in turn, so non-contiguous data is not flattened into an intermediate copy.
+      [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+        [self.backingData appendBytes:bytes length:byteRange.length];
+      }];
+      return;
+    }
+    self.contents = dispatch_data_create_concat(self.contents, [FBDataConsumerAdaptor adaptNSData:data]);
+    if (self.capacity > 0 && self.length > self.capacity) {
+      [self removeLength:self.length - self.capacity];
     }
   }
 }
@@ -99,6 +188,181 @@
   return self.finishedConsumingFuture;
 }
 
+#pragma mark Private
+
+- (size_t)length
+{
+  return self.backingData ? self.backingData.length : dispatch_data_get_size(self.contents);
+}
+
+- (NSData *)takeLength:(size_t)length
+{
+  NSData *data = (NSData *) dispatch_data_create_map(dispatch_data_create_subrange(self.contents, 0, length), NULL, NULL);
+  [self removeLength:length];
+  return data;
+}
+
+- (void)removeLength:(size_t)length
+{
+  size_t size = dispatch_data_get_size(self.contents);
+  self.contents = dispatch_data_create_subrange(self.contents, length, size - length);
+}
+
+@end
+
+@interface FBDataBuffer_Bounded : FBDataBuffer_Accumilating <FBBoundedBuffer>
+
+@property (nonatomic, assign, readonly) size_t headCapacity;
+@property (nonatomic, assign, readonly) size_t tailCapacity;
+@property (nonatomic, assign, readonly) BOOL spillToTemporaryFile;
+@property (nonatomic, strong, readonly) NSMutableData *head;
+@property (nonatomic, strong, readwrite) dispatch_data_t tail;
+@property (nonatomic, assign, readwrite) uint64_t droppedBytes;
+@property (nonatomic, copy, nullable, readwrite) NSString *spillFilePath;
+@property (nonatomic, assign, readwrite) int spillFileDescriptor;
+
+@end
+
+@implementation FBDataBuffer_Bounded
+
+#pragma mark Initializers
+
+- (instancetype)initWithHeadCapacity:(size_t)headCapacity tailCapacity:(size_t)tailCapacity spillToTemporaryFile:(BOOL)spillToTemporaryFile
+{
+  self = [super initWithBackingBuffer:nil capacity:0];
+  if (!self) {
+    return nil;
+  }
+
+  _headCapacity = headCapacity;
+  _tailCapacity = tailCapacity;
+  _spillToTemporaryFile = spillToTemporaryFile;
+  _head = [NSMutableData dataWithCapacity:MIN(headCapacity, (size_t) 1024 * 64)];
+  _tail = dispatch_data_empty;
+  _spillFileDescriptor = -1;
+
+  return self;
+}
+
+- (void)dealloc
+{
+  if (_spillFileDescriptor >= 0) {
+    close(_spillFileDescriptor);
+  }
+}
+
+#pragma mark NSObject
+
+- (NSString *)description
+{
+  @synchronized (self) {
+    return [NSString stringWithFormat:@"Bounded Buffer %lu Bytes, %llu Dropped", (unsigned long) (self.head.length + dispatch_data_get_size(self.tail)), self.droppedBytes];
+  }
+}
+
+#pragma mark FBAccumulatingBuffer
+
+- (NSData *)data
+{
+  @synchronized (self) {
+    NSMutableData *data = [self.head mutableCopy];
+    dispatch_data_apply(self.tail, ^ bool (dispatch_data_t region, size_t offset, const void *buffer, size_t size) {
+      [data appendBytes:buffer length:size];
+      return true;
+    });
+    return data;
+  }
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  @synchronized (self) {
+    if (self.finishedConsuming.hasCompleted) {
+      return;
+    }
+    dispatch_data_t remaining = [FBDataConsumerAdaptor adaptNSData:data];
+    size_t size = dispatch_data_get_size(remaining);
+    size_t headLength = MIN(self.headCapacity - self.head.length, size);
+    if (headLength > 0) {
+      dispatch_data_apply(dispatch_data_create_subrange(remaining, 0, headLength), ^ bool (dispatch_data_t region, size_t offset, const void *buffer, size_t regionSize) {
+        [self.head appendBytes:buffer length:regionSize];
+        return true;
+      });
+      remaining = dispatch_data_create_subrange(remaining, headLength, size - headLength);
+    }
+    self.tail = dispatch_data_create_concat(self.tail, remaining);
+    size_t tailLength = dispatch_data_get_size(self.tail);
+    if (tailLength <= self.tailCapacity) {
+      return;
+    }
+    size_t droppedLength = tailLength - self.tailCapacity;
+    [self spill:dispatch_data_create_subrange(self.tail, 0, droppedLength)];
+    self.tail = dispatch_data_create_subrange(self.tail, droppedLength, self.tailCapacity);
+    self.droppedBytes += droppedLength;
+  }
+}
+
+- (void)consumeEndOfFile
+{
+  @synchronized (self) {
+    if (self.spillFileDescriptor >= 0) {
+      close(self.spillFileDescriptor);
+      self.spillFileDescriptor = -1;
+    }
+  }
+  [super consumeEndOfFile];
+}
+
+#pragma mark Private
+
+- (void)spill:(dispatch_data_t)dropped
+{
+  if (!self.spillToTemporaryFile) {
+    return;
+  }
+  // The file is created on the first drop, so that output that fits in memory never touches the disk.
+  if (self.droppedBytes == 0) {
+    NSString *template = [NSTemporaryDirectory() stringByAppendingPathComponent:@"FBDataBuffer_XXXXXX"];
+    char path[PATH_MAX];
+    strlcpy(path, template.fileSystemRepresentation, sizeof(path));
+    self.spillFileDescriptor = mkstemp(path);
+    if (self.spillFileDescriptor < 0) {
+      return;
+    }
+    self.spillFilePath = [NSFileManager.defaultManager stringWithFileSystemRepresentation:path length:strlen(path)];
+  }
+  if (self.spillFileDescriptor < 0) {
+    return;
+  }
+  __block BOOL success = YES;
+  dispatch_data_apply(dropped, ^ bool (dispatch_data_t region, size_t offset, const void *buffer, size_t size) {
+    const uint8_t *bytes = buffer;
+    while (size > 0) {
+      ssize_t written = write(self.spillFileDescriptor, bytes, size);
+      if (written < 0 && errno == EINTR) {
+        continue;
+      }
+      if (written <= 0) {
+        success = NO;
+        return false;
+      }
+      bytes += written;
+      size -= (size_t) written;
+    }
+    return true;
+  });
+  if (success) {
+    return;
+  }
+  // An incomplete file is of no use, so it is removed rather than handed out.
+  close(self.spillFileDescriptor);
+  self.spillFileDescriptor = -1;
+  unlink(self.spillFilePath.fileSystemRepresentation);
+  self.spillFilePath = nil;
+}
+
 @end
 
 @protocol FBDataBuffer_Forwarder <NSObject>
@@ -209,6 +473,8 @@
 @interface FBDataBuffer_Consumable : FBDataBuffer_Accumilating <FBConsumableBuffer, FBNotifyingBuffer>
 
 @property (nonatomic, strong, nullable, readwrite) id<FBDataBuffer_Forwarder> forwarder;
+@property (nonatomic, copy, nullable, readwrite) NSData *scannedTerminal;
+@property (nonatomic, assign, readwrite) size_t scannedLength;
 
 @end
 
@@ -233,7 +499,7 @@
 - (NSString *)description
 {
   @synchronized (self) {
-    return [NSString stringWithFormat:@"Consumable Buffer %lu Bytes", self.data.length];
+    return [NSString stringWithFormat:@"Consumable Buffer %lu Bytes", self.length];
   }
 }
 
@@ -242,9 +508,7 @@
 - (nullable NSData *)consumeCurrentData
 {
   @synchronized (self) {
-    NSData *data = self.data;
-    self.buffer.data = NSData.data;
-    return data;
+    return [self takeLength:self.length];
   }
 }
 
@@ -257,31 +521,35 @@
 - (nullable NSData *)consumeLength:(NSUInteger)length
 {
   @synchronized (self) {
-    if (length > self.buffer.length) {
-      return nil;
-    }
-    NSRange range = NSMakeRange(0, length);
-    NSData *data = [self.buffer subdataWithRange:range];
-    if (!data) {
+    if (length > self.length) {
       return nil;
     }
-    [self.buffer replaceBytesInRange:range withBytes:"" length:0];
-    return data;
+    return [self takeLength:length];
   }
 }
 
 - (nullable NSData *)consumeUntil:(NSData *)terminal
 {
   @synchronized (self) {
-    if (self.buffer.length == 0) {
+    if (self.length == 0) {
       return nil;
     }
-    NSRange terminalRange = [self.buffer rangeOfData:terminal options:0 range:NSMakeRange(0, self.buffer.length)];
-    if (terminalRange.location == NSNotFound) {
+    // The scanned length is only meaningful for the terminal it was scanned for.
+    if (![self.scannedTerminal isEqualToData:terminal]) {
+      self.scannedTerminal = terminal;
+      self.scannedLength = 0;
+    }
+    size_t offset = FBDataBufferOffsetOfTerminal(self.contents, terminal, self.scannedLength);
+    if (offset == FBDataBufferNotFound) {
+      // A terminal may start in the last bytes and complete in the next append, so those are scanned again.
+      size_t length = self.length;
+      self.scannedLength = length >= terminal.length ? length - terminal.length + 1 : 0;
       return nil;
     }
-    NSData *data = [self.buffer subdataWithRange:NSMakeRange(0, terminalRange.location)];
-    [self.buffer replaceBytesInRange:NSMakeRange(0, terminalRange.location + terminal.length) withBytes:"" length:0];
+    NSData *data = [self takeLength:offset];
+    [self removeLength:terminal.length];
+    // The scan stopped at the first terminal, none of the remaining bytes have been scanned.
+    self.scannedLength = 0;
     return data;
   }
 }
@@ -375,6 +643,13 @@
   return [self consume:consumer onQueue:nil untilTerminal:terminal error:error];
 }
 
+- (void)removeLength:(size_t)length
+{
+  // Bytes removed from the front of the buffer were ahead of the scanned position, so it moves back with them.
+  self.scannedLength = self.scannedLength > length ? self.scannedLength - length : 0;
+  [super removeLength:length];
+}
+
 @end
 
 @implementation FBDataBuffer
@@ -389,7 +664,7 @@
 + (id<FBAccumulatingBuffer>)accumulatingBufferWithCapacity:(size_t)capacity
 {
   NSParameterAssert(capacity > 0);
-  return [[FBDataBuffer_Accumilating alloc] initWithBackingBuffer:NSMutableData.data capacity:capacity];
+  return [[FBDataBuffer_Accumilating alloc] initWithBackingBuffer:nil capacity:capacity];
 }
 
 + (id<FBAccumulatingBuffer>)accumulatingBufferForMutableData:(NSMutableData *)data
@@ -397,6 +672,11 @@
   return [[FBDataBuffer_Accumilating alloc] initWithBackingBuffer:data capacity:0];
 }
 
++ (id<FBBoundedBuffer>)boundedBufferWithHeadCapacity:(size_t)headCapacity tailCapacity:(size_t)tailCapacity spillToTemporaryFile:(BOOL)spillToTemporaryFile
+{
+  return [[FBDataBuffer_Bounded alloc] initWithHeadCapacity:headCapacity tailCapacity:tailCapacity spillToTemporaryFile:spillToTemporaryFile];
+}
+
 + (id<FBConsumableBuffer>)consumableBuffer
 {
   return [self consumableBufferForwardingToConsumer:nil onQueue:nil terminal:nil];
@@ -13,12 +13,6 @@
 #import "FBDataBuffer.h"
 #import <stdatomic.h>
 
-@interface FBDataConsumerAdaptor ()
-
-+ (dispatch_data_t)adaptNSData:(NSData *)dispatchData;
-
-@end
-
 @interface FBDataConsumerAdaptor_ToNSData : NSObject <FBDispatchDataConsumer>
 
 @property (nonatomic, strong, readonly) id<FBDataConsumer> consumer;
@@ -45,6 +39,11 @@
 
 - (void)consumeData:(dispatch_data_t)dispatchData
 {
+  // Consumers that handle non-contiguous data receive the dispatch_data as-is.
+  if ([self.consumer conformsToProtocol:@protocol(FBDataConsumerNonContiguous)]) {
+    [self.consumer consumeData:(NSData *) dispatchData];
+    return;
+  }
   NSData *data = [FBDataConsumerAdaptor adaptDispatchData:dispatchData];
   [self.consumer consumeData:data];
 }
@@ -56,7 +55,7 @@
 
 @end
 
-@interface FBDataConsumerAdaptor_ToDispatchData : NSObject <FBDataConsumer, FBDataConsumerLifecycle>
+@interface FBDataConsumerAdaptor_ToDispatchData : NSObject <FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerNonContiguous>
 
 @property (nonatomic, strong, readonly) id<FBDispatchDataConsumer, FBDataConsumerLifecycle> consumer;
 
@@ -124,8 +123,6 @@
   return (NSData *) dispatch_data_create_map(dispatchData, NULL, NULL);
 }
 
-#pragma mark Private
-
 + (dispatch_data_t)adaptNSData:(NSData *)data __attribute__((no_sanitize("nullability-arg")))
 {
   // The safest possible way of adapting the NSData to dispatch_data_t is to ensure that buffer backing the dispatch_data_t data is:
@@ -137,6 +134,10 @@
   // This uses #2 as it's preferable to let libdispatch do the management itself and avoids an object copy (NSData) as well as a potential buffer copy in `-[NSData copy]`.
   // It can be quite surprising how many methods result in the creation of NSMutableData, for example `-[NSString dataUsingEncoding:]` can result in NSConcreteMutableData.
   // By copying the buffer we are sure that the data in the dispatch wrapper is completely immutable.
+  // The exception is data that is already a dispatch_data_t bridged to NSData, this is immutable so can be passed through without a copy.
+  if ([data conformsToProtocol:@protocol(OS_dispatch_data)]) {
+    return (dispatch_data_t) data;
+  }
   return dispatch_data_create(
     data.bytes,
     data.length,
@@ -164,6 +165,9 @@ static inline dataBlock FBDataConsumerToStringConsumer (void(^consumer)(NSString
 @property (nonatomic, strong, nullable, readwrite) dispatch_group_t group;
 @property (nonatomic, copy, nullable, readwrite) void (^consumer)(NSData *);
 @property _Atomic int64_t numPendingTasks;
+@property _Atomic int64_t generation;
+
+- (NSInteger)discardUnprocessedData;
 
 @end
 
@@ -179,7 +183,8 @@ static inline dataBlock FBDataConsumerToStringConsumer (void(^consumer)(NSString
   _queue = queue;
   _group = dispatch_group_create();
   _consumer = consumer;
-atomic_init(&_numPendingTasks, 0);
+  atomic_init(&_numPendingTasks, 0);
+  atomic_init(&_generation, 0);
 
   return self;
 }
@@ -199,8 +204,12 @@ atomic_init(&_numPendingTasks, 0);
       return;
     }
     if (queue) {
+      // Data enqueued before a discard belongs to an older generation and is skipped.
+      int64_t generation = atomic_load(&_generation);
       dispatch_group_async(group, queue, ^{
-        consumer(data);
+        if (generation == atomic_load(&self->_generation)) {
+          consumer(data);
+        }
         atomic_fetch_sub(&self->_numPendingTasks, 1);
       });
     } else {
@@ -210,6 +219,12 @@ atomic_init(&_numPendingTasks, 0);
   }
 }
 
+- (NSInteger)discardUnprocessedData
+{
+  atomic_fetch_add(&_generation, 1);
+  return (NSInteger) atomic_load(&_numPendingTasks);
+}
+
 - (void)consumeEndOfFile
 {
   dispatch_group_t group;
@@ -239,7 +254,7 @@ atomic_init(&_numPendingTasks, 0);
 
 @end
 
-@interface FBBlockDataConsumer_Buffered : FBBlockDataConsumer
+@interface FBBlockDataConsumer_Buffered : FBBlockDataConsumer <FBDataConsumerNonContiguous>
 
 @property (nonatomic, strong, readonly) id<FBConsumableBuffer> buffer;
 
@@ -259,6 +274,22 @@ atomic_init(&_numPendingTasks, 0);
 
 @end
 
+@interface FBBlockDataConsumer_Ring : NSObject <FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerAsync>
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue capacity:(NSUInteger)capacity consumer:(void (^)(NSData *))consumer;
+
+@end
+
+@interface FBBlockDataConsumer_LineSpan : NSObject <FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerSync, FBDataConsumerNonContiguous>
+
+@property (nonatomic, copy, readonly) FBDataConsumerLineSpanBlock consumer;
+@property (nonatomic, strong, readonly) NSMutableData *partialLine;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *finishedConsumingFuture;
+
+- (instancetype)initWithConsumer:(FBDataConsumerLineSpanBlock)consumer;
+
+@end
+
 @implementation FBBlockDataConsumer
 
 #pragma mark Initializers
@@ -275,6 +306,11 @@ atomic_init(&_numPendingTasks, 0);
   return [[FBBlockDataConsumer_Buffered alloc] initWithDispatcher:dispatcher terminal:FBDataBuffer.newlineTerminal];
 }
 
++ (id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerSync>)synchronousLineSpanConsumerWithBlock:(FBDataConsumerLineSpanBlock)consumer
+{
+  return [[FBBlockDataConsumer_LineSpan alloc] initWithConsumer:consumer];
+}
+
 + (id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerAsync>)asynchronousDataConsumerOnQueue:(dispatch_queue_t)queue consumer:(void (^)(NSData *))consumer
 {
   FBBlockDataConsumer_Dispatcher *dispatcher = [[FBBlockDataConsumer_Dispatcher alloc] initWithQueue:queue consumer:consumer];
@@ -287,6 +323,11 @@ atomic_init(&_numPendingTasks, 0);
   return [self asynchronousDataConsumerOnQueue:queue consumer:consumer];
 }
 
++ (id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerAsync>)ringBufferDataConsumerOnQueue:(dispatch_queue_t)queue capacity:(NSUInteger)capacity consumer:(void (^)(NSData *))consumer
+{
+  return [[FBBlockDataConsumer_Ring alloc] initWithQueue:queue capacity:capacity consumer:consumer];
+}
+
 + (id<FBDataConsumer, FBDataConsumerLifecycle>)asynchronousLineConsumerWithBlock:(void (^)(NSString *))consumer
 {
   dispatch_queue_t queue = dispatch_queue_create("com.facebook.FBControlCore.BlockDataConsumer.lines", DISPATCH_QUEUE_SERIAL);
@@ -519,6 +560,334 @@ atomic_init(&_numPendingTasks, 0);
   return self.dispatcher.numPendingTasks;
 }
 
+- (NSInteger)discardUnprocessedData
+{
+  return [self.dispatcher discardUnprocessedData];
+}
+
+@end
+
+@implementation FBBlockDataConsumer_Ring
+{
+  // Slots hold retained NSData. The producer owns the head, the consumer owns the tail.
+  void **_slots;
+  uint64_t _mask;
+  _Atomic uint64_t _head;
+  _Atomic uint64_t _tail;
+  // Chunks before this index have been discarded by the producer and are released without being delivered.
+  _Atomic uint64_t _discardBefore;
+  _Atomic bool _drainScheduled;
+  _Atomic bool _endOfFile;
+  _Atomic bool _finished;
+  dispatch_source_t _source;
+  void (^_consumer)(NSData *);
+  FBMutableFuture<NSNull *> *_finishedConsuming;
+}
+
+#pragma mark Initializers
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue capacity:(NSUInteger)capacity consumer:(void (^)(NSData *))consumer
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  uint64_t size = 1;
+  while (size < MAX(capacity, (NSUInteger) 1)) {
+    size <<= 1;
+  }
+  _slots = calloc(size, sizeof(void *));
+  _mask = size - 1;
+  atomic_init(&_head, 0);
+  atomic_init(&_tail, 0);
+  atomic_init(&_discardBefore, 0);
+  atomic_init(&_drainScheduled, false);
+  atomic_init(&_endOfFile, false);
+  atomic_init(&_finished, false);
+  _consumer = consumer;
+  _finishedConsuming = FBMutableFuture.future;
+
+  // A DATA_OR source coalesces wakeups, so signalling it does not allocate.
+  _source = dispatch_source_create(DISPATCH_SOURCE_TYPE_DATA_OR, 0, 0, queue);
+  __weak typeof(self) weakSelf = self;
+  dispatch_source_set_event_handler(_source, ^{
+    [weakSelf drain];
+  });
+  dispatch_resume(_source);
+
+  return self;
+}
+
+- (void)dealloc
+{
+  dispatch_source_cancel(_source);
+  for (uint64_t index = atomic_load(&_tail); index != atomic_load(&_head); index++) {
+    CFRelease(_slots[index & _mask]);
+  }
+  free(_slots);
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  if (atomic_load_explicit(&_endOfFile, memory_order_relaxed)) {
+    return;
+  }
+  uint64_t head = atomic_load_explicit(&_head, memory_order_relaxed);
+  uint64_t tail = atomic_load_explicit(&_tail, memory_order_acquire);
+  if (head - tail > _mask) {
+    return;
+  }
+  _slots[head & _mask] = (void *) CFBridgingRetain(data);
+  atomic_store_explicit(&_head, head + 1, memory_order_release);
+  [self scheduleDrain];
+}
+
+- (void)consumeEndOfFile
+{
+  atomic_store(&_endOfFile, true);
+  [self scheduleDrain];
+}
+
+#pragma mark FBDataConsumerLifecycle
+
+- (FBFuture<NSNull *> *)finishedConsuming
+{
+  return _finishedConsuming;
+}
+
+#pragma mark FBDataConsumerAsync
+
+- (NSInteger)unprocessedDataCount
+{
+  return (NSInteger) (atomic_load(&_head) - atomic_load(&_tail));
+}
+
+- (NSInteger)discardUnprocessedData
+{
+  uint64_t head = atomic_load(&_head);
+  atomic_store(&_discardBefore, head);
+  return (NSInteger) (head - atomic_load(&_tail));
+}
+
+#pragma mark Private
+
+- (void)scheduleDrain
+{
+  // Only the write that finds the consumer idle needs to wake it.
+  if (!atomic_exchange(&_drainScheduled, true)) {
+    dispatch_source_merge_data(_source, 1);
+  }
+}
+
+- (void)drain
+{
+  uint64_t tail = atomic_load_explicit(&_tail, memory_order_relaxed);
+  while (true) {
+    uint64_t head = atomic_load_explicit(&_head, memory_order_acquire);
+    while (tail != head) {
+      NSData *data = CFBridgingRelease(_slots[tail & _mask]);
+      _slots[tail & _mask] = NULL;
+      BOOL discarded = tail < atomic_load(&_discardBefore);
+      tail++;
+      atomic_store_explicit(&_tail, tail, memory_order_release);
+      if (!discarded) {
+        _consumer(data);
+      }
+    }
+    atomic_store(&_drainScheduled, false);
+    // A write may have landed after the ring was seen to be empty, but before the flag was cleared.
+    if (atomic_load_explicit(&_head, memory_order_acquire) == tail) {
+      break;
+    }
+    if (atomic_exchange(&_drainScheduled, true)) {
+      break;
+    }
+  }
+  if (atomic_load(&_endOfFile) && atomic_load(&_head) == tail && !atomic_exchange(&_finished, true)) {
+    dispatch_source_cancel(_source);
+    [_finishedConsuming resolveWithResult:NSNull.null];
+  }
+}
+
+@end
+
+@implementation FBBlockDataConsumer_LineSpan
+
+#pragma mark Initializers
+
+- (instancetype)initWithConsumer:(FBDataConsumerLineSpanBlock)consumer
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _consumer = consumer;
+  _partialLine = NSMutableData.data;
+  _finishedConsumingFuture = FBMutableFuture.future;
+
+  return self;
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  @synchronized (self) {
+    if (self.finishedConsumingFuture.hasCompleted) {
+      return;
+    }
+    FBDataConsumerLineSpanBlock consumer = self.consumer;
+    NSMutableData *partialLine = self.partialLine;
+    [data enumerateByteRangesUsingBlock:^(const void *rangeBytes, NSRange byteRange, BOOL *stop) {
+      const char *bytes = rangeBytes;
+      size_t remaining = byteRange.length;
+      while (remaining > 0) {
+        const char *newline = memchr(bytes, '\n', remaining);
+        if (!newline) {
+          [partialLine appendBytes:bytes length:remaining];
+          return;
+        }
+        size_t length = (size_t) (newline - bytes);
+        if (partialLine.length == 0) {
+          consumer(bytes, length);
+        } else {
+          // The start of the line arrived in an earlier chunk. Truncating keeps the allocation of the buffer for the next line that spans chunks.
+          [partialLine appendBytes:bytes length:length];
+          consumer(partialLine.bytes, partialLine.length);
+          partialLine.length = 0;
+        }
+        bytes = newline + 1;
+        remaining -= length + 1;
+      }
+    }];
+  }
+}
+
+- (void)consumeEndOfFile
+{
+  @synchronized (self) {
+    [self.finishedConsumingFuture resolveWithResult:NSNull.null];
+  }
+}
+
+#pragma mark FBDataConsumerLifecycle
+
+- (FBFuture<NSNull *> *)finishedConsuming
+{
+  return self.finishedConsumingFuture;
+}
+
+@end
+
+typedef struct {
+  const char *bytes;
+  size_t length;
+} FBStringInterner_Key;
+
+static const void *FBStringInterner_KeyRetain(CFAllocatorRef allocator, const void *value)
+{
+  // Lookups are made with a key on the stack that borrows the bytes, so the key and its bytes are copied when inserted.
+  const FBStringInterner_Key *key = value;
+  FBStringInterner_Key *copy = malloc(sizeof(FBStringInterner_Key) + key->length);
+  char *bytes = (char *) (copy + 1);
+  memcpy(bytes, key->bytes, key->length);
+  copy->bytes = bytes;
+  copy->length = key->length;
+  return copy;
+}
+
+static void FBStringInterner_KeyRelease(CFAllocatorRef allocator, const void *value)
+{
+  free((void *) value);
+}
+
+static Boolean FBStringInterner_KeyEqual(const void *left, const void *right)
+{
+  const FBStringInterner_Key *leftKey = left;
+  const FBStringInterner_Key *rightKey = right;
+  return leftKey->length == rightKey->length && memcmp(leftKey->bytes, rightKey->bytes, leftKey->length) == 0;
+}
+
+static CFHashCode FBStringInterner_KeyHash(const void *value)
+{
+  // FNV-1a
+  const FBStringInterner_Key *key = value;
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t index = 0; index < key->length; index++) {
+    hash ^= (uint8_t) key->bytes[index];
+    hash *= 1099511628211ULL;
+  }
+  return (CFHashCode) hash;
+}
+
+@interface FBStringInterner ()
+
+@property (nonatomic, assign, readonly) NSUInteger capacity;
+@property (nonatomic, assign, readonly) CFMutableDictionaryRef strings;
+
+@end
+
+@implementation FBStringInterner
+
+#pragma mark Initializers
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  CFDictionaryKeyCallBacks keyCallBacks = {
+    .version = 0,
+    .retain = FBStringInterner_KeyRetain,
+    .release = FBStringInterner_KeyRelease,
+    .copyDescription = NULL,
+    .equal = FBStringInterner_KeyEqual,
+    .hash = FBStringInterner_KeyHash,
+  };
+  _capacity = capacity;
+  _strings = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, &keyCallBacks, &kCFTypeDictionaryValueCallBacks);
+
+  return self;
+}
+
+- (void)dealloc
+{
+  CFRelease(_strings);
+}
+
+#pragma mark Public
+
+- (nullable NSString *)stringWithBytes:(const char *)bytes length:(size_t)length
+{
+  FBStringInterner_Key key = {
+    .bytes = bytes,
+    .length = length,
+  };
+  const void *interned = CFDictionaryGetValue(self.strings, &key);
+  if (interned) {
+    return (__bridge NSString *) interned;
+  }
+  NSString *string = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+  if (!string) {
+    return nil;
+  }
+  if ((NSUInteger) CFDictionaryGetCount(self.strings) < self.capacity) {
+    CFDictionarySetValue(self.strings, &key, (__bridge const void *) string);
+  }
+  return string;
+}
+
+- (NSUInteger)count
+{
+  return (NSUInteger) CFDictionaryGetCount(self.strings);
+}
+
 @end
 
 @implementation FBLoggingDataConsumer
@@ -604,8 +973,18 @@ atomic_init(&_numPendingTasks, 0);
 
 - (void)consumeData:(NSData *)data
 {
+  // Non-contiguous data is only made contiguous if a member needs it, and then only once for all members.
+  NSData *contiguous = nil;
+  BOOL isDispatchData = [data conformsToProtocol:@protocol(OS_dispatch_data)];
   for (id<FBDataConsumer> consumer in self.consumers) {
-    [consumer consumeData:data];
+    if (!isDispatchData || [consumer conformsToProtocol:@protocol(FBDataConsumerNonContiguous)]) {
+      [consumer consumeData:data];
+      continue;
+    }
+    if (!contiguous) {
+      contiguous = [FBDataConsumerAdaptor adaptDispatchData:(dispatch_data_t) data];
+    }
+    [consumer consumeData:contiguous];
   }
 }
 
@@ -626,6 +1005,294 @@ atomic_init(&_numPendingTasks, 0);
 
 @end
 
+@interface FBQueuedDataConsumerStatistics ()
+
+- (instancetype)initWithBytesDelivered:(uint64_t)bytesDelivered deliveries:(uint64_t)deliveries bytesDropped:(uint64_t)bytesDropped chunksDropped:(uint64_t)chunksDropped bytesPending:(uint64_t)bytesPending;
+
+@end
+
+@implementation FBQueuedDataConsumerStatistics
+
+- (instancetype)initWithBytesDelivered:(uint64_t)bytesDelivered deliveries:(uint64_t)deliveries bytesDropped:(uint64_t)bytesDropped chunksDropped:(uint64_t)chunksDropped bytesPending:(uint64_t)bytesPending
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _bytesDelivered = bytesDelivered;
+  _deliveries = deliveries;
+  _bytesDropped = bytesDropped;
+  _chunksDropped = chunksDropped;
+  _bytesPending = bytesPending;
+
+  return self;
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"Delivered %llu bytes in %llu | Dropped %llu bytes in %llu | Pending %llu bytes", self.bytesDelivered, self.deliveries, self.bytesDropped, self.chunksDropped, self.bytesPending];
+}
+
+@end
+
+@interface FBQueuedCompositeDataConsumer_Child : NSObject
+
+@property (nonatomic, strong, readonly) id<FBDataConsumer> consumer;
+@property (nonatomic, assign, readonly) FBQueuedDataConsumerPolicy policy;
+@property (nonatomic, assign, readonly) size_t maxPendingBytes;
+@property (nonatomic, assign, readonly) size_t coalescingBytes;
+@property (nonatomic, assign, readonly) NSTimeInterval coalescingInterval;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) NSCondition *condition;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *finishedConsumingFuture;
+
+// Guarded by the condition.
+@property (nonatomic, strong, readwrite) dispatch_data_t coalesced;
+@property (nonatomic, assign, readwrite) size_t pendingBytes;
+@property (nonatomic, assign, readwrite) BOOL drainScheduled;
+@property (nonatomic, assign, readwrite) BOOL timerScheduled;
+@property (nonatomic, assign, readwrite) BOOL finished;
+@property (nonatomic, assign, readwrite) uint64_t bytesDelivered;
+@property (nonatomic, assign, readwrite) uint64_t deliveries;
+@property (nonatomic, assign, readwrite) uint64_t bytesDropped;
+@property (nonatomic, assign, readwrite) uint64_t chunksDropped;
+
+- (instancetype)initWithConsumer:(id<FBDataConsumer>)consumer policy:(FBQueuedDataConsumerPolicy)policy maxPendingBytes:(size_t)maxPendingBytes coalescingBytes:(size_t)coalescingBytes coalescingInterval:(NSTimeInterval)coalescingInterval;
+- (void)consumeData:(dispatch_data_t)data;
+- (void)consumeEndOfFile;
+- (FBQueuedDataConsumerStatistics *)statistics;
+
+@end
+
+@implementation FBQueuedCompositeDataConsumer_Child
+
+- (instancetype)initWithConsumer:(id<FBDataConsumer>)consumer policy:(FBQueuedDataConsumerPolicy)policy maxPendingBytes:(size_t)maxPendingBytes coalescingBytes:(size_t)coalescingBytes coalescingInterval:(NSTimeInterval)coalescingInterval
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _consumer = consumer;
+  _policy = policy;
+  _maxPendingBytes = maxPendingBytes;
+  _coalescingBytes = coalescingBytes;
+  _coalescingInterval = coalescingInterval;
+  _queue = dispatch_queue_create("com.facebook.FBControlCore.QueuedCompositeDataConsumer", DISPATCH_QUEUE_SERIAL);
+  _condition = [[NSCondition alloc] init];
+  _finishedConsumingFuture = FBMutableFuture.future;
+  _coalesced = dispatch_data_empty;
+
+  return self;
+}
+
+- (void)consumeData:(dispatch_data_t)data
+{
+  size_t size = dispatch_data_get_size(data);
+  [self.condition lock];
+  // A chunk is always admitted to an empty queue, so a chunk larger than the limit cannot block forever.
+  while (self.policy == FBQueuedDataConsumerPolicyBlock && !self.finished && self.pendingBytes > 0 && self.pendingBytes + size > self.maxPendingBytes) {
+    [self.condition wait];
+  }
+  if (self.finished) {
+    [self.condition unlock];
+    return;
+  }
+  if (self.pendingBytes > 0 && self.pendingBytes + size > self.maxPendingBytes) {
+    self.bytesDropped += size;
+    self.chunksDropped += 1;
+    [self.condition unlock];
+    return;
+  }
+  self.coalesced = dispatch_data_create_concat(self.coalesced, data);
+  self.pendingBytes += size;
+  if (dispatch_data_get_size(self.coalesced) >= self.coalescingBytes) {
+    [self scheduleDrain];
+  } else if (!self.timerScheduled) {
+    self.timerScheduled = YES;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t) (self.coalescingInterval * NSEC_PER_SEC)), self.queue, ^{
+      [self.condition lock];
+      self.timerScheduled = NO;
+      [self.condition unlock];
+      [self drain];
+    });
+  }
+  [self.condition unlock];
+}
+
+- (void)consumeEndOfFile
+{
+  [self.condition lock];
+  if (self.finished) {
+    [self.condition unlock];
+    return;
+  }
+  self.finished = YES;
+  [self.condition broadcast];
+  [self.condition unlock];
+  dispatch_async(self.queue, ^{
+    [self drain];
+    [self.consumer consumeEndOfFile];
+    [self.finishedConsumingFuture resolveWithResult:NSNull.null];
+  });
+}
+
+- (FBQueuedDataConsumerStatistics *)statistics
+{
+  [self.condition lock];
+  FBQueuedDataConsumerStatistics *statistics = [[FBQueuedDataConsumerStatistics alloc] initWithBytesDelivered:self.bytesDelivered deliveries:self.deliveries bytesDropped:self.bytesDropped chunksDropped:self.chunksDropped bytesPending:self.pendingBytes];
+  [self.condition unlock];
+  return statistics;
+}
+
+#pragma mark Private
+
+// Must be called with the condition locked.
+- (void)scheduleDrain
+{
+  if (self.drainScheduled) {
+    return;
+  }
+  self.drainScheduled = YES;
+  dispatch_async(self.queue, ^{
+    [self drain];
+  });
+}
+
+// Must be called on the queue. The pending data is taken when the drain runs, rather than when it is scheduled, so that deliveries stay in order and chunks that arrive in the meantime are coalesced into the same delivery.
+- (void)drain
+{
+  [self.condition lock];
+  self.drainScheduled = NO;
+  dispatch_data_t data = self.coalesced;
+  self.coalesced = dispatch_data_empty;
+  [self.condition unlock];
+
+  size_t size = dispatch_data_get_size(data);
+  if (size == 0) {
+    return;
+  }
+  if ([self.consumer conformsToProtocol:@protocol(FBDataConsumerNonContiguous)]) {
+    [self.consumer consumeData:(NSData *) data];
+  } else {
+    [self.consumer consumeData:[FBDataConsumerAdaptor adaptDispatchData:data]];
+  }
+
+  [self.condition lock];
+  self.pendingBytes -= size;
+  self.bytesDelivered += size;
+  self.deliveries += 1;
+  [self.condition broadcast];
+  [self.condition unlock];
+}
+
+@end
+
+@interface FBQueuedCompositeDataConsumer ()
+
+@property (nonatomic, assign, readonly) size_t coalescingBytes;
+@property (nonatomic, assign, readonly) NSTimeInterval coalescingInterval;
+@property (nonatomic, copy, readwrite) NSArray<FBQueuedCompositeDataConsumer_Child *> *children;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *finishedConsumingFuture;
+
+@end
+
+@implementation FBQueuedCompositeDataConsumer
+
+#pragma mark Initializers
+
+- (instancetype)initWithCoalescingBytes:(size_t)coalescingBytes coalescingInterval:(NSTimeInterval)coalescingInterval
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _coalescingBytes = coalescingBytes;
+  _coalescingInterval = coalescingInterval;
+  _children = @[];
+  _finishedConsumingFuture = FBMutableFuture.future;
+
+  return self;
+}
+
+#pragma mark NSObject
+
+- (NSString *)description
+{
+  NSMutableArray<id<FBDataConsumer>> *consumers = NSMutableArray.array;
+  for (FBQueuedCompositeDataConsumer_Child *child in self.children) {
+    [consumers addObject:child.consumer];
+  }
+  return [NSString stringWithFormat:@"Queued Composite Consumer %@", [FBCollectionInformation oneLineDescriptionFromArray:consumers]];
+}
+
+#pragma mark Public
+
+- (void)addConsumer:(id<FBDataConsumer>)consumer policy:(FBQueuedDataConsumerPolicy)policy maxPendingBytes:(size_t)maxPendingBytes
+{
+  FBQueuedCompositeDataConsumer_Child *child = [[FBQueuedCompositeDataConsumer_Child alloc] initWithConsumer:consumer policy:policy maxPendingBytes:maxPendingBytes coalescingBytes:self.coalescingBytes coalescingInterval:self.coalescingInterval];
+  @synchronized (self) {
+    self.children = [self.children arrayByAddingObject:child];
+  }
+}
+
+- (void)removeConsumer:(id<FBDataConsumer>)consumer
+{
+  NSMutableArray<FBQueuedCompositeDataConsumer_Child *> *removed = NSMutableArray.array;
+  @synchronized (self) {
+    NSMutableArray<FBQueuedCompositeDataConsumer_Child *> *children = NSMutableArray.array;
+    for (FBQueuedCompositeDataConsumer_Child *child in self.children) {
+      [(child.consumer == consumer ? removed : children) addObject:child];
+    }
+    self.children = children;
+  }
+  for (FBQueuedCompositeDataConsumer_Child *child in removed) {
+    [child consumeEndOfFile];
+  }
+}
+
+- (nullable FBQueuedDataConsumerStatistics *)statisticsForConsumer:(id<FBDataConsumer>)consumer
+{
+  for (FBQueuedCompositeDataConsumer_Child *child in self.children) {
+    if (child.consumer == consumer) {
+      return child.statistics;
+    }
+  }
+  return nil;
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  // Adapting once means that each child shares the same immutable buffer.
+  dispatch_data_t dispatchData = [FBDataConsumerAdaptor adaptNSData:data];
+  for (FBQueuedCompositeDataConsumer_Child *child in self.children) {
+    [child consumeData:dispatchData];
+  }
+}
+
+- (void)consumeEndOfFile
+{
+  NSMutableArray<FBFuture<NSNull *> *> *futures = NSMutableArray.array;
+  for (FBQueuedCompositeDataConsumer_Child *child in self.children) {
+    [child consumeEndOfFile];
+    [futures addObject:child.finishedConsumingFuture];
+  }
+  [self.finishedConsumingFuture resolveFromFuture:[[FBFuture futureWithFutures:futures] mapReplace:NSNull.null]];
+}
+
+#pragma mark FBDataConsumerLifecycle
+
+- (FBFuture<NSNull *> *)finishedConsuming
+{
+  return self.finishedConsumingFuture;
+}
+
+@end
+
 @implementation FBNullDataConsumer
 
 #pragma mark FBDataConsumer
@@ -7,9 +7,13 @@
 
 #import "FBDeveloperDiskImage.h"
 
+#import <CoreServices/CoreServices.h>
+#import <os/lock.h>
+
 #import "FBControlCore.h"
 
 static NSString *const ExtraDeviceSupportDirEnv = @"IDB_EXTRA_DEVICE_SUPPORT_DIR";
+static CFTimeInterval const IndexWatchLatency = 1.0;
 
 static NSInteger ScoreVersions(NSOperatingSystemVersion current, NSOperatingSystemVersion target)
 {
@@ -18,11 +22,210 @@ static NSInteger ScoreVersions(NSOperatingSystemVersion current, NSOperatingSyst
   return major + minor;
 }
 
+static NSString *VersionKey(NSOperatingSystemVersion version)
+{
+  return [NSString stringWithFormat:@"%ld.%ld", (long) version.majorVersion, (long) version.minorVersion];
+}
+
+@interface FBDeveloperDiskImage ()
+
++ (NSArray<FBDeveloperDiskImage *> *)allDiskImagesFromSearchPath:(NSString *)searchPath xcodeVersion:(NSOperatingSystemVersion)xcodeVersion logger:(nullable id<FBControlCoreLogger>)logger;
+
+@end
+
+/**
+ The disk images and symbol directories found in the DeviceSupport directories, scanned once and shared by the whole process.
+ An index is replaced when anything beneath the directories it scanned changes, or when a different Xcode is selected.
+ */
+@interface FBDeveloperDiskImageIndex : NSObject
+
+@property (nonatomic, copy, readonly) NSString *developerDirectory;
+@property (nonatomic, copy, readonly) NSArray<FBDeveloperDiskImage *> *images;
+@property (nonatomic, copy, readonly) NSArray<NSString *> *symbolsPaths;
+@property (nonatomic, copy, readonly) NSArray<NSString *> *watchedDirectories;
+
+@end
+
+@implementation FBDeveloperDiskImageIndex
+{
+  os_unfair_lock _lock;
+  NSMutableDictionary<NSString *, FBDeveloperDiskImage *> *_bestImageByVersion;
+}
+
+- (instancetype)initWithDeveloperDirectory:(NSString *)developerDirectory logger:(nullable id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  NSString *xcodeDeviceSupportPath = [developerDirectory stringByAppendingPathComponent:@"Platforms/iPhoneOS.platform/DeviceSupport"];
+  NSString *userDeviceSupportPath = [NSHomeDirectory() stringByAppendingPathComponent:@"Library/Developer/Xcode/iOS DeviceSupport"];
+  NSString *extraDeviceSupportPath = NSProcessInfo.processInfo.environment[ExtraDeviceSupportDirEnv];
+
+  NSOperatingSystemVersion xcodeVersion = FBXcodeConfiguration.xcodeVersion;
+  NSArray<FBDeveloperDiskImage *> *images = [FBDeveloperDiskImage allDiskImagesFromSearchPath:xcodeDeviceSupportPath xcodeVersion:xcodeVersion logger:logger];
+  if (extraDeviceSupportPath) {
+    images = [images arrayByAddingObjectsFromArray:[FBDeveloperDiskImage allDiskImagesFromSearchPath:extraDeviceSupportPath xcodeVersion:xcodeVersion logger:logger]];
+  }
+
+  _lock = OS_UNFAIR_LOCK_INIT;
+  _developerDirectory = [developerDirectory copy];
+  _images = [images copy];
+  _symbolsPaths = [FBDeveloperDiskImageIndex symbolsPathsInSearchPaths:@[userDeviceSupportPath, xcodeDeviceSupportPath]];
+  _bestImageByVersion = NSMutableDictionary.dictionary;
+  NSMutableArray<NSString *> *watchedDirectories = [NSMutableArray arrayWithObjects:xcodeDeviceSupportPath, userDeviceSupportPath, nil];
+  if (extraDeviceSupportPath) {
+    [watchedDirectories addObject:extraDeviceSupportPath];
+  }
+  _watchedDirectories = [watchedDirectories copy];
+
+  return self;
+}
+
++ (NSArray<NSString *> *)symbolsPathsInSearchPaths:(NSArray<NSString *> *)searchPaths
+{
+  NSMutableArray<NSString *> *paths = NSMutableArray.array;
+  for (NSString *searchPath in searchPaths) {
+    NSError *innerError = nil;
+    NSArray<NSString *> *supportPaths = [NSFileManager.defaultManager contentsOfDirectoryAtPath:searchPath error:&innerError];
+    if (!supportPaths) {
+      continue;
+    }
+    for (NSString *supportName in supportPaths) {
+      NSString *supportPath = [searchPath stringByAppendingPathComponent:supportName];
+      BOOL isDirectory = NO;
+      if (![NSFileManager.defaultManager fileExistsAtPath:supportPath isDirectory:&isDirectory]) {
+        continue;
+      }
+      if (isDirectory == NO) {
+        continue;
+      }
+      NSString *symbolsPath = [supportPath stringByAppendingPathComponent:@"Symbols"];
+      if (![NSFileManager.defaultManager fileExistsAtPath:symbolsPath isDirectory:&isDirectory]) {
+        continue;
+      }
+      if (isDirectory == NO) {
+        continue;
+      }
+      [paths addObject:symbolsPath];
+    }
+  }
+  return [paths copy];
+}
+
+- (nullable FBDeveloperDiskImage *)bestImageForTargetVersion:(NSOperatingSystemVersion)targetVersion logger:(nullable id<FBControlCoreLogger>)logger error:(NSError **)error
+{
+  NSString *key = VersionKey(targetVersion);
+  os_unfair_lock_lock(&_lock);
+  FBDeveloperDiskImage *image = _bestImageByVersion[key];
+  os_unfair_lock_unlock(&_lock);
+  if (image) {
+    return image;
+  }
+
+  image = [FBDeveloperDiskImage bestImageForImages:self.images targetVersion:targetVersion logger:logger error:error];
+  if (!image) {
+    return nil;
+  }
+  os_unfair_lock_lock(&_lock);
+  _bestImageByVersion[key] = image;
+  os_unfair_lock_unlock(&_lock);
+  return image;
+}
+
+@end
+
+static os_unfair_lock IndexLock = OS_UNFAIR_LOCK_INIT;
+static FBDeveloperDiskImageIndex *CurrentIndex = nil;
+static FSEventStreamRef CurrentIndexStream = NULL;
+
+static void IndexStreamCallback(ConstFSEventStreamRef stream, void *info, size_t count, void *eventPaths, const FSEventStreamEventFlags eventFlags[], const FSEventStreamEventId eventIds[])
+{
+  // Any change beneath a DeviceSupport directory can add, remove or complete a disk image or symbols directory.
+  FBDeveloperDiskImageIndex *index = (__bridge FBDeveloperDiskImageIndex *) info;
+  FSEventStreamRef invalidatedStream = NULL;
+  os_unfair_lock_lock(&IndexLock);
+  if (CurrentIndex == index) {
+    CurrentIndex = nil;
+    invalidatedStream = CurrentIndexStream;
+    CurrentIndexStream = NULL;
+  }
+  os_unfair_lock_unlock(&IndexLock);
+  if (invalidatedStream) {
+    FSEventStreamStop(invalidatedStream);
+    FSEventStreamInvalidate(invalidatedStream);
+    FSEventStreamRelease(invalidatedStream);
+  }
+}
+
+static FSEventStreamRef IndexStreamStart(FBDeveloperDiskImageIndex *index)
+{
+  static dispatch_once_t onceToken;
+  static dispatch_queue_t queue;
+  dispatch_once(&onceToken, ^{
+    queue = dispatch_queue_create("com.facebook.fbcontrolcore.developer_disk_images", DISPATCH_QUEUE_SERIAL);
+  });
+
+  FSEventStreamContext context = {
+    .version = 0,
+    .info = (__bridge void *) index,
+    .retain = CFRetain,
+    .release = CFRelease,
+    .copyDescription = NULL,
+  };
+  FSEventStreamRef stream = FSEventStreamCreate(
+    kCFAllocatorDefault,
+    IndexStreamCallback,
+    &context,
+    (__bridge CFArrayRef) index.watchedDirectories,
+    kFSEventStreamEventIdSinceNow,
+    IndexWatchLatency,
+    kFSEventStreamCreateFlagWatchRoot
+  );
+  if (!stream) {
+    return NULL;
+  }
+  FSEventStreamSetDispatchQueue(stream, queue);
+  if (!FSEventStreamStart(stream)) {
+    FSEventStreamInvalidate(stream);
+    FSEventStreamRelease(stream);
+    return NULL;
+  }
+  return stream;
+}
+
 @implementation FBDeveloperDiskImage
 
 #pragma mark Private
 
-+ (NSArray<FBDeveloperDiskImage *> *)allDiskImagesFromSearchPath:(NSString *)searchPath xcodeVersion:(NSOperatingSystemVersion)xcodeVersion logger:(id<FBControlCoreLogger>)logger
++ (FBDeveloperDiskImageIndex *)index
+{
+  NSString *developerDirectory = FBXcodeConfiguration.developerDirectory;
+  FSEventStreamRef invalidatedStream = NULL;
+  os_unfair_lock_lock(&IndexLock);
+  FBDeveloperDiskImageIndex *index = CurrentIndex;
+  if (index && ![index.developerDirectory isEqualToString:developerDirectory]) {
+    index = nil;
+    invalidatedStream = CurrentIndexStream;
+    CurrentIndexStream = NULL;
+  }
+  if (!index) {
+    // Scanned under the lock so that devices connecting at the same time share one scan.
+    index = [[FBDeveloperDiskImageIndex alloc] initWithDeveloperDirectory:developerDirectory logger:FBControlCoreGlobalConfiguration.defaultLogger];
+    CurrentIndex = index;
+    CurrentIndexStream = IndexStreamStart(index);
+  }
+  os_unfair_lock_unlock(&IndexLock);
+  if (invalidatedStream) {
+    FSEventStreamStop(invalidatedStream);
+    FSEventStreamInvalidate(invalidatedStream);
+    FSEventStreamRelease(invalidatedStream);
+  }
+  return index;
+}
+
++ (NSArray<FBDeveloperDiskImage *> *)allDiskImagesFromSearchPath:(NSString *)searchPath xcodeVersion:(NSOperatingSystemVersion)xcodeVersion logger:(nullable id<FBControlCoreLogger>)logger
 {
   NSMutableArray<FBDeveloperDiskImage *> *images = NSMutableArray.array;
   [logger logFormat:@"Attempting to find Disk Images at path %@", searchPath];
@@ -62,22 +265,12 @@ static NSInteger ScoreVersions(NSOperatingSystemVersion current, NSOperatingSyst
 
 + (FBDeveloperDiskImage *)developerDiskImage:(NSOperatingSystemVersion)targetVersion logger:(id<FBControlCoreLogger>)logger error:(NSError **)error
 {
-  NSArray<FBDeveloperDiskImage *> *images = FBDeveloperDiskImage.allDiskImages;
-  return [self bestImageForImages:images targetVersion:targetVersion logger:logger error:error];
+  return [self.index bestImageForTargetVersion:targetVersion logger:logger error:error];
 }
 
 + (NSArray<FBDeveloperDiskImage *> *)allDiskImages
 {
-  static dispatch_once_t onceToken;
-  static NSArray<FBDeveloperDiskImage *> *images = nil;
-  dispatch_once(&onceToken, ^{
-    images = [self allDiskImagesFromSearchPath:[FBXcodeConfiguration.developerDirectory stringByAppendingPathComponent:@"Platforms/iPhoneOS.platform/DeviceSupport"] xcodeVersion:FBXcodeConfiguration.xcodeVersion logger:FBControlCoreGlobalConfiguration.defaultLogger];
-    if ([[NSProcessInfo.processInfo.environment allKeys] containsObject:ExtraDeviceSupportDirEnv]) {
-      NSArray<FBDeveloperDiskImage *> *extraImages = [self allDiskImagesFromSearchPath:NSProcessInfo.processInfo.environment[ExtraDeviceSupportDirEnv] xcodeVersion:FBXcodeConfiguration.xcodeVersion logger:FBControlCoreGlobalConfiguration.defaultLogger];
-      images = [images arrayByAddingObjectsFromArray:extraImages];
-    }
-  });
-  return images;
+  return self.index.images;
 }
 
 + (FBDeveloperDiskImage *) unknownDiskImageWithSignature:(NSData *)signature
@@ -109,37 +302,8 @@ static NSInteger ScoreVersions(NSOperatingSystemVersion current, NSOperatingSyst
 
 + (NSString *)pathForDeveloperSymbols:(NSString *)buildVersion logger:(id<FBControlCoreLogger>)logger error:(NSError **)error
 {
-  NSArray<NSString *> *searchPaths = @[
-    [NSHomeDirectory() stringByAppendingPathComponent:@"Library/Developer/Xcode/iOS DeviceSupport"],
-    [FBXcodeConfiguration.developerDirectory stringByAppendingPathComponent:@"Platforms/iPhoneOS.platform/DeviceSupport"],
-  ];
   [logger logFormat:@"Attempting to find Symbols directory by build version %@", buildVersion];
-  NSMutableArray<NSString *> *paths = NSMutableArray.array;
-  for (NSString *searchPath in searchPaths) {
-    NSError *innerError = nil;
-    NSArray<NSString *> *supportPaths = [NSFileManager.defaultManager contentsOfDirectoryAtPath:searchPath error:&innerError];
-    if (!supportPaths) {
-      continue;
-    }
-    for (NSString *supportName in supportPaths) {
-      NSString *supportPath = [searchPath stringByAppendingPathComponent:supportName];
-      BOOL isDirectory = NO;
-      if (![NSFileManager.defaultManager fileExistsAtPath:supportPath isDirectory:&isDirectory]) {
-        continue;
-      }
-      if (isDirectory == NO) {
-        continue;
-      }
-      NSString *symbolsPath = [supportPath stringByAppendingPathComponent:@"Symbols"];
-      if (![NSFileManager.defaultManager fileExistsAtPath:symbolsPath isDirectory:&isDirectory]) {
-        continue;
-      }
-      if (isDirectory == NO) {
-        continue;
-      }
-      [paths addObject:symbolsPath];
-    }
-  }
+  NSArray<NSString *> *paths = self.index.symbolsPaths;
   for (NSString *path in paths) {
     if (![path containsString:buildVersion]) {
       continue;
@@ -159,22 +323,16 @@ static NSInteger ScoreVersions(NSOperatingSystemVersion current, NSOperatingSyst
       fail:error];
   }
 
-  // Sort the array such that the best matching version appears at the top.
-  NSArray<FBDeveloperDiskImage *> *sorted = [images sortedArrayUsingComparator:^ NSComparisonResult (FBDeveloperDiskImage *left, FBDeveloperDiskImage *right) {
-    NSOperatingSystemVersion leftVersion = left.version;
-    NSOperatingSystemVersion rightVersion = right.version;
-    NSInteger leftDelta = ScoreVersions(leftVersion, targetVersion);
-    NSInteger rightDelta = ScoreVersions(rightVersion, targetVersion);
-    if (leftDelta < rightDelta) {
-      return NSOrderedAscending;
+  // Only the best matching version is needed, so a single pass is enough. The first of equally scored images wins.
+  FBDeveloperDiskImage *best = nil;
+  NSInteger bestDelta = NSIntegerMax;
+  for (FBDeveloperDiskImage *image in images) {
+    NSInteger delta = ScoreVersions(image.version, targetVersion);
+    if (delta < bestDelta) {
+      best = image;
+      bestDelta = delta;
     }
-    if (leftDelta > rightDelta) {
-      return NSOrderedDescending;
-    }
-    return NSOrderedSame;
-  }];
-
-  FBDeveloperDiskImage *best = sorted.firstObject;
+  }
   NSOperatingSystemVersion bestVersion = best.version;
   if (bestVersion.majorVersion == targetVersion.majorVersion && bestVersion.minorVersion == targetVersion.minorVersion) {
     [logger logFormat:@"Found the best match for %ld.%ld at %@", targetVersion.majorVersion, targetVersion.minorVersion, best];
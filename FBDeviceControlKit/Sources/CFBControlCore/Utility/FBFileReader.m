@@ -28,10 +28,74 @@ static NSString *StateStringFromState(FBFileReaderState state)
   }
 }
 
+// Small enough that interactive output is delivered in pieces, rather than after a large read.
+static const size_t LatencyHighWater = 1024 * 16;
+// Large enough that bulk output is delivered in few pieces, without each reader holding much memory.
+static const size_t ThroughputLowWater = 1024 * 64;
+static const size_t ThroughputHighWater = 1024 * 1024;
+// Bounds how long bulk output waits to reach the low water.
+static const NSTimeInterval ThroughputInterval = 0.05;
+
+@implementation FBFileReaderConfiguration
+
+#pragma mark Initializers
+
++ (instancetype)configurationWithLowWater:(size_t)lowWater highWater:(size_t)highWater interval:(NSTimeInterval)interval
+{
+  return [[self alloc] initWithLowWater:lowWater highWater:highWater interval:interval];
+}
+
++ (FBFileReaderConfiguration *)defaultConfiguration
+{
+  // Report partial results with as little as 1 byte read.
+  return [self configurationWithLowWater:1 highWater:SIZE_MAX interval:0];
+}
+
++ (FBFileReaderConfiguration *)latencyConfiguration
+{
+  return [self configurationWithLowWater:1 highWater:LatencyHighWater interval:0];
+}
+
++ (FBFileReaderConfiguration *)throughputConfiguration
+{
+  return [self configurationWithLowWater:ThroughputLowWater highWater:ThroughputHighWater interval:ThroughputInterval];
+}
+
+- (instancetype)initWithLowWater:(size_t)lowWater highWater:(size_t)highWater interval:(NSTimeInterval)interval
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _lowWater = MAX(lowWater, 1);
+  _highWater = MAX(highWater, _lowWater);
+  _interval = MAX(interval, 0);
+
+  return self;
+}
+
+#pragma mark NSCopying
+
+- (instancetype)copyWithZone:(NSZone *)zone
+{
+  return self;
+}
+
+#pragma mark NSObject
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"Low Water %zu | High Water %zu | Interval %.3fs", self.lowWater, self.highWater, self.interval];
+}
+
+@end
+
 @interface FBFileReader ()
 
 @property (nonatomic, copy, readonly) NSString *targeting;
 @property (nonatomic, strong, readonly) id<FBDispatchDataConsumer> consumer;
+@property (nonatomic, copy, readonly) FBFileReaderConfiguration *configuration;
 @property (nonatomic, strong, readonly) dispatch_queue_t readQueue;
 @property (nonatomic, strong, readonly) FBMutableFuture<NSNumber *> *ioChannelRelinquishedControl;
 @property (nonatomic, assign, readonly) int fileDescriptor;
@@ -54,13 +118,23 @@ static NSString *StateStringFromState(FBFileReaderState state)
 
 + (instancetype)readerWithFileDescriptor:(int)fileDescriptor closeOnEndOfFile:(BOOL)closeOnEndOfFile consumer:(id<FBDataConsumer>)consumer logger:(nullable id<FBControlCoreLogger>)logger
 {
-  return [self dispatchDataReaderWithFileDescriptor:fileDescriptor closeOnEndOfFile:closeOnEndOfFile consumer:[FBDataConsumerAdaptor dispatchDataConsumerForDataConsumer:consumer] logger:logger];
+  return [self readerWithFileDescriptor:fileDescriptor closeOnEndOfFile:closeOnEndOfFile consumer:consumer configuration:FBFileReaderConfiguration.defaultConfiguration logger:logger];
 }
 
 + (instancetype)dispatchDataReaderWithFileDescriptor:(int)fileDescriptor closeOnEndOfFile:(BOOL)closeOnEndOfFile consumer:(id<FBDispatchDataConsumer>)consumer logger:(nullable id<FBControlCoreLogger>)logger
+{
+  return [self dispatchDataReaderWithFileDescriptor:fileDescriptor closeOnEndOfFile:closeOnEndOfFile consumer:consumer configuration:FBFileReaderConfiguration.defaultConfiguration logger:logger];
+}
+
++ (instancetype)readerWithFileDescriptor:(int)fileDescriptor closeOnEndOfFile:(BOOL)closeOnEndOfFile consumer:(id<FBDataConsumer>)consumer configuration:(FBFileReaderConfiguration *)configuration logger:(nullable id<FBControlCoreLogger>)logger
+{
+  return [self dispatchDataReaderWithFileDescriptor:fileDescriptor closeOnEndOfFile:closeOnEndOfFile consumer:[FBDataConsumerAdaptor dispatchDataConsumerForDataConsumer:consumer] configuration:configuration logger:logger];
+}
+
++ (instancetype)dispatchDataReaderWithFileDescriptor:(int)fileDescriptor closeOnEndOfFile:(BOOL)closeOnEndOfFile consumer:(id<FBDispatchDataConsumer>)consumer configuration:(FBFileReaderConfiguration *)configuration logger:(nullable id<FBControlCoreLogger>)logger
 {
   NSString *targeting = [NSString stringWithFormat:@"fd %d", fileDescriptor];
-  return [[self alloc] initWithFileDescriptor:fileDescriptor closeOnEndOfFile:closeOnEndOfFile consumer:consumer targeting:targeting queue:self.createQueue logger:logger];
+  return [[self alloc] initWithFileDescriptor:fileDescriptor closeOnEndOfFile:closeOnEndOfFile consumer:consumer configuration:configuration targeting:targeting queue:self.createQueue logger:logger];
 }
 
 + (FBFuture<FBFileReader *> *)readerWithFilePath:(NSString *)filePath consumer:(id<FBDataConsumer>)consumer logger:(nullable id<FBControlCoreLogger>)logger
@@ -73,11 +147,11 @@ static NSString *StateStringFromState(FBFileReaderState state)
         describeFormat:@"open of %@ returned an error '%s'", filePath, strerror(errno)]
         fail:error];
     }
-    return [[self alloc] initWithFileDescriptor:fileDescriptor closeOnEndOfFile:YES consumer:[FBDataConsumerAdaptor dispatchDataConsumerForDataConsumer:consumer] targeting:filePath queue:queue logger:logger];
+    return [[self alloc] initWithFileDescriptor:fileDescriptor closeOnEndOfFile:YES consumer:[FBDataConsumerAdaptor dispatchDataConsumerForDataConsumer:consumer] configuration:FBFileReaderConfiguration.defaultConfiguration targeting:filePath queue:queue logger:logger];
   }];
 }
 
-- (instancetype)initWithFileDescriptor:(int)fileDescriptor closeOnEndOfFile:(BOOL)closeOnEndOfFile consumer:(id<FBDispatchDataConsumer>)consumer targeting:(NSString *)targeting queue:(dispatch_queue_t)queue logger:(nullable id<FBControlCoreLogger>)logger
+- (instancetype)initWithFileDescriptor:(int)fileDescriptor closeOnEndOfFile:(BOOL)closeOnEndOfFile consumer:(id<FBDispatchDataConsumer>)consumer configuration:(FBFileReaderConfiguration *)configuration targeting:(NSString *)targeting queue:(dispatch_queue_t)queue logger:(nullable id<FBControlCoreLogger>)logger
 {
   self = [super init];
   if (!self) {
@@ -86,6 +160,7 @@ static NSString *StateStringFromState(FBFileReaderState state)
 
   _fileDescriptor = fileDescriptor;
   _consumer = consumer;
+  _configuration = [configuration copy];
   _targeting = targeting;
   _readQueue = queue;
   _ioChannelRelinquishedControl = [FBMutableFuture futureWithNameFormat:@"IO Channel control relinquished %@", targeting];
@@ -171,8 +246,13 @@ static NSString *StateStringFromState(FBFileReaderState state)
       failFuture];
   }
 
-  // Report partial results with as little as 1 byte read.
-  dispatch_io_set_low_water(self.io, 1);
+  FBFileReaderConfiguration *configuration = self.configuration;
+  dispatch_io_set_low_water(self.io, configuration.lowWater);
+  dispatch_io_set_high_water(self.io, configuration.highWater);
+  if (configuration.interval > 0) {
+    // A strict interval delivers whatever has been read, even if it is short of the low water.
+    dispatch_io_set_interval(self.io, (uint64_t) (configuration.interval * NSEC_PER_SEC), DISPATCH_IO_STRICT_INTERVAL);
+  }
   dispatch_io_read(self.io, 0, SIZE_MAX, self.readQueue, ^(bool done, dispatch_data_t dispatchData, int errorCode) {
     if (dispatchData != NULL && dispatchData != dispatch_data_empty) {
       [consumer consumeData:dispatchData];
@@ -7,8 +7,48 @@
 
 #import "FBFileWriter.h"
 
+#import <poll.h>
+#import <stdatomic.h>
+#import <sys/uio.h>
+
 #import "FBControlCoreError.h"
 
+// The most regions of a dispatch_data that are passed to a single writev.
+static const int WriteMaximumVectors = 64;
+
+static BOOL WriteDispatchData(int fileDescriptor, dispatch_data_t data, NSError **error)
+{
+  while (dispatch_data_get_size(data) > 0) {
+    struct iovec vectors[WriteMaximumVectors];
+    struct iovec *vectorsPointer = vectors;
+    __block int count = 0;
+    dispatch_data_apply(data, ^ bool (dispatch_data_t region, size_t offset, const void *buffer, size_t size) {
+      vectorsPointer[count].iov_base = (void *) buffer;
+      vectorsPointer[count].iov_len = size;
+      count++;
+      return count < WriteMaximumVectors;
+    });
+    ssize_t written = writev(fileDescriptor, vectors, count);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written < 0 && errno == EAGAIN) {
+      // The descriptor is non-blocking, so wait until it can accept more.
+      struct pollfd pollDescriptor = {.fd = fileDescriptor, .events = POLLOUT};
+      poll(&pollDescriptor, 1, -1);
+      continue;
+    }
+    if (written < 0) {
+      return [[FBControlCoreError
+        describeFormat:@"Failed to write %zu bytes to fd %d: %s", dispatch_data_get_size(data), fileDescriptor, strerror(errno)]
+        failBool:error];
+    }
+    // A short write leaves the remainder to be written on the next pass.
+    data = dispatch_data_create_subrange(data, (size_t) written, dispatch_data_get_size(data) - (size_t) written);
+  }
+  return YES;
+}
+
 @interface FBFileWriter ()
 
 @property (nonatomic, assign, readonly) int fileDescriptor;
@@ -26,12 +66,15 @@
 
 @interface FBFileWriter_Sync : FBFileWriter <FBDispatchDataConsumer, FBDataConsumerLifecycle>
 
+@property (nonatomic, strong, nullable, readwrite) NSError *writeError;
+
 @end
 
 @interface FBFileWriter_Async : FBFileWriter <FBDispatchDataConsumer, FBDataConsumerLifecycle>
 
 @property (nonatomic, strong, readonly) dispatch_queue_t writeQueue;
 @property (nonatomic, strong, readwrite) dispatch_io_t io;
+@property (atomic, strong, nullable, readwrite) NSError *writeError;
 
 - (instancetype)initWithFileDescriptor:(int)fileDescriptor closeOnEndOfFile:(BOOL)closeOnEndOfFile writeQueue:(dispatch_queue_t)writeQueue;
 
@@ -39,6 +82,24 @@
 
 @end
 
+@interface FBFileWriter_Coalescing : FBFileWriter <FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerAsync, FBDataConsumerBackpressure>
+
+@property (nonatomic, assign, readonly) size_t coalescingBytes;
+@property (nonatomic, assign, readonly) NSTimeInterval coalescingInterval;
+@property (nonatomic, strong, readonly) dispatch_queue_t writeQueue;
+
+// Guarded by self.
+@property (nonatomic, strong, readwrite) dispatch_data_t coalesced;
+@property (nonatomic, assign, readwrite) NSInteger coalescedChunks;
+@property (nonatomic, assign, readwrite) BOOL drainScheduled;
+@property (nonatomic, assign, readwrite) BOOL timerScheduled;
+@property (nonatomic, assign, readwrite) BOOL finished;
+@property (nonatomic, strong, nullable, readwrite) NSError *writeError;
+
+- (instancetype)initWithFileDescriptor:(int)fileDescriptor closeOnEndOfFile:(BOOL)closeOnEndOfFile coalescingBytes:(size_t)coalescingBytes coalescingInterval:(NSTimeInterval)coalescingInterval writeQueue:(dispatch_queue_t)writeQueue;
+
+@end
+
 @implementation FBFileWriter
 
 #pragma mark Initializers
@@ -56,10 +117,11 @@
 + (int)fileDescriptorForPath:(NSString *)filePath error:(NSError **)error
 {
   int fileDescriptor = open(filePath.UTF8String, O_WRONLY | O_CREAT, 0644);
-  if (!fileDescriptor) {
-    return [[FBControlCoreError
+  if (fileDescriptor < 0) {
+    [[FBControlCoreError
       describeFormat:@"A file handle for path %@ could not be opened: %s", filePath, strerror(errno)]
-      failInt:error];
+      fail:error];
+    return -1;
   }
   return fileDescriptor;
 }
@@ -94,10 +156,15 @@
   return [self asyncWriterWithFileDescriptor:fileDescriptor closeOnEndOfFile:closeOnEndOfFile queue:queue error:error];
 }
 
++ (id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerAsync, FBDataConsumerBackpressure>)coalescingWriterWithFileDescriptor:(int)fileDescriptor closeOnEndOfFile:(BOOL)closeOnEndOfFile coalescingBytes:(size_t)coalescingBytes coalescingInterval:(NSTimeInterval)coalescingInterval
+{
+  return [[FBFileWriter_Coalescing alloc] initWithFileDescriptor:fileDescriptor closeOnEndOfFile:closeOnEndOfFile coalescingBytes:coalescingBytes coalescingInterval:coalescingInterval writeQueue:self.createWorkQueue];
+}
+
 + (id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerSync>)syncWriterForFilePath:(NSString *)filePath error:(NSError **)error
 {
   int fileDescriptor = [self fileDescriptorForPath:filePath error:error];
-  if (!fileDescriptor) {
+  if (fileDescriptor < 0) {
     return nil;
   }
   return [FBFileWriter syncWriterWithFileDescriptor:fileDescriptor closeOnEndOfFile:YES];
@@ -110,7 +177,7 @@
     onQueue:queue resolve:^() {
       NSError *error = nil;
       int fileDescriptor = [self fileDescriptorForPath:filePath error:&error];
-      if (!fileDescriptor) {
+      if (fileDescriptor < 0) {
         return [FBFuture futureWithError:error];
       }
       FBFileWriter_Async *writer = [[FBFileWriter_Async alloc] initWithFileDescriptor:fileDescriptor closeOnEndOfFile:YES writeQueue:queue];
@@ -164,18 +231,26 @@
 
 - (void)consumeData:(dispatch_data_t)data
 {
-  dispatch_data_apply(data, ^ bool (dispatch_data_t region, size_t offset, const void *buffer, size_t size) {
-    write(self.fileDescriptor, buffer, size);
-    return true;
-  });
+  // Once a write has failed, later data can't be written contiguously with earlier data, so is discarded.
+  if (self.writeError) {
+    return;
+  }
+  NSError *error = nil;
+  if (!WriteDispatchData(self.fileDescriptor, data, &error)) {
+    self.writeError = error;
+  }
 }
 
 - (void)consumeEndOfFile
 {
-  [self.finishedConsumingMutable resolveWithResult:NSNull.null];
   if (self.closeOnEndOfFile) {
     close(self.fileDescriptor);
   }
+  if (self.writeError) {
+    [self.finishedConsumingMutable resolveWithError:self.writeError];
+    return;
+  }
+  [self.finishedConsumingMutable resolveWithResult:NSNull.null];
 }
 
 - (FBFuture<NSNull *> *)finishedConsuming
@@ -210,7 +285,13 @@
     return;
   }
   
-  dispatch_io_write(io, 0, data, self.writeQueue, ^(bool done, dispatch_data_t remainder, int error) {});
+  dispatch_io_write(io, 0, data, self.writeQueue, ^(bool done, dispatch_data_t remainder, int errorCode) {
+    if (done && errorCode != 0 && !self.writeError) {
+      self.writeError = [[FBControlCoreError
+        describeFormat:@"Failed to write %zu bytes to fd %d: %s", remainder ? dispatch_data_get_size(remainder) : 0, self.fileDescriptor, strerror(errorCode)]
+        build];
+    }
+  });
 }
 
 - (void)consumeEndOfFile
@@ -242,6 +323,7 @@
   NSParameterAssert(!self.io);
 
   FBMutableFuture<NSNull *> *finishedConsuming = self.finishedConsumingMutable;
+  __weak typeof(self) weakSelf = self;
 
   // If there is an error creating the IO Object, the errorCode will be delivered asynchronously.
   // Having a self -> IO -> self cycle shouldn't be a problem in theory, since the cleanup handler should get when IO is done.
@@ -257,12 +339,16 @@
   // 9) `consumeEndOfFile` is called and subsequently dispatch_io_close.
   // 10) The cleanup handler is *never* called and the FD is therefore never closed.
   // This isn't a problem in practice if different FDs are splayed, but repeating FDs representing different dispatch channels will cause this problem.
-  __weak typeof(self) weakSelf = self;
   self.io = dispatch_io_create(DISPATCH_IO_STREAM, self.fileDescriptor, self.writeQueue, ^(int errorCode) {
+    NSError *writeError = weakSelf.writeError;
     [weakSelf ioChannelDidCloseWithError:errorCode];
 
     // Since writing is asynchronous, we don't want to vend futures that show that all work on a file descriptor has finished.
     // Instead we should wait until the io channel is fully closed, this only occurs in this callback.
+    if (writeError) {
+      [finishedConsuming resolveWithError:writeError];
+      return;
+    }
     [finishedConsuming resolveWithResult:NSNull.null];
   });
   if (!self.io) {
@@ -285,3 +371,159 @@
 }
 
 @end
+
+@implementation FBFileWriter_Coalescing
+{
+  _Atomic(uint64_t) _bytesPending;
+}
+
+#pragma mark Initializers
+
+- (instancetype)initWithFileDescriptor:(int)fileDescriptor closeOnEndOfFile:(BOOL)closeOnEndOfFile coalescingBytes:(size_t)coalescingBytes coalescingInterval:(NSTimeInterval)coalescingInterval writeQueue:(dispatch_queue_t)writeQueue
+{
+  self = [super initWithFileDescriptor:fileDescriptor closeOnEndOfFile:closeOnEndOfFile];
+  if (!self) {
+    return nil;
+  }
+
+  _coalescingBytes = coalescingBytes;
+  _coalescingInterval = coalescingInterval;
+  _writeQueue = writeQueue;
+  _coalesced = dispatch_data_empty;
+  atomic_init(&_bytesPending, 0);
+
+  return self;
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  dispatch_data_t dispatchData = [FBDataConsumerAdaptor adaptNSData:data];
+  size_t size = dispatch_data_get_size(dispatchData);
+  if (size == 0) {
+    return;
+  }
+  @synchronized (self) {
+    if (self.finished || self.writeError) {
+      return;
+    }
+    self.coalesced = dispatch_data_create_concat(self.coalesced, dispatchData);
+    self.coalescedChunks += 1;
+    atomic_fetch_add_explicit(&_bytesPending, size, memory_order_relaxed);
+    if (dispatch_data_get_size(self.coalesced) >= self.coalescingBytes) {
+      [self scheduleDrain];
+    } else if (!self.timerScheduled) {
+      self.timerScheduled = YES;
+      dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t) (self.coalescingInterval * NSEC_PER_SEC)), self.writeQueue, ^{
+        @synchronized (self) {
+          self.timerScheduled = NO;
+        }
+        [self drain];
+      });
+    }
+  }
+}
+
+- (void)consumeEndOfFile
+{
+  @synchronized (self) {
+    if (self.finished) {
+      return;
+    }
+    self.finished = YES;
+  }
+  dispatch_async(self.writeQueue, ^{
+    [self drain];
+    if (self.closeOnEndOfFile) {
+      close(self.fileDescriptor);
+    }
+    NSError *error = nil;
+    @synchronized (self) {
+      error = self.writeError;
+    }
+    if (error) {
+      [self.finishedConsumingMutable resolveWithError:error];
+      return;
+    }
+    [self.finishedConsumingMutable resolveWithResult:NSNull.null];
+  });
+}
+
+#pragma mark FBDataConsumerLifecycle
+
+- (FBFuture<NSNull *> *)finishedConsuming
+{
+  return self.finishedConsumingMutable;
+}
+
+#pragma mark FBDataConsumerAsync
+
+- (NSInteger)unprocessedDataCount
+{
+  @synchronized (self) {
+    return self.coalescedChunks;
+  }
+}
+
+- (NSInteger)discardUnprocessedData
+{
+  @synchronized (self) {
+    NSInteger discarded = self.coalescedChunks;
+    atomic_fetch_sub_explicit(&_bytesPending, dispatch_data_get_size(self.coalesced), memory_order_relaxed);
+    self.coalesced = dispatch_data_empty;
+    self.coalescedChunks = 0;
+    return discarded;
+  }
+}
+
+#pragma mark FBDataConsumerBackpressure
+
+- (uint64_t)bytesPending
+{
+  return atomic_load_explicit(&_bytesPending, memory_order_relaxed);
+}
+
+#pragma mark Private
+
+// Must be called with self locked.
+- (void)scheduleDrain
+{
+  if (self.drainScheduled) {
+    return;
+  }
+  self.drainScheduled = YES;
+  dispatch_async(self.writeQueue, ^{
+    [self drain];
+  });
+}
+
+// Must be called on the write queue. The pending data is taken when the drain runs, so that chunks that arrive whilst a write is in progress are coalesced into the next one.
+- (void)drain
+{
+  dispatch_data_t data = nil;
+  @synchronized (self) {
+    self.drainScheduled = NO;
+    data = self.coalesced;
+    self.coalesced = dispatch_data_empty;
+    self.coalescedChunks = 0;
+  }
+  size_t size = dispatch_data_get_size(data);
+  if (size == 0) {
+    return;
+  }
+  NSError *error = nil;
+  BOOL success = WriteDispatchData(self.fileDescriptor, data, &error);
+  atomic_fetch_sub_explicit(&_bytesPending, size, memory_order_relaxed);
+  if (success) {
+    return;
+  }
+  @synchronized (self) {
+    self.writeError = self.writeError ?: error;
+    atomic_fetch_sub_explicit(&_bytesPending, dispatch_data_get_size(self.coalesced), memory_order_relaxed);
+    self.coalesced = dispatch_data_empty;
+    self.coalescedChunks = 0;
+  }
+}
+
+@end
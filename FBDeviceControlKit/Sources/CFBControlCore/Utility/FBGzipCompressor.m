@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBGzipCompressor.h"
+
+#import <libkern/OSByteOrder.h>
+#import <zlib.h>
+
+#import "FBControlCoreError.h"
+
+const int FBGzipCompressionLevelDefault = Z_DEFAULT_COMPRESSION;
+
+// The same as pigz, large enough that priming each block with a dictionary costs little.
+static const size_t DefaultBlockSize = 1024 * 128;
+// The window of deflate. The end of each block primes the next, so that compression is as good as it would be in a single stream.
+static const size_t DictionarySize = 1024 * 32;
+
+static NSData *DeflateBlock(NSData *input, NSData *dictionary, int level, NSError **error)
+{
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  // Negative window bits produce raw deflate, the gzip header and trailer are written once for the whole stream.
+  if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to initialize deflate at level %d", level]
+      fail:error];
+  }
+  if (dictionary.length > 0) {
+    deflateSetDictionary(&stream, dictionary.bytes, (uInt) dictionary.length);
+  }
+  NSMutableData *output = [NSMutableData dataWithLength:deflateBound(&stream, input.length) + 16];
+  stream.next_in = (Bytef *) input.bytes;
+  stream.avail_in = (uInt) input.length;
+  while (YES) {
+    stream.next_out = (Bytef *) output.mutableBytes + stream.total_out;
+    stream.avail_out = (uInt) (output.length - stream.total_out);
+    // A sync flush ends the block on a byte boundary without ending the stream, so that blocks can be concatenated.
+    int status = deflate(&stream, Z_SYNC_FLUSH);
+    if (status != Z_OK && status != Z_BUF_ERROR) {
+      deflateEnd(&stream);
+      return [[FBControlCoreError
+        describeFormat:@"Failed to deflate a block of %lu bytes: %s", (unsigned long) input.length, stream.msg ?: "unknown error"]
+        fail:error];
+    }
+    if (stream.avail_out != 0) {
+      break;
+    }
+    output.length *= 2;
+  }
+  output.length = stream.total_out;
+  deflateEnd(&stream);
+  return output;
+}
+
+/**
+ A block that has been compressed, waiting to be written in order.
+ */
+@interface FBGzipCompressor_Block : NSObject
+
+@property (nonatomic, strong, nullable, readonly) NSData *compressed;
+@property (nonatomic, strong, nullable, readonly) NSError *error;
+@property (nonatomic, assign, readonly) uLong crc;
+@property (nonatomic, assign, readonly) size_t length;
+
+@end
+
+@implementation FBGzipCompressor_Block
+
+- (instancetype)initWithCompressed:(nullable NSData *)compressed error:(nullable NSError *)error crc:(uLong)crc length:(size_t)length
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _compressed = compressed;
+  _error = error;
+  _crc = crc;
+  _length = length;
+
+  return self;
+}
+
+@end
+
+@interface FBGzipCompressor ()
+
+@property (nonatomic, strong, readonly) id<FBDataConsumer> consumer;
+@property (nonatomic, assign, readonly) int level;
+@property (nonatomic, assign, readonly) size_t blockSize;
+@property (nonatomic, strong, readonly) dispatch_queue_t compressionQueue;
+@property (nonatomic, strong, readonly) dispatch_queue_t outputQueue;
+@property (nonatomic, strong, readonly) dispatch_semaphore_t blocksAvailable;
+@property (nonatomic, strong, readonly) dispatch_group_t blocksOutstanding;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *finishedConsumingMutable;
+
+// Accessed by the producer, which consumes serially.
+@property (nonatomic, strong, readwrite) NSMutableData *pendingInput;
+@property (nonatomic, strong, readwrite) NSData *dictionary;
+@property (nonatomic, assign, readwrite) NSUInteger nextSubmittedIndex;
+@property (nonatomic, assign, readwrite) uint64_t bytesConsumed;
+@property (nonatomic, assign, readwrite) BOOL finished;
+
+// Accessed on the output queue.
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSNumber *, FBGzipCompressor_Block *> *completedBlocks;
+@property (nonatomic, assign, readwrite) NSUInteger nextWrittenIndex;
+@property (nonatomic, assign, readwrite) uLong crc;
+@property (nonatomic, assign, readwrite) BOOL headerWritten;
+@property (nonatomic, strong, nullable, readwrite) NSError *error;
+
+@end
+
+@implementation FBGzipCompressor
+
+#pragma mark Initializers
+
++ (instancetype)compressorWithConsumer:(id<FBDataConsumer>)consumer level:(int)level
+{
+  return [self compressorWithConsumer:consumer level:level blockSize:DefaultBlockSize concurrency:NSProcessInfo.processInfo.activeProcessorCount];
+}
+
++ (instancetype)compressorWithConsumer:(id<FBDataConsumer>)consumer level:(int)level blockSize:(size_t)blockSize concurrency:(NSUInteger)concurrency
+{
+  return [[self alloc] initWithConsumer:consumer level:level blockSize:blockSize concurrency:concurrency];
+}
+
+- (instancetype)initWithConsumer:(id<FBDataConsumer>)consumer level:(int)level blockSize:(size_t)blockSize concurrency:(NSUInteger)concurrency
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _consumer = consumer;
+  _level = level;
+  _blockSize = MAX(blockSize, 1);
+  _compressionQueue = dispatch_queue_create("com.facebook.fbcontrolcore.gzip_compressor.compression", DISPATCH_QUEUE_CONCURRENT);
+  _outputQueue = dispatch_queue_create("com.facebook.fbcontrolcore.gzip_compressor.output", DISPATCH_QUEUE_SERIAL);
+  _blocksAvailable = dispatch_semaphore_create((long) MAX(concurrency, 1) * 2);
+  _blocksOutstanding = dispatch_group_create();
+  _finishedConsumingMutable = [FBMutableFuture futureWithName:@"Gzip compression"];
+  _pendingInput = [NSMutableData dataWithCapacity:_blockSize];
+  _dictionary = NSData.data;
+  _completedBlocks = NSMutableDictionary.dictionary;
+  _crc = crc32(0L, Z_NULL, 0);
+
+  return self;
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  if (self.finished) {
+    return;
+  }
+  [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+    const uint8_t *remaining = bytes;
+    size_t length = byteRange.length;
+    while (length > 0) {
+      size_t size = MIN(length, self.blockSize - self.pendingInput.length);
+      [self.pendingInput appendBytes:remaining length:size];
+      remaining += size;
+      length -= size;
+      if (self.pendingInput.length == self.blockSize) {
+        [self submitPendingInput];
+      }
+    }
+  }];
+  self.bytesConsumed += data.length;
+}
+
+- (void)consumeEndOfFile
+{
+  if (self.finished) {
+    return;
+  }
+  self.finished = YES;
+  if (self.pendingInput.length > 0) {
+    [self submitPendingInput];
+  }
+  uint32_t length = (uint32_t) self.bytesConsumed;
+  dispatch_group_notify(self.blocksOutstanding, self.outputQueue, ^{
+    if (self.error) {
+      [self.consumer consumeEndOfFile];
+      [self.finishedConsumingMutable resolveWithError:self.error];
+      return;
+    }
+    [self writeHeaderIfNeeded];
+    // An empty final block ends the deflate stream, followed by the gzip trailer of the checksum and the length modulo 2^32.
+    uint8_t trailer[10] = {0x03, 0x00};
+    OSWriteLittleInt32(trailer, 2, (uint32_t) self.crc);
+    OSWriteLittleInt32(trailer, 6, length);
+    [self.consumer consumeData:[NSData dataWithBytes:trailer length:sizeof(trailer)]];
+    [self.consumer consumeEndOfFile];
+    [self.finishedConsumingMutable resolveWithResult:NSNull.null];
+  });
+}
+
+#pragma mark FBDataConsumerLifecycle
+
+- (FBFuture<NSNull *> *)finishedConsuming
+{
+  return self.finishedConsumingMutable;
+}
+
+#pragma mark Private
+
+- (void)submitPendingInput
+{
+  NSData *input = self.pendingInput;
+  NSData *dictionary = self.dictionary;
+  NSUInteger index = self.nextSubmittedIndex;
+  self.nextSubmittedIndex += 1;
+  self.pendingInput = [NSMutableData dataWithCapacity:self.blockSize];
+  self.dictionary = input.length > DictionarySize ? [input subdataWithRange:NSMakeRange(input.length - DictionarySize, DictionarySize)] : input;
+
+  // Waiting here holds up the producer when compression or writing can't keep up.
+  dispatch_semaphore_wait(self.blocksAvailable, DISPATCH_TIME_FOREVER);
+  dispatch_group_enter(self.blocksOutstanding);
+  int level = self.level;
+  dispatch_async(self.compressionQueue, ^{
+    NSError *error = nil;
+    NSData *compressed = DeflateBlock(input, dictionary, level, &error);
+    uLong crc = crc32(crc32(0L, Z_NULL, 0), input.bytes, (uInt) input.length);
+    FBGzipCompressor_Block *block = [[FBGzipCompressor_Block alloc] initWithCompressed:compressed error:error crc:crc length:input.length];
+    dispatch_async(self.outputQueue, ^{
+      self.completedBlocks[@(index)] = block;
+      [self writeCompletedBlocks];
+    });
+  });
+}
+
+// Must be called on the output queue. Blocks complete in any order, but are written in the order they were submitted.
+- (void)writeCompletedBlocks
+{
+  while (YES) {
+    FBGzipCompressor_Block *block = self.completedBlocks[@(self.nextWrittenIndex)];
+    if (!block) {
+      return;
+    }
+    [self.completedBlocks removeObjectForKey:@(self.nextWrittenIndex)];
+    self.nextWrittenIndex += 1;
+    if (block.error && !self.error) {
+      self.error = block.error;
+    }
+    if (!self.error) {
+      [self writeHeaderIfNeeded];
+      [self.consumer consumeData:block.compressed];
+      self.crc = crc32_combine(self.crc, block.crc, (z_off_t) block.length);
+    }
+    dispatch_semaphore_signal(self.blocksAvailable);
+    dispatch_group_leave(self.blocksOutstanding);
+  }
+}
+
+- (void)writeHeaderIfNeeded
+{
+  if (self.headerWritten) {
+    return;
+  }
+  self.headerWritten = YES;
+  // Deflate, with no name or modification time, from a Unix system.
+  static const uint8_t header[10] = {0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03};
+  [self.consumer consumeData:[NSData dataWithBytes:header length:sizeof(header)]];
+}
+
+@end
@@ -7,13 +7,29 @@
 
 #import "FBLoggingWrapper.h"
 
+// Descriptions of arguments are truncated, as some arguments are large.
+static const NSUInteger MaximumArgumentDescriptionLength = 100;
+
 @interface FBLoggingWrapper ()
 
 @property (nonatomic, strong, readonly) id wrappedObject;
-@property (nonatomic, strong, readonly) id<FBEventReporter> eventReporter;
-@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) FBLoggingWrapperRecorder *recorder;
+
++ (NSArray<NSString *> *)descriptionOfArguments:(NSInvocation *)invocation;
++ (NSString *)descriptionForObject:(NSObject *)object;
++ (NSString *)truncatedDescription:(NSString *)description;
+
+@end
+
+@interface FBLoggingWrapperRecorder ()
+
+@property (nonatomic, strong, nullable, readonly) id<FBEventReporter> eventReporter;
+@property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
 @property (nonatomic, strong, readonly) dispatch_queue_t queue;
 @property (nonatomic, assign, readonly) BOOL simplifiedNaming;
+@property (nonatomic, assign, readonly) BOOL recording;
+
+- (id)recordCall:(SEL)selector descriptionOfArguments:(NSArray<NSString *> *)descriptionOfArguments firstMethodArgument:(nullable id)firstMethodArgument call:(id (^)(void))call;
 
 @end
 
@@ -23,10 +39,11 @@
 
 + (instancetype)wrap:(id)wrappedObject simplifiedNaming:(BOOL)simplifiedNaming eventReporter:(nullable id<FBEventReporter>)eventReporter logger:(nullable id<FBControlCoreLogger>)logger
 {
-  return [[self alloc] initWithWrappedObject:wrappedObject simplifiedNaming:simplifiedNaming eventReporter:eventReporter logger:logger];
+  FBLoggingWrapperRecorder *recorder = [FBLoggingWrapperRecorder recorderWithSimplifiedNaming:simplifiedNaming eventReporter:eventReporter logger:logger];
+  return [[self alloc] initWithWrappedObject:wrappedObject recorder:recorder];
 }
 
-- (instancetype)initWithWrappedObject:(id)wrappedObject simplifiedNaming:(BOOL)simplifiedNaming eventReporter:(nullable id<FBEventReporter>)eventReporter logger:(nullable id<FBControlCoreLogger>)logger
+- (instancetype)initWithWrappedObject:(id)wrappedObject recorder:(FBLoggingWrapperRecorder *)recorder
 {
   self = [super init];
   if (!self) {
@@ -34,10 +51,7 @@
   }
 
   _wrappedObject = wrappedObject;
-  _simplifiedNaming = simplifiedNaming;
-  _queue = dispatch_queue_create("com.facebook.fbcontrolcore.logging_wrapper", DISPATCH_QUEUE_SERIAL);
-  _eventReporter = eventReporter;
-  _logger = logger;
+  _recorder = recorder;
 
   return self;
 }
@@ -65,12 +79,11 @@
 
 - (void)runInvocation:(NSInvocation *)invocation
 {
-  // Extract information about the start of the call.
-  NSDate *startDate = NSDate.date;
-  NSString *methodName = [self.class methodName:invocation simplifiedNaming:self.simplifiedNaming];
-  NSArray<NSString *> *descriptionOfArguments = [self.class descriptionOfArguments:invocation];
-  FBEventReporterSubject *beforeSubject = [self.class subjectForBeforeInvocation:methodName descriptionOfArguments:descriptionOfArguments logger:self.logger];
-  [self.eventReporter report:beforeSubject];
+  // Nothing is described when nothing would be recorded.
+  if (!self.recorder.recording) {
+    [invocation invokeWithTarget:self.wrappedObject];
+    return;
+  }
 
   // Extract the first method argument and retain it, if it exists
   id firstMethodArgument = nil;
@@ -80,72 +93,36 @@
     firstMethodArgument = argument;
   }
 
-  // Invoke on the Future Handler on the appropriate queue.
-  [invocation invokeWithTarget:self.wrappedObject];
-  void *returnValue = NULL;
-  [invocation getReturnValue:&returnValue];
-  FBFuture *future = (__bridge FBFuture *)(returnValue);
-
-  // Log the end of the call when the future resolves.
-  if ([future isKindOfClass:FBFuture.class]) {
-    [future onQueue:self.queue notifyOfCompletion:^(FBFuture *completedFuture) {
-      FBEventReporterSubject *afterSubject = [self.class subjectAfterCompletion:completedFuture methodName:methodName descriptionOfArguments:descriptionOfArguments startDate:startDate firstMethodArgument:firstMethodArgument logger:self.logger];
-      [self.eventReporter report:afterSubject];
-    }];
-  }
-}
-
-#pragma mark - Subjects
-
-+ (FBEventReporterSubject *)subjectForBeforeInvocation:(NSString *)methodName descriptionOfArguments:(NSArray<NSString *> *)descriptionOfArguments logger:(id<FBControlCoreLogger>)logger
-{
-  [logger.info logFormat:@"%@ called with: %@", methodName, [FBCollectionInformation oneLineDescriptionFromArray:descriptionOfArguments]];
-  return [FBEventReporterSubject subjectForStartedCall:methodName arguments:descriptionOfArguments reportNativeSwiftMethodCall: NO];
-}
-
-+ (FBEventReporterSubject *)subjectAfterCompletion:(FBFuture *)future methodName:(NSString *)methodName descriptionOfArguments:(NSArray<NSString *> *)descriptionOfArguments startDate:(NSDate *)startDate firstMethodArgument:(id)firstMethodArgument logger:(id<FBControlCoreLogger>)logger
-{
-  NSTimeInterval duration = [NSDate.date timeIntervalSinceDate:startDate];
-  NSError *error = future.error;
-  NSNumber *size = nil;
-  if ([firstMethodArgument respondsToSelector:@selector(bytesTransferred)]) {
-    size = @([firstMethodArgument bytesTransferred]);
-  }
-  if (error) {
-    NSString *message = error.localizedDescription;
-    [logger.debug logFormat:@"%@ failed with: %@", methodName, message];
-    return [FBEventReporterSubject subjectForFailingCall:methodName duration:duration message:message size:size arguments:descriptionOfArguments reportNativeSwiftMethodCall: NO];
-  } else {
-    [logger.debug logFormat:@"%@ succeeded", methodName];
-    return [FBEventReporterSubject subjectForSuccessfulCall:methodName duration:duration size:size arguments:descriptionOfArguments reportNativeSwiftMethodCall: NO];
-  }
+  [self.recorder recordCall:invocation.selector descriptionOfArguments:[self.class descriptionOfArguments:invocation] firstMethodArgument:firstMethodArgument call:^ id {
+    [invocation invokeWithTarget:self.wrappedObject];
+    if (strcmp(invocation.methodSignature.methodReturnType, "@") != 0) {
+      return nil;
+    }
+    void *returnValue = NULL;
+    [invocation getReturnValue:&returnValue];
+    return (__bridge id)(returnValue);
+  }];
 }
 
 #pragma mark - NSInvocation inspection
 
-+ (NSString *)methodName:(NSInvocation *)invocation simplifiedNaming:(BOOL)simplifiedNaming
-{
-  // This will log the first argument in the method name, so method names should be unique relative to the first component within the selector
-  if (simplifiedNaming) {
-    return [NSStringFromSelector(invocation.selector) componentsSeparatedByString:@":"][0];
-  }
-  // Otherwise log the entire selector
-  return NSStringFromSelector(invocation.selector);
-}
-
 + (NSArray<NSString *> *)descriptionOfArguments:(NSInvocation *)invocation
 {
   NSMutableArray<NSString *> *descriptions = NSMutableArray.array;
   for (int index = 2; index < (int) invocation.methodSignature.numberOfArguments; index++) {
-    NSString *description = [self descriptionForAgumentAtIndex:index inInvoation:invocation];
-    if (description.length > 100) {
-      description = [NSString stringWithFormat:@"%@...", [description substringToIndex:100]];
-    }
-    [descriptions addObject:description];
+    [descriptions addObject:[self truncatedDescription:[self descriptionForAgumentAtIndex:index inInvoation:invocation]]];
   }
   return descriptions;
 }
 
++ (NSString *)truncatedDescription:(NSString *)description
+{
+  if (description.length > MaximumArgumentDescriptionLength) {
+    return [NSString stringWithFormat:@"%@...", [description substringToIndex:MaximumArgumentDescriptionLength]];
+  }
+  return description;
+}
+
 + (NSString *)descriptionForAgumentAtIndex:(int)index inInvoation:(NSInvocation *)invocation
 {
   const char *typeString = [invocation.methodSignature getArgumentTypeAtIndex:(NSUInteger)index];
@@ -277,3 +254,289 @@
 }
 
 @end
+
+@implementation FBLoggingWrapperRecorder
+
+#pragma mark Initializers
+
++ (instancetype)recorderWithSimplifiedNaming:(BOOL)simplifiedNaming eventReporter:(nullable id<FBEventReporter>)eventReporter logger:(nullable id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithSimplifiedNaming:simplifiedNaming eventReporter:eventReporter logger:logger];
+}
+
+- (instancetype)initWithSimplifiedNaming:(BOOL)simplifiedNaming eventReporter:(nullable id<FBEventReporter>)eventReporter logger:(nullable id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _simplifiedNaming = simplifiedNaming;
+  _queue = dispatch_queue_create("com.facebook.fbcontrolcore.logging_wrapper", DISPATCH_QUEUE_SERIAL);
+  _eventReporter = eventReporter;
+  _logger = logger;
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (BOOL)recording
+{
+  return self.eventReporter != nil || [self.logger isEnabledForLevel:FBControlCoreLogLevelInfo];
+}
+
+- (id)recordCall:(SEL)selector arguments:(NSArray<id> * (^)(void))arguments call:(id (^)(void))call
+{
+  if (!self.recording) {
+    return call();
+  }
+  NSArray<id> *argumentObjects = arguments();
+  NSMutableArray<NSString *> *descriptionOfArguments = [NSMutableArray arrayWithCapacity:argumentObjects.count];
+  for (id argument in argumentObjects) {
+    [descriptionOfArguments addObject:[FBLoggingWrapper truncatedDescription:[FBLoggingWrapper descriptionForObject:argument]]];
+  }
+  return [self recordCall:selector descriptionOfArguments:descriptionOfArguments firstMethodArgument:argumentObjects.firstObject call:call];
+}
+
+#pragma mark Private
+
+- (id)recordCall:(SEL)selector descriptionOfArguments:(NSArray<NSString *> *)descriptionOfArguments firstMethodArgument:(nullable id)firstMethodArgument call:(id (^)(void))call
+{
+  // Extract information about the start of the call.
+  NSDate *startDate = NSDate.date;
+  NSString *methodName = [self methodName:selector];
+  FBEventReporterSubject *beforeSubject = [self.class subjectForBeforeInvocation:methodName descriptionOfArguments:descriptionOfArguments logger:self.logger];
+  [self.eventReporter report:beforeSubject];
+
+  id returnValue = call();
+  FBFuture *future = returnValue;
+  if ([returnValue isKindOfClass:FBFutureContext.class]) {
+    future = [(FBFutureContext *) returnValue future];
+  }
+
+  // Log the end of the call when the future resolves.
+  if ([future isKindOfClass:FBFuture.class]) {
+    [future onQueue:self.queue notifyOfCompletion:^(FBFuture *completedFuture) {
+      FBEventReporterSubject *afterSubject = [self.class subjectAfterCompletion:completedFuture methodName:methodName descriptionOfArguments:descriptionOfArguments startDate:startDate firstMethodArgument:firstMethodArgument logger:self.logger];
+      [self.eventReporter report:afterSubject];
+    }];
+  }
+  return returnValue;
+}
+
+- (NSString *)methodName:(SEL)selector
+{
+  // This will log the first argument in the method name, so method names should be unique relative to the first component within the selector
+  if (self.simplifiedNaming) {
+    return [NSStringFromSelector(selector) componentsSeparatedByString:@":"][0];
+  }
+  // Otherwise log the entire selector
+  return NSStringFromSelector(selector);
+}
+
+#pragma mark - Subjects
+
++ (FBEventReporterSubject *)subjectForBeforeInvocation:(NSString *)methodName descriptionOfArguments:(NSArray<NSString *> *)descriptionOfArguments logger:(id<FBControlCoreLogger>)logger
+{
+  [logger.info logFormat:@"%@ called with: %@", methodName, [FBCollectionInformation oneLineDescriptionFromArray:descriptionOfArguments]];
+  return [FBEventReporterSubject subjectForStartedCall:methodName arguments:descriptionOfArguments reportNativeSwiftMethodCall: NO];
+}
+
++ (FBEventReporterSubject *)subjectAfterCompletion:(FBFuture *)future methodName:(NSString *)methodName descriptionOfArguments:(NSArray<NSString *> *)descriptionOfArguments startDate:(NSDate *)startDate firstMethodArgument:(id)firstMethodArgument logger:(id<FBControlCoreLogger>)logger
+{
+  NSTimeInterval duration = [NSDate.date timeIntervalSinceDate:startDate];
+  NSError *error = future.error;
+  NSNumber *size = nil;
+  if ([firstMethodArgument respondsToSelector:@selector(bytesTransferred)]) {
+    size = @([firstMethodArgument bytesTransferred]);
+  }
+  if (error) {
+    NSString *message = error.localizedDescription;
+    [logger.debug logFormat:@"%@ failed with: %@", methodName, message];
+    return [FBEventReporterSubject subjectForFailingCall:methodName duration:duration message:message size:size arguments:descriptionOfArguments reportNativeSwiftMethodCall: NO];
+  } else {
+    [logger.debug logFormat:@"%@ succeeded", methodName];
+    return [FBEventReporterSubject subjectForSuccessfulCall:methodName duration:duration size:size arguments:descriptionOfArguments reportNativeSwiftMethodCall: NO];
+  }
+}
+
+@end
+
+@interface FBApplicationCommandsLoggingWrapper ()
+
+@property (nonatomic, strong, readonly) id<FBApplicationCommands> commands;
+@property (nonatomic, strong, readonly) FBLoggingWrapperRecorder *recorder;
+
+@end
+
+@implementation FBApplicationCommandsLoggingWrapper
+
+#pragma mark Initializers
+
++ (instancetype)commandsWithTarget:(id<FBiOSTarget>)target
+{
+  FBLoggingWrapperRecorder *recorder = [FBLoggingWrapperRecorder recorderWithSimplifiedNaming:NO eventReporter:nil logger:target.logger];
+  return [self wrap:(id<FBApplicationCommands>) target recorder:recorder];
+}
+
++ (instancetype)wrap:(id<FBApplicationCommands>)commands recorder:(FBLoggingWrapperRecorder *)recorder
+{
+  return [[self alloc] initWithCommands:commands recorder:recorder];
+}
+
+- (instancetype)initWithCommands:(id<FBApplicationCommands>)commands recorder:(FBLoggingWrapperRecorder *)recorder
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _commands = commands;
+  _recorder = recorder;
+
+  return self;
+}
+
+#pragma mark FBApplicationCommands
+
+- (FBFuture<FBInstalledApplication *> *)installApplicationWithPath:(NSString *)path
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands installApplicationWithPath:path], path);
+}
+
+- (FBFuture<NSNull *> *)uninstallApplicationWithBundleID:(NSString *)bundleID
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands uninstallApplicationWithBundleID:bundleID], bundleID);
+}
+
+- (FBFuture<id<FBLaunchedApplication>> *)launchApplication:(FBApplicationLaunchConfiguration *)configuration
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands launchApplication:configuration], configuration);
+}
+
+- (FBFuture<NSNull *> *)killApplicationWithBundleID:(NSString *)bundleID
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands killApplicationWithBundleID:bundleID], bundleID);
+}
+
+- (FBFuture<NSArray<FBInstalledApplication *> *> *)installedApplications
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands installedApplications]);
+}
+
+- (FBFuture<FBInstalledApplication *> *)installedApplicationWithBundleID:(NSString *)bundleID
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands installedApplicationWithBundleID:bundleID], bundleID);
+}
+
+- (FBFuture<NSDictionary<NSString *, NSNumber *> *> *)runningApplications
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands runningApplications]);
+}
+
+- (FBFuture<NSNumber *> *)processIDWithBundleID:(NSString *)bundleID
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands processIDWithBundleID:bundleID], bundleID);
+}
+
+@end
+
+@interface FBFileCommandsLoggingWrapper ()
+
+@property (nonatomic, strong, readonly) id<FBFileCommands> commands;
+@property (nonatomic, strong, readonly) FBLoggingWrapperRecorder *recorder;
+
+@end
+
+@implementation FBFileCommandsLoggingWrapper
+
+#pragma mark Initializers
+
++ (instancetype)commandsWithTarget:(id<FBiOSTarget>)target
+{
+  FBLoggingWrapperRecorder *recorder = [FBLoggingWrapperRecorder recorderWithSimplifiedNaming:NO eventReporter:nil logger:target.logger];
+  return [self wrap:(id<FBFileCommands>) target recorder:recorder];
+}
+
++ (instancetype)wrap:(id<FBFileCommands>)commands recorder:(FBLoggingWrapperRecorder *)recorder
+{
+  return [[self alloc] initWithCommands:commands recorder:recorder];
+}
+
+- (instancetype)initWithCommands:(id<FBFileCommands>)commands recorder:(FBLoggingWrapperRecorder *)recorder
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _commands = commands;
+  _recorder = recorder;
+
+  return self;
+}
+
+#pragma mark FBFileCommands
+
+- (FBFutureContext<id<FBFileContainer>> *)fileCommandsForContainerApplication:(NSString *)bundleID
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands fileCommandsForContainerApplication:bundleID], bundleID);
+}
+
+- (FBFutureContext<id<FBFileContainer>> *)fileCommandsForAuxillary
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands fileCommandsForAuxillary]);
+}
+
+- (FBFutureContext<id<FBFileContainer>> *)fileCommandsForApplicationContainers
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands fileCommandsForApplicationContainers]);
+}
+
+- (FBFutureContext<id<FBFileContainer>> *)fileCommandsForGroupContainers
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands fileCommandsForGroupContainers]);
+}
+
+- (FBFutureContext<id<FBFileContainer>> *)fileCommandsForRootFilesystem
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands fileCommandsForRootFilesystem]);
+}
+
+- (FBFutureContext<id<FBFileContainer>> *)fileCommandsForMediaDirectory
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands fileCommandsForMediaDirectory]);
+}
+
+- (FBFutureContext<id<FBFileContainer>> *)fileCommandsForProvisioningProfiles
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands fileCommandsForProvisioningProfiles]);
+}
+
+- (FBFutureContext<id<FBFileContainer>> *)fileCommandsForMDMProfiles
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands fileCommandsForMDMProfiles]);
+}
+
+- (FBFutureContext<id<FBFileContainer>> *)fileCommandsForSpringboardIconLayout
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands fileCommandsForSpringboardIconLayout]);
+}
+
+- (FBFutureContext<id<FBFileContainer>> *)fileCommandsForWallpaper
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands fileCommandsForWallpaper]);
+}
+
+- (FBFutureContext<id<FBFileContainer>> *)fileCommandsForDiskImages
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands fileCommandsForDiskImages]);
+}
+
+- (FBFutureContext<id<FBFileContainer>> *)fileCommandsForSymbols
+{
+  return FBLoggingWrapperRecordCall(self.recorder, [self.commands fileCommandsForSymbols]);
+}
+
+@end
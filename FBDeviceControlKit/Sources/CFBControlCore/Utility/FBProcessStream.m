@@ -7,6 +7,7 @@
 
 #import "FBProcessStream.h"
 
+#import <fcntl.h>
 #import <sys/types.h>
 #import <sys/stat.h>
 
@@ -263,11 +264,19 @@ static NSTimeInterval ProcessDetachDrainTimeout = 4;
 
 @end
 
-@interface FBProcessOutput_Null : FBProcessOutput
+@interface FBProcessOutput_Null : FBProcessOutput <FBProcessStreamDirectAttachment>
 
 @end
 
-@interface FBProcessOutput_FilePath : FBProcessOutput
+@interface FBProcessOutput_FileDescriptor : FBProcessOutput <FBProcessStreamDirectAttachment>
+
+@property (nonatomic, assign, readonly) int fileDescriptor;
+
+- (instancetype)initWithFileDescriptor:(int)fileDescriptor;
+
+@end
+
+@interface FBProcessOutput_FilePath : FBProcessOutput <FBProcessStreamDirectAttachment>
 
 @property (nonatomic, copy, readonly) NSString *filePath;
 @property (nonatomic, assign, readwrite) int fileDescriptor;
@@ -301,13 +310,36 @@ static NSTimeInterval ProcessDetachDrainTimeout = 4;
 
 @end
 
+@interface FBProcessOutput_Reader : FBProcessOutput_Pipe
+
+@property (nonatomic, strong, readonly) FBProcessOutputReader *reader;
+
+@end
+
+@interface FBProcessOutputReader ()
+
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *attached;
+@property (nonatomic, assign, readwrite) int fileDescriptor;
+@property (nonatomic, strong, nullable, readwrite) dispatch_source_t readSource;
+@property (nonatomic, assign, readwrite) BOOL readSourceResumed;
+@property (nonatomic, strong, nullable, readwrite) FBMutableFuture<dispatch_data_t> *pendingRead;
+@property (nonatomic, assign, readwrite) size_t pendingLength;
+@property (atomic, assign, readwrite) uint64_t bytesRead;
+
+- (void)attachToFileDescriptor:(int)fileDescriptor;
+
+@end
+
 @interface FBProcessOutput_Consumer : FBProcessOutput_Pipe
 
 @property (nonatomic, strong, readwrite) id<FBDataConsumer> consumer;
 @property (nonatomic, strong, nullable, readwrite) FBFileReader *reader;
 @property (nonatomic, strong, nullable, readwrite) id<FBControlCoreLogger> logger;
+@property (nonatomic, copy, readonly) FBFileReaderConfiguration *readerConfiguration;
 
 - (instancetype)initWithConsumer:(id<FBDataConsumer>)consumer logger:(nullable id<FBControlCoreLogger>)logger;
+- (instancetype)initWithConsumer:(id<FBDataConsumer>)consumer readerConfiguration:(FBFileReaderConfiguration *)readerConfiguration logger:(nullable id<FBControlCoreLogger>)logger;
 
 @end
 
@@ -348,11 +380,21 @@ static NSTimeInterval ProcessDetachDrainTimeout = 4;
   return [[FBProcessOutput_FilePath alloc] initWithFilePath:filePath];
 }
 
++ (FBProcessOutput<NSNumber *> *)outputForFileDescriptor:(int)fileDescriptor
+{
+  return [[FBProcessOutput_FileDescriptor alloc] initWithFileDescriptor:fileDescriptor];
+}
+
 + (FBProcessOutput<NSInputStream *> *)outputToInputStream
 {
   return [[FBProcessOutput_InputStream alloc] init];
 }
 
++ (FBProcessOutput<FBProcessOutputReader *> *)outputToReader
+{
+  return [[FBProcessOutput_Reader alloc] init];
+}
+
 + (FBProcessOutput<id<FBDataConsumer>> *)outputForDataConsumer:(id<FBDataConsumer>)dataConsumer logger:(id<FBControlCoreLogger>)logger
 {
   return [[FBProcessOutput_Consumer alloc] initWithConsumer:dataConsumer logger:logger];
@@ -363,6 +405,11 @@ static NSTimeInterval ProcessDetachDrainTimeout = 4;
   return [[FBProcessOutput_Consumer alloc] initWithConsumer:dataConsumer logger:nil];
 }
 
++ (FBProcessOutput<id<FBDataConsumer>> *)outputForDataConsumer:(id<FBDataConsumer>)dataConsumer readerConfiguration:(FBFileReaderConfiguration *)readerConfiguration logger:(nullable id<FBControlCoreLogger>)logger
+{
+  return [[FBProcessOutput_Consumer alloc] initWithConsumer:dataConsumer readerConfiguration:readerConfiguration logger:logger];
+}
+
 + (FBProcessOutput<id<FBControlCoreLogger>> *)outputForLogger:(id<FBControlCoreLogger>)logger
 {
   return [[FBProcessOutput_Logger alloc] initWithLogger:logger];
@@ -378,6 +425,13 @@ static NSTimeInterval ProcessDetachDrainTimeout = 4;
   return [[FBProcessOutput_String alloc] initWithMutableData:data];
 }
 
++ (FBProcessOutput<id<FBBoundedBuffer>> *)outputToBoundedBufferWithHeadCapacity:(size_t)headCapacity tailCapacity:(size_t)tailCapacity spillToTemporaryFile:(BOOL)spillToTemporaryFile
+{
+  id<FBBoundedBuffer> buffer = [FBDataBuffer boundedBufferWithHeadCapacity:headCapacity tailCapacity:tailCapacity spillToTemporaryFile:spillToTemporaryFile];
+  // As with accumulated output, this is mostly used in full, so is read in large batches.
+  return (FBProcessOutput<id<FBBoundedBuffer>> *) [self outputForDataConsumer:buffer readerConfiguration:FBFileReaderConfiguration.throughputConfiguration logger:nil];
+}
+
 - (instancetype)init
 {
   return [self initWithWorkQueue:FBProcessOutput.createWorkQueue];
@@ -467,6 +521,18 @@ static NSTimeInterval ProcessDetachDrainTimeout = 4;
   return NSNull.null;
 }
 
+#pragma mark FBProcessStreamDirectAttachment
+
+- (int)directFileDescriptor
+{
+  return -1;
+}
+
+- (NSString *)directFilePath
+{
+  return @"/dev/null";
+}
+
 #pragma mark FBProcessOutput Implementation
 
 - (FBFuture<id<FBProcessFileOutput>> *)providedThroughFile
@@ -488,6 +554,71 @@ static NSTimeInterval ProcessDetachDrainTimeout = 4;
 
 @end
 
+@implementation FBProcessOutput_FileDescriptor
+
+- (instancetype)initWithFileDescriptor:(int)fileDescriptor
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _fileDescriptor = fileDescriptor;
+
+  return self;
+}
+
+#pragma mark FBStandardStream
+
+- (FBFuture<FBProcessStreamAttachment *> *)attach
+{
+  // The file descriptor belongs to the caller, so is not closed.
+  return [FBFuture futureWithResult:[[FBProcessStreamAttachment alloc] initWithFileDescriptor:self.fileDescriptor closeOnEndOfFile:NO mode:FBProcessStreamAttachmentModeOutput]];
+}
+
+- (FBFuture<NSNull *> *)detach
+{
+  return FBFuture.empty;
+}
+
+- (NSNumber *)contents
+{
+  return @(self.fileDescriptor);
+}
+
+#pragma mark FBProcessStreamDirectAttachment
+
+- (int)directFileDescriptor
+{
+  return self.fileDescriptor;
+}
+
+- (NSString *)directFilePath
+{
+  return nil;
+}
+
+#pragma mark FBProcessOutput Implementation
+
+- (FBFuture<id<FBProcessFileOutput>> *)providedThroughFile
+{
+  return [FBFuture futureWithResult:[[FBProcessFileOutput_DirectToFile alloc] initWithFilePath:[NSString stringWithFormat:@"/dev/fd/%d", self.fileDescriptor]]];
+}
+
+- (FBFuture<id<FBDataConsumer>> *)providedThroughConsumer
+{
+  return [FBFuture futureWithResult:[FBFileWriter syncWriterWithFileDescriptor:self.fileDescriptor closeOnEndOfFile:NO]];
+}
+
+#pragma mark NSObject
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"Output to file descriptor %d", self.fileDescriptor];
+}
+
+@end
+
 @implementation FBProcessOutput_Pipe
 
 #pragma mark FBStandardStream
@@ -635,11 +766,211 @@ static NSTimeInterval ProcessDetachDrainTimeout = 4;
 
 @end
 
+@implementation FBProcessOutput_Reader
+
+- (instancetype)init
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _reader = [[FBProcessOutputReader alloc] init];
+
+  return self;
+}
+
+#pragma mark FBStandardStream
+
+- (FBProcessOutputReader *)contents
+{
+  return self.reader;
+}
+
+- (FBFuture<FBProcessStreamAttachment *> *)attach
+{
+  return [[super
+    attach]
+    onQueue:self.workQueue map:^(FBProcessStreamAttachment *result) {
+      // The reader owns the read end from here, closing it at the end of the output.
+      [self.reader attachToFileDescriptor:self.readEnd];
+      return result;
+    }];
+}
+
+- (FBFuture<NSNull *> *)detach
+{
+  return [[self
+    closeWriteEndOfPipe]
+    nameFormat:@"Detach %@", self];
+}
+
+#pragma mark NSObject
+
+- (NSString *)description
+{
+  return @"Output to reader";
+}
+
+@end
+
+@implementation FBProcessOutputReader
+
+- (instancetype)init
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _queue = dispatch_queue_create("com.facebook.fbcontrolcore.process_output_reader", DISPATCH_QUEUE_SERIAL);
+  _attached = FBMutableFuture.future;
+  _fileDescriptor = -1;
+
+  return self;
+}
+
+- (void)dealloc
+{
+  // A suspended source can't be released, so is resumed in order to cancel it.
+  dispatch_source_t readSource = _readSource;
+  if (readSource) {
+    dispatch_source_cancel(readSource);
+    if (!_readSourceResumed) {
+      dispatch_resume(readSource);
+    }
+  }
+}
+
+#pragma mark Public Methods
+
+- (FBFuture<dispatch_data_t> *)readWithMaximumLength:(size_t)maximumLength
+{
+  return [self.attached
+    onQueue:self.queue fmap:^ FBFuture<dispatch_data_t> * (id _) {
+      if (self.pendingRead) {
+        return [[FBControlCoreError
+          describe:@"Cannot read whilst another read is outstanding"]
+          failFuture];
+      }
+      if (self.fileDescriptor == -1) {
+        return [FBFuture futureWithResult:dispatch_data_empty];
+      }
+      FBMutableFuture<dispatch_data_t> *read = FBMutableFuture.future;
+      self.pendingRead = read;
+      self.pendingLength = MAX(maximumLength, (size_t) 1);
+      [self performPendingRead];
+      return read;
+    }];
+}
+
+- (void)close
+{
+  dispatch_async(self.queue, ^{
+    [self closeFileDescriptor];
+    [self completePendingReadWithData:dispatch_data_empty error:nil];
+  });
+}
+
+#pragma mark Private
+
+- (void)attachToFileDescriptor:(int)fileDescriptor
+{
+  dispatch_async(self.queue, ^{
+    // Reads are attempted directly, the source only wakes a read that found the pipe empty.
+    fcntl(fileDescriptor, F_SETFL, fcntl(fileDescriptor, F_GETFL) | O_NONBLOCK);
+    self.fileDescriptor = fileDescriptor;
+    dispatch_source_t readSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, (uintptr_t) fileDescriptor, 0, self.queue);
+    __weak typeof(self) weakSelf = self;
+    dispatch_source_set_event_handler(readSource, ^{
+      __strong typeof(self) strongSelf = weakSelf;
+      if (!strongSelf || !strongSelf.readSource) {
+        return;
+      }
+      dispatch_suspend(strongSelf.readSource);
+      strongSelf.readSourceResumed = NO;
+      [strongSelf performPendingRead];
+    });
+    dispatch_source_set_cancel_handler(readSource, ^{
+      close(fileDescriptor);
+    });
+    self.readSource = readSource;
+    self.readSourceResumed = NO;
+    [self.attached resolveWithResult:NSNull.null];
+  });
+}
+
+- (void)performPendingRead
+{
+  if (!self.pendingRead || self.fileDescriptor == -1) {
+    return;
+  }
+  size_t length = self.pendingLength;
+  void *buffer = malloc(length);
+  ssize_t result = read(self.fileDescriptor, buffer, length);
+  if (result > 0) {
+    if ((size_t) result < length / 2) {
+      buffer = realloc(buffer, (size_t) result);
+    }
+    self.bytesRead += (uint64_t) result;
+    [self completePendingReadWithData:dispatch_data_create(buffer, (size_t) result, NULL, DISPATCH_DATA_DESTRUCTOR_FREE) error:nil];
+    return;
+  }
+  free(buffer);
+  if (result == -1 && (errno == EAGAIN || errno == EINTR)) {
+    if (!self.readSourceResumed) {
+      self.readSourceResumed = YES;
+      dispatch_resume(self.readSource);
+    }
+    return;
+  }
+  NSError *error = result == 0 ? nil : [[FBControlCoreError describeFormat:@"Failed to read process output: %s", strerror(errno)] build];
+  [self closeFileDescriptor];
+  [self completePendingReadWithData:dispatch_data_empty error:error];
+}
+
+- (void)completePendingReadWithData:(dispatch_data_t)data error:(nullable NSError *)error
+{
+  FBMutableFuture<dispatch_data_t> *read = self.pendingRead;
+  if (!read) {
+    return;
+  }
+  self.pendingRead = nil;
+  if (error) {
+    [read resolveWithError:error];
+  } else {
+    [read resolveWithResult:data];
+  }
+}
+
+- (void)closeFileDescriptor
+{
+  dispatch_source_t readSource = self.readSource;
+  if (!readSource) {
+    return;
+  }
+  // The cancel handler closes the file descriptor, once the source has been resumed.
+  self.readSource = nil;
+  self.fileDescriptor = -1;
+  dispatch_source_cancel(readSource);
+  if (!self.readSourceResumed) {
+    dispatch_resume(readSource);
+  }
+  self.readSourceResumed = NO;
+}
+
+@end
+
 @implementation FBProcessOutput_Consumer
 
 #pragma mark Initializers
 
 - (instancetype)initWithConsumer:(id<FBDataConsumer>)consumer logger:(nullable id<FBControlCoreLogger>)logger
+{
+  return [self initWithConsumer:consumer readerConfiguration:FBFileReaderConfiguration.defaultConfiguration logger:logger];
+}
+
+- (instancetype)initWithConsumer:(id<FBDataConsumer>)consumer readerConfiguration:(FBFileReaderConfiguration *)readerConfiguration logger:(nullable id<FBControlCoreLogger>)logger
 {
   self = [super init];
   if (!self) {
@@ -647,6 +978,7 @@ static NSTimeInterval ProcessDetachDrainTimeout = 4;
   }
 
   _consumer = consumer;
+  _readerConfiguration = [readerConfiguration copy];
   _logger = logger;
 
   return self;
@@ -677,7 +1009,7 @@ static NSTimeInterval ProcessDetachDrainTimeout = 4;
       }
 
       // FBProcessOuput consumes the read end, the write end is passed out in the attachment.
-      self.reader = [FBFileReader readerWithFileDescriptor:self.readEnd closeOnEndOfFile:YES consumer:consumer logger:self.logger];
+      self.reader = [FBFileReader readerWithFileDescriptor:self.readEnd closeOnEndOfFile:YES consumer:consumer configuration:self.readerConfiguration logger:self.logger];
       return [[[self.reader
         startReading]
         mapReplace:attachment]
@@ -745,7 +1077,8 @@ static NSTimeInterval ProcessDetachDrainTimeout = 4;
 - (instancetype)initWithLogger:(id<FBControlCoreLogger>)logger
 {
   id<FBDataConsumer> consumer = [FBLoggingDataConsumer consumerWithLogger:logger];
-  self = [super initWithConsumer:consumer logger:logger];
+  // Logged output is read by people as it happens, so is delivered promptly.
+  self = [super initWithConsumer:consumer readerConfiguration:FBFileReaderConfiguration.latencyConfiguration logger:logger];
   if (!self) {
     return nil;
   }
@@ -832,6 +1165,18 @@ static NSTimeInterval ProcessDetachDrainTimeout = 4;
   return self.filePath;
 }
 
+#pragma mark FBProcessStreamDirectAttachment
+
+- (int)directFileDescriptor
+{
+  return -1;
+}
+
+- (NSString *)directFilePath
+{
+  return self.filePath;
+}
+
 #pragma mark FBProcessOutput Implementation
 
 - (FBFuture<id<FBProcessFileOutput>> *)providedThroughFile
@@ -860,7 +1205,8 @@ static NSTimeInterval ProcessDetachDrainTimeout = 4;
 - (instancetype)initWithMutableData:(NSMutableData *)mutableData
 {
   id<FBAccumulatingBuffer> consumer = [FBDataBuffer accumulatingBufferForMutableData:mutableData];
-  self = [super initWithConsumer:consumer logger:nil];
+  // Accumulated output is mostly used in full, so is read in large batches.
+  self = [super initWithConsumer:consumer readerConfiguration:FBFileReaderConfiguration.throughputConfiguration logger:nil];
   if (!self) {
     return nil;
   }
@@ -0,0 +1,443 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBScrcpyDemuxer.h"
+
+#import <libkern/OSByteOrder.h>
+
+// The sizes of the fields of the scrcpy protocol that precede the packets of the stream.
+static const size_t DeviceMetaSize = 64;
+static const size_t CodecMetaSize = 12;
+static const size_t FrameHeaderSize = 12;
+// The flags in the top bits of the PTS of a frame header, as in scrcpy's demuxer.c.
+static const uint64_t ConfigPacketFlag = 1ULL << 63;
+static const uint64_t KeyFrameFlag = 1ULL << 62;
+static const uint64_t PresentationTimeMask = KeyFrameFlag - 1;
+// The bytes at the end of a raw stream that may be the start of a start code that is split across reads.
+static const size_t StartCodeOverlap = 3;
+// The length prefix of each NAL unit in AVCC form, matching the NALUnitHeaderLength of the format descriptions.
+static const size_t AVCCLengthSize = 4;
+
+typedef NS_ENUM(NSUInteger, FBScrcpyDemuxerState) {
+  FBScrcpyDemuxerStateDummyByte = 0,
+  FBScrcpyDemuxerStateDeviceMeta = 1,
+  FBScrcpyDemuxerStateCodecMeta = 2,
+  FBScrcpyDemuxerStateFrameHeader = 3,
+  FBScrcpyDemuxerStateFrameData = 4,
+  FBScrcpyDemuxerStateRawStream = 5,
+};
+
+typedef void (*NALUnitCallback)(FBScrcpyNALUnit unit, void *context);
+typedef void (*PacketCallback)(FBScrcpyPacket packet, void *context);
+
+// The callbacks of a single call to consume bytes. The packet callback is optional.
+typedef struct {
+  NALUnitCallback unit;
+  PacketCallback packet;
+  void *context;
+} DemuxerCallbacks;
+
+/**
+ The state of a demuxer, kept as a plain struct so that the per-byte work has no Objective-C dispatch.
+ The buffer only holds the bytes of a unit that spans reads: a field or packet in framed mode, the current NAL unit in raw stream mode.
+ */
+typedef struct {
+  FBScrcpyDemuxerState state;
+  uint8_t *buffer;
+  size_t capacity;
+  // The buffered bytes are at [start, start + length). The start only advances in raw stream mode, the bytes are moved down once there is no room to append.
+  size_t start;
+  size_t length;
+  // Raw stream mode: whether the buffer begins with a NAL unit, and the offset from which to resume the search for the start code that ends it.
+  BOOL inUnit;
+  size_t scanOffset;
+  // The frame header of the packet being parsed.
+  uint64_t pts;
+  uint32_t packetSize;
+  // The metadata. The device name is the whole of the device metadata, with room for a terminator.
+  char deviceName[64 + 1];
+  BOOL hasDeviceMeta;
+  BOOL hasCodecMeta;
+  uint32_t codecIdentifier;
+  uint32_t width;
+  uint32_t height;
+} DemuxerState;
+
+size_t FBScrcpyFindStartCode(const uint8_t *bytes, size_t length, size_t *startCodeLength)
+{
+  size_t offset = 0;
+  while (length >= 3 && offset <= length - 3) {
+    // memchr is vectorized, so runs of non-zero slice data are skipped many bytes at a time.
+    const uint8_t *zero = memchr(bytes + offset, 0, length - 2 - offset);
+    if (!zero) {
+      break;
+    }
+    offset = (size_t) (zero - bytes);
+    if (bytes[offset + 1] != 0) {
+      // No code starts at this zero, or at the non-zero byte after it.
+      offset += 2;
+      continue;
+    }
+    if (bytes[offset + 2] == 1) {
+      *startCodeLength = 3;
+      return offset;
+    }
+    if (bytes[offset + 2] == 0 && offset + 3 < length && bytes[offset + 3] == 1) {
+      *startCodeLength = 4;
+      return offset;
+    }
+    offset += 1;
+  }
+  return length;
+}
+
+// Whether a NAL unit is a slice of a picture, rather than a parameter set or other non-VCL unit.
+static BOOL IsVideoCodingLayerUnit(uint8_t header, CMVideoCodecType codec, BOOL *isKeyFrame)
+{
+  if (codec == kCMVideoCodecType_HEVC) {
+    uint8_t type = (header >> 1) & 0x3f;
+    // BLA, IDR & CRA pictures are the IRAP types 16-21.
+    *isKeyFrame = type >= 16 && type <= 21;
+    return type <= 31;
+  }
+  uint8_t type = header & 0x1f;
+  *isKeyFrame = type == 5;
+  return type >= 1 && type <= 5;
+}
+
+CMBlockBufferRef FBScrcpyCreateAVCCBlockBuffer(const uint8_t *bytes, size_t length, CMVideoCodecType codec, BOOL *containsKeyFrame)
+{
+  if (containsKeyFrame) {
+    *containsKeyFrame = NO;
+  }
+  // Each unit is at least one byte after a start code of at least three, so a length prefix adds at most a quarter to the packet.
+  size_t capacity = length + length / 4 + AVCCLengthSize;
+  uint8_t *memory = CFAllocatorAllocate(kCFAllocatorDefault, (CFIndex) capacity, 0);
+  if (!memory) {
+    return NULL;
+  }
+  size_t written = 0;
+  size_t startCodeLength = 0;
+  size_t offset = FBScrcpyFindStartCode(bytes, length, &startCodeLength);
+  while (offset < length) {
+    size_t unitStart = offset + startCodeLength;
+    size_t nextStartCodeLength = 0;
+    size_t unitEnd = unitStart + FBScrcpyFindStartCode(bytes + unitStart, length - unitStart, &nextStartCodeLength);
+    BOOL isKeyFrame = NO;
+    if (unitEnd > unitStart && IsVideoCodingLayerUnit(bytes[unitStart], codec, &isKeyFrame)) {
+      size_t unitLength = unitEnd - unitStart;
+      OSWriteBigInt32(memory, written, (uint32_t) unitLength);
+      memcpy(memory + written + AVCCLengthSize, bytes + unitStart, unitLength);
+      written += AVCCLengthSize + unitLength;
+      if (containsKeyFrame && isKeyFrame) {
+        *containsKeyFrame = YES;
+      }
+    }
+    offset = unitEnd;
+    startCodeLength = nextStartCodeLength;
+  }
+  if (written == 0) {
+    CFAllocatorDeallocate(kCFAllocatorDefault, memory);
+    return NULL;
+  }
+  // The block buffer takes ownership of the memory, freeing it with the same allocator.
+  CMBlockBufferRef blockBuffer = NULL;
+  OSStatus status = CMBlockBufferCreateWithMemoryBlock(kCFAllocatorDefault, memory, capacity, kCFAllocatorDefault, NULL, 0, written, 0, &blockBuffer);
+  if (status != kCMBlockBufferNoErr) {
+    CFAllocatorDeallocate(kCFAllocatorDefault, memory);
+    return NULL;
+  }
+  return blockBuffer;
+}
+
+static void DemuxerAppend(DemuxerState *demuxer, const uint8_t *bytes, size_t length)
+{
+  if (demuxer->start + demuxer->length + length > demuxer->capacity) {
+    if (demuxer->start > 0) {
+      memmove(demuxer->buffer, demuxer->buffer + demuxer->start, demuxer->length);
+      demuxer->start = 0;
+    }
+    if (demuxer->length + length > demuxer->capacity) {
+      size_t capacity = MAX(demuxer->capacity * 2, demuxer->length + length);
+      demuxer->buffer = reallocf(demuxer->buffer, capacity);
+      demuxer->capacity = demuxer->buffer ? capacity : 0;
+      if (!demuxer->buffer) {
+        demuxer->length = 0;
+        return;
+      }
+    }
+  }
+  memcpy(demuxer->buffer + demuxer->start + demuxer->length, bytes, length);
+  demuxer->length += length;
+}
+
+static void DemuxerEmitPacket(DemuxerState *demuxer, const uint8_t *bytes, size_t length, const DemuxerCallbacks *callbacks)
+{
+  FBScrcpyNALUnit unit = {
+    .presentationTimeMicroseconds = demuxer->pts & PresentationTimeMask,
+    .hasFrameHeader = YES,
+    .isKeyFrame = (demuxer->pts & KeyFrameFlag) != 0,
+    .isConfigPacket = (demuxer->pts & ConfigPacketFlag) != 0,
+  };
+  size_t startCodeLength = 0;
+  size_t offset = FBScrcpyFindStartCode(bytes, length, &startCodeLength);
+  while (offset < length) {
+    size_t unitStart = offset + startCodeLength;
+    size_t nextStartCodeLength = 0;
+    size_t unitEnd = unitStart + FBScrcpyFindStartCode(bytes + unitStart, length - unitStart, &nextStartCodeLength);
+    if (unitEnd > unitStart) {
+      unit.bytes = bytes + unitStart;
+      unit.length = unitEnd - unitStart;
+      callbacks->unit(unit, callbacks->context);
+    }
+    offset = unitEnd;
+    startCodeLength = nextStartCodeLength;
+  }
+  if (callbacks->packet) {
+    FBScrcpyPacket packet = {
+      .bytes = bytes,
+      .length = length,
+      .presentationTimeMicroseconds = unit.presentationTimeMicroseconds,
+      .isKeyFrame = unit.isKeyFrame,
+      .isConfigPacket = unit.isConfigPacket,
+    };
+    callbacks->packet(packet, callbacks->context);
+  }
+}
+
+static size_t DemuxerFieldLength(const DemuxerState *demuxer)
+{
+  switch (demuxer->state) {
+    case FBScrcpyDemuxerStateDummyByte:
+      return 1;
+    case FBScrcpyDemuxerStateDeviceMeta:
+      return DeviceMetaSize;
+    case FBScrcpyDemuxerStateCodecMeta:
+      return CodecMetaSize;
+    case FBScrcpyDemuxerStateFrameHeader:
+      return FrameHeaderSize;
+    case FBScrcpyDemuxerStateFrameData:
+      return demuxer->packetSize;
+    case FBScrcpyDemuxerStateRawStream:
+    default:
+      return 0;
+  }
+}
+
+// Parses a complete field of the protocol, returning the number of bytes that it used.
+static size_t DemuxerParseField(DemuxerState *demuxer, const uint8_t *bytes, size_t length, const DemuxerCallbacks *callbacks)
+{
+  switch (demuxer->state) {
+    case FBScrcpyDemuxerStateDummyByte:
+      // The dummy byte is zero. If the server didn't send one, the byte is the start of the device metadata.
+      demuxer->state = FBScrcpyDemuxerStateDeviceMeta;
+      return bytes[0] == 0 ? 1 : 0;
+    case FBScrcpyDemuxerStateDeviceMeta:
+      memcpy(demuxer->deviceName, bytes, DeviceMetaSize);
+      demuxer->deviceName[DeviceMetaSize] = 0;
+      demuxer->hasDeviceMeta = YES;
+      demuxer->state = FBScrcpyDemuxerStateCodecMeta;
+      return DeviceMetaSize;
+    case FBScrcpyDemuxerStateCodecMeta:
+      demuxer->codecIdentifier = OSReadBigInt32(bytes, 0);
+      demuxer->width = OSReadBigInt32(bytes, 4);
+      demuxer->height = OSReadBigInt32(bytes, 8);
+      demuxer->hasCodecMeta = YES;
+      demuxer->state = FBScrcpyDemuxerStateFrameHeader;
+      return CodecMetaSize;
+    case FBScrcpyDemuxerStateFrameHeader:
+      demuxer->pts = OSReadBigInt64(bytes, 0);
+      demuxer->packetSize = OSReadBigInt32(bytes, 8);
+      demuxer->state = FBScrcpyDemuxerStateFrameData;
+      return FrameHeaderSize;
+    case FBScrcpyDemuxerStateFrameData:
+      DemuxerEmitPacket(demuxer, bytes, length, callbacks);
+      demuxer->state = FBScrcpyDemuxerStateFrameHeader;
+      return length;
+    case FBScrcpyDemuxerStateRawStream:
+    default:
+      return length;
+  }
+}
+
+static void DemuxerConsumeFramed(DemuxerState *demuxer, const uint8_t *bytes, size_t length, const DemuxerCallbacks *callbacks)
+{
+  while (length > 0) {
+    size_t fieldLength = DemuxerFieldLength(demuxer);
+    // A field that is wholly within the bytes is parsed in place, only a field that spans reads is buffered.
+    if (demuxer->length == 0 && length >= fieldLength) {
+      size_t used = DemuxerParseField(demuxer, bytes, fieldLength, callbacks);
+      bytes += used;
+      length -= used;
+      continue;
+    }
+    size_t appended = MIN(fieldLength - demuxer->length, length);
+    DemuxerAppend(demuxer, bytes, appended);
+    bytes += appended;
+    length -= appended;
+    if (demuxer->length < fieldLength) {
+      return;
+    }
+    DemuxerParseField(demuxer, demuxer->buffer, fieldLength, callbacks);
+    demuxer->length = 0;
+  }
+}
+
+static void DemuxerConsumeRawStream(DemuxerState *demuxer, const uint8_t *bytes, size_t length, const DemuxerCallbacks *callbacks)
+{
+  DemuxerAppend(demuxer, bytes, length);
+  FBScrcpyNALUnit unit = {0};
+  while (YES) {
+    const uint8_t *buffered = demuxer->buffer + demuxer->start;
+    size_t startCodeLength = 0;
+    size_t offset = FBScrcpyFindStartCode(buffered + demuxer->scanOffset, demuxer->length - demuxer->scanOffset, &startCodeLength) + demuxer->scanOffset;
+    if (offset == demuxer->length) {
+      // The search resumes before the end, in case a start code is split across reads.
+      size_t resume = demuxer->length > StartCodeOverlap ? demuxer->length - StartCodeOverlap : 0;
+      if (demuxer->inUnit) {
+        demuxer->scanOffset = resume;
+      } else {
+        // Bytes before the first start code are not part of any unit.
+        demuxer->start += resume;
+        demuxer->length -= resume;
+        demuxer->scanOffset = 0;
+      }
+      return;
+    }
+    if (demuxer->inUnit && offset > 0) {
+      unit.bytes = buffered;
+      unit.length = offset;
+      callbacks->unit(unit, callbacks->context);
+    }
+    demuxer->start += offset + startCodeLength;
+    demuxer->length -= offset + startCodeLength;
+    demuxer->scanOffset = 0;
+    demuxer->inUnit = YES;
+  }
+}
+
+static void DemuxerReset(DemuxerState *demuxer, FBScrcpyDemuxerMode mode)
+{
+  uint8_t *buffer = demuxer->buffer;
+  size_t capacity = demuxer->capacity;
+  memset(demuxer, 0, sizeof(DemuxerState));
+  // The buffer is kept, as it is sized for the largest packet of the stream.
+  demuxer->buffer = buffer;
+  demuxer->capacity = capacity;
+  demuxer->state = mode == FBScrcpyDemuxerModeRawStream ? FBScrcpyDemuxerStateRawStream : FBScrcpyDemuxerStateDummyByte;
+}
+
+// The handlers of a single call to consume bytes. They are only called within the call, so are not retained.
+typedef struct {
+  __unsafe_unretained FBScrcpyNALUnitHandler unitHandler;
+  __unsafe_unretained FBScrcpyPacketHandler packetHandler;
+} HandlerContext;
+
+static void CallUnitHandler(FBScrcpyNALUnit unit, void *context)
+{
+  ((HandlerContext *) context)->unitHandler(unit);
+}
+
+static void CallPacketHandler(FBScrcpyPacket packet, void *context)
+{
+  ((HandlerContext *) context)->packetHandler(packet);
+}
+
+@implementation FBScrcpyDemuxer
+{
+  DemuxerState _demuxer;
+}
+
+#pragma mark Initializers
+
+- (instancetype)initWithMode:(FBScrcpyDemuxerMode)mode
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _mode = mode;
+  DemuxerReset(&_demuxer, mode);
+
+  return self;
+}
+
+- (void)dealloc
+{
+  free(_demuxer.buffer);
+}
+
+#pragma mark Public Methods
+
+- (void)consumeBytes:(const void *)bytes length:(size_t)length handler:(NS_NOESCAPE FBScrcpyNALUnitHandler)handler
+{
+  [self consumeBytes:bytes length:length handler:handler packetHandler:nil];
+}
+
+- (void)consumeBytes:(const void *)bytes length:(size_t)length handler:(NS_NOESCAPE FBScrcpyNALUnitHandler)handler packetHandler:(NS_NOESCAPE nullable FBScrcpyPacketHandler)packetHandler
+{
+  if (length == 0) {
+    return;
+  }
+  HandlerContext context = {
+    .unitHandler = handler,
+    .packetHandler = packetHandler,
+  };
+  DemuxerCallbacks callbacks = {
+    .unit = CallUnitHandler,
+    .packet = packetHandler ? CallPacketHandler : NULL,
+    .context = &context,
+  };
+  if (self.mode == FBScrcpyDemuxerModeRawStream) {
+    DemuxerConsumeRawStream(&_demuxer, bytes, length, &callbacks);
+  } else {
+    DemuxerConsumeFramed(&_demuxer, bytes, length, &callbacks);
+  }
+}
+
+- (void)reset
+{
+  DemuxerReset(&_demuxer, self.mode);
+}
+
+#pragma mark Properties
+
+- (nullable NSString *)deviceName
+{
+  if (!_demuxer.hasDeviceMeta) {
+    return nil;
+  }
+  return [[NSString alloc] initWithUTF8String:_demuxer.deviceName] ?: @"";
+}
+
+- (BOOL)hasCodecMetadata
+{
+  return _demuxer.hasCodecMeta;
+}
+
+- (uint32_t)codecIdentifier
+{
+  return _demuxer.codecIdentifier;
+}
+
+- (uint32_t)width
+{
+  return _demuxer.width;
+}
+
+- (uint32_t)height
+{
+  return _demuxer.height;
+}
+
+- (size_t)bufferedByteCount
+{
+  return _demuxer.length;
+}
+
+@end
@@ -7,8 +7,18 @@
 
 #import "FBStorageUtils.h"
 
+#import <copyfile.h>
+#import <fcntl.h>
+#import <sys/clonefile.h>
+#import <sys/stat.h>
+
 #import "FBControlCoreError.h"
 
+// Files at least this large are copied in concurrent chunks when they can't be cloned.
+static const off_t ChunkedCopyThreshold = 64 * 1024 * 1024;
+// The size of each chunk of a chunked copy.
+static const size_t ChunkedCopyChunkSize = 8 * 1024 * 1024;
+
 @implementation FBStorageUtils
 
 #pragma mark Finding Files
@@ -97,4 +107,176 @@
   return [FBBundleDescriptor bundleFromPath:uniqueFile.path error:error];
 }
 
+#pragma mark Copying Files
+
++ (BOOL)cloneItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(NSError **)error
+{
+  // A directory is cloned in a single call, including everything within it.
+  if (clonefile(sourcePath.fileSystemRepresentation, destinationPath.fileSystemRepresentation, CLONE_NOFOLLOW) == 0) {
+    return YES;
+  }
+  int cloneError = errno;
+  // Only a filesystem that can't clone, or a copy across volumes, falls back to copying.
+  if (cloneError != ENOTSUP && cloneError != EXDEV) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to clone %@ to %@: %s", sourcePath, destinationPath, strerror(cloneError)]
+      failBool:error];
+  }
+  return [self concurrentlyCopyItemAtPath:sourcePath toPath:destinationPath error:error];
+}
+
+#pragma mark Private
+
++ (BOOL)concurrentlyCopyItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(NSError **)error
+{
+  struct stat sourceStat;
+  if (lstat(sourcePath.fileSystemRepresentation, &sourceStat) != 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to stat %@: %s", sourcePath, strerror(errno)]
+      failBool:error];
+  }
+  if (!S_ISDIR(sourceStat.st_mode)) {
+    return [self copyFileAtPath:sourcePath toPath:destinationPath size:sourceStat.st_size error:error];
+  }
+
+  // Directories are created up front, in order, so that the files can then be copied in any order.
+  NSMutableArray<NSString *> *files = NSMutableArray.array;
+  NSMutableArray<NSNumber *> *fileSizes = NSMutableArray.array;
+  if (mkdir(destinationPath.fileSystemRepresentation, sourceStat.st_mode & 07777) != 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to create directory %@: %s", destinationPath, strerror(errno)]
+      failBool:error];
+  }
+  NSDirectoryEnumerator<NSString *> *enumerator = [NSFileManager.defaultManager enumeratorAtPath:sourcePath];
+  for (NSString *relativePath in enumerator) {
+    NSString *type = enumerator.fileAttributes[NSFileType];
+    if ([type isEqualToString:NSFileTypeDirectory]) {
+      NSUInteger permissions = [enumerator.fileAttributes[NSFilePosixPermissions] unsignedIntegerValue];
+      NSString *directory = [destinationPath stringByAppendingPathComponent:relativePath];
+      if (mkdir(directory.fileSystemRepresentation, (mode_t) (permissions ?: 0755)) != 0) {
+        return [[FBControlCoreError
+          describeFormat:@"Failed to create directory %@: %s", directory, strerror(errno)]
+          failBool:error];
+      }
+      continue;
+    }
+    [files addObject:relativePath];
+    [fileSizes addObject:enumerator.fileAttributes[NSFileSize] ?: @0];
+  }
+
+  __block NSError *firstError = nil;
+  NSLock *errorLock = [NSLock new];
+  dispatch_apply(files.count, DISPATCH_APPLY_AUTO, ^(size_t index) {
+    NSError *innerError = nil;
+    NSString *relativePath = files[index];
+    NSString *source = [sourcePath stringByAppendingPathComponent:relativePath];
+    NSString *destination = [destinationPath stringByAppendingPathComponent:relativePath];
+    if (![self copyFileAtPath:source toPath:destination size:fileSizes[index].longLongValue error:&innerError]) {
+      [errorLock lock];
+      firstError = firstError ?: innerError;
+      [errorLock unlock];
+    }
+  });
+  if (firstError) {
+    if (error) {
+      *error = firstError;
+    }
+    return NO;
+  }
+  return YES;
+}
+
++ (BOOL)copyFileAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath size:(off_t)size error:(NSError **)error
+{
+  if (size < ChunkedCopyThreshold) {
+    // COPYFILE_NOFOLLOW copies a symbolic link as a link.
+    if (copyfile(sourcePath.fileSystemRepresentation, destinationPath.fileSystemRepresentation, NULL, COPYFILE_ALL | COPYFILE_NOFOLLOW | COPYFILE_EXCL) != 0) {
+      return [[FBControlCoreError
+        describeFormat:@"Failed to copy %@ to %@: %s", sourcePath, destinationPath, strerror(errno)]
+        failBool:error];
+    }
+    return YES;
+  }
+
+  int source = open(sourcePath.fileSystemRepresentation, O_RDONLY | O_NOFOLLOW);
+  if (source < 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to open %@: %s", sourcePath, strerror(errno)]
+      failBool:error];
+  }
+  int destination = open(destinationPath.fileSystemRepresentation, O_WRONLY | O_CREAT | O_EXCL, 0600);
+  if (destination < 0) {
+    close(source);
+    return [[FBControlCoreError
+      describeFormat:@"Failed to create %@: %s", destinationPath, strerror(errno)]
+      failBool:error];
+  }
+  __block int copyError = ftruncate(destination, size) == 0 ? 0 : errno;
+  if (copyError == 0) {
+    size_t chunkCount = (size_t) ((size + (off_t) ChunkedCopyChunkSize - 1) / (off_t) ChunkedCopyChunkSize);
+    NSLock *errorLock = [NSLock new];
+    dispatch_apply(chunkCount, DISPATCH_APPLY_AUTO, ^(size_t chunk) {
+      int chunkError = [self copyChunk:chunk from:source to:destination size:size];
+      if (chunkError != 0) {
+        [errorLock lock];
+        copyError = copyError ?: chunkError;
+        [errorLock unlock];
+      }
+    });
+  }
+  // Permissions, timestamps and extended attributes follow the data.
+  if (copyError == 0 && fcopyfile(source, destination, NULL, COPYFILE_METADATA) != 0) {
+    copyError = errno;
+  }
+  close(source);
+  close(destination);
+  if (copyError != 0) {
+    unlink(destinationPath.fileSystemRepresentation);
+    return [[FBControlCoreError
+      describeFormat:@"Failed to copy %@ to %@: %s", sourcePath, destinationPath, strerror(copyError)]
+      failBool:error];
+  }
+  return YES;
+}
+
++ (int)copyChunk:(size_t)chunk from:(int)source to:(int)destination size:(off_t)size
+{
+  off_t offset = (off_t) (chunk * ChunkedCopyChunkSize);
+  size_t remaining = (size_t) MIN((off_t) ChunkedCopyChunkSize, size - offset);
+  void *buffer = malloc(remaining);
+  if (!buffer) {
+    return ENOMEM;
+  }
+  int result = 0;
+  while (remaining > 0) {
+    ssize_t bytesRead = pread(source, buffer, remaining, offset);
+    if (bytesRead < 0 && errno == EINTR) {
+      continue;
+    }
+    if (bytesRead <= 0) {
+      result = bytesRead == 0 ? EIO : errno;
+      break;
+    }
+    size_t written = 0;
+    while (written < (size_t) bytesRead) {
+      ssize_t bytesWritten = pwrite(destination, (uint8_t *) buffer + written, (size_t) bytesRead - written, offset + (off_t) written);
+      if (bytesWritten < 0 && errno == EINTR) {
+        continue;
+      }
+      if (bytesWritten <= 0) {
+        result = errno ?: EIO;
+        break;
+      }
+      written += (size_t) bytesWritten;
+    }
+    if (result != 0) {
+      break;
+    }
+    offset += bytesRead;
+    remaining -= (size_t) bytesRead;
+  }
+  free(buffer);
+  return result;
+}
+
 @end
@@ -7,9 +7,40 @@
 
 #import "FBTemporaryDirectory.h"
 
+#import <sys/stat.h>
+
 #import "FBControlCoreError.h"
 #import "FBStorageUtils.h"
 
+/**
+ A staged copy of a source, shared by every context that has staged it.
+ */
+@interface FBTemporaryDirectory_StagedItem : NSObject
+
+@property (nonatomic, copy, readonly) NSURL *url;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSURL *> *staged;
+// Guarded by @synchronized on the staged items.
+@property (nonatomic, assign, readwrite) NSUInteger referenceCount;
+
+@end
+
+@implementation FBTemporaryDirectory_StagedItem
+
+- (instancetype)initWithURL:(NSURL *)url
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _url = url;
+  _staged = FBMutableFuture.future;
+
+  return self;
+}
+
+@end
+
 @interface FBTemporaryDirectory ()
 
 @property (nonatomic, copy, readonly) NSURL *rootTemporaryDirectory;
@@ -20,11 +51,7 @@
 
 + (instancetype)temporaryDirectoryWithLogger:(id<FBControlCoreLogger>)logger
 {
-  NSString *base = [NSProcessInfo.processInfo.environment objectForKey:@"TMPDIR"];
-  if (!base) {
-    base = NSTemporaryDirectory();
-  }
-  NSArray<NSString *> *tempPathComponents = @[base, @"IDB", [[NSUUID UUID] UUIDString]];
+  NSArray<NSString *> *tempPathComponents = @[self.baseDirectory, @"IDB", [[NSUUID UUID] UUIDString]];
   NSURL *temporaryDirectory = [NSURL fileURLWithPathComponents:tempPathComponents];
   NSError *error;
   BOOL success = [NSFileManager.defaultManager createDirectoryAtURL:temporaryDirectory withIntermediateDirectories:YES attributes:nil error:&error];
@@ -167,6 +194,58 @@
     }];
 }
 
+- (FBFutureContext<NSURL *> *)withStagedCopyOfItemAtPath:(NSString *)path
+{
+  struct stat sourceStat;
+  if (stat(path.fileSystemRepresentation, &sourceStat) != 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Cannot stage %@: %s", path, strerror(errno)]
+      failFutureContext];
+  }
+  NSString *key = [NSString stringWithFormat:@"%@:%lld:%ld.%ld", path.stringByStandardizingPath, (long long) sourceStat.st_size, (long) sourceStat.st_mtimespec.tv_sec, (long) sourceStat.st_mtimespec.tv_nsec];
+  NSMutableDictionary<NSString *, FBTemporaryDirectory_StagedItem *> *stagedItems = FBTemporaryDirectory.stagedItems;
+  FBTemporaryDirectory_StagedItem *item = nil;
+  BOOL created = NO;
+  @synchronized (stagedItems) {
+    item = stagedItems[key];
+    if (!item) {
+      NSURL *url = [[FBTemporaryDirectory.stagingDirectory URLByAppendingPathComponent:NSUUID.UUID.UUIDString] URLByAppendingPathComponent:path.lastPathComponent];
+      item = [[FBTemporaryDirectory_StagedItem alloc] initWithURL:url];
+      stagedItems[key] = item;
+      created = YES;
+    }
+    item.referenceCount += 1;
+  }
+  id<FBControlCoreLogger> logger = self.logger;
+  if (created) {
+    dispatch_async(self.queue, ^{
+      [logger logFormat:@"Staging %@ at %@", path, item.url];
+      NSError *error = nil;
+      BOOL success = [NSFileManager.defaultManager createDirectoryAtURL:item.url.URLByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:&error]
+        && [FBStorageUtils cloneItemAtPath:path toPath:item.url.path error:&error];
+      if (!success) {
+        // A failed stage is forgotten, so that staging the source again tries again.
+        @synchronized (stagedItems) {
+          if (stagedItems[key] == item) {
+            [stagedItems removeObjectForKey:key];
+          }
+        }
+        [NSFileManager.defaultManager removeItemAtURL:item.url.URLByDeletingLastPathComponent error:nil];
+        [item.staged resolveWithError:error];
+        return;
+      }
+      [item.staged resolveWithResult:item.url];
+    });
+  } else {
+    [logger logFormat:@"Reusing staged copy of %@ at %@", path, item.url];
+  }
+  return [item.staged
+    onQueue:self.queue contextualTeardown:^(id _, FBFutureState __) {
+      [FBTemporaryDirectory releaseStagedItem:item key:key logger:logger];
+      return FBFuture.empty;
+    }];
+}
+
 - (FBFutureContext<NSURL *> *)withTemporaryFileNamed:(NSString *)name
 {
   return [[[self
@@ -186,4 +265,46 @@
     }];
 }
 
+#pragma mark Private
+
++ (NSString *)baseDirectory
+{
+  return [NSProcessInfo.processInfo.environment objectForKey:@"TMPDIR"] ?: NSTemporaryDirectory();
+}
+
++ (NSURL *)stagingDirectory
+{
+  return [NSURL fileURLWithPathComponents:@[self.baseDirectory, @"IDB", @"Staging"]];
+}
+
++ (NSMutableDictionary<NSString *, FBTemporaryDirectory_StagedItem *> *)stagedItems
+{
+  static NSMutableDictionary<NSString *, FBTemporaryDirectory_StagedItem *> *stagedItems;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    stagedItems = [NSMutableDictionary dictionary];
+  });
+  return stagedItems;
+}
+
++ (void)releaseStagedItem:(FBTemporaryDirectory_StagedItem *)item key:(NSString *)key logger:(id<FBControlCoreLogger>)logger
+{
+  NSMutableDictionary<NSString *, FBTemporaryDirectory_StagedItem *> *stagedItems = self.stagedItems;
+  @synchronized (stagedItems) {
+    item.referenceCount -= 1;
+    if (item.referenceCount > 0) {
+      return;
+    }
+    if (stagedItems[key] == item) {
+      [stagedItems removeObjectForKey:key];
+    }
+  }
+  NSError *error = nil;
+  if ([NSFileManager.defaultManager removeItemAtURL:item.url.URLByDeletingLastPathComponent error:&error]) {
+    [logger logFormat:@"Removed staged copy %@", item.url];
+  } else {
+    [logger logFormat:@"Failed to remove staged copy %@: %@", item.url, error];
+  }
+}
+
 @end
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBTripleBuffer.h"
+
+#import <mach/mach_time.h>
+#import <stdatomic.h>
+
+// The state that is exchanged between the two sides: the index of the middle slot in the low bits, and whether it holds a value that has not been consumed.
+static const uint_fast8_t SlotIndexMask = 0x3;
+static const uint_fast8_t FreshFlag = 0x4;
+
+static uint64_t NanosecondsFromAbsoluteTime(uint64_t absoluteTime)
+{
+  static mach_timebase_info_data_t timebase;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    mach_timebase_info(&timebase);
+  });
+  return absoluteTime * timebase.numer / timebase.denom;
+}
+
+// Counts an interval in the statistics of one side. Only that side writes the counters, so relaxed loads and stores suffice. A reset from another thread may be lost to a concurrent update, which only affects the diagnostics.
+static void RecordInterval(atomic_uint_fast64_t *count, atomic_uint_fast64_t *total, atomic_uint_fast64_t *maximum, uint64_t lastTime, uint64_t now)
+{
+  uint64_t previousCount = atomic_load_explicit(count, memory_order_relaxed);
+  if (previousCount > 0) {
+    uint64_t interval = NanosecondsFromAbsoluteTime(now - lastTime);
+    atomic_fetch_add_explicit(total, interval, memory_order_relaxed);
+    if (interval > atomic_load_explicit(maximum, memory_order_relaxed)) {
+      atomic_store_explicit(maximum, interval, memory_order_relaxed);
+    }
+  }
+  atomic_store_explicit(count, previousCount + 1, memory_order_relaxed);
+}
+
+static double AverageMilliseconds(uint64_t total, uint64_t count)
+{
+  return count > 1 ? (double) total / (double) (count - 1) / NSEC_PER_MSEC : 0;
+}
+
+@implementation FBTripleBuffer
+{
+  id _slots[3];
+  atomic_uint_fast8_t _state;
+  // Owned by the producer.
+  uint_fast8_t _backIndex;
+  uint64_t _lastPublishTime;
+  uint64_t _consecutiveSkips;
+  // Owned by the consumer.
+  uint_fast8_t _frontIndex;
+  uint64_t _lastConsumeTime;
+  // Statistics, written by one side and read and reset from any thread.
+  atomic_uint_fast64_t _publishedCount;
+  atomic_uint_fast64_t _consumedCount;
+  atomic_uint_fast64_t _skippedCount;
+  atomic_uint_fast64_t _maxConsecutiveSkips;
+  atomic_uint_fast64_t _totalPublishInterval;
+  atomic_uint_fast64_t _maxPublishInterval;
+  atomic_uint_fast64_t _totalConsumeInterval;
+  atomic_uint_fast64_t _maxConsumeInterval;
+  atomic_uint_fast64_t _statisticsResetTime;
+}
+
+#pragma mark Initializers
+
+- (instancetype)init
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _frontIndex = 0;
+  _backIndex = 1;
+  atomic_init(&_state, 2);
+  atomic_init(&_statisticsResetTime, mach_absolute_time());
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (BOOL)publish:(id)value
+{
+  uint64_t now = mach_absolute_time();
+  RecordInterval(&_publishedCount, &_totalPublishInterval, &_maxPublishInterval, _lastPublishTime, now);
+  _lastPublishTime = now;
+
+  _slots[_backIndex] = value;
+  // Release the write of the slot to the consumer, and acquire the slot that the consumer last released.
+  uint_fast8_t previous = atomic_exchange_explicit(&_state, _backIndex | FreshFlag, memory_order_acq_rel);
+  _backIndex = previous & SlotIndexMask;
+
+  BOOL skipped = (previous & FreshFlag) != 0;
+  if (skipped) {
+    atomic_fetch_add_explicit(&_skippedCount, 1, memory_order_relaxed);
+    _consecutiveSkips += 1;
+    if (_consecutiveSkips > atomic_load_explicit(&_maxConsecutiveSkips, memory_order_relaxed)) {
+      atomic_store_explicit(&_maxConsecutiveSkips, _consecutiveSkips, memory_order_relaxed);
+    }
+  } else {
+    _consecutiveSkips = 0;
+  }
+  return skipped;
+}
+
+- (nullable id)consume
+{
+  if ((atomic_load_explicit(&_state, memory_order_relaxed) & FreshFlag) == 0) {
+    return nil;
+  }
+  uint_fast8_t previous = atomic_exchange_explicit(&_state, _frontIndex, memory_order_acq_rel);
+  _frontIndex = previous & SlotIndexMask;
+
+  uint64_t now = mach_absolute_time();
+  RecordInterval(&_consumedCount, &_totalConsumeInterval, &_maxConsumeInterval, _lastConsumeTime, now);
+  _lastConsumeTime = now;
+
+  return _slots[_frontIndex];
+}
+
+- (nullable id)peek
+{
+  return _slots[_frontIndex];
+}
+
+- (void)reset
+{
+  for (size_t index = 0; index < 3; index++) {
+    _slots[index] = nil;
+  }
+  _consecutiveSkips = 0;
+  atomic_store_explicit(&_state, atomic_load_explicit(&_state, memory_order_relaxed) & SlotIndexMask, memory_order_release);
+}
+
+- (FBTripleBufferStatistics)readAndResetStatistics
+{
+  uint64_t now = mach_absolute_time();
+  uint64_t publishedCount = atomic_exchange_explicit(&_publishedCount, 0, memory_order_relaxed);
+  uint64_t consumedCount = atomic_exchange_explicit(&_consumedCount, 0, memory_order_relaxed);
+  uint64_t totalPublishInterval = atomic_exchange_explicit(&_totalPublishInterval, 0, memory_order_relaxed);
+  uint64_t totalConsumeInterval = atomic_exchange_explicit(&_totalConsumeInterval, 0, memory_order_relaxed);
+  uint64_t resetTime = atomic_exchange_explicit(&_statisticsResetTime, now, memory_order_relaxed);
+
+  return (FBTripleBufferStatistics) {
+    .publishedCount = publishedCount,
+    .consumedCount = consumedCount,
+    .skippedCount = atomic_exchange_explicit(&_skippedCount, 0, memory_order_relaxed),
+    .maxConsecutiveSkips = atomic_exchange_explicit(&_maxConsecutiveSkips, 0, memory_order_relaxed),
+    .averagePublishInterval = AverageMilliseconds(totalPublishInterval, publishedCount),
+    .maxPublishInterval = (double) atomic_exchange_explicit(&_maxPublishInterval, 0, memory_order_relaxed) / NSEC_PER_MSEC,
+    .averageConsumeInterval = AverageMilliseconds(totalConsumeInterval, consumedCount),
+    .maxConsumeInterval = (double) atomic_exchange_explicit(&_maxConsumeInterval, 0, memory_order_relaxed) / NSEC_PER_MSEC,
+    .interval = (double) NanosecondsFromAbsoluteTime(now - resetTime) / NSEC_PER_SEC,
+  };
+}
+
+#pragma mark Properties
+
+- (BOOL)hasNewValue
+{
+  return (atomic_load_explicit(&_state, memory_order_relaxed) & FreshFlag) != 0;
+}
+
+- (uint64_t)publishedCount
+{
+  return atomic_load_explicit(&_publishedCount, memory_order_relaxed);
+}
+
+- (uint64_t)skippedCount
+{
+  return atomic_load_explicit(&_skippedCount, memory_order_relaxed);
+}
+
+@end
@@ -126,3 +126,223 @@
 }
 
 @end
+
+@interface FBVideoSampleFileWriter ()
+
+@property (nonatomic, strong, readonly) AVAssetWriter *writer;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *startFuture;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *finishFuture;
+@property (nonatomic, copy, readonly) NSString *filePath;
+
+@end
+
+@implementation FBVideoSampleFileWriter
+{
+  // Only accessed on the queue.
+  AVAssetWriterInput *_input;
+  BOOL _awaitingKeyFrame;
+  BOOL _finishing;
+  uint64_t _droppedSampleCount;
+}
+
+#pragma mark Initializers
+
++ (nullable instancetype)writerWithFilePath:(NSString *)filePath segmentDuration:(NSTimeInterval)segmentDuration logger:(id<FBControlCoreLogger>)logger error:(NSError **)error
+{
+  NSError *innerError = nil;
+  if ([NSFileManager.defaultManager fileExistsAtPath:filePath]) {
+    [logger logFormat:@"File already exists at %@, deleting", filePath];
+    if (![NSFileManager.defaultManager removeItemAtPath:filePath error:&innerError]) {
+      return [[[FBControlCoreError
+        describeFormat:@"Failed to remove existing video at %@", filePath]
+        causedBy:innerError]
+        fail:error];
+    }
+  }
+  if (![NSFileManager.defaultManager createDirectoryAtPath:filePath.stringByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:&innerError]) {
+    return [[[FBControlCoreError
+      describeFormat:@"Failed to create directory for video at %@", filePath]
+      causedBy:innerError]
+      fail:error];
+  }
+  AVFileType fileType = [filePath.pathExtension.lowercaseString isEqualToString:@"mov"] ? AVFileTypeQuickTimeMovie : AVFileTypeMPEG4;
+  AVAssetWriter *writer = [AVAssetWriter assetWriterWithURL:[NSURL fileURLWithPath:filePath] fileType:fileType error:&innerError];
+  if (!writer) {
+    return [[[FBControlCoreError
+      describeFormat:@"Failed to create asset writer for %@", filePath]
+      causedBy:innerError]
+      fail:error];
+  }
+  // Fragments are appended as the recording progresses, rather than writing a single movie header when it finishes, so an interrupted recording remains readable.
+  writer.movieFragmentInterval = CMTimeMakeWithSeconds(segmentDuration, 600);
+  writer.shouldOptimizeForNetworkUse = NO;
+
+  return [[self alloc] initWithWriter:writer filePath:filePath logger:logger];
+}
+
+- (instancetype)initWithWriter:(AVAssetWriter *)writer filePath:(NSString *)filePath logger:(id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _writer = writer;
+  _filePath = filePath;
+  _logger = logger;
+  _queue = dispatch_queue_create("com.facebook.fbcontrolcore.videosamplewriter", DISPATCH_QUEUE_SERIAL);
+  _startFuture = FBMutableFuture.future;
+  _finishFuture = FBMutableFuture.future;
+  _awaitingKeyFrame = YES;
+  _expectsMediaDataInRealTime = YES;
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (FBFuture<NSNull *> *)started
+{
+  return self.startFuture;
+}
+
+- (FBFuture<NSNull *> *)stopRecording
+{
+  dispatch_async(self.queue, ^{
+    [self finishWriting];
+  });
+  return self.finishFuture;
+}
+
+- (FBFuture<NSNull *> *)completed
+{
+  return self.finishFuture;
+}
+
+#pragma mark FBVideoSampleConsumer
+
+- (void)consumeSampleBuffer:(CMSampleBufferRef)sampleBuffer
+{
+  CFRetain(sampleBuffer);
+  dispatch_async(self.queue, ^{
+    [self appendSampleBuffer:sampleBuffer];
+    CFRelease(sampleBuffer);
+  });
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  // Frames are delivered as sample buffers, not bytes.
+}
+
+- (void)consumeEndOfFile
+{
+  [self stopRecording];
+}
+
+#pragma mark FBDataConsumerLifecycle
+
+- (FBFuture<NSNull *> *)finishedConsuming
+{
+  return self.finishFuture;
+}
+
+#pragma mark Private
+
+- (void)appendSampleBuffer:(CMSampleBufferRef)sampleBuffer
+{
+  if (_finishing) {
+    return;
+  }
+  BOOL isKeyFrame = FBVideoStreamSampleBufferIsKeyFrame(sampleBuffer);
+  if (_awaitingKeyFrame && !isKeyFrame) {
+    _droppedSampleCount += 1;
+    return;
+  }
+  if (!_input && ![self startWritingWithSampleBuffer:sampleBuffer]) {
+    return;
+  }
+  if (!self.expectsMediaDataInRealTime) {
+    // The samples are already buffered, so waiting for the input costs nothing but time.
+    while (!_input.readyForMoreMediaData && self.writer.status == AVAssetWriterStatusWriting) {
+      usleep(1000);
+    }
+  }
+  // A sample that is dropped breaks the dependencies of the samples after it, so nothing more is appended until the next key frame.
+  if (!_input.readyForMoreMediaData) {
+    if (!_awaitingKeyFrame) {
+      [self.logger logFormat:@"Asset writer for %@ is not ready, dropping samples until the next key frame", self.filePath];
+    }
+    _awaitingKeyFrame = YES;
+    _droppedSampleCount += 1;
+    return;
+  }
+  if (![_input appendSampleBuffer:sampleBuffer]) {
+    [self failWithError:self.writer.error];
+    return;
+  }
+  _awaitingKeyFrame = NO;
+}
+
+- (BOOL)startWritingWithSampleBuffer:(CMSampleBufferRef)sampleBuffer
+{
+  // Passing no output settings appends the samples as they are, the format hint describes them to the writer.
+  AVAssetWriterInput *input = [AVAssetWriterInput assetWriterInputWithMediaType:AVMediaTypeVideo outputSettings:nil sourceFormatHint:CMSampleBufferGetFormatDescription(sampleBuffer)];
+  input.expectsMediaDataInRealTime = self.expectsMediaDataInRealTime;
+  if (![self.writer canAddInput:input]) {
+    [self failWithError:[[FBControlCoreError describeFormat:@"Cannot add passthrough input to asset writer for %@", self.filePath] build]];
+    return NO;
+  }
+  [self.writer addInput:input];
+  if (![self.writer startWriting]) {
+    [self failWithError:self.writer.error];
+    return NO;
+  }
+  [self.writer startSessionAtSourceTime:CMSampleBufferGetPresentationTimeStamp(sampleBuffer)];
+  _input = input;
+  [self.logger logFormat:@"Started writing samples to %@, discarded %llu samples before the first key frame", self.filePath, _droppedSampleCount];
+  [self.startFuture resolveWithResult:NSNull.null];
+  return YES;
+}
+
+- (void)finishWriting
+{
+  if (_finishing) {
+    return;
+  }
+  _finishing = YES;
+  if (!_input) {
+    [self.logger logFormat:@"No key frame was written to %@, there is no recording", self.filePath];
+    NSError *error = [[FBControlCoreError describeFormat:@"No key frame was written to %@", self.filePath] build];
+    [self.startFuture resolveWithError:error];
+    [self.finishFuture resolveWithError:error];
+    return;
+  }
+  [_input markAsFinished];
+  uint64_t droppedSampleCount = _droppedSampleCount;
+  [self.writer finishWritingWithCompletionHandler:^{
+    if (self.writer.status != AVAssetWriterStatusCompleted) {
+      [self.finishFuture resolveWithError:self.writer.error];
+      return;
+    }
+    [self.logger logFormat:@"Finished writing samples to %@, dropped %llu samples", self.filePath, droppedSampleCount];
+    [self.finishFuture resolveWithResult:NSNull.null];
+  }];
+}
+
+- (void)failWithError:(NSError *)error
+{
+  [self.logger logFormat:@"Failed to write samples to %@: %@", self.filePath, error];
+  _finishing = YES;
+  if (self.writer.status == AVAssetWriterStatusWriting) {
+    [self.writer cancelWriting];
+  }
+  [self.startFuture resolveWithError:error];
+  [self.finishFuture resolveWithError:error];
+}
+
+@end
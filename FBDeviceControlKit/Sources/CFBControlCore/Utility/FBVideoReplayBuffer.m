@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBVideoReplayBuffer.h"
+
+#import "FBControlCoreError.h"
+#import "FBControlCoreLogger.h"
+#import "FBVideoFileWriter.h"
+#import "FBVideoStream.h"
+
+/**
+ A group of pictures: a key frame and the frames that depend on it.
+ */
+@interface FBVideoReplayBuffer_Group : NSObject
+
+@property (nonatomic, strong, readonly) NSMutableArray *samples;
+@property (nonatomic, assign, readonly) CMTime startTime;
+@property (nonatomic, assign, readwrite) NSUInteger byteCount;
+
+@end
+
+@implementation FBVideoReplayBuffer_Group
+
+- (instancetype)initWithStartTime:(CMTime)startTime
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _samples = [NSMutableArray array];
+  _startTime = startTime;
+
+  return self;
+}
+
+@end
+
+@interface FBVideoReplayBuffer ()
+
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, assign, readonly) NSUInteger maximumByteCount;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *finishedConsumingFuture;
+
+@end
+
+@implementation FBVideoReplayBuffer
+{
+  // Only accessed on the queue.
+  NSMutableArray<FBVideoReplayBuffer_Group *> *_groups;
+  CMTime _latestTime;
+  NSUInteger _byteCount;
+}
+
+#pragma mark Initializers
+
+- (instancetype)initWithWindow:(NSTimeInterval)window maximumByteCount:(NSUInteger)maximumByteCount logger:(id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _window = window;
+  _maximumByteCount = maximumByteCount;
+  _logger = logger;
+  _queue = dispatch_queue_create("com.facebook.fbcontrolcore.videoreplaybuffer", DISPATCH_QUEUE_SERIAL);
+  _finishedConsumingFuture = FBMutableFuture.future;
+  _groups = [NSMutableArray array];
+  _latestTime = kCMTimeInvalid;
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (FBFuture<NSString *> *)writeToFile:(NSString *)filePath
+{
+  __block NSArray *samples = nil;
+  dispatch_sync(self.queue, ^{
+    // The samples are immutable, so a snapshot of the references is enough for them to be written whilst the buffer moves on.
+    NSMutableArray *snapshot = [NSMutableArray array];
+    for (FBVideoReplayBuffer_Group *group in self->_groups) {
+      [snapshot addObjectsFromArray:group.samples];
+    }
+    samples = [snapshot copy];
+  });
+  if (samples.count == 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Cannot write replay to %@, no key frame has been buffered", filePath]
+      failFuture];
+  }
+  NSError *error = nil;
+  FBVideoSampleFileWriter *writer = [FBVideoSampleFileWriter writerWithFilePath:filePath segmentDuration:self.window logger:self.logger error:&error];
+  if (!writer) {
+    return [FBFuture futureWithError:error];
+  }
+  writer.expectsMediaDataInRealTime = NO;
+  for (id sample in samples) {
+    [writer consumeSampleBuffer:(__bridge CMSampleBufferRef) sample];
+  }
+  [self.logger logFormat:@"Writing %lu buffered samples to %@", (unsigned long) samples.count, filePath];
+  return [[writer stopRecording] mapReplace:filePath];
+}
+
+- (void)clear
+{
+  dispatch_async(self.queue, ^{
+    [self->_groups removeAllObjects];
+    self->_byteCount = 0;
+    self->_latestTime = kCMTimeInvalid;
+  });
+}
+
+#pragma mark Properties
+
+- (NSTimeInterval)bufferedDuration
+{
+  __block NSTimeInterval duration = 0;
+  dispatch_sync(self.queue, ^{
+    FBVideoReplayBuffer_Group *oldest = self->_groups.firstObject;
+    if (oldest && CMTIME_IS_NUMERIC(self->_latestTime)) {
+      duration = CMTimeGetSeconds(CMTimeSubtract(self->_latestTime, oldest.startTime));
+    }
+  });
+  return duration;
+}
+
+- (NSUInteger)bufferedByteCount
+{
+  __block NSUInteger byteCount = 0;
+  dispatch_sync(self.queue, ^{
+    byteCount = self->_byteCount;
+  });
+  return byteCount;
+}
+
+#pragma mark FBVideoSampleConsumer
+
+- (void)consumeSampleBuffer:(CMSampleBufferRef)sampleBuffer
+{
+  CFRetain(sampleBuffer);
+  dispatch_async(self.queue, ^{
+    [self appendSampleBuffer:sampleBuffer];
+    CFRelease(sampleBuffer);
+  });
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  // Frames are delivered as sample buffers, not bytes.
+}
+
+- (void)consumeEndOfFile
+{
+  // The buffered samples remain available for writing once the stream has ended.
+  FBMutableFuture<NSNull *> *finishedConsuming = self.finishedConsumingFuture;
+  dispatch_async(self.queue, ^{
+    [finishedConsuming resolveWithResult:NSNull.null];
+  });
+}
+
+#pragma mark FBDataConsumerLifecycle
+
+- (FBFuture<NSNull *> *)finishedConsuming
+{
+  return self.finishedConsumingFuture;
+}
+
+#pragma mark Private
+
+- (void)appendSampleBuffer:(CMSampleBufferRef)sampleBuffer
+{
+  CMTime presentationTimeStamp = CMSampleBufferGetPresentationTimeStamp(sampleBuffer);
+  if (FBVideoStreamSampleBufferIsKeyFrame(sampleBuffer)) {
+    [_groups addObject:[[FBVideoReplayBuffer_Group alloc] initWithStartTime:presentationTimeStamp]];
+  }
+  // The stream only delivers dependent frames after a key frame, so there is always a group to add them to.
+  FBVideoReplayBuffer_Group *group = _groups.lastObject;
+  if (!group) {
+    return;
+  }
+  NSUInteger byteCount = (NSUInteger) CMSampleBufferGetTotalSampleSize(sampleBuffer);
+  [group.samples addObject:(__bridge id) sampleBuffer];
+  group.byteCount += byteCount;
+  _byteCount += byteCount;
+  _latestTime = presentationTimeStamp;
+  [self evictExpiredGroups];
+}
+
+- (void)evictExpiredGroups
+{
+  // The oldest group is only discarded once the next group alone starts far enough back to cover the window, and the newest group is never discarded.
+  while (_groups.count > 1) {
+    FBVideoReplayBuffer_Group *oldest = _groups[0];
+    CMTime nextStartTime = _groups[1].startTime;
+    BOOL covered = CMTimeGetSeconds(CMTimeSubtract(_latestTime, nextStartTime)) >= self.window;
+    BOOL overLimit = _byteCount > self.maximumByteCount;
+    if (!covered && !overLimit) {
+      return;
+    }
+    _byteCount -= oldest.byteCount;
+    [_groups removeObjectAtIndex:0];
+  }
+}
+
+@end
@@ -11,150 +11,396 @@
 #import "FBControlCoreError.h"
 #import "FBControlCoreLogger.h"
 #import "FBDataConsumer.h"
+#import <mach/mach_time.h>
+#import <stdatomic.h>
 
 static NSInteger const MaxAllowedUnprocessedDataCounts = 2;
 
+static NSInteger UnprocessedDataCount(id<FBDataConsumer> consumer)
+{
+  if (![consumer conformsToProtocol:@protocol(FBDataConsumerAsync)]) {
+    return 0;
+  }
+  return [(id<FBDataConsumerAsync>) consumer unprocessedDataCount];
+}
+
 BOOL checkConsumerBufferLimit(id<FBDataConsumer> consumer, id<FBControlCoreLogger> logger) {
-  if ([consumer conformsToProtocol:@protocol(FBDataConsumerAsync)]) {
-    id<FBDataConsumerAsync> asyncConsumer = (id<FBDataConsumerAsync>)consumer;
-    NSInteger framesInProcess = asyncConsumer.unprocessedDataCount;
-    // drop frames if consumer is overflown
-    if (framesInProcess > MaxAllowedUnprocessedDataCounts) {
-      [logger logFormat:@"Consumer is overflown. Number of unsent frames: %@", @(framesInProcess)];
-      return NO;
+  // drop frames if consumer is overflown
+  return UnprocessedDataCount(consumer) <= MaxAllowedUnprocessedDataCounts;
+}
+
+@implementation FBVideoStreamStatistics
+
+- (instancetype)initWithFramesSent:(uint64_t)framesSent framesDropped:(uint64_t)framesDropped keyFramesDropped:(uint64_t)keyFramesDropped framesDiscarded:(uint64_t)framesDiscarded congestionEvents:(uint64_t)congestionEvents
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _framesSent = framesSent;
+  _framesDropped = framesDropped;
+  _keyFramesDropped = keyFramesDropped;
+  _framesDiscarded = framesDiscarded;
+  _congestionEvents = congestionEvents;
+
+  return self;
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:
+    @"Sent %llu | Dropped %llu | Key frames dropped %llu | Discarded %llu | Congestion events %llu",
+    self.framesSent,
+    self.framesDropped,
+    self.keyFramesDropped,
+    self.framesDiscarded,
+    self.congestionEvents
+  ];
+}
+
+@end
+
+@implementation FBVideoStreamFrameGate
+{
+  _Atomic uint64_t _framesSent;
+  _Atomic uint64_t _framesDropped;
+  _Atomic uint64_t _keyFramesDropped;
+  _Atomic uint64_t _framesDiscarded;
+  _Atomic uint64_t _congestionEvents;
+  FBVideoStreamBackpressurePolicy _policy;
+  NSInteger _maxPendingFrames;
+  BOOL _congested;
+  BOOL _awaitingKeyFrame;
+}
+
+- (instancetype)initWithPolicy:(FBVideoStreamBackpressurePolicy)policy maxPendingFrames:(NSUInteger)maxPendingFrames
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _policy = policy;
+  _maxPendingFrames = (NSInteger) maxPendingFrames;
+  atomic_init(&_framesSent, 0);
+  atomic_init(&_framesDropped, 0);
+  atomic_init(&_keyFramesDropped, 0);
+  atomic_init(&_framesDiscarded, 0);
+  atomic_init(&_congestionEvents, 0);
+
+  return self;
+}
+
+- (BOOL)shouldWriteFrameToConsumer:(id<FBDataConsumer>)consumer isKeyFrame:(BOOL)isKeyFrame
+{
+  NSInteger pendingFrames = UnprocessedDataCount(consumer);
+  BOOL congested = pendingFrames > _maxPendingFrames;
+  if (congested && !_congested) {
+    atomic_fetch_add(&_congestionEvents, 1);
+  }
+  _congested = congested;
+
+  BOOL shouldWrite = !congested;
+  switch (_policy) {
+    case FBVideoStreamBackpressurePolicyDropNewest:
+      break;
+    case FBVideoStreamBackpressurePolicyDropOldest:
+      if (congested && [consumer respondsToSelector:@selector(discardUnprocessedData)]) {
+        NSInteger discarded = [(id<FBDataConsumerAsync>) consumer discardUnprocessedData];
+        atomic_fetch_add(&_framesDiscarded, (uint64_t) MAX(discarded, 0));
+        shouldWrite = YES;
+      }
+      break;
+    case FBVideoStreamBackpressurePolicyPreserveKeyFrames:
+      if (isKeyFrame) {
+        // A key frame resets the dependency chain, so it is always written.
+        _awaitingKeyFrame = NO;
+        shouldWrite = YES;
+      } else if (_awaitingKeyFrame) {
+        // A previous dependent frame was dropped, so this frame cannot be decoded correctly.
+        shouldWrite = NO;
+      } else if (!shouldWrite) {
+        _awaitingKeyFrame = YES;
+      }
+      break;
+  }
+
+  if (shouldWrite) {
+    atomic_fetch_add(&_framesSent, 1);
+  } else {
+    atomic_fetch_add(&_framesDropped, 1);
+    if (isKeyFrame) {
+      atomic_fetch_add(&_keyFramesDropped, 1);
     }
   }
-  return YES;
+  return shouldWrite;
 }
 
-static NSData *AnnexBNALUStartCodeData(void)
+- (void)recordDroppedFrame
+{
+  atomic_fetch_add(&_framesDropped, 1);
+}
+
+- (FBVideoStreamStatistics *)statistics
+{
+  return [[FBVideoStreamStatistics alloc]
+    initWithFramesSent:atomic_load(&_framesSent)
+    framesDropped:atomic_load(&_framesDropped)
+    keyFramesDropped:atomic_load(&_keyFramesDropped)
+    framesDiscarded:atomic_load(&_framesDiscarded)
+    congestionEvents:atomic_load(&_congestionEvents)];
+}
+
+@end
+
+uint32_t const FBVideoStreamFrameHeaderMagic = 'FBVF';
+
+dispatch_data_t FBVideoStreamFramedData(dispatch_data_t frame, uint32_t sequenceNumber, BOOL isKeyFrame, CMTime presentationTimeStamp, uint64_t captureHostTime)
+{
+  int64_t presentationTimeNanos = INT64_MIN;
+  if (CMTIME_IS_NUMERIC(presentationTimeStamp)) {
+    presentationTimeNanos = CMTimeConvertScale(presentationTimeStamp, NSEC_PER_SEC, kCMTimeRoundingMethod_Default).value;
+  }
+  FBVideoStreamFrameHeader header = {
+    // The magic is byte-swapped so that it reads as 'FBVF' in the stream.
+    .magic = CFSwapInt32HostToBig(FBVideoStreamFrameHeaderMagic),
+    .headerLength = CFSwapInt16HostToLittle(sizeof(FBVideoStreamFrameHeader)),
+    .flags = CFSwapInt16HostToLittle(isKeyFrame ? FBVideoStreamFrameHeaderFlagKeyFrame : 0),
+    .sequenceNumber = CFSwapInt32HostToLittle(sequenceNumber),
+    .frameLength = CFSwapInt32HostToLittle((uint32_t) dispatch_data_get_size(frame)),
+    .presentationTimeNanos = (int64_t) CFSwapInt64HostToLittle((uint64_t) presentationTimeNanos),
+    .captureHostTime = CFSwapInt64HostToLittle(captureHostTime),
+    .writeHostTime = CFSwapInt64HostToLittle(mach_absolute_time()),
+  };
+  dispatch_data_t headerData = dispatch_data_create(&header, sizeof(header), NULL, DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+  return dispatch_data_create_concat(headerData, frame);
+}
+
+static dispatch_data_t AnnexBNALUStartCodeData(void)
 {
   // https://www.programmersought.com/article/3901815022/
   // Annex-B is simpler as it is purely based on a start code to denote the start of the NALU.
-  static NSData *data;
+  static dispatch_data_t data;
   static dispatch_once_t onceToken;
   dispatch_once(&onceToken, ^{
-    const uint8_t headerCode[] = {0x00, 0x00, 0x00, 0x01};
-    data = [NSData dataWithBytes:headerCode length:sizeof(headerCode)];
+    static const uint8_t headerCode[] = {0x00, 0x00, 0x00, 0x01};
+    data = dispatch_data_create(headerCode, sizeof(headerCode), NULL, DISPATCH_DATA_DESTRUCTOR_NONE);
   });
   return data;
 }
 
 static const int AVCCHeaderLength = 4;
 
-BOOL WriteFrameToAnnexBStream(CMSampleBufferRef sampleBuffer, id<FBDataConsumer> consumer, id<FBControlCoreLogger> logger, NSError **error)
+BOOL FBVideoStreamSampleBufferIsKeyFrame(CMSampleBufferRef sampleBuffer)
 {
-  if (!CMSampleBufferDataIsReady(sampleBuffer)) {
-    return [[FBControlCoreError
-      describeFormat:@"Sample Buffer is not ready"]
-      failBool:error];
+  CFArrayRef attachments = CMSampleBufferGetSampleAttachmentsArray(sampleBuffer, true);
+  if (!attachments || !CFArrayGetCount(attachments)) {
+    return NO;
+  }
+  CFDictionaryRef attachment = (CFDictionaryRef)CFArrayGetValueAtIndex(attachments, 0);
+  CFBooleanRef dependsOnOthers = (CFBooleanRef)CFDictionaryGetValue(attachment, kCMSampleAttachmentKey_DependsOnOthers);
+  return dependsOnOthers == kCFBooleanFalse;
+}
+
+static OSStatus GetParameterSetAtIndex(CMFormatDescriptionRef format, FourCharCode codec, size_t index, const uint8_t **parameterSet, size_t *parameterSetSize, size_t *parameterSetCount, int *nalUnitHeaderLength)
+{
+  if (codec == kCMVideoCodecType_HEVC) {
+    return CMVideoFormatDescriptionGetHEVCParameterSetAtIndex(format, index, parameterSet, parameterSetSize, parameterSetCount, nalUnitHeaderLength);
   }
-  NSData *headerData = AnnexBNALUStartCodeData();
-  NSMutableData *consumableData = [NSMutableData alloc];
+  return CMVideoFormatDescriptionGetH264ParameterSetAtIndex(format, index, parameterSet, parameterSetSize, parameterSetCount, nalUnitHeaderLength);
+}
 
-  bool isKeyFrame = false;
-  CFArrayRef attachments =
-      CMSampleBufferGetSampleAttachmentsArray(sampleBuffer, true);
-  if (CFArrayGetCount(attachments)) {
-    CFDictionaryRef attachment = (CFDictionaryRef)CFArrayGetValueAtIndex(attachments, 0);
-    CFBooleanRef dependsOnOthers = (CFBooleanRef)CFDictionaryGetValue(
-        attachment, kCMSampleAttachmentKey_DependsOnOthers);
-    isKeyFrame = (dependsOnOthers == kCFBooleanFalse);
+static dispatch_data_t AnnexBParameterSetData(CMFormatDescriptionRef format, NSError **error)
+{
+  // H264 has SPS & PPS. HEVC has VPS, SPS & PPS, all of which are vended in-order by the format description.
+  FourCharCode codec = CMFormatDescriptionGetMediaSubType(format);
+  if (codec != kCMVideoCodecType_H264 && codec != kCMVideoCodecType_HEVC) {
+    return [[FBControlCoreError
+      describeFormat:@"Cannot write Annex-B for codec %u, only H264 and HEVC are supported", (unsigned int) codec]
+      fail:error];
+  }
+  size_t parameterSetCount = 0;
+  int nalUnitHeaderLength = 0;
+  OSStatus status = GetParameterSetAtIndex(format, codec, 0, NULL, NULL, &parameterSetCount, &nalUnitHeaderLength);
+  if (status != noErr) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to get Parameter Set count %d", status]
+      fail:error];
+  }
+  if (nalUnitHeaderLength != AVCCHeaderLength) {
+    return [[FBControlCoreError
+      describeFormat:@"NAL Unit header length of %d is not supported, only %d is supported", nalUnitHeaderLength, AVCCHeaderLength]
+      fail:error];
   }
 
-  if (isKeyFrame) {
-    CMFormatDescriptionRef format = CMSampleBufferGetFormatDescription(sampleBuffer);
-    size_t spsSize, spsCount;
-    const uint8_t *spsParameterSet;
-    OSStatus status = CMVideoFormatDescriptionGetH264ParameterSetAtIndex(
-      format,
-      0,
-      &spsParameterSet,
-      &spsSize,
-      &spsCount,
-      0
-    );
+  dispatch_data_t headerData = AnnexBNALUStartCodeData();
+  NSMutableData *parameterSets = [NSMutableData data];
+  for (size_t index = 0; index < parameterSetCount; index++) {
+    size_t parameterSetSize = 0;
+    const uint8_t *parameterSet = NULL;
+    status = GetParameterSetAtIndex(format, codec, index, &parameterSet, &parameterSetSize, NULL, NULL);
     if (status != noErr) {
       return [[FBControlCoreError
-        describeFormat:@"Failed to get SPS Params %d", status]
-        failBool:error];
+        describeFormat:@"Failed to get Parameter Set at index %zu %d", index, status]
+        fail:error];
     }
-    size_t ppsSize, ppsCount;
-    const uint8_t *ppsParameterSet;
-    status = CMVideoFormatDescriptionGetH264ParameterSetAtIndex(
-      format,
-      1,
-      &ppsParameterSet,
-      &ppsSize,
-      &ppsCount,
-      0
-    );
+    [parameterSets appendData:(NSData *)headerData];
+    [parameterSets appendBytes:parameterSet length:parameterSetSize];
+  }
+  // Parameter sets are owned by the format description, which may not outlive the consumer, so the header is built into a buffer of its own.
+  return dispatch_data_create(parameterSets.bytes, parameterSets.length, NULL, DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+}
+
+@interface FBAnnexBParameterSetCache ()
+
+@property (nonatomic, assign, readwrite) CMFormatDescriptionRef formatDescription;
+@property (nonatomic, strong, nullable, readwrite) dispatch_data_t parameterSets;
+@property (nonatomic, assign, readwrite) NSUInteger formatChangeCount;
+
+@end
+
+@implementation FBAnnexBParameterSetCache
+
+- (void)dealloc
+{
+  if (_formatDescription) {
+    CFRelease(_formatDescription);
+  }
+}
+
+- (nullable dispatch_data_t)parameterSetsForFormatDescription:(CMFormatDescriptionRef)format logger:(nullable id<FBControlCoreLogger>)logger error:(NSError **)error
+{
+  // Identity is the fast path, the capture output re-uses the same format description for the lifetime of a given resolution.
+  if (format == self.formatDescription && self.parameterSets) {
+    return self.parameterSets;
+  }
+  // A new description object with identical contents doesn't require a rebuild.
+  if (self.formatDescription && self.parameterSets && CMFormatDescriptionEqual(format, self.formatDescription)) {
+    [self retainFormatDescription:format];
+    return self.parameterSets;
+  }
+  dispatch_data_t parameterSets = AnnexBParameterSetData(format, error);
+  if (!parameterSets) {
+    return nil;
+  }
+  if (self.formatDescription) {
+    CMVideoDimensions dimensions = CMVideoFormatDescriptionGetDimensions(format);
+    [logger logFormat:@"Stream format changed to %dx%d, rebuilt parameter sets", dimensions.width, dimensions.height];
+  }
+  [self retainFormatDescription:format];
+  self.parameterSets = parameterSets;
+  self.formatChangeCount += 1;
+  return parameterSets;
+}
+
+- (void)retainFormatDescription:(CMFormatDescriptionRef)format
+{
+  CFRetain(format);
+  if (_formatDescription) {
+    CFRelease(_formatDescription);
+  }
+  _formatDescription = format;
+}
+
+@end
+
+static dispatch_data_t AnnexBFrameDataFromBlockBuffer(CMBlockBufferRef dataBuffer, NSError **error)
+{
+  // The AVCC length prefix and the Annex-B start code are both four bytes, so the elementary stream can be produced by rewriting the prefixes in place.
+  // A contiguous block buffer is required for this, this is almost always the case for samples vended by the capture output.
+  size_t totalLength = CMBlockBufferGetDataLength(dataBuffer);
+  CMBlockBufferRef contiguousBuffer = NULL;
+  if (CMBlockBufferIsRangeContiguous(dataBuffer, 0, totalLength)) {
+    contiguousBuffer = (CMBlockBufferRef) CFRetain(dataBuffer);
+  } else {
+    OSStatus status = CMBlockBufferCreateContiguous(kCFAllocatorDefault, dataBuffer, kCFAllocatorDefault, NULL, 0, totalLength, 0, &contiguousBuffer);
     if (status != noErr) {
       return [[FBControlCoreError
-        describeFormat:@"Failed to get PPS Params %d", status]
-        failBool:error];
+        describeFormat:@"Failed to create contiguous Block Buffer %d", status]
+        fail:error];
     }
-    NSData *spsData = [NSData dataWithBytes:spsParameterSet length:spsSize];
-    NSData *ppsData = [NSData dataWithBytes:ppsParameterSet length:ppsSize];
-    [consumableData appendData:headerData];
-    [consumableData appendData:spsData];
-    [consumableData appendData:headerData];
-    [consumableData appendData:ppsData];
   }
 
-  // Get the underlying data buffer.
-  CMBlockBufferRef dataBuffer = CMSampleBufferGetDataBuffer(sampleBuffer);
-  size_t dataLength;
-  char *dataPointer;
-  OSStatus status = CMBlockBufferGetDataPointer(
-    dataBuffer,
-    0,
-    NULL,
-    &dataLength,
-    &dataPointer
-  );
+  size_t dataLength = 0;
+  char *dataPointer = NULL;
+  OSStatus status = CMBlockBufferGetDataPointer(contiguousBuffer, 0, NULL, &dataLength, &dataPointer);
   if (status != noErr) {
+    CFRelease(contiguousBuffer);
     return [[FBControlCoreError
       describeFormat:@"Failed to get Data Pointer %d", status]
-      failBool:error];
+      fail:error];
   }
 
-  // Enumerate the data buffer
+  // Enumerate the data buffer, replacing each length prefix with a start code.
+  static const uint8_t startCode[] = {0x00, 0x00, 0x00, 0x01};
   size_t dataOffset = 0;
-  while (dataOffset < dataLength - AVCCHeaderLength) {
-    // Write start code to the elementary stream
-    [consumableData appendData:headerData];
-
-    // Get our current position in the buffer
-    void *currentDataPointer = dataPointer + dataOffset;
-
+  while (dataOffset + AVCCHeaderLength <= dataLength) {
     // Get the length of the NAL Unit, this is contained in the current offset.
-    // This will tell us how many bytes to write in the current NAL unit, contained in the buffer.
-    uint32_t nalLength = 0;
-    memcpy(&nalLength, currentDataPointer, AVCCHeaderLength);
     // Convert the length value from Big-endian to Little-endian.
+    uint32_t nalLength = 0;
+    memcpy(&nalLength, dataPointer + dataOffset, AVCCHeaderLength);
     nalLength = CFSwapInt32BigToHost(nalLength);
-
-    // Write the NAL unit without the AVCC length header to the elementary stream
-    void *nalUnitPointer = currentDataPointer + AVCCHeaderLength;
-    if ([consumer conformsToProtocol:@protocol(FBDataConsumerSync)]) {
-      NSData *nalUnitData = [NSData dataWithBytesNoCopy:nalUnitPointer length:nalLength freeWhenDone:NO];
-      [consumableData appendData:nalUnitData];
-    } else {
-      NSData *nalUnitData = [NSData dataWithBytes:nalUnitPointer length:nalLength];
-      [consumableData appendData:nalUnitData];
+    if (nalLength > dataLength - dataOffset - AVCCHeaderLength) {
+      CFRelease(contiguousBuffer);
+      return [[FBControlCoreError
+        describeFormat:@"NAL Unit of length %u at offset %zu overruns sample of length %zu", nalLength, dataOffset, dataLength]
+        fail:error];
     }
+    memcpy(dataPointer + dataOffset, startCode, AVCCHeaderLength);
 
     // Increment the offset for the next iteration.
     dataOffset += AVCCHeaderLength + nalLength;
   }
-  [consumer consumeData:consumableData];
+
+  // The dispatch_data wraps the block buffer's storage without copying, releasing the block buffer once the last reference to the data goes away.
+  // This means that the bytes survive the sample buffer callback, so the same data is safe for both synchronous and asynchronous consumers.
+  return dispatch_data_create(dataPointer, dataOffset, NULL, ^{
+    CFRelease(contiguousBuffer);
+  });
+}
+
+BOOL WriteFrameToAnnexBStream(CMSampleBufferRef sampleBuffer, id<FBDataConsumer> consumer, id<FBControlCoreLogger> logger, NSError **error)
+{
+  return WriteFrameToAnnexBStreamWithParameterSetCache(sampleBuffer, nil, consumer, logger, error);
+}
+
+BOOL WriteFrameToAnnexBStreamWithParameterSetCache(CMSampleBufferRef sampleBuffer, FBAnnexBParameterSetCache *cache, id<FBDataConsumer> consumer, id<FBControlCoreLogger> logger, NSError **error)
+{
+  if (!CMSampleBufferDataIsReady(sampleBuffer)) {
+    return [[FBControlCoreError
+      describeFormat:@"Sample Buffer is not ready"]
+      failBool:error];
+  }
+
+  dispatch_data_t consumableData = dispatch_data_empty;
+  if (FBVideoStreamSampleBufferIsKeyFrame(sampleBuffer)) {
+    CMFormatDescriptionRef format = CMSampleBufferGetFormatDescription(sampleBuffer);
+    dispatch_data_t parameterSets = cache
+      ? [cache parameterSetsForFormatDescription:format logger:logger error:error]
+      : AnnexBParameterSetData(format, error);
+    if (!parameterSets) {
+      return NO;
+    }
+    consumableData = parameterSets;
+  }
+
+  // Get the underlying data buffer.
+  dispatch_data_t frameData = AnnexBFrameDataFromBlockBuffer(CMSampleBufferGetDataBuffer(sampleBuffer), error);
+  if (!frameData) {
+    return NO;
+  }
+  consumableData = dispatch_data_create_concat(consumableData, frameData);
+
+  // dispatch_data_t is bridged to NSData, the bytes are only flattened if a consumer requires a contiguous buffer.
+  [consumer consumeData:(NSData *)consumableData];
   return YES;
 }
 
-BOOL WriteJPEGDataToMJPEGStream(CMBlockBufferRef jpegDataBuffer, id<FBDataConsumer> consumer, id<FBControlCoreLogger> logger, NSError **error)
+static dispatch_data_t JPEGDataFromBlockBuffer(CMBlockBufferRef jpegDataBuffer, NSError **error)
 {
-  // Enumerate the data buffer
+  // Each contiguous region of the block buffer becomes a region of the dispatch data, retaining the block buffer rather than copying.
+  dispatch_data_t jpegData = dispatch_data_empty;
   size_t dataLength = CMBlockBufferGetDataLength(jpegDataBuffer);
   size_t offset = 0;
   while (offset < dataLength) {
@@ -170,31 +416,41 @@ BOOL WriteJPEGDataToMJPEGStream(CMBlockBufferRef jpegDataBuffer, id<FBDataConsum
     if (status != noErr) {
       return [[FBControlCoreError
         describeFormat:@"Failed to get Data Pointer %d", status]
-        failBool:error];
-    }
-    if ([consumer conformsToProtocol:@protocol(FBDataConsumerSync)]) {
-      NSData *data = [NSData dataWithBytesNoCopy:dataPointer length:lengthAtOffset freeWhenDone:NO];
-      [consumer consumeData:data];
-    } else {
-      NSData *data = [NSData dataWithBytes:dataPointer length:lengthAtOffset];
-      [consumer consumeData:data];
+        fail:error];
     }
+    CFRetain(jpegDataBuffer);
+    dispatch_data_t region = dispatch_data_create(dataPointer, lengthAtOffset, NULL, ^{
+      CFRelease(jpegDataBuffer);
+    });
+    jpegData = dispatch_data_create_concat(jpegData, region);
 
     // Increment the offset for the next iteration.
     offset += lengthAtOffset;
   }
+  return jpegData;
+}
+
+BOOL WriteJPEGDataToMJPEGStream(CMBlockBufferRef jpegDataBuffer, id<FBDataConsumer> consumer, id<FBControlCoreLogger> logger, NSError **error)
+{
+  dispatch_data_t jpegData = JPEGDataFromBlockBuffer(jpegDataBuffer, error);
+  if (!jpegData) {
+    return NO;
+  }
+  [consumer consumeData:(NSData *) jpegData];
   return YES;
 }
 
 BOOL WriteJPEGDataToMinicapStream(CMBlockBufferRef jpegDataBuffer, id<FBDataConsumer> consumer, id<FBControlCoreLogger> logger, NSError **error)
 {
-  // Write the header length first
-  size_t dataLength = CMBlockBufferGetDataLength(jpegDataBuffer);
-  uint32 imageLength = OSSwapHostToLittleInt32(dataLength);
-  NSData *lengthData = [[NSData alloc] initWithBytes:&imageLength length:sizeof(imageLength)];
-  [consumer consumeData:lengthData];
-
-  return WriteJPEGDataToMJPEGStream(jpegDataBuffer, consumer, logger, error);
+  dispatch_data_t jpegData = JPEGDataFromBlockBuffer(jpegDataBuffer, error);
+  if (!jpegData) {
+    return NO;
+  }
+  // The length prefix and the frame are written in a single call.
+  uint32 imageLength = OSSwapHostToLittleInt32((uint32) dispatch_data_get_size(jpegData));
+  dispatch_data_t lengthData = dispatch_data_create(&imageLength, sizeof(imageLength), NULL, DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+  [consumer consumeData:(NSData *) dispatch_data_create_concat(lengthData, jpegData)];
+  return YES;
 }
 
 // 1-byte alignment needed for the header to ensure correct sizing of the structure.
@@ -218,15 +474,25 @@ struct MinicapHeader {
 
 BOOL WriteMinicapHeaderToStream(uint32 width, uint32 height, id<FBDataConsumer> consumer, id<FBControlCoreLogger> logger, NSError **error)
 {
+  return WriteMinicapHeaderWithVirtualDisplayToStream(width, height, width, height, 0, consumer, logger, error);
+}
+
+BOOL WriteMinicapHeaderWithVirtualDisplayToStream(uint32 displayWidth, uint32 displayHeight, uint32 virtualWidth, uint32 virtualHeight, uint8_t orientation, id<FBDataConsumer> consumer, id<FBControlCoreLogger> logger, NSError **error)
+{
+  if (orientation > 3) {
+    return [[FBControlCoreError
+      describeFormat:@"%u is not a valid Minicap orientation", orientation]
+      failBool:error];
+  }
   struct MinicapHeader header = {
     .version = 1,
     .headerSize = sizeof(struct MinicapHeader),
     .pid = OSSwapHostToLittleInt32(NSProcessInfo.processInfo.processIdentifier),
-    .displayWidth = OSSwapHostToLittleInt32(width),
-    .displayHeight = OSSwapHostToLittleInt32(height),
-    .virtualDisplayWidth = OSSwapHostToLittleInt32(width),
-    .virtualDisplayHeight = OSSwapHostToLittleInt32(height),
-    .displayOrientation = 0,
+    .displayWidth = OSSwapHostToLittleInt32(displayWidth),
+    .displayHeight = OSSwapHostToLittleInt32(displayHeight),
+    .virtualDisplayWidth = OSSwapHostToLittleInt32(virtualWidth),
+    .virtualDisplayHeight = OSSwapHostToLittleInt32(virtualHeight),
+    .displayOrientation = orientation,
     .quirks = 0,
   };
   NSData *data = [[NSData alloc] initWithBytes:&header length:header.headerSize];
@@ -0,0 +1,474 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBVideoStreamFanout.h"
+
+#import "FBControlCoreError.h"
+#import "FBControlCoreLogger.h"
+#import "FBDataConsumer.h"
+#import "FBVideoSurfaceConsumer.h"
+#import <stdatomic.h>
+
+@interface FBVideoStreamStatistics ()
+
+- (instancetype)initWithFramesSent:(uint64_t)framesSent framesDropped:(uint64_t)framesDropped keyFramesDropped:(uint64_t)keyFramesDropped framesDiscarded:(uint64_t)framesDiscarded congestionEvents:(uint64_t)congestionEvents;
+
+@end
+
+/**
+ How a consumer of the fanout receives frames.
+ */
+typedef NS_ENUM(NSUInteger, FBVideoStreamFanoutConsumerKind) {
+  FBVideoStreamFanoutConsumerKindBytes = 0,
+  FBVideoStreamFanoutConsumerKindSurfaces = 1,
+  FBVideoStreamFanoutConsumerKindSamples = 2,
+};
+
+/**
+ Collects the bytes written for a single frame, without copying data that is already dispatch_data_t.
+ */
+@interface FBVideoStreamFanout_Collector : NSObject <FBDataConsumer, FBDataConsumerNonContiguous>
+
+@property (nonatomic, strong, readonly) dispatch_data_t data;
+
+@end
+
+@implementation FBVideoStreamFanout_Collector
+
+- (instancetype)init
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _data = dispatch_data_empty;
+
+  return self;
+}
+
+- (void)consumeData:(NSData *)data
+{
+  _data = dispatch_data_create_concat(_data, [FBDataConsumerAdaptor adaptNSData:data]);
+}
+
+- (void)consumeEndOfFile
+{
+}
+
+@end
+
+/**
+ A consumer of the fanout, with its own serial queue and backpressure.
+ Presents itself as an asynchronous consumer so that the frame gate can measure and discard the frames that are queued for it.
+ */
+@interface FBVideoStreamFanout_Subscriber : NSObject <FBDataConsumer, FBDataConsumerAsync>
+
+@property (nonatomic, strong, readonly) id<FBDataConsumer> consumer;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) FBVideoStreamFrameGate *gate;
+@property (nonatomic, assign, readonly) FBVideoStreamFanoutConsumerKind kind;
+@property (nonatomic, assign, readonly) BOOL writesDirectly;
+@property (nonatomic, assign, readwrite) BOOL hasReceivedKeyFrame;
+@property _Atomic int64_t numPendingFrames;
+@property _Atomic int64_t generation;
+@property _Atomic bool removed;
+
+@end
+
+@implementation FBVideoStreamFanout_Subscriber
+
+- (instancetype)initWithConsumer:(id<FBDataConsumer>)consumer policy:(FBVideoStreamBackpressurePolicy)policy maxPendingFrames:(NSUInteger)maxPendingFrames
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _consumer = consumer;
+  _queue = dispatch_queue_create("com.facebook.fbcontrolcore.videostream.fanout", DISPATCH_QUEUE_SERIAL);
+  _gate = [[FBVideoStreamFrameGate alloc] initWithPolicy:policy maxPendingFrames:maxPendingFrames];
+  if ([consumer conformsToProtocol:@protocol(FBVideoSurfaceConsumer)]) {
+    _kind = FBVideoStreamFanoutConsumerKindSurfaces;
+  } else if ([consumer conformsToProtocol:@protocol(FBVideoSampleConsumer)]) {
+    _kind = FBVideoStreamFanoutConsumerKindSamples;
+  } else {
+    _kind = FBVideoStreamFanoutConsumerKindBytes;
+  }
+  // Asynchronous consumers, such as ring buffer consumers, already have a queue and a count of pending data, so a second queue would only add a hop.
+  _writesDirectly = _kind == FBVideoStreamFanoutConsumerKindBytes && [consumer conformsToProtocol:@protocol(FBDataConsumerAsync)];
+  atomic_init(&_numPendingFrames, 0);
+  atomic_init(&_generation, 0);
+  atomic_init(&_removed, false);
+
+  return self;
+}
+
+- (void)enqueueDiscardable:(BOOL)discardable block:(dispatch_block_t)block
+{
+  atomic_fetch_add(&_numPendingFrames, 1);
+  int64_t generation = atomic_load(&_generation);
+  dispatch_async(self.queue, ^{
+    // Frames enqueued before a discard belong to an older generation and are skipped, headers are never skipped.
+    BOOL current = !discardable || generation == atomic_load(&self->_generation);
+    if (current && !atomic_load(&self->_removed)) {
+      block();
+    }
+    atomic_fetch_sub(&self->_numPendingFrames, 1);
+  });
+}
+
+- (void)enqueueHeader:(NSData *)data
+{
+  if (self.writesDirectly) {
+    [self.consumer consumeData:data];
+    return;
+  }
+  [self enqueueDiscardable:NO block:^{
+    [self.consumer consumeData:data];
+  }];
+}
+
+- (void)enqueuePixelBuffer:(CVPixelBufferRef)pixelBuffer presentationTimeStamp:(CMTime)presentationTimeStamp
+{
+  CVPixelBufferRetain(pixelBuffer);
+  id<FBVideoSurfaceConsumer> consumer = (id<FBVideoSurfaceConsumer>) self.consumer;
+  [self enqueueDiscardable:YES block:^{
+    [consumer consumePixelBuffer:pixelBuffer presentationTimeStamp:presentationTimeStamp];
+  }];
+  // The release is queued behind the frame so that it happens whether or not the frame was skipped.
+  dispatch_async(self.queue, ^{
+    CVPixelBufferRelease(pixelBuffer);
+  });
+}
+
+- (void)enqueueSampleBuffer:(CMSampleBufferRef)sampleBuffer
+{
+  CFRetain(sampleBuffer);
+  id<FBVideoSampleConsumer> consumer = (id<FBVideoSampleConsumer>) self.consumer;
+  [self enqueueDiscardable:YES block:^{
+    [consumer consumeSampleBuffer:sampleBuffer];
+  }];
+  dispatch_async(self.queue, ^{
+    CFRelease(sampleBuffer);
+  });
+}
+
+- (void)remove
+{
+  if (self.writesDirectly && [self.consumer respondsToSelector:@selector(discardUnprocessedData)]) {
+    [(id<FBDataConsumerAsync>) self.consumer discardUnprocessedData];
+  }
+  atomic_store(&_removed, true);
+  atomic_fetch_add(&_generation, 1);
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  if (self.writesDirectly) {
+    [self.consumer consumeData:data];
+    return;
+  }
+  [self enqueueDiscardable:YES block:^{
+    [self.consumer consumeData:data];
+  }];
+}
+
+- (void)consumeEndOfFile
+{
+  if (self.writesDirectly) {
+    [self.consumer consumeEndOfFile];
+    return;
+  }
+  [self enqueueDiscardable:NO block:^{
+    [self.consumer consumeEndOfFile];
+  }];
+}
+
+#pragma mark FBDataConsumerAsync
+
+- (NSInteger)unprocessedDataCount
+{
+  if (self.writesDirectly) {
+    return [(id<FBDataConsumerAsync>) self.consumer unprocessedDataCount];
+  }
+  return (NSInteger) atomic_load(&_numPendingFrames);
+}
+
+- (NSInteger)discardUnprocessedData
+{
+  if (self.writesDirectly) {
+    if (![self.consumer respondsToSelector:@selector(discardUnprocessedData)]) {
+      return 0;
+    }
+    return [(id<FBDataConsumerAsync>) self.consumer discardUnprocessedData];
+  }
+  atomic_fetch_add(&_generation, 1);
+  return (NSInteger) atomic_load(&_numPendingFrames);
+}
+
+@end
+
+@interface FBVideoStreamFanout ()
+
+@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, assign, readonly) BOOL framedOutput;
+@property (nonatomic, copy, readonly) NSArray<FBVideoStreamFanout_Subscriber *> *subscribers;
+
+@end
+
+@implementation FBVideoStreamFanout
+{
+  NSArray<FBVideoStreamFanout_Subscriber *> *_subscribers;
+  NSData *_streamHeader;
+  uint32_t _sequenceNumber;
+  BOOL _keyFrameRequested;
+}
+
+#pragma mark Initializers
+
+- (instancetype)initWithFramedOutput:(BOOL)framedOutput logger:(id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _framedOutput = framedOutput;
+  _logger = logger;
+  _subscribers = @[];
+
+  return self;
+}
+
+#pragma mark Subscription
+
+- (BOOL)addConsumer:(id<FBDataConsumer>)consumer policy:(FBVideoStreamBackpressurePolicy)policy maxPendingFrames:(NSUInteger)maxPendingFrames error:(NSError **)error
+{
+  @synchronized (self) {
+    if ([self subscriberForConsumer:consumer]) {
+      return [[FBControlCoreError
+        describeFormat:@"%@ is already consuming the stream", consumer]
+        failBool:error];
+    }
+    FBVideoStreamFanout_Subscriber *subscriber = [[FBVideoStreamFanout_Subscriber alloc] initWithConsumer:consumer policy:policy maxPendingFrames:maxPendingFrames];
+    // The header is enqueued whilst holding the lock, so that it is ahead of any frame.
+    if (_streamHeader) {
+      [subscriber enqueueHeader:_streamHeader];
+    }
+    _subscribers = [_subscribers arrayByAddingObject:subscriber];
+    [self.logger logFormat:@"Added stream consumer %@, %lu consumers", consumer, (unsigned long) _subscribers.count];
+  }
+  return YES;
+}
+
+- (BOOL)removeConsumer:(id<FBDataConsumer>)consumer error:(NSError **)error
+{
+  @synchronized (self) {
+    FBVideoStreamFanout_Subscriber *subscriber = [self subscriberForConsumer:consumer];
+    if (!subscriber) {
+      return [[FBControlCoreError
+        describeFormat:@"%@ is not consuming the stream", consumer]
+        failBool:error];
+    }
+    [subscriber remove];
+    NSMutableArray<FBVideoStreamFanout_Subscriber *> *subscribers = [_subscribers mutableCopy];
+    [subscribers removeObject:subscriber];
+    _subscribers = [subscribers copy];
+    [self.logger logFormat:@"Removed stream consumer %@, %lu consumers", consumer, (unsigned long) _subscribers.count];
+  }
+  return YES;
+}
+
+- (NSUInteger)consumerCount
+{
+  return self.subscribers.count;
+}
+
+- (NSArray<FBVideoStreamFanout_Subscriber *> *)subscribers
+{
+  @synchronized (self) {
+    return _subscribers;
+  }
+}
+
+#pragma mark Writing
+
+- (BOOL)writeStreamHeader:(FBVideoStreamFanoutWriter)writer
+{
+  FBVideoStreamFanout_Collector *collector = [[FBVideoStreamFanout_Collector alloc] init];
+  if (!writer(collector)) {
+    return NO;
+  }
+  NSData *header = (NSData *) collector.data;
+  @synchronized (self) {
+    _streamHeader = header;
+    for (FBVideoStreamFanout_Subscriber *subscriber in _subscribers) {
+      [subscriber enqueueHeader:header];
+    }
+  }
+  return YES;
+}
+
+- (BOOL)writeFrameIsKeyFrame:(BOOL)isKeyFrame presentationTimeStamp:(CMTime)presentationTimeStamp captureHostTime:(uint64_t)captureHostTime writer:(FBVideoStreamFanoutWriter)writer
+{
+  // The sequence number advances for every frame, whether or not it is admitted, so that consumers can detect their drops.
+  uint32_t sequenceNumber = _sequenceNumber++;
+  NSArray<FBVideoStreamFanout_Subscriber *> *admitted = [self admittedSubscribersForKeyFrame:isKeyFrame kind:FBVideoStreamFanoutConsumerKindBytes];
+  if (admitted.count == 0) {
+    return YES;
+  }
+  // The frame is written once and the same immutable bytes are shared between subscribers.
+  NSData *frame = [self frameDataWithSequenceNumber:sequenceNumber isKeyFrame:isKeyFrame presentationTimeStamp:presentationTimeStamp captureHostTime:captureHostTime writer:writer];
+  if (!frame) {
+    return NO;
+  }
+  for (FBVideoStreamFanout_Subscriber *subscriber in admitted) {
+    [subscriber consumeData:frame];
+  }
+  return YES;
+}
+
+- (BOOL)writePixelBuffer:(CVPixelBufferRef)pixelBuffer presentationTimeStamp:(CMTime)presentationTimeStamp captureHostTime:(uint64_t)captureHostTime writer:(FBVideoStreamFanoutWriter)writer
+{
+  uint32_t sequenceNumber = _sequenceNumber++;
+  BOOL hasSurface = CVPixelBufferGetIOSurface(pixelBuffer) != NULL;
+  NSMutableArray<FBVideoStreamFanout_Subscriber *> *byteSubscribers = [NSMutableArray array];
+  for (FBVideoStreamFanout_Subscriber *subscriber in [self admittedSubscribersForKeyFrame:YES kind:FBVideoStreamFanoutConsumerKindSurfaces]) {
+    if (subscriber.kind == FBVideoStreamFanoutConsumerKindSurfaces && hasSurface) {
+      [subscriber enqueuePixelBuffer:pixelBuffer presentationTimeStamp:presentationTimeStamp];
+    } else {
+      [byteSubscribers addObject:subscriber];
+    }
+  }
+  if (byteSubscribers.count == 0) {
+    return YES;
+  }
+  NSData *frame = [self frameDataWithSequenceNumber:sequenceNumber isKeyFrame:YES presentationTimeStamp:presentationTimeStamp captureHostTime:captureHostTime writer:writer];
+  if (!frame) {
+    return NO;
+  }
+  for (FBVideoStreamFanout_Subscriber *subscriber in byteSubscribers) {
+    [subscriber consumeData:frame];
+  }
+  return YES;
+}
+
+- (void)writeSurfacePixelBuffer:(CVPixelBufferRef)pixelBuffer presentationTimeStamp:(CMTime)presentationTimeStamp
+{
+  if (CVPixelBufferGetIOSurface(pixelBuffer) == NULL) {
+    return;
+  }
+  for (FBVideoStreamFanout_Subscriber *subscriber in self.subscribers) {
+    if (subscriber.kind == FBVideoStreamFanoutConsumerKindSurfaces && [subscriber.gate shouldWriteFrameToConsumer:subscriber isKeyFrame:YES]) {
+      [subscriber enqueuePixelBuffer:pixelBuffer presentationTimeStamp:presentationTimeStamp];
+    }
+  }
+}
+
+- (void)writeSampleBuffer:(CMSampleBufferRef)sampleBuffer
+{
+  for (FBVideoStreamFanout_Subscriber *subscriber in [self admittedSubscribersForKeyFrame:FBVideoStreamSampleBufferIsKeyFrame(sampleBuffer) kind:FBVideoStreamFanoutConsumerKindSamples]) {
+    [subscriber enqueueSampleBuffer:sampleBuffer];
+  }
+}
+
+- (void)recordDroppedFrame
+{
+  for (FBVideoStreamFanout_Subscriber *subscriber in self.subscribers) {
+    [subscriber.gate recordDroppedFrame];
+  }
+}
+
+#pragma mark Statistics
+
+- (nullable FBVideoStreamStatistics *)statisticsForConsumer:(id<FBDataConsumer>)consumer
+{
+  @synchronized (self) {
+    return [self subscriberForConsumer:consumer].gate.statistics;
+  }
+}
+
+- (FBVideoStreamStatistics *)statistics
+{
+  uint64_t framesSent = 0;
+  uint64_t framesDropped = 0;
+  uint64_t keyFramesDropped = 0;
+  uint64_t framesDiscarded = 0;
+  uint64_t congestionEvents = 0;
+  for (FBVideoStreamFanout_Subscriber *subscriber in self.subscribers) {
+    FBVideoStreamStatistics *statistics = subscriber.gate.statistics;
+    framesSent += statistics.framesSent;
+    framesDropped += statistics.framesDropped;
+    keyFramesDropped += statistics.keyFramesDropped;
+    framesDiscarded += statistics.framesDiscarded;
+    congestionEvents += statistics.congestionEvents;
+  }
+  return [[FBVideoStreamStatistics alloc] initWithFramesSent:framesSent framesDropped:framesDropped keyFramesDropped:keyFramesDropped framesDiscarded:framesDiscarded congestionEvents:congestionEvents];
+}
+
+#pragma mark Private
+
+- (nullable FBVideoStreamFanout_Subscriber *)subscriberForConsumer:(id<FBDataConsumer>)consumer
+{
+  for (FBVideoStreamFanout_Subscriber *subscriber in _subscribers) {
+    if (subscriber.consumer == consumer) {
+      return subscriber;
+    }
+  }
+  return nil;
+}
+
+- (nullable NSData *)frameDataWithSequenceNumber:(uint32_t)sequenceNumber isKeyFrame:(BOOL)isKeyFrame presentationTimeStamp:(CMTime)presentationTimeStamp captureHostTime:(uint64_t)captureHostTime writer:(FBVideoStreamFanoutWriter)writer
+{
+  FBVideoStreamFanout_Collector *collector = [[FBVideoStreamFanout_Collector alloc] init];
+  if (!writer(collector)) {
+    return nil;
+  }
+  if (!self.framedOutput) {
+    return (NSData *) collector.data;
+  }
+  return (NSData *) FBVideoStreamFramedData(collector.data, sequenceNumber, isKeyFrame, presentationTimeStamp, captureHostTime);
+}
+
+- (NSArray<FBVideoStreamFanout_Subscriber *> *)admittedSubscribersForKeyFrame:(BOOL)isKeyFrame kind:(FBVideoStreamFanoutConsumerKind)kind
+{
+  NSMutableArray<FBVideoStreamFanout_Subscriber *> *admitted = [NSMutableArray array];
+  BOOL needsKeyFrame = NO;
+  for (FBVideoStreamFanout_Subscriber *subscriber in self.subscribers) {
+    // Surface and sample consumers are only written the frames they consume, a bitmap frame is written to surface consumers and to byte consumers.
+    BOOL consumes = subscriber.kind == kind || (kind == FBVideoStreamFanoutConsumerKindSurfaces && subscriber.kind == FBVideoStreamFanoutConsumerKindBytes);
+    if (!consumes) {
+      continue;
+    }
+    // Dependent frames cannot be decoded by a consumer that has not yet received a key frame.
+    if (!isKeyFrame && !subscriber.hasReceivedKeyFrame) {
+      needsKeyFrame = YES;
+      continue;
+    }
+    if ([subscriber.gate shouldWriteFrameToConsumer:subscriber isKeyFrame:isKeyFrame]) {
+      subscriber.hasReceivedKeyFrame = subscriber.hasReceivedKeyFrame || isKeyFrame;
+      [admitted addObject:subscriber];
+    } else if (!isKeyFrame) {
+      needsKeyFrame = YES;
+    }
+  }
+  if (isKeyFrame) {
+    _keyFrameRequested = NO;
+  } else if (needsKeyFrame && !_keyFrameRequested) {
+    _keyFrameRequested = YES;
+    dispatch_block_t handler = self.keyFrameRequestHandler;
+    if (handler) {
+      handler();
+    }
+  }
+  return admitted;
+}
+
+@end
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBVideoSurfaceConsumer.h"
+
+@interface FBVideoSurfaceConsumer_Block : NSObject <FBVideoSurfaceConsumer, FBDataConsumerLifecycle>
+
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, copy, readonly) void (^handler)(CVPixelBufferRef, CMTime);
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *finishedConsumingFuture;
+
+@end
+
+@implementation FBVideoSurfaceConsumer_Block
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue handler:(void (^)(CVPixelBufferRef, CMTime))handler
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _queue = queue;
+  _handler = handler;
+  _finishedConsumingFuture = FBMutableFuture.future;
+
+  return self;
+}
+
+#pragma mark FBVideoSurfaceConsumer
+
+- (void)consumePixelBuffer:(CVPixelBufferRef)pixelBuffer presentationTimeStamp:(CMTime)presentationTimeStamp
+{
+  void (^handler)(CVPixelBufferRef, CMTime) = self.handler;
+  CVPixelBufferRetain(pixelBuffer);
+  dispatch_async(self.queue, ^{
+    handler(pixelBuffer, presentationTimeStamp);
+    CVPixelBufferRelease(pixelBuffer);
+  });
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  // Frames are delivered as surfaces, not bytes.
+}
+
+- (void)consumeEndOfFile
+{
+  // Resolve after any pending frames have been delivered.
+  FBMutableFuture<NSNull *> *finishedConsuming = self.finishedConsumingFuture;
+  dispatch_async(self.queue, ^{
+    [finishedConsuming resolveWithResult:NSNull.null];
+  });
+}
+
+#pragma mark FBDataConsumerLifecycle
+
+- (FBFuture<NSNull *> *)finishedConsuming
+{
+  return self.finishedConsumingFuture;
+}
+
+@end
+
+@implementation FBVideoSurfaceConsumer
+
++ (id<FBVideoSurfaceConsumer, FBDataConsumerLifecycle>)consumerOnQueue:(dispatch_queue_t)queue handler:(void (^)(CVPixelBufferRef pixelBuffer, CMTime presentationTimeStamp))handler
+{
+  return [[FBVideoSurfaceConsumer_Block alloc] initWithQueue:queue handler:handler];
+}
+
++ (id<FBVideoSurfaceConsumer, FBDataConsumerLifecycle>)machPortConsumerOnQueue:(dispatch_queue_t)queue handler:(FBVideoSurfaceMachPortHandler)handler
+{
+  return [[FBVideoSurfaceConsumer_Block alloc] initWithQueue:queue handler:^(CVPixelBufferRef pixelBuffer, CMTime presentationTimeStamp) {
+    IOSurfaceRef surface = CVPixelBufferGetIOSurface(pixelBuffer);
+    if (!surface) {
+      return;
+    }
+    // The use count marks the surface as in-use, which prevents the capture pool from recycling it whilst the other process is reading it.
+    // The pixel buffer is kept alive until the receiver is done, since it owns the surface.
+    CVPixelBufferRetain(pixelBuffer);
+    IOSurfaceIncrementUseCount(surface);
+    __block BOOL released = NO;
+    dispatch_block_t done = ^{
+      if (released) {
+        return;
+      }
+      released = YES;
+      IOSurfaceDecrementUseCount(surface);
+      CVPixelBufferRelease(pixelBuffer);
+    };
+    mach_port_t port = IOSurfaceCreateMachPort(surface);
+    handler(port, IOSurfaceGetID(surface), presentationTimeStamp, done);
+  }];
+}
+
+@end
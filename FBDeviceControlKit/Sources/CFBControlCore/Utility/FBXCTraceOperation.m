@@ -21,6 +21,129 @@
 const NSTimeInterval DefaultXCTraceRecordOperationTimeLimit = 4 * 60 * 60; // 4h
 const NSTimeInterval DefaultXCTraceRecordStopTimeout = 600.0; // 600s
 
+/**
+ Parses the XML of `xctrace export`, resolving the values of each row from the schema of its table.
+ */
+@interface FBXCTraceExportParser : NSObject <NSXMLParserDelegate>
+
+@property (nonatomic, strong, readonly) id<FBXCTraceRowConsumer> consumer;
+@property (nonatomic, assign, readonly) NSUInteger rowCount;
+
+@end
+
+@implementation FBXCTraceExportParser
+{
+  NSString *_schema;
+  NSMutableArray<NSString *> *_columns;
+  // Values that later rows refer to by id, rather than repeating them.
+  NSMutableDictionary<NSString *, NSString *> *_valuesByIdentifier;
+  NSMutableDictionary<NSString *, NSString *> *_row;
+  NSMutableString *_text;
+  NSString *_valueFormat;
+  NSString *_valueIdentifier;
+  NSUInteger _columnIndex;
+  NSUInteger _depthInRow;
+  BOOL _inMnemonic;
+}
+
+- (instancetype)initWithConsumer:(id<FBXCTraceRowConsumer>)consumer
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _consumer = consumer;
+  _columns = [NSMutableArray array];
+  _valuesByIdentifier = [NSMutableDictionary dictionary];
+
+  return self;
+}
+
+- (void)parser:(NSXMLParser *)parser didStartElement:(NSString *)elementName namespaceURI:(nullable NSString *)namespaceURI qualifiedName:(nullable NSString *)qName attributes:(NSDictionary<NSString *, NSString *> *)attributes
+{
+  if (_row) {
+    _depthInRow++;
+    if (_depthInRow != 1) {
+      return;
+    }
+    // A direct child of a row is the value of the next column.
+    NSString *reference = attributes[@"ref"];
+    if (reference) {
+      [self setValue:_valuesByIdentifier[reference] forColumn:_columnIndex];
+      _valueIdentifier = nil;
+      _text = nil;
+    } else {
+      _valueIdentifier = attributes[@"id"];
+      _valueFormat = attributes[@"fmt"];
+      _text = [NSMutableString string];
+    }
+    return;
+  }
+  if ([elementName isEqualToString:@"row"]) {
+    _row = [NSMutableDictionary dictionary];
+    _columnIndex = 0;
+    _depthInRow = 0;
+  } else if ([elementName isEqualToString:@"schema"]) {
+    _schema = attributes[@"name"] ?: @"";
+    [_columns removeAllObjects];
+  } else if ([elementName isEqualToString:@"mnemonic"]) {
+    _inMnemonic = YES;
+    _text = [NSMutableString string];
+  }
+}
+
+- (void)parser:(NSXMLParser *)parser foundCharacters:(NSString *)string
+{
+  [_text appendString:string];
+}
+
+- (void)parser:(NSXMLParser *)parser didEndElement:(NSString *)elementName namespaceURI:(nullable NSString *)namespaceURI qualifiedName:(nullable NSString *)qName
+{
+  if (_row) {
+    if (_depthInRow == 0) {
+      [_consumer consumeRow:[_row copy] schema:_schema];
+      _rowCount++;
+      _row = nil;
+      return;
+    }
+    _depthInRow--;
+    if (_depthInRow != 0) {
+      return;
+    }
+    if (_text) {
+      NSString *value = _valueFormat ?: [_text stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceAndNewlineCharacterSet];
+      // A sentinel marks a column without a value.
+      if (![elementName isEqualToString:@"sentinel"]) {
+        [self setValue:value forColumn:_columnIndex];
+      }
+      if (_valueIdentifier) {
+        _valuesByIdentifier[_valueIdentifier] = value;
+      }
+    }
+    _text = nil;
+    _valueFormat = nil;
+    _valueIdentifier = nil;
+    _columnIndex++;
+    return;
+  }
+  if (_inMnemonic && [elementName isEqualToString:@"mnemonic"]) {
+    [_columns addObject:[_text copy]];
+    _inMnemonic = NO;
+    _text = nil;
+  }
+}
+
+- (void)setValue:(nullable NSString *)value forColumn:(NSUInteger)index
+{
+  if (!value || index >= _columns.count) {
+    return;
+  }
+  _row[_columns[index]] = value;
+}
+
+@end
+
 
 @implementation FBXCTraceRecordOperation
 
@@ -126,6 +249,61 @@ const NSTimeInterval DefaultXCTraceRecordStopTimeout = 600.0; // 600s
   ];
 }
 
+- (FBFuture<NSNumber *> *)stopWithTimeout:(NSTimeInterval)timeout exportingQueries:(NSArray<NSString *> *)xpathQueries toConsumer:(id<FBXCTraceRowConsumer>)consumer
+{
+  return [[self
+    stopWithTimeout:timeout]
+    onQueue:self.queue fmap:^(NSURL *traceFile) {
+      return [FBXCTraceRecordOperation exportTrace:traceFile xpathQueries:xpathQueries toConsumer:consumer queue:self.queue logger:self.logger];
+    }];
+}
+
++ (FBFuture<NSNumber *> *)exportTrace:(NSURL *)traceFile xpathQueries:(NSArray<NSString *> *)xpathQueries toConsumer:(id<FBXCTraceRowConsumer>)consumer queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger
+{
+  if (xpathQueries.count == 0) {
+    return [FBFuture futureWithResult:@0];
+  }
+  NSError *error = nil;
+  NSString *xctracePath = [FBXCTraceRecordOperation xctracePathWithError:&error];
+  if (!xctracePath) {
+    return [FBControlCoreError failFutureWithError:error];
+  }
+  // A union of the queries is exported in one pass, rather than opening the trace once for each query.
+  NSArray<NSString *> *arguments = @[@"export", @"--input", traceFile.path, @"--xpath", [xpathQueries componentsJoinedByString:@" | "]];
+  [logger logFormat:@"Starting xctrace export with arguments: %@", [FBCollectionInformation oneLineDescriptionFromArray:arguments]];
+  dispatch_queue_t parseQueue = dispatch_queue_create("com.facebook.fbcontrolcore.xctrace.export", DISPATCH_QUEUE_SERIAL);
+
+  return [[[[[[[FBProcessBuilder
+    withLaunchPath:xctracePath]
+    withArguments:arguments]
+    withStdOutToInputStream]
+    withStdErrToLogger:logger]
+    withTaskLifecycleLoggingTo:logger]
+    start]
+    onQueue:queue fmap:^ FBFuture<NSNumber *> * (FBManagedProcess<id, NSInputStream *, id> *process) {
+      FBMutableFuture<NSNumber *> *parsed = FBMutableFuture.future;
+      dispatch_async(parseQueue, ^{
+        // The parser reads from the pipe as xctrace writes to it, so rows reach the consumer whilst the export is still running.
+        FBXCTraceExportParser *delegate = [[FBXCTraceExportParser alloc] initWithConsumer:consumer];
+        NSXMLParser *parser = [[NSXMLParser alloc] initWithStream:process.stdOut];
+        parser.delegate = delegate;
+        if (![parser parse]) {
+          [parsed resolveWithError:[[FBControlCoreError
+            describeFormat:@"Failed to parse xctrace export of %@ after %lu rows: %@", traceFile.path, (unsigned long) delegate.rowCount, parser.parserError]
+            build]];
+          return;
+        }
+        [logger logFormat:@"Exported %lu rows from %@", (unsigned long) delegate.rowCount, traceFile.path];
+        [parsed resolveWithResult:@(delegate.rowCount)];
+      });
+      return [[process
+        exitedWithCodes:[NSSet setWithObject:@0]]
+        onQueue:queue fmap:^(id _) {
+          return parsed;
+        }];
+    }];
+}
+
 + (FBFuture<NSURL *> *)postProcess:(NSArray<NSString *> *)arguments traceDir:(NSURL *)traceDir queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger
 {
   if (!arguments || arguments.count == 0) {
@@ -7,12 +7,162 @@
 
 #import "FBXcodeConfiguration.h"
 
+#import <CoreServices/CoreServices.h>
+#import <os/lock.h>
+
 #import "FBBundleDescriptor.h"
 #import "FBFuture+Sync.h"
 #import "FBiOSTargetConfiguration.h"
 #import "FBProcessBuilder.h"
 #import "FBXcodeDirectory.h"
 
+static NSString *const XcodeSelectLinkName = @"xcode_select_link";
+static CFTimeInterval const SnapshotWatchLatency = 0.5;
+
+/**
+ The values resolved from the selected Xcode, read once and shared by the whole process.
+ A snapshot is replaced when the xcode-select link or one of the plists it was read from changes.
+ */
+@interface FBXcodeConfigurationSnapshot : NSObject
+
+@property (nonatomic, copy, nullable, readonly) NSString *developerDirectory;
+@property (nonatomic, strong, nullable, readonly) NSError *developerDirectoryError;
+@property (nonatomic, copy, nullable, readonly) NSDecimalNumber *xcodeVersionNumber;
+@property (nonatomic, assign, readonly) NSOperatingSystemVersion xcodeVersion;
+@property (nonatomic, copy, nullable, readonly) NSString *iosSDKVersion;
+@property (nonatomic, copy, readonly) NSArray<NSString *> *watchedFiles;
+@property (nonatomic, copy, readonly) NSArray<NSString *> *watchedDirectories;
+
+@end
+
+@implementation FBXcodeConfigurationSnapshot
+
+- (instancetype)init
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  // /var is a symlink and FSEvents reports resolved paths, so resolve the directory but not the link itself.
+  NSString *xcodeSelectDirectory = [@"/var/db" stringByResolvingSymlinksInPath];
+  NSMutableArray<NSString *> *watchedFiles = [NSMutableArray arrayWithObject:[xcodeSelectDirectory stringByAppendingPathComponent:XcodeSelectLinkName]];
+  NSMutableArray<NSString *> *watchedDirectories = [NSMutableArray arrayWithObject:xcodeSelectDirectory];
+
+  NSError *error = nil;
+  _developerDirectory = [FBXcodeDirectory symlinkedDeveloperDirectoryWithError:&error];
+  _developerDirectoryError = error;
+  if (_developerDirectory) {
+    NSString *contentsDirectory = [_developerDirectory stringByDeletingLastPathComponent];
+    NSString *xcodeInfoPlistPath = [contentsDirectory stringByAppendingPathComponent:@"Info.plist"];
+    NSString *simulatorPlatformInfoPlistPath = [_developerDirectory stringByAppendingPathComponent:@"Platforms/iPhoneSimulator.platform/Info.plist"];
+
+    NSString *versionNumberString = [FBXcodeConfigurationSnapshot valueForKey:@"CFBundleShortVersionString" fromPlistAtPath:xcodeInfoPlistPath];
+    if (versionNumberString) {
+      _xcodeVersionNumber = [NSDecimalNumber decimalNumberWithString:versionNumberString];
+      _xcodeVersion = [FBOSVersion operatingSystemVersionFromName:_xcodeVersionNumber.stringValue];
+    }
+    _iosSDKVersion = [FBXcodeConfigurationSnapshot valueForKey:@"Version" fromPlistAtPath:simulatorPlatformInfoPlistPath];
+
+    [watchedFiles addObjectsFromArray:@[xcodeInfoPlistPath, simulatorPlatformInfoPlistPath]];
+    [watchedDirectories addObject:contentsDirectory];
+  }
+  _watchedFiles = [watchedFiles copy];
+  _watchedDirectories = [watchedDirectories copy];
+
+  return self;
+}
+
++ (nullable id)valueForKey:(NSString *)key fromPlistAtPath:(NSString *)plistPath
+{
+  return [NSDictionary dictionaryWithContentsOfFile:plistPath][key];
+}
+
+- (BOOL)isAffectedByEventAtPath:(NSString *)path flags:(FSEventStreamEventFlags)flags
+{
+  if (flags & (kFSEventStreamEventFlagMustScanSubDirs | kFSEventStreamEventFlagRootChanged)) {
+    return YES;
+  }
+  for (NSString *watchedFile in self.watchedFiles) {
+    // Moving or deleting a containing directory is reported for the directory, not the file inside it.
+    if ([watchedFile isEqualToString:path] || [watchedFile hasPrefix:[path stringByAppendingString:@"/"]]) {
+      return YES;
+    }
+  }
+  return NO;
+}
+
+@end
+
+static os_unfair_lock SnapshotLock = OS_UNFAIR_LOCK_INIT;
+static FBXcodeConfigurationSnapshot *CurrentSnapshot = nil;
+static FSEventStreamRef CurrentSnapshotStream = NULL;
+
+static void SnapshotStreamCallback(ConstFSEventStreamRef stream, void *info, size_t count, void *eventPaths, const FSEventStreamEventFlags eventFlags[], const FSEventStreamEventId eventIds[])
+{
+  FBXcodeConfigurationSnapshot *snapshot = (__bridge FBXcodeConfigurationSnapshot *) info;
+  char **paths = (char **) eventPaths;
+  BOOL affected = NO;
+  for (size_t index = 0; index < count && !affected; index++) {
+    NSString *path = [NSFileManager.defaultManager stringWithFileSystemRepresentation:paths[index] length:strlen(paths[index])];
+    affected = [snapshot isAffectedByEventAtPath:path flags:eventFlags[index]];
+  }
+  if (!affected) {
+    return;
+  }
+
+  // Drop the snapshot, the next access resolves the configuration again and watches whichever Xcode is selected then.
+  FSEventStreamRef invalidatedStream = NULL;
+  os_unfair_lock_lock(&SnapshotLock);
+  if (CurrentSnapshot == snapshot) {
+    CurrentSnapshot = nil;
+    invalidatedStream = CurrentSnapshotStream;
+    CurrentSnapshotStream = NULL;
+  }
+  os_unfair_lock_unlock(&SnapshotLock);
+  if (invalidatedStream) {
+    FSEventStreamStop(invalidatedStream);
+    FSEventStreamInvalidate(invalidatedStream);
+    FSEventStreamRelease(invalidatedStream);
+  }
+}
+
+static FSEventStreamRef SnapshotStreamStart(FBXcodeConfigurationSnapshot *snapshot)
+{
+  static dispatch_once_t onceToken;
+  static dispatch_queue_t queue;
+  dispatch_once(&onceToken, ^{
+    queue = dispatch_queue_create("com.facebook.fbcontrolcore.xcode_configuration", DISPATCH_QUEUE_SERIAL);
+  });
+
+  FSEventStreamContext context = {
+    .version = 0,
+    .info = (__bridge void *) snapshot,
+    .retain = CFRetain,
+    .release = CFRelease,
+    .copyDescription = NULL,
+  };
+  FSEventStreamRef stream = FSEventStreamCreate(
+    kCFAllocatorDefault,
+    SnapshotStreamCallback,
+    &context,
+    (__bridge CFArrayRef) snapshot.watchedDirectories,
+    kFSEventStreamEventIdSinceNow,
+    SnapshotWatchLatency,
+    kFSEventStreamCreateFlagFileEvents | kFSEventStreamCreateFlagWatchRoot
+  );
+  if (!stream) {
+    return NULL;
+  }
+  FSEventStreamSetDispatchQueue(stream, queue);
+  if (!FSEventStreamStart(stream)) {
+    FSEventStreamInvalidate(stream);
+    FSEventStreamRelease(stream);
+    return NULL;
+  }
+  return stream;
+}
+
 @implementation FBXcodeConfiguration
 
 + (NSString *)developerDirectory
@@ -32,36 +182,20 @@
 
 + (NSDecimalNumber *)xcodeVersionNumber
 {
-  static dispatch_once_t onceToken;
-  static NSDecimalNumber *versionNumber;
-  dispatch_once(&onceToken, ^{
-    NSString *versionNumberString = [FBXcodeConfiguration
-      readValueForKey:@"CFBundleShortVersionString"
-      fromPlistAtPath:FBXcodeConfiguration.xcodeInfoPlistPath];
-    versionNumber = [NSDecimalNumber decimalNumberWithString:versionNumberString];
-  });
+  NSDecimalNumber *versionNumber = self.snapshot.xcodeVersionNumber;
+  NSAssert(versionNumber, @"Could not read CFBundleShortVersionString from '%@'", FBXcodeConfiguration.xcodeInfoPlistPath);
   return versionNumber;
 }
 
 + (NSOperatingSystemVersion)xcodeVersion
 {
-  static dispatch_once_t onceToken;
-  static NSOperatingSystemVersion version;
-  dispatch_once(&onceToken, ^{
-    version = [FBOSVersion operatingSystemVersionFromName:self.xcodeVersionNumber.stringValue];
-  });
-  return version;
+  return self.snapshot.xcodeVersion;
 }
 
 + (NSString *)iosSDKVersion
 {
-  static dispatch_once_t onceToken;
-  static NSString *sdkVersion;
-  dispatch_once(&onceToken, ^{
-    sdkVersion = [FBXcodeConfiguration
-      readValueForKey:@"Version"
-      fromPlistAtPath:FBXcodeConfiguration.iPhoneSimulatorPlatformInfoPlistPath];
-  });
+  NSString *sdkVersion = self.snapshot.iosSDKVersion;
+  NSAssert(sdkVersion, @"Could not read Version from '%@'", FBXcodeConfiguration.iPhoneSimulatorPlatformInfoPlistPath);
   return sdkVersion;
 }
 
@@ -118,6 +252,20 @@
 
 #pragma mark Private
 
++ (FBXcodeConfigurationSnapshot *)snapshot
+{
+  os_unfair_lock_lock(&SnapshotLock);
+  FBXcodeConfigurationSnapshot *snapshot = CurrentSnapshot;
+  if (!snapshot) {
+    // Resolved under the lock so that concurrent first accesses read the plists once.
+    snapshot = [FBXcodeConfigurationSnapshot new];
+    CurrentSnapshot = snapshot;
+    CurrentSnapshotStream = SnapshotStreamStart(snapshot);
+  }
+  os_unfair_lock_unlock(&SnapshotLock);
+  return snapshot;
+}
+
 + (NSString *)simulatorApplicationPath
 {
   NSString *simulatorBinaryName =  @"Simulator";
@@ -150,28 +298,11 @@
 
 + (nullable NSString *)findXcodeDeveloperDirectory:(NSError **)error
 {
-  static dispatch_once_t onceToken;
-  static NSString *directory;
-  static NSError *savedError;
-  dispatch_once(&onceToken, ^{
-    NSError *innerError = nil;
-    directory = [FBXcodeDirectory symlinkedDeveloperDirectoryWithError:&innerError];
-    savedError = innerError;
-  });
+  FBXcodeConfigurationSnapshot *snapshot = self.snapshot;
   if (error) {
-    *error = savedError;
+    *error = snapshot.developerDirectoryError;
   }
-  return directory;
-}
-
-+ (nullable id)readValueForKey:(NSString *)key fromPlistAtPath:(NSString *)plistPath
-{
-  NSAssert([NSFileManager.defaultManager fileExistsAtPath:plistPath], @"plist does not exist at path '%@'", plistPath);
-  NSDictionary *infoPlist = [NSDictionary dictionaryWithContentsOfFile:plistPath];
-  NSAssert(infoPlist, @"Could not read plist at '%@'", plistPath);
-  id value = infoPlist[key];
-  NSAssert(value, @"'%@' does not exist in plist '%@'", key, infoPlist.allKeys);
-  return value;
+  return snapshot.developerDirectory;
 }
 
 @end
@@ -13,12 +13,16 @@
 #import "FBFuture.h"
 #import "FBFuture+Sync.h"
 #import "FBFutureContextManager.h"
+#import "FBFutureContextPool.h"
+#import "FBFutureProfiler.h"
 
 // MARK: - Applications
 
 #import "FBBinaryDescriptor.h"
 #import "FBBundleDescriptor.h"
 #import "FBBundleDescriptor+Application.h"
+#import "FBBundleManifest.h"
+#import "FBDescriptorCache.h"
 #import "FBInstalledApplication.h"
 
 // MARK: - Codesigning
@@ -72,6 +76,8 @@
 #import "FBCrashLog.h"
 #import "FBCrashLogNotifier.h"
 #import "FBCrashLogParser.h"
+#import "FBCrashLogQuery.h"
+#import "FBCrashLogSymbolicator.h"
 
 // MARK: - Management
 
@@ -91,6 +97,7 @@
 
 #import "FBEventReporter.h"
 #import "FBEventReporterSubject.h"
+#import "FBMetricsRegistry.h"
 
 // MARK: - Sockets
 
@@ -106,7 +113,10 @@
 
 // FBAccessibilityTraits excluded - requires AXRuntime private framework
 #import "FBArchitecture.h"
+#import "FBArchiveExtractor.h"
 #import "FBArchiveOperations.h"
+#import "FBAtomicSnapshot.h"
+#import "FBAudioRingBuffer.h"
 #import "FBCollectionInformation.h"
 #import "FBCollectionOperations.h"
 #import "FBConcatedJsonParser.h"
@@ -122,14 +132,20 @@
 #import "FBDeveloperDiskImage.h"
 #import "FBFileReader.h"
 #import "FBFileWriter.h"
+#import "FBGzipCompressor.h"
 #import "FBInstrumentsOperation.h"
 #import "FBLoggingWrapper.h"
 #import "FBProcessIO.h"
 #import "FBProcessStream.h"
+#import "FBScrcpyDemuxer.h"
 #import "FBStorageUtils.h"
 #import "FBTemporaryDirectory.h"
+#import "FBTripleBuffer.h"
 #import "FBVideoFileWriter.h"
+#import "FBVideoReplayBuffer.h"
 #import "FBVideoStream.h"
+#import "FBVideoStreamFanout.h"
+#import "FBVideoSurfaceConsumer.h"
 #import "FBWeakFramework.h"
 #import "FBWeakFramework+ApplePrivateFrameworks.h"
 #import "FBXcodeConfiguration.h"
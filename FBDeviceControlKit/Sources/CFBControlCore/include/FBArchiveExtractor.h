@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBDataConsumer.h"
+#import "FBFuture.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@protocol FBControlCoreLogger;
+
+/**
+ A Data Consumer that extracts an archive in-process as the data arrives, writing straight to files.
+ This avoids launching tar or gunzip, along with the pipes between them.
+ Data must be consumed serially, as FBFileReader and other producers do.
+ */
+@interface FBArchiveExtractor : NSObject <FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerNonContiguous>
+
+#pragma mark Initializers
+
+/**
+ Creates an extractor of a tar stream into a directory.
+ The stream can be an uncompressed tar or a gzipped tar, which is detected from the start of the stream.
+ Regular files, directories, symbolic links and hard links are extracted, with their permissions. GNU long names and pax paths are supported.
+ Entries with an absolute path, or a path that leaves the directory, fail the extraction.
+
+ @param directory the directory to extract into, which is created if it does not exist.
+ @param overrideMTime if YES the archive contents' `mtime` will be ignored. Current timestamp will be used as mtime of extracted files/directories.
+ @param logger the logger to log to.
+ @return a new extractor.
+ */
++ (instancetype)tarExtractorToDirectory:(NSString *)directory overrideModificationTime:(BOOL)overrideMTime logger:(nullable id<FBControlCoreLogger>)logger;
+
+/**
+ Creates an extractor of a gzip stream into a single file.
+
+ @param filePath the file to write the decompressed data to.
+ @param logger the logger to log to.
+ @return a new extractor.
+ */
++ (instancetype)gzipExtractorToFile:(NSString *)filePath logger:(nullable id<FBControlCoreLogger>)logger;
+
+#pragma mark Properties
+
+/**
+ The number of decompressed bytes that have been extracted.
+ */
+@property (nonatomic, assign, readonly) uint64_t bytesExtracted;
+
+/**
+ A Future that resolves when the end of the archive has been consumed and all files have been written, or fails if the archive could not be extracted.
+ */
+@property (nonatomic, strong, readonly) FBFuture<NSNull *> *finishedConsuming;
+
+@end
+
+NS_ASSUME_NONNULL_END
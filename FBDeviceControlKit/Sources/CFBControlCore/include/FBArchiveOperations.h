@@ -8,6 +8,7 @@
 #import <Foundation/Foundation.h>
 
 #import "FBFuture.h"
+#import "FBGzipCompressor.h"
 #import "FBManagedProcess.h"
 
 NS_ASSUME_NONNULL_BEGIN
@@ -23,6 +24,7 @@ typedef NS_ENUM(NSUInteger, FBCompressionFormat) {
 };
 
 @class FBProcessInput;
+@class FBProcessOutputReader;
 
 /**
  Operations of Zip/Tar Archives
@@ -66,12 +68,13 @@ typedef NS_ENUM(NSUInteger, FBCompressionFormat) {
 + (NSArray<NSString *> *)commandToExtractFromStdInWithExtractPath:(NSString *)extractPath overrideModificationTime:(BOOL)overrideMTime compression:(FBCompressionFormat)compression debugLogging:(BOOL)debugLogging;
 
 /**
- Extracts a tar, or zip stream archive to a directory.
+ Extracts a tar stream archive to a directory.
  The stream can be a:
  - An uncompressed tar.
  - A gzipped tar.
  - A zstd compressed tar
- - A zip.
+ Uncompressed and gzipped tars are extracted in-process as the stream arrives. zstd compressed tars are extracted by bsdtar.
+ Zips must be extracted from a file with `extractArchiveAtPath:toPath:overrideModificationTime:logger:`.
 
  @param stream the stream of the archive.
  @param extractPath the extraction path
@@ -83,7 +86,7 @@ typedef NS_ENUM(NSUInteger, FBCompressionFormat) {
 + (FBFuture<NSString *> *)extractArchiveFromStream:(FBProcessInput *)stream toPath:(NSString *)extractPath overrideModificationTime:(BOOL)overrideMTime logger:(id<FBControlCoreLogger>)logger compression:(FBCompressionFormat)compression;
 
 /**
- Extracts a gzip from a stream to a single file.
+ Extracts a gzip from a stream to a single file, in-process as the stream arrives.
  A plain gzip wrapping a single file is preferred when there's only a single file to transfer.
 
  @param stream the stream of the gzip archive.
@@ -127,7 +130,31 @@ typedef NS_ENUM(NSUInteger, FBCompressionFormat) {
 + (FBFuture<FBManagedProcess<NSNull *, NSInputStream *, id> *> *)createGzippedTarForPath:(NSString *)path logger:(id<FBControlCoreLogger>)logger;
 
 /**
- Creates a gzipped tar archive, returning an the data of the tar.
+ Creates a gzipped tar archive, returning a task that has a pull-based reader attached to stdout.
+ The archive is only produced as fast as the reader is read, so it can be streamed to a destination such as a device without an intermediate file.
+ To confirm that the stream has been correctly written, the caller should check the exit code of the returned task upon completion.
+
+ @param path the path to archive.
+ @param logger the logger to log to.
+ @return a Future containing a task with an FBProcessOutputReader attached to stdout.
+ */
++ (FBFuture<FBManagedProcess<NSNull *, FBProcessOutputReader *, id> *> *)createGzippedTarReaderForPath:(NSString *)path logger:(id<FBControlCoreLogger>)logger;
+
+/**
+ Writes a gzipped tar archive of a path to a consumer, in-process.
+ The tar is streamed from disk and compressed in parallel blocks as it is written, so neither the tar nor its compressed output is held in memory.
+
+ @param path the path to archive. A directory is archived with itself as the root, a file is archived relative to its parent.
+ @param consumer the consumer of the gzipped tar. It receives an end-of-file once the archive is complete.
+ @param compressionLevel the compression level, from 1 (fastest) to 9 (smallest), 0 for no compression, or FBGzipCompressionLevelDefault.
+ @param queue the queue to read the path on.
+ @param logger the logger to log to.
+ @return a Future that resolves when the archive has been written to the consumer.
+ */
++ (FBFuture<NSNull *> *)writeGzippedTarForPath:(NSString *)path toConsumer:(id<FBDataConsumer>)consumer compressionLevel:(int)compressionLevel queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger;
+
+/**
+ Creates a gzipped tar archive in-process, returning an the data of the tar.
 
  @param path the path to archive.
  @param queue the queue to do work on
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A reference to an immutable snapshot that is read without locking, for values that are read far more often than they are written.
+ Readers load the current snapshot with a single acquire load. Writers build a new snapshot and swap it in, so a reader sees either the old or the new snapshot and never a partial update.
+ A replaced snapshot may still be in use by a reader that loaded it just before the swap, so it is retired rather than released, and retired snapshots are released with the reference. This suits values that change a handful of times in the lifetime of the reference.
+
+ -load may be called from any thread. -store: must be serialized by the caller.
+ */
+@interface FBAtomicSnapshot : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param snapshot the initial snapshot.
+ @return a new Atomic Snapshot.
+ */
+- (instancetype)initWithSnapshot:(id)snapshot NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+#pragma mark Public Methods
+
+/**
+ Loads the current snapshot.
+
+ @return the current snapshot.
+ */
+- (id)load;
+
+/**
+ Replaces the current snapshot, retiring the previous one.
+
+ @param snapshot the new snapshot.
+ */
+- (void)store:(id)snapshot;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Up to two contiguous regions of an Audio Ring Buffer, in order. The second region is only used when the first wraps around the end of the storage.
+ */
+typedef struct {
+  float *_Nullable first;
+  NSUInteger firstCount;
+  float *_Nullable second;
+  NSUInteger secondCount;
+} FBAudioRingBufferSegments;
+
+/**
+ A ring of float samples between one producer and one consumer, which never locks or allocates after it has been created.
+ The capacity is a power of two, so that positions wrap with a mask. The read and write positions are monotonic atomic counters, each advanced by one side only. The producer releases the samples it has written when advancing the write position, and the consumer releases the space it has read when advancing the read position.
+ Bulk reads and writes are at most two memcpy calls, one either side of the wrap.
+
+ -write:count:, -writableSegments and -commitWrite: must only be called from the producer. -read:count:, -skip:, -readableSegments and -commitRead: must only be called from the consumer. -reset must only be called when neither side is running.
+ */
+@interface FBAudioRingBuffer : NSObject
+
+#pragma mark Initializers
+
+/**
+ Creates a ring buffer.
+
+ @param minimumCapacity the minimum number of samples the buffer can hold. It is rounded up to a power of two.
+ @return a new ring buffer.
+ */
+- (instancetype)initWithMinimumCapacity:(NSUInteger)minimumCapacity;
+
+#pragma mark Producer
+
+/**
+ Copies samples into the buffer.
+
+ @param samples the samples to write.
+ @param count the number of samples to write.
+ @return the number of samples written, which is less than count if the buffer is full.
+ */
+- (NSUInteger)write:(const float *)samples count:(NSUInteger)count;
+
+/**
+ The free space of the buffer, for writing samples in place.
+
+ @return the writable regions. Samples written to them are only visible to the consumer after -commitWrite:.
+ */
+- (FBAudioRingBufferSegments)writableSegments;
+
+/**
+ Publishes samples that have been written in place to the consumer.
+
+ @param count the number of samples written to the start of the writable regions.
+ */
+- (void)commitWrite:(NSUInteger)count;
+
+#pragma mark Consumer
+
+/**
+ Copies samples out of the buffer.
+
+ @param samples the destination for the samples.
+ @param count the maximum number of samples to read.
+ @return the number of samples read, which is less than count if the buffer does not hold enough.
+ */
+- (NSUInteger)read:(float *)samples count:(NSUInteger)count;
+
+/**
+ Discards the oldest samples.
+
+ @param count the maximum number of samples to discard.
+ @return the number of samples discarded.
+ */
+- (NSUInteger)skip:(NSUInteger)count;
+
+/**
+ The samples in the buffer, for reading or modifying them in place.
+
+ @return the readable regions, oldest first. They remain valid until -commitRead:.
+ */
+- (FBAudioRingBufferSegments)readableSegments;
+
+/**
+ Releases samples that have been read in place back to the producer.
+
+ @param count the number of samples read from the start of the readable regions.
+ */
+- (void)commitRead:(NSUInteger)count;
+
+#pragma mark Other
+
+/**
+ Discards all of the samples.
+ */
+- (void)reset;
+
+#pragma mark Properties
+
+/**
+ The number of samples that the buffer can hold.
+ */
+@property (nonatomic, assign, readonly) NSUInteger capacity;
+
+/**
+ The number of samples that can be read. May be read from any thread.
+ */
+@property (nonatomic, assign, readonly) NSUInteger availableToRead;
+
+/**
+ The number of samples that can be written. May be read from any thread.
+ */
+@property (nonatomic, assign, readonly) NSUInteger availableToWrite;
+
+@end
+
+NS_ASSUME_NONNULL_END
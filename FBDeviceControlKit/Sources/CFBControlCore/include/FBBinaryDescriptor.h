@@ -36,6 +36,8 @@ extern FBBinaryArchitecture const FBBinaryArchitectureArm64;
 
 /**
  Returns the FBBinaryDescriptor for the given binary path, by parsing the binary.
+ The binary is mapped and its headers and load commands are read in a single pass, so the descriptor answers all of its properties, and rpaths, without reading the binary again.
+ Descriptors are cached in the shared FBDescriptorCache, so a binary that is unchanged since it was last parsed is not parsed again.
 
  @param path the path to the binary.
  @param error an error out for any error that occurs.
@@ -43,6 +45,14 @@ extern FBBinaryArchitecture const FBBinaryArchitectureArm64;
  */
 + (nullable instancetype)binaryWithPath:(NSString *)path error:(NSError **)error;
 
+/**
+ Creates a Binary Descriptor from a representation obtained from -propertyListRepresentation, without parsing the binary.
+
+ @param representation the property list representation.
+ @return a Binary Descriptor if the representation is valid, nil otherwise.
+ */
++ (nullable instancetype)fromPropertyListRepresentation:(NSDictionary<NSString *, id> *)representation;
+
 #pragma mark Properties
 
 /**
@@ -60,11 +70,28 @@ extern FBBinaryArchitecture const FBBinaryArchitectureArm64;
  */
 @property (nonatomic, copy, nullable, readonly) NSUUID *uuid;
 
+/**
+ The LC_UUID of each architecture of the binary, for matching against the slices of a dSYM.
+ Empty if the binary was not parsed.
+ */
+@property (nonatomic, copy, readonly) NSDictionary<FBBinaryArchitecture, NSUUID *> *uuidsByArchitecture;
+
+/**
+ The install names of the dylibs that the binary links against, in load order and across all architectures.
+ Empty if the binary was not parsed.
+ */
+@property (nonatomic, copy, readonly) NSArray<NSString *> *linkedLibraries;
+
 /**
  The file path to the executable.
  */
 @property (nonatomic, copy, readonly) NSString *path;
 
+/**
+ A property list representation of the parsed information, so that it can be persisted and restored without parsing the binary again.
+ */
+@property (nonatomic, copy, readonly) NSDictionary<NSString *, id> *propertyListRepresentation;
+
 #pragma mark Public Methods
 
 /**
@@ -37,6 +37,7 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  An initializer for FBBundleDescriptor that obtains information by inflating via NSBundle.
  This requires that a CFBundleIdentifier is set in the bundle's Info.plist.
+ Descriptors are cached in the shared FBDescriptorCache, so a bundle whose Info.plist and executable are unchanged since it was last inflated is not inflated again.
 
  @param path the path of the bundle to use.
  @param error an error out for any error that occurs
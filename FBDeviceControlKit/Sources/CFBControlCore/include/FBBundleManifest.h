@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A record of the contents of a bundle on disk, with a digest of each file.
+ Manifests can be compared to find the files of a bundle that have changed between builds.
+ */
+@interface FBBundleManifest : NSObject
+
+#pragma mark Initializers
+
+/**
+ Creates a Manifest by hashing the files of a bundle.
+ Files whose size and modification date are the same as in the previous manifest are not hashed again, their digest is taken from the previous manifest.
+
+ @param path the path of the bundle.
+ @param previousManifest a manifest of an earlier build of the same bundle, nil to hash every file.
+ @param error an error out for any error that occurs.
+ @return a manifest of the bundle, nil on error.
+ */
++ (nullable instancetype)manifestForBundleAtPath:(NSString *)path previousManifest:(nullable FBBundleManifest *)previousManifest error:(NSError **)error;
+
+/**
+ Creates a Manifest from a representation obtained from -propertyListRepresentation, without reading the bundle.
+
+ @param representation the property list representation.
+ @return a Manifest if the representation is valid, nil otherwise.
+ */
++ (nullable instancetype)fromPropertyListRepresentation:(NSDictionary<NSString *, id> *)representation;
+
+#pragma mark Public Methods
+
+/**
+ The files that differ between the receiver and another manifest.
+
+ @param manifest the manifest to compare against, nil if there is no earlier manifest.
+ @return the paths, relative to the bundle, of files that have been added, changed or removed.
+ */
+- (NSArray<NSString *> *)pathsChangedFromManifest:(nullable FBBundleManifest *)manifest;
+
+#pragma mark Properties
+
+/**
+ A digest of the contents of the whole bundle, that is equal for bundles with the same files and contents.
+ */
+@property (nonatomic, copy, readonly) NSString *digest;
+
+/**
+ The digest of each file, keyed by its path relative to the bundle.
+ */
+@property (nonatomic, copy, readonly) NSDictionary<NSString *, NSString *> *digestsByPath;
+
+/**
+ The total size of the files in the bundle, in bytes.
+ */
+@property (nonatomic, assign, readonly) unsigned long long totalSize;
+
+/**
+ A property list representation of the manifest, so that it can be persisted and compared against later builds.
+ */
+@property (nonatomic, copy, readonly) NSDictionary<NSString *, id> *propertyListRepresentation;
+
+@end
+
+NS_ASSUME_NONNULL_END
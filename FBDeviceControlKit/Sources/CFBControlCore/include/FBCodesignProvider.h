@@ -53,7 +53,9 @@ NS_ASSUME_NONNULL_BEGIN
 - (FBFuture<NSNull *> *)signBundleAtPath:(NSString *)bundlePath;
 
 /**
- Requests that the receiver codesigns a bundle and all bundles within its Frameworks directory.
+ Requests that the receiver codesigns a bundle and all bundles within its Frameworks and PlugIns directories, recursively.
+ Nested bundles are signed before the bundle that contains them, and bundles at the same level are signed in parallel.
+ Bundles that this process has already signed with the same identity, and whose content has not changed since, are not signed again.
 
  @param bundlePath path to bundle that should be signed.
  @return A future that resolves when the bundle has been signed.
@@ -62,6 +64,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  Attempts to fetch the CDHash of a bundle.
+ The CDHash is cached for as long as the signed content of the bundle is unchanged.
 
  @param bundlePath the file path to the bundle.
  @return A future that resolves with the CDHash.
@@ -29,6 +29,15 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (NSString *)oneLineDescriptionFromArray:(NSArray *)array atKeyPath:(NSString *)keyPath;
 
+/**
+ Creates an object whose -[NSObject description] is the One-Line Array description of the array.
+ The description is only constructed when it is first read, so this is suitable for error messages that may never be shown.
+ The array is copied, so later mutations do not affect the description.
+
+ @param array the Array to construct a description for.
+ */
++ (id)lazyOneLineDescriptionFromArray:(NSArray *)array;
+
 /**
  Creates a One-Line Array description from the Dictionary.
 
@@ -7,6 +7,8 @@
 
 #import <Foundation/Foundation.h>
 
+#import "FBDataConsumer.h"
+
 NS_ASSUME_NONNULL_BEGIN
 
 /**
@@ -17,6 +19,67 @@ NS_ASSUME_NONNULL_BEGIN
 
 + (nullable NSDictionary<NSString *, id> *)parseConcatenatedJSONFromString:(NSString *)str error:(NSError **)error;
 
+/**
+ Enumerates the members of each of the concatenated JSON objects in data, without decoding them.
+ Values that are not needed are skipped over without being decoded, so the cost of a member is a scan of its bytes. Nothing after the point that enumeration is stopped is read.
+
+ @param data the data to enumerate, which may be memory-mapped.
+ @param error an error out for malformed or truncated JSON.
+ @param block called with the key and the encoded bytes of each member's value. The value refers to the bytes of data rather than a copy, so must not be used after data is released.
+ @return YES if the data was enumerated until the end, or until stopped, NO if the data is malformed.
+ */
++ (BOOL)enumerateMembersOfConcatenatedJSONData:(NSData *)data error:(NSError **)error usingBlock:(void (^)(NSString *key, NSData *value, BOOL *stop))block;
+
+/**
+ Enumerates the elements of an encoded JSON array, without decoding them.
+
+ @param data the encoded array, for example a value from enumerateMembersOfConcatenatedJSONData:error:usingBlock:.
+ @param error an error out for malformed or truncated JSON.
+ @param block called with the encoded bytes and index of each element, which refer to the bytes of data.
+ @return YES if the array was enumerated until the end, or until stopped, NO if it is malformed.
+ */
++ (BOOL)enumerateElementsOfJSONArrayData:(NSData *)data error:(NSError **)error usingBlock:(void (^)(NSData *element, NSUInteger index, BOOL *stop))block;
+
+/**
+ Decodes an encoded JSON value, which may be a scalar.
+
+ @param data the encoded value.
+ @return the decoded value, nil if it is malformed.
+ */
++ (nullable id)decodeJSONValue:(NSData *)data;
+
+@end
+
+/**
+ Parses concatenated JSON as it is consumed, so that a stream can be parsed without holding all of it.
+ The brace depth and string state are carried between chunks, each top-level object or array is decoded as soon as its closing bracket is consumed.
+ Data should be consumed from a single producer at a time.
+ */
+@interface FBConcatenatedJSONStreamParser : NSObject <FBDataConsumer, FBDataConsumerSync, FBDataConsumerNonContiguous>
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param handler called with each top-level value, in the order they are consumed, on the thread that consumes the data.
+ @return a new parser.
+ */
++ (instancetype)parserWithValueHandler:(void (^)(id value))handler;
+
+#pragma mark Properties
+
+/**
+ The first error in the stream, either a malformed value or a stream that ended within a value.
+ Data consumed after an error is ignored.
+ */
+@property (nonatomic, strong, nullable, readonly) NSError *error;
+
+/**
+ The number of top-level values that have been decoded.
+ */
+@property (nonatomic, assign, readonly) NSUInteger valueCount;
+
 @end
 
 NS_ASSUME_NONNULL_END
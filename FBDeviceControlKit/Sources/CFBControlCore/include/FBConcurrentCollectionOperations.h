@@ -33,6 +33,27 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (NSArray *)map:(NSArray *)array withBlock:( id(^)(id object) )block;
 
+/**
+ Generate an array of objects from indices, with a bound on the number of blocks that run at once. Indices where nil is returned will contain `NSNull.null`
+
+ @param count the number of generations to execute
+ @param maxConcurrency the maximum number of blocks that run at once. Must be greater than 0.
+ @param block the block to generate objects from.
+ @return a Generated Array of Objects.
+ */
++ (NSArray *)generate:(NSUInteger)count maxConcurrency:(NSUInteger)maxConcurrency withBlock:( id(^)(NSUInteger index) )block;
+
+/**
+ Map an array of objects concurrently, with a bound on the number of blocks that run at once.
+ This is for blocks that use a shared resource, such as a connection to a device service, which would be flooded if every object were mapped at once.
+
+ @param array the array to map.
+ @param maxConcurrency the maximum number of blocks that run at once. Must be greater than 0.
+ @param block the block to map objects with.
+ @return a Mapped Array of Objects.
+ */
++ (NSArray *)map:(NSArray *)array maxConcurrency:(NSUInteger)maxConcurrency withBlock:( id(^)(id object) )block;
+
 /**
  Filter an array of objects concurrently.
 
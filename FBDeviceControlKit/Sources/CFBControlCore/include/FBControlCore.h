@@ -10,9 +10,13 @@
 #import "FBApplicationCommands.h"
 #import "FBApplicationLaunchConfiguration.h"
 #import "FBArchitecture.h"
+#import "FBArchiveExtractor.h"
 #import "FBArchiveOperations.h"
+#import "FBAtomicSnapshot.h"
+#import "FBAudioRingBuffer.h"
 #import "FBBinaryDescriptor.h"
 #import "FBBundleDescriptor+Application.h"
+#import "FBBundleManifest.h"
 #import "FBCodesignProvider.h"
 #import "FBCollectionInformation.h"
 #import "FBCollectionOperations.h"
@@ -24,10 +28,13 @@
 #import "FBCrashLog.h"
 #import "FBCrashLogCommands.h"
 #import "FBCrashLogNotifier.h"
+#import "FBCrashLogQuery.h"
+#import "FBCrashLogSymbolicator.h"
 #import "FBCrashLogStore.h"
 #import "FBDapServerCommands.h"
 #import "FBDataBuffer.h"
 #import "FBDataConsumer.h"
+#import "FBDescriptorCache.h"
 #import "FBDebuggerCommands.h"
 #import "FBDeveloperDiskImage.h"
 #import "FBDeveloperDiskImageCommands.h"
@@ -42,6 +49,9 @@
 #import "FBFuture+Sync.h"
 #import "FBFuture.h"
 #import "FBFutureContextManager.h"
+#import "FBFutureContextPool.h"
+#import "FBFutureProfiler.h"
+#import "FBGzipCompressor.h"
 #import "FBInstalledApplication.h"
 #import "FBInstrumentsCommands.h"
 #import "FBInstrumentsConfiguration.h"
@@ -58,6 +68,7 @@
 #import "FBLogCommands.h"
 #import "FBLoggingWrapper.h"
 #import "FBMemoryCommands.h"
+#import "FBMetricsRegistry.h"
 #import "FBNotificationCommands.h"
 #import "FBPowerCommands.h"
 #import "FBManagedProcess.h"
@@ -71,6 +82,7 @@
 #import "FBProcessStream.h"
 #import "FBProcessTerminationStrategy.h"
 #import "FBProvisioningProfileCommands.h"
+#import "FBScrcpyDemuxer.h"
 #import "FBScreenshotCommands.h"
 #import "FBServiceManagement.h"
 #import "FBSettingsCommands.h"
@@ -78,11 +90,15 @@
 #import "FBStorageUtils.h"
 #import "FBTemporaryDirectory.h"
 #import "FBTestLaunchConfiguration.h"
+#import "FBTripleBuffer.h"
 #import "FBVideoFileWriter.h"
 #import "FBVideoRecordingCommands.h"
+#import "FBVideoReplayBuffer.h"
 #import "FBVideoStream.h"
 #import "FBVideoStreamCommands.h"
 #import "FBVideoStreamConfiguration.h"
+#import "FBVideoStreamFanout.h"
+#import "FBVideoSurfaceConsumer.h"
 #import "FBWeakFramework+ApplePrivateFrameworks.h"
 #import "FBXcodeConfiguration.h"
 #import "FBXcodeDirectory.h"
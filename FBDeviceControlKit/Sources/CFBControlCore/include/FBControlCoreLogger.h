@@ -76,6 +76,14 @@ typedef NS_ENUM(NSUInteger, FBControlCoreLogLevel) {
  */
 - (id<FBControlCoreLogger>)withDateFormatEnabled:(BOOL)enabled;
 
+/**
+ Returns whether messages at a level would be recorded, so that messages that would be discarded need not be built.
+
+ @param level the level to check. FBControlCoreLogLevelMultiple checks each logger of a composite at its own level.
+ @return YES if messages at the level are recorded, NO otherwise.
+ */
+- (BOOL)isEnabledForLevel:(FBControlCoreLogLevel)level;
+
 #pragma mark Properties
 
 /**
@@ -90,6 +98,18 @@ typedef NS_ENUM(NSUInteger, FBControlCoreLogLevel) {
 
 @end
 
+/**
+ Logs a Message with the provided Format String, only if the logger is enabled at its own level.
+ The format arguments are not evaluated when the logger is disabled, so this is preferable for messages on hot paths.
+ */
+#define FBControlCoreLogFormat(logger, format, ...) \
+  do { \
+    id<FBControlCoreLogger> _fbLogger = (logger); \
+    if ([_fbLogger isEnabledForLevel:_fbLogger.level]) { \
+      [_fbLogger logFormat:format, ##__VA_ARGS__]; \
+    } \
+  } while (0)
+
 /**
   A composite logger that logs to many loggers
  */
@@ -154,6 +174,25 @@ typedef NS_ENUM(NSUInteger, FBControlCoreLogLevel) {
  */
 + (id<FBControlCoreLogger>)loggerToFileDescriptor:(int)fileDescriptor closeOnEndOfFile:(BOOL)closeOnEndOfFile;
 
+/**
+ Log to a Consumer, without blocking the caller.
+ Messages are queued without taking a lock, then formatted and written to the consumer in batches on a background queue.
+ Timestamps, when enabled, are the seconds since the logger was created. Each logger drops messages beyond a fixed rate, logging how many were dropped.
+
+ @param consumer the consumer to write data to.
+ @return a logger instance.
+ */
++ (id<FBControlCoreLogger>)asyncLoggerToConsumer:(id<FBDataConsumer>)consumer;
+
+/**
+ Wraps a logger so that logging doesn't block the caller, for use on hot paths such as per-frame callbacks.
+ Messages are forwarded to the wrapped logger in order on a background queue, with the same rate limiting as `asyncLoggerToConsumer:`.
+
+ @param logger the logger to wrap.
+ @return a logger instance.
+ */
++ (id<FBControlCoreLogger>)asyncLoggerWithLogger:(id<FBControlCoreLogger>)logger;
+
 /**
  Strips the newline and returns a nullable string if the string shouldn't be logged.
 
@@ -23,6 +23,15 @@ typedef NS_OPTIONS(NSUInteger, FBCrashLogInfoProcessType) {
   FBCrashLogInfoProcessTypeCustom = 1 << 2, /** A process that not an application nor part of the operating system runtime **/
 };
 
+/**
+ Fetches the full contents of a crash log whose header has been parsed without them.
+
+ @param destination the path that the contents should be written to.
+ @param error an error out for any error that occurs.
+ @return YES if the contents were written to the destination, NO otherwise.
+ */
+typedef BOOL (^FBCrashLogContentsFetcher)(NSString *destination, NSError **error);
+
 /**
  Information about Crash Logs.
  */
@@ -111,6 +120,28 @@ typedef NS_OPTIONS(NSUInteger, FBCrashLogInfoProcessType) {
  */
 + (nullable instancetype)fromCrashLogAtPath:(NSString *)path error:(NSError **)error;
 
+/**
+ Creates Crash Log Info from the start of a crash log, without the rest of its contents.
+ Only crash logs that keep all of the information in their header can be parsed from a header alone, this is the case for plain-text crash logs.
+ The contents are fetched when they are first needed, after which they are at the crash path.
+
+ @param data the start of the crash log.
+ @param crashPath the path that the contents of the crash log will be at once fetched.
+ @param contentsFetcher fetches the contents to the crash path.
+ @param error an error out for any error that occurs.
+ @return a Crash Log Info on success, nil otherwise.
+ */
++ (nullable instancetype)fromCrashLogHeaderData:(NSData *)data crashPath:(NSString *)crashPath contentsFetcher:(FBCrashLogContentsFetcher)contentsFetcher error:(NSError **)error;
+
+/**
+ Creates Crash Log Info from a representation obtained from -propertyListRepresentation, without parsing the crash log.
+
+ @param representation the property list representation.
+ @param crashPath the path of the crash log.
+ @return a Crash Log Info if the representation is valid, nil otherwise.
+ */
++ (nullable instancetype)fromPropertyListRepresentation:(NSDictionary<NSString *, id> *)representation crashPath:(NSString *)crashPath;
+
 
 #pragma mark Public Methods
 
@@ -122,6 +153,19 @@ typedef NS_OPTIONS(NSUInteger, FBCrashLogInfoProcessType) {
  */
 + (BOOL)isParsableCrashLog:(NSData *)data;
 
+/**
+ Determines whether a crash log can be parsed from its header alone.
+
+ @param data the start of the crash log.
+ @return YES if the crash log is of a format with all of its information in the header, NO otherwise.
+ */
++ (BOOL)isParsableFromHeader:(NSData *)data;
+
+/**
+ A property list representation of the parsed information, excluding the crash path, so that it can be persisted and restored without parsing the crash log again.
+ */
+@property (nonatomic, copy, readonly) NSDictionary<NSString *, id> *propertyListRepresentation;
+
 #pragma mark Bulk Collection
 
 /**
@@ -149,6 +193,10 @@ typedef NS_OPTIONS(NSUInteger, FBCrashLogInfoProcessType) {
 
 #pragma mark Predicates
 
+/**
+ Predicates compare properties of FBCrashLogInfo, so that stores of crash logs can answer them from an index, rather than evaluating every crash log.
+ */
+
 /**
  A Predicate for FBCrashLogInfo that passes for all Crash Logs with certain process info.
 
@@ -35,6 +35,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  Starts listening for crash logs.
+ Crash logs are observed with an FSEvents stream on the diagnostic reports directories, so only newly written files are read and nothing is done while no crash logs are written.
 
  @param onlyNew YES if you only want to ingest crash logs from now, NO to ingest from the beginning of time.
  @return success.
@@ -11,6 +11,12 @@ NS_ASSUME_NONNULL_BEGIN
 
 @protocol FBCrashLogParser <NSObject>
 -(void)parseCrashLogFromString:(NSString *)str executablePathOut:(NSString *_Nonnull * _Nonnull)executablePathOut identifierOut:(NSString *_Nonnull * _Nonnull)identifierOut processNameOut:(NSString *_Nonnull * _Nonnull)processNameOut parentProcessNameOut:(NSString *_Nonnull * _Nonnull)parentProcessNameOut processIdentifierOut:(pid_t *)processIdentifierOut parentProcessIdentifierOut:(pid_t *)parentProcessIdentifierOut dateOut:(NSDate *_Nonnull * _Nonnull)dateOut  exceptionDescription:(NSString *_Nonnull * _Nonnull)exceptionDescription crashedThreadDescription:(NSString *_Nonnull * _Nonnull)crashedThreadDescription error:(NSError **)error;
+
+/**
+ The same as parseCrashLogFromString: but from the bytes of the crash log, which may be memory-mapped.
+ Only as much of the data as is needed to find the fields is read, and the data is never converted to a string in its entirety.
+ */
+-(void)parseCrashLogFromData:(NSData *)data executablePathOut:(NSString *_Nonnull * _Nonnull)executablePathOut identifierOut:(NSString *_Nonnull * _Nonnull)identifierOut processNameOut:(NSString *_Nonnull * _Nonnull)processNameOut parentProcessNameOut:(NSString *_Nonnull * _Nonnull)parentProcessNameOut processIdentifierOut:(pid_t *)processIdentifierOut parentProcessIdentifierOut:(pid_t *)parentProcessIdentifierOut dateOut:(NSDate *_Nonnull * _Nonnull)dateOut  exceptionDescription:(NSString *_Nonnull * _Nonnull)exceptionDescription crashedThreadDescription:(NSString *_Nonnull * _Nonnull)crashedThreadDescription error:(NSError **)error;
 @end
 
 /**
@@ -19,9 +25,20 @@ NS_ASSUME_NONNULL_BEGIN
  1. The layout can be changed by apple easily
  2. Json structure inself can be easily changed
  3. Crashes is not often happening operation of idb
- we prefer reliability over performance gain here and parse all json strings finding the fields that we need in all of json entries
+ we scan the members of all of the json strings for the fields that we need, rather than relying on where they are.
+ Members that are not needed are skipped without being decoded, and scanning stops once all of the fields have been found, which for most reports is well before the end.
+ Where a field is present in more than one json string, the first is used.
 */
 @interface FBConcatedJSONCrashLogParser : NSObject <FBCrashLogParser>
+
+/**
+ Decodes the frames of the thread that triggered the crash. The other threads are skipped without being decoded.
+
+ @param threads the encoded "threads" member of a crash log.
+ @return the frames of the crashed thread, nil if no thread triggered the crash.
+ */
++ (nullable NSArray<NSDictionary *> *)framesOfCrashedThread:(NSData *)threads;
+
 @end
 
 /**
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBCrashLogInfo;
+
+/**
+ A typed query for crash logs, the equivalent of a conjunction of the FBCrashLogInfo predicates.
+ Queries are matched by comparing the properties of FBCrashLogInfo directly, rather than evaluating a predicate through Key-Value Coding.
+ Queries are immutable, each of the builder methods returns a new query that matches a subset of the receiver.
+ */
+@interface FBCrashLogQuery : NSObject <NSCopying>
+
+#pragma mark Initializers
+
+/**
+ A query that matches all crash logs.
+ */
++ (instancetype)query;
+
+#pragma mark Builders
+
+/**
+ Matches crash logs with a given name.
+
+ @param name the name of the crash log.
+ @return a new query.
+ */
+- (instancetype)withName:(NSString *)name;
+
+/**
+ Matches crash logs with a given identifier.
+
+ @param identifier the identifier of the crash log.
+ @return a new query.
+ */
+- (instancetype)withIdentifier:(NSString *)identifier;
+
+/**
+ Matches crash logs of any of the given processes.
+
+ @param processNames the names of the processes.
+ @return a new query.
+ */
+- (instancetype)withProcessNames:(NSSet<NSString *> *)processNames;
+
+/**
+ Matches crash logs of the process with a given process identifier.
+
+ @param processIdentifier the process identifier.
+ @return a new query.
+ */
+- (instancetype)withProcessIdentifier:(pid_t)processIdentifier;
+
+/**
+ Matches crash logs within a range of dates, as +[FBCrashLogInfo predicateNewerThanDate:] and +[FBCrashLogInfo predicateOlderThanDate:] do.
+
+ @param newerThan crash logs must be strictly newer than this date, nil for no lower bound.
+ @param olderThan crash logs must be no newer than this date, nil for no upper bound.
+ @return a new query.
+ */
+- (instancetype)withDatesNewerThan:(nullable NSDate *)newerThan olderThan:(nullable NSDate *)olderThan;
+
+/**
+ Matches crash logs whose executable path contains a substring.
+
+ @param substring the substring to search for.
+ @return a new query.
+ */
+- (instancetype)withExecutablePathContaining:(NSString *)substring;
+
+#pragma mark Properties
+
+/**
+ The name to match, if any.
+ */
+@property (nonatomic, copy, nullable, readonly) NSString *name;
+
+/**
+ The identifier to match, if any.
+ */
+@property (nonatomic, copy, nullable, readonly) NSString *identifier;
+
+/**
+ The process names to match, if any.
+ */
+@property (nonatomic, copy, nullable, readonly) NSSet<NSString *> *processNames;
+
+/**
+ The process identifier to match, if any.
+ */
+@property (nonatomic, copy, nullable, readonly) NSNumber *processIdentifier;
+
+/**
+ The exclusive lower bound of the date, if any.
+ */
+@property (nonatomic, copy, nullable, readonly) NSDate *newerThan;
+
+/**
+ The inclusive upper bound of the date, if any.
+ */
+@property (nonatomic, copy, nullable, readonly) NSDate *olderThan;
+
+/**
+ The substring of the executable path to match, if any.
+ */
+@property (nonatomic, copy, nullable, readonly) NSString *executablePathSubstring;
+
+/**
+ A predicate that evaluates the query, for the interfaces that accept predicates.
+ */
+@property (nonatomic, copy, readonly) NSPredicate *predicate;
+
+#pragma mark Public Methods
+
+/**
+ Determines whether a crash log matches the query.
+
+ @param crashLog the crash log to match.
+ @return YES if the crash log matches, NO otherwise.
+ */
+- (BOOL)matchesCrashLog:(FBCrashLogInfo *)crashLog;
+
+@end
+
+NS_ASSUME_NONNULL_END
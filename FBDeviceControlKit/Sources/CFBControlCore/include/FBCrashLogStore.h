@@ -7,11 +7,13 @@
 
 #import <Foundation/Foundation.h>
 
+#import "FBCrashLog.h"
 #import "FBFuture.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
-@class FBCrashLogInfo;
+@class FBCrashLogQuery;
+
 @protocol FBControlCoreLogger;
 
 /**
@@ -30,6 +32,17 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (instancetype)storeForDirectories:(NSArray<NSString *> *)directories logger:(id<FBControlCoreLogger>)logger;
 
+/**
+ Constructs a store that persists an index of the crash logs it has ingested.
+ The index holds the parsed information of each crash log, so that crash logs do not need to be parsed again when a store is next created.
+
+ @param directories the directories to store into.
+ @param indexPath the file to persist the index to, nil to not persist it.
+ @param logger the logger to use.
+ @return a store for the device.
+ */
++ (instancetype)storeForDirectories:(NSArray<NSString *> *)directories indexPath:(nullable NSString *)indexPath logger:(id<FBControlCoreLogger>)logger;
+
 #pragma mark Ingestion
 
 /**
@@ -56,6 +69,34 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable FBCrashLogInfo *)ingestCrashLogData:(NSData *)data name:(NSString *)name;
 
+/**
+ Ingest the start of a crash log, deferring the fetch of its contents until they are needed.
+
+ @param data the start of the crash log.
+ @param name the name of the crash log.
+ @param contentsFetcher fetches the contents of the crash log into the store.
+ @return the crash log info if the header could be parsed.
+ */
+- (nullable FBCrashLogInfo *)ingestCrashLogHeaderData:(NSData *)data name:(NSString *)name contentsFetcher:(FBCrashLogContentsFetcher)contentsFetcher;
+
+/**
+ Records that a crash log of a given size has been seen at its source, regardless of whether it could be ingested.
+ This means that crash logs that cannot be parsed are not fetched again, unless their size changes.
+
+ @param name the name of the crash log.
+ @param size the size of the crash log at its source.
+ */
+- (void)recordSeenCrashLogWithName:(NSString *)name size:(uint64_t)size;
+
+/**
+ Determines whether a crash log needs to be fetched from its source.
+
+ @param name the name of the crash log.
+ @param size the size of the crash log at its source.
+ @return YES if a crash log of the same name and size has been seen, NO otherwise.
+ */
+- (BOOL)hasSeenCrashLogWithName:(NSString *)name size:(uint64_t)size;
+
 /**
  Removes the crash log at at a given path.
 
@@ -91,6 +132,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  Obtains all of the ingested logs that match the given predicate.
+ Comparisons of the name, identifier, process name, process identifier and date, such as those from the FBCrashLogInfo predicates, are looked up rather than evaluated against every ingested log.
 
  @param predicate the predicate to use.
  @return an array of all the ingested crash logs.
@@ -105,6 +147,23 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (NSArray<FBCrashLogInfo *> *)pruneCrashLogsMatchingPredicate:(NSPredicate *)predicate;
 
+/**
+ Obtains all of the ingested logs that match the given query.
+ The candidates are looked up by the most selective part of the query, then compared field by field, without evaluating a predicate.
+
+ @param query the query to use.
+ @return an array of all the matching crash logs.
+ */
+- (NSArray<FBCrashLogInfo *> *)ingestedCrashLogsMatchingQuery:(FBCrashLogQuery *)query;
+
+/**
+ Prunes all of the ingested logs that match the given query.
+
+ @param query the query to use.
+ @return an array of all the pruned crash logs.
+ */
+- (NSArray<FBCrashLogInfo *> *)pruneCrashLogsMatchingQuery:(FBCrashLogQuery *)query;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBCrashLog;
+
+@protocol FBControlCoreLogger;
+
+/**
+ Symbolicates Crash Logs in-process, from the symbol tables of the binaries and dSYMs that are added to it.
+ Binaries are registered against their UUIDs from their load commands, which is cheap and cached by FBBinaryDescriptor.
+ The symbol table of a binary is only read the first time that a frame in it is resolved, where it is built into an index of symbols sorted by address.
+ When an index directory is provided the index is written to it, keyed by UUID, and is subsequently mapped from there rather than being built again.
+ Frames are resolved by a binary search of the index, so symbolicating many crash logs against the same binaries does not read their symbol tables again.
+ Only 64-bit slices are indexed.
+ */
+@interface FBCrashLogSymbolicator : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param indexDirectory the directory to persist symbol indices in, nil to keep them in memory only.
+ @param logger the logger to use.
+ @return a new Symbolicator.
+ */
++ (instancetype)symbolicatorWithIndexDirectory:(nullable NSString *)indexDirectory logger:(nullable id<FBControlCoreLogger>)logger;
+
+#pragma mark Public Methods
+
+/**
+ Registers the UUIDs of a binary, so that frames within it can be symbolicated.
+
+ @param path the path to a Mach-O binary, or to a .dSYM bundle.
+ @param error an error out for any error that occurs.
+ @return YES if the binary was registered, NO otherwise.
+ */
+- (BOOL)addBinaryAtPath:(NSString *)path error:(NSError **)error;
+
+/**
+ Registers all of the Mach-O binaries and .dSYM bundles within a directory, such as one produced by -[FBDeviceDebugSymbolsCommands pullAndExtractSymbolsToDestinationDirectory:].
+ Files that are not Mach-O binaries are skipped.
+
+ @param directory the directory to search.
+ @return the number of binaries that were registered.
+ */
+- (NSUInteger)addBinariesInDirectory:(NSString *)directory;
+
+/**
+ Resolves an address within an image to a symbol.
+
+ @param offset the offset of the address from the load address of the image.
+ @param uuid the UUID of the image.
+ @return the symbol and the offset into it, in the form "symbol + 12". nil if the image is not registered or no symbol precedes the address.
+ */
+- (nullable NSString *)symbolForOffset:(uint64_t)offset inImageWithUUID:(NSUUID *)uuid;
+
+/**
+ Symbolicates the crashed thread of a json (.ips) crash log.
+ Frames that are already symbolicated in the crash log are kept, those that cannot be resolved are described by their image and offset.
+
+ @param crashLog the crash log to symbolicate.
+ @param error an error out for any error that occurs.
+ @return a description of the crashed thread in the same form as -[FBCrashLogInfo crashedThreadDescription], nil if the crash log could not be read.
+ */
+- (nullable NSString *)symbolicatedCrashedThreadOfCrashLog:(FBCrashLog *)crashLog error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -26,6 +26,33 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (NSArray<NSString *> *)lines;
 
+/**
+ Enumerates the lines of the current output data, without creating a string for each line.
+ The bytes passed to the block are borrowed and are only valid for the duration of the call. A final line without a newline is also enumerated.
+
+ @param block the block to call for each line, set stop to YES to end the enumeration.
+ */
+- (void)enumerateLinesUsingBlock:(void (^)(const char *bytes, size_t length, BOOL *stop))block;
+
+@end
+
+/**
+ A buffer that holds a bounded amount of data: the start of the data, followed by the most recent data.
+ Memory is predictable however much is consumed, which suits the output of chatty processes.
+ */
+@protocol FBBoundedBuffer <FBAccumulatingBuffer>
+
+/**
+ The number of bytes between the start and the most recent data, that are not held by the buffer.
+ */
+@property (nonatomic, assign, readonly) uint64_t droppedBytes;
+
+/**
+ When spilling, the file that the dropped bytes are written to, in order. Nil if nothing has been dropped, or if the file could not be written.
+ The complete data is the head of `data`, followed by this file, followed by the tail of `data`. The file is not removed by the buffer.
+ */
+@property (nonatomic, copy, nullable, readonly) NSString *spillFilePath;
+
 @end
 
 /**
@@ -154,6 +181,17 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (id<FBAccumulatingBuffer>)accumulatingBufferForMutableData:(NSMutableData *)data;
 
+/**
+ A data buffer that keeps the first bytes it consumes and a ring of the last bytes, dropping those in between.
+ Its data is the head followed by the tail.
+
+ @param headCapacity the number of bytes from the start of the data to keep.
+ @param tailCapacity the number of most recent bytes to keep.
+ @param spillToTemporaryFile YES if the dropped bytes should be written to a temporary file, so that the complete data can be recovered from disk.
+ @return a FBBoundedBuffer implementation.
+ */
++ (id<FBBoundedBuffer>)boundedBufferWithHeadCapacity:(size_t)headCapacity tailCapacity:(size_t)tailCapacity spillToTemporaryFile:(BOOL)spillToTemporaryFile;
+
 /**
  A data buffer that is appended to by consuming data and can be drained.
 
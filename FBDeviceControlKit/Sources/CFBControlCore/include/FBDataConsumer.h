@@ -61,6 +61,15 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+/**
+ Consumer which accepts dispatch_data_t, bridged to NSData, in `consumeData:` without requiring it to be contiguous.
+ Producers of dispatch_data, such as FBFileReader, pass their data to members of this protocol as-is, rather than flattening each chunk into a contiguous copy.
+ Members must not assume that `-[NSData bytes]` is cheap, and should walk the regions of the data with `dispatch_data_apply` or `-[NSData enumerateByteRangesUsingBlock:]`.
+ */
+@protocol FBDataConsumerNonContiguous <NSObject>
+
+@end
+
 /**
  Consumer which consumes the data asynchronously
  The data passed in to this consumer should not contain a pointer to a stack allocated data and it should be copied instead
@@ -72,6 +81,28 @@ Number of submitted data that has not been consumed yet
 */
 - (NSInteger)unprocessedDataCount;
 
+@optional
+
+/**
+ Discards all submitted data that has not been consumed yet.
+ Data that is being consumed at the time of the call is unaffected.
+
+ @return the number of pieces of data that were pending at the time of the discard.
+ */
+- (NSInteger)discardUnprocessedData;
+
+@end
+
+/**
+ Consumer which holds on to data before it is written out, reporting how much it holds so that producers can throttle before memory grows without bound.
+ */
+@protocol FBDataConsumerBackpressure <NSObject>
+
+/**
+ The number of bytes that have been consumed, but not yet written out.
+ */
+@property (nonatomic, assign, readonly) uint64_t bytesPending;
+
 @end
 
 /**
@@ -110,15 +141,33 @@ Number of submitted data that has not been consumed yet
 
 /**
  Converts dispatch_data to NSData.
- Note that this will copy data if the underlying dispatch data is non-contiguous.
+ Note that this will copy data if the underlying dispatch data is non-contiguous, which can be avoided for members of FBDataConsumerNonContiguous.
 
  @param dispatchData the data to adapt.
  @return NSData from the dispatchData.
  */
 + (NSData *)adaptDispatchData:(dispatch_data_t)dispatchData;
 
+/**
+ Converts NSData to dispatch_data.
+ Data that is already dispatch_data bridged to NSData is returned as-is, other data is copied.
+
+ @param data the data to adapt.
+ @return dispatch_data from the data.
+ */
++ (dispatch_data_t)adaptNSData:(NSData *)data;
+
 @end
 
+/**
+ A block that receives a line as a span of UTF-8 bytes, without the newline terminator.
+ The bytes are borrowed and are only valid for the duration of the call. They should be copied if they are needed afterwards.
+
+ @param bytes the bytes of the line, which are not NUL-terminated.
+ @param length the number of bytes in the line.
+ */
+typedef void (^FBDataConsumerLineSpanBlock)(const char *bytes, size_t length);
+
 /**
  A consumer of data, passing output to a block.
  */
@@ -142,6 +191,17 @@ Number of submitted data that has not been consumed yet
  */
 + (id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerSync>)synchronousLineConsumerWithBlock:(void (^)(NSString *))consumer;
 
+/**
+ Creates a Consumer of lines from a block, where each line is passed as a borrowed span of bytes.
+ Lines will be delivered synchronously.
+ No object is created for each line. A line that is contained in a single chunk of data is passed from that data directly, only a line that spans chunks is copied into a reused buffer.
+ This makes it suitable for filtering high-volume output, such as device syslog, before any string is materialized.
+
+ @param consumer the block to call when a line has been consumed.
+ @return a new consumer.
+ */
++ (id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerSync>)synchronousLineSpanConsumerWithBlock:(FBDataConsumerLineSpanBlock)consumer;
+
 /**
  Creates a consumer that delivers data when available.
  Data will be delivered asynchronously to the provided queue.
@@ -161,6 +221,19 @@ Number of submitted data that has not been consumed yet
  */
 + (id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerAsync>)asynchronousDataConsumerWithBlock:(void (^)(NSData *))consumer;
 
+/**
+ Creates a consumer that delivers data asynchronously to the provided queue, through a bounded lock-free ring.
+ Unlike asynchronousDataConsumerOnQueue:consumer:, there is no block allocation or queue hop for each chunk. The queue is only woken when the ring goes from empty to non-empty.
+ The consumer must only be written to from one thread, or one serial queue, at a time.
+ Data that arrives whilst the ring is full is dropped, so the writer should apply backpressure with unprocessedDataCount, as video streams do.
+
+ @param queue the queue to consume on.
+ @param capacity the number of chunks that may be pending, rounded up to a power of two.
+ @param consumer the block to call when new data is available.
+ @return a new consumer.
+ */
++ (id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerAsync>)ringBufferDataConsumerOnQueue:(dispatch_queue_t)queue capacity:(NSUInteger)capacity consumer:(void (^)(NSData *))consumer;
+
 /**
  Creates a Consumer of lines from a block.
  Lines will be delivered asynchronously to a private queue.
@@ -192,6 +265,38 @@ Number of submitted data that has not been consumed yet
 
 @end
 
+/**
+ Maps spans of UTF-8 bytes to strings, returning the same string for spans with the same bytes.
+ Syslog lines repeat a small set of process and subsystem names, interning these means that a string is created once per name rather than once per line.
+ Looking up a span that is already interned does not allocate.
+ The interner is not thread-safe, so should be used from a single thread or serial queue, such as the callback of a synchronous line consumer.
+ */
+@interface FBStringInterner : NSObject
+
+/**
+ The Designated Initializer.
+
+ @param capacity the maximum number of strings to intern. Once reached, spans that have not been interned return a new string each time.
+ @return a new interner.
+ */
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+/**
+ Obtains the interned string for a span of bytes, interning it if it has not been seen before.
+
+ @param bytes the UTF-8 bytes of the string.
+ @param length the number of bytes.
+ @return the string, or nil if the bytes are not valid UTF-8.
+ */
+- (nullable NSString *)stringWithBytes:(const char *)bytes length:(size_t)length;
+
+/**
+ The number of strings that are currently interned.
+ */
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+@end
+
 @protocol FBControlCoreLogger;
 
 /**
@@ -214,7 +319,7 @@ Number of submitted data that has not been consumed yet
 /**
  A Composite Consumer.
  */
-@interface FBCompositeDataConsumer : NSObject <FBDataConsumer, FBDataConsumerLifecycle>
+@interface FBCompositeDataConsumer : NSObject <FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerNonContiguous>
 
 /**
  A Consumer of Consumers.
@@ -226,6 +331,88 @@ Number of submitted data that has not been consumed yet
 
 @end
 
+/**
+ What a queued composite does with data for a consumer whose queue is full.
+ */
+typedef NS_ENUM(NSUInteger, FBQueuedDataConsumerPolicy) {
+  FBQueuedDataConsumerPolicyDrop = 0, // Data that arrives whilst the queue of the consumer is full is dropped for that consumer.
+  FBQueuedDataConsumerPolicyBlock = 1, // The writer waits until the queue of the consumer has space. This stalls all consumers, so should be reserved for consumers that must see every byte.
+};
+
+/**
+ The counters of a consumer within a queued composite.
+ */
+@interface FBQueuedDataConsumerStatistics : NSObject
+
+/**
+ The number of bytes delivered to the consumer.
+ */
+@property (nonatomic, assign, readonly) uint64_t bytesDelivered;
+
+/**
+ The number of deliveries to the consumer. This is fewer than the number of chunks written when chunks are coalesced.
+ */
+@property (nonatomic, assign, readonly) uint64_t deliveries;
+
+/**
+ The number of bytes dropped for the consumer.
+ */
+@property (nonatomic, assign, readonly) uint64_t bytesDropped;
+
+/**
+ The number of chunks dropped for the consumer.
+ */
+@property (nonatomic, assign, readonly) uint64_t chunksDropped;
+
+/**
+ The number of bytes written that are yet to be delivered to the consumer.
+ */
+@property (nonatomic, assign, readonly) uint64_t bytesPending;
+
+@end
+
+/**
+ A Composite Consumer that gives each consumer its own bounded queue, so that a slow consumer cannot stall the others.
+ Each consumer is called from its own serial queue. Small chunks are coalesced into a single delivery until a byte threshold is reached, or until an interval has elapsed since the first chunk that is pending.
+ */
+@interface FBQueuedCompositeDataConsumer : NSObject <FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerNonContiguous>
+
+/**
+ The Designated Initializer.
+
+ @param coalescingBytes the number of bytes at which pending chunks are delivered. 0 delivers each chunk as soon as the queue of the consumer is free.
+ @param coalescingInterval the longest time that a chunk is held for coalescing.
+ @return a new consumer.
+ */
+- (instancetype)initWithCoalescingBytes:(size_t)coalescingBytes coalescingInterval:(NSTimeInterval)coalescingInterval;
+
+/**
+ Adds a consumer.
+
+ @param consumer the consumer to add.
+ @param policy the policy to apply when the queue of the consumer is full.
+ @param maxPendingBytes the number of bytes that may be pending for the consumer before its queue is full. A single chunk larger than this is still accepted into an empty queue.
+ */
+- (void)addConsumer:(id<FBDataConsumer>)consumer policy:(FBQueuedDataConsumerPolicy)policy maxPendingBytes:(size_t)maxPendingBytes;
+
+/**
+ Removes a consumer, such as one whose destination has gone away.
+ Data that is pending for the consumer is delivered, followed by an end-of-file.
+
+ @param consumer the consumer to remove.
+ */
+- (void)removeConsumer:(id<FBDataConsumer>)consumer;
+
+/**
+ The counters of a consumer.
+
+ @param consumer the consumer to obtain statistics for.
+ @return the statistics, or nil if the consumer has not been added.
+ */
+- (nullable FBQueuedDataConsumerStatistics *)statisticsForConsumer:(id<FBDataConsumer>)consumer;
+
+@end
+
 /**
  A consumer that does nothing with the data.
  */
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBBinaryDescriptor;
+@class FBBundleDescriptor;
+
+@protocol FBControlCoreLogger;
+
+/**
+ A process-wide cache of parsed Binary and Bundle Descriptors.
+ Each descriptor is keyed on its path and remembers the device, inode, size and modification time of the files that it was parsed from.
+ A descriptor is only returned whilst all of those files are unchanged, so a rebuilt bundle at the same path is parsed again.
+ This means that a bundle that is installed on many devices is only parsed once.
+ */
+@interface FBDescriptorCache : NSObject
+
+#pragma mark Initializers
+
+/**
+ The cache that is used by +[FBBinaryDescriptor binaryWithPath:error:] and +[FBBundleDescriptor bundleFromPath:error:].
+ */
+@property (nonatomic, strong, readonly, class) FBDescriptorCache *sharedCache;
+
+/**
+ The Designated Initializer.
+
+ @param logger the logger to use.
+ @return a new, empty, FBDescriptorCache.
+ */
++ (instancetype)cacheWithLogger:(nullable id<FBControlCoreLogger>)logger;
+
+#pragma mark Public Methods
+
+/**
+ Obtains a cached Binary Descriptor.
+
+ @param path the path of the binary.
+ @return the descriptor, if the binary is unchanged since it was cached. nil otherwise.
+ */
+- (nullable FBBinaryDescriptor *)binaryForPath:(NSString *)path;
+
+/**
+ Caches a Binary Descriptor against the current state of the binary on disk.
+
+ @param binary the descriptor to cache.
+ */
+- (void)cacheBinary:(FBBinaryDescriptor *)binary;
+
+/**
+ Obtains a cached Bundle Descriptor.
+
+ @param path the path of the bundle.
+ @return the descriptor, if the Info.plist and executable of the bundle are unchanged since it was cached. nil otherwise.
+ */
+- (nullable FBBundleDescriptor *)bundleForPath:(NSString *)path;
+
+/**
+ Caches a Bundle Descriptor against the current state of the Info.plist and executable of the bundle on disk.
+
+ @param bundle the descriptor to cache.
+ */
+- (void)cacheBundle:(FBBundleDescriptor *)bundle;
+
+/**
+ Persists the cache to a file, so that descriptors survive the process.
+ Descriptors that have previously been persisted to the file are loaded, subsequent changes to the cache are written to it.
+
+ @param path the path of the file.
+ */
+- (void)persistToPath:(NSString *)path;
+
+/**
+ Removes all descriptors from the cache.
+ */
+- (void)removeAllDescriptors;
+
+@end
+
+NS_ASSUME_NONNULL_END
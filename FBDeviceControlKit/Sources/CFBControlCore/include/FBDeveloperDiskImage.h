@@ -38,6 +38,7 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  Returns all of the Developer Disk Images that are available.
  These Disk Images are found by inspecting the appropriate directories within the current installed Xcode.
+ The directories are scanned once and the result is reused until their contents change or a different Xcode is selected.
  */
 + (NSArray<FBDeveloperDiskImage *> *)allDiskImages;
 
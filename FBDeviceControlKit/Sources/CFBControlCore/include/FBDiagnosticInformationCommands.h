@@ -16,11 +16,20 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  Fetches JSON-Serializable Diagnostic Information
+ Sources are fetched concurrently, each with its own timeout. A source that fails or times out is reported with an "Error" entry in place of its information, rather than failing the whole fetch.
 
  @return A future that resolves with the Diagnostic Information.
  */
 - (FBFuture<NSDictionary<NSString *, id> *> *)fetchDiagnosticInformation;
 
+/**
+ Fetches JSON-Serializable Diagnostic Information, leaving out the sources that are expensive to fetch.
+ This is intended for frequent polling. Results are cached briefly and concurrent callers share a single fetch.
+
+ @return A future that resolves with the Diagnostic Information.
+ */
+- (FBFuture<NSDictionary<NSString *, id> *> *)fetchFastDiagnosticInformation;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -23,6 +23,57 @@ typedef NS_ENUM(NSUInteger, FBFileReaderState) {
   FBFileReaderStateFinishedReadingByCancellation = ECANCELED,
 };
 
+/**
+ How a File Reader sizes its reads and how often it delivers to its consumer.
+ */
+@interface FBFileReaderConfiguration : NSObject <NSCopying>
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param lowWater the number of bytes that are read before they are delivered to the consumer, unless the end of the file or the interval comes first.
+ @param highWater the largest number of bytes that are delivered to the consumer at once.
+ @param interval the longest time that read bytes are held before they are delivered to the consumer, regardless of the low water. 0 for no interval.
+ @return a new configuration.
+ */
++ (instancetype)configurationWithLowWater:(size_t)lowWater highWater:(size_t)highWater interval:(NSTimeInterval)interval;
+
+/**
+ Delivers as soon as a single byte is read, in chunks as large as libdispatch reads them.
+ */
+@property (nonatomic, strong, readonly, class) FBFileReaderConfiguration *defaultConfiguration;
+
+/**
+ Delivers as soon as a single byte is read, in small chunks. Suited to interactive output, such as that of a process that is being logged.
+ */
+@property (nonatomic, strong, readonly, class) FBFileReaderConfiguration *latencyConfiguration;
+
+/**
+ Batches reads into large chunks, delivered at a bounded interval. Suited to bulk output, such as that of a process that is being captured in full.
+ */
+@property (nonatomic, strong, readonly, class) FBFileReaderConfiguration *throughputConfiguration;
+
+#pragma mark Properties
+
+/**
+ The number of bytes that are read before they are delivered to the consumer.
+ */
+@property (nonatomic, assign, readonly) size_t lowWater;
+
+/**
+ The largest number of bytes that are delivered to the consumer at once.
+ */
+@property (nonatomic, assign, readonly) size_t highWater;
+
+/**
+ The longest time that read bytes are held before they are delivered, or 0 for no interval.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval interval;
+
+@end
+
 /**
  A Protocol for defining file reading.
  */
@@ -105,6 +156,30 @@ typedef NS_ENUM(NSUInteger, FBFileReaderState) {
  */
 + (instancetype)dispatchDataReaderWithFileDescriptor:(int)fileDescriptor closeOnEndOfFile:(BOOL)closeOnEndOfFile consumer:(id<FBDispatchDataConsumer>)consumer logger:(nullable id<FBControlCoreLogger>)logger;
 
+/**
+ Creates a reader of NSData from a file descriptor, with a configuration for the sizing of reads.
+
+ @param fileDescriptor the file descriptor to write to.
+ @param closeOnEndOfFile YES if the file descriptor should be closed on consumeEndOfFile, NO otherwise.
+ @param consumer the consumer to forward to.
+ @param configuration the configuration of reads.
+ @param logger the logger to use.
+ @return a file reader.
+ */
++ (instancetype)readerWithFileDescriptor:(int)fileDescriptor closeOnEndOfFile:(BOOL)closeOnEndOfFile consumer:(id<FBDataConsumer>)consumer configuration:(FBFileReaderConfiguration *)configuration logger:(nullable id<FBControlCoreLogger>)logger;
+
+/**
+ Creates a reader of dispatch data from a file descriptor, with a configuration for the sizing of reads.
+
+ @param fileDescriptor the file descriptor to write to.
+ @param closeOnEndOfFile YES if the file descriptor should be closed on consumeEndOfFile, NO otherwise.
+ @param consumer the consumer to forward to.
+ @param configuration the configuration of reads.
+ @param logger the logger to use.
+ @return a File Reader.
+ */
++ (instancetype)dispatchDataReaderWithFileDescriptor:(int)fileDescriptor closeOnEndOfFile:(BOOL)closeOnEndOfFile consumer:(id<FBDispatchDataConsumer>)consumer configuration:(FBFileReaderConfiguration *)configuration logger:(nullable id<FBControlCoreLogger>)logger;
+
 /**
  Creates a reader of NSData from a file at a path on the filesystem.
  A file handle will be internally created, and closed when reading has finished.
@@ -29,6 +29,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  Creates a synchronous data consumer from a file handle.
+ Short writes are retried until all bytes are written. When a write fails the remaining data is discarded, and finishedConsuming resolves with the error.
 
  @param fileDescriptor the file descriptor to write to.
  @param closeOnEndOfFile YES if the file descriptor should be closed on consumeEndOfFile, NO otherwise.
@@ -55,6 +56,19 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (FBFuture<id<FBDispatchDataConsumer>> *)asyncDispatchDataWriterWithFileDescriptor:(int)fileDescriptor closeOnEndOfFile:(BOOL)closeOnEndOfFile;
 
+/**
+ Creates a non-blocking Data Consumer from a file handle, that coalesces small chunks into large writes.
+ Chunks are written once the bytes pending reach a threshold, or once an interval has elapsed since the first chunk that is pending, whichever is sooner.
+ Short writes are retried until all bytes are written. When a write fails the remaining data is discarded, and finishedConsuming resolves with the error.
+
+ @param fileDescriptor the file descriptor to write to.
+ @param closeOnEndOfFile YES if the file descriptor should be closed on consumeEndOfFile, NO otherwise.
+ @param coalescingBytes the number of pending bytes at which a write is made. 0 writes each chunk as soon as the writer is free.
+ @param coalescingInterval the longest time that a chunk is held for coalescing.
+ @return a data consumer.
+ */
++ (id<FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerAsync, FBDataConsumerBackpressure>)coalescingWriterWithFileDescriptor:(int)fileDescriptor closeOnEndOfFile:(BOOL)closeOnEndOfFile coalescingBytes:(size_t)coalescingBytes coalescingInterval:(NSTimeInterval)coalescingInterval;
+
 /**
  Creates a blocking Data Consumer from a file path.
  The file handle backing this path will be closed when and end-of-file is sent.
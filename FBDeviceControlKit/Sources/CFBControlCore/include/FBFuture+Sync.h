@@ -44,8 +44,8 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  Await the Future, with no Timeout.
- This will spin the run loop whilst waiting for the Future to resolve.
- For threads and queues that don't have a Run Loop, one will be created in accordance with +[NSRunLoop currentRunLoop].
+ On the main thread, or a thread that is inside a run of its Run Loop, this will run the Run Loop whilst waiting for the Future to resolve, waking as soon as it resolves.
+ Other threads and queues block on a semaphore that is signalled when the Future resolves, without spinning.
 
  @param error an error outparam if the Future resolves with an error.
  @return the the Future's result if successful, nil otherwise.
@@ -54,8 +54,8 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  Await the Future with the provided timeout.
- This will spin the run loop whilst waiting for the Future to resolve.
- For threads and queues that don't have a Run Loop, one will be created in accordance with +[NSRunLoop currentRunLoop].
+ On the main thread, or a thread that is inside a run of its Run Loop, this will run the Run Loop whilst waiting for the Future to resolve, waking as soon as it resolves.
+ Other threads and queues block on a semaphore that is signalled when the Future resolves, without spinning.
 
  @param timeout the timeout in seconds to wait.
  @param error an error outparam if the Future resolves with an error, or the Future is not resolved within the timeout.
@@ -96,9 +96,9 @@ NS_ASSUME_NONNULL_BEGIN
  Block until the Future is completed and return the result.
  This will use dispatch internally and should *never* be called from the main thread/queue, or any thread/queue that needs to be serviced for the Future to resolve.
 
- @param queue the queue to serialize on.
+ @param queue the queue to serialize on. Calling this from the same queue fails immediately, as the completion could never be delivered.
  @param timeout the timeout in dispatch_time to wait
- @param error an error outparam if the Future resolves with an error or times out.
+ @param error an error outparam if the Future resolves with an error, times out or would deadlock.
  @return the the Future's result if successful, nil otherwise.
  */
 - (nullable T)onQueue:(dispatch_queue_t)queue timeout:(dispatch_time_t)timeout block:(NSError **)error;
@@ -137,6 +137,19 @@ extern dispatch_time_t FBCreateDispatchTimeFromDuration(NSTimeInterval inDuratio
  */
 + (FBFuture<NSArray<T> *> *)futureWithFutures:(NSArray<FBFuture<T> *> *)futures NS_SWIFT_UNAVAILABLE("Use BridgeFuture.values instead");
 
+/**
+ Constructs a future from an array of generators of futures, with a bound on the number of futures that are pending at once.
+ Unlike futureWithFutures:, a future is not started until its generator is called, so a large batch of work against a single device service is pipelined rather than started all at once.
+ Generators are called in order, from a private serial queue.
+ If any future resolves in an error, the first error will be propogated and no further generators are called.
+ If the returned future is cancelled, the pending futures are cancelled and no further generators are called.
+
+ @param generators the blocks that each start a future.
+ @param maxConcurrency the maximum number of futures that may be pending at once. Must be greater than 0.
+ @return a new future with the resolved results of all the generated futures, in the order of the generators.
+ */
++ (FBFuture<NSArray<T> *> *)futureWithFutureGenerators:(NSArray<FBFuture<T> * (^)(void)> *)generators maxConcurrency:(NSUInteger)maxConcurrency NS_SWIFT_UNAVAILABLE("Use a TaskGroup with a bounded number of children instead");
+
 /**
  Constructrs a Future from an Array of Futures.
  The future which resolves the first will be returned.
@@ -150,8 +163,9 @@ extern dispatch_time_t FBCreateDispatchTimeFromDuration(NSTimeInterval inDuratio
 /**
  A resolved future, with an insignificant value.
  This can be used to communicate "success", where an errored future would indicate failure.
+ The same future is returned on each call, so naming it returns a named copy.
 
- @return a new Future that's resolved with an NSNull value.
+ @return a Future that's resolved with an NSNull value.
  */
 + (FBFuture<NSNull *> *)empty;
 
@@ -194,6 +208,16 @@ extern dispatch_time_t FBCreateDispatchTimeFromDuration(NSTimeInterval inDuratio
  */
 - (instancetype)onQueue:(dispatch_queue_t)queue notifyOfCompletion:(void (^)(FBFuture *))handler;
 
+/**
+ Notifies of the resolution of the Future, on the thread that resolves it, without a queue hop.
+ If the Future has already resolved, the handler is called before this method returns.
+ The handler is called whilst the Future is being resolved, so it must be short and must not block, such as resuming a Swift continuation.
+
+ @param handler the block to invoke.
+ @return the Receiver, for chaining.
+ */
+- (instancetype)notifyOfCompletionInline:(void (^)(FBFuture *))handler NS_SWIFT_NAME(notifyOfCompletionInline(_:));
+
 /**
  Notifies of the successful resolution of the Future.
  The handler will resolve before the chained Future.
@@ -510,6 +534,7 @@ extern dispatch_time_t FBCreateDispatchTimeFromDuration(NSTimeInterval inDuratio
 
 /**
  Constructs a FBFutureContext in Parallel.
+ The teardowns of each context are independent of the others, so the contexts are torn down concurrently, each in its own order.
 
  @param contexts the contexts to use.
  @return a new FBFutureContext with the underlying contexts in an array.
@@ -588,6 +613,22 @@ extern dispatch_time_t FBCreateDispatchTimeFromDuration(NSTimeInterval inDuratio
  */
 - (FBFuture *)onQueue:(dispatch_queue_t)queue enter:(id (^)(T result, FBMutableFuture<NSNull *> *teardown))enter;
 
+/**
+ Bounds the time that the teardown of the context waits on each teardown.
+ Once the deadline has elapsed since the teardown started, the remaining teardowns are started without waiting for those above them to finish. This allows resources lower in the stack, such as a service connection, to be released promptly when the teardown above it is stuck.
+ The deadline applies to this context and to the contexts that are derived from it.
+
+ @param deadline the time after which teardowns no longer wait for each other. 0 for no deadline, which is the default.
+ @return the receiver, for chaining.
+ */
+- (FBFutureContext<T> *)withTeardownDeadline:(NSTimeInterval)deadline;
+
+/**
+ A block that is called each time the teardown of a context completes, for measuring how long resources are held after an operation ends.
+ The parameters are the number of teardowns that were performed, the time taken by all of them, and the number that were still running when the deadline elapsed.
+ */
+@property (nonatomic, class, copy, nullable, readwrite) void (^teardownMetricsHandler)(NSUInteger teardownCount, NSTimeInterval duration, NSUInteger deadlineExceededCount);
+
 #pragma mark Properties
 
 /**
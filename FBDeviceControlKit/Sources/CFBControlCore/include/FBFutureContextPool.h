@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBFutureContextManager.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBFuture<T>;
+@class FBFutureContext<T>;
+
+@protocol FBControlCoreLogger;
+
+/**
+ The Delegate for a Context Pool.
+ The contextPoolTimeout is the amount of time that a returned context is retained for, nil if contexts should be torn down as soon as they are returned. Prewarmed contexts are retained until they are first used, evicted or fail a health check.
+ isContextSharable is ignored, as each consumer of a pool has a context to itself.
+ */
+@protocol FBFutureContextPoolDelegate <FBFutureContextManagerDelegate>
+
+@optional
+
+/**
+ Check that an idle context is still usable.
+ Contexts that fail the check are torn down and removed from the pool.
+
+ @param context the context to check.
+ @param logger the logger to use.
+ @return a Future that resolves if the context is usable.
+ */
+- (FBFuture<NSNull *> *)checkHealth:(id)context logger:(id<FBControlCoreLogger>)logger;
+
+@end
+
+/**
+ Manages a pool of up to a fixed number of asynchronous contexts, each of which can be used by a single consumer at a time.
+ Unlike FBFutureContextManager, concurrent consumers are given separate contexts rather than waiting on one.
+ Idle contexts are retained for re-use, the most recently used first, so that the least recently used are the first to age out or be evicted.
+ All state is confined to the queue of the pool, so the synchronous methods must be called on it.
+ */
+@interface FBFutureContextPool<ContextType : id> : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param queue the queue to use.
+ @param delegate the delegate to use.
+ @param capacity the maximum number of contexts, idle or in use. Consumers beyond this wait for a context to be returned.
+ @param healthCheckInterval the interval at which idle contexts are checked with the delegate, nil to never check.
+ @param logger the logger to use.
+ @return a new FBFutureContextPool Instance.
+ */
++ (instancetype)poolWithQueue:(dispatch_queue_t)queue delegate:(id<FBFutureContextPoolDelegate>)delegate capacity:(NSUInteger)capacity healthCheckInterval:(nullable NSNumber *)healthCheckInterval logger:(id<FBControlCoreLogger>)logger;
+
+#pragma mark Public Methods
+
+/**
+ Aquire a context from the pool, preparing one if none is idle and the pool has capacity.
+
+ @param purpose the purpose for utilization.
+ @return a context that is available at some point in the future, returned to the pool on teardown.
+ */
+- (FBFutureContext<ContextType> *)utilizeWithPurpose:(NSString *)purpose;
+
+/**
+ Prepare contexts ahead of their use, so that the first consumers do not pay for preparation.
+
+ @param count the number of idle contexts to have, limited by the capacity of the pool.
+ @return a Future that resolves with the number of idle contexts once preparation has finished.
+ */
+- (FBFuture<NSNumber *> *)prewarm:(NSUInteger)count;
+
+/**
+ Tear down all idle contexts.
+ Contexts that are in use are torn down when they are returned, rather than being pooled.
+
+ @return a Future that resolves when the idle contexts have been torn down.
+ */
+- (FBFuture<NSNull *> *)drain;
+
+/**
+ Tear down the least recently used idle context.
+ Must be called on the queue of the pool.
+
+ @return YES if a context was evicted, NO if there are no idle contexts.
+ */
+- (BOOL)evictLeastRecentlyUsed;
+
+#pragma mark Properties
+
+/**
+ The maximum number of contexts.
+ */
+@property (nonatomic, assign, readonly) NSUInteger capacity;
+
+/**
+ The number of contexts that are idle, in use or being prepared.
+ Must be read on the queue of the pool.
+ */
+@property (nonatomic, assign, readonly) NSUInteger contextCount;
+
+/**
+ The time at which the least recently used idle context was returned, nil if there are no idle contexts.
+ Must be read on the queue of the pool.
+ */
+@property (nonatomic, copy, nullable, readonly) NSDate *leastRecentlyUsedDate;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBFuture.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The profile of a single Future.
+ A Future that is created whilst a handler of another Future is running is a child of that Future, so the profiles of a chain form a tree.
+ */
+@interface FBFutureProfileNode : NSObject
+
+/**
+ The name of the Future, from named: or nameFormat:, nil if it is not named.
+ */
+@property (atomic, copy, nullable, readonly) NSString *name;
+
+/**
+ The state of the Future when the profile was read.
+ */
+@property (atomic, assign, readonly) FBFutureState state;
+
+/**
+ The time between the creation and the resolution of the Future, or until now if it is running.
+ */
+@property (atomic, assign, readonly) NSTimeInterval pendingDuration;
+
+/**
+ The time spent running the handlers that were notified of the resolution of the Future.
+ */
+@property (atomic, assign, readonly) NSTimeInterval handlerDuration;
+
+/**
+ The number of handlers that were notified of the resolution of the Future.
+ */
+@property (atomic, assign, readonly) NSUInteger handlerCount;
+
+/**
+ The labels of the queues that the handlers of the Future were run on.
+ */
+@property (atomic, copy, readonly) NSSet<NSString *> *queueLabels;
+
+/**
+ The profiles of the Futures that were created by the handlers of this Future.
+ */
+@property (atomic, copy, readonly) NSArray<FBFutureProfileNode *> *children;
+
+/**
+ The number of Futures allocated beneath this Future, including itself.
+ */
+@property (atomic, assign, readonly) NSUInteger allocationCount;
+
+@end
+
+/**
+ Opt-in instrumentation of Futures.
+ Whilst enabled, each Future that is created records a profile, and emits os_signpost intervals for its pending time and for each handler that it runs.
+ This has a cost for every Future, so should only be enabled whilst investigating.
+ */
+@interface FBFutureProfiler : NSObject
+
+/**
+ YES if Futures that are created should be profiled. Defaults to NO.
+ */
+@property (nonatomic, class, assign, readwrite) BOOL enabled;
+
+/**
+ The profiles of the most recent Futures that were created outside the handler of another Future.
+ */
+@property (nonatomic, class, copy, readonly) NSArray<FBFutureProfileNode *> *rootNodes;
+
+/**
+ A description of the tree of profiles, one Future per line, indented beneath the Future that created it.
+
+ @param minimumDuration the time below which a root and all of its children are omitted, for finding slow operations.
+ @return the description.
+ */
++ (NSString *)dumpTreeWithMinimumDuration:(NSTimeInterval)minimumDuration;
+
+/**
+ Discards all of the profiles that have been recorded.
+ */
++ (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
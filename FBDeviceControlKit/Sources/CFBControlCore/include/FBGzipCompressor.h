@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBDataConsumer.h"
+#import "FBFuture.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The default compression level, equivalent to that of gzip.
+ */
+extern const int FBGzipCompressionLevelDefault;
+
+/**
+ A Data Consumer that gzips the data it consumes, passing the compressed output to another consumer as it is produced.
+ As pigz does, input is split into blocks that are compressed concurrently, each primed with the end of the previous block, and the output is a single standard gzip stream.
+ The number of blocks in flight is bounded, so a producer that is faster than compression is held up in `consumeData:` rather than buffering without bound.
+ Data must be consumed serially, the output consumer is called serially.
+ */
+@interface FBGzipCompressor : NSObject <FBDataConsumer, FBDataConsumerLifecycle, FBDataConsumerNonContiguous>
+
+#pragma mark Initializers
+
+/**
+ Creates a compressor with the default block size, compressing on as many threads as there are active processors.
+
+ @param consumer the consumer of the gzip output. It receives an end-of-file once the compressor has written the end of the gzip stream.
+ @param level the compression level, from 1 (fastest) to 9 (smallest), 0 for no compression, or FBGzipCompressionLevelDefault.
+ @return a new compressor.
+ */
++ (instancetype)compressorWithConsumer:(id<FBDataConsumer>)consumer level:(int)level;
+
+/**
+ The Designated Initializer.
+
+ @param consumer the consumer of the gzip output. It receives an end-of-file once the compressor has written the end of the gzip stream.
+ @param level the compression level, from 1 (fastest) to 9 (smallest), 0 for no compression, or FBGzipCompressionLevelDefault.
+ @param blockSize the number of uncompressed bytes in each block.
+ @param concurrency the number of blocks to compress at once. Up to twice as many blocks are held in memory, so that blocks that finish early can wait for earlier blocks to be written.
+ @return a new compressor.
+ */
++ (instancetype)compressorWithConsumer:(id<FBDataConsumer>)consumer level:(int)level blockSize:(size_t)blockSize concurrency:(NSUInteger)concurrency;
+
+#pragma mark Properties
+
+/**
+ The number of uncompressed bytes consumed.
+ */
+@property (nonatomic, assign, readonly) uint64_t bytesConsumed;
+
+/**
+ A Future that resolves when all output has been passed to the consumer, followed by an end-of-file.
+ */
+@property (nonatomic, strong, readonly) FBFuture<NSNull *> *finishedConsuming;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -35,4 +35,71 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+/**
+ Records calls in the same way as FBLoggingWrapper, for wrappers that implement a protocol and call the wrapped object directly instead of forwarding invocations.
+ Method names and arguments are only described when there is an event reporter, or the logger is enabled, so calls are otherwise passed straight through.
+ */
+@interface FBLoggingWrapperRecorder : NSObject
+
+/**
+ The Designated Initializer.
+
+ @param simplifiedNaming YES if the name of the first element in the selector should be used, NO if you want the full selector.
+ @param eventReporter the event reporter to log to.
+ @param logger FBControlCoreLogger to use.
+ @return a new recorder.
+ */
++ (instancetype)recorderWithSimplifiedNaming:(BOOL)simplifiedNaming eventReporter:(nullable id<FBEventReporter>)eventReporter logger:(nullable id<FBControlCoreLogger>)logger;
+
+/**
+ Records a call that returns an FBFuture or FBFutureContext, with the end of the call being when the future resolves.
+
+ @param selector the selector of the call.
+ @param arguments returns the arguments of the call, with scalars boxed. Only called if the call is recorded.
+ @param call makes the call.
+ @return the return value of the call.
+ */
+- (id)recordCall:(SEL)selector arguments:(NSArray<id> * (^)(void))arguments call:(id (^)(void))call;
+
+@end
+
+/**
+ Records the current method call on a recorder, for use in the methods of a typed wrapper.
+ The arguments are boxed into an array lazily, so must not be nil.
+ */
+#define FBLoggingWrapperRecordCall(recorder, call, ...) \
+  [recorder recordCall:_cmd arguments:^ NSArray<id> * { return @[__VA_ARGS__]; } call:^ id { return call; }]
+
+/**
+ A typed logging wrapper of FBApplicationCommands.
+ */
+@interface FBApplicationCommandsLoggingWrapper : NSObject <FBApplicationCommands>
+
+/**
+ Wraps application commands.
+
+ @param commands the commands to wrap.
+ @param recorder the recorder to record calls with.
+ @return a new wrapper.
+ */
++ (instancetype)wrap:(id<FBApplicationCommands>)commands recorder:(FBLoggingWrapperRecorder *)recorder;
+
+@end
+
+/**
+ A typed logging wrapper of FBFileCommands.
+ */
+@interface FBFileCommandsLoggingWrapper : NSObject <FBFileCommands>
+
+/**
+ Wraps file commands.
+
+ @param commands the commands to wrap.
+ @param recorder the recorder to record calls with.
+ @return a new wrapper.
+ */
++ (instancetype)wrap:(id<FBFileCommands>)commands recorder:(FBLoggingWrapperRecorder *)recorder;
+
+@end
+
 NS_ASSUME_NONNULL_END
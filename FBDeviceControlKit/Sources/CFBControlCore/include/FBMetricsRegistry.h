@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A monotonically increasing count, such as a number of calls or bytes.
+ Updates are a single atomic operation, so are safe to make from any thread on hot paths.
+ */
+@interface FBMetricsCounter : NSObject
+
+/**
+ The name of the counter.
+ */
+@property (nonatomic, copy, readonly) NSString *name;
+
+/**
+ The current value.
+ */
+@property (nonatomic, assign, readonly) uint64_t value;
+
+/**
+ Increments the counter by one.
+ */
+- (void)increment;
+
+/**
+ Increments the counter.
+
+ @param value the amount to increment by.
+ */
+- (void)add:(uint64_t)value;
+
+@end
+
+/**
+ A value that goes up and down, such as a number of pending operations.
+ */
+@interface FBMetricsGauge : NSObject
+
+/**
+ The name of the gauge.
+ */
+@property (nonatomic, copy, readonly) NSString *name;
+
+/**
+ The current value.
+ */
+@property (nonatomic, assign, readonly) int64_t value;
+
+/**
+ Sets the gauge.
+
+ @param value the new value.
+ */
+- (void)set:(int64_t)value;
+
+/**
+ Adjusts the gauge.
+
+ @param delta the amount to adjust by, which may be negative.
+ */
+- (void)add:(int64_t)delta;
+
+@end
+
+/**
+ A point-in-time copy of a histogram.
+ */
+@interface FBMetricsHistogramSnapshot : NSObject
+
+/**
+ The number of recorded values.
+ */
+@property (nonatomic, assign, readonly) uint64_t count;
+
+/**
+ The sum of recorded values.
+ */
+@property (nonatomic, assign, readonly) uint64_t sum;
+
+/**
+ The smallest and largest recorded values, both 0 if nothing was recorded.
+ */
+@property (nonatomic, assign, readonly) uint64_t minimum;
+@property (nonatomic, assign, readonly) uint64_t maximum;
+
+/**
+ The value at a percentile, accurate to the width of the bucket it falls in.
+
+ @param percentile the percentile, from 0 to 100.
+ @return the lower bound of the bucket containing the percentile.
+ */
+- (uint64_t)valueAtPercentile:(double)percentile;
+
+@end
+
+/**
+ A distribution of values, such as latencies in nanoseconds.
+ Values are counted in log-linear buckets, as an HDR histogram does, so that the relative error is bounded at about 6% across the full range of a uint64_t, in fixed memory.
+ Recording is lock-free, so it is safe to record from any thread on hot paths.
+ */
+@interface FBMetricsHistogram : NSObject
+
+/**
+ The name of the histogram.
+ */
+@property (nonatomic, copy, readonly) NSString *name;
+
+/**
+ Records a value.
+
+ @param value the value to record.
+ */
+- (void)record:(uint64_t)value;
+
+/**
+ Records the time since a start time.
+
+ @param startTime a start time from clock_gettime_nsec_np(CLOCK_UPTIME_RAW).
+ */
+- (void)recordNanosecondsSince:(uint64_t)startTime;
+
+/**
+ A copy of the current distribution.
+ */
+@property (nonatomic, strong, readonly) FBMetricsHistogramSnapshot *snapshot;
+
+@end
+
+/**
+ A registry of named metrics.
+ Names are namespaced by subsystem with a dot, for example 'afc.bytes_read'. Obtaining a metric takes a lock, so callers on hot paths should obtain it once and keep it.
+ */
+@interface FBMetricsRegistry : NSObject
+
+#pragma mark Initializers
+
+/**
+ The registry that FBControlCore and FBDeviceControl record to.
+ */
+@property (nonatomic, strong, readonly, class) FBMetricsRegistry *sharedRegistry;
+
+#pragma mark Metrics
+
+/**
+ Returns the counter for a name, creating it if needed.
+
+ @param name the name of the counter.
+ @return the counter.
+ */
+- (FBMetricsCounter *)counterWithName:(NSString *)name;
+
+/**
+ Returns the gauge for a name, creating it if needed.
+
+ @param name the name of the gauge.
+ @return the gauge.
+ */
+- (FBMetricsGauge *)gaugeWithName:(NSString *)name;
+
+/**
+ Returns the histogram for a name, creating it if needed.
+
+ @param name the name of the histogram.
+ @return the histogram.
+ */
+- (FBMetricsHistogram *)histogramWithName:(NSString *)name;
+
+#pragma mark Export
+
+/**
+ A JSON-serializable snapshot of all metrics, keyed by name.
+ Counters and gauges are numbers. Histograms are dictionaries of count, sum, min, max, p50, p90, p99 and p999.
+ */
+@property (nonatomic, copy, readonly) NSDictionary<NSString *, id> *snapshot;
+
+/**
+ The snapshot as JSON data.
+
+ @param error an error out for any error that occurs.
+ @return the JSON data, or nil on error.
+ */
+- (nullable NSData *)JSONDataWithError:(NSError **)error;
+
+/**
+ All metrics in the Prometheus text exposition format, with dots in names replaced by underscores.
+ Histograms are exported as summaries with quantiles.
+ */
+@property (nonatomic, copy, readonly) NSString *prometheusText;
+
+@end
+
+NS_ASSUME_NONNULL_END
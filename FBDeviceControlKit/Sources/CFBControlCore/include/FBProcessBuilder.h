@@ -12,11 +12,13 @@
 NS_ASSUME_NONNULL_BEGIN
 
 @protocol FBAccumulatingBuffer;
+@protocol FBBoundedBuffer;
 @protocol FBControlCoreLogger;
 @protocol FBDataConsumer;
 
 @class FBFuture;
 @class FBProcessInput;
+@class FBProcessOutputReader;
 
 /**
  An interface to building FBManagedProcess instances.
@@ -123,6 +125,16 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (FBProcessBuilder<StdInType, NSString *, StdErrType> *)withStdOutInMemoryAsString;
 
+/**
+ Reads stdout into memory, keeping only the start and the end of the output.
+
+ @param headCapacity the number of bytes from the start of the output to keep.
+ @param tailCapacity the number of most recent bytes to keep.
+ @param spillToTemporaryFile YES if the bytes in between should be written to a temporary file, rather than discarded.
+ @return the receiver, for chaining.
+ */
+- (FBProcessBuilder<StdInType, id<FBBoundedBuffer>, StdErrType> *)withStdOutInMemoryWithHeadCapacity:(size_t)headCapacity tailCapacity:(size_t)tailCapacity spillToTemporaryFile:(BOOL)spillToTemporaryFile;
+
 /**
  Assigns a path to write stdout to.
 
@@ -138,6 +150,15 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (FBProcessBuilder<StdInType, NSNull *, StdErrType> *)withStdOutToDevNull;
 
+/**
+ Redirects stdout to a file descriptor that is already open.
+ The file descriptor is connected directly to the process and is not closed.
+
+ @param fileDescriptor the file descriptor to write stdout to.
+ @return the receiver, for chaining.
+ */
+- (FBProcessBuilder<StdInType, NSNumber *, StdErrType> *)withStdOutToFileDescriptor:(int)fileDescriptor;
+
 /**
  Redirects stdout to an input stream.
 
@@ -145,6 +166,13 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (FBProcessBuilder<StdInType, NSInputStream *, StdErrType> *)withStdOutToInputStream;
 
+/**
+ Redirects stdout to a pull-based reader.
+
+ @return the receiver, for chaining.
+ */
+- (FBProcessBuilder<StdInType, FBProcessOutputReader *, StdErrType> *)withStdOutToReader;
+
 /**
  Redirects stdout data to the consumer.
 
@@ -193,6 +221,16 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (FBProcessBuilder<StdInType, StdOutType, NSString *> *)withStdErrInMemoryAsString;
 
+/**
+ Reads stderr into memory, keeping only the start and the end of the output.
+
+ @param headCapacity the number of bytes from the start of the output to keep.
+ @param tailCapacity the number of most recent bytes to keep.
+ @param spillToTemporaryFile YES if the bytes in between should be written to a temporary file, rather than discarded.
+ @return the receiver, for chaining.
+ */
+- (FBProcessBuilder<StdInType, StdOutType, id<FBBoundedBuffer>> *)withStdErrInMemoryWithHeadCapacity:(size_t)headCapacity tailCapacity:(size_t)tailCapacity spillToTemporaryFile:(BOOL)spillToTemporaryFile;
+
 /**
  Assigns a path to write stderr to.
 
@@ -208,6 +246,15 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (FBProcessBuilder<StdInType, StdOutType, NSNull *> *)withStdErrToDevNull;
 
+/**
+ Redirects stderr to a file descriptor that is already open.
+ The file descriptor is connected directly to the process and is not closed.
+
+ @param fileDescriptor the file descriptor to write stderr to.
+ @return the receiver, for chaining.
+ */
+- (FBProcessBuilder<StdInType, StdOutType, NSNumber *> *)withStdErrToFileDescriptor:(int)fileDescriptor;
+
 /**
  Redirects stderr data to the consumer.
 
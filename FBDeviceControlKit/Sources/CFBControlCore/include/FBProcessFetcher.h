@@ -13,6 +13,102 @@ NS_ASSUME_NONNULL_BEGIN
 
 @class FBFuture<T>;
 
+/**
+ Lifecycle events of a process, as delivered by the kernel.
+ */
+typedef NS_OPTIONS(NSUInteger, FBProcessEvent) {
+  FBProcessEventExit = 1 << 0, /** The process exited. */
+  FBProcessEventFork = 1 << 1, /** The process forked a child. */
+  FBProcessEventExec = 1 << 2, /** The process exec'd a new image. */
+  FBProcessEventSignal = 1 << 3, /** A signal was delivered to the process. */
+};
+
+/**
+ A point-in-time table of the processes running on the Host, obtained in a single sysctl.
+ Processes are indexed by identifier, parent and name, so that repeated lookups don't query the kernel.
+ Arguments and environment are only fetched when the FBProcessInfo of a process is requested, then cached.
+ Lookups are safe to make from multiple threads.
+ */
+@interface FBProcessTableSnapshot : NSObject
+
+/**
+ The number of processes in the snapshot.
+ */
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+/**
+ The Process Identifiers of all processes in the snapshot, in ascending order.
+ */
+@property (nonatomic, copy, readonly) NSArray<NSNumber *> *processIdentifiers;
+
+/**
+ Whether the process was running when the snapshot was taken.
+
+ @param processIdentifier the Process Identifier to look up.
+ @return YES if the process is in the snapshot, NO otherwise.
+ */
+- (BOOL)containsProcess:(pid_t)processIdentifier;
+
+/**
+ The parent of a process.
+
+ @param child the Process Identifier of the child process.
+ @return the Process Identifier of the parent process, -1 if the child is not in the snapshot.
+ */
+- (pid_t)parentOf:(pid_t)child;
+
+/**
+ The name of a process.
+
+ @param processIdentifier the Process Identifier to look up.
+ @return the name of the process, nil if it is not in the snapshot.
+ */
+- (nullable NSString *)nameOf:(pid_t)processIdentifier;
+
+/**
+ The children of a process.
+
+ @param parent the Process Identifier of the parent process.
+ @return the Process Identifiers of the children, in ascending order.
+ */
+- (NSArray<NSNumber *> *)subprocessIdentifiersOf:(pid_t)parent;
+
+/**
+ The processes with a name.
+
+ @param processName the name of the processes.
+ @return the Process Identifiers of the processes, in ascending order.
+ */
+- (NSArray<NSNumber *> *)processIdentifiersWithName:(NSString *)processName;
+
+/**
+ The first child of a process whose name contains a string, as -[FBProcessFetcher subprocessOf:withName:] finds.
+
+ @param parent the Process Identifier of the parent process.
+ @param name the string to find in the name of the child process.
+ @return a Process Identifier of the child process if one could be found, -1 otherwise.
+ */
+- (pid_t)subprocessOf:(pid_t)parent withName:(NSString *)name;
+
+/**
+ The full process information of a process, including its arguments and environment.
+ This is fetched from the kernel on first use, so a process that has exited since the snapshot was taken has no information.
+
+ @param processIdentifier the Process Identifier to obtain process info for.
+ @return an FBProcessInfo object if the process could be found, nil otherwise.
+ */
+- (nullable FBProcessInfo *)processInfoFor:(pid_t)processIdentifier;
+
+/**
+ The full process information of the processes with a name.
+
+ @param processName the name of the processes to fetch.
+ @return an NSArray<FBProcessInfo> of the found processes.
+ */
+- (NSArray<FBProcessInfo *> *)processesWithProcessName:(NSString *)processName;
+
+@end
+
 /**
  Queries for Processes running on the Host.
  Should not be called from multiple threads since buffers are re-used internally.
@@ -22,6 +118,14 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @interface FBProcessFetcher : NSObject
 
+/**
+ Takes a snapshot of the process table, for making many lookups against the same set of processes.
+
+ @param error an error out for any error that occurs.
+ @return a snapshot if the process table could be read, nil otherwise.
+ */
+- (nullable FBProcessTableSnapshot *)snapshotWithError:(NSError **)error;
+
 /**
  A Query for obtaining all of the process information for a given processIdentifier.
 
@@ -115,6 +219,37 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (FBFuture<NSNull *> *) waitStopSignalForProcess:(pid_t) processIdentifier;
 
+/**
+ Observes lifecycle events of a process, as the kernel delivers them, rather than polling.
+
+ @param queue the queue to call the handler on.
+ @param events the events to call the handler for.
+ @param processIdentifier the Process Identifier of the process to observe.
+ @param handler called with the events that occurred, events that occur close together may be delivered in a single call.
+ @return A future that resolves when the process exits, or immediately if it is not running. Cancelling it stops the observation.
+ */
++ (FBFuture<NSNull *> *)onQueue:(dispatch_queue_t)queue observeEvents:(FBProcessEvent)events ofProcess:(pid_t)processIdentifier handler:(nullable void (^)(FBProcessEvent events))handler;
+
+/**
+ Waits for a process to exit, without polling.
+
+ @param queue the queue to wait on.
+ @param processIdentifier the Process Identifier of the process.
+ @return A future that resolves when the process exits, or immediately if it is not running.
+ */
++ (FBFuture<NSNull *> *)onQueue:(dispatch_queue_t)queue waitForExitOfProcess:(pid_t)processIdentifier;
+
+/**
+ Waits for a subprocess whose name contains a string to appear, without polling.
+ The subprocess is looked for when the parent forks and when any of its new children exec.
+
+ @param queue the queue to wait on.
+ @param parent the Process Identifier of the parent process.
+ @param name the string to find in the name of the child process, as -[FBProcessFetcher subprocessOf:withName:] finds.
+ @return A future that resolves with the Process Identifier of the subprocess, or fails if the parent exits first.
+ */
++ (FBFuture<NSNumber *> *)onQueue:(dispatch_queue_t)queue waitForSubprocessOf:(pid_t)parent withName:(NSString *)name;
+
 /**
  Performs a stackshot on the provided process id.
  Does not terminate the process after performing the stackshot.
@@ -63,7 +63,7 @@ NS_ASSUME_NONNULL_BEGIN
  Performs the necessary unwapping of the statLoc bitmask.
  
  @param statLoc the stat_loc value.
- @param attachment the IO attachment of the process.
+ @param attachment the IO attachment of the process, nil if its streams were connected directly.
  @param statLocFuture the statLoc future to resolve.
  @param exitCodeFuture the exitCode future to resolve.
  @param signalFuture the signal future to resolve.
@@ -72,7 +72,7 @@ NS_ASSUME_NONNULL_BEGIN
  @param configuration the configuration of the finished process.
  @param logger the logger to log to.
  */
-+ (void)resolveProcessFinishedWithStatLoc:(int)statLoc inTeardownOfIOAttachment:(FBProcessIOAttachment *)attachment statLocFuture:(FBMutableFuture<NSNumber *> *)statLocFuture exitCodeFuture:(FBMutableFuture<NSNumber *> *)exitCodeFuture signalFuture:(FBMutableFuture<NSNumber *> *)signalFuture processIdentifier:(pid_t)processIdentifier configuration:(FBProcessSpawnConfiguration *)configuration queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger;
++ (void)resolveProcessFinishedWithStatLoc:(int)statLoc inTeardownOfIOAttachment:(nullable FBProcessIOAttachment *)attachment statLocFuture:(FBMutableFuture<NSNumber *> *)statLocFuture exitCodeFuture:(FBMutableFuture<NSNumber *> *)exitCodeFuture signalFuture:(FBMutableFuture<NSNumber *> *)signalFuture processIdentifier:(pid_t)processIdentifier configuration:(FBProcessSpawnConfiguration *)configuration queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger;
 
 @end
 
@@ -8,10 +8,13 @@
 #import <Foundation/Foundation.h>
 
 #import "FBDataConsumer.h"
+#import "FBFileReader.h"
 #import "FBFuture.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
+@protocol FBBoundedBuffer;
+
 typedef NS_ENUM(NSUInteger, FBProcessStreamAttachmentMode) {
   FBProcessStreamAttachmentModeInput = 0,
   FBProcessStreamAttachmentModeOutput = 1,
@@ -82,6 +85,24 @@ typedef NS_ENUM(NSUInteger, FBProcessStreamAttachmentMode) {
 
 @end
 
+/**
+ Implemented by streams that a launched process can be connected to with a posix_spawn file action alone.
+ There is no pipe or reader to set up, nor anything to tear down, so these are the cheapest streams to launch a process with.
+ */
+@protocol FBProcessStreamDirectAttachment <NSObject>
+
+/**
+ A file descriptor in this process, that is duplicated into the launched process. -1 if the launched process opens `directFilePath` instead.
+ */
+@property (nonatomic, assign, readonly) int directFileDescriptor;
+
+/**
+ The path that the launched process opens, when there is no file descriptor.
+ */
+@property (nonatomic, copy, nullable, readonly) NSString *directFilePath;
+
+@end
+
 /**
  Process Output that can be provided through a file.
  */
@@ -126,6 +147,34 @@ typedef NS_ENUM(NSUInteger, FBProcessStreamAttachmentMode) {
 
 @end
 
+/**
+ Reads the output of a process by pulling chunks of it, without an NSStream or a run loop.
+ Nothing is read from the pipe until a chunk is requested, so a consumer that is slower than the process applies backpressure: the process blocks once the pipe is full.
+ */
+@interface FBProcessOutputReader : NSObject
+
+/**
+ Reads the next chunk of output.
+ Only one read may be outstanding at a time, the next read should be made once the previous has resolved.
+
+ @param maximumLength the maximum number of bytes to read.
+ @return a Future that resolves with the bytes that were available, once there is at least one. Resolves with empty data at the end of the output.
+ */
+- (FBFuture<dispatch_data_t> *)readWithMaximumLength:(size_t)maximumLength;
+
+/**
+ Stops reading, closing the read end of the pipe. An outstanding read resolves with empty data.
+ This happens automatically at the end of the output.
+ */
+- (void)close;
+
+/**
+ The number of bytes that have been read.
+ */
+@property (atomic, assign, readonly) uint64_t bytesRead;
+
+@end
+
 /**
  A container object for the output of a process.
  */
@@ -148,6 +197,15 @@ typedef NS_ENUM(NSUInteger, FBProcessStreamAttachmentMode) {
  */
 + (FBProcessOutput<NSString *> *)outputForFilePath:(NSString *)filePath;
 
+/**
+ An Output Container for a file descriptor that is already open, such as one shared between many processes.
+ The file descriptor is not closed, it remains owned by the caller.
+
+ @param fileDescriptor the file descriptor to write to.
+ @return a Process Output instance.
+ */
++ (FBProcessOutput<NSNumber *> *)outputForFileDescriptor:(int)fileDescriptor;
+
 /**
  An Output Container for an Input Stream
 
@@ -155,6 +213,13 @@ typedef NS_ENUM(NSUInteger, FBProcessStreamAttachmentMode) {
  */
 + (FBProcessOutput<NSInputStream *> *)outputToInputStream;
 
+/**
+ An Output Container for a pull-based reader.
+
+ @return a Process Output instance.
+ */
++ (FBProcessOutput<FBProcessOutputReader *> *)outputToReader;
+
 /**
  An Output Container that passes to both a data consumer and a logger.
 
@@ -172,6 +237,16 @@ typedef NS_ENUM(NSUInteger, FBProcessStreamAttachmentMode) {
  */
 + (FBProcessOutput<id<FBDataConsumer>> *)outputForDataConsumer:(id<FBDataConsumer>)dataConsumer;
 
+/**
+ An Output Container that passes to a Data Consumer, with a configuration for how the output is read.
+
+ @param dataConsumer the data consumer to write to.
+ @param readerConfiguration the configuration of reads of the output, such as FBFileReaderConfiguration.latencyConfiguration or FBFileReaderConfiguration.throughputConfiguration.
+ @param logger the logger to log to, if any.
+ @return a Process Output instance.
+ */
++ (FBProcessOutput<id<FBDataConsumer>> *)outputForDataConsumer:(id<FBDataConsumer>)dataConsumer readerConfiguration:(FBFileReaderConfiguration *)readerConfiguration logger:(nullable id<FBControlCoreLogger>)logger;
+
 /**
  An Output Container that writes to a logger
 
@@ -196,6 +271,17 @@ typedef NS_ENUM(NSUInteger, FBProcessStreamAttachmentMode) {
  */
 + (FBProcessOutput<NSString *> *)outputToStringBackedByMutableData:(NSMutableData *)data;
 
+/**
+ An Output Container that accumulates a bounded amount of data in memory, however much the process writes.
+ The start of the output and the most recent output are kept, so that both the cause of a failure and its final messages are available.
+
+ @param headCapacity the number of bytes from the start of the output to keep.
+ @param tailCapacity the number of most recent bytes to keep.
+ @param spillToTemporaryFile YES if the bytes in between should be written to a temporary file, rather than discarded.
+ @return a Process Output instance.
+ */
++ (FBProcessOutput<id<FBBoundedBuffer>> *)outputToBoundedBufferWithHeadCapacity:(size_t)headCapacity tailCapacity:(size_t)tailCapacity spillToTemporaryFile:(BOOL)spillToTemporaryFile;
+
 #pragma mark Properties
 
 /**
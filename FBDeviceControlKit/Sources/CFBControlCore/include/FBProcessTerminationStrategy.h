@@ -28,8 +28,9 @@ typedef NS_ENUM(NSUInteger, FBProcessTerminationStrategyOptions) {
  A Configuration for the Strategy.
  */
 typedef struct {
-  int signo;
+  int signo; /** The signal to terminate with first **/
   FBProcessTerminationStrategyOptions options;
+  NSTimeInterval backoffTimeout; /** How long to wait for exit before backing off to SIGKILL. Zero uses the default of 20 seconds **/
 } FBProcessTerminationStrategyConfiguration;
 
 
@@ -71,6 +72,26 @@ typedef struct {
  */
 - (FBFuture<NSNull *> *)killProcessIdentifier:(pid_t)processIdentifier;
 
+/**
+ Terminates a batch of Processes.
+ Every process is signalled before waiting on any of them, so they exit concurrently. Exits are observed with kqueue, rather than by polling the process table.
+ If backing off is enabled, the processes that are still running when the backoff timeout elapses are sent SIGKILL together.
+ Processes that have already exited are skipped, rather than failing the batch.
+
+ @param processIdentifiers the pids of the processes to kill.
+ @return a Future that resolves when all of the processes have been killed.
+ */
+- (FBFuture<NSNull *> *)killProcessIdentifiers:(NSArray<NSNumber *> *)processIdentifiers;
+
+/**
+ Terminates all of the Processes in a Process Group, with a single signal to the group.
+ Waiting on exit and backing off behaves as it does for -killProcessIdentifiers:, for the members of the group at the time it is signalled.
+
+ @param processGroup the process group id.
+ @return a Future that resolves when all of the processes in the group have been killed.
+ */
+- (FBFuture<NSNull *> *)killProcessGroup:(pid_t)processGroup;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The framing of the stream that a Scrcpy Demuxer parses.
+ */
+typedef NS_ENUM(NSUInteger, FBScrcpyDemuxerMode) {
+  FBScrcpyDemuxerModeFramed = 0, // The scrcpy protocol: a dummy byte, device and codec metadata, then a frame header before each packet.
+  FBScrcpyDemuxerModeRawStream = 1, // An Annex-B stream with no framing.
+};
+
+/**
+ A NAL unit of a stream, without its start code.
+ The bytes are a view of the data passed to the demuxer, or of its buffer, so are only valid within the handler that the unit is passed to.
+ */
+typedef struct {
+  const uint8_t *bytes;
+  size_t length;
+  // The presentation time of the packet in microseconds, with the flags of the frame header removed. 0 for a raw stream.
+  uint64_t presentationTimeMicroseconds;
+  // YES if the unit is from a packet that has a frame header, NO for a raw stream.
+  BOOL hasFrameHeader;
+  // YES if the frame header of the packet marks it as a key frame.
+  BOOL isKeyFrame;
+  // YES if the frame header of the packet marks it as a config packet, which carries the parameter sets.
+  BOOL isConfigPacket;
+} FBScrcpyNALUnit;
+
+/**
+ Called for each NAL unit that the demuxer parses, in stream order.
+ */
+typedef void (^FBScrcpyNALUnitHandler)(FBScrcpyNALUnit unit);
+
+/**
+ A whole packet of a framed stream, in Annex-B form.
+ The bytes are a view in the same way as those of a NAL unit, so are only valid within the handler that the packet is passed to.
+ */
+typedef struct {
+  const uint8_t *bytes;
+  size_t length;
+  // The presentation time of the packet in microseconds, with the flags of the frame header removed.
+  uint64_t presentationTimeMicroseconds;
+  // YES if the frame header of the packet marks it as a key frame.
+  BOOL isKeyFrame;
+  // YES if the frame header of the packet marks it as a config packet, which carries the parameter sets.
+  BOOL isConfigPacket;
+} FBScrcpyPacket;
+
+/**
+ Called for each packet of a framed stream, after the NAL units of the packet.
+ */
+typedef void (^FBScrcpyPacketHandler)(FBScrcpyPacket packet);
+
+/**
+ Finds the first Annex-B start code, of three or four bytes, using memchr to skip to each zero byte.
+
+ @param bytes the bytes to search.
+ @param length the number of bytes to search.
+ @param startCodeLength an out for the length of the start code that is found.
+ @return the offset of the start code, or length if there is none.
+ */
+extern size_t FBScrcpyFindStartCode(const uint8_t *bytes, size_t length, size_t *startCodeLength);
+
+/**
+ Creates a block buffer of the slices of an Annex-B packet in AVCC form, so that the packet can be decoded by VideoToolbox.
+ The slices are copied once, straight into the memory of the block buffer, with 4-byte big-endian lengths written in place of the start codes. Parameter sets and other non-VCL units are left out, as VideoToolbox takes them from the format description.
+
+ @param bytes the bytes of the packet.
+ @param length the length of the packet.
+ @param codec kCMVideoCodecType_H264 or kCMVideoCodecType_HEVC.
+ @param containsKeyFrame an out for whether any of the slices is of a key frame. May be NULL.
+ @return a block buffer that the caller owns, or NULL if the packet has no slices or the block buffer could not be created.
+ */
+extern CMBlockBufferRef _Nullable FBScrcpyCreateAVCCBlockBuffer(const uint8_t *bytes, size_t length, CMVideoCodecType codec, BOOL *_Nullable containsKeyFrame) CF_RETURNS_RETAINED;
+
+/**
+ Splits a scrcpy video stream into NAL units as the bytes arrive from the socket.
+ When a whole packet is within the bytes that are passed in, its NAL units are views of those bytes. Only a packet that spans calls is copied, once, into a buffer that is retained for the largest packet.
+ Not thread-safe, bytes are expected to be consumed serially.
+ */
+@interface FBScrcpyDemuxer : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param mode the framing of the stream.
+ @return a new Demuxer.
+ */
+- (instancetype)initWithMode:(FBScrcpyDemuxerMode)mode;
+
+#pragma mark Public Methods
+
+/**
+ Consumes bytes of the stream, calling the handler for each NAL unit that is complete.
+ In framed mode a NAL unit is complete once its packet is. In raw stream mode a NAL unit is complete once the start code that follows it arrives.
+
+ @param bytes the bytes to consume.
+ @param length the number of bytes.
+ @param handler the handler to call for each NAL unit, before this method returns.
+ */
+- (void)consumeBytes:(const void *)bytes length:(size_t)length handler:(NS_NOESCAPE FBScrcpyNALUnitHandler)handler;
+
+/**
+ Consumes bytes of the stream, calling the handler for each NAL unit that is complete and the packet handler for each packet that is complete.
+ Packets are only parsed in framed mode, the packet handler is never called for a raw stream.
+
+ @param bytes the bytes to consume.
+ @param length the number of bytes.
+ @param handler the handler to call for each NAL unit, before this method returns.
+ @param packetHandler the handler to call for each packet, after the NAL units of the packet and before this method returns.
+ */
+- (void)consumeBytes:(const void *)bytes length:(size_t)length handler:(NS_NOESCAPE FBScrcpyNALUnitHandler)handler packetHandler:(NS_NOESCAPE nullable FBScrcpyPacketHandler)packetHandler;
+
+/**
+ Discards all buffered bytes and metadata, so that the next bytes are parsed from the start of a stream.
+ */
+- (void)reset;
+
+#pragma mark Properties
+
+/**
+ The framing of the stream.
+ */
+@property (nonatomic, assign, readonly) FBScrcpyDemuxerMode mode;
+
+/**
+ The device name of the device metadata, nil until the metadata is parsed.
+ */
+@property (nonatomic, copy, nullable, readonly) NSString *deviceName;
+
+/**
+ YES once the codec metadata has been parsed.
+ */
+@property (nonatomic, assign, readonly) BOOL hasCodecMetadata;
+
+/**
+ The FourCC of the codec metadata, or one of the scrcpy status values for a disabled or misconfigured stream.
+ */
+@property (nonatomic, assign, readonly) uint32_t codecIdentifier;
+
+/**
+ The initial width of the video of the codec metadata.
+ */
+@property (nonatomic, assign, readonly) uint32_t width;
+
+/**
+ The initial height of the video of the codec metadata.
+ */
+@property (nonatomic, assign, readonly) uint32_t height;
+
+/**
+ The number of bytes that are buffered, waiting for the rest of a packet or NAL unit.
+ */
+@property (nonatomic, assign, readonly) size_t bufferedByteCount;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -15,6 +15,59 @@
 NS_ASSUME_NONNULL_BEGIN
 
 @protocol FBSocketServerDelegate;
+@class FBQueuedCompositeDataConsumer;
+
+/**
+ How a Socket Server accepts clients and configures their sockets.
+ */
+@interface FBSocketServerConfiguration : NSObject <NSCopying>
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param acceptSources the number of accept sources on the listening socket, each on its own queue, so that connections can be set up concurrently.
+ @param perClientQueues YES if each client should be handed to the delegate on a serial queue of its own, NO to use the queue of the delegate.
+ @param noDelay YES if Nagle's algorithm should be disabled on client sockets, so that small writes such as video frames are sent immediately.
+ @param sendBufferSize the size of the send buffer of client sockets, 0 for the system default.
+ @return a new configuration.
+ */
++ (instancetype)configurationWithAcceptSources:(NSUInteger)acceptSources perClientQueues:(BOOL)perClientQueues noDelay:(BOOL)noDelay sendBufferSize:(int)sendBufferSize;
+
+/**
+ A single accept source, with clients handed to the queue of the delegate on sockets with the system defaults.
+ */
+@property (nonatomic, strong, readonly, class) FBSocketServerConfiguration *defaultConfiguration;
+
+/**
+ Concurrent accept sources and a queue per client, on sockets tuned for streaming to many clients at once.
+ */
+@property (nonatomic, strong, readonly, class) FBSocketServerConfiguration *multiClientConfiguration;
+
+#pragma mark Properties
+
+/**
+ The number of accept sources on the listening socket.
+ */
+@property (nonatomic, assign, readonly) NSUInteger acceptSources;
+
+/**
+ Whether each client is handed to the delegate on a serial queue of its own.
+ */
+@property (nonatomic, assign, readonly) BOOL perClientQueues;
+
+/**
+ Whether Nagle's algorithm is disabled on client sockets.
+ */
+@property (nonatomic, assign, readonly) BOOL noDelay;
+
+/**
+ The size of the send buffer of client sockets, 0 for the system default.
+ */
+@property (nonatomic, assign, readonly) int sendBufferSize;
+
+@end
 
 /**
  A Generic Socket Server.
@@ -32,6 +85,28 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (instancetype)socketServerOnPort:(in_port_t)port delegate:(id<FBSocketServerDelegate>)delegate;
 
+/**
+ Creates and returns a socket server for the provided port, delegate and configuration.
+
+ @param port the port to bind against.
+ @param delegate the delegate to use.
+ @param configuration how clients are accepted and their sockets configured.
+ @return a new socket server.
+ */
++ (instancetype)socketServerOnPort:(in_port_t)port delegate:(id<FBSocketServerDelegate>)delegate configuration:(FBSocketServerConfiguration *)configuration;
+
+/**
+ Creates and returns a socket server that adds every client to a fan-out, such as the consumer of a video stream.
+ Each client is written to from its own queue, so a slow client has data dropped for it rather than stalling the others. A client is removed from the fan-out when it disconnects.
+
+ @param port the port to bind against.
+ @param fanOut the fan-out to add clients to.
+ @param maxPendingBytes the number of bytes that may be pending for a client before data is dropped for it.
+ @param configuration how clients are accepted and their sockets configured.
+ @return a new socket server.
+ */
++ (instancetype)socketServerOnPort:(in_port_t)port fanOut:(FBQueuedCompositeDataConsumer *)fanOut maxPendingBytes:(size_t)maxPendingBytes configuration:(FBSocketServerConfiguration *)configuration;
+
 #pragma mark Properties
 
 /**
@@ -39,6 +114,11 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, assign, readonly) in_port_t port;
 
+/**
+ How clients are accepted and their sockets configured.
+ */
+@property (nonatomic, copy, readonly) FBSocketServerConfiguration *configuration;
+
 #pragma mark Public Methods
 
 /**
@@ -86,6 +166,19 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, strong, readonly) dispatch_queue_t queue;
 
+@optional
+
+/**
+ Called instead of -socketServer:clientConnected:fileDescriptor: when the server has a queue per client.
+ This is called on the queue of the client, which can be used for all further work with the client.
+
+ @param server the socket server.
+ @param address the IP Address of the connected client.
+ @param fileDescriptor the file descriptor of the connected socket.
+ @param queue the serial queue of the client.
+ */
+- (void)socketServer:(FBSocketServer *)server clientConnected:(struct in6_addr)address fileDescriptor:(int)fileDescriptor queue:(dispatch_queue_t)queue;
+
 @end
 
 NS_ASSUME_NONNULL_END
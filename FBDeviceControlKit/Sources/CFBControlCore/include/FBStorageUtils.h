@@ -76,6 +76,21 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (nullable FBBundleDescriptor *)bundleInDirectory:(NSURL *)directory error:(NSError **)error;
 
+#pragma mark Copying Files
+
+/**
+ Copies a file or directory, as a clone where the filesystem supports it.
+ On APFS the copy is made with clonefile(2), which takes constant time and shares storage with the source until either is modified.
+ Otherwise the files of a directory are copied concurrently, and large files are copied in concurrent chunks.
+ As with -[NSFileManager copyItemAtPath:toPath:error:], the destination must not exist and symbolic links are copied rather than followed.
+
+ @param sourcePath the file or directory to copy.
+ @param destinationPath the path to copy to.
+ @param error an error out for any error that occurs.
+ @return YES if successful, NO otherwise.
+ */
++ (BOOL)cloneItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(NSError **)error;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -127,6 +127,17 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (FBFutureContext<NSURL *> *)withTemporaryDirectory;
 
+/**
+ A Future Context for a staged copy of a file or directory.
+ The copy is made with -[FBStorageUtils cloneItemAtPath:toPath:error:], so takes no time or space where the filesystem supports clones.
+ Staged copies are shared across the process, so staging a source again whilst it is still staged, such as when installing the same bundle on many devices, reuses the existing copy.
+ A source is the same if its path, size and modification time are unchanged. The staged copy is removed when the last context using it exits.
+
+ @param path the file or directory to stage.
+ @return a Context Future with the staged copy, which must not be modified as it may be shared.
+ */
+- (FBFutureContext<NSURL *> *)withStagedCopyOfItemAtPath:(NSString *)path;
+
 #pragma mark Properties
 
 /**
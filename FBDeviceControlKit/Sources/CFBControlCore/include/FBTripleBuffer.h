@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The statistics of a Triple Buffer since they were last reset.
+ Intervals are in milliseconds, averages are 0 until two values have been published or consumed.
+ */
+typedef struct {
+  uint64_t publishedCount;
+  uint64_t consumedCount;
+  uint64_t skippedCount;
+  uint64_t maxConsecutiveSkips;
+  double averagePublishInterval;
+  double maxPublishInterval;
+  double averageConsumeInterval;
+  double maxConsumeInterval;
+  // The time since the statistics were last reset, in seconds.
+  double interval;
+} FBTripleBufferStatistics;
+
+/**
+ A latest-wins exchange of objects between one producer and one consumer, which never blocks either side.
+ The producer writes into a back slot and the consumer reads from a front slot, each owned by one side. The slots are exchanged through a middle slot with a single atomic swap, so publishing never waits on consuming and vice versa.
+ A value that is published over one that has not been consumed replaces it, and is counted as skipped.
+ The statistics are relaxed atomic counters, each written by one side only, so they can be read from any thread without synchronizing the two sides.
+
+ -publish: must only be called from the producer, -consume and -peek from the consumer. -reset must only be called when neither side is running.
+ */
+@interface FBTripleBuffer : NSObject
+
+#pragma mark Public Methods
+
+/**
+ Publishes a value, making it the latest value for the consumer.
+
+ @param value the value to publish.
+ @return YES if a previously published value had not been consumed, and has been skipped.
+ */
+- (BOOL)publish:(id)value;
+
+/**
+ Consumes the latest published value.
+
+ @return the latest value, or nil if there has been no value published since the last one was consumed.
+ */
+- (nullable id)consume;
+
+/**
+ The value that was last consumed, without consuming a newer one.
+
+ @return the value that was last consumed, or nil if there is none.
+ */
+- (nullable id)peek;
+
+/**
+ Releases all of the values, so that the buffer is empty.
+ */
+- (void)reset;
+
+/**
+ Reads the statistics, then resets them.
+
+ @return the statistics since the last reset.
+ */
+- (FBTripleBufferStatistics)readAndResetStatistics;
+
+#pragma mark Properties
+
+/**
+ YES if a value has been published since the last one was consumed. May be read from any thread.
+ */
+@property (nonatomic, assign, readonly) BOOL hasNewValue;
+
+/**
+ The number of values published since the statistics were last reset. May be read from any thread.
+ */
+@property (nonatomic, assign, readonly) uint64_t publishedCount;
+
+/**
+ The number of values skipped since the statistics were last reset. May be read from any thread.
+ */
+@property (nonatomic, assign, readonly) uint64_t skippedCount;
+
+@end
+
+NS_ASSUME_NONNULL_END
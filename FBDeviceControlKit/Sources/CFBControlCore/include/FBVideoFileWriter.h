@@ -8,6 +8,7 @@
 #import <Foundation/Foundation.h>
 
 #import "FBControlCore.h"
+#import "FBVideoSurfaceConsumer.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -56,4 +57,52 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+/**
+ Writes the encoded H264 or HEVC samples of a video stream to a file with AVAssetWriter, without re-encoding them.
+ The file is a fragmented MPEG-4 or QuickTime movie, to which a movie fragment is appended every segment duration. A recording that is interrupted, for instance by a crash, can still be played up to the last fragment that was written.
+ The file starts with the first key frame, earlier samples are discarded. When the writer cannot keep up, samples are discarded until the next key frame.
+ Attach it to an encoded FBVideoStream as a consumer, ending the stream finishes the file.
+ */
+@interface FBVideoSampleFileWriter : NSObject <FBVideoSampleConsumer, FBDataConsumerLifecycle>
+
+#pragma mark Initializers
+
+/**
+ Creates a Sample Writer.
+
+ @param filePath the File Path to record to. A path extension of "mov" writes a QuickTime movie, any other extension writes an MPEG-4 file.
+ @param segmentDuration the interval at which movie fragments are written, in seconds. This bounds how much of the recording is lost when it is interrupted.
+ @param logger the logger to use.
+ @param error an error out for any error that occurs.
+ @return a new Sample Writer, or nil if the file could not be created.
+ */
++ (nullable instancetype)writerWithFilePath:(NSString *)filePath segmentDuration:(NSTimeInterval)segmentDuration logger:(id<FBControlCoreLogger>)logger error:(NSError **)error;
+
+#pragma mark Public Methods
+
+/**
+ YES, the default, if samples are consumed as they are captured. Samples are then discarded when the writer cannot keep up, rather than holding up the stream.
+ Set to NO before the first sample when consuming samples faster than real time, such as those of a replay buffer. The writer then waits for each sample to be accepted, and never discards samples.
+ */
+@property (atomic, assign, readwrite) BOOL expectsMediaDataInRealTime;
+
+/**
+ A Future that resolves when the first key frame has been written.
+ */
+@property (nonatomic, strong, readonly) FBFuture<NSNull *> *started;
+
+/**
+ Finishes the file. Samples consumed afterwards are discarded.
+
+ @return A future that resolves when the file has been finished.
+ */
+- (FBFuture<NSNull *> *)stopRecording;
+
+/**
+ A Future that resolves when the file has been finished.
+ */
+@property (nonatomic, strong, readonly) FBFuture<NSNull *> *completed;
+
+@end
+
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBDataConsumer.h"
+#import "FBFuture.h"
+#import "FBVideoSurfaceConsumer.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@protocol FBControlCoreLogger;
+
+/**
+ Keeps the most recent seconds of an encoded video stream in memory, so that they can be written to a file after something of interest has happened.
+ Samples are held as the groups of pictures that the encoder produced, each starting with a key frame. The oldest group is discarded once the remaining groups cover the window, so the buffer always starts on a key frame and holds between one window and one window plus a group.
+ Encoded samples are retained as they are, so memory use is bounded by the bitrate of the stream multiplied by the window. A byte limit guards against a misconfigured bitrate.
+ Attach it to an H264 or HEVC FBVideoStream as a consumer.
+ */
+@interface FBVideoReplayBuffer : NSObject <FBVideoSampleConsumer, FBDataConsumerLifecycle>
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param window the duration of the stream to keep, in seconds.
+ @param maximumByteCount the most encoded bytes to keep, regardless of the window.
+ @param logger the logger to log to.
+ @return a new Replay Buffer.
+ */
+- (instancetype)initWithWindow:(NSTimeInterval)window maximumByteCount:(NSUInteger)maximumByteCount logger:(id<FBControlCoreLogger>)logger;
+
+#pragma mark Public Methods
+
+/**
+ Writes the buffered samples to a file, without re-encoding them. The buffer keeps consuming whilst the file is written.
+
+ @param filePath the file path to write to, as for FBVideoSampleFileWriter.
+ @return A future that resolves with the file path once the file has been written.
+ */
+- (FBFuture<NSString *> *)writeToFile:(NSString *)filePath;
+
+/**
+ Discards all of the buffered samples.
+ */
+- (void)clear;
+
+#pragma mark Properties
+
+/**
+ The duration of the stream to keep, in seconds.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval window;
+
+/**
+ The duration of the buffered samples, in seconds.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval bufferedDuration;
+
+/**
+ The number of encoded bytes that are buffered.
+ */
+@property (nonatomic, assign, readonly) NSUInteger bufferedByteCount;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -9,11 +9,82 @@
 #import <CoreMedia/CoreMedia.h>
 
 #import "FBiOSTargetOperation.h"
+#import "FBVideoStreamConfiguration.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 @protocol FBDataConsumer;
 @protocol FBDataConsumerSync;
+@protocol FBControlCoreLogger;
+
+/**
+ A point-in-time snapshot of the frame counters of a Video Stream.
+ */
+@interface FBVideoStreamStatistics : NSObject
+
+/**
+ The number of frames written to the consumer.
+ */
+@property (nonatomic, assign, readonly) uint64_t framesSent;
+
+/**
+ The number of frames dropped before being written to the consumer.
+ */
+@property (nonatomic, assign, readonly) uint64_t framesDropped;
+
+/**
+ The number of key frames dropped before being written to the consumer.
+ */
+@property (nonatomic, assign, readonly) uint64_t keyFramesDropped;
+
+/**
+ The number of frames that were pending in the consumer and were discarded.
+ */
+@property (nonatomic, assign, readonly) uint64_t framesDiscarded;
+
+/**
+ The number of distinct congestion episodes, a run of consecutive drops counts once.
+ */
+@property (nonatomic, assign, readonly) uint64_t congestionEvents;
+
+@end
+
+/**
+ Applies a backpressure policy to the frames written to a consumer, counting the frames that are sent and dropped.
+ Gating decisions are expected to be made from a single serial queue, statistics may be read from any thread.
+ */
+@interface FBVideoStreamFrameGate : NSObject
+
+/**
+ The Designated Initializer.
+
+ @param policy the backpressure policy to apply.
+ @param maxPendingFrames the number of frames that may be pending in an asynchronous consumer before it is considered congested.
+ @return a new Frame Gate.
+ */
+- (instancetype)initWithPolicy:(FBVideoStreamBackpressurePolicy)policy maxPendingFrames:(NSUInteger)maxPendingFrames;
+
+/**
+ Decides whether a frame should be written to a consumer.
+ The frame is counted as sent if YES is returned, dropped otherwise.
+
+ @param consumer the consumer that the frame would be written to.
+ @param isKeyFrame YES if the frame does not depend on other frames.
+ @return YES if the frame should be written, NO if it should be dropped.
+ */
+- (BOOL)shouldWriteFrameToConsumer:(id<FBDataConsumer>)consumer isKeyFrame:(BOOL)isKeyFrame;
+
+/**
+ Counts a frame that was dropped before reaching the gate, for instance by the capture output.
+ */
+- (void)recordDroppedFrame;
+
+/**
+ A snapshot of the counters of the gate.
+ */
+@property (nonatomic, strong, readonly) FBVideoStreamStatistics *statistics;
+
+@end
 
 /**
  Streams Bitmaps to a File Sink
@@ -37,10 +108,101 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (FBFuture<NSNull *> *)stopStreaming;
 
+/**
+ Requests that the next frame of the stream is a key frame, so that a consumer can start decoding without waiting for the key frame interval.
+ Streams where every frame is independent, such as bitmap and MJPEG streams, resolve immediately.
+
+ @return A future that resolves when the request has been submitted, or fails if the stream cannot produce a key frame on demand.
+ */
+- (FBFuture<NSNull *> *)requestKeyFrame;
+
+/**
+ A snapshot of the frame counters of the stream.
+ */
+@property (nonatomic, strong, readonly) FBVideoStreamStatistics *statistics;
+
 @end
 
 /**
- Returns true if consumer is ready to process another frame, false if consumer buffered data exceedes allowed limit
+ Caches the Annex-B parameter set header (start codes with VPS, SPS & PPS as appropriate for the codec) for a stream.
+ The header is only rebuilt when the format description of the stream changes, for instance on a mid-stream resolution change.
+ Not thread-safe, it is expected to be used from the serial queue that the stream writes frames on.
+ */
+@interface FBAnnexBParameterSetCache : NSObject
+
+/**
+ Returns the Annex-B parameter set header for the format, re-using the cached header if the format is unchanged.
+
+ @param format the format description of the sample being written.
+ @param logger the logger to log format changes to.
+ @param error an error out for any error that occurs.
+ @return the parameter set header, or nil on failure.
+ */
+- (nullable dispatch_data_t)parameterSetsForFormatDescription:(CMFormatDescriptionRef)format logger:(nullable id<FBControlCoreLogger>)logger error:(NSError **)error;
+
+/**
+ The number of times that the parameter set header has been built, one more than the number of mid-stream format changes.
+ */
+@property (nonatomic, assign, readonly) NSUInteger formatChangeCount;
+
+@end
+
+/**
+ The magic that begins every FBVideoStreamFrameHeader, the bytes 'FBVF' in stream order.
+ */
+extern uint32_t const FBVideoStreamFrameHeaderMagic;
+
+/**
+ The flags of an FBVideoStreamFrameHeader.
+ */
+typedef NS_OPTIONS(uint16_t, FBVideoStreamFrameHeaderFlags) {
+  FBVideoStreamFrameHeaderFlagKeyFrame = 1 << 0,
+};
+
+/**
+ The header that prefixes every frame of a stream with framed output. All fields, other than the magic, are little-endian.
+ Host times are in mach_absolute_time units, so that a consumer on the same host can compare them with its own clock.
+ The sequence number increments for every frame that the stream produces, a gap means that frames were dropped for this consumer.
+ */
+typedef struct __attribute__((packed)) {
+  uint32_t magic;
+  // The length of the header, including this field. Readers should skip bytes beyond the fields that they understand.
+  uint16_t headerLength;
+  uint16_t flags;
+  uint32_t sequenceNumber;
+  // The length of the frame that follows the header.
+  uint32_t frameLength;
+  // The presentation timestamp of the frame in nanoseconds, INT64_MIN if the stream has no timestamp for the frame.
+  int64_t presentationTimeNanos;
+  // The host time at which the frame was delivered by the capture output.
+  uint64_t captureHostTime;
+  // The host time at which the frame was written to the stream, after any encoding.
+  uint64_t writeHostTime;
+} FBVideoStreamFrameHeader;
+
+/**
+ Prefixes a frame with an FBVideoStreamFrameHeader. The write host time is the time of the call.
+
+ @param frame the bytes of the frame.
+ @param sequenceNumber the sequence number of the frame.
+ @param isKeyFrame YES if the frame does not depend on other frames.
+ @param presentationTimeStamp the presentation time of the frame, kCMTimeInvalid if not known.
+ @param captureHostTime the host time at which the frame was captured.
+ @return the header and the frame. The frame is not copied.
+ */
+extern dispatch_data_t FBVideoStreamFramedData(dispatch_data_t frame, uint32_t sequenceNumber, BOOL isKeyFrame, CMTime presentationTimeStamp, uint64_t captureHostTime);
+
+/**
+ Returns YES if the sample buffer does not depend on other frames.
+
+ @param sampleBuffer the sample buffer to inspect.
+ @return YES if a key frame, NO otherwise.
+ */
+extern BOOL FBVideoStreamSampleBufferIsKeyFrame(CMSampleBufferRef sampleBuffer);
+
+/**
+ Returns true if consumer is ready to process another frame, false if consumer buffered data exceedes the default limit.
+ Streams that need a configurable policy or drop statistics should use FBVideoStreamFrameGate.
  
  @param consumer consumer
  @return True if next frame should be pushed; False if frame should be dropped
@@ -48,7 +210,10 @@ NS_ASSUME_NONNULL_BEGIN
 extern BOOL checkConsumerBufferLimit(id<FBDataConsumer> consumer, id<FBControlCoreLogger> logger);
 
 /**
- Write an H264 frame to the stream, in the Annex-B stream format.
+ Write an H264 or HEVC frame to the stream, in the Annex-B stream format.
+ The codec is determined from the format description of the sample buffer.
+ The AVCC length prefixes are rewritten to start codes in-place within the sample's block buffer, so frame bytes are not copied.
+ The consumer receives a dispatch_data_t (bridged to NSData) that retains the block buffer, so it is safe for asynchronous consumers.
 
  @param sampleBuffer the Sample buffer to write.
  @param consumer the consumer to write to.
@@ -58,8 +223,21 @@ extern BOOL checkConsumerBufferLimit(id<FBDataConsumer> consumer, id<FBControlCo
  */
 extern BOOL WriteFrameToAnnexBStream(CMSampleBufferRef sampleBuffer, id<FBDataConsumer> consumer, id<FBControlCoreLogger> logger, NSError **error);
 
+/**
+ Write an H264 or HEVC frame to the stream, in the Annex-B stream format, using a cache of the parameter sets.
+
+ @param sampleBuffer the Sample buffer to write.
+ @param cache the parameter set cache of the stream. If nil the parameter sets are built on every keyframe.
+ @param consumer the consumer to write to.
+ @param logger the logger to use.
+ @param error an error out for any error that occurs.
+ @return YES if successful, NO otherwise.
+ */
+extern BOOL WriteFrameToAnnexBStreamWithParameterSetCache(CMSampleBufferRef sampleBuffer, FBAnnexBParameterSetCache *_Nullable cache, id<FBDataConsumer> consumer, id<FBControlCoreLogger> logger, NSError **error);
+
 /**
  Write a JPEG frame to the MJPEG stream.
+ The frame is written in a single call, as a dispatch_data_t (bridged to NSData) that retains the block buffer rather than copying it.
 
  @param jpegDataBuffer the JPEG data to write.
  @param consumer the consumer to write to.
@@ -71,6 +249,7 @@ extern BOOL WriteJPEGDataToMJPEGStream(CMBlockBufferRef jpegDataBuffer, id<FBDat
 
 /**
  Write a Minicap frame to the stream, based upon using the provided JPEG Block Buffer.
+ The length prefix and the frame are written in a single call, the frame is not copied.
 
  @param jpegDataBuffer the JPEG data to write.
  @param consumer the consumer to write to.
@@ -91,4 +270,19 @@ extern BOOL WriteJPEGDataToMinicapStream(CMBlockBufferRef jpegDataBuffer, id<FBD
 */
 extern BOOL WriteMinicapHeaderToStream(uint32_t width, uint32_t height, id<FBDataConsumer> consumer, id<FBControlCoreLogger> logger, NSError **error);
 
+/**
+ Write a Minicap header to the stream, for a stream that is scaled or rotated.
+
+ @param displayWidth the width of the display.
+ @param displayHeight the height of the display.
+ @param virtualWidth the width of the image stream.
+ @param virtualHeight the height of the image stream.
+ @param orientation the orientation of the display, in quarter turns from 0-3.
+ @param consumer the consumer to write to.
+ @param logger the logger to use.
+ @param error an error out for any error that occurs.
+ @return YES if successful, NO otherwise.
+*/
+extern BOOL WriteMinicapHeaderWithVirtualDisplayToStream(uint32_t displayWidth, uint32_t displayHeight, uint32_t virtualWidth, uint32_t virtualHeight, uint8_t orientation, id<FBDataConsumer> consumer, id<FBControlCoreLogger> logger, NSError **error);
+
 NS_ASSUME_NONNULL_END
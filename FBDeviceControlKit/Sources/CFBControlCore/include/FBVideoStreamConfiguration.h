@@ -14,10 +14,29 @@ NS_ASSUME_NONNULL_BEGIN
  */
 typedef NSString *FBVideoStreamEncoding NS_STRING_ENUM;
 extern FBVideoStreamEncoding const FBVideoStreamEncodingH264;
+extern FBVideoStreamEncoding const FBVideoStreamEncodingHEVC;
 extern FBVideoStreamEncoding const FBVideoStreamEncodingBGRA;
 extern FBVideoStreamEncoding const FBVideoStreamEncodingMJPEG;
 extern FBVideoStreamEncoding const FBVideoStreamEncodingMinicap;
 
+/**
+ How a Video Stream behaves when a consumer is not keeping up with the frames that are produced.
+ */
+typedef NS_ENUM(NSUInteger, FBVideoStreamBackpressurePolicy) {
+  FBVideoStreamBackpressurePolicyDropNewest = 0, // Frames produced whilst the consumer is congested are dropped.
+  FBVideoStreamBackpressurePolicyDropOldest = 1, // Frames pending in the consumer are discarded in favour of the newest frame. Falls back to dropping the newest frame for consumers that cannot discard.
+  FBVideoStreamBackpressurePolicyPreserveKeyFrames = 2, // Key frames are never dropped. Once a dependent frame is dropped, all dependent frames until the next key frame are dropped.
+};
+
+/**
+ The pixel format of uncompressed frames in a Video Stream.
+ */
+typedef NS_ENUM(NSUInteger, FBVideoStreamPixelFormat) {
+  FBVideoStreamPixelFormatBGRA = 0, // 32-bit BGRA.
+  FBVideoStreamPixelFormat420VideoRange = 1, // Bi-planar 4:2:0 YCbCr, video range (420v).
+  FBVideoStreamPixelFormat420FullRange = 2, // Bi-planar 4:2:0 YCbCr, full range (420f).
+};
+
 /**
  A Configuration Object for a Video Stream.
  */
@@ -33,6 +52,52 @@ extern FBVideoStreamEncoding const FBVideoStreamEncodingMinicap;
  */
 - (instancetype)initWithEncoding:(FBVideoStreamEncoding)encoding framesPerSecond:(nullable NSNumber *)framesPerSecond compressionQuality:(nullable NSNumber *)compressionQuality scaleFactor:(nullable NSNumber *)scaleFactor avgBitrate:(nullable NSNumber *)avgBitrate keyFrameRate:(nullable NSNumber *)keyFrameRate;
 
+/**
+ Returns a copy of the receiver with the provided encoder options.
+ These apply to the VideoToolbox encoder used for H264 & HEVC streams.
+
+ @param realtime YES if the encoder should run in real-time mode, favouring latency over compression efficiency.
+ @param lowLatencyRateControl YES if the encoder should use low-latency rate control, where supported.
+ @return a new Configuration.
+ */
+- (instancetype)withRealtime:(BOOL)realtime lowLatencyRateControl:(BOOL)lowLatencyRateControl;
+
+/**
+ Returns a copy of the receiver with the provided backpressure options.
+
+ @param backpressurePolicy the policy to apply when a consumer is congested.
+ @param maxPendingFrames the number of frames that may be pending in an asynchronous consumer before it is considered congested.
+ @return a new Configuration.
+ */
+- (instancetype)withBackpressurePolicy:(FBVideoStreamBackpressurePolicy)backpressurePolicy maxPendingFrames:(NSUInteger)maxPendingFrames;
+
+/**
+ Returns a copy of the receiver that limits the frame rate to the refresh rate of the main display.
+ This takes precedence over framesPerSecond and is resolved when the stream is created.
+
+ @param matchDisplayRefreshRate YES if the frame rate should match the refresh rate of the main display.
+ @return a new Configuration.
+ */
+- (instancetype)withFramesPerSecondMatchingDisplayRefreshRate:(BOOL)matchDisplayRefreshRate;
+
+/**
+ Returns a copy of the receiver with the provided output format options.
+ The scaleFactor and maxDimension are both applied, the smaller of the resulting sizes is used.
+
+ @param pixelFormat the pixel format of uncompressed frames.
+ @param maxDimension the maximum length of the longest edge of frames in pixels. nil for no limit.
+ @return a new Configuration.
+ */
+- (instancetype)withPixelFormat:(FBVideoStreamPixelFormat)pixelFormat maxDimension:(nullable NSNumber *)maxDimension;
+
+/**
+ Returns a copy of the receiver that prefixes every frame with an FBVideoStreamFrameHeader.
+
+ @param framedOutput YES if frames should be prefixed with a header.
+ @return a new Configuration.
+ */
+- (instancetype)withFramedOutput:(BOOL)framedOutput;
+
 /**
  The encoding of the stream.
  */
@@ -44,7 +109,7 @@ extern FBVideoStreamEncoding const FBVideoStreamEncodingMinicap;
 @property (nonatomic, copy, readonly) NSNumber *compressionQuality;
 
 /**
- The number of frames per second to use if using an eager stream.
+ The number of frames per second to use if using an eager stream, this may be fractional.
  nil if lazy streaming should be used.
  */
 @property (nonatomic, copy, nullable, readonly) NSNumber *framesPerSecond;
@@ -54,6 +119,17 @@ extern FBVideoStreamEncoding const FBVideoStreamEncodingMinicap;
  */
 @property (nonatomic, copy, nullable, readonly) NSNumber *scaleFactor;
 
+/**
+ The pixel format of uncompressed frames. Defaults to FBVideoStreamPixelFormatBGRA.
+ For the BGRA encoding this is the format of the frames that are streamed, for H264 & HEVC it is the format that is passed to the encoder.
+ */
+@property (nonatomic, assign, readonly) FBVideoStreamPixelFormat pixelFormat;
+
+/**
+ The maximum length of the longest edge of frames in pixels. nil for no limit.
+ */
+@property (nonatomic, copy, nullable, readonly) NSNumber *maxDimension;
+
 /**
  Average bitrate.
  */
@@ -64,6 +140,37 @@ extern FBVideoStreamEncoding const FBVideoStreamEncodingMinicap;
  */
 @property (nonatomic, copy, nullable, readonly) NSNumber *keyFrameRate;
 
+/**
+ YES if the encoder should run in real-time mode. Defaults to YES.
+ */
+@property (nonatomic, assign, readonly) BOOL realtime;
+
+/**
+ YES if the encoder should use low-latency rate control. Defaults to NO.
+ */
+@property (nonatomic, assign, readonly) BOOL lowLatencyRateControl;
+
+/**
+ YES if the frame rate should match the refresh rate of the main display. Defaults to NO.
+ */
+@property (nonatomic, assign, readonly) BOOL matchDisplayRefreshRate;
+
+/**
+ The policy to apply when a consumer is congested. Defaults to FBVideoStreamBackpressurePolicyDropNewest.
+ */
+@property (nonatomic, assign, readonly) FBVideoStreamBackpressurePolicy backpressurePolicy;
+
+/**
+ The number of frames that may be pending in an asynchronous consumer before it is considered congested. Defaults to 2.
+ */
+@property (nonatomic, assign, readonly) NSUInteger maxPendingFrames;
+
+/**
+ YES if every frame is prefixed with an FBVideoStreamFrameHeader, carrying the timing of the frame. Defaults to NO.
+ Surface consumers receive pixel buffers, rather than bytes, so are unaffected.
+ */
+@property (nonatomic, assign, readonly) BOOL framedOutput;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+#import <CoreVideo/CoreVideo.h>
+
+#import "FBVideoStream.h"
+#import "FBVideoStreamConfiguration.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@protocol FBDataConsumer;
+@protocol FBControlCoreLogger;
+
+/**
+ Writes the bytes of a single frame, or of a stream header, to a consumer.
+ The writer may call the consumer any number of times, the bytes of all calls are delivered to subscribers as one unit.
+
+ @param consumer the consumer to write to.
+ @return YES if successful, NO otherwise.
+ */
+typedef BOOL (^FBVideoStreamFanoutWriter)(id<FBDataConsumer> consumer);
+
+/**
+ Distributes the frames of a single video stream to any number of consumers.
+ Each consumer is fed from its own serial queue, with its own backpressure policy, so that a slow consumer cannot stall the others.
+ Consumers that conform to FBDataConsumerAsync, such as +[FBBlockDataConsumer ringBufferDataConsumerOnQueue:capacity:consumer:], already deliver on their own queue so are written to directly.
+ Consumers that conform to FBVideoSurfaceConsumer receive frames as pixel buffers, and never receive the bytes of encoded frames.
+ Consumers that conform to FBVideoSampleConsumer receive encoded frames as sample buffers, and never receive bytes or pixel buffers.
+ Consumers may be added and removed at any time, including whilst frames are being written.
+ Frames are expected to be written from a single serial queue.
+ */
+@interface FBVideoStreamFanout : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param framedOutput YES if the bytes of each frame should be prefixed with an FBVideoStreamFrameHeader.
+ @param logger the logger to log to.
+ @return a new Fanout.
+ */
+- (instancetype)initWithFramedOutput:(BOOL)framedOutput logger:(id<FBControlCoreLogger>)logger;
+
+#pragma mark Subscription
+
+/**
+ Adds a consumer. If a stream header has been written, it is delivered before the first frame.
+
+ @param consumer the consumer to add.
+ @param policy the backpressure policy of the consumer.
+ @param maxPendingFrames the number of frames that may be queued for the consumer before it is considered congested.
+ @param error an error out for any error that occurs.
+ @return YES if added, NO if the consumer was already added.
+ */
+- (BOOL)addConsumer:(id<FBDataConsumer>)consumer policy:(FBVideoStreamBackpressurePolicy)policy maxPendingFrames:(NSUInteger)maxPendingFrames error:(NSError **)error;
+
+/**
+ Removes a consumer. Frames that are already queued for the consumer are discarded.
+
+ @param consumer the consumer to remove.
+ @param error an error out for any error that occurs.
+ @return YES if removed, NO if the consumer was not added.
+ */
+- (BOOL)removeConsumer:(id<FBDataConsumer>)consumer error:(NSError **)error;
+
+/**
+ The number of consumers that are currently added.
+ */
+@property (nonatomic, assign, readonly) NSUInteger consumerCount;
+
+/**
+ Called on the queue that frames are written on when a consumer cannot decode further frames until it receives a key frame.
+ This occurs when a consumer is added and when a dependent frame is dropped for a consumer, it is called at most once until a key frame is written.
+ A consumer that is added receives no dependent frames until its first key frame.
+ */
+@property (atomic, copy, nullable, readwrite) dispatch_block_t keyFrameRequestHandler;
+
+#pragma mark Writing
+
+/**
+ Sets the stream header and writes it to all consumers.
+ The header is also written to any consumer that is added afterwards, before its first frame.
+
+ @param writer the writer of the header bytes.
+ @return YES if successful, NO otherwise.
+ */
+- (BOOL)writeStreamHeader:(FBVideoStreamFanoutWriter)writer;
+
+/**
+ Writes a frame to every byte consumer whose backpressure policy admits it.
+ The writer is called at most once per frame, and not at all if no consumer admits the frame.
+
+ @param isKeyFrame YES if the frame does not depend on other frames.
+ @param presentationTimeStamp the presentation time of the frame, kCMTimeInvalid if not known.
+ @param captureHostTime the mach host time at which the frame was captured.
+ @param writer the writer of the frame bytes.
+ @return YES if successful, NO otherwise.
+ */
+- (BOOL)writeFrameIsKeyFrame:(BOOL)isKeyFrame presentationTimeStamp:(CMTime)presentationTimeStamp captureHostTime:(uint64_t)captureHostTime writer:(FBVideoStreamFanoutWriter)writer;
+
+/**
+ Writes a bitmap frame. Consumers that conform to FBVideoSurfaceConsumer receive the pixel buffer when it is IOSurface-backed, all other consumers receive the bytes of the writer.
+
+ @param pixelBuffer the pixel buffer of the frame.
+ @param presentationTimeStamp the presentation time of the frame.
+ @param captureHostTime the mach host time at which the frame was captured.
+ @param writer the writer of the frame bytes.
+ @return YES if successful, NO otherwise.
+ */
+- (BOOL)writePixelBuffer:(CVPixelBufferRef)pixelBuffer presentationTimeStamp:(CMTime)presentationTimeStamp captureHostTime:(uint64_t)captureHostTime writer:(FBVideoStreamFanoutWriter)writer;
+
+/**
+ Writes the uncompressed source of an encoded frame to the consumers that conform to FBVideoSurfaceConsumer, so that they can share the capture session of an encoded stream.
+ Nothing is written if the pixel buffer is not IOSurface-backed.
+
+ @param pixelBuffer the pixel buffer of the frame, before it is encoded.
+ @param presentationTimeStamp the presentation time of the frame.
+ */
+- (void)writeSurfacePixelBuffer:(CVPixelBufferRef)pixelBuffer presentationTimeStamp:(CMTime)presentationTimeStamp;
+
+/**
+ Writes an encoded frame to the consumers that conform to FBVideoSampleConsumer, whose backpressure policy admits it.
+ Should be called alongside -writeFrameIsKeyFrame:presentationTimeStamp:captureHostTime:writer: for the same frame, so that sample consumers can mux the stream without re-encoding it.
+
+ @param sampleBuffer the encoded sample buffer of the frame.
+ */
+- (void)writeSampleBuffer:(CMSampleBufferRef)sampleBuffer;
+
+/**
+ Counts a frame that was dropped before it could be written, against every consumer.
+ */
+- (void)recordDroppedFrame;
+
+#pragma mark Statistics
+
+/**
+ The frame counters of a consumer.
+
+ @param consumer the consumer to obtain statistics for.
+ @return the statistics, or nil if the consumer is not added.
+ */
+- (nullable FBVideoStreamStatistics *)statisticsForConsumer:(id<FBDataConsumer>)consumer;
+
+/**
+ The frame counters summed across all of the current consumers.
+ */
+@property (nonatomic, strong, readonly) FBVideoStreamStatistics *statistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
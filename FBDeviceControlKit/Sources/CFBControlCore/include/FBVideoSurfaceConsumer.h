@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+#import <CoreVideo/CoreVideo.h>
+#import <IOSurface/IOSurface.h>
+
+#import "FBDataConsumer.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A consumer of video frames as IOSurface-backed pixel buffers, rather than as bytes.
+ Bitmap streams deliver frames to members of this protocol without copying or locking pixels, so that they can be sampled directly by the GPU.
+ The consumer may retain the pixel buffer beyond the call, but should release it promptly so that the capture pool can recycle the surface.
+ */
+@protocol FBVideoSurfaceConsumer <FBDataConsumer>
+
+/**
+ Consumes a frame.
+
+ @param pixelBuffer the IOSurface-backed pixel buffer of the frame.
+ @param presentationTimeStamp the presentation time of the frame.
+ */
+- (void)consumePixelBuffer:(CVPixelBufferRef)pixelBuffer presentationTimeStamp:(CMTime)presentationTimeStamp;
+
+@end
+
+/**
+ A consumer of encoded video frames as sample buffers, rather than as Annex-B bytes.
+ Encoded streams deliver the output of the encoder to members of this protocol unchanged, so that they can be muxed into a container without re-encoding.
+ Frames are gated like bytes: no dependent frames are delivered until the first key frame, nor after a dropped frame until the next key frame.
+ */
+@protocol FBVideoSampleConsumer <FBDataConsumer>
+
+/**
+ Consumes an encoded frame.
+ The sample buffer is only valid for the duration of the call, the consumer must retain it to use it afterwards.
+
+ @param sampleBuffer the encoded sample buffer, with the format description of the stream attached.
+ */
+- (void)consumeSampleBuffer:(CMSampleBufferRef)sampleBuffer;
+
+@end
+
+/**
+ A block that receives a frame as a Mach port for its IOSurface.
+ The block owns the send right of the port and must deallocate it after it has been sent.
+ The done block must be called once the receiver has finished with the surface, until then the surface will not be recycled.
+ */
+typedef void (^FBVideoSurfaceMachPortHandler)(mach_port_t surfacePort, IOSurfaceID surfaceID, CMTime presentationTimeStamp, dispatch_block_t done);
+
+/**
+ Surface consumers for consumption in the same process and in other processes.
+ */
+@interface FBVideoSurfaceConsumer : NSObject
+
+/**
+ A consumer that delivers pixel buffers to a block, on the provided queue.
+ The pixel buffer is retained until the block returns.
+
+ @param queue the queue to deliver on.
+ @param handler the block to deliver pixel buffers to.
+ @return a new consumer.
+ */
++ (id<FBVideoSurfaceConsumer, FBDataConsumerLifecycle>)consumerOnQueue:(dispatch_queue_t)queue handler:(void (^)(CVPixelBufferRef pixelBuffer, CMTime presentationTimeStamp))handler;
+
+/**
+ A consumer that vends a Mach port for each frame's IOSurface, for sending over XPC or Mach messages to another process.
+ The receiving process obtains the surface with IOSurfaceLookupFromMachPort.
+
+ @param queue the queue to deliver on.
+ @param handler the block to deliver ports to.
+ @return a new consumer.
+ */
++ (id<FBVideoSurfaceConsumer, FBDataConsumerLifecycle>)machPortConsumerOnQueue:(dispatch_queue_t)queue handler:(FBVideoSurfaceMachPortHandler)handler;
+
+@end
+
+NS_ASSUME_NONNULL_END
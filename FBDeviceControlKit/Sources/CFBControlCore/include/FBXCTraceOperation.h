@@ -20,6 +20,21 @@ NS_ASSUME_NONNULL_BEGIN
 @protocol FBControlCoreLogger;
 @protocol FBiOSTarget;
 
+/**
+ Consumes the rows of an `xctrace export` as they are parsed.
+ */
+@protocol FBXCTraceRowConsumer <NSObject>
+
+/**
+ Consumes a single row of a table, on the parsing queue of the export.
+ Values that xctrace references from earlier rows are resolved, so each row is complete in itself.
+
+ @param row the formatted values of the row, keyed by the mnemonic of their column. Columns without a value are absent.
+ @param schema the name of the schema of the table that the row belongs to.
+ */
+- (void)consumeRow:(NSDictionary<NSString *, NSString *> *)row schema:(NSString *)schema;
+
+@end
 
 /**
  Represents an `xctrace record` operation.
@@ -77,6 +92,30 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (FBFuture<NSURL *> *)stopWithTimeout:(NSTimeInterval)timeout;
 
+/**
+ Stops the Operation, then streams the rows matching the queries from the trace to a consumer.
+ xctrace only makes a trace readable once recording has finished, so the export starts as soon as the trace has been written out.
+
+ @param timeout backoff timeout to stop the operation
+ @param xpathQueries the XPath queries of the tables to export, as accepted by `xctrace export --xpath`.
+ @param consumer the consumer of the rows.
+ @return a Future that resolves with the number of rows exported.
+ */
+- (FBFuture<NSNumber *> *)stopWithTimeout:(NSTimeInterval)timeout exportingQueries:(NSArray<NSString *> *)xpathQueries toConsumer:(id<FBXCTraceRowConsumer>)consumer;
+
+/**
+ Streams the rows matching the queries from a .trace file to a consumer.
+ All queries are answered by a single `xctrace export`, so the trace is only opened once. Rows are parsed from the output of xctrace as it is written, rather than once the whole export has been written out.
+
+ @param traceFile the trace file to export from.
+ @param xpathQueries the XPath queries of the tables to export, as accepted by `xctrace export --xpath`.
+ @param consumer the consumer of the rows.
+ @param queue the queue to serialize on.
+ @param logger the logger to log to.
+ @return a Future that resolves with the number of rows exported.
+ */
++ (FBFuture<NSNumber *> *)exportTrace:(NSURL *)traceFile xpathQueries:(NSArray<NSString *> *)xpathQueries toConsumer:(id<FBXCTraceRowConsumer>)consumer queue:(dispatch_queue_t)queue logger:(nullable id<FBControlCoreLogger>)logger;
+
 /**
  Post-process a .trace file.
 
@@ -14,6 +14,7 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  XCode constants.
  These values can be accessed before the Private Frameworks are loaded.
+ They are resolved once per process and reused until the xcode-select link or the selected Xcode's Info.plists change, which is observed with FSEvents.
  */
 @interface FBXcodeConfiguration : NSObject
 
@@ -310,6 +310,31 @@ extern FBOSVersionName const FBOSVersionNamemac;
  */
 @interface FBiOSTargetConfiguration : NSObject
 
+/**
+ Finds the Device Type for a 'ProductType', such as "iPhone18,3".
+ The lookup is a binary search of a static table. Only the matching Device Type is created.
+
+ @param productType the product type of the device.
+ @return the Device Type, or nil if the product type is not known.
+ */
++ (nullable FBDeviceType *)deviceTypeForProductType:(NSString *)productType;
+
+/**
+ Finds the Device Type for a Device Name.
+
+ @param model the name of the device model.
+ @return the Device Type, or nil if the model is not known.
+ */
++ (nullable FBDeviceType *)deviceTypeForModel:(FBDeviceModel)model;
+
+/**
+ Finds the OS Version for an OS Version name.
+
+ @param name the name of the OS Version.
+ @return the OS Version, or nil if the name is not known.
+ */
++ (nullable FBOSVersion *)OSVersionForName:(FBOSVersionName)name;
+
 /**
  Maps Device Names to Devices.
  */
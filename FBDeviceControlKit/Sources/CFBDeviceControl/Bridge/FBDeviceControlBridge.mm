@@ -27,6 +27,7 @@
     // FBDeviceControl
     #import "FBDeviceSet.h"
     #import "FBDevice.h"
+    #import "FBDevice+Private.h"
     #import "FBAMDevice.h"
     #import "FBDeviceControlError.h"
 
@@ -69,13 +70,27 @@ NSString *const kFBDeviceEventStateChanged = @"stateChanged";
 @interface FBDeviceControlBridge () <FBiOSTargetSetDelegate>
 @property (nonatomic, strong) FBDeviceSet *deviceSet;
 @property (nonatomic, copy) FBDeviceChangeCallback changeCallback;
+@property (nonatomic, copy) FBDeviceDiffCallback diffCallback;
 @property (nonatomic, strong) dispatch_queue_t workQueue;
+/// 按 UDID 缓存的设备信息字典，设备发生变化时只失效对应的 UDID
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSDictionary *> *infoCache;
+/// 最近一次通过差量回调交付的设备信息，用于计算下一次差量，只在 workQueue 上访问
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSDictionary *> *deliveredInfos;
+/// 合并窗口内发生变化的设备 UDID，只在 workQueue 上访问
+@property (nonatomic, strong) NSMutableOrderedSet<NSString *> *pendingUDIDs;
+/// 是否已安排合并窗口结束时的交付，只在 workQueue 上访问
+@property (nonatomic, assign) BOOL flushScheduled;
+/// 初始化完成前处于进入状态
+@property (nonatomic, strong) dispatch_group_t readyGroup;
+/// 设备接入时的主机时间（秒），设备移除时清除，通过 @synchronized 访问
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *attachTimes;
 @end
 
 #else
 
 @interface FBDeviceControlBridge ()
 @property (nonatomic, copy) FBDeviceChangeCallback changeCallback;
+@property (nonatomic, copy) FBDeviceDiffCallback diffCallback;
 @end
 
 #endif
@@ -104,31 +119,69 @@ NSString *const kFBDeviceEventStateChanged = @"stateChanged";
 }
 
 - (void)setup {
+    _deliveryQueue = dispatch_get_main_queue();
+    _coalescingInterval = 0.075;
 #if FB_DEVICE_CONTROL_AVAILABLE
     _workQueue = dispatch_queue_create("com.fbdevicecontrolkit.bridge", DISPATCH_QUEUE_SERIAL);
+    _infoCache = [NSMutableDictionary dictionary];
+    _deliveredInfos = [NSMutableDictionary dictionary];
+    _pendingUDIDs = [NSMutableOrderedSet orderedSet];
+    _attachTimes = [NSMutableDictionary dictionary];
+    _readyGroup = dispatch_group_create();
     
+    // 加载 MobileDevice 并订阅设备通知需要数百毫秒，在 workQueue 上异步完成，不阻塞调用线程
+    // workQueue 是串行队列，之后提交的观察与交付都排在初始化之后
+    dispatch_group_enter(_readyGroup);
+    dispatch_async(_workQueue, ^{
+        [self createDeviceSet];
+        dispatch_group_leave(self.readyGroup);
+    });
+#else
+    _isAvailable = NO;
+    _initializationError = @"FBDeviceControl framework not compiled. FB_DEVICE_CONTROL_SOURCES_COMPILED is not defined.";
+    _isReady = YES;
+    NSLog(@"[FBDeviceControlBridge] FBDeviceControl 不可用");
+#endif
+}
+
+#if FB_DEVICE_CONTROL_AVAILABLE
+
+/// 创建 FBDeviceSet，需在 workQueue 上调用
+/// 首次访问 FBDeviceSet 时加载 MobileDevice，之后开始监听设备连接
+- (void)createDeviceSet {
     // 创建系统日志器
     id<FBControlCoreLogger> logger = [FBControlCoreLoggerFactory systemLoggerWritingToStderr:NO withDebugLogging:NO];
     
     NSError *error = nil;
-    _deviceSet = [FBDeviceSet setWithLogger:logger
-                                   delegate:self
-                                 ecidFilter:nil
-                                      error:&error];
+    FBDeviceSet *deviceSet = [FBDeviceSet setWithLogger:logger
+                                               delegate:self
+                                             ecidFilter:nil
+                                                  error:&error];
     
-    if (_deviceSet == nil) {
-        _isAvailable = NO;
+    if (deviceSet == nil) {
         _initializationError = error.localizedDescription ?: @"Failed to initialize FBDeviceSet";
+        _isAvailable = NO;
         NSLog(@"[FBDeviceControlBridge] 初始化失败: %@", _initializationError);
     } else {
-        _isAvailable = YES;
+        self.deviceSet = deviceSet;
         _initializationError = nil;
-        NSLog(@"[FBDeviceControlBridge] 初始化成功，当前设备数: %lu", (unsigned long)_deviceSet.allDevices.count);
+        _isAvailable = YES;
+        NSLog(@"[FBDeviceControlBridge] 初始化成功，当前设备数: %lu", (unsigned long)deviceSet.allDevices.count);
     }
+    _isReady = YES;
+}
+
+#endif
+
+- (void)whenReady:(void (^)(BOOL available))completion {
+#if FB_DEVICE_CONTROL_AVAILABLE
+    dispatch_group_notify(self.readyGroup, self.deliveryQueue, ^{
+        completion(self.isAvailable);
+    });
 #else
-    _isAvailable = NO;
-    _initializationError = @"FBDeviceControl framework not compiled. FB_DEVICE_CONTROL_SOURCES_COMPILED is not defined.";
-    NSLog(@"[FBDeviceControlBridge] FBDeviceControl 不可用");
+    dispatch_async(self.deliveryQueue, ^{
+        completion(NO);
+    });
 #endif
 }
 
@@ -142,7 +195,7 @@ NSString *const kFBDeviceEventStateChanged = @"stateChanged";
     
     NSMutableArray<NSDictionary *> *result = [NSMutableArray array];
     for (FBDevice *device in _deviceSet.allDevices) {
-        NSDictionary *info = [self deviceInfoDictionary:device];
+        NSDictionary *info = [self cachedDeviceInfoDictionary:device];
         if (info) {
             [result addObject:info];
         }
@@ -164,12 +217,25 @@ NSString *const kFBDeviceEventStateChanged = @"stateChanged";
         return nil;
     }
     
-    return [self deviceInfoDictionary:device];
+    return [self cachedDeviceInfoDictionary:device];
 #else
     return nil;
 #endif
 }
 
+- (NSTimeInterval)attachTimeForUDID:(NSString *)udid {
+#if FB_DEVICE_CONTROL_AVAILABLE
+    if (udid == nil) {
+        return 0;
+    }
+    @synchronized (self.attachTimes) {
+        return self.attachTimes[udid].doubleValue;
+    }
+#else
+    return 0;
+#endif
+}
+
 #pragma mark - 设备观察
 
 - (void)startObservingWithCallback:(FBDeviceChangeCallback)callback {
@@ -181,10 +247,13 @@ NSString *const kFBDeviceEventStateChanged = @"stateChanged";
     // 在 targetDidUpdate: 中会调用 callback
     NSLog(@"[FBDeviceControlBridge] 开始观察设备变化");
     
-    // 立即回调当前设备列表
+    // 立即回调当前设备列表，列表在 workQueue 上构建
     if (callback) {
-        dispatch_async(dispatch_get_main_queue(), ^{
-            callback([self listDevices]);
+        dispatch_async(_workQueue, ^{
+            NSArray<NSDictionary *> *devices = [self listDevices];
+            dispatch_async(self.deliveryQueue, ^{
+                callback(devices);
+            });
         });
     }
 #else
@@ -192,8 +261,32 @@ NSString *const kFBDeviceEventStateChanged = @"stateChanged";
 #endif
 }
 
+- (void)startObservingChangesWithCallback:(FBDeviceDiffCallback)callback {
+    self.diffCallback = callback;
+    _isObserving = YES;
+    
+#if FB_DEVICE_CONTROL_AVAILABLE
+    NSLog(@"[FBDeviceControlBridge] 开始以差量方式观察设备变化");
+    
+    // 首次回调以当前所有设备作为新增
+    dispatch_async(_workQueue, ^{
+        [self.deliveredInfos removeAllObjects];
+        NSMutableArray<NSString *> *udids = [NSMutableArray array];
+        for (FBDevice *device in self.deviceSet.allDevices) {
+            if (device.udid) {
+                [udids addObject:device.udid];
+            }
+        }
+        [self deliverDiffForUDIDs:udids];
+    });
+#else
+    NSLog(@"[FBDeviceControlBridge] FBDeviceControl 不可用，无法观察设备变化");
+#endif
+}
+
 - (void)stopObserving {
     self.changeCallback = nil;
+    self.diffCallback = nil;
     _isObserving = NO;
     NSLog(@"[FBDeviceControlBridge] 停止观察设备变化");
 }
@@ -201,6 +294,12 @@ NSString *const kFBDeviceEventStateChanged = @"stateChanged";
 #pragma mark - 刷新
 
 - (NSArray<NSDictionary *> *)refresh {
+#if FB_DEVICE_CONTROL_AVAILABLE
+    // 手动刷新时丢弃缓存，重新读取所有设备的信息
+    @synchronized (self.infoCache) {
+        [self.infoCache removeAllObjects];
+    }
+#endif
     return [self listDevices];
 }
 
@@ -210,33 +309,133 @@ NSString *const kFBDeviceEventStateChanged = @"stateChanged";
 
 - (void)targetAdded:(id<FBiOSTargetInfo>)targetInfo inTargetSet:(id<FBiOSTargetSet>)targetSet {
     NSLog(@"[FBDeviceControlBridge] 设备已添加: %@", targetInfo.udid);
-    [self notifyDeviceChange];
+    if (targetInfo.udid) {
+        // CLOCK_UPTIME_RAW 与 mach_absolute_time 同源，即 CACurrentMediaTime 的时基
+        NSTimeInterval attachTime = (NSTimeInterval)clock_gettime_nsec_np(CLOCK_UPTIME_RAW) / NSEC_PER_SEC;
+        @synchronized (self.attachTimes) {
+            self.attachTimes[targetInfo.udid] = @(attachTime);
+        }
+    }
+    [self notifyDeviceChange:targetInfo.udid];
 }
 
 - (void)targetRemoved:(id<FBiOSTargetInfo>)targetInfo inTargetSet:(id<FBiOSTargetSet>)targetSet {
     NSLog(@"[FBDeviceControlBridge] 设备已移除: %@", targetInfo.udid);
-    [self notifyDeviceChange];
+    if (targetInfo.udid) {
+        @synchronized (self.attachTimes) {
+            [self.attachTimes removeObjectForKey:targetInfo.udid];
+        }
+    }
+    [self notifyDeviceChange:targetInfo.udid];
 }
 
 - (void)targetUpdated:(id<FBiOSTargetInfo>)targetInfo inTargetSet:(id<FBiOSTargetSet>)targetSet {
     NSLog(@"[FBDeviceControlBridge] 设备状态更新: %@", targetInfo.udid);
-    [self notifyDeviceChange];
+    [self notifyDeviceChange:targetInfo.udid];
 }
 
-- (void)notifyDeviceChange {
-    if (self.changeCallback) {
-        dispatch_async(dispatch_get_main_queue(), ^{
-            self.changeCallback([self listDevices]);
+- (void)notifyDeviceChange:(NSString *)udid {
+    // 只失效发生变化的设备，其余设备继续使用缓存的信息字典
+    if (udid) {
+        @synchronized (self.infoCache) {
+            [self.infoCache removeObjectForKey:udid];
+        }
+    }
+    
+    // USB Hub 重连时会短时间内产生大量事件，合并窗口内的事件只交付一次
+    dispatch_async(self.workQueue, ^{
+        if (udid) {
+            [self.pendingUDIDs addObject:udid];
+        }
+        if (self.flushScheduled) {
+            return;
+        }
+        self.flushScheduled = YES;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.coalescingInterval * NSEC_PER_SEC)), self.workQueue, ^{
+            [self flushPendingChanges];
         });
+    });
+}
+
+/// 合并窗口结束，在 workQueue 上构建快照和差量，只把结果交付到 deliveryQueue
+- (void)flushPendingChanges {
+    self.flushScheduled = NO;
+    NSArray<NSString *> *udids = self.pendingUDIDs.array;
+    [self.pendingUDIDs removeAllObjects];
+    
+    FBDeviceChangeCallback changeCallback = self.changeCallback;
+    if (changeCallback) {
+        NSArray<NSDictionary *> *devices = [self listDevices];
+        dispatch_async(self.deliveryQueue, ^{
+            changeCallback(devices);
+        });
+    }
+    
+    if (udids.count > 0) {
+        [self deliverDiffForUDIDs:udids];
     }
 }
 
+/// 对比上次交付的信息，计算指定设备的差量并在 deliveryQueue 上回调，需在 workQueue 上调用
+- (void)deliverDiffForUDIDs:(NSArray<NSString *> *)udids {
+    FBDeviceDiffCallback callback = self.diffCallback;
+    if (callback == nil) {
+        return;
+    }
+    
+    NSMutableArray<NSDictionary *> *added = [NSMutableArray array];
+    NSMutableArray<NSString *> *removed = [NSMutableArray array];
+    NSMutableArray<NSDictionary *> *updated = [NSMutableArray array];
+    for (NSString *udid in udids) {
+        FBDevice *device = [self.deviceSet deviceWithUDID:udid];
+        NSDictionary *info = device ? [self cachedDeviceInfoDictionary:device] : nil;
+        NSDictionary *previous = self.deliveredInfos[udid];
+        if (info && previous == nil) {
+            [added addObject:info];
+        } else if (info == nil && previous) {
+            [removed addObject:udid];
+        } else if (info && ![info isEqualToDictionary:previous]) {
+            [updated addObject:info];
+        }
+        self.deliveredInfos[udid] = info;
+    }
+    
+    // 信息未发生变化的事件（如 lockdown 短暂抖动）不回调
+    if (added.count == 0 && removed.count == 0 && updated.count == 0) {
+        return;
+    }
+    dispatch_async(self.deliveryQueue, ^{
+        callback([added copy], [removed copy], [updated copy]);
+    });
+}
+
 #endif
 
 #pragma mark - 私有方法
 
 #if FB_DEVICE_CONTROL_AVAILABLE
 
+/// 获取设备信息字典，优先使用缓存
+- (NSDictionary *)cachedDeviceInfoDictionary:(FBDevice *)device {
+    NSString *udid = device.udid;
+    if (udid == nil) {
+        return [self deviceInfoDictionary:device];
+    }
+    @synchronized (self.infoCache) {
+        NSDictionary *cached = self.infoCache[udid];
+        if (cached) {
+            return cached;
+        }
+    }
+    NSDictionary *info = [self deviceInfoDictionary:device];
+    if (info) {
+        @synchronized (self.infoCache) {
+            self.infoCache[udid] = info;
+        }
+    }
+    return info;
+}
+
 - (NSDictionary *)deviceInfoDictionary:(FBDevice *)device {
     if (device == nil) {
         return nil;
@@ -327,7 +526,8 @@ NSString *const kFBDeviceEventStateChanged = @"stateChanged";
     
     // 状态信息
     info[kFBDeviceInfoRawState] = @(device.state);
-    info[kFBDeviceInfoConnectionType] = @"USB"; // TODO: 从 extendedInfo 判断连接类型
+    // 同时通过 USB 和网络可达的设备按连接策略选择接口，拔掉 USB 后切换到网络时以更新差量交付
+    info[kFBDeviceInfoConnectionType] = device.amDevice.interfaceType == FBAMDeviceInterfaceNetwork ? @"WiFi" : @"USB";
     
     return [info copy];
 }
@@ -14,58 +14,122 @@
 #import "FBDevice.h"
 #import "FBDeviceControlError.h"
 #import "FBDeviceDebuggerCommands.h"
+#import "FBDeviceProcessSnapshot.h"
+#import "FBDeviceWorkflowStatistics.h"
 #import "FBInstrumentsClient.h"
 // FBDeviceControl-Swift.h excluded - FBAppleDevicectlCommandExecutor not available
 
-@interface FBDeviceWorkflowStatistics : NSObject
+static NSString *const InstallRecordKeyManifest = @"manifest";
+static NSString *const InstallRecordKeyInstalledPath = @"installed_path";
 
-@property (nonatomic, copy, readonly) NSString *workflowType;
-@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
-@property (nonatomic, copy, nullable, readwrite) NSDictionary<NSString *, id> *lastEvent;
+static void WorkflowCallback(NSDictionary<NSString *, id> *callbackDictionary, FBDeviceWorkflowStatistics *statistics)
+{
+  [statistics pushProgress:callbackDictionary];
+}
+
+// installation_proxy posts these through notification_proxy whenever an app is installed or uninstalled, by anyone.
+static NSString *const ApplicationInstalledNotification = @"com.apple.mobile.application_installed";
+static NSString *const ApplicationUninstalledNotification = @"com.apple.mobile.application_uninstalled";
+
+// Notifications that arrive this soon after an install or uninstall of our own are caused by it, the index has already been updated from its result.
+static const NSTimeInterval OwnChangeNotificationGrace = 2.0;
+
+/**
+ The attributes of the installed applications on a device, keyed by bundle ID and by bundle name.
+ Filled from a single full lookup and then kept up to date with each change, rather than looked up on each query.
+ */
+@interface FBDeviceApplicationCommands_Index : NSObject
+
+@property (nonatomic, copy, nullable, readonly) NSDictionary<NSString *, NSDictionary<NSString *, id> *> *applications;
+@property (nonatomic, assign, readonly) NSUInteger generation;
+@property (nonatomic, strong, nullable, readwrite) FBFuture<NSDictionary<NSString *, NSDictionary<NSString *, id> *> *> *pendingFetch;
+@property (nonatomic, strong, nullable, readwrite) NSDate *ignoreNotificationsUntil;
+@property (nonatomic, assign, readwrite) BOOL observingNotifications;
 
 @end
 
-@implementation FBDeviceWorkflowStatistics
+@implementation FBDeviceApplicationCommands_Index
+{
+  NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> *_applicationsByBundleID;
+  NSMutableDictionary<NSString *, NSString *> *_bundleIDsByBundleName;
+}
 
-- (instancetype)initWithWorkflowType:(NSString *)workflowType logger:(id<FBControlCoreLogger>)logger
+- (nullable NSDictionary<NSString *, NSDictionary<NSString *, id> *> *)applications
 {
-  self = [super init];
-  if (!self) {
-    return nil;
+  @synchronized (self) {
+    return [_applicationsByBundleID copy];
   }
-
-  _workflowType = workflowType;
-  _logger = logger;
-
-  return self;
 }
 
-- (void)pushProgress:(NSDictionary<NSString *, id> *)event
+- (nullable NSString *)bundleIDForBundleName:(NSString *)bundleName
 {
-  [self.logger logFormat:@"%@ Progress: %@", self.workflowType, [FBCollectionInformation oneLineDescriptionFromDictionary:event]];
-  self.lastEvent = event;
+  @synchronized (self) {
+    return _bundleIDsByBundleName[bundleName];
+  }
 }
 
-- (NSString *)summaryOfRecentEvents
+- (void)replaceApplications:(NSDictionary<NSString *, NSDictionary<NSString *, id> *> *)applications ifGeneration:(NSUInteger)generation
 {
-  NSDictionary<NSString *, id> *lastEvent = self.lastEvent;
-  if (!lastEvent) {
-    return [NSString stringWithFormat:@"No events from %@", self.lastEvent];
+  @synchronized (self) {
+    // A change that was notified whilst the lookup was in flight may not be part of it.
+    if (generation != _generation) {
+      return;
+    }
+    _applicationsByBundleID = [applications mutableCopy];
+    _bundleIDsByBundleName = NSMutableDictionary.dictionary;
+    for (NSString *bundleID in applications) {
+      NSString *bundleName = applications[bundleID][FBApplicationInstallInfoKeyBundleName];
+      if (bundleName) {
+        _bundleIDsByBundleName[bundleName] = bundleID;
+      }
+    }
   }
-  return [NSString stringWithFormat:@"Last event %@", [FBCollectionInformation oneLineDescriptionFromDictionary:lastEvent]];
 }
 
-@end
+- (void)updateApplicationWithBundleID:(NSString *)bundleID attributes:(nullable NSDictionary<NSString *, id> *)attributes
+{
+  @synchronized (self) {
+    self.ignoreNotificationsUntil = [NSDate dateWithTimeIntervalSinceNow:OwnChangeNotificationGrace];
+    if (!_applicationsByBundleID) {
+      return;
+    }
+    NSString *previousName = _applicationsByBundleID[bundleID][FBApplicationInstallInfoKeyBundleName];
+    if (previousName && [_bundleIDsByBundleName[previousName] isEqualToString:bundleID]) {
+      [_bundleIDsByBundleName removeObjectForKey:previousName];
+    }
+    _applicationsByBundleID[bundleID] = attributes;
+    NSString *bundleName = attributes[FBApplicationInstallInfoKeyBundleName];
+    if (bundleName) {
+      _bundleIDsByBundleName[bundleName] = bundleID;
+    }
+  }
+}
 
-static void WorkflowCallback(NSDictionary<NSString *, id> *callbackDictionary, FBDeviceWorkflowStatistics *statistics)
+- (BOOL)invalidateForNotification
 {
-  [statistics pushProgress:callbackDictionary];
+  @synchronized (self) {
+    if (self.ignoreNotificationsUntil.timeIntervalSinceNow > 0) {
+      return NO;
+    }
+    _generation++;
+    _applicationsByBundleID = nil;
+    _bundleIDsByBundleName = nil;
+    return YES;
+  }
 }
 
+@end
+
 @interface FBDeviceApplicationCommands ()
 
 @property (nonatomic, weak, readonly) FBDevice *device;
 @property (nonatomic, copy, readonly) NSURL *deltaUpdateDirectory;
+@property (nonatomic, strong, nullable, readwrite) FBDeviceWorkflowStatistics *lastInstallStatistics;
+@property (nonatomic, strong, readonly) FBDeviceApplicationCommands_Index *index;
+@property (nonatomic, strong, readonly) dispatch_queue_t processListQueue;
+@property (nonatomic, strong, nullable, readwrite) FBFuture<FBAMDServiceConnection *> *processListConnection;
+@property (nonatomic, strong, nullable, readwrite) FBMutableFuture<NSNull *> *processListTeardown;
+@property (nonatomic, strong, nullable, readwrite) FBDeviceProcessSnapshot *lastProcessSnapshot;
 
 - (FBFuture<NSNull *> *)killApplicationWithProcessIdentifier:(pid_t)processIdentifier;
 
@@ -122,7 +186,9 @@ static void WorkflowCallback(NSDictionary<NSString *, id> *callbackDictionary, F
 
 + (instancetype)commandsWithTarget:(FBDevice *)target
 {
-  NSURL *deltaUpdateDirectory = [target.temporaryDirectory temporaryDirectory];
+  // The delta directory outlives the process, so that the next install of the same bundle only transfers what has changed.
+  NSString *deltaUpdatePath = [[target.auxillaryDirectory stringByAppendingPathComponent:@"delta_install"] stringByAppendingPathComponent:target.udid];
+  NSURL *deltaUpdateDirectory = [NSURL fileURLWithPath:deltaUpdatePath isDirectory:YES];
   return [[self alloc] initWithDevice:target deltaUpdateDirectory:deltaUpdateDirectory];
 }
 
@@ -135,13 +201,25 @@ static void WorkflowCallback(NSDictionary<NSString *, id> *callbackDictionary, F
 
   _device = device;
   _deltaUpdateDirectory = deltaUpdateDirectory;
-  
+  _index = [[FBDeviceApplicationCommands_Index alloc] init];
+  _processListQueue = dispatch_queue_create("com.facebook.fbdevicecontrol.process_list", DISPATCH_QUEUE_SERIAL);
+
   return self;
 }
 
+- (void)dealloc
+{
+  [_processListTeardown resolveWithResult:NSNull.null];
+}
+
 #pragma mark FBApplicationCommands Implementation
 
 - (FBFuture<FBInstalledApplication *> *)installApplicationWithPath:(NSString *)path
+{
+  return [self installApplicationWithPath:path incremental:NO];
+}
+
+- (FBFuture<FBInstalledApplication *> *)installApplicationWithPath:(NSString *)path incremental:(BOOL)incremental
 {
   // We need to get the bundle identifier of the installed application, in order that we can get install info later.
   NSError *error = nil;
@@ -149,47 +227,54 @@ static void WorkflowCallback(NSDictionary<NSString *, id> *callbackDictionary, F
   if (!bundle) {
     return [FBFuture futureWithError:error];
   }
+  if (!incremental) {
+    return [[self
+      installBundle:bundle]
+      onQueue:self.device.asyncQueue fmap:^(id _) {
+        return [self refreshedInstalledApplicationWithBundleID:bundle.identifier];
+      }];
+  }
 
-  // Construct the options for the underlying install API. This mirrors as much of Xcode's call to the same API as is reasonable.
-  // `@"PreferWifi": @1` may also be passed by Xcode. However, this being preferable is highly dependent on a fast WiFi network and both host/device on the same network. Since this is harder to pick a sane default for this option, this is omitted from the options.
-  NSURL *appURL = [NSURL fileURLWithPath:path isDirectory:YES];
-  NSDictionary<NSString *, id> *options = @{
-    @"CFBundleIdentifier": bundle.identifier,  // Lets the installer know what the Bundle ID is of the passed in artifact.
-    @"CloseOnInvalidate": @1,  // Standard arguments of lockdown services to ensure that the socket is closed on teardown.
-    @"InvalidateOnDetach": @1,  // Similar to the above.
-    @"IsUserInitiated": @1, // Improves installation performance. This has a strong effect on time taken in "VerifyingApplication" stage of installation, which is CPU/IO bound on the attached device.
-    @"PackageType": @"Developer", // Signifies that the passed payload is a .app
-    @"ShadowParentKey": self.deltaUpdateDirectory, // Must be provided if 'Developer' is the 'PackageType'. Specifies where incremental install data and apps are persisted for faster future installs of the same bundle.
-  };
+  NSString *recordPath = [self installRecordPathForBundleID:bundle.identifier];
+  NSDictionary<NSString *, id> *record = [NSDictionary dictionaryWithContentsOfFile:recordPath];
+  FBBundleManifest *previousManifest = [record[InstallRecordKeyManifest] isKindOfClass:NSDictionary.class] ? [FBBundleManifest fromPropertyListRepresentation:record[InstallRecordKeyManifest]] : nil;
+  NSString *previousInstalledPath = record[InstallRecordKeyInstalledPath];
+  id<FBControlCoreLogger> logger = self.device.logger;
 
-  // Perform the install and lookup the app after.
-  return [[[self.device
-    connectToDeviceWithPurpose:@"install"]
-    onQueue:self.device.workQueue pop:^ FBFuture<NSNull *> * (id<FBDeviceCommands> device) {
-      [self.device.logger logFormat:@"Installing Application %@", appURL];
-      // 'AMDeviceSecureInstallApplicationBundle' performs:
-      // 1) The transfer of the application bundle to the device.
-      // 2) The installation of the application after the transfer.
-      // 3) The performing of the relevant delta updates in the directory pointed to by 'ShadowParentKey'
-      FBDeviceWorkflowStatistics *statistics = [[FBDeviceWorkflowStatistics alloc] initWithWorkflowType:@"Install" logger:device.logger];
-      int status = device.calls.SecureInstallApplicationBundle(
-        device.amDeviceRef,
-        (__bridge CFURLRef _Nonnull)(appURL),
-        (__bridge CFDictionaryRef _Nonnull)(options),
-        (AMDeviceProgressCallback) WorkflowCallback,
-        (__bridge void *) (statistics)
-      );
-      if (status != 0) {
-        NSString *errorMessage = CFBridgingRelease(device.calls.CopyErrorText(status));
-        return [[FBDeviceControlError
-          describeFormat:@"Failed to install application %@ 0x%x (%@). %@", appURL.lastPathComponent, status, errorMessage, statistics.summaryOfRecentEvents]
-          failFuture];
-      }
-      [self.device.logger logFormat:@"Installed Application %@", appURL];
-      return FBFuture.empty;
+  return [[FBFuture
+    onQueue:self.device.asyncQueue resolveValue:^ FBBundleManifest * (NSError **innerError) {
+      return [FBBundleManifest manifestForBundleAtPath:bundle.path previousManifest:previousManifest error:innerError];
     }]
-    onQueue:self.device.asyncQueue fmap:^(id _) {
-      return [self installedApplicationWithBundleID:bundle.identifier];
+    onQueue:self.device.asyncQueue fmap:^ FBFuture<FBInstalledApplication *> * (FBBundleManifest *manifest) {
+      NSArray<NSString *> *changedPaths = [manifest pathsChangedFromManifest:previousManifest];
+      [logger logFormat:@"%@ has %lu changed files since the last install on this device", manifest, (unsigned long) changedPaths.count];
+      FBFuture<FBInstalledApplication *> *(^install)(void) = ^{
+        return [[[self
+          installBundle:bundle]
+          onQueue:self.device.asyncQueue fmap:^(id _) {
+            return [self refreshedInstalledApplicationWithBundleID:bundle.identifier];
+          }]
+          onQueue:self.device.asyncQueue doOnResolved:^(FBInstalledApplication *installed) {
+            [self writeInstallRecordForManifest:manifest installedPath:installed.bundle.path toPath:recordPath];
+          }];
+      };
+      if (changedPaths.count > 0 || !previousInstalledPath) {
+        return install();
+      }
+      // The bundle is unchanged, so the install can be skipped if the app from the last install is still there.
+      // A re-install from elsewhere moves the app to a new path, so that is not mistaken for the last install.
+      return [[[self
+        installedApplicationWithBundleID:bundle.identifier]
+        onQueue:self.device.asyncQueue handleError:^(NSError *_) {
+          return [FBFuture futureWithResult:NSNull.null];
+        }]
+        onQueue:self.device.asyncQueue fmap:^ FBFuture<FBInstalledApplication *> * (id installed) {
+          if (![installed isKindOfClass:FBInstalledApplication.class] || ![[installed bundle].path isEqualToString:previousInstalledPath]) {
+            return install();
+          }
+          [logger logFormat:@"Skipping install of unchanged %@, already installed at %@", bundle.identifier, previousInstalledPath];
+          return [FBFuture futureWithResult:installed];
+        }];
     }];
 }
 
@@ -220,6 +305,7 @@ static void WorkflowCallback(NSDictionary<NSString *, id> *callbackDictionary, F
           failFuture];
       }
       [self.device.logger logFormat:@"Uninstalled Application %@", bundleID];
+      [self.index updateApplicationWithBundleID:bundleID attributes:nil];
       return FBFuture.empty;
     }];
 }
@@ -227,7 +313,7 @@ static void WorkflowCallback(NSDictionary<NSString *, id> *callbackDictionary, F
 - (FBFuture<NSArray<FBInstalledApplication *> *> *)installedApplications
 {
   return [[self
-    installedApplicationsData:FBDeviceApplicationCommands.installedApplicationLookupAttributes]
+    indexedApplications]
     onQueue:self.device.asyncQueue map:^(NSDictionary<NSString *, NSDictionary<NSString *, id> *> *applicationData) {
       NSMutableArray<FBInstalledApplication *> *installedApplications = [[NSMutableArray alloc] initWithCapacity:applicationData.count];
       NSEnumerator *objectEnumerator = [applicationData objectEnumerator];
@@ -245,12 +331,12 @@ static void WorkflowCallback(NSDictionary<NSString *, id> *callbackDictionary, F
 - (FBFuture<FBInstalledApplication *> *)installedApplicationWithBundleID:(NSString *)bundleID
 {
   return [[self
-    installedApplicationsData:FBDeviceApplicationCommands.installedApplicationLookupAttributes]
+    indexedApplications]
     onQueue:self.device.asyncQueue fmap:^FBFuture *(NSDictionary<NSString *, NSDictionary<NSString *, id> *> *applicationData) {
       NSDictionary<NSString *, id> *app = applicationData[bundleID];
       if (!app) {
         return [[FBDeviceControlError
-          describeFormat:@"Application with bundle ID: %@ is not installed. Installed apps %@ ", bundleID, [FBCollectionInformation oneLineDescriptionFromArray:applicationData.allKeys]]
+          describeFormat:@"Application with bundle ID: %@ is not installed. Installed apps %@ ", bundleID, [FBCollectionInformation lazyOneLineDescriptionFromArray:applicationData.allKeys]]
           failFuture];
       }
       FBInstalledApplication *application = [FBDeviceApplicationCommands installedApplicationFromDictionary:app];
@@ -260,40 +346,11 @@ static void WorkflowCallback(NSDictionary<NSString *, id> *callbackDictionary, F
 
 - (FBFuture<NSDictionary<NSString *, NSNumber *> *> *)runningApplications
 {
-  return [[FBFuture
-    futureWithFutures:@[
-      [self pidToRunningProcessName],
-      [self installedApplicationsData:FBDeviceApplicationCommands.namingLookupAttributes],
-    ]]
-    onQueue:self.device.asyncQueue map:^ NSDictionary<NSString *, NSNumber *> * (NSArray<id> *tuple) {
-      // Obtain the requested mappings.
-      NSDictionary<NSNumber *, NSString *> *pidToRunningProcessName = tuple[0];
-      NSDictionary<NSString *, id> *bundleIdentifierToAttributes = tuple[1];
-
-      // Flip the mappings
-      NSMutableDictionary<NSString *, NSString *> *bundleNameToBundleIdentifier = NSMutableDictionary.dictionary;
-      for (NSString *bundleIdentifier in bundleIdentifierToAttributes.allKeys) {
-        NSString *bundleName = bundleIdentifierToAttributes[bundleIdentifier][FBApplicationInstallInfoKeyBundleName];
-        bundleNameToBundleIdentifier[bundleName] = bundleIdentifier;
-      }
-      NSMutableDictionary<NSString *, NSNumber *> *runningProcessNameToPID = NSMutableDictionary.dictionary;
-      for (NSNumber *processIdentifier in pidToRunningProcessName.allKeys) {
-        NSString *processName = pidToRunningProcessName[processIdentifier];
-        runningProcessNameToPID[processName] = processIdentifier;
-      }
-
-      // Compare bundle names with PIDs by using the inverted mappings.
-      NSMutableDictionary<NSString *, NSNumber *> *bundleNameToPID = NSMutableDictionary.dictionary;
-      for (NSString *processName in runningProcessNameToPID.allKeys) {
-        NSString *bundleName = bundleNameToBundleIdentifier[processName];
-        if (!bundleName) {
-          continue;
-        }
-        NSNumber *pid = runningProcessNameToPID[processName];
-        bundleNameToPID[bundleName] = pid;
-      }
-      return bundleNameToPID;
-    }]; 
+  return [[self
+    runningProcessSnapshot]
+    onQueue:self.device.asyncQueue map:^(FBDeviceProcessSnapshot *snapshot) {
+      return snapshot.processIdentifiersByBundleID;
+    }];
 }
 
 - (FBFuture<NSNumber *> *)processIDWithBundleID:(NSString *)bundleID
@@ -340,8 +397,98 @@ static void WorkflowCallback(NSDictionary<NSString *, id> *callbackDictionary, F
     }
 }
 
+#pragma mark Public Methods
+
+- (FBFuture<FBDeviceProcessSnapshot *> *)runningProcessSnapshot
+{
+  return [[FBFuture
+    futureWithFutures:@[
+      [self processListPayload],
+      [self indexedApplications],
+    ]]
+    onQueue:self.processListQueue map:^(NSArray<id> *tuple) {
+      FBDeviceApplicationCommands_Index *index = self.index;
+      FBDeviceProcessSnapshot *snapshot = [FBDeviceProcessSnapshot
+        snapshotFromProcessList:tuple[0]
+        previous:self.lastProcessSnapshot
+        bundleIDResolver:^(NSString *processName) {
+          return [index bundleIDForBundleName:processName];
+        }];
+      self.lastProcessSnapshot = snapshot;
+      return snapshot;
+    }];
+}
+
 #pragma mark Private
 
+- (FBFuture<NSNull *> *)installBundle:(FBBundleDescriptor *)bundle
+{
+  // Construct the options for the underlying install API. This mirrors as much of Xcode's call to the same API as is reasonable.
+  // `@"PreferWifi": @1` may also be passed by Xcode. However, this being preferable is highly dependent on a fast WiFi network and both host/device on the same network. Since this is harder to pick a sane default for this option, this is omitted from the options.
+  NSURL *appURL = [NSURL fileURLWithPath:bundle.path isDirectory:YES];
+  NSDictionary<NSString *, id> *options = @{
+    @"CFBundleIdentifier": bundle.identifier,  // Lets the installer know what the Bundle ID is of the passed in artifact.
+    @"CloseOnInvalidate": @1,  // Standard arguments of lockdown services to ensure that the socket is closed on teardown.
+    @"InvalidateOnDetach": @1,  // Similar to the above.
+    @"IsUserInitiated": @1, // Improves installation performance. This has a strong effect on time taken in "VerifyingApplication" stage of installation, which is CPU/IO bound on the attached device.
+    @"PackageType": @"Developer", // Signifies that the passed payload is a .app
+    @"ShadowParentKey": self.deltaUpdateDirectory, // Must be provided if 'Developer' is the 'PackageType'. Specifies where incremental install data and apps are persisted for faster future installs of the same bundle.
+  };
+
+  // The install blocks for as long as the transfer and install take, so is not performed on the work queue.
+  // This means that installs on several devices can proceed at the same time.
+  return [[self.device
+    connectToDeviceWithPurpose:@"install"]
+    onQueue:self.device.asyncQueue pop:^ FBFuture<NSNull *> * (id<FBDeviceCommands> device) {
+      [self.device.logger logFormat:@"Installing Application %@", appURL];
+      [NSFileManager.defaultManager createDirectoryAtURL:self.deltaUpdateDirectory withIntermediateDirectories:YES attributes:nil error:nil];
+      // 'AMDeviceSecureInstallApplicationBundle' performs:
+      // 1) The transfer of the application bundle to the device.
+      // 2) The installation of the application after the transfer.
+      // 3) The performing of the relevant delta updates in the directory pointed to by 'ShadowParentKey'
+      FBDeviceWorkflowStatistics *statistics = [[FBDeviceWorkflowStatistics alloc] initWithWorkflowType:@"Install" logger:device.logger];
+      self.lastInstallStatistics = statistics;
+      int status = device.calls.SecureInstallApplicationBundle(
+        device.amDeviceRef,
+        (__bridge CFURLRef _Nonnull)(appURL),
+        (__bridge CFDictionaryRef _Nonnull)(options),
+        (AMDeviceProgressCallback) WorkflowCallback,
+        (__bridge void *) (statistics)
+      );
+      [statistics finish];
+      if (status != 0) {
+        NSString *errorMessage = CFBridgingRelease(device.calls.CopyErrorText(status));
+        return [[FBDeviceControlError
+          describeFormat:@"Failed to install application %@ 0x%x (%@). %@", appURL.lastPathComponent, status, errorMessage, statistics.summaryOfRecentEvents]
+          failFuture];
+      }
+      [self.device.logger logFormat:@"Installed Application %@", appURL];
+      return FBFuture.empty;
+    }];
+}
+
+- (NSString *)installRecordPathForBundleID:(NSString *)bundleID
+{
+  return [[self.deltaUpdateDirectory.path stringByAppendingPathComponent:@"manifests"] stringByAppendingPathComponent:[bundleID stringByAppendingPathExtension:@"plist"]];
+}
+
+- (void)writeInstallRecordForManifest:(FBBundleManifest *)manifest installedPath:(NSString *)installedPath toPath:(NSString *)recordPath
+{
+  NSError *error = nil;
+  NSData *data = [NSPropertyListSerialization
+    dataWithPropertyList:@{
+      InstallRecordKeyManifest: manifest.propertyListRepresentation,
+      InstallRecordKeyInstalledPath: installedPath,
+    }
+    format:NSPropertyListBinaryFormat_v1_0
+    options:0
+    error:&error];
+  [NSFileManager.defaultManager createDirectoryAtPath:recordPath.stringByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:nil];
+  if (!data || ![data writeToFile:recordPath options:NSDataWritingAtomic error:&error]) {
+    [self.device.logger logFormat:@"Failed to write install manifest to %@ %@", recordPath, error];
+  }
+}
+
 - (FBFuture<NSNull *> *)killApplicationWithProcessIdentifier:(pid_t)processIdentifier
 {
   return [[self
@@ -351,14 +498,105 @@ static void WorkflowCallback(NSDictionary<NSString *, id> *callbackDictionary, F
     }];
 }
 
-- (FBFuture<NSDictionary<NSString *, NSDictionary<NSString *, id> *> *> *)installedApplicationsData:(NSArray<NSString *> *)returnAttributes
+- (FBFuture<NSDictionary<NSString *, NSDictionary<NSString *, id> *> *> *)indexedApplications
+{
+  FBDeviceApplicationCommands_Index *index = self.index;
+  @synchronized (index) {
+    NSDictionary<NSString *, NSDictionary<NSString *, id> *> *applications = index.applications;
+    if (applications) {
+      return [FBFuture futureWithResult:applications];
+    }
+    // Concurrent queries whilst the index is being filled share the same lookup.
+    if (index.pendingFetch) {
+      return index.pendingFetch;
+    }
+    [self observeApplicationChangesIfNeeded];
+    NSUInteger generation = index.generation;
+    FBFuture<NSDictionary<NSString *, NSDictionary<NSString *, id> *> *> *fetch = [[self
+      installedApplicationsData:FBDeviceApplicationCommands.installedApplicationLookupAttributes bundleIDs:nil]
+      onQueue:self.device.asyncQueue chain:^(FBFuture<NSDictionary<NSString *, NSDictionary<NSString *, id> *> *> *future) {
+        @synchronized (index) {
+          index.pendingFetch = nil;
+          if (future.result) {
+            [index replaceApplications:future.result ifGeneration:generation];
+          }
+        }
+        return future;
+      }];
+    index.pendingFetch = fetch;
+    return fetch;
+  }
+}
+
+- (FBFuture<FBInstalledApplication *> *)refreshedInstalledApplicationWithBundleID:(NSString *)bundleID
+{
+  // Only the changed app is looked up, the rest of the index is unaffected by an install.
+  return [[self
+    installedApplicationsData:FBDeviceApplicationCommands.installedApplicationLookupAttributes bundleIDs:@[bundleID]]
+    onQueue:self.device.asyncQueue fmap:^ FBFuture<FBInstalledApplication *> * (NSDictionary<NSString *, NSDictionary<NSString *, id> *> *applicationData) {
+      NSDictionary<NSString *, id> *app = applicationData[bundleID];
+      [self.index updateApplicationWithBundleID:bundleID attributes:app];
+      if (!app) {
+        return [[FBDeviceControlError
+          describeFormat:@"Application with bundle ID: %@ is not installed after installing it", bundleID]
+          failFuture];
+      }
+      return [FBFuture futureWithResult:[FBDeviceApplicationCommands installedApplicationFromDictionary:app]];
+    }];
+}
+
+- (void)observeApplicationChangesIfNeeded
+{
+  FBDeviceApplicationCommands_Index *index = self.index;
+  if (index.observingNotifications) {
+    return;
+  }
+  index.observingNotifications = YES;
+  id<FBControlCoreLogger> logger = self.device.logger;
+  dispatch_queue_t readQueue = dispatch_queue_create("com.facebook.fbdevicecontrol.application_notifications", DISPATCH_QUEUE_SERIAL);
+  [[[self.device
+    startService:@"com.apple.mobile.notification_proxy"]
+    onQueue:readQueue pop:^ FBFuture<NSNull *> * (FBAMDServiceConnection *connection) {
+      NSError *error = nil;
+      for (NSString *name in @[ApplicationInstalledNotification, ApplicationUninstalledNotification]) {
+        if (![connection sendMessage:@{@"Command": @"ObserveNotification", @"Name": name} error:&error]) {
+          return [FBFuture futureWithError:error];
+        }
+      }
+      // The connection is read until it fails, which happens when the device goes away.
+      while (YES) {
+        NSDictionary<NSString *, id> *message = [connection receiveMessageWithError:&error];
+        if (![message isKindOfClass:NSDictionary.class]) {
+          return [FBFuture futureWithError:error ?: [[FBDeviceControlError describe:@"notification_proxy closed"] build]];
+        }
+        if (![message[@"Command"] isEqual:@"RelayNotification"]) {
+          continue;
+        }
+        if ([index invalidateForNotification]) {
+          [logger logFormat:@"%@, the installed application index will be refreshed", message[@"Name"]];
+        }
+      }
+    }]
+    onQueue:readQueue notifyOfCompletion:^(FBFuture *future) {
+      // Without notifications the index can't be trusted, so it is refreshed on the next query and observing is started again.
+      [logger logFormat:@"Stopped observing application changes %@", future.error];
+      @synchronized (index) {
+        index.observingNotifications = NO;
+        index.ignoreNotificationsUntil = nil;
+        [index invalidateForNotification];
+      }
+    }];
+}
+
+- (FBFuture<NSDictionary<NSString *, NSDictionary<NSString *, id> *> *> *)installedApplicationsData:(NSArray<NSString *> *)returnAttributes bundleIDs:(nullable NSArray<NSString *> *)bundleIDs
 {
   return [[self.device
     connectToDeviceWithPurpose:@"installed_apps"]
     onQueue:self.device.workQueue pop:^ FBFuture<NSDictionary<NSString *, NSDictionary<NSString *, id> *> *> * (id<FBDeviceCommands> device) {
-      NSDictionary<NSString *, id> *options = @{
+      NSMutableDictionary<NSString *, id> *options = [NSMutableDictionary dictionaryWithDictionary:@{
         @"ReturnAttributes": returnAttributes,
-      };
+      }];
+      options[@"BundleIDs"] = bundleIDs;
       CFDictionaryRef applications;
       int status = device.calls.LookupApplications(
         device.amDeviceRef,
@@ -390,50 +628,108 @@ static void WorkflowCallback(NSDictionary<NSString *, id> *callbackDictionary, F
     }];
 }
 
-- (FBFuture<NSDictionary<NSString *, NSNumber *> *> *)pidToRunningProcessName
+- (FBFuture<NSDictionary<id, NSDictionary<NSString *, id> *> *> *)processListPayload
 {
-  return [[self.device
-    startService:@"com.apple.os_trace_relay"]
-    onQueue:self.device.asyncQueue pop:^(FBAMDServiceConnection *connection) {
+  return [[self
+    persistentProcessListConnection]
+    onQueue:self.processListQueue fmap:^ FBFuture<NSDictionary<id, NSDictionary<NSString *, id> *> *> * (FBAMDServiceConnection *connection) {
       NSError *error = nil;
-      BOOL success = [connection sendMessage:@{@"Request": @"PidList"} error:&error];
-      if (!success) {
-        return [[FBDeviceControlError
-          describeFormat:@"Failed to request PidList %@", error]
-          failFuture];
-      }
-      NSData *data = [connection receive:1 error:&error];
-      if (!data) {
-        return [[FBDeviceControlError
-          describeFormat:@"Failed to receive 1 byte after PidList %@", error]
-          failFuture];
-      }
-      NSDictionary<NSString *, id> *response = [connection receiveMessageWithError:&error];
-      if (!response) {
-        return [[FBDeviceControlError
-          describeFormat:@"Failed to receive PidList response %@", error]
-          failFuture];
+      NSDictionary<id, NSDictionary<NSString *, id> *> *payload = [FBDeviceApplicationCommands requestProcessListOnConnection:connection error:&error];
+      if (payload) {
+        return [FBFuture futureWithResult:payload];
       }
-      NSString *status = response[@"Status"];
-      if (![status isEqualToString:@"RequestSuccessful"]) {
-        return [[FBDeviceControlError
-          describeFormat:@"Request to PidList is not RequestSuccessful %@", error]
-          failFuture];
-      }
-      NSDictionary<NSNumber *, id> *payload = response[@"Payload"];
-      NSMutableDictionary<NSNumber *, NSString *> *pidToRunningProcessName = NSMutableDictionary.dictionary;
-      for (NSNumber *processIdentifer in payload.keyEnumerator) {
-        NSDictionary<NSString *, NSString *> *contents = payload[processIdentifer];
-        NSString *processName = contents[@"ProcessName"];
-        if (![processName isKindOfClass:NSString.class]) {
-          continue;
-        }
-        pidToRunningProcessName[processIdentifer] = processName;
+      // Some versions of os_trace_relay close the connection after a request, so a failed request is retried once on a fresh connection.
+      [self.device.logger logFormat:@"PidList failed on the existing os_trace_relay connection, reconnecting %@", error];
+      [self closeProcessListConnection];
+      return [[self
+        persistentProcessListConnection]
+        onQueue:self.processListQueue fmap:^ FBFuture<NSDictionary<id, NSDictionary<NSString *, id> *> *> * (FBAMDServiceConnection *retryConnection) {
+          NSError *retryError = nil;
+          NSDictionary<id, NSDictionary<NSString *, id> *> *retryPayload = [FBDeviceApplicationCommands requestProcessListOnConnection:retryConnection error:&retryError];
+          if (!retryPayload) {
+            [self closeProcessListConnection];
+            return [FBFuture futureWithError:retryError];
+          }
+          return [FBFuture futureWithResult:retryPayload];
+        }];
+    }];
+}
+
+- (FBFuture<FBAMDServiceConnection *> *)persistentProcessListConnection
+{
+  dispatch_queue_t queue = self.processListQueue;
+  return [FBFuture
+    onQueue:queue resolve:^ FBFuture<FBAMDServiceConnection *> * {
+      // Requests made whilst connecting share the same connection.
+      if (self.processListConnection) {
+        return self.processListConnection;
       }
-      return [FBFuture futureWithResult:pidToRunningProcessName];
+      // The connection is held open by not resolving the teardown until the connection is closed.
+      FBMutableFuture<FBAMDServiceConnection *> *connected = FBMutableFuture.future;
+      FBMutableFuture<NSNull *> *teardown = FBMutableFuture.future;
+      [[[self.device
+        startService:@"com.apple.os_trace_relay"]
+        onQueue:queue pop:^(FBAMDServiceConnection *connection) {
+          [connected resolveWithResult:connection];
+          return teardown;
+        }]
+        onQueue:queue notifyOfCompletion:^(FBFuture *future) {
+          if (future.error) {
+            [connected resolveWithError:future.error];
+          }
+          if (self.processListTeardown == teardown) {
+            self.processListConnection = nil;
+            self.processListTeardown = nil;
+          }
+        }];
+      self.processListConnection = connected;
+      self.processListTeardown = teardown;
+      return connected;
     }];
 }
 
+- (void)closeProcessListConnection
+{
+  [self.processListTeardown resolveWithResult:NSNull.null];
+  self.processListTeardown = nil;
+  self.processListConnection = nil;
+}
+
++ (nullable NSDictionary<id, NSDictionary<NSString *, id> *> *)requestProcessListOnConnection:(FBAMDServiceConnection *)connection error:(NSError **)error
+{
+  NSError *innerError = nil;
+  if (![connection sendMessage:@{@"Request": @"PidList"} error:&innerError]) {
+    return [[FBDeviceControlError
+      describeFormat:@"Failed to request PidList %@", innerError]
+      fail:error];
+  }
+  NSData *data = [connection receive:1 error:&innerError];
+  if (!data) {
+    return [[FBDeviceControlError
+      describeFormat:@"Failed to receive 1 byte after PidList %@", innerError]
+      fail:error];
+  }
+  NSDictionary<NSString *, id> *response = [connection receiveMessageWithError:&innerError];
+  if (!response) {
+    return [[FBDeviceControlError
+      describeFormat:@"Failed to receive PidList response %@", innerError]
+      fail:error];
+  }
+  NSString *status = response[@"Status"];
+  if (![status isEqualToString:@"RequestSuccessful"]) {
+    return [[FBDeviceControlError
+      describeFormat:@"Request to PidList is not RequestSuccessful %@", response]
+      fail:error];
+  }
+  NSDictionary<id, NSDictionary<NSString *, id> *> *payload = response[@"Payload"];
+  if (![payload isKindOfClass:NSDictionary.class]) {
+    return [[FBDeviceControlError
+      describeFormat:@"PidList Payload is not a dictionary %@", response]
+      fail:error];
+  }
+  return payload;
+}
+
 + (FBInstalledApplication *)installedApplicationFromDictionary:(NSDictionary<NSString *, id> *)app
 {
   NSString *bundleName = app[FBApplicationInstallInfoKeyBundleName] ?: @"";
@@ -465,17 +761,4 @@ static void WorkflowCallback(NSDictionary<NSString *, id> *callbackDictionary, F
   return lookupAttributes;
 }
 
-+ (NSArray<NSString *> *)namingLookupAttributes
-{
-  static dispatch_once_t onceToken;
-  static NSArray<NSString *> *lookupAttributes = nil;
-  dispatch_once(&onceToken, ^{
-    lookupAttributes = @[
-      FBApplicationInstallInfoKeyBundleIdentifier,
-      FBApplicationInstallInfoKeyBundleName,
-    ];
-  });
-  return lookupAttributes;
-}
-
 @end
@@ -14,7 +14,9 @@ FBDeviceActivationState const FBDeviceActivationStateActivated = @"Activated";
 FBDeviceKey const FBDeviceKeyChipID = @"ChipID";
 FBDeviceKey const FBDeviceKeyDeviceClass = @"DeviceClass";
 FBDeviceKey const FBDeviceKeyDeviceName = @"DeviceName";
+FBDeviceKey const FBDeviceKeyHardwareModel = @"HardwareModel";
 FBDeviceKey const FBDeviceKeyLocationID = @"LocationID";
+FBDeviceKey const FBDeviceKeyModelNumber = @"ModelNumber";
 FBDeviceKey const FBDeviceKeyProductType = @"ProductType";
 FBDeviceKey const FBDeviceKeySerialNumber = @"SerialNumber";
 FBDeviceKey const FBDeviceKeyUniqueChipID = @"UniqueChipID";
@@ -15,6 +15,46 @@
 #import "FBDeviceControlError.h"
 #import "FBDeviceFileCommands.h"
 
+// The number of connections that crash logs are fetched over at once.
+static const NSUInteger CrashLogIngestionConcurrency = 4;
+// The amount of a crash log that is read to parse its header.
+static const uint64_t CrashLogHeaderLength = 1024 * 8;
+
+/**
+ A crash log that has been read from the device, either in its entirety or just its header.
+ */
+@interface FBDeviceCrashLogCommands_Fetched : NSObject
+
+@property (nonatomic, copy, readonly) NSString *name;
+@property (nonatomic, assign, readonly) uint64_t size;
+@property (nonatomic, strong, readonly) NSData *data;
+@property (nonatomic, assign, readonly) BOOL isComplete;
+
+@end
+
+@implementation FBDeviceCrashLogCommands_Fetched
+
+- (instancetype)initWithName:(NSString *)name size:(uint64_t)size data:(NSData *)data
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _name = name;
+  _size = size;
+  _data = data;
+
+  return self;
+}
+
+- (BOOL)isComplete
+{
+  return self.data.length >= self.size;
+}
+
+@end
+
 @interface FBDeviceCrashLogCommands ()
 
 @property (nonatomic, weak, readonly) FBDevice *device;
@@ -30,7 +70,8 @@
 + (instancetype)commandsWithTarget:(FBDevice *)target
 {
   NSString *storeDirectory = [target.auxillaryDirectory stringByAppendingPathComponent:@"crash_store"];
-  FBCrashLogStore *store = [FBCrashLogStore storeForDirectories:@[storeDirectory] logger:target.logger];
+  NSString *indexPath = [target.auxillaryDirectory stringByAppendingPathComponent:@"crash_store_index.plist"];
+  FBCrashLogStore *store = [FBCrashLogStore storeForDirectories:@[storeDirectory] indexPath:indexPath logger:target.logger];
   return [[self alloc] initWithDevice:target store:store];
 }
 
@@ -110,20 +151,42 @@ static NSString *const PingSuccess = @"ping";
             self.hasPerformedInitialIngestion = YES;
           }
           NSError *error = nil;
-          NSArray<NSString *> *paths = [afc contentsOfDirectory:@"." error:&error];
-          if (!paths) {
+          NSArray<FBAFCFileInfo *> *files = [afc contentsOfDirectoryWithInfo:@"." error:&error];
+          if (!files) {
             return [FBFuture futureWithError:error];
           }
+          // Only crash logs that are new, or have changed size since they were last seen, are read from the device.
           NSMutableArray<FBCrashLogInfo *> *crashes = [NSMutableArray array];
-          for (NSString *path in paths) {
-            FBCrashLogInfo *crash = [self crashLogInfo:afc path:path error:&error];
-            if (!crash) {
-              [logger logFormat:@"Failed to ingest crash log %@: %@", path, error];
+          NSMutableArray<FBAFCFileInfo *> *pending = [NSMutableArray array];
+          for (FBAFCFileInfo *file in files) {
+            if (file.type == FBAFCFileTypeDirectory) {
+              continue;
+            }
+            FBCrashLogInfo *existing = [self.store ingestedCrashLogWithName:file.name];
+            if (existing) {
+              [crashes addObject:existing];
               continue;
             }
-            [crashes addObject:crash];
+            if ([self.store hasSeenCrashLogWithName:file.name size:file.size]) {
+              continue;
+            }
+            [pending addObject:file];
           }
-          return [FBFuture futureWithResult:crashes];
+          [logger logFormat:@"Fetching %lu of %lu crash logs", pending.count, files.count];
+          return [[self
+            fetchCrashLogs:pending connection:afc logger:logger]
+            onQueue:self.device.workQueue map:^(NSArray<FBDeviceCrashLogCommands_Fetched *> *fetched) {
+              for (FBDeviceCrashLogCommands_Fetched *crashLog in fetched) {
+                FBCrashLogInfo *crash = [self ingestFetchedCrashLog:crashLog];
+                [self.store recordSeenCrashLogWithName:crashLog.name size:crashLog.size];
+                if (!crash) {
+                  [logger logFormat:@"Failed to ingest crash log %@", crashLog.name];
+                  continue;
+                }
+                [crashes addObject:crash];
+              }
+              return crashes;
+            }];
         }];
     }];
 }
@@ -147,19 +210,125 @@ static NSString *const PingSuccess = @"ping";
     }];
 }
 
-- (nullable FBCrashLogInfo *)crashLogInfo:(FBAFCConnection *)afc path:(NSString *)path error:(NSError **)error
+- (FBFuture<NSArray<FBDeviceCrashLogCommands_Fetched *> *> *)fetchCrashLogs:(NSArray<FBAFCFileInfo *> *)files connection:(FBAFCConnection *)connection logger:(id<FBControlCoreLogger>)logger
 {
-  NSString *name = path;
-  FBCrashLogInfo *existing = [self.store ingestedCrashLogWithName:path];
-  if (existing) {
-    [self.device.logger logFormat:@"No need to re-ingest %@", path];
-    return existing;
+  if (files.count == 0) {
+    return [FBFuture futureWithResult:@[]];
   }
-  NSData *data = [afc contentsOfPath:path error:error];
-  if (!data) {
-    return nil;
+  // Workers take crash logs from a shared list, so that a connection that is slow to start takes fewer of them.
+  NSMutableArray<FBAFCFileInfo *> *remaining = [files mutableCopy];
+  NSMutableArray<FBFuture<NSArray<FBDeviceCrashLogCommands_Fetched *> *> *> *workers = [NSMutableArray array];
+  [workers addObject:[FBFuture
+    onQueue:self.device.asyncQueue resolveValue:^(NSError **_) {
+      return [self fetchCrashLogsFrom:remaining connection:connection logger:logger];
+    }]];
+  NSUInteger additionalConnections = MIN(CrashLogIngestionConcurrency, files.count) - 1;
+  for (NSUInteger index = 0; index < additionalConnections; index++) {
+    [workers addObject:[[[self
+      crashReportFileConnection]
+      onQueue:self.device.asyncQueue pop:^(FBAFCConnection *additionalConnection) {
+        return [FBFuture futureWithResult:[self fetchCrashLogsFrom:remaining connection:additionalConnection logger:logger]];
+      }]
+      onQueue:self.device.asyncQueue handleError:^(NSError *error) {
+        // The other workers will fetch the crash logs that this one would have done.
+        [logger logFormat:@"Failed to open an additional connection for crash logs: %@", error];
+        return [FBFuture futureWithResult:@[]];
+      }]];
+  }
+  return [[FBFuture
+    futureWithFutures:workers]
+    onQueue:self.device.asyncQueue map:^(NSArray<NSArray<FBDeviceCrashLogCommands_Fetched *> *> *results) {
+      return [results valueForKeyPath:@"@unionOfArrays.self"];
+    }];
+}
+
+- (NSArray<FBDeviceCrashLogCommands_Fetched *> *)fetchCrashLogsFrom:(NSMutableArray<FBAFCFileInfo *> *)remaining connection:(FBAFCConnection *)afc logger:(id<FBControlCoreLogger>)logger
+{
+  NSMutableArray<FBDeviceCrashLogCommands_Fetched *> *fetched = [NSMutableArray array];
+  while (YES) {
+    FBAFCFileInfo *file = nil;
+    @synchronized (remaining) {
+      file = remaining.lastObject;
+      [remaining removeLastObject];
+    }
+    if (!file) {
+      break;
+    }
+    // Only the header is read for crash logs that can be parsed from one, the rest is fetched if the contents are requested.
+    NSError *error = nil;
+    NSData *data = [afc contentsOfPath:file.name maximumLength:CrashLogHeaderLength error:&error];
+    if (data && data.length < file.size && ![FBCrashLogInfo isParsableFromHeader:data]) {
+      data = [self contentsOfCrashLog:file.name connection:afc error:&error];
+    }
+    if (!data) {
+      [logger logFormat:@"Failed to read crash log %@: %@", file.name, error];
+      continue;
+    }
+    [fetched addObject:[[FBDeviceCrashLogCommands_Fetched alloc] initWithName:file.name size:file.size data:data]];
+  }
+  return fetched;
+}
+
+- (nullable FBCrashLogInfo *)ingestFetchedCrashLog:(FBDeviceCrashLogCommands_Fetched *)crashLog
+{
+  if (crashLog.isComplete) {
+    return [self.store ingestCrashLogData:crashLog.data name:crashLog.name];
+  }
+  NSString *name = crashLog.name;
+  __weak typeof(self) weakSelf = self;
+  return [self.store ingestCrashLogHeaderData:crashLog.data name:name contentsFetcher:^ BOOL (NSString *destination, NSError **error) {
+    FBDeviceCrashLogCommands *commands = weakSelf;
+    if (!commands) {
+      return [[FBDeviceControlError
+        describeFormat:@"Cannot fetch crash log %@, the device has gone away", name]
+        failBool:error];
+    }
+    return [[[commands
+      crashReportFileConnection]
+      onQueue:commands.device.asyncQueue pop:^ FBFuture<NSNull *> * (FBAFCConnection *afc) {
+        // Fetched to the side and moved, so that a failed fetch doesn't leave partial contents at the destination.
+        NSString *partialPath = [destination stringByAppendingPathExtension:@"partial"];
+        NSError *innerError = nil;
+        if (![commands copyCrashLog:name connection:afc toPath:partialPath error:&innerError]) {
+          return [FBFuture futureWithError:innerError];
+        }
+        if (rename(partialPath.fileSystemRepresentation, destination.fileSystemRepresentation) != 0) {
+          [NSFileManager.defaultManager removeItemAtPath:partialPath error:nil];
+          return [[FBDeviceControlError
+            describeFormat:@"Failed to move crash log %@ to %@: %s", name, destination, strerror(errno)]
+            failFuture];
+        }
+        return [FBFuture futureWithResult:NSNull.null];
+      }]
+      await:error] != nil;
+  }];
+}
+
+- (nullable NSData *)contentsOfCrashLog:(NSString *)name connection:(FBAFCConnection *)afc error:(NSError **)error
+{
+  // Stream the crash log to a temporary file and map it, rather than reading it into memory, as some logs are very large.
+  NSString *temporaryPath = [NSTemporaryDirectory() stringByAppendingPathComponent:NSUUID.UUID.UUIDString];
+  BOOL success = [self copyCrashLog:name connection:afc toPath:temporaryPath error:error];
+  NSData *data = success ? [NSData dataWithContentsOfFile:temporaryPath options:NSDataReadingMappedIfSafe error:error] : nil;
+  // The mapping remains valid after the file is removed.
+  [NSFileManager.defaultManager removeItemAtPath:temporaryPath error:nil];
+  return data;
+}
+
+- (BOOL)copyCrashLog:(NSString *)name connection:(FBAFCConnection *)afc toPath:(NSString *)path error:(NSError **)error
+{
+  int fileDescriptor = open(path.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  if (fileDescriptor == -1) {
+    return [[FBDeviceControlError
+      describeFormat:@"Failed to open file %@ for %@: %s", path, name, strerror(errno)]
+      failBool:error];
+  }
+  BOOL success = [afc readContentsOfPath:name toFileDescriptor:fileDescriptor error:error];
+  close(fileDescriptor);
+  if (!success) {
+    [NSFileManager.defaultManager removeItemAtPath:path error:nil];
   }
-  return [self.store ingestCrashLogData:data name:name];
+  return success;
 }
 
 - (FBFuture<NSString *> *)moveCrashReports
@@ -8,14 +8,185 @@
 #import "FBDeviceDebugSymbolsCommands.h"
 
 #import <dlfcn.h>
+#import <fcntl.h>
+#import <sys/stat.h>
+#import <unistd.h>
 
 #import "FBDevice.h"
 #import "FBAMDServiceConnection.h"
 #import "FBDeviceControlError.h"
+#import "FBDeviceSymbolCache.h"
 
 // This signature for this function is shown in the OSS release of dyld (ex: https://opensource.apple.com/source/dyld/dyld-433.5/launch-cache/dsc_extractor.cpp.auto.html)
 typedef int (*SharedCacheExtractor)(const char *sharedCachePath, const char *extractionRootDirectory, void (^progressCallback)(int current, int total));
 
+// The shared cache is several gigabytes, so it is received in large reads, each written out whilst the next is received.
+static const size_t PullBufferSize = 1024 * 1024 * 8;
+static const long PullBufferCount = 2;
+
+// A pull that fails part-way, for instance when USB resets, is resumed on a fresh connection.
+static const NSUInteger PullAttempts = 3;
+
+// The UUID of a dyld shared cache is at a fixed offset in its header.
+static const off_t SharedCacheUUIDOffset = 0x58;
+static NSString *const MetadataKeySharedCacheUUID = @"SharedCacheUUID";
+
+@interface FBDeviceDebugSymbolsCommands_Pull : NSObject
+
+@property (nonatomic, assign, readonly) int fileDescriptor;
+@property (nonatomic, assign, readonly) uint64_t resumeOffset;
+@property (nonatomic, copy, readonly) NSArray<NSMutableData *> *buffers;
+@property (nonatomic, strong, readonly) dispatch_semaphore_t freeBuffers;
+@property (nonatomic, strong, readonly) dispatch_queue_t writeQueue;
+@property (atomic, strong, nullable, readwrite) NSError *writeError;
+
+@end
+
+@implementation FBDeviceDebugSymbolsCommands_Pull
+
++ (BOOL)receiveFileOfLength:(uint64_t)length fromConnection:(FBAMDServiceConnection *)connection toDestinationPath:(NSString *)destinationPath logger:(id<FBControlCoreLogger>)logger error:(NSError **)error
+{
+  struct stat existing;
+  if (stat(destinationPath.fileSystemRepresentation, &existing) == 0 && (uint64_t) existing.st_size == length) {
+    [logger logFormat:@"%@ has already been pulled", destinationPath];
+    return YES;
+  }
+  // The length is part of the name, so that a partial file from a different version of the same file is not resumed from.
+  NSString *partialPath = [destinationPath stringByAppendingFormat:@".%llu.partial", length];
+  int fileDescriptor = open(partialPath.fileSystemRepresentation, O_WRONLY | O_CREAT, 0644);
+  if (fileDescriptor < 0) {
+    return [[FBDeviceControlError
+      describeFormat:@"Failed to open file for writing at %@: %s", partialPath, strerror(errno)]
+      failBool:error];
+  }
+  struct stat partial;
+  uint64_t resumeOffset = fstat(fileDescriptor, &partial) == 0 ? (uint64_t) partial.st_size : 0;
+  if (resumeOffset > length) {
+    ftruncate(fileDescriptor, 0);
+    resumeOffset = 0;
+  }
+  if (resumeOffset > 0) {
+    [logger logFormat:@"Resuming pull of %@ from %llu of %llu bytes", destinationPath, resumeOffset, length];
+  }
+
+  NSDate *start = NSDate.date;
+  FBDeviceDebugSymbolsCommands_Pull *pull = [[self alloc] initWithFileDescriptor:fileDescriptor resumeOffset:resumeOffset];
+  BOOL success = [pull receiveLength:length fromConnection:connection error:error];
+  close(fileDescriptor);
+  if (!success) {
+    return NO;
+  }
+  if (rename(partialPath.fileSystemRepresentation, destinationPath.fileSystemRepresentation) != 0) {
+    return [[FBDeviceControlError
+      describeFormat:@"Failed to move %@ to %@: %s", partialPath, destinationPath, strerror(errno)]
+      failBool:error];
+  }
+  NSTimeInterval duration = MAX(-start.timeIntervalSinceNow, 0.001);
+  [logger logFormat:@"Pulled %llu bytes to %@ in %.1f seconds (%.1f MB/s)", length, destinationPath, duration, (length / duration) / (1024 * 1024)];
+  return YES;
+}
+
+- (instancetype)initWithFileDescriptor:(int)fileDescriptor resumeOffset:(uint64_t)resumeOffset
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _fileDescriptor = fileDescriptor;
+  _resumeOffset = resumeOffset;
+  NSMutableArray<NSMutableData *> *buffers = NSMutableArray.array;
+  for (long index = 0; index < PullBufferCount; index++) {
+    [buffers addObject:[NSMutableData dataWithLength:PullBufferSize]];
+  }
+  _buffers = buffers;
+  _freeBuffers = dispatch_semaphore_create(PullBufferCount);
+  _writeQueue = dispatch_queue_create("com.facebook.fbdevicecontrol.symbol_pull", DISPATCH_QUEUE_SERIAL);
+
+  return self;
+}
+
+- (BOOL)receiveLength:(uint64_t)length fromConnection:(FBAMDServiceConnection *)connection error:(NSError **)error
+{
+  // Receive in reads as large as the buffer, rather than the default chunk of the connection.
+  connection.receiveChunkSize = PullBufferSize;
+  uint64_t offset = 0;
+  NSUInteger bufferIndex = 0;
+  while (offset < length) {
+    // Writes are serial, so the buffer that is next in turn is the one that has been freed.
+    dispatch_semaphore_wait(self.freeBuffers, DISPATCH_TIME_FOREVER);
+    if (self.writeError) {
+      break;
+    }
+    uint8_t *buffer = self.buffers[bufferIndex].mutableBytes;
+    bufferIndex = (bufferIndex + 1) % self.buffers.count;
+    size_t size = (size_t) MIN((uint64_t) PullBufferSize, length - offset);
+    if (![connection receive:buffer ofSize:size error:error]) {
+      [self drainWrites];
+      return NO;
+    }
+    uint64_t bufferOffset = offset;
+    offset += size;
+    dispatch_async(self.writeQueue, ^{
+      [self writeBuffer:buffer size:size atOffset:bufferOffset];
+      dispatch_semaphore_signal(self.freeBuffers);
+    });
+  }
+  [self drainWrites];
+  if (self.writeError) {
+    if (error) {
+      *error = self.writeError;
+    }
+    return NO;
+  }
+  struct stat status;
+  if (fstat(self.fileDescriptor, &status) != 0 || (uint64_t) status.st_size != length) {
+    return [[FBDeviceControlError
+      describeFormat:@"Pulled file has a length of %lld bytes, expected %llu bytes", (long long) status.st_size, length]
+      failBool:error];
+  }
+  return YES;
+}
+
+- (void)writeBuffer:(const uint8_t *)buffer size:(size_t)size atOffset:(uint64_t)offset
+{
+  if (self.writeError) {
+    return;
+  }
+  // The service cannot start part-way through a file, so bytes that an earlier attempt has already written are received again but not written.
+  if (offset + size <= self.resumeOffset) {
+    return;
+  }
+  if (offset < self.resumeOffset) {
+    size_t skipped = (size_t) (self.resumeOffset - offset);
+    buffer += skipped;
+    size -= skipped;
+    offset += skipped;
+  }
+  while (size > 0) {
+    ssize_t written = pwrite(self.fileDescriptor, buffer, size, (off_t) offset);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      self.writeError = [[FBDeviceControlError
+        describeFormat:@"Failed to write %zu bytes at offset %llu: %s", size, offset, strerror(errno)]
+        build];
+      return;
+    }
+    buffer += written;
+    size -= (size_t) written;
+    offset += (uint64_t) written;
+  }
+}
+
+- (void)drainWrites
+{
+  dispatch_sync(self.writeQueue, ^{});
+}
+
+@end
+
 @interface FBDeviceDebugSymbolsCommands ()
 
 @property (nonatomic, weak, readonly) FBDevice *device;
@@ -67,6 +238,42 @@ static const uint32_t GetFileAck = GetFileCommand;
 }
 
 - (FBFuture<NSString *> *)pullAndExtractSymbolsToDestinationDirectory:(NSString *)destinationDirectory
+{
+  return [[self
+    pullAndExtractSymbolsToCache]
+    onQueue:self.device.asyncQueue fmap:^(NSString *cachedDirectory) {
+      NSError *error = nil;
+      if (![FBDeviceDebugSymbolsCommands copyContentsOfDirectory:cachedDirectory toDirectory:destinationDirectory error:&error]) {
+        return [FBFuture futureWithError:error];
+      }
+      return [FBFuture futureWithResult:destinationDirectory];
+    }];
+}
+
+- (FBFuture<NSString *> *)pullAndExtractSymbolsToCache
+{
+  return [self pullAndExtractSymbolsToCacheWithProgress:nil];
+}
+
+- (FBFuture<NSString *> *)pullAndExtractSymbolsToCacheWithProgress:(nullable FBDeviceSymbolsExtractionProgress)progress
+{
+  NSString *productVersion = self.device.productVersion;
+  NSString *buildVersion = self.device.buildVersion;
+  NSString *architecture = self.device.architectures.firstObject;
+  if (!productVersion || !buildVersion || !architecture) {
+    return [[FBDeviceControlError
+      describeFormat:@"Cannot cache symbols of %@ without a product version, build version and architecture", self.device]
+      failFuture];
+  }
+  NSString *key = [FBDeviceSymbolCache keyForProductVersion:productVersion buildVersion:buildVersion architecture:architecture];
+  return [FBDeviceSymbolCache.sharedCache directoryForKey:key onQueue:self.device.asyncQueue populator:^(NSString *directory) {
+    return [self pullAndExtractSymbolsToDirectory:directory progress:progress];
+  }];
+}
+
+#pragma mark Private
+
+- (FBFuture<NSDictionary<NSString *, id> *> *)pullAndExtractSymbolsToDirectory:(NSString *)destinationDirectory progress:(nullable FBDeviceSymbolsExtractionProgress)progress
 {
   NSError *error = nil;
   if (![NSFileManager.defaultManager createDirectoryAtPath:destinationDirectory withIntermediateDirectories:YES attributes:nil error:&error]) {
@@ -88,22 +295,22 @@ static const uint32_t GetFileAck = GetFileCommand;
     }]
     onQueue:self.device.asyncQueue fmap:^(NSArray<NSString *> *extractedSymbolFiles) {
       NSError *innerError = nil;
-      NSString *sharedCachePath = [FBDeviceDebugSymbolsCommands extractSharedCachePathFromPaths:extractedSymbolFiles error:&innerError];
-      if (!sharedCachePath) {
+      NSArray<NSString *> *sharedCachePaths = [FBDeviceDebugSymbolsCommands extractSharedCachePathsFromPaths:extractedSymbolFiles architecture:self.device.architectures.firstObject error:&innerError];
+      if (!sharedCachePaths) {
         return [FBFuture futureWithError:innerError];
       }
-      if (![FBDeviceDebugSymbolsCommands extractSharedCacheFile:sharedCachePath toDestinationDirectory:destinationDirectory logger:self.device.logger error:&innerError]) {
+      if (![FBDeviceDebugSymbolsCommands extractSharedCacheFiles:sharedCachePaths toDestinationDirectory:destinationDirectory progress:progress logger:self.device.logger error:&innerError]) {
         return [FBFuture futureWithError:innerError];
       }
+      NSMutableDictionary<NSString *, id> *metadata = NSMutableDictionary.dictionary;
+      metadata[MetadataKeySharedCacheUUID] = [FBDeviceDebugSymbolsCommands uuidOfSharedCacheAtPath:sharedCachePaths.firstObject];
       for (NSString *extractedSymbolFile in extractedSymbolFiles) {
         [NSFileManager.defaultManager removeItemAtPath:extractedSymbolFile error:nil];
       }
-      return [FBFuture futureWithResult:destinationDirectory];
+      return [FBFuture futureWithResult:[metadata copy]];
     }];
 }
 
-#pragma mark Private
-
 - (FBFuture<NSArray<NSString *> *> *)extractSymbolFilesWithIndicesMap:(NSDictionary<NSNumber *, NSString *> *)indicesToName extractedPaths:(NSArray<NSString *> *)extractedPaths
 {
   if (indicesToName.count == 0) {
@@ -155,7 +362,7 @@ static const uint32_t GetFileAck = GetFileCommand;
       NSUInteger index = [files indexOfObject:fileName];
       if (index == NSNotFound) {
         return [[FBDeviceControlError
-          describeFormat:@"Could not find %@ within %@", fileName, [FBCollectionInformation oneLineDescriptionFromArray:files]]
+          describeFormat:@"Could not find %@ within %@", fileName, [FBCollectionInformation lazyOneLineDescriptionFromArray:files]]
           failFuture];
       }
       return [FBFuture futureWithResult:@(index)];
@@ -164,14 +371,27 @@ static const uint32_t GetFileAck = GetFileCommand;
 
 - (FBFuture<NSString *> *)writeSymbolFileWithIndex:(uint32_t)index toFileAtPath:(NSString *)destinationPath
 {
-  return [[self
+  return [self writeSymbolFileWithIndex:index toFileAtPath:destinationPath attempt:1];
+}
+
+- (FBFuture<NSString *> *)writeSymbolFileWithIndex:(uint32_t)index toFileAtPath:(NSString *)destinationPath attempt:(NSUInteger)attempt
+{
+  id<FBControlCoreLogger> logger = self.device.logger;
+  return [[[self
     symbolServiceConnection]
     onQueue:self.device.asyncQueue pop:^(FBAMDServiceConnection *connection) {
       NSError *error = nil;
-      if(![FBDeviceDebugSymbolsCommands getFileWithIndex:index toDestinationPath:destinationPath onConnection:connection error:&error]) {
+      if(![FBDeviceDebugSymbolsCommands getFileWithIndex:index toDestinationPath:destinationPath onConnection:connection logger:logger error:&error]) {
         return [FBFuture futureWithError:error];
       }
       return [FBFuture futureWithResult:destinationPath];
+    }]
+    onQueue:self.device.asyncQueue handleError:^(NSError *error) {
+      if (attempt >= PullAttempts) {
+        return [FBFuture futureWithError:error];
+      }
+      [logger logFormat:@"Pull of %@ failed on attempt %lu, resuming on a new connection %@", destinationPath, (unsigned long) attempt, error];
+      return [self writeSymbolFileWithIndex:index toFileAtPath:destinationPath attempt:attempt + 1];
     }];
 }
 
@@ -213,7 +433,7 @@ static const uint32_t GetFileAck = GetFileCommand;
   NSArray<NSString *> *files = message[@"files"];
   if (![FBCollectionInformation isArrayHeterogeneous:files withClass:NSString.class]) {
     return [[FBDeviceControlError
-      describeFormat:@"ListFilesPlist expected Array<String> for 'files' but got %@", [FBCollectionInformation oneLineDescriptionFromArray:files]]
+      describeFormat:@"ListFilesPlist expected Array<String> for 'files' but got %@", [FBCollectionInformation lazyOneLineDescriptionFromArray:files]]
       fail:error];
   }
   return files;
@@ -243,7 +463,7 @@ static const uint32_t GetFileAck = GetFileCommand;
   return YES;
 }
 
-+ (BOOL)getFileWithIndex:(uint32_t)index toDestinationPath:(NSString *)destinationPath onConnection:(FBAMDServiceConnection *)connection error:(NSError **)error
++ (BOOL)getFileWithIndex:(uint32_t)index toDestinationPath:(NSString *)destinationPath onConnection:(FBAMDServiceConnection *)connection logger:(id<FBControlCoreLogger>)logger error:(NSError **)error
 {
   // Send the command that we want to get a file
   if (![FBDeviceDebugSymbolsCommands sendCommand:GetFileCommand withAck:GetFileAck commandName:@"GetFiles" onConnection:connection error:error]) {
@@ -269,38 +489,90 @@ static const uint32_t GetFileAck = GetFileCommand;
       failBool:error];
   }
   uint64_t recieveLength = OSSwapBigToHostInt64(recieveLengthWire);
-  if (![NSFileManager.defaultManager createFileAtPath:destinationPath contents:nil attributes:nil]) {
-    return [[FBDeviceControlError
-      describeFormat:@"Failed to create destination file at path %@", destinationPath]
-      failBool:error];
-  }
-  NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingAtPath:destinationPath];
-  if (!fileHandle) {
-    return [[FBDeviceControlError
-      describeFormat:@"Failed to open file for writing at %@", destinationPath]
-      failBool:error];
+  return [FBDeviceDebugSymbolsCommands_Pull receiveFileOfLength:recieveLength fromConnection:connection toDestinationPath:destinationPath logger:logger error:error];
+}
+
++ (BOOL)extractSharedCacheFiles:(NSArray<NSString *> *)sharedCacheFiles toDestinationDirectory:(NSString *)destinationDirectory progress:(nullable FBDeviceSymbolsExtractionProgress)progress logger:(id<FBControlCoreLogger>)logger error:(NSError **)error
+{
+  SharedCacheExtractor extractor = [self getSharedCacheExtractorWithError:error];
+  if (!extractor) {
+    return NO;
   }
-  if (![connection receive:recieveLength toFile:fileHandle error:error]) {
+  // The extractor already extracts the dylibs of one cache in parallel, so it is the independent caches that are extracted at the same time as each other.
+  // The first cache is the one for the architecture of the device, which is extracted into the destination itself. Any others are extracted alongside it so that their dylibs don't collide.
+  NSUInteger count = sharedCacheFiles.count;
+  NSUInteger *completedByCache = calloc(count, sizeof(NSUInteger));
+  NSUInteger *totalByCache = calloc(count, sizeof(NSUInteger));
+  __block NSUInteger lastReportedPercent = NSNotFound;
+  NSMutableArray<NSError *> *errors = NSMutableArray.array;
+  NSObject *lock = [NSObject new];
+  dispatch_apply(count, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^(size_t index) {
+    NSString *sharedCacheFile = sharedCacheFiles[index];
+    NSString *cacheDestination = index == 0 ? destinationDirectory : [destinationDirectory stringByAppendingPathComponent:sharedCacheFile.lastPathComponent];
+    NSError *innerError = nil;
+    BOOL success = [self extractSharedCacheFile:sharedCacheFile toDestinationDirectory:cacheDestination extractor:extractor logger:logger progress:^(NSUInteger completed, NSUInteger total) {
+      NSUInteger aggregateCompleted = 0;
+      NSUInteger aggregateTotal = 0;
+      BOOL report = NO;
+      @synchronized (lock) {
+        completedByCache[index] = completed;
+        totalByCache[index] = total;
+        for (NSUInteger cacheIndex = 0; cacheIndex < count; cacheIndex++) {
+          aggregateCompleted += completedByCache[cacheIndex];
+          aggregateTotal += totalByCache[cacheIndex];
+        }
+        // The extractor reports every dylib, which is thousands of callbacks, so progress is only reported when the percentage changes.
+        NSUInteger percent = aggregateTotal == 0 ? 0 : (aggregateCompleted * 100) / aggregateTotal;
+        report = percent != lastReportedPercent;
+        if (report) {
+          lastReportedPercent = percent;
+          if (percent % 10 == 0) {
+            [logger logFormat:@"Extracted %lu of %lu dylibs", (unsigned long) aggregateCompleted, (unsigned long) aggregateTotal];
+          }
+        }
+      }
+      if (report && progress) {
+        progress(aggregateCompleted, aggregateTotal);
+      }
+    } error:&innerError];
+    if (!success) {
+      @synchronized (lock) {
+        [errors addObject:innerError];
+      }
+    }
+  });
+  free(completedByCache);
+  free(totalByCache);
+  if (errors.count > 0) {
+    if (error) {
+      *error = errors.firstObject;
+    }
     return NO;
   }
   return YES;
 }
 
-+ (BOOL)extractSharedCacheFile:(NSString *)sharedCacheFile toDestinationDirectory:(NSString *)destinationDirectory logger:(id<FBControlCoreLogger>)logger error:(NSError **)error
++ (BOOL)extractSharedCacheFile:(NSString *)sharedCacheFile toDestinationDirectory:(NSString *)destinationDirectory extractor:(SharedCacheExtractor)extractor logger:(id<FBControlCoreLogger>)logger progress:(FBDeviceSymbolsExtractionProgress)progress error:(NSError **)error
 {
-  SharedCacheExtractor extractor = [self getSharedCacheExtractorWithError:error];
-  if (!extractor) {
-    return NO;
+  // A marker of a completed extraction is keyed on the UUID of the cache, so the same cache is not extracted twice into the same destination.
+  NSString *uuid = [self uuidOfSharedCacheAtPath:sharedCacheFile];
+  NSString *markerPath = uuid ? [destinationDirectory stringByAppendingPathComponent:[NSString stringWithFormat:@".%@.%@.extracted", sharedCacheFile.lastPathComponent, uuid]] : nil;
+  if (markerPath && [NSFileManager.defaultManager fileExistsAtPath:markerPath]) {
+    [logger logFormat:@"Shared cache %@ has already been extracted to %@", sharedCacheFile, destinationDirectory];
+    return YES;
   }
   [logger logFormat:@"Extracting shared cache at %@ to directory at %@", sharedCacheFile, destinationDirectory];
   int status = extractor(sharedCacheFile.UTF8String, destinationDirectory.UTF8String, ^(int completed, int total){
-    [logger logFormat:@"Completed %d Total %d", completed, total];
+    progress((NSUInteger) MAX(completed, 0), (NSUInteger) MAX(total, 0));
   });
   if (status != 0) {
     return [[FBDeviceControlError
       describeFormat:@"Failed to get extract shared cache directory %@ to %@ with status %d", sharedCacheFile, destinationDirectory, status]
       failBool:error];
   }
+  if (markerPath) {
+    [NSFileManager.defaultManager createFileAtPath:markerPath contents:nil attributes:nil];
+  }
   [logger logFormat:@"Shared cache extracted to %@", destinationDirectory];
   return YES;
 }
@@ -353,7 +625,7 @@ static const uint32_t GetFileAck = GetFileCommand;
     NSUInteger index = [fileIndices indexOfObject:file];
     if (index == NSNotFound) {
       return [[FBDeviceControlError
-        describeFormat:@"Could not find %@ within %@", file, [FBCollectionInformation oneLineDescriptionFromArray:fileIndices]]
+        describeFormat:@"Could not find %@ within %@", file, [FBCollectionInformation lazyOneLineDescriptionFromArray:fileIndices]]
         fail:error];
     }
     indexToFileName[@(index)] = file;
@@ -361,15 +633,69 @@ static const uint32_t GetFileAck = GetFileCommand;
   return indexToFileName;
 }
 
-+ (NSString *)extractSharedCachePathFromPaths:(NSArray<NSString *> *)paths error:(NSError **)error
++ (nullable NSString *)uuidOfSharedCacheAtPath:(NSString *)path
 {
+  int fileDescriptor = open(path.fileSystemRepresentation, O_RDONLY);
+  if (fileDescriptor < 0) {
+    return nil;
+  }
+  uuid_t uuid;
+  ssize_t result = pread(fileDescriptor, uuid, sizeof(uuid_t), SharedCacheUUIDOffset);
+  close(fileDescriptor);
+  if (result != sizeof(uuid_t)) {
+    return nil;
+  }
+  return [[NSUUID alloc] initWithUUIDBytes:uuid].UUIDString;
+}
+
++ (BOOL)copyContentsOfDirectory:(NSString *)sourceDirectory toDirectory:(NSString *)destinationDirectory error:(NSError **)error
+{
+  NSError *innerError = nil;
+  if (![NSFileManager.defaultManager createDirectoryAtPath:destinationDirectory withIntermediateDirectories:YES attributes:nil error:&innerError]) {
+    return [[FBDeviceControlError
+      describeFormat:@"Failed to create destination directory for symbol extraction: %@", innerError]
+      failBool:error];
+  }
+  NSArray<NSString *> *contents = [NSFileManager.defaultManager contentsOfDirectoryAtPath:sourceDirectory error:&innerError];
+  if (!contents) {
+    return [[FBDeviceControlError
+      describeFormat:@"Failed to list cached symbols in %@: %@", sourceDirectory, innerError]
+      failBool:error];
+  }
+  // Copies on APFS are clones, so populating a destination from the cache does not duplicate the storage of the symbols.
+  for (NSString *item in contents) {
+    NSString *destinationPath = [destinationDirectory stringByAppendingPathComponent:item];
+    if ([NSFileManager.defaultManager fileExistsAtPath:destinationPath]) {
+      continue;
+    }
+    if (![NSFileManager.defaultManager copyItemAtPath:[sourceDirectory stringByAppendingPathComponent:item] toPath:destinationPath error:&innerError]) {
+      return [[FBDeviceControlError
+        describeFormat:@"Failed to copy cached symbols to %@: %@", destinationPath, innerError]
+        failBool:error];
+    }
+  }
+  return YES;
+}
+
++ (NSArray<NSString *> *)extractSharedCachePathsFromPaths:(NSArray<NSString *> *)paths architecture:(nullable NSString *)architecture error:(NSError **)error
+{
+  // Sub-caches and symbol files have an extension and are found by the extractor next to their main cache, so only main caches are extracted.
+  NSMutableArray<NSString *> *sharedCachePaths = NSMutableArray.array;
   for (NSString *path in paths) {
-    if ([path.pathExtension isEqualToString:@""]) {
-      return path;
+    if (![path.pathExtension isEqualToString:@""]) {
+      continue;
     }
+    if (architecture && [path.lastPathComponent hasSuffix:[@"_" stringByAppendingString:architecture]]) {
+      [sharedCachePaths insertObject:path atIndex:0];
+    } else {
+      [sharedCachePaths addObject:path];
+    }
+  }
+  if (sharedCachePaths.count > 0) {
+    return sharedCachePaths;
   }
   return [[FBDeviceControlError
-    describeFormat:@"Could not find the shared cache file within %@", [FBCollectionInformation oneLineDescriptionFromArray:paths]]
+    describeFormat:@"Could not find the shared cache file within %@", [FBCollectionInformation lazyOneLineDescriptionFromArray:paths]]
     fail:error];
 }
   
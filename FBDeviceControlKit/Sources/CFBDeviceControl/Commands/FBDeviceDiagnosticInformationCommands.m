@@ -14,10 +14,19 @@
 
 static NSString *const DiagnosticsRelayService = @"com.apple.mobile.diagnostics_relay";
 
+// The time that a single source is given before it is reported as timed out.
+static const NSTimeInterval DiagnosticSourceTimeout = 10;
+// The time for which a fast fetch is reused, so that several pollers of the same device share one fetch.
+static const NSTimeInterval FastDiagnosticsCacheLifetime = 15;
+
 @interface FBDeviceDiagnosticInformationCommands ()
 
 @property (nonatomic, weak, readonly) FBDevice *device;
 
+// The last fast fetch and when it was started, guarded by @synchronized on the receiver.
+@property (nonatomic, strong, nullable, readwrite) FBFuture<NSDictionary<NSString *, id> *> *fastFetch;
+@property (nonatomic, assign, readwrite) CFAbsoluteTime fastFetchStartTime;
+
 @end
 
 @implementation FBDeviceDiagnosticInformationCommands
@@ -45,27 +54,68 @@ static NSString *const DiagnosticsRelayService = @"com.apple.mobile.diagnostics_
 
 - (FBFuture<NSDictionary<NSString *, id> *> *)fetchDiagnosticInformation
 {
+  return [self fetchFromSources:@{
+    DiagnosticsRelayService: [self fetchInformationFromDiagnosticsRelay],
+    FBSpringboardServiceName: [self fetchInformationFromSpringboard],
+    FBManagedConfigService: [self fetchInformationFromMobileConfiguration],
+  }];
+}
+
+- (FBFuture<NSDictionary<NSString *, id> *> *)fetchFastDiagnosticInformation
+{
+  @synchronized (self) {
+    FBFuture<NSDictionary<NSString *, id> *> *fastFetch = self.fastFetch;
+    BOOL reusable = fastFetch && (fastFetch.state == FBFutureStateRunning || fastFetch.state == FBFutureStateDone);
+    if (reusable && CFAbsoluteTimeGetCurrent() - self.fastFetchStartTime < FastDiagnosticsCacheLifetime) {
+      return fastFetch;
+    }
+    // The Springboard icon layout is the most expensive source and changes the least, so it is left out.
+    fastFetch = [self fetchFromSources:@{
+      DiagnosticsRelayService: [self fetchInformationFromDiagnosticsRelay],
+      FBManagedConfigService: [self fetchInformationFromMobileConfiguration],
+    }];
+    self.fastFetch = fastFetch;
+    self.fastFetchStartTime = CFAbsoluteTimeGetCurrent();
+    return fastFetch;
+  }
+}
+
+#pragma mark Private
+
+- (FBFuture<NSDictionary<NSString *, id> *> *)fetchFromSources:(NSDictionary<NSString *, FBFuture<id> *> *)sources
+{
+  NSArray<NSString *> *names = sources.allKeys;
+  NSMutableArray<FBFuture<id> *> *futures = [NSMutableArray arrayWithCapacity:names.count];
+  for (NSString *name in names) {
+    [futures addObject:[self partialResultOf:sources[name] source:name]];
+  }
   return [[FBFuture
-    futureWithFutures:@[
-      [self fetchInformationFromDiagnosticsRelay],
-      [self fetchInformationFromSpringboard],
-      [self fetchInformationFromMobileConfiguration],
-    ]]
+    futureWithFutures:futures]
     onQueue:self.device.asyncQueue map:^ NSDictionary<NSString *, id> * (NSArray<id> *results) {
-      return [FBCollectionOperations recursiveFilteredJSONSerializableRepresentationOfDictionary:@{
-        DiagnosticsRelayService: results[0],
-        FBSpringboardServiceName: results[1],
-        FBManagedConfigService: results[2],
-      }];
+      return [FBCollectionOperations recursiveFilteredJSONSerializableRepresentationOfDictionary:[NSDictionary dictionaryWithObjects:results forKeys:names]];
     }];
 }
 
-#pragma mark Private
+- (FBFuture<id> *)partialResultOf:(FBFuture<id> *)future source:(NSString *)source
+{
+  dispatch_queue_t queue = self.device.asyncQueue;
+  id<FBControlCoreLogger> logger = self.device.logger;
+  return [[future
+    onQueue:queue timeout:DiagnosticSourceTimeout handler:^{
+      return [[FBControlCoreError
+        describeFormat:@"Timed out fetching %@ after %.0f seconds", source, DiagnosticSourceTimeout]
+        failFuture];
+    }]
+    onQueue:queue handleError:^(NSError *error) {
+      [logger logFormat:@"Failed to fetch diagnostic information from %@: %@", source, error];
+      return [FBFuture futureWithResult:@{@"Error": error.localizedDescription ?: error.description}];
+    }];
+}
 
 - (FBFuture<NSDictionary<NSString *, id> *> *)fetchInformationFromDiagnosticsRelay
 {
   return [[self.device
-    startService:DiagnosticsRelayService]
+    pooledService:DiagnosticsRelayService]
     onQueue:self.device.asyncQueue pop:^(FBAMDServiceConnection *connection) {
       NSError *error = nil;
       NSDictionary<NSString *, id> *result = [connection sendAndReceiveMessage:@{@"Request": @"All"} error:&error];
@@ -84,7 +134,7 @@ static NSString *const DiagnosticsRelayService = @"com.apple.mobile.diagnostics_
 - (FBFuture<IconLayoutType> *)fetchInformationFromSpringboard
 {
   return [[self.device
-    startService:FBSpringboardServiceName]
+    pooledService:FBSpringboardServiceName]
     onQueue:self.device.asyncQueue pop:^(FBAMDServiceConnection *connection) {
       FBSpringboardServicesClient *client = [FBSpringboardServicesClient springboardServicesClientWithConnection:connection logger:self.device.logger];
       return [client getIconLayout];
@@ -94,7 +144,7 @@ static NSString *const DiagnosticsRelayService = @"com.apple.mobile.diagnostics_
 - (FBFuture<NSDictionary<NSString *, id> *> *)fetchInformationFromMobileConfiguration
 {
   return [[self.device
-    startService:FBManagedConfigService]
+    pooledService:FBManagedConfigService]
     onQueue:self.device.asyncQueue pop:^(FBAMDServiceConnection *connection) {
       return [[FBManagedConfigClient managedConfigClientWithConnection:connection logger:self.device.logger] getCloudConfiguration];
     }];
@@ -16,16 +16,168 @@
 #import "FBManagedConfigClient.h"
 #import "FBSpringboardServicesClient.h"
 
+// The bounds of the interval between polls of a tailed file. Polling backs off towards the maximum whilst the file is idle.
+static const NSTimeInterval TailMinimumPollInterval = 0.1;
+static const NSTimeInterval TailMaximumPollInterval = 2.0;
+// Whilst the file is being written to, the interval is chosen so that each poll reads around this many bytes.
+static const double TailTargetBytesPerPoll = 1024 * 64;
+
+/**
+ Follows a file on a device by polling it, reading only the bytes that have been appended since the previous poll.
+ */
+@interface FBDeviceFileContainer_Tail : NSObject
+
+@property (nonatomic, strong, readonly) FBAFCConnection *connection;
+@property (nonatomic, copy, readonly) NSString *path;
+@property (nonatomic, strong, readonly) id<FBDataConsumer> consumer;
+@property (nonatomic, strong, nullable, readonly) NSMutableDictionary<NSString *, NSNumber *> *offsets;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *completed;
+@property (nonatomic, assign, readwrite) uint64_t offset;
+@property (nonatomic, assign, readwrite) NSTimeInterval interval;
+@property (nonatomic, assign, readwrite) double bytesPerSecond;
+@property (nonatomic, assign, readwrite) uint64_t lastPollTime;
+
+@end
+
+@implementation FBDeviceFileContainer_Tail
+
+- (instancetype)initWithConnection:(FBAFCConnection *)connection path:(NSString *)path consumer:(id<FBDataConsumer>)consumer offsets:(nullable NSMutableDictionary<NSString *, NSNumber *> *)offsets
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _connection = connection;
+  _path = path.stringByStandardizingPath;
+  _consumer = consumer;
+  _offsets = offsets;
+  _queue = dispatch_queue_create("com.facebook.fbdevicecontrol.afc_tail", DISPATCH_QUEUE_SERIAL);
+  _completed = FBMutableFuture.future;
+  _interval = TailMinimumPollInterval;
+  @synchronized (offsets) {
+    _offset = offsets[_path].unsignedLongLongValue;
+  }
+
+  return self;
+}
+
+- (FBFuture<NSNull *> *)start
+{
+  dispatch_async(self.queue, ^{
+    self.lastPollTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    [self poll];
+  });
+  return [self.completed
+    onQueue:self.queue respondToCancellation:^{
+      [self finishWithError:nil];
+      return FBFuture.empty;
+    }];
+}
+
+#pragma mark Private
+
+- (void)poll
+{
+  if (self.completed.hasCompleted) {
+    return;
+  }
+  if (!self.connection.connectionIsValid) {
+    [self finishWithError:[[FBDeviceControlError describeFormat:@"Connection was lost whilst tailing %@ at offset %llu", self.path, self.offset] build]];
+    return;
+  }
+  uint64_t now = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  double elapsed = (double) (now - self.lastPollTime) / NSEC_PER_SEC;
+  self.lastPollTime = now;
+
+  // Checking the size first means that an idle file costs a single round trip to the device per poll.
+  NSError *error = nil;
+  FBAFCFileInfo *info = [self.connection fileInfoForPath:self.path error:&error];
+  uint64_t appended = 0;
+  if (info) {
+    if (info.size < self.offset) {
+      // The file has been truncated or replaced, so start again from the beginning of it.
+      [self.connection.logger logFormat:@"%@ shrank from %llu to %llu bytes, tailing from the start", self.path, self.offset, info.size];
+      [self storeOffset:0];
+    }
+    if (info.size > self.offset) {
+      uint64_t endOffset = self.offset;
+      if (![self.connection readContentsOfPath:self.path fromOffset:self.offset toConsumer:self.consumer endOffset:&endOffset error:&error]) {
+        [self finishWithError:error];
+        return;
+      }
+      appended = endOffset - self.offset;
+      [self storeOffset:endOffset];
+    }
+  }
+  // A file that doesn't exist yet is polled until it does, in the same way as "tail -F".
+
+  [self adaptIntervalToAppendedBytes:appended elapsed:elapsed];
+  dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t) (self.interval * NSEC_PER_SEC)), self.queue, ^{
+    [self poll];
+  });
+}
+
+- (void)adaptIntervalToAppendedBytes:(uint64_t)appended elapsed:(double)elapsed
+{
+  if (appended == 0 || elapsed <= 0) {
+    self.bytesPerSecond /= 2;
+    self.interval = MIN(self.interval * 2, TailMaximumPollInterval);
+    return;
+  }
+  // Smooth the rate, so that a single burst doesn't cause the interval to swing.
+  double rate = (double) appended / elapsed;
+  self.bytesPerSecond = self.bytesPerSecond > 0 ? (self.bytesPerSecond + rate) / 2 : rate;
+  self.interval = MAX(TailMinimumPollInterval, MIN(TailTargetBytesPerPoll / self.bytesPerSecond, TailMaximumPollInterval));
+}
+
+- (void)storeOffset:(uint64_t)offset
+{
+  self.offset = offset;
+  NSMutableDictionary<NSString *, NSNumber *> *offsets = self.offsets;
+  @synchronized (offsets) {
+    offsets[self.path] = @(offset);
+  }
+}
+
+- (void)finishWithError:(nullable NSError *)error
+{
+  if (self.completed.hasCompleted) {
+    return;
+  }
+  [self.consumer consumeEndOfFile];
+  if (error) {
+    [self.completed resolveWithError:error];
+  } else {
+    [self.completed resolveWithResult:NSNull.null];
+  }
+}
+
+@end
+
 @interface FBDeviceFileContainer ()
 
 @property (nonatomic, strong, readonly) dispatch_queue_t queue;
 @property (nonatomic, strong, readonly) FBAFCConnection *connection;
+@property (nonatomic, strong, nullable, readonly) FBAFCDirectoryTransfer *directoryTransfer;
+@property (nonatomic, strong, nullable, readonly) NSMutableDictionary<NSString *, NSNumber *> *tailOffsets;
 
 @end
 
 @implementation FBDeviceFileContainer
 
 - (instancetype)initWithAFCConnection:(FBAFCConnection *)connection queue:(dispatch_queue_t)queue
+{
+  return [self initWithAFCConnection:connection directoryTransfer:nil queue:queue];
+}
+
+- (instancetype)initWithAFCConnection:(FBAFCConnection *)connection directoryTransfer:(nullable FBAFCDirectoryTransfer *)directoryTransfer queue:(dispatch_queue_t)queue
+{
+  return [self initWithAFCConnection:connection directoryTransfer:directoryTransfer tailOffsets:nil queue:queue];
+}
+
+- (instancetype)initWithAFCConnection:(FBAFCConnection *)connection directoryTransfer:(nullable FBAFCDirectoryTransfer *)directoryTransfer tailOffsets:(nullable NSMutableDictionary<NSString *, NSNumber *> *)tailOffsets queue:(dispatch_queue_t)queue
 {
   self = [super init];
   if (!self) {
@@ -33,6 +185,8 @@
   }
 
   _connection = connection;
+  _directoryTransfer = directoryTransfer;
+  _tailOffsets = tailOffsets;
   _queue = queue;
 
   return self;
@@ -40,6 +194,16 @@
 
 - (FBFuture<NSNull *> *)copyFromHost:(NSString *)sourcePath toContainer:(NSString *)destinationPath
 {
+  FBAFCDirectoryTransfer *directoryTransfer = self.directoryTransfer;
+  if (directoryTransfer && [FBDeviceFileContainer isDirectory:sourcePath]) {
+    return [self handleAFCOperation:^ NSNull * (FBAFCConnection *afc, NSError **error) {
+      NSArray<NSString *> *copied = [directoryTransfer copyFromHost:sourcePath toContainerPath:destinationPath connection:afc manifestPath:nil error:error];
+      if (!copied) {
+        return nil;
+      }
+      return NSNull.null;
+    }];
+  }
   return [self handleAFCOperation:^ NSNull * (FBAFCConnection *afc, NSError **error) {
     BOOL success = [afc copyFromHost:sourcePath toContainerPath:destinationPath error:error];
     if (!success) {
@@ -55,25 +219,28 @@
   if ([FBDeviceFileContainer isDirectory:destinationPath]){
     destination = [destinationPath stringByAppendingPathComponent:sourcePath.lastPathComponent];
   }
-  return [[self
-    readFileFromPathInContainer:sourcePath]
-    onQueue:self.queue fmap:^FBFuture<NSString *> *(NSData *fileData) {
-     NSError *error;
-     if (![fileData writeToFile:destination options:0 error:&error]) {
-       return [[[FBDeviceControlError
-        describeFormat:@"Failed to write data to file at path %@", destination]
-        causedBy:error]
-        failFuture];
-     }
-     return [FBFuture futureWithResult:destination];
-   }];
+  return [self handleAFCOperation:^ NSString * (FBAFCConnection *afc, NSError **error) {
+    // Stream the file to the destination, so that the file is never held in memory in its entirety.
+    int fileDescriptor = open(destination.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fileDescriptor == -1) {
+      return [[FBDeviceControlError
+        describeFormat:@"Failed to open file at path %@ for writing: %s", destination, strerror(errno)]
+        fail:error];
+    }
+    BOOL success = [afc readContentsOfPath:sourcePath toFileDescriptor:fileDescriptor error:error];
+    close(fileDescriptor);
+    if (!success) {
+      [NSFileManager.defaultManager removeItemAtPath:destination error:nil];
+      return nil;
+    }
+    return destination;
+  }];
 }
 
 - (FBFuture<FBFuture<NSNull *> *> *)tail:(NSString *)path toConsumer:(id<FBDataConsumer>)consumer
 {
-  return [[FBControlCoreError
-    describeFormat:@"-[%@ %@] is not implemented", NSStringFromClass(self.class), NSStringFromSelector(_cmd)]
-    failFuture];
+  FBDeviceFileContainer_Tail *tail = [[FBDeviceFileContainer_Tail alloc] initWithConnection:self.connection path:path consumer:consumer offsets:self.tailOffsets];
+  return [FBFuture futureWithResult:[tail start]];
 }
 
 - (FBFuture<NSNull *> *)createDirectory:(NSString *)directoryPath
@@ -118,13 +285,6 @@
 
 #pragma mark Private
 
-- (FBFuture<NSData *> *)readFileFromPathInContainer:(NSString *)path
-{
-  return [self handleAFCOperation:^ NSData * (FBAFCConnection *afc, NSError **error) {
-    return [afc contentsOfPath:path error:error];
-  }];
-}
-
 - (FBFuture *)handleAFCOperation:(id(^)(FBAFCConnection *, NSError **))operationBlock
 {
   return [FBFuture
@@ -368,7 +528,7 @@ static NSString *const MountRootPath = @"mounted";
   FBDeveloperDiskImage *image = mountableImagesByPath[sourcePath];
   if (!image) {
     return [[FBControlCoreError
-      describeFormat:@"%@ is not one of %@", sourcePath, [FBCollectionInformation oneLineDescriptionFromArray:mountableImagesByPath.allKeys]]
+      describeFormat:@"%@ is not one of %@", sourcePath, [FBCollectionInformation lazyOneLineDescriptionFromArray:mountableImagesByPath.allKeys]]
       failFuture];
   }
   return [[self.commands
@@ -389,7 +549,7 @@ static NSString *const MountRootPath = @"mounted";
       FBDeveloperDiskImage *image = mountedImages[path];
       if (!image) {
         return [[FBDeviceControlError
-          describeFormat:@"%@ is not one of the available mounts %@", path, [FBCollectionInformation oneLineDescriptionFromArray:mountedImages.allKeys]]
+          describeFormat:@"%@ is not one of the available mounts %@", path, [FBCollectionInformation lazyOneLineDescriptionFromArray:mountedImages.allKeys]]
           failFuture];
       }
       return [self.commands unmountDiskImage:image];
@@ -562,9 +722,13 @@ static NSString *const ExtractedSymbolsDirectory = @"Symbols";
 
 @property (nonatomic, strong, readonly) FBDevice *device;
 @property (nonatomic, assign, readonly) AFCCalls afcCalls;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSNumber *> *> *tailOffsetsByContainer;
 
 @end
 
+// The number of connections that a directory is copied over.
+static const NSUInteger DirectoryTransferConcurrency = 4;
+
 @implementation FBDeviceFileCommands
 
 #pragma mark Initializers
@@ -588,6 +752,7 @@ static NSString *const ExtractedSymbolsDirectory = @"Symbols";
 
   _device = device;
   _afcCalls = afcCalls;
+  _tailOffsetsByContainer = [NSMutableDictionary dictionary];
 
   return self;
 }
@@ -599,7 +764,14 @@ static NSString *const ExtractedSymbolsDirectory = @"Symbols";
   return [[self.device
     houseArrestAFCConnectionForBundleID:bundleID afcCalls:self.afcCalls]
     onQueue:self.device.asyncQueue pend:^ FBFuture<id<FBFileContainer>> * (FBAFCConnection *connection) {
-      return [FBFuture futureWithResult:[[FBDeviceFileContainer alloc] initWithAFCConnection:connection queue:self.device.asyncQueue]];
+      // Additional connections come from the same pool of house_arrest connections.
+      FBAFCDirectoryTransfer *directoryTransfer = [FBAFCDirectoryTransfer
+        transferWithConnectionProvider:^{
+          return [self.device houseArrestAFCConnectionForBundleID:bundleID afcCalls:self.afcCalls];
+        }
+        concurrency:DirectoryTransferConcurrency
+        logger:self.device.logger];
+      return [FBFuture futureWithResult:[[FBDeviceFileContainer alloc] initWithAFCConnection:connection directoryTransfer:directoryTransfer tailOffsets:[self tailOffsetsForContainer:bundleID] queue:self.device.asyncQueue]];
     }];
 }
 
@@ -634,7 +806,13 @@ static NSString *const ExtractedSymbolsDirectory = @"Symbols";
   return [[self.device
     startAFCService:@"com.apple.afc"]
     onQueue:self.device.asyncQueue pend:^ FBFuture<id<FBFileContainer>> * (FBAFCConnection *connection) {
-      return [FBFuture futureWithResult:[[FBDeviceFileContainer alloc] initWithAFCConnection:connection queue:self.device.asyncQueue]];
+      FBAFCDirectoryTransfer *directoryTransfer = [FBAFCDirectoryTransfer
+        transferWithConnectionProvider:^{
+          return [self.device startAFCService:@"com.apple.afc"];
+        }
+        concurrency:DirectoryTransferConcurrency
+        logger:self.device.logger];
+      return [FBFuture futureWithResult:[[FBDeviceFileContainer alloc] initWithAFCConnection:connection directoryTransfer:directoryTransfer tailOffsets:[self tailOffsetsForContainer:@"com.apple.afc"] queue:self.device.asyncQueue]];
     }];
 }
 
@@ -686,4 +864,19 @@ static NSString *const ExtractedSymbolsDirectory = @"Symbols";
   return [FBFutureContext futureContextWithResult:[[FBDeviceFileCommands_Symbols alloc] initWithCommands:self.device queue:self.device.asyncQueue]];
 }
 
+#pragma mark Private
+
+- (NSMutableDictionary<NSString *, NSNumber *> *)tailOffsetsForContainer:(NSString *)container
+{
+  // Offsets outlive the connection that a container is backed by, so that a tail on a new connection resumes where the last one ended.
+  @synchronized (self.tailOffsetsByContainer) {
+    NSMutableDictionary<NSString *, NSNumber *> *offsets = self.tailOffsetsByContainer[container];
+    if (!offsets) {
+      offsets = [NSMutableDictionary dictionary];
+      self.tailOffsetsByContainer[container] = offsets;
+    }
+    return offsets;
+  }
+}
+
 @end
@@ -12,6 +12,7 @@
 #import "FBDeviceControlError.h"
 #import "FBAMDServiceConnection.h"
 #import "FBAFCConnection.h"
+#import "FBDeviceLocationSimulationSession.h"
 
 @interface FBDeviceLocationCommands ()
 
@@ -40,34 +41,29 @@
   return self;
 }
 
-#pragma mark FBDeviceLocationCommands
-
-static const int StartCommand = 0x0000000;
+#pragma mark FBLocationCommands Implementation
 
 - (FBFuture<NSNull *> *)overrideLocationWithLongitude:(double)longitude latitude:(double)latitude
 {
+  return [[self
+    locationSimulationSession]
+    onQueue:self.device.workQueue pop:^(FBDeviceLocationSimulationSession *session) {
+      return [session overrideLocationWithLatitude:latitude longitude:longitude];
+    }];
+}
+
+#pragma mark Public Methods
+
+- (FBFutureContext<FBDeviceLocationSimulationSession *> *)locationSimulationSession
+{
+  id<FBControlCoreLogger> logger = self.device.logger;
   return [[[self.device
     ensureDeveloperDiskImageIsMounted]
     onQueue:self.device.workQueue pushTeardown:^(id _) {
       return [self.device startService:@"com.apple.dt.simulatelocation"];
     }]
-    onQueue:self.device.workQueue pop:^ FBFuture<NSNull *> * (FBAMDServiceConnection *connection) {
-      NSData *start = [[NSData alloc] initWithBytes:&StartCommand length:sizeof(StartCommand)];
-      NSError *error = nil;
-      if (![connection send:start error:&error]) {
-        return [FBFuture futureWithError:error];
-      }
-      NSString *value = [NSString stringWithFormat:@"%f", latitude];
-      NSData *data = [[NSData alloc] initWithBytes:value.UTF8String length:strlen(value.UTF8String)];
-      if (![connection sendWithLengthHeader:data error:&error]) {
-        return [FBFuture futureWithError:error];
-      }
-      value = [NSString stringWithFormat:@"%f", longitude];
-      data = [[NSData alloc] initWithBytes:value.UTF8String length:strlen(value.UTF8String)];
-      if (![connection sendWithLengthHeader:data error:&error]) {
-        return [FBFuture futureWithError:error];
-      }
-      return FBFuture.empty;
+    onQueue:self.device.workQueue pend:^(FBAMDServiceConnection *connection) {
+      return [FBFuture futureWithResult:[FBDeviceLocationSimulationSession sessionWithConnection:connection logger:logger]];
     }];
 }
 
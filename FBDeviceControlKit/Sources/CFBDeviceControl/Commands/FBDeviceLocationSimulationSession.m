@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBDeviceLocationSimulationSession.h"
+
+#import "FBAMDServiceConnection.h"
+#import "FBDeviceControlError.h"
+
+static const uint32_t StartCommand = 0;
+static const uint32_t StopCommand = 1;
+
+// The interval between GPX points that have no time of their own.
+static const NSTimeInterval UntimedPointInterval = 1;
+
+#pragma mark - GPX Parsing
+
+@interface FBDeviceLocationSimulationSession_GPXParser : NSObject <NSXMLParserDelegate>
+
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSMutableArray<NSDictionary<NSString *, id> *> *> *pointsByElement;
+@property (nonatomic, strong, nullable, readwrite) NSMutableDictionary<NSString *, id> *currentPoint;
+@property (nonatomic, strong, nullable, readwrite) NSMutableString *currentTime;
+
+@end
+
+@implementation FBDeviceLocationSimulationSession_GPXParser
+
+- (instancetype)init
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _pointsByElement = [NSMutableDictionary dictionary];
+
+  return self;
+}
+
++ (NSArray<NSString *> *)pointElements
+{
+  // In order of preference, a track is a recording of the path taken, whereas route points and waypoints are sparser.
+  return @[@"trkpt", @"rtept", @"wpt"];
+}
+
+- (void)parser:(NSXMLParser *)parser didStartElement:(NSString *)elementName namespaceURI:(nullable NSString *)namespaceURI qualifiedName:(nullable NSString *)qName attributes:(NSDictionary<NSString *, NSString *> *)attributes
+{
+  if ([FBDeviceLocationSimulationSession_GPXParser.pointElements containsObject:elementName]) {
+    NSString *latitude = attributes[@"lat"];
+    NSString *longitude = attributes[@"lon"];
+    if (!latitude || !longitude) {
+      return;
+    }
+    self.currentPoint = [NSMutableDictionary dictionaryWithDictionary:@{
+      @"element": elementName,
+      @"lat": @(latitude.doubleValue),
+      @"lon": @(longitude.doubleValue),
+    }];
+    return;
+  }
+  if (self.currentPoint && [elementName isEqualToString:@"time"]) {
+    self.currentTime = [NSMutableString string];
+  }
+}
+
+- (void)parser:(NSXMLParser *)parser foundCharacters:(NSString *)string
+{
+  [self.currentTime appendString:string];
+}
+
+- (void)parser:(NSXMLParser *)parser didEndElement:(NSString *)elementName namespaceURI:(nullable NSString *)namespaceURI qualifiedName:(nullable NSString *)qName
+{
+  if (self.currentTime && [elementName isEqualToString:@"time"]) {
+    NSDate *date = [FBDeviceLocationSimulationSession_GPXParser dateFromString:self.currentTime];
+    if (date) {
+      self.currentPoint[@"time"] = date;
+    }
+    self.currentTime = nil;
+    return;
+  }
+  NSMutableDictionary<NSString *, id> *point = self.currentPoint;
+  if (point && [point[@"element"] isEqualToString:elementName]) {
+    NSMutableArray<NSDictionary<NSString *, id> *> *points = self.pointsByElement[elementName];
+    if (!points) {
+      points = [NSMutableArray array];
+      self.pointsByElement[elementName] = points;
+    }
+    [points addObject:point];
+    self.currentPoint = nil;
+  }
+}
+
+- (NSArray<FBLocationRoutePoint *> *)routePoints
+{
+  NSArray<NSDictionary<NSString *, id> *> *points = nil;
+  for (NSString *element in FBDeviceLocationSimulationSession_GPXParser.pointElements) {
+    points = self.pointsByElement[element];
+    if (points.count > 0) {
+      break;
+    }
+  }
+  NSMutableArray<FBLocationRoutePoint *> *routePoints = [NSMutableArray arrayWithCapacity:points.count];
+  NSDate *startTime = nil;
+  NSTimeInterval offset = 0;
+  for (NSDictionary<NSString *, id> *point in points) {
+    NSDate *time = point[@"time"];
+    if (time && !startTime) {
+      // Untimed points before the first timed one keep their spacing ahead of it.
+      startTime = [time dateByAddingTimeInterval:-offset];
+    }
+    if (time) {
+      // Out of order times are clamped, so that the route never goes backwards.
+      offset = MAX(offset, [time timeIntervalSinceDate:startTime]);
+    } else if (routePoints.count > 0) {
+      offset += UntimedPointInterval;
+    }
+    [routePoints addObject:[FBLocationRoutePoint pointWithLatitude:[point[@"lat"] doubleValue] longitude:[point[@"lon"] doubleValue] offset:offset]];
+  }
+  return routePoints;
+}
+
++ (nullable NSDate *)dateFromString:(NSString *)string
+{
+  static NSISO8601DateFormatter *formatter;
+  static NSISO8601DateFormatter *fractionalFormatter;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    formatter = [NSISO8601DateFormatter new];
+    fractionalFormatter = [NSISO8601DateFormatter new];
+    fractionalFormatter.formatOptions = NSISO8601DateFormatWithInternetDateTime | NSISO8601DateFormatWithFractionalSeconds;
+  });
+  NSString *trimmed = [string stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceAndNewlineCharacterSet];
+  return [formatter dateFromString:trimmed] ?: [fractionalFormatter dateFromString:trimmed];
+}
+
+@end
+
+#pragma mark - FBLocationRoutePoint
+
+@implementation FBLocationRoutePoint
+
+#pragma mark Initializers
+
++ (instancetype)pointWithLatitude:(double)latitude longitude:(double)longitude offset:(NSTimeInterval)offset
+{
+  return [[self alloc] initWithLatitude:latitude longitude:longitude offset:offset];
+}
+
+- (instancetype)initWithLatitude:(double)latitude longitude:(double)longitude offset:(NSTimeInterval)offset
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _latitude = latitude;
+  _longitude = longitude;
+  _offset = offset;
+
+  return self;
+}
+
++ (nullable NSArray<FBLocationRoutePoint *> *)routePointsFromGPXData:(NSData *)data error:(NSError **)error
+{
+  NSXMLParser *parser = [[NSXMLParser alloc] initWithData:data];
+  FBDeviceLocationSimulationSession_GPXParser *delegate = [FBDeviceLocationSimulationSession_GPXParser new];
+  parser.delegate = delegate;
+  if (![parser parse]) {
+    return [[FBDeviceControlError
+      describeFormat:@"Failed to parse GPX %@", parser.parserError]
+      fail:error];
+  }
+  NSArray<FBLocationRoutePoint *> *points = delegate.routePoints;
+  if (points.count == 0) {
+    return [[FBDeviceControlError
+      describe:@"GPX contains no track points, route points or waypoints"]
+      fail:error];
+  }
+  return points;
+}
+
+#pragma mark NSCopying
+
+- (instancetype)copyWithZone:(NSZone *)zone
+{
+  return self;
+}
+
+#pragma mark NSObject
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"%f,%f at %.3fs", self.latitude, self.longitude, self.offset];
+}
+
+@end
+
+#pragma mark - FBDeviceLocationSimulationSession
+
+@interface FBDeviceLocationSimulationSession ()
+
+@property (nonatomic, strong, readonly) FBAMDServiceConnection *connection;
+@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+
+// The current playback and the timer that drives it, only accessed on the queue.
+@property (nonatomic, strong, nullable, readwrite) FBMutableFuture<NSNull *> *playback;
+@property (nonatomic, strong, nullable, readwrite) dispatch_source_t playbackTimer;
+
+@end
+
+@implementation FBDeviceLocationSimulationSession
+
+#pragma mark Initializers
+
++ (instancetype)sessionWithConnection:(FBAMDServiceConnection *)connection logger:(id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithConnection:connection logger:logger];
+}
+
+- (instancetype)initWithConnection:(FBAMDServiceConnection *)connection logger:(id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _connection = connection;
+  _logger = logger;
+  _queue = dispatch_queue_create("com.facebook.fbdevicecontrol.location_simulation_session", DISPATCH_QUEUE_SERIAL);
+
+  return self;
+}
+
+- (void)dealloc
+{
+  if (_playbackTimer) {
+    dispatch_source_cancel(_playbackTimer);
+  }
+}
+
+#pragma mark Public Methods
+
+- (FBFuture<NSNull *> *)overrideLocationWithLatitude:(double)latitude longitude:(double)longitude
+{
+  return [FBFuture
+    onQueue:self.queue resolveValue:^ NSNull * (NSError **error) {
+      [self stopPlaybackWithError:nil];
+      if (![self sendLatitude:latitude longitude:longitude error:error]) {
+        return nil;
+      }
+      return NSNull.null;
+    }];
+}
+
+- (FBFuture<NSNull *> *)clearLocation
+{
+  return [FBFuture
+    onQueue:self.queue resolveValue:^ NSNull * (NSError **error) {
+      [self stopPlaybackWithError:nil];
+      if (![self.connection sendUnsignedInt32:OSSwapHostToBigInt32(StopCommand) error:error]) {
+        return nil;
+      }
+      return NSNull.null;
+    }];
+}
+
+- (FBFuture<NSNull *> *)playRoute:(NSArray<FBLocationRoutePoint *> *)route frequency:(double)frequency
+{
+  if (route.count == 0) {
+    return [[FBDeviceControlError
+      describe:@"Cannot play a route without any points"]
+      failFuture];
+  }
+  if (frequency <= 0) {
+    return [[FBDeviceControlError
+      describeFormat:@"Cannot play a route at a frequency of %f", frequency]
+      failFuture];
+  }
+  FBMutableFuture<NSNull *> *playback = FBMutableFuture.future;
+  NSArray<FBLocationRoutePoint *> *points = [route copy];
+  dispatch_async(self.queue, ^{
+    [self stopPlaybackWithError:nil];
+    [self startPlayback:playback route:points frequency:frequency];
+  });
+  return [playback
+    onQueue:self.queue respondToCancellation:^{
+      if (self.playback == playback) {
+        [self stopPlaybackWithError:nil];
+      }
+      return FBFuture.empty;
+    }];
+}
+
+#pragma mark Private
+
+- (BOOL)sendLatitude:(double)latitude longitude:(double)longitude error:(NSError **)error
+{
+  // The command and both length-prefixed coordinates are sent in a single write, rather than a write for each.
+  NSMutableData *data = [NSMutableData dataWithCapacity:64];
+  uint32_t command = OSSwapHostToBigInt32(StartCommand);
+  [data appendBytes:&command length:sizeof(command)];
+  for (NSString *value in @[[NSString stringWithFormat:@"%f", latitude], [NSString stringWithFormat:@"%f", longitude]]) {
+    const char *string = value.UTF8String;
+    uint32_t length = OSSwapHostToBigInt32((uint32_t) strlen(string));
+    [data appendBytes:&length length:sizeof(length)];
+    [data appendBytes:string length:strlen(string)];
+  }
+  return [self.connection send:data error:error];
+}
+
+- (void)startPlayback:(FBMutableFuture<NSNull *> *)playback route:(NSArray<FBLocationRoutePoint *> *)route frequency:(double)frequency
+{
+  if (playback.hasCompleted) {
+    return;
+  }
+  [self.logger logFormat:@"Playing route of %lu points over %.1fs at %.1f Hz", (unsigned long) route.count, route.lastObject.offset, frequency];
+
+  uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  uint64_t interval = (uint64_t) (NSEC_PER_SEC / frequency);
+  __block NSUInteger segment = 0;
+  __weak typeof(self) weakSelf = self;
+  dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.queue);
+  dispatch_source_set_timer(timer, DISPATCH_TIME_NOW, interval, interval / 10);
+  dispatch_source_set_event_handler(timer, ^{
+    FBDeviceLocationSimulationSession *session = weakSelf;
+    if (!session) {
+      return;
+    }
+    // Positions are derived from the elapsed time rather than the number of ticks, so a late tick doesn't slow the route down.
+    NSTimeInterval elapsed = (clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - startTime) / (double) NSEC_PER_SEC;
+    while (segment + 1 < route.count && route[segment + 1].offset <= elapsed) {
+      segment++;
+    }
+    FBLocationRoutePoint *from = route[segment];
+    BOOL finished = segment + 1 >= route.count;
+    double latitude = from.latitude;
+    double longitude = from.longitude;
+    if (!finished) {
+      FBLocationRoutePoint *to = route[segment + 1];
+      double fraction = MIN(MAX((elapsed - from.offset) / (to.offset - from.offset), 0), 1);
+      // Interpolate across the antimeridian the short way round.
+      double longitudeDelta = to.longitude - from.longitude;
+      if (longitudeDelta > 180) {
+        longitudeDelta -= 360;
+      } else if (longitudeDelta < -180) {
+        longitudeDelta += 360;
+      }
+      latitude += (to.latitude - from.latitude) * fraction;
+      longitude += longitudeDelta * fraction;
+      if (longitude > 180) {
+        longitude -= 360;
+      } else if (longitude < -180) {
+        longitude += 360;
+      }
+    }
+    NSError *error = nil;
+    if (![session sendLatitude:latitude longitude:longitude error:&error]) {
+      [session.logger logFormat:@"Stopping route playback %@", error];
+      [session stopPlaybackWithError:error];
+      return;
+    }
+    if (finished) {
+      [session.logger log:@"Finished route playback"];
+      [session stopPlaybackWithError:nil];
+    }
+  });
+  self.playback = playback;
+  self.playbackTimer = timer;
+  dispatch_resume(timer);
+}
+
+- (void)stopPlaybackWithError:(nullable NSError *)error
+{
+  if (self.playbackTimer) {
+    dispatch_source_cancel(self.playbackTimer);
+    self.playbackTimer = nil;
+  }
+  FBMutableFuture<NSNull *> *playback = self.playback;
+  self.playback = nil;
+  if (!playback || playback.hasCompleted) {
+    return;
+  }
+  if (error) {
+    [playback resolveWithError:error];
+  } else {
+    [playback resolveWithResult:NSNull.null];
+  }
+}
+
+@end
@@ -98,4 +98,22 @@
     }];
 }
 
+#pragma mark Public Methods
+
+- (FBFuture<id<FBLogOperation>> *)tailLogEntriesMatching:(FBDeviceLogPredicate *)predicate onQueue:(dispatch_queue_t)queue handler:(void (^)(FBDeviceLogEntry *entry))handler
+{
+  // Lines are parsed on the serial read queue, from spans of the bytes that are read, so only matching entries are materialized.
+  FBDeviceLogEntryParser *parser = [[FBDeviceLogEntryParser alloc] initWithPredicate:predicate];
+  id<FBDataConsumer> consumer = [FBBlockDataConsumer synchronousLineSpanConsumerWithBlock:^(const char *bytes, size_t length) {
+    FBDeviceLogEntry *entry = [parser entryForLineBytes:bytes length:length];
+    if (!entry) {
+      return;
+    }
+    dispatch_async(queue, ^{
+      handler(entry);
+    });
+  }];
+  return [self tailLog:@[] consumer:consumer];
+}
+
 @end
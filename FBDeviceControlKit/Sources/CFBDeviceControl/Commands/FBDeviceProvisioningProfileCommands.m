@@ -7,8 +7,51 @@
 
 #import "FBDeviceProvisioningProfileCommands.h"
 
+#import <CommonCrypto/CommonDigest.h>
+
 #import "FBDevice.h"
 
+// The listing of a device's profiles is reused for this long. Changes made through these commands update it, so it only goes stale if profiles are changed elsewhere.
+static const NSTimeInterval ProfileListingCacheTimeout = 60;
+
+static NSString *DigestOfProfileData(NSData *data)
+{
+  unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+  CC_SHA256(data.bytes, (CC_LONG) data.length, digest);
+  NSMutableString *string = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+  for (NSUInteger index = 0; index < CC_SHA256_DIGEST_LENGTH; index++) {
+    [string appendFormat:@"%02x", digest[index]];
+  }
+  return [string copy];
+}
+
+/**
+ The decoded profiles on a device, in the order the device lists them.
+ */
+@interface FBDeviceProvisioningProfileCommands_Listing : NSObject
+
+@property (nonatomic, copy, readonly) NSArray<NSDictionary<NSString *, id> *> *payloads;
+@property (nonatomic, strong, readonly) NSDate *expiry;
+
+@end
+
+@implementation FBDeviceProvisioningProfileCommands_Listing
+
+- (instancetype)initWithPayloads:(NSArray<NSDictionary<NSString *, id> *> *)payloads
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _payloads = [payloads copy];
+  _expiry = [NSDate dateWithTimeIntervalSinceNow:ProfileListingCacheTimeout];
+
+  return self;
+}
+
+@end
+
 @interface FBDeviceProvisioningProfileCommands ()
 
 @property (nonatomic, weak, readonly) FBDevice *device;
@@ -40,6 +83,12 @@
 
 - (FBFuture<NSArray<NSDictionary<NSString *, id> *> *> *)allProvisioningProfiles
 {
+  FBDeviceProvisioningProfileCommands_Listing *listing = [FBDeviceProvisioningProfileCommands listingForDevice:self.device.udid];
+  if (listing) {
+    return [FBFuture futureWithResult:listing.payloads];
+  }
+  NSCache<NSString *, NSDictionary<NSString *, id> *> *payloadsByUUID = FBDeviceProvisioningProfileCommands.payloadsByUUID;
+  NSString *udid = self.device.udid;
   return [[self
     listProvisioningProfiles]
     onQueue:self.device.workQueue pop:^(NSArray<id> *merged) {
@@ -47,16 +96,29 @@
       NSArray<id> *profiles = [merged subarrayWithRange:NSMakeRange(1, merged.count - 1)];
       NSMutableArray<NSDictionary<NSString *, id> *> *allProfiles = NSMutableArray.array;
       for (id profile in profiles) {
-        NSDictionary<NSString *, id> *payload = CFBridgingRelease(device.calls.ProvisioningProfileCopyPayload((__bridge CFTypeRef)(profile)));
-        payload = [FBCollectionOperations recursiveFilteredJSONSerializableRepresentationOfDictionary:payload];
+        // A profile's UUID changes whenever its contents do, so a payload decoded for one device is valid for all of them.
+        NSString *uuid = (__bridge NSString *) device.calls.ProvisioningProfileGetUUID((__bridge MISProfileRef) profile);
+        NSDictionary<NSString *, id> *payload = uuid ? [payloadsByUUID objectForKey:uuid] : nil;
+        if (!payload) {
+          payload = CFBridgingRelease(device.calls.ProvisioningProfileCopyPayload((__bridge CFTypeRef)(profile)));
+          payload = [FBCollectionOperations recursiveFilteredJSONSerializableRepresentationOfDictionary:payload];
+          if (!payload) {
+            continue;
+          }
+          if (uuid) {
+            [payloadsByUUID setObject:payload forKey:uuid];
+          }
+        }
         [allProfiles addObject:payload];
       }
+      [FBDeviceProvisioningProfileCommands setListing:[[FBDeviceProvisioningProfileCommands_Listing alloc] initWithPayloads:allProfiles] forDevice:udid];
       return [FBFuture futureWithResult:allProfiles];
     }];
 }
 
 - (FBFuture<NSDictionary<NSString *, id> *> *)removeProvisioningProfile:(NSString *)uuid
 {
+  NSString *udid = self.device.udid;
   return [[self.device
     connectToDeviceWithPurpose:@"remove_provisioning_profile"]
     onQueue:self.device.workQueue pop:^(id<FBDeviceCommands> device) {
@@ -67,12 +129,34 @@
           describeFormat:@"Failed to remove profile %@: %@", uuid, errorDescription]
           failFuture];
       }
+      [FBDeviceProvisioningProfileCommands updateListingForDevice:udid removingUUID:uuid addingPayload:nil];
       return [FBFuture futureWithResult:@{}];
     }];
 }
 
 - (FBFuture<NSDictionary<NSString *, id> *> *)installProvisioningProfile:(NSData *)profileData
 {
+  NSString *digest = DigestOfProfileData(profileData);
+  return [[self
+    allProvisioningProfiles]
+    onQueue:self.device.workQueue fmap:^(NSArray<NSDictionary<NSString *, id> *> *installed) {
+      // Profiles that have been decoded before are matched against the device without connecting again.
+      NSString *uuid = [FBDeviceProvisioningProfileCommands.uuidsByDigest objectForKey:digest];
+      NSDictionary<NSString *, id> *existing = uuid ? [FBDeviceProvisioningProfileCommands payloadWithUUID:uuid in:installed] : nil;
+      if (existing) {
+        [self.device.logger logFormat:@"Provisioning profile %@ is already installed", uuid];
+        return [FBFuture futureWithResult:existing];
+      }
+      return [self transferProvisioningProfile:profileData digest:digest installed:installed];
+    }];
+}
+
+#pragma mark Private
+
+- (FBFuture<NSDictionary<NSString *, id> *> *)transferProvisioningProfile:(NSData *)profileData digest:(NSString *)digest installed:(NSArray<NSDictionary<NSString *, id> *> *)installed
+{
+  NSString *udid = self.device.udid;
+  id<FBControlCoreLogger> logger = self.device.logger;
   return [[self.device
     connectToDeviceWithPurpose:@"install_provisioning_profile"]
     onQueue:self.device.workQueue pop:^(id<FBDeviceCommands> device) {
@@ -82,26 +166,43 @@
           describeFormat:@"Could not construct profile from data %@", profileData]
           failFuture];
       }
+      NSString *uuid = (__bridge NSString *) device.calls.ProvisioningProfileGetUUID(profile);
+      if (uuid) {
+        [FBDeviceProvisioningProfileCommands.uuidsByDigest setObject:uuid forKey:digest];
+        NSDictionary<NSString *, id> *existing = [FBDeviceProvisioningProfileCommands payloadWithUUID:uuid in:installed];
+        if (existing) {
+          CFRelease(profile);
+          [logger logFormat:@"Provisioning profile %@ is already installed", uuid];
+          return [FBFuture futureWithResult:existing];
+        }
+      }
       int status = device.calls.InstallProvisioningProfile(device.amDeviceRef, profile);
       if (status != 0) {
         NSString *errorDescription = CFBridgingRelease(device.calls.ProvisioningProfileCopyErrorStringForCode(status));
-        return [[FBControlCoreError
+        FBFuture<NSDictionary<NSString *, id> *> *failure = [[FBControlCoreError
           describeFormat:@"Failed to install profile %@: %@", profile, errorDescription]
           failFuture];
+        CFRelease(profile);
+        return failure;
       }
       NSDictionary<NSString *, id> *payload = CFBridgingRelease(device.calls.ProvisioningProfileCopyPayload(profile));
       payload = [FBCollectionOperations recursiveFilteredJSONSerializableRepresentationOfDictionary:payload];
       if (!payload) {
-        return [[FBControlCoreError
+        FBFuture<NSDictionary<NSString *, id> *> *failure = [[FBControlCoreError
           describeFormat:@"Failed to get payload of %@", profile]
           failFuture];
+        CFRelease(profile);
+        return failure;
       }
+      if (uuid) {
+        [FBDeviceProvisioningProfileCommands.payloadsByUUID setObject:payload forKey:uuid];
+        [FBDeviceProvisioningProfileCommands updateListingForDevice:udid removingUUID:uuid addingPayload:payload];
+      }
+      CFRelease(profile);
       return [FBFuture futureWithResult:payload];
     }];
 }
 
-#pragma mark Private
-
 - (FBFutureContext<NSArray<id> *> *)listProvisioningProfiles
 {
   return [[self.device
@@ -117,4 +218,90 @@
     }];
 }
 
++ (nullable NSDictionary<NSString *, id> *)payloadWithUUID:(NSString *)uuid in:(NSArray<NSDictionary<NSString *, id> *> *)payloads
+{
+  for (NSDictionary<NSString *, id> *payload in payloads) {
+    if ([payload[@"UUID"] isEqual:uuid]) {
+      return payload;
+    }
+  }
+  return nil;
+}
+
+#pragma mark Caches
+
++ (NSCache<NSString *, NSDictionary<NSString *, id> *> *)payloadsByUUID
+{
+  static NSCache<NSString *, NSDictionary<NSString *, id> *> *cache;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    cache = [[NSCache alloc] init];
+    cache.name = @"com.facebook.fbdevicecontrol.provisioning_profile_payloads";
+  });
+  return cache;
+}
+
++ (NSCache<NSString *, NSString *> *)uuidsByDigest
+{
+  static NSCache<NSString *, NSString *> *cache;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    cache = [[NSCache alloc] init];
+    cache.name = @"com.facebook.fbdevicecontrol.provisioning_profile_uuids";
+  });
+  return cache;
+}
+
++ (NSMutableDictionary<NSString *, FBDeviceProvisioningProfileCommands_Listing *> *)listingsByDevice
+{
+  static NSMutableDictionary<NSString *, FBDeviceProvisioningProfileCommands_Listing *> *listings;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    listings = [NSMutableDictionary dictionary];
+  });
+  return listings;
+}
+
++ (nullable FBDeviceProvisioningProfileCommands_Listing *)listingForDevice:(NSString *)udid
+{
+  NSMutableDictionary<NSString *, FBDeviceProvisioningProfileCommands_Listing *> *listings = self.listingsByDevice;
+  @synchronized (listings) {
+    FBDeviceProvisioningProfileCommands_Listing *listing = listings[udid];
+    if (listing && [listing.expiry compare:NSDate.date] != NSOrderedDescending) {
+      [listings removeObjectForKey:udid];
+      return nil;
+    }
+    return listing;
+  }
+}
+
++ (void)setListing:(FBDeviceProvisioningProfileCommands_Listing *)listing forDevice:(NSString *)udid
+{
+  NSMutableDictionary<NSString *, FBDeviceProvisioningProfileCommands_Listing *> *listings = self.listingsByDevice;
+  @synchronized (listings) {
+    listings[udid] = listing;
+  }
+}
+
++ (void)updateListingForDevice:(NSString *)udid removingUUID:(NSString *)uuid addingPayload:(nullable NSDictionary<NSString *, id> *)payload
+{
+  NSMutableDictionary<NSString *, FBDeviceProvisioningProfileCommands_Listing *> *listings = self.listingsByDevice;
+  @synchronized (listings) {
+    FBDeviceProvisioningProfileCommands_Listing *listing = listings[udid];
+    if (!listing) {
+      return;
+    }
+    NSMutableArray<NSDictionary<NSString *, id> *> *payloads = [NSMutableArray array];
+    for (NSDictionary<NSString *, id> *existing in listing.payloads) {
+      if (![existing[@"UUID"] isEqual:uuid]) {
+        [payloads addObject:existing];
+      }
+    }
+    if (payload) {
+      [payloads addObject:payload];
+    }
+    listings[udid] = [[FBDeviceProvisioningProfileCommands_Listing alloc] initWithPayloads:payloads];
+  }
+}
+
 @end
@@ -12,6 +12,7 @@
 #import "FBDevice.h"
 #import "FBDeviceControlError.h"
 #import "FBDeviceLinkClient.h"
+#import "FBDeviceScreenshotSession.h"
 
 @interface FBDeviceScreenshotCommands ()
 
@@ -62,4 +63,16 @@ static NSString *const ScreenShotDataKey = @"ScreenShotData";
     }];
 }
 
+#pragma mark Public Methods
+
+- (FBFutureContext<FBDeviceScreenshotSession *> *)screenshotSession
+{
+  id<FBControlCoreLogger> logger = self.device.logger;
+  return [[self.device
+    startDeviceLinkService:@"com.apple.mobile.screenshotr"]
+    onQueue:self.device.asyncQueue pend:^(FBDeviceLinkClient *client) {
+      return [FBFuture futureWithResult:[FBDeviceScreenshotSession sessionWithClient:client logger:logger]];
+    }];
+}
+
 @end
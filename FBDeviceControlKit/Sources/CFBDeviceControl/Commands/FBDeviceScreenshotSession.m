@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBDeviceScreenshotSession.h"
+
+#import <ImageIO/ImageIO.h>
+
+#import "FBDeviceControlError.h"
+#import "FBDeviceLinkClient.h"
+
+static NSString *const ScreenShotDataKey = @"ScreenShotData";
+
+@interface FBDeviceScreenshotSession ()
+
+@property (nonatomic, strong, readonly) FBDeviceLinkClient *client;
+@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) dispatch_queue_t decodeQueue;
+@property (nonatomic, assign, readwrite) BOOL decoding;
+
+@end
+
+@implementation FBDeviceScreenshotSession
+
+#pragma mark Initializers
+
++ (instancetype)sessionWithClient:(FBDeviceLinkClient *)client logger:(id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithClient:client logger:logger];
+}
+
+- (instancetype)initWithClient:(FBDeviceLinkClient *)client logger:(id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _client = client;
+  _logger = logger;
+  _queue = dispatch_queue_create("com.facebook.fbdevicecontrol.screenshot_session", DISPATCH_QUEUE_SERIAL);
+  _decodeQueue = dispatch_queue_create("com.facebook.fbdevicecontrol.screenshot_session.decode", DISPATCH_QUEUE_SERIAL);
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (FBFuture<NSData *> *)takeScreenshot
+{
+  return [[self.client
+    processMessage:@{@"MessageType": @"ScreenShotRequest"}]
+    onQueue:self.queue fmap:^(NSDictionary<id, id> *response) {
+      NSData *screenshotData = response[ScreenShotDataKey];
+      if (![screenshotData isKindOfClass:NSData.class]) {
+        return [[FBDeviceControlError
+          describeFormat:@"%@ is not an NSData for %@", screenshotData, ScreenShotDataKey]
+          failFuture];
+      }
+      return [FBFuture futureWithResult:screenshotData];
+    }];
+}
+
+- (FBFuture<id<FBiOSTargetOperation>> *)captureWithInterval:(NSTimeInterval)interval consumer:(id<FBDeviceScreenshotConsumer>)consumer
+{
+  FBMutableFuture<NSNull *> *completed = FBMutableFuture.future;
+  [completed onQueue:self.decodeQueue notifyOfCompletion:^(id _) {
+    [consumer consumeEndOfScreenshots];
+  }];
+  dispatch_async(self.queue, ^{
+    [self captureNextWithInterval:interval consumer:consumer completed:completed];
+  });
+  FBFuture<NSNull *> *operationCompleted = [completed
+    onQueue:self.queue respondToCancellation:^{
+      [completed resolveWithResult:NSNull.null];
+      return FBFuture.empty;
+    }];
+  return [FBFuture futureWithResult:FBiOSTargetOperationFromFuture(operationCompleted)];
+}
+
+#pragma mark Private
+
+- (void)captureNextWithInterval:(NSTimeInterval)interval consumer:(id<FBDeviceScreenshotConsumer>)consumer completed:(FBMutableFuture<NSNull *> *)completed
+{
+  if (completed.hasCompleted) {
+    return;
+  }
+  NSTimeInterval timestamp = NSDate.timeIntervalSinceReferenceDate;
+  [[self
+    takeScreenshot]
+    onQueue:self.queue notifyOfCompletion:^(FBFuture<NSData *> *future) {
+      if (completed.hasCompleted) {
+        return;
+      }
+      NSData *data = future.result;
+      if (!data) {
+        [self.logger logFormat:@"Stopping screenshot capture %@", future.error];
+        [completed resolveWithError:future.error];
+        return;
+      }
+      [self decodeScreenshotData:data timestamp:timestamp consumer:consumer];
+      // The next request is timed from the start of this one, so the interval holds when the device is quick to respond.
+      NSTimeInterval delay = MAX(0, interval - (NSDate.timeIntervalSinceReferenceDate - timestamp));
+      dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t) (delay * NSEC_PER_SEC)), self.queue, ^{
+        [self captureNextWithInterval:interval consumer:consumer completed:completed];
+      });
+    }];
+}
+
+- (void)decodeScreenshotData:(NSData *)data timestamp:(NSTimeInterval)timestamp consumer:(id<FBDeviceScreenshotConsumer>)consumer
+{
+  // A frame is dropped rather than queueing behind a slow decode, so that there is no backlog of stale screenshots.
+  if (self.decoding) {
+    return;
+  }
+  self.decoding = YES;
+  dispatch_async(self.decodeQueue, ^{
+    // ImageIO sniffs the format, screenshotr provides TIFF on older versions of iOS and PNG on newer ones.
+    CGImageSourceRef source = CGImageSourceCreateWithData((__bridge CFDataRef) data, NULL);
+    CGImageRef image = source ? CGImageSourceCreateImageAtIndex(source, 0, NULL) : NULL;
+    if (image) {
+      [consumer consumeScreenshot:image timestamp:timestamp];
+      CGImageRelease(image);
+    } else {
+      [self.logger logFormat:@"Failed to decode screenshot of %lu bytes", (unsigned long) data.length];
+    }
+    if (source) {
+      CFRelease(source);
+    }
+    dispatch_async(self.queue, ^{
+      self.decoding = NO;
+    });
+  });
+}
+
+@end
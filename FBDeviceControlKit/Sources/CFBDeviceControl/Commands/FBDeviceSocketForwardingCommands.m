@@ -9,6 +9,7 @@
 
 #import "FBDevice.h"
 #import "FBDeviceControlError.h"
+#import "FBDeviceSocketRelay.h"
 
 @interface FBDeviceSocketForwardingCommands ()
 
@@ -41,42 +42,19 @@
 
 - (FBFuture<NSNull *> *)drainLocalFileInput:(int)localFileDescriptorInput localFileOutput:(int)localFileDescriptorOutput remotePort:(int)remotePort
 {
-  NSError *error = nil;
-  id<FBDataConsumer> localConsumer = [FBFileWriter asyncWriterWithFileDescriptor:localFileDescriptorOutput closeOnEndOfFile:NO error:&error];
-  if (!localConsumer) {
-    return [FBFuture futureWithError:error];
-  }
+  id<FBControlCoreLogger> logger = self.device.logger;
   return [[self
-    consumerForRemotePort:remotePort writingTo:localConsumer]
-    onQueue:self.device.asyncQueue pop:^(id<FBDataConsumer> remoteConsumer) {
-      id<FBFileReader> reader = [FBFileReader readerWithFileDescriptor:localFileDescriptorInput closeOnEndOfFile:NO consumer:remoteConsumer logger:nil];
-      return [[reader
-        startReading]
-        onQueue:self.device.asyncQueue fmap:^(id _) {
-          return reader.finishedReading;
-        }];
+    localSocketFromRemotePort:remotePort]
+    onQueue:self.device.asyncQueue pop:^(NSNumber *remoteSocket) {
+      FBDeviceSocketRelay *relay = [FBDeviceSocketRelay relayWithLocalInput:localFileDescriptorInput localOutput:localFileDescriptorOutput remoteSocket:remoteSocket.intValue logger:logger];
+      return [[relay
+        start]
+        mapReplace:NSNull.null];
     }];
 }
 
 #pragma mark Private
 
-- (FBFutureContext<id<FBDataConsumer>> *)consumerForRemotePort:(int)remotePort writingTo:(id<FBDataConsumer>)consumer
-{
-  return [[self
-    localSocketFromRemotePort:remotePort]
-    onQueue:self.device.asyncQueue pend:^(NSNumber *remoteSocket) {
-      NSError *error = nil;
-      id<FBDataConsumer> writer = [FBFileWriter asyncWriterWithFileDescriptor:remoteSocket.intValue closeOnEndOfFile:NO error:&error];
-      if (!writer) {
-        return [FBFuture futureWithError:error];
-      }
-      id<FBFileReader> reader = [FBFileReader readerWithFileDescriptor:remoteSocket.intValue closeOnEndOfFile:NO consumer:consumer logger:nil];
-      return [[reader
-        startReading]
-        mapReplace:writer];
-    }];
-}
-
 - (FBFutureContext<NSNumber *> *)localSocketFromRemotePort:(int)remotePort
 {
   id<FBControlCoreLogger> logger = self.device.logger;
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBDeviceValueCommands.h"
+
+#import "FBDevice.h"
+#import "FBDeviceControlError.h"
+
+FBDeviceValueDomain const FBDeviceValueDomainBattery = @"com.apple.mobile.battery";
+FBDeviceValueDomain const FBDeviceValueDomainDeveloper = @"com.apple.xcode.developerdomain";
+FBDeviceValueDomain const FBDeviceValueDomainDiskUsage = @"com.apple.disk_usage";
+FBDeviceValueDomain const FBDeviceValueDomainMobileBackup = @"com.apple.mobile.backup";
+
+// Values such as the battery level change whilst the device is attached, so cached values are only re-used for a short time.
+static const NSTimeInterval CachedValueLifetime = 30.0;
+
+@interface FBDeviceValueCommands_Entry : NSObject
+
+@property (nonatomic, strong, readonly) FBFuture<id> *future;
+@property (nonatomic, strong, readonly) NSDate *date;
+
+@end
+
+@implementation FBDeviceValueCommands_Entry
+
+- (instancetype)initWithFuture:(FBFuture<id> *)future
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _future = future;
+  _date = NSDate.date;
+
+  return self;
+}
+
+@end
+
+@interface FBDeviceValueCommands ()
+
+@property (nonatomic, weak, readonly) FBDevice *device;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, FBDeviceValueCommands_Entry *> *cache;
+
+@end
+
+@implementation FBDeviceValueCommands
+
+#pragma mark Initializers
+
++ (instancetype)commandsWithTarget:(FBDevice *)target
+{
+  return [[self alloc] initWithDevice:target];
+}
+
+- (instancetype)initWithDevice:(FBDevice *)device
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _device = device;
+  _cache = NSMutableDictionary.dictionary;
+
+  return self;
+}
+
+#pragma mark FBDeviceValueCommands Implementation
+
+- (FBFuture<id> *)deviceValueForKey:(NSString *)key domain:(nullable FBDeviceValueDomain)domain
+{
+  if (!domain) {
+    id value = self.device.allValues[key];
+    if (value) {
+      return [FBFuture futureWithResult:value];
+    }
+  }
+  return [self cachedValueForKey:key domain:domain];
+}
+
+- (FBFuture<NSDictionary<NSString *, id> *> *)deviceValuesInDomain:(FBDeviceValueDomain)domain
+{
+  return [self cachedValueForKey:nil domain:domain];
+}
+
+- (void)invalidateCachedDeviceValues
+{
+  @synchronized (self.cache) {
+    [self.cache removeAllObjects];
+  }
+}
+
+#pragma mark Private
+
+- (FBFuture<id> *)cachedValueForKey:(nullable NSString *)key domain:(nullable FBDeviceValueDomain)domain
+{
+  NSString *cacheKey = [NSString stringWithFormat:@"%@/%@", domain ?: @"", key ?: @"*"];
+  @synchronized (self.cache) {
+    // Requests that arrive whilst a fetch is in flight share it, rather than each making a round-trip.
+    FBDeviceValueCommands_Entry *entry = self.cache[cacheKey];
+    if (entry && !entry.future.error && entry.future.state != FBFutureStateCancelled && -entry.date.timeIntervalSinceNow < CachedValueLifetime) {
+      return entry.future;
+    }
+    FBFuture<id> *future = [self fetchValueForKey:key domain:domain];
+    self.cache[cacheKey] = [[FBDeviceValueCommands_Entry alloc] initWithFuture:future];
+    return future;
+  }
+}
+
+- (FBFuture<id> *)fetchValueForKey:(nullable NSString *)key domain:(nullable FBDeviceValueDomain)domain
+{
+  return [[self.device
+    connectToDeviceWithPurpose:@"copy_value_%@_%@", domain ?: @"default", key ?: @"all"]
+    onQueue:self.device.asyncQueue pop:^ FBFuture<id> * (id<FBDeviceCommands> device) {
+      id value = CFBridgingRelease(device.calls.CopyValue(device.amDeviceRef, (__bridge CFStringRef) domain, (__bridge CFStringRef) key));
+      if (!value) {
+        return [[FBDeviceControlError
+          describeFormat:@"No value for %@ in domain %@", key ?: @"all keys", domain ?: @"default"]
+          failFuture];
+      }
+      return [FBFuture futureWithResult:value];
+    }];
+}
+
+@end
@@ -19,6 +19,8 @@
 
 @property (nonatomic, weak, readonly) FBDevice *device;
 @property (nonatomic, strong, nullable, readwrite) FBDeviceVideo *video;
+@property (nonatomic, strong, nullable, readwrite) id<FBVideoStream> replayStream;
+@property (nonatomic, strong, nullable, readwrite) FBVideoReplayBuffer *replayBuffer;
 
 @end
 
@@ -73,6 +75,63 @@
   return [video stopRecording];
 }
 
+#pragma mark Replay
+
+- (FBFuture<NSNull *> *)startReplayBufferWithWindow:(NSTimeInterval)window configuration:(FBVideoStreamConfiguration *)configuration
+{
+  if (self.replayBuffer) {
+    return [[FBDeviceControlError
+      describe:@"Cannot start a replay buffer, one is already active"]
+      failFuture];
+  }
+  if (![configuration.encoding isEqualToString:FBVideoStreamEncodingH264] && ![configuration.encoding isEqualToString:FBVideoStreamEncodingHEVC]) {
+    return [[FBDeviceControlError
+      describeFormat:@"Cannot start a replay buffer with the %@ encoding, only encoded streams can be buffered", configuration.encoding]
+      failFuture];
+  }
+  // The bitrate is an average, so the hard limit leaves headroom for bursts of detail. Without a bitrate, the limit assumes a generous 20 Mbps.
+  double bitrate = configuration.avgBitrate ? configuration.avgBitrate.doubleValue : 20e6;
+  NSUInteger maximumByteCount = (NSUInteger) (bitrate / 8 * window * 2);
+  FBVideoReplayBuffer *replayBuffer = [[FBVideoReplayBuffer alloc] initWithWindow:window maximumByteCount:maximumByteCount logger:self.device.logger];
+  self.replayBuffer = replayBuffer;
+
+  return [[[self
+    createStreamWithConfiguration:configuration]
+    onQueue:self.device.workQueue fmap:^(id<FBVideoStream> stream) {
+      self.replayStream = stream;
+      return [stream startStreaming:replayBuffer];
+    }]
+    onQueue:self.device.workQueue handleError:^(NSError *error) {
+      self.replayBuffer = nil;
+      self.replayStream = nil;
+      return [FBFuture futureWithError:error];
+    }];
+}
+
+- (FBFuture<NSString *> *)saveReplayToFile:(NSString *)filePath
+{
+  NSParameterAssert(filePath);
+  if (!self.replayBuffer) {
+    return [[FBDeviceControlError
+      describeFormat:@"There is no replay buffer for %@", self.device]
+      failFuture];
+  }
+  return [self.replayBuffer writeToFile:filePath];
+}
+
+- (FBFuture<NSNull *> *)stopReplayBuffer
+{
+  if (!self.replayStream) {
+    return [[FBDeviceControlError
+      describeFormat:@"There is no replay buffer for %@", self.device]
+      failFuture];
+  }
+  id<FBVideoStream> stream = self.replayStream;
+  self.replayStream = nil;
+  self.replayBuffer = nil;
+  return [stream stopStreaming];
+}
+
 #pragma mark FBVideoStreamCommands
 
 - (FBFuture<id<FBVideoStream>> *)createStreamWithConfiguration:(FBVideoStreamConfiguration *)configuration
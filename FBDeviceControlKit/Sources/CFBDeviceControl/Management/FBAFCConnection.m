@@ -10,6 +10,7 @@
 #import "FBControlCore.h"
 
 #include <dlfcn.h>
+#include <sys/stat.h>
 
 #import "FBDeviceControlError.h"
 #import "FBAMDServiceConnection.h"
@@ -19,6 +20,38 @@ static NSString *AFCDomainKey = @"AFCDomain";
 
 static AFCCalls defaultCalls;
 
+// The size of each read of a streamed file, the memory used by a stream is bounded by this rather than the size of the file.
+static const size_t StreamReadChunkSize = 1024 * 256;
+
+// The size of each write of an uploaded file, a multiple of the page size so that host reads are aligned.
+static const size_t StreamWriteChunkSize = 1024 * 1024;
+
+static FBMetricsCounter *BytesReadCounter;
+static FBMetricsCounter *BytesWrittenCounter;
+static FBMetricsCounter *CallsCounter;
+static FBMetricsCounter *ErrorsCounter;
+static FBMetricsHistogram *ReadLatencyHistogram;
+static FBMetricsHistogram *WriteLatencyHistogram;
+
+static ssize_t FBAFCReadFully(int fileDescriptor, void *buffer, size_t length)
+{
+  size_t total = 0;
+  while (total < length) {
+    ssize_t result = read(fileDescriptor, (uint8_t *) buffer + total, length - total);
+    if (result == -1 && errno == EINTR) {
+      continue;
+    }
+    if (result == -1) {
+      return -1;
+    }
+    if (result == 0) {
+      break;
+    }
+    total += (size_t) result;
+  }
+  return (ssize_t) total;
+}
+
 static void AFCConnectionCallback(void *connectionRefPtr, void *arg1, void *afcOperationPtr)
 {
   AFCConnectionRef connection = connectionRefPtr;
@@ -27,10 +60,86 @@ static void AFCConnectionCallback(void *connectionRefPtr, void *arg1, void *afcO
   [logger logFormat:@"Connection %@, operation %@", connection, operation];
 }
 
+@interface FBAFCFileInfo ()
+
+- (instancetype)initWithName:(NSString *)name type:(FBAFCFileType)type size:(uint64_t)size modificationDate:(NSDate *)modificationDate;
+
+@end
+
+@implementation FBAFCFileInfo
+
+- (instancetype)initWithName:(NSString *)name type:(FBAFCFileType)type size:(uint64_t)size modificationDate:(NSDate *)modificationDate
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _name = name;
+  _type = type;
+  _size = size;
+  _modificationDate = modificationDate;
+
+  return self;
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"%@ type %lu size %llu modified %@", self.name, (unsigned long) self.type, self.size, self.modificationDate];
+}
+
+@end
+
+@interface FBAFCConnection_ListingCacheEntry : NSObject
+
+@property (nonatomic, copy, readonly) NSArray<FBAFCFileInfo *> *listing;
+@property (nonatomic, copy, readonly) NSDate *expiry;
+
+- (instancetype)initWithListing:(NSArray<FBAFCFileInfo *> *)listing expiry:(NSDate *)expiry;
+
+@end
+
+@implementation FBAFCConnection_ListingCacheEntry
+
+- (instancetype)initWithListing:(NSArray<FBAFCFileInfo *> *)listing expiry:(NSDate *)expiry
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _listing = listing;
+  _expiry = expiry;
+
+  return self;
+}
+
+@end
+
+@interface FBAFCConnection ()
+
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, FBAFCConnection_ListingCacheEntry *> *listingCache;
+
+@end
+
 @implementation FBAFCConnection
 
 #pragma mark Initializers
 
++ (void)initialize
+{
+  if (self != FBAFCConnection.class) {
+    return;
+  }
+  FBMetricsRegistry *registry = FBMetricsRegistry.sharedRegistry;
+  BytesReadCounter = [registry counterWithName:@"afc.bytes_read"];
+  BytesWrittenCounter = [registry counterWithName:@"afc.bytes_written"];
+  CallsCounter = [registry counterWithName:@"afc.calls"];
+  ErrorsCounter = [registry counterWithName:@"afc.errors"];
+  ReadLatencyHistogram = [registry histogramWithName:@"afc.read_latency_ns"];
+  WriteLatencyHistogram = [registry histogramWithName:@"afc.write_latency_ns"];
+}
+
 - (instancetype)initWithConnection:(AFCConnectionRef)connection calls:(AFCCalls)calls logger:(id<FBControlCoreLogger>)logger
 {
   self = [super init];
@@ -41,6 +150,7 @@ static void AFCConnectionCallback(void *connectionRefPtr, void *arg1, void *afcO
   _connection = connection;
   _calls = calls;
   _logger = logger;
+  _listingCache = [NSMutableDictionary dictionary];
 
   return self;
 }
@@ -83,9 +193,144 @@ static void AFCConnectionCallback(void *connectionRefPtr, void *arg1, void *afcO
   }
 }
 
+- (BOOL)copyFileFromHost:(NSString *)hostPath toContainerPath:(NSString *)containerPath progress:(nullable FBAFCTransferProgress)progress error:(NSError **)error
+{
+  [self.logger logFormat:@"Copying %@ to %@", hostPath, containerPath];
+  [self invalidateListingsForPath:containerPath];
+  int fileDescriptor = open(hostPath.fileSystemRepresentation, O_RDONLY);
+  if (fileDescriptor == -1) {
+    return [[FBDeviceControlError
+      describeFormat:@"Could not find file on host: %@", hostPath]
+      failBool:error];
+  }
+  struct stat fileStat;
+  if (fstat(fileDescriptor, &fileStat) != 0) {
+    close(fileDescriptor);
+    return [[FBDeviceControlError
+      describeFormat:@"Could not stat file on host %@: %s", hostPath, strerror(errno)]
+      failBool:error];
+  }
+  uint64_t totalBytes = (uint64_t) fileStat.st_size;
+
+  CFTypeRef fileReference;
+  mach_error_t result = self.calls.FileRefOpen(self.connection, containerPath.UTF8String, FBAFCreateReadAndWrite, &fileReference);
+  if (result != 0) {
+    close(fileDescriptor);
+    return [[FBDeviceControlError
+      describeFormat:@"Error when opening file %@: %@", containerPath, [self errorMessageWithCode:result]]
+      failBool:error];
+  }
+
+  // Two buffers are used, the next chunk is read from the host on another queue whilst the current chunk is written to the device.
+  NSMutableData *currentBuffer = [NSMutableData dataWithLength:StreamWriteChunkSize];
+  NSMutableData *nextBuffer = [NSMutableData dataWithLength:StreamWriteChunkSize];
+  dispatch_queue_t readQueue = dispatch_queue_create("com.facebook.fbdevicecontrol.afc.upload", DISPATCH_QUEUE_SERIAL);
+  dispatch_group_t readGroup = dispatch_group_create();
+  __block ssize_t nextLength = 0;
+  ssize_t currentLength = FBAFCReadFully(fileDescriptor, currentBuffer.mutableBytes, StreamWriteChunkSize);
+  uint64_t bytesTransferred = 0;
+  uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  mach_error_t writeResult = 0;
+
+  while (currentLength > 0) {
+    NSMutableData *readBuffer = nextBuffer;
+    dispatch_group_async(readGroup, readQueue, ^{
+      nextLength = FBAFCReadFully(fileDescriptor, readBuffer.mutableBytes, StreamWriteChunkSize);
+    });
+    writeResult = [self writeFile:fileReference bytes:currentBuffer.bytes length:(uint64_t) currentLength];
+    dispatch_group_wait(readGroup, DISPATCH_TIME_FOREVER);
+    if (writeResult != 0) {
+      break;
+    }
+    bytesTransferred += (uint64_t) currentLength;
+    if (progress) {
+      double elapsed = (double) (clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - startTime) / NSEC_PER_SEC;
+      progress(bytesTransferred, totalBytes, elapsed > 0 ? bytesTransferred / elapsed : 0);
+    }
+    // Swap the buffers, so the chunk that was just read is the next to be written.
+    nextBuffer = currentBuffer;
+    currentBuffer = readBuffer;
+    currentLength = nextLength;
+  }
+  self.calls.FileRefClose(self.connection, fileReference);
+  close(fileDescriptor);
+
+  if (writeResult != 0) {
+    return [[FBDeviceControlError
+      describeFormat:@"Error when writing file %@: %@", containerPath, [self errorMessageWithCode:writeResult]]
+      failBool:error];
+  }
+  if (currentLength < 0) {
+    return [[FBDeviceControlError
+      describeFormat:@"Error when reading file on host %@: %s", hostPath, strerror(errno)]
+      failBool:error];
+  }
+  double elapsed = (double) (clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - startTime) / NSEC_PER_SEC;
+  [self.logger logFormat:@"Copied %llu bytes from %@ to %@ in %.2f seconds", bytesTransferred, hostPath, containerPath, elapsed];
+  return YES;
+}
+
+- (BOOL)copyFromReader:(FBProcessOutputReader *)reader toContainerPath:(NSString *)containerPath progress:(nullable FBAFCTransferProgress)progress error:(NSError **)error
+{
+  [self.logger logFormat:@"Copying process output to %@", containerPath];
+  [self invalidateListingsForPath:containerPath];
+  CFTypeRef fileReference;
+  mach_error_t result = self.calls.FileRefOpen(self.connection, containerPath.UTF8String, FBAFCreateReadAndWrite, &fileReference);
+  if (result != 0) {
+    [reader close];
+    return [[FBDeviceControlError
+      describeFormat:@"Error when opening file %@: %@", containerPath, [self errorMessageWithCode:result]]
+      failBool:error];
+  }
+
+  uint64_t bytesTransferred = 0;
+  uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  mach_error_t writeResult = 0;
+  NSError *readError = nil;
+  FBFuture<dispatch_data_t> *nextRead = [reader readWithMaximumLength:StreamWriteChunkSize];
+  while (YES) {
+    dispatch_data_t chunk = [nextRead block:&readError];
+    if (!chunk || dispatch_data_get_size(chunk) == 0) {
+      break;
+    }
+    // The next read is outstanding whilst the current chunk is written.
+    nextRead = [reader readWithMaximumLength:StreamWriteChunkSize];
+    const void *bytes = NULL;
+    size_t length = 0;
+    dispatch_data_t contiguous __attribute__((objc_precise_lifetime)) = dispatch_data_create_map(chunk, &bytes, &length);
+    writeResult = [self writeFile:fileReference bytes:bytes length:(uint64_t) length];
+    if (writeResult != 0) {
+      break;
+    }
+    bytesTransferred += (uint64_t) length;
+    if (progress) {
+      double elapsed = (double) (clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - startTime) / NSEC_PER_SEC;
+      progress(bytesTransferred, 0, elapsed > 0 ? bytesTransferred / elapsed : 0);
+    }
+  }
+  self.calls.FileRefClose(self.connection, fileReference);
+
+  if (writeResult != 0) {
+    [reader close];
+    return [[FBDeviceControlError
+      describeFormat:@"Error when writing file %@: %@", containerPath, [self errorMessageWithCode:writeResult]]
+      failBool:error];
+  }
+  if (readError) {
+    return [[[FBDeviceControlError
+      describeFormat:@"Error when reading process output for %@", containerPath]
+      causedBy:readError]
+      failBool:error];
+  }
+  double elapsed = (double) (clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - startTime) / NSEC_PER_SEC;
+  [self.logger logFormat:@"Copied %llu bytes of process output to %@ in %.2f seconds", bytesTransferred, containerPath, elapsed];
+  return YES;
+}
+
 - (BOOL)createDirectory:(NSString *)path error:(NSError **)error
 {
   [self.logger logFormat:@"Creating Directory %@", path];
+  [self invalidateListingsForPath:path];
   mach_error_t result = self.calls.DirectoryCreate(self.connection, [path UTF8String]);
   if (result != 0) {
     return [[FBDeviceControlError
@@ -101,6 +346,10 @@ const char *DoubleDot = "..";
 
 - (NSArray<NSString *> *)contentsOfDirectory:(NSString *)path error:(NSError **)error
 {
+  NSArray<FBAFCFileInfo *> *cached = [self cachedListingForPath:path];
+  if (cached) {
+    return [cached valueForKey:@"name"];
+  }
   [self.logger logFormat:@"Listing contents of directory %@", path];
   CFTypeRef directory;
   mach_error_t result = self.calls.DirectoryOpen(self.connection, path.UTF8String, &directory);
@@ -124,13 +373,80 @@ const char *DoubleDot = "..";
   }
 
   self.calls.DirectoryClose(self.connection, directory);
-  [self.logger logFormat:@"Contents of directory %@ %@", path, [FBCollectionInformation oneLineDescriptionFromArray:dirs]];
+  FBControlCoreLogFormat(self.logger, @"Contents of directory %@ %@", path, [FBCollectionInformation oneLineDescriptionFromArray:dirs]);
   return [NSArray arrayWithArray:dirs];
 }
 
+- (NSArray<FBAFCFileInfo *> *)contentsOfDirectoryWithInfo:(NSString *)path error:(NSError **)error
+{
+  NSArray<FBAFCFileInfo *> *cached = [self cachedListingForPath:path];
+  if (cached) {
+    return cached;
+  }
+  NSArray<NSString *> *names = [self contentsOfDirectory:path error:error];
+  if (!names) {
+    return nil;
+  }
+  NSMutableArray<FBAFCFileInfo *> *listing = [NSMutableArray arrayWithCapacity:names.count];
+  for (NSString *name in names) {
+    NSError *infoError = nil;
+    FBAFCFileInfo *info = [self fileInfoForPath:[path stringByAppendingPathComponent:name] error:&infoError];
+    // An item can be removed between the listing and the stat, this doesn't fail the listing.
+    if (!info) {
+      FBControlCoreLogFormat(self.logger, @"Could not stat %@ in %@: %@", name, path, infoError);
+      continue;
+    }
+    [listing addObject:info];
+  }
+  NSNumber *timeout = self.listingCacheTimeout;
+  if (timeout) {
+    @synchronized (self.listingCache) {
+      self.listingCache[path.stringByStandardizingPath] = [[FBAFCConnection_ListingCacheEntry alloc] initWithListing:listing expiry:[NSDate dateWithTimeIntervalSinceNow:timeout.doubleValue]];
+    }
+  }
+  return [listing copy];
+}
+
+- (FBAFCFileInfo *)fileInfoForPath:(NSString *)path error:(NSError **)error
+{
+  CFTypeRef info = NULL;
+  mach_error_t result = self.calls.FileInfoOpen(self.connection, path.UTF8String, &info);
+  if (result != 0 || info == NULL) {
+    return [[FBDeviceControlError
+      describeFormat:@"Error when getting info of %@: %@", path, [self errorMessageWithCode:result]]
+      fail:error];
+  }
+  FBAFCFileType type = FBAFCFileTypeOther;
+  uint64_t size = 0;
+  uint64_t modificationNanoseconds = 0;
+  while (YES) {
+    char *key = NULL;
+    char *value = NULL;
+    if (self.calls.KeyValueRead(info, &key, &value) != 0 || key == NULL || value == NULL) {
+      break;
+    }
+    if (strcmp(key, "st_size") == 0) {
+      size = strtoull(value, NULL, 10);
+    } else if (strcmp(key, "st_mtime") == 0) {
+      modificationNanoseconds = strtoull(value, NULL, 10);
+    } else if (strcmp(key, "st_ifmt") == 0) {
+      if (strcmp(value, "S_IFREG") == 0) {
+        type = FBAFCFileTypeRegular;
+      } else if (strcmp(value, "S_IFDIR") == 0) {
+        type = FBAFCFileTypeDirectory;
+      } else if (strcmp(value, "S_IFLNK") == 0) {
+        type = FBAFCFileTypeSymbolicLink;
+      }
+    }
+  }
+  self.calls.KeyValueClose(info);
+  NSDate *modificationDate = [NSDate dateWithTimeIntervalSince1970:(NSTimeInterval) modificationNanoseconds / NSEC_PER_SEC];
+  return [[FBAFCFileInfo alloc] initWithName:path.lastPathComponent type:type size:size modificationDate:modificationDate];
+}
+
 - (NSData *)contentsOfPath:(NSString *)path error:(NSError **)error
 {
-  [self.logger logFormat:@"Contents of path %@", path];
+  FBControlCoreLogFormat(self.logger, @"Contents of path %@", path);
   CFTypeRef file;
   mach_error_t result = self.calls.FileRefOpen(self.connection, path.UTF8String, FBAFCReadOnlyMode, &file);
   if (result != 0) {
@@ -147,7 +463,7 @@ const char *DoubleDot = "..";
   self.calls.FileRefSeek(self.connection, file, 0, 0);
   while (toRead > 0) {
     uint64_t read = toRead;
-    result = self.calls.FileRefRead(self.connection, file, [buffer mutableBytes] + (len - toRead), &read);
+    result = [self readFile:file into:[buffer mutableBytes] + (len - toRead) length:&read];
     toRead -= read;
     if (result != 0) {
       self.calls.FileRefClose(self.connection, file);
@@ -157,29 +473,102 @@ const char *DoubleDot = "..";
     }
   }
   self.calls.FileRefClose(self.connection, file);
-  [self.logger logFormat:@"Read %lu bytes from path %@", buffer.length, path];
+  FBControlCoreLogFormat(self.logger, @"Read %lu bytes from path %@", buffer.length, path);
   return buffer;
 }
 
+- (NSData *)contentsOfPath:(NSString *)path maximumLength:(uint64_t)maximumLength error:(NSError **)error
+{
+  CFTypeRef file;
+  mach_error_t result = self.calls.FileRefOpen(self.connection, path.UTF8String, FBAFCReadOnlyMode, &file);
+  if (result != 0) {
+    return [[FBDeviceControlError
+      describeFormat:@"Error when opening file %@: %@", path, [self errorMessageWithCode:result]]
+      fail:error];
+  }
+  NSMutableData *buffer = [[NSMutableData alloc] initWithLength:maximumLength];
+  uint64_t total = 0;
+  while (total < maximumLength) {
+    uint64_t read = maximumLength - total;
+    result = [self readFile:file into:buffer.mutableBytes + total length:&read];
+    if (result != 0) {
+      self.calls.FileRefClose(self.connection, file);
+      return [[FBDeviceControlError
+        describeFormat:@"Error when reading file %@: %@", path, [self errorMessageWithCode:result]]
+        fail:error];
+    }
+    // A read of zero bytes is the end of the file, which is before the maximum length.
+    if (read == 0) {
+      break;
+    }
+    total += read;
+  }
+  self.calls.FileRefClose(self.connection, file);
+  buffer.length = (NSUInteger) total;
+  FBControlCoreLogFormat(self.logger, @"Read first %llu bytes from path %@", total, path);
+  return buffer;
+}
+
+- (BOOL)readContentsOfPath:(NSString *)path toConsumer:(id<FBDataConsumer>)consumer error:(NSError **)error
+{
+  return [self readContentsOfPath:path chunk:^ BOOL (const void *bytes, size_t length, NSError **innerError) {
+    [consumer consumeData:[NSData dataWithBytes:bytes length:length]];
+    return YES;
+  } error:error];
+}
+
+- (BOOL)readContentsOfPath:(NSString *)path fromOffset:(uint64_t)offset toConsumer:(id<FBDataConsumer>)consumer endOffset:(uint64_t *)endOffset error:(NSError **)error
+{
+  return [self readContentsOfPath:path fromOffset:offset chunk:^ BOOL (const void *bytes, size_t length, NSError **innerError) {
+    [consumer consumeData:[NSData dataWithBytes:bytes length:length]];
+    return YES;
+  } endOffset:endOffset error:error];
+}
+
+- (BOOL)readContentsOfPath:(NSString *)path toFileDescriptor:(int)fileDescriptor error:(NSError **)error
+{
+  return [self readContentsOfPath:path chunk:^ BOOL (const void *bytes, size_t length, NSError **innerError) {
+    const uint8_t *cursor = bytes;
+    size_t remaining = length;
+    while (remaining > 0) {
+      ssize_t written = write(fileDescriptor, cursor, remaining);
+      if (written == -1 && errno == EINTR) {
+        continue;
+      }
+      if (written < 1) {
+        return [[FBDeviceControlError
+          describeFormat:@"Failed to write %zu bytes of %@ to file descriptor %d: %s", remaining, path, fileDescriptor, strerror(errno)]
+          failBool:innerError];
+      }
+      cursor += written;
+      remaining -= (size_t) written;
+    }
+    return YES;
+  } error:error];
+}
+
 - (BOOL)removePath:(NSString *)path recursively:(BOOL)recursively error:(NSError **)error
 {
+  [self invalidateListingsForPath:path];
   if (recursively) {
     return [self removePathAndContents:path error:error];
   } else {
-    [self.logger logFormat:@"Removing file path %@", path];
+    FBControlCoreLogFormat(self.logger, @"Removing file path %@", path);
     mach_error_t result = self.calls.RemovePath(self.connection, [path UTF8String]);
     if (result != 0) {
       return [[FBDeviceControlError
         describeFormat:@"Error when removing path %@: %@", path, [self errorMessageWithCode:result]]
         failBool:error];
     }
-    [self.logger logFormat:@"Removed file path %@", path];
+    FBControlCoreLogFormat(self.logger, @"Removed file path %@", path);
     return YES;
   }
 }
 
 - (BOOL)renamePath:(NSString *)path destination:(NSString *)destination error:(NSError **)error
 {
+  [self invalidateListingsForPath:path];
+  [self invalidateListingsForPath:destination];
   mach_error_t result = self.calls.RenamePath(self.connection, path.UTF8String, destination.UTF8String);
   if (result != 0) {
     return [[FBDeviceControlError
@@ -210,43 +599,139 @@ const char *DoubleDot = "..";
   return YES;
 }
 
+- (BOOL)connectionIsValid
+{
+  return (BOOL) self.calls.ConnectionIsValid(self.connection);
+}
+
 #pragma mark Private
 
-- (BOOL)copyFileFromHost:(NSString *)hostPath toContainerPath:(NSString *)containerPath error:(NSError **)error
+- (mach_error_t)readFile:(CFTypeRef)file into:(void *)buffer length:(uint64_t *)length
 {
-  [self.logger logFormat:@"Copying %@ to %@", hostPath, containerPath];
-  NSData *data = [NSData dataWithContentsOfFile:hostPath];
-  if (!data) {
-    return [[FBDeviceControlError
-      describeFormat:@"Could not find file on host: %@", hostPath]
-      failBool:error];
+  uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  mach_error_t result = self.calls.FileRefRead(self.connection, file, buffer, length);
+  [CallsCounter increment];
+  [ReadLatencyHistogram recordNanosecondsSince:startTime];
+  if (result != 0) {
+    [ErrorsCounter increment];
+  } else {
+    [BytesReadCounter add:*length];
   }
+  return result;
+}
 
-  CFTypeRef fileReference;
-  mach_error_t result = self.calls.FileRefOpen(self.connection, containerPath.UTF8String, FBAFCreateReadAndWrite, &fileReference);
+- (mach_error_t)writeFile:(CFTypeRef)file bytes:(const void *)bytes length:(uint64_t)length
+{
+  uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  mach_error_t result = self.calls.FileRefWrite(self.connection, file, bytes, length);
+  [CallsCounter increment];
+  [WriteLatencyHistogram recordNanosecondsSince:startTime];
   if (result != 0) {
-    return [[FBDeviceControlError
-      describeFormat:@"Error when opening file %@: %@", containerPath, [self errorMessageWithCode:result]]
-      failBool:error];
+    [ErrorsCounter increment];
+  } else {
+    [BytesWrittenCounter add:length];
   }
+  return result;
+}
+
+- (nullable NSArray<FBAFCFileInfo *> *)cachedListingForPath:(NSString *)path
+{
+  if (!self.listingCacheTimeout) {
+    return nil;
+  }
+  NSString *key = path.stringByStandardizingPath;
+  @synchronized (self.listingCache) {
+    FBAFCConnection_ListingCacheEntry *entry = self.listingCache[key];
+    if (!entry) {
+      return nil;
+    }
+    if ([entry.expiry compare:NSDate.date] != NSOrderedDescending) {
+      [self.listingCache removeObjectForKey:key];
+      return nil;
+    }
+    return entry.listing;
+  }
+}
 
-  __block mach_error_t writeResult = 0;
-  [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
-    if (byteRange.length == 0) {
+- (void)invalidateListingsForPath:(NSString *)path
+{
+  // A change to a path affects the listing of its parent, and the listings of anything beneath it if it is a directory.
+  NSString *standardized = path.stringByStandardizingPath;
+  NSString *parent = standardized.stringByDeletingLastPathComponent;
+  NSString *prefix = [standardized stringByAppendingString:@"/"];
+  @synchronized (self.listingCache) {
+    if (self.listingCache.count == 0) {
       return;
     }
-    writeResult = self.calls.FileRefWrite(self.connection, fileReference, bytes, byteRange.length);
-    if (writeResult != 0) {
-      *stop = YES;
+    for (NSString *key in self.listingCache.allKeys) {
+      if ([key isEqualToString:parent] || [key isEqualToString:standardized] || [key hasPrefix:prefix]) {
+        [self.listingCache removeObjectForKey:key];
+      }
     }
-  }];
-  self.calls.FileRefClose(self.connection, fileReference);
-  if (writeResult != 0) {
+  }
+}
+
+- (BOOL)copyFileFromHost:(NSString *)hostPath toContainerPath:(NSString *)containerPath error:(NSError **)error
+{
+  return [self copyFileFromHost:hostPath toContainerPath:containerPath progress:nil error:error];
+}
+
+- (BOOL)readContentsOfPath:(NSString *)path chunk:(BOOL(^)(const void *bytes, size_t length, NSError **error))chunk error:(NSError **)error
+{
+  return [self readContentsOfPath:path fromOffset:0 chunk:chunk endOffset:NULL error:error];
+}
+
+- (BOOL)readContentsOfPath:(NSString *)path fromOffset:(uint64_t)offset chunk:(BOOL(^)(const void *bytes, size_t length, NSError **error))chunk endOffset:(uint64_t *)endOffset error:(NSError **)error
+{
+  [self.logger logFormat:@"Streaming contents of path %@ from offset %llu", path, offset];
+  CFTypeRef file;
+  mach_error_t result = self.calls.FileRefOpen(self.connection, path.UTF8String, FBAFCReadOnlyMode, &file);
+  if (result != 0) {
     return [[FBDeviceControlError
-      describeFormat:@"Error when writing file %@: %@", containerPath, [self errorMessageWithCode:writeResult]]
+      describeFormat:@"Error when opening file %@: %@", path, [self errorMessageWithCode:result]]
       failBool:error];
   }
-  [self.logger logFormat:@"Copied from %@ to %@", hostPath, containerPath];
+  if (offset > 0) {
+    result = self.calls.FileRefSeek(self.connection, file, (int64_t) offset, SEEK_SET);
+    if (result != 0) {
+      self.calls.FileRefClose(self.connection, file);
+      return [[FBDeviceControlError
+        describeFormat:@"Error when seeking to %llu in file %@: %@", offset, path, [self errorMessageWithCode:result]]
+        failBool:error];
+    }
+  }
+  // The buffer is re-used for every read, so memory use is the same regardless of the size of the file.
+  NSMutableData *buffer = [NSMutableData dataWithLength:StreamReadChunkSize];
+  uint64_t total = 0;
+  while (YES) {
+    uint64_t read = StreamReadChunkSize;
+    result = [self readFile:file into:buffer.mutableBytes length:&read];
+    if (result != 0) {
+      self.calls.FileRefClose(self.connection, file);
+      return [[FBDeviceControlError
+        describeFormat:@"Error when reading file %@: %@", path, [self errorMessageWithCode:result]]
+        failBool:error];
+    }
+    // A read of zero bytes is the end of the file.
+    if (read == 0) {
+      break;
+    }
+    if (!chunk(buffer.bytes, (size_t) read, error)) {
+      self.calls.FileRefClose(self.connection, file);
+      return NO;
+    }
+    total += read;
+  }
+  if (endOffset) {
+    // Ask the device where the read ended, rather than assuming, as the file may have been truncated beneath the offset.
+    uint64_t position = offset + total;
+    if (self.calls.FileRefTell(self.connection, file, &position) != 0) {
+      position = offset + total;
+    }
+    *endOffset = position;
+  }
+  self.calls.FileRefClose(self.connection, file);
+  [self.logger logFormat:@"Streamed %llu bytes from path %@", total, path];
   return YES;
 }
 
@@ -342,11 +827,6 @@ const char *DoubleDot = "..";
 
 #pragma mark Private
 
-- (BOOL)connectionIsValid
-{
-  return (BOOL) self.calls.ConnectionIsValid(self.connection);
-}
-
 + (void)populateCallsFromMobileDevice:(AFCCalls *)calls
 {
   void *handle = [[NSBundle bundleWithIdentifier:@"com.apple.mobiledevice"] dlopenExecutablePath];
@@ -366,7 +846,10 @@ const char *DoubleDot = "..";
   calls->FileRefRead = FBGetSymbolFromHandle(handle, "AFCFileRefRead");
   calls->FileRefSeek = FBGetSymbolFromHandle(handle, "AFCFileRefSeek");
   calls->FileRefTell = FBGetSymbolFromHandle(handle, "AFCFileRefTell");
+  calls->FileInfoOpen = FBGetSymbolFromHandle(handle, "AFCFileInfoOpen");
   calls->FileRefWrite = FBGetSymbolFromHandle(handle, "AFCFileRefWrite");
+  calls->KeyValueClose = FBGetSymbolFromHandle(handle, "AFCKeyValueClose");
+  calls->KeyValueRead = FBGetSymbolFromHandle(handle, "AFCKeyValueRead");
   calls->OperationCreateRemovePathAndContents = FBGetSymbolFromHandle(handle, "AFCOperationCreateRemovePathAndContents");
   calls->OperationGetResultObject = FBGetSymbolFromHandle(handle, "AFCOperationGetResultObject");
   calls->OperationGetResultStatus = FBGetSymbolFromHandle(handle, "AFCOperationGetResultStatus");
@@ -0,0 +1,359 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBAFCDirectoryTransfer.h"
+
+#import "FBAFCConnection.h"
+#import "FBDeviceControlError.h"
+
+// Files below this size are batched together, rather than being a unit of work of their own.
+static const unsigned long long SmallFileThreshold = 1024 * 64;
+// The limits of a single batch of small files.
+static const unsigned long long BatchByteLimit = 1024 * 1024;
+static const NSUInteger BatchFileLimit = 64;
+
+static NSString *const ManifestDestinationKey = @"destination";
+static NSString *const ManifestFilesKey = @"files";
+static NSString *const ManifestSizeKey = @"size";
+static NSString *const ManifestModificationKey = @"mtime";
+
+@interface FBAFCDirectoryTransfer_File : NSObject
+
+@property (nonatomic, copy, readonly) NSString *relativePath;
+@property (nonatomic, assign, readonly) unsigned long long size;
+@property (nonatomic, assign, readonly) NSTimeInterval modificationTime;
+
+- (instancetype)initWithRelativePath:(NSString *)relativePath size:(unsigned long long)size modificationTime:(NSTimeInterval)modificationTime;
+- (NSDictionary<NSString *, NSNumber *> *)manifestEntry;
+
+@end
+
+@implementation FBAFCDirectoryTransfer_File
+
+- (instancetype)initWithRelativePath:(NSString *)relativePath size:(unsigned long long)size modificationTime:(NSTimeInterval)modificationTime
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _relativePath = relativePath;
+  _size = size;
+  _modificationTime = modificationTime;
+
+  return self;
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)manifestEntry
+{
+  return @{
+    ManifestSizeKey: @(self.size),
+    ManifestModificationKey: @(self.modificationTime),
+  };
+}
+
+@end
+
+/**
+ The shared state of a single transfer, used by all of the workers.
+ */
+@interface FBAFCDirectoryTransfer_State : NSObject
+
+@property (nonatomic, copy, readonly) NSString *hostRoot;
+@property (nonatomic, copy, readonly) NSString *containerRoot;
+@property (nonatomic, copy, nullable, readonly) NSString *manifestPath;
+@property (nonatomic, strong, readonly) NSArray<NSArray<FBAFCDirectoryTransfer_File *> *> *batches;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *manifestFiles;
+@property (nonatomic, strong, readonly) NSMutableArray<NSString *> *copied;
+@property (nonatomic, strong, readonly) dispatch_group_t inFlight;
+@property (nonatomic, assign, readwrite) NSUInteger nextBatch;
+@property (nonatomic, strong, nullable, readwrite) NSError *error;
+
+- (instancetype)initWithHostRoot:(NSString *)hostRoot containerRoot:(NSString *)containerRoot manifestPath:(nullable NSString *)manifestPath manifestFiles:(NSMutableDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *)manifestFiles batches:(NSArray<NSArray<FBAFCDirectoryTransfer_File *> *> *)batches;
+- (nullable NSArray<FBAFCDirectoryTransfer_File *> *)takeBatch;
+- (void)finishBatch:(NSArray<FBAFCDirectoryTransfer_File *> *)batch copied:(NSUInteger)copiedCount error:(nullable NSError *)error;
+- (void)writeManifest;
+
+@end
+
+@implementation FBAFCDirectoryTransfer_State
+
+- (instancetype)initWithHostRoot:(NSString *)hostRoot containerRoot:(NSString *)containerRoot manifestPath:(nullable NSString *)manifestPath manifestFiles:(NSMutableDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *)manifestFiles batches:(NSArray<NSArray<FBAFCDirectoryTransfer_File *> *> *)batches
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _hostRoot = hostRoot;
+  _containerRoot = containerRoot;
+  _manifestPath = manifestPath;
+  _manifestFiles = manifestFiles;
+  _batches = batches;
+  _copied = [NSMutableArray array];
+  _inFlight = dispatch_group_create();
+
+  return self;
+}
+
+- (nullable NSArray<FBAFCDirectoryTransfer_File *> *)takeBatch
+{
+  @synchronized (self) {
+    if (self.error || self.nextBatch >= self.batches.count) {
+      return nil;
+    }
+    NSArray<FBAFCDirectoryTransfer_File *> *batch = self.batches[self.nextBatch];
+    self.nextBatch += 1;
+    // Entered whilst locked, so that a batch that has been taken is always waited on.
+    dispatch_group_enter(self.inFlight);
+    return batch;
+  }
+}
+
+- (void)finishBatch:(NSArray<FBAFCDirectoryTransfer_File *> *)batch copied:(NSUInteger)copiedCount error:(nullable NSError *)error
+{
+  @synchronized (self) {
+    for (NSUInteger index = 0; index < copiedCount; index++) {
+      FBAFCDirectoryTransfer_File *file = batch[index];
+      [self.copied addObject:file.relativePath];
+      self.manifestFiles[file.relativePath] = file.manifestEntry;
+    }
+    if (error && !self.error) {
+      self.error = error;
+    }
+    // Recording after every batch means that a transfer that is killed can resume from the last batch.
+    [self writeManifest];
+  }
+  dispatch_group_leave(self.inFlight);
+}
+
+- (void)writeManifest
+{
+  if (!self.manifestPath) {
+    return;
+  }
+  NSDictionary<NSString *, id> *manifest = @{
+    ManifestDestinationKey: self.containerRoot,
+    ManifestFilesKey: self.manifestFiles,
+  };
+  NSData *data = [NSJSONSerialization dataWithJSONObject:manifest options:0 error:nil];
+  [data writeToFile:self.manifestPath atomically:YES];
+}
+
+@end
+
+@interface FBAFCDirectoryTransfer ()
+
+@property (nonatomic, copy, nullable, readonly) FBAFCConnectionProvider connectionProvider;
+@property (nonatomic, assign, readonly) NSUInteger concurrency;
+@property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+
+@end
+
+@implementation FBAFCDirectoryTransfer
+
+#pragma mark Initializers
+
++ (instancetype)transferWithConnectionProvider:(nullable FBAFCConnectionProvider)connectionProvider concurrency:(NSUInteger)concurrency logger:(nullable id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithConnectionProvider:connectionProvider concurrency:concurrency logger:logger];
+}
+
+- (instancetype)initWithConnectionProvider:(nullable FBAFCConnectionProvider)connectionProvider concurrency:(NSUInteger)concurrency logger:(nullable id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _connectionProvider = connectionProvider;
+  _concurrency = MAX(concurrency, (NSUInteger) 1);
+  _logger = logger;
+  _queue = dispatch_queue_create("com.facebook.fbdevicecontrol.afc.directory_transfer", DISPATCH_QUEUE_CONCURRENT);
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (nullable NSArray<NSString *> *)copyFromHost:(NSString *)hostPath toContainerPath:(NSString *)containerPath connection:(FBAFCConnection *)connection manifestPath:(nullable NSString *)manifestPath error:(NSError **)error
+{
+  BOOL isDirectory = NO;
+  if (![NSFileManager.defaultManager fileExistsAtPath:hostPath isDirectory:&isDirectory]) {
+    return [[FBDeviceControlError
+      describeFormat:@"Could not find file on host: %@", hostPath]
+      fail:error];
+  }
+  NSString *containerRoot = [containerPath stringByAppendingPathComponent:hostPath.lastPathComponent];
+
+  // Enumerate the tree once, up-front.
+  NSMutableArray<NSString *> *directories = [NSMutableArray array];
+  NSMutableArray<FBAFCDirectoryTransfer_File *> *files = [NSMutableArray array];
+  if (isDirectory) {
+    [directories addObject:@""];
+    if (![self enumerateHostDirectory:hostPath directories:directories files:files error:error]) {
+      return nil;
+    }
+  } else {
+    NSDictionary<NSFileAttributeKey, id> *attributes = [NSFileManager.defaultManager attributesOfItemAtPath:hostPath error:error];
+    if (!attributes) {
+      return nil;
+    }
+    [files addObject:[[FBAFCDirectoryTransfer_File alloc] initWithRelativePath:@"" size:attributes.fileSize modificationTime:attributes.fileModificationDate.timeIntervalSince1970]];
+  }
+
+  // Skip files that are unchanged since they were last copied to the same destination.
+  NSMutableDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *manifestFiles = [self loadManifest:manifestPath destination:containerRoot];
+  NSMutableArray<FBAFCDirectoryTransfer_File *> *pending = [NSMutableArray array];
+  for (FBAFCDirectoryTransfer_File *file in files) {
+    if ([manifestFiles[file.relativePath] isEqualToDictionary:file.manifestEntry]) {
+      continue;
+    }
+    [pending addObject:file];
+  }
+  [self.logger logFormat:@"Copying %lu of %lu files and %lu directories from %@ to %@", pending.count, files.count, directories.count, hostPath, containerRoot];
+
+  // Directories are created first, parents before children, so that files can be written in any order.
+  for (NSString *directory in directories) {
+    NSString *path = directory.length == 0 ? containerRoot : [containerRoot stringByAppendingPathComponent:directory];
+    NSError *createError = nil;
+    if (![connection createDirectory:path error:&createError]) {
+      // The directory may exist from a previous transfer, a missing one will fail the writes into it.
+      [self.logger logFormat:@"Could not create directory %@, it may already exist: %@", path, createError];
+    }
+  }
+
+  FBAFCDirectoryTransfer_State *state = [[FBAFCDirectoryTransfer_State alloc]
+    initWithHostRoot:hostPath
+    containerRoot:containerRoot
+    manifestPath:manifestPath
+    manifestFiles:manifestFiles
+    batches:[FBAFCDirectoryTransfer batchesForFiles:pending]];
+
+  // Additional workers join when they get a connection, the calling thread works on the connection it was given meanwhile.
+  NSUInteger additionalWorkers = self.connectionProvider ? MIN(self.concurrency - 1, state.batches.count > 0 ? state.batches.count - 1 : 0) : 0;
+  for (NSUInteger index = 0; index < additionalWorkers; index++) {
+    [[self.connectionProvider()
+      onQueue:self.queue pop:^(FBAFCConnection *additional) {
+        [self drainBatches:state connection:additional];
+        return FBFuture.empty;
+      }]
+      onQueue:self.queue handleError:^(NSError *providerError) {
+        [self.logger logFormat:@"Could not obtain an additional connection for transfer: %@", providerError];
+        return FBFuture.empty;
+      }];
+  }
+  [self drainBatches:state connection:connection];
+  dispatch_group_wait(state.inFlight, DISPATCH_TIME_FOREVER);
+
+  if (state.error) {
+    return [[[FBDeviceControlError
+      describeFormat:@"Failed to copy %@ to %@, %lu files copied before failure", hostPath, containerRoot, state.copied.count]
+      causedBy:state.error]
+      fail:error];
+  }
+  [self.logger logFormat:@"Copied %lu files from %@ to %@", state.copied.count, hostPath, containerRoot];
+  return [state.copied copy];
+}
+
+#pragma mark Private
+
+- (void)drainBatches:(FBAFCDirectoryTransfer_State *)state connection:(FBAFCConnection *)connection
+{
+  NSArray<FBAFCDirectoryTransfer_File *> *batch = nil;
+  while ((batch = [state takeBatch])) {
+    NSUInteger copiedCount = 0;
+    NSError *error = nil;
+    for (FBAFCDirectoryTransfer_File *file in batch) {
+      NSString *hostPath = file.relativePath.length == 0 ? state.hostRoot : [state.hostRoot stringByAppendingPathComponent:file.relativePath];
+      NSString *containerPath = file.relativePath.length == 0 ? state.containerRoot : [state.containerRoot stringByAppendingPathComponent:file.relativePath];
+      if (![connection copyFileFromHost:hostPath toContainerPath:containerPath progress:nil error:&error]) {
+        break;
+      }
+      copiedCount += 1;
+    }
+    [state finishBatch:batch copied:copiedCount error:error];
+  }
+}
+
+- (BOOL)enumerateHostDirectory:(NSString *)hostDirectory directories:(NSMutableArray<NSString *> *)directories files:(NSMutableArray<FBAFCDirectoryTransfer_File *> *)files error:(NSError **)error
+{
+  NSURL *rootURL = [NSURL fileURLWithPath:hostDirectory].URLByStandardizingPath;
+  NSArray<NSURLResourceKey> *keys = @[NSURLIsDirectoryKey, NSURLFileSizeKey, NSURLContentModificationDateKey];
+  __block NSError *enumerationError = nil;
+  NSDirectoryEnumerator<NSURL *> *urls = [NSFileManager.defaultManager
+    enumeratorAtURL:rootURL
+    includingPropertiesForKeys:keys
+    options:0
+    errorHandler:^ BOOL (NSURL *url, NSError *urlError) {
+      enumerationError = urlError;
+      return NO;
+    }];
+  NSUInteger rootLength = rootURL.path.length + 1;
+  for (NSURL *url in urls) {
+    NSDictionary<NSURLResourceKey, id> *values = [url.URLByStandardizingPath resourceValuesForKeys:keys error:nil];
+    NSString *path = url.URLByStandardizingPath.path;
+    if (path.length <= rootLength) {
+      continue;
+    }
+    NSString *relativePath = [path substringFromIndex:rootLength];
+    if ([values[NSURLIsDirectoryKey] boolValue]) {
+      [directories addObject:relativePath];
+      continue;
+    }
+    NSDate *modification = values[NSURLContentModificationDateKey];
+    [files addObject:[[FBAFCDirectoryTransfer_File alloc] initWithRelativePath:relativePath size:[values[NSURLFileSizeKey] unsignedLongLongValue] modificationTime:modification.timeIntervalSince1970]];
+  }
+  if (enumerationError) {
+    return [[[FBDeviceControlError
+      describeFormat:@"Failed to enumerate %@", hostDirectory]
+      causedBy:enumerationError]
+      failBool:error];
+  }
+  // Enumeration is depth-first so parents precede their children already.
+  return YES;
+}
+
+- (NSMutableDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *)loadManifest:(nullable NSString *)manifestPath destination:(NSString *)destination
+{
+  if (!manifestPath) {
+    return [NSMutableDictionary dictionary];
+  }
+  NSData *data = [NSData dataWithContentsOfFile:manifestPath];
+  NSDictionary<NSString *, id> *manifest = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+  if (![manifest isKindOfClass:NSDictionary.class] || ![manifest[ManifestDestinationKey] isEqual:destination] || ![manifest[ManifestFilesKey] isKindOfClass:NSDictionary.class]) {
+    return [NSMutableDictionary dictionary];
+  }
+  return [manifest[ManifestFilesKey] mutableCopy];
+}
+
++ (NSArray<NSArray<FBAFCDirectoryTransfer_File *> *> *)batchesForFiles:(NSArray<FBAFCDirectoryTransfer_File *> *)files
+{
+  NSMutableArray<NSArray<FBAFCDirectoryTransfer_File *> *> *batches = [NSMutableArray array];
+  NSMutableArray<FBAFCDirectoryTransfer_File *> *current = [NSMutableArray array];
+  unsigned long long currentBytes = 0;
+  for (FBAFCDirectoryTransfer_File *file in files) {
+    if (file.size >= SmallFileThreshold) {
+      [batches addObject:@[file]];
+      continue;
+    }
+    [current addObject:file];
+    currentBytes += file.size;
+    if (current.count >= BatchFileLimit || currentBytes >= BatchByteLimit) {
+      [batches addObject:[current copy]];
+      [current removeAllObjects];
+      currentBytes = 0;
+    }
+  }
+  if (current.count > 0) {
+    [batches addObject:[current copy]];
+  }
+  return batches;
+}
+
+@end
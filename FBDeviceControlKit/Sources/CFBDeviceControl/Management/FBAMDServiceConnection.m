@@ -13,13 +13,28 @@
 typedef uint32_t HeaderIntType;
 static const NSUInteger HeaderLength = sizeof(HeaderIntType);
 
-// There's an upper limit on the number of bytes we can read at once
-static size_t ReadBufferSize = 1024 * 4;
+// The default size of a single receive, reads are made into heap buffers so this is not bounded by the stack.
+static const size_t DefaultReceiveChunkSize = 1024 * 64;
+
+// The default size of a single send, large enough that bulk transfers aren't dominated by per-call overhead.
+static const size_t DefaultSendChunkSize = 1024 * 256;
+
+// The size of the buffer that a length header is sent in, along with the head of its payload.
+static const size_t CoalescedSendSize = 1024 * 16;
+
+static FBMetricsCounter *BytesSentCounter;
+static FBMetricsCounter *BytesReceivedCounter;
+static FBMetricsCounter *CallsCounter;
+static FBMetricsCounter *ErrorsCounter;
+static FBMetricsHistogram *SendLatencyHistogram;
+static FBMetricsHistogram *ReceiveLatencyHistogram;
 
 @interface FBAMDServiceConnection ()
 
 - (ssize_t)send:(const void *)buffer size:(size_t)size;
 - (ssize_t)receive:(void *)buffer size:(size_t)size;
+- (BOOL)send:(NSData *)data fromOffset:(size_t)offset error:(NSError **)error;
+- (BOOL)sendBytes:(const void *)bytes length:(size_t)length error:(NSError **)error;
 
 @end
 
@@ -63,13 +78,15 @@ static size_t ReadBufferSize = 1024 * 4;
   FBAMDServiceConnection *connection = self.connection;
   id<FBDataConsumer> consumer = self.consumer;
   dispatch_async(self.queue, ^{
-    void *buffer = alloca(ReadBufferSize);
+    size_t chunkSize = MAX(connection.receiveChunkSize, (size_t) 1);
     while (self.state == FBFileReaderStateReading && self.finishedReadingMutable.state == FBFutureStateRunning) {
-      ssize_t readBytes = [connection receive:buffer size:ReadBufferSize];
+      // Each read is made into a buffer of its own that is handed to the consumer, rather than copied out of a shared one.
+      NSMutableData *data = [NSMutableData dataWithLength:chunkSize];
+      ssize_t readBytes = [connection receive:data.mutableBytes size:chunkSize];
       if (readBytes < 1) {
         break;
       }
-      NSData *data = [[NSData alloc] initWithBytes:buffer length:(size_t) readBytes];
+      data.length = (NSUInteger) readBytes;
       [consumer consumeData:data];
     }
     [consumer consumeEndOfFile];
@@ -116,6 +133,20 @@ static size_t ReadBufferSize = 1024 * 4;
 
 #pragma mark Initializers
 
++ (void)initialize
+{
+  if (self != FBAMDServiceConnection.class) {
+    return;
+  }
+  FBMetricsRegistry *registry = FBMetricsRegistry.sharedRegistry;
+  BytesSentCounter = [registry counterWithName:@"amd_service_connection.bytes_sent"];
+  BytesReceivedCounter = [registry counterWithName:@"amd_service_connection.bytes_received"];
+  CallsCounter = [registry counterWithName:@"amd_service_connection.calls"];
+  ErrorsCounter = [registry counterWithName:@"amd_service_connection.errors"];
+  SendLatencyHistogram = [registry histogramWithName:@"amd_service_connection.send_latency_ns"];
+  ReceiveLatencyHistogram = [registry histogramWithName:@"amd_service_connection.receive_latency_ns"];
+}
+
 + (instancetype)connectionWithName:(NSString *)name connection:(AMDServiceConnectionRef)connection device:(AMDeviceRef)device calls:(AMDCalls)calls logger:(id<FBControlCoreLogger>)logger
 {
   // Use Raw transfer when there's no Secure Context, otherwise we must use the service connection wrapping.
@@ -136,6 +167,8 @@ static size_t ReadBufferSize = 1024 * 4;
   _device = device;
   _calls = calls;
   _logger = logger;
+  _sendChunkSize = DefaultSendChunkSize;
+  _receiveChunkSize = DefaultReceiveChunkSize;
 
   return self;
 }
@@ -151,8 +184,12 @@ static size_t ReadBufferSize = 1024 * 4;
 
 - (BOOL)sendMessage:(id)message error:(NSError **)error
 {
+  uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
   int result = self.calls.ServiceConnectionSendMessage(self.connection, (__bridge CFPropertyListRef)(message), kCFPropertyListBinaryFormat_v1_0, NULL, NULL, NULL);
+  [CallsCounter increment];
+  [SendLatencyHistogram recordNanosecondsSince:startTime];
   if (result != 0) {
+    [ErrorsCounter increment];
     NSString *errorDescription = CFBridgingRelease(self.calls.CopyErrorText(result));
     return [[FBDeviceControlError
       describeFormat:@"Failed to send message %@ (%@ code %d)", errorDescription, message, result]
@@ -164,8 +201,12 @@ static size_t ReadBufferSize = 1024 * 4;
 - (id)receiveMessageWithError:(NSError **)error
 {
   CFTypeRef message = NULL;
+  uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
   int result = self.calls.ServiceConnectionReceiveMessage(self.connection, &message, NULL, NULL, NULL, NULL);
+  [CallsCounter increment];
+  [ReceiveLatencyHistogram recordNanosecondsSince:startTime];
   if (result != 0) {
+    [ErrorsCounter increment];
     NSString *errorDescription = CFBridgingRelease(self.calls.CopyErrorText(result));
     return [[FBDeviceControlError
       describeFormat:@"Failed to receive message (%@): code %d", errorDescription, result]
@@ -182,6 +223,44 @@ static size_t ReadBufferSize = 1024 * 4;
   return [self receiveMessageWithError:error];
 }
 
+- (NSArray<FBFuture<id> *> *)sendMessagesPipelined:(NSArray<id> *)messages depth:(NSUInteger)depth onQueue:(dispatch_queue_t)queue
+{
+  NSMutableArray<FBMutableFuture<id> *> *futures = [NSMutableArray arrayWithCapacity:messages.count];
+  for (NSUInteger index = 0; index < messages.count; index++) {
+    [futures addObject:FBMutableFuture.future];
+  }
+  depth = MAX(depth, 1u);
+  dispatch_async(queue, ^{
+    NSUInteger sent = 0;
+    for (NSUInteger received = 0; received < messages.count; received++) {
+      // Keep the pipeline full, bounded so that unread responses can't back up the device's writes whilst ours are blocked.
+      while (sent < messages.count && sent - received < depth) {
+        NSError *error = nil;
+        if (![self sendMessage:messages[sent] error:&error]) {
+          [FBAMDServiceConnection failFutures:futures fromIndex:received error:error];
+          return;
+        }
+        sent++;
+      }
+      NSError *error = nil;
+      id response = [self receiveMessageWithError:&error];
+      if (!response) {
+        [FBAMDServiceConnection failFutures:futures fromIndex:received error:error];
+        return;
+      }
+      [futures[received] resolveWithResult:response];
+    }
+  });
+  return [futures copy];
+}
+
++ (void)failFutures:(NSArray<FBMutableFuture<id> *> *)futures fromIndex:(NSUInteger)index error:(NSError *)error
+{
+  for (NSUInteger remaining = index; remaining < futures.count; remaining++) {
+    [futures[remaining] resolveWithError:error];
+  }
+}
+
 #pragma mark Lifecycle
 
 - (BOOL)invalidateWithError:(NSError **)error
@@ -228,64 +307,26 @@ static size_t ReadBufferSize = 1024 * 4;
 
 #pragma mark FBAMDServiceConnectionTransfer Implementation
 
-// There's an upper limit on the number of bytes we can receive at once
-static size_t SendBufferSize = 1024 * 4;
-
 - (BOOL)send:(NSData *)data error:(NSError **)error
 {
-  // Keep track of the number of bytes we can send.
-  size_t bytesRemaining = data.length;
-
-  // Start a loop that ends when there's no more bytes to send
-  while (bytesRemaining > 0) {
-    // Send the bytes now
-    NSRange sendRange = NSMakeRange(data.length - data.length, MIN(SendBufferSize, bytesRemaining));
-    NSData *chunkData = [data subdataWithRange:sendRange];
-    ssize_t result = [self send:chunkData.bytes size:chunkData.length];
-    // A negative return indicates error.
-    if (result == -1) {
-      return [[FBDeviceControlError
-        describeFormat:@"Failure in send of %zu bytes: %s", chunkData.length, strerror(errno)]
-        failBool:error];
-    }
-    // End of file.
-    if (result == 0) {
-      break;
-    }
-    // Check an over-write to prevent unsigned integer overflow.
-    size_t sentBytes = (size_t) result;
-    if (sentBytes > bytesRemaining) {
-      return [[FBDeviceControlError
-        describeFormat:@"Failure in send: Sent %zu bytes but only %zu bytes remaining", sentBytes, bytesRemaining]
-        failBool:error];
-    }
-    // Otherwise keep going and decrement the number of remaining bytes to send.
-    bytesRemaining -= sentBytes;
-  }
-
-  // Check that we've sent the right number of bytes.
-  if (bytesRemaining != 0) {
-    return [[FBDeviceControlError
-      describeFormat:@"Failed to send %zu bytes, %zu remaining", data.length, bytesRemaining]
-      failBool:error];
-  }
-  return YES;
+  return [self send:data fromOffset:0 error:error];
 }
 
 - (BOOL)sendWithLengthHeader:(NSData *)data error:(NSError **)error
 {
   HeaderIntType length = (HeaderIntType) data.length;
   HeaderIntType lengthWire = OSSwapHostToBigInt32(length); // The host (native) length should be converted endianness of remote (ARM/Apple Silicon).
-  NSData *lengthData = [[NSData alloc] initWithBytes:&lengthWire length:HeaderLength];
-  // Write the length data.
-  if (![self send:lengthData error:error]) {
+  // Send the header in the same write as the start of the payload, rather than as a write of its own.
+  // The connection may be wrapped in a secure context so there's no writev, instead the head of the payload is coalesced into a small buffer.
+  uint8_t coalesced[CoalescedSendSize];
+  size_t payloadHeadLength = MIN(data.length, CoalescedSendSize - HeaderLength);
+  memcpy(coalesced, &lengthWire, HeaderLength);
+  [data getBytes:coalesced + HeaderLength range:NSMakeRange(0, payloadHeadLength)];
+  if (![self sendBytes:coalesced length:HeaderLength + payloadHeadLength error:error]) {
     return NO;
   }
-  // Then send the actual payload.
-  if (![self send:data error:error]) {
-   return NO;
-  }
-  return YES;
+  // Then send the remainder of the payload directly from its storage.
+  return [self send:data fromOffset:payloadHeadLength error:error];
 }
 
 - (BOOL)sendUnsignedInt32:(uint32_t)value error:(NSError **)error
@@ -296,55 +337,100 @@ static size_t SendBufferSize = 1024 * 4;
 
 - (NSData *)receive:(size_t)size error:(NSError **)error
 {
-  // Create a buffer that contains the data to return and how to append it from the enumerator
-  NSMutableData *data = NSMutableData.data;
-  void(^enumerator)(NSData *) = ^(NSData *chunk){
-    [data appendData:[chunk copy]];
-  };
-  // Start the byte recieve.
-  BOOL success = [self enumateReceiveOfLength:size chunkSize:ReadBufferSize enumerator:enumerator error:error];
-  if (!success) {
+  // Receive directly into the storage of the returned data.
+  NSMutableData *data = [NSMutableData dataWithCapacity:size];
+  if (![self receive:size appendingToData:data error:error]) {
     return nil;
   }
   return data;
 }
 
+- (BOOL)receive:(size_t)size appendingToData:(NSMutableData *)data error:(NSError **)error
+{
+  NSUInteger offset = data.length;
+  data.length = offset + size;
+  if (![self receive:(uint8_t *) data.mutableBytes + offset ofSize:size error:error]) {
+    data.length = offset;
+    return NO;
+  }
+  return YES;
+}
+
 - (BOOL)receive:(size_t)size toFile:(NSFileHandle *)fileHandle error:(NSError **)error
 {
   void(^enumerator)(NSData *) = ^(NSData *chunk){
     [fileHandle writeData:chunk];
   };
-  return [self enumateReceiveOfLength:size chunkSize:ReadBufferSize enumerator:enumerator error:error];
+  return [self enumateReceiveOfLength:size chunkSize:self.receiveChunkSize enumerator:enumerator error:error];
 }
 
 - (BOOL)receive:(void *)destination ofSize:(size_t)size error:(NSError **)error
 {
-  NSData *data = [self receive:size error:error];
-  if (!data) {
-    return NO;
+  // Start reading in a loop, until there's no more bytes to read, advancing through the destination on each read.
+  uint8_t *cursor = destination;
+  size_t bytesRemaining = size;
+  size_t chunkSize = MAX(self.receiveChunkSize, (size_t) 1);
+  while (bytesRemaining > 0) {
+    size_t maxReadBytes = MIN(chunkSize, bytesRemaining);
+    ssize_t result = [self receive:cursor size:maxReadBytes];
+    // End of file.
+    if (result == 0) {
+      break;
+    }
+    // A negative return indicates an error
+    if (result == -1) {
+      return [[FBDeviceControlError
+        describeFormat:@"Failure in receive of %zu bytes: %s", maxReadBytes, strerror(errno)]
+        failBool:error];
+    }
+    // Check an over-read to prevent unsigned integer overflow.
+    size_t readBytes = (size_t) result;
+    if (readBytes > bytesRemaining) {
+      return [[FBDeviceControlError
+        describeFormat:@"Failure in receive: Read %zu bytes but only %zu bytes remaining", readBytes, bytesRemaining]
+        failBool:error];
+    }
+    cursor += readBytes;
+    bytesRemaining -= readBytes;
+  }
+
+  // Check that we've read the right number of bytes.
+  if (bytesRemaining != 0) {
+    return [[FBDeviceControlError
+      describeFormat:@"Failed to receive %zu bytes, %zu remaining to read and eof reached.", size, bytesRemaining]
+      failBool:error];
   }
-  memcpy(destination, data.bytes, data.length);
   return YES;
 }
 
 - (NSData *)receiveUpTo:(size_t)size error:(NSError **)error
 {
-  // Create a buffer that contains the data
-  void *buffer = alloca(size);
-  // Read the underlying bytes.
-  ssize_t result = [self receive:buffer size:size];
-  // End of file.
-  if (result == 0) {
-    return NSData.data;
+  // The size is provided by the caller, so the buffer is on the heap rather than the stack.
+  NSMutableData *data = [NSMutableData dataWithCapacity:size];
+  ssize_t result = [self receiveUpTo:size appendingToData:data error:error];
+  if (result == -1) {
+    return nil;
   }
+  return data;
+}
+
+- (ssize_t)receiveUpTo:(size_t)size appendingToData:(NSMutableData *)data error:(NSError **)error
+{
+  NSUInteger offset = data.length;
+  data.length = offset + size;
+  // Read the underlying bytes.
+  ssize_t result = [self receive:(uint8_t *) data.mutableBytes + offset size:size];
   // A negative return indicates an error
   if (result == -1) {
-    return [[FBDeviceControlError
+    data.length = offset;
+    [[FBDeviceControlError
       describeFormat:@"Failure in receive of up to %zu bytes: %s", size, strerror(errno)]
       fail:error];
+    return -1;
   }
-  size_t readBytes = (size_t) result;
-  return [[NSData alloc] initWithBytes:buffer length:readBytes];
+  // Trim to the bytes that were read, none at end of file.
+  data.length = offset + (NSUInteger) result;
+  return result;
 }
 
 - (BOOL)receiveUnsignedInt32:(uint32_t *)valueOut error:(NSError **)error
@@ -373,18 +459,101 @@ static size_t SendBufferSize = 1024 * 4;
 
 - (ssize_t)send:(const void *)buffer size:(size_t)size
 {
-  return self.calls.ServiceConnectionSend(self.connection, buffer, size);
+  uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  ssize_t result = self.calls.ServiceConnectionSend(self.connection, buffer, size);
+  [self.class recordTransfer:result latencySince:startTime counter:BytesSentCounter histogram:SendLatencyHistogram];
+  return result;
 }
 
 - (ssize_t)receive:(void *)buffer size:(size_t)size
 {
-  return self.calls.ServiceConnectionReceive(self.connection, buffer, size);
+  uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  ssize_t result = self.calls.ServiceConnectionReceive(self.connection, buffer, size);
+  [self.class recordTransfer:result latencySince:startTime counter:BytesReceivedCounter histogram:ReceiveLatencyHistogram];
+  return result;
+}
+
++ (void)recordTransfer:(ssize_t)result latencySince:(uint64_t)startTime counter:(FBMetricsCounter *)counter histogram:(FBMetricsHistogram *)histogram
+{
+  [CallsCounter increment];
+  [histogram recordNanosecondsSince:startTime];
+  if (result < 0) {
+    [ErrorsCounter increment];
+    return;
+  }
+  [counter add:(uint64_t) result];
+}
+
+- (BOOL)send:(NSData *)data fromOffset:(size_t)offset error:(NSError **)error
+{
+  // Send each of the regions of the data in place, a dispatch_data backed NSData may not be contiguous.
+  __block NSError *innerError = nil;
+  __block BOOL success = YES;
+  [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+    if (NSMaxRange(byteRange) <= offset) {
+      return;
+    }
+    size_t skip = offset > byteRange.location ? offset - byteRange.location : 0;
+    if (![self sendBytes:(const uint8_t *) bytes + skip length:byteRange.length - skip error:&innerError]) {
+      success = NO;
+      *stop = YES;
+    }
+  }];
+  if (!success) {
+    if (error) {
+      *error = innerError;
+    }
+    return NO;
+  }
+  return YES;
+}
+
+- (BOOL)sendBytes:(const void *)bytes length:(size_t)length error:(NSError **)error
+{
+  // Start a loop that ends when there's no more bytes to send, advancing through the buffer on each send.
+  const uint8_t *cursor = bytes;
+  size_t bytesRemaining = length;
+  size_t chunkSize = MAX(self.sendChunkSize, (size_t) 1);
+  while (bytesRemaining > 0) {
+    size_t chunkLength = MIN(chunkSize, bytesRemaining);
+    ssize_t result = [self send:cursor size:chunkLength];
+    // A negative return indicates error.
+    if (result == -1) {
+      return [[FBDeviceControlError
+        describeFormat:@"Failure in send of %zu bytes: %s", chunkLength, strerror(errno)]
+        failBool:error];
+    }
+    // End of file.
+    if (result == 0) {
+      break;
+    }
+    // Check an over-write to prevent unsigned integer overflow.
+    size_t sentBytes = (size_t) result;
+    if (sentBytes > bytesRemaining) {
+      return [[FBDeviceControlError
+        describeFormat:@"Failure in send: Sent %zu bytes but only %zu bytes remaining", sentBytes, bytesRemaining]
+        failBool:error];
+    }
+    // Otherwise keep going from where the send finished, a short send resumes at the first unsent byte.
+    cursor += sentBytes;
+    bytesRemaining -= sentBytes;
+  }
+
+  // Check that we've sent the right number of bytes.
+  if (bytesRemaining != 0) {
+    return [[FBDeviceControlError
+      describeFormat:@"Failed to send %zu bytes, %zu remaining", length, bytesRemaining]
+      failBool:error];
+  }
+  return YES;
 }
 
 - (BOOL)enumateReceiveOfLength:(size_t)size chunkSize:(size_t)chunkSize enumerator:(void(^)(NSData *))enumerator error:(NSError **)error
 {
-  // Create a buffer that contains the incremental enumerated data.
-  void *buffer = alloca(chunkSize);
+  // Create a buffer that contains the incremental enumerated data, this is re-used for each read.
+  NSMutableData *bufferData = [NSMutableData dataWithLength:MAX(MIN(chunkSize, size), (size_t) 1)];
+  void *buffer = bufferData.mutableBytes;
+  chunkSize = bufferData.length;
 
   // Start reading in a loop, until there's no more bytes to read.
   size_t bytesRemaining = size;
@@ -22,9 +22,28 @@
 #import "FBDeviceControlFrameworkLoader.h"
 #import "FBDeviceLinkClient.h"
 
+static NSString *FBAMDeviceInterfaceDescription(FBAMDeviceInterface interface)
+{
+  switch (interface) {
+    case FBAMDeviceInterfaceUSB:
+      return @"USB";
+    case FBAMDeviceInterfaceNetwork:
+      return @"Network";
+    default:
+      return @"Unknown";
+  }
+}
+
 #pragma mark - FBAMDevice Implementation
 
-@implementation FBAMDevice
+@implementation FBAMDevice {
+  // The references for each attached interface, retained with calls.Retain. Guarded by synchronizing on self.
+  NSMutableDictionary<NSNumber *, NSValue *> *_attachedAMDeviceRefs;
+  FBAMDeviceInterface _interfaceType;
+  FBAMDeviceConnectionPolicy _connectionPolicy;
+  // The reference that the shared session was started on, so that it is stopped on the same one if amDeviceRef fails over in the meantime.
+  AMDeviceRef _sessionAMDeviceRef;
+}
 
 @synthesize amDeviceRef = _amDeviceRef;
 @synthesize asyncQueue = _asyncQueue;
@@ -50,6 +69,8 @@
   _connectionContextManager = [FBFutureContextManager managerWithQueue:workQueue delegate:self logger:logger];
   _contextPoolTimeout = connectionReuseTimeout;
   _serviceManager = [FBAMDeviceServiceManager managerWithAMDevice:self serviceTimeout:serviceReuseTimeout];
+  _attachedAMDeviceRefs = NSMutableDictionary.dictionary;
+  _connectionPolicy = FBAMDeviceConnectionPolicyPreferUSB;
 
   return self;
 }
@@ -73,6 +94,41 @@
   return _amDeviceRef;
 }
 
+- (FBAMDeviceInterface)interfaceType
+{
+  @synchronized (self) {
+    return _interfaceType;
+  }
+}
+
+- (NSArray<NSNumber *> *)attachedInterfaces
+{
+  @synchronized (self) {
+    return [_attachedAMDeviceRefs.allKeys sortedArrayUsingSelector:@selector(compare:)];
+  }
+}
+
+- (FBAMDeviceConnectionPolicy)connectionPolicy
+{
+  @synchronized (self) {
+    return _connectionPolicy;
+  }
+}
+
+- (void)setConnectionPolicy:(FBAMDeviceConnectionPolicy)connectionPolicy
+{
+  BOOL changed = NO;
+  @synchronized (self) {
+    _connectionPolicy = connectionPolicy;
+    changed = [self selectAMDeviceRef];
+  }
+  if (changed) {
+    // Pooled services were started over the previous interface.
+    [self.logger logFormat:@"Connection policy changed, connecting over %@", FBAMDeviceInterfaceDescription(self.interfaceType)];
+    [self.serviceManager deviceAttached];
+  }
+}
+
 - (NSDictionary<NSString *, id> *)extendedInformation
 {
   return @{
@@ -112,13 +168,13 @@
 
 - (FBDeviceType *)deviceType
 {
-  return FBiOSTargetConfiguration.productTypeToDevice[self.allValues[FBDeviceKeyProductType]];
+  return [FBiOSTargetConfiguration deviceTypeForProductType:self.allValues[FBDeviceKeyProductType]];
 }
 
 - (FBOSVersion *)osVersion
 {
   NSString *osVersion = [FBAMDevice osVersionForDeviceClass:self.allValues[FBDeviceKeyDeviceClass] productVersion:self.productVersion];
-  return FBiOSTargetConfiguration.nameToOSVersion[osVersion] ?: [FBOSVersion genericWithName:osVersion];
+  return [FBiOSTargetConfiguration OSVersionForName:osVersion] ?: [FBOSVersion genericWithName:osVersion];
 }
 
 - (FBiOSTargetState)state
@@ -131,6 +187,115 @@
   return FBiOSTargetTypeDevice;
 }
 
+#pragma mark Interfaces
+
++ (FBAMDeviceInterface)interfaceOfAMDeviceRef:(AMDeviceRef)amDeviceRef calls:(AMDCalls)calls
+{
+  if (calls.GetInterfaceType) {
+    switch (calls.GetInterfaceType(amDeviceRef)) {
+      case 1:
+        return FBAMDeviceInterfaceUSB;
+      case 2:
+        return FBAMDeviceInterfaceNetwork;
+      default:
+        return FBAMDeviceInterfaceUnknown;
+    }
+  }
+  // Only devices attached over USB have a USB location.
+  if (calls.USBLocationID && calls.USBLocationID(amDeviceRef) != 0) {
+    return FBAMDeviceInterfaceUSB;
+  }
+  return FBAMDeviceInterfaceUnknown;
+}
+
+- (BOOL)attachAMDeviceRef:(AMDeviceRef)amDeviceRef interface:(FBAMDeviceInterface)interface
+{
+  @synchronized (self) {
+    NSNumber *key = @(interface);
+    AMDeviceRef previous = _attachedAMDeviceRefs[key].pointerValue;
+    if (previous != amDeviceRef) {
+      self.calls.Retain(amDeviceRef);
+      _attachedAMDeviceRefs[key] = [NSValue valueWithPointer:amDeviceRef];
+      if (previous) {
+        self.calls.Release(previous);
+      }
+    }
+    BOOL changed = [self selectAMDeviceRef];
+    [self.logger logFormat:@"Attached over %@, connecting over %@", FBAMDeviceInterfaceDescription(interface), FBAMDeviceInterfaceDescription(_interfaceType)];
+    return changed;
+  }
+}
+
+- (BOOL)detachAMDeviceRef:(AMDeviceRef)amDeviceRef
+{
+  @synchronized (self) {
+    for (NSNumber *key in _attachedAMDeviceRefs.allKeys) {
+      if (_attachedAMDeviceRefs[key].pointerValue != amDeviceRef) {
+        continue;
+      }
+      [_attachedAMDeviceRefs removeObjectForKey:key];
+      self.calls.Release(amDeviceRef);
+      [self.logger logFormat:@"Detached from %@", FBAMDeviceInterfaceDescription(key.unsignedIntegerValue)];
+    }
+    if (_attachedAMDeviceRefs.count == 0) {
+      return NO;
+    }
+    if ([self selectAMDeviceRef]) {
+      [self.logger logFormat:@"Failed over to %@", FBAMDeviceInterfaceDescription(_interfaceType)];
+    }
+    return YES;
+  }
+}
+
+- (BOOL)hasAMDeviceRef:(AMDeviceRef)amDeviceRef
+{
+  @synchronized (self) {
+    for (NSValue *value in _attachedAMDeviceRefs.allValues) {
+      if (value.pointerValue == amDeviceRef) {
+        return YES;
+      }
+    }
+    return amDeviceRef == _amDeviceRef;
+  }
+}
+
+// Chooses amDeviceRef from the attached interfaces, returning YES if it changed. Called whilst synchronized on self.
+- (BOOL)selectAMDeviceRef
+{
+  NSArray<NSNumber *> *preference = nil;
+  switch (_connectionPolicy) {
+    case FBAMDeviceConnectionPolicyPreferNetwork:
+      preference = @[@(FBAMDeviceInterfaceNetwork), @(FBAMDeviceInterfaceUSB), @(FBAMDeviceInterfaceUnknown)];
+      break;
+    case FBAMDeviceConnectionPolicyUSBOnly:
+      // Where the interface type cannot be determined, the reference is allowed rather than leaving the device unreachable.
+      preference = @[@(FBAMDeviceInterfaceUSB), @(FBAMDeviceInterfaceUnknown)];
+      break;
+    default:
+      preference = @[@(FBAMDeviceInterfaceUSB), @(FBAMDeviceInterfaceUnknown), @(FBAMDeviceInterfaceNetwork)];
+      break;
+  }
+  for (NSNumber *interface in preference) {
+    AMDeviceRef amDeviceRef = _attachedAMDeviceRefs[interface].pointerValue;
+    if (!amDeviceRef) {
+      continue;
+    }
+    _interfaceType = interface.unsignedIntegerValue;
+    if (amDeviceRef == _amDeviceRef) {
+      return NO;
+    }
+    self.amDeviceRef = amDeviceRef;
+    return YES;
+  }
+  if (_attachedAMDeviceRefs.count == 0 || !_amDeviceRef) {
+    return NO;
+  }
+  // Attached, but not over an interface that the policy allows.
+  _interfaceType = FBAMDeviceInterfaceUnknown;
+  self.amDeviceRef = NULL;
+  return YES;
+}
+
 #pragma mark FBDevice Protocol Implementation
 
 - (AMRecoveryModeDeviceRef)recoveryModeDeviceRef
@@ -195,6 +360,17 @@
     }];
 }
 
+- (FBFutureContext<FBAMDServiceConnection *> *)pooledService:(NSString *)service
+{
+  return [[self
+    connectToDeviceWithPurpose:@"pooled_service_%@", service]
+    onQueue:self.workQueue replace:^ FBFutureContext<FBAMDServiceConnection *> * (id<FBDeviceCommands> device) {
+      return [[self.serviceManager
+        serviceConnectionPoolForService:service]
+        utilizeWithPurpose:self.udid];
+    }];
+}
+
 - (FBFutureContext<FBDeviceLinkClient *> *)startDeviceLinkService:(NSString *)service
 {
   return [[self
@@ -229,16 +405,25 @@
 - (FBFuture<FBAMDevice *> *)prepare:(id<FBControlCoreLogger>)logger
 {
   NSError *error = nil;
-  if (![FBAMDeviceManager startUsing:self.amDevice calls:self.calls logger:logger error:&error]) {
+  AMDeviceRef amDeviceRef = self.amDevice;
+  if (![FBAMDeviceManager startUsing:amDeviceRef calls:self.calls logger:logger error:&error]) {
     return [FBFuture futureWithError:error];
   }
+  self.calls.Retain(amDeviceRef);
+  _sessionAMDeviceRef = amDeviceRef;
   return [FBFuture futureWithResult:self];
 }
 
 - (FBFuture<NSNull *> *)teardown:(FBAMDevice *)device logger:(id<FBControlCoreLogger>)logger;
 {
   NSError *error = nil;
-  if (![FBAMDeviceManager stopUsing:self.amDevice calls:self.calls logger:logger error:&error]) {
+  AMDeviceRef amDeviceRef = _sessionAMDeviceRef ?: self.amDevice;
+  BOOL stopped = [FBAMDeviceManager stopUsing:amDeviceRef calls:self.calls logger:logger error:&error];
+  if (_sessionAMDeviceRef) {
+    self.calls.Release(_sessionAMDeviceRef);
+    _sessionAMDeviceRef = NULL;
+  }
+  if (!stopped) {
     return [FBFuture futureWithError:error];
   }
   return FBFuture.empty;
@@ -264,9 +449,10 @@
 - (NSString *)description
 {
   return [NSString stringWithFormat:
-    @"AMDevice %@ | %@",
+    @"AMDevice %@ | %@ | %@",
     self.udid,
-    self.name
+    self.name,
+    FBAMDeviceInterfaceDescription(self.interfaceType)
   ];
 }
 
@@ -8,11 +8,25 @@
 #import "FBAMDeviceManager.h"
 
 #import "FBAMDevice+Private.h"
+#import "FBAMDeviceServiceManager.h"
 #import "FBAMRestorableDevice.h"
 #import "FBDeviceControlError.h"
 #import "FBDeviceControlFrameworkLoader.h"
 
-static NSString *const MobileBackupDomain = @"com.apple.mobile.backup";
+// Each bring-up holds a lockdown connection whilst it runs, so the number at once is bounded rather than one per attached device.
+static const long MaximumConcurrentBringUps = 4;
+
+static FBMetricsCounter *BringUpsSucceededCounter;
+static FBMetricsCounter *BringUpsFailedCounter;
+static FBMetricsHistogram *BringUpWaitHistogram;
+static FBMetricsHistogram *BringUpDurationHistogram;
+
+// The states of a device that is being brought up, keyed by its AMDeviceRef.
+typedef NS_ENUM(NSUInteger, FBAMDeviceBringUpState) {
+  FBAMDeviceBringUpStateRunning = 0,
+  FBAMDeviceBringUpStateRepeat = 1,
+  FBAMDeviceBringUpStateCancelled = 2,
+};
 
 @interface FBAMDeviceManager ()
 
@@ -27,12 +41,17 @@ static NSString *const MobileBackupDomain = @"com.apple.mobile.backup";
 @property (nonatomic, assign, readonly) AMDCalls calls;
 @property (nonatomic, copy, nullable, readonly) NSString *ecidFilter;
 @property (nonatomic, assign, readwrite) AMDNotificationSubscription subscription;
+@property (nonatomic, strong, readonly) dispatch_queue_t bringUpAdmissionQueue;
+@property (nonatomic, strong, readonly) dispatch_semaphore_t bringUpSemaphore;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSValue *, NSNumber *> *bringUpStates;
 
-- (NSString *)identifierForDevice:(AMDeviceRef)device;
+- (FBAMDevice *)publicDeviceForDevice:(AMDeviceRef)device;
+- (void)scheduleBringUpOfDevice:(AMDeviceRef)device;
+- (void)scheduleDisconnectionOfDevice:(AMDeviceRef)device;
 
 @end
 
-static BOOL FB_AMDeviceConnected(AMDeviceRef device, FBAMDeviceManager *manager)
+static NSDictionary<NSString *, id> *FB_AMDeviceBringUp(AMDeviceRef device, FBAMDeviceManager *manager, NSString **uniqueChipIDOut)
 {
   NSError *error = nil;
   id<FBControlCoreLogger> logger = manager.logger;
@@ -41,18 +60,18 @@ static BOOL FB_AMDeviceConnected(AMDeviceRef device, FBAMDeviceManager *manager)
   // Start with a basic connection. This should always succeed, even if the device is not paired.
   if (![FBAMDeviceManager startConnectionToDevice:device calls:calls logger:logger error:&error]) {
     [logger.error logFormat:@"Cannot connect to device, ignoring device %@", error];
-    return NO;
+    return nil;
   }
   NSString *uniqueChipID = [CFBridgingRelease(calls.CopyValue(device, NULL, (__bridge CFStringRef)(FBDeviceKeyUniqueChipID))) stringValue];
   if (!uniqueChipID) {
     [FBAMDeviceManager stopConnectionToDevice:device calls:calls logger:logger error:nil];
     [logger.error logFormat:@"Ignoring device as cannot obtain ECID for it"];
-    return NO;
+    return nil;
   }
   if (manager.ecidFilter && ![uniqueChipID isEqualToString:manager.ecidFilter]) {
     [FBAMDeviceManager stopConnectionToDevice:device calls:calls logger:logger error:nil];
     [logger.error logFormat:@"Ignoring device as ECID %@ does not match filter %@", uniqueChipID, manager.ecidFilter];
-    return NO;
+    return nil;
   }
 
   NSError *pairingError = nil;
@@ -73,16 +92,16 @@ static BOOL FB_AMDeviceConnected(AMDeviceRef device, FBAMDeviceManager *manager)
 
   if (!info) {
     [logger.error log:@"Ignoring device as no values were returned for it"];
-    return NO;
+    return nil;
   }
   NSString *udid = info[FBDeviceKeyUniqueDeviceID];
   if (!udid) {
     [logger.error logFormat:@"Ignoring device as %@ is not present in %@", FBDeviceKeyUniqueDeviceID, info];
-    return NO;
+    return nil;
   }
   [logger.debug logFormat:@"Obtained Device Values %@", info];
-  [manager deviceConnected:device identifier:uniqueChipID info:info];
-  return YES;
+  *uniqueChipIDOut = uniqueChipID;
+  return info;
 }
 
 static void FB_AMDeviceListenerCallback(AMDeviceNotification *notification, FBAMDeviceManager *manager)
@@ -93,17 +112,11 @@ static void FB_AMDeviceListenerCallback(AMDeviceNotification *notification, FBAM
   switch (notificationType) {
     case AMDeviceNotificationTypeConnected:
     case AMDeviceNotificationTypePaired:
-      FB_AMDeviceConnected(device, manager);
+      [manager scheduleBringUpOfDevice:device];
       return;
-    case AMDeviceNotificationTypeDisconnected: {
-      NSString *identifier = [manager identifierForDevice:device];
-      if (!identifier) {
-        [logger logFormat:@"Cannot obtain identifier for device %@", device];
-        return;
-      }
-      [manager deviceDisconnected:device identifier:[manager identifierForDevice:device]];
+    case AMDeviceNotificationTypeDisconnected:
+      [manager scheduleDisconnectionOfDevice:device];
       return;
-    }
     case AMDeviceNotificationTypeUnsubscribed:
       [logger logFormat:@"Unsubscribed from AMDeviceNotificationSubscribe"];
       return;
@@ -117,6 +130,18 @@ static void FB_AMDeviceListenerCallback(AMDeviceNotification *notification, FBAM
 
 #pragma mark Initializers
 
++ (void)initialize
+{
+  if (self != FBAMDeviceManager.class) {
+    return;
+  }
+  FBMetricsRegistry *registry = FBMetricsRegistry.sharedRegistry;
+  BringUpsSucceededCounter = [registry counterWithName:@"device_bring_up.succeeded"];
+  BringUpsFailedCounter = [registry counterWithName:@"device_bring_up.failed"];
+  BringUpWaitHistogram = [registry histogramWithName:@"device_bring_up.wait_ns"];
+  BringUpDurationHistogram = [registry histogramWithName:@"device_bring_up.duration_ns"];
+}
+
 - (instancetype)initWithCalls:(AMDCalls)calls workQueue:(dispatch_queue_t)workQueue asyncQueue:(dispatch_queue_t)asyncQueue ecidFilter:(NSString *)ecidFilter logger:(id<FBControlCoreLogger>)logger
 {
   self = [super initWithLogger:logger];
@@ -128,6 +153,9 @@ static void FB_AMDeviceListenerCallback(AMDeviceNotification *notification, FBAM
   _workQueue = workQueue;
   _asyncQueue = asyncQueue;
   _ecidFilter = ecidFilter;
+  _bringUpAdmissionQueue = dispatch_queue_create("com.facebook.fbdevicecontrol.amdevice_bring_up", DISPATCH_QUEUE_SERIAL);
+  _bringUpSemaphore = dispatch_semaphore_create(MaximumConcurrentBringUps);
+  _bringUpStates = NSMutableDictionary.dictionary;
 
   return self;
 }
@@ -219,8 +247,15 @@ static const NSTimeInterval ServiceReuseTimeout = 6.0;
 
 + (void)updatePublicReference:(FBAMDevice *)publicDevice privateDevice:(AMDeviceRef)privateDevice identifier:(NSString *)identifier info:(NSDictionary<NSString *,id> *)info
 {
-  publicDevice.amDeviceRef = privateDevice;
+  // A device reachable over both USB and the network is notified once per interface, the connection policy chooses which one is used.
+  FBAMDeviceInterface interface = [FBAMDevice interfaceOfAMDeviceRef:privateDevice calls:publicDevice.calls];
+  BOOL firstInterface = publicDevice.attachedInterfaces.count == 0;
+  if (![publicDevice attachAMDeviceRef:privateDevice interface:interface] && !firstInterface) {
+    return;
+  }
+  // Values such as the USB location are specific to the interface, so are taken from the one that is connected over.
   publicDevice.allValues = info;
+  [publicDevice.serviceManager deviceAttached];
 }
 
 + (AMDeviceRef)extractPrivateReference:(FBAMDevice *)publicDevice
@@ -230,16 +265,96 @@ static const NSTimeInterval ServiceReuseTimeout = 6.0;
 
 #pragma mark Private
 
-- (NSString *)identifierForDevice:(AMDeviceRef)amDevice
+- (void)scheduleBringUpOfDevice:(AMDeviceRef)device
+{
+  // The reference is retained until the bring-up has finished, as it may be released by MobileDevice when the device detaches.
+  CFRetain(device);
+  dispatch_async(self.workQueue, ^{
+    NSValue *key = [NSValue valueWithPointer:device];
+    if (self.bringUpStates[key]) {
+      // Connecting and pairing may both be notified for one device, the second runs once the first has finished so that each device has one bring-up at a time.
+      self.bringUpStates[key] = @(FBAMDeviceBringUpStateRepeat);
+      CFRelease(device);
+      return;
+    }
+    self.bringUpStates[key] = @(FBAMDeviceBringUpStateRunning);
+    [self bringUpDevice:device key:key];
+  });
+}
+
+- (void)bringUpDevice:(AMDeviceRef)device key:(NSValue *)key
+{
+  // The admission queue is the only one that waits for a slot, so the waiting for bring-ups of many devices does not occupy many threads.
+  uint64_t scheduledTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  dispatch_async(self.bringUpAdmissionQueue, ^{
+    dispatch_semaphore_wait(self.bringUpSemaphore, DISPATCH_TIME_FOREVER);
+    dispatch_async(self.asyncQueue, ^{
+      uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+      [BringUpWaitHistogram record:startTime - scheduledTime];
+      NSString *uniqueChipID = nil;
+      NSDictionary<NSString *, id> *info = FB_AMDeviceBringUp(device, self, &uniqueChipID);
+      dispatch_semaphore_signal(self.bringUpSemaphore);
+      [BringUpDurationHistogram recordNanosecondsSince:startTime];
+      [(info ? BringUpsSucceededCounter : BringUpsFailedCounter) increment];
+      dispatch_async(self.workQueue, ^{
+        // Each device is published as soon as its own values are ready, rather than once all devices are.
+        FBAMDeviceBringUpState state = self.bringUpStates[key].unsignedIntegerValue;
+        if (info && state != FBAMDeviceBringUpStateCancelled) {
+          [self deviceConnected:device identifier:uniqueChipID info:info];
+        }
+        if (state == FBAMDeviceBringUpStateRepeat) {
+          self.bringUpStates[key] = @(FBAMDeviceBringUpStateRunning);
+          [self bringUpDevice:device key:key];
+          return;
+        }
+        [self.bringUpStates removeObjectForKey:key];
+        CFRelease(device);
+      });
+    });
+  });
+}
+
+- (void)scheduleDisconnectionOfDevice:(AMDeviceRef)device
+{
+  CFRetain(device);
+  dispatch_async(self.workQueue, ^{
+    // A device that detaches during its bring-up is not published when the bring-up finishes.
+    NSValue *key = [NSValue valueWithPointer:device];
+    if (self.bringUpStates[key]) {
+      self.bringUpStates[key] = @(FBAMDeviceBringUpStateCancelled);
+    }
+    FBAMDevice *amDevice = [self publicDeviceForDevice:device];
+    NSString *identifier = amDevice.uniqueIdentifier;
+    if (!identifier) {
+      [self.logger logFormat:@"Cannot obtain identifier for device %@", device];
+      CFRelease(device);
+      return;
+    }
+    // Unplugging one interface of a device that is reachable over another fails over to it, rather than removing the device.
+    AMDeviceRef previous = amDevice.amDeviceRef;
+    if ([amDevice detachAMDeviceRef:device]) {
+      if (amDevice.amDeviceRef != previous) {
+        [amDevice.serviceManager deviceAttached];
+      }
+      [self.delegate targetUpdated:amDevice inTargetSet:self];
+      CFRelease(device);
+      return;
+    }
+    [self deviceDisconnected:device identifier:identifier];
+    CFRelease(device);
+  });
+}
+
+- (FBAMDevice *)publicDeviceForDevice:(AMDeviceRef)amDevice
 {
   if (amDevice == NULL) {
     return nil;
   }
   for (FBAMDevice *device in self.storage.referenced.allValues) {
-    if (device.amDeviceRef != amDevice) {
+    if (![device hasAMDeviceRef:amDevice]) {
       continue;
     }
-    return device.uniqueIdentifier;
+    return device;
   }
   return nil;
 }
@@ -317,24 +432,56 @@ static const NSTimeInterval ServiceReuseTimeout = 6.0;
   return YES;
 }
 
++ (NSArray<FBDeviceKey> *)attachedValueKeys
+{
+  static dispatch_once_t onceToken;
+  static NSArray<FBDeviceKey> *keys;
+  dispatch_once(&onceToken, ^{
+    keys = @[
+      FBDeviceKeyActivationState,
+      FBDeviceKeyBuildVersion,
+      FBDeviceKeyChipID,
+      FBDeviceKeyCPUArchitecture,
+      FBDeviceKeyDeviceClass,
+      FBDeviceKeyDeviceName,
+      FBDeviceKeyHardwareModel,
+      FBDeviceKeyModelNumber,
+      FBDeviceKeyProductType,
+      FBDeviceKeyProductVersion,
+      FBDeviceKeySerialNumber,
+      FBDeviceKeyUniqueChipID,
+      FBDeviceKeyUniqueDeviceID,
+    ];
+  });
+  return keys;
+}
+
 + (NSDictionary<NSString *, id> *)obtainDeviceValues:(AMDeviceRef)device calls:(AMDCalls)calls
 {
   // Get the values from the default domain, this will obtain information regardless of whether pairing was successful or not.
-  NSMutableDictionary<NSString *, id> *info = [CFBridgingRelease(calls.CopyValue(device, NULL, NULL)) mutableCopy];
-  if (!info) {
+  // The whole domain is one round-trip, but only the values needed to list and identify the device are kept. Anything else, including other domains, is fetched on request by FBDeviceValueCommands.
+  NSDictionary<NSString *, id> *defaultDomain = CFBridgingRelease(calls.CopyValue(device, NULL, NULL));
+  if (!defaultDomain) {
     return nil;
   }
+  NSMutableDictionary<NSString *, id> *info = NSMutableDictionary.dictionary;
+  for (FBDeviceKey key in self.attachedValueKeys) {
+    id value = defaultDomain[key];
+    if (value) {
+      info[key] = value;
+    }
+  }
 
   // Synthetic Values.
   BOOL isPaired = calls.IsPaired(device) != 0;
   info[FBDeviceKeyIsPaired] = @(isPaired);
+  // The location of the USB port, which is absent for devices that are connected over the network.
+  uint32_t locationID = calls.USBLocationID ? calls.USBLocationID(device) : 0;
+  if (locationID != 0) {
+    info[FBDeviceKeyLocationID] = @(locationID);
+  }
 
-  // Get values from mobile backup, this will only return meaningful information if paired.
-  NSDictionary<NSString *, id> * backupInfo = [CFBridgingRelease(calls.CopyValue(device, (__bridge CFStringRef)(MobileBackupDomain), NULL)) copy] ?: @{};
-  // Insert the values from subdomains.
-  info[MobileBackupDomain] = backupInfo;
-
-  return info;
+  return [info copy];
 }
 
 @end
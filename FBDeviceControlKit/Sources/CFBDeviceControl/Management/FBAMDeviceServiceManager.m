@@ -7,13 +7,44 @@
 
 #import "FBAMDeviceServiceManager.h"
 
+#import <poll.h>
+
 #import "FBAMDevice.h"
 #import "FBDeviceControlError.h"
 #import "FBAMDevice+Private.h"
 
-@interface FBAMDeviceServiceManager_HouseArrest : NSObject<FBFutureContextManagerDelegate>
+// The maximum number of concurrent house_arrest connections for a single Bundle ID.
+static const NSUInteger HouseArrestPoolCapacity = 4;
+// The maximum number of concurrent connections for a single lockdown service.
+static const NSUInteger ServicePoolCapacity = 2;
+// The maximum number of pooled service connections across all services of a device, beyond which the least recently used idle connection is evicted.
+static const NSUInteger ServiceConnectionBudget = 8;
+// The number of connections to prepare for each Bundle ID when a device is attached.
+static const NSUInteger HouseArrestPrewarmCount = 1;
+// The interval at which idle connections are checked.
+static const NSTimeInterval ServiceHealthCheckInterval = 2.0;
+
+@class FBAMDeviceServiceManager_HouseArrest;
+@class FBAMDeviceServiceManager_Service;
+
+@interface FBAMDeviceServiceManager ()
 
 @property (nonatomic, weak, readonly) FBAMDevice *device;
+@property (nonatomic, copy, nullable, readonly) NSNumber *serviceTimeout;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, FBFutureContextPool<FBAFCConnection *> *> *houseArrestPools;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, FBAMDeviceServiceManager_HouseArrest *> *houseArrestDelegates;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, FBFutureContextPool<FBAMDServiceConnection *> *> *servicePools;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, FBAMDeviceServiceManager_Service *> *serviceDelegates;
+
+- (void)reserveConnectionWithLogger:(id<FBControlCoreLogger>)logger;
+- (NSArray<FBFutureContextPool *> *)allPools;
+
+@end
+
+@interface FBAMDeviceServiceManager_HouseArrest : NSObject<FBFutureContextPoolDelegate>
+
+@property (nonatomic, weak, readonly) FBAMDevice *device;
+@property (nonatomic, weak, readwrite) FBAMDeviceServiceManager *manager;
 @property (nonatomic, copy, readonly) NSString *bundleID;
 @property (nonatomic, assign, readonly) AFCCalls calls;
 
@@ -41,6 +72,7 @@
 - (FBFuture<FBAFCConnection *> *)prepare:(id<FBControlCoreLogger>)logger
 {
   AFCConnectionRef afcConnection = NULL;
+  [self.manager reserveConnectionWithLogger:logger];
   [logger logFormat:@"Starting house arrest for '%@'", self.bundleID];
   int status = self.device.calls.CreateHouseArrestService(
     self.device.amDeviceRef,
@@ -71,6 +103,16 @@
   }
 }
 
+- (FBFuture<NSNull *> *)checkHealth:(FBAFCConnection *)connection logger:(id<FBControlCoreLogger>)logger
+{
+  if (![connection connectionIsValid]) {
+    return [[FBDeviceControlError
+      describeFormat:@"House Arrest connection for '%@' is no longer valid", self.bundleID]
+      failFuture];
+  }
+  return FBFuture.empty;
+}
+
 - (NSString *)contextName
 {
   return [NSString stringWithFormat:@"house_arrest_%@", self.bundleID];
@@ -83,12 +125,95 @@
 
 @end
 
-@interface FBAMDeviceServiceManager ()
+@interface FBAMDeviceServiceManager_Service : NSObject<FBFutureContextPoolDelegate>
 
 @property (nonatomic, weak, readonly) FBAMDevice *device;
-@property (nonatomic, copy, nullable, readonly) NSNumber *serviceTimeout;
-@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, FBFutureContextManager<FBAFCConnection *> *> *houseArrestManagers;
-@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, FBAMDeviceServiceManager_HouseArrest *> *houseArrestDelegates;
+@property (nonatomic, weak, readwrite) FBAMDeviceServiceManager *manager;
+@property (nonatomic, copy, readonly) NSString *service;
+
+@end
+
+@implementation FBAMDeviceServiceManager_Service
+
+@synthesize contextPoolTimeout = _contextPoolTimeout;
+
+- (instancetype)initWithDevice:(FBAMDevice *)device service:(NSString *)service serviceTimeout:(nullable NSNumber *)serviceTimeout
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _device = device;
+  _service = service;
+  _contextPoolTimeout = serviceTimeout;
+
+  return self;
+}
+
+- (FBFuture<FBAMDServiceConnection *> *)prepare:(id<FBControlCoreLogger>)logger
+{
+  NSDictionary<NSString *, id> *userInfo = @{
+    @"CloseOnInvalidate" : @1,
+    @"InvalidateOnDetach" : @1,
+  };
+  AMDServiceConnectionRef serviceConnection = NULL;
+  [self.manager reserveConnectionWithLogger:logger];
+  [logger logFormat:@"Starting pooled service %@", self.service];
+  int status = self.device.calls.SecureStartService(
+    self.device.amDeviceRef,
+    (__bridge CFStringRef)(self.service),
+    (__bridge CFDictionaryRef)(userInfo),
+    &serviceConnection
+  );
+  if (status != 0) {
+    NSString *errorDescription = CFBridgingRelease(self.device.calls.CopyErrorText(status));
+    return [[FBDeviceControlError
+      describeFormat:@"SecureStartService of %@ Failed with 0x%x %@", self.service, status, errorDescription]
+      failFuture];
+  }
+  FBAMDServiceConnection *connection = [FBAMDServiceConnection connectionWithName:self.service connection:serviceConnection device:self.device.amDeviceRef calls:self.device.calls logger:logger];
+  return [FBFuture futureWithResult:connection];
+}
+
+- (FBFuture<NSNull *> *)teardown:(FBAMDServiceConnection *)connection logger:(id<FBControlCoreLogger>)logger
+{
+  [logger logFormat:@"Invalidating pooled service %@", self.service];
+  NSError *error = nil;
+  if (![connection invalidateWithError:&error]) {
+    [logger logFormat:@"Failed to invalidate pooled service %@ with error %@", self.service, error];
+    return [FBFuture futureWithError:error];
+  }
+  return FBFuture.empty;
+}
+
+- (FBFuture<NSNull *> *)checkHealth:(FBAMDServiceConnection *)connection logger:(id<FBControlCoreLogger>)logger
+{
+  int socket = connection.connection ? connection.calls.ServiceConnectionGetSocket(connection.connection) : -1;
+  if (socket < 0) {
+    return [[FBDeviceControlError
+      describeFormat:@"Pooled service %@ has no socket", self.service]
+      failFuture];
+  }
+  // An idle request/response service has nothing to say, so a readable socket is either the device closing it or a stray response that would desynchronise the next caller.
+  struct pollfd descriptor = {.fd = socket, .events = POLLIN};
+  if (poll(&descriptor, 1, 0) != 0) {
+    return [[FBDeviceControlError
+      describeFormat:@"Pooled service %@ was closed or has unread data", self.service]
+      failFuture];
+  }
+  return FBFuture.empty;
+}
+
+- (NSString *)contextName
+{
+  return [NSString stringWithFormat:@"service_%@", self.service];
+}
+
+- (BOOL)isContextSharable
+{
+  return NO;
+}
 
 @end
 
@@ -110,25 +235,131 @@
 
   _device = device;
   _serviceTimeout = serviceTimeout;
-  _houseArrestManagers = [NSMutableDictionary dictionary];
+  _houseArrestPools = [NSMutableDictionary dictionary];
   _houseArrestDelegates = [NSMutableDictionary dictionary];
+  _servicePools = [NSMutableDictionary dictionary];
+  _serviceDelegates = [NSMutableDictionary dictionary];
+  _prewarmBundleIDs = [NSSet set];
 
   return self;
 }
 
 #pragma mark Public Services
 
-- (FBFutureContextManager<FBAFCConnection *> *)houseArrestAFCConnectionForBundleID:(NSString *)bundleID afcCalls:(AFCCalls)afcCalls
+- (FBFutureContextPool<FBAFCConnection *> *)houseArrestAFCConnectionForBundleID:(NSString *)bundleID afcCalls:(AFCCalls)afcCalls
 {
-  FBFutureContextManager<FBAFCConnection *> *manager = self.houseArrestManagers[bundleID];
-  if (manager) {
-    return manager;
+  FBFutureContextPool<FBAFCConnection *> *pool = self.houseArrestPools[bundleID];
+  if (pool) {
+    return pool;
   }
   FBAMDeviceServiceManager_HouseArrest *delegate = [[FBAMDeviceServiceManager_HouseArrest alloc] initWithDevice:self.device bundleID:bundleID calls:afcCalls serviceTimeout:self.serviceTimeout];
-  manager = [FBFutureContextManager managerWithQueue:self.device.workQueue delegate:delegate logger:self.device.logger];
-  self.houseArrestManagers[bundleID] = manager;
+  pool = [FBFutureContextPool poolWithQueue:self.device.workQueue delegate:delegate capacity:HouseArrestPoolCapacity healthCheckInterval:@(ServiceHealthCheckInterval) logger:self.device.logger];
+  delegate.manager = self;
+  self.houseArrestPools[bundleID] = pool;
   self.houseArrestDelegates[bundleID] = delegate;
-  return manager;
+  return pool;
+}
+
+- (FBFutureContextPool<FBAMDServiceConnection *> *)serviceConnectionPoolForService:(NSString *)service
+{
+  FBFutureContextPool<FBAMDServiceConnection *> *pool = self.servicePools[service];
+  if (pool) {
+    return pool;
+  }
+  FBAMDeviceServiceManager_Service *delegate = [[FBAMDeviceServiceManager_Service alloc] initWithDevice:self.device service:service serviceTimeout:self.serviceTimeout];
+  pool = [FBFutureContextPool poolWithQueue:self.device.workQueue delegate:delegate capacity:ServicePoolCapacity healthCheckInterval:@(ServiceHealthCheckInterval) logger:self.device.logger];
+  delegate.manager = self;
+  self.servicePools[service] = pool;
+  self.serviceDelegates[service] = delegate;
+  return pool;
+}
+
+#pragma mark Lifecycle
+
+- (FBFuture<NSNull *> *)deviceAttached
+{
+  id<FBControlCoreLogger> logger = self.device.logger;
+  return [[[self
+    drain]
+    onQueue:self.device.workQueue fmap:^(id _) {
+      return [self prewarm];
+    }]
+    onQueue:self.device.workQueue handleError:^(NSError *error) {
+      [logger logFormat:@"Failed to prewarm services %@", error];
+      return FBFuture.empty;
+    }];
+}
+
+- (FBFuture<NSNull *> *)prewarm
+{
+  return [FBFuture
+    onQueue:self.device.workQueue resolve:^ FBFuture<NSNull *> * {
+      NSMutableSet<NSString *> *bundleIDs = [NSMutableSet setWithSet:self.prewarmBundleIDs];
+      [bundleIDs addObjectsFromArray:self.houseArrestPools.allKeys];
+      if (bundleIDs.count == 0) {
+        return FBFuture.empty;
+      }
+      return [[self.device
+        connectToDeviceWithPurpose:@"prewarm_services"]
+        onQueue:self.device.workQueue pop:^(id _) {
+          NSMutableArray<FBFuture<NSNumber *> *> *futures = [NSMutableArray array];
+          for (NSString *bundleID in bundleIDs) {
+            AFCCalls calls = self.houseArrestDelegates[bundleID] ? self.houseArrestDelegates[bundleID].calls : FBAFCConnection.defaultCalls;
+            [futures addObject:[[self houseArrestAFCConnectionForBundleID:bundleID afcCalls:calls] prewarm:HouseArrestPrewarmCount]];
+          }
+          return [[FBFuture futureWithFutures:futures] mapReplace:NSNull.null];
+        }];
+    }];
+}
+
+- (FBFuture<NSNull *> *)drain
+{
+  return [FBFuture
+    onQueue:self.device.workQueue resolve:^ FBFuture<NSNull *> * {
+      NSMutableArray<FBFuture<NSNull *> *> *futures = [NSMutableArray array];
+      for (FBFutureContextPool *pool in self.allPools) {
+        [futures addObject:[pool drain]];
+      }
+      return [[FBFuture futureWithFutures:futures] mapReplace:NSNull.null];
+    }];
+}
+
+#pragma mark Private
+
+- (void)reserveConnectionWithLogger:(id<FBControlCoreLogger>)logger
+{
+  // The pool that is preparing already counts the connection that is being reserved, so only evict when the budget is exceeded.
+  while ([self totalConnectionCount] > ServiceConnectionBudget) {
+    FBFutureContextPool *leastRecentlyUsed = nil;
+    for (FBFutureContextPool *candidate in self.allPools) {
+      NSDate *date = candidate.leastRecentlyUsedDate;
+      if (!date) {
+        continue;
+      }
+      if (!leastRecentlyUsed || [date compare:leastRecentlyUsed.leastRecentlyUsedDate] == NSOrderedAscending) {
+        leastRecentlyUsed = candidate;
+      }
+    }
+    if (!leastRecentlyUsed) {
+      [logger logFormat:@"%lu service connections exceeds the budget of %lu, but none are idle to evict", [self totalConnectionCount], ServiceConnectionBudget];
+      return;
+    }
+    [leastRecentlyUsed evictLeastRecentlyUsed];
+  }
+}
+
+- (NSUInteger)totalConnectionCount
+{
+  NSUInteger count = 0;
+  for (FBFutureContextPool *pool in self.allPools) {
+    count += pool.contextCount;
+  }
+  return count;
+}
+
+- (NSArray<FBFutureContextPool *> *)allPools
+{
+  return [self.houseArrestPools.allValues arrayByAddingObjectsFromArray:self.servicePools.allValues];
 }
 
 @end
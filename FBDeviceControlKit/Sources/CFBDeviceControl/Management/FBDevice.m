@@ -26,6 +26,7 @@
 #import "FBDeviceLogCommands.h"
 #import "FBDevicePowerCommands.h"
 #import "FBDeviceScreenshotCommands.h"
+#import "FBDeviceValueCommands.h"
 #import "FBDeviceVideoRecordingCommands.h"
 // FBDeviceXCTestCommands excluded - requires XCTestBootstrap
 
@@ -269,6 +270,17 @@
     failFutureContext];
 }
 
+- (FBFutureContext<FBAMDServiceConnection *> *)pooledService:(NSString *)service
+{
+  FBAMDevice *amDevice = self.amDevice;
+  if (amDevice) {
+    return [amDevice pooledService:service];
+  }
+  return [[FBDeviceControlError
+    describeFormat:@"%@ fails when not AMDevice backed.", NSStringFromSelector(_cmd)]
+    failFutureContext];
+}
+
 - (FBFutureContext<FBDeviceLinkClient *> *)startDeviceLinkService:(NSString *)service
 {
   FBAMDevice *amDevice = self.amDevice;
@@ -326,6 +338,7 @@
       FBDeviceRecoveryCommands.class,
       FBDeviceScreenshotCommands.class,
       FBDeviceSocketForwardingCommands.class,
+      FBDeviceValueCommands.class,
       FBDeviceVideoRecordingCommands.class,
       // FBDeviceXCTestCommands.class excluded
       FBInstrumentsCommands.class,
@@ -7,11 +7,30 @@
 
 #import "FBDeviceDebugServer.h"
 
+#import <netinet/in.h>
+#import <netinet/tcp.h>
+#import <poll.h>
+#import <stdatomic.h>
+#import <sys/socket.h>
+
 #import "FBControlCore.h"
 
 #import "FBAMDServiceConnection.h"
 
+// The size of a single relay read in each direction. Large memory reads arrive as large gdb-remote packets, which shouldn't be split into many small reads.
+static size_t const RelayBufferSize = 1024 * 256;
+// The kernel buffer size of the lldb client socket, so that a large packet doesn't stall on a full socket buffer.
+static int const ClientSocketBufferSize = 1024 * 1024;
+
+static FBMetricsCounter *BytesToDebugServerCounter;
+static FBMetricsCounter *BytesFromDebugServerCounter;
+static FBMetricsHistogram *RoundTripLatencyHistogram;
+
 @interface FBDeviceDebugServer_TwistedPairFiles : NSObject
+{
+  // When the oldest request that has not yet been answered was sent, 0 when there is none.
+  _Atomic uint64_t _requestSentTime;
+}
 
 @property (nonatomic, assign, readonly) int socket;
 @property (nonatomic, strong, readonly) FBAMDServiceConnection *connection;
@@ -23,6 +42,17 @@
 
 @implementation FBDeviceDebugServer_TwistedPairFiles
 
++ (void)initialize
+{
+  if (self != FBDeviceDebugServer_TwistedPairFiles.class) {
+    return;
+  }
+  FBMetricsRegistry *registry = FBMetricsRegistry.sharedRegistry;
+  BytesToDebugServerCounter = [registry counterWithName:@"debugserver.bytes_to_device"];
+  BytesFromDebugServerCounter = [registry counterWithName:@"debugserver.bytes_from_device"];
+  RoundTripLatencyHistogram = [registry histogramWithName:@"debugserver.round_trip_latency_ns"];
+}
+
 - (instancetype)initWithSocket:(int)socket connection:(FBAMDServiceConnection *)connection logger:(id<FBControlCoreLogger>)logger
 {
   self = [super init];
@@ -35,65 +65,141 @@
   _logger = logger;
   _socketToConnectionQueue = dispatch_queue_create("com.facebook.fbdevicecontrol.debugserver.socket_to_connection", DISPATCH_QUEUE_SERIAL);
   _connectionToSocketQueue = dispatch_queue_create("com.facebook.fbdevicecontrol.debugserver.connection_to_socket", DISPATCH_QUEUE_SERIAL);
+  atomic_init(&_requestSentTime, 0);
 
   return self;
 }
 
-static size_t const ConnectionReadSizeLimit = 1024;
-
 - (FBFuture<NSNull *> *)startWithError:(NSError **)error
 {
-  if (@available(macOS 10.15, *)) {
-    id<FBControlCoreLogger> logger = self.logger;
-    int socket = self.socket;
-    NSFileHandle *socketReadHandle = [[NSFileHandle alloc] initWithFileDescriptor:socket closeOnDealloc:NO];
-    NSFileHandle *socketWriteHandle = [[NSFileHandle alloc] initWithFileDescriptor:socket closeOnDealloc:NO];
-    FBAMDServiceConnection *connection = self.connection;
-    FBMutableFuture<NSNull *> *socketReadCompleted = FBMutableFuture.future;
-    FBMutableFuture<NSNull *> *connectionReadCompleted = FBMutableFuture.future;
-    dispatch_async(self.socketToConnectionQueue, ^{
-      while (socketReadCompleted.state == FBFutureStateRunning && connectionReadCompleted.state == FBFutureStateRunning) {
-        NSError *innerError = nil;
-        NSData *data = [socketReadHandle availableData];
-        if (data.length == 0) {
-          [logger log:@"Socket read reached end of file"];
-          break;
-        }
-        if (![connection send:data error:&innerError]) {
-          [logger logFormat:@"Sending data to remote debugserver failed: %@", innerError];
-          break;
-        }
+  id<FBControlCoreLogger> logger = self.logger;
+  int socket = self.socket;
+  FBAMDServiceConnection *connection = self.connection;
+  FBMutableFuture<NSNull *> *socketReadCompleted = FBMutableFuture.future;
+  FBMutableFuture<NSNull *> *connectionReadCompleted = FBMutableFuture.future;
+  [FBDeviceDebugServer_TwistedPairFiles configureClientSocket:socket logger:logger];
+  uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  __block uint64_t bytesToDevice = 0;
+  __block uint64_t bytesFromDevice = 0;
+
+  dispatch_async(self.socketToConnectionQueue, ^{
+    // A single buffer is reused for every read, and is sent from directly rather than being copied.
+    NSMutableData *buffer = [NSMutableData dataWithLength:RelayBufferSize];
+    while (socketReadCompleted.state == FBFutureStateRunning && connectionReadCompleted.state == FBFutureStateRunning) {
+      ssize_t length = [FBDeviceDebugServer_TwistedPairFiles readCoalescedFromSocket:socket buffer:buffer.mutableBytes size:RelayBufferSize];
+      if (length == 0) {
+        [logger log:@"Socket read reached end of file"];
+        break;
+      }
+      if (length < 0) {
+        [logger logFormat:@"Socket read failed: %s", strerror(errno)];
+        break;
+      }
+      uint64_t sendTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+      NSError *innerError = nil;
+      NSData *chunk = [NSData dataWithBytesNoCopy:buffer.mutableBytes length:(NSUInteger) length freeWhenDone:NO];
+      if (![connection send:chunk error:&innerError]) {
+        [logger logFormat:@"Sending data to remote debugserver failed: %@", innerError];
+        break;
+      }
+      bytesToDevice += (uint64_t) length;
+      [BytesToDebugServerCounter add:(uint64_t) length];
+      uint64_t noRequest = 0;
+      atomic_compare_exchange_strong(&self->_requestSentTime, &noRequest, sendTime);
+    }
+    [logger logFormat:@"Exiting socket %d read loop", socket];
+    [socketReadCompleted resolveWithResult:NSNull.null];
+  });
+  dispatch_async(self.connectionToSocketQueue, ^{
+    // Received directly into the storage of a single buffer that is reused for every read.
+    NSMutableData *buffer = [NSMutableData dataWithCapacity:RelayBufferSize];
+    while (socketReadCompleted.state == FBFutureStateRunning && connectionReadCompleted.state == FBFutureStateRunning) {
+      NSError *innerError = nil;
+      buffer.length = 0;
+      ssize_t length = [connection receiveUpTo:RelayBufferSize appendingToData:buffer error:&innerError];
+      if (length <= 0) {
+        [logger logFormat:@"debugserver read ended: %@", innerError];
+        break;
+      }
+      uint64_t requestTime = atomic_exchange(&self->_requestSentTime, 0);
+      if (requestTime) {
+        [RoundTripLatencyHistogram recordNanosecondsSince:requestTime];
       }
-      [logger logFormat:@"Exiting socket %d read loop", socket];
-      [socketReadCompleted resolveWithResult:NSNull.null];
-    });
-    dispatch_async(self.connectionToSocketQueue, ^{
-      while (socketReadCompleted.state == FBFutureStateRunning && connectionReadCompleted.state == FBFutureStateRunning) {
-        NSError *innerError = nil;
-        NSData *data = [connection receiveUpTo:ConnectionReadSizeLimit error:&innerError];
-        if (data.length == 0) {
-          [logger logFormat:@"debugserver read ended: %@", innerError];
-          break;
-        }
-        if (![socketWriteHandle writeData:data error:&innerError]) {
-          [logger logFormat:@"Socket write failed: %@", innerError];
-          break;
-        }
+      bytesFromDevice += (uint64_t) length;
+      [BytesFromDebugServerCounter add:(uint64_t) length];
+      if (![FBDeviceDebugServer_TwistedPairFiles writeToSocket:socket bytes:buffer.bytes length:buffer.length]) {
+        [logger logFormat:@"Socket write failed: %s", strerror(errno)];
+        break;
       }
-      [logger logFormat:@"Exiting connection %@ read loop", connection];
-      [connectionReadCompleted resolveWithResult:NSNull.null];
-    });
-    return [[FBFuture
-      futureWithFutures:@[
-        socketReadCompleted,
-        connectionReadCompleted,
-      ]]
-      onQueue:self.connectionToSocketQueue notifyOfCompletion:^(id _) {
-        [logger logFormat:@"Closing socket file descriptor %d", socket];
-        close(socket);
-      }];
+    }
+    [logger logFormat:@"Exiting connection %@ read loop", connection];
+    // Unblock the socket read loop, which would otherwise wait for the client to send something more.
+    shutdown(socket, SHUT_RDWR);
+    [connectionReadCompleted resolveWithResult:NSNull.null];
+  });
+  return [[FBFuture
+    futureWithFutures:@[
+      socketReadCompleted,
+      connectionReadCompleted,
+    ]]
+    onQueue:self.connectionToSocketQueue notifyOfCompletion:^(id _) {
+      double seconds = (clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - startTime) / (double) NSEC_PER_SEC;
+      [logger logFormat:@"Relayed %llu bytes to and %llu bytes from debugserver in %.1fs (%.2f MB/s from device)", bytesToDevice, bytesFromDevice, seconds, seconds > 0 ? bytesFromDevice / seconds / (1024 * 1024) : 0];
+      [logger logFormat:@"Closing socket file descriptor %d", socket];
+      close(socket);
+    }];
+}
+
+#pragma mark Private
+
++ (void)configureClientSocket:(int)socket logger:(id<FBControlCoreLogger>)logger
+{
+  // gdb-remote is a request/response protocol of mostly small packets, so Nagle's algorithm only adds latency to each exchange.
+  int noDelay = 1;
+  if (setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay)) != 0) {
+    [logger logFormat:@"Failed to set TCP_NODELAY on socket %d: %s", socket, strerror(errno)];
+  }
+  int bufferSize = ClientSocketBufferSize;
+  setsockopt(socket, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+  setsockopt(socket, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+}
+
++ (ssize_t)readCoalescedFromSocket:(int)socket buffer:(uint8_t *)buffer size:(size_t)size
+{
+  ssize_t total = 0;
+  do {
+    total = read(socket, buffer, size);
+  } while (total < 0 && errno == EINTR);
+  if (total <= 0) {
+    return total;
+  }
+  // lldb writes a packet and its acknowledgement separately, so gather anything else that has already arrived, sending it to the device in one secure write.
+  struct pollfd descriptor = {.fd = socket, .events = POLLIN};
+  while ((size_t) total < size && poll(&descriptor, 1, 0) > 0 && (descriptor.revents & POLLIN)) {
+    ssize_t more = recv(socket, buffer + total, size - (size_t) total, MSG_DONTWAIT);
+    if (more <= 0) {
+      // End of file or an error is seen by the next blocking read.
+      break;
+    }
+    total += more;
+  }
+  return total;
+}
+
++ (BOOL)writeToSocket:(int)socket bytes:(const uint8_t *)bytes length:(size_t)length
+{
+  size_t written = 0;
+  while (written < length) {
+    ssize_t result = write(socket, bytes + written, length - written);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      return NO;
+    }
+    written += (size_t) result;
   }
-  return nil;
+  return YES;
 }
 
 @end
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBDevicePortForwarder.h"
+
+#import <sys/socket.h>
+
+#import "FBDeviceControlError.h"
+#import "FBDeviceSocketRelay.h"
+
+@class FBDevicePortForwarder;
+
+@interface FBDevicePortForwarder ()
+
+@property (nonatomic, strong, readonly) dispatch_queue_t clientQueue;
+
+- (void)forwardClient:(int)clientSocket toRemotePort:(int)remotePort;
+
+@end
+
+@interface FBDevicePortForwarder_Listener : NSObject <FBSocketServerDelegate>
+
+@property (nonatomic, weak, readonly) FBDevicePortForwarder *forwarder;
+@property (nonatomic, assign, readonly) int remotePort;
+@property (nonatomic, strong, nullable, readwrite) FBSocketServer *server;
+
+@end
+
+@implementation FBDevicePortForwarder_Listener
+
+- (instancetype)initWithForwarder:(FBDevicePortForwarder *)forwarder remotePort:(int)remotePort
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _forwarder = forwarder;
+  _remotePort = remotePort;
+
+  return self;
+}
+
+- (dispatch_queue_t)queue
+{
+  return self.forwarder.clientQueue ?: dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+}
+
+- (void)socketServer:(FBSocketServer *)server clientConnected:(struct in6_addr)address fileDescriptor:(int)fileDescriptor
+{
+  FBDevicePortForwarder *forwarder = self.forwarder;
+  if (!forwarder) {
+    close(fileDescriptor);
+    return;
+  }
+  [forwarder forwardClient:fileDescriptor toRemotePort:self.remotePort];
+}
+
+@end
+
+@interface FBDevicePortForwarder ()
+
+@property (nonatomic, strong, readonly) id<FBDeviceCommands> device;
+@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, copy, readonly) NSDictionary<NSNumber *, NSNumber *> *requestedPortMapping;
+@property (nonatomic, assign, readonly) NSUInteger poolSize;
+@property (nonatomic, copy, readwrite) NSArray<FBDevicePortForwarder_Listener *> *listeners;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSNumber *, NSMutableArray<NSNumber *> *> *pools;
+@property (nonatomic, assign, readwrite) int connectionID;
+@property (nonatomic, assign, readwrite) BOOL stopped;
+
+@end
+
+@implementation FBDevicePortForwarder
+
+#pragma mark Initializers
+
++ (instancetype)forwarderWithDevice:(id<FBDeviceCommands>)device portMapping:(NSDictionary<NSNumber *, NSNumber *> *)portMapping poolSize:(NSUInteger)poolSize logger:(id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithDevice:device portMapping:portMapping poolSize:poolSize logger:logger];
+}
+
+- (instancetype)initWithDevice:(id<FBDeviceCommands>)device portMapping:(NSDictionary<NSNumber *, NSNumber *> *)portMapping poolSize:(NSUInteger)poolSize logger:(id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _device = device;
+  _logger = logger;
+  _requestedPortMapping = [portMapping copy];
+  _poolSize = poolSize;
+  _listeners = @[];
+  _pools = NSMutableDictionary.dictionary;
+  // Connections are accepted and set up concurrently, so that a slow connection to one device port doesn't hold up others.
+  _clientQueue = dispatch_queue_create("com.facebook.fbdevicecontrol.port_forwarder", DISPATCH_QUEUE_CONCURRENT);
+
+  return self;
+}
+
+#pragma mark Properties
+
+- (NSDictionary<NSNumber *, NSNumber *> *)portMapping
+{
+  NSMutableDictionary<NSNumber *, NSNumber *> *portMapping = NSMutableDictionary.dictionary;
+  for (FBDevicePortForwarder_Listener *listener in self.listeners) {
+    portMapping[@(listener.server.port)] = @(listener.remotePort);
+  }
+  return [portMapping copy];
+}
+
+#pragma mark Public Methods
+
+- (FBFuture<NSNull *> *)start
+{
+  return [[[self
+    refreshConnectionID]
+    onQueue:self.clientQueue fmap:^(NSNumber *_) {
+      NSMutableArray<FBDevicePortForwarder_Listener *> *listeners = NSMutableArray.array;
+      NSMutableArray<FBFuture<NSNull *> *> *listening = NSMutableArray.array;
+      for (NSNumber *localPort in self.requestedPortMapping) {
+        FBDevicePortForwarder_Listener *listener = [[FBDevicePortForwarder_Listener alloc] initWithForwarder:self remotePort:self.requestedPortMapping[localPort].intValue];
+        listener.server = [FBSocketServer socketServerOnPort:(in_port_t) localPort.unsignedShortValue delegate:listener];
+        [listeners addObject:listener];
+        [listening addObject:[listener.server startListening]];
+      }
+      self.listeners = listeners;
+      return [FBFuture futureWithFutures:listening];
+    }]
+    onQueue:self.clientQueue map:^(id _) {
+      for (NSNumber *remotePort in [NSSet setWithArray:self.requestedPortMapping.allValues]) {
+        [self replenishPoolForRemotePort:remotePort.intValue];
+      }
+      [self.logger logFormat:@"Forwarding %@", [FBCollectionInformation oneLineDescriptionFromDictionary:self.portMapping]];
+      return NSNull.null;
+    }];
+}
+
+- (FBFuture<NSNull *> *)stop
+{
+  NSArray<NSNumber *> *pooledSockets = nil;
+  @synchronized (self.pools) {
+    self.stopped = YES;
+    NSMutableArray<NSNumber *> *sockets = NSMutableArray.array;
+    for (NSArray<NSNumber *> *pool in self.pools.allValues) {
+      [sockets addObjectsFromArray:pool];
+    }
+    [self.pools removeAllObjects];
+    pooledSockets = sockets;
+  }
+  for (NSNumber *pooledSocket in pooledSockets) {
+    close(pooledSocket.intValue);
+  }
+  NSMutableArray<FBFuture<NSNull *> *> *stopping = NSMutableArray.array;
+  for (FBDevicePortForwarder_Listener *listener in self.listeners) {
+    [stopping addObject:[listener.server stopListening]];
+  }
+  return [[FBFuture futureWithFutures:stopping] mapReplace:NSNull.null];
+}
+
+#pragma mark Private
+
+- (FBFuture<NSNumber *> *)refreshConnectionID
+{
+  // Only obtaining the connection ID needs a lockdown session, connecting to a device port with it does not.
+  return [[self.device
+    connectToDeviceWithPurpose:@"port_forwarding"]
+    onQueue:self.clientQueue pop:^ FBFuture<NSNumber *> * (id<FBDeviceCommands> device) {
+      int connectionID = device.calls.GetConnectionID(device.amDeviceRef);
+      if (connectionID <= 0) {
+        return [[FBDeviceControlError
+          describeFormat:@"Failed to get ConnectionID from Device"]
+          failFuture];
+      }
+      @synchronized (self.pools) {
+        self.connectionID = connectionID;
+      }
+      return [FBFuture futureWithResult:@(connectionID)];
+    }];
+}
+
+- (int)connectToRemotePort:(int)remotePort error:(NSError **)error
+{
+  int connectionID = 0;
+  @synchronized (self.pools) {
+    connectionID = self.connectionID;
+  }
+  int remoteSocket = -1;
+  int status = self.device.calls.USBMuxConnectByPort(connectionID, htons(remotePort), &remoteSocket);
+  if (status != 0) {
+    [[FBDeviceControlError
+      describeFormat:@"Failed to connect to remote port %d with connection ID %d, status %d", remotePort, connectionID, status]
+      fail:error];
+    return -1;
+  }
+  return remoteSocket;
+}
+
+- (FBFuture<NSNumber *> *)remoteSocketForPort:(int)remotePort
+{
+  int pooledSocket = [self takePooledSocketForRemotePort:remotePort];
+  if (pooledSocket >= 0) {
+    return [FBFuture futureWithResult:@(pooledSocket)];
+  }
+  NSError *error = nil;
+  int remoteSocket = [self connectToRemotePort:remotePort error:&error];
+  if (remoteSocket >= 0) {
+    return [FBFuture futureWithResult:@(remoteSocket)];
+  }
+  // The connection ID changes if the device is re-attached, so obtain it again before giving up.
+  [self.logger logFormat:@"%@, obtaining a new connection ID", error.localizedDescription];
+  return [[self
+    refreshConnectionID]
+    onQueue:self.clientQueue fmap:^(NSNumber *_) {
+      NSError *innerError = nil;
+      int retriedSocket = [self connectToRemotePort:remotePort error:&innerError];
+      if (retriedSocket < 0) {
+        return [FBFuture futureWithError:innerError];
+      }
+      return [FBFuture futureWithResult:@(retriedSocket)];
+    }];
+}
+
+- (void)forwardClient:(int)clientSocket toRemotePort:(int)remotePort
+{
+  id<FBControlCoreLogger> logger = self.logger;
+  [[[self
+    remoteSocketForPort:remotePort]
+    onQueue:self.clientQueue fmap:^(NSNumber *remoteSocket) {
+      FBDeviceSocketRelay *relay = [FBDeviceSocketRelay relayWithLocalInput:clientSocket localOutput:clientSocket remoteSocket:remoteSocket.intValue logger:nil];
+      return [[relay
+        start]
+        onQueue:self.clientQueue notifyOfCompletion:^(FBFuture<FBDeviceSocketRelayStatistics *> *future) {
+          close(remoteSocket.intValue);
+          [logger logFormat:@"Forwarded connection to remote port %d finished %@", remotePort, future.result ?: future.error];
+        }];
+    }]
+    onQueue:self.clientQueue notifyOfCompletion:^(FBFuture *future) {
+      close(clientSocket);
+      if (future.error) {
+        [logger logFormat:@"Failed to forward connection to remote port %d %@", remotePort, future.error];
+      }
+    }];
+  dispatch_async(self.clientQueue, ^{
+    [self replenishPoolForRemotePort:remotePort];
+  });
+}
+
+- (int)takePooledSocketForRemotePort:(int)remotePort
+{
+  while (YES) {
+    int pooledSocket = -1;
+    @synchronized (self.pools) {
+      NSMutableArray<NSNumber *> *pool = self.pools[@(remotePort)];
+      if (pool.count == 0) {
+        return -1;
+      }
+      pooledSocket = pool.firstObject.intValue;
+      [pool removeObjectAtIndex:0];
+    }
+    // The device may have closed a socket whilst it was pooled, which is only known by looking at the socket.
+    char byte = 0;
+    ssize_t result = recv(pooledSocket, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (result > 0 || (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))) {
+      return pooledSocket;
+    }
+    close(pooledSocket);
+  }
+}
+
+- (void)replenishPoolForRemotePort:(int)remotePort
+{
+  while (YES) {
+    @synchronized (self.pools) {
+      if (self.stopped || self.pools[@(remotePort)].count >= self.poolSize) {
+        return;
+      }
+    }
+    int remoteSocket = [self connectToRemotePort:remotePort error:nil];
+    if (remoteSocket < 0) {
+      return;
+    }
+    @synchronized (self.pools) {
+      if (self.stopped) {
+        close(remoteSocket);
+        return;
+      }
+      NSMutableArray<NSNumber *> *pool = self.pools[@(remotePort)] ?: NSMutableArray.array;
+      [pool addObject:@(remoteSocket)];
+      self.pools[@(remotePort)] = pool;
+    }
+  }
+}
+
+@end
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBDeviceProcessSnapshot.h"
+
+static NSString *const KeyProcessName = @"ProcessName";
+
+static int CompareEntries(const void *left, const void *right)
+{
+  pid_t leftIdentifier = ((const FBDeviceProcessEntry *) left)->processIdentifier;
+  pid_t rightIdentifier = ((const FBDeviceProcessEntry *) right)->processIdentifier;
+  return (leftIdentifier > rightIdentifier) - (leftIdentifier < rightIdentifier);
+}
+
+@interface FBDeviceProcessSnapshot ()
+
+// Retains the strings that the entries point to.
+@property (nonatomic, copy, readonly) NSArray<NSString *> *strings;
+
+@end
+
+@implementation FBDeviceProcessSnapshot
+{
+  FBDeviceProcessEntry *_entries;
+}
+
+#pragma mark Initializers
+
++ (instancetype)snapshotFromProcessList:(NSDictionary<id, NSDictionary<NSString *, id> *> *)payload previous:(nullable FBDeviceProcessSnapshot *)previous bundleIDResolver:(FBDeviceProcessBundleIDResolver)resolver
+{
+  NSUInteger capacity = payload.count;
+  FBDeviceProcessEntry *entries = calloc(MAX(capacity, 1u), sizeof(FBDeviceProcessEntry));
+  NSMutableArray<NSString *> *strings = [NSMutableArray arrayWithCapacity:capacity * 2];
+  NSUInteger count = 0;
+  for (id key in payload) {
+    NSString *name = payload[key][KeyProcessName];
+    if (![name isKindOfClass:NSString.class] || ![key respondsToSelector:@selector(intValue)]) {
+      continue;
+    }
+    entries[count].processIdentifier = [key intValue];
+    entries[count].name = name;
+    count++;
+  }
+  qsort(entries, count, sizeof(FBDeviceProcessEntry), CompareEntries);
+
+  // Both snapshots are ordered by process identifier, so the changes fall out of a single merge.
+  NSMutableIndexSet *launched = NSMutableIndexSet.indexSet;
+  NSMutableIndexSet *terminated = NSMutableIndexSet.indexSet;
+  const FBDeviceProcessEntry *previousEntries = previous.entries;
+  NSUInteger previousCount = previous.count;
+  NSUInteger previousIndex = 0;
+  for (NSUInteger index = 0; index < count; index++) {
+    FBDeviceProcessEntry *entry = &entries[index];
+    while (previousIndex < previousCount && previousEntries[previousIndex].processIdentifier < entry->processIdentifier) {
+      [terminated addIndex:(NSUInteger) previousEntries[previousIndex].processIdentifier];
+      previousIndex++;
+    }
+    if (previousIndex < previousCount && previousEntries[previousIndex].processIdentifier == entry->processIdentifier && [previousEntries[previousIndex].name isEqualToString:entry->name]) {
+      entry->name = previousEntries[previousIndex].name;
+      entry->bundleID = previousEntries[previousIndex].bundleID;
+      previousIndex++;
+    } else {
+      // A process identifier that is re-used by a different process is a termination and a launch.
+      if (previousIndex < previousCount && previousEntries[previousIndex].processIdentifier == entry->processIdentifier) {
+        [terminated addIndex:(NSUInteger) entry->processIdentifier];
+        previousIndex++;
+      }
+      [launched addIndex:(NSUInteger) entry->processIdentifier];
+      entry->bundleID = resolver(entry->name);
+    }
+    [strings addObject:entry->name];
+    if (entry->bundleID) {
+      [strings addObject:entry->bundleID];
+    }
+  }
+  for (; previousIndex < previousCount; previousIndex++) {
+    [terminated addIndex:(NSUInteger) previousEntries[previousIndex].processIdentifier];
+  }
+
+  return [[self alloc] initWithEntries:entries count:count strings:strings launched:launched terminated:terminated];
+}
+
+- (instancetype)initWithEntries:(FBDeviceProcessEntry *)entries count:(NSUInteger)count strings:(NSArray<NSString *> *)strings launched:(NSIndexSet *)launched terminated:(NSIndexSet *)terminated
+{
+  self = [super init];
+  if (!self) {
+    free(entries);
+    return nil;
+  }
+
+  _entries = entries;
+  _count = count;
+  _strings = [strings copy];
+  _launchedProcessIdentifiers = [launched copy];
+  _terminatedProcessIdentifiers = [terminated copy];
+
+  return self;
+}
+
+- (void)dealloc
+{
+  free(_entries);
+}
+
+#pragma mark Properties
+
+- (const FBDeviceProcessEntry *)entries
+{
+  return _entries;
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)processIdentifiersByBundleID
+{
+  NSMutableDictionary<NSString *, NSNumber *> *processIdentifiersByBundleID = NSMutableDictionary.dictionary;
+  for (NSUInteger index = 0; index < self.count; index++) {
+    NSString *bundleID = _entries[index].bundleID;
+    if (!bundleID) {
+      continue;
+    }
+    processIdentifiersByBundleID[bundleID] = @(_entries[index].processIdentifier);
+  }
+  return [processIdentifiersByBundleID copy];
+}
+
+#pragma mark NSObject
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"%lu processes | %lu launched | %lu terminated", (unsigned long) self.count, (unsigned long) self.launchedProcessIdentifiers.count, (unsigned long) self.terminatedProcessIdentifiers.count];
+}
+
+@end
@@ -21,6 +21,7 @@
 #import "FBDevice+Private.h"
 #import "FBDevice.h"
 #import "FBDeviceControlFrameworkLoader.h"
+#import "FBDeviceSetInstaller.h"
 #import "FBDeviceStorage.h"
 
 @interface FBDeviceSet () <FBiOSTargetSetDelegate>
@@ -28,6 +29,10 @@
 @property (nonatomic, strong, readonly) FBAMDeviceManager *amDeviceManager;
 @property (nonatomic, strong, readonly) FBAMRestorableDeviceManager *restorableDeviceManager;
 @property (nonatomic, strong, readonly) FBDeviceStorage<FBDevice *> *storage;
+// Immutable snapshots of the attached devices, replaced on the work queue whenever a device changes.
+// Reading them doesn't build anything, so queries never wait on devices being brought up.
+@property (atomic, copy, readwrite) NSArray<FBDevice *> *devicesSnapshot;
+@property (atomic, copy, readwrite) NSDictionary<NSString *, FBDevice *> *devicesByUDIDSnapshot;
 
 @end
 
@@ -71,6 +76,8 @@
   _delegate = delegate;
   _logger = logger;
   _storage = [[FBDeviceStorage alloc] initWithLogger:logger];
+  _devicesSnapshot = @[];
+  _devicesByUDIDSnapshot = @{};
 
   [self subscribeToDeviceNotifications];
 
@@ -96,7 +103,16 @@
 
 - (FBDevice *)deviceWithUDID:(NSString *)udid
 {
-  return [[self.allDevices filteredArrayUsingPredicate:FBiOSTargetPredicateForUDID(udid)] firstObject];
+  return self.devicesByUDIDSnapshot[udid];
+}
+
+#pragma mark Installing
+
+- (FBFuture<FBDeviceSetInstallReport *> *)installApplicationWithPath:(NSString *)path onDevicesMatching:(NSPredicate *)predicate maximumConcurrencyPerHub:(NSUInteger)maximumConcurrencyPerHub incremental:(BOOL)incremental progress:(nullable FBDeviceSetInstallProgress)progress
+{
+  return [[FBDeviceSetInstaller
+    installerWithDeviceSet:self maximumConcurrencyPerHub:maximumConcurrencyPerHub logger:self.logger]
+    installApplicationWithPath:path onDevicesMatching:predicate incremental:incremental progress:progress];
 }
 
 #pragma mark FBiOSTargetSet Implementation
@@ -126,6 +142,21 @@
   self.restorableDeviceManager.delegate = nil;
 }
 
+- (void)publishDevices
+{
+  // Called after every change, before the delegate is told of it, so the delegate sees the change in the snapshot.
+  NSArray<FBDevice *> *devices = [self.storage.attached.allValues sortedArrayUsingDescriptors:@[[NSSortDescriptor sortDescriptorWithKey:@"uniqueIdentifier" ascending:YES]]];
+  NSMutableDictionary<NSString *, FBDevice *> *devicesByUDID = [NSMutableDictionary dictionaryWithCapacity:devices.count];
+  for (FBDevice *device in devices) {
+    NSString *udid = device.udid;
+    if (udid) {
+      devicesByUDID[udid] = device;
+    }
+  }
+  self.devicesSnapshot = devices;
+  self.devicesByUDIDSnapshot = devicesByUDID;
+}
+
 - (void)amDeviceAdded:(FBAMDevice *)amDevice
 {
   FBDevice *device = [self.storage deviceForKey:amDevice.uniqueIdentifier];
@@ -135,6 +166,7 @@
     device = [[FBDevice alloc] initWithSet:self amDevice:amDevice restorableDevice:nil logger:self.logger];
     [self.storage deviceAttached:device forKey:amDevice.uniqueIdentifier];
   }
+  [self publishDevices];
   [self.delegate targetAdded:device inTargetSet:self];
 }
 
@@ -147,9 +179,11 @@
   }
   device.amDevice = NULL;
   if (device.amDevice || device.restorableDevice) {
+    [self publishDevices];
     [self.delegate targetUpdated:device inTargetSet:self];
   } else {
     [self.storage deviceDetachedForKey:amDevice.uniqueIdentifier];
+    [self publishDevices];
     [self.delegate targetRemoved:device inTargetSet:self];
   }
 }
@@ -163,6 +197,7 @@
     device = [[FBDevice alloc] initWithSet:self amDevice:nil restorableDevice:restorableDevice logger:self.logger];
     [self.storage deviceAttached:device forKey:restorableDevice.uniqueIdentifier];
   }
+  [self publishDevices];
   [self.delegate targetAdded:device inTargetSet:self];
 }
 
@@ -175,9 +210,11 @@
   }
   device.restorableDevice = NULL;
   if (device.amDevice || device.restorableDevice) {
+    [self publishDevices];
     [self.delegate targetUpdated:device inTargetSet:self];
   } else {
     [self.storage deviceDetachedForKey:restorableDevice.uniqueIdentifier];
+    [self publishDevices];
     [self.delegate targetRemoved:device inTargetSet:self];
   }
 }
@@ -186,7 +223,7 @@
 
 - (NSArray<FBDevice *> *)allDevices
 {
-  return [self.storage.attached.allValues sortedArrayUsingSelector:@selector(uniqueIdentifier)];
+  return self.devicesSnapshot;
 }
 
 #pragma mark FBiOSTargetSetDelegate Implementation
@@ -223,6 +260,7 @@
   } else {
     NSAssert(NO, @"No existing device to update for %@", targetInfo);
   }
+  [self publishDevices];
   [self.delegate targetUpdated:device inTargetSet:self];
 }
 
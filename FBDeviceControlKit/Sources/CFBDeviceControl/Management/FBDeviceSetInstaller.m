@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBDeviceSetInstaller.h"
+
+#import "FBDevice.h"
+#import "FBDeviceApplicationCommands.h"
+#import "FBDeviceCommands.h"
+#import "FBDeviceControlError.h"
+#import "FBDeviceSet.h"
+
+// Devices without a USB location are connected over the network, and share its bandwidth.
+static NSString *const NetworkHubIdentifier = @"network";
+
+@interface FBDeviceSetInstallReport ()
+
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, FBInstalledApplication *> *mutableInstalledApplications;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSError *> *mutableErrors;
+@property (nonatomic, strong, readonly) NSDate *startDate;
+@property (nonatomic, strong, nullable, readwrite) NSDate *endDate;
+
+@end
+
+@implementation FBDeviceSetInstallReport
+
+- (instancetype)initWithStartDate:(NSDate *)startDate
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _mutableInstalledApplications = NSMutableDictionary.dictionary;
+  _mutableErrors = NSMutableDictionary.dictionary;
+  _startDate = startDate;
+
+  return self;
+}
+
+- (NSDictionary<NSString *, FBInstalledApplication *> *)installedApplications
+{
+  @synchronized (self) {
+    return [self.mutableInstalledApplications copy];
+  }
+}
+
+- (NSDictionary<NSString *, NSError *> *)errors
+{
+  @synchronized (self) {
+    return [self.mutableErrors copy];
+  }
+}
+
+- (NSTimeInterval)duration
+{
+  return [(self.endDate ?: NSDate.date) timeIntervalSinceDate:self.startDate];
+}
+
+- (NSUInteger)recordDevice:(FBDevice *)device installed:(nullable FBInstalledApplication *)installed error:(nullable NSError *)error
+{
+  @synchronized (self) {
+    if (installed) {
+      self.mutableInstalledApplications[device.udid] = installed;
+    } else {
+      self.mutableErrors[device.udid] = error;
+    }
+    return self.mutableInstalledApplications.count + self.mutableErrors.count;
+  }
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"Installed on %lu devices, failed on %lu devices, in %.1f seconds", (unsigned long) self.installedApplications.count, (unsigned long) self.errors.count, self.duration];
+}
+
+@end
+
+@interface FBDeviceSetInstaller ()
+
+@property (nonatomic, weak, readonly) FBDeviceSet *deviceSet;
+@property (nonatomic, assign, readonly) NSUInteger maximumConcurrencyPerHub;
+@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+
+@end
+
+@implementation FBDeviceSetInstaller
+
+#pragma mark Initializers
+
++ (instancetype)installerWithDeviceSet:(FBDeviceSet *)deviceSet maximumConcurrencyPerHub:(NSUInteger)maximumConcurrencyPerHub logger:(id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithDeviceSet:deviceSet maximumConcurrencyPerHub:maximumConcurrencyPerHub logger:logger];
+}
+
+- (instancetype)initWithDeviceSet:(FBDeviceSet *)deviceSet maximumConcurrencyPerHub:(NSUInteger)maximumConcurrencyPerHub logger:(id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _deviceSet = deviceSet;
+  _maximumConcurrencyPerHub = MAX(maximumConcurrencyPerHub, 1u);
+  _logger = logger;
+  _queue = dispatch_queue_create("com.facebook.fbdevicecontrol.device_set_installer", DISPATCH_QUEUE_SERIAL);
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (FBFuture<FBDeviceSetInstallReport *> *)installApplicationWithPath:(NSString *)path onDevicesMatching:(NSPredicate *)predicate incremental:(BOOL)incremental progress:(nullable FBDeviceSetInstallProgress)progress
+{
+  NSArray<FBDevice *> *devices = [self.deviceSet.allDevices filteredArrayUsingPredicate:predicate];
+  if (devices.count == 0) {
+    return [[FBDeviceControlError
+      describeFormat:@"No devices match %@", predicate]
+      failFuture];
+  }
+  FBDeviceSetInstallReport *report = [[FBDeviceSetInstallReport alloc] initWithStartDate:NSDate.date];
+  id<FBControlCoreLogger> logger = self.logger;
+
+  return [[[self
+    preparedBundleAtPath:path]
+    onQueue:self.queue pend:^(FBBundleDescriptor *bundle) {
+      // The signature is checked once here, rather than failing late on every device.
+      return [[[FBCodesignProvider
+        codeSignCommandWithAdHocIdentityWithLogger:logger]
+        cdHashForBundleAtPath:bundle.path]
+        mapReplace:bundle];
+    }]
+    onQueue:self.queue pop:^(FBBundleDescriptor *bundle) {
+      NSDictionary<NSString *, NSArray<FBDevice *> *> *devicesByHub = [FBDeviceSetInstaller devicesByHub:devices];
+      [logger logFormat:@"Installing %@ on %lu devices across %lu hubs", bundle, (unsigned long) devices.count, (unsigned long) devicesByHub.count];
+      NSMutableArray<FBFuture<NSNull *> *> *lanes = NSMutableArray.array;
+      for (NSString *hub in devicesByHub) {
+        NSMutableArray<FBDevice *> *remaining = [devicesByHub[hub] mutableCopy];
+        NSUInteger laneCount = MIN(self.maximumConcurrencyPerHub, remaining.count);
+        for (NSUInteger index = 0; index < laneCount; index++) {
+          [lanes addObject:[self installNextFrom:remaining bundlePath:bundle.path incremental:incremental report:report total:devices.count progress:progress]];
+        }
+      }
+      return [[FBFuture
+        futureWithFutures:lanes]
+        onQueue:self.queue map:^(id _) {
+          report.endDate = NSDate.date;
+          [logger logFormat:@"%@", report];
+          return report;
+        }];
+    }];
+}
+
++ (NSString *)hubIdentifierForDevice:(FBDevice *)device
+{
+  uint32_t locationID = [device.allValues[FBDeviceKeyLocationID] unsignedIntValue];
+  if (locationID == 0) {
+    return NetworkHubIdentifier;
+  }
+  // Below the bus in the top byte, each nibble is the port at one tier of hubs. Removing the last port gives the location of the hub.
+  for (uint32_t shift = 0; shift < 24; shift += 4) {
+    if ((locationID >> shift) & 0xF) {
+      locationID &= ~(0xFu << shift);
+      break;
+    }
+  }
+  return [NSString stringWithFormat:@"0x%08x", locationID];
+}
+
+#pragma mark Private
+
+- (FBFutureContext<FBBundleDescriptor *> *)preparedBundleAtPath:(NSString *)path
+{
+  id<FBControlCoreLogger> logger = self.logger;
+  if ([FBBundleDescriptor isApplicationAtPath:path]) {
+    NSError *error = nil;
+    FBBundleDescriptor *bundle = [FBBundleDescriptor bundleFromPath:path error:&error];
+    if (!bundle) {
+      return [FBFutureContext futureContextWithError:error];
+    }
+    return [FBFutureContext futureContextWithResult:bundle];
+  }
+  // Archives are extracted once for all devices, and removed when all devices have finished.
+  FBTemporaryDirectory *temporaryDirectory = [FBTemporaryDirectory temporaryDirectoryWithLogger:logger];
+  return [[temporaryDirectory
+    withArchiveExtractedFromFile:path]
+    onQueue:self.queue pend:^(NSURL *extractedDirectory) {
+      NSError *error = nil;
+      FBBundleDescriptor *bundle = [FBBundleDescriptor findAppPathFromDirectory:extractedDirectory logger:logger error:&error];
+      if (!bundle) {
+        return [FBFuture futureWithError:error];
+      }
+      return [FBFuture futureWithResult:bundle];
+    }];
+}
+
+- (FBFuture<NSNull *> *)installNextFrom:(NSMutableArray<FBDevice *> *)remaining bundlePath:(NSString *)bundlePath incremental:(BOOL)incremental report:(FBDeviceSetInstallReport *)report total:(NSUInteger)total progress:(nullable FBDeviceSetInstallProgress)progress
+{
+  FBDevice *device = nil;
+  @synchronized (remaining) {
+    device = remaining.firstObject;
+    if (device) {
+      [remaining removeObjectAtIndex:0];
+    }
+  }
+  if (!device) {
+    return FBFuture.empty;
+  }
+  // Application commands are forwarded to by the device.
+  FBDeviceApplicationCommands *commands = (FBDeviceApplicationCommands *) device;
+  return [[commands
+    installApplicationWithPath:bundlePath incremental:incremental]
+    onQueue:self.queue chain:^(FBFuture<FBInstalledApplication *> *future) {
+      NSError *error = future.error ?: (future.result ? nil : [[FBDeviceControlError describeFormat:@"Install on %@ was cancelled", device.udid] build]);
+      NSUInteger completed = [report recordDevice:device installed:future.result error:error];
+      if (error) {
+        [self.logger logFormat:@"Failed to install on %@ %@", device, error];
+      }
+      if (progress) {
+        progress(device, error, completed, total);
+      }
+      return [self installNextFrom:remaining bundlePath:bundlePath incremental:incremental report:report total:total progress:progress];
+    }];
+}
+
++ (NSDictionary<NSString *, NSArray<FBDevice *> *> *)devicesByHub:(NSArray<FBDevice *> *)devices
+{
+  NSMutableDictionary<NSString *, NSMutableArray<FBDevice *> *> *devicesByHub = NSMutableDictionary.dictionary;
+  for (FBDevice *device in devices) {
+    NSString *hub = [self hubIdentifierForDevice:device];
+    NSMutableArray<FBDevice *> *hubDevices = devicesByHub[hub] ?: NSMutableArray.array;
+    [hubDevices addObject:device];
+    devicesByHub[hub] = hubDevices;
+  }
+  return devicesByHub;
+}
+
+@end
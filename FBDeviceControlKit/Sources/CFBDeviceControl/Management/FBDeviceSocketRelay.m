@@ -0,0 +1,337 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBDeviceSocketRelay.h"
+
+#import <fcntl.h>
+#import <sys/socket.h>
+
+#import "FBDeviceControlError.h"
+
+// Large enough to fill a usbmux packet several times over, without each relay holding much memory.
+static const size_t RelayBufferSize = 1024 * 128;
+
+@interface FBDeviceSocketRelayStatistics ()
+
+- (instancetype)initWithBytesToRemote:(uint64_t)bytesToRemote bytesFromRemote:(uint64_t)bytesFromRemote averageLatency:(NSTimeInterval)averageLatency maximumLatency:(NSTimeInterval)maximumLatency;
+
+@end
+
+@implementation FBDeviceSocketRelayStatistics
+
+- (instancetype)initWithBytesToRemote:(uint64_t)bytesToRemote bytesFromRemote:(uint64_t)bytesFromRemote averageLatency:(NSTimeInterval)averageLatency maximumLatency:(NSTimeInterval)maximumLatency
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _bytesToRemote = bytesToRemote;
+  _bytesFromRemote = bytesFromRemote;
+  _averageLatency = averageLatency;
+  _maximumLatency = maximumLatency;
+
+  return self;
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"%llu bytes to remote | %llu bytes from remote | %.2fms average latency | %.2fms maximum latency", self.bytesToRemote, self.bytesFromRemote, self.averageLatency * 1000, self.maximumLatency * 1000];
+}
+
+@end
+
+/**
+ One direction of a relay, all of which is accessed on the queue of the relay.
+ */
+@interface FBDeviceSocketRelay_Direction : NSObject
+
+@property (nonatomic, assign, readonly) int source;
+@property (nonatomic, assign, readonly) int destination;
+@property (nonatomic, assign, readonly) uint8_t *buffer;
+@property (nonatomic, assign, readwrite) size_t start;
+@property (nonatomic, assign, readwrite) size_t end;
+@property (nonatomic, strong, readonly) dispatch_source_t readSource;
+@property (nonatomic, strong, readonly) dispatch_source_t writeSource;
+@property (nonatomic, assign, readwrite) BOOL readSuspended;
+@property (nonatomic, assign, readwrite) BOOL writeSuspended;
+@property (nonatomic, assign, readwrite) BOOL reachedEnd;
+@property (nonatomic, assign, readwrite) BOOL finished;
+@property (nonatomic, assign, readwrite) uint64_t bufferedSince;
+@property (nonatomic, assign, readwrite) uint64_t bytes;
+
+@end
+
+@implementation FBDeviceSocketRelay_Direction
+
+- (instancetype)initWithSource:(int)source destination:(int)destination queue:(dispatch_queue_t)queue
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _source = source;
+  _destination = destination;
+  _buffer = malloc(RelayBufferSize);
+  _readSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, (uintptr_t) source, 0, queue);
+  _writeSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_WRITE, (uintptr_t) destination, 0, queue);
+  // Sources are created suspended.
+  _readSuspended = YES;
+  _writeSuspended = YES;
+
+  return self;
+}
+
+- (void)dealloc
+{
+  free(_buffer);
+}
+
+- (void)resumeReading
+{
+  if (self.readSuspended) {
+    self.readSuspended = NO;
+    dispatch_resume(self.readSource);
+  }
+}
+
+- (void)suspendReading
+{
+  if (!self.readSuspended) {
+    self.readSuspended = YES;
+    dispatch_suspend(self.readSource);
+  }
+}
+
+- (void)resumeWriting
+{
+  if (self.writeSuspended) {
+    self.writeSuspended = NO;
+    dispatch_resume(self.writeSource);
+  }
+}
+
+- (void)suspendWriting
+{
+  if (!self.writeSuspended) {
+    self.writeSuspended = YES;
+    dispatch_suspend(self.writeSource);
+  }
+}
+
+- (void)cancel
+{
+  dispatch_source_cancel(self.readSource);
+  dispatch_source_cancel(self.writeSource);
+  // A suspended source must be resumed before it is released.
+  [self resumeReading];
+  [self resumeWriting];
+}
+
+@end
+
+@interface FBDeviceSocketRelay ()
+
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) FBDeviceSocketRelay_Direction *toRemote;
+@property (nonatomic, strong, readonly) FBDeviceSocketRelay_Direction *fromRemote;
+@property (nonatomic, strong, readonly) FBMutableFuture<FBDeviceSocketRelayStatistics *> *completed;
+
+@end
+
+@implementation FBDeviceSocketRelay
+{
+  uint64_t _latencyTotal;
+  uint64_t _latencyCount;
+  uint64_t _latencyMaximum;
+}
+
+#pragma mark Initializers
+
++ (instancetype)relayWithLocalInput:(int)localInput localOutput:(int)localOutput remoteSocket:(int)remoteSocket logger:(nullable id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithLocalInput:localInput localOutput:localOutput remoteSocket:remoteSocket logger:logger];
+}
+
+- (instancetype)initWithLocalInput:(int)localInput localOutput:(int)localOutput remoteSocket:(int)remoteSocket logger:(nullable id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _queue = dispatch_queue_create("com.facebook.fbdevicecontrol.socket_relay", DISPATCH_QUEUE_SERIAL);
+  _logger = logger;
+  _toRemote = [[FBDeviceSocketRelay_Direction alloc] initWithSource:localInput destination:remoteSocket queue:_queue];
+  _fromRemote = [[FBDeviceSocketRelay_Direction alloc] initWithSource:remoteSocket destination:localOutput queue:_queue];
+  _completed = FBMutableFuture.future;
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (FBFuture<FBDeviceSocketRelayStatistics *> *)start
+{
+  dispatch_async(self.queue, ^{
+    for (NSNumber *fileDescriptor in @[@(self.toRemote.source), @(self.toRemote.destination), @(self.fromRemote.destination)]) {
+      int flags = fcntl(fileDescriptor.intValue, F_GETFL);
+      fcntl(fileDescriptor.intValue, F_SETFL, flags | O_NONBLOCK);
+      // A write to a peer that has gone away is an error of the relay, rather than a signal to the process. Not all descriptors are sockets, so this may fail.
+      int noSigPipe = 1;
+      setsockopt(fileDescriptor.intValue, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+    }
+    // The handlers keep the relay alive whilst it runs, they are released when the sources are cancelled.
+    for (FBDeviceSocketRelay_Direction *direction in @[self.toRemote, self.fromRemote]) {
+      dispatch_source_set_event_handler(direction.readSource, ^{
+        [self readDirection:direction];
+      });
+      dispatch_source_set_event_handler(direction.writeSource, ^{
+        [self flushDirection:direction];
+      });
+      [direction resumeReading];
+    }
+  });
+  return [self.completed
+    onQueue:self.queue respondToCancellation:^{
+      [self finishWithError:nil];
+      return FBFuture.empty;
+    }];
+}
+
+- (FBDeviceSocketRelayStatistics *)statistics
+{
+  @synchronized (self) {
+    NSTimeInterval average = _latencyCount == 0 ? 0 : ((double) _latencyTotal / _latencyCount) / NSEC_PER_SEC;
+    NSTimeInterval maximum = (double) _latencyMaximum / NSEC_PER_SEC;
+    return [[FBDeviceSocketRelayStatistics alloc] initWithBytesToRemote:self.toRemote.bytes bytesFromRemote:self.fromRemote.bytes averageLatency:average maximumLatency:maximum];
+  }
+}
+
+#pragma mark Private
+
+- (void)readDirection:(FBDeviceSocketRelay_Direction *)direction
+{
+  if (direction.finished) {
+    return;
+  }
+  size_t space = RelayBufferSize - direction.end;
+  if (space == 0 && direction.start > 0) {
+    memmove(direction.buffer, direction.buffer + direction.start, direction.end - direction.start);
+    direction.end -= direction.start;
+    direction.start = 0;
+    space = RelayBufferSize - direction.end;
+  }
+  if (space == 0) {
+    // The destination is not accepting bytes as fast as they arrive, so stop reading until the buffer drains.
+    [direction suspendReading];
+    return;
+  }
+  ssize_t result = read(direction.source, direction.buffer + direction.end, space);
+  if (result < 0) {
+    if (errno == EAGAIN || errno == EINTR) {
+      return;
+    }
+    [self finishWithError:[[FBDeviceControlError describeFormat:@"Failed to read from %d: %s", direction.source, strerror(errno)] build]];
+    return;
+  }
+  if (result == 0) {
+    direction.reachedEnd = YES;
+    [direction suspendReading];
+  } else {
+    if (direction.start == direction.end) {
+      direction.bufferedSince = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    }
+    direction.end += (size_t) result;
+    @synchronized (self) {
+      direction.bytes += (uint64_t) result;
+    }
+  }
+  [self flushDirection:direction];
+}
+
+- (void)flushDirection:(FBDeviceSocketRelay_Direction *)direction
+{
+  if (direction.finished) {
+    return;
+  }
+  while (direction.start < direction.end) {
+    ssize_t result = write(direction.destination, direction.buffer + direction.start, direction.end - direction.start);
+    if (result > 0) {
+      direction.start += (size_t) result;
+      continue;
+    }
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result < 0 && errno == EAGAIN) {
+      // Wait until the destination can accept more.
+      [direction resumeWriting];
+      return;
+    }
+    if (result < 0 && errno == EPIPE) {
+      // The destination has gone away, so nothing more can be relayed in this direction.
+      [self finishDirection:direction];
+      return;
+    }
+    [self finishWithError:[[FBDeviceControlError describeFormat:@"Failed to write to %d: %s", direction.destination, strerror(errno)] build]];
+    return;
+  }
+  // The buffer has fully drained.
+  if (direction.bufferedSince != 0) {
+    uint64_t latency = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - direction.bufferedSince;
+    @synchronized (self) {
+      _latencyTotal += latency;
+      _latencyCount += 1;
+      _latencyMaximum = MAX(_latencyMaximum, latency);
+    }
+  }
+  direction.bufferedSince = 0;
+  direction.start = 0;
+  direction.end = 0;
+  [direction suspendWriting];
+  if (direction.reachedEnd) {
+    [self finishDirection:direction];
+    return;
+  }
+  [direction resumeReading];
+}
+
+- (void)finishDirection:(FBDeviceSocketRelay_Direction *)direction
+{
+  direction.finished = YES;
+  [direction cancel];
+  // Pass on the end of the source, which fails harmlessly for descriptors that are not sockets.
+  shutdown(direction.destination, SHUT_WR);
+  if (self.toRemote.finished && self.fromRemote.finished) {
+    [self finishWithError:nil];
+  }
+}
+
+- (void)finishWithError:(nullable NSError *)error
+{
+  if (self.completed.hasCompleted) {
+    return;
+  }
+  for (FBDeviceSocketRelay_Direction *direction in @[self.toRemote, self.fromRemote]) {
+    if (!direction.finished) {
+      direction.finished = YES;
+      [direction cancel];
+    }
+  }
+  FBDeviceSocketRelayStatistics *statistics = self.statistics;
+  [self.logger logFormat:@"Relay finished %@", statistics];
+  if (error) {
+    [self.completed resolveWithError:error];
+  } else {
+    [self.completed resolveWithResult:statistics];
+  }
+}
+
+@end
@@ -12,6 +12,8 @@
 @property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
 @property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, id> *attachedDevices;
 @property (nonatomic, strong, readonly) NSMapTable<NSString *, id> *referencedDevices;
+// An immutable copy of attachedDevices, replaced whenever it changes so that reads never copy.
+@property (atomic, copy, readwrite) NSDictionary<NSString *, id> *attachedSnapshot;
 
 @end
 
@@ -27,6 +29,7 @@
   _logger = logger;
   _attachedDevices = [NSMutableDictionary dictionary];
   _referencedDevices = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsCopyIn valueOptions:NSPointerFunctionsWeakMemory];
+  _attachedSnapshot = @{};
 
   return self;
 }
@@ -49,6 +52,7 @@
   }
   self.attachedDevices[key] = device;
   [self.referencedDevices setObject:device forKey:key];
+  self.attachedSnapshot = self.attachedDevices;
 }
 
 - (void)deviceDetachedForKey:(NSString *)key
@@ -57,6 +61,7 @@
   // If the device instance is not referenced elsewhere it will be removed from the referencedDevices dictionary.
   // This is because the values in that dictionary are weakly referenced.
   [self.attachedDevices removeObjectForKey:key];
+  self.attachedSnapshot = self.attachedDevices;
 }
 
 - (nullable id)deviceForKey:(NSString *)key
@@ -68,7 +73,7 @@
 
 - (NSDictionary<NSString *, id> *)attached
 {
-  return [self.attachedDevices copy];
+  return self.attachedSnapshot;
 }
 
 - (NSDictionary<NSString *, id> *)referenced
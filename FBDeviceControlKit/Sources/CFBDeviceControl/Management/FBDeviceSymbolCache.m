@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBDeviceSymbolCache.h"
+
+#import "FBDeviceControlError.h"
+
+// The metadata of an entry is written last, so an entry without it is incomplete.
+static NSString *const MetadataFileName = @"Info.plist";
+static NSString *const MetadataKeyKey = @"Key";
+static NSString *const MetadataKeyDate = @"Date";
+
+@interface FBDeviceSymbolCache ()
+
+@property (nonatomic, copy, readonly) NSString *rootDirectory;
+@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, FBFuture<NSString *> *> *populating;
+
+@end
+
+@implementation FBDeviceSymbolCache
+
+#pragma mark Initializers
+
++ (FBDeviceSymbolCache *)sharedCache
+{
+  static dispatch_once_t onceToken;
+  static FBDeviceSymbolCache *cache;
+  dispatch_once(&onceToken, ^{
+    NSString *caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject ?: NSTemporaryDirectory();
+    NSString *rootDirectory = [caches stringByAppendingPathComponent:@"com.facebook.FBDeviceControl/Symbols"];
+    cache = [self cacheWithRootDirectory:rootDirectory logger:FBControlCoreGlobalConfiguration.defaultLogger];
+  });
+  return cache;
+}
+
++ (instancetype)cacheWithRootDirectory:(NSString *)rootDirectory logger:(id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithRootDirectory:rootDirectory logger:logger];
+}
+
+- (instancetype)initWithRootDirectory:(NSString *)rootDirectory logger:(id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _rootDirectory = rootDirectory;
+  _logger = logger;
+  _populating = NSMutableDictionary.dictionary;
+
+  return self;
+}
+
+#pragma mark Public Methods
+
++ (NSString *)keyForProductVersion:(NSString *)productVersion buildVersion:(NSString *)buildVersion architecture:(NSString *)architecture
+{
+  return [NSString stringWithFormat:@"%@ (%@) %@", productVersion, buildVersion, architecture];
+}
+
+- (NSDictionary<NSString *, id> *)metadataForKey:(NSString *)key
+{
+  NSString *metadataPath = [[self directoryForKey:key] stringByAppendingPathComponent:MetadataFileName];
+  NSDictionary<NSString *, id> *metadata = [NSDictionary dictionaryWithContentsOfFile:metadataPath];
+  if (![metadata[MetadataKeyKey] isEqual:key]) {
+    return nil;
+  }
+  return metadata;
+}
+
+- (FBFuture<NSString *> *)directoryForKey:(NSString *)key onQueue:(dispatch_queue_t)queue populator:(FBDeviceSymbolCachePopulator)populator
+{
+  NSString *directory = [self directoryForKey:key];
+  @synchronized (self.populating) {
+    FBFuture<NSString *> *existing = self.populating[key];
+    if (existing) {
+      return existing;
+    }
+    if ([self metadataForKey:key]) {
+      [self.logger logFormat:@"Symbols for %@ are cached at %@", key, directory];
+      return [FBFuture futureWithResult:directory];
+    }
+    FBFuture<NSString *> *future = [self populateDirectory:directory forKey:key onQueue:queue populator:populator];
+    self.populating[key] = future;
+    [future onQueue:queue notifyOfCompletion:^(FBFuture *_) {
+      @synchronized (self.populating) {
+        [self.populating removeObjectForKey:key];
+      }
+    }];
+    return future;
+  }
+}
+
+#pragma mark Private
+
+- (NSString *)directoryForKey:(NSString *)key
+{
+  return [self.rootDirectory stringByAppendingPathComponent:key];
+}
+
+- (FBFuture<NSString *> *)populateDirectory:(NSString *)directory forKey:(NSString *)key onQueue:(dispatch_queue_t)queue populator:(FBDeviceSymbolCachePopulator)populator
+{
+  // Entries are populated in a staging directory, so that a failed or interrupted population is never mistaken for a complete entry.
+  NSString *stagingDirectory = [directory stringByAppendingFormat:@".staging.%@", NSUUID.UUID.UUIDString];
+  NSError *error = nil;
+  if (![NSFileManager.defaultManager createDirectoryAtPath:stagingDirectory withIntermediateDirectories:YES attributes:nil error:&error]) {
+    return [[FBDeviceControlError
+      describeFormat:@"Failed to create symbol cache directory %@: %@", stagingDirectory, error]
+      failFuture];
+  }
+  [self.logger logFormat:@"Populating symbols for %@", key];
+  return [[populator(stagingDirectory)
+    onQueue:queue fmap:^ FBFuture<NSString *> * (NSDictionary<NSString *, id> *populatedMetadata) {
+      NSMutableDictionary<NSString *, id> *metadata = [populatedMetadata mutableCopy];
+      metadata[MetadataKeyKey] = key;
+      metadata[MetadataKeyDate] = NSDate.date;
+      NSError *innerError = nil;
+      if (![metadata writeToURL:[NSURL fileURLWithPath:[stagingDirectory stringByAppendingPathComponent:MetadataFileName]] error:&innerError]) {
+        return [FBFuture futureWithError:innerError];
+      }
+      [NSFileManager.defaultManager removeItemAtPath:directory error:nil];
+      if (![NSFileManager.defaultManager moveItemAtPath:stagingDirectory toPath:directory error:&innerError]) {
+        return [[FBDeviceControlError
+          describeFormat:@"Failed to move symbols for %@ into the cache: %@", key, innerError]
+          failFuture];
+      }
+      [self.logger logFormat:@"Symbols for %@ are now cached at %@", key, directory];
+      return [FBFuture futureWithResult:directory];
+    }]
+    onQueue:queue handleError:^(NSError *innerError) {
+      [NSFileManager.defaultManager removeItemAtPath:stagingDirectory error:nil];
+      return [FBFuture futureWithError:innerError];
+    }];
+}
+
+@end
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBDeviceWorkflowStatistics.h"
+
+FBDeviceWorkflowPhase const FBDeviceWorkflowPhaseStaging = @"staging";
+FBDeviceWorkflowPhase const FBDeviceWorkflowPhaseVerify = @"verify";
+FBDeviceWorkflowPhase const FBDeviceWorkflowPhaseInstall = @"install";
+
+// Statuses that are not listed here continue the current phase, so new statuses in later versions of MobileDevice don't start a phase of their own.
+static FBDeviceWorkflowPhase PhaseForStatus(NSString *status)
+{
+  static dispatch_once_t onceToken;
+  static NSDictionary<NSString *, FBDeviceWorkflowPhase> *lookup;
+  dispatch_once(&onceToken, ^{
+    lookup = @{
+      @"TransferringPackage": FBDeviceWorkflowPhaseStaging,
+      @"CopyingFile": FBDeviceWorkflowPhaseStaging,
+      @"CreatingStagingDirectory": FBDeviceWorkflowPhaseStaging,
+      @"ExtractingPackage": FBDeviceWorkflowPhaseStaging,
+      @"InspectingPackage": FBDeviceWorkflowPhaseVerify,
+      @"TakingInstallLock": FBDeviceWorkflowPhaseVerify,
+      @"PreflightingApplication": FBDeviceWorkflowPhaseVerify,
+      @"InstallingEmbeddedProfile": FBDeviceWorkflowPhaseVerify,
+      @"VerifyingApplication": FBDeviceWorkflowPhaseVerify,
+      @"CreatingContainer": FBDeviceWorkflowPhaseInstall,
+      @"InstallingApplication": FBDeviceWorkflowPhaseInstall,
+      @"PostflightingApplication": FBDeviceWorkflowPhaseInstall,
+      @"SandboxingApplication": FBDeviceWorkflowPhaseInstall,
+      @"GeneratingApplicationMap": FBDeviceWorkflowPhaseInstall,
+    };
+  });
+  if (![status isKindOfClass:NSString.class]) {
+    return nil;
+  }
+  return lookup[status];
+}
+
+@interface FBDeviceWorkflowStatistics ()
+
+@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, copy, nullable, readwrite) NSDictionary<NSString *, id> *lastEvent;
+@property (nonatomic, strong, readonly) NSMutableDictionary<FBDeviceWorkflowPhase, NSNumber *> *completedDurations;
+@property (nonatomic, copy, nullable, readwrite) FBDeviceWorkflowPhase currentPhase;
+@property (nonatomic, copy, nullable, readwrite) NSDate *currentPhaseStart;
+
+@end
+
+@implementation FBDeviceWorkflowStatistics
+
+#pragma mark Initializers
+
+- (instancetype)initWithWorkflowType:(NSString *)workflowType logger:(id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _workflowType = workflowType;
+  _logger = logger;
+  _completedDurations = NSMutableDictionary.dictionary;
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (void)pushProgress:(NSDictionary<NSString *, id> *)event
+{
+  [self.logger logFormat:@"%@ Progress: %@", self.workflowType, [FBCollectionInformation oneLineDescriptionFromDictionary:event]];
+  @synchronized (self) {
+    self.lastEvent = event;
+    FBDeviceWorkflowPhase phase = PhaseForStatus(event[@"Status"]) ?: self.currentPhase ?: FBDeviceWorkflowPhaseStaging;
+    if ([phase isEqualToString:self.currentPhase]) {
+      return;
+    }
+    [self accumulateCurrentPhase];
+    self.currentPhase = phase;
+    self.currentPhaseStart = NSDate.date;
+  }
+}
+
+- (void)finish
+{
+  @synchronized (self) {
+    [self accumulateCurrentPhase];
+    self.currentPhase = nil;
+    self.currentPhaseStart = nil;
+  }
+  [self.logger logFormat:@"%@ Phase Durations: %@", self.workflowType, [FBCollectionInformation oneLineDescriptionFromDictionary:self.durationsByPhase]];
+}
+
+- (NSString *)summaryOfRecentEvents
+{
+  NSDictionary<NSString *, id> *lastEvent = self.lastEvent;
+  if (!lastEvent) {
+    return [NSString stringWithFormat:@"No events from %@", self.lastEvent];
+  }
+  return [NSString stringWithFormat:@"Last event %@", [FBCollectionInformation oneLineDescriptionFromDictionary:lastEvent]];
+}
+
+#pragma mark Properties
+
+- (NSDictionary<FBDeviceWorkflowPhase, NSNumber *> *)durationsByPhase
+{
+  @synchronized (self) {
+    NSMutableDictionary<FBDeviceWorkflowPhase, NSNumber *> *durations = [self.completedDurations mutableCopy];
+    FBDeviceWorkflowPhase phase = self.currentPhase;
+    if (phase) {
+      durations[phase] = @(durations[phase].doubleValue - self.currentPhaseStart.timeIntervalSinceNow);
+    }
+    return [durations copy];
+  }
+}
+
+#pragma mark Private
+
+- (void)accumulateCurrentPhase
+{
+  FBDeviceWorkflowPhase phase = self.currentPhase;
+  if (!phase) {
+    return;
+  }
+  // A phase may be re-entered, for instance when a status is repeated out of order, so durations are summed.
+  self.completedDurations[phase] = @(self.completedDurations[phase].doubleValue - self.currentPhaseStart.timeIntervalSinceNow);
+}
+
+@end
@@ -60,13 +60,74 @@ static const ResponsePayload InvalidResponsePayload = {
   .auxillaryValues = nil,
 };
 
+/**
+ A decoded message, either the reply to a request or a message that the device sent of its own accord on a channel.
+ */
+@interface FBInstrumentsClient_Message : NSObject
+
+@property (nonatomic, strong, nullable, readonly) id returnValue;
+@property (nonatomic, copy, nullable, readonly) NSArray<id> *auxillaryValues;
+
+@end
+
+@implementation FBInstrumentsClient_Message
+
+- (instancetype)initWithResponse:(ResponsePayload)response
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _returnValue = response.returnValue;
+  _auxillaryValues = response.auxillaryValues;
+
+  return self;
+}
+
+@end
+
+/**
+ A message that arrives in many fragments. The buffer is sized for the whole message up-front, so each fragment is received in place.
+ */
+@interface FBInstrumentsClient_PartialMessage : NSObject
+
+@property (nonatomic, strong, readonly) NSMutableData *data;
+@property (nonatomic, assign, readwrite) size_t offset;
+
+@end
+
+@implementation FBInstrumentsClient_PartialMessage
+
+- (instancetype)initWithLength:(size_t)length
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _data = [NSMutableData dataWithLength:length];
+  _offset = 0;
+
+  return self;
+}
+
+@end
+
+typedef void (^FBInstrumentsChannelHandler)(FBInstrumentsClient_Message *_Nullable message, NSError *_Nullable error);
+
 @interface FBInstrumentsClient ()
 
 @property (nonatomic, assign, readwrite) uint32 lastMessageIdentifier;
 @property (nonatomic, assign, readwrite) int32_t lastChannelIdentifier;
-@property (nonatomic, copy, readonly) NSDictionary<NSString *, id> *channels;
+@property (nonatomic, copy, nullable, readwrite) NSDictionary<NSString *, id> *channels;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, FBFuture<NSNumber *> *> *channelCodes;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSNumber *, FBMutableFuture<FBInstrumentsClient_Message *> *> *pendingReplies;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSNumber *, FBInstrumentsChannelHandler> *channelHandlers;
+@property (nonatomic, strong, nullable, readwrite) NSError *readError;
 @property (nonatomic, strong, readonly) FBAMDServiceConnection *connection;
 @property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) dispatch_queue_t readQueue;
 @property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
 
 @end
@@ -78,18 +139,14 @@ static const ResponsePayload InvalidResponsePayload = {
 + (FBFuture<FBInstrumentsClient *> *)instrumentsClientWithServiceConnection:(FBAMDServiceConnection *)connection logger:(id<FBControlCoreLogger>)logger
 {
   dispatch_queue_t queue = dispatch_queue_create("com.facebook.fbdevicecontrol.fbinstrumentsclient", DISPATCH_QUEUE_SERIAL);
-  return [FBFuture
-    onQueue:queue resolveValue:^ FBInstrumentsClient * (NSError **error) {
-      uint32 responseMessageIdentifier = 0;
-      NSDictionary<NSString *, id> *channels = [FBInstrumentsClient getAvailableChannels:connection responseMessageIdentifierOut:&responseMessageIdentifier error:error];
-      if (!channels) {
-        return nil;
-      }
-      return [[self alloc] initWithConnection:connection channels:channels lastMessageIdentifier:responseMessageIdentifier queue:queue logger:logger];
-    }];
+  dispatch_queue_t readQueue = dispatch_queue_create("com.facebook.fbdevicecontrol.fbinstrumentsclient.read", DISPATCH_QUEUE_SERIAL);
+  FBInstrumentsClient *client = [[self alloc] initWithConnection:connection queue:queue readQueue:readQueue logger:logger];
+  return [[client
+    publishCapabilities]
+    mapReplace:client];
 }
 
-- (instancetype)initWithConnection:(FBAMDServiceConnection *)connection channels:(NSDictionary<NSString *, id> *)channels lastMessageIdentifier:(uint32)lastMessageIdentifier queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger
+- (instancetype)initWithConnection:(FBAMDServiceConnection *)connection queue:(dispatch_queue_t)queue readQueue:(dispatch_queue_t)readQueue logger:(id<FBControlCoreLogger>)logger
 {
   self = [super init];
   if (!self) {
@@ -97,11 +154,14 @@ static const ResponsePayload InvalidResponsePayload = {
   }
 
   _connection = connection;
-  _channels = channels;
   _queue = queue;
+  _readQueue = readQueue;
   _logger = logger;
-  _lastMessageIdentifier = lastMessageIdentifier;
+  _lastMessageIdentifier = 0;
   _lastChannelIdentifier = 0;
+  _channelCodes = NSMutableDictionary.dictionary;
+  _pendingReplies = NSMutableDictionary.dictionary;
+  _channelHandlers = NSMutableDictionary.dictionary;
 
   return self;
 }
@@ -112,45 +172,139 @@ static NSString *const ProcessControlChannel = @"com.apple.instruments.server.se
 
 - (FBFuture<NSNumber *> *)launchApplication:(FBApplicationLaunchConfiguration *)configuration
 {
-  return [FBFuture
-    onQueue:self.queue resolveValue:^ NSNumber * (NSError **error) {
-      NSDictionary<NSString *, NSNumber *> *options = @{
-        @"StartSuspendedKey": @(configuration.waitForDebugger),
-        @"KillExisting": @(configuration.launchMode != FBApplicationLaunchModeFailIfRunning),
-      };
-      ResponsePayload response = [self
-        onChannelIdentifier:ProcessControlChannel
-        performSelector:@"launchSuspendedProcessWithDevicePath:bundleIdentifier:environment:arguments:options:"
-        argumentsData:@[
-          [FBInstrumentsClient argumentDataForArgument:@""], // devicePath:
-          [FBInstrumentsClient argumentDataForArgument:configuration.bundleID], // bundleIdentifier:
-          [FBInstrumentsClient argumentDataForArgument:configuration.environment], // environment:
-          [FBInstrumentsClient argumentDataForArgument:configuration.arguments], // arguments:
-          [FBInstrumentsClient argumentDataForArgument:options], // options:
-        ]
-        error:error];
-      if (response.success == NO) {
-        return nil;
+  NSDictionary<NSString *, NSNumber *> *options = @{
+    @"StartSuspendedKey": @(configuration.waitForDebugger),
+    @"KillExisting": @(configuration.launchMode != FBApplicationLaunchModeFailIfRunning),
+  };
+  return [[self
+    onChannelIdentifier:ProcessControlChannel
+    performSelector:@"launchSuspendedProcessWithDevicePath:bundleIdentifier:environment:arguments:options:"
+    argumentsData:@[
+      [FBInstrumentsClient argumentDataForArgument:@""], // devicePath:
+      [FBInstrumentsClient argumentDataForArgument:configuration.bundleID], // bundleIdentifier:
+      [FBInstrumentsClient argumentDataForArgument:configuration.environment], // environment:
+      [FBInstrumentsClient argumentDataForArgument:configuration.arguments], // arguments:
+      [FBInstrumentsClient argumentDataForArgument:options], // options:
+    ]]
+    onQueue:self.queue fmap:^ FBFuture<NSNumber *> * (FBInstrumentsClient_Message *message) {
+      if (![message.returnValue isKindOfClass:NSNumber.class]) {
+        return [[FBControlCoreError
+          describeFormat:@"Launch of %@ returned %@ rather than a pid", configuration.bundleID, message.returnValue]
+          failFuture];
       }
-      return response.returnValue;
+      return [FBFuture futureWithResult:message.returnValue];
     }];
 }
 
 - (FBFuture<NSNull *> *)killProcess:(pid_t)processIdentifier
 {
-  return [FBFuture
-    onQueue:self.queue resolveValue:^ NSNull * (NSError **error) {
-      ResponsePayload response = [self
-        onChannelIdentifier:ProcessControlChannel
-        performSelector:@"killPid:"
-        argumentsData:@[
-          [FBInstrumentsClient argumentDataForArgument:@(processIdentifier)], // pid:
-        ]
-        error:error];
-      if (response.success == NO) {
-        return nil;
+  return [[self
+    onChannelIdentifier:ProcessControlChannel
+    performSelector:@"killPid:"
+    argumentsData:@[
+      [FBInstrumentsClient argumentDataForArgument:@(processIdentifier)], // pid:
+    ]]
+    mapReplace:NSNull.null];
+}
+
+static NSString *const SysmontapChannel = @"com.apple.instruments.server.services.sysmontap";
+static NSString *const GraphicsChannel = @"com.apple.instruments.server.services.graphics.opengl";
+
+// The order of the system attributes is the order of the values in the "System" array of each sysmontap sample.
+static NSArray<NSString *> *SysmontapSystemAttributes(void)
+{
+  return @[@"vmFreeCount", @"vmActiveCount", @"vmInactiveCount", @"vmWireCount", @"vmCompressorPageCount"];
+}
+
+static uint64_t UnsignedValueAtIndex(NSArray<id> *values, NSUInteger index)
+{
+  id value = index < values.count ? values[index] : nil;
+  return [value isKindOfClass:NSNumber.class] ? [value unsignedLongLongValue] : 0;
+}
+
+static double DoubleValue(id value)
+{
+  return [value isKindOfClass:NSNumber.class] ? [value doubleValue] : 0;
+}
+
+- (FBFuture<id<FBiOSTargetOperation>> *)streamSystemSamplesWithInterval:(NSTimeInterval)interval consumer:(id<FBInstrumentsSampleConsumer>)consumer
+{
+  NSDictionary<NSString *, id> *config = @{
+    @"ur": @((NSUInteger) (interval * 1000)),
+    @"bm": @0,
+    @"cpuUsage": @YES,
+    @"sampleInterval": @((uint64_t) (interval * NSEC_PER_SEC)),
+    @"sysAttrs": SysmontapSystemAttributes(),
+    @"procAttrs": @[],
+  };
+  BOOL respondsToSample = [consumer respondsToSelector:@selector(consumeSystemSample:)];
+  return [self
+    streamOnChannelIdentifier:SysmontapChannel
+    setupRequests:@[
+      @[@"setConfig:", @[[FBInstrumentsClient argumentDataForArgument:config]]],
+      @[@"start", @[]],
+    ]
+    stopSelector:@"stop"
+    consumer:consumer
+    decoder:^(id returnValue) {
+      // Each message is an array of samples, system values and cpu usage may arrive in separate elements.
+      NSArray<NSDictionary<NSString *, id> *> *elements = [returnValue isKindOfClass:NSArray.class] ? returnValue : @[returnValue];
+      if (!respondsToSample) {
+        return;
+      }
+      FBInstrumentsSystemSample sample = {
+        .timestamp = NSDate.timeIntervalSinceReferenceDate,
+      };
+      BOOL hasSample = NO;
+      for (NSDictionary<NSString *, id> *element in elements) {
+        if (![element isKindOfClass:NSDictionary.class]) {
+          continue;
+        }
+        NSDictionary<NSString *, id> *cpuUsage = element[@"SystemCPUUsage"];
+        if ([cpuUsage isKindOfClass:NSDictionary.class]) {
+          sample.cpuTotalLoad = DoubleValue(cpuUsage[@"CPU_TotalLoad"]);
+          sample.cpuCount = (uint32_t) DoubleValue(element[@"EnabledCPUs"] ?: element[@"CPUCount"]);
+          hasSample = YES;
+        }
+        NSArray<id> *system = element[@"System"];
+        if ([system isKindOfClass:NSArray.class]) {
+          sample.freePages = UnsignedValueAtIndex(system, 0);
+          sample.activePages = UnsignedValueAtIndex(system, 1);
+          sample.inactivePages = UnsignedValueAtIndex(system, 2);
+          sample.wiredPages = UnsignedValueAtIndex(system, 3);
+          sample.compressedPages = UnsignedValueAtIndex(system, 4);
+          hasSample = YES;
+        }
+      }
+      if (hasSample) {
+        [consumer consumeSystemSample:sample];
       }
-      return NSNull.null;
+    }];
+}
+
+- (FBFuture<id<FBiOSTargetOperation>> *)streamGraphicsSamplesWithInterval:(NSTimeInterval)interval consumer:(id<FBInstrumentsSampleConsumer>)consumer
+{
+  BOOL respondsToSample = [consumer respondsToSelector:@selector(consumeGraphicsSample:)];
+  return [self
+    streamOnChannelIdentifier:GraphicsChannel
+    setupRequests:@[
+      @[@"setSamplingRate:", @[[FBInstrumentsClient argumentDataForArgument:@(interval * 1000)]]],
+      @[@"startSamplingAtTimeInterval:", @[[FBInstrumentsClient argumentDataForArgument:@0.0]]],
+    ]
+    stopSelector:@"stopSampling"
+    consumer:consumer
+    decoder:^(NSDictionary<NSString *, id> *returnValue) {
+      if (!respondsToSample || ![returnValue isKindOfClass:NSDictionary.class]) {
+        return;
+      }
+      FBInstrumentsGraphicsSample sample = {
+        .timestamp = DoubleValue(returnValue[@"XRVideoCardRunTimeStamp"]) / USEC_PER_SEC,
+        .framesPerSecond = DoubleValue(returnValue[@"CoreAnimationFramesPerSecond"]),
+        .deviceUtilization = DoubleValue(returnValue[@"Device Utilization %"]),
+        .rendererUtilization = DoubleValue(returnValue[@"Renderer Utilization %"]),
+        .tilerUtilization = DoubleValue(returnValue[@"Tiler Utilization %"]),
+      };
+      [consumer consumeGraphicsSample:sample];
     }];
 }
 
@@ -176,54 +330,30 @@ static NSString *const ProcessControlChannel = @"com.apple.instruments.server.se
   return classes;
 }
 
-+ (NSDictionary<NSString *, id> *)getAvailableChannels:(FBAMDServiceConnection *)connection responseMessageIdentifierOut:(uint32 *)responseMessageIdentifierOut error:(NSError **)error
-{
-  RequestPayload request = {
-    .selector = @"_notifyOfPublishedCapabilities:",
-    .argumentsData = @[self.capabilitiesArgumentData],
-    .messageIdentifier = 1,
-    .channelCode = 0,
-    .expectsReply = NO,
-  };
-  const ResponsePayload response = [self onConnection:connection requestSendAndReceive:request error:error];
-  if (response.success == NO) {
-    return nil;
-  }
-  NSDictionary<NSString *, NSNumber *> *channels = response.auxillaryValues.firstObject;
-  if (![channels isKindOfClass:NSDictionary.class]) {
-    return [[FBControlCoreError
-      describeFormat:@"%@ is not a dictionary", channels]
-      fail:error];
-  }
-  return channels;
-}
-
-+ (ResponsePayload)onConnection:(FBAMDServiceConnection *)connection requestSendAndReceive:(RequestPayload)request error:(NSError **)error
-{
-  NSData *requestData = [self requestDataFromRequest:request];
-  if (![connection send:requestData error:error]) {
-    return InvalidResponsePayload;
-  }
-  return [self receiveMessage:connection request:request error:error];
-}
-
 static const uint32 DTXMessageHeaderMagic = 0x1F3D5B79;
 
+static const uint64 ArgumentMagic = 0x1F0;
+static const uint32 EmptyDictionaryKey = 10;
+static const uint32 ObjectArgumentType = 2;
+static const uint32 Int32ArgumentType = 3;
+
 + (NSData *)requestDataFromRequest:(RequestPayload)request
 {
-  // Arguments are serialized into the auxillary data.
-  NSData *auxillaryData = [self auxillaryDataFromArgumentsData:request.argumentsData];
-
   // The selector is the "return value" of a request. In a response this will be the return value of the remote method.
-  NSError *error = nil;
-  NSData *selectorData = [NSKeyedArchiver archivedDataWithRootObject:request.selector requiringSecureCoding:NO error:&error];
-  NSAssert(selectorData, @"%@", error);
+  NSData *selectorData = [self archivedDataForObject:request.selector];
+
+  // Arguments are serialized into the auxillary data, which has a header of its own when there are arguments.
+  NSUInteger argumentsLength = 0;
+  for (NSData *argument in request.argumentsData) {
+    argumentsLength += argument.length;
+  }
+  NSUInteger auxillaryLength = request.argumentsData ? sizeof(ArgumentMagic) + sizeof(uint64) + argumentsLength : 0;
 
   // Message header is derivable from payload sizing.
   DTXMessagePayloadHeader payloadHeader;
   payloadHeader.flags = 0x2 | (request.expectsReply ? 0x1000 : 0);
-  payloadHeader.auxiliaryLength = (uint32) auxillaryData.length;
-  payloadHeader.totalLength = auxillaryData.length + selectorData.length;
+  payloadHeader.auxiliaryLength = (uint32) auxillaryLength;
+  payloadHeader.totalLength = auxillaryLength + selectorData.length;
 
   // All messages have a magic number.
   DTXMessageHeader messageHeader;
@@ -238,49 +368,32 @@ static const uint32 DTXMessageHeaderMagic = 0x1F3D5B79;
   messageHeader.channelCode = request.channelCode;
   messageHeader.expectsReply = (request.expectsReply ? 1 : 0);
 
-  // Construct the payload from the slices of data.
+  // Construct the payload from the slices of data, into a buffer of the final size.
   // This is not a multi-part message so is:
   // 1) The message header, containing the total length of the entire payload.
   // 2) The payload header, containing sizing for the aux and selector/return payloads.
   // 3) The aux data (arguments to the remote call).
   // 4) The selector/return payload (the selector to perform on the remote object).
-  NSMutableData *data = NSMutableData.data;
+  NSMutableData *data = [NSMutableData dataWithCapacity:sizeof(messageHeader) + messageHeader.length];
   [data appendBytes:&messageHeader length:sizeof(messageHeader)];
   [data appendBytes:&payloadHeader length:sizeof(payloadHeader)];
-  [data appendData:auxillaryData];
-  [data appendData:selectorData];
-  return data;
-}
-
-static const uint64 ArgumentMagic = 0x1F0;
-static const uint32 EmptyDictionaryKey = 10;
-static const uint32 ObjectArgumentType = 2;
-static const uint32 Int32ArgumentType = 3;
-
-+ (NSData *)auxillaryDataFromArgumentsData:(nullable NSArray<NSData *> *)arguments
-{
-  if (arguments == nil) {
-    return NSData.data;
-  }
-  NSMutableData *argumentsData = NSMutableData.data;
-  for (NSData *argument in arguments) {
-    [argumentsData appendData:argument];
+  if (request.argumentsData) {
+    uint64 payloadLength = argumentsLength;
+    [data appendBytes:&ArgumentMagic length:sizeof(ArgumentMagic)];
+    [data appendBytes:&payloadLength length:sizeof(payloadLength)];
+    for (NSData *argument in request.argumentsData) {
+      [data appendData:argument];
+    }
   }
-  uint64 payloadLength = argumentsData.length;
-  NSMutableData *data = NSMutableData.data;
-  [data appendBytes:&ArgumentMagic length:sizeof(ArgumentMagic)];
-  [data appendBytes:&payloadLength length:sizeof(payloadLength)];
-  [data appendData:argumentsData];
+  [data appendData:selectorData];
   return data;
 }
 
 + (NSData *)argumentDataForArgument:(id)argument
 {
-  NSError *error = nil;
-  NSData *argumentData = [NSKeyedArchiver archivedDataWithRootObject:argument requiringSecureCoding:NO error:&error];
-  NSAssert(argumentData, @"%@", error);
+  NSData *argumentData = [self archivedDataForObject:argument];
   uint32 argumentSize = (uint32) argumentData.length;
-  NSMutableData *data = NSMutableData.data;
+  NSMutableData *data = [NSMutableData dataWithCapacity:sizeof(uint32) * 3 + argumentSize];
   [data appendBytes:&EmptyDictionaryKey length:sizeof(EmptyDictionaryKey)];
   [data appendBytes:&ObjectArgumentType length:sizeof(ObjectArgumentType)];
   [data appendBytes:&argumentSize length:sizeof(argumentSize)];
@@ -288,6 +401,69 @@ static const uint32 Int32ArgumentType = 3;
   return data;
 }
 
+// Bounds the archive caches, as most of the strings and numbers they see are the same few selectors and constants.
+static const NSUInteger ArchiveCacheLimit = 256;
+// Only small payloads are looked up in the unarchive cache, larger ones are samples that are rarely repeated.
+static const NSUInteger UnarchiveCacheMaximumLength = 512;
+
++ (NSData *)archivedDataForObject:(id)object
+{
+  // Strings and numbers are immutable and compared by value, so their archives can be re-used.
+  BOOL cacheable = [object isKindOfClass:NSString.class] || [object isKindOfClass:NSNumber.class];
+  static NSMutableDictionary<id, NSData *> *cache;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    cache = NSMutableDictionary.dictionary;
+  });
+  if (cacheable) {
+    @synchronized (cache) {
+      NSData *cached = cache[object];
+      if (cached) {
+        return cached;
+      }
+    }
+  }
+  NSError *error = nil;
+  NSData *data = [NSKeyedArchiver archivedDataWithRootObject:object requiringSecureCoding:NO error:&error];
+  NSAssert(data, @"%@", error);
+  if (cacheable) {
+    @synchronized (cache) {
+      if (cache.count < ArchiveCacheLimit) {
+        cache[[object copy]] = data;
+      }
+    }
+  }
+  return data;
+}
+
++ (nullable id)unarchivedObjectFromData:(NSData *)data error:(NSError **)error
+{
+  static NSMutableDictionary<NSData *, id> *cache;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    cache = NSMutableDictionary.dictionary;
+  });
+  BOOL cacheable = data.length <= UnarchiveCacheMaximumLength;
+  if (cacheable) {
+    @synchronized (cache) {
+      id cached = cache[data];
+      if (cached) {
+        return cached;
+      }
+    }
+  }
+  id object = [NSKeyedUnarchiver unarchivedObjectOfClasses:self.supportedReturnSerializerValues fromData:data error:error];
+  // Only immutable values are cached, as the same instance is handed to every caller.
+  if (cacheable && ([object isKindOfClass:NSString.class] || [object isKindOfClass:NSNumber.class])) {
+    @synchronized (cache) {
+      if (cache.count < ArchiveCacheLimit) {
+        cache[[data copy]] = object;
+      }
+    }
+  }
+  return object;
+}
+
 + (NSData *)argumentDataForInt32:(int32_t)value
 {
   NSMutableData *data = NSMutableData.data;
@@ -297,6 +473,8 @@ static const uint32 Int32ArgumentType = 3;
   return data;
 }
 
+static const uint32 Int64ArgumentType = 6;
+
 + (NSArray<id> *)objectArgumentsFromAuxillaryData:(NSData *)data error:(NSError **)error
 {
   if (data.length < 16) {
@@ -304,31 +482,53 @@ static const uint32 Int32ArgumentType = 3;
       describeFormat:@"Data is of insufficient length %@", data]
       fail:error];
   }
-  uint64 magic = 0;
-  data = [self advanceData:data buffer:&magic length:sizeof(magic)];
-  uint64 payloadLength = 0;
-  data = [self advanceData:data buffer:&payloadLength length:sizeof(payloadLength)];
+  // Arguments are read in place at an offset, rather than slicing off the remainder after each one.
+  const uint8_t *bytes = data.bytes;
+  size_t length = data.length;
+  size_t offset = sizeof(uint64) * 2;
 
   // We need at least the length of the length of the argument data within the buffer.
   NSMutableArray<id> *arguments = NSMutableArray.array;
-  while (data.length > (sizeof(uint32) * 3)) {
-    uint32 dictionaryKey = 0;
+  while (length - offset >= (sizeof(uint32) * 3)) {
     uint32 argumentType = 0;
-    uint32 argumentLength = 0;
-    data = [self advanceData:data buffer:&dictionaryKey length:sizeof(dictionaryKey)];
-    data = [self advanceData:data buffer:&argumentType length:sizeof(argumentType)];
-    if (argumentType != 2) {
+    memcpy(&argumentType, bytes + offset + sizeof(uint32), sizeof(argumentType));
+    offset += sizeof(uint32) * 2;
+    if (argumentType == Int32ArgumentType) {
+      int32_t value = 0;
+      memcpy(&value, bytes + offset, sizeof(value));
+      offset += sizeof(value);
+      [arguments addObject:@(value)];
+      continue;
+    }
+    if (argumentType == Int64ArgumentType) {
+      if (length - offset < sizeof(int64_t)) {
+        break;
+      }
+      int64_t value = 0;
+      memcpy(&value, bytes + offset, sizeof(value));
+      offset += sizeof(value);
+      [arguments addObject:@(value)];
+      continue;
+    }
+    if (argumentType != ObjectArgumentType) {
       return [[FBControlCoreError
         describeFormat:@"Canot decode argument of type %d", argumentType]
         fail:error];
     }
-    data = [self advanceData:data buffer:&argumentLength length:sizeof(argumentLength)];
-    NSData *argumentData = nil;
-    data = [self advanceData:data dataOut:&argumentData length:argumentLength];
-    id argument = [NSKeyedUnarchiver unarchivedObjectOfClasses:self.supportedReturnSerializerValues fromData:argumentData error:error];
+    uint32 argumentLength = 0;
+    memcpy(&argumentLength, bytes + offset, sizeof(argumentLength));
+    offset += sizeof(argumentLength);
+    if (argumentLength > length - offset) {
+      return [[FBControlCoreError
+        describeFormat:@"Argument of length %u exceeds the remaining %zu bytes", argumentLength, length - offset]
+        fail:error];
+    }
+    NSData *argumentData = [data subdataWithRange:NSMakeRange(offset, argumentLength)];
+    offset += argumentLength;
+    id argument = [self unarchivedObjectFromData:argumentData error:error];
     if (!argument) {
       return [[FBControlCoreError
-        describeFormat:@"Failed to decode argument %@", data]
+        describeFormat:@"Failed to decode argument %@", argumentData]
         fail:error];
     }
     [arguments addObject:argument];
@@ -336,96 +536,36 @@ static const uint32 Int32ArgumentType = 3;
   return arguments;
 }
 
-+ (NSData *)advanceData:(NSData *)data buffer:(void *)buffer length:(size_t)length
-{
-  [data getBytes:buffer length:length];
-  return [data subdataWithRange:NSMakeRange(length, data.length - length)];
-}
-
-+ (NSData *)advanceData:(NSData *)data dataOut:(NSData **)dataOut length:(size_t)length
-{
-  if (dataOut) {
-    *dataOut = [data subdataWithRange:NSMakeRange(0, length)];
-  }
-  return [data subdataWithRange:NSMakeRange(length, data.length - length)];
-}
-
-+ (ResponsePayload)receiveMessage:(FBAMDServiceConnection *)connection request:(RequestPayload)request error:(NSError **)error
-{
-  // This header will start the first iteration of the loop, then is overwritten on each iteration.
-  DTXMessageHeader messageHeader = {
-    .magic = 0,
-    .cb = 0,
-    .fragmentId = 0,
-    .fragmentCount = UINT16_MAX,
-    .length = 0,
-    .identifier = 0,
-    .conversationIndex = 0,
-    .channelCode = 0,
-    .expectsReply = 0,
-  };
-  NSMutableData *payloadData = NSMutableData.data;
-
-  // Will execute at least once, exiting when there are no more fragments.
-  while (messageHeader.fragmentId < messageHeader.fragmentCount - 1) {
-    // Obtain the header payload in this iteration.
-    if (![connection receive:&messageHeader ofSize:sizeof(messageHeader) error:error]) {
-      return InvalidResponsePayload;
-    }
-    // The data is corrupted in some way if the magic number from the header is missing.
-    if (messageHeader.magic != DTXMessageHeaderMagic) {
-      return InvalidResponsePayload;
-    }
-    // We should always expect that identifiers are increasing.
-    if (messageHeader.conversationIndex == 0 && messageHeader.identifier < request.messageIdentifier) {
-      [[FBControlCoreError
-        describeFormat:@"Response identifier %d with lower identifier than that requested (%d)", messageHeader.identifier, request.messageIdentifier]
-        fail:error];
-      return InvalidResponsePayload;
-    }
-    if (messageHeader.conversationIndex == 1 && messageHeader.identifier != request.messageIdentifier) {
-      [[FBControlCoreError
-        describeFormat:@"Response identifier %d is not the same as requested identifier (%d)", messageHeader.identifier, request.messageIdentifier]
-        fail:error];
-      return InvalidResponsePayload;
-    }
-    // First message in a multi-part fragment has no payload, move onto the next fragment which does.
-    if (messageHeader.fragmentCount > 1 && messageHeader.fragmentId == 0) {
-      continue;
-    }
-    // Consume all data from this fragment and accumilate it.
-    NSData *fragmentData = [connection receive:messageHeader.length error:error];
-    if (!fragmentData) {
-      return InvalidResponsePayload;
-    }
-    [payloadData appendData:fragmentData];
-  }
-  return [self consumePayloadData:payloadData messageHeader:messageHeader error:error];
-}
-
 + (ResponsePayload)consumePayloadData:(NSData *)payloadData messageHeader:(DTXMessageHeader)messageHeader error:(NSError **)error
 {
   // There is a single payload header at the start of the payload, even if it is a multi-part message.
   DTXMessagePayloadHeader payloadHeader;
-  payloadData = [self advanceData:payloadData buffer:&payloadHeader length:sizeof(payloadHeader)];
+  if (payloadData.length < sizeof(payloadHeader)) {
+    [[FBControlCoreError
+      describeFormat:@"Payload of length %lu is shorter than its header", (unsigned long) payloadData.length]
+      fail:error];
+    return InvalidResponsePayload;
+  }
+  [payloadData getBytes:&payloadHeader length:sizeof(payloadHeader)];
   uint8 compression = (payloadHeader.flags & 0xFF000) >> 12;
   if (compression != 0) {
+    [[FBControlCoreError
+      describeFormat:@"Compressed payloads are not supported %d", compression]
+      fail:error];
     return InvalidResponsePayload;
   }
-
-  // First comes the auxillary data.
-  size_t auxillaryDataLength = payloadHeader.auxiliaryLength;
-  NSData *auxillaryData = nil;
-  if (auxillaryDataLength) {
-    payloadData = [self advanceData:payloadData dataOut:&auxillaryData length:auxillaryDataLength];
+  if (payloadHeader.totalLength < payloadHeader.auxiliaryLength || payloadHeader.totalLength > payloadData.length - sizeof(payloadHeader)) {
+    [[FBControlCoreError
+      describeFormat:@"Payload lengths %u and %llu do not fit in %lu bytes", payloadHeader.auxiliaryLength, payloadHeader.totalLength, (unsigned long) payloadData.length]
+      fail:error];
+    return InvalidResponsePayload;
   }
 
-  // Then comes the return value
-  size_t returnValueDataLength = payloadHeader.totalLength - payloadHeader.auxiliaryLength;
-  NSData *returnValueData = nil;
-  if (returnValueDataLength) {
-    [self advanceData:payloadData dataOut:&returnValueData length:returnValueDataLength];
-  }
+  // First comes the auxillary data, then comes the return value.
+  size_t auxillaryDataLength = payloadHeader.auxiliaryLength;
+  size_t returnValueDataLength = (size_t) (payloadHeader.totalLength - payloadHeader.auxiliaryLength);
+  NSData *auxillaryData = auxillaryDataLength ? [payloadData subdataWithRange:NSMakeRange(sizeof(payloadHeader), auxillaryDataLength)] : nil;
+  NSData *returnValueData = returnValueDataLength ? [payloadData subdataWithRange:NSMakeRange(sizeof(payloadHeader) + auxillaryDataLength, returnValueDataLength)] : nil;
 
   // Then parse the payload items.
   return [self parseReturnValueData:returnValueData auxillaryData:auxillaryData messageHeader:messageHeader error:error];
@@ -445,7 +585,7 @@ static const uint32 Int32ArgumentType = 3;
   // Then the return value of the RPC call. For some calls this will be the selector name.
   id returnValue = nil;
   if (returnValueData && returnValueData.length > 0) {
-    returnValue = [NSKeyedUnarchiver unarchivedObjectOfClasses:self.supportedReturnSerializerValues fromData:returnValueData error:error];
+    returnValue = [self unarchivedObjectFromData:returnValueData error:error];
     if (!returnValue) {
       return InvalidResponsePayload;
     }
@@ -468,60 +608,283 @@ static const uint32 Int32ArgumentType = 3;
 
 #pragma mark Private Instance Methods
 
-- (ResponsePayload)onChannelIdentifier:(NSString *)channelIdentifier performSelector:(NSString *)selector argumentsData:(nullable NSArray<NSData *> *)argumentsData error:(NSError **)error
+- (FBFuture<NSDictionary<NSString *, id> *> *)publishCapabilities
 {
-  NSNumber *channelCode = [self makeChannelWithIdentifier:channelIdentifier error:error];
-  if (!channelCode) {
-    return InvalidResponsePayload;
-  }
-  return [self onChannelCode:channelCode.unsignedIntValue performSelector:selector argumentsData:argumentsData error:error];
+  // The device publishes its channels on the root channel in response to ours, as a message of its own rather than a reply.
+  FBMutableFuture<NSDictionary<NSString *, id> *> *published = FBMutableFuture.future;
+  [self onChannelCode:0 receiveMessages:^(FBInstrumentsClient_Message *message, NSError *error) {
+    if (!message) {
+      [published resolveWithError:error];
+      return;
+    }
+    if (![message.returnValue isEqual:@"_notifyOfPublishedCapabilities:"]) {
+      return;
+    }
+    NSDictionary<NSString *, id> *channels = message.auxillaryValues.firstObject;
+    if (![channels isKindOfClass:NSDictionary.class]) {
+      [published resolveWithError:[[FBControlCoreError describeFormat:@"%@ is not a dictionary", channels] build]];
+      return;
+    }
+    [published resolveWithResult:channels];
+  }];
+  [self startReading];
+
+  return [[[FBFuture
+    onQueue:self.queue resolve:^{
+      return [self sendRequestWithSelector:@"_notifyOfPublishedCapabilities:" onChannelCode:0 argumentsData:@[FBInstrumentsClient.capabilitiesArgumentData] expectsReply:NO];
+    }]
+    onQueue:self.queue fmap:^(id _) {
+      return published;
+    }]
+    onQueue:self.queue map:^(NSDictionary<NSString *, id> *channels) {
+      self.channels = channels;
+      return channels;
+    }];
+}
+
+- (FBFuture<FBInstrumentsClient_Message *> *)onChannelIdentifier:(NSString *)channelIdentifier performSelector:(NSString *)selector argumentsData:(nullable NSArray<NSData *> *)argumentsData
+{
+  return [[self
+    makeChannelWithIdentifier:channelIdentifier]
+    onQueue:self.queue fmap:^(NSNumber *channelCode) {
+      return [self onChannelCode:channelCode.unsignedIntValue performSelector:selector argumentsData:argumentsData];
+    }];
 }
 
-- (ResponsePayload)onChannelCode:(uint32)channelCode performSelector:(NSString *)selector argumentsData:(nullable NSArray<NSData *> *)argumentsData error:(NSError **)error
+- (FBFuture<FBInstrumentsClient_Message *> *)onChannelCode:(uint32)channelCode performSelector:(NSString *)selector argumentsData:(nullable NSArray<NSData *> *)argumentsData
+{
+  return [FBFuture
+    onQueue:self.queue resolve:^{
+      return [self sendRequestWithSelector:selector onChannelCode:channelCode argumentsData:argumentsData expectsReply:YES];
+    }];
+}
+
+- (FBFuture<id<FBiOSTargetOperation>> *)streamOnChannelIdentifier:(NSString *)channelIdentifier setupRequests:(NSArray<NSArray<id> *> *)setupRequests stopSelector:(NSString *)stopSelector consumer:(id<FBInstrumentsSampleConsumer>)consumer decoder:(void (^)(id returnValue))decoder
+{
+  // Samples are decoded and consumed off the read queue, so that a slow consumer does not hold up replies on other channels.
+  dispatch_queue_t sampleQueue = dispatch_queue_create("com.facebook.fbdevicecontrol.fbinstrumentsclient.samples", DISPATCH_QUEUE_SERIAL);
+  FBMutableFuture<NSNull *> *ended = FBMutableFuture.future;
+  return [[self
+    makeChannelWithIdentifier:channelIdentifier]
+    onQueue:self.queue fmap:^(NSNumber *channelCodeNumber) {
+      uint32 channelCode = channelCodeNumber.unsignedIntValue;
+      [self onChannelCode:channelCode receiveMessages:^(FBInstrumentsClient_Message *message, NSError *error) {
+        dispatch_async(sampleQueue, ^{
+          if (!message) {
+            [ended resolveWithResult:NSNull.null];
+            return;
+          }
+          if (ended.hasCompleted || !message.returnValue) {
+            return;
+          }
+          decoder(message.returnValue);
+        });
+      }];
+      [ended onQueue:sampleQueue notifyOfCompletion:^(id _) {
+        [consumer consumeEndOfSamples];
+      }];
+      // Sampling starts without waiting on replies, the samples themselves are the acknowledgement.
+      for (NSArray<id> *setupRequest in setupRequests) {
+        NSArray<NSData *> *argumentsData = [setupRequest[1] count] > 0 ? setupRequest[1] : nil;
+        FBFuture<FBInstrumentsClient_Message *> *sent = [self sendRequestWithSelector:setupRequest[0] onChannelCode:channelCode argumentsData:argumentsData expectsReply:NO];
+        if (sent.error) {
+          [self onChannelCode:channelCode receiveMessages:nil];
+          [ended resolveWithError:sent.error];
+          return [FBFuture futureWithError:sent.error];
+        }
+      }
+      FBFuture<NSNull *> *completed = [ended
+        onQueue:self.queue respondToCancellation:^{
+          [self onChannelCode:channelCode receiveMessages:nil];
+          FBFuture<FBInstrumentsClient_Message *> *stopped = [self sendRequestWithSelector:stopSelector onChannelCode:channelCode argumentsData:nil expectsReply:NO];
+          [ended resolveWithResult:NSNull.null];
+          return [stopped mapReplace:NSNull.null];
+        }];
+      return [FBFuture futureWithResult:FBiOSTargetOperationFromFuture(completed)];
+    }];
+}
+
+- (FBFuture<NSNumber *> *)makeChannelWithIdentifier:(NSString *)identifier
+{
+  return [FBFuture
+    onQueue:self.queue resolve:^ FBFuture<NSNumber *> * {
+      // Each channel is made once per connection, then shared by every call on it.
+      FBFuture<NSNumber *> *existing = self.channelCodes[identifier];
+      if (existing) {
+        return existing;
+      }
+      if (self.channels[identifier] == nil) {
+        return [[FBControlCoreError
+          describeFormat:@"Could not make a channel %@ as it is not one of %@", identifier, self.channels.allKeys]
+          failFuture];
+      }
+      int32_t channelIdentifier = [self nextChannelIdentifier];
+      FBFuture<NSNumber *> *channelCode = [[[self
+        sendRequestWithSelector:@"_requestChannelWithCode:identifier:"
+        onChannelCode:0
+        argumentsData:@[
+          [FBInstrumentsClient argumentDataForInt32:channelIdentifier],
+          [FBInstrumentsClient argumentDataForArgument:identifier],
+        ]
+        expectsReply:YES]
+        mapReplace:@(channelIdentifier)]
+        onQueue:self.queue handleError:^(NSError *error) {
+          [self.channelCodes removeObjectForKey:identifier];
+          return [FBFuture futureWithError:error];
+        }];
+      self.channelCodes[identifier] = channelCode;
+      return channelCode;
+    }];
+}
+
+// Must be called on the queue, which serializes writes to the connection. Replies are received on the read queue, so sending never waits on a previous reply.
+- (FBFuture<FBInstrumentsClient_Message *> *)sendRequestWithSelector:(NSString *)selector onChannelCode:(uint32)channelCode argumentsData:(nullable NSArray<NSData *> *)argumentsData expectsReply:(BOOL)expectsReply
 {
   RequestPayload request = {
     .selector = selector,
     .argumentsData = argumentsData,
     .messageIdentifier = [self nextMessageIdentifier],
     .channelCode = channelCode,
-    .expectsReply = YES,
+    .expectsReply = expectsReply,
   };
-  return [self requestSendAndReceive:request error:error];
+  // The reply is registered for before sending, as it may arrive before the send returns.
+  FBMutableFuture<FBInstrumentsClient_Message *> *reply = FBMutableFuture.future;
+  NSNumber *key = @(request.messageIdentifier);
+  @synchronized (self.pendingReplies) {
+    if (self.readError) {
+      return [FBFuture futureWithError:self.readError];
+    }
+    if (expectsReply) {
+      self.pendingReplies[key] = reply;
+    }
+  }
+  NSError *error = nil;
+  if (![self.connection send:[FBInstrumentsClient requestDataFromRequest:request] error:&error]) {
+    @synchronized (self.pendingReplies) {
+      [self.pendingReplies removeObjectForKey:key];
+    }
+    return [FBFuture futureWithError:error];
+  }
+  if (!expectsReply) {
+    return [FBFuture futureWithResult:[[FBInstrumentsClient_Message alloc] initWithResponse:InvalidResponsePayload]];
+  }
+  return reply;
 }
 
-- (NSNumber *)makeChannelWithIdentifier:(NSString *)identifier error:(NSError **)error
+- (void)onChannelCode:(uint32)channelCode receiveMessages:(nullable FBInstrumentsChannelHandler)handler
 {
-  if (self.channels[identifier] == nil) {
-    return [[FBControlCoreError
-      describeFormat:@"Could not make a channel %@ as it is not one of %@", identifier, self.channels.allKeys]
-      fail:error];
+  @synchronized (self.pendingReplies) {
+    self.channelHandlers[@(channelCode)] = handler;
   }
-  int32_t channelIdentifier = [self nextChannelIdentifier];
-  RequestPayload request = {
-    .selector = @"_requestChannelWithCode:identifier:",
-    .argumentsData = @[
-      [FBInstrumentsClient argumentDataForInt32:channelIdentifier],
-      [FBInstrumentsClient argumentDataForArgument:identifier],
-    ],
-    .messageIdentifier = [self nextMessageIdentifier],
-    .channelCode = 0,
-    .expectsReply = YES,
-  };
-  ResponsePayload response = [self requestSendAndReceive:request error:error];
-  if (response.success == NO) {
-    return nil;
+}
+
+- (void)startReading
+{
+  dispatch_async(self.readQueue, ^{
+    NSError *error = [self readUntilError];
+    [self.logger logFormat:@"Stopped reading from instruments connection %@", error];
+    NSArray<FBMutableFuture<FBInstrumentsClient_Message *> *> *pendingReplies = nil;
+    NSArray<FBInstrumentsChannelHandler> *channelHandlers = nil;
+    @synchronized (self.pendingReplies) {
+      self.readError = error;
+      pendingReplies = self.pendingReplies.allValues;
+      channelHandlers = self.channelHandlers.allValues;
+      [self.pendingReplies removeAllObjects];
+      [self.channelHandlers removeAllObjects];
+    }
+    for (FBMutableFuture<FBInstrumentsClient_Message *> *reply in pendingReplies) {
+      [reply resolveWithError:error];
+    }
+    for (FBInstrumentsChannelHandler handler in channelHandlers) {
+      handler(nil, error);
+    }
+  });
+}
+
+- (NSError *)readUntilError
+{
+  NSError *error = nil;
+  // Fragments of different messages may be interleaved, so partial messages are keyed by channel and identifier.
+  NSMutableDictionary<NSNumber *, FBInstrumentsClient_PartialMessage *> *partialMessages = NSMutableDictionary.dictionary;
+  while (YES) {
+    DTXMessageHeader messageHeader;
+    if (![self.connection receive:&messageHeader ofSize:sizeof(messageHeader) error:&error]) {
+      return error;
+    }
+    // The data is corrupted in some way if the magic number from the header is missing.
+    if (messageHeader.magic != DTXMessageHeaderMagic) {
+      return [[FBControlCoreError
+        describeFormat:@"Message header has magic %x rather than %x", messageHeader.magic, DTXMessageHeaderMagic]
+        build];
+    }
+    NSNumber *key = @(((uint64) messageHeader.channelCode << 32) | messageHeader.identifier);
+    // First message in a multi-part fragment has no payload, its length is that of the whole message.
+    if (messageHeader.fragmentCount > 1 && messageHeader.fragmentId == 0) {
+      partialMessages[key] = [[FBInstrumentsClient_PartialMessage alloc] initWithLength:messageHeader.length];
+      continue;
+    }
+    NSMutableData *payloadData = nil;
+    if (messageHeader.fragmentCount > 1) {
+      FBInstrumentsClient_PartialMessage *partialMessage = partialMessages[key];
+      if (!partialMessage || messageHeader.length > partialMessage.data.length - partialMessage.offset) {
+        return [[FBControlCoreError
+          describeFormat:@"Fragment %d of message %d does not fit the message", messageHeader.fragmentId, messageHeader.identifier]
+          build];
+      }
+      if (![self.connection receive:(uint8_t *) partialMessage.data.mutableBytes + partialMessage.offset ofSize:messageHeader.length error:&error]) {
+        return error;
+      }
+      partialMessage.offset += messageHeader.length;
+      if (messageHeader.fragmentId < messageHeader.fragmentCount - 1) {
+        continue;
+      }
+      [partialMessages removeObjectForKey:key];
+      payloadData = partialMessage.data;
+    } else {
+      payloadData = [NSMutableData dataWithLength:messageHeader.length];
+      if (messageHeader.length > 0 && ![self.connection receive:payloadData.mutableBytes ofSize:messageHeader.length error:&error]) {
+        return error;
+      }
+    }
+    [self dispatchPayloadData:payloadData messageHeader:messageHeader];
   }
-  return @(channelIdentifier);
 }
 
-- (ResponsePayload)requestSendAndReceive:(RequestPayload)request error:(NSError **)error
+- (void)dispatchPayloadData:(NSData *)payloadData messageHeader:(DTXMessageHeader)messageHeader
 {
-  ResponsePayload response = [FBInstrumentsClient onConnection:self.connection requestSendAndReceive:request error:error];
+  NSError *error = nil;
+  ResponsePayload response = [FBInstrumentsClient consumePayloadData:payloadData messageHeader:messageHeader error:&error];
+  if (messageHeader.conversationIndex > 0) {
+    FBMutableFuture<FBInstrumentsClient_Message *> *reply = nil;
+    @synchronized (self.pendingReplies) {
+      reply = self.pendingReplies[@(messageHeader.identifier)];
+      [self.pendingReplies removeObjectForKey:@(messageHeader.identifier)];
+    }
+    if (!reply) {
+      [self.logger logFormat:@"Reply to message %d that is not pending", messageHeader.identifier];
+      return;
+    }
+    if (response.success == NO) {
+      [reply resolveWithError:error ?: [[FBControlCoreError describeFormat:@"Invalid reply to message %d", messageHeader.identifier] build]];
+      return;
+    }
+    [reply resolveWithResult:[[FBInstrumentsClient_Message alloc] initWithResponse:response]];
+    return;
+  }
+  // Messages that the device sends of its own accord on a channel are addressed with the negation of its code.
+  uint32 channelCode = (uint32) abs((int32_t) messageHeader.channelCode);
+  FBInstrumentsChannelHandler handler = nil;
+  @synchronized (self.pendingReplies) {
+    handler = self.channelHandlers[@(channelCode)];
+  }
+  if (!handler) {
+    return;
+  }
   if (response.success == NO) {
-    return InvalidResponsePayload;
+    [self.logger logFormat:@"Failed to decode message %d on channel %d %@", messageHeader.identifier, channelCode, error];
+    return;
   }
-  self.lastMessageIdentifier = response.messageIdentifier;
-  return response;
+  handler([[FBInstrumentsClient_Message alloc] initWithResponse:response], nil);
 }
 
 - (uint32)nextMessageIdentifier
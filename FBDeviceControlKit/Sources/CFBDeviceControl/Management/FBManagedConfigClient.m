@@ -116,7 +116,7 @@ static NSString * const PayloadVersion = @"PayloadVersion";
       NSDictionary<NSString *, id> *profileMetadata = result[ProfileMetadata][profileName];
       if (!profileMetadata) {
         return [[FBControlCoreError
-          describeFormat:@"%@ is not one of %@", profileName, [FBCollectionInformation oneLineDescriptionFromArray:result[OrderedIdentifiers]]]
+          describeFormat:@"%@ is not one of %@", profileName, [FBCollectionInformation lazyOneLineDescriptionFromArray:result[OrderedIdentifiers]]]
           fail:error];
       }
       NSDictionary<NSString *, id> *profileIdentifier = @{
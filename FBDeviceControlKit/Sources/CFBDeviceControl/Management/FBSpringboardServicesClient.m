@@ -15,15 +15,114 @@ NSString *const FBSpringboardServiceName = @"com.apple.springboardservices";
 FBWallpaperName const FBWallpaperNameHomescreen = @"homescreen";
 FBWallpaperName const FBWallpaperNameLockscreen = @"lockscreen";
 
+typedef NSArray<NSArray<NSString *> *> *IconLayoutJSONType;
+
+/**
+ An immutable model of an Icon Layout, which derives its lookups once rather than each time they are needed.
+ */
+@interface FBSpringboardIconLayout : NSObject
+
+@property (nonatomic, copy, readonly) IconLayoutType pages;
+@property (nonatomic, copy, readonly) NSDictionary<NSString *, NSDictionary<NSString *, id> *> *iconsByBundleID;
+@property (nonatomic, copy, readonly) IconLayoutJSONType flattened;
+
+- (instancetype)initWithPages:(IconLayoutType)pages;
+- (NSIndexSet *)indexesOfPagesChangedFrom:(FBSpringboardIconLayout *)previous;
+- (nullable NSString *)entityTagForBundleID:(NSString *)bundleID;
+
+@end
+
+@implementation FBSpringboardIconLayout
+{
+  NSDictionary<NSString *, NSDictionary<NSString *, id> *> *_iconsByBundleID;
+  IconLayoutJSONType _flattened;
+}
+
+- (instancetype)initWithPages:(IconLayoutType)pages
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _pages = [pages copy];
+
+  return self;
+}
+
+- (NSDictionary<NSString *, NSDictionary<NSString *, id> *> *)iconsByBundleID
+{
+  if (!_iconsByBundleID) {
+    NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> *iconsByBundleID = NSMutableDictionary.dictionary;
+    for (NSArray<NSDictionary<NSString *, id> *> *page in self.pages) {
+      for (NSDictionary<NSString *, id> *icon in page) {
+        NSString *bundleIdentifier = icon[@"bundleIdentifier"];
+        if (bundleIdentifier) {
+          iconsByBundleID[bundleIdentifier] = icon;
+        }
+      }
+    }
+    _iconsByBundleID = [iconsByBundleID copy];
+  }
+  return _iconsByBundleID;
+}
+
+- (IconLayoutJSONType)flattened
+{
+  if (!_flattened) {
+    NSMutableArray<NSArray<NSString *> *> *flatFormat = NSMutableArray.array;
+    for (NSArray<NSDictionary<NSString *, id> *> *basePage in self.pages) {
+      NSMutableArray<NSString *> *flatPage = NSMutableArray.array;
+      for (NSDictionary<NSString *, id> *icon in basePage) {
+        NSString *bundleIdentifier = icon[@"bundleIdentifier"];
+        [flatPage addObject:bundleIdentifier];
+      }
+      [flatFormat addObject:flatPage];
+    }
+    _flattened = [flatFormat copy];
+  }
+  return _flattened;
+}
+
+- (NSIndexSet *)indexesOfPagesChangedFrom:(FBSpringboardIconLayout *)previous
+{
+  NSMutableIndexSet *changed = NSMutableIndexSet.indexSet;
+  NSUInteger count = MAX(self.pages.count, previous.pages.count);
+  for (NSUInteger index = 0; index < count; index++) {
+    NSArray<NSDictionary<NSString *, id> *> *page = index < self.pages.count ? self.pages[index] : nil;
+    NSArray<NSDictionary<NSString *, id> *> *previousPage = index < previous.pages.count ? previous.pages[index] : nil;
+    if (![page isEqualToArray:previousPage]) {
+      [changed addIndex:index];
+    }
+  }
+  return changed;
+}
+
+- (nullable NSString *)entityTagForBundleID:(NSString *)bundleID
+{
+  // An icon only changes when the application is updated or Springboard re-renders it.
+  NSDictionary<NSString *, id> *icon = self.iconsByBundleID[bundleID];
+  if (!icon) {
+    return nil;
+  }
+  return [NSString stringWithFormat:@"%@|%@", icon[@"bundleVersion"] ?: @"", icon[@"iconModDate"] ?: @""];
+}
+
+@end
+
 @interface FBSpringboardServicesClient ()
 
 @property (nonatomic, strong, readonly) FBAMDServiceConnection *connection;
 @property (nonatomic, strong, readonly) dispatch_queue_t queue;
 @property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+// The layout last fetched from or sent to Springboard, only accessed on the queue.
+@property (nonatomic, strong, nullable, readwrite) FBSpringboardIconLayout *cachedLayout;
+// Icon PNG Data and the entity tag of the icon it was fetched for, keyed by Bundle ID. Only accessed on the queue.
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, NSArray *> *cachedIconImages;
 
-@end
+- (FBFuture<FBSpringboardIconLayout *> *)iconLayoutUsingCache:(BOOL)useCache;
 
-typedef NSArray<NSArray<NSString *> *> *IconLayoutJSONType;
+@end
 
 @interface FBSpringboardServicesIconContainer : NSObject <FBFileContainer>
 
@@ -61,17 +160,18 @@ static NSString *const IconJSONFile = @"icons.json";
 {
   NSString *filename = sourcePath.lastPathComponent;
   return [[FBFuture
-    onQueue:self.client.queue resolve:^ FBFuture<IconLayoutType> * {
+    onQueue:self.client.queue resolve:^ FBFuture<FBSpringboardIconLayout *> * {
       if (![self.validFilenames containsObject:filename]) {
         return [[FBControlCoreError
-          describeFormat:@"%@ is not one of %@", filename, [FBCollectionInformation oneLineDescriptionFromArray:self.validFilenames]]
+          describeFormat:@"%@ is not one of %@", filename, [FBCollectionInformation lazyOneLineDescriptionFromArray:self.validFilenames]]
           failFuture];
       }
-      return [self.client getIconLayout];
+      return [self.client iconLayoutUsingCache:NO];
     }]
-    onQueue:self.client.queue fmap:^ FBFuture<NSString *> * (IconLayoutType layout) {
+    onQueue:self.client.queue fmap:^ FBFuture<NSString *> * (FBSpringboardIconLayout *model) {
+      IconLayoutType layout = model.pages;
       if ([filename isEqualToString:IconJSONFile]) {
-        IconLayoutJSONType jsonLayout = [FBSpringboardServicesIconContainer flattenBaseFormat:layout];
+        IconLayoutJSONType jsonLayout = model.flattened;
         NSError *error = nil;
         NSData *data = [NSJSONSerialization dataWithJSONObject:jsonLayout options:NSJSONWritingPrettyPrinted error:&error];
         if (!data) {
@@ -161,7 +261,7 @@ static NSString *const IconJSONFile = @"icons.json";
         return [FBFuture futureWithResult:layout];
       }
       return [[FBControlCoreError
-        describeFormat:@"%@ is not one of %@", filename, [FBCollectionInformation oneLineDescriptionFromArray:self.validFilenames]]
+        describeFormat:@"%@ is not one of %@", filename, [FBCollectionInformation lazyOneLineDescriptionFromArray:self.validFilenames]]
         failFuture];
     }];
 }
@@ -169,17 +269,17 @@ static NSString *const IconJSONFile = @"icons.json";
 - (FBFuture<IconLayoutType> *)convertJSONFormatToWireFormat:(IconLayoutJSONType)jsonFormat
 {
   return [[self.client
-    getIconLayout]
-    onQueue:self.client.queue fmap:^ FBFuture<IconLayoutType> * (IconLayoutType currentApps) {
-      NSDictionary<NSString *, NSDictionary<NSString *, id> *> *iconsByBundleID = [FBSpringboardServicesIconContainer keyIconsByBundleID:currentApps];
+    iconLayoutUsingCache:NO]
+    onQueue:self.client.queue fmap:^ FBFuture<IconLayoutType> * (FBSpringboardIconLayout *currentLayout) {
+      NSDictionary<NSString *, NSDictionary<NSString *, id> *> *iconsByBundleID = currentLayout.iconsByBundleID;
       NSMutableArray<NSArray<NSDictionary<NSString *, id> *> *> *format = NSMutableArray.array;
       for (NSArray<NSString *> *jsonPage in jsonFormat) {
         NSMutableArray<NSDictionary<NSString *, id> *> *fullPage = NSMutableArray.array;
         for (NSString *bundleID in jsonPage) {
           NSDictionary<NSString *, id> *icon = iconsByBundleID[bundleID];
-          if (!bundleID) {
+          if (!icon) {
             return [[FBControlCoreError
-              describeFormat:@"Cannot use layout %@ is not any of %@", bundleID, [FBCollectionInformation oneLineDescriptionFromArray:iconsByBundleID.allKeys]]
+              describeFormat:@"Cannot use layout %@ is not any of %@", bundleID, [FBCollectionInformation lazyOneLineDescriptionFromArray:iconsByBundleID.allKeys]]
               failFuture];
           }
           [fullPage addObject:icon];
@@ -190,32 +290,6 @@ static NSString *const IconJSONFile = @"icons.json";
     }];
 }
 
-+ (IconLayoutJSONType)flattenBaseFormat:(IconLayoutType)baseFormat
-{
-  NSMutableArray<NSArray<NSString *> *> *flatFormat = NSMutableArray.array;
-  for (NSArray<NSDictionary<NSString *, id> *> *basePage in baseFormat) {
-    NSMutableArray<NSString *> *flatPage = NSMutableArray.array;
-    for (NSDictionary<NSString *, id> *icon in basePage) {
-      NSString *bundleIdentifier = icon[@"bundleIdentifier"];
-      [flatPage addObject:bundleIdentifier];
-    }
-    [flatFormat addObject:flatPage];
-  }
-  return flatFormat;
-}
-
-+ (NSDictionary<NSString *, NSDictionary<NSString *, id> *> *)keyIconsByBundleID:(IconLayoutType)layout
-{
-  NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> *iconsByBundleID = NSMutableDictionary.dictionary;
-  for (NSArray<NSDictionary<NSString *, id> *> *page in layout) {
-    for (NSDictionary<NSString *, id> *icon in page) {
-      NSString *bundleIdentifier = icon[@"bundleIdentifier"];
-      iconsByBundleID[bundleIdentifier] = icon;
-    }
-  }
-  return iconsByBundleID;
-}
-
 @end
 
 @implementation FBSpringboardServicesClient
@@ -238,6 +312,7 @@ static NSString *const IconJSONFile = @"icons.json";
   _connection = connection;
   _queue = queue;
   _logger = logger;
+  _cachedIconImages = NSMutableDictionary.dictionary;
 
   return self;
 }
@@ -247,13 +322,10 @@ static NSString *const IconJSONFile = @"icons.json";
 
 - (FBFuture<IconLayoutType> *)getIconLayout
 {
-  return [FBFuture
-    onQueue:self.queue resolveValue:^ IconLayoutType (NSError **error) {
-      IconLayoutType result = [self.connection sendAndReceiveMessage:@{@"command": @"getIconState", @"formatVersion": @"2"} error:error];
-      if (!result) {
-        return nil;
-      }
-      return result;
+  return [[self
+    iconLayoutUsingCache:NO]
+    onQueue:self.queue map:^ IconLayoutType (FBSpringboardIconLayout *layout) {
+      return layout.pages;
     }];
 }
 
@@ -263,19 +335,98 @@ static size_t IconLayoutSize = 4;
 {
   return [FBFuture
     onQueue:self.queue resolveValue:^ NSNull * (NSError **error) {
+      FBSpringboardIconLayout *layout = [[FBSpringboardIconLayout alloc] initWithPages:iconLayout];
+      FBSpringboardIconLayout *previous = self.cachedLayout;
+      if (previous) {
+        // Springboard only accepts the whole layout, so the diff can only avoid sending a layout that is already in place.
+        NSIndexSet *changedPages = [layout indexesOfPagesChangedFrom:previous];
+        if (changedPages.count == 0) {
+          [self.logger log:@"Icon layout is unchanged, not sending it"];
+          return NSNull.null;
+        }
+        [self.logger logFormat:@"Icon layout has changed on %lu of %lu pages", (unsigned long) changedPages.count, (unsigned long) iconLayout.count];
+      }
       // A message is not returned upon the connection, so we just have to send the data itself and check it was acked.
       if (![self.connection sendMessage:@{@"command": @"setIconState", @"iconState": iconLayout} error:error]) {
+        self.cachedLayout = nil;
         return nil;
       }
       // Recieve some data to know that it reached the other side, in the event of a failure we will receive no bytes. 
       NSData *data = [self.connection receive:IconLayoutSize error:error];
       if (!data) {
+        self.cachedLayout = nil;
         return nil;
       }
+      self.cachedLayout = layout;
       return NSNull.null;
     }];
 }
 
+// The number of icon requests that are sent ahead of their responses when fetching a batch of icons.
+static NSUInteger IconPipelineDepth = 8;
+
+- (FBFuture<NSData *> *)iconImageDataForBundleID:(NSString *)bundleID
+{
+  return [[self
+    iconLayoutUsingCache:YES]
+    onQueue:self.queue fmap:^ FBFuture<NSData *> * (FBSpringboardIconLayout *layout) {
+      NSString *entityTag = [layout entityTagForBundleID:bundleID];
+      NSArray *cached = self.cachedIconImages[bundleID];
+      if (entityTag && [cached.firstObject isEqualToString:entityTag]) {
+        return [FBFuture futureWithResult:cached.lastObject];
+      }
+      NSError *error = nil;
+      NSDictionary<NSString *, id> *response = [self.connection sendAndReceiveMessage:[FBSpringboardServicesClient iconRequestForBundleID:bundleID] error:&error];
+      if (!response) {
+        return [FBFuture futureWithError:error];
+      }
+      return [self cacheIconResponse:response bundleID:bundleID entityTag:entityTag];
+    }];
+}
+
+- (FBFuture<NSDictionary<NSString *, NSData *> *> *)iconImageDataForBundleIDs:(NSArray<NSString *> *)bundleIDs
+{
+  return [[self
+    iconLayoutUsingCache:YES]
+    onQueue:self.queue fmap:^ FBFuture<NSDictionary<NSString *, NSData *> *> * (FBSpringboardIconLayout *layout) {
+      NSMutableDictionary<NSString *, NSData *> *icons = NSMutableDictionary.dictionary;
+      NSMutableArray<NSString *> *missing = NSMutableArray.array;
+      for (NSString *bundleID in [NSOrderedSet orderedSetWithArray:bundleIDs]) {
+        NSString *entityTag = [layout entityTagForBundleID:bundleID];
+        NSArray *cached = self.cachedIconImages[bundleID];
+        if (entityTag && [cached.firstObject isEqualToString:entityTag]) {
+          icons[bundleID] = cached.lastObject;
+        } else {
+          [missing addObject:bundleID];
+        }
+      }
+      if (missing.count == 0) {
+        return [FBFuture futureWithResult:[icons copy]];
+      }
+
+      NSMutableArray<NSDictionary<NSString *, id> *> *requests = NSMutableArray.array;
+      for (NSString *bundleID in missing) {
+        [requests addObject:[FBSpringboardServicesClient iconRequestForBundleID:bundleID]];
+      }
+      NSArray<FBFuture<id> *> *responses = [self.connection sendMessagesPipelined:requests depth:IconPipelineDepth onQueue:self.queue];
+      NSMutableArray<FBFuture<NSData *> *> *fetched = NSMutableArray.array;
+      [missing enumerateObjectsUsingBlock:^(NSString *bundleID, NSUInteger index, BOOL *_) {
+        NSString *entityTag = [layout entityTagForBundleID:bundleID];
+        [fetched addObject:[responses[index] onQueue:self.queue fmap:^ FBFuture<NSData *> * (NSDictionary<NSString *, id> *response) {
+          return [self cacheIconResponse:response bundleID:bundleID entityTag:entityTag];
+        }]];
+      }];
+      return [[FBFuture
+        futureWithFutures:fetched]
+        onQueue:self.queue map:^ NSDictionary<NSString *, NSData *> * (NSArray<NSData *> *datas) {
+          [missing enumerateObjectsUsingBlock:^(NSString *bundleID, NSUInteger index, BOOL *_) {
+            icons[bundleID] = datas[index];
+          }];
+          return [icons copy];
+        }];
+    }];
+}
+
 - (FBFuture<NSData *> *)wallpaperImageDataForKind:(FBWallpaperName)name
 {
   return [FBFuture
@@ -299,4 +450,42 @@ static size_t IconLayoutSize = 4;
   return [[FBSpringboardServicesIconContainer alloc] initWithClient:self];
 }
 
+#pragma mark Private
+
+- (FBFuture<FBSpringboardIconLayout *> *)iconLayoutUsingCache:(BOOL)useCache
+{
+  return [FBFuture
+    onQueue:self.queue resolveValue:^ FBSpringboardIconLayout * (NSError **error) {
+      if (useCache && self.cachedLayout) {
+        return self.cachedLayout;
+      }
+      IconLayoutType result = [self.connection sendAndReceiveMessage:@{@"command": @"getIconState", @"formatVersion": @"2"} error:error];
+      if (!result) {
+        return nil;
+      }
+      FBSpringboardIconLayout *layout = [[FBSpringboardIconLayout alloc] initWithPages:result];
+      self.cachedLayout = layout;
+      return layout;
+    }];
+}
+
++ (NSDictionary<NSString *, id> *)iconRequestForBundleID:(NSString *)bundleID
+{
+  return @{@"command": @"getIconPNGData", @"bundleId": bundleID};
+}
+
+- (FBFuture<NSData *> *)cacheIconResponse:(NSDictionary<NSString *, id> *)response bundleID:(NSString *)bundleID entityTag:(nullable NSString *)entityTag
+{
+  NSData *data = response[@"pngData"];
+  if (![data isKindOfClass:NSData.class]) {
+    return [[FBControlCoreError
+      describeFormat:@"No pngData for %@ in response %@", bundleID, response]
+      failFuture];
+  }
+  if (entityTag) {
+    self.cachedIconImages[bundleID] = @[entityTag, data];
+  }
+  return [FBFuture futureWithResult:data];
+}
+
 @end
@@ -98,6 +98,7 @@ DYLD_INTERPOSE(FBDeviceControlFrameworkLoader_asl_open, asl_open);
   calls->Disconnect = FBGetSymbolFromHandle(handle, "AMDeviceDisconnect");
   calls->EnterRecovery = FBGetSymbolFromHandle(handle, "AMDeviceEnterRecovery");
   calls->GetConnectionID = FBGetSymbolFromHandle(handle, "AMDeviceGetConnectionID");
+  calls->GetInterfaceType = FBGetSymbolFromHandleOptional(handle, "AMDeviceGetInterfaceType");
   calls->InitializeMobileDevice = FBGetSymbolFromHandle(handle, "_InitializeMobileDevice");
   calls->InstallProvisioningProfile = FBGetSymbolFromHandle(handle, "AMDeviceInstallProvisioningProfile");
   calls->IsPaired = FBGetSymbolFromHandle(handle, "AMDeviceIsPaired");
@@ -144,6 +145,7 @@ DYLD_INTERPOSE(FBDeviceControlFrameworkLoader_asl_open, asl_open);
   calls->SetLogLevel = FBGetSymbolFromHandle(handle, "AMDSetLogLevel");
   calls->StartSession = FBGetSymbolFromHandle(handle, "AMDeviceStartSession");
   calls->StopSession = FBGetSymbolFromHandle(handle, "AMDeviceStopSession");
+  calls->USBLocationID = FBGetSymbolFromHandleOptional(handle, "AMDeviceUSBLocationID");
   calls->USBMuxConnectByPort = FBGetSymbolFromHandle(handle, "USBMuxConnectByPort");
   calls->ValidatePairing = FBGetSymbolFromHandle(handle, "AMDeviceValidatePairing");
 
@@ -0,0 +1,362 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBDeviceLogEntry.h"
+
+#import "FBControlCore.h"
+
+// Process and subsystem names repeat across nearly every line, far fewer than this are seen in practice.
+static NSUInteger const FBDeviceLogEntryParserInternedStringCapacity = 1024;
+
+typedef struct {
+  const char *bytes;
+  size_t length;
+} FBDeviceLogSpan;
+
+typedef struct {
+  FBDeviceLogSpan timestamp;
+  FBDeviceLogSpan process;
+  FBDeviceLogSpan subsystem;
+  pid_t processIdentifier;
+  FBDeviceLogLevel level;
+  FBDeviceLogSpan message;
+} FBDeviceLogHeader;
+
+static BOOL FBDeviceLogSpanEquals(FBDeviceLogSpan span, const char *string)
+{
+  size_t length = strlen(string);
+  return span.length == length && memcmp(span.bytes, string, length) == 0;
+}
+
+static FBDeviceLogLevel FBDeviceLogLevelFromSpan(FBDeviceLogSpan span)
+{
+  if (FBDeviceLogSpanEquals(span, "Notice")) {
+    return FBDeviceLogLevelNotice;
+  }
+  if (FBDeviceLogSpanEquals(span, "Debug")) {
+    return FBDeviceLogLevelDebug;
+  }
+  if (FBDeviceLogSpanEquals(span, "Info")) {
+    return FBDeviceLogLevelInfo;
+  }
+  if (FBDeviceLogSpanEquals(span, "Warning")) {
+    return FBDeviceLogLevelWarning;
+  }
+  if (FBDeviceLogSpanEquals(span, "Error")) {
+    return FBDeviceLogLevelError;
+  }
+  if (FBDeviceLogSpanEquals(span, "Fault") || FBDeviceLogSpanEquals(span, "Critical") || FBDeviceLogSpanEquals(span, "Alert") || FBDeviceLogSpanEquals(span, "Emergency")) {
+    return FBDeviceLogLevelFault;
+  }
+  return FBDeviceLogLevelNotice;
+}
+
+// Parses the header of a syslog relay line in place, for example:
+// "Oct 14 10:15:22 iPhone SpringBoard(FrontBoard)[58] <Notice>: message"
+static BOOL FBDeviceLogParseHeader(const char *bytes, size_t length, FBDeviceLogHeader *header)
+{
+  // The timestamp is fixed width, as the day of the month is padded with a space.
+  if (length < 16 || bytes[3] != ' ' || bytes[9] != ':' || bytes[12] != ':' || bytes[15] != ' ') {
+    return NO;
+  }
+  header->timestamp = (FBDeviceLogSpan) {bytes, 15};
+  const char *end = bytes + length;
+  const char *cursor = bytes + 16;
+
+  // The device name.
+  const char *space = memchr(cursor, ' ', (size_t) (end - cursor));
+  if (!space) {
+    return NO;
+  }
+  cursor = space + 1;
+
+  // The process, with an optional subsystem in parentheses, followed by the pid in brackets.
+  const char *openBracket = memchr(cursor, '[', (size_t) (end - cursor));
+  if (!openBracket || openBracket == cursor) {
+    return NO;
+  }
+  header->process = (FBDeviceLogSpan) {cursor, (size_t) (openBracket - cursor)};
+  header->subsystem = (FBDeviceLogSpan) {NULL, 0};
+  if (openBracket[-1] == ')') {
+    for (const char *openParen = openBracket - 2; openParen > cursor; openParen--) {
+      if (*openParen == '(') {
+        header->process = (FBDeviceLogSpan) {cursor, (size_t) (openParen - cursor)};
+        header->subsystem = (FBDeviceLogSpan) {openParen + 1, (size_t) (openBracket - 1 - (openParen + 1))};
+        break;
+      }
+    }
+  }
+  cursor = openBracket + 1;
+  pid_t processIdentifier = 0;
+  while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+    processIdentifier = processIdentifier * 10 + (*cursor - '0');
+    cursor++;
+  }
+  if (end - cursor < 3 || cursor[0] != ']' || cursor[1] != ' ' || cursor[2] != '<') {
+    return NO;
+  }
+  header->processIdentifier = processIdentifier;
+  cursor += 3;
+
+  // The level, followed by the message.
+  const char *closeAngle = memchr(cursor, '>', (size_t) (end - cursor));
+  if (!closeAngle || end - closeAngle < 2 || closeAngle[1] != ':') {
+    return NO;
+  }
+  header->level = FBDeviceLogLevelFromSpan((FBDeviceLogSpan) {cursor, (size_t) (closeAngle - cursor)});
+  cursor = closeAngle + 2;
+  if (cursor < end && *cursor == ' ') {
+    cursor++;
+  }
+  header->message = (FBDeviceLogSpan) {cursor, (size_t) (end - cursor)};
+  return YES;
+}
+
+static NSString *FBDeviceLogStringFromSpan(FBDeviceLogSpan span)
+{
+  NSString *string = [[NSString alloc] initWithBytes:span.bytes length:span.length encoding:NSUTF8StringEncoding];
+  if (!string) {
+    // Latin-1 decodes any bytes, so a malformed line still produces an entry.
+    string = [[NSString alloc] initWithBytes:span.bytes length:span.length encoding:NSISOLatin1StringEncoding];
+  }
+  return string;
+}
+
+@interface FBDeviceLogEntry ()
+
+- (instancetype)initWithTimestamp:(NSString *)timestamp process:(NSString *)process processIdentifier:(pid_t)processIdentifier subsystem:(nullable NSString *)subsystem level:(FBDeviceLogLevel)level message:(NSString *)message;
+
+@end
+
+@implementation FBDeviceLogEntry
+
+#pragma mark Initializers
+
+- (instancetype)initWithTimestamp:(NSString *)timestamp process:(NSString *)process processIdentifier:(pid_t)processIdentifier subsystem:(nullable NSString *)subsystem level:(FBDeviceLogLevel)level message:(NSString *)message
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _timestamp = timestamp;
+  _process = process;
+  _processIdentifier = processIdentifier;
+  _subsystem = subsystem;
+  _level = level;
+  _message = message;
+
+  return self;
+}
+
+#pragma mark NSObject
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:
+    @"%@ %@%@[%d] <%lu>: %@",
+    self.timestamp,
+    self.process,
+    self.subsystem ? [NSString stringWithFormat:@"(%@)", self.subsystem] : @"",
+    self.processIdentifier,
+    (unsigned long) self.level,
+    self.message
+  ];
+}
+
+@end
+
+@interface FBDeviceLogPredicate ()
+
+@property (nonatomic, copy, readonly) NSArray<NSData *> *processNameData;
+@property (nonatomic, copy, nullable, readonly) NSIndexSet *processIdentifierIndexes;
+
+- (BOOL)matchesHeader:(const FBDeviceLogHeader *)header;
+- (BOOL)matchesMessage:(NSString *)message;
+
+@end
+
+@implementation FBDeviceLogPredicate
+
+#pragma mark Initializers
+
++ (FBDeviceLogPredicate *)matchAll
+{
+  return [[self alloc] initWithProcessNames:nil processIdentifiers:nil minimumLevel:FBDeviceLogLevelDebug messagePattern:nil];
+}
+
+- (instancetype)initWithProcessNames:(nullable NSSet<NSString *> *)processNames processIdentifiers:(nullable NSSet<NSNumber *> *)processIdentifiers minimumLevel:(FBDeviceLogLevel)minimumLevel messagePattern:(nullable NSRegularExpression *)messagePattern
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _processNames = [processNames copy];
+  _processIdentifiers = [processIdentifiers copy];
+  _minimumLevel = minimumLevel;
+  _messagePattern = [messagePattern copy];
+
+  // Process names are compared against the bytes of a line, and pids against an index set, neither of which allocate.
+  NSMutableArray<NSData *> *processNameData = NSMutableArray.array;
+  for (NSString *processName in processNames) {
+    [processNameData addObject:[processName dataUsingEncoding:NSUTF8StringEncoding]];
+  }
+  _processNameData = [processNameData copy];
+  if (processIdentifiers) {
+    NSMutableIndexSet *processIdentifierIndexes = NSMutableIndexSet.indexSet;
+    for (NSNumber *processIdentifier in processIdentifiers) {
+      [processIdentifierIndexes addIndex:processIdentifier.unsignedIntegerValue];
+    }
+    _processIdentifierIndexes = [processIdentifierIndexes copy];
+  }
+
+  return self;
+}
+
+#pragma mark NSCopying
+
+- (instancetype)copyWithZone:(NSZone *)zone
+{
+  // Is immutable.
+  return self;
+}
+
+#pragma mark NSObject
+
+- (BOOL)isEqual:(FBDeviceLogPredicate *)object
+{
+  if (![object isKindOfClass:self.class]) {
+    return NO;
+  }
+
+  return (self.processNames == object.processNames || [self.processNames isEqualToSet:object.processNames])
+      && (self.processIdentifiers == object.processIdentifiers || [self.processIdentifiers isEqualToSet:object.processIdentifiers])
+      && self.minimumLevel == object.minimumLevel
+      && (self.messagePattern == object.messagePattern || [self.messagePattern isEqual:object.messagePattern]);
+}
+
+- (NSUInteger)hash
+{
+  return self.processNames.hash ^ self.processIdentifiers.hash ^ (self.minimumLevel << 4) ^ self.messagePattern.hash;
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:
+    @"Processes %@ | Pids %@ | Minimum Level %lu | Pattern %@",
+    self.processNames ? [FBCollectionInformation oneLineDescriptionFromArray:self.processNames.allObjects] : @"Any",
+    self.processIdentifiers ? [FBCollectionInformation oneLineDescriptionFromArray:self.processIdentifiers.allObjects] : @"Any",
+    (unsigned long) self.minimumLevel,
+    self.messagePattern.pattern ?: @"Any"
+  ];
+}
+
+#pragma mark Private
+
+- (BOOL)matchesHeader:(const FBDeviceLogHeader *)header
+{
+  if (header->level < self.minimumLevel) {
+    return NO;
+  }
+  if (self.processIdentifierIndexes && ![self.processIdentifierIndexes containsIndex:(NSUInteger) header->processIdentifier]) {
+    return NO;
+  }
+  if (self.processNames) {
+    BOOL matchesProcess = NO;
+    for (NSData *processName in self.processNameData) {
+      if (processName.length == header->process.length && memcmp(processName.bytes, header->process.bytes, header->process.length) == 0) {
+        matchesProcess = YES;
+        break;
+      }
+    }
+    if (!matchesProcess) {
+      return NO;
+    }
+  }
+  return YES;
+}
+
+- (BOOL)matchesMessage:(NSString *)message
+{
+  if (!self.messagePattern) {
+    return YES;
+  }
+  return [self.messagePattern firstMatchInString:message options:0 range:NSMakeRange(0, message.length)] != nil;
+}
+
+@end
+
+@interface FBDeviceLogEntryParser ()
+
+@property (nonatomic, strong, readonly) FBDeviceLogPredicate *predicate;
+@property (nonatomic, strong, readonly) FBStringInterner *interner;
+@property (nonatomic, strong, nullable, readwrite) FBDeviceLogEntry *lastEntry;
+
+@end
+
+@implementation FBDeviceLogEntryParser
+
+#pragma mark Initializers
+
+- (instancetype)initWithPredicate:(FBDeviceLogPredicate *)predicate
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _predicate = predicate;
+  _interner = [[FBStringInterner alloc] initWithCapacity:FBDeviceLogEntryParserInternedStringCapacity];
+
+  return self;
+}
+
+#pragma mark Public Methods
+
+- (nullable FBDeviceLogEntry *)entryForLineBytes:(const char *)bytes length:(size_t)length
+{
+  // The relay can separate entries with NUL bytes as well as newlines.
+  while (length > 0 && bytes[0] == '\0') {
+    bytes++;
+    length--;
+  }
+  if (length == 0) {
+    return nil;
+  }
+
+  FBDeviceLogHeader header;
+  if (!FBDeviceLogParseHeader(bytes, length, &header)) {
+    // A line without a header continues the message of the last entry, so it is kept only if the last entry matched.
+    FBDeviceLogEntry *lastEntry = self.lastEntry;
+    if (!lastEntry) {
+      return nil;
+    }
+    NSString *message = FBDeviceLogStringFromSpan((FBDeviceLogSpan) {bytes, length});
+    return [[FBDeviceLogEntry alloc] initWithTimestamp:lastEntry.timestamp process:lastEntry.process processIdentifier:lastEntry.processIdentifier subsystem:lastEntry.subsystem level:lastEntry.level message:message];
+  }
+
+  self.lastEntry = nil;
+  if (![self.predicate matchesHeader:&header]) {
+    return nil;
+  }
+  NSString *message = FBDeviceLogStringFromSpan(header.message);
+  if (![self.predicate matchesMessage:message]) {
+    return nil;
+  }
+  NSString *process = [self.interner stringWithBytes:header.process.bytes length:header.process.length] ?: FBDeviceLogStringFromSpan(header.process);
+  NSString *subsystem = nil;
+  if (header.subsystem.bytes) {
+    subsystem = [self.interner stringWithBytes:header.subsystem.bytes length:header.subsystem.length] ?: FBDeviceLogStringFromSpan(header.subsystem);
+  }
+  NSString *timestamp = FBDeviceLogStringFromSpan(header.timestamp);
+  FBDeviceLogEntry *entry = [[FBDeviceLogEntry alloc] initWithTimestamp:timestamp process:process processIdentifier:header.processIdentifier subsystem:subsystem level:header.level message:message];
+  self.lastEntry = entry;
+  return entry;
+}
+
+@end
@@ -82,28 +82,37 @@
   return [[self
     findCaptureDeviceForDevice:device]
     onQueue:device.workQueue fmap:^(AVCaptureDevice *captureDevice) {
-      // Get the Input instance for this Device.
       NSError *innerError = nil;
-      AVCaptureDeviceInput *deviceInput = [AVCaptureDeviceInput deviceInputWithDevice:captureDevice error:&innerError];
-      if (!deviceInput) {
-        return [[[FBDeviceControlError
-          describeFormat:@"Failed to create Device Input for %@", captureDevice]
-          causedBy:innerError]
-          failFuture];
-      }
-      // Add the Input to a new Session.
-      AVCaptureSession *session = [[AVCaptureSession alloc] init];
-      if (![session canAddInput:deviceInput]) {
-        return [[FBDeviceControlError
-          describeFormat:@"Cannot add Device Input to session for %@", captureDevice]
-          failFuture];
+      AVCaptureSession *session = [self captureSessionForCaptureDevice:captureDevice error:&innerError];
+      if (!session) {
+        return [FBFuture futureWithError:innerError];
       }
-      [session addInput:deviceInput];
-
       return [FBFuture futureWithResult:session];
     }];
 }
 
++ (nullable AVCaptureSession *)captureSessionForCaptureDevice:(AVCaptureDevice *)captureDevice error:(NSError **)error
+{
+  // Get the Input instance for this Device.
+  NSError *innerError = nil;
+  AVCaptureDeviceInput *deviceInput = [AVCaptureDeviceInput deviceInputWithDevice:captureDevice error:&innerError];
+  if (!deviceInput) {
+    return [[[FBDeviceControlError
+      describeFormat:@"Failed to create Device Input for %@", captureDevice]
+      causedBy:innerError]
+      fail:error];
+  }
+  // Add the Input to a new Session.
+  AVCaptureSession *session = [[AVCaptureSession alloc] init];
+  if (![session canAddInput:deviceInput]) {
+    return [[FBDeviceControlError
+      describeFormat:@"Cannot add Device Input to session for %@", captureDevice]
+      fail:error];
+  }
+  [session addInput:deviceInput];
+  return session;
+}
+
 + (FBFuture<FBDeviceVideo *> *)videoForDevice:(FBDevice *)device filePath:(NSString *)filePath
 {
   // Add the Input to a new Session.
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBDeviceVideoEncoder.h"
+
+#import <VideoToolbox/VideoToolbox.h>
+
+#import "FBDeviceControlError.h"
+
+@interface FBDeviceVideoEncoder ()
+
+@property (nonatomic, strong, readonly) FBVideoStreamConfiguration *configuration;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, copy, readonly) FBDeviceVideoEncoderOutput output;
+
+@property (nonatomic, assign, readwrite) VTCompressionSessionRef session;
+@property (nonatomic, assign, readwrite) int32_t width;
+@property (nonatomic, assign, readwrite) int32_t height;
+@property (nonatomic, assign, readwrite) BOOL keyFrameRequested;
+
+@end
+
+static void EncoderOutputCallback(void *outputCallbackRefCon, void *sourceFrameRefCon, OSStatus status, VTEncodeInfoFlags infoFlags, CMSampleBufferRef sampleBuffer)
+{
+  FBDeviceVideoEncoder *encoder = (__bridge FBDeviceVideoEncoder *) outputCallbackRefCon;
+  if (status != noErr) {
+    [encoder.logger logFormat:@"Encoder failed to encode frame %d", status];
+    return;
+  }
+  if (!sampleBuffer || (infoFlags & kVTEncodeInfo_FrameDropped)) {
+    return;
+  }
+  // The callback occurs on a VideoToolbox thread, hop to the queue so that samples are consumed serially with the rest of the stream.
+  CFRetain(sampleBuffer);
+  FBDeviceVideoEncoderOutput output = encoder.output;
+  dispatch_async(encoder.queue, ^{
+    output(sampleBuffer);
+    CFRelease(sampleBuffer);
+  });
+}
+
+@implementation FBDeviceVideoEncoder
+
+#pragma mark Initializers
+
+- (instancetype)initWithCodec:(CMVideoCodecType)codec configuration:(FBVideoStreamConfiguration *)configuration queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger output:(FBDeviceVideoEncoderOutput)output
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _codec = codec;
+  _configuration = configuration;
+  _queue = queue;
+  _logger = logger;
+  _output = output;
+
+  return self;
+}
+
+- (void)dealloc
+{
+  [self invalidate];
+}
+
+#pragma mark Public Methods
+
+- (BOOL)encodePixelBuffer:(CVPixelBufferRef)pixelBuffer presentationTimeStamp:(CMTime)presentationTimeStamp duration:(CMTime)duration error:(NSError **)error
+{
+  int32_t width = (int32_t) CVPixelBufferGetWidth(pixelBuffer);
+  int32_t height = (int32_t) CVPixelBufferGetHeight(pixelBuffer);
+  if (self.session && (width != self.width || height != self.height)) {
+    [self.logger logFormat:@"Pixel buffer dimensions changed from %dx%d to %dx%d, recreating compression session", self.width, self.height, width, height];
+    [self invalidate];
+  }
+  if (!self.session && ![self createSessionWithWidth:width height:height error:error]) {
+    return NO;
+  }
+  // A new session always starts with a key frame, so a request only needs to be applied to an existing session.
+  NSDictionary<NSString *, id> *frameProperties = nil;
+  if (self.keyFrameRequested) {
+    frameProperties = @{(NSString *) kVTEncodeFrameOptionKey_ForceKeyFrame: @YES};
+    self.keyFrameRequested = NO;
+  }
+  OSStatus status = VTCompressionSessionEncodeFrame(self.session, pixelBuffer, presentationTimeStamp, duration, (__bridge CFDictionaryRef) frameProperties, NULL, NULL);
+  if (status != noErr) {
+    return [[FBDeviceControlError
+      describeFormat:@"Failed to encode frame %d", status]
+      failBool:error];
+  }
+  return YES;
+}
+
+- (void)requestKeyFrame
+{
+  self.keyFrameRequested = YES;
+}
+
+- (void)invalidate
+{
+  if (!_session) {
+    return;
+  }
+  VTCompressionSessionInvalidate(_session);
+  CFRelease(_session);
+  _session = NULL;
+}
+
+#pragma mark Private
+
+- (BOOL)createSessionWithWidth:(int32_t)width height:(int32_t)height error:(NSError **)error
+{
+  NSMutableDictionary<NSString *, id> *encoderSpecification = [NSMutableDictionary dictionaryWithDictionary:@{
+    (NSString *) kVTVideoEncoderSpecification_EnableHardwareAcceleratedVideoEncoder: @YES,
+  }];
+  if (self.configuration.lowLatencyRateControl) {
+    if (@available(macOS 11.3, *)) {
+      encoderSpecification[(NSString *) kVTVideoEncoderSpecification_EnableLowLatencyRateControl] = @YES;
+    } else {
+      [self.logger log:@"Low latency rate control is not available prior to macOS 11.3, ignoring"];
+    }
+  }
+
+  VTCompressionSessionRef session = NULL;
+  OSStatus status = VTCompressionSessionCreate(
+    kCFAllocatorDefault,
+    width,
+    height,
+    self.codec,
+    (__bridge CFDictionaryRef) encoderSpecification,
+    NULL,
+    kCFAllocatorDefault,
+    EncoderOutputCallback,
+    (__bridge void *) self,
+    &session
+  );
+  if (status != noErr) {
+    return [[FBDeviceControlError
+      describeFormat:@"Failed to create compression session %d", status]
+      failBool:error];
+  }
+
+  FBVideoStreamConfiguration *configuration = self.configuration;
+  NSMutableDictionary<NSString *, id> *properties = [NSMutableDictionary dictionaryWithDictionary:@{
+    (NSString *) kVTCompressionPropertyKey_RealTime: @(configuration.realtime),
+    (NSString *) kVTCompressionPropertyKey_AllowFrameReordering: @NO,
+    (NSString *) kVTCompressionPropertyKey_ProfileLevel: self.codec == kCMVideoCodecType_HEVC
+      ? (NSString *) kVTProfileLevel_HEVC_Main_AutoLevel
+      : (NSString *) kVTProfileLevel_H264_High_AutoLevel,
+    (NSString *) kVTCompressionPropertyKey_MaxKeyFrameIntervalDuration: configuration.keyFrameRate,
+  }];
+  if (configuration.avgBitrate) {
+    properties[(NSString *) kVTCompressionPropertyKey_AverageBitRate] = configuration.avgBitrate;
+  }
+  if (configuration.framesPerSecond) {
+    properties[(NSString *) kVTCompressionPropertyKey_ExpectedFrameRate] = configuration.framesPerSecond;
+  }
+  status = VTSessionSetProperties(session, (__bridge CFDictionaryRef) properties);
+  if (status != noErr) {
+    VTCompressionSessionInvalidate(session);
+    CFRelease(session);
+    return [[FBDeviceControlError
+      describeFormat:@"Failed to set compression session properties %@ %d", properties, status]
+      failBool:error];
+  }
+  VTCompressionSessionPrepareToEncodeFrames(session);
+
+  [self.logger logFormat:@"Created %dx%d compression session with properties %@", width, height, [FBCollectionInformation oneLineDescriptionFromDictionary:properties]];
+  self.session = session;
+  self.width = width;
+  self.height = height;
+  return YES;
+}
+
+@end
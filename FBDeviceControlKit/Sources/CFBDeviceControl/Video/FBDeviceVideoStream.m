@@ -11,8 +11,17 @@
 #import <AVFoundation/AVFoundation.h>
 #import <CoreMedia/CoreMedia.h>
 #import <CoreVideo/CoreVideo.h>
+#import <CoreGraphics/CoreGraphics.h>
+#import <mach/mach_time.h>
 
 #import "FBDeviceControlError.h"
+#import "FBDeviceVideoEncoder.h"
+
+static FBMetricsCounter *FramesCapturedCounter;
+static FBMetricsCounter *FramesSkippedCounter;
+static FBMetricsCounter *FramesProcessedCounter;
+static FBMetricsCounter *FramesDroppedCounter;
+static FBMetricsHistogram *FrameProcessingHistogram;
 
 static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixelBuffer(CVPixelBufferRef pixelBuffer);
 static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixelBuffer(CVPixelBufferRef pixelBuffer)
@@ -33,13 +42,56 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
   };
 }
 
+static OSType FBDeviceVideoStreamCVPixelFormat(FBVideoStreamPixelFormat pixelFormat)
+{
+  switch (pixelFormat) {
+    case FBVideoStreamPixelFormat420VideoRange:
+      return kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange;
+    case FBVideoStreamPixelFormat420FullRange:
+      return kCVPixelFormatType_420YpCbCr8BiPlanarFullRange;
+    case FBVideoStreamPixelFormatBGRA:
+    default:
+      return kCVPixelFormatType_32BGRA;
+  }
+}
+
+static NSNumber *FBDeviceVideoStreamTimeKey(CMTime time)
+{
+  return @(CMTimeConvertScale(time, NSEC_PER_SEC, kCMTimeRoundingMethod_Default).value);
+}
+
+static CMVideoDimensions FBDeviceVideoStreamScaledDimensions(CMVideoDimensions dimensions, FBVideoStreamConfiguration *configuration)
+{
+  double scale = 1;
+  if (configuration.scaleFactor && configuration.scaleFactor.doubleValue > 0) {
+    scale = MIN(scale, configuration.scaleFactor.doubleValue);
+  }
+  int32_t longestEdge = MAX(dimensions.width, dimensions.height);
+  if (configuration.maxDimension && longestEdge > 0) {
+    scale = MIN(scale, configuration.maxDimension.doubleValue / longestEdge);
+  }
+  // Even dimensions are required for the chroma planes of 4:2:0 formats.
+  return (CMVideoDimensions) {
+    .width = MAX(2, ((int32_t) (dimensions.width * scale)) & ~1),
+    .height = MAX(2, ((int32_t) (dimensions.height * scale)) & ~1),
+  };
+}
+
 @interface FBDeviceVideoStream_BGRA : FBDeviceVideoStream
 
 @end
 
 @interface FBDeviceVideoStream_H264 : FBDeviceVideoStream
 
-@property (nonatomic, assign, readwrite) BOOL sentH264SPSPPS;
+@property (nonatomic, strong, readonly) FBAnnexBParameterSetCache *parameterSetCache;
+@property (nonatomic, strong, readonly) FBDeviceVideoEncoder *encoder;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSNumber *, NSNumber *> *captureHostTimes;
+
++ (CMVideoCodecType)codec;
+
+@end
+
+@interface FBDeviceVideoStream_HEVC : FBDeviceVideoStream_H264
 
 @end
 
@@ -50,6 +102,9 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
 @interface FBDeviceVideoStream_Minicap : FBDeviceVideoStream_MJPEG
 
 @property (nonatomic, assign, readwrite) BOOL hasSentHeader;
+@property (nonatomic, assign, readwrite) CMVideoDimensions displayDimensions;
+@property (nonatomic, assign, readwrite) CMVideoDimensions virtualDimensions;
+@property (nonatomic, assign, readwrite) uint8_t orientation;
 
 @end
 
@@ -61,14 +116,35 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
 @property (nonatomic, strong, readonly) dispatch_queue_t writeQueue;
 @property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *startFuture;
 @property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *stopFuture;
+@property (nonatomic, strong, readonly) FBVideoStreamFanout *fanout;
+@property (nonatomic, assign, readwrite) BOOL streaming;
+@property (nonatomic, assign, readwrite) CMTime minFrameDuration;
+@property (nonatomic, assign, readwrite) CMTime limitFrameDuration;
+@property (nonatomic, assign, readwrite) CMTime nextFrameTime;
+@property (nonatomic, assign, readwrite) uint64_t captureHostTime;
 
-@property (nonatomic, strong, nullable, readwrite) id<FBDataConsumer> consumer;
 @property (nonatomic, copy, nullable, readwrite) NSDictionary<NSString *, id> *pixelBufferAttributes;
 
+- (instancetype)initWithSession:(AVCaptureSession *)session output:(AVCaptureVideoDataOutput *)output configuration:(FBVideoStreamConfiguration *)configuration writeQueue:(dispatch_queue_t)writeQueue logger:(id<FBControlCoreLogger>)logger;
++ (void)applyScalingToOutput:(AVCaptureVideoDataOutput *)output configuration:(FBVideoStreamConfiguration *)configuration logger:(id<FBControlCoreLogger>)logger;
+
 @end
 
 @implementation FBDeviceVideoStream
 
++ (void)initialize
+{
+  if (self != FBDeviceVideoStream.class) {
+    return;
+  }
+  FBMetricsRegistry *registry = FBMetricsRegistry.sharedRegistry;
+  FramesCapturedCounter = [registry counterWithName:@"video_stream.frames_captured"];
+  FramesSkippedCounter = [registry counterWithName:@"video_stream.frames_skipped"];
+  FramesProcessedCounter = [registry counterWithName:@"video_stream.frames_processed"];
+  FramesDroppedCounter = [registry counterWithName:@"video_stream.frames_dropped"];
+  FrameProcessingHistogram = [registry histogramWithName:@"video_stream.frame_processing_ns"];
+}
+
 + (instancetype)streamWithSession:(AVCaptureSession *)session configuration:(FBVideoStreamConfiguration *)configuration logger:(id<FBControlCoreLogger>)logger error:(NSError **)error
 {
   // Get the class to project into
@@ -89,28 +165,82 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
       fail:error];
   }
   [session addOutput:output];
-
-  // Set the minimum duration between frames as a frame limiter
-  if (configuration.framesPerSecond) {
-    if (@available(macOS 10.15, *)) {
-      AVCaptureConnection *connection = session.connections.firstObject;
-      if (!connection) {
-        return [[FBDeviceControlError
-          describe:@"No capture connection available!"]
-          fail:error];
-      }
-      Float64 frameTime = 1 / configuration.framesPerSecond.unsignedIntegerValue;
-      connection.videoMinFrameDuration = CMTimeMakeWithSeconds(frameTime, NSEC_PER_SEC);
-    } else {
+  [self applyScalingToOutput:output configuration:configuration logger:logger];
+
+  // Set the minimum duration between frames as a frame limiter.
+  // If the connection cannot limit the frame rate, frames are decimated in software when they are delivered.
+  CMTime minFrameDuration = kCMTimeInvalid;
+  BOOL softwareFrameLimiting = NO;
+  NSNumber *framesPerSecond = [self framesPerSecondForConfiguration:configuration];
+  if (framesPerSecond) {
+    if (framesPerSecond.doubleValue <= 0) {
       return [[FBDeviceControlError
-        describeFormat:@"Cannot set FPS on an OS prior to 10.15"]
+        describeFormat:@"%@ is not a valid frame rate", framesPerSecond]
         fail:error];
     }
+    minFrameDuration = CMTimeMakeWithSeconds(1.0 / framesPerSecond.doubleValue, NSEC_PER_SEC);
+    AVCaptureConnection *connection = [output connectionWithMediaType:AVMediaTypeVideo];
+    if (connection.isVideoMinFrameDurationSupported) {
+      connection.videoMinFrameDuration = minFrameDuration;
+      [logger logFormat:@"Limiting frame rate to %@ fps on the capture connection", framesPerSecond];
+    } else {
+      softwareFrameLimiting = YES;
+      [logger logFormat:@"Capture connection cannot limit frame rate, limiting to %@ fps in software", framesPerSecond];
+    }
   }
 
   // Create a serial queue to handle processing of frames
   dispatch_queue_t writeQueue = dispatch_queue_create("com.facebook.fbdevicecontrol.streamencoder", NULL);
-  return [[streamClass alloc] initWithSession:session output:output writeQueue:writeQueue logger:logger];
+  FBDeviceVideoStream *stream = [[streamClass alloc] initWithSession:session output:output configuration:configuration writeQueue:writeQueue logger:logger];
+  if (softwareFrameLimiting) {
+    stream.minFrameDuration = minFrameDuration;
+  }
+  return stream;
+}
+
++ (void)applyScalingToOutput:(AVCaptureVideoDataOutput *)output configuration:(FBVideoStreamConfiguration *)configuration logger:(id<FBControlCoreLogger>)logger
+{
+  if (!configuration.scaleFactor && !configuration.maxDimension) {
+    return;
+  }
+  // The native dimensions are only known once the output is connected to the input.
+  AVCaptureConnection *connection = [output connectionWithMediaType:AVMediaTypeVideo];
+  CMFormatDescriptionRef format = connection.inputPorts.firstObject.formatDescription;
+  if (!format) {
+    [logger log:@"Input format is unknown, frames will not be scaled"];
+    return;
+  }
+  CMVideoDimensions nativeDimensions = CMVideoFormatDescriptionGetDimensions(format);
+  CMVideoDimensions dimensions = FBDeviceVideoStreamScaledDimensions(nativeDimensions, configuration);
+  if (dimensions.width >= nativeDimensions.width && dimensions.height >= nativeDimensions.height) {
+    return;
+  }
+  // Scaling is performed by the capture output, before frames are delivered, so full size frames are never materialized.
+  NSMutableDictionary<NSString *, id> *videoSettings = [output.videoSettings mutableCopy] ?: [NSMutableDictionary dictionary];
+  if (videoSettings[AVVideoCodecKey]) {
+    videoSettings[AVVideoWidthKey] = @(dimensions.width);
+    videoSettings[AVVideoHeightKey] = @(dimensions.height);
+  } else {
+    videoSettings[(NSString *) kCVPixelBufferWidthKey] = @(dimensions.width);
+    videoSettings[(NSString *) kCVPixelBufferHeightKey] = @(dimensions.height);
+  }
+  output.videoSettings = videoSettings;
+  [logger logFormat:@"Scaling frames from %dx%d to %dx%d", nativeDimensions.width, nativeDimensions.height, dimensions.width, dimensions.height];
+}
+
++ (nullable NSNumber *)framesPerSecondForConfiguration:(FBVideoStreamConfiguration *)configuration
+{
+  if (!configuration.matchDisplayRefreshRate) {
+    return configuration.framesPerSecond;
+  }
+  // Some displays, such as built-in panels that use variable refresh, report a refresh rate of zero.
+  double refreshRate = 0;
+  CGDisplayModeRef mode = CGDisplayCopyDisplayMode(CGMainDisplayID());
+  if (mode) {
+    refreshRate = CGDisplayModeGetRefreshRate(mode);
+    CGDisplayModeRelease(mode);
+  }
+  return refreshRate > 0 ? @(refreshRate) : @60;
 }
 
 + (Class)classForEncoding:(FBVideoStreamEncoding)encoding
@@ -121,6 +251,9 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
   if ([encoding isEqualToString:FBVideoStreamEncodingH264]) {
     return FBDeviceVideoStream_H264.class;
   }
+  if ([encoding isEqualToString:FBVideoStreamEncodingHEVC]) {
+    return FBDeviceVideoStream_HEVC.class;
+  }
   if ([encoding isEqualToString:FBVideoStreamEncodingMJPEG]) {
     return FBDeviceVideoStream_MJPEG.class;
   }
@@ -137,7 +270,7 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
   return YES;
 }
 
-- (instancetype)initWithSession:(AVCaptureSession *)session output:(AVCaptureVideoDataOutput *)output writeQueue:(dispatch_queue_t)writeQueue logger:(id<FBControlCoreLogger>)logger
+- (instancetype)initWithSession:(AVCaptureSession *)session output:(AVCaptureVideoDataOutput *)output configuration:(FBVideoStreamConfiguration *)configuration writeQueue:(dispatch_queue_t)writeQueue logger:(id<FBControlCoreLogger>)logger
 {
   self = [super init];
   if (!self) {
@@ -146,8 +279,15 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
 
   _session = session;
   _output = output;
+  _configuration = configuration;
   _writeQueue = writeQueue;
+  // The logger is used from the capture and write queues, which shouldn't wait on writing log messages.
+  logger = [FBControlCoreLoggerFactory asyncLoggerWithLogger:logger];
   _logger = logger;
+  _minFrameDuration = kCMTimeInvalid;
+  _limitFrameDuration = kCMTimeInvalid;
+  _nextFrameTime = kCMTimeInvalid;
+  _fanout = [[FBVideoStreamFanout alloc] initWithFramedOutput:configuration.framedOutput logger:logger];
   _startFuture = FBMutableFuture.future;
   _stopFuture = FBMutableFuture.future;
 
@@ -158,51 +298,143 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
 
 - (FBFuture<NSNull *> *)startStreaming:(id<FBDataConsumer>)consumer
 {
-  if (self.consumer) {
-    return [[FBDeviceControlError
-      describe:@"Cannot start streaming, a consumer is already attached"]
-      failFuture];
-  }
-  self.consumer = consumer;
-  [self.output setSampleBufferDelegate:self queue:self.writeQueue];
-  [self.session startRunning];
-  return self.startFuture;
+  return [self attachConsumer:consumer policy:self.configuration.backpressurePolicy maxPendingFrames:self.configuration.maxPendingFrames];
 }
 
 - (FBFuture<NSNull *> *)stopStreaming
 {
-  if (!self.consumer) {
-    return [[FBDeviceControlError
-      describe:@"Cannot stop streaming, no consumer attached"]
-      failFuture];
+  @synchronized (self) {
+    if (!self.streaming) {
+      return [[FBDeviceControlError
+        describe:@"Cannot stop streaming, the stream has not started"]
+        failFuture];
+    }
   }
   [self.session stopRunning];
   [self.stopFuture resolveWithResult:NSNull.null];
   return self.stopFuture;
 }
 
+- (FBFuture<NSNull *> *)attachConsumer:(id<FBDataConsumer>)consumer policy:(FBVideoStreamBackpressurePolicy)policy maxPendingFrames:(NSUInteger)maxPendingFrames
+{
+  if (self.stopFuture.hasCompleted) {
+    return [[FBDeviceControlError
+      describe:@"Cannot attach a consumer, the stream has stopped"]
+      failFuture];
+  }
+  NSError *error = nil;
+  if (![self.fanout addConsumer:consumer policy:policy maxPendingFrames:maxPendingFrames error:&error]) {
+    return [FBFuture futureWithError:error];
+  }
+  // The capture session is shared by all consumers, so it is only started for the first.
+  @synchronized (self) {
+    if (!self.streaming) {
+      self.streaming = YES;
+      [self.output setSampleBufferDelegate:self queue:self.writeQueue];
+      [self.session startRunning];
+    }
+  }
+  return self.startFuture;
+}
+
+- (FBFuture<NSNull *> *)detachConsumer:(id<FBDataConsumer>)consumer
+{
+  NSError *error = nil;
+  if (![self.fanout removeConsumer:consumer error:&error]) {
+    return [FBFuture futureWithError:error];
+  }
+  return FBFuture.empty;
+}
+
+- (nullable FBVideoStreamStatistics *)statisticsForConsumer:(id<FBDataConsumer>)consumer
+{
+  return [self.fanout statisticsForConsumer:consumer];
+}
+
+- (FBFuture<NSNull *> *)requestKeyFrame
+{
+  // Every frame is a key frame, unless the stream is encoded.
+  return FBFuture.empty;
+}
+
+- (FBVideoStreamStatistics *)statistics
+{
+  return self.fanout.statistics;
+}
+
+- (void)limitFramesPerSecond:(nullable NSNumber *)framesPerSecond
+{
+  CMTime limitFrameDuration = framesPerSecond.doubleValue > 0
+    ? CMTimeMakeWithSeconds(1.0 / framesPerSecond.doubleValue, NSEC_PER_SEC)
+    : kCMTimeInvalid;
+  // The cadence is only read and written on the write queue, so the limit is applied there and the cadence restarts from the next frame.
+  dispatch_async(self.writeQueue, ^{
+    self.limitFrameDuration = limitFrameDuration;
+    self.nextFrameTime = kCMTimeInvalid;
+  });
+  [self.logger logFormat:@"Limiting frame rate to %@ fps in software", framesPerSecond ?: @"unlimited"];
+}
+
 #pragma mark AVCaptureAudioDataOutputSampleBufferDelegate
 
 - (void)captureOutput:(AVCaptureOutput *)captureOutput didOutputSampleBuffer:(CMSampleBufferRef)sampleBuffer fromConnection:(AVCaptureConnection *)connection
 {
-  if (!self.consumer) {
+  uint64_t captureHostTime = mach_absolute_time();
+  [FramesCapturedCounter increment];
+  // Frames are still delivered whilst there are no consumers, so that consumers can be attached without restarting the session.
+  if (self.fanout.consumerCount == 0) {
     return;
   }
-  if (!checkConsumerBufferLimit(self.consumer, self.logger)) {
+  if (![self shouldProcessSampleAtTime:CMSampleBufferGetPresentationTimeStamp(sampleBuffer)]) {
+    [FramesSkippedCounter increment];
     return;
   }
-  
+
   [self.startFuture resolveWithResult:NSNull.null];
+  self.captureHostTime = captureHostTime;
+  uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
   [self consumeSampleBuffer:sampleBuffer];
+  [FrameProcessingHistogram recordNanosecondsSince:startTime];
+  [FramesProcessedCounter increment];
 }
 
 - (void)captureOutput:(AVCaptureOutput *)captureOutput didDropSampleBuffer:(CMSampleBufferRef)sampleBuffer fromConnection:(AVCaptureConnection *)connection
 {
-  [self.logger logFormat:@"Dropped a sample!"];
+  [FramesDroppedCounter increment];
+  [self.fanout recordDroppedFrame];
 }
 
 #pragma mark Data consumption
 
+- (BOOL)shouldProcessSampleAtTime:(CMTime)time
+{
+  // The runtime limit only ever lowers the frame rate of the configuration.
+  CMTime interval = self.minFrameDuration;
+  CMTime limitFrameDuration = self.limitFrameDuration;
+  if (CMTIME_IS_VALID(limitFrameDuration) && (!CMTIME_IS_VALID(interval) || CMTimeCompare(limitFrameDuration, interval) > 0)) {
+    interval = limitFrameDuration;
+  }
+  if (!CMTIME_IS_VALID(interval) || !CMTIME_IS_VALID(time)) {
+    return YES;
+  }
+  // Frames are scheduled against an ideal cadence, rather than against the last frame, so that jitter in delivery doesn't lower the rate.
+  // An eighth of the interval of tolerance absorbs jitter in the timestamps of the source.
+  CMTime nextFrameTime = self.nextFrameTime;
+  if (CMTIME_IS_VALID(nextFrameTime)) {
+    CMTime tolerance = CMTimeMultiplyByRatio(interval, 1, 8);
+    if (CMTimeCompare(time, CMTimeSubtract(nextFrameTime, tolerance)) < 0) {
+      return NO;
+    }
+  }
+  // If the source has stalled for longer than an interval, the cadence restarts from this frame.
+  if (!CMTIME_IS_VALID(nextFrameTime) || CMTimeCompare(CMTimeSubtract(time, nextFrameTime), interval) > 0) {
+    self.nextFrameTime = CMTimeAdd(time, interval);
+  } else {
+    self.nextFrameTime = CMTimeAdd(nextFrameTime, interval);
+  }
+  return YES;
+}
+
 - (void)consumeSampleBuffer:(CMSampleBufferRef)sampleBuffer
 {
   NSAssert(NO, @"-[%@ %@] is abstract and should be overridden", NSStringFromClass(self.class), NSStringFromSelector(_cmd));
@@ -224,26 +456,41 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
 - (void)consumeSampleBuffer:(CMSampleBufferRef)sampleBuffer
 {
   CVImageBufferRef pixelBuffer = CMSampleBufferGetImageBuffer(sampleBuffer);
-  CVPixelBufferLockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
-
-  void *baseAddress = CVPixelBufferGetBaseAddress(pixelBuffer);
-  size_t size = CVPixelBufferGetDataSize(pixelBuffer);
-  if ([self.consumer conformsToProtocol:@protocol(FBDataConsumerSync)]) {
-    NSData *data = [NSData dataWithBytesNoCopy:baseAddress length:size freeWhenDone:NO];
-    [self.consumer consumeData:data];
-  } else {
-    NSData *data = [NSData dataWithBytes:baseAddress length:size];
-    [self.consumer consumeData:data];
-  }
-
-
-  CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
-
   if (!self.pixelBufferAttributes) {
     NSDictionary<NSString *, id> *attributes = FBBitmapStreamPixelBufferAttributesFromPixelBuffer(pixelBuffer);
     self.pixelBufferAttributes = attributes;
     [self.logger logFormat:@"Mounting Surface with Attributes: %@", attributes];
   }
+
+  // Surface consumers share the IOSurface of the frame, so there's no need to touch the pixels on the CPU.
+  // The pixels are only copied once, and only if there is a consumer of bytes.
+  [self.fanout writePixelBuffer:pixelBuffer presentationTimeStamp:CMSampleBufferGetPresentationTimeStamp(sampleBuffer) captureHostTime:self.captureHostTime writer:^ BOOL (id<FBDataConsumer> consumer) {
+    CVPixelBufferLockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+
+    // Planar buffers have their planes written one after the other, the base address of a planar buffer is not the pixel data.
+    if (CVPixelBufferIsPlanar(pixelBuffer)) {
+      NSMutableData *data = [NSMutableData data];
+      for (size_t plane = 0; plane < CVPixelBufferGetPlaneCount(pixelBuffer); plane++) {
+        [data appendBytes:CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, plane) length:CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, plane) * CVPixelBufferGetHeightOfPlane(pixelBuffer, plane)];
+      }
+      CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+      [consumer consumeData:data];
+      return YES;
+    }
+
+    void *baseAddress = CVPixelBufferGetBaseAddress(pixelBuffer);
+    size_t size = CVPixelBufferGetDataSize(pixelBuffer);
+    if ([consumer conformsToProtocol:@protocol(FBDataConsumerSync)]) {
+      NSData *data = [NSData dataWithBytesNoCopy:baseAddress length:size freeWhenDone:NO];
+      [consumer consumeData:data];
+    } else {
+      NSData *data = [NSData dataWithBytes:baseAddress length:size];
+      [consumer consumeData:data];
+    }
+
+    CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+    return YES;
+  }];
 }
 
 + (BOOL)configureVideoOutput:(AVCaptureVideoDataOutput *)output configuration:(FBVideoStreamConfiguration *)configuration error:(NSError **)error;
@@ -251,13 +498,16 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
   if (![super configureVideoOutput:output configuration:configuration error:error]) {
     return NO;
   }
-  if (![output.availableVideoCVPixelFormatTypes containsObject:@(kCVPixelFormatType_32BGRA)]) {
+  OSType pixelFormat = FBDeviceVideoStreamCVPixelFormat(configuration.pixelFormat);
+  if (![output.availableVideoCVPixelFormatTypes containsObject:@(pixelFormat)]) {
     return [[FBDeviceControlError
-      describe:@"kCVPixelFormatType_32BGRA is not a supported output type"]
+      describeFormat:@"%@ is not a supported output type", (__bridge_transfer NSString *) UTCreateStringForOSType(pixelFormat)]
       failBool:error];
   }
   output.videoSettings = @{
-    (id)kCVPixelBufferPixelFormatTypeKey: @(kCVPixelFormatType_32BGRA),
+    (id)kCVPixelBufferPixelFormatTypeKey: @(pixelFormat),
+    (id)kCVPixelBufferIOSurfacePropertiesKey: @{},
+    (id)kCVPixelBufferMetalCompatibilityKey: @YES,
   };
   return YES;
 }
@@ -266,9 +516,137 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
 
 @implementation FBDeviceVideoStream_H264
 
++ (CMVideoCodecType)codec
+{
+  return kCMVideoCodecType_H264;
+}
+
++ (BOOL)configureVideoOutput:(AVCaptureVideoDataOutput *)output configuration:(FBVideoStreamConfiguration *)configuration error:(NSError **)error;
+{
+  if (![super configureVideoOutput:output configuration:configuration error:error]) {
+    return NO;
+  }
+  // Uncompressed frames are requested from the output and are then encoded with VideoToolbox.
+  // Bi-planar 420v is preferable as it is the native input of the hardware encoder, otherwise BGRA is converted by the encoder.
+  NSArray<NSNumber *> *availableFormats = output.availableVideoCVPixelFormatTypes;
+  // A pixel format other than the default is an explicit request, so it is preferred.
+  NSMutableArray<NSNumber *> *candidates = [NSMutableArray arrayWithArray:@[@(kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange), @(kCVPixelFormatType_32BGRA)]];
+  if (configuration.pixelFormat != FBVideoStreamPixelFormatBGRA) {
+    [candidates insertObject:@(FBDeviceVideoStreamCVPixelFormat(configuration.pixelFormat)) atIndex:0];
+  }
+  NSNumber *pixelFormat = nil;
+  for (NSNumber *candidate in candidates) {
+    if ([availableFormats containsObject:candidate]) {
+      pixelFormat = candidate;
+      break;
+    }
+  }
+  if (!pixelFormat) {
+    return [[FBDeviceControlError
+      describeFormat:@"Neither 420v nor BGRA are supported output types %@", [FBCollectionInformation oneLineDescriptionFromArray:availableFormats]]
+      failBool:error];
+  }
+  // IOSurface-backed, Metal compatible frames can also be shared with surface consumers without a copy.
+  output.videoSettings = @{
+    (id)kCVPixelBufferPixelFormatTypeKey: pixelFormat,
+    (id)kCVPixelBufferIOSurfacePropertiesKey: @{},
+    (id)kCVPixelBufferMetalCompatibilityKey: @YES,
+  };
+  return YES;
+}
+
+- (instancetype)initWithSession:(AVCaptureSession *)session output:(AVCaptureVideoDataOutput *)output configuration:(FBVideoStreamConfiguration *)configuration writeQueue:(dispatch_queue_t)writeQueue logger:(id<FBControlCoreLogger>)logger
+{
+  self = [super initWithSession:session output:output configuration:configuration writeQueue:writeQueue logger:logger];
+  if (!self) {
+    return nil;
+  }
+
+  _parameterSetCache = [[FBAnnexBParameterSetCache alloc] init];
+  _captureHostTimes = [NSMutableDictionary dictionary];
+  __weak typeof(self) weakSelf = self;
+  _encoder = [[FBDeviceVideoEncoder alloc] initWithCodec:self.class.codec configuration:configuration queue:writeQueue logger:self.logger output:^(CMSampleBufferRef encodedSampleBuffer) {
+    [weakSelf writeEncodedSampleBuffer:encodedSampleBuffer];
+  }];
+  // Consumers that attach mid-stream, or that drop a dependent frame, get a key frame now rather than at the end of the interval.
+  self.fanout.keyFrameRequestHandler = ^{
+    [weakSelf.encoder requestKeyFrame];
+  };
+
+  return self;
+}
+
+- (FBFuture<NSNull *> *)stopStreaming
+{
+  FBFuture<NSNull *> *future = [super stopStreaming];
+  dispatch_async(self.writeQueue, ^{
+    [self.encoder invalidate];
+  });
+  return future;
+}
+
+- (FBFuture<NSNull *> *)requestKeyFrame
+{
+  FBMutableFuture<NSNull *> *future = FBMutableFuture.future;
+  dispatch_async(self.writeQueue, ^{
+    [self.encoder requestKeyFrame];
+    [future resolveWithResult:NSNull.null];
+  });
+  return future;
+}
+
 - (void)consumeSampleBuffer:(CMSampleBufferRef)sampleBuffer
 {
-  WriteFrameToAnnexBStream(sampleBuffer, self.consumer, self.logger, nil);
+  // Samples that are already compressed are passed straight through.
+  CVImageBufferRef pixelBuffer = CMSampleBufferGetImageBuffer(sampleBuffer);
+  if (!pixelBuffer) {
+    [self writeEncodedSampleBuffer:sampleBuffer];
+    return;
+  }
+  // Surface consumers share the uncompressed frame, before it is encoded.
+  CMTime presentationTimeStamp = CMSampleBufferGetPresentationTimeStamp(sampleBuffer);
+  [self.fanout writeSurfacePixelBuffer:pixelBuffer presentationTimeStamp:presentationTimeStamp];
+  // Encoding is asynchronous, so the capture time of the frame is looked up by timestamp when it is written.
+  if (self.configuration.framedOutput) {
+    // Frames dropped by the encoder never return, so abandoned entries are bounded.
+    if (self.captureHostTimes.count > 64) {
+      [self.captureHostTimes removeAllObjects];
+    }
+    self.captureHostTimes[FBDeviceVideoStreamTimeKey(presentationTimeStamp)] = @(self.captureHostTime);
+  }
+  NSError *error = nil;
+  if (![self.encoder encodePixelBuffer:pixelBuffer presentationTimeStamp:presentationTimeStamp duration:CMSampleBufferGetDuration(sampleBuffer) error:&error]) {
+    [self.logger logFormat:@"Failed to encode sample %@", error];
+  }
+}
+
+- (void)writeEncodedSampleBuffer:(CMSampleBufferRef)sampleBuffer
+{
+  // Consumers are gated on the encoded output, where key frames are known.
+  FBAnnexBParameterSetCache *parameterSetCache = self.parameterSetCache;
+  id<FBControlCoreLogger> logger = self.logger;
+  CMTime presentationTimeStamp = CMSampleBufferGetPresentationTimeStamp(sampleBuffer);
+  uint64_t captureHostTime = self.captureHostTime;
+  NSNumber *timeKey = FBDeviceVideoStreamTimeKey(presentationTimeStamp);
+  NSNumber *encodedCaptureHostTime = self.captureHostTimes[timeKey];
+  if (encodedCaptureHostTime) {
+    captureHostTime = encodedCaptureHostTime.unsignedLongLongValue;
+    [self.captureHostTimes removeObjectForKey:timeKey];
+  }
+  [self.fanout writeFrameIsKeyFrame:FBVideoStreamSampleBufferIsKeyFrame(sampleBuffer) presentationTimeStamp:presentationTimeStamp captureHostTime:captureHostTime writer:^ BOOL (id<FBDataConsumer> consumer) {
+    return WriteFrameToAnnexBStreamWithParameterSetCache(sampleBuffer, parameterSetCache, consumer, logger, nil);
+  }];
+  // Recorders mux the encoded samples as they are.
+  [self.fanout writeSampleBuffer:sampleBuffer];
+}
+
+@end
+
+@implementation FBDeviceVideoStream_HEVC
+
++ (CMVideoCodecType)codec
+{
+  return kCMVideoCodecType_HEVC;
 }
 
 @end
@@ -278,7 +656,10 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
 - (void)consumeSampleBuffer:(CMSampleBufferRef)sampleBuffer
 {
   CMBlockBufferRef jpegDataBuffer = CMSampleBufferGetDataBuffer(sampleBuffer);
-  WriteJPEGDataToMJPEGStream(jpegDataBuffer, self.consumer, self.logger, nil);
+  id<FBControlCoreLogger> logger = self.logger;
+  [self.fanout writeFrameIsKeyFrame:YES presentationTimeStamp:CMSampleBufferGetPresentationTimeStamp(sampleBuffer) captureHostTime:self.captureHostTime writer:^ BOOL (id<FBDataConsumer> consumer) {
+    return WriteJPEGDataToMJPEGStream(jpegDataBuffer, consumer, logger, nil);
+  }];
 }
 
 + (BOOL)configureVideoOutput:(AVCaptureVideoDataOutput *)output configuration:(FBVideoStreamConfiguration *)configuration error:(NSError **)error;
@@ -307,14 +688,56 @@ static NSDictionary<NSString *, id> *FBBitmapStreamPixelBufferAttributesFromPixe
 
 - (void)consumeSampleBuffer:(CMSampleBufferRef)sampleBuffer
 {
-  if (!self.hasSentHeader) {
-    CMFormatDescriptionRef format = CMSampleBufferGetFormatDescription(sampleBuffer);
-    CMVideoDimensions dimensions = CMVideoFormatDescriptionGetDimensions(format);
-    WriteMinicapHeaderToStream((uint32) dimensions.width, (uint32) dimensions.height, self.consumer, self.logger, nil);
+  id<FBControlCoreLogger> logger = self.logger;
+  // The display size is that of the input, the virtual size is that of the frames after scaling by the capture output.
+  CMVideoDimensions virtualDimensions = CMVideoFormatDescriptionGetDimensions(CMSampleBufferGetFormatDescription(sampleBuffer));
+  AVCaptureConnection *connection = [self.output connectionWithMediaType:AVMediaTypeVideo];
+  CMFormatDescriptionRef inputFormat = connection.inputPorts.firstObject.formatDescription;
+  CMVideoDimensions displayDimensions = inputFormat ? CMVideoFormatDescriptionGetDimensions(inputFormat) : virtualDimensions;
+  uint8_t orientation = [self.class minicapOrientationForConnection:connection displayDimensions:displayDimensions];
+
+  // A rotation changes the input dimensions, so the scaled size is recomputed to preserve the aspect ratio.
+  BOOL displayChanged = displayDimensions.width != self.displayDimensions.width || displayDimensions.height != self.displayDimensions.height;
+  if (self.hasSentHeader && displayChanged) {
+    [self.logger logFormat:@"Display changed from %dx%d to %dx%d", self.displayDimensions.width, self.displayDimensions.height, displayDimensions.width, displayDimensions.height];
+    [FBDeviceVideoStream applyScalingToOutput:self.output configuration:self.configuration logger:self.logger];
+  }
+
+  // The header is retained by the fanout, so consumers that attach later receive it before their first frame.
+  // It is re-emitted whenever the geometry changes, so that clients don't have to reconnect on rotation.
+  BOOL virtualChanged = virtualDimensions.width != self.virtualDimensions.width || virtualDimensions.height != self.virtualDimensions.height;
+  if (!self.hasSentHeader || displayChanged || virtualChanged || orientation != self.orientation) {
+    [self.fanout writeStreamHeader:^ BOOL (id<FBDataConsumer> consumer) {
+      return WriteMinicapHeaderWithVirtualDisplayToStream((uint32) displayDimensions.width, (uint32) displayDimensions.height, (uint32) virtualDimensions.width, (uint32) virtualDimensions.height, orientation, consumer, logger, nil);
+    }];
     self.hasSentHeader = YES;
+    self.displayDimensions = displayDimensions;
+    self.virtualDimensions = virtualDimensions;
+    self.orientation = orientation;
   }
   CMBlockBufferRef jpegDataBuffer = CMSampleBufferGetDataBuffer(sampleBuffer);
-  WriteJPEGDataToMinicapStream(jpegDataBuffer, self.consumer, self.logger, nil);
+  [self.fanout writeFrameIsKeyFrame:YES presentationTimeStamp:CMSampleBufferGetPresentationTimeStamp(sampleBuffer) captureHostTime:self.captureHostTime writer:^ BOOL (id<FBDataConsumer> consumer) {
+    return WriteJPEGDataToMinicapStream(jpegDataBuffer, consumer, logger, nil);
+  }];
+}
+
++ (uint8_t)minicapOrientationForConnection:(AVCaptureConnection *)connection displayDimensions:(CMVideoDimensions)displayDimensions
+{
+  // Minicap orientations are in quarter turns.
+  if (connection.isVideoOrientationSupported) {
+    switch (connection.videoOrientation) {
+      case AVCaptureVideoOrientationPortrait:
+        return 0;
+      case AVCaptureVideoOrientationLandscapeRight:
+        return 1;
+      case AVCaptureVideoOrientationPortraitUpsideDown:
+        return 2;
+      case AVCaptureVideoOrientationLandscapeLeft:
+        return 3;
+    }
+  }
+  // Otherwise the device is rotated when the screen is wider than it is high, as device screens are natively portrait.
+  return displayDimensions.width > displayDimensions.height ? 1 : 0;
 }
 
 @end
@@ -0,0 +1,576 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBDeviceVideoStreamServer.h"
+
+#import <CommonCrypto/CommonDigest.h>
+#import <libkern/OSByteOrder.h>
+
+#import "FBDeviceVideoStream.h"
+
+// Large enough for the request of any browser, whilst bounding what a client can make the server buffer.
+static NSUInteger const MaxRequestHeaderLength = 1024 * 8;
+// A client that connects and doesn't send a request shouldn't hold on to its queue.
+static time_t const RequestTimeoutSeconds = 5;
+// Appended to the key of a WebSocket handshake, as defined by RFC 6455.
+static NSString *const WebSocketGUID = @"258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+static NSString *const MultipartBoundary = @"fbvideoframe";
+
+/**
+ How the bytes of each frame are delimited for a client.
+ */
+typedef NS_ENUM(NSUInteger, FBDeviceVideoStreamServerFraming) {
+  FBDeviceVideoStreamServerFramingNone = 0, // The bytes of the stream as-is.
+  FBDeviceVideoStreamServerFramingWebSocket = 1, // A binary WebSocket message per frame.
+  FBDeviceVideoStreamServerFramingMultipart = 2, // A part of a multipart/x-mixed-replace response per frame.
+};
+
+static BOOL WriteAll(int fileDescriptor, const void *bytes, size_t length)
+{
+  const uint8_t *remaining = bytes;
+  while (length > 0) {
+    ssize_t written = write(fileDescriptor, remaining, length);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      return NO;
+    }
+    remaining += written;
+    length -= (size_t) written;
+  }
+  return YES;
+}
+
+static BOOL WriteString(int fileDescriptor, NSString *string)
+{
+  NSData *data = [string dataUsingEncoding:NSUTF8StringEncoding];
+  return WriteAll(fileDescriptor, data.bytes, data.length);
+}
+
+static BOOL WriteErrorResponse(int fileDescriptor, NSString *status)
+{
+  return WriteString(fileDescriptor, [NSString stringWithFormat:@"HTTP/1.1 %@\r\nContent-Length: 0\r\nConnection: close\r\n\r\n", status]);
+}
+
+static NSString *WebSocketAcceptForKey(NSString *key)
+{
+  NSData *challenge = [[key stringByAppendingString:WebSocketGUID] dataUsingEncoding:NSUTF8StringEncoding];
+  unsigned char digest[CC_SHA1_DIGEST_LENGTH];
+  CC_SHA1(challenge.bytes, (CC_LONG) challenge.length, digest);
+  return [[NSData dataWithBytes:digest length:sizeof(digest)] base64EncodedStringWithOptions:0];
+}
+
+static NSString *ContentTypeForEncoding(FBVideoStreamEncoding encoding)
+{
+  if ([encoding isEqualToString:FBVideoStreamEncodingH264]) {
+    return @"video/h264";
+  }
+  if ([encoding isEqualToString:FBVideoStreamEncodingHEVC]) {
+    return @"video/h265";
+  }
+  return @"application/octet-stream";
+}
+
+static NSString *NormalizedPath(NSString *path)
+{
+  NSString *normalized = [path componentsSeparatedByString:@"?"].firstObject;
+  return [normalized hasPrefix:@"/"] ? normalized : [@"/" stringByAppendingString:normalized];
+}
+
+/**
+ Reads the head of an HTTP request, returning the headers with lowercased names, or nil if the request is malformed or too long.
+ The path of the request is the value of the ":path" key and the method is the value of the ":method" key.
+ */
+static NSDictionary<NSString *, NSString *> *_Nullable ReadRequestHead(int fileDescriptor)
+{
+  struct timeval timeout = {.tv_sec = RequestTimeoutSeconds, .tv_usec = 0};
+  setsockopt(fileDescriptor, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  NSData *terminator = [@"\r\n\r\n" dataUsingEncoding:NSUTF8StringEncoding];
+  NSMutableData *head = NSMutableData.data;
+  while ([head rangeOfData:terminator options:0 range:NSMakeRange(0, head.length)].location == NSNotFound) {
+    if (head.length > MaxRequestHeaderLength) {
+      return nil;
+    }
+    uint8_t buffer[1024];
+    ssize_t result = read(fileDescriptor, buffer, sizeof(buffer));
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      return nil;
+    }
+    [head appendBytes:buffer length:(NSUInteger) result];
+  }
+
+  NSString *string = [[NSString alloc] initWithData:head encoding:NSUTF8StringEncoding];
+  NSArray<NSString *> *lines = [string componentsSeparatedByString:@"\r\n"];
+  NSArray<NSString *> *requestLine = [lines.firstObject componentsSeparatedByString:@" "];
+  if (requestLine.count != 3) {
+    return nil;
+  }
+  NSMutableDictionary<NSString *, NSString *> *headers = NSMutableDictionary.dictionary;
+  headers[@":method"] = requestLine[0];
+  headers[@":path"] = requestLine[1];
+  for (NSString *line in [lines subarrayWithRange:NSMakeRange(1, lines.count - 1)]) {
+    NSRange separator = [line rangeOfString:@":"];
+    if (separator.location == NSNotFound) {
+      continue;
+    }
+    NSString *name = [line substringToIndex:separator.location].lowercaseString;
+    NSString *value = [[line substringFromIndex:separator.location + 1] stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceCharacterSet];
+    headers[name] = value;
+  }
+  return headers;
+}
+
+/**
+ A client of a stream, which is attached to the stream as a consumer.
+ */
+@interface FBDeviceVideoStreamServer_Client : NSObject <FBDataConsumer>
+
+@property (nonatomic, assign, readonly) int fileDescriptor;
+@property (nonatomic, assign, readonly) FBDeviceVideoStreamServerFraming framing;
+@property (nonatomic, strong, readonly) FBDeviceVideoStream *stream;
+@property (nonatomic, copy, readonly) NSString *path;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) dispatch_source_t readSource;
+@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) FBMutableFuture<NSNull *> *disconnected;
+// Held whilst writing, so that the descriptor is not closed, and possibly re-used, beneath a write.
+@property (nonatomic, strong, readonly) NSObject *writeLock;
+@property (nonatomic, assign, readwrite) BOOL closed;
+@property (nonatomic, assign, readwrite) BOOL disconnecting;
+
+@end
+
+@implementation FBDeviceVideoStreamServer_Client
+
+- (instancetype)initWithFileDescriptor:(int)fileDescriptor framing:(FBDeviceVideoStreamServerFraming)framing stream:(FBDeviceVideoStream *)stream path:(NSString *)path queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _fileDescriptor = fileDescriptor;
+  _framing = framing;
+  _stream = stream;
+  _path = path;
+  _queue = queue;
+  _logger = logger;
+  _disconnected = [FBMutableFuture futureWithNameFormat:@"Disconnection of client %d", fileDescriptor];
+  _writeLock = [[NSObject alloc] init];
+  _readSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, (uintptr_t) fileDescriptor, 0, queue);
+
+  return self;
+}
+
+#pragma mark Public
+
+- (void)attach
+{
+  // Clients only receive, so reads are only to notice the client disconnecting.
+  __weak typeof(self) weakSelf = self;
+  int fileDescriptor = self.fileDescriptor;
+  BOOL isWebSocket = self.framing == FBDeviceVideoStreamServerFramingWebSocket;
+  dispatch_source_set_event_handler(self.readSource, ^{
+    uint8_t buffer[512];
+    ssize_t result = read(fileDescriptor, buffer, sizeof(buffer));
+    if (result < 0 && (errno == EINTR || errno == EAGAIN)) {
+      return;
+    }
+    // Only a WebSocket close is acted upon, other messages from a WebSocket client are ignored.
+    BOOL isClose = result > 0 && isWebSocket && (buffer[0] & 0x0f) == 0x08;
+    if (result > 0 && !isClose) {
+      return;
+    }
+    [weakSelf disconnect];
+  });
+  dispatch_source_set_cancel_handler(self.readSource, ^{
+    @synchronized (self.writeLock) {
+      self.closed = YES;
+      close(fileDescriptor);
+    }
+    [self.disconnected resolveWithResult:NSNull.null];
+  });
+  dispatch_resume(self.readSource);
+
+  // Key frames are never dropped, so that a congested client resumes from the next key frame rather than decoding corrupt frames.
+  [[self.stream
+    attachConsumer:self policy:FBVideoStreamBackpressurePolicyPreserveKeyFrames maxPendingFrames:self.stream.configuration.maxPendingFrames]
+    onQueue:self.queue handleError:^(NSError *error) {
+      [self.logger logFormat:@"Failed to attach client %d to stream %@: %@", fileDescriptor, self.path, error];
+      [self disconnect];
+      return [FBFuture futureWithError:error];
+    }];
+}
+
+- (void)disconnect
+{
+  @synchronized (self) {
+    if (self.disconnecting) {
+      return;
+    }
+    self.disconnecting = YES;
+  }
+  // A shutdown fails any write that is blocked on the client, so that the write lock is released for the descriptor to be closed.
+  shutdown(self.fileDescriptor, SHUT_RDWR);
+  [self.stream detachConsumer:self];
+  dispatch_source_cancel(self.readSource);
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  BOOL written = NO;
+  @synchronized (self.writeLock) {
+    if (self.closed) {
+      return;
+    }
+    written = [self writeFrame:data];
+  }
+  if (!written) {
+    [self disconnect];
+  }
+}
+
+- (void)consumeEndOfFile
+{
+  [self disconnect];
+}
+
+#pragma mark Private
+
+- (BOOL)writeFrame:(NSData *)data
+{
+  int fileDescriptor = self.fileDescriptor;
+  switch (self.framing) {
+    case FBDeviceVideoStreamServerFramingWebSocket: {
+      // A final, unmasked, binary frame. Server frames are never masked.
+      uint8_t header[10] = {0x82};
+      size_t headerLength = 2;
+      uint64_t length = data.length;
+      if (length < 126) {
+        header[1] = (uint8_t) length;
+      } else if (length <= UINT16_MAX) {
+        header[1] = 126;
+        OSWriteBigInt16(header, 2, (uint16_t) length);
+        headerLength = 4;
+      } else {
+        header[1] = 127;
+        OSWriteBigInt64(header, 2, length);
+        headerLength = 10;
+      }
+      if (!WriteAll(fileDescriptor, header, headerLength)) {
+        return NO;
+      }
+      return [self writeData:data];
+    }
+    case FBDeviceVideoStreamServerFramingMultipart: {
+      NSString *partHeader = [NSString stringWithFormat:@"--%@\r\nContent-Type: image/jpeg\r\nContent-Length: %lu\r\n\r\n", MultipartBoundary, (unsigned long) data.length];
+      return WriteString(fileDescriptor, partHeader) && [self writeData:data] && WriteString(fileDescriptor, @"\r\n");
+    }
+    case FBDeviceVideoStreamServerFramingNone:
+    default:
+      return [self writeData:data];
+  }
+}
+
+- (BOOL)writeData:(NSData *)data
+{
+  // Frames are dispatch data that reference the encoder output, so each region is written without flattening the frame.
+  __block BOOL written = YES;
+  int fileDescriptor = self.fileDescriptor;
+  [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+    written = WriteAll(fileDescriptor, bytes, byteRange.length);
+    *stop = !written;
+  }];
+  return written;
+}
+
+@end
+
+/**
+ The delegate of the socket server, which doesn't retain the streaming server so that the socket server can be owned by it.
+ */
+@interface FBDeviceVideoStreamServer_Delegate : NSObject <FBSocketServerDelegate>
+
+@property (nonatomic, weak, readwrite) FBDeviceVideoStreamServer *server;
+
+@end
+
+@interface FBDeviceVideoStreamServer ()
+
+@property (nonatomic, assign, readonly) BOOL readsRequests;
+@property (nonatomic, strong, readonly) FBSocketServer *socketServer;
+@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong, readonly) NSMutableDictionary<NSString *, FBDeviceVideoStream *> *streams;
+@property (nonatomic, strong, readonly) NSMutableSet<FBDeviceVideoStreamServer_Client *> *clients;
+
+- (void)clientConnected:(int)fileDescriptor queue:(dispatch_queue_t)queue;
+
+@end
+
+@implementation FBDeviceVideoStreamServer_Delegate
+
+@synthesize queue = _queue;
+
+- (instancetype)init
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _queue = dispatch_queue_create("com.facebook.fbdevicecontrol.video_stream_server", DISPATCH_QUEUE_CONCURRENT);
+
+  return self;
+}
+
+- (void)socketServer:(FBSocketServer *)server clientConnected:(struct in6_addr)address fileDescriptor:(int)fileDescriptor
+{
+  dispatch_queue_t queue = dispatch_queue_create("com.facebook.fbdevicecontrol.video_stream_server.client", DISPATCH_QUEUE_SERIAL);
+  [self socketServer:server clientConnected:address fileDescriptor:fileDescriptor queue:queue];
+}
+
+- (void)socketServer:(FBSocketServer *)server clientConnected:(struct in6_addr)address fileDescriptor:(int)fileDescriptor queue:(dispatch_queue_t)queue
+{
+  FBDeviceVideoStreamServer *streamServer = self.server;
+  if (!streamServer) {
+    close(fileDescriptor);
+    return;
+  }
+  [streamServer clientConnected:fileDescriptor queue:queue];
+}
+
+@end
+
+@implementation FBDeviceVideoStreamServer
+
+#pragma mark Initializers
+
++ (instancetype)tcpServerOnPort:(in_port_t)port stream:(FBDeviceVideoStream *)stream logger:(id<FBControlCoreLogger>)logger
+{
+  FBDeviceVideoStreamServer *server = [[self alloc] initWithPort:port readsRequests:NO logger:logger];
+  [server serveStream:stream atPath:@"/"];
+  return server;
+}
+
++ (instancetype)httpServerOnPort:(in_port_t)port logger:(id<FBControlCoreLogger>)logger
+{
+  return [[self alloc] initWithPort:port readsRequests:YES logger:logger];
+}
+
+- (instancetype)initWithPort:(in_port_t)port readsRequests:(BOOL)readsRequests logger:(id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  FBDeviceVideoStreamServer_Delegate *delegate = [[FBDeviceVideoStreamServer_Delegate alloc] init];
+  delegate.server = self;
+  _readsRequests = readsRequests;
+  _socketServer = [FBSocketServer socketServerOnPort:port delegate:delegate configuration:FBSocketServerConfiguration.multiClientConfiguration];
+  _logger = logger;
+  _queue = delegate.queue;
+  _streams = NSMutableDictionary.dictionary;
+  _clients = NSMutableSet.set;
+
+  return self;
+}
+
+#pragma mark Streams
+
+- (void)serveStream:(FBDeviceVideoStream *)stream atPath:(NSString *)path
+{
+  path = NormalizedPath(path);
+  FBDeviceVideoStream *previous = nil;
+  @synchronized (self) {
+    previous = self.streams[path];
+    self.streams[path] = stream;
+  }
+  if (previous && previous != stream) {
+    [self disconnectClientsOfStream:previous];
+  }
+  // Clients of a stream that has completed would otherwise wait for frames that never arrive.
+  __weak typeof(self) weakSelf = self;
+  [stream.completed onQueue:self.queue notifyOfCompletion:^(id _) {
+    [weakSelf stopServingStream:stream atPath:path];
+  }];
+}
+
+- (void)stopServingStreamAtPath:(NSString *)path
+{
+  path = NormalizedPath(path);
+  FBDeviceVideoStream *stream = nil;
+  @synchronized (self) {
+    stream = self.streams[path];
+    [self.streams removeObjectForKey:path];
+  }
+  if (stream) {
+    [self disconnectClientsOfStream:stream];
+  }
+}
+
+#pragma mark Properties
+
+- (in_port_t)port
+{
+  return self.socketServer.port;
+}
+
+- (NSUInteger)clientCount
+{
+  @synchronized (self) {
+    return self.clients.count;
+  }
+}
+
+#pragma mark Public Methods
+
+- (FBFuture<NSNull *> *)startListening
+{
+  return [self.socketServer startListening];
+}
+
+- (FBFuture<NSNull *> *)stopListening
+{
+  FBFuture<NSNull *> *future = [self.socketServer stopListening];
+  NSArray<FBDeviceVideoStreamServer_Client *> *clients = nil;
+  @synchronized (self) {
+    clients = self.clients.allObjects;
+  }
+  for (FBDeviceVideoStreamServer_Client *client in clients) {
+    [client disconnect];
+  }
+  return future;
+}
+
+- (FBFutureContext<NSNull *> *)startListeningContext
+{
+  return [[self
+    startListening]
+    onQueue:self.queue contextualTeardown:^(NSNull *_, FBFutureState __) {
+      return [self stopListening];
+    }];
+}
+
+#pragma mark Private
+
+- (void)clientConnected:(int)fileDescriptor queue:(dispatch_queue_t)queue
+{
+  // A write to a client that has gone away should fail the write, not raise SIGPIPE in this process.
+  int flagTrue = 1;
+  setsockopt(fileDescriptor, SOL_SOCKET, SO_NOSIGPIPE, &flagTrue, sizeof(flagTrue));
+
+  FBDeviceVideoStreamServer_Client *client = self.readsRequests ? [self clientForRequestOnFileDescriptor:fileDescriptor queue:queue] : [self clientOnFileDescriptor:fileDescriptor path:@"/" framing:FBDeviceVideoStreamServerFramingNone queue:queue];
+  if (!client) {
+    close(fileDescriptor);
+    return;
+  }
+  @synchronized (self) {
+    [self.clients addObject:client];
+  }
+  __weak typeof(self) weakSelf = self;
+  [client.disconnected onQueue:queue notifyOfCompletion:^(id _) {
+    FBDeviceVideoStreamServer *server = weakSelf;
+    if (!server) {
+      return;
+    }
+    @synchronized (server) {
+      [server.clients removeObject:client];
+    }
+  }];
+  [client attach];
+}
+
+- (nullable FBDeviceVideoStreamServer_Client *)clientForRequestOnFileDescriptor:(int)fileDescriptor queue:(dispatch_queue_t)queue
+{
+  NSDictionary<NSString *, NSString *> *request = ReadRequestHead(fileDescriptor);
+  if (!request) {
+    WriteErrorResponse(fileDescriptor, @"400 Bad Request");
+    return nil;
+  }
+  if (![request[@":method"] isEqualToString:@"GET"]) {
+    WriteErrorResponse(fileDescriptor, @"405 Method Not Allowed");
+    return nil;
+  }
+  NSString *path = NormalizedPath(request[@":path"]);
+  FBDeviceVideoStream *stream = [self streamForPath:path];
+  if (!stream) {
+    WriteErrorResponse(fileDescriptor, @"404 Not Found");
+    return nil;
+  }
+
+  NSString *webSocketKey = request[@"sec-websocket-key"];
+  if ([request[@"upgrade"].lowercaseString isEqualToString:@"websocket"] && webSocketKey) {
+    NSString *response = [NSString stringWithFormat:@"HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: %@\r\n\r\n", WebSocketAcceptForKey(webSocketKey)];
+    if (!WriteString(fileDescriptor, response)) {
+      return nil;
+    }
+    return [self clientOnFileDescriptor:fileDescriptor path:path framing:FBDeviceVideoStreamServerFramingWebSocket queue:queue];
+  }
+
+  FBVideoStreamEncoding encoding = stream.configuration.encoding;
+  BOOL isMultipart = [encoding isEqualToString:FBVideoStreamEncodingMJPEG];
+  NSString *contentType = isMultipart ? [NSString stringWithFormat:@"multipart/x-mixed-replace; boundary=%@", MultipartBoundary] : ContentTypeForEncoding(encoding);
+  NSString *response = [NSString stringWithFormat:@"HTTP/1.1 200 OK\r\nContent-Type: %@\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n", contentType];
+  if (!WriteString(fileDescriptor, response)) {
+    return nil;
+  }
+  return [self clientOnFileDescriptor:fileDescriptor path:path framing:(isMultipart ? FBDeviceVideoStreamServerFramingMultipart : FBDeviceVideoStreamServerFramingNone) queue:queue];
+}
+
+- (nullable FBDeviceVideoStreamServer_Client *)clientOnFileDescriptor:(int)fileDescriptor path:(NSString *)path framing:(FBDeviceVideoStreamServerFraming)framing queue:(dispatch_queue_t)queue
+{
+  FBDeviceVideoStream *stream = [self streamForPath:path];
+  if (!stream) {
+    return nil;
+  }
+  return [[FBDeviceVideoStreamServer_Client alloc] initWithFileDescriptor:fileDescriptor framing:framing stream:stream path:path queue:queue logger:self.logger];
+}
+
+- (nullable FBDeviceVideoStream *)streamForPath:(NSString *)path
+{
+  @synchronized (self) {
+    FBDeviceVideoStream *stream = self.streams[path];
+    if (!stream && [path isEqualToString:@"/"] && self.streams.count == 1) {
+      stream = self.streams.allValues.firstObject;
+    }
+    return stream;
+  }
+}
+
+- (void)stopServingStream:(FBDeviceVideoStream *)stream atPath:(NSString *)path
+{
+  @synchronized (self) {
+    if (self.streams[path] != stream) {
+      return;
+    }
+  }
+  [self stopServingStreamAtPath:path];
+}
+
+- (void)disconnectClientsOfStream:(FBDeviceVideoStream *)stream
+{
+  NSArray<FBDeviceVideoStreamServer_Client *> *clients = nil;
+  @synchronized (self) {
+    clients = self.clients.allObjects;
+  }
+  for (FBDeviceVideoStreamServer_Client *client in clients) {
+    if (client.stream == stream) {
+      [client disconnect];
+    }
+  }
+}
+
+@end
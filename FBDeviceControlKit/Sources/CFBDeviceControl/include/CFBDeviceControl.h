@@ -25,18 +25,22 @@
 #import "FBDeviceFileCommands.h"
 #import "FBDeviceLifecycleCommands.h"
 #import "FBDeviceLocationCommands.h"
+#import "FBDeviceLocationSimulationSession.h"
 #import "FBDeviceLogCommands.h"
 #import "FBDevicePowerCommands.h"
 #import "FBDeviceProvisioningProfileCommands.h"
 #import "FBDeviceRecoveryCommands.h"
 #import "FBDeviceScreenshotCommands.h"
+#import "FBDeviceScreenshotSession.h"
 #import "FBDeviceSocketForwardingCommands.h"
+#import "FBDeviceValueCommands.h"
 #import "FBDeviceVideoRecordingCommands.h"
 // FBDeviceXCTestCommands excluded - requires XCTestBootstrap dependency
 
 // MARK: - Management
 
 #import "FBAFCConnection.h"
+#import "FBAFCDirectoryTransfer.h"
 #import "FBAMDefines.h"
 #import "FBAMDevice.h"
 #import "FBAMDevice+Private.h"
@@ -49,8 +53,14 @@
 #import "FBDevice+Private.h"
 #import "FBDeviceDebugServer.h"
 #import "FBDeviceManager.h"
+#import "FBDevicePortForwarder.h"
+#import "FBDeviceProcessSnapshot.h"
 #import "FBDeviceSet.h"
+#import "FBDeviceSetInstaller.h"
+#import "FBDeviceSocketRelay.h"
 #import "FBDeviceStorage.h"
+#import "FBDeviceSymbolCache.h"
+#import "FBDeviceWorkflowStatistics.h"
 #import "FBInstrumentsClient.h"
 #import "FBManagedConfigClient.h"
 #import "FBSpringboardServicesClient.h"
@@ -60,11 +70,14 @@
 #import "FBDeviceControlError.h"
 #import "FBDeviceControlFrameworkLoader.h"
 #import "FBDeviceLinkClient.h"
+#import "FBDeviceLogEntry.h"
 
 // MARK: - Video
 
 #import "FBDeviceVideo.h"
+#import "FBDeviceVideoEncoder.h"
 #import "FBDeviceVideoStream.h"
+#import "FBDeviceVideoStreamServer.h"
 
 // MARK: - Bridge
 
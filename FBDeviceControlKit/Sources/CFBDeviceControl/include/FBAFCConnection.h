@@ -13,7 +13,55 @@
 NS_ASSUME_NONNULL_BEGIN
 
 @class FBAMDServiceConnection;
+@class FBProcessOutputReader;
 @protocol FBControlCoreLogger;
+@protocol FBDataConsumer;
+
+/**
+ Reports the progress of a file transfer.
+
+ @param bytesTransferred the number of bytes transferred so far.
+ @param totalBytes the size of the file being transferred.
+ @param bytesPerSecond the average throughput of the transfer so far.
+ */
+typedef void (^FBAFCTransferProgress)(uint64_t bytesTransferred, uint64_t totalBytes, double bytesPerSecond);
+
+/**
+ The type of a file on the device.
+ */
+typedef NS_ENUM(NSUInteger, FBAFCFileType) {
+  FBAFCFileTypeOther = 0,
+  FBAFCFileTypeRegular = 1,
+  FBAFCFileTypeDirectory = 2,
+  FBAFCFileTypeSymbolicLink = 3,
+};
+
+/**
+ Information about a file on the device, as reported by AFC.
+ */
+@interface FBAFCFileInfo : NSObject
+
+/**
+ The name of the file, without its directory.
+ */
+@property (nonatomic, copy, readonly) NSString *name;
+
+/**
+ The type of the file.
+ */
+@property (nonatomic, assign, readonly) FBAFCFileType type;
+
+/**
+ The size of the file in bytes.
+ */
+@property (nonatomic, assign, readonly) uint64_t size;
+
+/**
+ The time at which the file was last modified.
+ */
+@property (nonatomic, copy, readonly) NSDate *modificationDate;
+
+@end
 
 /**
  An Object wrapper for an Apple File Conduit handle/
@@ -56,6 +104,31 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (BOOL)copyFromHost:(NSString *)hostPath toContainerPath:(NSString *)containerPath error:(NSError **)error;
 
+/**
+ Copies a single file on the host into an application container.
+ The file is read in large chunks, with the read of the next chunk overlapping the write of the current one, so memory use doesn't grow with the size of the file.
+
+ @param hostPath the file on the host.
+ @param containerPath the destination path, including the file name, relative to the application container.
+ @param progress called after each chunk is written, may be nil.
+ @param error an error out for any error that occurs.
+ @return YES if successful, NO otherwise.
+ */
+- (BOOL)copyFileFromHost:(NSString *)hostPath toContainerPath:(NSString *)containerPath progress:(nullable FBAFCTransferProgress)progress error:(NSError **)error;
+
+/**
+ Copies the output of a process into a file in an application container, such as a tar created by -[FBArchiveOperations createGzippedTarReaderForPath:logger:].
+ The next chunk is read from the process whilst the current chunk is written to the device, so there is no intermediate file, and the process is only read as fast as the device is written.
+ Must not be called on a queue that the reader needs to resolve its reads.
+
+ @param reader the reader of the process output.
+ @param containerPath the destination path, including the file name, relative to the application container.
+ @param progress called after each chunk is written, the total is 0 as the length of the output is not known. May be nil.
+ @param error an error out for any error that occurs.
+ @return YES if successful, NO otherwise.
+ */
+- (BOOL)copyFromReader:(FBProcessOutputReader *)reader toContainerPath:(NSString *)containerPath progress:(nullable FBAFCTransferProgress)progress error:(NSError **)error;
+
 /**
  Creates a Directory.
 
@@ -74,6 +147,26 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable NSArray<NSString *> *)contentsOfDirectory:(NSString *)path error:(NSError **)error;
 
+/**
+ Get the contents of a directory, along with information about each item.
+ AFC has no call that lists and stats at once, so each item is stat-ed on this connection as the directory is read, without returning to the caller in between.
+ If listingCacheTimeout is set, a listing that is younger than it is returned without going to the device.
+
+ @param path the path to locate.
+ @param error an error out for any occurs
+ @return the information of each item in the directory.
+ */
+- (nullable NSArray<FBAFCFileInfo *> *)contentsOfDirectoryWithInfo:(NSString *)path error:(NSError **)error;
+
+/**
+ Get information about a single path.
+
+ @param path the path to stat.
+ @param error an error out for any occurs
+ @return the information of the path.
+ */
+- (nullable FBAFCFileInfo *)fileInfoForPath:(NSString *)path error:(NSError **)error;
+
 /**
  Get the contents of a file.
 
@@ -83,6 +176,52 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable NSData *)contentsOfPath:(NSString *)path error:(NSError **)error;
 
+/**
+ Reads the start of a file, for when only a header is needed.
+
+ @param path the path to read.
+ @param maximumLength the maximum number of bytes to read.
+ @param error an error out for any occurs.
+ @return the data from the start of the file, which is shorter than the maximum length if the file is.
+ */
+- (nullable NSData *)contentsOfPath:(NSString *)path maximumLength:(uint64_t)maximumLength error:(NSError **)error;
+
+/**
+ Reads the contents of a file in fixed-size chunks, passing each chunk to a consumer.
+ Unlike contentsOfPath:error: the file is never held in memory in its entirety.
+ The consumer is not sent an end-of-file, so that it can be used for more than one file.
+
+ @param path the path to read.
+ @param consumer the consumer to pass each chunk to.
+ @param error an error out for any occurs.
+ @return YES if the file was read in its entirety, NO otherwise.
+ */
+- (BOOL)readContentsOfPath:(NSString *)path toConsumer:(id<FBDataConsumer>)consumer error:(NSError **)error;
+
+/**
+ Reads the contents of a file from an offset to the end of the file, passing each chunk to a consumer.
+ Only the bytes after the offset are transferred, so a growing file can be followed by starting each read where the previous one ended.
+
+ @param path the path to read.
+ @param offset the offset in the file to start reading from.
+ @param consumer the consumer to pass each chunk to. This is not sent an end-of-file.
+ @param endOffset an outparam for the offset at which the read ended, to start the next read from.
+ @param error an error out for any occurs.
+ @return YES if the file was read to the end, NO otherwise.
+ */
+- (BOOL)readContentsOfPath:(NSString *)path fromOffset:(uint64_t)offset toConsumer:(id<FBDataConsumer>)consumer endOffset:(nullable uint64_t *)endOffset error:(NSError **)error;
+
+/**
+ Reads the contents of a file in fixed-size chunks, writing each chunk to a file descriptor on the host.
+ Unlike contentsOfPath:error: the file is never held in memory in its entirety.
+
+ @param path the path to read.
+ @param fileDescriptor the file descriptor to write to. This is not closed.
+ @param error an error out for any occurs.
+ @return YES if the file was read and written in its entirety, NO otherwise.
+ */
+- (BOOL)readContentsOfPath:(NSString *)path toFileDescriptor:(int)fileDescriptor error:(NSError **)error;
+
 /**
  Removes a path.
 
@@ -112,6 +251,13 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (BOOL)closeWithError:(NSError **)error;
 
+/**
+ Whether the underlying connection is still usable, without making a request of the device.
+
+ @return YES if the connection is valid, NO otherwise.
+ */
+- (BOOL)connectionIsValid;
+
 #pragma mark Properties
 
 /**
@@ -129,6 +275,12 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
 
+/**
+ The time for which a listing from contentsOfDirectoryWithInfo:error: is re-used, nil to not cache listings. Defaults to nil.
+ Writes, removals and renames made through this connection invalidate the listings that they affect, changes made by the device or by other connections are seen once the listing expires.
+ */
+@property (nonatomic, copy, nullable, readwrite) NSNumber *listingCacheTimeout;
+
 /**
  The Default Calls.
  */
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBControlCore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBAFCConnection;
+
+/**
+ Provides an additional AFC Connection for a transfer, that is torn down when the worker using it is done.
+ */
+typedef FBFutureContext<FBAFCConnection *> *_Nonnull (^FBAFCConnectionProvider)(void);
+
+/**
+ Copies trees of files from the host into a device over several AFC Connections at once.
+ The tree is enumerated once, small files are batched so that each is not a separate unit of work, and batches are spread across connections.
+ The connection that the transfer is started with always takes part, additional connections are used as and when the provider can supply them, so a provider backed by an exhausted pool slows the transfer rather than stalling it.
+ */
+@interface FBAFCDirectoryTransfer : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param connectionProvider provides additional connections, nil to only use the connection that the transfer is started with.
+ @param concurrency the maximum number of connections to use, including the connection that the transfer is started with.
+ @param logger the logger to use.
+ @return a new FBAFCDirectoryTransfer instance.
+ */
++ (instancetype)transferWithConnectionProvider:(nullable FBAFCConnectionProvider)connectionProvider concurrency:(NSUInteger)concurrency logger:(nullable id<FBControlCoreLogger>)logger;
+
+#pragma mark Public Methods
+
+/**
+ Copies an item on the host into the device, blocking until the copy is done.
+ The semantics are the same as -[FBAFCConnection copyFromHost:toContainerPath:error:], the item is copied into the container path with its own name.
+
+ @param hostPath the file or directory on the host.
+ @param containerPath the directory to copy into, relative to the root of the connection.
+ @param connection the connection to use on the calling thread. This must not be used elsewhere for the duration of the call.
+ @param manifestPath a file on the host that records which files have been copied, keyed on their size and modification date. Files that are unchanged since a previous copy to the same destination are skipped, so an interrupted copy can be resumed. nil to copy every file.
+ @param error an error out for any error that occurs.
+ @return the paths of the files that were copied, relative to hostPath, nil on error.
+ */
+- (nullable NSArray<NSString *> *)copyFromHost:(NSString *)hostPath toContainerPath:(NSString *)containerPath connection:(FBAFCConnection *)connection manifestPath:(nullable NSString *)manifestPath error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
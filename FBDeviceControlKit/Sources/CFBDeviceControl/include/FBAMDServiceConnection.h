@@ -82,9 +82,24 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable id)sendAndReceiveMessage:(id)message error:(NSError **)error;
 
+/**
+ Sends a batch of plists, reading the responses in order.
+ Up to 'depth' messages are written before the first response is read, so a batch of N requests costs roughly one round-trip rather than N.
+ Sends and receives are all made on 'queue', so the connection is never used from two threads at once; this should be the queue that the owner of the connection otherwise uses for it.
+ Only valid for services that answer every request with exactly one response, in the order of the requests.
+ If a send or receive fails the stream can no longer be matched to the requests, so the failing request and all that follow it fail with the same error.
+
+ @param messages the messages to send.
+ @param depth the maximum number of requests that are awaiting a response at any one time.
+ @param queue the serial queue to send and receive on.
+ @return a Future per message, in the same order, resolving with the response to that message.
+ */
+- (NSArray<FBFuture<id> *> *)sendMessagesPipelined:(NSArray<id> *)messages depth:(NSUInteger)depth onQueue:(dispatch_queue_t)queue;
+
 #pragma mark Raw Bytes Read/Write
 /**
  Synchronously send bytes on the connection.
+ The bytes are sent from the storage of the data, in writes of up to sendChunkSize, so non-contiguous data is not flattened first.
 
  @param data the data to send
  @param error an error out for any error that occurs.
@@ -94,6 +109,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  Synchronously send bytes on the connection, prefixed with a length packet.
+ The header is sent in the same write as the start of the payload.
 
  @param data the data to send>
  @param error an error out for any error that occurs.
@@ -121,6 +137,30 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (NSData *)receive:(size_t)size error:(NSError **)error;
 
+/**
+ Synchronously receive bytes from the connection, appending them to existing data.
+ The bytes are received directly into the storage of the data, without an intermediate buffer.
+ This call will block until 'size' is met.
+ If a read fails before the 'size' is met, this call will fail and the data is left as it was.
+
+ @param size the number of bytes to read.
+ @param data the data to append to.
+ @param error an error out for any error that occurs.
+ @return YES if all bytes read, NO otherwise.
+ */
+- (BOOL)receive:(size_t)size appendingToData:(NSMutableData *)data error:(NSError **)error;
+
+/**
+ Synchronously receive up to 'size' bytes in the connection, appending them to existing data.
+ The bytes are received directly into the storage of the data, without an intermediate buffer.
+
+ @param size the number of bytes to read up to.
+ @param data the data to append to.
+ @param error an error out for any error that occurs.
+ @return the number of bytes read, 0 when end of file is reached, -1 on error.
+ */
+- (ssize_t)receiveUpTo:(size_t)size appendingToData:(NSMutableData *)data error:(NSError **)error;
+
 /**
  Synchronously receive up to 'size' bytes in the connection
  This call will return an empty NSData when end of file is reached.
@@ -143,6 +183,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  Synchronously receive bytes into a buffer.
+ The bytes are received directly into the destination.
 
  @param destination the destination to write into.
  @param size the number of bytes to read.
@@ -173,6 +214,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  Reads the stream on the given queue, until exhausted.
+ Reads are delivered from a single thread, so a ring buffer consumer from +[FBBlockDataConsumer ringBufferDataConsumerOnQueue:capacity:consumer:] can be used to hand reads to another queue cheaply.
 
  @param consumer the consumer to use.
  @param queue the queue to consume on.
@@ -238,6 +280,16 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, strong, nullable, readonly) id<FBControlCoreLogger> logger;
 
+/**
+ The maximum number of bytes passed to a single send. Defaults to 256KB.
+ */
+@property (nonatomic, assign, readwrite) size_t sendChunkSize;
+
+/**
+ The maximum number of bytes requested by a single receive, including those of readFromConnectionWritingToConsumer:onQueue:. Defaults to 64KB.
+ */
+@property (nonatomic, assign, readwrite) size_t receiveChunkSize;
+
 @end
 
 NS_ASSUME_NONNULL_END
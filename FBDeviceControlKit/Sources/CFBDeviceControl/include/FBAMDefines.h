@@ -209,6 +209,8 @@ typedef struct {
   
   // USBMux
   int (*GetConnectionID)(AMDeviceRef device);
+  uint32_t (*_Nullable USBLocationID)(AMDeviceRef device);
+  int (*_Nullable GetInterfaceType)(AMDeviceRef device);
   int (*USBMuxConnectByPort)(int connectionID, int remotePort, int *socket);
 
   // Debugging
@@ -241,6 +243,9 @@ typedef struct {
   int (*FileRefWrite)(AFCConnectionRef connection, CFTypeRef ref, const void *_Nonnull buf, uint64_t len);
   int (*RenamePath)(AFCConnectionRef connection, const char *_Nonnull path, const char *_Nonnull toPath);
   int (*RemovePath)(AFCConnectionRef connection, const char *_Nonnull path);
+  int (*FileInfoOpen)(AFCConnectionRef connection, const char *_Nonnull path, CFTypeRef _Nullable *_Nonnull info);
+  int (*KeyValueRead)(CFTypeRef info, char *_Nullable *_Nonnull key, char *_Nullable *_Nonnull value);
+  int (*KeyValueClose)(CFTypeRef info);
 
   // Batch Operations
   int (*ConnectionProcessOperation)(AFCConnectionRef connection, CFTypeRef operation);
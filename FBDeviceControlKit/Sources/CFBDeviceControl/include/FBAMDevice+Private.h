@@ -41,6 +41,42 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, strong, readonly) FBAMDeviceServiceManager *serviceManager;
 
+/**
+ The interface of an AMDeviceRef.
+
+ @param amDeviceRef the AMDeviceRef.
+ @param calls the calls to use.
+ @return the interface.
+ */
++ (FBAMDeviceInterface)interfaceOfAMDeviceRef:(AMDeviceRef)amDeviceRef calls:(AMDCalls)calls;
+
+/**
+ Records an AMDeviceRef for one of the device's interfaces, replacing any previous reference for that interface.
+ amDeviceRef is then chosen from the attached interfaces by the connection policy.
+
+ @param amDeviceRef the AMDeviceRef.
+ @param interface the interface of the reference.
+ @return YES if the reference used for connections changed, NO otherwise.
+ */
+- (BOOL)attachAMDeviceRef:(AMDeviceRef)amDeviceRef interface:(FBAMDeviceInterface)interface;
+
+/**
+ Removes an AMDeviceRef for an interface that has detached.
+ If another interface is still attached, connections fail over to it. Otherwise amDeviceRef keeps the detached reference, as before.
+
+ @param amDeviceRef the AMDeviceRef that has detached.
+ @return YES if the device is still reachable over another interface, NO otherwise.
+ */
+- (BOOL)detachAMDeviceRef:(AMDeviceRef)amDeviceRef;
+
+/**
+ Whether the AMDeviceRef is one of the device's attached interfaces.
+
+ @param amDeviceRef the AMDeviceRef.
+ @return YES if attached, NO otherwise.
+ */
+- (BOOL)hasAMDeviceRef:(AMDeviceRef)amDeviceRef;
+
 #pragma mark Private Methods
 
 /**
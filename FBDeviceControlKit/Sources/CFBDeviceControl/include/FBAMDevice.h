@@ -14,6 +14,25 @@ NS_ASSUME_NONNULL_BEGIN
 @class FBDeviceType;
 @class FBOSVersion;
 
+/**
+ The interface over which an AMDevice is reachable.
+ A device that is attached over USB and paired for network access is notified once for each interface.
+ */
+typedef NS_ENUM(NSUInteger, FBAMDeviceInterface) {
+  FBAMDeviceInterfaceUnknown = 0,
+  FBAMDeviceInterfaceUSB = 1,
+  FBAMDeviceInterfaceNetwork = 2,
+};
+
+/**
+ How an interface is chosen, when a device is reachable over more than one.
+ */
+typedef NS_ENUM(NSUInteger, FBAMDeviceConnectionPolicy) {
+  FBAMDeviceConnectionPolicyPreferUSB = 0, // USB when attached, the network otherwise. Suits streaming and bulk AFC transfers.
+  FBAMDeviceConnectionPolicyPreferNetwork = 1, // The network when paired for it, USB otherwise.
+  FBAMDeviceConnectionPolicyUSBOnly = 2, // Only USB. Connections fail whilst the device is only reachable over the network.
+};
+
 /**
  An Object Wrapper for AMDevice.
  AMDevice is a Core Foundation Type in the MobileDevice.framework.
@@ -49,6 +68,22 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, strong, readonly) dispatch_queue_t asyncQueue;
 
+/**
+ The interface that connections to the device are made over.
+ */
+@property (nonatomic, assign, readonly) FBAMDeviceInterface interfaceType;
+
+/**
+ The interfaces over which the device is currently reachable, as FBAMDeviceInterface values.
+ */
+@property (nonatomic, copy, readonly) NSArray<NSNumber *> *attachedInterfaces;
+
+/**
+ The policy that chooses the interface for connections. Defaults to FBAMDeviceConnectionPolicyPreferUSB.
+ Changing it takes effect for the next connection. When the chosen interface detaches, connections fail over to the next one the policy allows.
+ */
+@property (nonatomic, assign, readwrite) FBAMDeviceConnectionPolicy connectionPolicy;
+
 @end
 
 NS_ASSUME_NONNULL_END
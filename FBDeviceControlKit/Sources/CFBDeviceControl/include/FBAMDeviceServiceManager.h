@@ -10,6 +10,7 @@
 #import "FBControlCore.h"
 
 #import "FBAFCConnection.h"
+#import "FBAMDServiceConnection.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -18,6 +19,7 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  The Service Manager for an FBAMDevice instance.
  This allows for the pooling of services.
+ Connections are limited across all services of the device, evicting the least recently used idle connection when a new one is needed.
  */
 @interface FBAMDeviceServiceManager : NSObject
 
@@ -35,13 +37,55 @@ NS_ASSUME_NONNULL_BEGIN
 #pragma mark Public Services
 
 /**
- Obtain the Context Mannager
+ Obtain the Context Pool for a house_arrest service.
+ Concurrent consumers of the same Bundle ID are given separate connections, up to a limit, rather than waiting on each other.
 
  @param bundleID the Bundle ID of the house_arrest service.
  @param afcCalls the calls to use.
- @return a FBFutureContextManager for the house_arrest service.
+ @return a FBFutureContextPool for the house_arrest service.
  */
-- (FBFutureContextManager<FBAFCConnection *> *)houseArrestAFCConnectionForBundleID:(NSString *)bundleID afcCalls:(AFCCalls)afcCalls;
+- (FBFutureContextPool<FBAFCConnection *> *)houseArrestAFCConnectionForBundleID:(NSString *)bundleID afcCalls:(AFCCalls)afcCalls;
+
+/**
+ Obtain the Context Pool for a plist-based lockdown service.
+ Only suitable for services that can be used for several request/response exchanges on one connection.
+ A connection that the device has closed, or that has unread data, is discarded rather than reused.
+
+ @param service the name of the service.
+ @return a FBFutureContextPool for the service.
+ */
+- (FBFutureContextPool<FBAMDServiceConnection *> *)serviceConnectionPoolForService:(NSString *)service;
+
+#pragma mark Lifecycle
+
+/**
+ Called when the device is attached, or re-attached with a new AMDeviceRef.
+ Connections of the previous AMDeviceRef are drained and services are prewarmed.
+
+ @return a Future that resolves when services have been prewarmed. Failures to prewarm are logged rather than propagated.
+ */
+- (FBFuture<NSNull *> *)deviceAttached;
+
+/**
+ Prepare connections for the Bundle IDs in prewarmBundleIDs and for those that have been used before.
+
+ @return a Future that resolves when the connections have been prepared.
+ */
+- (FBFuture<NSNull *> *)prewarm;
+
+/**
+ Tear down all idle connections. Connections that are in use are torn down when they are returned.
+
+ @return a Future that resolves when the idle connections have been torn down.
+ */
+- (FBFuture<NSNull *> *)drain;
+
+#pragma mark Properties
+
+/**
+ The Bundle IDs to prepare house_arrest connections for, ahead of their first use.
+ */
+@property (nonatomic, copy, readwrite) NSSet<NSString *> *prewarmBundleIDs;
 
 @end
 
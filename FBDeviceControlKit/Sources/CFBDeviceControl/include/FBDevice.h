@@ -13,6 +13,7 @@
 #import "FBDeviceDebugSymbolsCommands.h"
 #import "FBDeviceRecoveryCommands.h"
 #import "FBDeviceSocketForwardingCommands.h"
+#import "FBDeviceValueCommands.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -22,7 +23,7 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  A class that represents an iOS Device.
  */
-@interface FBDevice : NSObject <FBiOSTarget, FBDebuggerCommands, FBDeviceCommands, FBDiagnosticInformationCommands, FBLocationCommands, FBDeviceRecoveryCommands, FBDeviceActivationCommands, FBPowerCommands, FBDeveloperDiskImageCommands, FBSocketForwardingCommands, FBDeviceDebugSymbolsCommands>
+@interface FBDevice : NSObject <FBiOSTarget, FBDebuggerCommands, FBDeviceCommands, FBDiagnosticInformationCommands, FBLocationCommands, FBDeviceRecoveryCommands, FBDeviceActivationCommands, FBPowerCommands, FBDeveloperDiskImageCommands, FBSocketForwardingCommands, FBDeviceDebugSymbolsCommands, FBDeviceValueCommands>
 
 /**
  The Device Set to which the Device Belongs.
@@ -12,12 +12,44 @@
 NS_ASSUME_NONNULL_BEGIN
 
 @class FBDevice;
+@class FBDeviceProcessSnapshot;
+@class FBDeviceWorkflowStatistics;
 
 /**
  An Implementation of FBApplicationCommands for Devices
  */
 @interface FBDeviceApplicationCommands : NSObject <FBApplicationCommands>
 
+#pragma mark Public Methods
+
+/**
+ Installs an application, optionally skipping the install if the bundle is unchanged since it was last installed on the device.
+ An incremental install hashes the contents of the bundle, re-using the digests of files that are unchanged on disk since the last incremental install of the same bundle identifier.
+ If no file has changed and the app from that install is still on the device, the install is skipped.
+ Otherwise the bundle is installed, with the delta directory for the device ensuring that only changed files are transferred.
+
+ @param path the path of the application bundle.
+ @param incremental YES to compare against the manifest of the last install on the device, NO to always install.
+ @return a Future that resolves with the installed application.
+ */
+- (FBFuture<FBInstalledApplication *> *)installApplicationWithPath:(NSString *)path incremental:(BOOL)incremental;
+
+/**
+ Takes a snapshot of the processes running on the device, with the bundle ID of those that are applications.
+ The os_trace_relay connection is kept open between snapshots, and each snapshot carries the processes launched and terminated since the previous one.
+ Processes that are unchanged re-use the resolution of the previous snapshot, so polling this frequently is cheap.
+
+ @return a Future that resolves with the snapshot.
+ */
+- (FBFuture<FBDeviceProcessSnapshot *> *)runningProcessSnapshot;
+
+#pragma mark Properties
+
+/**
+ The statistics of the most recent install that reached the device, with the time spent in each phase. nil if there has been no install.
+ */
+@property (nonatomic, strong, nullable, readonly) FBDeviceWorkflowStatistics *lastInstallStatistics;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -31,7 +31,9 @@ typedef NSString *FBDeviceKey NS_STRING_ENUM;
 extern FBDeviceKey const FBDeviceKeyChipID;
 extern FBDeviceKey const FBDeviceKeyDeviceClass;
 extern FBDeviceKey const FBDeviceKeyDeviceName;
+extern FBDeviceKey const FBDeviceKeyHardwareModel;
 extern FBDeviceKey const FBDeviceKeyLocationID;
+extern FBDeviceKey const FBDeviceKeyModelNumber;
 extern FBDeviceKey const FBDeviceKeyProductType;
 extern FBDeviceKey const FBDeviceKeySerialNumber;
 extern FBDeviceKey const FBDeviceKeyUniqueChipID;
@@ -120,6 +122,16 @@ extern FBDeviceActivationState FBDeviceActivationStateCoerceFromString(NSString
  */
 - (FBFutureContext<FBAMDServiceConnection *> *)startService:(NSString *)service;
 
+/**
+ Obtains a connection to a Service on the AMDevice from a pool, starting the service if there's no idle connection.
+ The connection is returned to the pool when the context is torn down, so repeated use doesn't pay for starting the service each time.
+ Only suitable for plist-based request/response services.
+
+ @param service the service name
+ @return a Future context wrapping the service connection.
+ */
+- (FBFutureContext<FBAMDServiceConnection *> *)pooledService:(NSString *)service;
+
 /**
  Starts a Service, wrapping it in a "Device Link" Plist client.
 
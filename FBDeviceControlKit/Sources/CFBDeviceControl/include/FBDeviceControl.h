@@ -6,6 +6,7 @@
  */
 
 #import "FBAFCConnection.h"
+#import "FBAFCDirectoryTransfer.h"
 #import "FBAMDefines.h"
 #import "FBAMDevice+Private.h"
 #import "FBAMDevice.h"
@@ -16,10 +17,22 @@
 #import "FBDeviceControlError.h"
 #import "FBDeviceControlFrameworkLoader.h"
 #import "FBDeviceDebugSymbolsCommands.h"
+#import "FBDeviceLocationSimulationSession.h"
+#import "FBDeviceLogEntry.h"
+#import "FBDevicePortForwarder.h"
 #import "FBDevicePowerCommands.h"
+#import "FBDeviceProcessSnapshot.h"
 #import "FBDeviceRecoveryCommands.h"
+#import "FBDeviceScreenshotSession.h"
 #import "FBDeviceSet.h"
+#import "FBDeviceSetInstaller.h"
 #import "FBDeviceSocketForwardingCommands.h"
+#import "FBDeviceSocketRelay.h"
+#import "FBDeviceSymbolCache.h"
+#import "FBDeviceValueCommands.h"
 #import "FBDeviceVideo.h"
+#import "FBDeviceVideoEncoder.h"
 #import "FBDeviceVideoStream.h"
+#import "FBDeviceVideoStreamServer.h"
+#import "FBDeviceWorkflowStatistics.h"
 // FBDeviceXCTestCommands excluded - requires XCTestBootstrap
@@ -50,6 +50,12 @@ extern NSString *const kFBDeviceEventStateChanged;
 /// @param devices 当前所有设备的信息字典数组
 typedef void (^FBDeviceChangeCallback)(NSArray<NSDictionary *> *devices);
 
+/// 设备变化差量回调 Block 类型
+/// @param added 新增设备的信息字典数组
+/// @param removed 已移除设备的 UDID 数组
+/// @param updated 信息发生变化的设备的信息字典数组
+typedef void (^FBDeviceDiffCallback)(NSArray<NSDictionary *> *added, NSArray<NSString *> *removed, NSArray<NSDictionary *> *updated);
+
 #pragma mark - FBDeviceControlBridge
 
 /// FBDeviceControl 桥接类
@@ -59,11 +65,26 @@ typedef void (^FBDeviceChangeCallback)(NSArray<NSDictionary *> *devices);
 /// 单例实例
 @property (class, nonatomic, readonly) FBDeviceControlBridge *shared;
 
-/// FBDeviceControl 是否可用
-@property (nonatomic, readonly) BOOL isAvailable;
+/// FBDeviceControl 是否可用（初始化完成前为 NO）
+@property (atomic, readonly) BOOL isAvailable;
 
 /// 初始化错误信息（如果不可用）
-@property (nonatomic, readonly, nullable) NSString *initializationError;
+@property (atomic, readonly, nullable) NSString *initializationError;
+
+/// 是否已完成初始化（无论成功与否）
+/// 单例创建后在后台队列加载 MobileDevice 并开始监听设备，不阻塞调用线程
+@property (atomic, readonly) BOOL isReady;
+
+/// 初始化完成后在 deliveryQueue 上回调，已完成时也会异步回调
+/// 初始化完成前 listDevices 等同步方法返回空结果；开始观察后，首次回调在初始化完成后交付
+/// @param completion 回调，参数为 FBDeviceControl 是否可用
+- (void)whenReady:(void (^)(BOOL available))completion;
+
+/// 设备变化回调所在的队列，默认为主队列
+@property (nonatomic, strong) dispatch_queue_t deliveryQueue;
+
+/// 设备变化的合并窗口（秒），窗口内的多个事件合并为一次回调，默认 0.075 秒
+@property (nonatomic, assign) NSTimeInterval coalescingInterval;
 
 #pragma mark - 设备列表
 
@@ -76,13 +97,23 @@ typedef void (^FBDeviceChangeCallback)(NSArray<NSDictionary *> *devices);
 /// @return 设备信息字典，如果设备不存在返回 nil
 - (nullable NSDictionary *)fetchDeviceInfo:(NSString *)udid;
 
+/// 设备接入（FBDeviceSet 报告新增）时的主机时间，用于剖析设备启动耗时
+/// @param udid 设备 UDID
+/// @return 以秒为单位、与 CACurrentMediaTime 同一时基的时间，未记录时返回 0
+- (NSTimeInterval)attachTimeForUDID:(NSString *)udid;
+
 #pragma mark - 设备观察
 
 /// 开始观察设备变化
-/// @param callback 设备变化回调，在主线程调用
+/// @param callback 设备变化回调，在 deliveryQueue 上调用
 - (void)startObservingWithCallback:(FBDeviceChangeCallback)callback;
 
-/// 停止观察设备变化
+/// 以差量方式开始观察设备变化
+/// 首次回调的 added 包含当前所有设备，之后只回调发生变化的设备，信息未变化的事件不会回调
+/// @param callback 设备变化差量回调，在 deliveryQueue 上调用
+- (void)startObservingChangesWithCallback:(FBDeviceDiffCallback)callback;
+
+/// 停止观察设备变化（包括差量观察）
 - (void)stopObserving;
 
 /// 是否正在观察设备变化
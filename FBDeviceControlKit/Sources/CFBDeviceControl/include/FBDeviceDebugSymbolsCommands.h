@@ -15,6 +15,14 @@ NS_ASSUME_NONNULL_BEGIN
 
 @class FBDevice;
 
+/**
+ Reports the progress of extracting a shared cache, aggregated over all caches that are being extracted.
+
+ @param completed the number of dylibs that have been extracted.
+ @param total the number of dylibs to extract.
+ */
+typedef void (^FBDeviceSymbolsExtractionProgress)(NSUInteger completed, NSUInteger total);
+
 /**
  The Protocol for Debug Symbol related commands.
  */
@@ -38,12 +46,28 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  Pulls and extracts symbols to the provided path.
+ The symbols are copied from the host-level symbol cache, so they are only pulled from a device once for each OS build.
 
  @param destinationDirectory the destination to write to.
  @return a  Future that resolves with the extract path.
  */
 - (FBFuture<NSString *> *)pullAndExtractSymbolsToDestinationDirectory:(NSString *)destinationDirectory;
 
+/**
+ Obtains the extracted symbols from the shared FBDeviceSymbolCache, pulling and extracting them if no device on the same OS build has already done so.
+
+ @return a Future that resolves with the directory of the cached symbols.
+ */
+- (FBFuture<NSString *> *)pullAndExtractSymbolsToCache;
+
+/**
+ Obtains the extracted symbols from the shared FBDeviceSymbolCache, reporting the progress of extraction.
+
+ @param progress called on an arbitrary queue as dylibs are extracted. Not called if the symbols are already cached, or are being extracted for another device.
+ @return a Future that resolves with the directory of the cached symbols.
+ */
+- (FBFuture<NSString *> *)pullAndExtractSymbolsToCacheWithProgress:(nullable FBDeviceSymbolsExtractionProgress)progress;
+
 @end
 
 /**
@@ -10,6 +10,7 @@
 #import "FBControlCore.h"
 
 #import "FBAFCConnection.h"
+#import "FBAFCDirectoryTransfer.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -27,6 +28,27 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (instancetype)initWithAFCConnection:(FBAFCConnection *)connection queue:(dispatch_queue_t)queue;
 
+/**
+ Constructs a container that copies directories from the host over several connections at once.
+
+ @param connection the connection to use.
+ @param directoryTransfer the transfer to copy directories with, using the connection along with any others that it obtains.
+ @param queue the queue to perform work on.
+ @return a new FBDeviceFileCommands instance.
+ */
+- (instancetype)initWithAFCConnection:(FBAFCConnection *)connection directoryTransfer:(nullable FBAFCDirectoryTransfer *)directoryTransfer queue:(dispatch_queue_t)queue;
+
+/**
+ Constructs a container that resumes tails from where a previous tail of the same path ended.
+
+ @param connection the connection to use.
+ @param directoryTransfer the transfer to copy directories with, nil to copy over the connection alone.
+ @param tailOffsets the offsets that tails have reached, keyed by path. This is shared with other containers for the same location, so that it outlives the connection. nil to always tail from the start of a file.
+ @param queue the queue to perform work on.
+ @return a new FBDeviceFileCommands instance.
+ */
+- (instancetype)initWithAFCConnection:(FBAFCConnection *)connection directoryTransfer:(nullable FBAFCDirectoryTransfer *)directoryTransfer tailOffsets:(nullable NSMutableDictionary<NSString *, NSNumber *> *)tailOffsets queue:(dispatch_queue_t)queue;
+
 @end
 
 /**
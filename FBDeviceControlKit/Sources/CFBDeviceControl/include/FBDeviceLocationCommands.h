@@ -12,12 +12,22 @@
 NS_ASSUME_NONNULL_BEGIN
 
 @class FBDevice;
+@class FBDeviceLocationSimulationSession;
 
 /**
  An Implementation of FBLocationCommands for Devices.
  */
 @interface FBDeviceLocationCommands : NSObject <FBLocationCommands>
 
+#pragma mark Public Methods
+
+/**
+ Starts a simulatelocation session that is kept open for as long as the context is, for sending many locations such as when playing back a route.
+
+ @return a Future Context that resolves with the session.
+ */
+- (FBFutureContext<FBDeviceLocationSimulationSession *> *)locationSimulationSession;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBControlCore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBAMDServiceConnection;
+
+/**
+ A point on a route to simulate.
+ */
+@interface FBLocationRoutePoint : NSObject <NSCopying>
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param latitude the latitude.
+ @param longitude the longitude.
+ @param offset the time from the start of the route at which the point is reached.
+ @return a new FBLocationRoutePoint instance.
+ */
++ (instancetype)pointWithLatitude:(double)latitude longitude:(double)longitude offset:(NSTimeInterval)offset;
+
+/**
+ Parses the points of a GPX document.
+ Track points are used if there are any, then route points, then waypoints.
+ Offsets come from the <time> of each point, relative to the first. A point without a time is placed one second after the previous point.
+
+ @param data the GPX document.
+ @param error an error out for any error that occurs.
+ @return the points in the order of the document, nil on error.
+ */
++ (nullable NSArray<FBLocationRoutePoint *> *)routePointsFromGPXData:(NSData *)data error:(NSError **)error;
+
+#pragma mark Properties
+
+/**
+ The latitude.
+ */
+@property (nonatomic, assign, readonly) double latitude;
+
+/**
+ The longitude.
+ */
+@property (nonatomic, assign, readonly) double longitude;
+
+/**
+ The time from the start of the route at which the point is reached.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval offset;
+
+@end
+
+/**
+ A simulatelocation session that keeps its service connection open, so that each location update doesn't start the service again.
+ */
+@interface FBDeviceLocationSimulationSession : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param connection the connection to the simulatelocation service.
+ @param logger the logger to use.
+ @return a new FBDeviceLocationSimulationSession instance.
+ */
++ (instancetype)sessionWithConnection:(FBAMDServiceConnection *)connection logger:(id<FBControlCoreLogger>)logger;
+
+#pragma mark Public Methods
+
+/**
+ Overrides the location of the device.
+
+ @param latitude the latitude.
+ @param longitude the longitude.
+ @return a Future that resolves when the location has been sent.
+ */
+- (FBFuture<NSNull *> *)overrideLocationWithLatitude:(double)latitude longitude:(double)longitude;
+
+/**
+ Stops overriding the location, returning the device to its real location.
+
+ @return a Future that resolves when the request has been sent.
+ */
+- (FBFuture<NSNull *> *)clearLocation;
+
+/**
+ Plays a route back in real time, sending positions interpolated between the points of the route at a fixed rate.
+ Starting another playback, or overriding the location, ends the current playback.
+
+ @param route the points of the route, ordered by offset.
+ @param frequency the number of positions to send per second.
+ @return a Future that resolves when the last point of the route has been sent. Cancelling the future stops playback at the current position.
+ */
+- (FBFuture<NSNull *> *)playRoute:(NSArray<FBLocationRoutePoint *> *)route frequency:(double)frequency;
+
+@end
+
+NS_ASSUME_NONNULL_END
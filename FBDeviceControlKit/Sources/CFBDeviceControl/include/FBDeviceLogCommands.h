@@ -8,6 +8,7 @@
 #import <Foundation/Foundation.h>
 
 #import "FBControlCore.h"
+#import "FBDeviceLogEntry.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -18,6 +19,17 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @interface FBDeviceLogCommands : NSObject <FBLogCommands, FBiOSTargetCommand>
 
+/**
+ Starts tailing the log of the device, as parsed entries.
+ Each line is parsed once, as it arrives, and lines that do not match the predicate are discarded before any object is created for them.
+
+ @param predicate the predicate that entries must match.
+ @param queue the queue to call the handler on.
+ @param handler the block to call with each entry that matches.
+ @return a Future that will complete when the log command has started successfully. The wrapped Awaitable can then be cancelled, or awaited until it is finished.
+ */
+- (FBFuture<id<FBLogOperation>> *)tailLogEntriesMatching:(FBDeviceLogPredicate *)predicate onQueue:(dispatch_queue_t)queue handler:(void (^)(FBDeviceLogEntry *entry))handler;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The level of a device log entry, in ascending order of severity.
+ */
+typedef NS_ENUM(NSUInteger, FBDeviceLogLevel) {
+  FBDeviceLogLevelDebug = 0,
+  FBDeviceLogLevelInfo = 1,
+  FBDeviceLogLevelNotice = 2,
+  FBDeviceLogLevelWarning = 3,
+  FBDeviceLogLevelError = 4,
+  FBDeviceLogLevelFault = 5,
+};
+
+/**
+ A single entry of the device syslog relay.
+ */
+@interface FBDeviceLogEntry : NSObject
+
+/**
+ The timestamp of the entry, as formatted by the device, for example "Oct 14 10:15:22".
+ */
+@property (nonatomic, copy, readonly) NSString *timestamp;
+
+/**
+ The name of the process that logged the entry.
+ */
+@property (nonatomic, copy, readonly) NSString *process;
+
+/**
+ The pid of the process that logged the entry.
+ */
+@property (nonatomic, assign, readonly) pid_t processIdentifier;
+
+/**
+ The subsystem, or library, within the process that logged the entry. nil if the entry does not name one.
+ */
+@property (nonatomic, copy, nullable, readonly) NSString *subsystem;
+
+/**
+ The level of the entry.
+ */
+@property (nonatomic, assign, readonly) FBDeviceLogLevel level;
+
+/**
+ The message of the entry. A message that spans lines is delivered as one entry per line, each with the fields of the first.
+ */
+@property (nonatomic, copy, readonly) NSString *message;
+
+@end
+
+/**
+ A predicate on device log entries.
+ The predicate is compiled when it is created, so that entries can be rejected from their bytes as they are parsed, before any object is created for them.
+ Every condition that is set must be met for an entry to match.
+ */
+@interface FBDeviceLogPredicate : NSObject <NSCopying>
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param processNames the names of the processes to match, nil to match any process.
+ @param processIdentifiers the pids to match, nil to match any pid.
+ @param minimumLevel the lowest level that matches.
+ @param messagePattern a regular expression that the message must contain a match of, nil to match any message. This is applied after all other conditions, as it is the only one that needs the message as a string.
+ @return a new predicate.
+ */
+- (instancetype)initWithProcessNames:(nullable NSSet<NSString *> *)processNames processIdentifiers:(nullable NSSet<NSNumber *> *)processIdentifiers minimumLevel:(FBDeviceLogLevel)minimumLevel messagePattern:(nullable NSRegularExpression *)messagePattern;
+
+/**
+ A predicate that matches every entry.
+ */
+@property (nonatomic, class, strong, readonly) FBDeviceLogPredicate *matchAll;
+
+#pragma mark Properties
+
+/**
+ The names of the processes to match, nil if any process matches.
+ */
+@property (nonatomic, copy, nullable, readonly) NSSet<NSString *> *processNames;
+
+/**
+ The pids to match, nil if any pid matches.
+ */
+@property (nonatomic, copy, nullable, readonly) NSSet<NSNumber *> *processIdentifiers;
+
+/**
+ The lowest level that matches.
+ */
+@property (nonatomic, assign, readonly) FBDeviceLogLevel minimumLevel;
+
+/**
+ The regular expression that the message must contain a match of, nil if any message matches.
+ */
+@property (nonatomic, copy, nullable, readonly) NSRegularExpression *messagePattern;
+
+@end
+
+/**
+ Parses lines of the device syslog relay into entries, applying a predicate as each line is parsed.
+ The parser holds the state of the last entry, so that continuation lines of a multi-line message are attributed to it, so it should be fed lines in order from a single thread or serial queue.
+ */
+@interface FBDeviceLogEntryParser : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param predicate the predicate that entries must match.
+ @return a new parser.
+ */
+- (instancetype)initWithPredicate:(FBDeviceLogPredicate *)predicate;
+
+#pragma mark Public Methods
+
+/**
+ Parses a single line of the syslog relay, without the newline.
+
+ @param bytes the bytes of the line. These are borrowed, so need only be valid for the duration of the call.
+ @param length the number of bytes in the line.
+ @return the entry if the line matches the predicate, nil otherwise.
+ */
+- (nullable FBDeviceLogEntry *)entryForLineBytes:(const char *)bytes length:(size_t)length;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBControlCore.h"
+
+#import "FBDeviceCommands.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A long-lived forwarder of local TCP ports to ports on a device.
+ The usbmux connection ID of the device is obtained once, so forwarded connections are made without starting a lockdown session.
+ A small number of sockets to each device port are connected ahead of time, so that a new forwarded connection can be relayed immediately.
+ */
+@interface FBDevicePortForwarder : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param device the device to forward to.
+ @param portMapping the ports on the device, keyed by the local port to forward from. A local port of 0 binds to any free port.
+ @param poolSize the number of sockets to connect ahead of time for each device port. Use 0 for services on the device that only accept a single client.
+ @param logger the logger to use.
+ @return a new FBDevicePortForwarder instance.
+ */
++ (instancetype)forwarderWithDevice:(id<FBDeviceCommands>)device portMapping:(NSDictionary<NSNumber *, NSNumber *> *)portMapping poolSize:(NSUInteger)poolSize logger:(id<FBControlCoreLogger>)logger;
+
+#pragma mark Properties
+
+/**
+ The ports on the device, keyed by the local port that is bound once started.
+ */
+@property (nonatomic, copy, readonly) NSDictionary<NSNumber *, NSNumber *> *portMapping;
+
+#pragma mark Public Methods
+
+/**
+ Starts listening on all local ports.
+
+ @return a Future that resolves when all local ports are listening.
+ */
+- (FBFuture<NSNull *> *)start;
+
+/**
+ Stops listening, closing all pooled sockets. Connections that are being relayed continue until they end.
+
+ @return a Future that resolves when listening has stopped.
+ */
+- (FBFuture<NSNull *> *)stop;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A single running process.
+ The strings are owned by the snapshot that the entry belongs to, and are valid for the lifetime of that snapshot.
+ */
+typedef struct {
+  pid_t processIdentifier;
+  __unsafe_unretained NSString *name;
+  __unsafe_unretained NSString *_Nullable bundleID;
+} FBDeviceProcessEntry;
+
+/**
+ Resolves the bundle ID of an application from the name of its process.
+ */
+typedef NSString *_Nullable (^FBDeviceProcessBundleIDResolver)(NSString *processName);
+
+/**
+ The processes running on a device at a point in time, along with the changes since the previous snapshot.
+ */
+@interface FBDeviceProcessSnapshot : NSObject
+
+#pragma mark Initializers
+
+/**
+ Constructs a snapshot from the payload of an os_trace_relay PidList response.
+ Processes that are unchanged from the previous snapshot share its strings, rather than being resolved again.
+
+ @param payload the payload of the response, keyed by process identifier.
+ @param previous the previous snapshot to derive changes from, nil if this is the first.
+ @param resolver resolves the bundle ID of processes that are new since the previous snapshot.
+ @return a new FBDeviceProcessSnapshot instance.
+ */
++ (instancetype)snapshotFromProcessList:(NSDictionary<id, NSDictionary<NSString *, id> *> *)payload previous:(nullable FBDeviceProcessSnapshot *)previous bundleIDResolver:(FBDeviceProcessBundleIDResolver)resolver;
+
+#pragma mark Properties
+
+/**
+ The running processes, ordered by process identifier.
+ */
+@property (nonatomic, assign, readonly) const FBDeviceProcessEntry *entries NS_RETURNS_INNER_POINTER;
+
+/**
+ The number of entries.
+ */
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+/**
+ The processes that are in this snapshot but not the previous one. All processes if there was no previous snapshot.
+ */
+@property (nonatomic, copy, readonly) NSIndexSet *launchedProcessIdentifiers;
+
+/**
+ The processes that were in the previous snapshot but are not in this one.
+ */
+@property (nonatomic, copy, readonly) NSIndexSet *terminatedProcessIdentifiers;
+
+/**
+ The process identifier of each running application, keyed by bundle ID.
+ */
+@property (nonatomic, copy, readonly) NSDictionary<NSString *, NSNumber *> *processIdentifiersByBundleID;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -11,11 +11,22 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class FBDeviceScreenshotSession;
+
 /**
  Device Implementation for Screenshots
  */
 @interface FBDeviceScreenshotCommands : NSObject <FBScreenshotCommands>
 
+#pragma mark Public Methods
+
+/**
+ Starts a screenshotr session that is kept open for as long as the context is, for taking many screenshots.
+
+ @return a Future Context that resolves with the session.
+ */
+- (FBFutureContext<FBDeviceScreenshotSession *> *)screenshotSession;
+
 @end
 
 NS_ASSUME_NONNULL_END
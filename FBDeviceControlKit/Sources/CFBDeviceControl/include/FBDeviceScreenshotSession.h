@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+
+#import "FBControlCore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBDeviceLinkClient;
+
+/**
+ Consumes the screenshots of a continuous capture.
+ */
+@protocol FBDeviceScreenshotConsumer <NSObject>
+
+/**
+ Consumes a decoded screenshot, on the decoding queue of the session.
+
+ @param image the screenshot. Only valid for the duration of the call, unless retained.
+ @param timestamp the time since the reference date that the screenshot was requested.
+ */
+- (void)consumeScreenshot:(CGImageRef)image timestamp:(NSTimeInterval)timestamp;
+
+/**
+ Consumes the end of the capture, after which there are no more screenshots.
+ */
+- (void)consumeEndOfScreenshots;
+
+@end
+
+/**
+ A screenshotr session that keeps its DeviceLink client open, so that each screenshot doesn't start the service and exchange versions again.
+ */
+@interface FBDeviceScreenshotSession : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param client the DeviceLink client of the screenshotr service, after the version exchange.
+ @param logger the logger to use.
+ @return a new FBDeviceScreenshotSession instance.
+ */
++ (instancetype)sessionWithClient:(FBDeviceLinkClient *)client logger:(id<FBControlCoreLogger>)logger;
+
+#pragma mark Public Methods
+
+/**
+ Takes a single screenshot.
+
+ @return a Future that resolves with the encoded screenshot, as the device provides it.
+ */
+- (FBFuture<NSData *> *)takeScreenshot;
+
+/**
+ Captures screenshots continuously, aiming for one per interval.
+ If a screenshot takes longer than the interval, the next one is requested as soon as it arrives. Screenshots that arrive whilst the previous one is still decoding are dropped.
+
+ @param interval the target interval between screenshots.
+ @param consumer the consumer of the decoded screenshots.
+ @return a Future that resolves with the operation once capture has started. Cancelling the completed future of the operation stops capture.
+ */
+- (FBFuture<id<FBiOSTargetOperation>> *)captureWithInterval:(NSTimeInterval)interval consumer:(id<FBDeviceScreenshotConsumer>)consumer;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -7,6 +7,7 @@
 
 #import <Foundation/Foundation.h>
 #import "FBControlCore.h"
+#import "FBDeviceSetInstaller.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -40,10 +41,26 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable FBDevice *)deviceWithUDID:(NSString *)udid;
 
+#pragma mark Installing
+
+/**
+ Installs an application on all of the devices matching a predicate, using a FBDeviceSetInstaller.
+ The bundle is prepared once and installs are limited per USB hub, rather than being started on every device at once.
+
+ @param path the path of an application bundle, or an archive containing one.
+ @param predicate the predicate to select devices with.
+ @param maximumConcurrencyPerHub the number of devices on a single hub that are installed to at the same time.
+ @param incremental YES to skip devices that already have the same bundle.
+ @param progress called as each device finishes, nil for no progress.
+ @return a Future that resolves with the report once every device has finished.
+ */
+- (FBFuture<FBDeviceSetInstallReport *> *)installApplicationWithPath:(NSString *)path onDevicesMatching:(NSPredicate *)predicate maximumConcurrencyPerHub:(NSUInteger)maximumConcurrencyPerHub incremental:(BOOL)incremental progress:(nullable FBDeviceSetInstallProgress)progress;
+
 #pragma mark Properties
 
 /**
- All of the Available Devices.
+ All of the Available Devices, sorted by unique identifier.
+ This is an immutable snapshot that is replaced whenever a device is attached, detached or updated, so it may be read from any thread.
  */
 @property (nonatomic, copy, readonly) NSArray<FBDevice *> *allDevices;
 
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBControlCore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBDevice;
+@class FBDeviceSet;
+
+/**
+ The outcome of installing an application across many devices.
+ */
+@interface FBDeviceSetInstallReport : NSObject
+
+/**
+ The installed application, keyed by the UDID of each device that it was installed on.
+ */
+@property (nonatomic, copy, readonly) NSDictionary<NSString *, FBInstalledApplication *> *installedApplications;
+
+/**
+ The error, keyed by the UDID of each device that the install failed on.
+ */
+@property (nonatomic, copy, readonly) NSDictionary<NSString *, NSError *> *errors;
+
+/**
+ The number of seconds from the start of preparing the bundle until the last device finished.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval duration;
+
+@end
+
+/**
+ Called as each device finishes, with the aggregate progress so far.
+
+ @param device the device that finished.
+ @param error the error if the install failed on the device, nil if it succeeded.
+ @param completed the number of devices that have finished, successfully or not.
+ @param total the number of devices being installed to.
+ */
+typedef void (^FBDeviceSetInstallProgress)(FBDevice *device, NSError *_Nullable error, NSUInteger completed, NSUInteger total);
+
+/**
+ Installs an application on many devices of a Device Set at once.
+ The bundle is prepared once: an archive is extracted, the bundle is described and its signature is checked, before any device is touched.
+ Devices are grouped by the USB hub that they are attached to, and each hub installs to a limited number of its devices at a time.
+ This means that throughput is bounded by the bandwidth of each hub, rather than by how many installs are started.
+ */
+@interface FBDeviceSetInstaller : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param deviceSet the device set to install to.
+ @param maximumConcurrencyPerHub the number of devices on a single hub that are installed to at the same time. Devices on the network are treated as being on one hub.
+ @param logger the logger to use.
+ @return a new FBDeviceSetInstaller instance.
+ */
++ (instancetype)installerWithDeviceSet:(FBDeviceSet *)deviceSet maximumConcurrencyPerHub:(NSUInteger)maximumConcurrencyPerHub logger:(id<FBControlCoreLogger>)logger;
+
+#pragma mark Public Methods
+
+/**
+ Installs an application on all devices of the set that match a predicate.
+ Failure on one device does not stop the install on others, failures are part of the report.
+
+ @param path the path of an application bundle, or an archive containing one.
+ @param predicate the predicate to select devices with, evaluated against each FBDevice.
+ @param incremental YES to skip devices that already have the same bundle, see -[FBDeviceApplicationCommands installApplicationWithPath:incremental:].
+ @param progress called on an arbitrary queue as each device finishes, nil for no progress.
+ @return a Future that resolves with the report once every device has finished. Fails if the bundle could not be prepared.
+ */
+- (FBFuture<FBDeviceSetInstallReport *> *)installApplicationWithPath:(NSString *)path onDevicesMatching:(NSPredicate *)predicate incremental:(BOOL)incremental progress:(nullable FBDeviceSetInstallProgress)progress;
+
+/**
+ The hub that a device is attached to, used for grouping devices.
+
+ @param device the device.
+ @return an identifier of the hub, that is the same for all devices attached to it.
+ */
++ (NSString *)hubIdentifierForDevice:(FBDevice *)device;
+
+@end
+
+NS_ASSUME_NONNULL_END
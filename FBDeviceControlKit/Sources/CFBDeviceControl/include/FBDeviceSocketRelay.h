@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBControlCore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The counters of a relay, in each direction.
+ Latency is the time from bytes being read until they have all been written to the destination.
+ */
+@interface FBDeviceSocketRelayStatistics : NSObject
+
+/**
+ The number of bytes relayed from the local input to the remote socket.
+ */
+@property (nonatomic, assign, readonly) uint64_t bytesToRemote;
+
+/**
+ The number of bytes relayed from the remote socket to the local output.
+ */
+@property (nonatomic, assign, readonly) uint64_t bytesFromRemote;
+
+/**
+ The mean time that bytes waited in the relay, over both directions.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval averageLatency;
+
+/**
+ The longest time that bytes waited in the relay, over both directions.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval maximumLatency;
+
+@end
+
+/**
+ Relays bytes between local file descriptors and a socket that is connected to a device port.
+ Each direction has a fixed buffer that is re-used for the lifetime of the relay, and reads and writes are made directly on the file descriptors as they become ready.
+ When the destination of a direction cannot accept more bytes, reading from its source is paused until the buffer drains.
+ */
+@interface FBDeviceSocketRelay : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+ The file descriptors are made non-blocking, and are not closed by the relay.
+
+ @param localInput the file descriptor to read bytes for the remote from.
+ @param localOutput the file descriptor to write bytes from the remote to. May be the same as the input.
+ @param remoteSocket the socket connected to the device port.
+ @param logger the logger to use.
+ @return a new FBDeviceSocketRelay instance.
+ */
++ (instancetype)relayWithLocalInput:(int)localInput localOutput:(int)localOutput remoteSocket:(int)remoteSocket logger:(nullable id<FBControlCoreLogger>)logger;
+
+#pragma mark Public Methods
+
+/**
+ Starts relaying.
+ The end of the local input is passed on to the remote as a half-close, and the end of the remote to the local output likewise.
+
+ @return a Future that resolves with the statistics once both directions have ended. Cancelling it stops the relay.
+ */
+- (FBFuture<FBDeviceSocketRelayStatistics *> *)start;
+
+/**
+ The statistics so far.
+ */
+@property (nonatomic, strong, readonly) FBDeviceSocketRelayStatistics *statistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -17,7 +17,8 @@ NS_ASSUME_NONNULL_BEGIN
 #pragma mark Properties
 
 /**
- A mapping of all referenced devices, keyed by identifier.
+ A mapping of all attached devices, keyed by identifier.
+ This is an immutable snapshot that is replaced when a device is attached or detached, so it may be read from any thread without copying.
  */
 @property (nonatomic, copy, readonly) NSDictionary<NSString *, PublicDevice> *attached;
 
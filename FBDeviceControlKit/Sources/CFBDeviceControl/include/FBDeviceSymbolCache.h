@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBControlCore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Populates a directory of the cache, resolving with metadata that is stored alongside it.
+
+ @param directory the directory to populate, which is moved into place once the future resolves.
+ @return a Future that resolves with the metadata of the populated directory.
+ */
+typedef FBFuture<NSDictionary<NSString *, id> *> *_Nonnull (^FBDeviceSymbolCachePopulator)(NSString *directory);
+
+/**
+ A host-level cache of extracted device symbols.
+ Symbols depend only on the OS build and architecture of a device, so entries are shared by all devices on the same build.
+ Concurrent requests for the same entry, such as from many devices on one build attaching at once, share a single population.
+ */
+@interface FBDeviceSymbolCache : NSObject
+
+#pragma mark Initializers
+
+/**
+ The cache in the Caches directory of the user, shared by all device sets in the process.
+ */
+@property (nonatomic, strong, readonly, class) FBDeviceSymbolCache *sharedCache;
+
+/**
+ The Designated Initializer.
+
+ @param rootDirectory the directory that entries are stored in.
+ @param logger the logger to use.
+ @return a new FBDeviceSymbolCache instance.
+ */
++ (instancetype)cacheWithRootDirectory:(NSString *)rootDirectory logger:(id<FBControlCoreLogger>)logger;
+
+#pragma mark Public Methods
+
+/**
+ The key of the entry for a device.
+
+ @param productVersion the 'Product Version' of the device.
+ @param buildVersion the 'Build Version' of the device.
+ @param architecture the CPU architecture of the device.
+ @return the key of the entry.
+ */
++ (NSString *)keyForProductVersion:(NSString *)productVersion buildVersion:(NSString *)buildVersion architecture:(NSString *)architecture;
+
+/**
+ The metadata of a complete entry.
+
+ @param key the key of the entry.
+ @return the metadata, or nil if there is no complete entry for the key.
+ */
+- (nullable NSDictionary<NSString *, id> *)metadataForKey:(NSString *)key;
+
+/**
+ Obtains the directory of an entry, populating it if it is not already in the cache.
+
+ @param key the key of the entry.
+ @param queue the queue to populate on.
+ @param populator populates the entry when it is not in the cache.
+ @return a Future that resolves with the directory of the complete entry.
+ */
+- (FBFuture<NSString *> *)directoryForKey:(NSString *)key onQueue:(dispatch_queue_t)queue populator:(FBDeviceSymbolCachePopulator)populator;
+
+@end
+
+NS_ASSUME_NONNULL_END
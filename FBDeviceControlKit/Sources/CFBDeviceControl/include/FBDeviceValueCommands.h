@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBControlCore.h"
+
+#import "FBDeviceCommands.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A string enum representing lockdown domains, whose values are not obtained when the device is attached.
+ */
+typedef NSString *FBDeviceValueDomain NS_STRING_ENUM;
+extern FBDeviceValueDomain const FBDeviceValueDomainBattery;
+extern FBDeviceValueDomain const FBDeviceValueDomainDeveloper;
+extern FBDeviceValueDomain const FBDeviceValueDomainDiskUsage;
+extern FBDeviceValueDomain const FBDeviceValueDomainMobileBackup;
+
+/**
+ Commands for fetching lockdown values of a device on request.
+ When a device is attached only a minimal set of values is obtained, enough to list and identify the device.
+ All other values are fetched from the device when they are first requested, then cached for a short time.
+ */
+@protocol FBDeviceValueCommands <FBiOSTargetCommand>
+
+/**
+ Obtains a single lockdown value.
+ Values that were obtained when the device was attached resolve without a round-trip to the device.
+
+ @param key the key of the value.
+ @param domain the domain of the value, nil for the default domain.
+ @return a Future that resolves with the value. Fails if the device has no such value.
+ */
+- (FBFuture<id> *)deviceValueForKey:(NSString *)key domain:(nullable FBDeviceValueDomain)domain;
+
+/**
+ Obtains all of the lockdown values in a domain.
+
+ @param domain the domain to obtain.
+ @return a Future that resolves with the values of the domain.
+ */
+- (FBFuture<NSDictionary<NSString *, id> *> *)deviceValuesInDomain:(FBDeviceValueDomain)domain;
+
+/**
+ Discards all cached values, so that the next request for each fetches it from the device.
+ */
+- (void)invalidateCachedDeviceValues;
+
+@end
+
+/**
+ An Implementation of FBDeviceValueCommands.
+ */
+@interface FBDeviceValueCommands : NSObject <FBDeviceValueCommands>
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -11,6 +11,7 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class AVCaptureDevice;
 @class AVCaptureSession;
 @class FBDevice;
 
@@ -29,6 +30,16 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (FBFuture<AVCaptureSession *> *)captureSessionForDevice:(FBDevice *)device;
 
+/**
+ Creates an AVCaptureSession for a screen capture device that has already been found.
+ Access to screen capture devices must already have been allowed.
+
+ @param captureDevice the screen capture device.
+ @param error an error out for any error that occurs.
+ @return A Capture Session if successful, nil otherwise.
+ */
++ (nullable AVCaptureSession *)captureSessionForCaptureDevice:(AVCaptureDevice *)captureDevice error:(NSError **)error;
+
 /**
  A Factory method for obtaining the Video for a Device.
 
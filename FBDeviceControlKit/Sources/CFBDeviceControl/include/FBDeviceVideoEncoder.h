@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+#import <CoreVideo/CoreVideo.h>
+
+#import "FBControlCore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBVideoStreamConfiguration;
+
+/**
+ A block that receives encoded samples.
+ */
+typedef void (^FBDeviceVideoEncoderOutput)(CMSampleBufferRef sampleBuffer);
+
+/**
+ Encodes uncompressed pixel buffers with a VTCompressionSession.
+ The compression session is created lazily from the first pixel buffer, and re-created if the dimensions of the pixel buffers change.
+ Encoded samples are delivered to the output block on the provided queue, in decode order.
+ */
+@interface FBDeviceVideoEncoder : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param codec the codec to encode with, kCMVideoCodecType_H264 or kCMVideoCodecType_HEVC.
+ @param configuration the configuration of the stream, providing the bitrate, key frame interval and rate control options.
+ @param queue the queue to deliver encoded samples on.
+ @param logger the logger to log to.
+ @param output the block to deliver encoded samples to.
+ @return a new Encoder.
+ */
+- (instancetype)initWithCodec:(CMVideoCodecType)codec configuration:(FBVideoStreamConfiguration *)configuration queue:(dispatch_queue_t)queue logger:(id<FBControlCoreLogger>)logger output:(FBDeviceVideoEncoderOutput)output;
+
+#pragma mark Public Methods
+
+/**
+ Encodes a pixel buffer.
+
+ @param pixelBuffer the pixel buffer to encode.
+ @param presentationTimeStamp the presentation time of the pixel buffer.
+ @param duration the duration of the pixel buffer, may be invalid.
+ @param error an error out for any error that occurs.
+ @return YES if the frame was submitted to the encoder, NO otherwise.
+ */
+- (BOOL)encodePixelBuffer:(CVPixelBufferRef)pixelBuffer presentationTimeStamp:(CMTime)presentationTimeStamp duration:(CMTime)duration error:(NSError **)error;
+
+/**
+ Forces the next encoded frame to be a key frame, regardless of the key frame interval.
+ Must be called on the queue that frames are encoded on.
+ */
+- (void)requestKeyFrame;
+
+/**
+ Tears down the compression session, any pending frames are discarded.
+ */
+- (void)invalidate;
+
+#pragma mark Properties
+
+/**
+ The codec being encoded to.
+ */
+@property (nonatomic, assign, readonly) CMVideoCodecType codec;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -18,6 +18,33 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @interface FBDeviceVideoRecordingCommands : NSObject <FBVideoRecordingCommands, FBVideoStreamCommands>
 
+#pragma mark Replay
+
+/**
+ Starts keeping the most recent seconds of the screen in memory, without writing anything to disk.
+ The screen is captured and encoded continuously until the replay buffer is stopped.
+
+ @param window the duration of the screen to keep, in seconds.
+ @param configuration the configuration of the stream to encode, which must use the H264 or HEVC encoding. The average bitrate and the window bound the memory used.
+ @return A Future that resolves when the replay buffer has started.
+ */
+- (FBFuture<NSNull *> *)startReplayBufferWithWindow:(NSTimeInterval)window configuration:(FBVideoStreamConfiguration *)configuration;
+
+/**
+ Writes the contents of the replay buffer to a file, without interrupting capture.
+
+ @param filePath the file path to write to.
+ @return A Future that resolves with the file path once it has been written.
+ */
+- (FBFuture<NSString *> *)saveReplayToFile:(NSString *)filePath;
+
+/**
+ Stops capturing and discards the contents of the replay buffer.
+
+ @return A Future that resolves when capture has stopped.
+ */
+- (FBFuture<NSNull *> *)stopReplayBuffer;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -16,6 +16,9 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  An implementation of FBVideoStream, for Devices.
+ Consumers that conform to FBVideoSurfaceConsumer receive the captured pixel buffers with their presentation time, without copying or locking pixels. This is the case for H264 & HEVC streams as well as BGRA streams, as the uncompressed frames are delivered before they are encoded.
+ Consumers that conform to FBVideoSampleConsumer, such as FBVideoSampleFileWriter, receive the encoded sample buffers of H264 & HEVC streams, so that the stream can be recorded without encoding it a second time.
+ Presenting, recording and streaming can therefore share one capture session, one frame rate limit and one pixel format by attaching their consumers to the same stream.
  */
 @interface FBDeviceVideoStream : NSObject <FBVideoStream>
 
@@ -32,6 +35,54 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (nullable instancetype)streamWithSession:(AVCaptureSession *)session configuration:(FBVideoStreamConfiguration *)configuration logger:(id<FBControlCoreLogger>)logger error:(NSError **)error;
 
+#pragma mark Properties
+
+/**
+ The configuration of the stream.
+ */
+@property (nonatomic, strong, readonly) FBVideoStreamConfiguration *configuration;
+
+#pragma mark Consumers
+
+/**
+ Attaches a consumer to the stream, starting the capture session if this is the first consumer.
+ Each consumer is fed from its own queue, so consumers can be attached and detached whilst streaming without restarting the session.
+ -[FBVideoStream startStreaming:] attaches with the backpressure policy of the configuration.
+
+ @param consumer the consumer to attach.
+ @param policy the backpressure policy for the consumer.
+ @param maxPendingFrames the number of frames that may be queued for the consumer before it is considered congested.
+ @return A future that resolves when the streaming has started.
+ */
+- (FBFuture<NSNull *> *)attachConsumer:(id<FBDataConsumer>)consumer policy:(FBVideoStreamBackpressurePolicy)policy maxPendingFrames:(NSUInteger)maxPendingFrames;
+
+/**
+ Detaches a consumer from the stream. Frames queued for the consumer are discarded, the capture session keeps running.
+
+ @param consumer the consumer to detach.
+ @return A future that resolves when the consumer is detached.
+ */
+- (FBFuture<NSNull *> *)detachConsumer:(id<FBDataConsumer>)consumer;
+
+/**
+ The frame counters of an attached consumer.
+
+ @param consumer the consumer.
+ @return the statistics, or nil if the consumer is not attached.
+ */
+- (nullable FBVideoStreamStatistics *)statisticsForConsumer:(id<FBDataConsumer>)consumer;
+
+#pragma mark Frame Rate
+
+/**
+ Limits the frame rate of the stream below the frame rate of the configuration, whilst streaming.
+ Frames are decimated in software before they reach the consumers, so the capture session doesn't need to be reconfigured or restarted.
+ The limit never raises the frame rate above the frame rate of the configuration.
+
+ @param framesPerSecond the maximum frame rate, or nil to remove the limit.
+ */
+- (void)limitFramesPerSecond:(nullable NSNumber *)framesPerSecond;
+
 @end
 
 NS_ASSUME_NONNULL_END
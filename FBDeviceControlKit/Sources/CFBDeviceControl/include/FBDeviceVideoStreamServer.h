@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBControlCore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBDeviceVideoStream;
+
+/**
+ Serves Device Video Streams to network clients, so that many viewers can watch a single capture session.
+ Each client is attached to the stream as a consumer of its own, written to from its own queue. A client that falls behind has dependent frames dropped until the next key frame, so a slow viewer cannot stall the others.
+ A client that connects whilst the stream is running starts from a key frame, which is requested from the encoder so that it doesn't wait for the key frame interval.
+ Clients are disconnected when they close their connection, when the stream completes, or when the server stops listening.
+ */
+@interface FBDeviceVideoStreamServer : NSObject
+
+#pragma mark Initializers
+
+/**
+ Creates a server that writes the bytes of a stream to every client as-is, which is Annex-B for H264 & HEVC streams and Minicap framing for Minicap streams.
+ Clients receive the stream as soon as they connect, they do not send a request.
+
+ @param port the port to bind against, 0 for any free port.
+ @param stream the stream to serve.
+ @param logger the logger to log to.
+ @return a new server.
+ */
++ (instancetype)tcpServerOnPort:(in_port_t)port stream:(FBDeviceVideoStream *)stream logger:(id<FBControlCoreLogger>)logger;
+
+/**
+ Creates a server that serves streams by the path of an HTTP request.
+ Requests that upgrade to a WebSocket receive each frame of the stream as a binary message, with a Minicap header as a message of its own.
+ Other requests for an MJPEG stream receive a multipart/x-mixed-replace response that browsers render natively. Other requests for any other stream receive the bytes of the stream as the body of the response.
+ Streams are added with -serveStream:atPath:.
+
+ @param port the port to bind against, 0 for any free port.
+ @param logger the logger to log to.
+ @return a new server.
+ */
++ (instancetype)httpServerOnPort:(in_port_t)port logger:(id<FBControlCoreLogger>)logger;
+
+#pragma mark Streams
+
+/**
+ Serves a stream at a path, replacing any stream that was served at the path.
+ A request for "/" is served by the only stream when there is exactly one.
+
+ @param stream the stream to serve.
+ @param path the path of the stream, for instance the UDID of the device.
+ */
+- (void)serveStream:(FBDeviceVideoStream *)stream atPath:(NSString *)path;
+
+/**
+ Stops serving the stream at a path, disconnecting its clients. The stream itself keeps running.
+
+ @param path the path of the stream.
+ */
+- (void)stopServingStreamAtPath:(NSString *)path;
+
+#pragma mark Properties
+
+/**
+ The Port the Server is Bound on.
+ */
+@property (nonatomic, assign, readonly) in_port_t port;
+
+/**
+ The number of clients that are currently connected to a stream.
+ */
+@property (nonatomic, assign, readonly) NSUInteger clientCount;
+
+#pragma mark Public Methods
+
+/**
+ Starts listening for clients.
+
+ @return A future that resolves when listening has started.
+ */
+- (FBFuture<NSNull *> *)startListening;
+
+/**
+ Stops listening for clients, disconnecting those that are connected.
+
+ @return A future that resolves when listening has ended.
+ */
+- (FBFuture<NSNull *> *)stopListening;
+
+/**
+ Starts the server, managed by a context manager.
+
+ @return a FBFutureContext that will stop listening when the context is torn down.
+ */
+- (FBFutureContext<NSNull *> *)startListeningContext;
+
+@end
+
+NS_ASSUME_NONNULL_END
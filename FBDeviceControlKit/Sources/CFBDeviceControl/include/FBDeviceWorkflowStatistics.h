@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBControlCore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The phases of an installation workflow, as reported in its progress.
+ */
+typedef NSString *FBDeviceWorkflowPhase NS_STRING_ENUM;
+
+/**
+ Transferring the bundle to the device and unpacking it there.
+ */
+extern FBDeviceWorkflowPhase const FBDeviceWorkflowPhaseStaging;
+
+/**
+ Inspecting the bundle and verifying its signature.
+ */
+extern FBDeviceWorkflowPhase const FBDeviceWorkflowPhaseVerify;
+
+/**
+ Installing the verified bundle, creating its container and registering it.
+ */
+extern FBDeviceWorkflowPhase const FBDeviceWorkflowPhaseInstall;
+
+/**
+ Collects the progress events of a MobileDevice workflow, such as an install or uninstall.
+ The time spent in each phase of the workflow is derived from the status of each event.
+ */
+@interface FBDeviceWorkflowStatistics : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param workflowType the name of the workflow, for logging.
+ @param logger the logger to log progress to.
+ @return a new FBDeviceWorkflowStatistics instance.
+ */
+- (instancetype)initWithWorkflowType:(NSString *)workflowType logger:(id<FBControlCoreLogger>)logger;
+
+#pragma mark Public Methods
+
+/**
+ Records a progress event from the workflow.
+
+ @param event the progress event.
+ */
+- (void)pushProgress:(NSDictionary<NSString *, id> *)event;
+
+/**
+ Marks the workflow as finished, so that the time of the last phase stops accumulating.
+ */
+- (void)finish;
+
+/**
+ A description of the most recent event, for errors.
+ */
+- (NSString *)summaryOfRecentEvents;
+
+#pragma mark Properties
+
+/**
+ The name of the workflow.
+ */
+@property (nonatomic, copy, readonly) NSString *workflowType;
+
+/**
+ The number of seconds spent in each phase, including the current phase if the workflow is yet to finish.
+ Phases that the workflow did not report are absent.
+ */
+@property (nonatomic, copy, readonly) NSDictionary<FBDeviceWorkflowPhase, NSNumber *> *durationsByPhase;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -14,8 +14,66 @@ NS_ASSUME_NONNULL_BEGIN
 @class FBAMDServiceConnection;
 @class FBApplicationLaunchConfiguration;
 
+/**
+ A sample of the load on the device, from the sysmontap channel.
+ Memory is in pages, as reported by the device.
+ */
+typedef struct {
+  NSTimeInterval timestamp;
+  double cpuTotalLoad;
+  uint32_t cpuCount;
+  uint64_t freePages;
+  uint64_t activePages;
+  uint64_t inactivePages;
+  uint64_t wiredPages;
+  uint64_t compressedPages;
+} FBInstrumentsSystemSample;
+
+/**
+ A sample of the rendering of the device, from the graphics channel.
+ Utilization is a percentage.
+ */
+typedef struct {
+  NSTimeInterval timestamp;
+  double framesPerSecond;
+  double deviceUtilization;
+  double rendererUtilization;
+  double tilerUtilization;
+} FBInstrumentsGraphicsSample;
+
+/**
+ Consumes samples from a telemetry stream, on a serial queue of the stream.
+ */
+@protocol FBInstrumentsSampleConsumer <NSObject>
+
+@optional
+
+/**
+ Consumes a sample from the sysmontap channel.
+
+ @param sample the sample. The timestamp is the time since the reference date that the sample was received.
+ */
+- (void)consumeSystemSample:(FBInstrumentsSystemSample)sample;
+
+/**
+ Consumes a sample from the graphics channel.
+
+ @param sample the sample. The timestamp is the time on the device's GPU clock, in seconds.
+ */
+- (void)consumeGraphicsSample:(FBInstrumentsGraphicsSample)sample;
+
+@required
+
+/**
+ Consumes the end of the stream, after which there are no more samples.
+ */
+- (void)consumeEndOfSamples;
+
+@end
+
 /**
  A client for Instruments.
+ Calls are multiplexed over the one connection: a dedicated reader delivers each reply to the call that is waiting on it, so calls on different channels don't wait on each other.
  */
 @interface FBInstrumentsClient : NSObject
 
@@ -48,6 +106,24 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (FBFuture<NSNull *> *)killProcess:(pid_t)processIdentifier;
 
+/**
+ Streams samples of cpu and memory usage from the sysmontap channel.
+
+ @param interval the interval between samples.
+ @param consumer the consumer of the samples.
+ @return a Future that resolves with the operation once sampling has started. Cancelling the completed future of the operation stops sampling. There is one stream per channel at a time.
+ */
+- (FBFuture<id<FBiOSTargetOperation>> *)streamSystemSamplesWithInterval:(NSTimeInterval)interval consumer:(id<FBInstrumentsSampleConsumer>)consumer;
+
+/**
+ Streams samples of frame rate and GPU utilization from the graphics channel.
+
+ @param interval the interval between samples.
+ @param consumer the consumer of the samples.
+ @return a Future that resolves with the operation once sampling has started. Cancelling the completed future of the operation stops sampling. There is one stream per channel at a time.
+ */
+- (FBFuture<id<FBiOSTargetOperation>> *)streamGraphicsSamplesWithInterval:(NSTimeInterval)interval consumer:(id<FBInstrumentsSampleConsumer>)consumer;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -55,12 +55,31 @@ extern FBWallpaperName const FBWallpaperNameLockscreen;
 
 /**
  Sets the Icon Layout of Springboard.
+ The layout is compared with the one last fetched from or sent to Springboard by the receiver, and is not sent if it is the same.
 
  @param iconLayout the icon layout to set.
  @return a Future that resolves when the icon layout has been set.
  */
 - (FBFuture<NSNull *> *)setIconLayout:(IconLayoutType)iconLayout;
 
+/**
+ Obtains the Icon of an Application.
+ Icons are cached by the receiver, and are fetched again when the version or modification date of the icon in the Icon Layout changes.
+
+ @param bundleID the Bundle ID of the Application.
+ @return a Future with the Image PNG Data.
+ */
+- (FBFuture<NSData *> *)iconImageDataForBundleID:(NSString *)bundleID;
+
+/**
+ Obtains the Icons of several Applications.
+ Icons that aren't cached are requested together, so the batch costs about one round-trip to the device rather than one per icon.
+
+ @param bundleIDs the Bundle IDs of the Applications.
+ @return a Future with the Image PNG Data, keyed by Bundle ID.
+ */
+- (FBFuture<NSDictionary<NSString *, NSData *> *> *)iconImageDataForBundleIDs:(NSArray<NSString *> *)bundleIDs;
+
 /**
  Obtains Wallpaper for the Homescreen.
 
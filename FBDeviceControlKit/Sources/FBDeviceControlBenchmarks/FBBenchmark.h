@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The measurements of one benchmark.
+ */
+@interface FBBenchmarkResult : NSObject
+
+/**
+ The name of the benchmark, which identifies it in a baseline.
+ */
+@property (nonatomic, copy, readonly) NSString *name;
+
+/**
+ The number of frames that were measured.
+ */
+@property (nonatomic, assign, readonly) NSUInteger frameCount;
+
+/**
+ The median and 95th percentile time per frame. For throughput benchmarks these are both the mean.
+ */
+@property (nonatomic, assign, readonly) double medianNanoseconds;
+@property (nonatomic, assign, readonly) double p95Nanoseconds;
+
+/**
+ The mean time per frame.
+ */
+@property (nonatomic, assign, readonly) double meanNanoseconds;
+
+/**
+ The heap allocations made per frame, on any thread.
+ */
+@property (nonatomic, assign, readonly) double allocationsPerFrame;
+
+/**
+ The heap bytes allocated per frame, on any thread. Copies of frame data need a destination, so this is an upper bound on the bytes copied.
+ */
+@property (nonatomic, assign, readonly) double bytesAllocatedPerFrame;
+
+/**
+ The size of the input of each frame.
+ */
+@property (nonatomic, assign, readonly) double inputBytesPerFrame;
+
+/**
+ A JSON compatible representation.
+ */
+@property (nonatomic, copy, readonly) NSDictionary<NSString *, id> *jsonSerializableRepresentation;
+
+@end
+
+/**
+ Measures the cost per frame of a block, in time and in heap allocations.
+ Allocations are counted with the malloc logger, which sees every allocation in the process, so asynchronous work is included as long as it completes within the measurement.
+ */
+@interface FBBenchmark : NSObject
+
+/**
+ Times each frame individually, after a warmup that is not measured.
+
+ @param name the name of the benchmark.
+ @param frameCount the number of frames to measure.
+ @param inputBytesPerFrame the size of the input of each frame.
+ @param setUp called before every frame, outside of the measurement, to prepare its input.
+ @param body called once per frame.
+ @return the result.
+ */
++ (FBBenchmarkResult *)measureName:(NSString *)name frameCount:(NSUInteger)frameCount inputBytesPerFrame:(NSUInteger)inputBytesPerFrame setUp:(nullable void (^)(NSUInteger frame))setUp body:(void (^)(NSUInteger frame))body;
+
+/**
+ Times a batch of frames as a whole, for work that completes asynchronously. The block must not return until every frame has been processed.
+
+ @param name the name of the benchmark.
+ @param frameCount the number of frames that the block processes.
+ @param inputBytesPerFrame the size of the input of each frame.
+ @param batch processes all of the frames.
+ @return the result.
+ */
++ (FBBenchmarkResult *)measureThroughputName:(NSString *)name frameCount:(NSUInteger)frameCount inputBytesPerFrame:(NSUInteger)inputBytesPerFrame batch:(void (^)(void))batch;
+
+/**
+ Compares results against a baseline that was previously written from jsonSerializableRepresentation.
+
+ @param results the results to check.
+ @param baseline the baseline results.
+ @param tolerance the fraction by which time and allocations may regress.
+ @return a description of each regression, empty if there are none.
+ */
++ (NSArray<NSString *> *)regressionsInResults:(NSArray<FBBenchmarkResult *> *)results baseline:(NSArray<NSDictionary<NSString *, id> *> *)baseline tolerance:(double)tolerance;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBBenchmark.h"
+
+#import <mach/mach_time.h>
+#import <stdatomic.h>
+
+// The hook that libmalloc calls for every allocation and free when it is set. It is what stack logging and Instruments use, and is exported although not declared in a public header.
+typedef void (malloc_logger_t)(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numHotFramesToSkip);
+extern malloc_logger_t *malloc_logger;
+
+static const uint32_t MallocLogTypeAllocate = 2;
+static const uint32_t MallocLogTypeDeallocate = 4;
+
+static atomic_bool Tracking;
+static atomic_uint_fast64_t AllocationCount;
+static atomic_uint_fast64_t AllocatedBytes;
+
+static void CountAllocation(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numHotFramesToSkip)
+{
+  if (!atomic_load_explicit(&Tracking, memory_order_relaxed) || (type & MallocLogTypeAllocate) == 0) {
+    return;
+  }
+  // A reallocation is logged as both, with the new size in the third argument.
+  uint64_t size = (type & MallocLogTypeDeallocate) ? arg3 : arg2;
+  atomic_fetch_add_explicit(&AllocationCount, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&AllocatedBytes, size, memory_order_relaxed);
+}
+
+static void StartTracking(void)
+{
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    malloc_logger = CountAllocation;
+  });
+  atomic_store(&AllocationCount, 0);
+  atomic_store(&AllocatedBytes, 0);
+  atomic_store(&Tracking, true);
+}
+
+static void PauseTracking(void)
+{
+  atomic_store(&Tracking, false);
+}
+
+static void ResumeTracking(void)
+{
+  atomic_store(&Tracking, true);
+}
+
+static uint64_t NanosecondsFromAbsoluteTime(uint64_t absoluteTime)
+{
+  static mach_timebase_info_data_t timebase;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    mach_timebase_info(&timebase);
+  });
+  return absoluteTime * timebase.numer / timebase.denom;
+}
+
+static int CompareDoubles(const void *left, const void *right)
+{
+  double a = *(const double *) left;
+  double b = *(const double *) right;
+  return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+static const NSUInteger WarmupFrameCount = 16;
+
+@implementation FBBenchmarkResult
+
+- (instancetype)initWithName:(NSString *)name frameCount:(NSUInteger)frameCount medianNanoseconds:(double)medianNanoseconds p95Nanoseconds:(double)p95Nanoseconds meanNanoseconds:(double)meanNanoseconds inputBytesPerFrame:(double)inputBytesPerFrame
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _name = [name copy];
+  _frameCount = frameCount;
+  _medianNanoseconds = medianNanoseconds;
+  _p95Nanoseconds = p95Nanoseconds;
+  _meanNanoseconds = meanNanoseconds;
+  _inputBytesPerFrame = inputBytesPerFrame;
+  // Read once the measurement has stopped.
+  _allocationsPerFrame = (double) atomic_load(&AllocationCount) / (double) frameCount;
+  _bytesAllocatedPerFrame = (double) atomic_load(&AllocatedBytes) / (double) frameCount;
+
+  return self;
+}
+
+- (NSDictionary<NSString *, id> *)jsonSerializableRepresentation
+{
+  return @{
+    @"name": self.name,
+    @"frames": @(self.frameCount),
+    @"median_ns": @(self.medianNanoseconds),
+    @"p95_ns": @(self.p95Nanoseconds),
+    @"mean_ns": @(self.meanNanoseconds),
+    @"allocations_per_frame": @(self.allocationsPerFrame),
+    @"bytes_allocated_per_frame": @(self.bytesAllocatedPerFrame),
+    @"input_bytes_per_frame": @(self.inputBytesPerFrame),
+  };
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"%-48@ %10.0f ns median %10.0f ns p95 %8.1f allocs/frame %12.0f B alloc/frame %10.0f B in/frame", self.name, self.medianNanoseconds, self.p95Nanoseconds, self.allocationsPerFrame, self.bytesAllocatedPerFrame, self.inputBytesPerFrame];
+}
+
+@end
+
+@implementation FBBenchmark
+
++ (FBBenchmarkResult *)measureName:(NSString *)name frameCount:(NSUInteger)frameCount inputBytesPerFrame:(NSUInteger)inputBytesPerFrame setUp:(nullable void (^)(NSUInteger frame))setUp body:(void (^)(NSUInteger frame))body
+{
+  for (NSUInteger frame = 0; frame < WarmupFrameCount; frame++) {
+    @autoreleasepool {
+      if (setUp) {
+        setUp(frame);
+      }
+      body(frame);
+    }
+  }
+
+  double *samples = calloc(frameCount, sizeof(double));
+  double total = 0;
+  StartTracking();
+  for (NSUInteger frame = 0; frame < frameCount; frame++) {
+    @autoreleasepool {
+      if (setUp) {
+        PauseTracking();
+        setUp(frame);
+        ResumeTracking();
+      }
+      uint64_t start = mach_absolute_time();
+      body(frame);
+      samples[frame] = (double) NanosecondsFromAbsoluteTime(mach_absolute_time() - start);
+      total += samples[frame];
+    }
+  }
+  PauseTracking();
+
+  qsort(samples, frameCount, sizeof(double), CompareDoubles);
+  double median = samples[frameCount / 2];
+  double p95 = samples[MIN(frameCount - 1, (NSUInteger) ((double) frameCount * 0.95))];
+  free(samples);
+  return [[FBBenchmarkResult alloc] initWithName:name frameCount:frameCount medianNanoseconds:median p95Nanoseconds:p95 meanNanoseconds:total / (double) frameCount inputBytesPerFrame:inputBytesPerFrame];
+}
+
++ (FBBenchmarkResult *)measureThroughputName:(NSString *)name frameCount:(NSUInteger)frameCount inputBytesPerFrame:(NSUInteger)inputBytesPerFrame batch:(void (^)(void))batch
+{
+  @autoreleasepool {
+    batch();
+  }
+  StartTracking();
+  uint64_t start = mach_absolute_time();
+  @autoreleasepool {
+    batch();
+  }
+  double mean = (double) NanosecondsFromAbsoluteTime(mach_absolute_time() - start) / (double) frameCount;
+  PauseTracking();
+  return [[FBBenchmarkResult alloc] initWithName:name frameCount:frameCount medianNanoseconds:mean p95Nanoseconds:mean meanNanoseconds:mean inputBytesPerFrame:inputBytesPerFrame];
+}
+
++ (NSArray<NSString *> *)regressionsInResults:(NSArray<FBBenchmarkResult *> *)results baseline:(NSArray<NSDictionary<NSString *, id> *> *)baseline tolerance:(double)tolerance
+{
+  NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> *baselineByName = [NSMutableDictionary dictionary];
+  for (NSDictionary<NSString *, id> *entry in baseline) {
+    baselineByName[entry[@"name"]] = entry;
+  }
+  NSMutableArray<NSString *> *regressions = [NSMutableArray array];
+  for (FBBenchmarkResult *result in results) {
+    NSDictionary<NSString *, id> *entry = baselineByName[result.name];
+    if (!entry) {
+      continue;
+    }
+    double baselineMedian = [entry[@"median_ns"] doubleValue];
+    if (result.medianNanoseconds > baselineMedian * (1 + tolerance)) {
+      [regressions addObject:[NSString stringWithFormat:@"%@: %.0f ns per frame, baseline %.0f ns", result.name, result.medianNanoseconds, baselineMedian]];
+    }
+    // Allocation counts are close to deterministic, so a small absolute allowance absorbs the noise of system frameworks.
+    double baselineAllocations = [entry[@"allocations_per_frame"] doubleValue];
+    if (result.allocationsPerFrame > baselineAllocations * (1 + tolerance) + 0.5) {
+      [regressions addObject:[NSString stringWithFormat:@"%@: %.1f allocations per frame, baseline %.1f", result.name, result.allocationsPerFrame, baselineAllocations]];
+    }
+    double baselineBytes = [entry[@"bytes_allocated_per_frame"] doubleValue];
+    if (result.bytesAllocatedPerFrame > baselineBytes * (1 + tolerance) + 1024) {
+      [regressions addObject:[NSString stringWithFormat:@"%@: %.0f bytes allocated per frame, baseline %.0f", result.name, result.bytesAllocatedPerFrame, baselineBytes]];
+    }
+  }
+  return regressions;
+}
+
+@end
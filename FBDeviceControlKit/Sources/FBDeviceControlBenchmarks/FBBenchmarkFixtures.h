@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Synthetic frames at a given resolution, produced once and reused by every benchmark.
+ The H264 frames are real encoder output, so that the sizes and NAL unit layout match a device stream.
+ */
+@interface FBBenchmarkFixtures : NSObject
+
+#pragma mark Initializers
+
+/**
+ Encodes the fixtures.
+
+ @param width the width of the frames.
+ @param height the height of the frames.
+ @param frameCount the number of distinct frames, the first of which is a key frame.
+ @param error an error out for any error that occurs.
+ @return the fixtures, or nil if encoding failed.
+ */
++ (nullable instancetype)fixturesWithWidth:(int32_t)width height:(int32_t)height frameCount:(NSUInteger)frameCount error:(NSError **)error;
+
+#pragma mark Properties
+
+/**
+ A label for the resolution, such as "1080p".
+ */
+@property (nonatomic, copy, readonly) NSString *label;
+
+/**
+ The number of distinct frames.
+ */
+@property (nonatomic, assign, readonly) NSUInteger frameCount;
+
+/**
+ The average size of an encoded H264 frame.
+ */
+@property (nonatomic, assign, readonly) NSUInteger averageEncodedFrameSize;
+
+/**
+ A JPEG image of the first frame.
+ */
+@property (nonatomic, copy, readonly) NSData *jpegData;
+
+#pragma mark Public Methods
+
+/**
+ Creates a sample buffer for an encoded frame, in AVCC format with its format description.
+ A new sample buffer with its own copy of the bytes is created on every call, since writing a sample to an Annex-B stream rewrites it in place.
+
+ @param index the index of the frame, modulo the number of frames.
+ @return a new sample buffer, which the caller must release.
+ */
+- (CMSampleBufferRef)createEncodedSampleBufferAtIndex:(NSUInteger)index CF_RETURNS_RETAINED;
+
+/**
+ Creates a block buffer containing the JPEG image.
+
+ @return a new block buffer, which the caller must release.
+ */
+- (CMBlockBufferRef)createJPEGBlockBuffer CF_RETURNS_RETAINED;
+
+/**
+ The bytes of an encoded frame, for benchmarks of byte consumers.
+
+ @param index the index of the frame, modulo the number of frames.
+ @return the bytes of the frame.
+ */
+- (NSData *)encodedFrameDataAtIndex:(NSUInteger)index;
+
+@end
+
+NS_ASSUME_NONNULL_END
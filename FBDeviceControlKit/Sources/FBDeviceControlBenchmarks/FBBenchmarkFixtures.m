@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBBenchmarkFixtures.h"
+
+#import <CoreVideo/CoreVideo.h>
+#import <ImageIO/ImageIO.h>
+#import <VideoToolbox/VideoToolbox.h>
+
+static NSError *FixtureError(NSString *description, OSStatus status)
+{
+  return [NSError errorWithDomain:@"com.facebook.fbdevicecontrol.benchmarks" code:status userInfo:@{
+    NSLocalizedDescriptionKey: [NSString stringWithFormat:@"%@ (%d)", description, status],
+  }];
+}
+
+// A gradient that scrolls with the frame index, with a band of noise so that every frame has detail to encode, as a device screen with an animation would.
+static void FillPixels(uint8_t *pixels, size_t width, size_t height, size_t bytesPerRow, NSUInteger frame)
+{
+  uint32_t seed = (uint32_t) frame * 2654435761u + 1;
+  for (size_t y = 0; y < height; y++) {
+    uint8_t *row = pixels + y * bytesPerRow;
+    BOOL noisy = y % 64 < 8;
+    for (size_t x = 0; x < width; x++) {
+      uint8_t value = (uint8_t) (x + y + frame * 4);
+      if (noisy) {
+        seed = seed * 1664525u + 1013904223u;
+        value = (uint8_t) (seed >> 24);
+      }
+      row[x * 4 + 0] = value;
+      row[x * 4 + 1] = (uint8_t) (value + 85);
+      row[x * 4 + 2] = (uint8_t) (value + 170);
+      row[x * 4 + 3] = 0xFF;
+    }
+  }
+}
+
+@interface FBBenchmarkFixtures ()
+
+@property (nonatomic, copy, readonly) NSArray<NSData *> *encodedFrames;
+@property (nonatomic, copy, readonly) NSArray<NSNumber *> *keyFrames;
+
+@end
+
+@implementation FBBenchmarkFixtures
+{
+  CMVideoFormatDescriptionRef _formatDescription;
+}
+
+#pragma mark Initializers
+
++ (nullable instancetype)fixturesWithWidth:(int32_t)width height:(int32_t)height frameCount:(NSUInteger)frameCount error:(NSError **)error
+{
+  NSDictionary<NSString *, id> *pixelBufferAttributes = @{
+    (NSString *) kCVPixelBufferIOSurfacePropertiesKey: @{},
+  };
+  CVPixelBufferRef pixelBuffer = NULL;
+  CVReturn pixelBufferStatus = CVPixelBufferCreate(kCFAllocatorDefault, (size_t) width, (size_t) height, kCVPixelFormatType_32BGRA, (__bridge CFDictionaryRef) pixelBufferAttributes, &pixelBuffer);
+  if (pixelBufferStatus != kCVReturnSuccess) {
+    if (error) {
+      *error = FixtureError(@"Failed to create pixel buffer", pixelBufferStatus);
+    }
+    return nil;
+  }
+
+  VTCompressionSessionRef session = NULL;
+  OSStatus status = VTCompressionSessionCreate(kCFAllocatorDefault, width, height, kCMVideoCodecType_H264, NULL, NULL, NULL, NULL, NULL, &session);
+  if (status != noErr) {
+    CVPixelBufferRelease(pixelBuffer);
+    if (error) {
+      *error = FixtureError(@"Failed to create compression session", status);
+    }
+    return nil;
+  }
+  // Settings in line with those of a device stream, with a single key frame at the start of the fixtures.
+  int32_t bitrate = width * height >= 3840 * 2160 ? 20000000 : 8000000;
+  VTSessionSetProperty(session, kVTCompressionPropertyKey_RealTime, kCFBooleanTrue);
+  VTSessionSetProperty(session, kVTCompressionPropertyKey_AllowFrameReordering, kCFBooleanFalse);
+  VTSessionSetProperty(session, kVTCompressionPropertyKey_ProfileLevel, kVTProfileLevel_H264_High_AutoLevel);
+  VTSessionSetProperty(session, kVTCompressionPropertyKey_AverageBitRate, (__bridge CFNumberRef) @(bitrate));
+  VTSessionSetProperty(session, kVTCompressionPropertyKey_ExpectedFrameRate, (__bridge CFNumberRef) @60);
+  VTSessionSetProperty(session, kVTCompressionPropertyKey_MaxKeyFrameInterval, (__bridge CFNumberRef) @(frameCount));
+
+  NSMutableArray<NSData *> *encodedFrames = [NSMutableArray array];
+  NSMutableArray<NSNumber *> *keyFrames = [NSMutableArray array];
+  __block CMVideoFormatDescriptionRef formatDescription = NULL;
+  for (NSUInteger frame = 0; frame < frameCount; frame++) {
+    CVPixelBufferLockBaseAddress(pixelBuffer, 0);
+    FillPixels(CVPixelBufferGetBaseAddress(pixelBuffer), (size_t) width, (size_t) height, CVPixelBufferGetBytesPerRow(pixelBuffer), frame);
+    CVPixelBufferUnlockBaseAddress(pixelBuffer, 0);
+    NSDictionary<NSString *, id> *frameProperties = frame == 0 ? @{(NSString *) kVTEncodeFrameOptionKey_ForceKeyFrame: @YES} : nil;
+    status = VTCompressionSessionEncodeFrameWithOutputHandler(session, pixelBuffer, CMTimeMake((int64_t) frame, 60), CMTimeMake(1, 60), (__bridge CFDictionaryRef) frameProperties, NULL, ^(OSStatus outputStatus, VTEncodeInfoFlags infoFlags, CMSampleBufferRef sampleBuffer) {
+      if (outputStatus != noErr || !sampleBuffer) {
+        return;
+      }
+      CMBlockBufferRef dataBuffer = CMSampleBufferGetDataBuffer(sampleBuffer);
+      NSMutableData *data = [NSMutableData dataWithLength:CMBlockBufferGetDataLength(dataBuffer)];
+      CMBlockBufferCopyDataBytes(dataBuffer, 0, data.length, data.mutableBytes);
+      [encodedFrames addObject:data];
+      CFArrayRef attachments = CMSampleBufferGetSampleAttachmentsArray(sampleBuffer, false);
+      BOOL notSync = attachments && CFArrayGetCount(attachments) > 0 && CFDictionaryContainsKey(CFArrayGetValueAtIndex(attachments, 0), kCMSampleAttachmentKey_NotSync);
+      [keyFrames addObject:@(!notSync)];
+      if (!formatDescription) {
+        formatDescription = (CMVideoFormatDescriptionRef) CFRetain(CMSampleBufferGetFormatDescription(sampleBuffer));
+      }
+    });
+    if (status != noErr) {
+      break;
+    }
+    // Encoding one frame at a time keeps the output in order and the memory of the session bounded.
+    VTCompressionSessionCompleteFrames(session, kCMTimeInvalid);
+  }
+  VTCompressionSessionInvalidate(session);
+  CFRelease(session);
+
+  if (status != noErr || !formatDescription || encodedFrames.count == 0) {
+    CVPixelBufferRelease(pixelBuffer);
+    if (formatDescription) {
+      CFRelease(formatDescription);
+    }
+    if (error) {
+      *error = FixtureError(@"Failed to encode fixtures", status);
+    }
+    return nil;
+  }
+
+  NSData *jpegData = [self jpegDataFromPixelBuffer:pixelBuffer error:error];
+  CVPixelBufferRelease(pixelBuffer);
+  if (!jpegData) {
+    CFRelease(formatDescription);
+    return nil;
+  }
+
+  NSString *label = [NSString stringWithFormat:@"%dp", MIN(width, height)];
+  FBBenchmarkFixtures *fixtures = [[self alloc] initWithLabel:label formatDescription:formatDescription encodedFrames:encodedFrames keyFrames:keyFrames jpegData:jpegData];
+  CFRelease(formatDescription);
+  return fixtures;
+}
+
++ (nullable NSData *)jpegDataFromPixelBuffer:(CVPixelBufferRef)pixelBuffer error:(NSError **)error
+{
+  CVPixelBufferLockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+  CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+  CGContextRef context = CGBitmapContextCreate(CVPixelBufferGetBaseAddress(pixelBuffer), CVPixelBufferGetWidth(pixelBuffer), CVPixelBufferGetHeight(pixelBuffer), 8, CVPixelBufferGetBytesPerRow(pixelBuffer), colorSpace, kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little);
+  CGImageRef image = context ? CGBitmapContextCreateImage(context) : NULL;
+  CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+  CGColorSpaceRelease(colorSpace);
+  if (context) {
+    CGContextRelease(context);
+  }
+  if (!image) {
+    if (error) {
+      *error = FixtureError(@"Failed to create image", 0);
+    }
+    return nil;
+  }
+
+  NSMutableData *data = [NSMutableData data];
+  CGImageDestinationRef destination = CGImageDestinationCreateWithData((__bridge CFMutableDataRef) data, CFSTR("public.jpeg"), 1, NULL);
+  CGImageDestinationAddImage(destination, image, (__bridge CFDictionaryRef) @{(NSString *) kCGImageDestinationLossyCompressionQuality: @0.7});
+  BOOL finalized = CGImageDestinationFinalize(destination);
+  CFRelease(destination);
+  CGImageRelease(image);
+  if (!finalized) {
+    if (error) {
+      *error = FixtureError(@"Failed to encode JPEG", 0);
+    }
+    return nil;
+  }
+  return data;
+}
+
+- (instancetype)initWithLabel:(NSString *)label formatDescription:(CMVideoFormatDescriptionRef)formatDescription encodedFrames:(NSArray<NSData *> *)encodedFrames keyFrames:(NSArray<NSNumber *> *)keyFrames jpegData:(NSData *)jpegData
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _label = [label copy];
+  _formatDescription = (CMVideoFormatDescriptionRef) CFRetain(formatDescription);
+  _encodedFrames = [encodedFrames copy];
+  _keyFrames = [keyFrames copy];
+  _jpegData = [jpegData copy];
+
+  return self;
+}
+
+- (void)dealloc
+{
+  CFRelease(_formatDescription);
+}
+
+#pragma mark Properties
+
+- (NSUInteger)frameCount
+{
+  return self.encodedFrames.count;
+}
+
+- (NSUInteger)averageEncodedFrameSize
+{
+  NSUInteger total = 0;
+  for (NSData *frame in self.encodedFrames) {
+    total += frame.length;
+  }
+  return total / self.encodedFrames.count;
+}
+
+#pragma mark Public Methods
+
+- (CMSampleBufferRef)createEncodedSampleBufferAtIndex:(NSUInteger)index
+{
+  NSUInteger frame = index % self.encodedFrames.count;
+  NSData *data = self.encodedFrames[frame];
+  CMBlockBufferRef dataBuffer = NULL;
+  CMBlockBufferCreateWithMemoryBlock(kCFAllocatorDefault, NULL, data.length, kCFAllocatorDefault, NULL, 0, data.length, kCMBlockBufferAssureMemoryNowFlag, &dataBuffer);
+  CMBlockBufferReplaceDataBytes(data.bytes, dataBuffer, 0, data.length);
+
+  CMSampleTimingInfo timing = {
+    .duration = CMTimeMake(1, 60),
+    .presentationTimeStamp = CMTimeMake((int64_t) index, 60),
+    .decodeTimeStamp = kCMTimeInvalid,
+  };
+  size_t sampleSize = data.length;
+  CMSampleBufferRef sampleBuffer = NULL;
+  CMSampleBufferCreateReady(kCFAllocatorDefault, dataBuffer, _formatDescription, 1, 1, &timing, 1, &sampleSize, &sampleBuffer);
+  CFRelease(dataBuffer);
+
+  if (!self.keyFrames[frame].boolValue) {
+    CFArrayRef attachments = CMSampleBufferGetSampleAttachmentsArray(sampleBuffer, true);
+    CFDictionarySetValue((CFMutableDictionaryRef) CFArrayGetValueAtIndex(attachments, 0), kCMSampleAttachmentKey_NotSync, kCFBooleanTrue);
+  }
+  return sampleBuffer;
+}
+
+- (CMBlockBufferRef)createJPEGBlockBuffer
+{
+  NSData *data = self.jpegData;
+  CMBlockBufferRef blockBuffer = NULL;
+  CMBlockBufferCreateWithMemoryBlock(kCFAllocatorDefault, NULL, data.length, kCFAllocatorDefault, NULL, 0, data.length, kCMBlockBufferAssureMemoryNowFlag, &blockBuffer);
+  CMBlockBufferReplaceDataBytes(data.bytes, blockBuffer, 0, data.length);
+  return blockBuffer;
+}
+
+- (NSData *)encodedFrameDataAtIndex:(NSUInteger)index
+{
+  return self.encodedFrames[index % self.encodedFrames.count];
+}
+
+@end
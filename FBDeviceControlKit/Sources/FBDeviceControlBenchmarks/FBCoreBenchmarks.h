@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBBenchmark.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Benchmarks of the primitives that everything else is built on: future composition, buffer consumption, asynchronous consumers and logging.
+ These need no fixtures, so they are run once rather than per resolution, and provide the baselines for changes to the primitives themselves.
+ */
+@interface FBCoreBenchmarks : NSObject
+
+/**
+ Runs the benchmarks.
+
+ @param frameCount the number of frames to measure in each benchmark.
+ @param filter only benchmarks whose name contains this are run, all are run if nil.
+ @return the results.
+ */
++ (NSArray<FBBenchmarkResult *> *)runWithFrameCount:(NSUInteger)frameCount filter:(nullable NSString *)filter;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBCoreBenchmarks.h"
+
+#import <fcntl.h>
+
+#import "FBControlCore.h"
+
+// A line of typical tool output, such as a syslog line.
+static const NSUInteger LineLength = 120;
+
+static NSData *LinesOfLength(NSUInteger lineLength, NSUInteger totalLength)
+{
+  NSMutableData *data = [NSMutableData dataWithCapacity:totalLength];
+  NSMutableData *line = [NSMutableData dataWithLength:lineLength];
+  memset(line.mutableBytes, 'a', lineLength - 1);
+  ((uint8_t *) line.mutableBytes)[lineLength - 1] = '\n';
+  while (data.length + lineLength <= totalLength) {
+    [data appendData:line];
+  }
+  return data;
+}
+
+static NSString *SizeLabel(NSUInteger size)
+{
+  return size >= 1024 * 1024 ? [NSString stringWithFormat:@"%luM", (unsigned long) (size / (1024 * 1024))] : [NSString stringWithFormat:@"%luK", (unsigned long) (size / 1024)];
+}
+
+// Blocks until a future resolves, which for a chain is on the queue of its last link, so the time includes every hop along the chain.
+static void WaitForFuture(FBFuture *future)
+{
+  dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+  [future notifyOfCompletionInline:^(FBFuture *_) {
+    dispatch_semaphore_signal(semaphore);
+  }];
+  dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+}
+
+@implementation FBCoreBenchmarks
+
++ (NSArray<FBBenchmarkResult *> *)runWithFrameCount:(NSUInteger)frameCount filter:(nullable NSString *)filter
+{
+  NSMutableArray<FBBenchmarkResult *> *results = [NSMutableArray array];
+  BOOL (^included)(NSString *) = ^ BOOL (NSString *name) {
+    return filter.length == 0 || [name containsString:filter];
+  };
+  void (^record)(FBBenchmarkResult *) = ^(FBBenchmarkResult *result) {
+    NSLog(@"%@", result);
+    [results addObject:result];
+  };
+
+  [self runFutureBenchmarksWithFrameCount:frameCount included:included record:record];
+  [self runDataBufferBenchmarksWithFrameCount:frameCount included:included record:record];
+  [self runConsumerBenchmarksWithFrameCount:frameCount included:included record:record];
+  [self runLoggerBenchmarksWithFrameCount:frameCount included:included record:record];
+  [self runErrorBenchmarksWithFrameCount:frameCount included:included record:record];
+  return results;
+}
+
+#pragma mark Private
+
++ (void)runFutureBenchmarksWithFrameCount:(NSUInteger)frameCount included:(BOOL (^)(NSString *))included record:(void (^)(FBBenchmarkResult *))record
+{
+  dispatch_queue_t queue = dispatch_queue_create("com.facebook.fbdevicecontrol.benchmarks.future", DISPATCH_QUEUE_SERIAL);
+  NSDictionary<NSString *, FBFuture * (^)(FBFuture *)> *links = @{
+    @"map": ^(FBFuture *future) {
+      return [future onQueue:queue map:^(NSNumber *value) {
+        return @(value.unsignedIntegerValue + 1);
+      }];
+    },
+    @"fmap": ^(FBFuture *future) {
+      return [future onQueue:queue fmap:^(NSNumber *value) {
+        return [FBFuture futureWithResult:@(value.unsignedIntegerValue + 1)];
+      }];
+    },
+    @"chain": ^(FBFuture *future) {
+      return [future onQueue:queue chain:^(FBFuture *completed) {
+        return completed;
+      }];
+    },
+  };
+  // Each frame creates a future, registers inline handlers and resolves it, which isolates the per-future allocations and locking from any queue hop.
+  for (NSNumber *count in @[@1, @2, @4]) {
+    NSString *name = [NSString stringWithFormat:@"future.resolve.handlers%@", count];
+    if (!included(name)) {
+      continue;
+    }
+    __block NSUInteger called = 0;
+    void (^handler)(FBFuture *) = ^(FBFuture *_) {
+      called++;
+    };
+    record([FBBenchmark measureName:name frameCount:frameCount inputBytesPerFrame:0 setUp:nil body:^(NSUInteger frame) {
+      FBMutableFuture<NSNumber *> *future = FBMutableFuture.future;
+      for (NSUInteger index = 0; index < count.unsignedIntegerValue; index++) {
+        [future notifyOfCompletionInline:handler];
+      }
+      [future resolveWithResult:@0];
+    }]);
+  }
+  // Each frame builds a chain on an unresolved future, then times the resolution propagating to the end of the chain.
+  for (NSString *operation in [links.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+    FBFuture * (^link)(FBFuture *) = links[operation];
+    for (NSNumber *depth in @[@1, @8, @64]) {
+      NSString *name = [NSString stringWithFormat:@"future.%@.depth%@", operation, depth];
+      if (!included(name)) {
+        continue;
+      }
+      __block FBMutableFuture<NSNumber *> *head = nil;
+      __block FBFuture *tail = nil;
+      record([FBBenchmark measureName:name frameCount:frameCount inputBytesPerFrame:0 setUp:^(NSUInteger frame) {
+        head = FBMutableFuture.future;
+        tail = head;
+        for (NSUInteger index = 0; index < depth.unsignedIntegerValue; index++) {
+          tail = link(tail);
+        }
+      } body:^(NSUInteger frame) {
+        [head resolveWithResult:@0];
+        WaitForFuture(tail);
+      }]);
+    }
+  }
+  for (NSNumber *count in @[@1, @8, @64]) {
+    NSString *name = [NSString stringWithFormat:@"future.futureWithFutures.count%@", count];
+    if (!included(name)) {
+      continue;
+    }
+    __block NSArray<FBMutableFuture<NSNumber *> *> *futures = nil;
+    __block FBFuture *combined = nil;
+    record([FBBenchmark measureName:name frameCount:frameCount inputBytesPerFrame:0 setUp:^(NSUInteger frame) {
+      NSMutableArray<FBMutableFuture<NSNumber *> *> *created = [NSMutableArray array];
+      for (NSUInteger index = 0; index < count.unsignedIntegerValue; index++) {
+        [created addObject:FBMutableFuture.future];
+      }
+      futures = created;
+      combined = [FBFuture futureWithFutures:created];
+    } body:^(NSUInteger frame) {
+      for (FBMutableFuture<NSNumber *> *future in futures) {
+        [future resolveWithResult:@0];
+      }
+      WaitForFuture(combined);
+    }]);
+  }
+}
+
++ (void)runDataBufferBenchmarksWithFrameCount:(NSUInteger)frameCount included:(BOOL (^)(NSString *))included record:(void (^)(FBBenchmarkResult *))record
+{
+  NSData *terminal = [@"\r\n--BoundaryString\r\n" dataUsingEncoding:NSASCIIStringEncoding];
+  // A frame is a buffer of the given size, fed in one go and then drained by the consume pattern.
+  for (NSNumber *size in @[@(4 * 1024), @(64 * 1024), @(1024 * 1024)]) {
+    NSUInteger bufferSize = size.unsignedIntegerValue;
+    NSString *label = SizeLabel(bufferSize);
+    NSData *lines = LinesOfLength(LineLength, bufferSize);
+
+    NSString *linesName = [NSString stringWithFormat:@"databuffer.lines/%@", label];
+    if (included(linesName)) {
+      id<FBConsumableBuffer> buffer = FBDataBuffer.consumableBuffer;
+      record([FBBenchmark measureName:linesName frameCount:frameCount inputBytesPerFrame:lines.length setUp:nil body:^(NSUInteger frame) {
+        [buffer consumeData:lines];
+        while ([buffer consumeLineData]) {
+        }
+      }]);
+    }
+
+    NSString *lengthName = [NSString stringWithFormat:@"databuffer.consumeLength.%lu/%@", (unsigned long) LineLength, label];
+    if (included(lengthName)) {
+      id<FBConsumableBuffer> buffer = FBDataBuffer.consumableBuffer;
+      record([FBBenchmark measureName:lengthName frameCount:frameCount inputBytesPerFrame:lines.length setUp:nil body:^(NSUInteger frame) {
+        [buffer consumeData:lines];
+        while ([buffer consumeLength:LineLength]) {
+        }
+      }]);
+    }
+
+    NSString *untilName = [NSString stringWithFormat:@"databuffer.consumeUntil/%@", label];
+    if (included(untilName)) {
+      id<FBConsumableBuffer> buffer = FBDataBuffer.consumableBuffer;
+      NSMutableData *part = [NSMutableData dataWithLength:bufferSize - terminal.length];
+      [part appendData:terminal];
+      record([FBBenchmark measureName:untilName frameCount:frameCount inputBytesPerFrame:part.length setUp:nil body:^(NSUInteger frame) {
+        [buffer consumeData:part];
+        [buffer consumeUntil:terminal];
+      }]);
+    }
+  }
+}
+
++ (void)runConsumerBenchmarksWithFrameCount:(NSUInteger)frameCount included:(BOOL (^)(NSString *))included record:(void (^)(FBBenchmarkResult *))record
+{
+  // Small chunks, as from a pipe of tool output, where the per-chunk overhead of the consumer dominates.
+  for (NSNumber *size in @[@(LineLength), @(16 * 1024)]) {
+    NSUInteger chunkSize = size.unsignedIntegerValue;
+    NSString *name = [NSString stringWithFormat:@"consumer.async.block/%luB", (unsigned long) chunkSize];
+    if (!included(name)) {
+      continue;
+    }
+    NSData *chunk = [NSMutableData dataWithLength:chunkSize];
+    dispatch_group_t group = dispatch_group_create();
+    id<FBDataConsumer> consumer = [FBBlockDataConsumer asynchronousDataConsumerWithBlock:^(NSData *data) {
+      dispatch_group_leave(group);
+    }];
+    record([FBBenchmark measureThroughputName:name frameCount:frameCount inputBytesPerFrame:chunkSize batch:^{
+      for (NSUInteger frame = 0; frame < frameCount; frame++) {
+        dispatch_group_enter(group);
+        [consumer consumeData:chunk];
+      }
+      dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    }]);
+  }
+
+  NSString *linesName = @"consumer.async.lines";
+  if (included(linesName)) {
+    NSData *lines = LinesOfLength(LineLength, 16 * 1024);
+    NSUInteger linesPerChunk = lines.length / LineLength;
+    dispatch_group_t group = dispatch_group_create();
+    id<FBDataConsumer> consumer = [FBBlockDataConsumer asynchronousLineConsumerWithBlock:^(NSString *line) {
+      dispatch_group_leave(group);
+    }];
+    NSUInteger chunkCount = MAX((NSUInteger) 1, frameCount / linesPerChunk);
+    record([FBBenchmark measureThroughputName:linesName frameCount:chunkCount * linesPerChunk inputBytesPerFrame:LineLength batch:^{
+      for (NSUInteger chunk = 0; chunk < chunkCount; chunk++) {
+        for (NSUInteger line = 0; line < linesPerChunk; line++) {
+          dispatch_group_enter(group);
+        }
+        [consumer consumeData:lines];
+      }
+      dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    }]);
+  }
+}
+
++ (void)runLoggerBenchmarksWithFrameCount:(NSUInteger)frameCount included:(BOOL (^)(NSString *))included record:(void (^)(FBBenchmarkResult *))record
+{
+  int nullDevice = open("/dev/null", O_WRONLY);
+  NSDictionary<NSString *, id<FBControlCoreLogger>> *loggers = @{
+    @"fd": [FBControlCoreLoggerFactory loggerToFileDescriptor:nullDevice closeOnEndOfFile:NO],
+    @"consumer": [FBControlCoreLoggerFactory loggerToConsumer:FBDataBuffer.accumulatingBuffer],
+    @"async": [FBControlCoreLoggerFactory asyncLoggerWithLogger:[FBControlCoreLoggerFactory loggerToFileDescriptor:nullDevice closeOnEndOfFile:NO]],
+    @"system": [FBControlCoreLoggerFactory systemLoggerWritingToStderr:NO withDebugLogging:NO],
+  };
+  // A formatted line as is typical of the logging in this codebase, per line.
+  for (NSString *kind in [loggers.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+    id<FBControlCoreLogger> logger = loggers[kind];
+    NSString *name = [NSString stringWithFormat:@"logger.%@.logFormat", kind];
+    if (included(name)) {
+      record([FBBenchmark measureName:name frameCount:frameCount inputBytesPerFrame:0 setUp:nil body:^(NSUInteger frame) {
+        [logger logFormat:@"Benchmark line %lu of %lu from %@", (unsigned long) frame, (unsigned long) frameCount, kind];
+      }]);
+    }
+    // Debug lines to a logger without debug logging enabled, the cost of logging that is turned off.
+    NSString *debugName = [NSString stringWithFormat:@"logger.%@.debug.disabled", kind];
+    if (included(debugName)) {
+      id<FBControlCoreLogger> debug = logger.debug;
+      record([FBBenchmark measureName:debugName frameCount:frameCount inputBytesPerFrame:0 setUp:nil body:^(NSUInteger frame) {
+        [debug logFormat:@"Benchmark line %lu of %lu from %@", (unsigned long) frame, (unsigned long) frameCount, kind];
+      }]);
+    }
+  }
+}
+
++ (void)runErrorBenchmarksWithFrameCount:(NSUInteger)frameCount included:(BOOL (^)(NSString *))included record:(void (^)(FBBenchmarkResult *))record
+{
+  NSMutableArray<NSString *> *installed = [NSMutableArray array];
+  for (NSUInteger index = 0; index < 200; index++) {
+    [installed addObject:[NSString stringWithFormat:@"com.example.application%lu", (unsigned long) index]];
+  }
+  // A failed lookup whose error is handled without being described, as with fallback: on a probe.
+  NSString *name = @"error.describeFormat.unread";
+  if (included(name)) {
+    record([FBBenchmark measureName:name frameCount:frameCount inputBytesPerFrame:0 setUp:nil body:^(NSUInteger frame) {
+      [[FBControlCoreError
+        describeFormat:@"Application with bundle ID: %@ is not installed. Installed apps %@ ", @"com.example.missing", [FBCollectionInformation lazyOneLineDescriptionFromArray:installed]]
+        build];
+    }]);
+  }
+  // The same error, when the description is read.
+  NSString *readName = @"error.describeFormat.read";
+  if (included(readName)) {
+    record([FBBenchmark measureName:readName frameCount:frameCount inputBytesPerFrame:0 setUp:nil body:^(NSUInteger frame) {
+      [[[FBControlCoreError
+        describeFormat:@"Application with bundle ID: %@ is not installed. Installed apps %@ ", @"com.example.missing", [FBCollectionInformation lazyOneLineDescriptionFromArray:installed]]
+        build]
+        localizedDescription];
+    }]);
+  }
+}
+
+@end
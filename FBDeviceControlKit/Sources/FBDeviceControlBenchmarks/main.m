@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+#import <sched.h>
+
+#import "FBBenchmark.h"
+#import "FBBenchmarkFixtures.h"
+#import "FBCoreBenchmarks.h"
+#import "FBControlCore.h"
+
+/**
+ Drives the stream writers and data consumers with synthetic frames, reporting the time and heap allocations per frame.
+ The core suite measures futures, data buffers, consumers and loggers without fixtures, the video suite is run at each resolution.
+
+ Usage: FBDeviceControlBenchmarks [--suites core,video] [--frames N] [--resolutions 1080,2160] [--filter substring] [--output results.json] [--baseline results.json] [--tolerance 0.15]
+ With a baseline, exits with a non-zero status if any benchmark is slower, or allocates more, than the tolerance allows.
+ */
+
+static const NSUInteger FixtureFrameCount = 60;
+static const NSUInteger ChunkSize = 16 * 1024;
+
+/**
+ A byte consumer that only looks at what it is given. Optionally flattens the data, as a consumer that needs contiguous bytes would.
+ */
+@interface FBBenchmarkSink : NSObject <FBDataConsumer>
+
+@property (nonatomic, assign, readonly) BOOL contiguous;
+@property (nonatomic, assign, readonly) NSUInteger byteCount;
+@property (nonatomic, strong, nullable, readonly) dispatch_semaphore_t semaphore;
+
+@end
+
+@implementation FBBenchmarkSink
+
+- (instancetype)initContiguous:(BOOL)contiguous semaphore:(nullable dispatch_semaphore_t)semaphore
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _contiguous = contiguous;
+  _semaphore = semaphore;
+
+  return self;
+}
+
+- (void)consumeData:(NSData *)data
+{
+  if (self.contiguous) {
+    const uint8_t *bytes = data.bytes;
+    _byteCount += bytes ? data.length : 0;
+  } else {
+    _byteCount += data.length;
+  }
+  if (self.semaphore) {
+    dispatch_semaphore_signal(self.semaphore);
+  }
+}
+
+- (void)consumeEndOfFile
+{
+}
+
+@end
+
+static NSArray<NSData *> *ChunksOfData(NSData *data)
+{
+  NSMutableArray<NSData *> *chunks = [NSMutableArray array];
+  for (NSUInteger offset = 0; offset < data.length; offset += ChunkSize) {
+    NSRange range = NSMakeRange(offset, MIN(ChunkSize, data.length - offset));
+    [chunks addObject:[NSData dataWithBytes:(const uint8_t *) data.bytes + range.location length:range.length]];
+  }
+  return chunks;
+}
+
+static NSArray<FBBenchmarkResult *> *RunBenchmarks(FBBenchmarkFixtures *fixtures, NSUInteger frameCount, NSString *_Nullable filter, id<FBControlCoreLogger> logger)
+{
+  NSMutableArray<FBBenchmarkResult *> *results = [NSMutableArray array];
+  NSString *label = fixtures.label;
+  NSUInteger encodedSize = fixtures.averageEncodedFrameSize;
+  BOOL (^included)(NSString *) = ^ BOOL (NSString *name) {
+    return filter.length == 0 || [name containsString:filter];
+  };
+  void (^record)(FBBenchmarkResult *) = ^(FBBenchmarkResult *result) {
+    NSLog(@"%@", result);
+    [results addObject:result];
+  };
+
+  // Annex-B: the sample buffer is rewritten in place, so a fresh one is created before every frame, outside of the measurement.
+  __block CMSampleBufferRef sampleBuffer = NULL;
+  void (^nextSampleBuffer)(NSUInteger) = ^(NSUInteger frame) {
+    if (sampleBuffer) {
+      CFRelease(sampleBuffer);
+    }
+    sampleBuffer = [fixtures createEncodedSampleBufferAtIndex:frame];
+  };
+  for (NSNumber *contiguous in @[@NO, @YES]) {
+    NSString *name = [NSString stringWithFormat:@"annexb.write%@/%@", contiguous.boolValue ? @".contiguous" : @"", label];
+    if (!included(name)) {
+      continue;
+    }
+    FBBenchmarkSink *sink = [[FBBenchmarkSink alloc] initContiguous:contiguous.boolValue semaphore:nil];
+    record([FBBenchmark measureName:name frameCount:frameCount inputBytesPerFrame:encodedSize setUp:nextSampleBuffer body:^(NSUInteger frame) {
+      WriteFrameToAnnexBStream(sampleBuffer, sink, logger, nil);
+    }]);
+  }
+  NSString *cachedName = [NSString stringWithFormat:@"annexb.write.cached/%@", label];
+  if (included(cachedName)) {
+    FBBenchmarkSink *sink = [[FBBenchmarkSink alloc] initContiguous:NO semaphore:nil];
+    FBAnnexBParameterSetCache *cache = [[FBAnnexBParameterSetCache alloc] init];
+    record([FBBenchmark measureName:cachedName frameCount:frameCount inputBytesPerFrame:encodedSize setUp:nextSampleBuffer body:^(NSUInteger frame) {
+      WriteFrameToAnnexBStreamWithParameterSetCache(sampleBuffer, cache, sink, logger, nil);
+    }]);
+  }
+
+  // The fanout delivers on a queue per consumer, so each frame is timed until every consumer has received it.
+  NSString *fanoutName = [NSString stringWithFormat:@"fanout.annexb.x3/%@", label];
+  if (included(fanoutName)) {
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    FBVideoStreamFanout *fanout = [[FBVideoStreamFanout alloc] initWithFramedOutput:YES logger:logger];
+    for (NSUInteger index = 0; index < 3; index++) {
+      [fanout addConsumer:[[FBBenchmarkSink alloc] initContiguous:NO semaphore:semaphore] policy:FBVideoStreamBackpressurePolicyPreserveKeyFrames maxPendingFrames:8 error:nil];
+    }
+    FBAnnexBParameterSetCache *cache = [[FBAnnexBParameterSetCache alloc] init];
+    record([FBBenchmark measureName:fanoutName frameCount:frameCount inputBytesPerFrame:encodedSize setUp:nextSampleBuffer body:^(NSUInteger frame) {
+      CMSampleBufferRef frameSampleBuffer = sampleBuffer;
+      [fanout writeFrameIsKeyFrame:FBVideoStreamSampleBufferIsKeyFrame(frameSampleBuffer) presentationTimeStamp:CMSampleBufferGetPresentationTimeStamp(frameSampleBuffer) captureHostTime:0 writer:^ BOOL (id<FBDataConsumer> consumer) {
+        return WriteFrameToAnnexBStreamWithParameterSetCache(frameSampleBuffer, cache, consumer, logger, nil);
+      }];
+      for (NSUInteger index = 0; index < 3; index++) {
+        dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+      }
+    }]);
+  }
+  if (sampleBuffer) {
+    CFRelease(sampleBuffer);
+  }
+
+  // MJPEG does not modify the block buffer, so the same one is written every frame.
+  NSString *mjpegName = [NSString stringWithFormat:@"mjpeg.write/%@", label];
+  if (included(mjpegName)) {
+    FBBenchmarkSink *sink = [[FBBenchmarkSink alloc] initContiguous:NO semaphore:nil];
+    CMBlockBufferRef jpegBuffer = [fixtures createJPEGBlockBuffer];
+    record([FBBenchmark measureName:mjpegName frameCount:frameCount inputBytesPerFrame:fixtures.jpegData.length setUp:nil body:^(NSUInteger frame) {
+      WriteJPEGDataToMJPEGStream(jpegBuffer, sink, logger, nil);
+    }]);
+    CFRelease(jpegBuffer);
+  }
+
+  // Data buffers are fed frames in socket-sized chunks, then the frame is consumed as a whole.
+  __block NSArray<NSData *> *chunks = nil;
+  NSString *consumeLengthName = [NSString stringWithFormat:@"databuffer.consumeLength/%@", label];
+  if (included(consumeLengthName)) {
+    id<FBConsumableBuffer> buffer = FBDataBuffer.consumableBuffer;
+    record([FBBenchmark measureName:consumeLengthName frameCount:frameCount inputBytesPerFrame:encodedSize setUp:^(NSUInteger frame) {
+      chunks = ChunksOfData([fixtures encodedFrameDataAtIndex:frame]);
+    } body:^(NSUInteger frame) {
+      NSUInteger length = 0;
+      for (NSData *chunk in chunks) {
+        [buffer consumeData:chunk];
+        length += chunk.length;
+      }
+      [buffer consumeLength:length];
+    }]);
+  }
+  NSString *consumeUntilName = [NSString stringWithFormat:@"databuffer.consumeUntil/%@", label];
+  if (included(consumeUntilName)) {
+    id<FBConsumableBuffer> buffer = FBDataBuffer.consumableBuffer;
+    NSData *boundary = [@"\r\n--BoundaryString\r\n" dataUsingEncoding:NSASCIIStringEncoding];
+    NSMutableData *part = [fixtures.jpegData mutableCopy];
+    [part appendData:boundary];
+    NSArray<NSData *> *partChunks = ChunksOfData(part);
+    record([FBBenchmark measureName:consumeUntilName frameCount:frameCount inputBytesPerFrame:part.length setUp:nil body:^(NSUInteger frame) {
+      for (NSData *chunk in partChunks) {
+        [buffer consumeData:chunk];
+      }
+      [buffer consumeUntil:boundary];
+    }]);
+  }
+
+  // Asynchronous consumers are measured by throughput, from the first write until the last frame has been delivered.
+  NSString *asyncName = [NSString stringWithFormat:@"consumer.async/%@", label];
+  if (included(asyncName)) {
+    dispatch_group_t group = dispatch_group_create();
+    id<FBDataConsumer> consumer = [FBBlockDataConsumer asynchronousDataConsumerOnQueue:dispatch_queue_create("com.facebook.fbdevicecontrol.benchmarks.async", DISPATCH_QUEUE_SERIAL) consumer:^(NSData *data) {
+      dispatch_group_leave(group);
+    }];
+    record([FBBenchmark measureThroughputName:asyncName frameCount:frameCount inputBytesPerFrame:encodedSize batch:^{
+      for (NSUInteger frame = 0; frame < frameCount; frame++) {
+        dispatch_group_enter(group);
+        [consumer consumeData:[fixtures encodedFrameDataAtIndex:frame]];
+      }
+      dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    }]);
+  }
+  NSString *ringName = [NSString stringWithFormat:@"consumer.ringbuffer/%@", label];
+  if (included(ringName)) {
+    static const NSUInteger RingCapacity = 8;
+    dispatch_group_t group = dispatch_group_create();
+    id<FBDataConsumer, FBDataConsumerAsync> consumer = [FBBlockDataConsumer ringBufferDataConsumerOnQueue:dispatch_queue_create("com.facebook.fbdevicecontrol.benchmarks.ring", DISPATCH_QUEUE_SERIAL) capacity:RingCapacity consumer:^(NSData *data) {
+      dispatch_group_leave(group);
+    }];
+    record([FBBenchmark measureThroughputName:ringName frameCount:frameCount inputBytesPerFrame:encodedSize batch:^{
+      for (NSUInteger frame = 0; frame < frameCount; frame++) {
+        // The ring drops data when it is full, so the writer waits for space as a video stream's backpressure would.
+        while ((NSUInteger) consumer.unprocessedDataCount >= RingCapacity) {
+          sched_yield();
+        }
+        dispatch_group_enter(group);
+        [consumer consumeData:[fixtures encodedFrameDataAtIndex:frame]];
+      }
+      dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    }]);
+  }
+
+  return results;
+}
+
+static NSString *_Nullable ArgumentValue(NSArray<NSString *> *arguments, NSString *flag)
+{
+  NSUInteger index = [arguments indexOfObject:flag];
+  if (index == NSNotFound || index + 1 >= arguments.count) {
+    return nil;
+  }
+  return arguments[index + 1];
+}
+
+int main(int argc, const char *argv[])
+{
+  @autoreleasepool {
+    NSArray<NSString *> *arguments = NSProcessInfo.processInfo.arguments;
+    NSUInteger frameCount = (NSUInteger) MAX(1, [ArgumentValue(arguments, @"--frames") ?: @"300" integerValue]);
+    NSArray<NSString *> *suites = [ArgumentValue(arguments, @"--suites") ?: @"core,video" componentsSeparatedByString:@","];
+    NSArray<NSString *> *resolutions = [ArgumentValue(arguments, @"--resolutions") ?: @"1080,2160" componentsSeparatedByString:@","];
+    NSString *filter = ArgumentValue(arguments, @"--filter");
+    NSString *outputPath = ArgumentValue(arguments, @"--output");
+    NSString *baselinePath = ArgumentValue(arguments, @"--baseline");
+    double tolerance = [ArgumentValue(arguments, @"--tolerance") ?: @"0.15" doubleValue];
+    id<FBControlCoreLogger> logger = [FBControlCoreLoggerFactory systemLoggerWritingToStderr:NO withDebugLogging:NO];
+
+    NSMutableArray<FBBenchmarkResult *> *results = [NSMutableArray array];
+    if ([suites containsObject:@"core"]) {
+      [results addObjectsFromArray:[FBCoreBenchmarks runWithFrameCount:frameCount filter:filter]];
+    }
+    for (NSString *resolution in [suites containsObject:@"video"] ? resolutions : @[]) {
+      int32_t height = (int32_t) resolution.integerValue;
+      int32_t width = height * 16 / 9;
+      NSError *error = nil;
+      FBBenchmarkFixtures *fixtures = [FBBenchmarkFixtures fixturesWithWidth:width height:height frameCount:FixtureFrameCount error:&error];
+      if (!fixtures) {
+        NSLog(@"Failed to create %dx%d fixtures: %@", width, height, error);
+        return 1;
+      }
+      NSLog(@"%@: %lu frames, %lu bytes per encoded frame, %lu bytes per JPEG", fixtures.label, (unsigned long) fixtures.frameCount, (unsigned long) fixtures.averageEncodedFrameSize, (unsigned long) fixtures.jpegData.length);
+      [results addObjectsFromArray:RunBenchmarks(fixtures, frameCount, filter, logger)];
+    }
+
+    NSMutableArray<NSDictionary<NSString *, id> *> *json = [NSMutableArray array];
+    for (FBBenchmarkResult *result in results) {
+      [json addObject:result.jsonSerializableRepresentation];
+    }
+    if (outputPath) {
+      NSData *data = [NSJSONSerialization dataWithJSONObject:json options:NSJSONWritingPrettyPrinted | NSJSONWritingSortedKeys error:nil];
+      [data writeToFile:outputPath atomically:YES];
+    }
+    if (baselinePath) {
+      NSData *data = [NSData dataWithContentsOfFile:baselinePath];
+      NSArray<NSDictionary<NSString *, id> *> *baseline = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+      if (![baseline isKindOfClass:NSArray.class]) {
+        NSLog(@"Could not read baseline at %@", baselinePath);
+        return 1;
+      }
+      NSArray<NSString *> *regressions = [FBBenchmark regressionsInResults:results baseline:baseline tolerance:tolerance];
+      for (NSString *regression in regressions) {
+        NSLog(@"Regression %@", regression);
+      }
+      if (regressions.count > 0) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
@@ -40,30 +40,54 @@ public final class FBDeviceControlService: @unchecked Sendable {
         FBDeviceControlBridge.shared.initializationError
     }
 
+    /// 是否已完成初始化（MobileDevice 在后台加载，完成前 isAvailable 为 false）
+    public var isReady: Bool {
+        FBDeviceControlBridge.shared.isReady
+    }
+
     // MARK: - 设备变化回调
 
     /// 设备变化回调
     public var onDevicesChanged: (([FBDeviceInfoDTO]) -> Void)?
 
+    /// 设备差量变化回调（新增设备、已移除设备的 UDID、信息变化的设备）
+    public var onDevicesDiff: ((_ added: [FBDeviceInfoDTO], _ removed: [String], _ updated: [FBDeviceInfoDTO]) -> Void)?
+
     // MARK: - 私有属性
 
     private var isObserving = false
 
+    /// 已观察到的设备 DTO，按差量更新，只在主线程访问
+    private var observedDevices: [String: FBDeviceInfoDTO] = [:]
+
+    /// 已观察到的设备顺序
+    private var observedOrder: [String] = []
+
     // MARK: - 初始化
 
     private init() {
-        if isAvailable {
-            logger.info("FBDeviceControlService initialized, FBDeviceControl is available")
-        } else {
-            logger
-                .warning(
-                    "FBDeviceControlService: FBDeviceControl not available - \(self.initializationError ?? "Unknown error")"
-                )
+        // 桥接层在后台完成初始化，就绪后再记录是否可用
+        FBDeviceControlBridge.shared.whenReady { [weak self] available in
+            guard let self else { return }
+            if available {
+                logger.info("FBDeviceControlService initialized, FBDeviceControl is available")
+            } else {
+                logger
+                    .warning(
+                        "FBDeviceControlService: FBDeviceControl not available - \(self.initializationError ?? "Unknown error")"
+                    )
+            }
         }
     }
 
     // MARK: - 公开方法
 
+    /// 初始化完成后在主线程回调
+    /// - Parameter completion: 回调，参数为 FBDeviceControl 是否可用
+    public func whenReady(_ completion: @escaping (Bool) -> Void) {
+        FBDeviceControlBridge.shared.whenReady(completion)
+    }
+
     /// 获取当前所有设备列表
     /// - Returns: 设备信息 DTO 数组
     public func listDevices() -> [FBDeviceInfoDTO] {
@@ -91,18 +115,39 @@ public final class FBDeviceControlService: @unchecked Sendable {
     }
 
     /// 开始观察设备变化
+    /// 可在初始化完成前调用，首次回调在初始化完成后交付
     public func startObserving() {
-        guard isAvailable, !isObserving else {
+        guard !isObserving else {
             return
         }
 
         isObserving = true
-        FBDeviceControlBridge.shared.startObserving { [weak self] dictionaries in
+        observedDevices = [:]
+        observedOrder = []
+        FBDeviceControlBridge.shared.startObservingChanges { [weak self] addedInfos, removedUDIDs, updatedInfos in
             guard let self else { return }
-            let devices = dictionaries.compactMap { self.parseDeviceInfo($0) }
-
-            logger.debug("FBDeviceControl device change: \(devices.count) device(s)")
-            onDevicesChanged?(devices)
+            // 只解析发生变化的设备，未变化的设备沿用已有的 DTO
+            let added = addedInfos.compactMap { self.parseDeviceInfo($0) }
+            let updated = updatedInfos.compactMap { self.parseDeviceInfo($0) }
+            let removed = removedUDIDs
+
+            for device in added where observedDevices[device.udid] == nil {
+                observedOrder.append(device.udid)
+            }
+            for device in added + updated {
+                observedDevices[device.udid] = device
+            }
+            for udid in removed {
+                observedDevices[udid] = nil
+            }
+            if !removed.isEmpty {
+                let removedSet = Set(removed)
+                observedOrder.removeAll { removedSet.contains($0) }
+            }
+
+            logger.debug("FBDeviceControl device change: +\(added.count) -\(removed.count) ~\(updated.count)")
+            onDevicesDiff?(added, removed, updated)
+            onDevicesChanged?(observedOrder.compactMap { observedDevices[$0] })
         }
 
         logger.info("FBDeviceControlService: Started observing device changes")
@@ -0,0 +1,88 @@
+//
+//  FBFuture+Concurrency.swift
+//  FBDeviceControlKit
+//
+//  FBFuture / FBFutureContext 的 Swift Concurrency 桥接
+//  直接在 Future 的解析线程上恢复 Continuation，不经过主队列转发，也不使用 FBFuture+Sync 的 RunLoop 等待
+//
+
+import CFBDeviceControl
+import Foundation
+
+// MARK: - FBFuture 异步桥接
+
+/// FBFuture 的 async/await 桥接
+public enum FBFutureConcurrency {
+    /// 执行 FBFutureContext 进入与退出回调所使用的队列
+    private static let contextQueue = DispatchQueue(
+        label: "com.fbdevicecontrolkit.future.context",
+        qos: .userInitiated,
+        attributes: .concurrent
+    )
+
+    /// 等待 Future 解析并返回结果
+    /// - Parameter future: 要等待的 Future
+    /// - Returns: Future 的结果
+    /// - Throws: Future 失败时抛出其错误，Future 或当前 Task 被取消时抛出 `CancellationError`
+    /// - Note: 当前 Task 被取消时会调用 `FBFuture.cancel()`
+    public static func value<T: AnyObject>(of future: FBFuture<T>) async throws -> T {
+        try await withTaskCancellationHandler {
+            try await withCheckedThrowingContinuation { (continuation: CheckedContinuation<T, Error>) in
+                // 在解析 Future 的线程上直接恢复，结果对象按引用传递，不做拷贝
+                future.notifyOfCompletionInline { resolved in
+                    switch resolved.state {
+                    case .done:
+                        guard let result = resolved.result as? T else {
+                            continuation.resume(throwing: CancellationError())
+                            return
+                        }
+                        continuation.resume(returning: result)
+                    case .failed:
+                        continuation.resume(throwing: resolved.error ?? CancellationError())
+                    default:
+                        continuation.resume(throwing: CancellationError())
+                    }
+                }
+            }
+        } onCancel: {
+            future.cancel()
+        }
+    }
+
+    /// 进入 FBFutureContext，在上下文存活期间执行 `body`，结束后触发上下文的 teardown
+    /// - Parameters:
+    ///   - context: 要进入的上下文
+    ///   - body: 使用上下文值的异步闭包
+    /// - Returns: `body` 的返回值
+    /// - Throws: 上下文建立失败或 `body` 抛出的错误
+    public static func withContext<T: AnyObject, R>(
+        _ context: FBFutureContext<T>,
+        _ body: (T) async throws -> R
+    ) async throws -> R {
+        let entered = context.onQueue(contextQueue, enter: { value, teardown in
+            FBFutureContextEntry(value: value, teardown: teardown)
+        })
+        guard let entry = try await value(of: entered) as? FBFutureContextEntry,
+              let contextValue = entry.value as? T
+        else {
+            throw CancellationError()
+        }
+        defer {
+            entry.teardown.resolve(withResult: NSNull())
+        }
+        return try await body(contextValue)
+    }
+}
+
+// MARK: - 上下文条目
+
+/// 进入上下文后得到的值与 teardown 触发器
+private final class FBFutureContextEntry: NSObject {
+    let value: AnyObject
+    let teardown: FBMutableFuture<NSNull>
+
+    init(value: AnyObject, teardown: FBMutableFuture<NSNull>) {
+        self.value = value
+        self.teardown = teardown
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBControlCore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class FBDevice;
+
+/**
+ Standardized scenarios that are run against an attached device, so that the throughput of the device services can be compared between changes, devices and hosts.
+ Each scenario returns report entries: a JSON compatible dictionary with the "scenario", a "name" that identifies the entry in a report, and the measured values.
+ A scenario that fails returns an entry with an "error", rather than failing the whole run.
+ */
+@interface FBHardwareBenchmarks : NSObject
+
+#pragma mark Initializers
+
+/**
+ The Designated Initializer.
+
+ @param device the device to run the scenarios against.
+ @param logger the logger to use.
+ @return a new FBHardwareBenchmarks instance.
+ */
+- (instancetype)initWithDevice:(FBDevice *)device logger:(id<FBControlCoreLogger>)logger;
+
+#pragma mark Scenarios
+
+/**
+ Uploads a file of each size to the media partition over AFC, then downloads it again.
+ Small files are transferred repeatedly, so that each size moves a comparable amount of data.
+
+ @param sizes the file sizes in bytes.
+ @return one entry per size, with the median time and throughput of each direction.
+ */
+- (NSArray<NSDictionary<NSString *, id> *> *)runAFCWithSizes:(NSArray<NSNumber *> *)sizes;
+
+/**
+ Sends small plist requests to springboardservices and measures the time until each response arrives.
+ Requests are sent one at a time, then pipelined, which shows the cost of the round trip separately from the cost of the service.
+
+ @param iterations the number of requests to send in each mode.
+ @return one entry per mode, with latency percentiles.
+ */
+- (NSArray<NSDictionary<NSString *, id> *> *)runPlistRoundTripWithIterations:(NSUInteger)iterations;
+
+/**
+ Tails the syslog relay and counts the lines and bytes that arrive.
+
+ @param duration the time to tail for.
+ @return a single entry, with the line and byte rates.
+ */
+- (NSArray<NSDictionary<NSString *, id> *> *)runSyslogWithDuration:(NSTimeInterval)duration;
+
+/**
+ Streams the screen in each encoding with framed output, measuring the frame rate and the latency of each frame from capture to delivery.
+
+ @param encodings the encodings to stream.
+ @param duration the time to stream each encoding for, after the first frame.
+ @return one entry per encoding.
+ */
+- (NSArray<NSDictionary<NSString *, id> *> *)runVideoWithEncodings:(NSArray<FBVideoStreamEncoding> *)encodings duration:(NSTimeInterval)duration;
+
+@end
+
+NS_ASSUME_NONNULL_END
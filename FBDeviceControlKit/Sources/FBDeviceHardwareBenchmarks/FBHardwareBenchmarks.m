@@ -0,0 +1,470 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBHardwareBenchmarks.h"
+
+#import <fcntl.h>
+#import <mach/mach_time.h>
+
+#import "FBDeviceControl.h"
+
+static NSString *const AFCDirectory = @"FBDeviceHardwareBenchmarks";
+
+// Each size is transferred until at least this much data has moved, up to MaximumTransfers times.
+static const uint64_t AFCTargetBytesPerSize = 64 * 1024 * 1024;
+static const NSUInteger AFCMaximumTransfers = 32;
+static const NSUInteger PlistPipelineDepth = 8;
+static const NSTimeInterval FirstFrameTimeout = 10;
+
+static uint64_t NowNanoseconds(void)
+{
+  return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+}
+
+static double MachTimeToMilliseconds(uint64_t machTime)
+{
+  static mach_timebase_info_data_t timebase;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    mach_timebase_info(&timebase);
+  });
+  return (double) machTime * timebase.numer / timebase.denom / NSEC_PER_MSEC;
+}
+
+static double Percentile(NSArray<NSNumber *> *sorted, double percentile)
+{
+  if (sorted.count == 0) {
+    return 0;
+  }
+  NSUInteger index = MIN(sorted.count - 1, (NSUInteger) (percentile * (double) (sorted.count - 1) + 0.5));
+  return sorted[index].doubleValue;
+}
+
+static NSDictionary<NSString *, NSNumber *> *LatencySummary(NSArray<NSNumber *> *milliseconds)
+{
+  NSArray<NSNumber *> *sorted = [milliseconds sortedArrayUsingSelector:@selector(compare:)];
+  return @{
+    @"count": @(sorted.count),
+    @"p50_ms": @(Percentile(sorted, 0.5)),
+    @"p95_ms": @(Percentile(sorted, 0.95)),
+    @"p99_ms": @(Percentile(sorted, 0.99)),
+    @"max_ms": sorted.lastObject ?: @0,
+  };
+}
+
+static NSString *SizeLabel(uint64_t size)
+{
+  if (size >= 1024 * 1024 * 1024 && size % (1024 * 1024 * 1024) == 0) {
+    return [NSString stringWithFormat:@"%lluG", size / (1024 * 1024 * 1024)];
+  }
+  if (size >= 1024 * 1024 && size % (1024 * 1024) == 0) {
+    return [NSString stringWithFormat:@"%lluM", size / (1024 * 1024)];
+  }
+  if (size >= 1024 && size % 1024 == 0) {
+    return [NSString stringWithFormat:@"%lluK", size / 1024];
+  }
+  return [NSString stringWithFormat:@"%llu", size];
+}
+
+static NSDictionary<NSString *, id> *ErrorEntry(NSString *scenario, NSString *name, NSError *error)
+{
+  return @{
+    @"scenario": scenario,
+    @"name": name,
+    @"error": error.localizedDescription ?: @"Unknown error",
+  };
+}
+
+// Writes random bytes in chunks, so that a 1G file does not need to be held in memory.
+static BOOL WriteRandomFile(NSString *path, uint64_t size, NSError **error)
+{
+  int fd = open(path.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return [[FBControlCoreError
+      describeFormat:@"Failed to create %@: %s", path, strerror(errno)]
+      failBool:error];
+  }
+  NSMutableData *chunk = [NSMutableData dataWithLength:1024 * 1024];
+  arc4random_buf(chunk.mutableBytes, chunk.length);
+  for (uint64_t written = 0; written < size;) {
+    size_t length = (size_t) MIN((uint64_t) chunk.length, size - written);
+    ssize_t result = write(fd, chunk.bytes, length);
+    if (result < 0) {
+      close(fd);
+      return [[FBControlCoreError
+        describeFormat:@"Failed to write %@: %s", path, strerror(errno)]
+        failBool:error];
+    }
+    written += (uint64_t) result;
+  }
+  close(fd);
+  return YES;
+}
+
+/**
+ Parses a stream with framed output, recording the latency from capture to delivery of each frame and the frames that the stream dropped.
+ */
+@interface FBHardwareBenchmarkFrameCounter : NSObject <FBDataConsumer>
+
+@property (nonatomic, strong, readonly) dispatch_semaphore_t firstFrame;
+
+/**
+ Returns the frames, bytes and latencies since the last reset, then resets them.
+ */
+- (NSDictionary<NSString *, id> *)reset;
+
+@end
+
+@implementation FBHardwareBenchmarkFrameCounter
+{
+  id<FBConsumableBuffer> _buffer;
+  NSUInteger _pendingFrameLength;
+  BOOL _receivedFirstFrame;
+  BOOL _hasSequenceNumber;
+  uint32_t _lastSequenceNumber;
+  uint64_t _frames;
+  uint64_t _keyFrames;
+  uint64_t _bytes;
+  uint64_t _gaps;
+  NSMutableArray<NSNumber *> *_deliveryLatencies;
+  NSMutableArray<NSNumber *> *_encodeLatencies;
+}
+
+- (instancetype)init
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _buffer = FBDataBuffer.consumableBuffer;
+  _firstFrame = dispatch_semaphore_create(0);
+  _deliveryLatencies = [NSMutableArray array];
+  _encodeLatencies = [NSMutableArray array];
+
+  return self;
+}
+
+- (void)consumeData:(NSData *)data
+{
+  uint64_t now = mach_absolute_time();
+  @synchronized (self) {
+    [_buffer consumeData:data];
+    while (YES) {
+      if (_pendingFrameLength == 0) {
+        NSData *headerData = [_buffer consumeLength:sizeof(FBVideoStreamFrameHeader)];
+        if (!headerData) {
+          return;
+        }
+        FBVideoStreamFrameHeader header;
+        memcpy(&header, headerData.bytes, sizeof(header));
+        NSUInteger headerLength = CFSwapInt16LittleToHost(header.headerLength);
+        uint32_t sequenceNumber = CFSwapInt32LittleToHost(header.sequenceNumber);
+        uint64_t captureHostTime = CFSwapInt64LittleToHost(header.captureHostTime);
+        uint64_t writeHostTime = CFSwapInt64LittleToHost(header.writeHostTime);
+        _pendingFrameLength = CFSwapInt32LittleToHost(header.frameLength) + (headerLength > sizeof(header) ? headerLength - sizeof(header) : 0);
+        if (_hasSequenceNumber && sequenceNumber > _lastSequenceNumber + 1) {
+          _gaps += sequenceNumber - _lastSequenceNumber - 1;
+        }
+        _hasSequenceNumber = YES;
+        _lastSequenceNumber = sequenceNumber;
+        _frames += 1;
+        _keyFrames += (CFSwapInt16LittleToHost(header.flags) & FBVideoStreamFrameHeaderFlagKeyFrame) ? 1 : 0;
+        _bytes += _pendingFrameLength;
+        if (captureHostTime > 0 && now >= captureHostTime) {
+          [_deliveryLatencies addObject:@(MachTimeToMilliseconds(now - captureHostTime))];
+        }
+        if (captureHostTime > 0 && writeHostTime >= captureHostTime) {
+          [_encodeLatencies addObject:@(MachTimeToMilliseconds(writeHostTime - captureHostTime))];
+        }
+        if (!_receivedFirstFrame) {
+          _receivedFirstFrame = YES;
+          dispatch_semaphore_signal(_firstFrame);
+        }
+      }
+      if (_pendingFrameLength > 0) {
+        if (![_buffer consumeLength:_pendingFrameLength]) {
+          return;
+        }
+        _pendingFrameLength = 0;
+      }
+    }
+  }
+}
+
+- (void)consumeEndOfFile
+{
+}
+
+- (NSDictionary<NSString *, id> *)reset
+{
+  @synchronized (self) {
+    NSDictionary<NSString *, id> *counts = @{
+      @"frames": @(_frames),
+      @"key_frames": @(_keyFrames),
+      @"bytes": @(_bytes),
+      @"sequence_gaps": @(_gaps),
+      @"capture_to_delivery": LatencySummary(_deliveryLatencies),
+      @"capture_to_write": LatencySummary(_encodeLatencies),
+    };
+    _frames = 0;
+    _keyFrames = 0;
+    _bytes = 0;
+    _gaps = 0;
+    [_deliveryLatencies removeAllObjects];
+    [_encodeLatencies removeAllObjects];
+    return counts;
+  }
+}
+
+@end
+
+@interface FBHardwareBenchmarks ()
+
+@property (nonatomic, strong, readonly) FBDevice *device;
+@property (nonatomic, strong, readonly) id<FBControlCoreLogger> logger;
+@property (nonatomic, strong, readonly) dispatch_queue_t queue;
+
+@end
+
+@implementation FBHardwareBenchmarks
+
+#pragma mark Initializers
+
+- (instancetype)initWithDevice:(FBDevice *)device logger:(id<FBControlCoreLogger>)logger
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _device = device;
+  _logger = logger;
+  _queue = dispatch_queue_create("com.facebook.fbdevicecontrol.hardware_benchmarks", DISPATCH_QUEUE_SERIAL);
+
+  return self;
+}
+
+#pragma mark Scenarios
+
+- (NSArray<NSDictionary<NSString *, id> *> *)runAFCWithSizes:(NSArray<NSNumber *> *)sizes
+{
+  NSString *hostDirectory = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"FBDeviceHardwareBenchmarks-%@", NSUUID.UUID.UUIDString]];
+  NSError *error = nil;
+  if (![NSFileManager.defaultManager createDirectoryAtPath:hostDirectory withIntermediateDirectories:YES attributes:nil error:&error]) {
+    return @[ErrorEntry(@"afc", @"afc", error)];
+  }
+
+  NSArray<NSDictionary<NSString *, id> *> *entries = [[[self.device
+    startAFCService:@"com.apple.afc"]
+    onQueue:self.queue pop:^(FBAFCConnection *afc) {
+      NSMutableArray<NSDictionary<NSString *, id> *> *results = [NSMutableArray array];
+      [afc createDirectory:AFCDirectory error:nil];
+      for (NSNumber *sizeNumber in sizes) {
+        NSDictionary<NSString *, id> *result = [self transferSize:sizeNumber.unsignedLongLongValue connection:afc hostDirectory:hostDirectory];
+        NSLog(@"%@", result);
+        [results addObject:result];
+      }
+      [afc removePath:AFCDirectory recursively:YES error:nil];
+      return [FBFuture futureWithResult:results];
+    }]
+    block:&error];
+  [NSFileManager.defaultManager removeItemAtPath:hostDirectory error:nil];
+  return entries ?: @[ErrorEntry(@"afc", @"afc", error)];
+}
+
+- (NSArray<NSDictionary<NSString *, id> *> *)runPlistRoundTripWithIterations:(NSUInteger)iterations
+{
+  NSDictionary<NSString *, id> *request = @{@"command": @"getInterfaceOrientation"};
+  NSError *error = nil;
+  NSArray<NSDictionary<NSString *, id> *> *entries = [[[self.device
+    startService:@"com.apple.springboardservices"]
+    onQueue:self.queue pop:^(FBAMDServiceConnection *connection) {
+      NSMutableArray<NSNumber *> *latencies = [NSMutableArray arrayWithCapacity:iterations];
+      uint64_t start = NowNanoseconds();
+      for (NSUInteger iteration = 0; iteration < iterations; iteration++) {
+        uint64_t sent = NowNanoseconds();
+        NSError *innerError = nil;
+        if (![connection sendAndReceiveMessage:request error:&innerError]) {
+          return [FBFuture futureWithError:innerError];
+        }
+        [latencies addObject:@((double) (NowNanoseconds() - sent) / NSEC_PER_MSEC)];
+      }
+      double sequentialSeconds = (double) (NowNanoseconds() - start) / NSEC_PER_SEC;
+      NSMutableDictionary<NSString *, id> *sequential = [LatencySummary(latencies) mutableCopy];
+      [sequential addEntriesFromDictionary:@{
+        @"scenario": @"plist",
+        @"name": @"plist.sequential",
+        @"requests_per_second": @(iterations / MAX(sequentialSeconds, 1e-9)),
+      }];
+
+      // Pipelined responses resolve in order, so each is timed from when the whole batch was handed to the connection.
+      NSMutableArray<NSDictionary<NSString *, id> *> *requests = [NSMutableArray arrayWithCapacity:iterations];
+      for (NSUInteger iteration = 0; iteration < iterations; iteration++) {
+        [requests addObject:request];
+      }
+      dispatch_queue_t responseQueue = dispatch_queue_create("com.facebook.fbdevicecontrol.hardware_benchmarks.plist", DISPATCH_QUEUE_SERIAL);
+      uint64_t pipelineStart = NowNanoseconds();
+      NSMutableArray<FBFuture<NSNumber *> *> *completions = [NSMutableArray arrayWithCapacity:iterations];
+      for (FBFuture<id> *response in [connection sendMessagesPipelined:requests depth:PlistPipelineDepth onQueue:responseQueue]) {
+        [completions addObject:[response onQueue:responseQueue map:^(id _) {
+          return @((double) (NowNanoseconds() - pipelineStart) / NSEC_PER_MSEC);
+        }]];
+      }
+      return [[FBFuture
+        futureWithFutures:completions]
+        onQueue:responseQueue map:^(NSArray<NSNumber *> *pipelinedLatencies) {
+          double pipelinedSeconds = (double) (NowNanoseconds() - pipelineStart) / NSEC_PER_SEC;
+          NSMutableDictionary<NSString *, id> *pipelined = [@{
+            @"scenario": @"plist",
+            @"name": [NSString stringWithFormat:@"plist.pipelined.x%lu", (unsigned long) PlistPipelineDepth],
+            @"requests_per_second": @(iterations / MAX(pipelinedSeconds, 1e-9)),
+          } mutableCopy];
+          pipelined[@"completion"] = LatencySummary(pipelinedLatencies);
+          return @[sequential, pipelined];
+        }];
+    }]
+    block:&error];
+  for (NSDictionary<NSString *, id> *entry in entries) {
+    NSLog(@"%@", entry);
+  }
+  return entries ?: @[ErrorEntry(@"plist", @"plist", error)];
+}
+
+- (NSArray<NSDictionary<NSString *, id> *> *)runSyslogWithDuration:(NSTimeInterval)duration
+{
+  __block uint64_t lines = 0;
+  __block uint64_t bytes = 0;
+  id<FBDataConsumer> consumer = [FBBlockDataConsumer synchronousLineSpanConsumerWithBlock:^(const char *_, size_t length) {
+    lines += 1;
+    bytes += length + 1;
+  }];
+  NSError *error = nil;
+  id<FBLogOperation> operation = [[(id<FBLogCommands>) self.device tailLog:@[] consumer:consumer] block:&error];
+  if (!operation) {
+    return @[ErrorEntry(@"syslog", @"syslog", error)];
+  }
+  uint64_t start = NowNanoseconds();
+  [NSThread sleepForTimeInterval:duration];
+  [operation.completed cancel];
+  double seconds = (double) (NowNanoseconds() - start) / NSEC_PER_SEC;
+
+  NSDictionary<NSString *, id> *entry = @{
+    @"scenario": @"syslog",
+    @"name": @"syslog.relay",
+    @"seconds": @(seconds),
+    @"lines": @(lines),
+    @"lines_per_second": @(lines / seconds),
+    @"bytes_per_second": @(bytes / seconds),
+  };
+  NSLog(@"%@", entry);
+  return @[entry];
+}
+
+- (NSArray<NSDictionary<NSString *, id> *> *)runVideoWithEncodings:(NSArray<FBVideoStreamEncoding> *)encodings duration:(NSTimeInterval)duration
+{
+  NSMutableArray<NSDictionary<NSString *, id> *> *entries = [NSMutableArray array];
+  for (FBVideoStreamEncoding encoding in encodings) {
+    NSString *name = [NSString stringWithFormat:@"video.%@", encoding];
+    FBVideoStreamConfiguration *configuration = [[[FBVideoStreamConfiguration alloc]
+      initWithEncoding:encoding framesPerSecond:nil compressionQuality:nil scaleFactor:nil avgBitrate:nil keyFrameRate:nil]
+      withFramedOutput:YES];
+    NSError *error = nil;
+    id<FBVideoStream> stream = [[(id<FBVideoStreamCommands>) self.device createStreamWithConfiguration:configuration] await:&error];
+    FBHardwareBenchmarkFrameCounter *counter = [[FBHardwareBenchmarkFrameCounter alloc] init];
+    if (!stream || ![[stream startStreaming:counter] await:&error]) {
+      [entries addObject:ErrorEntry(@"video", name, error)];
+      continue;
+    }
+
+    // The time to the first frame includes the encoder's startup, so it is reported on its own and excluded from the steady state.
+    uint64_t start = NowNanoseconds();
+    if (dispatch_semaphore_wait(counter.firstFrame, dispatch_time(DISPATCH_TIME_NOW, (int64_t) (FirstFrameTimeout * NSEC_PER_SEC))) != 0) {
+      [[stream stopStreaming] await:nil];
+      [entries addObject:ErrorEntry(@"video", name, [[FBControlCoreError describeFormat:@"No frame within %.0f seconds", FirstFrameTimeout] build])];
+      continue;
+    }
+    double firstFrameMilliseconds = (double) (NowNanoseconds() - start) / NSEC_PER_MSEC;
+    [counter reset];
+    uint64_t steadyStart = NowNanoseconds();
+    [NSRunLoop.currentRunLoop runUntilDate:[NSDate dateWithTimeIntervalSinceNow:duration]];
+    NSDictionary<NSString *, id> *counts = [counter reset];
+    double seconds = (double) (NowNanoseconds() - steadyStart) / NSEC_PER_SEC;
+    FBVideoStreamStatistics *statistics = stream.statistics;
+    [[stream stopStreaming] await:nil];
+
+    NSMutableDictionary<NSString *, id> *entry = [counts mutableCopy];
+    [entry addEntriesFromDictionary:@{
+      @"scenario": @"video",
+      @"name": name,
+      @"seconds": @(seconds),
+      @"first_frame_ms": @(firstFrameMilliseconds),
+      @"frames_per_second": @([counts[@"frames"] doubleValue] / seconds),
+      @"bits_per_second": @([counts[@"bytes"] doubleValue] * 8 / seconds),
+      @"stream_frames_dropped": @(statistics.framesDropped),
+    }];
+    NSLog(@"%@", entry);
+    [entries addObject:entry];
+  }
+  return entries;
+}
+
+#pragma mark Private
+
+- (NSDictionary<NSString *, id> *)transferSize:(uint64_t)size connection:(FBAFCConnection *)afc hostDirectory:(NSString *)hostDirectory
+{
+  NSString *label = SizeLabel(size);
+  NSString *name = [NSString stringWithFormat:@"afc/%@", label];
+  NSString *uploadPath = [hostDirectory stringByAppendingPathComponent:[NSString stringWithFormat:@"upload-%@.bin", label]];
+  NSString *downloadPath = [hostDirectory stringByAppendingPathComponent:[NSString stringWithFormat:@"download-%@.bin", label]];
+  NSString *containerPath = [AFCDirectory stringByAppendingPathComponent:[NSString stringWithFormat:@"%@.bin", label]];
+  NSError *error = nil;
+  if (!WriteRandomFile(uploadPath, size, &error)) {
+    return ErrorEntry(@"afc", name, error);
+  }
+
+  NSUInteger transfers = (NSUInteger) MAX(1, MIN((uint64_t) AFCMaximumTransfers, AFCTargetBytesPerSize / MAX(size, 1)));
+  NSMutableArray<NSNumber *> *uploads = [NSMutableArray arrayWithCapacity:transfers];
+  NSMutableArray<NSNumber *> *downloads = [NSMutableArray arrayWithCapacity:transfers];
+  for (NSUInteger transfer = 0; transfer < transfers; transfer++) {
+    uint64_t start = NowNanoseconds();
+    if (![afc copyFileFromHost:uploadPath toContainerPath:containerPath progress:nil error:&error]) {
+      return ErrorEntry(@"afc", name, error);
+    }
+    [uploads addObject:@((double) (NowNanoseconds() - start) / NSEC_PER_SEC)];
+
+    int fd = open(downloadPath.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      return ErrorEntry(@"afc", name, [[FBControlCoreError describeFormat:@"Failed to create %@: %s", downloadPath, strerror(errno)] build]);
+    }
+    start = NowNanoseconds();
+    BOOL downloaded = [afc readContentsOfPath:containerPath toFileDescriptor:fd error:&error];
+    close(fd);
+    if (!downloaded) {
+      return ErrorEntry(@"afc", name, error);
+    }
+    [downloads addObject:@((double) (NowNanoseconds() - start) / NSEC_PER_SEC)];
+  }
+  [afc removePath:containerPath recursively:NO error:nil];
+  [NSFileManager.defaultManager removeItemAtPath:uploadPath error:nil];
+  [NSFileManager.defaultManager removeItemAtPath:downloadPath error:nil];
+
+  double uploadSeconds = Percentile([uploads sortedArrayUsingSelector:@selector(compare:)], 0.5);
+  double downloadSeconds = Percentile([downloads sortedArrayUsingSelector:@selector(compare:)], 0.5);
+  return @{
+    @"scenario": @"afc",
+    @"name": name,
+    @"bytes": @(size),
+    @"transfers": @(transfers),
+    @"upload_median_ms": @(uploadSeconds * 1000),
+    @"upload_bytes_per_second": @(size / MAX(uploadSeconds, 1e-9)),
+    @"download_median_ms": @(downloadSeconds * 1000),
+    @"download_bytes_per_second": @(size / MAX(downloadSeconds, 1e-9)),
+  };
+}
+
+@end
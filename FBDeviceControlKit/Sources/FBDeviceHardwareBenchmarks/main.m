@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "FBControlCore.h"
+#import "FBDeviceControl.h"
+#import "FBHardwareBenchmarks.h"
+
+/**
+ Runs standardized scenarios against an attached device: AFC upload and download, plist round trips, the syslog relay and the screen stream in each encoding.
+ Unlike FBDeviceControlBenchmarks, the results depend on the device, its OS version and the cable, so the report records them alongside the measurements.
+
+ Usage: FBDeviceHardwareBenchmarks [--udid UDID] [--scenarios afc,plist,syslog,video] [--sizes 4K,1M,64M,1G] [--iterations N] [--duration seconds] [--encodings h264,hevc,mjpeg] [--output report.json]
+ */
+
+static const NSTimeInterval DeviceDiscoveryTimeout = 10;
+
+static NSString *_Nullable ArgumentValue(NSArray<NSString *> *arguments, NSString *flag)
+{
+  NSUInteger index = [arguments indexOfObject:flag];
+  if (index == NSNotFound || index + 1 >= arguments.count) {
+    return nil;
+  }
+  return arguments[index + 1];
+}
+
+// Parses sizes such as "4K", "64M" or "1G", in powers of 1024.
+static NSArray<NSNumber *> *_Nullable ParseSizes(NSString *argument)
+{
+  NSMutableArray<NSNumber *> *sizes = [NSMutableArray array];
+  for (NSString *component in [argument componentsSeparatedByString:@","]) {
+    NSString *value = [component.uppercaseString stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceCharacterSet];
+    uint64_t multiplier = 1;
+    if ([value hasSuffix:@"K"]) {
+      multiplier = 1024;
+    } else if ([value hasSuffix:@"M"]) {
+      multiplier = 1024 * 1024;
+    } else if ([value hasSuffix:@"G"]) {
+      multiplier = 1024 * 1024 * 1024;
+    }
+    if (multiplier > 1) {
+      value = [value substringToIndex:value.length - 1];
+    }
+    long long number = value.longLongValue;
+    if (number <= 0) {
+      return nil;
+    }
+    [sizes addObject:@((uint64_t) number * multiplier)];
+  }
+  return sizes;
+}
+
+int main(int argc, const char *argv[])
+{
+  @autoreleasepool {
+    NSArray<NSString *> *arguments = NSProcessInfo.processInfo.arguments;
+    NSString *udid = ArgumentValue(arguments, @"--udid");
+    NSArray<NSString *> *scenarios = [ArgumentValue(arguments, @"--scenarios") ?: @"afc,plist,syslog,video" componentsSeparatedByString:@","];
+    NSArray<NSNumber *> *sizes = ParseSizes(ArgumentValue(arguments, @"--sizes") ?: @"4K,64K,1M,16M,256M,1G");
+    NSUInteger iterations = (NSUInteger) MAX(1, [ArgumentValue(arguments, @"--iterations") ?: @"200" integerValue]);
+    NSTimeInterval duration = MAX(1, [ArgumentValue(arguments, @"--duration") ?: @"10" doubleValue]);
+    NSArray<FBVideoStreamEncoding> *encodings = [ArgumentValue(arguments, @"--encodings") ?: @"h264,hevc,mjpeg" componentsSeparatedByString:@","];
+    NSString *outputPath = ArgumentValue(arguments, @"--output");
+    if (!sizes) {
+      NSLog(@"Invalid --sizes, expected a list such as 4K,1M,1G");
+      return 1;
+    }
+    id<FBControlCoreLogger> logger = [FBControlCoreLoggerFactory systemLoggerWritingToStderr:NO withDebugLogging:NO];
+
+    NSError *error = nil;
+    FBDeviceSet *deviceSet = [FBDeviceSet setWithLogger:logger delegate:nil ecidFilter:nil error:&error];
+    if (!deviceSet) {
+      NSLog(@"Failed to create the device set: %@", error);
+      return 1;
+    }
+    // Devices are discovered through notifications, which are delivered on the main run loop.
+    FBDevice *device = [NSRunLoop.currentRunLoop spinRunLoopWithTimeout:DeviceDiscoveryTimeout untilExists:^ FBDevice * {
+      return udid ? [deviceSet deviceWithUDID:udid] : deviceSet.allDevices.firstObject;
+    }];
+    if (!device) {
+      NSLog(@"No device %@ was attached within %.0f seconds", udid ?: @"", DeviceDiscoveryTimeout);
+      return 1;
+    }
+    NSLog(@"Benchmarking %@", device);
+
+    FBHardwareBenchmarks *benchmarks = [[FBHardwareBenchmarks alloc] initWithDevice:device logger:logger];
+    NSMutableArray<NSDictionary<NSString *, id> *> *results = [NSMutableArray array];
+    if ([scenarios containsObject:@"afc"]) {
+      [results addObjectsFromArray:[benchmarks runAFCWithSizes:sizes]];
+    }
+    if ([scenarios containsObject:@"plist"]) {
+      [results addObjectsFromArray:[benchmarks runPlistRoundTripWithIterations:iterations]];
+    }
+    if ([scenarios containsObject:@"syslog"]) {
+      [results addObjectsFromArray:[benchmarks runSyslogWithDuration:duration]];
+    }
+    if ([scenarios containsObject:@"video"]) {
+      [results addObjectsFromArray:[benchmarks runVideoWithEncodings:encodings duration:duration]];
+    }
+
+    NSDictionary<NSString *, id> *report = @{
+      @"device": @{
+        @"udid": device.udid,
+        @"name": device.name,
+        @"model": device.deviceType.model ?: @"",
+        @"os_version": device.osVersion.versionString ?: @"",
+      },
+      @"host": @{
+        @"name": NSProcessInfo.processInfo.hostName,
+        @"os_version": NSProcessInfo.processInfo.operatingSystemVersionString,
+      },
+      @"date": [[[NSISO8601DateFormatter alloc] init] stringFromDate:NSDate.date],
+      @"results": results,
+    };
+    if (outputPath) {
+      NSData *data = [NSJSONSerialization dataWithJSONObject:report options:NSJSONWritingPrettyPrinted | NSJSONWritingSortedKeys error:nil];
+      [data writeToFile:outputPath atomically:YES];
+    }
+    for (NSDictionary<NSString *, id> *result in results) {
+      if (result[@"error"]) {
+        NSLog(@"%@ failed: %@", result[@"name"], result[@"error"]);
+      }
+    }
+  }
+  return 0;
+}
@@ -78,6 +78,12 @@ final class AppDelegate: NSObject, NSApplicationDelegate, FormatMenuProvider {
         // 启动捕获电源协调器（管理防休眠）
         CapturePowerCoordinator.shared.start()
 
+        // 启动内存压力协调器（内存紧张时释放缓存、降低不可见设备的解码量）
+        MemoryPressureCoordinator.shared.start()
+
+        // 启动主线程卡顿检测（卡顿报告显示在捕获信息中，并写入性能日志）
+        MainThreadWatchdog.shared.start()
+
         // 初始化自动更新管理器
         UpdateManager.shared.initialize()
 
@@ -195,6 +201,8 @@ final class AppDelegate: NSObject, NSApplicationDelegate, FormatMenuProvider {
 
         // 停止捕获电源协调器（释放防休眠 assertion）
         CapturePowerCoordinator.shared.stop()
+        MemoryPressureCoordinator.shared.stop()
+        MainThreadWatchdog.shared.stop()
 
         // 清理资源
         Task {
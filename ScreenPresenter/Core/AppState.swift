@@ -39,6 +39,12 @@ final class AppState {
     /// Android 设备源
     private(set) var androidDeviceSource: ScrcpyDeviceSource?
 
+    /// 热备中的 Android 设备源（最近使用的在后），切回这些设备时无需重新推送、启动 server 与等待关键帧
+    private var androidStandbySources: [ScrcpyDeviceSource] = []
+
+    /// 热备设备源数量上限
+    private let androidStandbyLimit = 2
+
     /// 是否正在初始化
     private(set) var isInitializing = true
 
@@ -115,6 +121,7 @@ final class AppState {
             await source.stopCapture()
             await source.disconnect()
         }
+        await dropStandbySources { _ in true }
 
         // 停止监控
         iosDeviceProvider.stopMonitoring()
@@ -138,6 +145,7 @@ final class AppState {
             if let device = iosDeviceProvider.devices.first {
                 let newSource = IOSDeviceSource(device: device)
                 iosDeviceSource = newSource
+                newSource.markStartup(.captureRequested)
                 try await newSource.connect()
                 try await newSource.startCapture()
             } else {
@@ -146,6 +154,7 @@ final class AppState {
             return
         }
 
+        source.markStartup(.captureRequested)
         if source.state == .idle || source.state == .disconnected {
             try await source.connect()
         }
@@ -172,6 +181,7 @@ final class AppState {
                     toolchainManager: toolchainManager
                 )
                 androidDeviceSource = newSource
+                newSource.markStartup(.captureRequested)
                 try await newSource.connect()
                 try await newSource.startCapture()
             } else {
@@ -180,6 +190,7 @@ final class AppState {
             return
         }
 
+        source.markStartup(.captureRequested)
         if source.state == .idle || source.state == .disconnected {
             try await source.connect()
         }
@@ -269,23 +280,40 @@ final class AppState {
     private func handleAndroidDeviceChange() async {
         let currentDevice = androidDeviceProvider.devices.first
 
+        // 已拔出设备的热备会话无法再使用
+        await dropStandbySources { source in
+            !androidDeviceProvider.devices.contains { $0.serial == source.deviceInfo?.id }
+        }
+
         if let device = currentDevice {
             // 设备已连接
             if androidDeviceSource == nil || androidDeviceSource?.deviceInfo?.id != device.serial {
-                // 断开旧设备
+                // 正在捕获的旧设备转入热备，否则断开
                 if let oldSource = androidDeviceSource {
-                    await oldSource.stopCapture()
-                    await oldSource.disconnect()
+                    if oldSource.state == .capturing {
+                        await moveToStandby(oldSource)
+                    } else {
+                        await oldSource.stopCapture()
+                        await oldSource.disconnect()
+                    }
                 }
 
-                // 创建新设备源（不自动捕获）
-                let source = ScrcpyDeviceSource(
-                    device: device,
-                    toolchainManager: toolchainManager
-                )
-                androidDeviceSource = source
+                if let index = androidStandbySources.firstIndex(where: { $0.deviceInfo?.id == device.serial }) {
+                    // 提升热备会话，无需冷启动
+                    let source = androidStandbySources.remove(at: index)
+                    source.leaveStandby()
+                    androidDeviceSource = source
+                    AppLogger.device.info("Android 设备已连接（热备提升）: \(device.displayName)")
+                } else {
+                    // 创建新设备源（不自动捕获）
+                    let source = ScrcpyDeviceSource(
+                        device: device,
+                        toolchainManager: toolchainManager
+                    )
+                    androidDeviceSource = source
+                    AppLogger.device.info("Android 设备已连接: \(device.displayName)")
+                }
 
-                AppLogger.device.info("Android 设备已连接: \(device.displayName)")
                 stateChangedPublisher.send()
             }
         } else {
@@ -301,6 +329,32 @@ final class AppState {
         }
     }
 
+    /// 将设备源转入热备，超出上限时停止最久未使用的会话
+    private func moveToStandby(_ source: ScrcpyDeviceSource) async {
+        source.enterStandby()
+        androidStandbySources.append(source)
+
+        while androidStandbySources.count > androidStandbyLimit {
+            let evicted = androidStandbySources.removeFirst()
+            AppLogger.device.info("停止热备会话: \(evicted.displayName)")
+            await evicted.stopCapture()
+            await evicted.disconnect()
+        }
+    }
+
+    /// 停止并移除满足条件的热备会话
+    private func dropStandbySources(where shouldDrop: (ScrcpyDeviceSource) -> Bool) async {
+        let dropped = androidStandbySources.filter(shouldDrop)
+        guard !dropped.isEmpty else { return }
+
+        androidStandbySources.removeAll(where: shouldDrop)
+        for source in dropped {
+            AppLogger.device.info("停止热备会话: \(source.displayName)")
+            await source.stopCapture()
+            await source.disconnect()
+        }
+    }
+
     // MARK: - 计算属性
 
     /// 当前 iOS 设备（用于获取完整设备信息）
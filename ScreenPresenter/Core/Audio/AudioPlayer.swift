@@ -9,17 +9,26 @@
 //  支持音量控制、静音功能和缓冲调节
 //
 
+import Accelerate
 import AVFoundation
 import CoreMedia
 import Foundation
 
 // MARK: - 音频播放器
 
+/// 拉取模式的输出方式
+enum AudioPullOutputMode {
+    /// 渲染回调：AVAudioSourceNode 在音频实时线程上直接从调节器拉取到硬件缓冲区
+    case renderCallback
+    /// 定时调度：定时器周期性拉取并通过 scheduleBuffer 调度（每次分配缓冲区，受队列调度抖动影响）
+    case scheduledBuffer
+}
+
 /// 音频播放器
 /// 使用 AVAudioEngine 播放从设备捕获的音频采样
 /// 支持两种模式：
 /// 1. 推送模式（直接调度缓冲区）- 简单但可能有抖动
-/// 2. 拉取模式（通过 AudioRegulator）- 更平滑的播放体验
+/// 2. 拉取模式（通过 AudioRegulator）- 更平滑的播放体验，默认由渲染回调驱动
 final class AudioPlayer {
     // MARK: - 常量
 
@@ -27,6 +36,9 @@ final class AudioPlayer {
     /// 10ms @ 48kHz = 480 samples
     private static let pullBufferFrameCount: AVAudioFrameCount = 480
 
+    /// 渲染回调单次处理的最大帧数（超过时分段拉取）
+    private static let renderChunkFrameCount = 4096
+
     // MARK: - 属性
 
     /// 音频引擎
@@ -87,12 +99,22 @@ final class AudioPlayer {
     /// 拉取模式的输出格式
     private var pullOutputFormat: AVAudioFormat?
 
+    /// 拉取模式的输出方式
+    private(set) var pullOutputMode: AudioPullOutputMode = .renderCallback
+
+    /// 渲染回调节点（renderCallback 输出方式）
+    private var sourceNode: AVAudioSourceNode?
+
+    /// 渲染回调的 interleaved 中转缓冲区（创建节点时分配一次，实时线程上不再分配）
+    private var renderScratch: UnsafeMutableBufferPointer<Float>?
+
     // MARK: - 初始化
 
     init() {}
 
     deinit {
         stop()
+        releaseRenderScratch()
     }
 
     // MARK: - 公开方法
@@ -183,12 +205,13 @@ final class AudioPlayer {
             playerNode?.play()
             isPlaying = true
 
-            // 如果启用了调节器，启动拉取模式
-            if usePullMode {
+            // 定时调度方式需要启动拉取定时器，渲染回调方式由引擎驱动
+            if usePullMode, pullOutputMode == .scheduledBuffer {
                 startPullMode()
             }
 
-            AppLogger.capture.info("[AudioPlayer] 开始播放 (模式: \(usePullMode ? "拉取" : "推送"))")
+            let modeName = usePullMode ? (pullOutputMode == .renderCallback ? "拉取/渲染回调" : "拉取/定时调度") : "推送"
+            AppLogger.capture.info("[AudioPlayer] 开始播放 (模式: \(modeName))")
         } catch {
             AppLogger.capture.error("[AudioPlayer] 启动失败: \(error.localizedDescription)")
         }
@@ -218,6 +241,8 @@ final class AudioPlayer {
         audioEngine = nil
         playerNode = nil
         mixerNode = nil
+        sourceNode = nil
+        releaseRenderScratch()
         audioFormat = nil
         playbackFormat = nil
         audioConverter = nil
@@ -322,20 +347,43 @@ final class AudioPlayer {
         }
     }
 
+    /// 处理 PCM 样本（解码器输出的借用缓冲区，仅在调用期间有效）
+    /// 拉取模式下直接写入调节器的环形缓冲区，不分配内存
+    /// - Parameters:
+    ///   - samples: PCM 样本（Float32 格式，interleaved）
+    ///   - format: 音频格式
+    func processPCMSamples(_ samples: UnsafeBufferPointer<Float>, format: AVAudioFormat) {
+        if usePullMode, isPlaying, let regulator = audioRegulator {
+            regulator.push(samples: samples)
+            return
+        }
+
+        // 未初始化或推送模式：按 Data 处理
+        processPCMData(Data(buffer: samples), format: format)
+    }
+
     // MARK: - 拉取模式（AudioRegulator 集成）
 
     /// 启用音频调节器（拉取模式）
+    /// 需在播放器初始化（创建音频引擎）之前调用
     /// - Parameters:
     ///   - sampleRate: 采样率
     ///   - channels: 声道数
     ///   - targetBufferingMs: 目标缓冲时长（毫秒）
-    func enableRegulator(sampleRate: Int = 48000, channels: Int = 2, targetBufferingMs: Int = 50) {
+    ///   - outputMode: 输出方式
+    func enableRegulator(
+        sampleRate: Int = 48000,
+        channels: Int = 2,
+        targetBufferingMs: Int = 50,
+        outputMode: AudioPullOutputMode = .renderCallback
+    ) {
         audioRegulator = AudioRegulator(
             targetBufferingMs: targetBufferingMs,
             sampleRate: sampleRate,
             channels: channels
         )
         usePullMode = true
+        pullOutputMode = outputMode
 
         // 创建拉取模式的输出格式
         pullOutputFormat = AVAudioFormat(
@@ -345,7 +393,13 @@ final class AudioPlayer {
             interleaved: false
         )
 
-        AppLogger.capture.info("[AudioPlayer] 已启用音频调节器，目标缓冲: \(targetBufferingMs)ms")
+        AppLogger.capture.info("[AudioPlayer] 已启用音频调节器，目标缓冲: \(targetBufferingMs)ms, 输出: \(outputMode)")
+    }
+
+    /// 设置建议的播放速率（由调节器以小幅重采样补偿时钟漂移）
+    /// - Parameter rate: 建议的播放速率（1.0 为原速）
+    func setSuggestedPlaybackRate(_ rate: Float) {
+        audioRegulator?.setSuggestedPlaybackRate(rate)
     }
 
     /// 禁用音频调节器
@@ -430,6 +484,48 @@ final class AudioPlayer {
         playerNode.scheduleBuffer(pcmBuffer, completionHandler: nil)
     }
 
+    // MARK: - 渲染回调输出
+
+    /// 创建渲染回调节点
+    /// 回调在音频实时线程上执行：从调节器拉取 interleaved 样本到预分配的中转缓冲区，再拆分到各声道的硬件缓冲区
+    /// 回调中不加锁、不分配内存、不记录日志
+    private func makeSourceNode(regulator: AudioRegulator, format: AVAudioFormat) -> AVAudioSourceNode {
+        let channels = Int(format.channelCount)
+        let scratch = UnsafeMutableBufferPointer<Float>.allocate(capacity: Self.renderChunkFrameCount * channels)
+        scratch.initialize(repeating: 0)
+        releaseRenderScratch()
+        renderScratch = scratch
+
+        return AVAudioSourceNode(format: format) { isSilence, _, frameCount, audioBufferList -> OSStatus in
+            let buffers = UnsafeMutableAudioBufferListPointer(audioBufferList)
+            let totalFrames = Int(frameCount)
+            var renderedFrames = 0
+            var readSamples = 0
+
+            while renderedFrames < totalFrames {
+                let chunkFrames = min(totalFrames - renderedFrames, Self.renderChunkFrameCount)
+                let chunk = UnsafeMutableBufferPointer(rebasing: scratch[0..<(chunkFrames * channels)])
+                readSamples += regulator.pull(into: chunk)
+
+                // interleaved -> non-interleaved
+                for channel in 0..<min(channels, buffers.count) {
+                    guard let data = buffers[channel].mData, let source = chunk.baseAddress else { continue }
+                    let destination = data.assumingMemoryBound(to: Float.self).advanced(by: renderedFrames)
+                    vDSP_mmov(source.advanced(by: channel), destination, 1, vDSP_Length(chunkFrames), vDSP_Length(channels), 1)
+                }
+                renderedFrames += chunkFrames
+            }
+
+            isSilence.pointee = ObjCBool(readSamples == 0)
+            return noErr
+        }
+    }
+
+    private func releaseRenderScratch() {
+        renderScratch?.deallocate()
+        renderScratch = nil
+    }
+
     /// 从 interleaved Float 样本创建 non-interleaved PCM 缓冲区
     private func createPCMBuffer(
         fromInterleavedSamples samples: [Float],
@@ -473,6 +569,14 @@ final class AudioPlayer {
         // 使用指定的格式连接 player 到 mixer
         engine.connect(player, to: mixer, format: format)
 
+        // 渲染回调输出：source -> mixer，由引擎在硬件需要数据时拉取
+        if usePullMode, pullOutputMode == .renderCallback, let regulator = audioRegulator, let pullFormat = pullOutputFormat {
+            let source = makeSourceNode(regulator: regulator, format: pullFormat)
+            engine.attach(source)
+            engine.connect(source, to: mixer, format: pullFormat)
+            sourceNode = source
+        }
+
         // 连接 mixer 到 output 时使用 nil 格式，让 AVAudioEngine 自动处理格式转换
         // 这可以避免格式不兼容的问题
         engine.connect(mixer, to: engine.outputNode, format: nil)
@@ -7,10 +7,15 @@
 //  音频调节器
 //  参考 scrcpy 的 audio_regulator.c 实现
 //  使用环形缓冲区和自适应策略解决音频抖动问题
+//  推送（解码线程）与拉取（渲染回调）通过无锁环形缓冲区交换数据，拉取路径不加锁、不分配内存
+//  时钟漂移通过小幅调整播放速率补偿（vDSP 线性插值的小数重采样），偏差过大时才跳过样本
 //
 
+import Accelerate
 import AVFoundation
+import FBDeviceControlKit
 import Foundation
+import os.lock
 
 /// 音频调节器
 /// 负责音频缓冲管理和流量控制，避免音频卡顿或延迟累积
@@ -35,6 +40,15 @@ final class AudioRegulator {
     /// 补偿检测周期（样本数）
     private static let compensationCheckPeriod: Int = 960 // 20ms @ 48kHz
 
+    /// 播放速率的最大修正幅度（±0.5%，约 9 音分，听感上无法察觉）
+    private static let maxRateCorrection: Double = 0.005
+
+    /// 低于此修正幅度时按原速播放，不做重采样
+    private static let minRateCorrection: Double = 0.0002
+
+    /// 单次重采样的最大输出帧数（超过时按原速读取）
+    private static let maxResampleFrames = 4096
+
     // MARK: - 属性
 
     /// 采样率
@@ -43,9 +57,6 @@ final class AudioRegulator {
     /// 声道数
     private let channels: Int
 
-    /// 每样本字节数
-    private let bytesPerSample: Int
-
     /// 目标缓冲样本数
     private let targetBuffering: Int
 
@@ -55,26 +66,14 @@ final class AudioRegulator {
     /// 重同步阈值样本数
     private let resyncThreshold: Int
 
-    /// 环形缓冲区
-    private var ringBuffer: RingBuffer<Float>
-
-    /// 线程安全锁
-    private let lock = NSLock()
+    /// 环形缓冲区（原始 Float 内存，批量 memcpy 读写）
+    private let ringBuffer: FBAudioRingBuffer
 
-    // MARK: - 状态
-
-    /// 是否已接收到数据
-    private var hasReceived = false
+    // MARK: - 消费者状态（只在拉取线程访问，实时线程上无锁）
 
     /// 是否已开始播放
     private var hasPlayed = false
 
-    /// 下溢样本计数（用于统计）
-    private var underflowSamples: Int = 0
-
-    /// 溢出样本计数（用于统计）
-    private var overflowSamples: Int = 0
-
     /// 平均缓冲量（指数移动平均）
     private var avgBuffering: Double = 0
 
@@ -84,6 +83,69 @@ final class AudioRegulator {
     /// 累积补偿样本数
     private var compensationPending: Int = 0
 
+    /// 尚未合并到共享统计的增量
+    private var pendingStatistics = Statistics()
+
+    /// 当前播放速率（>1 消耗快于输出，用于消化多余缓冲）
+    private var playbackRate: Double = 1
+
+    /// 外部建议的播放速率（已限制在最大修正幅度内）
+    private var externalPlaybackRate: Double = 1
+
+    /// 重采样的小数读位置（相对于环形缓冲区读位置，单位为帧）
+    private var resamplePhase: Double = 0
+
+    // MARK: - 重采样缓冲区（初始化时分配，拉取路径上不再分配）
+
+    /// 单次重采样的最大输入帧数
+    private let maxResampleInputFrames: Int
+
+    /// 按声道拆分的输入样本（channels × maxResampleInputFrames）
+    private let resampleInput: UnsafeMutablePointer<Float>
+
+    /// 输出帧对应的输入位置
+    private let resamplePositions: UnsafeMutablePointer<Float>
+
+    /// 单个声道的重采样输出
+    private let resampleOutput: UnsafeMutablePointer<Float>
+
+    /// 外部速率建议（推送端写入，拉取端以 withLockIfAvailable 读取）
+    private let rateSuggestion = OSAllocatedUnfairLock(initialState: 1.0)
+
+    // MARK: - 统计
+
+    /// 调节统计
+    private struct Statistics {
+        /// 下溢样本数
+        var underflowSamples = 0
+        /// 溢出丢弃样本数
+        var overflowSamples = 0
+        /// 重同步跳过的样本数
+        var resyncSamples = 0
+        /// 平均缓冲量（样本数）
+        var avgBuffering: Double = 0
+        /// 是否已开始播放
+        var hasPlayed = false
+        /// 当前播放速率
+        var playbackRate: Double = 1
+
+        mutating func merge(_ other: Statistics) {
+            underflowSamples += other.underflowSamples
+            overflowSamples += other.overflowSamples
+            resyncSamples += other.resyncSamples
+            avgBuffering = other.avgBuffering
+            hasPlayed = other.hasPlayed
+            playbackRate = other.playbackRate
+        }
+    }
+
+    /// 共享统计
+    /// 拉取线程只用 withLockIfAvailable 合并增量，拿不到锁时留到下一次，不会在实时线程上等待
+    private let statistics = OSAllocatedUnfairLock(initialState: Statistics())
+
+    /// 上次记录日志时的统计（只在推送线程访问）
+    private var loggedStatistics = Statistics()
+
     /// 上次日志时间
     private var lastLogTime: CFAbsoluteTime = 0
 
@@ -101,20 +163,26 @@ final class AudioRegulator {
     ) {
         self.sampleRate = sampleRate
         self.channels = channels
-        bytesPerSample = MemoryLayout<Float>.size
 
         // 计算缓冲样本数
         targetBuffering = targetBufferingMs * sampleRate / 1000
         maxBuffering = Self.maxBufferingMs * sampleRate / 1000
         resyncThreshold = Self.resyncThresholdMs * sampleRate / 1000
 
-        // 创建环形缓冲区（容量 = 最大缓冲 * 2 * 声道数）
+        // 创建环形缓冲区（容量 ≥ 最大缓冲 * 2 * 声道数，向上取整为 2 的幂）
+        // 超过最大缓冲的部分由拉取端丢弃，容量留出余量，拉取端短暂停顿时推送端不会被挡住
         let bufferCapacity = maxBuffering * 2 * channels
-        ringBuffer = RingBuffer<Float>(capacity: bufferCapacity + 1) // +1 for ring buffer implementation
+        ringBuffer = FBAudioRingBuffer(minimumCapacity: bufferCapacity)
 
         // 初始化平均缓冲估算
         avgBuffering = Double(targetBuffering)
 
+        // 分配重采样缓冲区（线性插值需要额外一帧）
+        maxResampleInputFrames = Int(Double(Self.maxResampleFrames) * (1 + Self.maxRateCorrection)) + 2
+        resampleInput = .allocate(capacity: maxResampleInputFrames * channels)
+        resamplePositions = .allocate(capacity: Self.maxResampleFrames)
+        resampleOutput = .allocate(capacity: Self.maxResampleFrames)
+
         AppLogger.capture.info("""
         [AudioRegulator] 已初始化
         - 采样率: \(sampleRate)Hz
@@ -124,41 +192,34 @@ final class AudioRegulator {
         """)
     }
 
+    deinit {
+        resampleInput.deallocate()
+        resamplePositions.deallocate()
+        resampleOutput.deallocate()
+    }
+
     // MARK: - 推送数据（生产者）
 
     /// 推送音频数据到缓冲区
     /// - Parameter data: PCM 音频数据（Float32 interleaved 格式）
     func push(_ data: Data) {
-        lock.lock()
-        defer { lock.unlock() }
-
-        hasReceived = true
-
-        let sampleCount = data.count / bytesPerSample / channels
-
-        // 计算当前缓冲量
-        let currentBuffered = ringBuffer.count / channels
-
-        // 检查是否溢出
-        if currentBuffered + sampleCount > maxBuffering {
-            // 丢弃最旧的数据，为新数据腾出空间
-            let overflow = currentBuffered + sampleCount - maxBuffering
-            let samplesToDiscard = overflow * channels
-            _ = ringBuffer.skip(samplesToDiscard)
-            overflowSamples += overflow
-
-            logOccasionally("[AudioRegulator] 缓冲区溢出，丢弃 \(overflow) 样本")
+        data.withUnsafeBytes { rawBuffer in
+            push(samples: rawBuffer.bindMemory(to: Float.self))
         }
+    }
 
-        // 写入数据
-        let written = ringBuffer.writeAudioSamples(from: data)
+    /// 推送音频样本到缓冲区（解码器直接写入，不经过 Data 中转）
+    /// - Parameter samples: PCM 样本（Float32 interleaved 格式）
+    func push(samples: UnsafeBufferPointer<Float>) {
+        let written = ringBuffer.write(from: samples)
 
-        if written < data.count / bytesPerSample {
-            // 仍有数据未能写入（理论上不应该发生）
-            AppLogger.capture.warning("[AudioRegulator] 写入不完整: \(written) / \(data.count / bytesPerSample)")
+        if written < samples.count {
+            // 拉取端长时间停顿，环形缓冲区已满，丢弃本次剩余数据
+            let dropped = (samples.count - written) / channels
+            statistics.withLock { $0.overflowSamples += dropped }
         }
 
-        updateBufferingEstimate()
+        logConsumerEvents()
     }
 
     // MARK: - 拉取数据（消费者）
@@ -167,38 +228,56 @@ final class AudioRegulator {
     /// - Parameter sampleCount: 需要的样本数（单声道）
     /// - Returns: Float 数组（interleaved 格式，长度 = sampleCount * channels）
     func pull(sampleCount: Int) -> [Float] {
-        lock.lock()
-        defer { lock.unlock() }
+        [Float](unsafeUninitializedCapacity: sampleCount * channels) { buffer, initializedCount in
+            pull(into: buffer)
+            initializedCount = buffer.count
+        }
+    }
 
-        let frameCount = sampleCount * channels
+    /// 从缓冲区拉取音频数据到调用方提供的缓冲区
+    /// 不加锁、不分配内存、不记录日志，可在音频渲染回调（实时线程）中调用
+    /// - Parameter output: 目标缓冲区（interleaved 格式），长度应为声道数的整数倍；数据不足的部分填充静音
+    /// - Returns: 从缓冲区读出的样本数（interleaved），0 表示输出全为静音
+    @discardableResult
+    func pull(into output: UnsafeMutableBufferPointer<Float>) -> Int {
+        let frameCount = output.count
+        let sampleCount = frameCount / channels
 
         // 首次播放：检查是否有足够的缓冲
         if !hasPlayed {
-            let bufferedSamples = ringBuffer.count / channels
-            if bufferedSamples < targetBuffering {
+            if ringBuffer.count / channels < targetBuffering {
                 // 缓冲不足，返回静音
-                return [Float](repeating: 0, count: frameCount)
+                output.update(repeating: 0)
+                return 0
             }
             hasPlayed = true
-            // 避免在持有锁时访问 bufferedMs 属性（它也会获取锁，导致死锁）
-            let bufferedMsValue = Double(bufferedSamples) * 1000.0 / Double(sampleRate)
-            AppLogger.capture.info("[AudioRegulator] 开始播放，缓冲: \(bufferedSamples) 样本 (\(bufferedMsValue)ms)")
         }
 
-        // 读取数据
-        var output = ringBuffer.readAudioSamples(count: frameCount)
+        // 缓冲超过上限：丢弃最旧的数据（读位置只由拉取端移动）
+        let buffered = ringBuffer.count / channels
+        if buffered > maxBuffering {
+            let overflow = buffered - maxBuffering
+            ringBuffer.skip(overflow * channels)
+            pendingStatistics.overflowSamples += overflow
+        }
 
-        // 处理下溢
-        if output.count < frameCount {
-            let silenceCount = frameCount - output.count
-            output.append(contentsOf: [Float](repeating: 0, count: silenceCount))
-            underflowSamples += silenceCount / channels
+        // 读取数据（播放速率偏离原速时经小数重采样读取，数据不足时按原速读取）
+        let readCount: Int
+        if playbackRate != 1, let resampledCount = readResampled(into: output) {
+            readCount = resampledCount
+        } else {
+            resamplePhase = 0
+            readCount = ringBuffer.read(into: output)
+        }
 
-            if hasReceived {
-                logOccasionally("[AudioRegulator] 下溢，插入 \(silenceCount / channels) 样本静音")
-            }
+        // 处理下溢
+        if readCount < frameCount {
+            UnsafeMutableBufferPointer(rebasing: output[readCount...]).update(repeating: 0)
+            pendingStatistics.underflowSamples += (frameCount - readCount) / channels
         }
 
+        updateBufferingEstimate()
+
         // 更新重同步计数
         samplesSinceResync += sampleCount
 
@@ -208,7 +287,8 @@ final class AudioRegulator {
             samplesSinceResync = 0
         }
 
-        return output
+        publishStatistics()
+        return readCount
     }
 
     // MARK: - 缓冲估算与补偿
@@ -224,6 +304,14 @@ final class AudioRegulator {
         let deviation = avgBuffering - Double(targetBuffering)
         let deviationSamples = Int(deviation)
 
+        // 小幅调整播放速率：缓冲偏多时略快消耗，偏少时略慢，叠加外部（AudioSynchronizer）建议
+        if let suggestedRate = rateSuggestion.withLockIfAvailable({ $0 }) {
+            externalPlaybackRate = suggestedRate
+        }
+        let bufferCorrection = deviation / Double(resyncThreshold) * Self.maxRateCorrection
+        let correction = min(max(bufferCorrection + externalPlaybackRate - 1, -Self.maxRateCorrection), Self.maxRateCorrection)
+        playbackRate = abs(correction) < Self.minRateCorrection ? 1 : 1 + correction
+
         // 累积补偿
         compensationPending += deviationSamples
 
@@ -232,10 +320,9 @@ final class AudioRegulator {
             if compensationPending > 0 {
                 // 缓冲过多：跳过一些样本
                 let samplesToSkip = min(compensationPending, resyncThreshold / 2)
-                _ = ringBuffer.skip(samplesToSkip * channels)
+                ringBuffer.skip(samplesToSkip * channels)
                 compensationPending -= samplesToSkip
-
-                logOccasionally("[AudioRegulator] 重同步：跳过 \(samplesToSkip) 样本")
+                pendingStatistics.resyncSamples += samplesToSkip
             } else {
                 // 缓冲不足：会在 pull 时自动插入静音
                 compensationPending = 0
@@ -243,21 +330,119 @@ final class AudioRegulator {
         }
     }
 
-    private func logOccasionally(_ message: String) {
+    // MARK: - 小数重采样
+
+    /// 以当前播放速率从环形缓冲区重采样读取
+    /// 直接在环形缓冲区的可读连续段上按声道拆分，经 vDSP 线性插值后交织写入输出，只提交实际消耗的输入帧
+    /// - Parameter output: 目标缓冲区（interleaved）
+    /// - Returns: 写入的样本数；缓冲数据不足或输出过长时返回 nil，由调用方按原速读取
+    private func readResampled(into output: UnsafeMutableBufferPointer<Float>) -> Int? {
+        let outputFrames = output.count / channels
+        guard outputFrames > 0, outputFrames <= Self.maxResampleFrames, let outputBase = output.baseAddress else {
+            return nil
+        }
+
+        // 输出第 i 帧对应输入位置 phase + i * rate，插值还需要其后一帧
+        let lastPosition = resamplePhase + Double(outputFrames - 1) * playbackRate
+        let inputFrames = Int(lastPosition) + 2
+        guard inputFrames <= maxResampleInputFrames, ringBuffer.count / channels >= inputFrames else {
+            return nil
+        }
+
+        // 可读区域最多两段；容量不是声道数的整数倍时回绕点可能落在帧内部，此时按原速读取
+        let segments = ringBuffer.readableSegments()
+        guard let first = segments.first, segments.firstCount % channels == 0 else {
+            return nil
+        }
+        let firstFrames = min(segments.firstCount / channels, inputFrames)
+        deinterleave(first, frames: firstFrames, toFrame: 0)
+        if inputFrames > firstFrames {
+            guard let second = segments.second else { return nil }
+            deinterleave(second, frames: inputFrames - firstFrames, toFrame: firstFrames)
+        }
+
+        // 输入位置: phase, phase + rate, phase + 2 * rate ...
+        var start = Float(resamplePhase)
+        var step = Float(playbackRate)
+        vDSP_vramp(&start, &step, resamplePositions, 1, vDSP_Length(outputFrames))
+
+        for channel in 0..<channels {
+            let channelInput = resampleInput.advanced(by: channel * maxResampleInputFrames)
+            vDSP_vlint(channelInput, resamplePositions, 1, resampleOutput, 1, vDSP_Length(outputFrames), vDSP_Length(inputFrames))
+            // 单声道 -> interleaved
+            vDSP_mmov(resampleOutput, outputBase.advanced(by: channel), 1, vDSP_Length(outputFrames), 1, vDSP_Length(channels))
+        }
+
+        // 只提交完整消耗的输入帧，小数部分留给下一次
+        let endPosition = resamplePhase + Double(outputFrames) * playbackRate
+        let consumedFrames = Int(endPosition)
+        resamplePhase = endPosition - Double(consumedFrames)
+        ringBuffer.commitRead(consumedFrames * channels)
+
+        return outputFrames * channels
+    }
+
+    /// interleaved -> 按声道拆分到 resampleInput
+    private func deinterleave(_ source: UnsafeMutablePointer<Float>, frames: Int, toFrame offset: Int) {
+        for channel in 0..<channels {
+            let destination = resampleInput.advanced(by: channel * maxResampleInputFrames + offset)
+            vDSP_mmov(source.advanced(by: channel), destination, 1, vDSP_Length(frames), vDSP_Length(channels), 1)
+        }
+    }
+
+    // MARK: - 速率建议
+
+    /// 设置外部建议的播放速率（如 AudioSynchronizer 根据 PTS 漂移给出的建议）
+    /// 建议值只决定修正方向，幅度限制在 ±0.5% 以内，避免可闻的音调变化
+    /// - Parameter rate: 建议的播放速率（1.0 为原速）
+    func setSuggestedPlaybackRate(_ rate: Float) {
+        let clamped = min(max(Double(rate), 1 - Self.maxRateCorrection), 1 + Self.maxRateCorrection)
+        rateSuggestion.withLock { $0 = clamped }
+    }
+
+    /// 将拉取端的统计增量合并到共享统计（拿不到锁时保留增量，不等待）
+    private func publishStatistics() {
+        var pending = pendingStatistics
+        pending.avgBuffering = avgBuffering
+        pending.hasPlayed = hasPlayed
+        pending.playbackRate = playbackRate
+        let merged = statistics.withLockIfAvailable { $0.merge(pending) } != nil
+        if merged {
+            pendingStatistics = Statistics()
+        }
+    }
+
+    /// 在推送线程记录拉取端发生的事件（拉取端可能在实时线程上，不在那里记录日志）
+    private func logConsumerEvents() {
         let now = CFAbsoluteTimeGetCurrent()
-        if now - lastLogTime > 1.0 { // 每秒最多记录一次
-            AppLogger.capture.debug("\(message)")
+        guard now - lastLogTime > 1.0 else { return } // 每秒最多记录一次
+
+        let current = statistics.withLock { $0 }
+        defer {
+            loggedStatistics = current
             lastLogTime = now
         }
+
+        if current.hasPlayed, !loggedStatistics.hasPlayed {
+            let bufferedMsValue = current.avgBuffering * 1000.0 / Double(sampleRate)
+            AppLogger.capture.info("[AudioRegulator] 开始播放，缓冲: \(String(format: "%.1f", bufferedMsValue))ms")
+        }
+        if current.underflowSamples > loggedStatistics.underflowSamples {
+            AppLogger.capture.debug("[AudioRegulator] 下溢，插入 \(current.underflowSamples - loggedStatistics.underflowSamples) 样本静音")
+        }
+        if current.overflowSamples > loggedStatistics.overflowSamples {
+            AppLogger.capture.debug("[AudioRegulator] 缓冲区溢出，丢弃 \(current.overflowSamples - loggedStatistics.overflowSamples) 样本")
+        }
+        if current.resyncSamples > loggedStatistics.resyncSamples {
+            AppLogger.capture.debug("[AudioRegulator] 重同步：跳过 \(current.resyncSamples - loggedStatistics.resyncSamples) 样本")
+        }
     }
 
     // MARK: - 状态查询
 
     /// 当前缓冲的样本数（单声道）
     var bufferedSamples: Int {
-        lock.lock()
-        defer { lock.unlock() }
-        return ringBuffer.count / channels
+        ringBuffer.count / channels
     }
 
     /// 当前缓冲时长（毫秒）
@@ -272,55 +457,52 @@ final class AudioRegulator {
 
     /// 平均缓冲量（样本数）
     var averageBufferedSamples: Double {
-        lock.lock()
-        defer { lock.unlock() }
-        return avgBuffering
+        statistics.withLock { $0.avgBuffering }
     }
 
     /// 下溢统计（样本数）
     var totalUnderflowSamples: Int {
-        lock.lock()
-        defer { lock.unlock() }
-        return underflowSamples
+        statistics.withLock { $0.underflowSamples }
     }
 
     /// 溢出统计（样本数）
     var totalOverflowSamples: Int {
-        lock.lock()
-        defer { lock.unlock() }
-        return overflowSamples
+        statistics.withLock { $0.overflowSamples }
     }
 
     // MARK: - 重置
 
     /// 重置调节器状态
+    /// 只在拉取端停止时调用（拉取端状态不加锁）
     func reset() {
-        lock.lock()
-        defer { lock.unlock() }
-
-        ringBuffer.clear()
-        hasReceived = false
+        ringBuffer.reset()
         hasPlayed = false
-        underflowSamples = 0
-        overflowSamples = 0
         avgBuffering = Double(targetBuffering)
         samplesSinceResync = 0
         compensationPending = 0
+        playbackRate = 1
+        externalPlaybackRate = 1
+        resamplePhase = 0
+        rateSuggestion.withLock { $0 = 1 }
+        pendingStatistics = Statistics()
+        statistics.withLock { $0 = Statistics(avgBuffering: avgBuffering) }
+        loggedStatistics = Statistics()
 
         AppLogger.capture.info("[AudioRegulator] 已重置")
     }
 
     /// 打印统计信息
     func logStatistics() {
-        lock.lock()
-        defer { lock.unlock() }
+        let current = statistics.withLock { $0 }
 
         AppLogger.capture.info("""
         [AudioRegulator] 统计信息
-        - 当前缓冲: \(ringBuffer.count / channels) 样本 (\(String(format: "%.1f", bufferedMs))ms)
-        - 平均缓冲: \(String(format: "%.1f", avgBuffering)) 样本
-        - 下溢总计: \(underflowSamples) 样本
-        - 溢出总计: \(overflowSamples) 样本
+        - 当前缓冲: \(bufferedSamples) 样本 (\(String(format: "%.1f", bufferedMs))ms)
+        - 平均缓冲: \(String(format: "%.1f", current.avgBuffering)) 样本
+        - 下溢总计: \(current.underflowSamples) 样本
+        - 溢出总计: \(current.overflowSamples) 样本
+        - 重同步跳过: \(current.resyncSamples) 样本
+        - 播放速率: \(String(format: "%.4f", current.playbackRate))
         """)
     }
 }
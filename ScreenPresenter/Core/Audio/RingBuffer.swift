@@ -4,10 +4,12 @@
 //
 //  Created by Sun on 2026/1/07.
 //
-//  通用环形缓冲区实现
-//  用于音频数据的无锁缓冲，支持生产者-消费者模式
+//  环形缓冲区实现
+//  RingBuffer: 通用 FIFO 环形缓冲区（非线程安全）
+//  FBAudioRingBuffer 扩展: 音频样本的无锁单生产者-单消费者缓冲
 //
 
+import FBDeviceControlKit
 import Foundation
 
 /// 通用环形缓冲区
@@ -197,28 +199,45 @@ final class RingBuffer<T> {
     }
 }
 
-// MARK: - 专门为 Float 音频数据优化的扩展
+// MARK: - Float 音频环形缓冲区
+
+/// 音频样本环形缓冲区（FBAudioRingBuffer 的 Swift 便捷接口）
+///
+/// 与通用 RingBuffer 不同：
+/// - 存储为原始 Float 内存，容量为 2 的幂，位置回绕只需一次按位与
+/// - 读写位置为原子计数器，单生产者（解码线程）与单消费者（播放线程）之间无需加锁
+/// - 批量读写最多两次 memcpy（回绕点两侧各一次），不逐样本处理，也不分配内存
+extension FBAudioRingBuffer {
+    /// 写入音频样本
+    /// - Parameter samples: 样本（Float32 interleaved）
+    /// - Returns: 实际写入的样本数（缓冲区已满时少于输入）
+    @discardableResult
+    func write(from samples: UnsafeBufferPointer<Float>) -> Int {
+        guard let baseAddress = samples.baseAddress, !samples.isEmpty else { return 0 }
+        return write(baseAddress, count: samples.count)
+    }
 
-extension RingBuffer where T == Float {
-    /// 批量写入 Float 音频数据
-    /// - Parameter data: 音频数据 (Float32 格式)
+    /// 写入音频数据
+    /// - Parameter data: PCM 数据（Float32 interleaved）
     /// - Returns: 实际写入的样本数
     @discardableResult
     func writeAudioSamples(from data: Data) -> Int {
-        return data.withUnsafeBytes { ptr -> Int in
-            guard let baseAddress = ptr.baseAddress else { return 0 }
-            let floatPtr = baseAddress.assumingMemoryBound(to: Float.self)
-            let floatCount = data.count / MemoryLayout<Float>.size
-            let bufferPtr = UnsafeBufferPointer(start: floatPtr, count: floatCount)
-            return write(from: bufferPtr)
+        data.withUnsafeBytes { rawBuffer in
+            write(from: rawBuffer.bindMemory(to: Float.self))
         }
     }
-    
-    /// 读取音频样本到缓冲区（用于 AVAudioPlayerNode）
-    /// - Parameters:
-    ///   - count: 要读取的样本数
-    /// - Returns: Float 数组
-    func readAudioSamples(count: Int) -> [Float] {
-        return read(count: count, defaultValue: 0.0)
+
+    /// 读取音频样本到调用方提供的缓冲区
+    /// - Parameter samples: 目标缓冲区
+    /// - Returns: 实际读取的样本数（缓冲数据不足时少于目标长度，剩余部分不写入）
+    @discardableResult
+    func read(into samples: UnsafeMutableBufferPointer<Float>) -> Int {
+        guard let baseAddress = samples.baseAddress, !samples.isEmpty else { return 0 }
+        return read(baseAddress, count: samples.count)
+    }
+
+    /// 当前可读样本数
+    var count: Int {
+        availableToRead
     }
 }
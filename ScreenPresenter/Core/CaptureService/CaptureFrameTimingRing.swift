@@ -0,0 +1,178 @@
+//
+//  CaptureFrameTimingRing.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  捕获帧时间环
+//  应用与 ScreenPresenterCaptureService 共用的一小块共享内存：
+//  服务按帧序号写入槽位，再通过 XPC 发送 IOSurface 与序号，应用收到消息后按序号读取槽位
+//
+//  内存序：槽位在发送 XPC 消息前写入，Mach 消息的发送与接收构成先后关系，
+//  应用收到消息后读到的一定是已写完的槽位；消费序号只用于背压，读到旧值只会多丢一帧
+//
+
+import CoreMedia
+import Darwin
+import Foundation
+
+// MARK: - 帧时间
+
+/// 单帧时间（位于共享内存中，布局固定）
+struct CaptureFrameTiming {
+    /// 帧序号（从 1 开始，0 表示槽位为空）
+    var sequence: UInt64
+    /// 展示时间
+    var presentationValue: Int64
+    var presentationTimescale: Int32
+    var presentationFlags: UInt32
+
+    init(sequence: UInt64, presentationTime: CMTime) {
+        self.sequence = sequence
+        presentationValue = presentationTime.value
+        presentationTimescale = presentationTime.timescale
+        presentationFlags = presentationTime.flags.rawValue
+    }
+
+    /// 展示时间
+    var presentationTime: CMTime {
+        CMTime(
+            value: presentationValue,
+            timescale: presentationTimescale,
+            flags: CMTimeFlags(rawValue: presentationFlags),
+            epoch: 0
+        )
+    }
+}
+
+// MARK: - 时间环头
+
+/// 时间环头（位于共享内存起始处，布局固定）
+private struct CaptureFrameTimingHeader {
+    var magic: UInt32
+    var slotCount: UInt32
+    /// 最近发布的帧序号（服务写）
+    var publishedSequence: UInt64
+    /// 最近消费的帧序号（应用写）
+    var consumedSequence: UInt64
+    /// 因应用来不及消费而丢弃的帧数（服务写）
+    var droppedFrames: UInt64
+}
+
+// MARK: - 时间环
+
+/// 捕获帧时间环
+///
+/// 服务端用 create() 创建并把 fileHandle 传给应用，应用用 init?(fileHandle:) 映射同一块内存
+final class CaptureFrameTimingRing {
+    // MARK: - 常量
+
+    /// 槽位数量
+    static let slotCount = 8
+
+    private static let magic: UInt32 = 0x5350_5446 // "SPTF"
+
+    private static let slotsOffset = (MemoryLayout<CaptureFrameTimingHeader>.stride + 7) & ~7
+
+    private static let length = slotsOffset + MemoryLayout<CaptureFrameTiming>.stride * slotCount
+
+    // MARK: - 属性
+
+    /// 共享内存的文件句柄（经 XPC 传给应用）
+    let fileHandle: FileHandle
+
+    private let base: UnsafeMutableRawPointer
+
+    private var header: UnsafeMutablePointer<CaptureFrameTimingHeader> {
+        base.assumingMemoryBound(to: CaptureFrameTimingHeader.self)
+    }
+
+    private var slots: UnsafeMutablePointer<CaptureFrameTiming> {
+        (base + Self.slotsOffset).assumingMemoryBound(to: CaptureFrameTiming.self)
+    }
+
+    // MARK: - 初始化
+
+    /// 创建新的时间环（服务端）
+    static func create() -> CaptureFrameTimingRing? {
+        // shm_open 是变参函数，无法在 Swift 中调用；改用创建后立即解除链接的临时文件，同样只能通过文件描述符访问
+        var path = Array((NSTemporaryDirectory() as NSString).appendingPathComponent("CaptureTiming.XXXXXX").utf8CString)
+        let fd = path.withUnsafeMutableBufferPointer { mkstemp($0.baseAddress!) }
+        guard fd >= 0 else { return nil }
+        path.withUnsafeBufferPointer { _ = unlink($0.baseAddress!) }
+
+        guard ftruncate(fd, off_t(length)) == 0 else {
+            close(fd)
+            return nil
+        }
+        guard let ring = CaptureFrameTimingRing(fileHandle: FileHandle(fileDescriptor: fd, closeOnDealloc: true), validate: false) else {
+            return nil
+        }
+        ring.header.pointee = CaptureFrameTimingHeader(
+            magic: magic,
+            slotCount: UInt32(slotCount),
+            publishedSequence: 0,
+            consumedSequence: 0,
+            droppedFrames: 0
+        )
+        return ring
+    }
+
+    /// 映射服务传来的时间环（应用端）
+    convenience init?(fileHandle: FileHandle) {
+        self.init(fileHandle: fileHandle, validate: true)
+    }
+
+    private init?(fileHandle: FileHandle, validate: Bool) {
+        let address = mmap(nil, Self.length, PROT_READ | PROT_WRITE, MAP_SHARED, fileHandle.fileDescriptor, 0)
+        guard let address, address != MAP_FAILED else { return nil }
+
+        self.fileHandle = fileHandle
+        base = address
+        if validate, header.pointee.magic != Self.magic || header.pointee.slotCount != UInt32(Self.slotCount) {
+            return nil
+        }
+    }
+
+    deinit {
+        munmap(base, Self.length)
+    }
+
+    // MARK: - 服务端
+
+    /// 已发布但应用尚未消费的帧数
+    var pendingFrameCount: UInt64 {
+        let published = header.pointee.publishedSequence
+        let consumed = header.pointee.consumedSequence
+        return published > consumed ? published - consumed : 0
+    }
+
+    /// 写入一帧的时间（在发送 XPC 消息前调用）
+    func publish(_ timing: CaptureFrameTiming) {
+        slots[Int(timing.sequence % UInt64(Self.slotCount))] = timing
+        header.pointee.publishedSequence = timing.sequence
+    }
+
+    /// 记录一次丢帧
+    func recordDroppedFrame() {
+        header.pointee.droppedFrames += 1
+    }
+
+    // MARK: - 应用端
+
+    /// 读取帧序号对应的时间，槽位已被后续帧覆盖时返回 nil
+    func timing(for sequence: UInt64) -> CaptureFrameTiming? {
+        let timing = slots[Int(sequence % UInt64(Self.slotCount))]
+        return timing.sequence == sequence ? timing : nil
+    }
+
+    /// 标记帧已消费（服务据此判断应用是否跟得上）
+    func markConsumed(_ sequence: UInt64) {
+        header.pointee.consumedSequence = sequence
+    }
+
+    /// 累计丢帧数
+    var droppedFrames: UInt64 {
+        header.pointee.droppedFrames
+    }
+}
@@ -0,0 +1,299 @@
+//
+//  CaptureServiceClient.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  捕获服务客户端
+//  管理与 ScreenPresenterCaptureService 的 XPC 连接，把服务发布的 IOSurface 包装为像素缓冲交给设备源
+//
+//  连接状态:
+//  - 服务崩溃或退出: 连接中断，下一条消息会重新拉起服务；已打开的捕获全部失效，
+//    发送 captureServiceInterrupted 通知，由设备源重新打开捕获、设备发现重新同步
+//  - 服务无法启动（如未随应用打包）: 连接失效，之后所有请求以 serviceUnavailable 失败，调用方回退到进程内
+//
+
+import CoreMedia
+import CoreVideo
+import Foundation
+import IOSurface
+import os.lock
+
+// MARK: - 通知
+
+extension Notification.Name {
+    /// 捕获服务中断（在主线程发送）
+    static let captureServiceInterrupted = Notification.Name("captureServiceInterrupted")
+}
+
+// MARK: - 捕获服务客户端
+
+final class CaptureServiceClient: NSObject, CaptureServiceClientProtocol, @unchecked Sendable {
+    // MARK: - 单例
+
+    static let shared = CaptureServiceClient()
+
+    // MARK: - 类型定义
+
+    /// 客户端错误
+    enum ClientError: LocalizedError {
+        /// 服务不可用（连接中断或失效），调用方应回退到进程内
+        case serviceUnavailable(Error)
+
+        var errorDescription: String? {
+            switch self {
+            case let .serviceUnavailable(error):
+                "捕获服务不可用: \(error.localizedDescription)"
+            }
+        }
+
+        /// 连接是否已失效（服务无法启动，不会再恢复）；为 false 时是服务中断，之后会重新拉起
+        var isConnectionInvalid: Bool {
+            switch self {
+            case let .serviceUnavailable(error):
+                (error as? CocoaError)?.code == .xpcConnectionInvalid
+            }
+        }
+    }
+
+    /// 画面回调（在 XPC 接收队列调用，参数为像素缓冲与展示时间）
+    typealias FrameHandler = (CVPixelBuffer, CMTime) -> Void
+
+    /// 已打开的捕获
+    private struct Capture {
+        let timingRing: CaptureFrameTimingRing
+        let handler: FrameHandler
+    }
+
+    // MARK: - 属性
+
+    /// 是否使用捕获服务（启动时读取偏好设置，运行期改动需重启后生效）
+    let isEnabled: Bool
+
+    /// 设备差量变化回调（在 XPC 接收队列调用）
+    var onDevicesChanged: ((
+        _ added: [[AnyHashable: Any]],
+        _ removed: [String],
+        _ updated: [[AnyHashable: Any]],
+        _ attachTimes: [String: Double]
+    ) -> Void)?
+
+    private let lock = NSLock()
+
+    /// XPC 连接（失效后为 nil），通过 lock 访问
+    private var connection: NSXPCConnection?
+
+    /// 连接是否已失效，通过 lock 访问
+    private var isInvalidated = false
+
+    /// 按捕获 ID 索引的已打开捕获，通过 lock 访问
+    private var captures: [String: Capture] = [:]
+
+    // MARK: - 初始化
+
+    override private init() {
+        isEnabled = UserPreferences.shared.captureServiceEnabled
+        super.init()
+    }
+
+    // MARK: - 连接
+
+    /// 异步代理，连接不可用时回调 errorHandler
+    func proxy(errorHandler: @escaping (Error) -> Void) -> CaptureServiceProtocol? {
+        guard let connection = currentConnection() else {
+            errorHandler(ClientError.serviceUnavailable(CocoaError(.xpcConnectionInvalid)))
+            return nil
+        }
+        let proxy = connection.remoteObjectProxyWithErrorHandler { error in
+            errorHandler(ClientError.serviceUnavailable(error))
+        }
+        return proxy as? CaptureServiceProtocol
+    }
+
+    /// 同步代理（回复到达前阻塞调用线程，只用于手动刷新等低频操作）
+    func synchronousProxy(errorHandler: @escaping (Error) -> Void) -> CaptureServiceProtocol? {
+        guard let connection = currentConnection() else {
+            errorHandler(ClientError.serviceUnavailable(CocoaError(.xpcConnectionInvalid)))
+            return nil
+        }
+        let proxy = connection.synchronousRemoteObjectProxyWithErrorHandler { error in
+            errorHandler(ClientError.serviceUnavailable(error))
+        }
+        return proxy as? CaptureServiceProtocol
+    }
+
+    private func currentConnection() -> NSXPCConnection? {
+        lock.lock()
+        defer { lock.unlock() }
+
+        guard isEnabled, !isInvalidated else { return nil }
+        if let connection {
+            return connection
+        }
+
+        let connection = NSXPCConnection(serviceName: CaptureServiceConstants.serviceName)
+        connection.remoteObjectInterface = CaptureServiceInterfaces.makeServiceInterface()
+        connection.exportedInterface = CaptureServiceInterfaces.makeClientInterface()
+        connection.exportedObject = self
+        connection.interruptionHandler = { [weak self] in
+            self?.handleInterruption()
+        }
+        connection.invalidationHandler = { [weak self] in
+            self?.handleInvalidation()
+        }
+        connection.resume()
+        self.connection = connection
+        AppLogger.capture.info("已连接捕获服务")
+        return connection
+    }
+
+    /// 服务崩溃或退出：已打开的捕获全部失效，连接保留，下一条消息会重新拉起服务
+    private func handleInterruption() {
+        let lostCount = lock.withLock {
+            defer { captures.removeAll() }
+            return captures.count
+        }
+        AppLogger.capture.error("捕获服务中断，\(lostCount) 个捕获需要重新打开")
+        DispatchQueue.main.async {
+            NotificationCenter.default.post(name: .captureServiceInterrupted, object: nil)
+        }
+    }
+
+    /// 服务无法启动：之后的请求全部回退到进程内
+    private func handleInvalidation() {
+        lock.withLock {
+            isInvalidated = true
+            connection = nil
+            captures.removeAll()
+        }
+        AppLogger.capture.error("捕获服务连接已失效，改为在应用进程内捕获")
+    }
+
+    // MARK: - 捕获
+
+    /// 在服务中打开捕获
+    /// - Parameters:
+    ///   - avUniqueID: AVCaptureDevice 的 uniqueID
+    ///   - framesPerSecond: 偏好设置的帧率
+    ///   - audioEnabled: 是否播放设备音频
+    ///   - audioVolume: 音量
+    ///   - handler: 画面回调
+    /// - Returns: 捕获 ID
+    func openCapture(
+        avUniqueID: String,
+        framesPerSecond: Int,
+        audioEnabled: Bool,
+        audioVolume: Float,
+        handler: @escaping FrameHandler
+    ) async throws -> String {
+        let captureID = UUID().uuidString
+        let fileHandle: FileHandle = try await withCheckedThrowingContinuation { continuation in
+            let resumed = OSAllocatedUnfairLock(initialState: false)
+            let resume = { (result: Result<FileHandle, Error>) in
+                guard !resumed.withLock({ defer { $0 = true }; return $0 }) else { return }
+                continuation.resume(with: result)
+            }
+            proxy { resume(.failure($0)) }?.openCapture(
+                captureID: captureID,
+                avUniqueID: avUniqueID,
+                framesPerSecond: framesPerSecond,
+                audioEnabled: audioEnabled,
+                audioVolume: audioVolume
+            ) { fileHandle, error in
+                if let fileHandle {
+                    resume(.success(fileHandle))
+                } else {
+                    resume(.failure(error ?? CaptureServiceErrorCode.timingRingUnavailable.error("")))
+                }
+            }
+        }
+
+        guard let timingRing = CaptureFrameTimingRing(fileHandle: fileHandle) else {
+            closeCapture(captureID)
+            throw CaptureServiceErrorCode.timingRingUnavailable.error("无法映射帧时间环")
+        }
+        lock.withLock {
+            captures[captureID] = Capture(timingRing: timingRing, handler: handler)
+        }
+        return captureID
+    }
+
+    /// 启动捕获
+    func startCapture(_ captureID: String) async throws {
+        try await withCheckedThrowingContinuation { (continuation: CheckedContinuation<Void, Error>) in
+            let resumed = OSAllocatedUnfairLock(initialState: false)
+            let resume = { (error: Error?) in
+                guard !resumed.withLock({ defer { $0 = true }; return $0 }) else { return }
+                if let error {
+                    continuation.resume(throwing: error)
+                } else {
+                    continuation.resume()
+                }
+            }
+            proxy { resume($0) }?.startCapture(captureID: captureID) { error in
+                resume(error)
+            }
+        }
+    }
+
+    /// 停止捕获（服务不可用时直接返回）
+    func stopCapture(_ captureID: String) async {
+        await withCheckedContinuation { (continuation: CheckedContinuation<Void, Never>) in
+            let resumed = OSAllocatedUnfairLock(initialState: false)
+            let resume = {
+                guard !resumed.withLock({ defer { $0 = true }; return $0 }) else { return }
+                continuation.resume()
+            }
+            proxy { _ in resume() }?.stopCapture(captureID: captureID) {
+                resume()
+            }
+        }
+    }
+
+    /// 关闭捕获
+    func closeCapture(_ captureID: String) {
+        let capture = lock.withLock { captures.removeValue(forKey: captureID) }
+        if let capture, capture.timingRing.droppedFrames > 0 {
+            AppLogger.capture.info("捕获服务因应用来不及消费丢弃 \(capture.timingRing.droppedFrames) 帧")
+        }
+        proxy { _ in }?.closeCapture(captureID: captureID)
+    }
+
+    /// 设置帧率上限（nil 表示按偏好设置帧率）
+    func setFrameRateLimit(_ framesPerSecond: Int?, captureID: String) {
+        proxy { _ in }?.setFrameRateLimit(framesPerSecond ?? 0, captureID: captureID)
+    }
+
+    /// 设置音频播放
+    func setAudio(enabled: Bool, volume: Float, captureID: String) {
+        proxy { _ in }?.setAudio(enabled: enabled, volume: volume, captureID: captureID)
+    }
+
+    // MARK: - CaptureServiceClientProtocol
+
+    func devicesDidChange(
+        added: [[AnyHashable: Any]],
+        removed: [String],
+        updated: [[AnyHashable: Any]],
+        attachTimes: [String: Double]
+    ) {
+        onDevicesChanged?(added, removed, updated, attachTimes)
+    }
+
+    func didPublishFrame(_ surface: IOSurface, captureID: String, sequence: UInt64) {
+        guard let capture = lock.withLock({ captures[captureID] }) else { return }
+
+        // 包装出的像素缓冲存活期间持有 IOSurface 的使用计数，服务端的缓冲池不会复用它
+        var unmanagedPixelBuffer: Unmanaged<CVPixelBuffer>?
+        let attributes = [kCVPixelBufferMetalCompatibilityKey: true] as CFDictionary
+        let status = CVPixelBufferCreateWithIOSurface(kCFAllocatorDefault, surface, attributes, &unmanagedPixelBuffer)
+        guard status == kCVReturnSuccess, let pixelBuffer = unmanagedPixelBuffer?.takeRetainedValue() else {
+            AppLogger.capture.error("无法从 IOSurface 创建像素缓冲: \(status)")
+            return
+        }
+
+        let presentationTime = capture.timingRing.timing(for: sequence)?.presentationTime ?? .invalid
+        capture.timingRing.markConsumed(sequence)
+        capture.handler(pixelBuffer, presentationTime)
+    }
+}
@@ -0,0 +1,285 @@
+//
+//  CaptureServiceDeviceBackend.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  捕获服务中的设备发现后端
+//  FBDeviceSet 运行在捕获服务进程中，私有框架调用崩溃不会拖垮应用
+//  应用端维护设备信息镜像，列举与查询设备直接读取镜像，不做同步 XPC 调用
+//
+
+import FBDeviceControlKit
+import Foundation
+
+// MARK: - 捕获服务设备发现后端
+
+/// 捕获服务中的设备发现后端
+///
+/// - 创建时即开始观察服务中的设备变化，按差量维护镜像；差量回调与就绪回调都在主线程交付，与桥接层一致
+/// - 服务中断后重新观察，用服务回复的设备列表与镜像对比，补发期间的新增与移除
+/// - 服务无法启动时回退到应用进程内的 FBDeviceControlBridge
+final class CaptureServiceDeviceBackend: FBDeviceControlBackend {
+    // MARK: - 类型定义
+
+    private struct State {
+        var isReady = false
+        var isAvailable = false
+        var initializationError: String?
+        var readyWaiters: [(Bool) -> Void] = []
+        /// 设备信息镜像（按 UDID）
+        var devices: [String: [AnyHashable: Any]] = [:]
+        /// 设备顺序
+        var order: [String] = []
+        var attachTimes: [String: Double] = [:]
+        /// 应用注册的差量回调
+        var callback: FBDeviceDiffCallback?
+        /// 服务不可用时回退的桥接层
+        var fallback: FBDeviceControlBridge?
+    }
+
+    // MARK: - 属性
+
+    private let client: CaptureServiceClient
+
+    private let lock = NSLock()
+
+    private var state = State()
+
+    // MARK: - 初始化
+
+    init(client: CaptureServiceClient) {
+        self.client = client
+        client.onDevicesChanged = { [weak self] added, removed, updated, attachTimes in
+            DispatchQueue.main.async {
+                self?.apply(added: added, removed: removed, updated: updated, attachTimes: attachTimes)
+            }
+        }
+        _ = NotificationCenter.default.addObserver(
+            forName: .captureServiceInterrupted,
+            object: nil,
+            queue: .main
+        ) { [weak self] _ in
+            AppLogger.device.warning("捕获服务中断，重新同步设备列表")
+            self?.connect()
+        }
+        connect()
+    }
+
+    // MARK: - FBDeviceControlBackend
+
+    var isAvailable: Bool {
+        if let fallback = lock.withLock({ state.fallback }) {
+            return fallback.isAvailable
+        }
+        return lock.withLock { state.isAvailable }
+    }
+
+    var initializationError: String? {
+        if let fallback = lock.withLock({ state.fallback }) {
+            return fallback.initializationError
+        }
+        return lock.withLock { state.initializationError }
+    }
+
+    var isReady: Bool {
+        if let fallback = lock.withLock({ state.fallback }) {
+            return fallback.isReady
+        }
+        return lock.withLock { state.isReady }
+    }
+
+    func whenReady(_ completion: @escaping (Bool) -> Void) {
+        enum Action {
+            case forward(FBDeviceControlBridge)
+            case complete(Bool)
+            case wait
+        }
+        let action: Action = lock.withLock {
+            if let fallback = state.fallback {
+                return .forward(fallback)
+            }
+            if state.isReady {
+                return .complete(state.isAvailable)
+            }
+            state.readyWaiters.append(completion)
+            return .wait
+        }
+        switch action {
+        case let .forward(fallback):
+            fallback.whenReady(completion)
+        case let .complete(available):
+            DispatchQueue.main.async { completion(available) }
+        case .wait:
+            break
+        }
+    }
+
+    func listDevices() -> [[AnyHashable: Any]] {
+        lock.withLock {
+            if let fallback = state.fallback {
+                return fallback.listDevices()
+            }
+            return state.order.compactMap { state.devices[$0] }
+        }
+    }
+
+    func fetchDeviceInfo(_ udid: String) -> [AnyHashable: Any]? {
+        lock.withLock {
+            if let fallback = state.fallback {
+                return fallback.fetchDeviceInfo(udid)
+            }
+            return state.devices[udid]
+        }
+    }
+
+    func attachTime(forUDID udid: String) -> TimeInterval {
+        lock.withLock {
+            if let fallback = state.fallback {
+                return fallback.attachTime(forUDID: udid)
+            }
+            return state.attachTimes[udid] ?? 0
+        }
+    }
+
+    func startObservingChanges(callback: @escaping FBDeviceDiffCallback) {
+        let (fallback, snapshot) = lock.withLock {
+            state.callback = callback
+            return (state.fallback, state.order.compactMap { state.devices[$0] })
+        }
+        if let fallback {
+            fallback.startObservingChanges(callback: callback)
+            return
+        }
+
+        // 镜像中已有的设备作为首次差量交付，与桥接层开始观察时的行为一致
+        if !snapshot.isEmpty {
+            DispatchQueue.main.async {
+                callback(snapshot, [], [])
+            }
+        }
+    }
+
+    func stopObserving() {
+        let fallback = lock.withLock {
+            state.callback = nil
+            return state.fallback
+        }
+        fallback?.stopObserving()
+    }
+
+    func refresh() -> [[AnyHashable: Any]] {
+        if let fallback = lock.withLock({ state.fallback }) {
+            return fallback.refresh()
+        }
+
+        var devices: [[AnyHashable: Any]]?
+        client.synchronousProxy { error in
+            AppLogger.device.error("捕获服务刷新设备失败: \(error.localizedDescription)")
+        }?.refreshDevices { refreshed in
+            devices = refreshed
+        }
+        guard let devices else { return listDevices() }
+        apply(snapshot: devices, attachTimes: [:])
+        return devices
+    }
+
+    // MARK: - 私有方法
+
+    /// 连接服务并开始观察（创建时与服务中断后调用）
+    private func connect() {
+        // 服务中断由 captureServiceInterrupted 通知重新连接，只有连接失效时才回退
+        let proxy = client.proxy { [weak self] error in
+            guard (error as? CaptureServiceClient.ClientError)?.isConnectionInvalid == true else { return }
+            DispatchQueue.main.async {
+                self?.fallBackToBridge(error)
+            }
+        }
+        proxy?.waitUntilReady { [weak self] available, initializationError in
+            DispatchQueue.main.async {
+                self?.markReady(available: available, initializationError: initializationError)
+            }
+        }
+        proxy?.startObservingDevices { [weak self] devices, attachTimes in
+            DispatchQueue.main.async {
+                self?.apply(snapshot: devices, attachTimes: attachTimes)
+            }
+        }
+    }
+
+    private func markReady(available: Bool, initializationError: String?) {
+        let waiters = lock.withLock {
+            state.isReady = true
+            state.isAvailable = available
+            state.initializationError = initializationError
+            defer { state.readyWaiters.removeAll() }
+            return state.readyWaiters
+        }
+        waiters.forEach { $0(available) }
+    }
+
+    /// 服务无法启动时回退到应用进程内的桥接层
+    private func fallBackToBridge(_ error: Error) {
+        let bridge = FBDeviceControlBridge.shared
+        let (waiters, callback, alreadyFallenBack) = lock.withLock {
+            let alreadyFallenBack = state.fallback != nil
+            state.fallback = bridge
+            defer { state.readyWaiters.removeAll() }
+            return (state.readyWaiters, state.callback, alreadyFallenBack)
+        }
+        guard !alreadyFallenBack else { return }
+
+        AppLogger.device.warning("捕获服务不可用，设备发现回退到应用进程内: \(error.localizedDescription)")
+        waiters.forEach { bridge.whenReady($0) }
+        if let callback {
+            bridge.startObservingChanges(callback: callback)
+        }
+    }
+
+    /// 应用服务回复的完整设备列表，与镜像对比得出差量
+    private func apply(snapshot: [[AnyHashable: Any]], attachTimes: [String: Double]) {
+        let snapshotUDIDs = Set(snapshot.compactMap { $0[kFBDeviceInfoUDID] as? String })
+        let removed = lock.withLock { state.order.filter { !snapshotUDIDs.contains($0) } }
+        apply(added: snapshot, removed: removed, updated: [], attachTimes: attachTimes)
+    }
+
+    /// 应用差量：新增中已在镜像中的设备按信息变化处理（服务重新观察时会把已知设备再报告为新增）
+    private func apply(
+        added: [[AnyHashable: Any]],
+        removed: [String],
+        updated: [[AnyHashable: Any]],
+        attachTimes: [String: Double]
+    ) {
+        let (diff, callback) = lock.withLock {
+            var diff: (added: [[AnyHashable: Any]], removed: [String], updated: [[AnyHashable: Any]]) = ([], [], [])
+            for info in added {
+                guard let udid = info[kFBDeviceInfoUDID] as? String else { continue }
+                if state.devices[udid] == nil {
+                    state.order.append(udid)
+                    diff.added.append(info)
+                } else if !NSDictionary(dictionary: state.devices[udid] ?? [:]).isEqual(to: info) {
+                    diff.updated.append(info)
+                }
+                state.devices[udid] = info
+            }
+            for info in updated {
+                guard let udid = info[kFBDeviceInfoUDID] as? String, state.devices[udid] != nil else { continue }
+                state.devices[udid] = info
+                diff.updated.append(info)
+            }
+            for udid in removed where state.devices.removeValue(forKey: udid) != nil {
+                state.attachTimes[udid] = nil
+                diff.removed.append(udid)
+            }
+            if !diff.removed.isEmpty {
+                let removedSet = Set(diff.removed)
+                state.order.removeAll { removedSet.contains($0) }
+            }
+            state.attachTimes.merge(attachTimes) { _, new in new }
+            return (diff, state.callback)
+        }
+
+        guard !diff.added.isEmpty || !diff.removed.isEmpty || !diff.updated.isEmpty else { return }
+        callback?(diff.added, diff.removed, diff.updated)
+    }
+}
@@ -0,0 +1,174 @@
+//
+//  CaptureServiceProtocol.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  捕获服务 XPC 协议
+//  应用与 ScreenPresenterCaptureService 共用（两个 target 都编译此文件）
+//
+//  FBDeviceSet 与 iOS 捕获会话运行在服务进程中：
+//  - 设备信息以字典交付，键与 FBDeviceControlBridge 一致
+//  - 画面以 IOSurface 经 Mach 端口交给应用（不复制像素），消息只携带帧序号
+//  - 每帧的时间信息写在共享内存中的 CaptureFrameTimingRing 里
+//
+
+import Foundation
+import IOSurface
+
+// MARK: - 常量
+
+/// 捕获服务常量
+enum CaptureServiceConstants {
+    /// XPC 服务名（即服务的 bundle identifier）
+    static let serviceName = "com.haptictide.ScreenPresenter.CaptureService"
+
+    /// 服务返回错误的错误域
+    static let errorDomain = "com.haptictide.ScreenPresenter.CaptureService"
+}
+
+// MARK: - 错误码
+
+/// 捕获服务错误码（经 NSError 传回应用，由应用映射为 DeviceSourceError）
+enum CaptureServiceErrorCode: Int {
+    /// 找不到 AVCaptureDevice
+    case deviceNotFound = 1
+    /// 设备被其他应用占用
+    case deviceInUse
+    /// 设备未解锁或未信任
+    case deviceNotReady
+    /// 创建视频输入失败（localizedDescription 为原始错误描述）
+    case inputFailed
+    /// 无法添加视频输出
+    case cannotAddOutput
+    /// 无法创建共享内存时间环
+    case timingRingUnavailable
+    /// 捕获不存在（已关闭或服务重启过）
+    case captureNotFound
+
+    /// 创建对应的 NSError
+    func error(_ message: String) -> NSError {
+        NSError(
+            domain: CaptureServiceConstants.errorDomain,
+            code: rawValue,
+            userInfo: [NSLocalizedDescriptionKey: message]
+        )
+    }
+
+    /// 从服务返回的错误中解析错误码
+    init?(error: Error) {
+        let nsError = error as NSError
+        guard nsError.domain == CaptureServiceConstants.errorDomain else { return nil }
+        self.init(rawValue: nsError.code)
+    }
+}
+
+// MARK: - 服务接口
+
+/// 捕获服务导出的接口（应用调用）
+@objc protocol CaptureServiceProtocol {
+    // MARK: 设备发现
+
+    /// 等待 FBDeviceSet 初始化完成
+    /// - Parameter reply: FBDeviceControl 是否可用、初始化错误
+    func waitUntilReady(reply: @escaping (Bool, String?) -> Void)
+
+    /// 开始观察设备变化
+    /// 先回复当前设备与各设备的接入时间（CACurrentMediaTime 时基，跨进程可比），
+    /// 之后的变化通过 CaptureServiceClientProtocol.devicesDidChange 交付
+    func startObservingDevices(reply: @escaping ([[AnyHashable: Any]], [String: Double]) -> Void)
+
+    /// 停止观察设备变化
+    func stopObservingDevices()
+
+    /// 重新枚举设备
+    func refreshDevices(reply: @escaping ([[AnyHashable: Any]]) -> Void)
+
+    // MARK: 捕获
+
+    /// 为设备创建捕获会话（不启动）
+    /// - Parameters:
+    ///   - captureID: 应用分配的捕获 ID
+    ///   - avUniqueID: AVCaptureDevice 的 uniqueID
+    ///   - framesPerSecond: 偏好设置的帧率
+    ///   - audioEnabled: 是否播放设备音频
+    ///   - audioVolume: 音量 (0.0 - 1.0)
+    ///   - reply: 时间环的共享内存文件句柄，失败时为错误
+    func openCapture(
+        captureID: String,
+        avUniqueID: String,
+        framesPerSecond: Int,
+        audioEnabled: Bool,
+        audioVolume: Float,
+        reply: @escaping (FileHandle?, Error?) -> Void
+    )
+
+    /// 启动捕获
+    func startCapture(captureID: String, reply: @escaping (Error?) -> Void)
+
+    /// 停止捕获（会话保留，可再次启动）
+    func stopCapture(captureID: String, reply: @escaping () -> Void)
+
+    /// 关闭捕获并释放会话
+    func closeCapture(captureID: String)
+
+    /// 设置帧率上限（0 表示按偏好设置帧率）
+    func setFrameRateLimit(_ framesPerSecond: Int, captureID: String)
+
+    /// 设置音频播放
+    func setAudio(enabled: Bool, volume: Float, captureID: String)
+}
+
+// MARK: - 客户端接口
+
+/// 应用导出给捕获服务的接口（服务回调）
+@objc protocol CaptureServiceClientProtocol {
+    /// 设备差量变化（语义与 FBDeviceControlBridge 的差量回调一致）
+    /// - Parameter attachTimes: 新增设备的接入时间
+    func devicesDidChange(
+        added: [[AnyHashable: Any]],
+        removed: [String],
+        updated: [[AnyHashable: Any]],
+        attachTimes: [String: Double]
+    )
+
+    /// 发布一帧画面
+    /// 帧的时间信息位于时间环中序号对应的槽位
+    func didPublishFrame(_ surface: IOSurface, captureID: String, sequence: UInt64)
+}
+
+// MARK: - 接口描述
+
+/// NSXPCInterface 工厂
+/// 集合参数需要显式声明允许解码的类，设备信息字典只包含属性列表类型
+enum CaptureServiceInterfaces {
+    private static let propertyListClasses: Set<AnyHashable> = [
+        NSArray.self,
+        NSDictionary.self,
+        NSString.self,
+        NSNumber.self,
+        NSDate.self,
+        NSData.self,
+    ]
+
+    /// 服务导出接口
+    static func makeServiceInterface() -> NSXPCInterface {
+        let interface = NSXPCInterface(with: CaptureServiceProtocol.self)
+        let observe = #selector(CaptureServiceProtocol.startObservingDevices(reply:))
+        interface.setClasses(propertyListClasses, for: observe, argumentIndex: 0, ofReply: true)
+        interface.setClasses(propertyListClasses, for: observe, argumentIndex: 1, ofReply: true)
+        let refresh = #selector(CaptureServiceProtocol.refreshDevices(reply:))
+        interface.setClasses(propertyListClasses, for: refresh, argumentIndex: 0, ofReply: true)
+        return interface
+    }
+
+    /// 客户端导出接口
+    static func makeClientInterface() -> NSXPCInterface {
+        let interface = NSXPCInterface(with: CaptureServiceClientProtocol.self)
+        let change = #selector(CaptureServiceClientProtocol.devicesDidChange(added:removed:updated:attachTimes:))
+        for index in 0 ..< 4 {
+            interface.setClasses(propertyListClasses, for: change, argumentIndex: index, ofReply: false)
+        }
+        return interface
+    }
+}
@@ -5,11 +5,12 @@
 //  Created by Sun on 2025/12/22.
 //
 //  Android 设备提供者
-//  通过 adb 扫描并管理 Android 设备列表
+//  通过 adb server 的 host:track-devices-l 推送跟踪并管理 Android 设备列表
 //
 
 import Combine
 import Foundation
+import QuartzCore
 
 // MARK: - Android 设备提供者
 
@@ -29,14 +30,33 @@ final class AndroidDeviceProvider: ObservableObject {
     /// adb 服务是否运行中
     @Published private(set) var isAdbServerRunning = false
 
+    /// 设备列表差异回调（新增、移除的序列号、更新），在 devices 更新后调用
+    var onDevicesDiff: ((_ added: [AndroidDevice], _ removed: [String], _ updated: [AndroidDevice]) -> Void)?
+
     // MARK: - 私有属性
 
     private let processRunner = ProcessRunner()
+    private lazy var adbClient = ADBServerClient(adbPath: toolchainManager.adbPath)
     private var monitoringTask: Task<Void, Never>?
     private let toolchainManager: ToolchainManager
 
-    /// 轮询间隔（秒）
-    private let pollingInterval: TimeInterval = 2.0
+    /// 各设备最近一次由 adb 上报的原始信息（未补充 getprop 属性），用于判断设备是否变化
+    private var reportedDevices: [String: AndroidDevice] = [:]
+
+    /// 合并窗口内最新的设备列表输出
+    private var pendingDeviceList: String?
+
+    /// 合并窗口内首次收到设备列表的时间（CACurrentMediaTime 时基），作为新增设备的接入时间
+    private var pendingDeviceListTime: CFTimeInterval?
+
+    /// 合并窗口任务
+    private var coalescingTask: Task<Void, Never>?
+
+    /// 合并窗口（秒），窗口内的多次推送只处理最后一次（如 USB Hub 重新连接）
+    private let coalescingInterval: TimeInterval = 0.075
+
+    /// 跟踪连接断开后的重连间隔（秒）
+    private let reconnectInterval: TimeInterval = 2.0
 
     // MARK: - 生命周期
 
@@ -46,6 +66,7 @@ final class AndroidDeviceProvider: ObservableObject {
 
     deinit {
         monitoringTask?.cancel()
+        coalescingTask?.cancel()
     }
 
     // MARK: - 公开方法
@@ -65,8 +86,10 @@ final class AndroidDeviceProvider: ObservableObject {
             await startAdbServer()
 
             while !Task.isCancelled, isMonitoring {
-                await refreshDevices()
-                try? await Task.sleep(nanoseconds: UInt64(pollingInterval * 1_000_000_000))
+                await trackDevices()
+                guard !Task.isCancelled, isMonitoring else { break }
+                // 跟踪连接断开（如 adb server 重启），稍后重连
+                try? await Task.sleep(nanoseconds: UInt64(reconnectInterval * 1_000_000_000))
             }
 
             AppLogger.device.info("设备监控已停止")
@@ -79,110 +102,149 @@ final class AndroidDeviceProvider: ObservableObject {
         isMonitoring = false
         monitoringTask?.cancel()
         monitoringTask = nil
+        coalescingTask?.cancel()
+        coalescingTask = nil
+        pendingDeviceList = nil
     }
 
     /// 手动刷新设备列表
     func refreshDevices() async {
-
         do {
-            let result = try await processRunner.run(
-                toolchainManager.adbPath,
-                arguments: ["devices", "-l"]
-            )
-
-            if result.isSuccess {
-                var newDevices = parseDevices(from: result.stdout)
-
-                // 为已授权设备获取详细信息
-                for i in newDevices.indices {
-                    if newDevices[i].state == .device {
-                        newDevices[i] = await enrichDeviceInfo(newDevices[i])
-                    }
-                }
-
-                // 只在设备列表真正变化时更新
-                if newDevices != devices {
-                    AppLogger.device.info("Android 设备列表已更新: \(newDevices.count) 个设备")
-                    for device in newDevices {
-                        AppLogger.device
-                            .info(
-                                "  - \(device.serial): \(device.state.rawValue), 名称: \(device.displayName), Android \(device.androidVersion ?? "?")"
-                            )
-                    }
-                    devices = newDevices
-                }
+            let output = try await adbClient.devices()
+            isAdbServerRunning = true
+            lastError = nil
+            await applyDeviceList(output)
+        } catch {
+            AppLogger.device.error("刷新设备列表失败: \(error.localizedDescription)")
+            lastError = error.localizedDescription
+            isAdbServerRunning = false
+        }
+    }
 
+    /// 跟踪设备列表，直到连接断开或任务取消
+    private func trackDevices() async {
+        do {
+            for try await output in adbClient.trackDevices() {
                 isAdbServerRunning = true
                 lastError = nil
-            } else {
-                AppLogger.device.error("adb devices 命令失败: \(result.stderr)")
-                lastError = "adb 命令执行失败: \(result.stderr)"
+                scheduleDeviceList(output)
             }
         } catch {
-            AppLogger.device.error("刷新设备列表失败: \(error.localizedDescription)")
+            guard !Task.isCancelled else { return }
+            AppLogger.device.error("跟踪设备列表失败: \(error.localizedDescription)")
             lastError = error.localizedDescription
             isAdbServerRunning = false
         }
     }
 
+    /// 在合并窗口结束后处理最新的设备列表
+    private func scheduleDeviceList(_ output: String) {
+        pendingDeviceList = output
+        if pendingDeviceListTime == nil {
+            pendingDeviceListTime = CACurrentMediaTime()
+        }
+        guard coalescingTask == nil else { return }
+
+        coalescingTask = Task { [weak self, coalescingInterval] in
+            try? await Task.sleep(nanoseconds: UInt64(coalescingInterval * 1_000_000_000))
+            guard let self, !Task.isCancelled else { return }
+            coalescingTask = nil
+            guard let output = pendingDeviceList else { return }
+            let receivedTime = pendingDeviceListTime
+            pendingDeviceList = nil
+            pendingDeviceListTime = nil
+            await applyDeviceList(output, receivedAt: receivedTime)
+        }
+    }
+
+    /// 与上次上报的列表比较，只为新增或变化的已授权设备读取属性，其余沿用已有信息
+    private func applyDeviceList(_ output: String, receivedAt receivedTime: CFTimeInterval? = nil) async {
+        let reported = parseDevices(from: output)
+        let previousReported = reportedDevices
+        let previousBySerial = Dictionary(devices.map { ($0.serial, $0) }, uniquingKeysWith: { first, _ in first })
+
+        var newDevices: [AndroidDevice] = []
+        var added: [AndroidDevice] = []
+        var updated: [AndroidDevice] = []
+        for device in reported {
+            if previousReported[device.serial] == device, let existing = previousBySerial[device.serial] {
+                newDevices.append(existing)
+                continue
+            }
+
+            let enriched = device.state == .device ? await enrichDeviceInfo(device) : device
+            newDevices.append(enriched)
+            if previousBySerial[device.serial] == nil {
+                added.append(enriched)
+            } else if previousBySerial[device.serial] != enriched {
+                updated.append(enriched)
+            }
+        }
+        let reportedSerials = Set(reported.map(\.serial))
+        let removed = devices.map(\.serial).filter { !reportedSerials.contains($0) }
+
+        reportedDevices = Dictionary(reported.map { ($0.serial, $0) }, uniquingKeysWith: { first, _ in first })
+
+        // 只在设备列表真正变化时更新
+        guard newDevices != devices else { return }
+
+        AppLogger.device.info(
+            "Android 设备列表已更新: \(newDevices.count) 个设备（新增 \(added.count)，移除 \(removed.count)，更新 \(updated.count)）"
+        )
+        for device in added + updated {
+            AppLogger.device
+                .info(
+                    "  - \(device.serial): \(device.state.rawValue), 名称: \(device.displayName), Android \(device.androidVersion ?? "?")"
+                )
+        }
+        devices = newDevices
+        for device in added {
+            DeviceStartupProfiler.shared.begin(deviceID: device.serial, attachedAt: receivedTime)
+            DeviceStartupProfiler.shared.mark(.notified, deviceID: device.serial)
+        }
+        for serial in removed {
+            DeviceStartupProfiler.shared.abandon(deviceID: serial)
+        }
+        onDevicesDiff?(added, removed, updated)
+    }
+
     /// 获取设备详细信息
+    /// 一次 getprop 取回全部属性，再在本地查找，避免每个属性一次 shell 往返
     private func enrichDeviceInfo(_ device: AndroidDevice) async -> AndroidDevice {
         var enriched = device
 
-        // 并行获取所有属性以提高效率
-        async let brand = getDeviceProperty(device.serial, property: "ro.product.brand")
-        async let marketName = getDeviceProperty(device.serial, property: "ro.product.marketname")
-        async let androidVersion = getDeviceProperty(device.serial, property: "ro.build.version.release")
-        async let sdkVersion = getDeviceProperty(device.serial, property: "ro.build.version.sdk")
+        let properties: [String: String]
+        do {
+            properties = try await adbClient.properties(serial: device.serial)
+        } catch {
+            AppLogger.device.warning("读取设备属性失败 \(device.serial): \(error.localizedDescription)")
+            return enriched
+        }
 
-        enriched.brand = await brand
-        enriched.marketName = await marketName
-        enriched.androidVersion = await androidVersion
-        enriched.sdkVersion = await sdkVersion
+        enriched.brand = properties["ro.product.brand"]
+        enriched.marketName = properties["ro.product.marketname"]
+        enriched.androidVersion = properties["ro.build.version.release"]
+        enriched.sdkVersion = properties["ro.build.version.sdk"]
 
         // 获取定制系统信息
-        await enrichCustomOsInfo(&enriched)
+        enrichCustomOsInfo(&enriched, properties: properties)
 
-        // 某些设备没有 marketname，尝试其他属性
+        // 某些设备没有 marketname，依次尝试其他属性
         // 注意：只有当值看起来像有效的市场名称时才使用（包含空格或长度超过型号）
-        if !isValidMarketName(enriched.marketName) {
-            let vendorMarketName = await getDeviceProperty(device.serial, property: "ro.product.vendor.marketname")
-            if isValidMarketName(vendorMarketName) {
-                enriched.marketName = vendorMarketName
-            }
-        }
-        if !isValidMarketName(enriched.marketName) {
-            let configMarketingName = await getDeviceProperty(device.serial, property: "ro.config.marketing_name")
-            if isValidMarketName(configMarketingName) {
-                enriched.marketName = configMarketingName
-            }
-        }
-        // OnePlus 等设备使用 ro.product.odm.marketname
-        if !isValidMarketName(enriched.marketName) {
-            let odmMarketName = await getDeviceProperty(device.serial, property: "ro.product.odm.marketname")
-            if isValidMarketName(odmMarketName) {
-                enriched.marketName = odmMarketName
-            }
-        }
-        // 尝试 ro.display.series（某些 OnePlus 设备使用）
-        if !isValidMarketName(enriched.marketName) {
-            let displaySeries = await getDeviceProperty(device.serial, property: "ro.display.series")
-            if isValidMarketName(displaySeries) {
-                enriched.marketName = displaySeries
-            }
-        }
-        // 尝试 ro.vendor.oplus.market.name（OPLUS/OnePlus 设备）
-        if !isValidMarketName(enriched.marketName) {
-            let oplusMarketName = await getDeviceProperty(device.serial, property: "ro.vendor.oplus.market.name")
-            if isValidMarketName(oplusMarketName) {
-                enriched.marketName = oplusMarketName
-            }
-        }
-        // 尝试 ro.oplus.market.name
-        if !isValidMarketName(enriched.marketName) {
-            let oplusMarketName2 = await getDeviceProperty(device.serial, property: "ro.oplus.market.name")
-            if isValidMarketName(oplusMarketName2) {
-                enriched.marketName = oplusMarketName2
+        let fallbackMarketNameProperties = [
+            "ro.product.vendor.marketname",
+            "ro.config.marketing_name",
+            // OnePlus 等设备使用 ro.product.odm.marketname
+            "ro.product.odm.marketname",
+            // 某些 OnePlus 设备使用 ro.display.series
+            "ro.display.series",
+            // OPLUS/OnePlus 设备
+            "ro.vendor.oplus.market.name",
+            "ro.oplus.market.name",
+        ]
+        for property in fallbackMarketNameProperties where !isValidMarketName(enriched.marketName) {
+            if isValidMarketName(properties[property]) {
+                enriched.marketName = properties[property]
             }
         }
 
@@ -235,12 +297,10 @@ final class AndroidDeviceProvider: ObservableObject {
         AppLogger.device.info("停止 adb 服务...")
 
         do {
-            _ = try await processRunner.run(
-                toolchainManager.adbPath,
-                arguments: ["kill-server"]
-            )
+            try await adbClient.killServer()
             isAdbServerRunning = false
             devices = []
+            reportedDevices = [:]
             AppLogger.device.info("adb 服务已停止")
         } catch {
             lastError = L10n.adb.stopFailed(error.localizedDescription)
@@ -255,7 +315,7 @@ final class AndroidDeviceProvider: ObservableObject {
 
     // MARK: - 私有方法
 
-    /// 解析 adb devices -l 输出
+    /// 解析 host:devices-l / host:track-devices-l 输出
     private func parseDevices(from output: String) -> [AndroidDevice] {
         output
             .components(separatedBy: .newlines)
@@ -269,12 +329,9 @@ extension AndroidDeviceProvider {
     /// 获取设备属性
     func getDeviceProperty(_ serial: String, property: String) async -> String? {
         do {
-            let result = try await processRunner.run(
-                toolchainManager.adbPath,
-                arguments: ["-s", serial, "shell", "getprop", property]
-            )
-            if result.isSuccess {
-                return result.stdout.trimmingCharacters(in: .whitespacesAndNewlines)
+            let result = try await adbClient.shell(serial: serial, command: "getprop \(property)")
+            if result.exitCode == 0 {
+                return result.output.trimmingCharacters(in: .whitespacesAndNewlines)
             }
         } catch {
             // 忽略
@@ -294,25 +351,23 @@ extension AndroidDeviceProvider {
 
     /// 获取定制系统信息
     /// 支持：ColorOS, MIUI, HyperOS, One UI, OxygenOS, Flyme, EMUI, MagicOS 等
-    private func enrichCustomOsInfo(_ device: inout AndroidDevice) async {
-        let serial = device.serial
-
+    private func enrichCustomOsInfo(_ device: inout AndroidDevice, properties: [String: String]) {
         // ColorOS (OnePlus/OPPO/Realme)
-        if let colorOsVersion = await getDeviceProperty(serial, property: "ro.oplus.version") {
+        if let colorOsVersion = properties["ro.oplus.version"] {
             device.customOsName = "ColorOS"
             device.customOsVersion = colorOsVersion
             return
         }
-        if let colorOsVersion = await getDeviceProperty(serial, property: "ro.build.version.opporom") {
+        if let colorOsVersion = properties["ro.build.version.opporom"] {
             device.customOsName = "ColorOS"
             device.customOsVersion = colorOsVersion
             return
         }
 
         // MIUI/HyperOS (Xiaomi/Redmi/POCO)
-        if let miuiVersion = await getDeviceProperty(serial, property: "ro.miui.ui.version.name") {
+        if let miuiVersion = properties["ro.miui.ui.version.name"] {
             // 检查是否是 HyperOS
-            if let hyperOsVersion = await getDeviceProperty(serial, property: "ro.mi.os.version.name"),
+            if let hyperOsVersion = properties["ro.mi.os.version.name"],
                !hyperOsVersion.isEmpty
             {
                 device.customOsName = "HyperOS"
@@ -325,7 +380,7 @@ extension AndroidDeviceProvider {
         }
 
         // One UI (Samsung)
-        if let oneUiVersion = await getDeviceProperty(serial, property: "ro.build.version.oneui") {
+        if let oneUiVersion = properties["ro.build.version.oneui"] {
             // One UI 版本通常是数字格式，如 50100 表示 5.1
             let formatted = formatOneUiVersion(oneUiVersion)
             device.customOsName = "One UI"
@@ -334,14 +389,14 @@ extension AndroidDeviceProvider {
         }
 
         // OxygenOS (OnePlus 海外版)
-        if let oxygenVersion = await getDeviceProperty(serial, property: "ro.oxygen.version") {
+        if let oxygenVersion = properties["ro.oxygen.version"] {
             device.customOsName = "OxygenOS"
             device.customOsVersion = oxygenVersion
             return
         }
 
         // Flyme (Meizu)
-        if let flymeVersion = await getDeviceProperty(serial, property: "ro.build.display.id") {
+        if let flymeVersion = properties["ro.build.display.id"] {
             if flymeVersion.lowercased().contains("flyme") {
                 device.customOsName = "Flyme"
                 // 提取版本号
@@ -353,9 +408,9 @@ extension AndroidDeviceProvider {
         }
 
         // EMUI/HarmonyOS (Huawei)
-        if let emuiVersion = await getDeviceProperty(serial, property: "ro.build.version.emui") {
+        if let emuiVersion = properties["ro.build.version.emui"] {
             // 检查是否是 HarmonyOS
-            if let harmonyVersion = await getDeviceProperty(serial, property: "hw_sc.build.os.version"),
+            if let harmonyVersion = properties["hw_sc.build.os.version"],
                !harmonyVersion.isEmpty
             {
                 device.customOsName = "HarmonyOS"
@@ -371,14 +426,14 @@ extension AndroidDeviceProvider {
         }
 
         // MagicOS (Honor)
-        if let magicVersion = await getDeviceProperty(serial, property: "ro.build.version.magic") {
+        if let magicVersion = properties["ro.build.version.magic"] {
             device.customOsName = "MagicOS"
             device.customOsVersion = magicVersion
             return
         }
 
         // Vivo OriginOS
-        if let originVersion = await getDeviceProperty(serial, property: "ro.vivo.os.version") {
+        if let originVersion = properties["ro.vivo.os.version"] {
             device.customOsName = "OriginOS"
             device.customOsVersion = originVersion
             return
@@ -0,0 +1,593 @@
+//
+//  ADBServerClient.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  adb server 协议客户端
+//  直接通过 TCP 与本机 adb server 通信，代替每条命令启动一次 adb 进程
+//
+//  请求: 4 位十六进制长度 + 服务名
+//  应答: "OKAY"，或 "FAIL" + 4 位十六进制长度 + 错误信息
+//  每条连接承载一个服务：host: 服务应答后由 server 关闭连接，
+//  host:transport: 选定设备后，随后的设备服务（shell:、sync:、reverse:）独占该连接
+//
+
+import Foundation
+import Network
+
+// MARK: - Shell 输出
+
+/// adb shell 执行结果
+struct ADBShellOutput {
+    /// 输出（shell v1 协议下 stderr 合并在 stdout 中）
+    let output: String
+
+    /// 退出码
+    let exitCode: Int32
+}
+
+// MARK: - 设备文件状态
+
+/// sync STAT 返回的设备文件状态
+struct ADBFileStat: Equatable {
+    /// 文件类型与权限
+    let mode: UInt32
+
+    /// 文件大小（字节，超过 4GB 时截断）
+    let size: UInt32
+
+    /// 修改时间（秒）
+    let modificationTime: UInt32
+}
+
+// MARK: - adb server 客户端
+
+/// adb server 协议客户端
+/// 连接本机 adb server（默认 5037 端口），支持 host:、shell:、sync:、forward 与 reverse 服务
+/// server 未运行时自动执行一次 `adb start-server` 后重试
+final class ADBServerClient {
+    // MARK: - 常量
+
+    /// adb server 默认端口
+    static let defaultPort: UInt16 = 5037
+
+    /// sync 协议单个 DATA 块的最大字节数
+    private static let syncMaxChunkSize = 64 * 1024
+
+    /// 追加在 shell 命令之后、用于取回退出码的标记
+    private static let exitCodeMarker = "__SP_EXIT_CODE__"
+
+    // MARK: - 属性
+
+    /// adb 可执行文件路径（仅用于启动 server）
+    private let adbPath: String
+
+    /// adb server 端口
+    private let port: NWEndpoint.Port
+
+    /// 单次服务请求的超时时间（秒）
+    private let timeout: TimeInterval
+
+    /// 连接回调队列
+    private let queue = DispatchQueue(label: "com.screenPresenter.adb.client", qos: .userInitiated)
+
+    // MARK: - 初始化
+
+    /// 初始化客户端
+    /// - Parameters:
+    ///   - adbPath: adb 可执行文件路径
+    ///   - port: adb server 端口
+    ///   - timeout: 单次服务请求的超时时间（秒）
+    init(adbPath: String, port: UInt16 = ADBServerClient.defaultPort, timeout: TimeInterval = 30) {
+        self.adbPath = adbPath
+        self.port = NWEndpoint.Port(rawValue: port) ?? NWEndpoint.Port(rawValue: Self.defaultPort)!
+        self.timeout = timeout
+    }
+
+    // MARK: - host 服务
+
+    /// 列出已连接的设备（等价于 `adb devices -l` 的设备行）
+    /// - Returns: 每行一个设备
+    func devices() async throws -> String {
+        try await withConnection(service: "host:devices-l") { connection in
+            try await connection.sendRequest("host:devices-l")
+            try await connection.readStatus()
+            return try await connection.readLengthPrefixedString()
+        }
+    }
+
+    /// 持续跟踪设备列表（host:track-devices-l）
+    /// 连接建立后 server 立即发送一次当前列表，之后每当设备接入、断开或状态变化时再发送完整列表
+    /// - Returns: 设备列表流，每个元素与 devices() 的输出格式相同；连接断开时结束
+    func trackDevices() -> AsyncThrowingStream<String, Error> {
+        AsyncThrowingStream { continuation in
+            let task = Task {
+                do {
+                    try await withConnection(service: "host:track-devices-l", timesOut: false) { connection in
+                        try await connection.sendRequest("host:track-devices-l")
+                        try await connection.readStatus()
+                        while !Task.isCancelled {
+                            try await continuation.yield(connection.readLengthPrefixedString())
+                        }
+                    }
+                    continuation.finish()
+                } catch {
+                    continuation.finish(throwing: error)
+                }
+            }
+            continuation.onTermination = { _ in
+                task.cancel()
+            }
+        }
+    }
+
+    /// 让 adb server 退出（等价于 `adb kill-server`）
+    func killServer() async throws {
+        try await withConnection(service: "host:kill", startsServer: false) { connection in
+            try await connection.sendRequest("host:kill")
+            try await connection.readStatus()
+        }
+    }
+
+    /// 设置端口转发（macOS 连接到设备）
+    /// - Parameters:
+    ///   - serial: 设备序列号
+    ///   - local: 本机端，如 tcp:27183
+    ///   - remote: 设备端，如 localabstract:scrcpy
+    func forward(serial: String, local: String, remote: String) async throws {
+        try await hostSerialCommand(serial: serial, command: "forward:\(local);\(remote)")
+    }
+
+    /// 移除端口转发
+    func removeForward(serial: String, local: String) async throws {
+        try await hostSerialCommand(serial: serial, command: "killforward:\(local)")
+    }
+
+    /// 移除所有端口转发
+    func removeAllForwards(serial: String) async throws {
+        try await hostSerialCommand(serial: serial, command: "killforward-all")
+    }
+
+    // MARK: - 设备服务
+
+    /// 设置反向端口转发（设备连接到 macOS）
+    /// - Parameters:
+    ///   - serial: 设备序列号
+    ///   - remote: 设备端，如 localabstract:scrcpy
+    ///   - local: 本机端，如 tcp:27183
+    func reverse(serial: String, remote: String, local: String) async throws {
+        try await deviceCommand(serial: serial, command: "reverse:forward:\(remote);\(local)")
+    }
+
+    /// 移除反向端口转发
+    func removeReverse(serial: String, remote: String) async throws {
+        try await deviceCommand(serial: serial, command: "reverse:killforward:\(remote)")
+    }
+
+    /// 移除所有反向端口转发
+    func removeAllReverses(serial: String) async throws {
+        try await deviceCommand(serial: serial, command: "reverse:killforward-all")
+    }
+
+    /// 执行 shell 命令并等待结束
+    /// - Parameters:
+    ///   - serial: 设备序列号
+    ///   - command: shell 命令
+    /// - Returns: 输出与退出码
+    func shell(serial: String, command: String) async throws -> ADBShellOutput {
+        // shell v1 协议不回传退出码，在命令后输出标记与 $? 取回
+        let service = "shell:\(command); echo \(Self.exitCodeMarker)$?"
+        let data = try await withConnection(service: "shell:\(command)") { connection in
+            try await connection.selectTransport(serial: serial)
+            try await connection.sendRequest(service)
+            try await connection.readStatus()
+            return try await connection.readToEnd()
+        }
+
+        var output = String(decoding: data, as: UTF8.self)
+        var exitCode: Int32 = -1
+        if let markerRange = output.range(of: Self.exitCodeMarker, options: .backwards) {
+            let code = output[markerRange.upperBound...].trimmingCharacters(in: .whitespacesAndNewlines)
+            exitCode = Int32(code) ?? -1
+            output = String(output[..<markerRange.lowerBound])
+        }
+        return ADBShellOutput(output: output, exitCode: exitCode)
+    }
+
+    /// 一次读取设备的全部系统属性
+    /// - Parameter serial: 设备序列号
+    /// - Returns: 属性名到属性值的映射（不含值为空的属性）
+    func properties(serial: String) async throws -> [String: String] {
+        let result = try await shell(serial: serial, command: "getprop")
+        guard result.exitCode == 0 else {
+            throw ADBError.commandFailed(command: "getprop", exitCode: result.exitCode, stderr: result.output)
+        }
+
+        // 每行格式: [ro.product.brand]: [OnePlus]
+        var properties: [String: String] = [:]
+        for line in result.output.split(whereSeparator: \.isNewline) {
+            guard
+                line.hasPrefix("["),
+                let separator = line.range(of: "]: ["),
+                line.hasSuffix("]")
+            else {
+                continue
+            }
+            let key = line[line.index(after: line.startIndex)..<separator.lowerBound]
+            let value = line[separator.upperBound..<line.index(before: line.endIndex)]
+            if !value.isEmpty {
+                properties[String(key)] = String(value)
+            }
+        }
+        return properties
+    }
+
+    /// 通过 sync 协议读取设备文件状态
+    /// - Parameters:
+    ///   - serial: 设备序列号
+    ///   - remotePath: 设备上的路径
+    /// - Returns: 文件状态，文件不存在时返回 nil
+    func stat(serial: String, remotePath: String) async throws -> ADBFileStat? {
+        try await withConnection(service: "sync:STAT \(remotePath)") { connection in
+            try await connection.selectTransport(serial: serial)
+            try await connection.sendRequest("sync:")
+            try await connection.readStatus()
+
+            var request = Data()
+            request.appendSyncPacket(id: "STAT", payload: Data(remotePath.utf8))
+            try await connection.send(request)
+
+            // 应答: "STAT" + mode + size + mtime（均为小端 UInt32），文件不存在时全部为 0
+            let reply = try await connection.receive(exactly: 16)
+            guard String(decoding: reply.prefix(4), as: UTF8.self) == "STAT" else {
+                throw ADBError.connectionFailed(reason: "无效的 STAT 应答")
+            }
+
+            var quit = Data()
+            quit.appendSyncHeader(id: "QUIT", value: 0)
+            try await connection.send(quit)
+
+            let stat = ADBFileStat(
+                mode: reply.readLittleEndianUInt32(at: 4),
+                size: reply.readLittleEndianUInt32(at: 8),
+                modificationTime: reply.readLittleEndianUInt32(at: 12)
+            )
+            return stat.mode == 0 ? nil : stat
+        }
+    }
+
+    /// 通过 sync 协议推送文件到设备
+    /// 设备上文件的修改时间设为本地文件的修改时间，供 stat(serial:remotePath:) 比较
+    /// - Parameters:
+    ///   - serial: 设备序列号
+    ///   - localPath: 本地文件路径
+    ///   - remotePath: 设备上的目标路径
+    ///   - mode: 目标文件权限
+    func push(serial: String, localPath: String, remotePath: String, mode: Int32 = 0o644) async throws {
+        let url = URL(fileURLWithPath: localPath)
+        let contents = try Data(contentsOf: url, options: .mappedIfSafe)
+        let modificationDate = (try? url.resourceValues(forKeys: [.contentModificationDateKey]))?
+            .contentModificationDate ?? Date()
+
+        try await withConnection(service: "sync:SEND \(remotePath)") { connection in
+            try await connection.selectTransport(serial: serial)
+            try await connection.sendRequest("sync:")
+            try await connection.readStatus()
+
+            // SEND "<路径>,<八进制权限对应的十进制>"，随后若干 DATA 块，以 DONE <修改时间> 结束
+            var request = Data()
+            request.appendSyncPacket(id: "SEND", payload: Data("\(remotePath),\(mode | 0o100000)".utf8))
+            var offset = 0
+            while offset < contents.count {
+                let end = min(offset + Self.syncMaxChunkSize, contents.count)
+                request.appendSyncPacket(id: "DATA", payload: contents.subdata(in: offset..<end))
+                offset = end
+            }
+            request.appendSyncHeader(id: "DONE", value: UInt32(truncatingIfNeeded: Int(modificationDate.timeIntervalSince1970)))
+            try await connection.send(request)
+
+            let reply = try await connection.receive(exactly: 8)
+            let id = String(decoding: reply.prefix(4), as: UTF8.self)
+            let length = Int(reply.readLittleEndianUInt32(at: 4))
+            guard id == "OKAY" else {
+                var message = Data()
+                if length > 0 {
+                    message = try await connection.receive(exactly: length)
+                }
+                throw ADBError.commandFailed(
+                    command: "push",
+                    exitCode: 1,
+                    stderr: String(decoding: message, as: UTF8.self)
+                )
+            }
+
+            var quit = Data()
+            quit.appendSyncHeader(id: "QUIT", value: 0)
+            try await connection.send(quit)
+        }
+    }
+
+    // MARK: - 私有方法
+
+    /// host-serial: 命令，成功时 server 先后应答两次 OKAY（连接与执行结果）
+    private func hostSerialCommand(serial: String, command: String) async throws {
+        let service = "host-serial:\(serial):\(command)"
+        try await withConnection(service: service) { connection in
+            try await connection.sendRequest(service)
+            try await connection.readStatus()
+            try await connection.readStatus()
+        }
+    }
+
+    /// 选定设备后执行的设备端命令，成功时先后应答两次 OKAY（服务打开与执行结果）
+    private func deviceCommand(serial: String, command: String) async throws {
+        try await withConnection(service: command) { connection in
+            try await connection.selectTransport(serial: serial)
+            try await connection.sendRequest(command)
+            try await connection.readStatus()
+            try await connection.readStatus()
+        }
+    }
+
+    /// 建立连接并执行一个服务，结束后关闭连接
+    /// 连接被拒绝时（server 未运行）启动 server 并重试一次
+    private func withConnection<T>(
+        service: String,
+        startsServer: Bool = true,
+        timesOut: Bool = true,
+        _ body: (ADBServerConnection) async throws -> T
+    ) async throws -> T {
+        let connection = ADBServerConnection(port: port, queue: queue, timeout: timesOut ? timeout : nil)
+        do {
+            try await connection.open()
+        } catch let error as ADBServerConnection.ConnectError where startsServer {
+            AppLogger.process.info("[ADB] 无法连接 adb server（\(error.localizedDescription)），尝试启动")
+            try await startServer()
+            return try await withConnection(service: service, startsServer: false, timesOut: timesOut, body)
+        }
+        defer { connection.close() }
+
+        do {
+            // 任务取消时关闭连接，让挂起的读取立即结束
+            return try await withTaskCancellationHandler {
+                try await body(connection)
+            } onCancel: {
+                connection.close()
+            }
+        } catch {
+            if connection.didTimeOut {
+                throw ADBError.timeout(command: service)
+            }
+            throw error
+        }
+    }
+
+    /// 启动 adb server
+    private func startServer() async throws {
+        guard FileManager.default.fileExists(atPath: adbPath) else {
+            throw ADBError.executableNotFound
+        }
+
+        let process = Process()
+        process.executableURL = URL(fileURLWithPath: adbPath)
+        process.arguments = ["start-server"]
+        process.standardOutput = FileHandle.nullDevice
+        process.standardError = FileHandle.nullDevice
+
+        let exitCode: Int32 = try await withCheckedThrowingContinuation { continuation in
+            process.terminationHandler = { process in
+                continuation.resume(returning: process.terminationStatus)
+            }
+            do {
+                try process.run()
+            } catch {
+                process.terminationHandler = nil
+                continuation.resume(throwing: error)
+            }
+        }
+        guard exitCode == 0 else {
+            throw ADBError.connectionFailed(reason: "adb start-server 退出码 \(exitCode)")
+        }
+    }
+}
+
+// MARK: - adb server 连接
+
+/// 一条到 adb server 的 TCP 连接
+/// 所有回调在客户端的串行队列上执行
+private final class ADBServerConnection {
+    /// 连接建立失败
+    struct ConnectError: LocalizedError {
+        let underlying: NWError
+
+        var errorDescription: String? {
+            underlying.localizedDescription
+        }
+    }
+
+    private let connection: NWConnection
+    private let queue: DispatchQueue
+    private let timeout: TimeInterval?
+
+    /// 是否因超时被取消（仅在队列上读写）
+    private var timedOut = false
+
+    /// 是否已关闭（仅在队列上读写）
+    private var closed = false
+
+    init(port: NWEndpoint.Port, queue: DispatchQueue, timeout: TimeInterval?) {
+        let parameters = NWParameters.tcp
+        if let tcpOptions = parameters.defaultProtocolStack.transportProtocol as? NWProtocolTCP.Options {
+            tcpOptions.noDelay = true
+        }
+        connection = NWConnection(host: .ipv4(.loopback), port: port, using: parameters)
+        self.queue = queue
+        self.timeout = timeout
+    }
+
+    /// 是否因超时被取消
+    var didTimeOut: Bool {
+        queue.sync { timedOut }
+    }
+
+    /// 建立连接，并开始计算超时（timeout 为 nil 时不限时）
+    func open() async throws {
+        try await withCheckedThrowingContinuation { (continuation: CheckedContinuation<Void, Error>) in
+            var resumed = false
+            connection.stateUpdateHandler = { [connection] state in
+                guard !resumed else { return }
+                switch state {
+                case .ready:
+                    resumed = true
+                    continuation.resume()
+                case let .waiting(error), let .failed(error):
+                    // 本机端口被拒绝时 NWConnection 进入 waiting 并不断重试，直接视为失败
+                    resumed = true
+                    connection.cancel()
+                    continuation.resume(throwing: ConnectError(underlying: error))
+                case .cancelled:
+                    resumed = true
+                    continuation.resume(throwing: ADBError.connectionFailed(reason: "连接已取消"))
+                default:
+                    break
+                }
+            }
+            connection.start(queue: queue)
+        }
+
+        guard let timeout else { return }
+        queue.asyncAfter(deadline: .now() + timeout) { [weak self] in
+            guard let self, !closed else { return }
+            timedOut = true
+            connection.cancel()
+        }
+    }
+
+    /// 关闭连接
+    func close() {
+        queue.async { [self] in
+            closed = true
+            connection.cancel()
+        }
+    }
+
+    /// 发送服务请求（4 位十六进制长度 + 服务名）
+    func sendRequest(_ service: String) async throws {
+        let payload = Data(service.utf8)
+        var request = Data(String(format: "%04x", payload.count).utf8)
+        request.append(payload)
+        try await send(request)
+    }
+
+    /// 选定设备，之后的请求由该设备处理
+    func selectTransport(serial: String) async throws {
+        try await sendRequest("host:transport:\(serial)")
+        try await readStatus()
+    }
+
+    /// 读取应答状态，FAIL 时抛出 server 返回的错误信息
+    func readStatus() async throws {
+        let status = try await receive(exactly: 4)
+        switch String(decoding: status, as: UTF8.self) {
+        case "OKAY":
+            return
+        case "FAIL":
+            let message = try await readLengthPrefixedString()
+            if message.hasPrefix("device '"), message.hasSuffix("' not found") {
+                throw ADBError.deviceNotFound(serial: String(message.dropFirst(8).dropLast(11)))
+            }
+            throw ADBError.connectionFailed(reason: message)
+        default:
+            throw ADBError.connectionFailed(reason: "无法识别的应答: \(String(decoding: status, as: UTF8.self))")
+        }
+    }
+
+    /// 读取 4 位十六进制长度前缀的字符串
+    func readLengthPrefixedString() async throws -> String {
+        let lengthData = try await receive(exactly: 4)
+        guard let length = Int(String(decoding: lengthData, as: UTF8.self), radix: 16) else {
+            throw ADBError.connectionFailed(reason: "无效的长度前缀")
+        }
+        guard length > 0 else { return "" }
+        return try await String(decoding: receive(exactly: length), as: UTF8.self)
+    }
+
+    /// 发送数据
+    func send(_ data: Data) async throws {
+        try await withCheckedThrowingContinuation { (continuation: CheckedContinuation<Void, Error>) in
+            connection.send(content: data, completion: .contentProcessed { error in
+                if let error {
+                    continuation.resume(throwing: error)
+                } else {
+                    continuation.resume()
+                }
+            })
+        }
+    }
+
+    /// 读取恰好 count 个字节
+    func receive(exactly count: Int) async throws -> Data {
+        try await withCheckedThrowingContinuation { continuation in
+            connection.receive(minimumIncompleteLength: count, maximumLength: count) { data, _, _, error in
+                if let error {
+                    continuation.resume(throwing: error)
+                } else if let data, data.count == count {
+                    continuation.resume(returning: data)
+                } else {
+                    continuation.resume(throwing: ADBError.connectionFailed(reason: "连接被 adb server 关闭"))
+                }
+            }
+        }
+    }
+
+    /// 读取直到对端关闭连接
+    func readToEnd() async throws -> Data {
+        var result = Data()
+        while true {
+            let (chunk, isComplete) = try await receiveChunk()
+            if let chunk {
+                result.append(chunk)
+            }
+            if isComplete {
+                return result
+            }
+        }
+    }
+
+    private func receiveChunk() async throws -> (Data?, Bool) {
+        try await withCheckedThrowingContinuation { continuation in
+            connection.receive(minimumIncompleteLength: 1, maximumLength: 64 * 1024) { data, _, isComplete, error in
+                if let error {
+                    continuation.resume(throwing: error)
+                } else {
+                    continuation.resume(returning: (data, isComplete))
+                }
+            }
+        }
+    }
+}
+
+// MARK: - sync 协议编码
+
+private extension Data {
+    /// 追加 sync 协议包头：4 字节 ID + 小端 UInt32
+    mutating func appendSyncHeader(id: String, value: UInt32) {
+        append(contentsOf: Array(id.utf8))
+        withUnsafeBytes(of: value.littleEndian) { append(contentsOf: $0) }
+    }
+
+    /// 追加 sync 协议包：包头（长度）+ 数据
+    mutating func appendSyncPacket(id: String, payload: Data) {
+        appendSyncHeader(id: id, value: UInt32(payload.count))
+        append(payload)
+    }
+
+    func readLittleEndianUInt32(at offset: Int) -> UInt32 {
+        var value: UInt32 = 0
+        withUnsafeMutableBytes(of: &value) { destination in
+            _ = copyBytes(to: destination, from: (startIndex + offset)..<(startIndex + offset + 4))
+        }
+        return UInt32(littleEndian: value)
+    }
+}
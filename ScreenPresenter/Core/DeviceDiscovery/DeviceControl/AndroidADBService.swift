@@ -5,7 +5,7 @@
 //  Created by Sun on 2025/12/24.
 //
 //  Android ADB 命令服务
-//  封装 adb 命令执行，提供结构化接口
+//  通过 ADBServerClient 执行 adb 命令，提供结构化接口
 //
 
 import Foundation
@@ -51,21 +51,22 @@ enum ADBError: LocalizedError {
 // MARK: - Android ADB 服务
 
 /// Android ADB 命令服务
-/// 提供对 adb 命令的封装，支持指定设备执行
+/// 通过 adb server 协议执行 push、reverse、forward 与 shell 命令，不再为每条命令启动 adb 进程
 final class AndroidADBService {
     // MARK: - 属性
 
-    /// adb 可执行文件路径
+    /// adb 可执行文件路径（启动 scrcpy-server 时使用）
     private let adbPath: String
 
     /// 设备序列号
     private let deviceSerial: String
 
-    /// 进程执行器
-    private let processRunner: ProcessRunner
+    /// adb server 协议客户端
+    private let client: ADBServerClient
 
-    /// 命令执行超时时间（秒）
-    private let timeout: TimeInterval
+    /// 各设备上已确认与本地一致的文件（键为"序列号|设备路径"），值为本地文件的大小与修改时间
+    /// 进程内共享，同一设备重新连接时无需再次检查
+    @MainActor private static var verifiedPushes: [String: ADBFileStat] = [:]
 
     // MARK: - 初始化
 
@@ -73,83 +74,75 @@ final class AndroidADBService {
     init(
         adbPath: String,
         deviceSerial: String,
-        processRunner: ProcessRunner? = nil,
         timeout: TimeInterval = 30
     ) {
         self.adbPath = adbPath
         self.deviceSerial = deviceSerial
-        self.processRunner = processRunner ?? ProcessRunner()
-        self.timeout = timeout
+        client = ADBServerClient(adbPath: adbPath, timeout: timeout)
     }
 
     // MARK: - 公开方法
 
-    /// 执行 adb 命令
+    /// 推送文件到设备
     /// - Parameters:
-    ///   - arguments: 命令参数（不包含 -s serial）
-    ///   - logCommand: 是否记录命令日志
-    /// - Returns: 执行结果
+    ///   - localPath: 本地文件路径
+    ///   - remotePath: 设备上的目标路径
     @MainActor
-    func execute(_ arguments: [String], logCommand: Bool = true) async throws -> ADBResult {
-        let startTime = CFAbsoluteTimeGetCurrent()
+    func push(local localPath: String, remote remotePath: String) async throws {
+        AppLogger.process.info("[ADB] push: \(localPath) -> \(remotePath)")
 
-        // 构建完整参数：-s <serial> <arguments>
-        var fullArgs = ["-s", deviceSerial]
-        fullArgs.append(contentsOf: arguments)
+        let startTime = CFAbsoluteTimeGetCurrent()
+        try await client.push(serial: deviceSerial, localPath: localPath, remotePath: remotePath)
+        let duration = CFAbsoluteTimeGetCurrent() - startTime
 
-        let commandDescription = "adb \(fullArgs.joined(separator: " "))"
+        AppLogger.process.info("[ADB] push 成功，耗时: \(String(format: "%.1f", duration * 1000))ms")
+    }
 
-        if logCommand {
-            AppLogger.process.info("[ADB] 执行: \(commandDescription)")
+    /// 仅在设备上的文件与本地不一致时推送
+    /// 先查进程内缓存，未命中时用 sync STAT 比较大小与修改时间（push 会把修改时间设为本地文件的时间）
+    /// - Parameters:
+    ///   - localPath: 本地文件路径
+    ///   - remotePath: 设备上的目标路径
+    /// - Returns: 是否实际推送了文件
+    @MainActor
+    @discardableResult
+    func pushIfNeeded(local localPath: String, remote remotePath: String) async throws -> Bool {
+        let attributes = try FileManager.default.attributesOfItem(atPath: localPath)
+        let size = (attributes[.size] as? NSNumber)?.uint32Value ?? 0
+        let modificationDate = attributes[.modificationDate] as? Date ?? Date()
+        let localStat = (size: size, modificationTime: UInt32(truncatingIfNeeded: Int(modificationDate.timeIntervalSince1970)))
+        let cacheKey = "\(deviceSerial)|\(remotePath)"
+
+        if let verified = Self.verifiedPushes[cacheKey],
+           verified.size == localStat.size, verified.modificationTime == localStat.modificationTime
+        {
+            AppLogger.process.info("[ADB] \(remotePath) 与本地一致（缓存），跳过 push")
+            return false
         }
 
         do {
-            let result = try await processRunner.run(adbPath, arguments: fullArgs, timeout: timeout)
-            let duration = CFAbsoluteTimeGetCurrent() - startTime
-
-            let adbResult = ADBResult(
-                exitCode: result.exitCode,
-                stdout: result.stdout,
-                stderr: result.stderr,
-                duration: duration
-            )
-
-            if logCommand {
-                if result.isSuccess {
-                    AppLogger.process.info("[ADB] 成功 (\(String(format: "%.1f", duration * 1000))ms)")
-                } else {
-                    AppLogger.process.warning("[ADB] 失败: 退出码 \(result.exitCode), stderr: \(result.stderr)")
-                }
+            if let remoteStat = try await client.stat(serial: deviceSerial, remotePath: remotePath),
+               remoteStat.size == localStat.size, remoteStat.modificationTime == localStat.modificationTime
+            {
+                Self.verifiedPushes[cacheKey] = remoteStat
+                AppLogger.process.info("[ADB] \(remotePath) 与本地一致，跳过 push")
+                return false
             }
-
-            return adbResult
         } catch {
-            let duration = CFAbsoluteTimeGetCurrent() - startTime
-            AppLogger.process
-                .error("[ADB] 执行异常 (\(String(format: "%.1f", duration * 1000))ms): \(error.localizedDescription)")
-            throw error
+            AppLogger.process.warning("[ADB] 读取 \(remotePath) 状态失败: \(error.localizedDescription)，直接推送")
         }
+
+        Self.verifiedPushes[cacheKey] = nil
+        try await push(local: localPath, remote: remotePath)
+        Self.verifiedPushes[cacheKey] = ADBFileStat(mode: 0, size: localStat.size, modificationTime: localStat.modificationTime)
+        return true
     }
 
-    /// 推送文件到设备
-    /// - Parameters:
-    ///   - localPath: 本地文件路径
-    ///   - remotePath: 设备上的目标路径
+    /// 清除文件推送缓存，下次 pushIfNeeded 重新检查设备上的文件
+    /// - Parameter remotePath: 设备上的路径
     @MainActor
-    func push(local localPath: String, remote remotePath: String) async throws {
-        AppLogger.process.info("[ADB] push: \(localPath) -> \(remotePath)")
-
-        let result = try await execute(["push", localPath, remotePath])
-
-        if !result.isSuccess {
-            throw ADBError.commandFailed(
-                command: "push",
-                exitCode: result.exitCode,
-                stderr: result.stderr
-            )
-        }
-
-        AppLogger.process.info("[ADB] push 成功，耗时: \(String(format: "%.1f", result.duration * 1000))ms")
+    func invalidatePushCache(remote remotePath: String) {
+        Self.verifiedPushes["\(deviceSerial)|\(remotePath)"] = nil
     }
 
     /// 设置 adb reverse（设备连接到 macOS 监听端口）
@@ -160,19 +153,7 @@ final class AndroidADBService {
     func reverse(localAbstract: String, tcpPort: Int) async throws {
         AppLogger.process.info("[ADB] reverse: localabstract:\(localAbstract) -> tcp:\(tcpPort)")
 
-        let result = try await execute([
-            "reverse",
-            "localabstract:\(localAbstract)",
-            "tcp:\(tcpPort)",
-        ])
-
-        if !result.isSuccess {
-            throw ADBError.commandFailed(
-                command: "reverse",
-                exitCode: result.exitCode,
-                stderr: result.stderr
-            )
-        }
+        try await client.reverse(serial: deviceSerial, remote: "localabstract:\(localAbstract)", local: "tcp:\(tcpPort)")
 
         AppLogger.process.info("[ADB] reverse 设置成功")
     }
@@ -184,7 +165,7 @@ final class AndroidADBService {
         AppLogger.process.info("[ADB] remove reverse: localabstract:\(localAbstract)")
 
         do {
-            _ = try await execute(["reverse", "--remove", "localabstract:\(localAbstract)"], logCommand: false)
+            try await client.removeReverse(serial: deviceSerial, remote: "localabstract:\(localAbstract)")
             AppLogger.process.info("[ADB] reverse 已移除")
         } catch {
             AppLogger.process.warning("[ADB] 移除 reverse 失败: \(error.localizedDescription)")
@@ -197,7 +178,7 @@ final class AndroidADBService {
         AppLogger.process.info("[ADB] remove all reverse")
 
         do {
-            _ = try await execute(["reverse", "--remove-all"], logCommand: false)
+            try await client.removeAllReverses(serial: deviceSerial)
             AppLogger.process.info("[ADB] 所有 reverse 已移除")
         } catch {
             AppLogger.process.warning("[ADB] 移除所有 reverse 失败: \(error.localizedDescription)")
@@ -212,19 +193,7 @@ final class AndroidADBService {
     func forward(tcpPort: Int, localAbstract: String) async throws {
         AppLogger.process.info("[ADB] forward: tcp:\(tcpPort) -> localabstract:\(localAbstract)")
 
-        let result = try await execute([
-            "forward",
-            "tcp:\(tcpPort)",
-            "localabstract:\(localAbstract)",
-        ])
-
-        if !result.isSuccess {
-            throw ADBError.commandFailed(
-                command: "forward",
-                exitCode: result.exitCode,
-                stderr: result.stderr
-            )
-        }
+        try await client.forward(serial: deviceSerial, local: "tcp:\(tcpPort)", remote: "localabstract:\(localAbstract)")
 
         AppLogger.process.info("[ADB] forward 设置成功")
     }
@@ -236,7 +205,7 @@ final class AndroidADBService {
         AppLogger.process.info("[ADB] remove forward: tcp:\(tcpPort)")
 
         do {
-            _ = try await execute(["forward", "--remove", "tcp:\(tcpPort)"], logCommand: false)
+            try await client.removeForward(serial: deviceSerial, local: "tcp:\(tcpPort)")
             AppLogger.process.info("[ADB] forward 已移除")
         } catch {
             AppLogger.process.warning("[ADB] 移除 forward 失败: \(error.localizedDescription)")
@@ -249,7 +218,7 @@ final class AndroidADBService {
         AppLogger.process.info("[ADB] remove all forward")
 
         do {
-            _ = try await execute(["forward", "--remove-all"], logCommand: false)
+            try await client.removeAllForwards(serial: deviceSerial)
             AppLogger.process.info("[ADB] 所有 forward 已移除")
         } catch {
             AppLogger.process.warning("[ADB] 移除所有 forward 失败: \(error.localizedDescription)")
@@ -258,10 +227,22 @@ final class AndroidADBService {
 
     /// 执行 shell 命令
     /// - Parameter command: shell 命令
-    /// - Returns: 执行结果
+    /// - Returns: 执行结果（shell v1 协议下 stderr 合并在 stdout 中）
     @MainActor
     func shell(_ command: String) async throws -> ADBResult {
-        try await execute(["shell", command])
+        let startTime = CFAbsoluteTimeGetCurrent()
+        AppLogger.process.info("[ADB] shell: \(command)")
+
+        let output = try await client.shell(serial: deviceSerial, command: command)
+        let duration = CFAbsoluteTimeGetCurrent() - startTime
+
+        if output.exitCode == 0 {
+            AppLogger.process.info("[ADB] 成功 (\(String(format: "%.1f", duration * 1000))ms)")
+        } else {
+            AppLogger.process.warning("[ADB] 失败: 退出码 \(output.exitCode), 输出: \(output.output)")
+        }
+
+        return ADBResult(exitCode: output.exitCode, stdout: output.output, stderr: "", duration: duration)
     }
 
     /// 启动 scrcpy-server 进程（后台运行，不等待结束）
@@ -325,6 +306,13 @@ final class AndroidADBService {
 
     // MARK: - 设备信息
 
+    /// 一次读取设备的全部系统属性
+    /// - Returns: 属性名到属性值的映射（不含值为空的属性）
+    @MainActor
+    func getProperties() async throws -> [String: String] {
+        try await client.properties(serial: deviceSerial)
+    }
+
     /// 获取设备属性
     /// - Parameter property: 属性名称
     /// - Returns: 属性值
@@ -363,32 +351,29 @@ final class AndroidADBService {
 
     /// 列出已连接的 Android 设备
     /// - Returns: 设备列表
-    /// - Note: 此方法不使用 -s 参数，因为需要列出所有设备
+    /// - Note: host:devices-l 不绑定设备，列出所有设备
     @MainActor
     func listDevices() async throws -> [AndroidDevice] {
         AppLogger.process.info("[ADB] 列出设备...")
 
         let startTime = CFAbsoluteTimeGetCurrent()
 
-        let result = try await processRunner.run(adbPath, arguments: ["devices", "-l"], timeout: timeout)
-        let duration = CFAbsoluteTimeGetCurrent() - startTime
-
-        guard result.isSuccess else {
-            AppLogger.process.error("[ADB] 列出设备失败: \(result.stderr)")
-            throw ADBError.commandFailed(
-                command: "devices",
-                exitCode: result.exitCode,
-                stderr: result.stderr
-            )
+        let output: String
+        do {
+            output = try await client.devices()
+        } catch {
+            AppLogger.process.error("[ADB] 列出设备失败: \(error.localizedDescription)")
+            throw error
         }
+        let duration = CFAbsoluteTimeGetCurrent() - startTime
 
-        let devices = parseDevicesOutput(result.stdout)
+        let devices = parseDevicesOutput(output)
         AppLogger.process.info("[ADB] 找到 \(devices.count) 个设备 (\(String(format: "%.1f", duration * 1000))ms)")
 
         return devices
     }
 
-    /// 解析 adb devices -l 输出
+    /// 解析 host:devices-l 输出
     private func parseDevicesOutput(_ output: String) -> [AndroidDevice] {
         output
             .components(separatedBy: .newlines)
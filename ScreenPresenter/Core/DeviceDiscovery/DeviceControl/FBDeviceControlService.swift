@@ -8,12 +8,31 @@
 //  提供类型安全的 Swift API，隔离 ObjC 桥接层
 //
 //  注意：此文件是主工程的本地封装，使用 AppLogger 记录日志
-//  底层 FBDeviceControl 功能来自 FBDeviceControlKit 包
+//  底层 FBDeviceControl 功能来自 FBDeviceControlKit 包，默认运行在捕获服务进程中
 //
 
 import FBDeviceControlKit
 import Foundation
 
+// MARK: - 设备发现后端
+
+/// 设备发现后端
+/// 捕获服务中的 FBDeviceSet（CaptureServiceDeviceBackend），或应用进程内的 FBDeviceControlBridge
+protocol FBDeviceControlBackend: AnyObject {
+    var isAvailable: Bool { get }
+    var initializationError: String? { get }
+    var isReady: Bool { get }
+    func whenReady(_ completion: @escaping (Bool) -> Void)
+    func listDevices() -> [[AnyHashable: Any]]
+    func fetchDeviceInfo(_ udid: String) -> [AnyHashable: Any]?
+    func attachTime(forUDID udid: String) -> TimeInterval
+    func startObservingChanges(callback: @escaping FBDeviceDiffCallback)
+    func stopObserving()
+    func refresh() -> [[AnyHashable: Any]]
+}
+
+extension FBDeviceControlBridge: FBDeviceControlBackend {}
+
 // MARK: - FBDeviceControl 服务
 
 /// FBDeviceControl Swift 封装
@@ -23,16 +42,31 @@ final class FBDeviceControlService {
 
     static let shared = FBDeviceControlService()
 
+    // MARK: - 后端
+
+    /// 设备发现后端（启用捕获服务时 FBDeviceSet 运行在服务进程中）
+    private let backend: FBDeviceControlBackend = {
+        if CaptureServiceClient.shared.isEnabled {
+            return CaptureServiceDeviceBackend(client: CaptureServiceClient.shared)
+        }
+        return FBDeviceControlBridge.shared
+    }()
+
     // MARK: - 状态
 
     /// FBDeviceControl 是否可用
     var isAvailable: Bool {
-        FBDeviceControlBridge.shared.isAvailable
+        backend.isAvailable
     }
 
     /// 初始化错误信息
     var initializationError: String? {
-        FBDeviceControlBridge.shared.initializationError
+        backend.initializationError
+    }
+
+    /// 是否已完成初始化（MobileDevice 在后台加载，完成前 isAvailable 为 false）
+    var isReady: Bool {
+        backend.isReady
     }
 
     // MARK: - 设备变化回调
@@ -40,22 +74,46 @@ final class FBDeviceControlService {
     /// 设备变化回调
     var onDevicesChanged: (([FBDeviceInfoDTO]) -> Void)?
 
+    /// 设备差量变化回调（新增设备、已移除设备的 UDID、信息变化的设备）
+    var onDevicesDiff: ((_ added: [FBDeviceInfoDTO], _ removed: [String], _ updated: [FBDeviceInfoDTO]) -> Void)?
+
+    // MARK: - 关联索引
+
+    /// AVCaptureDevice 与 FBDevice 的关联索引，观察期间按差量维护，列举设备时整体替换
+    let correlationIndex = IOSDeviceCorrelationIndex()
+
     // MARK: - 私有属性
 
     private var isObserving = false
 
+    /// 已观察到的设备 DTO，按差量更新，只在主线程访问
+    private var observedDevices: [String: FBDeviceInfoDTO] = [:]
+
+    /// 已观察到的设备顺序
+    private var observedOrder: [String] = []
+
     // MARK: - 初始化
 
     private init() {
-        if isAvailable {
-            AppLogger.device.info("FBDeviceControlService 已初始化，FBDeviceControl 可用")
-        } else {
-            AppLogger.device.warning("FBDeviceControlService: FBDeviceControl 不可用 - \(initializationError ?? "未知错误")")
+        // 后端在后台完成初始化，就绪后再记录是否可用
+        backend.whenReady { [weak self] available in
+            guard let self else { return }
+            if available {
+                AppLogger.device.info("FBDeviceControlService 已初始化，FBDeviceControl 可用")
+            } else {
+                AppLogger.device.warning("FBDeviceControlService: FBDeviceControl 不可用 - \(initializationError ?? "未知错误")")
+            }
         }
     }
 
     // MARK: - 公开方法
 
+    /// 初始化完成后在主线程回调
+    /// - Parameter completion: 回调，参数为 FBDeviceControl 是否可用
+    func whenReady(_ completion: @escaping (Bool) -> Void) {
+        backend.whenReady(completion)
+    }
+
     /// 获取当前所有设备列表
     /// - Returns: 设备信息 DTO 数组
     func listDevices() -> [FBDeviceInfoDTO] {
@@ -63,8 +121,10 @@ final class FBDeviceControlService {
             return []
         }
 
-        let dictionaries = FBDeviceControlBridge.shared.listDevices()
-        return dictionaries.compactMap { parseDeviceInfo($0) }
+        let dictionaries = backend.listDevices()
+        let devices = dictionaries.compactMap { parseDeviceInfo($0) }
+        correlationIndex.replaceAll(devices)
+        return devices
     }
 
     /// 获取指定设备的详细信息
@@ -75,7 +135,7 @@ final class FBDeviceControlService {
             return nil
         }
 
-        guard let dictionary = FBDeviceControlBridge.shared.fetchDeviceInfo(udid) else {
+        guard let dictionary = backend.fetchDeviceInfo(udid) else {
             return nil
         }
 
@@ -83,23 +143,59 @@ final class FBDeviceControlService {
     }
 
     /// 开始观察设备变化
+    /// 可在初始化完成前调用，首次回调在初始化完成后交付
     func startObserving() {
-        guard isAvailable, !isObserving else {
+        guard !isObserving else {
             return
         }
 
         isObserving = true
-        FBDeviceControlBridge.shared.startObserving { [weak self] dictionaries in
+        observedDevices = [:]
+        observedOrder = []
+        backend.startObservingChanges { [weak self] addedInfos, removedUDIDs, updatedInfos in
             guard let self else { return }
-            let devices = dictionaries.compactMap { self.parseDeviceInfo($0) }
-
-            AppLogger.device.debug("FBDeviceControl 设备变化: \(devices.count) 台设备")
-            onDevicesChanged?(devices)
+            // 只解析发生变化的设备，未变化的设备沿用已有的 DTO
+            let added = addedInfos.compactMap { self.parseDeviceInfo($0) }
+            let updated = updatedInfos.compactMap { self.parseDeviceInfo($0) }
+            let removed = removedUDIDs
+
+            for device in added where observedDevices[device.udid] == nil {
+                observedOrder.append(device.udid)
+            }
+            for device in added + updated {
+                observedDevices[device.udid] = device
+            }
+            for udid in removed {
+                observedDevices[udid] = nil
+            }
+            if !removed.isEmpty {
+                let removedSet = Set(removed)
+                observedOrder.removeAll { removedSet.contains($0) }
+            }
+
+            correlationIndex.apply(added: added, removed: removed, updated: updated)
+            recordStartupMilestones(added: added, removed: removed)
+            AppLogger.device.debug("FBDeviceControl 设备变化: +\(added.count) -\(removed.count) ~\(updated.count)")
+            onDevicesDiff?(added, removed, updated)
+            onDevicesChanged?(observedOrder.compactMap { observedDevices[$0] })
         }
 
         AppLogger.device.info("FBDeviceControlService: 开始观察设备变化")
     }
 
+    /// 记录设备接入与交付的启动里程碑
+    private func recordStartupMilestones(added: [FBDeviceInfoDTO], removed: [String]) {
+        let profiler = DeviceStartupProfiler.shared
+        for device in added {
+            let attachTime = backend.attachTime(forUDID: device.udid)
+            profiler.begin(deviceID: device.udid, attachedAt: attachTime > 0 ? attachTime : nil)
+            profiler.mark(.notified, deviceID: device.udid)
+        }
+        for udid in removed {
+            profiler.abandon(deviceID: udid)
+        }
+    }
+
     /// 停止观察设备变化
     func stopObserving() {
         guard isObserving else {
@@ -107,7 +203,8 @@ final class FBDeviceControlService {
         }
 
         isObserving = false
-        FBDeviceControlBridge.shared.stopObserving()
+        backend.stopObserving()
+        correlationIndex.invalidate()
         AppLogger.device.info("FBDeviceControlService: 停止观察设备变化")
     }
 
@@ -118,8 +215,10 @@ final class FBDeviceControlService {
             return []
         }
 
-        let dictionaries = FBDeviceControlBridge.shared.refresh()
-        return dictionaries.compactMap { parseDeviceInfo($0) }
+        let dictionaries = backend.refresh()
+        let devices = dictionaries.compactMap { parseDeviceInfo($0) }
+        correlationIndex.replaceAll(devices)
+        return devices
     }
 
     // MARK: - 私有方法
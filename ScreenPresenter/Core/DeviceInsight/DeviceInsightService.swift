@@ -209,7 +209,7 @@ final class DeviceInsightService {
         // 尝试在 FBDeviceControl 中查找匹配的设备
         // 注意：AVFoundation uniqueID ≠ iOS 真实 UDID，需要通过其他特征匹配
         // 优先使用 modelID（机型标识）匹配，fallback 到名称匹配
-        if let dto = findFBDevice(modelID: modelID, name: deviceName) {
+        if let dto = findFBDevice(avUniqueID: avUniqueID, modelID: modelID, name: deviceName) {
             var insight = DeviceInsight.from(dto: dto)
             // 保留 AVFoundation 的 uniqueID 作为标识（用于 AVCaptureDevice 操作）
             insight = insight.withAVUniqueID(avUniqueID)
@@ -258,143 +258,33 @@ final class DeviceInsightService {
         )
     }
 
-    /// 在 FBDeviceControl 设备列表中查找匹配的设备
+    /// 在 FBDeviceControl 设备中查找匹配的设备
     /// - Parameters:
+    ///   - avUniqueID: AVFoundation 的 uniqueID，关联成功后用于直接命中
     ///   - modelID: 机型标识（来自 AVCaptureDevice.modelID，通常是 "iOS Device"）
     ///   - name: 设备名称（来自 AVFoundation localizedName，可能带后缀如 "Sun的相机"）
     /// - Returns: 匹配的 FBDeviceInfoDTO，如果找不到返回 nil
     ///
-    /// 注意：AVFoundation 的 modelID 通常返回 "iOS Device"，无法提供具体型号
-    /// 因此主要依赖名称匹配和单设备自动匹配
-    ///
-    /// 匹配策略优先级：
-    /// 1. 单设备自动匹配（最常见场景，最可靠）
-    /// 2. 设备名称精确匹配
-    /// 3. 设备名称模糊匹配（包含关系）
-    /// 4. 机型标识匹配（仅当 modelID 是具体型号时，如 "iPhone17,1"）
-    private func findFBDevice(modelID: String, name: String) -> FBDeviceInfoDTO? {
+    /// 查询关联索引，索引由设备观察按差量维护；未在观察时才重新列举设备
+    /// 匹配策略见 IOSDeviceCorrelationIndex.correlate(avUniqueID:modelID:name:)
+    private func findFBDevice(avUniqueID: String, modelID: String, name: String) -> FBDeviceInfoDTO? {
         guard isFBDeviceControlAvailable else {
             return nil
         }
 
-        // 获取所有 FBDeviceControl 设备
-        let allDevices = FBDeviceControlService.shared.listDevices()
-
-        guard !allDevices.isEmpty else {
-            AppLogger.device.warning("FBDeviceControl: 设备列表为空，无法增强设备信息")
-            return nil
-        }
-
-        // 调试：记录 FBDeviceControl 返回的设备详情
-        for (index, dto) in allDevices.enumerated() {
-            AppLogger.device.debug("""
-            FBDeviceControl 设备[\(index)]:
-              名称: \(dto.deviceName)
-              UDID: \(dto.udid)
-              型号标识: \(dto.productType ?? "nil")
-              型号名称: \(dto.modelName ?? "nil")
-              版本: \(dto.productVersion ?? "nil")
-            """)
-        }
-
-        // 策略 1：单设备自动匹配（最常见场景）
-        // 大多数用户只连接一台 iPhone，此策略最可靠
-        if allDevices.count == 1 {
-            let singleDevice = allDevices[0]
-            AppLogger.device
-                .info(
-                    "FBDeviceControl: 单设备自动匹配 -> '\(singleDevice.deviceName)' UDID: \(singleDevice.udid)"
-                )
-            return singleDevice
+        let service = FBDeviceControlService.shared
+        let index = service.correlationIndex
+        if !index.isMaintained {
+            // 列举设备时会整体替换索引
+            _ = service.listDevices()
         }
 
-        // 多设备场景：需要通过名称匹配
-        // 清理设备名称（去掉可能的后缀，用于名称匹配）
-        let cleanedName = cleanDeviceName(name)
-
-        AppLogger.device.debug("FBDeviceControl: 多设备场景，尝试名称匹配 '\(name)' -> '\(cleanedName)'")
-
-        // 策略 2：设备名称精确匹配
-        if let exactMatch = allDevices.first(where: { $0.deviceName == cleanedName }) {
-            AppLogger.device.info("FBDeviceControl: 精确名称匹配 '\(cleanedName)' -> UDID: \(exactMatch.udid)")
-            return exactMatch
-        }
-
-        // 策略 3：设备名称模糊匹配（包含关系）
-        if
-            let fuzzyMatch = allDevices.first(where: {
-                $0.deviceName.contains(cleanedName) || cleanedName.contains($0.deviceName)
-            }) {
-            AppLogger.device
-                .info(
-                    "FBDeviceControl: 模糊名称匹配 '\(cleanedName)' -> '\(fuzzyMatch.deviceName)' UDID: \(fuzzyMatch.udid)"
-                )
-            return fuzzyMatch
-        }
-
-        // 策略 4：机型标识匹配（仅当 AVFoundation 返回具体型号时）
-        // 注意：通常 modelID 是 "iOS Device"，这个策略很少生效
-        if !modelID.isEmpty, modelID != "iOS Device" {
-            let modelMatches = allDevices.filter { $0.productType == modelID }
-
-            if modelMatches.count == 1 {
-                let match = modelMatches[0]
-                AppLogger.device
-                    .info("FBDeviceControl: 机型匹配成功 '\(modelID)' -> '\(match.deviceName)' UDID: \(match.udid)")
-                return match
-            } else if modelMatches.count > 1 {
-                // 多台同型号设备，返回第一个
-                let firstMatch = modelMatches[0]
-                AppLogger.device
-                    .warning(
-                        "FBDeviceControl: 多台同型号设备 '\(modelID)'，使用第一个 '\(firstMatch.deviceName)' UDID: \(firstMatch.udid)"
-                    )
-                return firstMatch
-            }
-        }
-
-        AppLogger.device
-            .warning(
-                "FBDeviceControl: 未找到匹配设备 (name: '\(cleanedName)')，可用设备: \(allDevices.map(\.deviceName))"
-            )
-        return nil
-    }
-
-    /// 清理设备名称，去掉系统添加的后缀
-    private func cleanDeviceName(_ name: String) -> String {
-        var cleanName = name
-
-        // 去掉常见后缀
-        let suffixes = [
-            "的相机",
-            "的桌上视角相机",
-            "的摄像头",
-            "'s Camera",
-            "'s Desk View Camera",
-            " Camera",
-        ]
-
-        for suffix in suffixes {
-            if cleanName.hasSuffix(suffix) {
-                cleanName = String(cleanName.dropLast(suffix.count))
-                break
-            }
-        }
-
-        // 去掉首尾引号（英文和中文引号）
-        let quotePatterns: [(String, String)] = [
-            ("\"", "\""),
-            ("\u{201C}", "\u{201D}"), // 中文引号 " "
-        ]
-
-        for (openQuote, closeQuote) in quotePatterns {
-            if cleanName.hasPrefix(openQuote), cleanName.hasSuffix(closeQuote) {
-                cleanName = String(cleanName.dropFirst().dropLast())
-                break
-            }
+        guard let match = index.correlate(avUniqueID: avUniqueID, modelID: modelID, name: name) else {
+            AppLogger.device.warning("FBDeviceControl: 未找到匹配设备 (name: '\(name)')，可用设备: \(index.deviceNames)")
+            return nil
         }
-
-        return cleanName.trimmingCharacters(in: .whitespaces)
+        AppLogger.device.info("FBDeviceControl: 匹配设备 '\(name)' -> '\(match.deviceName)' UDID: \(match.udid)")
+        return match
     }
 
     /// 检测可能占用设备的应用
@@ -0,0 +1,216 @@
+//
+//  IOSDeviceCorrelationIndex.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  AVCaptureDevice 与 FBDevice 的关联索引
+//  按 UDID、AVFoundation uniqueID、规范化名称和机型标识索引 FBDeviceControl 设备，
+//  由 FBDeviceControlService 的差量更新维护，查询设备信息时不再重新列举设备
+//
+
+import FBDeviceControlKit
+import Foundation
+
+// MARK: - 设备关联索引
+
+/// AVCaptureDevice 与 FBDevice 的关联索引
+///
+/// 线程安全：所有方法均可在任意线程调用
+final class IOSDeviceCorrelationIndex {
+    // MARK: - 属性
+
+    /// 是否由设备观察持续维护（否则索引只是某次列举的快照）
+    var isMaintained: Bool {
+        lock.withLock { maintained }
+    }
+
+    private let lock = NSLock()
+    private var maintained = false
+
+    /// UDID -> 设备
+    private var devicesByUDID: [String: FBDeviceInfoDTO] = [:]
+
+    /// 规范化名称 -> UDID 集合
+    private var udidsByName: [String: Set<String>] = [:]
+
+    /// 机型标识 -> UDID 集合
+    private var udidsByProductType: [String: Set<String>] = [:]
+
+    /// AVFoundation uniqueID -> UDID（关联成功后记录，设备移除时清除）
+    private var udidsByAVUniqueID: [String: String] = [:]
+
+    // MARK: - 更新
+
+    /// 应用设备差量变化
+    /// - Parameters:
+    ///   - added: 新增的设备
+    ///   - removed: 已移除设备的 UDID
+    ///   - updated: 信息变化的设备
+    func apply(added: [FBDeviceInfoDTO], removed: [String], updated: [FBDeviceInfoDTO]) {
+        lock.withLock {
+            maintained = true
+            for udid in removed {
+                unindex(udid: udid)
+                udidsByAVUniqueID = udidsByAVUniqueID.filter { $0.value != udid }
+            }
+            for device in added + updated {
+                unindex(udid: device.udid)
+                index(device)
+            }
+        }
+    }
+
+    /// 用完整的设备列表替换索引（保留仍然存在的设备的 AVFoundation 关联）
+    /// - Parameter devices: 当前所有设备
+    func replaceAll(_ devices: [FBDeviceInfoDTO]) {
+        lock.withLock {
+            devicesByUDID = [:]
+            udidsByName = [:]
+            udidsByProductType = [:]
+            for device in devices {
+                index(device)
+            }
+            udidsByAVUniqueID = udidsByAVUniqueID.filter { devicesByUDID[$0.value] != nil }
+        }
+    }
+
+    /// 停止维护，之后的查询需要先重新列举设备
+    func invalidate() {
+        lock.withLock {
+            maintained = false
+        }
+    }
+
+    // MARK: - 查询
+
+    /// 按 UDID 查询设备
+    func device(udid: String) -> FBDeviceInfoDTO? {
+        lock.withLock { devicesByUDID[udid] }
+    }
+
+    /// 查找与 AVCaptureDevice 对应的设备
+    /// - Parameters:
+    ///   - avUniqueID: AVFoundation 的 uniqueID
+    ///   - modelID: 机型标识（来自 AVCaptureDevice.modelID，通常是 "iOS Device"）
+    ///   - name: 设备名称（来自 AVFoundation localizedName，可能带后缀如 "Sun的相机"）
+    /// - Returns: 匹配的设备，找不到返回 nil
+    ///
+    /// 匹配策略优先级：
+    /// 1. 已关联过的 AVFoundation uniqueID
+    /// 2. 单设备自动匹配（最常见场景，最可靠）
+    /// 3. 规范化名称精确匹配
+    /// 4. 规范化名称模糊匹配（包含关系，仅遍历名称）
+    /// 5. 机型标识匹配（仅当 modelID 是具体型号时，如 "iPhone17,1"）
+    func correlate(avUniqueID: String, modelID: String, name: String) -> FBDeviceInfoDTO? {
+        lock.withLock {
+            if let udid = udidsByAVUniqueID[avUniqueID], let device = devicesByUDID[udid] {
+                return device
+            }
+            guard let device = match(modelID: modelID, name: name) else {
+                return nil
+            }
+            udidsByAVUniqueID[avUniqueID] = device.udid
+            return device
+        }
+    }
+
+    /// 所有设备名称（用于日志）
+    var deviceNames: [String] {
+        lock.withLock { devicesByUDID.values.map(\.deviceName) }
+    }
+
+    // MARK: - 私有方法
+
+    /// 按名称与机型匹配（需持有锁）
+    private func match(modelID: String, name: String) -> FBDeviceInfoDTO? {
+        if devicesByUDID.count == 1 {
+            return devicesByUDID.values.first
+        }
+
+        let normalized = Self.normalizedName(name)
+        if let udids = udidsByName[normalized], let device = firstDevice(in: udids) {
+            return device
+        }
+
+        if
+            !normalized.isEmpty,
+            let (_, udids) = udidsByName.first(where: { !$0.key.isEmpty && ($0.key.contains(normalized) || normalized.contains($0.key)) }),
+            let device = firstDevice(in: udids) {
+            return device
+        }
+
+        // 通常 modelID 是 "iOS Device"，这个策略很少生效
+        if !modelID.isEmpty, modelID != "iOS Device", let udids = udidsByProductType[modelID] {
+            if udids.count > 1 {
+                AppLogger.device.warning("FBDeviceControl: 多台同型号设备 '\(modelID)'，使用其中一台")
+            }
+            return firstDevice(in: udids)
+        }
+        return nil
+    }
+
+    /// 集合中 UDID 最小的设备，使多台同名设备的匹配结果稳定
+    private func firstDevice(in udids: Set<String>) -> FBDeviceInfoDTO? {
+        udids.min().flatMap { devicesByUDID[$0] }
+    }
+
+    /// 加入索引（需持有锁）
+    private func index(_ device: FBDeviceInfoDTO) {
+        devicesByUDID[device.udid] = device
+        udidsByName[Self.normalizedName(device.deviceName), default: []].insert(device.udid)
+        if let productType = device.productType, !productType.isEmpty {
+            udidsByProductType[productType, default: []].insert(device.udid)
+        }
+    }
+
+    /// 从名称与机型索引中移除（需持有锁）
+    private func unindex(udid: String) {
+        guard let existing = devicesByUDID.removeValue(forKey: udid) else { return }
+        let name = Self.normalizedName(existing.deviceName)
+        udidsByName[name]?.remove(udid)
+        if udidsByName[name]?.isEmpty == true {
+            udidsByName[name] = nil
+        }
+        if let productType = existing.productType {
+            udidsByProductType[productType]?.remove(udid)
+            if udidsByProductType[productType]?.isEmpty == true {
+                udidsByProductType[productType] = nil
+            }
+        }
+    }
+
+    // MARK: - 名称规范化
+
+    /// 系统为相机设备名称添加的后缀
+    private static let cameraNameSuffixes = [
+        "的相机",
+        "的桌上视角相机",
+        "的摄像头",
+        "'s Camera",
+        "'s Desk View Camera",
+        " Camera",
+    ]
+
+    /// 规范化设备名称：去掉系统添加的后缀与首尾引号，忽略大小写
+    static func normalizedName(_ name: String) -> String {
+        var cleanName = name
+
+        for suffix in cameraNameSuffixes where cleanName.hasSuffix(suffix) {
+            cleanName = String(cleanName.dropLast(suffix.count))
+            break
+        }
+
+        // 去掉首尾引号（英文和中文引号）
+        let quotePatterns: [(String, String)] = [
+            ("\"", "\""),
+            ("\u{201C}", "\u{201D}"),
+        ]
+        for (openQuote, closeQuote) in quotePatterns where cleanName.hasPrefix(openQuote) && cleanName.hasSuffix(closeQuote) {
+            cleanName = String(cleanName.dropFirst().dropLast())
+            break
+        }
+
+        return cleanName.trimmingCharacters(in: .whitespaces).lowercased()
+    }
+}
@@ -13,6 +13,7 @@ import Combine
 import CoreMedia
 import CoreVideo
 import Foundation
+import os
 
 /// 设备平台
 enum DevicePlatform: String {
@@ -258,6 +259,9 @@ class BaseDeviceSource: NSObject, DeviceSource {
     /// 最新的 CVPixelBuffer（子类需要维护）
     var latestPixelBuffer: CVPixelBuffer? { nil }
 
+    /// 帧缩略图分接（子类有帧管道时返回管道的分接）
+    var thumbnailTap: FrameThumbnailTap? { nil }
+
     // MARK: - Properties
 
     let id: UUID
@@ -279,6 +283,9 @@ class BaseDeviceSource: NSObject, DeviceSource {
 
     var cancellables = Set<AnyCancellable>()
 
+    /// 是否等待本次捕获的首个视频样本（用于记录启动里程碑）
+    private let awaitingStartupSample = OSAllocatedUnfairLock(initialState: false)
+
     // MARK: - Initialization
 
     init(id: UUID = UUID(), displayName: String, sourceType: DeviceSourceType) {
@@ -313,6 +320,33 @@ class BaseDeviceSource: NSObject, DeviceSource {
         }
     }
 
+    // MARK: - Startup Profiling
+
+    /// 启动时间线的设备 ID（iOS 为 UDID，Android 为序列号）
+    var startupDeviceID: String? {
+        deviceInfo?.id
+    }
+
+    /// 记录启动里程碑；请求捕获时开始等待本次捕获的首个视频样本
+    func markStartup(_ milestone: DeviceStartupMilestone) {
+        guard let startupDeviceID else { return }
+        if milestone == .captureRequested {
+            awaitingStartupSample.withLock { $0 = true }
+        }
+        DeviceStartupProfiler.shared.mark(milestone, deviceID: startupDeviceID)
+    }
+
+    /// 收到视频样本时调用，每次捕获只记录第一个
+    func markStartupSampleIfNeeded() {
+        let isFirst = awaitingStartupSample.withLock { awaiting -> Bool in
+            defer { awaiting = false }
+            return awaiting
+        }
+        if isFirst {
+            markStartup(.firstSample)
+        }
+    }
+
     // MARK: - Frame Handling
 
     func emitFrame(_ frame: CapturedFrame) {
@@ -364,4 +398,14 @@ class BaseDeviceSource: NSObject, DeviceSource {
         updateState(.capturing)
         AppLogger.capture.info("捕获已恢复: \(displayName)")
     }
+
+    // MARK: - 截图
+
+    /// 从正在投屏的最新帧生成截图（不向设备请求）
+    /// - Returns: 截图；未在捕获或尚未收到画面时为 nil，调用方可回退到向设备请求截图
+    func snapshot() -> FrameSnapshot? {
+        guard state == .capturing || state == .paused else { return nil }
+        guard let frame = latestFrame, let pixelBuffer = frame.pixelBuffer else { return nil }
+        return FrameSnapshot(pixelBuffer: pixelBuffer, presentationTime: frame.timestamp)
+    }
 }
@@ -0,0 +1,259 @@
+//
+//  DeviceStartupProfiler.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  设备启动耗时剖析
+//  按设备记录从接入到首帧上屏的各个里程碑，每次启动一个 os_signpost 区间，
+//  完成的时间线保留在滚动历史中，由捕获信息视图展示，用于定位启动慢的阶段
+//
+//  里程碑:
+//  接入 → 通知 → 请求捕获 → 会话就绪 → 码流启动 → 首个样本 → 解码器就绪 → 首帧
+//
+
+import Foundation
+import os
+import QuartzCore
+
+// MARK: - 启动里程碑
+
+/// 设备启动过程中的里程碑（按时间顺序）
+enum DeviceStartupMilestone: Int, CaseIterable {
+    /// 设备接入（iOS: FBDeviceSet 报告新增；Android: adb 上报设备列表）
+    case attached
+    /// 设备信息交付给应用（iOS: FBDeviceControlBridge 差量回调；Android: 属性读取完成）
+    case notified
+    /// 请求开始捕获（之前的时间是等待用户操作，不计入启动耗时）
+    case captureRequested
+    /// 会话就绪（iOS: 捕获会话配置完成；Android: scrcpy-server 已启动）
+    case sessionReady
+    /// 码流启动（iOS: 捕获会话开始运行；Android: 视频连接建立）
+    case streamStarted
+    /// 收到首个视频样本（iOS: 像素缓冲；Android: 视频包）
+    case firstSample
+    /// 解码器就绪（仅 Android）
+    case decoderReady
+    /// 首帧上屏
+    case firstFrame
+
+    /// 显示名称（以到达该里程碑的阶段命名）
+    var name: String {
+        switch self {
+        case .attached: "接入"
+        case .notified: "通知"
+        case .captureRequested: "等待"
+        case .sessionReady: "会话"
+        case .streamStarted: "码流"
+        case .firstSample: "首样本"
+        case .decoderReady: "解码器"
+        case .firstFrame: "首帧"
+        }
+    }
+}
+
+// MARK: - 启动时间线
+
+/// 一次设备启动的时间线
+struct DeviceStartupTimeline {
+    /// 设备 ID（iOS 为 UDID，Android 为序列号）
+    let deviceID: String
+
+    /// 各里程碑的时间（CACurrentMediaTime 时基），未到达的里程碑为 nil
+    fileprivate(set) var timestamps = [CFTimeInterval?](repeating: nil, count: DeviceStartupMilestone.allCases.count)
+
+    /// 里程碑的时间
+    func time(of milestone: DeviceStartupMilestone) -> CFTimeInterval? {
+        timestamps[milestone.rawValue]
+    }
+
+    /// 各阶段耗时（秒，从上一个已记录的里程碑到该里程碑），不含等待用户操作的阶段
+    var phases: [(milestone: DeviceStartupMilestone, duration: CFTimeInterval)] {
+        var phases: [(DeviceStartupMilestone, CFTimeInterval)] = []
+        var previous: CFTimeInterval?
+        for milestone in DeviceStartupMilestone.allCases {
+            guard let timestamp = time(of: milestone) else { continue }
+            if let previous, milestone != .captureRequested {
+                phases.append((milestone, max(0, timestamp - previous)))
+            }
+            previous = timestamp
+        }
+        return phases
+    }
+
+    /// 发现耗时（接入到交付给应用）
+    var discoveryDuration: CFTimeInterval? {
+        guard let attached = time(of: .attached), let notified = time(of: .notified) else { return nil }
+        return max(0, notified - attached)
+    }
+
+    /// 启动耗时（请求捕获到首帧上屏）
+    var captureDuration: CFTimeInterval? {
+        guard let requested = time(of: .captureRequested), let firstFrame = time(of: .firstFrame) else { return nil }
+        return max(0, firstFrame - requested)
+    }
+
+    /// 单行摘要（用于日志与界面）
+    var summary: String {
+        let phaseSummary = phases
+            .filter { $0.milestone.rawValue > DeviceStartupMilestone.captureRequested.rawValue }
+            .map { String(format: "%@ %.0f", $0.milestone.name, $0.duration * 1000) }
+            .joined(separator: " · ")
+        var summary = String(format: "启动 %.0fms", (captureDuration ?? 0) * 1000)
+        if !phaseSummary.isEmpty {
+            summary += "（\(phaseSummary)）"
+        }
+        if let discoveryDuration {
+            summary += String(format: "，发现 %.0fms", discoveryDuration * 1000)
+        }
+        return summary
+    }
+}
+
+// MARK: - 启动剖析器
+
+/// 设备启动耗时剖析器
+///
+/// 使用方式:
+/// - 设备接入时调用 begin(deviceID:attachedAt:)，之后各阶段调用 mark(_:deviceID:at:)
+/// - 请求捕获时若没有进行中的时间线（设备在应用启动前已接入、或再次捕获），从请求捕获开始新的时间线
+/// - 首帧上屏时时间线完成，移入滚动历史；设备移除时调用 abandon(deviceID:) 丢弃未完成的时间线
+///
+/// 每个里程碑在一条时间线中只记录一次，重复调用（如旋转后重建解码器）被忽略
+///
+/// 线程安全：所有方法都可在任意线程调用
+final class DeviceStartupProfiler {
+    // MARK: - 单例
+
+    static let shared = DeviceStartupProfiler()
+
+    // MARK: - 常量
+
+    /// 每台设备保留的历史时间线数量
+    static let historyLimit = 10
+
+    // MARK: - 类型定义
+
+    /// 进行中的时间线
+    private struct ActiveTimeline {
+        var timeline: DeviceStartupTimeline
+        let signpostState: OSSignpostIntervalState
+        let signpostID: OSSignpostID
+    }
+
+    /// 剖析状态
+    private struct State {
+        var active: [String: ActiveTimeline] = [:]
+        var history: [String: [DeviceStartupTimeline]] = [:]
+    }
+
+    // MARK: - 属性
+
+    private let signposter = OSSignposter(
+        subsystem: Bundle.main.bundleIdentifier ?? "com.haptictide.ScreenPresenter",
+        category: "DeviceStartup"
+    )
+
+    private let state = OSAllocatedUnfairLock(initialState: State())
+
+    // MARK: - 记录
+
+    /// 设备接入，开始新的时间线（丢弃该设备未完成的时间线）
+    /// - Parameters:
+    ///   - deviceID: 设备 ID
+    ///   - attachTime: 接入时间（CACurrentMediaTime 时基），未知时使用当前时间
+    func begin(deviceID: String, attachedAt attachTime: CFTimeInterval? = nil) {
+        start(deviceID: deviceID, milestone: .attached, at: attachTime ?? CACurrentMediaTime())
+    }
+
+    /// 记录设备到达某个里程碑
+    /// - Parameters:
+    ///   - milestone: 里程碑
+    ///   - deviceID: 设备 ID
+    ///   - time: 到达时间（CACurrentMediaTime 时基）
+    func mark(_ milestone: DeviceStartupMilestone, deviceID: String, at time: CFTimeInterval = CACurrentMediaTime()) {
+        if milestone == .attached {
+            start(deviceID: deviceID, milestone: milestone, at: time)
+            return
+        }
+
+        enum Outcome {
+            case recorded(OSSignpostID)
+            case completed(ActiveTimeline)
+            case startNew
+            case ignored
+        }
+        let outcome: Outcome = state.withLock { state in
+            guard var active = state.active[deviceID] else {
+                // 没有进行中的时间线时，只有请求捕获会开始新的时间线
+                return milestone == .captureRequested ? .startNew : .ignored
+            }
+            guard active.timeline.time(of: milestone) == nil else {
+                return milestone == .captureRequested ? .startNew : .ignored
+            }
+            active.timeline.timestamps[milestone.rawValue] = time
+            guard milestone == .firstFrame else {
+                state.active[deviceID] = active
+                return .recorded(active.signpostID)
+            }
+            state.active[deviceID] = nil
+            var history = state.history[deviceID, default: []]
+            history.append(active.timeline)
+            if history.count > Self.historyLimit {
+                history.removeFirst(history.count - Self.historyLimit)
+            }
+            state.history[deviceID] = history
+            return .completed(active)
+        }
+
+        switch outcome {
+        case let .recorded(signpostID):
+            signposter.emitEvent("Milestone", id: signpostID, "\(milestone.name, privacy: .public)")
+        case let .completed(active):
+            signposter.endInterval("Startup", active.signpostState, "first frame")
+            AppLogger.performance.info("[启动] \(deviceID): \(active.timeline.summary)")
+        case .startNew:
+            start(deviceID: deviceID, milestone: milestone, at: time)
+        case .ignored:
+            break
+        }
+    }
+
+    /// 丢弃设备未完成的时间线（设备移除时调用）
+    func abandon(deviceID: String) {
+        let abandoned = state.withLock { state in
+            state.active.removeValue(forKey: deviceID)
+        }
+        if let abandoned {
+            signposter.endInterval("Startup", abandoned.signpostState, "abandoned")
+        }
+    }
+
+    /// 设备已完成的启动时间线（按时间顺序，最新的在最后）
+    func history(deviceID: String) -> [DeviceStartupTimeline] {
+        state.withLock { state in
+            state.history[deviceID] ?? []
+        }
+    }
+
+    // MARK: - 私有方法
+
+    /// 以指定里程碑开始新的时间线
+    private func start(deviceID: String, milestone: DeviceStartupMilestone, at time: CFTimeInterval) {
+        let signpostID = signposter.makeSignpostID()
+        let signpostState = signposter.beginInterval("Startup", id: signpostID, "\(deviceID, privacy: .public)")
+        signposter.emitEvent("Milestone", id: signpostID, "\(milestone.name, privacy: .public)")
+
+        var timeline = DeviceStartupTimeline(deviceID: deviceID)
+        timeline.timestamps[milestone.rawValue] = time
+        let replaced = state.withLock { state in
+            state.active.updateValue(
+                ActiveTimeline(timeline: timeline, signpostState: signpostState, signpostID: signpostID),
+                forKey: deviceID
+            )
+        }
+        if let replaced {
+            signposter.endInterval("Startup", replaced.signpostState, "abandoned")
+        }
+    }
+}
@@ -7,12 +7,18 @@
 //  iOS 设备源
 //  使用 CoreMediaIO + AVFoundation 捕获 USB 连接的 iPhone/iPad 屏幕
 //  这是 QuickTime 同款路径，稳定可靠
+//  捕获会话与视频输出由 FBDeviceVideo / FBDeviceVideoStream 创建，画面以像素缓冲消费者接入，
+//  录制、推流与预览共享同一个会话、帧率限制与像素格式
+//
+//  启用捕获服务时，会话运行在 ScreenPresenterCaptureService 进程中，画面以 IOSurface 跨进程交付，
+//  应用卡顿不影响捕获；服务不可用时回退到应用进程内捕获
 //
 
 @preconcurrency import AVFoundation
 import Combine
 import CoreMedia
 import CoreVideo
+import FBDeviceControlKit
 import Foundation
 import os.lock
 
@@ -30,16 +36,27 @@ final class IOSDeviceSource: BaseDeviceSource, @unchecked Sendable {
     /// 最新的 CVPixelBuffer（仅用于获取尺寸信息，不长期持有）
     override var latestPixelBuffer: CVPixelBuffer? { nil }
 
+    /// 帧缩略图分接
+    override var thumbnailTap: FrameThumbnailTap? { framePipeline.thumbnailTap }
+
     // MARK: - 私有属性
 
     private var captureSession: AVCaptureSession?
-    private var videoOutput: AVCaptureVideoDataOutput?
     private var audioOutput: AVCaptureAudioDataOutput?
     private let captureQueue = DispatchQueue(label: "com.screenPresenter.ios.capture", qos: .userInteractive)
     private let audioQueue = DispatchQueue(label: "com.screenPresenter.ios.audio", qos: .userInteractive)
 
-    /// 视频输出代理
-    private var videoDelegate: VideoCaptureDelegate?
+    /// 视频流（拥有会话的视频输出，向所有消费者分发画面）
+    private var videoStream: FBDeviceVideoStream?
+
+    /// 捕获策略施加的帧率上限（nil 表示按偏好设置帧率，仅主线程访问）
+    private var policyFrameRateLimit: Int?
+
+    /// 预览画面的像素缓冲消费者
+    private var frameConsumer: (any FBVideoSurfaceConsumerProtocol & FBDataConsumerLifecycle)?
+
+    /// 捕获服务中的捕获 ID（nil 表示在应用进程内捕获，仅主线程访问）
+    private var serviceCaptureID: String?
 
     /// 音频输出代理
     private var audioDelegate: AudioCaptureDelegate?
@@ -50,8 +67,16 @@ final class IOSDeviceSource: BaseDeviceSource, @unchecked Sendable {
     /// 是否正在捕获（使用线程安全的原子操作）
     private let capturingLock = OSAllocatedUnfairLock(initialState: false)
 
-    /// 帧回调
-    var onFrame: ((CVPixelBuffer) -> Void)?
+    /// 帧管道
+    /// 实现: 捕获线程 → FramePipeline → 渲染，像素缓冲全程零拷贝
+    private let framePipeline = FramePipeline()
+
+    /// 帧回调（通过 FramePipeline 分发，已实现事件合并）
+    var onFrame: ((CVPixelBuffer) -> Void)? {
+        didSet {
+            framePipeline.setFrameHandler(onFrame ?? { _ in })
+        }
+    }
 
     // MARK: - 音频控制
 
@@ -70,6 +95,9 @@ final class IOSDeviceSource: BaseDeviceSource, @unchecked Sendable {
         set {
             UserPreferences.shared.iosAudioVolume = newValue
             audioPlayer?.volume = newValue
+            if let serviceCaptureID {
+                CaptureServiceClient.shared.setAudio(enabled: isAudioEnabled, volume: newValue, captureID: serviceCaptureID)
+            }
         }
     }
 
@@ -92,6 +120,7 @@ final class IOSDeviceSource: BaseDeviceSource, @unchecked Sendable {
 
         self.deviceInfo = deviceInfo
 
+        MainThreadWatchdog.shared.register(self)
         AppLogger.device.info("创建 iOS 设备源: \(device.name)")
     }
 
@@ -112,8 +141,12 @@ final class IOSDeviceSource: BaseDeviceSource, @unchecked Sendable {
                 IOSScreenMirrorActivator.shared.enableDALDevices()
             }
 
-            // 2. 创建捕获会话
-            try await setupCaptureSession()
+            // 2. 创建捕获会话（优先在捕获服务中创建）
+            let openedInService = try await setupServiceCapture()
+            if !openedInService {
+                try await setupCaptureSession()
+            }
+            markStartup(.sessionReady)
 
             updateState(.connected)
             AppLogger.connection.info("iOS 设备已连接: \(iosDevice.name)")
@@ -132,15 +165,20 @@ final class IOSDeviceSource: BaseDeviceSource, @unchecked Sendable {
         // 移除通知监听
         NotificationCenter.default.removeObserver(self)
 
+        if let serviceCaptureID {
+            CaptureServiceClient.shared.closeCapture(serviceCaptureID)
+            self.serviceCaptureID = nil
+        }
+
         // 清理音频
         audioPlayer?.stop()
         audioPlayer = nil
 
         captureSession?.stopRunning()
         captureSession = nil
-        videoOutput = nil
+        videoStream = nil
+        frameConsumer = nil
         audioOutput = nil
-        videoDelegate = nil
         audioDelegate = nil
         onFrame = nil
 
@@ -154,7 +192,7 @@ final class IOSDeviceSource: BaseDeviceSource, @unchecked Sendable {
             throw DeviceSourceError.captureStartFailed(L10n.capture.deviceNotConnected)
         }
 
-        guard let session = captureSession else {
+        guard captureSession != nil || serviceCaptureID != nil else {
             throw DeviceSourceError.captureStartFailed(L10n.capture.sessionNotInitialized)
         }
 
@@ -163,6 +201,22 @@ final class IOSDeviceSource: BaseDeviceSource, @unchecked Sendable {
         // ⚠️ 重要：在启动会话之前设置标志，避免竞态条件
         capturingLock.withLock { $0 = true }
         lastCaptureSize = .zero // 重置尺寸以便重新检测
+        framePipeline.start(size: captureSize != .zero ? captureSize : CGSize(width: 1170, height: 2532))
+
+        if let serviceCaptureID {
+            do {
+                try await CaptureServiceClient.shared.startCapture(serviceCaptureID)
+            } catch {
+                capturingLock.withLock { $0 = false }
+                framePipeline.stop()
+                throw DeviceSourceError.captureStartFailed(error.localizedDescription)
+            }
+            markStartup(.streamStarted)
+            updateState(.capturing)
+            AppLogger.capture.info("iOS 捕获已启动（捕获服务）: \(iosDevice.name)")
+            return
+        }
+        guard let session = captureSession else { return }
 
         // 在后台线程启动会话
         await withCheckedContinuation { continuation in
@@ -172,9 +226,14 @@ final class IOSDeviceSource: BaseDeviceSource, @unchecked Sendable {
                     return
                 }
 
+                // 首个消费者接入时视频流会启动会话；会话此前被停止过时在此重新启动
+                if let videoStream, let frameConsumer {
+                    videoStream.attachConsumer(frameConsumer, policy: .dropOldest, maxPendingFrames: 1)
+                }
                 if !session.isRunning {
                     session.startRunning()
                 }
+                markStartup(.streamStarted)
 
                 DispatchQueue.main.async {
                     self.updateState(.capturing)
@@ -194,8 +253,23 @@ final class IOSDeviceSource: BaseDeviceSource, @unchecked Sendable {
         }
         guard wasCapturing else { return }
 
+        framePipeline.stop()
+
+        if let serviceCaptureID {
+            await CaptureServiceClient.shared.stopCapture(serviceCaptureID)
+            if state == .capturing {
+                updateState(.connected)
+            }
+            AppLogger.capture.info("iOS 捕获已停止（捕获服务）: \(iosDevice.name)")
+            return
+        }
+
         await withCheckedContinuation { continuation in
             captureQueue.async { [weak self] in
+                // 视频流的其他消费者（录制、推流）不受影响，但预览停止时不再保留会话
+                if let videoStream = self?.videoStream, let frameConsumer = self?.frameConsumer {
+                    videoStream.detachConsumer(frameConsumer)
+                }
                 self?.captureSession?.stopRunning()
 
                 DispatchQueue.main.async {
@@ -210,6 +284,88 @@ final class IOSDeviceSource: BaseDeviceSource, @unchecked Sendable {
         AppLogger.capture.info("iOS 捕获已停止: \(iosDevice.name)")
     }
 
+    // MARK: - 捕获服务
+
+    /// 在捕获服务中打开捕获
+    /// - Returns: 是否已在服务中打开；服务未启用或不可用时返回 false，由调用方在应用进程内创建会话
+    private func setupServiceCapture() async throws -> Bool {
+        let client = CaptureServiceClient.shared
+        guard client.isEnabled else { return false }
+
+        do {
+            let captureID = try await client.openCapture(
+                avUniqueID: iosDevice.avUniqueID,
+                framesPerSecond: UserPreferences.shared.captureFrameRate,
+                audioEnabled: isAudioEnabled,
+                audioVolume: audioVolume
+            ) { [weak self] pixelBuffer, presentationTime in
+                self?.handleVideoPixelBuffer(pixelBuffer, presentationTime: presentationTime)
+            }
+            serviceCaptureID = captureID
+            if let limit = policyFrameRateLimit {
+                client.setFrameRateLimit(limit, captureID: captureID)
+            }
+            NotificationCenter.default.addObserver(
+                self,
+                selector: #selector(captureServiceInterrupted),
+                name: .captureServiceInterrupted,
+                object: nil
+            )
+            AppLogger.capture.info("iOS 捕获会话已在捕获服务中配置: \(iosDevice.name)")
+            return true
+        } catch let error as CaptureServiceClient.ClientError {
+            AppLogger.capture.warning("\(error.localizedDescription)，在应用进程内捕获")
+            return false
+        } catch {
+            throw deviceSourceError(fromServiceError: error)
+        }
+    }
+
+    /// 捕获服务中断：服务中的会话已丢失，重新打开并恢复捕获状态
+    @objc private func captureServiceInterrupted() {
+        guard serviceCaptureID != nil else { return }
+        let wasCapturing = capturingLock.withLock { $0 }
+        serviceCaptureID = nil
+        NotificationCenter.default.removeObserver(self, name: .captureServiceInterrupted, object: nil)
+        AppLogger.capture.warning("捕获服务中断，重新打开 iOS 捕获: \(iosDevice.name)")
+
+        Task { @MainActor in
+            do {
+                let openedInService = try await setupServiceCapture()
+                if !openedInService {
+                    try await setupCaptureSession()
+                }
+                if wasCapturing {
+                    capturingLock.withLock { $0 = false }
+                    framePipeline.stop()
+                    updateState(.connected)
+                    try await startCapture()
+                }
+            } catch {
+                let deviceError = error as? DeviceSourceError ?? .connectionFailed(error.localizedDescription)
+                updateState(.error(deviceError))
+            }
+        }
+    }
+
+    /// 把服务返回的错误映射为设备源错误（与应用进程内创建会话时的错误一致）
+    private func deviceSourceError(fromServiceError error: Error) -> DeviceSourceError {
+        switch CaptureServiceErrorCode(error: error) {
+        case .deviceNotFound:
+            .connectionFailed(L10n.capture.cannotGetDevice(iosDevice.id))
+        case .deviceInUse:
+            .deviceInUse("QuickTime")
+        case .deviceNotReady:
+            .connectionFailed(L10n.capture.deviceNotReady(iosDevice.name))
+        case .inputFailed:
+            .connectionFailed(L10n.capture.inputFailed(error.localizedDescription))
+        case .cannotAddOutput:
+            .connectionFailed(L10n.capture.cannotAddOutput)
+        case .timingRingUnavailable, .captureNotFound, nil:
+            .connectionFailed(error.localizedDescription)
+        }
+    }
+
     // MARK: - 捕获会话设置
 
     private func setupCaptureSession() async throws {
@@ -229,26 +385,17 @@ final class IOSDeviceSource: BaseDeviceSource, @unchecked Sendable {
             throw DeviceSourceError.deviceInUse("QuickTime")
         }
 
-        let session = AVCaptureSession()
-        session.sessionPreset = .high
-
-        // 配置捕获帧率
-        configureFrameRate(for: captureDevice)
-
-        // 添加视频输入
+        // 创建会话（与 FBDeviceVideo 的录制共用同一套会话配置）
+        let session: AVCaptureSession
         do {
-            let videoInput = try AVCaptureDeviceInput(device: captureDevice)
-            guard session.canAddInput(videoInput) else {
-                AppLogger.capture.error("无法添加视频输入到会话")
-                throw DeviceSourceError.connectionFailed(L10n.capture.cannotAddInput)
-            }
-            session.addInput(videoInput)
+            session = try FBDeviceVideo.captureSession(for: captureDevice)
             AppLogger.capture.info("视频输入已添加")
         } catch {
             AppLogger.capture.error("创建视频输入失败: \(error.localizedDescription)")
 
-            // 检测常见错误并提供更有用的提示
-            let errorMessage = error.localizedDescription
+            // 检测常见错误并提供更有用的提示（AVCaptureDeviceInput 的原始错误）
+            let underlyingError = (error as NSError).userInfo[NSUnderlyingErrorKey] as? Error ?? error
+            let errorMessage = underlyingError.localizedDescription
             if errorMessage.contains("无法使用") || errorMessage.contains("Cannot use") {
                 // "无法使用 XXX" 通常是因为 iPhone 未解锁或未信任
                 throw DeviceSourceError.connectionFailed(L10n.capture.deviceNotReady(iosDevice.name))
@@ -257,37 +404,78 @@ final class IOSDeviceSource: BaseDeviceSource, @unchecked Sendable {
             }
         }
 
-        // 添加视频输出
-        let videoOutput = AVCaptureVideoDataOutput()
-        videoOutput.videoSettings = [
-            kCVPixelBufferPixelFormatTypeKey as String: kCVPixelFormatType_32BGRA,
-        ]
-        videoOutput.alwaysDiscardsLateVideoFrames = true
-
-        // 创建视频代理
-        let delegate = VideoCaptureDelegate { [weak self] sampleBuffer in
-            self?.handleVideoSampleBuffer(sampleBuffer)
-        }
-        videoOutput.setSampleBufferDelegate(delegate, queue: captureQueue)
-        AppLogger.capture.info("✅ 视频代理已设置到输出")
+        // 创建视频流
+        // 使用原生 420v 输出，IOSurface 承载且与 Metal 兼容，像素缓冲可直接导入为纹理（零拷贝）
+        // 帧率由视频流统一限制（捕获连接支持时在连接上限制，否则按节拍丢帧）
+        let videoStream = try makeVideoStream(session: session)
 
-        guard session.canAddOutput(videoOutput) else {
-            AppLogger.capture.error("❌ 无法添加视频输出到会话")
-            throw DeviceSourceError.connectionFailed(L10n.capture.cannotAddOutput)
+        // 以像素缓冲消费者接入预览
+        let frameConsumer = FBVideoSurfaceConsumer.consumer(on: captureQueue) { [weak self] pixelBuffer, presentationTime in
+            self?.handleVideoPixelBuffer(pixelBuffer, presentationTime: presentationTime)
         }
-        session.addOutput(videoOutput)
-        AppLogger.capture.info("✅ 视频输出已添加到会话")
+        AppLogger.capture.info("✅ 视频流已创建")
 
         // 添加音频输入和输出
         setupAudioCapture(for: session, videoDevice: captureDevice)
 
         captureSession = session
-        self.videoOutput = videoOutput
-        videoDelegate = delegate
+        self.videoStream = videoStream
+        if let limit = policyFrameRateLimit {
+            videoStream.limitFramesPerSecond(NSNumber(value: limit))
+        }
+        self.frameConsumer = frameConsumer
 
         AppLogger.capture.info("iOS 捕获会话已配置: \(iosDevice.name)")
     }
 
+    /// 创建视频流，优先使用 420v，设备不支持时回退为 BGRA
+    private func makeVideoStream(session: AVCaptureSession) throws -> FBDeviceVideoStream {
+        let framesPerSecond = NSNumber(value: UserPreferences.shared.captureFrameRate)
+        let baseConfiguration = FBVideoStreamConfiguration(
+            encoding: .BGRA,
+            framesPerSecond: framesPerSecond,
+            compressionQuality: nil,
+            scaleFactor: nil,
+            avgBitrate: nil,
+            keyFrameRate: nil
+        )
+        let logger = FBControlCoreGlobalConfiguration.defaultLogger
+
+        var lastError: Error?
+        for pixelFormat in [FBVideoStreamPixelFormat.format420VideoRange, .BGRA] {
+            do {
+                let configuration = baseConfiguration.withPixelFormat(pixelFormat, maxDimension: nil)
+                let stream = try FBDeviceVideoStream(session: session, configuration: configuration, logger: logger)
+                AppLogger.capture.info("视频流像素格式: \(pixelFormat == .BGRA ? "BGRA" : "420v"), 帧率上限: \(framesPerSecond) fps")
+                return stream
+            } catch {
+                AppLogger.capture.warning("视频流不支持像素格式 \(pixelFormat.rawValue): \(error.localizedDescription)")
+                lastError = error
+            }
+        }
+
+        AppLogger.capture.error("❌ 无法添加视频输出到会话: \(lastError?.localizedDescription ?? "")")
+        throw DeviceSourceError.connectionFailed(L10n.capture.cannotAddOutput)
+    }
+
+    // MARK: - 捕获策略
+
+    /// 应用捕获策略：在视频流上软件抽帧，不重建捕获会话
+    /// 主窗口不可见时只保留很低的帧率，画面仍会更新但几乎不占用渲染和编码资源
+    @MainActor
+    func applyCapturePolicy(_ policy: CapturePolicy) {
+        let frameRate = policy.rendersPaused ? CapturePolicy.hiddenFrameRate : policy.maxFrameRate
+        let limit = frameRate < UserPreferences.shared.captureFrameRate ? frameRate : nil
+        guard limit != policyFrameRateLimit else { return }
+
+        policyFrameRateLimit = limit
+        videoStream?.limitFramesPerSecond(limit.map { NSNumber(value: $0) })
+        if let serviceCaptureID {
+            CaptureServiceClient.shared.setFrameRateLimit(limit, captureID: serviceCaptureID)
+        }
+        AppLogger.capture.info("iOS 视频流帧率上限: \(limit.map { "\($0) fps" } ?? "按偏好设置")")
+    }
+
     // MARK: - 音频捕获设置
 
     /// 设置音频捕获
@@ -350,6 +538,9 @@ final class IOSDeviceSource: BaseDeviceSource, @unchecked Sendable {
     /// 更新音频播放状态
     private func updateAudioPlayback() {
         audioPlayer?.isMuted = !isAudioEnabled
+        if let serviceCaptureID {
+            CaptureServiceClient.shared.setAudio(enabled: isAudioEnabled, volume: audioVolume, captureID: serviceCaptureID)
+        }
     }
 
     // MARK: - 帧处理
@@ -357,15 +548,11 @@ final class IOSDeviceSource: BaseDeviceSource, @unchecked Sendable {
     /// 上一次的捕获尺寸（用于检测旋转）
     private var lastCaptureSize: CGSize = .zero
 
-    private func handleVideoSampleBuffer(_ sampleBuffer: CMSampleBuffer) {
+    private func handleVideoPixelBuffer(_ pixelBuffer: CVPixelBuffer, presentationTime: CMTime) {
         // 检查捕获状态（使用线程安全的原子读取）
         let isCapturing = capturingLock.withLock { $0 }
         guard isCapturing else { return }
-
-        // 获取 CVPixelBuffer
-        guard let pixelBuffer = CMSampleBufferGetImageBuffer(sampleBuffer) else {
-            return
-        }
+        markStartupSampleIfNeeded()
 
         // 获取当前帧尺寸
         let width = CVPixelBufferGetWidth(pixelBuffer)
@@ -387,84 +574,23 @@ final class IOSDeviceSource: BaseDeviceSource, @unchecked Sendable {
         }
 
         // 创建 CapturedFrame 并发送
-        let frame = CapturedFrame(sourceID: id, sampleBuffer: sampleBuffer)
+        let frame = CapturedFrame(sourceID: id, pixelBuffer: pixelBuffer, presentationTime: presentationTime, size: currentSize)
         emitFrame(frame)
 
-        // 直接回调通知渲染视图
-        onFrame?(pixelBuffer)
-    }
-
-    // MARK: - 帧率配置
-
-    /// 配置设备帧率
-    /// - Parameter device: AVCaptureDevice 实例
-    private func configureFrameRate(for device: AVCaptureDevice) {
-        let targetFps = UserPreferences.shared.captureFrameRate
-        let targetDuration = CMTime(value: 1, timescale: CMTimeScale(targetFps))
-
-        // 查找支持目标帧率的格式
-        // iOS 设备通过 CoreMediaIO 暴露时，格式支持可能有限
-        // 我们尝试设置帧率，如果失败则使用默认值
-        do {
-            try device.lockForConfiguration()
-            defer { device.unlockForConfiguration() }
-
-            // 检查当前格式是否支持目标帧率
-            let format = device.activeFormat
-            var bestFrameRateRange: AVFrameRateRange?
-
-            for range in format.videoSupportedFrameRateRanges {
-                // 检查目标帧率是否在支持范围内
-                if range.minFrameRate <= Double(targetFps) && Double(targetFps) <= range.maxFrameRate {
-                    bestFrameRateRange = range
-                    break
-                }
-
-                // 否则找到最接近的范围
-                if bestFrameRateRange == nil || range.maxFrameRate > bestFrameRateRange!.maxFrameRate {
-                    bestFrameRateRange = range
-                }
-            }
-
-            if let range = bestFrameRateRange {
-                // 目标帧率在支持范围内，直接设置
-                if range.minFrameRate <= Double(targetFps), Double(targetFps) <= range.maxFrameRate {
-                    device.activeVideoMinFrameDuration = targetDuration
-                    device.activeVideoMaxFrameDuration = targetDuration
-                    AppLogger.capture.info("iOS 帧率已配置: \(targetFps) fps")
-                } else {
-                    // 目标帧率超出支持范围，使用最大支持帧率
-                    let maxSupportedFps = Int(range.maxFrameRate)
-                    let actualDuration = CMTime(value: 1, timescale: CMTimeScale(maxSupportedFps))
-                    device.activeVideoMinFrameDuration = actualDuration
-                    device.activeVideoMaxFrameDuration = actualDuration
-                    AppLogger.capture.info("iOS 帧率已配置: \(maxSupportedFps) fps（目标 \(targetFps) fps 不支持）")
-                }
-            } else {
-                AppLogger.capture.warning("无法获取帧率支持范围，使用设备默认帧率")
-            }
-        } catch {
-            AppLogger.capture.warning("无法配置 iOS 帧率: \(error.localizedDescription)")
-        }
+        // 经帧管道交给渲染视图（只传递引用，不触碰像素数据）
+        ZeroCopyFrameContract.markProduced(pixelBuffer)
+        framePipeline.pushFrame(pixelBuffer)
     }
 }
 
-// MARK: - 视频捕获代理
-
-private final class VideoCaptureDelegate: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate {
-    private let handler: (CMSampleBuffer) -> Void
+// MARK: - HangCorrelationSource
 
-    init(handler: @escaping (CMSampleBuffer) -> Void) {
-        self.handler = handler
-        super.init()
-    }
+extension IOSDeviceSource: HangCorrelationSource {
+    var hangCorrelationName: String { displayName }
 
-    func captureOutput(
-        _: AVCaptureOutput,
-        didOutput sampleBuffer: CMSampleBuffer,
-        from _: AVCaptureConnection
-    ) {
-        handler(sampleBuffer)
+    /// 画面由 AVCapture 解码后交付，没有应用内的解码队列
+    func hangFrameSample() -> HangFrameSample {
+        HangFrameSample(skippedFrames: framePipeline.getStats().skipped, decodeQueueDepth: nil)
     }
 }
 
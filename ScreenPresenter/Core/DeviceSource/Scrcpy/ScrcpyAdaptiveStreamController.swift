@@ -0,0 +1,226 @@
+//
+//  ScrcpyAdaptiveStreamController.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  Scrcpy 码流自适应控制器
+//  根据显示尺寸、帧缓冲跳帧率与解码耗时，决定 scrcpy-server 的 max_size / video_bit_rate / max_fps
+//  server 以 control=false 启动，运行中无法重新协商，调整通过重启码流生效，因此带有滞回：
+//  降级需要持续过载，升级需要更长时间的持续空闲，且两次调整之间有最短间隔
+//
+
+import CoreGraphics
+import Foundation
+import QuartzCore
+
+// MARK: - 码流参数
+
+/// scrcpy 码流参数
+struct ScrcpyStreamProfile: Equatable {
+    /// 长边最大像素（0 表示不限制）
+    var maxSize: Int
+
+    /// 视频码率（bps）
+    var bitrate: Int
+
+    /// 最大帧率（0 表示不限制）
+    var maxFps: Int
+}
+
+// MARK: - 自适应控制器
+
+/// Scrcpy 码流自适应控制器
+/// 纯决策逻辑，不持有码流；由设备源定期提交采样，返回值非 nil 时按新参数重启码流
+final class ScrcpyAdaptiveStreamController {
+    // MARK: - 采样
+
+    /// 一个采样周期内的观测值
+    struct Sample {
+        /// 渲染视图的像素尺寸
+        let displayedPixelSize: CGSize
+
+        /// 当前码流的像素尺寸
+        let streamPixelSize: CGSize
+
+        /// 周期内帧缓冲的跳帧率（未渲染即被新帧覆盖的比例）
+        let skipRate: Double
+
+        /// 周期内的平均解码耗时（毫秒）
+        let averageDecodeTimeMs: Double
+    }
+
+    // MARK: - 常量
+
+    /// 最多降级的负载级别数
+    private static let maximumLoadLevel = 2
+
+    /// 每个负载级别的缩放系数
+    private static let loadLevelScale = 0.75
+
+    /// 显示尺寸与码流尺寸相差超过此比例才调整
+    private static let sizeChangeThreshold = 0.2
+
+    /// 最低码率（bps）
+    private static let minimumBitrate = 1_000_000
+
+    /// 降级需要连续满足的采样数
+    private static let downgradeSampleCount = 3
+
+    /// 升级需要连续满足的采样数
+    private static let upgradeSampleCount = 8
+
+    /// 两次调整之间的最短间隔（秒）
+    private static let minimumChangeInterval: TimeInterval = 15
+
+    // MARK: - 属性
+
+    /// 用户配置的码流参数（上限）
+    let baseline: ScrcpyStreamProfile
+
+    /// 当前生效的码流参数
+    private(set) var current: ScrcpyStreamProfile
+
+    /// 捕获策略施加的帧率上限（0 表示不限制）
+    var frameRateCap = 0
+
+    /// 负载级别（0 表示无过载降级）
+    private var loadLevel = 0
+
+    /// 设备原生画面长边（在未限制 max_size 时观测得到）
+    private var nativeLongEdge: CGFloat = 0
+
+    /// 等待确认的目标参数与连续满足的采样数
+    private var pendingTarget: ScrcpyStreamProfile?
+    private var pendingLoadLevel = 0
+    private var pendingSampleCount = 0
+
+    /// 上次调整的时间
+    private var lastChangeTime = CACurrentMediaTime()
+
+    // MARK: - 初始化
+
+    /// 初始化控制器
+    /// - Parameter baseline: 用户配置的码流参数
+    init(baseline: ScrcpyStreamProfile) {
+        self.baseline = baseline
+        current = baseline
+    }
+
+    // MARK: - 决策
+
+    /// 提交一个采样
+    /// - Parameter sample: 采样周期内的观测值
+    /// - Returns: 需要切换到的码流参数；无需调整时返回 nil
+    func evaluate(_ sample: Sample) -> ScrcpyStreamProfile? {
+        let streamLongEdge = max(sample.streamPixelSize.width, sample.streamPixelSize.height)
+        if current.maxSize == baseline.maxSize {
+            nativeLongEdge = max(nativeLongEdge, streamLongEdge)
+        }
+        guard nativeLongEdge > 0 else { return nil }
+
+        let desiredLoadLevel = nextLoadLevel(for: sample)
+        let target = profile(displayedPixelSize: sample.displayedPixelSize, loadLevel: desiredLoadLevel)
+
+        guard target != current, isMaterialChange(from: current, to: target) || desiredLoadLevel != loadLevel else {
+            pendingTarget = nil
+            pendingSampleCount = 0
+            return nil
+        }
+
+        if pendingTarget == target {
+            pendingSampleCount += 1
+        } else {
+            pendingTarget = target
+            pendingLoadLevel = desiredLoadLevel
+            pendingSampleCount = 1
+        }
+
+        let isDowngrade = target.maxSize.effectiveSize(native: nativeLongEdge) < current.maxSize
+            .effectiveSize(native: nativeLongEdge) || target.bitrate < current.bitrate
+            || target.maxFps.effectiveFrameRate < current.maxFps.effectiveFrameRate
+        let requiredSamples = isDowngrade ? Self.downgradeSampleCount : Self.upgradeSampleCount
+        let now = CACurrentMediaTime()
+        guard pendingSampleCount >= requiredSamples, now - lastChangeTime >= Self.minimumChangeInterval else {
+            return nil
+        }
+
+        current = target
+        loadLevel = pendingLoadLevel
+        pendingTarget = nil
+        pendingSampleCount = 0
+        lastChangeTime = now
+        return target
+    }
+
+    // MARK: - 私有方法
+
+    /// 根据跳帧率与解码耗时调整负载级别
+    private func nextLoadLevel(for sample: Sample) -> Int {
+        let frameIntervalMs = 1000 / Double(current.maxFps > 0 ? current.maxFps : 60)
+        let overloaded = sample.skipRate > 0.25 || sample.averageDecodeTimeMs > frameIntervalMs * 0.8
+        let idle = sample.skipRate < 0.05 && sample.averageDecodeTimeMs < frameIntervalMs * 0.4
+
+        if overloaded {
+            return min(loadLevel + 1, Self.maximumLoadLevel)
+        }
+        if idle {
+            return max(loadLevel - 1, 0)
+        }
+        return loadLevel
+    }
+
+    /// 计算目标码流参数
+    private func profile(displayedPixelSize: CGSize, loadLevel: Int) -> ScrcpyStreamProfile {
+        let baselineLongEdge = CGFloat(baseline.maxSize.effectiveSize(native: nativeLongEdge))
+        let displayedLongEdge = max(displayedPixelSize.width, displayedPixelSize.height)
+        let loadScale = pow(Self.loadLevelScale, Double(loadLevel))
+
+        // 显示尺寸未知时按配置上限
+        var longEdge = displayedLongEdge > 0 ? min(displayedLongEdge, baselineLongEdge) : baselineLongEdge
+        longEdge *= loadScale
+        // 编码器要求尺寸为 8 的倍数
+        let maxSize = max(8, Int(longEdge) / 8 * 8)
+
+        // 码率按像素面积缩放
+        let areaScale = Double((CGFloat(maxSize) / baselineLongEdge) * (CGFloat(maxSize) / baselineLongEdge))
+        let bitrate = max(Self.minimumBitrate, Int(Double(baseline.bitrate) * min(areaScale, 1)))
+
+        // 最高负载级别时同时限制帧率
+        var maxFps = baseline.maxFps
+        if loadLevel >= Self.maximumLoadLevel {
+            maxFps = baseline.maxFps > 0 ? min(baseline.maxFps, 30) : 30
+        }
+        if frameRateCap > 0, frameRateCap < maxFps.effectiveFrameRate {
+            maxFps = frameRateCap
+        }
+
+        // 不缩小时保持用户原始配置（包括 max_size=0 不限制）
+        if maxSize >= Int(baselineLongEdge) / 8 * 8 {
+            return ScrcpyStreamProfile(maxSize: baseline.maxSize, bitrate: baseline.bitrate, maxFps: maxFps)
+        }
+        return ScrcpyStreamProfile(maxSize: maxSize, bitrate: min(bitrate, baseline.bitrate), maxFps: maxFps)
+    }
+
+    /// 尺寸变化是否足够大
+    private func isMaterialChange(from old: ScrcpyStreamProfile, to new: ScrcpyStreamProfile) -> Bool {
+        let oldSize = Double(old.maxSize.effectiveSize(native: nativeLongEdge))
+        let newSize = Double(new.maxSize.effectiveSize(native: nativeLongEdge))
+        guard oldSize > 0 else { return true }
+        return abs(newSize - oldSize) / oldSize > Self.sizeChangeThreshold || old.maxFps != new.maxFps
+    }
+}
+
+// MARK: - 辅助
+
+private extension Int {
+    /// max_size 为 0 时的实际长边
+    func effectiveSize(native: CGFloat) -> Int {
+        self > 0 ? Swift.min(self, Int(native)) : Int(native)
+    }
+
+    /// max_fps 为 0 时视为不限制
+    var effectiveFrameRate: Int {
+        self > 0 ? self : .max
+    }
+}
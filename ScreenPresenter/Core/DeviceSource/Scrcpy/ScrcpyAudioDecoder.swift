@@ -6,6 +6,7 @@
 //
 //  Scrcpy 音频解码器
 //  使用 AudioToolbox 解码 AAC 音频
+//  解码到预分配的 PCM 缓冲区，解码过程不分配内存
 //
 
 import AudioToolbox
@@ -17,8 +18,16 @@ import Foundation
 
 /// Scrcpy 音频解码器
 /// 使用 AudioToolbox 的 AudioConverter 解码 AAC 音频
-/// 输出为 Float32 PCM 数据供 AudioPlayer 播放
+/// 输出为 Float32 interleaved PCM 样本供 AudioPlayer 播放
 final class ScrcpyAudioDecoder {
+    // MARK: - 常量
+
+    /// 每个 AAC 包的帧数
+    private static let framesPerPacket: UInt32 = 1024
+
+    /// 支持的最大声道数（AudioSpecificConfig 的声道配置最多 7.1）
+    private static let maxChannels = 8
+
     // MARK: - 属性
 
     /// 音频转换器
@@ -58,8 +67,12 @@ final class ScrcpyAudioDecoder {
     /// 解码成功计数（用于日志节流）
     private var decodeSuccessCount = 0
 
-    /// 解码后的 PCM 数据回调
-    var onDecodedAudio: ((Data, AVAudioFormat) -> Void)?
+    /// 解码后的 PCM 样本回调（interleaved）
+    /// 样本指向解码器内部的复用缓冲区，仅在回调期间有效
+    var onDecodedAudio: ((UnsafeBufferPointer<Float>, AVAudioFormat) -> Void)?
+
+    /// 复用的解码输出缓冲区（framesPerPacket × maxChannels）
+    private let outputSamples: UnsafeMutableBufferPointer<Float>
 
     /// 输出的 AVAudioFormat（供 AudioPlayer 使用）
     private(set) var outputAudioFormat: AVAudioFormat?
@@ -73,6 +86,10 @@ final class ScrcpyAudioDecoder {
     // MARK: - 初始化
 
     init() {
+        // 分配解码输出缓冲区
+        outputSamples = .allocate(capacity: Int(Self.framesPerPacket) * Self.maxChannels)
+        outputSamples.initialize(repeating: 0)
+
         // 分配 packet description 内存
         packetDescriptionPtr = UnsafeMutablePointer<AudioStreamPacketDescription>.allocate(capacity: 1)
         packetDescriptionPtr?.initialize(to: AudioStreamPacketDescription())
@@ -80,6 +97,7 @@ final class ScrcpyAudioDecoder {
 
     deinit {
         cleanup()
+        outputSamples.deallocate()
     }
 
     // MARK: - 公开方法
@@ -282,10 +300,14 @@ final class ScrcpyAudioDecoder {
             return
         }
 
-        // 计算输出缓冲区大小（每帧 1024 样本）
-        let outputFrames: UInt32 = 1024
+        guard outputFormat.mChannelsPerFrame > 0, Int(outputFormat.mChannelsPerFrame) <= Self.maxChannels,
+              let outputBase = outputSamples.baseAddress else {
+            return
+        }
+
+        // 输出缓冲区大小（每包 1024 帧）
+        let outputFrames = Self.framesPerPacket
         let outputByteSize = outputFrames * outputFormat.mBytesPerFrame
-        var outputBuffer = Data(count: Int(outputByteSize))
 
         // 使用 withUnsafeBytes 确保输入数据在整个解码过程中保持有效
         data.withUnsafeBytes { inputPtr in
@@ -298,43 +320,37 @@ final class ScrcpyAudioDecoder {
             inputBufferPointer = inputBaseAddress
             inputBufferSize = UInt32(data.count)
 
-            // 设置输出 buffer list
+            // 设置输出 buffer list（直接指向复用缓冲区）
             var outputBufferList = AudioBufferList(
                 mNumberBuffers: 1,
                 mBuffers: AudioBuffer(
                     mNumberChannels: outputFormat.mChannelsPerFrame,
                     mDataByteSize: outputByteSize,
-                    mData: nil
+                    mData: UnsafeMutableRawPointer(outputBase)
                 )
             )
 
-            outputBuffer.withUnsafeMutableBytes { outputPtr in
-                outputBufferList.mBuffers.mData = outputPtr.baseAddress
-                outputBufferList.mBuffers.mDataByteSize = outputByteSize
-
-                var outputPacketCount = outputFrames
+            var outputPacketCount = outputFrames
 
-                // 执行转换
-                let status = AudioConverterFillComplexBuffer(
-                    converter,
-                    inputDataProc,
-                    Unmanaged.passUnretained(self).toOpaque(),
-                    &outputPacketCount,
-                    &outputBufferList,
-                    nil
-                )
+            // 执行转换
+            let status = AudioConverterFillComplexBuffer(
+                converter,
+                inputDataProc,
+                Unmanaged.passUnretained(self).toOpaque(),
+                &outputPacketCount,
+                &outputBufferList,
+                nil
+            )
 
-                if status == noErr, outputPacketCount > 0 {
-                    let actualSize = Int(outputPacketCount * outputFormat.mBytesPerFrame)
-                    let pcmData = Data(bytes: outputPtr.baseAddress!, count: actualSize)
-                    decodeSuccessCount += 1
+            if status == noErr, outputPacketCount > 0 {
+                let sampleCount = Int(outputPacketCount * outputFormat.mChannelsPerFrame)
+                decodeSuccessCount += 1
 
-                    if let format = outputAudioFormat {
-                        onDecodedAudio?(pcmData, format)
-                    }
+                if let format = outputAudioFormat {
+                    onDecodedAudio?(UnsafeBufferPointer(start: outputBase, count: sampleCount), format)
                 }
-                // 静默忽略解码错误，避免日志洪泛
             }
+            // 静默忽略解码错误，避免日志洪泛
 
             // 清空指针
             inputBufferPointer = nil
@@ -0,0 +1,283 @@
+//
+//  ScrcpyMovieRecording.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  Scrcpy 直通录制
+//  把解析器已转换为 AVCC 的视频包原样写入 QuickTime 影片（AVAssetWriter 直通，outputSettings 为 nil），
+//  不经过解码与重新编码，录制几乎不占 CPU，画质与设备编码输出一致
+//
+//  时间戳:
+//  - 使用 scrcpy 帧头中的 PTS（微秒），会话从第一个关键帧开始
+//  - 码流重启（码流自适应）后编码器的 PTS 从头开始，在下一个关键帧处接续，保持时间线单调递增
+//  - scrcpy 的 Android 编码器不输出 B 帧，解码时间与显示时间一致，不单独设置 DTS
+//
+//  参数集变化（设备旋转）:
+//  QuickTime 影片允许同一轨道包含多个样本描述，新参数集的视频包携带新的格式描述继续写入同一轨道
+//
+
+import AVFoundation
+import CoreMedia
+import Foundation
+
+// MARK: - 直通录制器
+
+/// 直通录制器
+///
+/// 线程安全：
+/// - append() 在 socket 接收队列调用，只创建样本缓冲（不复制切片数据），写入在独立的串行队列进行
+/// - finish() 可在任意线程调用，调用后不再接受新的视频包
+final class ScrcpyMovieRecorder: @unchecked Sendable {
+    // MARK: - 常量
+
+    /// 码流重启后接续时，新旧两段之间的间隔（秒）
+    private static let discontinuityGap = CMTime(value: 1, timescale: 60)
+
+    // MARK: - 属性
+
+    /// 影片文件路径
+    let url: URL
+
+    private let writer: AVAssetWriter
+    private let writeQueue = DispatchQueue(label: "com.screenPresenter.scrcpy.movieRecorder", qos: .utility)
+
+    /// 当前参数集与对应的格式描述（仅在 socket 接收队列访问）
+    private var parameterSets: [Data] = []
+    private var formatDescription: CMFormatDescription?
+
+    /// 以下状态仅在 writeQueue 访问
+    private var input: AVAssetWriterInput?
+    private var isFinished = false
+    /// 丢帧后等待关键帧（直通写入缺少参考帧的 P 帧会导致花屏）
+    private var isAwaitingKeyFrame = true
+    /// 码流重启后的时间偏移
+    private var timeOffset = CMTime.zero
+    private var lastPresentationTime = CMTime.invalid
+    private var writtenFrameCount = 0
+    private var droppedFrameCount = 0
+
+    // MARK: - 初始化
+
+    /// 创建影片文件（已存在时覆盖）
+    /// - Parameter url: 影片文件路径
+    init(url: URL) throws {
+        try FileManager.default.createDirectory(
+            at: url.deletingLastPathComponent(),
+            withIntermediateDirectories: true
+        )
+        if FileManager.default.fileExists(atPath: url.path) {
+            try FileManager.default.removeItem(at: url)
+        }
+        writer = try AVAssetWriter(outputURL: url, fileType: .mov)
+        self.url = url
+    }
+
+    // MARK: - 录制
+
+    /// 追加一个视频包（配置包与参数集不完整时跳过）
+    /// - Parameters:
+    ///   - packet: 解析器输出的视频包
+    ///   - parser: 提供当前参数集的解析器
+    func append(_ packet: ScrcpyVideoPacket, from parser: ScrcpyVideoStreamParser) {
+        guard
+            !packet.isConfigPacket,
+            let blockBuffer = packet.blockBuffer,
+            let formatDescription = currentFormatDescription(from: parser),
+            let sampleBuffer = makeSampleBuffer(blockBuffer, packet: packet, formatDescription: formatDescription)
+        else {
+            return
+        }
+
+        let isKeyFrame = packet.isKeyFrame
+        writeQueue.async { [self] in
+            write(sampleBuffer, isKeyFrame: isKeyFrame)
+        }
+    }
+
+    /// 写完已排队的视频包并关闭影片
+    /// - Returns: 影片文件路径；没有写入任何帧或写入失败时为 nil（文件已删除）
+    func finish() async -> URL? {
+        await withCheckedContinuation { continuation in
+            writeQueue.async { [self] in
+                guard !isFinished else {
+                    continuation.resume(returning: nil)
+                    return
+                }
+                isFinished = true
+
+                guard let input, writer.status == .writing else {
+                    writer.cancelWriting()
+                    try? FileManager.default.removeItem(at: url)
+                    AppLogger.capture.info("[MovieRecorder] 未写入任何帧，已取消录制")
+                    continuation.resume(returning: nil)
+                    return
+                }
+
+                input.markAsFinished()
+                writer.finishWriting { [self] in
+                    if writer.status == .completed {
+                        AppLogger.capture.info(
+                            "[MovieRecorder] 录制完成: \(url.lastPathComponent)，写入 \(writtenFrameCount) 帧，丢弃 \(droppedFrameCount) 帧"
+                        )
+                        continuation.resume(returning: url)
+                    } else {
+                        AppLogger.capture.error("[MovieRecorder] 录制结束失败: \(writer.error?.localizedDescription ?? "未知错误")")
+                        continuation.resume(returning: nil)
+                    }
+                }
+            }
+        }
+    }
+
+    // MARK: - 私有方法
+
+    /// 参数集变化时重建格式描述
+    private func currentFormatDescription(from parser: ScrcpyVideoStreamParser) -> CMFormatDescription? {
+        guard parser.hasCompleteParameterSets, let sps = parser.sps, let pps = parser.pps else { return nil }
+
+        let isH264 = parser.currentCodecType == kCMVideoCodecType_H264
+        let currentSets = isH264 ? [sps, pps] : [parser.vps ?? Data(), sps, pps]
+        if currentSets == parameterSets, let formatDescription {
+            return formatDescription
+        }
+
+        parameterSets = currentSets
+        if isH264 {
+            formatDescription = VideoFormatDescriptionFactory.createH264FormatDescription(sps: sps, pps: pps)
+        } else if let vps = parser.vps {
+            formatDescription = VideoFormatDescriptionFactory.createH265FormatDescription(vps: vps, sps: sps, pps: pps)
+        } else {
+            formatDescription = nil
+        }
+        return formatDescription
+    }
+
+    private func makeSampleBuffer(
+        _ blockBuffer: CMBlockBuffer,
+        packet: ScrcpyVideoPacket,
+        formatDescription: CMFormatDescription
+    ) -> CMSampleBuffer? {
+        var timingInfo = CMSampleTimingInfo(
+            duration: .invalid,
+            presentationTimeStamp: packet.presentationTime,
+            decodeTimeStamp: .invalid
+        )
+        var sampleSize = CMBlockBufferGetDataLength(blockBuffer)
+        var sampleBuffer: CMSampleBuffer?
+        let status = CMSampleBufferCreateReady(
+            allocator: kCFAllocatorDefault,
+            dataBuffer: blockBuffer,
+            formatDescription: formatDescription,
+            sampleCount: 1,
+            sampleTimingEntryCount: 1,
+            sampleTimingArray: &timingInfo,
+            sampleSizeEntryCount: 1,
+            sampleSizeArray: &sampleSize,
+            sampleBufferOut: &sampleBuffer
+        )
+        guard status == noErr, let sampleBuffer else { return nil }
+
+        // 直通写入按 NotSync 生成同步样本表，未标记的样本都会被当作关键帧
+        if
+            !packet.isKeyFrame,
+            let attachments = CMSampleBufferGetSampleAttachmentsArray(sampleBuffer, createIfNecessary: true),
+            CFArrayGetCount(attachments) > 0
+        {
+            let dict = unsafeBitCast(CFArrayGetValueAtIndex(attachments, 0), to: CFMutableDictionary.self)
+            CFDictionarySetValue(
+                dict,
+                Unmanaged.passUnretained(kCMSampleAttachmentKey_NotSync).toOpaque(),
+                Unmanaged.passUnretained(kCFBooleanTrue).toOpaque()
+            )
+        }
+        return sampleBuffer
+    }
+
+    /// 写入一个样本（在 writeQueue 调用）
+    private func write(_ sampleBuffer: CMSampleBuffer, isKeyFrame: Bool) {
+        guard !isFinished else { return }
+
+        if isAwaitingKeyFrame, !isKeyFrame {
+            droppedFrameCount += 1
+            return
+        }
+
+        var presentationTime = CMTimeAdd(CMSampleBufferGetPresentationTimeStamp(sampleBuffer), timeOffset)
+        if lastPresentationTime.isValid, presentationTime <= lastPresentationTime {
+            // 码流重启后 PTS 回到起点：只能在关键帧处接续
+            guard isKeyFrame else {
+                droppedFrameCount += 1
+                return
+            }
+            let rawTime = CMSampleBufferGetPresentationTimeStamp(sampleBuffer)
+            timeOffset = CMTimeSubtract(CMTimeAdd(lastPresentationTime, Self.discontinuityGap), rawTime)
+            presentationTime = CMTimeAdd(rawTime, timeOffset)
+            AppLogger.capture.info("[MovieRecorder] 码流时间戳不连续，从关键帧接续")
+        }
+
+        guard let input = input ?? startWriting(sampleBuffer, at: presentationTime) else { return }
+
+        guard input.isReadyForMoreMediaData else {
+            droppedFrameCount += 1
+            isAwaitingKeyFrame = true
+            return
+        }
+
+        let sample = timeOffset == .zero ? sampleBuffer : retimed(sampleBuffer, to: presentationTime)
+        guard let sample, input.append(sample) else {
+            AppLogger.capture.error("[MovieRecorder] 写入失败: \(writer.error?.localizedDescription ?? "未知错误")")
+            droppedFrameCount += 1
+            isAwaitingKeyFrame = true
+            return
+        }
+
+        isAwaitingKeyFrame = false
+        lastPresentationTime = presentationTime
+        writtenFrameCount += 1
+    }
+
+    /// 以第一个关键帧的格式描述创建直通轨道并开始会话
+    private func startWriting(_ sampleBuffer: CMSampleBuffer, at presentationTime: CMTime) -> AVAssetWriterInput? {
+        guard writer.status == .unknown else { return nil }
+
+        let input = AVAssetWriterInput(
+            mediaType: .video,
+            outputSettings: nil,
+            sourceFormatHint: CMSampleBufferGetFormatDescription(sampleBuffer)
+        )
+        input.expectsMediaDataInRealTime = true
+        guard writer.canAdd(input) else {
+            AppLogger.capture.error("[MovieRecorder] 无法添加直通视频轨道")
+            return nil
+        }
+        writer.add(input)
+
+        guard writer.startWriting() else {
+            AppLogger.capture.error("[MovieRecorder] 无法开始写入: \(writer.error?.localizedDescription ?? "未知错误")")
+            return nil
+        }
+        writer.startSession(atSourceTime: presentationTime)
+        self.input = input
+        AppLogger.capture.info("[MovieRecorder] 开始直通录制: \(url.lastPathComponent)")
+        return input
+    }
+
+    /// 按时间偏移复制样本的时间信息（不复制数据）
+    private func retimed(_ sampleBuffer: CMSampleBuffer, to presentationTime: CMTime) -> CMSampleBuffer? {
+        var timingInfo = CMSampleTimingInfo(
+            duration: .invalid,
+            presentationTimeStamp: presentationTime,
+            decodeTimeStamp: .invalid
+        )
+        var retimed: CMSampleBuffer?
+        let status = CMSampleBufferCreateCopyWithNewTiming(
+            allocator: kCFAllocatorDefault,
+            sampleBuffer: sampleBuffer,
+            sampleTimingEntryCount: 1,
+            sampleTimingArray: &timingInfo,
+            sampleBufferOut: &retimed
+        )
+        return status == noErr ? retimed : nil
+    }
+}
@@ -6,8 +6,10 @@
 //
 //  Scrcpy OPUS 音频解码器
 //  使用 alta/swift-opus 库解码 OPUS 音频
+//  解码到预分配的 PCM 缓冲区，按 20ms 包的节奏解码时不分配内存
 //
 
+import Accelerate
 import AVFoundation
 import Foundation
 import Opus
@@ -16,8 +18,13 @@ import Opus
 
 /// Scrcpy OPUS 解码器
 /// 使用 alta/swift-opus 库解码 OPUS 音频数据
-/// 输出为 Float32 PCM 数据供 AudioPlayer 播放
+/// 输出为 Float32 interleaved PCM 样本供 AudioPlayer 播放
 final class ScrcpyOpusDecoder {
+    // MARK: - 常量
+
+    /// 单个 OPUS 包的最大帧数（120ms @ 48kHz）
+    private static let maxPacketFrames: AVAudioFrameCount = 5760
+
     // MARK: - 属性
 
     /// OPUS 解码器
@@ -32,8 +39,15 @@ final class ScrcpyOpusDecoder {
     /// 是否已收到 Config Packet（OPUS 不需要，但保留接口兼容性）
     private(set) var hasReceivedConfig = false
 
-    /// 解码后的 PCM 数据回调
-    var onDecodedAudio: ((Data, AVAudioFormat) -> Void)?
+    /// 解码后的 PCM 样本回调（interleaved）
+    /// 样本指向解码器内部的复用缓冲区，仅在回调期间有效
+    var onDecodedAudio: ((UnsafeBufferPointer<Float>, AVAudioFormat) -> Void)?
+
+    /// 复用的解码输出缓冲区
+    private var decodeBuffer: AVAudioPCMBuffer?
+
+    /// 复用的交织缓冲区（解码格式为 non-interleaved 时使用）
+    private var interleaveBuffer: UnsafeMutableBufferPointer<Float>?
 
     /// 采样率（OPUS 标准为 48000）
     private var sampleRate: Double = 48000
@@ -104,18 +118,18 @@ final class ScrcpyOpusDecoder {
             return
         }
 
-        do {
-            // 使用 alta/swift-opus 解码
-            let pcmBuffer = try decoder.decode(data)
+        guard let decodeBuffer else { return }
 
-            // 将 AVAudioPCMBuffer 转换为 Data
-            guard let pcmData = convertPCMBufferToData(pcmBuffer) else {
-                AppLogger.capture.error("[OpusDecoder] PCMBuffer 转换失败")
-                return
+        do {
+            // 使用 alta/swift-opus 解码到复用缓冲区
+            try data.withUnsafeBytes { rawBuffer in
+                try decoder.decode(rawBuffer.bindMemory(to: UInt8.self), to: decodeBuffer)
             }
 
-            // 回调解码后的 PCM 数据
-            onDecodedAudio?(pcmData, format)
+            // 回调解码后的 PCM 样本
+            withInterleavedSamples(of: decodeBuffer) { samples in
+                onDecodedAudio?(samples, format)
+            }
 
         } catch let error as Opus.Error {
             AppLogger.capture.error("[OpusDecoder] 解码失败: \(error)")
@@ -127,6 +141,7 @@ final class ScrcpyOpusDecoder {
     /// 清理资源
     func cleanup() {
         opusDecoder = nil
+        releaseBuffers()
         isInitialized = false
         hasReceivedConfig = false
     }
@@ -151,6 +166,7 @@ final class ScrcpyOpusDecoder {
             outputAudioFormat = pcmFormat
 
             opusDecoder = try Opus.Decoder(format: pcmFormat)
+            allocateBuffers(format: pcmFormat)
             isInitialized = true
             hasReceivedConfig = true // OPUS 不需要额外配置
 
@@ -165,38 +181,46 @@ final class ScrcpyOpusDecoder {
         }
     }
 
-    /// 将 AVAudioPCMBuffer 转换为 Data
-    /// - Parameter buffer: PCM 缓冲区
-    /// - Returns: PCM 数据
-    private func convertPCMBufferToData(_ buffer: AVAudioPCMBuffer) -> Data? {
-        let frameCount = Int(buffer.frameLength)
-        guard frameCount > 0 else { return nil }
+    /// 预分配解码与交织缓冲区
+    private func allocateBuffers(format: AVAudioFormat) {
+        releaseBuffers()
+        decodeBuffer = AVAudioPCMBuffer(pcmFormat: format, frameCapacity: Self.maxPacketFrames)
+        if !format.isInterleaved {
+            let capacity = Int(Self.maxPacketFrames) * Int(format.channelCount)
+            let buffer = UnsafeMutableBufferPointer<Float>.allocate(capacity: capacity)
+            buffer.initialize(repeating: 0)
+            interleaveBuffer = buffer
+        }
+    }
+
+    private func releaseBuffers() {
+        decodeBuffer = nil
+        interleaveBuffer?.deallocate()
+        interleaveBuffer = nil
+    }
 
+    /// 以 interleaved 样本访问解码结果
+    /// alta/swift-opus 返回的格式：
+    /// - 单声道：interleaved
+    /// - 双声道：interleaved（根据创建时的 format）
+    /// - Parameters:
+    ///   - buffer: 解码输出缓冲区
+    ///   - body: 接收样本的闭包（样本仅在闭包内有效）
+    private func withInterleavedSamples(of buffer: AVAudioPCMBuffer, _ body: (UnsafeBufferPointer<Float>) -> Void) {
+        let frameCount = Int(buffer.frameLength)
         let channelCount = Int(buffer.format.channelCount)
-        let bytesPerSample = 4 // Float32 = 4 bytes
+        guard frameCount > 0, let channelData = buffer.floatChannelData else { return }
 
-        // alta/swift-opus 返回的格式：
-        // - 单声道：interleaved
-        // - 双声道：interleaved（根据创建时的 format）
         if buffer.format.isInterleaved {
-            // interleaved 格式：直接复制
-            guard let channelData = buffer.floatChannelData?[0] else { return nil }
-            let byteCount = frameCount * channelCount * bytesPerSample
-            return Data(bytes: channelData, count: byteCount)
+            // interleaved 格式：直接使用
+            body(UnsafeBufferPointer(start: channelData[0], count: frameCount * channelCount))
         } else {
-            // non-interleaved 格式：需要交织
-            var interleavedData = Data(capacity: frameCount * channelCount * bytesPerSample)
-
-            for frame in 0..<frameCount {
-                for channel in 0..<channelCount {
-                    if let channelData = buffer.floatChannelData?[channel] {
-                        var sample = channelData[frame]
-                        interleavedData.append(Data(bytes: &sample, count: bytesPerSample))
-                    }
-                }
+            // non-interleaved 格式：交织到复用缓冲区
+            guard let interleaveBuffer, let destination = interleaveBuffer.baseAddress else { return }
+            for channel in 0..<channelCount {
+                vDSP_mmov(channelData[channel], destination.advanced(by: channel), 1, vDSP_Length(frameCount), 1, vDSP_Length(channelCount))
             }
-
-            return interleavedData
+            body(UnsafeBufferPointer(start: destination, count: frameCount * channelCount))
         }
     }
 }
@@ -0,0 +1,382 @@
+//
+//  ScrcpyReplayBenchmark.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  Scrcpy 回放基准测试
+//  把录制的 socket 码流重放进与真机相同的管道：
+//  ScrcpyVideoStreamParser → VideoToolboxDecoder → FramePipeline → MetalRenderer（离屏 CAMetalLayer）
+//  按录制时的节奏或尽可能快地喂入，输出吞吐、各阶段延迟分位数与丢帧数，便于在 CI 和基准机上对比改动
+//
+//  用法:
+//  ScreenPresenter --replay-benchmark <录制文件> [--realtime] [--output <报告.json>]
+//  录制文件通过 -ScrcpyStreamRecordingPath <路径> 启动参数在真机投屏时生成
+//
+
+import CoreMedia
+import CoreVideo
+import Foundation
+import Metal
+import os
+import QuartzCore
+
+// MARK: - 基准测试报告
+
+/// 回放基准测试报告（JSON 输出）
+struct ScrcpyReplayBenchmarkReport: Encodable {
+    /// 单个阶段的延迟统计（毫秒）
+    struct Stage: Encodable {
+        let name: String
+        let count: Int
+        let average: Double
+        let p50: Double
+        let p95: Double
+        let p99: Double
+        let max: Double
+
+        init(name: String, histogram: FrameLatencyHistogram) {
+            self.name = name
+            count = histogram.count
+            average = histogram.average
+            p50 = histogram.percentile(0.5)
+            p95 = histogram.percentile(0.95)
+            p99 = histogram.percentile(0.99)
+            max = histogram.maximum
+        }
+    }
+
+    let recording: String
+    let mode: String
+    let recordedDuration: Double
+    let wallTime: Double
+    let byteCount: Int
+    let packetCount: Int
+    let decodedFrameCount: Int
+    let presentedFrameCount: Int
+    /// 未呈现就被新帧取代的帧数（延迟追踪器）
+    let droppedFrameCount: Int
+    /// 帧缓冲中未被渲染消费就被覆盖的帧数
+    let skippedFrameCount: Int
+    /// 解码器因积压丢弃的帧数
+    let decoderDroppedFrameCount: Int
+    let framesPerSecond: Double
+    let megabytesPerSecond: Double
+    let stages: [Stage]
+    let total: Stage
+
+    /// 多行摘要（用于终端输出）
+    var summary: String {
+        var lines = [
+            String(
+                format: "回放 %@（%@）: 码流 %.2fs，用时 %.2fs，%d 包，解码 %d 帧，呈现 %d 帧，%.1f fps，%.1f MB/s",
+                recording,
+                mode,
+                recordedDuration,
+                wallTime,
+                packetCount,
+                decodedFrameCount,
+                presentedFrameCount,
+                framesPerSecond,
+                megabytesPerSecond
+            ),
+            String(
+                format: "丢帧: 追踪 %d，帧缓冲跳过 %d，解码器丢弃 %d",
+                droppedFrameCount,
+                skippedFrameCount,
+                decoderDroppedFrameCount
+            ),
+        ]
+        for stage in stages + [total] {
+            lines.append(String(
+                format: "  %@ p50 %7.2fms  p95 %7.2fms  p99 %7.2fms  max %7.2fms",
+                stage.name.padding(toLength: 14, withPad: " ", startingAt: 0),
+                stage.p50,
+                stage.p95,
+                stage.p99,
+                stage.max
+            ))
+        }
+        return lines.joined(separator: "\n")
+    }
+}
+
+// MARK: - 回放基准测试
+
+/// Scrcpy 回放基准测试
+/// 喂入在专用串行队列进行（对应 socket 接收队列），解码输出经 FramePipeline 以主线程事件模式交给渲染，
+/// 离屏图层没有上屏时间，呈现阶段以 GPU 执行完成的时间记录
+final class ScrcpyReplayBenchmark {
+    // MARK: - 选项
+
+    /// 命令行选项
+    struct Options {
+        /// 录制文件
+        var recordingURL: URL
+        /// 是否按录制时的到达时间喂入（否则尽可能快）
+        var realtime = false
+        /// JSON 报告输出路径
+        var outputURL: URL?
+
+        /// 从命令行参数解析，未指定 --replay-benchmark 时返回 nil
+        init?(arguments: [String]) {
+            guard
+                let index = arguments.firstIndex(of: "--replay-benchmark"),
+                index + 1 < arguments.count
+            else {
+                return nil
+            }
+            recordingURL = URL(fileURLWithPath: (arguments[index + 1] as NSString).expandingTildeInPath)
+            realtime = arguments.contains("--realtime")
+            if let outputIndex = arguments.firstIndex(of: "--output"), outputIndex + 1 < arguments.count {
+                outputURL = URL(fileURLWithPath: (arguments[outputIndex + 1] as NSString).expandingTildeInPath)
+            }
+        }
+    }
+
+    // MARK: - 常量
+
+    /// 尽可能快模式下允许的最大待解码帧数
+    /// 低于解码器的丢帧阈值，喂入速度由解码能力决定而不是触发丢帧
+    private static let maxPendingDecodes = 4
+
+    /// 离屏图层的默认尺寸（首帧解码前）
+    private static let defaultFrameSize = CGSize(width: 1080, height: 1920)
+
+    // MARK: - 组件
+
+    private let recording: ScrcpyStreamRecording
+    private let options: Options
+    private let parser: ScrcpyVideoStreamParser
+    private let decoder: VideoToolboxDecoder
+    private let framePipeline = FramePipeline(renderMode: .event)
+    private let latencyTracer = FrameLatencyTracer()
+    private let renderer: MetalRenderer
+    private let metalLayer = CAMetalLayer()
+    private let feedQueue = DispatchQueue(label: "com.screenPresenter.replayBenchmark.feed", qos: .userInteractive)
+
+    // MARK: - 状态
+
+    /// 尚未解析出完整视频包的首个数据块的到达时间（仅在喂入队列访问）
+    private var pendingReceiveTime: CFTimeInterval?
+
+    /// 统计（仅在喂入队列访问）
+    private var packetCount = 0
+
+    /// 码流中途 SPS 变化时解码器与帧管道会重置统计，重置前的计数累计在这里（仅在喂入队列访问）
+    private var previousDecoderDroppedCount = 0
+    private var previousSkippedCount = 0
+
+    /// 统计（解码回调线程写入）
+    private let decodedFrameCount = OSAllocatedUnfairLock(initialState: 0)
+
+    /// 当前帧尺寸（仅在主线程访问）
+    private var frameSize: CGSize = .zero
+
+    /// 已提交、GPU 尚未完成的渲染
+    private let renderGroup = DispatchGroup()
+
+    // MARK: - 初始化
+
+    init?(recording: ScrcpyStreamRecording, options: Options) {
+        guard let renderer = MetalRenderer() else { return nil }
+        self.recording = recording
+        self.options = options
+        self.renderer = renderer
+        parser = ScrcpyVideoStreamParser(codecType: recording.codecType, useRawStream: recording.useRawStream)
+        decoder = VideoToolboxDecoder(codecType: recording.codecType)
+
+        metalLayer.device = MTLCreateSystemDefaultDevice()
+        metalLayer.pixelFormat = .bgra8Unorm
+        metalLayer.framebufferOnly = true
+        metalLayer.contentsScale = 1
+        metalLayer.drawableSize = Self.defaultFrameSize
+    }
+
+    // MARK: - 入口
+
+    /// 运行基准测试并退出进程（在 NSApplication 启动前由 main.swift 调用）
+    /// - Parameter options: 命令行选项
+    static func runAndExit(_ options: Options) -> Never {
+        let recording: ScrcpyStreamRecording
+        do {
+            recording = try ScrcpyStreamRecording(contentsOf: options.recordingURL)
+        } catch {
+            fputs("读取录制文件失败: \(error.localizedDescription)\n", stderr)
+            exit(1)
+        }
+
+        guard let benchmark = ScrcpyReplayBenchmark(recording: recording, options: options) else {
+            fputs("无法创建 Metal 渲染器\n", stderr)
+            exit(1)
+        }
+
+        benchmark.run { report in
+            print(report.summary)
+            if let outputURL = options.outputURL {
+                do {
+                    let encoder = JSONEncoder()
+                    encoder.outputFormatting = [.prettyPrinted, .sortedKeys]
+                    try encoder.encode(report).write(to: outputURL)
+                } catch {
+                    fputs("写入报告失败: \(error.localizedDescription)\n", stderr)
+                    exit(1)
+                }
+            }
+            exit(report.presentedFrameCount > 0 ? 0 : 1)
+        }
+
+        // 运行主 run loop 而不是 dispatchMain：离屏图层的 drawable 依赖 Core Animation 在 run loop 中提交事务后回收
+        while true {
+            RunLoop.main.run(mode: .default, before: .distantFuture)
+        }
+    }
+
+    // MARK: - 运行
+
+    /// 运行基准测试（在主线程调用，主线程须运行 run loop）
+    /// - Parameter completion: 所有帧呈现后在主线程回调
+    func run(completion: @escaping (ScrcpyReplayBenchmarkReport) -> Void) {
+        parser.onSPSChanged = { [weak self] _ in
+            self?.handleSPSChanged()
+        }
+        decoder.latencyTracer = latencyTracer
+        framePipeline.latencyTracer = latencyTracer
+        // 回放的每一帧都要计入呈现延迟，不跳过静止帧
+        framePipeline.skipsUnchangedFrames = false
+        decoder.onDecodedFrame = { [weak self] pixelBuffer, _ in
+            guard let self else { return }
+            decodedFrameCount.withLock { $0 += 1 }
+            framePipeline.pushFrame(pixelBuffer)
+        }
+        framePipeline.setFrameHandler { [weak self] pixelBuffer in
+            self?.render(pixelBuffer)
+        }
+        framePipeline.start(size: Self.defaultFrameSize)
+
+        let startTime = CACurrentMediaTime()
+        feedQueue.async { [self] in
+            for chunk in recording.chunks {
+                if options.realtime {
+                    let delay = startTime + chunk.offset - CACurrentMediaTime()
+                    if delay > 0 {
+                        Thread.sleep(forTimeInterval: delay)
+                    }
+                } else {
+                    while decoder.pendingDecodeCount >= Self.maxPendingDecodes {
+                        usleep(100)
+                    }
+                }
+                feed(chunk.data)
+            }
+            decoder.flush()
+
+            // 解码输出已全部推入帧管道，其投递事件排在这之前
+            framePipeline.notifyWhenDelivered(on: .main) { [self] in
+                renderGroup.notify(queue: .main) { [self] in
+                    let report = makeReport(wallTime: CACurrentMediaTime() - startTime)
+                    framePipeline.stop()
+                    completion(report)
+                }
+            }
+        }
+    }
+
+    // MARK: - 管道
+
+    /// 喂入一个数据块（与 ScrcpyDeviceSource.handleReceivedData 相同的处理）
+    private func feed(_ data: Data) {
+        let receiveTime = pendingReceiveTime ?? CACurrentMediaTime()
+        let packets = parser.appendPackets(data)
+        pendingReceiveTime = packets.isEmpty ? receiveTime : nil
+
+        for packet in packets {
+            if !packet.isConfigPacket, let frameID = FrameLatencyTracer.frameID(for: packet.presentationTime) {
+                latencyTracer.begin(frameID: frameID, receivedAt: receiveTime)
+                packetCount += 1
+            }
+
+            initializeDecoderIfNeeded()
+
+            if decoder.isReady {
+                decoder.decode(packet: packet)
+            }
+        }
+    }
+
+    private func initializeDecoderIfNeeded() {
+        guard !decoder.isReady, parser.hasCompleteParameterSets else { return }
+
+        do {
+            if parser.currentCodecType == kCMVideoCodecType_H264 {
+                guard let sps = parser.sps, let pps = parser.pps else { return }
+                try decoder.initializeH264(sps: sps, pps: pps)
+            } else {
+                guard let vps = parser.vps, let sps = parser.sps, let pps = parser.pps else { return }
+                try decoder.initializeH265(vps: vps, sps: sps, pps: pps)
+            }
+            decoder.activateCallbacks()
+        } catch {
+            AppLogger.performance.error("[ReplayBenchmark] 解码器初始化失败: \(error.localizedDescription)")
+        }
+    }
+
+    private func handleSPSChanged() {
+        previousDecoderDroppedCount += decoder.droppedFrameCount
+        previousSkippedCount += framePipeline.getStats().skipped
+        decoder.reset()
+        framePipeline.stop()
+        framePipeline.start(size: Self.defaultFrameSize)
+    }
+
+    /// 渲染一帧到离屏图层（帧管道投递队列）
+    private func render(_ pixelBuffer: CVPixelBuffer) {
+        let size = CGSize(width: CVPixelBufferGetWidth(pixelBuffer), height: CVPixelBufferGetHeight(pixelBuffer))
+        if size != frameSize {
+            frameSize = size
+            metalLayer.drawableSize = size
+            renderer.setLayout(CompositorLayerLayout(screenFrame: CGRect(origin: .zero, size: size)), forLayer: 0)
+        }
+        renderer.updateTexture(forLayer: 0, from: pixelBuffer)
+
+        let frameID = FrameLatencyTracer.frameID(of: pixelBuffer)
+        renderGroup.enter()
+        let rendered = renderer.render(to: metalLayer) { [latencyTracer, renderGroup] in
+            if let frameID {
+                latencyTracer.markPresented(frameID: frameID, at: CACurrentMediaTime())
+            }
+            renderGroup.leave()
+        }
+        if !rendered {
+            renderGroup.leave()
+        }
+    }
+
+    // MARK: - 报告
+
+    private func makeReport(wallTime: TimeInterval) -> ScrcpyReplayBenchmarkReport {
+        let latency = latencyTracer.snapshot()
+        let pipelineStats = framePipeline.getStats()
+        let byteCount = recording.byteCount
+
+        return ScrcpyReplayBenchmarkReport(
+            recording: options.recordingURL.lastPathComponent,
+            mode: options.realtime ? "realtime" : "fast",
+            recordedDuration: recording.duration,
+            wallTime: wallTime,
+            byteCount: byteCount,
+            packetCount: packetCount,
+            decodedFrameCount: decodedFrameCount.withLock { $0 },
+            presentedFrameCount: latency.presentedCount,
+            droppedFrameCount: latency.droppedCount,
+            skippedFrameCount: previousSkippedCount + pipelineStats.skipped,
+            decoderDroppedFrameCount: previousDecoderDroppedCount + decoder.droppedFrameCount,
+            framesPerSecond: wallTime > 0 ? Double(latency.presentedCount) / wallTime : 0,
+            megabytesPerSecond: wallTime > 0 ? Double(byteCount) / wallTime / 1_000_000 : 0,
+            stages: latency.stages.map {
+                ScrcpyReplayBenchmarkReport.Stage(name: String(describing: $0.stage), histogram: $0.histogram)
+            },
+            total: ScrcpyReplayBenchmarkReport.Stage(name: "total", histogram: latency.total)
+        )
+    }
+}
@@ -161,6 +161,12 @@ final class ScrcpyServerLauncher {
         AppLogger.process.info("[ScrcpyLauncher] 服务器已停止")
     }
 
+    /// 视频流首个帧头之前的字节数，与 buildServerArguments 中的参数对应：
+    /// forward 模式的 dummy byte（1）+ 设备名（64，send_device_meta）+ 编解码元数据（12，send_codec_meta）
+    var videoPreambleLength: Int {
+        (connectionMode == .forward ? 1 : 0) + 64 + 12
+    }
+
     /// 获取 Unix 域套接字名称
     /// scrcpy 使用十六进制格式的 scid 作为 socket 名称
     var socketName: String {
@@ -170,7 +176,7 @@ final class ScrcpyServerLauncher {
 
     // MARK: - 私有方法
 
-    /// 推送 scrcpy-server 到设备
+    /// 推送 scrcpy-server 到设备（设备上已是同一文件时跳过）
     @MainActor
     private func pushServer() async throws {
         AppLogger.process.info("[ScrcpyLauncher] 推送 scrcpy-server 到设备...")
@@ -179,9 +185,11 @@ final class ScrcpyServerLauncher {
             throw ScrcpyLauncherError.serverNotFound(path: serverLocalPath)
         }
 
-        try await adbService.push(local: serverLocalPath, remote: Self.serverDevicePath)
-
-        AppLogger.process.info("[ScrcpyLauncher] scrcpy-server 已推送到设备")
+        if try await adbService.pushIfNeeded(local: serverLocalPath, remote: Self.serverDevicePath) {
+            AppLogger.process.info("[ScrcpyLauncher] scrcpy-server 已推送到设备")
+        } else {
+            AppLogger.process.info("[ScrcpyLauncher] 设备上的 scrcpy-server 已是最新，跳过推送")
+        }
     }
 
     /// 设置端口转发
@@ -242,6 +250,8 @@ final class ScrcpyServerLauncher {
             if !process.isRunning {
                 let exitCode = process.terminationStatus
                 AppLogger.process.error("[ScrcpyLauncher] ❌ scrcpy-server 进程已退出，退出码: \(exitCode)")
+                // 设备上的 jar 可能已被删除或损坏，下次启动时重新检查
+                adbService.invalidatePushCache(remote: Self.serverDevicePath)
                 throw ScrcpyLauncherError.serverStartFailedWithExitCode(exitCode)
             }
 
@@ -10,6 +10,8 @@
 
 import Foundation
 import Network
+import os
+import QuartzCore
 
 // MARK: - Socket 连接状态
 
@@ -60,6 +62,9 @@ final class ScrcpySocketAcceptor {
     /// 已接收的连接数
     private var acceptedConnectionCount = 0
 
+    /// 视频流帧边界跟踪（仅在连接队列访问），为 nil 时每收到数据即回调
+    private var framing: ScrcpyReceiveFraming?
+
     /// 状态变更回调
     var onStateChange: ((ScrcpySocketState) -> Void)?
 
@@ -76,10 +81,18 @@ final class ScrcpySocketAcceptor {
     ///   - port: 监听/连接端口
     ///   - connectionMode: 连接模式
     ///   - audioEnabled: 是否启用音频
-    init(port: Int, connectionMode: ScrcpyConnectionMode, audioEnabled: Bool = false) {
+    ///   - videoPreambleLength: 视频流首个帧头之前的字节数（dummy byte、设备名、编解码元数据）；
+    ///     为 nil 时（原始流模式或未知）不按帧边界合并接收
+    init(
+        port: Int,
+        connectionMode: ScrcpyConnectionMode,
+        audioEnabled: Bool = false,
+        videoPreambleLength: Int? = nil
+    ) {
         self.port = port
         self.connectionMode = connectionMode
         self.audioEnabled = audioEnabled
+        framing = videoPreambleLength.map { ScrcpyReceiveFraming(preambleLength: $0) }
 
         AppLogger.connection.info("[SocketAcceptor] 初始化，端口: \(port), 模式: \(connectionMode), 音频: \(audioEnabled)")
     }
@@ -419,45 +432,71 @@ final class ScrcpySocketAcceptor {
             }
     }
 
-    /// 接收到的数据包计数（用于调试）
-    private var receivedPacketCount = 0
+    // MARK: - 接收统计
 
-    // MARK: - 调试统计
+    /// 视频接收统计
+    struct ReceiveStatistics {
+        /// 总接收字节数
+        var totalBytes = 0
 
-    /// 总接收字节数
-    private var totalBytesReceived: Int = 0
+        /// 接收回调次数
+        var callbackCount = 0
 
-    /// 统计周期内接收字节数
-    private var bytesInPeriod: Int = 0
+        /// 单次回调的最小字节数
+        var minChunkSize = Int.max
 
-    /// 统计周期内接收包数
-    private var packetsInPeriod: Int = 0
+        /// 单次回调的最大字节数
+        var maxChunkSize = 0
 
-    /// 上次统计时间
-    private var lastStatsTime = CFAbsoluteTimeGetCurrent()
+        /// 最大接收间隔（ms）
+        var maxIntervalMs: Double = 0
 
-    /// 最小包大小
-    private var minPacketSize: Int = .max
+        /// 平均单次回调字节数
+        var averageChunkSize: Int {
+            callbackCount > 0 ? totalBytes / callbackCount : 0
+        }
+    }
 
-    /// 最大包大小
-    private var maxPacketSize: Int = 0
+    /// 视频接收统计（每次回调只加锁更新一次）
+    private let statistics = OSAllocatedUnfairLock(initialState: ReceiveStatistics())
 
-    /// 接收间隔统计
-    private var lastReceiveTime = CFAbsoluteTimeGetCurrent()
+    /// 上次接收回调的时间（仅在连接队列访问）
+    private var lastReceiveTime: CFTimeInterval?
 
-    /// 最大接收间隔（ms）
-    private var maxReceiveInterval: Double = 0
+    /// 当前视频接收统计快照
+    var receiveStatistics: ReceiveStatistics {
+        statistics.withLock { $0 }
+    }
+
+    /// 记录一次接收回调
+    private func recordReceive(byteCount: Int) {
+        let now = CACurrentMediaTime()
+        let intervalMs = lastReceiveTime.map { (now - $0) * 1000 } ?? 0
+        lastReceiveTime = now
+
+        statistics.withLock { statistics in
+            statistics.totalBytes += byteCount
+            statistics.callbackCount += 1
+            statistics.minChunkSize = min(statistics.minChunkSize, byteCount)
+            statistics.maxChunkSize = max(statistics.maxChunkSize, byteCount)
+            statistics.maxIntervalMs = max(statistics.maxIntervalMs, intervalMs)
+        }
+    }
 
-    /// 接收间隔累计（用于计算平均值）
-    private var totalReceiveIntervals: Double = 0
+    // MARK: - 视频接收
 
-    /// 接收间隔计数
-    private var receiveIntervalCount: Int = 0
+    /// 单次接收的最大字节数，高码率时一次回调可取走多帧数据
+    private static let maximumReceiveLength = 1 << 20
 
     /// 递归接收数据
+    /// 已知帧边界时，要求至少收到当前帧的剩余字节再回调，把一帧的多个 TCP 段合并为一次回调
     private func receiveData(on connection: NWConnection) {
+        let minimumLength = framing?.bytesUntilBoundary(limit: Self.maximumReceiveLength) ?? 1
         connection
-            .receive(minimumIncompleteLength: 1, maximumLength: 65536) { [weak self] content, _, isComplete, error in
+            .receive(
+                minimumIncompleteLength: minimumLength,
+                maximumLength: Self.maximumReceiveLength
+            ) { [weak self] content, _, isComplete, error in
                 guard let self else { return }
 
                 if let error {
@@ -467,42 +506,11 @@ final class ScrcpySocketAcceptor {
                 }
 
                 if let data = content, !data.isEmpty {
-                    // 调试统计
-                    let now = CFAbsoluteTimeGetCurrent()
-                    let interval = (now - lastReceiveTime) * 1000 // 转换为毫秒
-                    lastReceiveTime = now
-
-                    receivedPacketCount += 1
-
-                    totalBytesReceived += data.count
-                    bytesInPeriod += data.count
-                    packetsInPeriod += 1
-
-                    // 更新包大小统计
-                    minPacketSize = min(minPacketSize, data.count)
-                    maxPacketSize = max(maxPacketSize, data.count)
-
-                    // 更新接收间隔统计
-                    if receivedPacketCount > 1 {
-                        maxReceiveInterval = max(maxReceiveInterval, interval)
-                        totalReceiveIntervals += interval
-                        receiveIntervalCount += 1
-                    }
-
-                    // 每 5 秒重置统计（保留内部统计逻辑，移除日志输出）
-                    let elapsed = now - lastStatsTime
-                    if elapsed >= 5.0 {
-                        // 重置周期统计
-                        bytesInPeriod = 0
-                        packetsInPeriod = 0
-                        lastStatsTime = now
-                        minPacketSize = Int.max
-                        maxPacketSize = 0
-                        maxReceiveInterval = 0
-                        totalReceiveIntervals = 0
-                        receiveIntervalCount = 0
+                    recordReceive(byteCount: data.count)
+                    if framing?.consume(data) == false {
+                        AppLogger.connection.warning("[SocketAcceptor] 帧头长度异常，停止按帧边界合并接收")
+                        framing = nil
                     }
-
                     onDataReceived?(data)
                 }
 
@@ -526,6 +534,75 @@ final class ScrcpySocketAcceptor {
     }
 }
 
+// MARK: - 帧边界跟踪
+
+/// 跟踪 scrcpy 视频流的帧边界，用于决定下一次接收至少需要多少字节
+/// 流格式: 前导字节，之后每帧为 12 字节帧头（8 字节 PTS 与标志 + 4 字节大端长度）+ 负载
+private struct ScrcpyReceiveFraming {
+    /// 帧头长度
+    private static let headerLength = 12
+
+    /// 合理的最大帧长度，超出说明跟踪已与流错位
+    private static let maximumPacketLength = 64 << 20
+
+    private enum Position {
+        /// 前导字节（剩余字节数）
+        case preamble(Int)
+        /// 帧头（已收到的字节）
+        case header([UInt8])
+        /// 负载（剩余字节数）
+        case payload(Int)
+    }
+
+    private var position: Position
+
+    init(preambleLength: Int) {
+        position = preambleLength > 0 ? .preamble(preambleLength) : .header([])
+    }
+
+    /// 到达下一个边界（前导结束、帧头完整或帧结束）还需要的字节数
+    func bytesUntilBoundary(limit: Int) -> Int {
+        let remaining = switch position {
+        case let .preamble(remaining): remaining
+        case let .header(bytes): Self.headerLength - bytes.count
+        case let .payload(remaining): remaining
+        }
+        return max(1, min(remaining, limit))
+    }
+
+    /// 消费接收到的数据
+    /// - Returns: 帧头长度异常时返回 false，此后不应再使用
+    mutating func consume(_ data: Data) -> Bool {
+        var index = data.startIndex
+        while index < data.endIndex {
+            switch position {
+            case let .preamble(remaining):
+                let count = min(remaining, data.endIndex - index)
+                index += count
+                position = remaining - count > 0 ? .preamble(remaining - count) : .header([])
+
+            case var .header(bytes):
+                let count = min(Self.headerLength - bytes.count, data.endIndex - index)
+                bytes.append(contentsOf: data[index..<(index + count)])
+                index += count
+                guard bytes.count == Self.headerLength else {
+                    position = .header(bytes)
+                    continue
+                }
+                let length = bytes[8..<12].reduce(0) { $0 << 8 | Int($1) }
+                guard length <= Self.maximumPacketLength else { return false }
+                position = length > 0 ? .payload(length) : .header([])
+
+            case let .payload(remaining):
+                let count = min(remaining, data.endIndex - index)
+                index += count
+                position = remaining - count > 0 ? .payload(remaining - count) : .header([])
+            }
+        }
+        return true
+    }
+}
+
 // MARK: - Scrcpy Socket 错误
 
 /// Scrcpy Socket 错误
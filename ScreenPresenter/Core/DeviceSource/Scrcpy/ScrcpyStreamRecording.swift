@@ -0,0 +1,197 @@
+//
+//  ScrcpyStreamRecording.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  Scrcpy 码流录制
+//  按到达时间原样记录视频 socket 收到的数据块，供回放基准测试在没有真机的情况下重放完整管道
+//
+//  文件格式（小端）:
+//  文件头: 魔数 "SPSR"、版本（UInt16）、标志（UInt16，bit0 为原始流模式）、编解码 FourCC（UInt32）
+//  数据块: 相对录制开始的时间偏移（UInt64，纳秒）、长度（UInt32）、socket 收到的原始字节
+//
+
+import CoreMedia
+import Foundation
+
+// MARK: - 录制错误
+
+enum ScrcpyStreamRecordingError: LocalizedError {
+    case invalidHeader
+    case unsupportedVersion(UInt16)
+    case truncatedChunk(offset: Int)
+
+    var errorDescription: String? {
+        switch self {
+        case .invalidHeader:
+            "不是 scrcpy 码流录制文件"
+        case let .unsupportedVersion(version):
+            "不支持的录制文件版本: \(version)"
+        case let .truncatedChunk(offset):
+            "录制文件在偏移 \(offset) 处被截断"
+        }
+    }
+}
+
+// MARK: - 文件格式
+
+private enum ScrcpyStreamRecordingFormat {
+    static let magic = Data("SPSR".utf8)
+    static let version: UInt16 = 1
+    static let headerSize = 12
+    static let chunkHeaderSize = 12
+    static let rawStreamFlag: UInt16 = 1 << 0
+}
+
+// MARK: - 码流录制器
+
+/// 码流录制器
+/// 在 socket 接收队列调用 append，写文件在独立的串行队列进行，不阻塞接收
+final class ScrcpyStreamRecorder {
+    // MARK: - 属性
+
+    private let fileHandle: FileHandle
+    private let writeQueue = DispatchQueue(label: "com.screenPresenter.scrcpy.streamRecorder", qos: .utility)
+    private let startTime = DispatchTime.now().uptimeNanoseconds
+
+    // MARK: - 初始化
+
+    /// 创建录制文件（已存在时覆盖）
+    /// - Parameters:
+    ///   - url: 录制文件路径
+    ///   - codecType: 编解码类型（协议元数据可能在码流中更新）
+    ///   - useRawStream: 是否为原始流模式（无协议头）
+    init(url: URL, codecType: CMVideoCodecType, useRawStream: Bool) throws {
+        try FileManager.default.createDirectory(
+            at: url.deletingLastPathComponent(),
+            withIntermediateDirectories: true
+        )
+        FileManager.default.createFile(atPath: url.path, contents: nil)
+        fileHandle = try FileHandle(forWritingTo: url)
+
+        var header = ScrcpyStreamRecordingFormat.magic
+        header.appendLittleEndian(ScrcpyStreamRecordingFormat.version)
+        header.appendLittleEndian(useRawStream ? ScrcpyStreamRecordingFormat.rawStreamFlag : 0)
+        header.appendLittleEndian(codecType)
+        try fileHandle.write(contentsOf: header)
+    }
+
+    deinit {
+        try? fileHandle.close()
+    }
+
+    // MARK: - 录制
+
+    /// 追加一个数据块
+    /// - Parameter data: socket 收到的原始字节
+    func append(_ data: Data) {
+        let offset = DispatchTime.now().uptimeNanoseconds - startTime
+        writeQueue.async { [fileHandle] in
+            var chunk = Data(capacity: ScrcpyStreamRecordingFormat.chunkHeaderSize + data.count)
+            chunk.appendLittleEndian(UInt64(offset))
+            chunk.appendLittleEndian(UInt32(data.count))
+            chunk.append(data)
+            do {
+                try fileHandle.write(contentsOf: chunk)
+            } catch {
+                AppLogger.capture.error("[StreamRecorder] 写入失败: \(error.localizedDescription)")
+            }
+        }
+    }
+
+    /// 写完已排队的数据块并关闭文件
+    func close() {
+        writeQueue.sync {
+            try? fileHandle.synchronize()
+            try? fileHandle.close()
+        }
+    }
+}
+
+// MARK: - 码流录制文件
+
+/// 码流录制文件（整体读入内存，回放时不涉及磁盘 I/O）
+struct ScrcpyStreamRecording {
+    /// 数据块
+    struct Chunk {
+        /// 相对录制开始的到达时间（秒）
+        let offset: TimeInterval
+        /// socket 收到的原始字节
+        let data: Data
+    }
+
+    /// 编解码类型
+    let codecType: CMVideoCodecType
+
+    /// 是否为原始流模式
+    let useRawStream: Bool
+
+    /// 按到达顺序排列的数据块
+    let chunks: [Chunk]
+
+    /// 录制时长（秒）
+    var duration: TimeInterval {
+        chunks.last?.offset ?? 0
+    }
+
+    /// 码流总字节数
+    var byteCount: Int {
+        chunks.reduce(0) { $0 + $1.data.count }
+    }
+
+    /// 读取录制文件
+    /// - Parameter url: 录制文件路径
+    init(contentsOf url: URL) throws {
+        let data = try Data(contentsOf: url, options: .mappedIfSafe)
+        guard
+            data.count >= ScrcpyStreamRecordingFormat.headerSize,
+            data.prefix(4) == ScrcpyStreamRecordingFormat.magic
+        else {
+            throw ScrcpyStreamRecordingError.invalidHeader
+        }
+
+        let version: UInt16 = data.readLittleEndian(at: 4)
+        guard version == ScrcpyStreamRecordingFormat.version else {
+            throw ScrcpyStreamRecordingError.unsupportedVersion(version)
+        }
+        let flags: UInt16 = data.readLittleEndian(at: 6)
+        useRawStream = flags & ScrcpyStreamRecordingFormat.rawStreamFlag != 0
+        codecType = data.readLittleEndian(at: 8)
+
+        var chunks: [Chunk] = []
+        var position = ScrcpyStreamRecordingFormat.headerSize
+        while position < data.count {
+            guard position + ScrcpyStreamRecordingFormat.chunkHeaderSize <= data.count else {
+                throw ScrcpyStreamRecordingError.truncatedChunk(offset: position)
+            }
+            let offset: UInt64 = data.readLittleEndian(at: position)
+            let length = Int(data.readLittleEndian(at: position + 8) as UInt32)
+            let start = position + ScrcpyStreamRecordingFormat.chunkHeaderSize
+            guard start + length <= data.count else {
+                throw ScrcpyStreamRecordingError.truncatedChunk(offset: position)
+            }
+            // 复制出独立的数据块，与解析器在 socket 路径上收到的 Data 一致
+            let chunkData = data.subdata(in: (data.startIndex + start)..<(data.startIndex + start + length))
+            chunks.append(Chunk(offset: TimeInterval(offset) / TimeInterval(NSEC_PER_SEC), data: chunkData))
+            position = start + length
+        }
+        self.chunks = chunks
+    }
+}
+
+// MARK: - 小端读写
+
+private extension Data {
+    mutating func appendLittleEndian<T: FixedWidthInteger>(_ value: T) {
+        withUnsafeBytes(of: value.littleEndian) { append(contentsOf: $0) }
+    }
+
+    func readLittleEndian<T: FixedWidthInteger>(at offset: Int) -> T {
+        var value: T = 0
+        withUnsafeMutableBytes(of: &value) { destination in
+            _ = copyBytes(to: destination, from: (startIndex + offset)..<(startIndex + offset + MemoryLayout<T>.size))
+        }
+        return T(littleEndian: value)
+    }
+}
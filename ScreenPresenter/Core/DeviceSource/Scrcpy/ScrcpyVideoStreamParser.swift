@@ -9,6 +9,7 @@
 //
 
 import CoreMedia
+import FBDeviceControlKit
 import Foundation
 import VideoToolbox
 
@@ -326,6 +327,24 @@ struct ParsedNALUnit {
     }
 }
 
+// MARK: - 视频包
+
+/// 可直接送入 VideoToolbox 的 scrcpy 视频包
+/// 媒体包的切片已按 AVCC 格式写入 block buffer，配置包只标记参数集到达的位置
+struct ScrcpyVideoPacket {
+    /// AVCC 格式的切片数据（配置包为 nil）
+    let blockBuffer: CMBlockBuffer?
+
+    /// 显示时间戳
+    let presentationTime: CMTime
+
+    /// 是否为关键帧（协议标志或 NAL 类型判断）
+    let isKeyFrame: Bool
+
+    /// 是否为配置包（携带参数集）
+    let isConfigPacket: Bool
+}
+
 // MARK: - Scrcpy Packet Merger
 
 /// Scrcpy Packet Merger
@@ -390,24 +409,6 @@ final class ScrcpyPacketMerger {
     }
 }
 
-// MARK: - 解析器状态
-
-/// 解析器状态
-enum ScrcpyParserState: Equatable {
-    /// 等待 dummy byte
-    case waitingDummyByte
-    /// 等待设备元数据
-    case waitingDeviceMeta
-    /// 等待编解码器元数据
-    case waitingCodecMeta
-    /// 等待帧头
-    case waitingFrameHeader
-    /// 等待帧数据
-    case waitingFrameData(header: ScrcpyFrameHeader)
-    /// 解析帧数据（raw stream 模式）
-    case parsingRawStream
-}
-
 // MARK: - Scrcpy 视频流解析器
 
 /// Scrcpy 视频流解析器
@@ -418,8 +419,8 @@ final class ScrcpyVideoStreamParser {
     /// 编解码类型（初始值，可能被协议更新）
     private var codecType: CMVideoCodecType
 
-    /// 数据缓冲区
-    private var buffer = Data()
+    /// 解复用器：按帧头与起始码切分 NAL 单元，完整位于本次数据中的包不会被复制
+    private let demuxer: FBScrcpyDemuxer
 
     /// 缓冲区锁
     private let bufferLock = NSLock()
@@ -442,9 +443,6 @@ final class ScrcpyVideoStreamParser {
 
     // MARK: - 协议元数据
 
-    /// 解析器状态
-    private var parserState: ScrcpyParserState = .waitingDummyByte
-
     /// 设备元数据
     private(set) var deviceMeta: ScrcpyDeviceMeta?
 
@@ -452,7 +450,7 @@ final class ScrcpyVideoStreamParser {
     private(set) var codecMeta: ScrcpyCodecMeta?
 
     /// 是否使用 raw stream 模式（跳过协议头）
-    var useRawStream: Bool = false
+    let useRawStream: Bool
 
     /// 当前帧的 PTS
     private(set) var currentFramePTS: CMTime = .invalid
@@ -531,7 +529,7 @@ final class ScrcpyVideoStreamParser {
     init(codecType: CMVideoCodecType, useRawStream: Bool = false) {
         self.codecType = codecType
         self.useRawStream = useRawStream
-        parserState = useRawStream ? .parsingRawStream : .waitingDummyByte
+        demuxer = FBScrcpyDemuxer(mode: useRawStream ? .rawStream : .framed)
         AppLogger.capture
             .info(
                 "[StreamParser] 初始化，编解码器: \(codecType == kCMVideoCodecType_H264 ? "H.264" : "H.265"), rawStream: \(useRawStream)"
@@ -549,63 +547,104 @@ final class ScrcpyVideoStreamParser {
         bufferLock.lock()
         defer { bufferLock.unlock() }
 
-        buffer.append(data)
         totalBytesReceived += data.count
 
         // 更新码率统计
         updateBitrateStatistics(bytesReceived: data.count)
 
-        // 根据模式选择解析方式
-        let nalUnits: [ParsedNALUnit] = if useRawStream || parserState == .parsingRawStream {
-            parseNALUnits()
-        } else {
-            parseProtocol()
+        // 解复用器回调的 NAL 视图只在回调内有效，此处复制为 Data
+        var nalUnits: [ParsedNALUnit] = []
+        data.withUnsafeBytes { rawBuffer in
+            guard let baseAddress = rawBuffer.baseAddress else { return }
+            demuxer.consumeBytes(baseAddress, length: rawBuffer.count) { unit in
+                // 元数据总是先于帧数据到达，需在解析 NAL 前更新编解码类型
+                updateProtocolMetadata()
+                var pts = CMTime.invalid
+                if unit.hasFrameHeader {
+                    pts = CMTime(value: Int64(unit.presentationTimeMicroseconds), timescale: 1_000_000)
+                    currentFramePTS = pts
+                }
+                let nalData = Data(bytes: unit.bytes, count: unit.length)
+                if let nalUnit = parseNALUnit(data: nalData, pts: pts, protocolKeyFrame: unit.isKeyFrame) {
+                    nalUnits.append(nalUnit)
+                    parsedNALCount += 1
+                }
+            }
         }
+        updateProtocolMetadata()
 
-        // 调试统计
-        let parseTime = (CFAbsoluteTimeGetCurrent() - parseStartTime) * 1000 // 转换为毫秒
-        parseCallCount += 1
-        totalParseTime += parseTime
-        maxParseTime = max(maxParseTime, parseTime)
+        let vclUnits = nalUnits.filter(\.isVCL)
+        recordParseStatistics(
+            parseStartTime: parseStartTime,
+            nalUnitCount: nalUnits.count,
+            frameCount: vclUnits.count,
+            keyFrameCount: vclUnits.count(where: { $0.isEffectiveKeyFrame })
+        )
 
-        // 统计 NAL 单元
-        nalUnitsInPeriod += nalUnits.count
+        return nalUnits
+    }
 
-        // 统计帧（VCL NAL 单元）
-        let vclUnits = nalUnits.filter(\.isVCL)
-        if !vclUnits.isEmpty {
-            let now = CFAbsoluteTimeGetCurrent()
-            let frameInterval = (now - lastFrameTime) * 1000
+    /// 追加数据并解析为视频包（仅 scrcpy 协议模式）
+    /// 每个媒体包只复制一次：切片直接写入 CMBlockBuffer，起始码同时改写为 AVCC 长度前缀
+    /// 参数集仍按 NAL 单元解析，用于更新 SPS/PPS/VPS 与检测分辨率变化
+    /// - Parameter data: 接收到的数据
+    /// - Returns: 按流顺序排列的视频包（含配置包）
+    func appendPackets(_ data: Data) -> [ScrcpyVideoPacket] {
+        let parseStartTime = CFAbsoluteTimeGetCurrent()
 
-            if framesInPeriod > 0 {
-                maxFrameInterval = max(maxFrameInterval, frameInterval)
-                totalFrameIntervals += frameInterval
-                frameIntervalCount += 1
-            }
-            lastFrameTime = now
+        bufferLock.lock()
+        defer { bufferLock.unlock() }
 
-            framesInPeriod += vclUnits.count
-            keyFramesInPeriod += vclUnits.count(where: { $0.isEffectiveKeyFrame })
-        }
+        totalBytesReceived += data.count
 
-        // 每 5 秒重置统计（保留内部统计逻辑，移除日志输出）
-        let now = CFAbsoluteTimeGetCurrent()
-        let elapsed = now - lastParseStatsTime
-        if elapsed >= 5.0 {
-            // 重置周期统计
-            framesInPeriod = 0
-            keyFramesInPeriod = 0
-            nalUnitsInPeriod = 0
-            lastParseStatsTime = now
-            totalParseTime = 0
-            maxParseTime = 0
-            parseCallCount = 0
-            maxFrameInterval = 0
-            totalFrameIntervals = 0
-            frameIntervalCount = 0
+        // 更新码率统计
+        updateBitrateStatistics(bytesReceived: data.count)
+
+        var packets: [ScrcpyVideoPacket] = []
+        var nalUnitCount = 0
+        data.withUnsafeBytes { rawBuffer in
+            guard let baseAddress = rawBuffer.baseAddress else { return }
+            demuxer.consumeBytes(baseAddress, length: rawBuffer.count, handler: { unit in
+                // 元数据总是先于帧数据到达，需在解析 NAL 前更新编解码类型
+                updateProtocolMetadata()
+                nalUnitCount += 1
+                // 切片由视频包携带，只有参数集需要复制
+                guard unit.length > 0, isParameterSetHeader(unit.bytes[0]) else { return }
+                let pts = CMTime(value: Int64(unit.presentationTimeMicroseconds), timescale: 1_000_000)
+                let nalData = Data(bytes: unit.bytes, count: unit.length)
+                if parseNALUnit(data: nalData, pts: pts, protocolKeyFrame: unit.isKeyFrame) != nil {
+                    parsedNALCount += 1
+                }
+            }, packetHandler: { packet in
+                let pts = CMTime(value: Int64(packet.presentationTimeMicroseconds), timescale: 1_000_000)
+                currentFramePTS = pts
+                if packet.isConfigPacket {
+                    packets.append(ScrcpyVideoPacket(blockBuffer: nil, presentationTime: pts, isKeyFrame: false, isConfigPacket: true))
+                    return
+                }
+                var containsKeyFrame: ObjCBool = false
+                guard let blockBuffer = FBScrcpyCreateAVCCBlockBuffer(packet.bytes, packet.length, codecType, &containsKeyFrame) else {
+                    return
+                }
+                packets.append(ScrcpyVideoPacket(
+                    blockBuffer: blockBuffer,
+                    presentationTime: pts,
+                    isKeyFrame: packet.isKeyFrame || containsKeyFrame.boolValue,
+                    isConfigPacket: false
+                ))
+            })
         }
+        updateProtocolMetadata()
+
+        let mediaPackets = packets.filter { !$0.isConfigPacket }
+        recordParseStatistics(
+            parseStartTime: parseStartTime,
+            nalUnitCount: nalUnitCount,
+            frameCount: mediaPackets.count,
+            keyFrameCount: mediaPackets.count(where: \.isKeyFrame)
+        )
 
-        return nalUnits
+        return packets
     }
 
     /// 重置解析器状态
@@ -613,7 +652,7 @@ final class ScrcpyVideoStreamParser {
         bufferLock.lock()
         defer { bufferLock.unlock() }
 
-        buffer.removeAll()
+        demuxer.reset()
         vps = nil
         sps = nil
         pps = nil
@@ -622,7 +661,6 @@ final class ScrcpyVideoStreamParser {
         totalBytesReceived = 0
         deviceMeta = nil
         codecMeta = nil
-        parserState = useRawStream ? .parsingRawStream : .waitingDummyByte
         currentFramePTS = .invalid
         bytesReceivedInLastSecond = 0
         currentBitrate = 0
@@ -667,249 +705,77 @@ final class ScrcpyVideoStreamParser {
         }
     }
 
-    // MARK: - 协议解析
-
-    /// 协议解析帧计数（用于调试）
-    private var frameCount = 0
-
-    /// 解析 scrcpy 协议
-    private func parseProtocol() -> [ParsedNALUnit] {
-        var nalUnits: [ParsedNALUnit] = []
-
-        while true {
-            switch parserState {
-            case .waitingDummyByte:
-                // 等待 1 字节的 dummy byte
-                // scrcpy 的 dummy byte 应该是 0x00
-                guard buffer.count >= 1 else {
-                    return nalUnits
-                }
-
-                let firstByte = buffer[0]
-
-                // 检查是否是真正的 dummy byte (0x00)
-                // 如果不是 0x00，可能服务端没有发送 dummy byte
-                if firstByte == 0x00 {
-                    buffer.removeFirst(1)
-                    AppLogger.capture.info("[StreamParser] 收到 dummy byte: 0x00")
-                } else {
-                    // 不是 0x00，假设没有 dummy byte，直接进入设备元数据阶段
-                    AppLogger.capture
-                        .warning("[StreamParser] 首字节不是 0x00 (0x\(String(format: "%02X", firstByte)))，跳过 dummy byte")
-                }
-                parserState = .waitingDeviceMeta
-
-            case .waitingDeviceMeta:
-                // 等待 64 字节的设备元数据
-                guard buffer.count >= 64 else {
-                    return nalUnits
-                }
-                let metaData = buffer.prefix(64)
-                buffer.removeFirst(64)
-
-                if let meta = ScrcpyDeviceMeta.parse(from: Data(metaData)) {
-                    deviceMeta = meta
-                    AppLogger.capture.info("[StreamParser] 设备元数据: \(meta.deviceName)")
-                } else {
-                    AppLogger.capture.warning("[StreamParser] 设备元数据解析失败")
-                }
-                parserState = .waitingCodecMeta
-
-            case .waitingCodecMeta:
-                // 等待 12 字节的编解码器元数据 (codec id + width + height)
-                guard buffer.count >= ScrcpyCodecMeta.size else {
-                    return nalUnits
-                }
-
-                let codecData = Data(buffer.prefix(ScrcpyCodecMeta.size))
-                buffer.removeFirst(ScrcpyCodecMeta.size)
-
-                if let meta = ScrcpyCodecMeta.parse(from: codecData) {
-                    codecMeta = meta
-                    codecType = meta.cmCodecType
-                    AppLogger.capture
-                        .info("[StreamParser] 编解码器: \(meta.codecName), 分辨率: \(meta.width)x\(meta.height)")
-                } else {
-                    AppLogger.capture.warning("[StreamParser] 编解码器元数据解析失败")
-                }
-                parserState = .waitingFrameHeader
-
-            case .waitingFrameHeader:
-                // 等待 12 字节的帧头
-                guard buffer.count >= ScrcpyFrameHeader.size else {
-                    return nalUnits
-                }
-                let headerData = Data(buffer.prefix(ScrcpyFrameHeader.size))
-                buffer.removeFirst(ScrcpyFrameHeader.size)
-
-                guard let header = ScrcpyFrameHeader.parse(from: headerData) else {
-                    AppLogger.capture.warning("[StreamParser] 帧头解析失败")
-                    continue
-                }
-
-                frameCount += 1
-                currentFramePTS = header.cmTime
-                parserState = .waitingFrameData(header: header)
-
-            case let .waitingFrameData(header):
-                // 等待帧数据
-                guard buffer.count >= Int(header.packetSize) else {
-                    return nalUnits
-                }
-                let frameData = buffer.prefix(Int(header.packetSize))
-                buffer.removeFirst(Int(header.packetSize))
-
-                // 解析帧数据中的 NAL 单元，传递帧头信息
-                let parsedUnits = parseNALUnitsFromData(
-                    Data(frameData),
-                    pts: header.cmTime,
-                    protocolKeyFrame: header.isKeyFrame,
-                    isConfigPacket: header.isConfigPacket
-                )
-                nalUnits.append(contentsOf: parsedUnits)
-
-                parserState = .waitingFrameHeader
-
-            case .parsingRawStream:
-                // Raw stream 模式，直接解析 NAL 单元
-                let parsedUnits = parseNALUnits()
-                nalUnits.append(contentsOf: parsedUnits)
-                return nalUnits
-            }
-        }
-    }
+    // MARK: - 调试统计
 
-    /// 从帧数据中解析 NAL 单元
-    /// - Parameters:
-    ///   - data: 帧数据
-    ///   - pts: 显示时间戳
-    ///   - protocolKeyFrame: 协议层关键帧标志（从帧头 bit62 获取）
-    ///   - isConfigPacket: 是否为配置包
-    private func parseNALUnitsFromData(
-        _ data: Data,
-        pts: CMTime,
-        protocolKeyFrame: Bool = false,
-        isConfigPacket: Bool = false
-    ) -> [ParsedNALUnit] {
-        var nalUnits: [ParsedNALUnit] = []
-        let tempBuffer = data
-        var searchStart = 0
-
-        while searchStart < tempBuffer.count - 4 {
-            // 查找当前起始码
-            guard let startCodeInfo = findStartCodeInData(tempBuffer, from: searchStart) else {
-                searchStart += 1
-                continue
-            }
+    /// 记录单次解析的调试统计
+    private func recordParseStatistics(parseStartTime: CFAbsoluteTime, nalUnitCount: Int, frameCount: Int, keyFrameCount: Int) {
+        let parseTime = (CFAbsoluteTimeGetCurrent() - parseStartTime) * 1000 // 转换为毫秒
+        parseCallCount += 1
+        totalParseTime += parseTime
+        maxParseTime = max(maxParseTime, parseTime)
 
-            let (startCodeOffset, startCodeLength) = startCodeInfo
-            let nalStart = startCodeOffset + startCodeLength
+        // 统计 NAL 单元
+        nalUnitsInPeriod += nalUnitCount
 
-            // 查找下一个起始码
-            var nalEnd = tempBuffer.count
-            if let nextStartCode = findStartCodeInData(tempBuffer, from: nalStart) {
-                nalEnd = nextStartCode.0
-            }
+        // 统计帧
+        if frameCount > 0 {
+            let now = CFAbsoluteTimeGetCurrent()
+            let frameInterval = (now - lastFrameTime) * 1000
 
-            // 提取 NAL 单元数据
-            let nalData = tempBuffer.subdata(in: nalStart..<nalEnd)
-            if let nalUnit = parseNALUnit(data: nalData, pts: pts, protocolKeyFrame: protocolKeyFrame) {
-                nalUnits.append(nalUnit)
-                parsedNALCount += 1
+            if framesInPeriod > 0 {
+                maxFrameInterval = max(maxFrameInterval, frameInterval)
+                totalFrameIntervals += frameInterval
+                frameIntervalCount += 1
             }
+            lastFrameTime = now
 
-            searchStart = nalEnd
+            framesInPeriod += frameCount
+            keyFramesInPeriod += keyFrameCount
         }
 
-        return nalUnits
-    }
-
-    /// 在数据中查找起始码
-    private func findStartCodeInData(_ data: Data, from: Int) -> (Int, Int)? {
-        var i = from
-        while i < data.count - 3 {
-            if data[i] == 0x00, data[i + 1] == 0x00, data[i + 2] == 0x00, data[i + 3] == 0x01 {
-                return (i, 4)
-            }
-            if data[i] == 0x00, data[i + 1] == 0x00, data[i + 2] == 0x01 {
-                return (i, 3)
-            }
-            i += 1
+        // 每 5 秒重置统计（保留内部统计逻辑，移除日志输出）
+        let now = CFAbsoluteTimeGetCurrent()
+        let elapsed = now - lastParseStatsTime
+        if elapsed >= 5.0 {
+            // 重置周期统计
+            framesInPeriod = 0
+            keyFramesInPeriod = 0
+            nalUnitsInPeriod = 0
+            lastParseStatsTime = now
+            totalParseTime = 0
+            maxParseTime = 0
+            parseCallCount = 0
+            maxFrameInterval = 0
+            totalFrameIntervals = 0
+            frameIntervalCount = 0
         }
-        return nil
     }
 
-    // MARK: - 私有方法
-
-    /// 解析缓冲区中的 NAL 单元
-    private func parseNALUnits() -> [ParsedNALUnit] {
-        var nalUnits: [ParsedNALUnit] = []
-        var searchStart = 0
-
-        // 查找起始码 (0x00 0x00 0x00 0x01 或 0x00 0x00 0x01)
-        while searchStart < buffer.count - 4 {
-            // 查找当前起始码
-            guard let startCodeInfo = findStartCode(from: searchStart) else {
-                searchStart += 1
-                continue
-            }
-
-            let (startCodeOffset, startCodeLength) = startCodeInfo
-            let nalStart = startCodeOffset + startCodeLength
-
-            // 查找下一个起始码
-            var nalEnd = buffer.count
-            if let nextStartCode = findStartCode(from: nalStart) {
-                nalEnd = nextStartCode.0
-            } else {
-                // 没有找到下一个起始码，保留当前数据等待更多数据
-                break
-            }
-
-            // 提取 NAL 单元数据
-            let nalData = buffer.subdata(in: nalStart..<nalEnd)
-            if let nalUnit = parseNALUnit(data: nalData) {
-                nalUnits.append(nalUnit)
-                parsedNALCount += 1
-            }
+    // MARK: - 元数据同步
 
-            searchStart = nalEnd
+    /// 从解复用器同步设备与编解码器元数据
+    private func updateProtocolMetadata() {
+        if deviceMeta == nil, let deviceName = demuxer.deviceName {
+            deviceMeta = ScrcpyDeviceMeta(deviceName: deviceName)
+            AppLogger.capture.info("[StreamParser] 设备元数据: \(deviceName)")
         }
-
-        // 移除已处理的数据
-        if searchStart > 0 {
-            buffer.removeSubrange(0..<searchStart)
+        if codecMeta == nil, demuxer.hasCodecMetadata {
+            let meta = ScrcpyCodecMeta(codecId: demuxer.codecIdentifier, width: demuxer.width, height: demuxer.height)
+            codecMeta = meta
+            codecType = meta.cmCodecType
+            AppLogger.capture
+                .info("[StreamParser] 编解码器: \(meta.codecName), 分辨率: \(meta.width)x\(meta.height)")
         }
-
-        return nalUnits
     }
 
-    /// 查找起始码
-    /// - Parameter from: 搜索起始位置
-    /// - Returns: (起始码位置, 起始码长度) 或 nil
-    private func findStartCode(from: Int) -> (Int, Int)? {
-        var i = from
-        while i < buffer.count - 3 {
-            // 检查 4 字节起始码: 0x00 0x00 0x00 0x01
-            if
-                buffer[i] == 0x00,
-                buffer[i + 1] == 0x00,
-                buffer[i + 2] == 0x00,
-                buffer[i + 3] == 0x01 {
-                return (i, 4)
-            }
-
-            // 检查 3 字节起始码: 0x00 0x00 0x01
-            if
-                buffer[i] == 0x00,
-                buffer[i + 1] == 0x00,
-                buffer[i + 2] == 0x01 {
-                return (i, 3)
-            }
+    // MARK: - 私有方法
 
-            i += 1
+    /// 根据 NAL 头首字节判断是否为参数集（SPS/PPS/VPS）
+    private func isParameterSetHeader(_ header: UInt8) -> Bool {
+        if codecType == kCMVideoCodecType_H264 {
+            return H264NALUnitType(rawValue: header & 0x1f)?.isParameterSet ?? false
         }
-        return nil
+        return H265NALUnitType(rawValue: (header >> 1) & 0x3f)?.isParameterSet ?? false
     }
 
     /// 解析单个 NAL 单元
@@ -180,8 +180,8 @@ struct ScrcpyConfiguration {
 final class ScrcpyDeviceSource: BaseDeviceSource {
     // MARK: - 配置
 
-    /// 配置（在初始化时设置）
-    private let configuration: ScrcpyConfiguration
+    /// 配置（在初始化时设置，码流自适应会调整 maxSize / bitrate / maxFps）
+    private var configuration: ScrcpyConfiguration
     private let toolchainManager: ToolchainManager
 
     // MARK: - 组件
@@ -201,6 +201,14 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
     /// VideoToolbox 解码器
     private var decoder: VideoToolboxDecoder?
 
+    /// 码流录制器（设置 ScrcpyStreamRecordingPath 时把 socket 收到的原始字节写入文件，供回放基准测试使用）
+    private var streamRecorder: ScrcpyStreamRecorder?
+
+    /// 直通录制器（在主线程开始与结束，在 socket 接收队列写入，由 movieRecorderLock 保护）
+    /// 跨越码流重启保留，断开连接时结束
+    private let movieRecorderLock = NSLock()
+    private var movieRecorder: ScrcpyMovieRecorder?
+
     // MARK: - 音频组件
 
     /// 音频流解析器
@@ -224,6 +232,9 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
     /// 音频同步器
     private var audioSynchronizer: AudioSynchronizer?
 
+    /// 正在解码的音频包 PTS（微秒，解码器同步回调时使用）
+    private var decodingAudioPts: UInt64?
+
     /// 音频是否启用（从偏好设置读取，控制播放而非捕获）
     var audioEnabled: Bool {
         get { UserPreferences.shared.androidAudioEnabled }
@@ -260,6 +271,9 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
     /// 实现: 解码线程 → FramePipeline → 主线程渲染
     private let framePipeline = FramePipeline()
 
+    /// 帧延迟追踪器（socket 接收 → 呈现，呈现阶段由渲染视图记录）
+    let latencyTracer = FrameLatencyTracer()
+
     /// 最新的 CVPixelBuffer 存储（兼容旧接口）
     private let latestPixelBufferLock = NSLock()
     private var latestPixelBufferStorage: CVPixelBuffer?
@@ -271,10 +285,20 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
         return latestPixelBufferStorage
     }
 
+    /// 帧缩略图分接
+    override var thumbnailTap: FrameThumbnailTap? { framePipeline.thumbnailTap }
+
     /// 捕获回调开关（避免 stop/cleanup 后仍处理解码回调）
     private let captureGateLock = NSLock()
     private var isCaptureActive = false
 
+    /// 是否处于热备状态（由 captureGateLock 保护）
+    /// 热备时 server、socket 与解码器保持运行，解码帧只更新最新帧，不分发、不渲染
+    private var isStandbyActive = false
+
+    /// 从热备提升后，下一次设置帧回调时立即分发最新帧（仅主线程访问）
+    private var needsLatestFrameOnAttach = false
+
     /// 帧回调（通过 FramePipeline 分发，已实现事件合并）
     var onFrame: ((CVPixelBuffer) -> Void)? {
         didSet {
@@ -286,6 +310,11 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
                     // 调用外部回调
                     callback(pixelBuffer)
                 }
+                // 刚从热备提升：画面静止时短时间内没有新帧，先分发热备期间解码的最新帧
+                if needsLatestFrameOnAttach, let latest = latestPixelBuffer {
+                    needsLatestFrameOnAttach = false
+                    framePipeline.pushFrame(latest, allowsSkip: false)
+                }
             } else {
                 framePipeline.setFrameHandler { _ in }
             }
@@ -295,9 +324,24 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
     /// 当前端口
     private var currentPort: Int
 
-    /// 帧管道统计任务
+    /// 帧管道统计任务（同时负责码流自适应采样）
     private var pipelineStatsTask: Task<Void, Never>?
 
+    /// 码流自适应控制器（跨码流重启保留，以便滞回生效）
+    private let adaptiveStreamController: ScrcpyAdaptiveStreamController
+
+    /// 显示尺寸提供者（主线程调用，返回渲染视图的像素尺寸）
+    var displaySizeProvider: (() -> CGSize)?
+
+    /// 捕获策略要求的实时解码调度（重建解码器时沿用）
+    private var isDecoderRealTime = true
+
+    /// 捕获策略是否暂停了渲染（窗口不可见），与内存压力共同决定是否只解码关键帧
+    private var isRendersPaused = false
+
+    /// 主窗口是否为焦点窗口（决定解码优先级）
+    private var isWindowFocused = true
+
     // MARK: - 初始化
 
     init(device: AndroidDevice, toolchainManager: ToolchainManager, configuration: ScrcpyConfiguration? = nil) {
@@ -305,6 +349,9 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
         var config = configuration ?? UserPreferences.shared.buildScrcpyConfiguration(serial: device.serial)
         config.serial = device.serial
         self.configuration = config
+        adaptiveStreamController = ScrcpyAdaptiveStreamController(
+            baseline: ScrcpyStreamProfile(maxSize: config.maxSize, bitrate: config.bitrate, maxFps: config.maxFps)
+        )
         self.toolchainManager = toolchainManager
 
         // 从用户偏好读取端口范围起始值作为初始端口
@@ -323,6 +370,8 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
             platform: .android
         )
 
+        MemoryPressureCoordinator.shared.register(self)
+        MainThreadWatchdog.shared.register(self)
         AppLogger.device.info("创建 Scrcpy 设备源: \(device.displayName)")
     }
 
@@ -377,6 +426,10 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
 
         // 创建 VideoToolbox 解码器
         decoder = VideoToolboxDecoder(codecType: configuration.videoCodec.fourCC)
+        decoder?.setRealTime(isDecoderRealTime)
+        updateDecoderScheduling()
+        decoder?.latencyTracer = latencyTracer
+        framePipeline.latencyTracer = latencyTracer
         attachDecoderCallback()
 
         // 获取 scrcpy 版本
@@ -408,6 +461,7 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
 
         // stopCapture 会处理所有清理工作
         await stopCapture()
+        _ = await stopMovieRecording()
 
         // 清理组件
         adbService = nil
@@ -465,7 +519,8 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
             socketAcceptor = ScrcpySocketAcceptor(
                 port: currentPort,
                 connectionMode: launcher.connectionMode,
-                audioEnabled: configuration.audioEnabled
+                audioEnabled: configuration.audioEnabled,
+                videoPreambleLength: launcher.videoPreambleLength
             )
 
             // 设置视频数据接收回调
@@ -486,10 +541,16 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
                 }
             }
 
+            // 按需录制码流（必须在数据开始接收之前）
+            startStreamRecordingIfNeeded()
+            startMovieRecordingIfNeeded()
+
             // 4. 启动监听/连接
             try await socketAcceptor?.start()
 
             // 5. 提前启动帧管道（必须在数据开始接收之前！）
+            latencyTracer.reset()
+            pendingReceiveTime = nil
             framePipeline.start(size: CGSize(width: 1080, height: 1920))
 
             // 6. 提前设置状态为 capturing
@@ -498,9 +559,11 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
 
             // 7. 启动 scrcpy-server
             serverProcess = try await launcher.startServer(configuration: configuration)
+            markStartup(.sessionReady)
 
             // 8. 等待视频连接建立
             try await socketAcceptor?.waitForVideoConnection(timeout: 10)
+            markStartup(.streamStarted)
 
             AppLogger.capture.info("捕获已启动: \(displayName)")
 
@@ -639,6 +702,7 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
         // 清理 socket
         socketAcceptor?.stop()
         socketAcceptor = nil
+        stopStreamRecording()
 
         // 停止 launcher（会清理端口转发）
         await serverLauncher?.stop()
@@ -684,15 +748,23 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
         // 先停掉回调，避免清理过程中仍处理帧
         deactivateCaptureCallbacks()
 
-        // 0. 停止帧管道统计任务
+        // 0. 停止帧管道统计任务与进程监控
         stopPipelineStats()
+        monitorTask?.cancel()
+        monitorTask = nil
 
         // 0.5. 停止帧管道
         framePipeline.stop()
 
+        let latency = latencyTracer.snapshot()
+        if latency.presentedCount > 0 {
+            AppLogger.performance.info("[Scrcpy] 帧延迟: \(latency.summary)")
+        }
+
         // 1. 停止 Socket 接收器
         socketAcceptor?.stop()
         socketAcceptor = nil
+        stopStreamRecording()
 
         // 2. 停止服务器启动器
         await serverLauncher?.stop()
@@ -739,52 +811,117 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
         }
     }
 
-    // MARK: - 数据处理
+    // MARK: - 热备
+
+    /// 是否处于热备状态
+    var isStandby: Bool {
+        captureGateLock.lock()
+        defer { captureGateLock.unlock() }
+        return isStandbyActive
+    }
+
+    /// 进入热备：切换到其他设备时保留会话，而不是停止捕获
+    /// server、socket 与解码器继续运行（解码器保持参考帧，提升时无需等待关键帧），只停止分发帧和播放音频
+    /// 注意：scrcpy-server 以 control=false 启动，运行中无法调整码率，热备期间码流保持原码率
+    @MainActor
+    func enterStandby() {
+        guard state == .capturing else { return }
+
+        captureGateLock.lock()
+        isStandbyActive = true
+        captureGateLock.unlock()
+
+        onFrame = nil
+        audioPlayer?.isMuted = true
+        pauseCapture()
+        updateDecoderScheduling()
+        AppLogger.capture.info("[Scrcpy] 进入热备: \(displayName)")
+    }
+
+    /// 从热备提升为当前设备，恢复分发帧和播放音频
+    @MainActor
+    func leaveStandby() {
+        guard isStandby else { return }
+
+        captureGateLock.lock()
+        isStandbyActive = false
+        captureGateLock.unlock()
 
-    /// 过滤掉的非 VCL NAL 计数（用于诊断）
-    private var filteredNonVCLCount = 0
+        needsLatestFrameOnAttach = true
+        audioPlayer?.isMuted = !audioEnabled
+        resumeCapture()
+        updateDecoderScheduling()
+        AppLogger.capture.info("[Scrcpy] 从热备提升: \(displayName)")
+    }
+
+    // MARK: - 捕获策略
+
+    /// 应用捕获策略
+    /// 解码调度立即生效；帧率上限交给码流自适应控制器，经过滞回后以重启码流的方式生效
+    /// 窗口遮挡只暂停渲染，不因此重启 server
+    @MainActor
+    func applyCapturePolicy(_ policy: CapturePolicy) {
+        if isDecoderRealTime != policy.decoderRealTime {
+            isDecoderRealTime = policy.decoderRealTime
+            decoder?.setRealTime(policy.decoderRealTime)
+        }
+        adaptiveStreamController.frameRateCap = policy.maxFrameRate
+        isRendersPaused = policy.rendersPaused
+        isWindowFocused = policy.windowFocused
+        updateDecoderScheduling()
+    }
 
-    /// 端到端延迟统计
-    private var frameReceiveTime: CFAbsoluteTime = 0
-    private var frameDecodeCompleteTime: CFAbsoluteTime = 0
-    private var totalE2ELatency: Double = 0
-    private var maxE2ELatency: Double = 0
-    private var e2eLatencyCount: Int = 0
-    private var lastE2EStatsTime = CFAbsoluteTimeGetCurrent()
+    // MARK: - 解码调度
+
+    /// 按可见性与焦点设置解码优先级；画面不可见（热备或渲染暂停）且内存紧张时只解码关键帧
+    /// 恢复后从下一个关键帧开始解码：server 以 control=false 启动，无法主动请求关键帧
+    private func updateDecoderScheduling() {
+        let isHidden = isRendersPaused || isStandby
+        decoder?.priority = isHidden ? .hidden : (isWindowFocused ? .focused : .visible)
+        decoder?.setKeyFrameOnly(isHidden && MemoryPressureCoordinator.shared.level >= .warning)
+    }
+
+    // MARK: - 数据处理
+
+    /// 尚未解析出完整视频包的首个数据块的到达时间（仅在 socket 接收队列访问）
+    /// 一个视频包可能跨越多个数据块，以首个数据块的到达时间作为该帧的接收时间
+    private var pendingReceiveTime: CFTimeInterval?
 
     /// 处理接收到的数据
     private func handleReceivedData(_ data: Data) {
         // 记录数据接收时间
-        frameReceiveTime = CFAbsoluteTimeGetCurrent()
+        let receiveTime = pendingReceiveTime ?? CACurrentMediaTime()
 
         guard let parser = streamParser, let decoder else { return }
 
-        // 解析 NAL 单元
-        let nalUnits = parser.append(data)
+        streamRecorder?.append(data)
 
-        for nalUnit in nalUnits {
-            // 如果是参数集且解码器未初始化，尝试初始化
-            if nalUnit.isParameterSet, !decoder.isReady {
-                if parser.hasCompleteParameterSets {
-                    initializeDecoderIfNeeded()
-                }
-                continue
-            }
+        // 解析视频包：切片已按 AVCC 格式写入 block buffer，非 VCL 单元已被滤除
+        let packets = parser.appendPackets(data)
 
-            // 过滤非 VCL NAL 单元（SEI/AUD/filler 等）
-            // 这些单元不包含实际视频数据，不应送入解码器
-            guard nalUnit.isVCL else {
-                filteredNonVCLCount += 1
-                // 每 100 个非 VCL NAL 记录一次日志（避免日志过多）
-                if filteredNonVCLCount % 100 == 1 {
-                    AppLogger.capture.debug("[Scrcpy] 过滤非 VCL NAL (type=\(nalUnit.type))，累计过滤: \(filteredNonVCLCount)")
-                }
-                continue
+        movieRecorderLock.lock()
+        let movieRecorder = movieRecorder
+        movieRecorderLock.unlock()
+
+        // 数据块末尾的剩余字节属于下一个包，其接收时间近似为下一个数据块的到达时间
+        pendingReceiveTime = packets.isEmpty ? receiveTime : nil
+
+        for packet in packets {
+            if !packet.isConfigPacket {
+                markStartupSampleIfNeeded()
             }
+            if !packet.isConfigPacket, let frameID = FrameLatencyTracer.frameID(for: packet.presentationTime) {
+                latencyTracer.begin(frameID: frameID, receivedAt: receiveTime)
+            }
+
+            movieRecorder?.append(packet, from: parser)
 
-            // 解码 VCL NAL 单元（实际视频帧数据）
+            // 参数集可能来自配置包，也可能内联在媒体包中；解码器未初始化时尝试初始化
+            initializeDecoderIfNeeded()
+
+            // 配置包由解码器跳过
             if decoder.isReady {
-                decoder.decode(nalUnit: nalUnit)
+                decoder.decode(packet: packet)
             }
         }
     }
@@ -815,6 +952,7 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
                 try decoder.initializeH265(vps: vps, sps: sps, pps: pps)
             }
             decoder.activateCallbacks()
+            markStartup(.decoderReady)
             AppLogger.capture.info("✅ 解码器初始化成功（可能是旋转后重建）")
         } catch {
             AppLogger.capture.error("解码器初始化失败: \(error.localizedDescription)")
@@ -844,28 +982,18 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
 
     /// 处理解码后的帧
     /// 使用双帧缓冲设计（与 scrcpy frame_buffer.c 一致）
-    private func handleDecodedFrame(_ pixelBuffer: CVPixelBuffer) {
-        guard canHandleFrames() else { return }
-
-        // 计算端到端延迟（从数据接收到解码完成）
-        let decodeCompleteTime = CFAbsoluteTimeGetCurrent()
-        let e2eLatency = (decodeCompleteTime - frameReceiveTime) * 1000 // 转换为毫秒
-
-        totalE2ELatency += e2eLatency
-        maxE2ELatency = max(maxE2ELatency, e2eLatency)
-        e2eLatencyCount += 1
-
-        // 每 5 秒重置统计（保留内部统计逻辑，移除日志输出）
-        let now = CFAbsoluteTimeGetCurrent()
-        let elapsed = now - lastE2EStatsTime
-        if elapsed >= 5.0 {
-            // 重置统计
-            lastE2EStatsTime = now
-            totalE2ELatency = 0
-            maxE2ELatency = 0
-            e2eLatencyCount = 0
+    /// - Parameters:
+    ///   - pixelBuffer: 解码后的像素缓冲
+    ///   - outputTime: 解码器输出回调时的主机时间
+    private func handleDecodedFrame(_ pixelBuffer: CVPixelBuffer, outputTime: CMTime) {
+        // 热备时只保留最新帧，提升时立即可用
+        if isStandby {
+            setLatestPixelBuffer(pixelBuffer)
+            return
         }
 
+        guard canHandleFrames() else { return }
+
         // 更新最新帧（兼容旧接口）
         setLatestPixelBuffer(pixelBuffer)
 
@@ -889,7 +1017,7 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
         // 创建 CapturedFrame
         let frame = CapturedFrame(
             pixelBuffer: pixelBuffer,
-            presentationTime: CMTime(value: Int64(CACurrentMediaTime() * 1_000_000), timescale: 1_000_000),
+            presentationTime: outputTime,
             size: newSize
         )
         emitFrame(frame)
@@ -925,13 +1053,16 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
 
     private func attachDecoderCallback() {
         decoder?.activateCallbacks()
-        decoder?.onDecodedFrame = { [weak self] pixelBuffer in
-            self?.handleDecodedFrame(pixelBuffer)
+        decoder?.onDecodedFrame = { [weak self] pixelBuffer, outputTime in
+            self?.handleDecodedFrame(pixelBuffer, outputTime: outputTime)
         }
     }
 
     private func deactivateCaptureCallbacks() {
-        setCaptureActive(false)
+        captureGateLock.lock()
+        isCaptureActive = false
+        isStandbyActive = false
+        captureGateLock.unlock()
         decoder?.stopAndDrain(clearCallback: true)
         setLatestPixelBuffer(nil)
     }
@@ -964,7 +1095,8 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
             let exitCode = serverProcess.terminationStatus
 
             await MainActor.run { [weak self] in
-                guard let self else { return }
+                // 主动停止（包括码流自适应重启）时由 stopCapture 负责状态，不再处理旧进程的退出
+                guard let self, !Task.isCancelled else { return }
 
                 // 退出码 0 表示正常退出，15 (SIGTERM) 表示被主动终止（也是正常情况）
                 let isNormalExit = exitCode == 0 || exitCode == 15 // SIGTERM
@@ -982,12 +1114,177 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
         }
     }
 
+    // MARK: - 码流录制
+
+    /// 录制路径的偏好键（可通过启动参数 -ScrcpyStreamRecordingPath <路径> 设置）
+    private static let streamRecordingPathKey = "ScrcpyStreamRecordingPath"
+
+    /// 设置了录制路径时开始录制码流（每次捕获覆盖同一文件）
+    private func startStreamRecordingIfNeeded() {
+        guard let path = UserDefaults.standard.string(forKey: Self.streamRecordingPathKey), !path.isEmpty else {
+            return
+        }
+
+        let url = URL(fileURLWithPath: (path as NSString).expandingTildeInPath)
+        do {
+            streamRecorder = try ScrcpyStreamRecorder(
+                url: url,
+                codecType: configuration.videoCodec.fourCC,
+                useRawStream: false
+            )
+            AppLogger.capture.info("[Scrcpy] 录制码流到: \(url.path)")
+        } catch {
+            AppLogger.capture.error("[Scrcpy] 无法创建码流录制文件: \(error.localizedDescription)")
+        }
+    }
+
+    /// 停止录制码流
+    private func stopStreamRecording() {
+        streamRecorder?.close()
+        streamRecorder = nil
+    }
+
+    // MARK: - 直通录制
+
+    /// 直通录制路径的偏好键（可通过启动参数 -ScrcpyMovieRecordingPath <路径> 设置）
+    private static let movieRecordingPathKey = "ScrcpyMovieRecordingPath"
+
+    /// 设置了直通录制路径且尚未在录制时开始录制（码流重启时沿用同一个录制器）
+    private func startMovieRecordingIfNeeded() {
+        guard
+            !isMovieRecording,
+            let path = UserDefaults.standard.string(forKey: Self.movieRecordingPathKey),
+            !path.isEmpty
+        else {
+            return
+        }
+
+        do {
+            try startMovieRecording(to: URL(fileURLWithPath: (path as NSString).expandingTildeInPath))
+        } catch {
+            AppLogger.capture.error("[Scrcpy] 无法创建直通录制文件: \(error.localizedDescription)")
+        }
+    }
+
+    /// 是否正在直通录制
+    var isMovieRecording: Bool {
+        movieRecorderLock.lock()
+        defer { movieRecorderLock.unlock() }
+        return movieRecorder != nil
+    }
+
+    /// 开始直通录制：视频包不经解码直接写入 QuickTime 影片，从下一个关键帧开始
+    /// - Parameter url: 影片文件路径（已存在时覆盖）
+    func startMovieRecording(to url: URL) throws {
+        let recorder = try ScrcpyMovieRecorder(url: url)
+
+        movieRecorderLock.lock()
+        let previous = movieRecorder
+        movieRecorder = recorder
+        movieRecorderLock.unlock()
+
+        if let previous {
+            Task { _ = await previous.finish() }
+        }
+        AppLogger.capture.info("[Scrcpy] 直通录制到: \(url.path)")
+    }
+
+    /// 结束直通录制
+    /// - Returns: 影片文件路径；未在录制或没有写入任何帧时为 nil
+    func stopMovieRecording() async -> URL? {
+        movieRecorderLock.lock()
+        let recorder = movieRecorder
+        movieRecorder = nil
+        movieRecorderLock.unlock()
+
+        return await recorder?.finish()
+    }
+
     // MARK: - 帧缓冲统计
 
+    /// 码流自适应采样间隔（秒）
+    private static let adaptiveSampleInterval: Double = 2
+
+    /// 关闭码流自适应的偏好键（可通过启动参数 -ScrcpyAdaptiveStreamDisabled YES 设置）
+    private static let adaptiveStreamDisabledKey = "ScrcpyAdaptiveStreamDisabled"
+
     /// 启动帧管道统计任务（生产环境已禁用日志输出）
+    /// 定期采样跳帧率、解码耗时与显示尺寸，交给码流自适应控制器决策
     private func startPipelineStats() {
-        // 保留任务结构以便后续调试使用，但不再输出日志
-        pipelineStatsTask = nil
+        pipelineStatsTask?.cancel()
+        guard !UserDefaults.standard.bool(forKey: Self.adaptiveStreamDisabledKey) else {
+            pipelineStatsTask = nil
+            return
+        }
+
+        pipelineStatsTask = Task { @MainActor [weak self] in
+            var lastFrames = self?.framePipeline.getStats()
+            var lastDecodeLoad = self?.decoder?.decodeLoad
+
+            while !Task.isCancelled {
+                try? await Task.sleep(for: .seconds(Self.adaptiveSampleInterval))
+                guard !Task.isCancelled, let self else { return }
+
+                let frames = framePipeline.getStats()
+                let decodeLoad = decoder?.decodeLoad ?? (0, 0)
+                defer {
+                    lastFrames = frames
+                    lastDecodeLoad = decodeLoad
+                }
+
+                // 热备或暂停期间帧不分发，跳帧统计没有意义
+                guard state == .capturing, !isStandby, captureSize != .zero else { continue }
+
+                // 统计在帧管道或解码器重建后会归零，出现负增量时只更新基线
+                let skipped = frames.skipped - (lastFrames?.skipped ?? 0)
+                let rendered = frames.rendered - (lastFrames?.rendered ?? 0)
+                let decodeTime = decodeLoad.totalTimeMs - (lastDecodeLoad?.totalTimeMs ?? 0)
+                let decodeCount = decodeLoad.count - (lastDecodeLoad?.count ?? 0)
+                guard skipped >= 0, rendered >= 0, decodeCount >= 0, skipped + rendered > 0 else { continue }
+
+                let sample = ScrcpyAdaptiveStreamController.Sample(
+                    displayedPixelSize: displayedPixelSize(),
+                    streamPixelSize: captureSize,
+                    skipRate: Double(skipped) / Double(skipped + rendered),
+                    averageDecodeTimeMs: decodeCount > 0 ? decodeTime / Double(decodeCount) : 0
+                )
+                if let profile = adaptiveStreamController.evaluate(sample) {
+                    // 重启会取消本任务，放到独立任务中执行，避免取消传递到 startCapture
+                    Task { @MainActor [weak self] in
+                        await self?.applyStreamProfile(profile)
+                    }
+                    return
+                }
+            }
+        }
+    }
+
+    /// 视频在渲染视图中按比例适配后的像素尺寸
+    @MainActor
+    private func displayedPixelSize() -> CGSize {
+        guard let drawable = displaySizeProvider?(), drawable.width > 0, drawable.height > 0 else { return .zero }
+        let scale = min(drawable.width / captureSize.width, drawable.height / captureSize.height)
+        return CGSize(width: captureSize.width * scale, height: captureSize.height * scale)
+    }
+
+    /// 按新的码流参数重启码流
+    /// scrcpy-server 以 control=false 启动，没有控制通道可以在运行中重新协商，只能重启 server
+    @MainActor
+    private func applyStreamProfile(_ profile: ScrcpyStreamProfile) async {
+        AppLogger.performance.info(
+            "[Scrcpy] 码流自适应: maxSize \(configuration.maxSize) → \(profile.maxSize), bitrate \(configuration.bitrate) → \(profile.bitrate), maxFps \(configuration.maxFps) → \(profile.maxFps)"
+        )
+
+        configuration.maxSize = profile.maxSize
+        configuration.bitrate = profile.bitrate
+        configuration.maxFps = profile.maxFps
+
+        await stopCapture()
+        do {
+            try await startCapture()
+        } catch {
+            AppLogger.capture.error("[Scrcpy] 码流自适应重启失败: \(error.localizedDescription)")
+        }
     }
 
     /// 停止帧管道统计任务
@@ -1029,8 +1326,11 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
             // 启用音频调节器
             audioPlayer?.enableRegulator(sampleRate: 48000, channels: 2, targetBufferingMs: 50)
 
+            // 创建音频同步器（根据 PTS 漂移为调节器提供播放速率建议）
+            audioSynchronizer = AudioSynchronizer()
+
             // 设置 onDecodedAudio 回调
-            opusDecoder?.onDecodedAudio = { [weak self] pcmData, format in
+            opusDecoder?.onDecodedAudio = { [weak self] samples, format in
                 guard let self else { return }
 
                 // 检查是否已初始化
@@ -1039,8 +1339,15 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
                     audioPlayer?.start()
                 }
 
-                // 将数据推送到 regulator
-                audioPlayer?.processPCMData(pcmData, format: format)
+                // 根据 PTS 漂移调整播放速率
+                if let pts = decodingAudioPts, let audioSynchronizer {
+                    let sampleCount = samples.count / max(Int(format.channelCount), 1)
+                    let decision = audioSynchronizer.processAudioPts(pts, sampleCount: sampleCount)
+                    audioPlayer?.setSuggestedPlaybackRate(decision.suggestedRate)
+                }
+
+                // 将样本直接写入 regulator 的环形缓冲区
+                audioPlayer?.processPCMSamples(samples, format: format)
             }
         }
 
@@ -1051,6 +1358,7 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
             if isConfig {
                 return
             }
+            decodingAudioPts = pts
             opusDecoder?.decode(data, pts: pts, isKeyFrame: isKeyFrame)
         }
     }
@@ -1086,8 +1394,32 @@ final class ScrcpyDeviceSource: BaseDeviceSource {
         // 清理音频同步器
         audioSynchronizer?.reset()
         audioSynchronizer = nil
+        decodingAudioPts = nil
 
         audioStreamParser?.reset()
         audioStreamParser = nil
     }
 }
+
+// MARK: - MemoryPressureResponder
+
+extension ScrcpyDeviceSource: MemoryPressureResponder {
+    func memoryPressureDidChange(to level: MemoryPressureLevel) {
+        MainActor.assumeIsolated {
+            updateDecoderScheduling()
+        }
+    }
+}
+
+// MARK: - HangCorrelationSource
+
+extension ScrcpyDeviceSource: HangCorrelationSource {
+    var hangCorrelationName: String { displayName }
+
+    func hangFrameSample() -> HangFrameSample {
+        HangFrameSample(
+            skippedFrames: framePipeline.getStats().skipped,
+            decodeQueueDepth: decoder?.pendingDecodeCount
+        )
+    }
+}
@@ -44,6 +44,7 @@ final class UserPreferences {
         static let backgroundOpacity = "backgroundOpacity"
         static let showDeviceBezel = "showDeviceBezel"
         static let captureFrameRate = "captureFrameRate"
+        static let captureServiceEnabled = "captureServiceEnabled"
         static let scrcpyBitrate = "scrcpyBitrate"
         static let scrcpyMaxSize = "scrcpyMaxSize"
         static let scrcpyShowTouches = "scrcpyShowTouches"
@@ -198,6 +199,12 @@ final class UserPreferences {
         set { defaults.set(newValue, forKey: Keys.captureFrameRate) }
     }
 
+    /// 是否在独立的捕获服务进程中运行 iOS 设备发现与捕获（运行期改动需重启后生效）
+    var captureServiceEnabled: Bool {
+        get { defaults.bool(forKey: Keys.captureServiceEnabled) }
+        set { defaults.set(newValue, forKey: Keys.captureServiceEnabled) }
+    }
+
     // MARK: - scrcpy Settings
 
     /// 码率（Mbps）
@@ -406,6 +413,7 @@ final class UserPreferences {
             Keys.backgroundOpacity: 1.0,
             Keys.showDeviceBezel: true,
             Keys.captureFrameRate: 60,
+            Keys.captureServiceEnabled: true,
             Keys.scrcpyBitrate: 8,
             Keys.scrcpyMaxSize: 0,
             Keys.scrcpyShowTouches: false,
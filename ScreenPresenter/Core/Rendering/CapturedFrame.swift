@@ -51,9 +51,9 @@ struct CapturedFrame: Identifiable {
     }
 
     /// 从 CVPixelBuffer 初始化
-    init(pixelBuffer: CVPixelBuffer, presentationTime: CMTime, size: CGSize) {
+    init(sourceID: UUID = UUID(), pixelBuffer: CVPixelBuffer, presentationTime: CMTime, size: CGSize) {
         id = UUID()
-        sourceID = UUID()
+        self.sourceID = sourceID
         _pixelBuffer = pixelBuffer
         _sampleBuffer = nil
         timestamp = presentationTime
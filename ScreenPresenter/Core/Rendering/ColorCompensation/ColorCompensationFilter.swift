@@ -9,8 +9,9 @@
 //  支持多实例，每个设备面板可以使用独立的滤镜实例
 //
 
-import Foundation
+import AppKit
 import Metal
+import QuartzCore
 import simd
 
 // MARK: - 颜色补偿参数结构（与 Shader 对应）
@@ -65,6 +66,9 @@ protocol ColorCompensationFilterProtocol: AnyObject {
 
     /// 获取 LUT 纹理（RGBA16Float 格式，256x1）
     func getLUTTexture() -> MTLTexture?
+
+    /// 获取折叠整条补偿链路的 3D LUT 纹理（RGBA16Float 格式，lut3DSize³）
+    func getLUT3DTexture() -> MTLTexture?
 }
 
 // MARK: - 1D LUT 颜色补偿滤镜
@@ -92,7 +96,7 @@ final class ColorCompensationFilter: ColorCompensationFilterProtocol {
     var profile: ColorProfile = .neutral {
         didSet {
             if oldValue != profile {
-                updateLUT()
+                scheduleLUTUpdate()
                 updateUniformBuffer()
             }
         }
@@ -102,7 +106,22 @@ final class ColorCompensationFilter: ColorCompensationFilterProtocol {
 
     private var device: MTLDevice?
     private var lutTexture: MTLTexture?
+    private var lut3DTexture: MTLTexture?
     private var uniformBuffer: MTLBuffer?
+
+    /// GPU LUT 生成器（无法创建计算管线时为 nil，回退到 CPU 生成）
+    private var computeGenerator: LUTComputeGenerator?
+
+    // MARK: - LUT 更新节流（主线程）
+
+    /// 上次生成 LUT 的时间
+    private var lastLUTUpdateTime: CFTimeInterval = 0
+
+    /// 是否已安排 LUT 更新（拖动滑块时按显示刷新率合并）
+    private var isLUTUpdateScheduled = false
+
+    /// 是否处于临时禁用（AB 对比）
+    private var isBypassed = false
     private let bufferLock = NSLock()
 
     // MARK: - Triple Buffering
@@ -123,6 +142,10 @@ final class ColorCompensationFilter: ColorCompensationFilterProtocol {
             return
         }
         self.device = device
+        computeGenerator = LUTComputeGenerator(device: device)
+        if computeGenerator == nil {
+            AppLogger.rendering.warning("ColorCompensationFilter: GPU LUT 生成不可用，使用 CPU 生成")
+        }
 
         // 创建 Triple Buffering 的 Uniform Buffer
         let bufferSize = MemoryLayout<ColorCompensationParams>.stride
@@ -141,8 +164,54 @@ final class ColorCompensationFilter: ColorCompensationFilterProtocol {
 
     // MARK: - LUT 管理
 
-    /// 更新 LUT 纹理
+    /// 更新 LUT 纹理（立即生成，返回时新纹理已可用）
     func updateLUT() {
+        generateLUT(waitUntilCompleted: true)
+    }
+
+    /// 按显示刷新率合并 LUT 更新
+    /// 拖动滑块时配置连续变化，每个刷新周期最多生成一次，最后一次变化总会生成
+    private func scheduleLUTUpdate() {
+        guard !isLUTUpdateScheduled else { return }
+
+        let interval = 1.0 / Double(max(NSScreen.main?.maximumFramesPerSecond ?? 60, 1))
+        let delay = lastLUTUpdateTime + interval - CACurrentMediaTime()
+        guard delay > 0 else {
+            generateLUT(waitUntilCompleted: false)
+            return
+        }
+
+        isLUTUpdateScheduled = true
+        DispatchQueue.main.asyncAfter(deadline: .now() + delay) { [weak self] in
+            guard let self else { return }
+            isLUTUpdateScheduled = false
+            generateLUT(waitUntilCompleted: false)
+        }
+    }
+
+    /// 生成 LUT 纹理
+    /// 优先在 GPU 上生成（完成后替换纹理，渲染在此之前继续使用旧纹理），不可用时在 CPU 上生成
+    /// - Parameter waitUntilCompleted: 是否等待 GPU 生成完成
+    private func generateLUT(waitUntilCompleted: Bool) {
+        lastLUTUpdateTime = CACurrentMediaTime()
+
+        if let computeGenerator {
+            let submitted = computeGenerator.generate(from: profile, waitUntilCompleted: waitUntilCompleted) { [weak self] textures in
+                guard let self else { return }
+                bufferLock.lock()
+                lutTexture = textures.lut1D
+                lut3DTexture = textures.lut3D
+                bufferLock.unlock()
+            }
+            if submitted {
+                return
+            }
+        }
+        generateLUTOnCPU()
+    }
+
+    /// 在 CPU 上生成 LUT 纹理（GPU 生成不可用时的回退）
+    private func generateLUTOnCPU() {
         guard let device else { return }
 
         bufferLock.lock()
@@ -181,6 +250,42 @@ final class ColorCompensationFilter: ColorCompensationFilterProtocol {
         }
 
         lutTexture = texture
+        lut3DTexture = make3DLUTTexture(device: device)
+    }
+
+    /// 创建 3D LUT 纹理
+    /// 只在配置变化时生成并上传一次，合成器在片段着色器中以一次三线性采样完成整条补偿链路
+    private func make3DLUTTexture(device: MTLDevice) -> MTLTexture? {
+        let size = LUTGenerator.lut3DSize
+
+        let descriptor = MTLTextureDescriptor()
+        descriptor.textureType = .type3D
+        descriptor.pixelFormat = .rgba16Float
+        descriptor.width = size
+        descriptor.height = size
+        descriptor.depth = size
+        descriptor.mipmapLevelCount = 1
+        descriptor.usage = [.shaderRead]
+        descriptor.storageMode = .shared
+
+        guard let texture = device.makeTexture(descriptor: descriptor) else {
+            AppLogger.rendering.error("ColorCompensationFilter: 无法创建 3D LUT 纹理")
+            return nil
+        }
+
+        let data = LUTGenerator.convert3DToRGBA16FloatData(LUTGenerator.generate3DLUT(from: profile))
+        data.withUnsafeBytes { rawBuffer in
+            texture.replace(
+                region: MTLRegion(origin: MTLOrigin(x: 0, y: 0, z: 0),
+                                  size: MTLSize(width: size, height: size, depth: size)),
+                mipmapLevel: 0,
+                slice: 0,
+                withBytes: rawBuffer.baseAddress!,
+                bytesPerRow: size * 8, // 4 通道 * 2 字节
+                bytesPerImage: size * size * 8
+            )
+        }
+        return texture
     }
 
     /// 更新 Uniform Buffer
@@ -195,7 +300,7 @@ final class ColorCompensationFilter: ColorCompensationFilterProtocol {
         let buffer = uniformBuffers[currentBufferIndex]
 
         // 写入参数
-        let params = ColorCompensationParams(profile: profile, enabled: isEnabled)
+        let params = ColorCompensationParams(profile: profile, enabled: isEnabled && !isBypassed)
         buffer.contents().storeBytes(of: params, as: ColorCompensationParams.self)
 
         uniformBuffer = buffer
@@ -217,12 +322,28 @@ final class ColorCompensationFilter: ColorCompensationFilterProtocol {
         return lutTexture
     }
 
+    /// 获取 3D LUT 纹理
+    func getLUT3DTexture() -> MTLTexture? {
+        bufferLock.lock()
+        defer { bufferLock.unlock() }
+        return lut3DTexture
+    }
+
+    /// 当前是否实际应用补偿（启用且未临时禁用）
+    var isActive: Bool {
+        bufferLock.lock()
+        defer { bufferLock.unlock() }
+        return isEnabled && !isBypassed
+    }
+
     /// 临时禁用（AB 对比）
     /// - Parameter disabled: 是否禁用
     func setTemporaryBypass(_ bypassed: Bool) {
         bufferLock.lock()
         defer { bufferLock.unlock() }
 
+        isBypassed = bypassed
+
         guard !uniformBuffers.isEmpty else { return }
 
         // 更新当前 Buffer 的 enabled 状态
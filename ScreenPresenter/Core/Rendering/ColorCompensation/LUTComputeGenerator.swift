@@ -0,0 +1,286 @@
+//
+//  LUTComputeGenerator.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  GPU LUT 生成器
+//  用 compute kernel 直接把 1D 曲线与 3D LUT 写入纹理，
+//  拖动颜色补偿滑块时不再在 CPU 上逐格点求值、转换半精度并上传
+//
+
+import Foundation
+import Metal
+
+// MARK: - 生成参数（与 Shader 对应）
+
+/// LUT 生成参数
+/// 必须与 compute kernel 中的结构体内存布局一致
+private struct LUTComputeParams {
+    var gamma: Float
+    var blackLift: Float
+    var whiteClip: Float
+    var rollOff: Float
+    var temperature: Float
+    var tint: Float
+    var saturation: Float
+
+    init(profile: ColorProfile) {
+        gamma = profile.gamma
+        blackLift = profile.blackLift
+        whiteClip = profile.whiteClip
+        rollOff = profile.highlightRollOff
+        temperature = profile.temperature
+        tint = profile.tint
+        saturation = profile.saturation
+    }
+}
+
+// MARK: - GPU LUT 生成器
+
+/// GPU LUT 生成器
+///
+/// 求值逻辑与 LUTGenerator 完全一致（1D 曲线见 generateChannelLUT，3D LUT 见 generate3DLUT），
+/// 修改任一处时必须同步修改另一处；无法创建计算管线时由调用方回退到 LUTGenerator
+final class LUTComputeGenerator {
+    // MARK: - 类型定义
+
+    /// 一组 LUT 纹理
+    struct Textures {
+        /// 1D 曲线（RGBA16Float，lutSize x 1）
+        let lut1D: MTLTexture
+        /// 折叠整条补偿链路的 3D LUT（RGBA16Float，lut3DSize³）
+        let lut3D: MTLTexture
+    }
+
+    // MARK: - 属性
+
+    private let device: MTLDevice
+    private let commandQueue: MTLCommandQueue
+    private let curvePipeline: MTLComputePipelineState
+    private let cubePipeline: MTLComputePipelineState
+
+    // MARK: - 初始化
+
+    init?(device: MTLDevice) {
+        guard let commandQueue = device.makeCommandQueue() else { return nil }
+
+        do {
+            let library = try device.makeLibrary(source: Self.shaderSource, options: nil)
+            guard
+                let curveFunction = library.makeFunction(name: "generateLUT1D"),
+                let cubeFunction = library.makeFunction(name: "generateLUT3D")
+            else {
+                return nil
+            }
+            curvePipeline = try device.makeComputePipelineState(function: curveFunction)
+            cubePipeline = try device.makeComputePipelineState(function: cubeFunction)
+        } catch {
+            AppLogger.rendering.error("LUTComputeGenerator: 编译计算着色器失败: \(error.localizedDescription)")
+            return nil
+        }
+
+        self.device = device
+        self.commandQueue = commandQueue
+    }
+
+    // MARK: - 生成
+
+    /// 在 GPU 上生成一组新的 LUT 纹理
+    ///
+    /// 每次生成新的纹理，不写入正在被渲染读取的旧纹理
+    /// - Parameters:
+    ///   - profile: 颜色补偿配置
+    ///   - waitUntilCompleted: 是否等待生成完成后再返回
+    ///   - completion: 生成完成后调用（同步生成时在当前线程，否则在 GPU 完成回调线程），纹理此时可以安全采样
+    /// - Returns: 是否成功提交
+    @discardableResult
+    func generate(
+        from profile: ColorProfile,
+        waitUntilCompleted: Bool = false,
+        completion: @escaping (Textures) -> Void
+    ) -> Bool {
+        guard
+            let textures = makeTextures(),
+            let commandBuffer = commandQueue.makeCommandBuffer(),
+            let encoder = commandBuffer.makeComputeCommandEncoder()
+        else {
+            return false
+        }
+        commandBuffer.label = "LUT Generation"
+
+        var params = LUTComputeParams(profile: profile)
+
+        // 1. 1D 曲线
+        encoder.setComputePipelineState(curvePipeline)
+        encoder.setTexture(textures.lut1D, index: 0)
+        encoder.setBytes(&params, length: MemoryLayout<LUTComputeParams>.stride, index: 0)
+        encoder.dispatchThreads(
+            MTLSize(width: LUTGenerator.lutSize, height: 1, depth: 1),
+            threadsPerThreadgroup: MTLSize(width: min(curvePipeline.maxTotalThreadsPerThreadgroup, LUTGenerator.lutSize), height: 1, depth: 1)
+        )
+
+        // 2. 3D LUT（采样上一步的曲线，串行编码器保证先后顺序）
+        let size = LUTGenerator.lut3DSize
+        let width = cubePipeline.threadExecutionWidth
+        let height = max(1, min(cubePipeline.maxTotalThreadsPerThreadgroup / width, 8))
+        encoder.setComputePipelineState(cubePipeline)
+        encoder.setTexture(textures.lut3D, index: 0)
+        encoder.setTexture(textures.lut1D, index: 1)
+        encoder.setBytes(&params, length: MemoryLayout<LUTComputeParams>.stride, index: 0)
+        encoder.dispatchThreads(
+            MTLSize(width: size, height: size, depth: size),
+            threadsPerThreadgroup: MTLSize(width: min(width, size), height: height, depth: 1)
+        )
+        encoder.endEncoding()
+
+        let finish = { (buffer: MTLCommandBuffer) in
+            guard buffer.status == .completed else {
+                AppLogger.rendering.error("LUTComputeGenerator: 生成失败: \(buffer.error?.localizedDescription ?? "unknown")")
+                return
+            }
+            completion(textures)
+        }
+
+        // 同步生成时在返回前交付纹理，异步生成时在完成回调中交付
+        if waitUntilCompleted {
+            commandBuffer.commit()
+            commandBuffer.waitUntilCompleted()
+            finish(commandBuffer)
+        } else {
+            commandBuffer.addCompletedHandler(finish)
+            commandBuffer.commit()
+        }
+        return true
+    }
+
+    // MARK: - 私有方法
+
+    private func makeTextures() -> Textures? {
+        let curveDescriptor = MTLTextureDescriptor()
+        curveDescriptor.textureType = .type1D
+        curveDescriptor.pixelFormat = .rgba16Float
+        curveDescriptor.width = LUTGenerator.lutSize
+        curveDescriptor.usage = [.shaderRead, .shaderWrite]
+        curveDescriptor.storageMode = .private
+
+        let size = LUTGenerator.lut3DSize
+        let cubeDescriptor = MTLTextureDescriptor()
+        cubeDescriptor.textureType = .type3D
+        cubeDescriptor.pixelFormat = .rgba16Float
+        cubeDescriptor.width = size
+        cubeDescriptor.height = size
+        cubeDescriptor.depth = size
+        cubeDescriptor.usage = [.shaderRead, .shaderWrite]
+        cubeDescriptor.storageMode = .private
+
+        guard
+            let lut1D = device.makeTexture(descriptor: curveDescriptor),
+            let lut3D = device.makeTexture(descriptor: cubeDescriptor)
+        else {
+            AppLogger.rendering.error("LUTComputeGenerator: 无法创建 LUT 纹理")
+            return nil
+        }
+        return Textures(lut1D: lut1D, lut3D: lut3D)
+    }
+
+    // MARK: - 着色器
+
+    private static let shaderSource = """
+    #include <metal_stdlib>
+    using namespace metal;
+
+    struct LUTComputeParams {
+        float gamma;
+        float blackLift;
+        float whiteClip;
+        float rollOff;
+        float temperature;
+        float tint;
+        float saturation;
+    };
+
+    float srgbToLinear(float c) {
+        return (c <= 0.04045) ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4);
+    }
+
+    float linearToSrgb(float c) {
+        return (c <= 0.0031308) ? c * 12.92 : 1.055 * pow(c, 1.0 / 2.4) - 0.055;
+    }
+
+    // 单通道曲线（与 LUTGenerator.generateChannelLUT 一致）
+    kernel void generateLUT1D(texture1d<float, access::write> lut [[texture(0)]],
+                              constant LUTComputeParams &params [[buffer(0)]],
+                              uint index [[thread_position_in_grid]]) {
+        uint size = lut.get_width();
+        if (index >= size) {
+            return;
+        }
+
+        float x = float(index) / float(size - 1);
+
+        // 1. Gamma
+        if (params.gamma != 1.0 && x > 0.0) {
+            x = pow(x, params.gamma);
+        }
+
+        // 2. Black Lift
+        if (params.blackLift != 0.0) {
+            x = x * (1.0 - params.blackLift) + params.blackLift;
+        }
+
+        // 3. Highlight Roll-off（指数衰减）
+        if (params.rollOff > 0.0 && x > 1.0 - params.rollOff) {
+            float threshold = 1.0 - params.rollOff;
+            float t = (x - threshold) / params.rollOff;
+            x = threshold + params.rollOff * (1.0 - exp(-t * 2.0)) / (1.0 - exp(-2.0));
+        }
+
+        // 4. White Clip
+        x = min(x, params.whiteClip);
+
+        // 5. 钳位
+        x = saturate(x);
+        lut.write(float4(x, x, x, 1.0), index);
+    }
+
+    // 3D LUT：把整条补偿链路求值到格点上（与 LUTGenerator.generate3DLUT 一致）
+    kernel void generateLUT3D(texture3d<float, access::write> lut [[texture(0)]],
+                              texture1d<float> curve [[texture(1)]],
+                              constant LUTComputeParams &params [[buffer(0)]],
+                              uint3 gid [[thread_position_in_grid]]) {
+        uint size = lut.get_width();
+        if (any(gid >= size)) {
+            return;
+        }
+
+        // 与渲染时 1D 纹理的线性采样一致
+        constexpr sampler curveSampler(filter::linear, address::clamp_to_edge);
+
+        float3 color = float3(gid) / float(size - 1);
+
+        // 1. sRGB -> Linear
+        color = float3(srgbToLinear(color.r), srgbToLinear(color.g), srgbToLinear(color.b));
+
+        // 2. 应用 1D 曲线
+        color = float3(curve.sample(curveSampler, color.r).r,
+                       curve.sample(curveSampler, color.g).g,
+                       curve.sample(curveSampler, color.b).b);
+
+        // 3. 应用色温/色调
+        color.r += params.temperature * 0.1;
+        color.b -= params.temperature * 0.1;
+        color.g += params.tint * 0.05;
+        color = saturate(color);
+
+        // 4. 应用饱和度
+        float luma = dot(color, float3(0.2126, 0.7152, 0.0722));
+        color = mix(float3(luma), color, params.saturation);
+
+        // 5. Linear -> sRGB
+        color = float3(linearToSrgb(color.r), linearToSrgb(color.g), linearToSrgb(color.b));
+
+        lut.write(float4(max(color, 0.0), 1.0), gid);
+    }
+    """
+}
@@ -4,20 +4,25 @@
 //
 //  Created by Sun on 2026/1/4.
 //
-//  1D LUT 生成器
-//  根据 ColorProfile 参数生成 256 级查找表
+//  LUT 生成器
+//  根据 ColorProfile 参数生成 256 级 1D 查找表，以及折叠整条补偿链路的 3D 查找表
 //
 
 import Foundation
+import simd
 
 // MARK: - LUT 生成器
 
 /// 1D LUT 生成器
 /// 根据 ColorProfile 的亮度曲线参数生成 R/G/B 三通道的 256 级查找表
+/// 这是 CPU 实现，滤镜优先使用 LUTComputeGenerator 在 GPU 上生成，两者的求值逻辑必须保持一致
 enum LUTGenerator {
     /// LUT 长度（256 级，对应 8-bit 输入）
     static let lutSize = 256
 
+    /// 3D LUT 每个维度的格点数（33 级，配合三线性插值足以覆盖 8-bit 输入）
+    static let lut3DSize = 33
+
     // MARK: - 生成方法
 
     /// 根据 ColorProfile 生成三通道 LUT
@@ -87,6 +92,72 @@ enum LUTGenerator {
         return lut
     }
 
+    /// 根据 ColorProfile 生成 3D LUT
+    /// 把着色器中的整条补偿链路（sRGB → 线性、1D 曲线、色温/色调、饱和度、线性 → sRGB）预先求值到格点上，
+    /// 渲染时只需一次三线性采样
+    /// - Parameter profile: 颜色补偿配置
+    /// - Returns: RGBA 交错的 Float 数组，按 R 最快、B 最慢的顺序排列，共 lut3DSize³ 个格点
+    static func generate3DLUT(from profile: ColorProfile) -> [Float] {
+        let luts = generateLUT(from: profile)
+        let size = lut3DSize
+        var lut = [Float](repeating: 1, count: size * size * size * 4)
+
+        for b in 0 ..< size {
+            for g in 0 ..< size {
+                for r in 0 ..< size {
+                    var color = SIMD3<Float>(Float(r), Float(g), Float(b)) / Float(size - 1)
+
+                    // 1. sRGB -> Linear
+                    color = SIMD3(srgbToLinear(color.x), srgbToLinear(color.y), srgbToLinear(color.z))
+
+                    // 2. 应用 1D LUT
+                    color = SIMD3(
+                        sampleLUT(luts.r, at: color.x),
+                        sampleLUT(luts.g, at: color.y),
+                        sampleLUT(luts.b, at: color.z)
+                    )
+
+                    // 3. 应用色温/色调
+                    color.x += profile.temperature * 0.1
+                    color.z -= profile.temperature * 0.1
+                    color.y += profile.tint * 0.05
+                    color = simd_clamp(color, SIMD3(repeating: 0), SIMD3(repeating: 1))
+
+                    // 4. 应用饱和度
+                    let luma = simd_dot(color, SIMD3<Float>(0.2126, 0.7152, 0.0722))
+                    color = simd_mix(SIMD3(repeating: luma), color, SIMD3(repeating: profile.saturation))
+
+                    // 5. Linear -> sRGB
+                    color = SIMD3(linearToSrgb(color.x), linearToSrgb(color.y), linearToSrgb(color.z))
+
+                    let index = ((b * size + g) * size + r) * 4
+                    lut[index] = color.x
+                    lut[index + 1] = color.y
+                    lut[index + 2] = color.z
+                }
+            }
+        }
+
+        return lut
+    }
+
+    /// 以与着色器 1D 纹理线性采样相同的方式读取 LUT（纹素中心位于 (i + 0.5) / n）
+    private static func sampleLUT(_ lut: [Float], at x: Float) -> Float {
+        let position = min(max(x * Float(lut.count) - 0.5, 0), Float(lut.count - 1))
+        let lower = Int(position)
+        let upper = min(lower + 1, lut.count - 1)
+        let t = position - Float(lower)
+        return lut[lower] + (lut[upper] - lut[lower]) * t
+    }
+
+    private static func srgbToLinear(_ c: Float) -> Float {
+        c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4)
+    }
+
+    private static func linearToSrgb(_ c: Float) -> Float {
+        c <= 0.0031308 ? c * 12.92 : 1.055 * pow(c, 1.0 / 2.4) - 0.055
+    }
+
     // MARK: - 验证方法
 
     /// 验证 LUT 是否单调递增（非严格）
@@ -189,4 +260,17 @@ extension LUTGenerator {
         }
         return data
     }
+
+    /// 将 3D LUT 转换为 RGBA16Float 格式数据
+    /// - Parameter lut: generate3DLUT 生成的 RGBA 交错数组
+    /// - Returns: RGBA16Float 格式数据，可直接上传为 lut3DSize³ 的 3D 纹理
+    static func convert3DToRGBA16FloatData(_ lut: [Float]) -> Data {
+        precondition(lut.count == lut3DSize * lut3DSize * lut3DSize * 4)
+
+        var halfs = [UInt16](repeating: 0, count: lut.count)
+        for i in 0 ..< lut.count {
+            halfs[i] = float16FromFloat32(max(0, lut[i]))
+        }
+        return halfs.withUnsafeBytes { Data($0) }
+    }
 }
@@ -0,0 +1,184 @@
+//
+//  DecodeScheduler.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  解码调度器
+//  所有 VideoToolboxDecoder 共享，按窗口焦点与可见性为每个解码器分配优先级类别，
+//  让多设备同时解码时硬件解码器优先服务用户正在看的设备
+//
+//  调度规则（只降级优先级低于当前最高优先级的解码器）:
+//  - 最高优先级: 不限制
+//  - visible: 关闭实时调度，由 VideoToolbox 降低其优先级
+//  - hidden: 关闭实时调度；更高优先级的解码器出现积压时只解码关键帧，积压消除后保持一段时间再恢复
+//
+//  说明：H.264/H.265 的非关键帧多为参考帧，解码端无法跳帧降低帧率而不花屏，
+//  visible 的降速通过 VideoToolbox 的调度优先级实现，帧率上限仍由编码端（码流自适应）决定
+//
+
+import Foundation
+import os.lock
+
+// MARK: - 解码优先级
+
+/// 解码优先级
+enum DecodePriority: Int, Comparable {
+    /// 不可见（窗口被遮挡或设备处于热备）
+    case hidden = 0
+    /// 可见但窗口不是焦点
+    case visible = 1
+    /// 窗口为焦点
+    case focused = 2
+
+    static func < (lhs: DecodePriority, rhs: DecodePriority) -> Bool {
+        lhs.rawValue < rhs.rawValue
+    }
+
+    var description: String {
+        switch self {
+        case .hidden: "不可见"
+        case .visible: "可见"
+        case .focused: "焦点"
+        }
+    }
+}
+
+// MARK: - 解码调度结果
+
+/// 调度器分配给单个解码器的限制
+struct DecodeSchedule: Equatable {
+    /// 是否允许按实时播放调度
+    var allowsRealTime: Bool
+
+    /// 是否只解码关键帧
+    var keyFrameOnly: Bool
+
+    /// 不做任何限制
+    static let unrestricted = DecodeSchedule(allowsRealTime: true, keyFrameOnly: false)
+}
+
+// MARK: - 解码调度器
+
+/// 解码调度器
+///
+/// 线程安全：
+/// - 所有方法可在任意线程调用，解码器的积压报告来自各自的解码队列
+/// - 调度结果在调度器的锁外应用到解码器
+final class DecodeScheduler: @unchecked Sendable {
+    // MARK: - Singleton
+
+    static let shared = DecodeScheduler()
+
+    // MARK: - 常量
+
+    /// 积压消除后保持降级的时间（秒），避免在临界负载下反复切换
+    static let saturationHoldTime: TimeInterval = 3
+
+    // MARK: - 类型定义
+
+    private struct Entry {
+        weak var decoder: VideoToolboxDecoder?
+        var priority: DecodePriority
+        var isBacklogged = false
+        var schedule = DecodeSchedule.unrestricted
+    }
+
+    private struct State {
+        var entries: [ObjectIdentifier: Entry] = [:]
+        /// 最近一次积压消除后，降级保持到的时间
+        var saturatedUntil: CFAbsoluteTime = 0
+    }
+
+    // MARK: - 属性
+
+    private let state = OSAllocatedUnfairLock(initialState: State())
+
+    /// 积压保持期结束后重新调度
+    private let queue = DispatchQueue(label: "com.screenPresenter.decodeScheduler", qos: .userInitiated)
+
+    // MARK: - 初始化
+
+    private init() {}
+
+    // MARK: - 注册
+
+    /// 注册解码器
+    func register(_ decoder: VideoToolboxDecoder, priority: DecodePriority) {
+        state.withLock {
+            $0.entries[ObjectIdentifier(decoder)] = Entry(decoder: decoder, priority: priority)
+        }
+        reschedule()
+    }
+
+    /// 注销解码器
+    func unregister(_ decoder: VideoToolboxDecoder) {
+        state.withLock {
+            _ = $0.entries.removeValue(forKey: ObjectIdentifier(decoder))
+        }
+        reschedule()
+    }
+
+    /// 更新解码器的优先级
+    func setPriority(_ priority: DecodePriority, for decoder: VideoToolboxDecoder) {
+        let changed = state.withLock { state -> Bool in
+            let key = ObjectIdentifier(decoder)
+            guard state.entries[key]?.priority != priority else { return false }
+            state.entries[key]?.priority = priority
+            return true
+        }
+        guard changed else { return }
+        reschedule()
+    }
+
+    /// 报告解码积压变化（只在越过阈值时调用）
+    func reportBacklog(_ isBacklogged: Bool, for decoder: VideoToolboxDecoder) {
+        state.withLock { state in
+            let key = ObjectIdentifier(decoder)
+            state.entries[key]?.isBacklogged = isBacklogged
+            if !isBacklogged {
+                state.saturatedUntil = CFAbsoluteTimeGetCurrent() + Self.saturationHoldTime
+            }
+        }
+        reschedule()
+
+        if !isBacklogged {
+            queue.asyncAfter(deadline: .now() + Self.saturationHoldTime) { [weak self] in
+                self?.reschedule()
+            }
+        }
+    }
+
+    // MARK: - 调度
+
+    private func reschedule() {
+        let now = CFAbsoluteTimeGetCurrent()
+        let changes = state.withLock { state -> [(VideoToolboxDecoder, DecodeSchedule)] in
+            state.entries = state.entries.filter { $0.value.decoder != nil }
+
+            let topPriority = state.entries.values.map(\.priority).max() ?? .focused
+            // 可见的解码器出现积压（或仍在保持期内）时，硬件已经饱和
+            let isSaturated = state.entries.values.contains { $0.priority > .hidden && $0.isBacklogged }
+                || now < state.saturatedUntil
+
+            var changes: [(VideoToolboxDecoder, DecodeSchedule)] = []
+            for (key, entry) in state.entries {
+                let schedule: DecodeSchedule = if entry.priority == topPriority {
+                    .unrestricted
+                } else if entry.priority == .hidden {
+                    DecodeSchedule(allowsRealTime: false, keyFrameOnly: isSaturated)
+                } else {
+                    DecodeSchedule(allowsRealTime: false, keyFrameOnly: false)
+                }
+                guard schedule != entry.schedule, let decoder = entry.decoder else { continue }
+                state.entries[key]?.schedule = schedule
+                changes.append((decoder, schedule))
+            }
+            return changes
+        }
+
+        for (decoder, schedule) in changes {
+            decoder.applySchedule(schedule)
+        }
+    }
+}
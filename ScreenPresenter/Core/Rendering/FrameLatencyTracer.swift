@@ -0,0 +1,339 @@
+//
+//  FrameLatencyTracer.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/9.
+//
+//  帧延迟追踪器
+//  以帧 ID（码流 PTS，微秒）串联每一帧从 socket 接收到屏幕呈现的各个阶段
+//  每帧一个 os_signpost 区间，可在 Instruments 中逐帧查看；同时聚合为各阶段的延迟直方图
+//
+//  阶段:
+//  接收 → 解析 → 提交解码 → 解码输出 → 推入帧缓冲 → 渲染消费 → 呈现
+//
+
+import CoreMedia
+import CoreVideo
+import Foundation
+import os
+import QuartzCore
+
+// MARK: - 延迟阶段
+
+/// 帧在管道中经过的阶段（按时间顺序）
+enum FrameLatencyStage: Int, CaseIterable {
+    /// 帧的首个数据块到达 socket
+    case receive
+    /// 解析出完整的视频包
+    case parse
+    /// 提交给 VideoToolbox 解码
+    case decodeSubmit
+    /// VideoToolbox 输出回调
+    case decodeOutput
+    /// 推入帧缓冲
+    case bufferPush
+    /// 被渲染线程从帧缓冲中取出
+    case renderConsume
+    /// 上屏（drawable 的实际呈现时间）
+    case present
+
+    /// 显示名称（以到达该阶段的区间命名）
+    var name: String {
+        switch self {
+        case .receive: "接收"
+        case .parse: "解析"
+        case .decodeSubmit: "排队"
+        case .decodeOutput: "解码"
+        case .bufferPush: "分发"
+        case .renderConsume: "等待"
+        case .present: "呈现"
+        }
+    }
+}
+
+// MARK: - 延迟直方图
+
+/// 延迟直方图
+/// 按 2 的幂划分毫秒区间：[0, 1)、[1, 2)、[2, 4) … [128, 256)、[256, ∞)
+struct FrameLatencyHistogram {
+    /// 区间数量
+    static let bucketCount = 10
+
+    /// 各区间的样本数
+    private(set) var buckets = [Int](repeating: 0, count: bucketCount)
+
+    /// 样本数
+    private(set) var count = 0
+
+    /// 样本总和（毫秒）
+    private(set) var total: Double = 0
+
+    /// 最大值（毫秒）
+    private(set) var maximum: Double = 0
+
+    /// 平均值（毫秒）
+    var average: Double {
+        count > 0 ? total / Double(count) : 0
+    }
+
+    /// 记录一个样本
+    /// - Parameter milliseconds: 延迟（毫秒）
+    mutating func record(_ milliseconds: Double) {
+        let value = max(0, milliseconds)
+        buckets[Self.bucketIndex(for: value)] += 1
+        count += 1
+        total += value
+        maximum = max(maximum, value)
+    }
+
+    /// 估算百分位数（在所在区间内线性插值）
+    /// - Parameter percentile: 百分位（0...1）
+    /// - Returns: 延迟（毫秒）
+    func percentile(_ percentile: Double) -> Double {
+        guard count > 0 else { return 0 }
+
+        let rank = percentile * Double(count)
+        var accumulated = 0
+        for (index, bucketCount) in buckets.enumerated() where bucketCount > 0 {
+            if Double(accumulated + bucketCount) >= rank {
+                let lower = Self.lowerBound(ofBucket: index)
+                let upper = min(Self.upperBound(ofBucket: index), maximum)
+                let fraction = (rank - Double(accumulated)) / Double(bucketCount)
+                return lower + (max(upper, lower) - lower) * fraction
+            }
+            accumulated += bucketCount
+        }
+        return maximum
+    }
+
+    /// 区间下界（毫秒）
+    static func lowerBound(ofBucket index: Int) -> Double {
+        index == 0 ? 0 : Double(1 << (index - 1))
+    }
+
+    /// 区间上界（毫秒），最后一个区间无上界
+    static func upperBound(ofBucket index: Int) -> Double {
+        index == bucketCount - 1 ? .infinity : Double(1 << index)
+    }
+
+    private static func bucketIndex(for milliseconds: Double) -> Int {
+        guard milliseconds >= 1 else { return 0 }
+        return min(Int(log2(milliseconds)) + 1, bucketCount - 1)
+    }
+}
+
+// MARK: - 延迟快照
+
+/// 延迟统计快照
+struct FrameLatencySnapshot {
+    /// 各阶段的耗时（从上一个阶段到该阶段），不含 receive
+    let stages: [(stage: FrameLatencyStage, histogram: FrameLatencyHistogram)]
+
+    /// 接收到呈现的总延迟
+    let total: FrameLatencyHistogram
+
+    /// 未呈现就被新帧取代的帧数
+    let droppedCount: Int
+
+    /// 已呈现的帧数
+    var presentedCount: Int {
+        total.count
+    }
+
+    /// 单行摘要（用于日志）
+    var summary: String {
+        let stageSummary = stages
+            .map { String(format: "%@ %.1f", $0.stage.name, $0.histogram.average) }
+            .joined(separator: " · ")
+        return String(
+            format: "总延迟 p50 %.1fms p95 %.1fms max %.1fms（%@），呈现 %d 帧，丢弃 %d 帧",
+            total.percentile(0.5),
+            total.percentile(0.95),
+            total.maximum,
+            stageSummary,
+            presentedCount,
+            droppedCount
+        )
+    }
+}
+
+// MARK: - 帧延迟追踪器
+
+/// 帧延迟追踪器
+///
+/// 使用方式:
+/// - 解析出视频包后调用 begin(frameID:receivedAt:) 开始追踪
+/// - 后续各阶段调用 mark(_:frameID:at:)；解码器输出的像素缓冲通过附件携带帧 ID
+/// - 呈现时调用 markPresented(frameID:at:)，结束 signpost 区间并计入直方图
+///
+/// 码流不含 B 帧，PTS 单调递增：一帧呈现时，所有更早的在途帧都已被帧缓冲跳过，按丢弃处理
+/// 在途帧数有上限，超出时丢弃最早的帧，保证未呈现的帧不会无限累积
+///
+/// 线程安全：所有方法都可在任意线程调用
+final class FrameLatencyTracer {
+    // MARK: - 常量
+
+    /// 最大在途帧数
+    static let maxInFlightFrames = 64
+
+    /// 像素缓冲上携带帧 ID 的附件键
+    private static let frameIDAttachmentKey = "com.screenPresenter.frameLatencyID" as CFString
+
+    // MARK: - 类型定义
+
+    /// 在途帧
+    private struct InFlightFrame {
+        /// 各阶段的时间戳（秒，主机时钟），未到达的阶段为 nil
+        var timestamps = [CFTimeInterval?](repeating: nil, count: FrameLatencyStage.allCases.count)
+        /// signpost 区间
+        let signpostState: OSSignpostIntervalState
+    }
+
+    /// 追踪状态
+    private struct State {
+        var inFlight: [Int64: InFlightFrame] = [:]
+        var stages = [FrameLatencyHistogram](repeating: FrameLatencyHistogram(), count: FrameLatencyStage.allCases.count)
+        var total = FrameLatencyHistogram()
+        var droppedCount = 0
+    }
+
+    // MARK: - 属性
+
+    private let signposter = OSSignposter(
+        subsystem: Bundle.main.bundleIdentifier ?? "com.haptictide.ScreenPresenter",
+        category: "FrameLatency"
+    )
+
+    private let state = OSAllocatedUnfairLock(initialState: State())
+
+    // MARK: - 帧 ID
+
+    /// 由显示时间戳生成帧 ID（微秒）
+    static func frameID(for presentationTime: CMTime) -> Int64? {
+        guard presentationTime.isNumeric else { return nil }
+        return CMTimeConvertScale(presentationTime, timescale: 1_000_000, method: .roundTowardZero).value
+    }
+
+    /// 将帧 ID 附加到像素缓冲
+    static func attachFrameID(_ frameID: Int64, to pixelBuffer: CVPixelBuffer) {
+        CVBufferSetAttachment(pixelBuffer, frameIDAttachmentKey, NSNumber(value: frameID), .shouldNotPropagate)
+    }
+
+    /// 读取像素缓冲携带的帧 ID
+    static func frameID(of pixelBuffer: CVPixelBuffer) -> Int64? {
+        guard let value = CVBufferCopyAttachment(pixelBuffer, frameIDAttachmentKey, nil) as? NSNumber else {
+            return nil
+        }
+        return value.int64Value
+    }
+
+    // MARK: - 追踪
+
+    /// 开始追踪一帧（在解析出视频包后调用，同时记录解析阶段）
+    /// - Parameters:
+    ///   - frameID: 帧 ID
+    ///   - receiveTime: 帧的首个数据块到达时间（CACurrentMediaTime）
+    func begin(frameID: Int64, receivedAt receiveTime: CFTimeInterval) {
+        let now = CACurrentMediaTime()
+        let signpostState = signposter.beginInterval("Frame", id: signpostID(for: frameID), "pts \(frameID)")
+
+        var frame = InFlightFrame(signpostState: signpostState)
+        frame.timestamps[FrameLatencyStage.receive.rawValue] = receiveTime
+        frame.timestamps[FrameLatencyStage.parse.rawValue] = now
+
+        let evicted: [InFlightFrame] = state.withLock { state in
+            let replaced = state.inFlight.updateValue(frame, forKey: frameID)
+            var evicted = replaced.map { [$0] } ?? []
+            while state.inFlight.count > Self.maxInFlightFrames, let oldest = state.inFlight.keys.min() {
+                if let frame = state.inFlight.removeValue(forKey: oldest) {
+                    evicted.append(frame)
+                }
+            }
+            state.droppedCount += evicted.count
+            return evicted
+        }
+        endDropped(evicted)
+    }
+
+    /// 记录一帧到达某个阶段
+    /// - Parameters:
+    ///   - stage: 阶段
+    ///   - frameID: 帧 ID
+    ///   - time: 到达时间（CACurrentMediaTime）
+    func mark(_ stage: FrameLatencyStage, frameID: Int64, at time: CFTimeInterval = CACurrentMediaTime()) {
+        let isTracked = state.withLock { state in
+            guard state.inFlight[frameID] != nil else { return false }
+            state.inFlight[frameID]?.timestamps[stage.rawValue] = time
+            return true
+        }
+        guard isTracked else { return }
+        signposter.emitEvent("Stage", id: signpostID(for: frameID), "\(stage.name, privacy: .public)")
+    }
+
+    /// 记录一帧已呈现，结束追踪
+    /// - Parameters:
+    ///   - frameID: 帧 ID
+    ///   - time: 呈现时间（CACurrentMediaTime 时基）
+    func markPresented(frameID: Int64, at time: CFTimeInterval) {
+        let result: (frame: InFlightFrame, dropped: [InFlightFrame])? = state.withLock { state in
+            guard var frame = state.inFlight.removeValue(forKey: frameID) else { return nil }
+            frame.timestamps[FrameLatencyStage.present.rawValue] = time
+
+            // 相邻已记录阶段之间的耗时计入后一个阶段
+            var previous = frame.timestamps[FrameLatencyStage.receive.rawValue]
+            for stage in FrameLatencyStage.allCases.dropFirst() {
+                guard let timestamp = frame.timestamps[stage.rawValue] else { continue }
+                if let previous {
+                    state.stages[stage.rawValue].record((timestamp - previous) * 1000)
+                }
+                previous = timestamp
+            }
+            if let receiveTime = frame.timestamps[FrameLatencyStage.receive.rawValue] {
+                state.total.record((time - receiveTime) * 1000)
+            }
+
+            // 更早的在途帧已被跳过
+            let droppedIDs = state.inFlight.keys.filter { $0 < frameID }
+            let dropped = droppedIDs.compactMap { state.inFlight.removeValue(forKey: $0) }
+            state.droppedCount += dropped.count
+            return (frame, dropped)
+        }
+        guard let result else { return }
+
+        signposter.endInterval("Frame", result.frame.signpostState, "presented")
+        endDropped(result.dropped)
+    }
+
+    /// 清空在途帧与统计
+    func reset() {
+        let inFlight = state.withLock { state in
+            let inFlight = Array(state.inFlight.values)
+            state = State()
+            return inFlight
+        }
+        endDropped(inFlight)
+    }
+
+    /// 获取统计快照
+    func snapshot() -> FrameLatencySnapshot {
+        state.withLock { state in
+            FrameLatencySnapshot(
+                stages: FrameLatencyStage.allCases.dropFirst().map { ($0, state.stages[$0.rawValue]) },
+                total: state.total,
+                droppedCount: state.droppedCount
+            )
+        }
+    }
+
+    // MARK: - 私有方法
+
+    private func signpostID(for frameID: Int64) -> OSSignpostID {
+        OSSignpostID(UInt64(bitPattern: frameID))
+    }
+
+    private func endDropped(_ frames: [InFlightFrame]) {
+        for frame in frames {
+            signposter.endInterval("Frame", frame.signpostState, "dropped")
+        }
+    }
+}
@@ -10,13 +10,16 @@
 //  设计理念:
 //  1. FrameSource: 帧生产者（解码器产出帧）
 //  2. FrameSink: 帧消费者（渲染器接收帧）
-//  3. FrameBuffer: 单帧缓冲，实现"最新帧优先"策略
+//  3. FrameBuffer: 无锁三缓冲，实现"最新帧优先"策略
 //  4. 事件合并: 避免主线程任务堆积
+//  5. 静止帧: 与上一帧内容相同的帧不分发，画面静止时渲染与缩略图不做任何工作
 //
 
 import AVFoundation
 import CoreVideo
+import FBDeviceControlKit
 import Foundation
+import os.lock
 
 // MARK: - 帧数据
 
@@ -84,68 +87,117 @@ protocol FrameSource: AnyObject {
     func pushToSinks(_ frame: VideoFrame) -> Bool
 }
 
+// MARK: - 帧消费者快照
+
+/// 不可变的帧消费者快照
+/// 添加/移除消费者时整体替换，推帧时无需加锁；单个消费者是最常见的情况，单独存放以免遍历数组
+private final class FrameSinkSnapshot {
+    enum Storage {
+        case empty
+        case single(FrameSink)
+        case multiple([FrameSink])
+    }
+
+    let storage: Storage
+
+    /// 快照中的消费者
+    var sinks: [FrameSink] {
+        switch storage {
+        case .empty:
+            []
+        case let .single(sink):
+            [sink]
+        case let .multiple(sinks):
+            sinks
+        }
+    }
+
+    init(sinks: [FrameSink]) {
+        switch sinks.count {
+        case 0:
+            storage = .empty
+        case 1:
+            storage = .single(sinks[0])
+        default:
+            storage = .multiple(sinks)
+        }
+    }
+}
+
 // MARK: - 帧生产者默认实现
 
 /// 帧生产者基类
 /// 管理多个帧消费者，实现广播分发
+///
+/// 线程安全：
+/// - 消费者列表以不可变快照发布（RCU 风格），推帧只需一次原子读取，不加锁
+/// - addSink / removeSink 之间由锁串行化，构建新快照后原子替换
 class BaseFrameSource: FrameSource {
     /// 最大消费者数量（与 scrcpy 一致）
     static let maxSinks = 2
 
-    /// 注册的帧消费者
-    private(set) var sinks: [FrameSink] = []
+    /// 当前消费者快照
+    private let snapshot = FBAtomicSnapshot(snapshot: FrameSinkSnapshot(sinks: []))
 
-    /// 线程锁
-    private let lock = NSLock()
+    /// 写入锁（只串行化添加/移除，推帧不使用）
+    private let writeLock = NSLock()
+
+    /// 读取当前快照
+    private var currentSnapshot: FrameSinkSnapshot {
+        unsafeDowncast(snapshot.load() as AnyObject, to: FrameSinkSnapshot.self)
+    }
+
+    /// 注册的帧消费者
+    var sinks: [FrameSink] {
+        currentSnapshot.sinks
+    }
 
     /// 添加帧消费者
     func addSink(_ sink: FrameSink) {
-        lock.lock()
-        defer { lock.unlock() }
+        writeLock.lock()
+        defer { writeLock.unlock() }
 
-        guard sinks.count < Self.maxSinks else {
+        var newSinks = currentSnapshot.sinks
+        guard newSinks.count < Self.maxSinks else {
             AppLogger.rendering.warning("帧消费者数量已达上限: \(Self.maxSinks)")
             return
         }
 
-        sinks.append(sink)
-        AppLogger.rendering.info("添加帧消费者，当前数量: \(sinks.count)")
+        newSinks.append(sink)
+        snapshot.store(FrameSinkSnapshot(sinks: newSinks))
+        AppLogger.rendering.info("添加帧消费者，当前数量: \(newSinks.count)")
     }
 
     /// 移除帧消费者
     func removeSink(_ sink: FrameSink) {
-        lock.lock()
-        defer { lock.unlock() }
+        writeLock.lock()
+        defer { writeLock.unlock() }
 
-        sinks.removeAll { $0 === sink }
-        AppLogger.rendering.info("移除帧消费者，剩余数量: \(sinks.count)")
+        var newSinks = currentSnapshot.sinks
+        newSinks.removeAll { $0 === sink }
+        snapshot.store(FrameSinkSnapshot(sinks: newSinks))
+        AppLogger.rendering.info("移除帧消费者，剩余数量: \(newSinks.count)")
     }
 
     /// 向所有消费者推送帧
     @discardableResult
     func pushToSinks(_ frame: VideoFrame) -> Bool {
-        lock.lock()
-        let currentSinks = sinks
-        lock.unlock()
-
-        guard !currentSinks.isEmpty else {
+        switch currentSnapshot.storage {
+        case .empty:
             return true
-        }
-
-        for sink in currentSinks {
-            if !sink.push(frame) {
+        case let .single(sink):
+            return sink.push(frame)
+        case let .multiple(sinks):
+            for sink in sinks where !sink.push(frame) {
                 return false
             }
+            return true
         }
-
-        return true
     }
 
     /// 打开所有消费者
     func openSinks(size: CGSize) -> Bool {
-        lock.lock()
         let currentSinks = sinks
-        lock.unlock()
 
         for (index, sink) in currentSinks.enumerated() {
             if !sink.open(size: size) {
@@ -162,11 +214,7 @@ class BaseFrameSource: FrameSource {
 
     /// 关闭所有消费者
     func closeSinks() {
-        lock.lock()
-        let currentSinks = sinks
-        lock.unlock()
-
-        for sink in currentSinks {
+        for sink in sinks {
             sink.close()
         }
     }
@@ -191,6 +239,9 @@ final class BufferedFrameSink: FrameSink {
     /// 新帧可用时的回调（在解码线程调用）
     var onFrameAvailable: FrameAvailableCallback?
 
+    /// 帧延迟追踪器（可选，记录推入与消费阶段）
+    var latencyTracer: FrameLatencyTracer?
+
     /// 是否有待处理的渲染请求（事件合并标志）
     /// 使用 OSAtomicInt32 实现原子操作
     private var pendingEvent: Int32 = 0
@@ -232,6 +283,10 @@ final class BufferedFrameSink: FrameSink {
     func push(_ frame: VideoFrame) -> Bool {
         guard isOpen else { return false }
 
+        if let tracer = latencyTracer, let frameID = FrameLatencyTracer.frameID(of: frame.pixelBuffer) {
+            tracer.mark(.bufferPush, frameID: frameID)
+        }
+
         // 推送到帧缓冲
         let previousSkipped = frameBuffer.push(frame.pixelBuffer)
 
@@ -270,6 +325,10 @@ final class BufferedFrameSink: FrameSink {
             return nil
         }
 
+        if let tracer = latencyTracer, let frameID = FrameLatencyTracer.frameID(of: pixelBuffer) {
+            tracer.mark(.renderConsume, frameID: frameID)
+        }
+
         renderedFrameCount += 1
         return pixelBuffer
     }
@@ -298,19 +357,187 @@ final class BufferedFrameSink: FrameSink {
     }
 }
 
+// MARK: - 空闲感知 Display Link
+
+/// 按需驱动的 CVDisplayLink
+/// 每次 vsync 调用 onTick，由回调返回本次是否有待渲染的内容
+/// 连续空闲 idleFrameLimit 帧后停止 display link，直到 wake() 被调用（新帧到达、布局变化）时再重新启动
+/// 静态画面下不再每个 vsync 唤醒渲染线程，降低长时间演示时的功耗与发热
+///
+/// 线程安全：
+/// - start() / stop() 由持有者调用（通常为主线程）
+/// - wake() 可在任意线程调用，未暂停时只是一次无竞争的加锁
+/// - display link 的启停统一在 controlQueue 上串行执行，避免在 display link 回调线程中调用 CVDisplayLinkStop
+final class IdleAwareDisplayLink {
+    // MARK: - 类型定义
+
+    private struct State {
+        /// start() 已调用
+        var isStarted = false
+        /// display link 因空闲而停止
+        var isPaused = false
+        /// 已请求暂停，尚未在 controlQueue 上执行
+        var isPausePending = false
+        /// 连续空闲帧数
+        var idleFrames = 0
+    }
+
+    // MARK: - 属性
+
+    /// vsync 回调（在 CVDisplayLink 线程调用），返回本次是否有待渲染的内容
+    var onTick: (() -> Bool)?
+
+    /// 连续空闲多少帧后暂停
+    let idleFrameLimit: Int
+
+    /// 是否因空闲而暂停
+    var isPaused: Bool {
+        state.withLock { $0.isPaused }
+    }
+
+    private var displayLink: CVDisplayLink?
+    private let state = OSAllocatedUnfairLock(initialState: State())
+    private let controlQueue = DispatchQueue(label: "com.screenPresenter.displayLinkControl", qos: .userInteractive)
+
+    // MARK: - 初始化
+
+    /// - Parameter idleFrameLimit: 连续空闲多少帧后暂停（默认约半秒）
+    init(idleFrameLimit: Int = 30) {
+        self.idleFrameLimit = idleFrameLimit
+    }
+
+    deinit {
+        if let displayLink {
+            CVDisplayLinkStop(displayLink)
+        }
+    }
+
+    // MARK: - 控制
+
+    /// 创建并启动 display link
+    /// - Parameter displayID: 绑定的显示器，nil 时使用当前活跃显示器
+    /// - Returns: 是否启动成功
+    @discardableResult
+    func start(displayID: CGDirectDisplayID? = nil) -> Bool {
+        controlQueue.sync {
+            guard displayLink == nil else { return true }
+
+            var link: CVDisplayLink?
+            CVDisplayLinkCreateWithActiveCGDisplays(&link)
+            guard let link else {
+                AppLogger.rendering.error("无法创建 CVDisplayLink")
+                return false
+            }
+
+            let callback: CVDisplayLinkOutputCallback = { _, _, _, _, _, userInfo -> CVReturn in
+                guard let userInfo else { return kCVReturnSuccess }
+                let displayLink = Unmanaged<IdleAwareDisplayLink>.fromOpaque(userInfo).takeUnretainedValue()
+                displayLink.tick()
+                return kCVReturnSuccess
+            }
+
+            let userInfo = Unmanaged.passUnretained(self).toOpaque()
+            CVDisplayLinkSetOutputCallback(link, callback, userInfo)
+            if let displayID {
+                CVDisplayLinkSetCurrentCGDisplay(link, displayID)
+            }
+
+            state.withLock { $0 = State(isStarted: true) }
+            CVDisplayLinkStart(link)
+            displayLink = link
+            return true
+        }
+    }
+
+    /// 停止并释放 display link
+    func stop() {
+        controlQueue.sync {
+            state.withLock { $0 = State() }
+            if let displayLink {
+                CVDisplayLinkStop(displayLink)
+            }
+            displayLink = nil
+        }
+    }
+
+    /// 有新内容需要渲染时调用，若 display link 已因空闲暂停则重新启动
+    func wake() {
+        let needsResume = state.withLock { state -> Bool in
+            state.idleFrames = 0
+            state.isPausePending = false
+            return state.isPaused
+        }
+        guard needsResume else { return }
+
+        controlQueue.async { [weak self] in
+            self?.resumeIfPaused()
+        }
+    }
+
+    // MARK: - 调度
+
+    private func tick() {
+        let hasWork = onTick?() ?? false
+
+        let shouldPause = state.withLock { state -> Bool in
+            if hasWork {
+                state.idleFrames = 0
+                return false
+            }
+            state.idleFrames += 1
+            guard state.idleFrames >= idleFrameLimit, !state.isPaused, !state.isPausePending else {
+                return false
+            }
+            state.isPausePending = true
+            return true
+        }
+        guard shouldPause else { return }
+
+        controlQueue.async { [weak self] in
+            self?.pauseIfStillIdle()
+        }
+    }
+
+    /// 在 controlQueue 上执行：若暂停请求未被 wake() 取消则停止 display link
+    private func pauseIfStillIdle() {
+        let shouldPause = state.withLock { state -> Bool in
+            guard state.isStarted, state.isPausePending else { return false }
+            state.isPausePending = false
+            state.isPaused = true
+            return true
+        }
+        if shouldPause, let displayLink {
+            CVDisplayLinkStop(displayLink)
+        }
+    }
+
+    /// 在 controlQueue 上执行：重新启动已暂停的 display link
+    private func resumeIfPaused() {
+        let shouldResume = state.withLock { state -> Bool in
+            guard state.isStarted, state.isPaused else { return false }
+            state.isPaused = false
+            return true
+        }
+        if shouldResume, let displayLink {
+            CVDisplayLinkStart(displayLink)
+        }
+    }
+}
+
 // MARK: - 渲染帧接收器
 
 /// 渲染帧接收器
 /// 实现 CVDisplayLink 驱动的渲染循环
 /// 主动从 BufferedFrameSink 拉取帧，实现 vsync 同步
+/// 只在有新帧时调度渲染，帧源静止时 display link 进入空闲，新帧到达时再唤醒
 final class RenderFrameSink {
     // MARK: - 属性
 
     /// 帧源（BufferedFrameSink）
     private weak var frameSource: BufferedFrameSink?
 
-    /// CVDisplayLink
-    private var displayLink: CVDisplayLink?
+    /// 按需驱动的 CVDisplayLink
+    private let displayLink = IdleAwareDisplayLink()
 
     /// 渲染回调
     var onRender: ((CVPixelBuffer) -> Void)?
@@ -337,7 +564,15 @@ final class RenderFrameSink {
     func startRendering() {
         guard !isRendering else { return }
         isRendering = true
-        setupDisplayLink()
+
+        // 新帧到达时唤醒空闲的 display link（事件已合并，每个待消费帧最多调用一次）
+        frameSource?.onFrameAvailable = { [weak self] in
+            self?.displayLink.wake()
+        }
+        displayLink.onTick = { [weak self] in
+            self?.displayLinkCallback() ?? false
+        }
+        displayLink.start()
         AppLogger.rendering.info("RenderFrameSink 开始渲染")
     }
 
@@ -345,43 +580,20 @@ final class RenderFrameSink {
     func stopRendering() {
         guard isRendering else { return }
         isRendering = false
-        stopDisplayLink()
+        displayLink.stop()
+        displayLink.onTick = nil
+        frameSource?.onFrameAvailable = nil
         AppLogger.rendering.info("RenderFrameSink 停止渲染")
     }
 
     // MARK: - Display Link
 
-    private func setupDisplayLink() {
-        var link: CVDisplayLink?
-        CVDisplayLinkCreateWithActiveCGDisplays(&link)
-
-        guard let displayLink = link else {
-            AppLogger.rendering.error("无法创建 CVDisplayLink")
-            return
-        }
-
-        let callback: CVDisplayLinkOutputCallback = { _, _, _, _, _, userInfo -> CVReturn in
-            guard let userInfo else { return kCVReturnSuccess }
-            let sink = Unmanaged<RenderFrameSink>.fromOpaque(userInfo).takeUnretainedValue()
-            sink.displayLinkCallback()
-            return kCVReturnSuccess
-        }
-
-        let userInfo = Unmanaged.passUnretained(self).toOpaque()
-        CVDisplayLinkSetOutputCallback(displayLink, callback, userInfo)
-        CVDisplayLinkStart(displayLink)
-        self.displayLink = displayLink
-    }
-
-    private func stopDisplayLink() {
-        if let displayLink {
-            CVDisplayLinkStop(displayLink)
+    /// - Returns: 本次 vsync 是否有新帧需要渲染
+    private func displayLinkCallback() -> Bool {
+        guard isRendering, frameSource?.hasNewFrame == true else {
+            // 没有新帧，不唤醒渲染队列
+            return false
         }
-        displayLink = nil
-    }
-
-    private func displayLinkCallback() {
-        guard isRendering else { return }
 
         // 在渲染队列中执行，避免阻塞 DisplayLink 回调线程
         renderQueue.async { [weak self] in
@@ -391,6 +603,7 @@ final class RenderFrameSink {
                 self?.renderFrame()
             }
         }
+        return true
     }
 
     private func renderFrame() {
@@ -406,17 +619,21 @@ final class RenderFrameSink {
     }
 }
 
-// MARK: - 主线程帧分发器
+// MARK: - 队列帧分发器
 
-/// 主线程帧分发器
-/// 将帧事件安全地分发到主线程，支持事件合并
-final class MainThreadFrameDispatcher {
+/// 队列帧分发器
+/// 新帧到达时在专用的投递队列上消费最新帧，支持事件合并
+/// 不经过主线程：AppKit 布局等主线程卡顿不会让帧迟到或被丢弃
+final class QueueFrameDispatcher {
     // MARK: - 属性
 
     /// 帧源
     private let frameSink: BufferedFrameSink
 
-    /// 主线程帧处理回调
+    /// 投递队列（串行，帧处理回调在此调用）
+    private let deliveryQueue = DispatchQueue(label: "com.screenPresenter.frameDelivery", qos: .userInteractive)
+
+    /// 帧处理回调
     var onFrame: ((CVPixelBuffer) -> Void)?
 
     /// 是否已设置
@@ -437,32 +654,41 @@ final class MainThreadFrameDispatcher {
 
         // 设置帧可用回调
         frameSink.onFrameAvailable = { [weak self] in
-            self?.dispatchToMainThread()
+            self?.dispatchToDeliveryQueue()
         }
 
-        AppLogger.rendering.info("MainThreadFrameDispatcher 已设置")
+        AppLogger.rendering.info("QueueFrameDispatcher 已设置")
     }
 
     /// 停止分发
     func stop() {
         isSetup = false
         frameSink.onFrameAvailable = nil
-        AppLogger.rendering.info("MainThreadFrameDispatcher 已停止")
+        AppLogger.rendering.info("QueueFrameDispatcher 已停止")
+    }
+
+    /// 已排队的帧全部投递后在指定队列执行
+    func notifyWhenDelivered(on queue: DispatchQueue, execute work: @escaping () -> Void) {
+        deliveryQueue.async {
+            queue.async(execute: work)
+        }
     }
 
     // MARK: - 分发
 
-    private func dispatchToMainThread() {
-        DispatchQueue.main.async { [weak self] in
+    private func dispatchToDeliveryQueue() {
+        deliveryQueue.async { [weak self] in
             guard let self, isSetup else { return }
 
-            // 消费最新帧
-            guard let pixelBuffer = frameSink.consume() else {
-                return
-            }
+            autoreleasepool {
+                // 消费最新帧
+                guard let pixelBuffer = frameSink.consume() else {
+                    return
+                }
 
-            // 回调处理
-            onFrame?(pixelBuffer)
+                // 回调处理
+                onFrame?(pixelBuffer)
+            }
         }
     }
 }
@@ -470,10 +696,12 @@ final class MainThreadFrameDispatcher {
 // MARK: - 帧管道
 
 /// 渲染模式
+/// 两种模式都不经过主线程，主线程只按低频拉取 FPS、延迟等界面统计
 enum FramePipelineRenderMode {
-    /// 主线程事件驱动（默认，兼容性好）
-    case mainThreadEvent
-    /// CVDisplayLink 驱动（更流畅，独立于主线程）
+    /// 事件驱动（默认）：新帧到达即在专用投递队列消费，不等待 vsync
+    /// 呈现节奏由渲染视图的 CAMetalDisplayLink 按源帧率控制，管道不再额外对齐一次 vsync
+    case event
+    /// CVDisplayLink 驱动：按 vsync 在渲染队列消费（供没有自己 display link 的消费者使用）
     case displayLink
 }
 
@@ -485,14 +713,34 @@ final class FramePipeline {
     /// 带缓冲的帧消费者
     let bufferedSink: BufferedFrameSink
 
-    /// 主线程分发器
-    private let dispatcher: MainThreadFrameDispatcher
+    /// 队列分发器（事件驱动模式）
+    private let dispatcher: QueueFrameDispatcher
 
     /// CVDisplayLink 渲染器
     private let renderSink: RenderFrameSink
 
     /// 当前渲染模式
-    private(set) var renderMode: FramePipelineRenderMode = .displayLink
+    private(set) var renderMode: FramePipelineRenderMode = .event
+
+    /// 帧延迟追踪器（可选）
+    var latencyTracer: FrameLatencyTracer? {
+        get { bufferedSink.latencyTracer }
+        set { bufferedSink.latencyTracer = newValue }
+    }
+
+    /// 缩略图分接（按低频从推入的帧生成预览，不经过渲染链路）
+    let thumbnailTap = FrameThumbnailTap()
+
+    /// 静止帧检测器（只在推帧线程访问）
+    private let staticFrameDetector = StaticFrameDetector()
+
+    /// 是否跳过内容未变化的帧（回放基准测试需要完整的帧流，可关闭）
+    var skipsUnchangedFrames = true
+
+    /// 因内容未变化而跳过的帧数
+    var unchangedFrameCount: Int {
+        staticFrameDetector.unchangedFrameCount
+    }
 
     // MARK: - 状态
 
@@ -501,9 +749,9 @@ final class FramePipeline {
 
     // MARK: - 初始化
 
-    init(renderMode: FramePipelineRenderMode = .displayLink) {
+    init(renderMode: FramePipelineRenderMode = .event) {
         bufferedSink = BufferedFrameSink()
-        dispatcher = MainThreadFrameDispatcher(frameSink: bufferedSink)
+        dispatcher = QueueFrameDispatcher(frameSink: bufferedSink)
         renderSink = RenderFrameSink(frameSource: bufferedSink)
         self.renderMode = renderMode
     }
@@ -515,11 +763,12 @@ final class FramePipeline {
         guard !isRunning else { return }
 
         _ = bufferedSink.open(size: size)
+        staticFrameDetector.reset()
 
         switch renderMode {
-        case .mainThreadEvent:
+        case .event:
             dispatcher.setup()
-            AppLogger.rendering.info("FramePipeline 已启动（主线程事件模式）")
+            AppLogger.rendering.info("FramePipeline 已启动（事件驱动模式）")
         case .displayLink:
             renderSink.startRendering()
             AppLogger.rendering.info("FramePipeline 已启动（CVDisplayLink 模式）")
@@ -533,7 +782,7 @@ final class FramePipeline {
         guard isRunning else { return }
 
         switch renderMode {
-        case .mainThreadEvent:
+        case .event:
             dispatcher.stop()
         case .displayLink:
             renderSink.stopRendering()
@@ -546,27 +795,44 @@ final class FramePipeline {
     }
 
     /// 推送帧（由解码线程调用）
+    /// - Parameters:
+    ///   - pixelBuffer: 像素缓冲
+    ///   - allowsSkip: 内容未变化时是否可以跳过（重新分发最新帧时传 false）
+    /// - Returns: 是否成功处理（跳过的静止帧也视为成功）
     @discardableResult
-    func pushFrame(_ pixelBuffer: CVPixelBuffer) -> Bool {
+    func pushFrame(_ pixelBuffer: CVPixelBuffer, allowsSkip: Bool = true) -> Bool {
         guard isRunning else {
             return false
         }
 
+        ZeroCopyFrameContract.assertUntouched(pixelBuffer, stage: "FramePipeline.pushFrame")
+        if skipsUnchangedFrames, allowsSkip, staticFrameDetector.isUnchanged(pixelBuffer) {
+            // 下游已持有内容相同的上一帧，渲染、缩略图都无需处理
+            return true
+        }
+        thumbnailTap.offer(pixelBuffer)
         let frame = VideoFrame(pixelBuffer: pixelBuffer)
         return bufferedSink.push(frame)
     }
 
     /// 设置帧处理回调
-    /// 根据渲染模式，回调可能在主线程（mainThreadEvent）或渲染队列（displayLink）中调用
+    /// 根据渲染模式，回调在投递队列（event）或渲染队列（displayLink）中调用，不会在主线程调用
     func setFrameHandler(_ handler: @escaping (CVPixelBuffer) -> Void) {
+        // 新的处理者还没有收到过画面，静止时下一帧也必须分发
+        staticFrameDetector.reset()
         switch renderMode {
-        case .mainThreadEvent:
+        case .event:
             dispatcher.onFrame = handler
         case .displayLink:
             renderSink.onRender = handler
         }
     }
 
+    /// 事件驱动模式下，已推入的帧全部投递后在指定队列执行
+    func notifyWhenDelivered(on queue: DispatchQueue, execute work: @escaping () -> Void) {
+        dispatcher.notifyWhenDelivered(on: queue, execute: work)
+    }
+
     /// 获取统计信息
     func getStats() -> (skipped: Int, rendered: Int, skipRate: Double) {
         bufferedSink.getStats()
@@ -0,0 +1,168 @@
+//
+//  FrameSnapshot.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  帧截图
+//  投屏进行中时直接取帧管道中的最新帧作为截图，不需要 iOS 的 DeviceLink 往返或 Android 的 screencap，
+//  截图与画面上显示的帧完全一致
+//
+//  设计要点:
+//  1. 取图只是持有最新帧的像素缓冲引用，调用方线程不做任何像素处理
+//  2. 在低优先级队列中先转换为 CGImage，再用 ImageIO 编码；编码阶段不再访问像素缓冲
+//  3. 截图持有的像素缓冲来自解码/捕获缓冲池，调用方应在编码完成后尽快释放截图
+//
+
+import CoreImage
+import CoreMedia
+import CoreVideo
+import Foundation
+import ImageIO
+import Metal
+import UniformTypeIdentifiers
+
+// MARK: - 截图格式
+
+/// 截图编码格式
+enum FrameSnapshotFormat {
+    /// 无损 PNG
+    case png
+    /// HEIC（压缩质量 0~1）
+    case heic(quality: CGFloat)
+
+    /// 文件扩展名
+    var fileExtension: String {
+        switch self {
+        case .png: "png"
+        case .heic: "heic"
+        }
+    }
+
+    fileprivate var type: UTType {
+        switch self {
+        case .png: .png
+        case .heic: .heic
+        }
+    }
+
+    fileprivate var properties: [CFString: Any] {
+        switch self {
+        case .png: [:]
+        case let .heic(quality): [kCGImageDestinationLossyCompressionQuality: quality]
+        }
+    }
+}
+
+// MARK: - 截图错误
+
+enum FrameSnapshotError: LocalizedError {
+    case imageCreationFailed
+    case encodingFailed(FrameSnapshotFormat)
+
+    var errorDescription: String? {
+        switch self {
+        case .imageCreationFailed:
+            "无法从画面生成图像"
+        case let .encodingFailed(format):
+            "无法编码为 \(format.fileExtension.uppercased())"
+        }
+    }
+}
+
+// MARK: - 帧截图
+
+/// 帧截图（持有取图时的最新帧，编码在后台队列进行）
+struct FrameSnapshot {
+    // MARK: - 常量
+
+    /// 编码队列（串行，连续截图不会同时占用多份内存）
+    private static let encodeQueue = DispatchQueue(label: "com.screenPresenter.frameSnapshot", qos: .utility)
+
+    private static let colorSpace = CGColorSpace(name: CGColorSpace.sRGB) ?? CGColorSpaceCreateDeviceRGB()
+
+    /// 共享的 CIContext（420v → RGB 转换在 GPU 上进行）
+    private static let context: CIContext = {
+        let options: [CIContextOption: Any] = [
+            .cacheIntermediates: false,
+            .outputColorSpace: colorSpace,
+        ]
+        if let device = MTLCreateSystemDefaultDevice() {
+            return CIContext(mtlDevice: device, options: options)
+        }
+        return CIContext(options: options)
+    }()
+
+    // MARK: - 属性
+
+    /// 画面像素缓冲
+    let pixelBuffer: CVPixelBuffer
+
+    /// 画面的展示时间
+    let presentationTime: CMTime
+
+    /// 画面尺寸
+    var size: CGSize {
+        CGSize(
+            width: CVPixelBufferGetWidth(pixelBuffer),
+            height: CVPixelBufferGetHeight(pixelBuffer)
+        )
+    }
+
+    // MARK: - 编码
+
+    /// 编码截图
+    /// - Parameter format: 编码格式
+    /// - Returns: 编码后的图像数据
+    func encoded(as format: FrameSnapshotFormat) async throws -> Data {
+        let image = try await makeImage()
+        return try await withCheckedThrowingContinuation { continuation in
+            Self.encodeQueue.async {
+                let data = NSMutableData()
+                guard let destination = CGImageDestinationCreateWithData(
+                    data as CFMutableData,
+                    format.type.identifier as CFString,
+                    1,
+                    nil
+                ) else {
+                    continuation.resume(throwing: FrameSnapshotError.encodingFailed(format))
+                    return
+                }
+                CGImageDestinationAddImage(destination, image, format.properties as CFDictionary)
+                guard CGImageDestinationFinalize(destination) else {
+                    continuation.resume(throwing: FrameSnapshotError.encodingFailed(format))
+                    return
+                }
+                continuation.resume(returning: data as Data)
+            }
+        }
+    }
+
+    /// 编码截图并写入文件
+    /// - Parameters:
+    ///   - url: 文件路径（已存在时覆盖）
+    ///   - format: 编码格式
+    func write(to url: URL, format: FrameSnapshotFormat) async throws {
+        let data = try await encoded(as: format)
+        try data.write(to: url, options: .atomic)
+        AppLogger.capture.info("截图已保存: \(url.lastPathComponent)，\(Int(size.width))x\(Int(size.height))")
+    }
+
+    /// 在编码队列把像素缓冲转换为 CGImage
+    private func makeImage() async throws -> CGImage {
+        let pixelBuffer = pixelBuffer
+        return try await withCheckedThrowingContinuation { continuation in
+            Self.encodeQueue.async {
+                let image = autoreleasepool { () -> CGImage? in
+                    let ciImage = CIImage(cvPixelBuffer: pixelBuffer)
+                    return Self.context.createCGImage(ciImage, from: ciImage.extent)
+                }
+                if let image {
+                    continuation.resume(returning: image)
+                } else {
+                    continuation.resume(throwing: FrameSnapshotError.imageCreationFailed)
+                }
+            }
+        }
+    }
+}
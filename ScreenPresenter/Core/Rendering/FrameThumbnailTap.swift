@@ -0,0 +1,272 @@
+//
+//  FrameThumbnailTap.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  帧缩略图分接
+//  从正在投屏的帧流中按低频取最新帧，在 GPU 上缩放为小尺寸缩略图，
+//  供设备状态等需要预览的界面使用，不需要再向设备请求截图
+//
+//  设计要点:
+//  1. 未到取样时间时 offer 只是一次无竞争的加锁判断，不影响帧管道
+//  2. 同一时间最多一次缩放在进行，GPU 繁忙时宁可跳过也不排队
+//  3. 缩略图写入 IOSurface 承载的小像素缓冲（可直接导入为 Metal 纹理），CGImage 与 JPEG 按需生成
+//
+
+import CoreImage
+import CoreVideo
+import Foundation
+import Metal
+import os.lock
+
+// MARK: - 帧缩略图
+
+/// 帧缩略图
+struct FrameThumbnail {
+    /// 缩略图像素缓冲（BGRA，IOSurface 承载）
+    let pixelBuffer: CVPixelBuffer
+
+    /// 源帧尺寸
+    let sourceSize: CGSize
+
+    /// 生成时间
+    let timestamp: CFAbsoluteTime
+
+    /// 缩略图尺寸
+    var size: CGSize {
+        CGSize(
+            width: CVPixelBufferGetWidth(pixelBuffer),
+            height: CVPixelBufferGetHeight(pixelBuffer)
+        )
+    }
+
+    /// 生成 CGImage（用于界面显示）
+    func makeCGImage() -> CGImage? {
+        let image = CIImage(cvPixelBuffer: pixelBuffer)
+        return FrameThumbnailTap.context.createCGImage(image, from: image.extent)
+    }
+
+    /// 编码为 JPEG
+    /// - Parameter compressionQuality: 压缩质量（0~1）
+    func jpegData(compressionQuality: CGFloat = 0.7) -> Data? {
+        let image = CIImage(cvPixelBuffer: pixelBuffer)
+        let options = [
+            CIImageRepresentationOption(rawValue: kCGImageDestinationLossyCompressionQuality as String): compressionQuality,
+        ]
+        return FrameThumbnailTap.context.jpegRepresentation(
+            of: image,
+            colorSpace: FrameThumbnailTap.colorSpace,
+            options: options
+        )
+    }
+}
+
+// MARK: - 帧缩略图分接
+
+/// 帧缩略图分接
+///
+/// 线程安全：
+/// - offer() 在解码/捕获线程调用，只做取样判断，缩放在专用的低优先级队列执行
+/// - 配置与最新缩略图可在任意线程读写
+/// - onThumbnail 在主线程调用
+final class FrameThumbnailTap: @unchecked Sendable {
+    // MARK: - 常量
+
+    /// 默认取样间隔（秒）
+    static let defaultInterval: TimeInterval = 1.0
+
+    /// 默认缩略图最长边（像素）
+    static let defaultMaxDimension = 240
+
+    /// 共享的 Metal CIContext（缩放与 CGImage/JPEG 生成共用）
+    fileprivate static let context: CIContext = {
+        let options: [CIContextOption: Any] = [
+            .cacheIntermediates: false,
+            .outputColorSpace: colorSpace,
+        ]
+        if let device = MTLCreateSystemDefaultDevice() {
+            return CIContext(mtlDevice: device, options: options)
+        }
+        return CIContext(options: options)
+    }()
+
+    fileprivate static let colorSpace = CGColorSpace(name: CGColorSpace.sRGB) ?? CGColorSpaceCreateDeviceRGB()
+
+    // MARK: - 类型定义
+
+    private struct State {
+        var isEnabled = true
+        var interval = FrameThumbnailTap.defaultInterval
+        var maxDimension = FrameThumbnailTap.defaultMaxDimension
+        /// 上次取样时间
+        var lastSampleTime: CFAbsoluteTime = 0
+        /// 是否有缩放在进行
+        var isRendering = false
+        var latestThumbnail: FrameThumbnail?
+    }
+
+    // MARK: - 属性
+
+    /// 新缩略图回调（在主线程调用）
+    var onThumbnail: ((FrameThumbnail) -> Void)? {
+        get { state.withLock { _ in onThumbnailStorage } }
+        set { state.withLock { _ in onThumbnailStorage = newValue } }
+    }
+
+    /// 是否启用
+    var isEnabled: Bool {
+        get { state.withLock { $0.isEnabled } }
+        set { state.withLock { $0.isEnabled = newValue } }
+    }
+
+    /// 取样间隔（秒）
+    var interval: TimeInterval {
+        get { state.withLock { $0.interval } }
+        set { state.withLock { $0.interval = max(0.1, newValue) } }
+    }
+
+    /// 缩略图最长边（像素）
+    var maxDimension: Int {
+        get { state.withLock { $0.maxDimension } }
+        set { state.withLock { $0.maxDimension = max(16, newValue) } }
+    }
+
+    /// 最新的缩略图（停止投屏后保留）
+    var latestThumbnail: FrameThumbnail? {
+        state.withLock { $0.latestThumbnail }
+    }
+
+    private let state = OSAllocatedUnfairLock(initialState: State())
+
+    private var onThumbnailStorage: ((FrameThumbnail) -> Void)?
+
+    private let renderQueue = DispatchQueue(label: "com.screenPresenter.frameThumbnail", qos: .utility)
+
+    /// 缩略图缓冲池，只在 renderQueue 访问
+    private var pool: CVPixelBufferPool?
+    private var poolSize: CGSize = .zero
+
+    // MARK: - 初始化
+
+    init() {
+        MemoryPressureCoordinator.shared.register(self)
+    }
+
+    // MARK: - 取样
+
+    /// 提供一帧（由解码/捕获线程调用，未到取样时间时直接返回）
+    func offer(_ pixelBuffer: CVPixelBuffer) {
+        let now = CFAbsoluteTimeGetCurrent()
+        let maxDimension = state.withLock { state -> Int? in
+            guard state.isEnabled, !state.isRendering, now - state.lastSampleTime >= state.interval else {
+                return nil
+            }
+            state.lastSampleTime = now
+            state.isRendering = true
+            return state.maxDimension
+        }
+        guard let maxDimension else { return }
+
+        renderQueue.async { [self] in
+            let thumbnail = autoreleasepool {
+                render(pixelBuffer, maxDimension: maxDimension, timestamp: now)
+            }
+            let handler = state.withLock { state -> ((FrameThumbnail) -> Void)? in
+                state.isRendering = false
+                guard let thumbnail else { return nil }
+                state.latestThumbnail = thumbnail
+                return onThumbnailStorage
+            }
+            if let thumbnail, let handler {
+                DispatchQueue.main.async {
+                    handler(thumbnail)
+                }
+            }
+        }
+    }
+
+    /// 清除最新的缩略图
+    func reset() {
+        state.withLock {
+            $0.latestThumbnail = nil
+            $0.lastSampleTime = 0
+        }
+    }
+
+    // MARK: - 缩放
+
+    private func render(_ pixelBuffer: CVPixelBuffer, maxDimension: Int, timestamp: CFAbsoluteTime) -> FrameThumbnail? {
+        let sourceSize = CGSize(
+            width: CVPixelBufferGetWidth(pixelBuffer),
+            height: CVPixelBufferGetHeight(pixelBuffer)
+        )
+        guard sourceSize.width > 0, sourceSize.height > 0 else { return nil }
+
+        // 按最长边等比缩小，不放大；宽高取偶数以兼容缓冲池对齐
+        let scale = min(1, CGFloat(maxDimension) / max(sourceSize.width, sourceSize.height))
+        let targetSize = CGSize(
+            width: max(2, (sourceSize.width * scale / 2).rounded() * 2),
+            height: max(2, (sourceSize.height * scale / 2).rounded() * 2)
+        )
+        guard let outputBuffer = makeOutputBuffer(size: targetSize) else { return nil }
+
+        let image = CIImage(cvPixelBuffer: pixelBuffer)
+            .samplingLinear()
+            .transformed(by: CGAffineTransform(
+                scaleX: targetSize.width / sourceSize.width,
+                y: targetSize.height / sourceSize.height
+            ))
+        Self.context.render(
+            image,
+            to: outputBuffer,
+            bounds: CGRect(origin: .zero, size: targetSize),
+            colorSpace: Self.colorSpace
+        )
+
+        return FrameThumbnail(pixelBuffer: outputBuffer, sourceSize: sourceSize, timestamp: timestamp)
+    }
+
+    /// 从缓冲池取出缩略图缓冲，尺寸变化（如旋转）时重建缓冲池
+    private func makeOutputBuffer(size: CGSize) -> CVPixelBuffer? {
+        if pool == nil || poolSize != size {
+            var attributes = ZeroCopyFrameContract.pixelBufferAttributes(pixelFormat: kCVPixelFormatType_32BGRA)
+            attributes[kCVPixelBufferWidthKey as String] = Int(size.width)
+            attributes[kCVPixelBufferHeightKey as String] = Int(size.height)
+            var newPool: CVPixelBufferPool?
+            let status = CVPixelBufferPoolCreate(kCFAllocatorDefault, nil, attributes as CFDictionary, &newPool)
+            guard status == kCVReturnSuccess, let newPool else {
+                AppLogger.rendering.error("无法创建缩略图缓冲池: \(status)")
+                return nil
+            }
+            pool = newPool
+            poolSize = size
+        }
+
+        guard let pool else { return nil }
+        var pixelBuffer: CVPixelBuffer?
+        let status = CVPixelBufferPoolCreatePixelBuffer(kCFAllocatorDefault, pool, &pixelBuffer)
+        guard status == kCVReturnSuccess else {
+            AppLogger.rendering.error("无法创建缩略图缓冲: \(status)")
+            return nil
+        }
+        return pixelBuffer
+    }
+}
+
+// MARK: - 内存压力
+
+extension FrameThumbnailTap: MemoryPressureResponder {
+    func memoryPressureDidChange(to level: MemoryPressureLevel) {
+        guard level > .normal else { return }
+        renderQueue.async { [self] in
+            guard let pool else { return }
+            // warning 只归还空闲缓冲；critical 连缓冲池一起释放，下次取样时重建
+            CVPixelBufferPoolFlush(pool, .excessBuffers)
+            if level == .critical {
+                self.pool = nil
+                poolSize = .zero
+            }
+        }
+    }
+}
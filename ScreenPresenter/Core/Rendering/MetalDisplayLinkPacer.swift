@@ -0,0 +1,184 @@
+//
+//  MetalDisplayLinkPacer.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  基于 CAMetalDisplayLink 的帧节奏控制
+//  在专用渲染线程上按源帧率请求刷新（例如 120Hz ProMotion 屏上以 30 / 60 fps 刷新），
+//  display link 直接提供 drawable，画面静止时暂停，新帧到达时唤醒
+//
+
+import Foundation
+import QuartzCore
+
+// MARK: - 渲染线程
+
+/// 拥有 run loop 的专用渲染线程，CAMetalDisplayLink 的回调在此线程执行
+private final class RenderLoopThread: Thread {
+    private let ready = DispatchSemaphore(value: 0)
+    private var cfRunLoop: CFRunLoop?
+
+    /// 线程的 run loop（start() 返回后可用）
+    private(set) var runLoop: RunLoop?
+
+    override func main() {
+        let runLoop = RunLoop.current
+        // 没有输入源时 run loop 会立即返回，挂一个端口保持运行
+        runLoop.add(NSMachPort(), forMode: .default)
+        self.runLoop = runLoop
+        cfRunLoop = runLoop.getCFRunLoop()
+        ready.signal()
+
+        while !isCancelled {
+            autoreleasepool {
+                _ = runLoop.run(mode: .default, before: .distantFuture)
+            }
+        }
+    }
+
+    /// 启动线程并等待 run loop 就绪
+    func startAndWait() {
+        start()
+        ready.wait()
+    }
+
+    /// 在渲染线程上执行
+    func perform(_ block: @escaping () -> Void) {
+        guard let cfRunLoop else { return }
+        CFRunLoopPerformBlock(cfRunLoop, CFRunLoopMode.defaultMode.rawValue, block)
+        CFRunLoopWakeUp(cfRunLoop)
+    }
+
+    /// 停止线程
+    func stop() {
+        cancel()
+        // 唤醒 run loop，使其检查取消状态
+        perform {}
+    }
+}
+
+// MARK: - Metal Display Link 帧节奏控制
+
+/// 基于 CAMetalDisplayLink 的帧节奏控制
+///
+/// 线程安全：
+/// - onUpdate 在渲染线程调用，返回本次是否渲染了新内容
+/// - wake() / setSourceFrameRate(_:) 可在任意线程调用，实际修改在渲染线程上进行
+/// - 连续空闲 idleFrameLimit 次刷新后暂停 display link，不再每个 vsync 唤醒 GPU
+final class MetalDisplayLinkPacer: NSObject, CAMetalDisplayLinkDelegate {
+    // MARK: - 属性
+
+    /// 刷新回调（渲染线程），参数为本次刷新的 drawable 与呈现间隔，返回是否渲染了新内容
+    var onUpdate: ((CAMetalDrawable, CFTimeInterval) -> Bool)?
+
+    /// 连续空闲多少次刷新后暂停
+    let idleFrameLimit: Int
+
+    /// 当前请求的刷新率（渲染线程访问）
+    private var frameRate: Float = 60
+
+    /// 连续空闲次数（渲染线程访问）
+    private var idleFrames = 0
+
+    private let thread = RenderLoopThread()
+    private let displayLink: CAMetalDisplayLink
+
+    // MARK: - 初始化
+
+    /// - Parameters:
+    ///   - layer: 要呈现的 CAMetalLayer
+    ///   - idleFrameLimit: 连续空闲多少次刷新后暂停（默认约半秒）
+    init(layer: CAMetalLayer, idleFrameLimit: Int = 30) {
+        self.idleFrameLimit = idleFrameLimit
+        thread.name = "com.screenPresenter.metalDisplayLink"
+        thread.qualityOfService = .userInteractive
+        thread.startAndWait()
+
+        displayLink = CAMetalDisplayLink(metalLayer: layer)
+        super.init()
+
+        displayLink.delegate = self
+        // 只保留一帧在途，降低从解码到上屏的延迟
+        displayLink.preferredFrameLatency = 1
+        displayLink.preferredFrameRateRange = Self.frameRateRange(for: frameRate)
+        displayLink.isPaused = true
+        if let runLoop = thread.runLoop {
+            displayLink.add(to: runLoop, forMode: .default)
+        }
+    }
+
+    deinit {
+        invalidate()
+    }
+
+    // MARK: - 控制
+
+    /// 有新内容需要渲染时调用，唤醒已暂停的 display link
+    func wake() {
+        thread.perform { [weak self] in
+            guard let self else { return }
+            idleFrames = 0
+            displayLink.isPaused = false
+        }
+    }
+
+    /// 按源帧率请求刷新率（按常见帧率取整，避免频繁调整）
+    /// - Parameter framesPerSecond: 源帧率
+    func setSourceFrameRate(_ framesPerSecond: Double) {
+        // 画面静止时源只偶尔出帧，此时的测量值不代表源帧率
+        guard framesPerSecond >= Self.minimumSourceFrameRate else { return }
+        let rate = Self.standardFrameRate(for: framesPerSecond)
+        thread.perform { [weak self] in
+            guard let self, rate != frameRate else { return }
+            frameRate = rate
+            displayLink.preferredFrameRateRange = Self.frameRateRange(for: rate)
+            AppLogger.rendering.info("[DisplayLink] 请求刷新率: \(Int(rate)) Hz")
+        }
+    }
+
+    /// 停止 display link 并结束渲染线程
+    func invalidate() {
+        thread.perform { [displayLink] in
+            displayLink.invalidate()
+        }
+        thread.stop()
+    }
+
+    // MARK: - CAMetalDisplayLinkDelegate
+
+    func metalDisplayLink(_ link: CAMetalDisplayLink, needsUpdate update: CAMetalDisplayLink.Update) {
+        let interval = CFTimeInterval(1 / frameRate)
+        let rendered = autoreleasepool {
+            onUpdate?(update.drawable, interval) ?? false
+        }
+
+        if rendered {
+            idleFrames = 0
+            return
+        }
+        idleFrames += 1
+        if idleFrames >= idleFrameLimit {
+            link.isPaused = true
+        }
+    }
+
+    // MARK: - 辅助
+
+    /// 低于此帧率的测量值不用于调整刷新率
+    private static let minimumSourceFrameRate: Double = 20
+
+    /// 常见源帧率档位
+    private static let standardFrameRates: [Float] = [24, 30, 48, 60, 90, 120]
+
+    /// 取不低于源帧率的最近档位，略低于档位的测量值（如 58.7 fps）归入该档位
+    private static func standardFrameRate(for framesPerSecond: Double) -> Float {
+        let measured = Float(framesPerSecond) * 0.95
+        return standardFrameRates.first { $0 >= measured } ?? standardFrameRates[standardFrameRates.count - 1]
+    }
+
+    /// 固定为源帧率的刷新率范围：ProMotion 屏按源帧率刷新，刷新次数不超过源帧率
+    private static func frameRateRange(for rate: Float) -> CAFrameRateRange {
+        CAFrameRateRange(minimum: rate, maximum: rate, preferred: rate)
+    }
+}
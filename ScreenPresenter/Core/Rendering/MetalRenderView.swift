@@ -20,7 +20,9 @@ final class MetalRenderView: NSView {
 
     private var metalLayer: CAMetalLayer?
     private var renderer: MetalRenderer?
-    private var displayLink: CVDisplayLink?
+
+    /// 按需驱动的 CVDisplayLink：没有纹理或布局变化时空闲，有变化时唤醒
+    private let displayLink = IdleAwareDisplayLink()
 
     // MARK: - 渲染队列
 
@@ -107,6 +109,7 @@ final class MetalRenderView: NSView {
 
         // 创建渲染器
         renderer = MetalRenderer()
+        MemoryPressureCoordinator.shared.register(self)
 
         AppLogger.rendering.info("Metal 渲染视图已初始化")
     }
@@ -122,6 +125,7 @@ final class MetalRenderView: NSView {
 
         if size.width > 0, size.height > 0 {
             metalLayer.drawableSize = size
+            setNeedsRender()
         }
     }
 
@@ -155,53 +159,45 @@ final class MetalRenderView: NSView {
     // MARK: - Display Link
 
     private func setupDisplayLink() {
-        var link: CVDisplayLink?
-        CVDisplayLinkCreateWithActiveCGDisplays(&link)
-
-        guard let displayLink = link else {
-            AppLogger.rendering.error("无法创建 CVDisplayLink")
-            return
+        displayLink.onTick = { [weak self] in
+            self?.displayLinkCallback() ?? false
         }
 
-        // 设置输出回调
-        let callback: CVDisplayLinkOutputCallback = { _, _, _, _, _, userInfo -> CVReturn in
-            guard let userInfo else { return kCVReturnSuccess }
-            let view = Unmanaged<MetalRenderView>.fromOpaque(userInfo).takeUnretainedValue()
-            view.displayLinkCallback()
-            return kCVReturnSuccess
-        }
-
-        let userInfo = Unmanaged.passUnretained(self).toOpaque()
-        CVDisplayLinkSetOutputCallback(displayLink, callback, userInfo)
-
         // 设置当前显示
-        if let screen = window?.screen {
-            let displayID = screen
-                .deviceDescription[NSDeviceDescriptionKey("NSScreenNumber")] as? CGDirectDisplayID ?? CGMainDisplayID()
-            CVDisplayLinkSetCurrentCGDisplay(displayLink, displayID)
+        let displayID = window?.screen.map {
+            $0.deviceDescription[NSDeviceDescriptionKey("NSScreenNumber")] as? CGDirectDisplayID ?? CGMainDisplayID()
         }
-
-        CVDisplayLinkStart(displayLink)
-        self.displayLink = displayLink
+        displayLink.start(displayID: displayID)
     }
 
     private func stopDisplayLink() {
-        if let displayLink {
-            CVDisplayLinkStop(displayLink)
-        }
-        displayLink = nil
+        displayLink.stop()
+        displayLink.onTick = nil
     }
 
-    private func displayLinkCallback() {
+    /// - Returns: 本次 vsync 是否需要渲染
+    private func displayLinkCallback() -> Bool {
         renderLock.lock()
         defer { renderLock.unlock() }
 
-        guard isRendering else { return }
+        guard isRendering else { return false }
+
+        // 由外部按 vsync 拉取帧时每帧都要回调；否则只在纹理或布局变化后渲染
+        guard onRenderFrame != nil || renderer?.needsRender == true else {
+            return false
+        }
 
         // 在专用渲染队列执行渲染，避免阻塞主线程
         renderQueue.async { [weak self] in
             self?.renderFrame()
         }
+        return true
+    }
+
+    /// 标记需要重新渲染，并唤醒空闲的 display link
+    private func setNeedsRender() {
+        renderer?.setNeedsRender()
+        displayLink.wake()
     }
 
     // MARK: - 渲染
@@ -220,61 +216,137 @@ final class MetalRenderView: NSView {
         renderer.render(to: metalLayer)
     }
 
+    // MARK: - 合成图层
+
+    /// 添加或更新图层布局（任意数量的设备，上限为 MetalRenderer.maxLayerCount）
+    func setLayout(_ layout: CompositorLayerLayout, forLayer id: Int) {
+        renderer?.setLayout(layout, forLayer: id)
+        displayLink.wake()
+    }
+
+    /// 移除图层
+    func removeLayer(_ id: Int) {
+        renderer?.removeLayer(id)
+        displayLink.wake()
+    }
+
+    /// 更新图层画面
+    func updateTexture(forLayer id: Int, from pixelBuffer: CVPixelBuffer) {
+        renderer?.updateTexture(forLayer: id, from: pixelBuffer)
+        displayLink.wake()
+    }
+
+    /// 设置图层的设备边框纹理
+    func setBezelTexture(_ texture: MTLTexture?, forLayer id: Int) {
+        renderer?.setBezelTexture(texture, forLayer: id)
+        displayLink.wake()
+    }
+
+    /// 设置图层的颜色补偿滤镜（在合成时应用其 3D LUT）
+    func setColorFilter(_ filter: ColorCompensationFilter?, forLayer id: Int) {
+        renderer?.setColorFilter(filter, forLayer: id)
+        displayLink.wake()
+    }
+
+    /// 图层帧率
+    func fps(forLayer id: Int) -> Double {
+        renderer?.fps(forLayer: id) ?? 0
+    }
+
+    // MARK: - 左右布局
+
+    /// 左侧设备的图层标识
+    private static let leftLayerID = 0
+
+    /// 右侧设备的图层标识
+    private static let rightLayerID = 1
+
+    private var isSwapped = false
+    private var primaryScreenFrame: CGRect = .zero
+    private var secondaryScreenFrame: CGRect = .zero
+    private var primaryScreenCornerRadius: CGFloat = 0
+    private var secondaryScreenCornerRadius: CGFloat = 0
+
+    /// 按主/次屏幕区域与交换状态更新左右两个图层的布局
+    private func updateSideBySideLayout() {
+        let primary = CompositorLayerLayout(screenFrame: primaryScreenFrame, cornerRadius: primaryScreenCornerRadius)
+        let secondary = CompositorLayerLayout(screenFrame: secondaryScreenFrame, cornerRadius: secondaryScreenCornerRadius)
+        setLayout(isSwapped ? secondary : primary, forLayer: Self.leftLayerID)
+        setLayout(isSwapped ? primary : secondary, forLayer: Self.rightLayerID)
+    }
+
     // MARK: - 纹理更新
 
     /// 更新左侧纹理
     func updateLeftTexture(from pixelBuffer: CVPixelBuffer) {
-        renderer?.updateLeftTexture(from: pixelBuffer)
+        updateTexture(forLayer: Self.leftLayerID, from: pixelBuffer)
     }
 
     /// 更新右侧纹理
     func updateRightTexture(from pixelBuffer: CVPixelBuffer) {
-        renderer?.updateRightTexture(from: pixelBuffer)
+        updateTexture(forLayer: Self.rightLayerID, from: pixelBuffer)
     }
 
     /// 清除所有纹理
     func clearTextures() {
         renderer?.clearTextures()
+        displayLink.wake()
     }
 
     // MARK: - 布局
 
     /// 设置是否交换位置
     func setSwapped(_ swapped: Bool) {
-        renderer?.isSwapped = swapped
-        needsDisplay = true
+        isSwapped = swapped
+        updateSideBySideLayout()
         AppLogger.rendering.info("交换状态已切换: \(swapped)")
     }
 
     /// 设置主屏幕区域（用于渲染左侧/上方设备）
     func setPrimaryScreenFrame(_ frame: CGRect) {
-        renderer?.primaryScreenFrame = frame
+        primaryScreenFrame = frame
+        updateSideBySideLayout()
     }
 
     /// 设置次屏幕区域（用于渲染右侧/下方设备）
     func setSecondaryScreenFrame(_ frame: CGRect) {
-        renderer?.secondaryScreenFrame = frame
+        secondaryScreenFrame = frame
+        updateSideBySideLayout()
     }
 
     /// 设置主屏幕圆角半径（用于渲染左侧/上方设备）
     func setPrimaryScreenCornerRadius(_ radius: CGFloat) {
-        renderer?.primaryScreenCornerRadius = radius
+        primaryScreenCornerRadius = radius
+        updateSideBySideLayout()
     }
 
     /// 设置次屏幕圆角半径（用于渲染右侧/下方设备）
     func setSecondaryScreenCornerRadius(_ radius: CGFloat) {
-        renderer?.secondaryScreenCornerRadius = radius
+        secondaryScreenCornerRadius = radius
+        updateSideBySideLayout()
     }
 
     // MARK: - 统计
 
     /// 左侧帧率
     var leftFPS: Double {
-        renderer?.leftFPS ?? 0
+        fps(forLayer: Self.leftLayerID)
     }
 
     /// 右侧帧率
     var rightFPS: Double {
-        renderer?.rightFPS ?? 0
+        fps(forLayer: Self.rightLayerID)
+    }
+}
+
+// MARK: - 内存压力
+
+extension MetalRenderView: MemoryPressureResponder {
+    func memoryPressureDidChange(to level: MemoryPressureLevel) {
+        guard level > .normal else { return }
+        // 缩放纹理只在渲染队列访问；画面已上屏，下一次渲染时按需重新分配
+        renderQueue.async { [weak self] in
+            self?.renderer?.trimCaches()
+        }
     }
 }
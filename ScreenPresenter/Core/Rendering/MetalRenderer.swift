@@ -13,11 +13,215 @@ import CoreMedia
 import CoreVideo
 import Metal
 import MetalKit
+import MetalPerformanceShaders
+import os.lock
 import QuartzCore
+import simd
+
+// MARK: - 帧纹理
+
+/// 一帧画面的 Metal 纹理
+/// iOS 捕获与 VideoToolbox 解码均输出 420v 双平面缓冲（iOS 捕获不支持时回退为 BGRA 单平面），Y 与 CbCr 平面分别导入，在着色器中转换为 RGB
+/// 像素缓冲由 IOSurface 承载，纹理直接引用其内存，导入过程不经过 CPU（见 ZeroCopyFrameContract）
+struct FrameTexture {
+    /// 保持对 CVMetalTexture 的强引用，确保 MTLTexture 不会失效
+    private let cvTextures: [CVMetalTexture]
+
+    /// 平面纹理：BGRA 为单个 bgra8Unorm 纹理，YCbCr 为 r8Unorm（Y）与 rg8Unorm（CbCr）两个纹理
+    let planes: [MTLTexture]
+
+    /// YCbCr → RGB 转换参数（BGRA 为 nil）
+    let yCbCrConversion: YCbCrConversionParams?
+
+    /// 是否为 YCbCr 双平面纹理
+    var isYCbCr: Bool {
+        yCbCrConversion != nil
+    }
+
+    /// 画面宽度（以首个平面为准，即 Y 平面的全分辨率）
+    var width: Int {
+        planes[0].width
+    }
+
+    /// 画面高度
+    var height: Int {
+        planes[0].height
+    }
+
+    /// 由已缩放的平面纹理构造帧纹理（平面为独立分配的 MTLTexture，无需持有 CVMetalTexture）
+    init(scaledPlanes planes: [MTLTexture], yCbCrConversion: YCbCrConversionParams?) {
+        cvTextures = []
+        self.planes = planes
+        self.yCbCrConversion = yCbCrConversion
+    }
+
+    private init(cvTextures: [CVMetalTexture], planes: [MTLTexture], yCbCrConversion: YCbCrConversionParams?) {
+        self.cvTextures = cvTextures
+        self.planes = planes
+        self.yCbCrConversion = yCbCrConversion
+    }
+
+    /// 从 CVPixelBuffer 创建帧纹理
+    /// - Parameters:
+    ///   - pixelBuffer: BGRA 或 420v/420f 像素缓冲
+    ///   - cache: 纹理缓存
+    /// - Returns: 帧纹理，导入失败时返回 nil
+    static func make(from pixelBuffer: CVPixelBuffer, cache: CVMetalTextureCache) -> FrameTexture? {
+        ZeroCopyFrameContract.assertUntouched(pixelBuffer, stage: "FrameTexture.make")
+
+        let pixelFormat = CVPixelBufferGetPixelFormatType(pixelBuffer)
+        let isBiPlanar = pixelFormat == kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange
+            || pixelFormat == kCVPixelFormatType_420YpCbCr8BiPlanarFullRange
+
+        guard isBiPlanar else {
+            guard let plane = makePlane(from: pixelBuffer, planeIndex: 0, format: .bgra8Unorm, cache: cache) else {
+                return nil
+            }
+            return FrameTexture(cvTextures: [plane.0], planes: [plane.1], yCbCrConversion: nil)
+        }
+
+        guard
+            let luma = makePlane(from: pixelBuffer, planeIndex: 0, format: .r8Unorm, cache: cache),
+            let chroma = makePlane(from: pixelBuffer, planeIndex: 1, format: .rg8Unorm, cache: cache)
+        else {
+            return nil
+        }
+        return FrameTexture(
+            cvTextures: [luma.0, chroma.0],
+            planes: [luma.1, chroma.1],
+            yCbCrConversion: YCbCrConversionParams(pixelBuffer: pixelBuffer)
+        )
+    }
+
+    /// 导入像素缓冲的单个平面
+    private static func makePlane(
+        from pixelBuffer: CVPixelBuffer,
+        planeIndex: Int,
+        format: MTLPixelFormat,
+        cache: CVMetalTextureCache
+    ) -> (CVMetalTexture, MTLTexture)? {
+        let isPlanar = CVPixelBufferIsPlanar(pixelBuffer)
+        let width = isPlanar ? CVPixelBufferGetWidthOfPlane(pixelBuffer, planeIndex) : CVPixelBufferGetWidth(pixelBuffer)
+        let height = isPlanar ? CVPixelBufferGetHeightOfPlane(pixelBuffer, planeIndex) : CVPixelBufferGetHeight(pixelBuffer)
+
+        var cvTexture: CVMetalTexture?
+        let status = CVMetalTextureCacheCreateTextureFromImage(
+            kCFAllocatorDefault,
+            cache,
+            pixelBuffer,
+            nil,
+            format,
+            width,
+            height,
+            planeIndex,
+            &cvTexture
+        )
+
+        guard status == kCVReturnSuccess, let cvTexture, let texture = CVMetalTextureGetTexture(cvTexture) else {
+            return nil
+        }
+        return (cvTexture, texture)
+    }
+}
+
+// MARK: - YCbCr 转换
+
+/// YCbCr → RGB 转换参数（与着色器中的定义匹配）
+/// rgb = colorMatrix * (ycbcr - offset)，矩阵已包含视频范围的缩放
+struct YCbCrConversionParams {
+    var colorMatrix: simd_float3x3
+    var offset: SIMD3<Float>
+
+    /// 根据像素缓冲的范围与 YCbCr 矩阵附件生成转换参数
+    /// 未标记矩阵时按 BT.709 处理（高清码流的默认值）
+    init(pixelBuffer: CVPixelBuffer) {
+        let isFullRange = CVPixelBufferGetPixelFormatType(pixelBuffer) == kCVPixelFormatType_420YpCbCr8BiPlanarFullRange
+        let lumaScale: Float = isFullRange ? 1.0 : 255.0 / 219.0
+        let chromaScale: Float = isFullRange ? 1.0 : 255.0 / 224.0
+        offset = SIMD3<Float>(isFullRange ? 0.0 : 16.0 / 255.0, 128.0 / 255.0, 128.0 / 255.0)
+
+        let matrixKey = CVBufferCopyAttachment(pixelBuffer, kCVImageBufferYCbCrMatrixKey, nil) as? String
+        let isBT601 = matrixKey == (kCVImageBufferYCbCrMatrix_ITU_R_601_4 as String)
+
+        // 亮度与色差系数：R = Y + a·Cr，G = Y - b·Cb - c·Cr，B = Y + d·Cb
+        let (a, b, c, d): (Float, Float, Float, Float) = isBT601
+            ? (1.402, 0.3441, 0.7141, 1.772)
+            : (1.5748, 0.1873, 0.4681, 1.8556)
+
+        // 按列（Y、Cb、Cr）组织
+        colorMatrix = simd_float3x3(
+            SIMD3<Float>(lumaScale, lumaScale, lumaScale),
+            SIMD3<Float>(0, -b * chromaScale, d * chromaScale),
+            SIMD3<Float>(a * chromaScale, -c * chromaScale, 0)
+        )
+    }
+
+    /// 恒等转换（BGRA 画面在合成器中占位用）
+    static let identity = YCbCrConversionParams(colorMatrix: matrix_identity_float3x3, offset: .zero)
+
+    private init(colorMatrix: simd_float3x3, offset: SIMD3<Float>) {
+        self.colorMatrix = colorMatrix
+        self.offset = offset
+    }
+
+    /// 着色器中的定义与采样函数，供各渲染器的着色器源码内嵌
+    static let shaderSource = """
+    struct YCbCrConversionParams {
+        float3x3 colorMatrix;
+        float3 offset;
+    };
+
+    // 采样 Y 与 CbCr 平面并转换为 RGB
+    float4 sampleYCbCr(texture2d<float> luma,
+                       texture2d<float> chroma,
+                       sampler s,
+                       float2 texCoord,
+                       constant YCbCrConversionParams &params) {
+        float3 ycbcr = float3(luma.sample(s, texCoord).r, chroma.sample(s, texCoord).rg);
+        return float4(saturate(params.colorMatrix * (ycbcr - params.offset)), 1.0);
+    }
+    """
+}
+
+// MARK: - 合成图层
+
+/// 合成器中一路设备画面的布局
+/// 所有坐标均为视图坐标系（点，原点在左下角）
+struct CompositorLayerLayout {
+    /// 设备屏幕区域，画面按纵横比适配到该区域内
+    var screenFrame: CGRect
+
+    /// 屏幕圆角半径（点）
+    var cornerRadius: CGFloat = 0
+
+    /// 绕屏幕区域中心施加的变换（旋转、缩放、平移）
+    var transform: CGAffineTransform = .identity
+
+    /// 设备边框区域，nil 时使用屏幕区域
+    var bezelFrame: CGRect?
+
+    /// 叠放次序，较大者绘制在上层
+    var zIndex: Int = 0
+}
 
 // MARK: - Metal 渲染器
 
+/// N 路设备画面合成器
+/// 每路设备为一个图层（变换、圆角、可选边框纹理），所有图层在一个渲染通道中
+/// 以实例化四边形一次绘制完成：每个实例的参数来自实例缓冲区，纹理来自同一个参数缓冲区
+/// 4–9 台设备同屏时只需一个 CAMetalLayer 和一个命令缓冲区
 final class MetalRenderer {
+    // MARK: - 常量
+
+    /// 最大图层数
+    static let maxLayerCount = 16
+
+    /// 最大实例数（每个图层最多一个边框实例和一个画面实例）
+    private static let maxInstanceCount = maxLayerCount * 2
+
+    /// 同时在 GPU 上处理的帧数（实例缓冲区与参数缓冲区按此数量轮换）
+    private static let maxFramesInFlight = 3
+
     // MARK: - Metal 核心对象
 
     private let device: MTLDevice
@@ -27,35 +231,86 @@ final class MetalRenderer {
 
     // MARK: - 渲染状态
 
-    private var vertexBuffer: MTLBuffer?
     private let samplerState: MTLSamplerState
 
-    // MARK: - 纹理
+    /// 3D LUT 采样器（三线性插值）
+    private let lutSamplerState: MTLSamplerState
+
+    /// 按帧轮换的实例缓冲区
+    private let instanceBuffers: [MTLBuffer]
+
+    /// 按帧轮换的纹理参数缓冲区
+    private let argumentBuffers: [MTLBuffer]
+
+    /// 纹理参数缓冲区编码器
+    private let argumentEncoder: MTLArgumentEncoder
+
+    /// 限制在途帧数，避免覆盖 GPU 仍在读取的缓冲区
+    private let inFlightSemaphore = DispatchSemaphore(value: MetalRenderer.maxFramesInFlight)
+
+    /// 当前帧使用的缓冲区下标（仅在渲染队列访问）
+    private var frameIndex = 0
+
+    // MARK: - 缩放
+
+    /// 画面缩小到该比例以下时先经 Lanczos 缩放到屏幕尺寸，避免单次双线性采样产生混叠
+    private static let downscaleThreshold: CGFloat = 0.9
+
+    /// Lanczos 缩放核（设备不支持 MPS 时为 nil，回退为直接采样）
+    private let lanczosScale: MPSImageLanczosScale?
 
-    private(set) var leftTexture: MTLTexture?
-    private(set) var rightTexture: MTLTexture?
+    /// 每个图层缩放后的中间纹理
+    private struct ScaledTexture {
+        /// 缩放后的平面纹理（BGRA 一个，YCbCr 为 Y 与 CbCr 两个）
+        let planes: [MTLTexture]
+        /// 生成该结果的源画面计数
+        var sourceGeneration: UInt64
+    }
 
-    // MARK: - 统计
+    /// 缩放缓存（仅在渲染队列访问）
+    /// 尺寸只随布局变化重新分配，新画面到达时复用已分配的纹理重新缩放
+    private var scaledTextures: [Int: ScaledTexture] = [:]
+
+    // MARK: - 图层
+
+    /// 图层状态
+    private struct LayerState {
+        let id: Int
+        var layout: CompositorLayerLayout
+        var texture: FrameTexture?
+        /// 画面更新计数，用于判断缩放缓存是否过期
+        var textureGeneration: UInt64 = 0
+        var bezelTexture: MTLTexture?
+        /// 颜色补偿滤镜，启用时在合成的片段着色器中应用其 3D LUT
+        var colorFilter: ColorCompensationFilter?
+        var frameTimestamps: [CFAbsoluteTime] = []
+        var fps: Double = 0
+    }
 
-    private(set) var leftFPS: Double = 0
-    private(set) var rightFPS: Double = 0
-    private var leftFrameTimestamps: [CFAbsoluteTime] = []
-    private var rightFrameTimestamps: [CFAbsoluteTime] = []
+    /// 合成器状态
+    /// 纹理可能在解码/捕获线程更新，布局在主线程更新，渲染在渲染队列执行，因此用锁保护
+    private struct CompositorState {
+        var layers: [Int: LayerState] = [:]
+        /// 自上次渲染以来是否有纹理或布局变化
+        var isDirty = true
+    }
 
-    // MARK: - 布局
+    private let state = OSAllocatedUnfairLock(initialState: CompositorState())
 
-    var isSwapped: Bool = false
+    /// 上次渲染时的 drawable 尺寸（仅在渲染队列访问）
+    private var lastDrawableSize: CGSize = .zero
 
-    // MARK: - 屏幕区域（用于渲染到设备边框内）
+    /// 是否有待渲染的变化
+    var needsRender: Bool {
+        state.withLock { $0.isDirty }
+    }
 
-    /// 左侧/上方设备的屏幕区域（在视图坐标系中）
-    var primaryScreenFrame: CGRect = .zero
-    /// 右侧/下方设备的屏幕区域（在视图坐标系中）
-    var secondaryScreenFrame: CGRect = .zero
-    /// 左侧/上方设备的屏幕圆角半径
-    var primaryScreenCornerRadius: CGFloat = 0
-    /// 右侧/下方设备的屏幕圆角半径
-    var secondaryScreenCornerRadius: CGFloat = 0
+    /// 图层标识（按叠放次序排列）
+    var layerIDs: [Int] {
+        state.withLock { state in
+            state.layers.sorted { $0.value.layout.zIndex < $1.value.layout.zIndex }.map(\.key)
+        }
+    }
 
     // MARK: - 初始化
 
@@ -89,12 +344,35 @@ final class MetalRenderer {
         }
         self.textureCache = textureCache
 
-        // 创建渲染管线
-        guard let pipelineState = MetalRenderer.createPipelineState(device: device) else {
+        // 创建渲染管线与纹理参数编码器
+        guard
+            let library = device.makeDefaultLibrary() ?? MetalRenderer.createShaderLibrary(device: device),
+            let pipelineState = MetalRenderer.createPipelineState(device: device, library: library),
+            let fragmentFunction = library.makeFunction(name: "compositorFragment")
+        else {
             AppLogger.rendering.error("无法创建渲染管线")
             return nil
         }
         self.pipelineState = pipelineState
+        argumentEncoder = fragmentFunction.makeArgumentEncoder(bufferIndex: 0)
+
+        // 创建实例缓冲区与纹理参数缓冲区
+        let instanceLength = MemoryLayout<LayerInstance>.stride * MetalRenderer.maxInstanceCount
+        var instanceBuffers: [MTLBuffer] = []
+        var argumentBuffers: [MTLBuffer] = []
+        for _ in 0..<MetalRenderer.maxFramesInFlight {
+            guard
+                let instanceBuffer = device.makeBuffer(length: instanceLength, options: .storageModeShared),
+                let argumentBuffer = device.makeBuffer(length: argumentEncoder.encodedLength, options: .storageModeShared)
+            else {
+                AppLogger.rendering.error("无法创建合成缓冲区")
+                return nil
+            }
+            instanceBuffers.append(instanceBuffer)
+            argumentBuffers.append(argumentBuffer)
+        }
+        self.instanceBuffers = instanceBuffers
+        self.argumentBuffers = argumentBuffers
 
         // 创建采样器
         let samplerDescriptor = MTLSamplerDescriptor()
@@ -109,70 +387,143 @@ final class MetalRenderer {
         }
         samplerState = sampler
 
-        // 创建顶点缓冲区
-        setupVertexBuffer()
+        guard let lutSampler = device.makeSamplerState(descriptor: ColorCompensationFilter.createLUTSamplerDescriptor()) else {
+            AppLogger.rendering.error("无法创建 LUT 采样器")
+            return nil
+        }
+        lutSamplerState = lutSampler
+
+        // 创建 Lanczos 缩放核
+        lanczosScale = MPSSupportsMTLDevice(device) ? MPSImageLanczosScale(device: device) : nil
 
         AppLogger.rendering.info("Metal 渲染器初始化成功")
     }
 
-    // MARK: - 纹理更新
-
-    /// 更新左侧纹理（从 CVPixelBuffer）
-    func updateLeftTexture(from pixelBuffer: CVPixelBuffer) {
-        leftTexture = createTexture(from: pixelBuffer)
-        updateFPSStatistics(for: &leftFrameTimestamps, fps: &leftFPS)
+    // MARK: - 图层管理
+
+    /// 添加或更新图层布局
+    /// - Parameters:
+    ///   - layout: 图层布局
+    ///   - id: 图层标识
+    func setLayout(_ layout: CompositorLayerLayout, forLayer id: Int) {
+        state.withLock { state in
+            if state.layers[id] == nil {
+                guard state.layers.count < MetalRenderer.maxLayerCount else {
+                    AppLogger.rendering.warning("合成图层数已达上限 \(MetalRenderer.maxLayerCount)，忽略图层 \(id)")
+                    return
+                }
+                state.layers[id] = LayerState(id: id, layout: layout)
+            } else {
+                state.layers[id]?.layout = layout
+            }
+            state.isDirty = true
+        }
     }
 
-    /// 更新右侧纹理（从 CVPixelBuffer）
-    func updateRightTexture(from pixelBuffer: CVPixelBuffer) {
-        rightTexture = createTexture(from: pixelBuffer)
-        updateFPSStatistics(for: &rightFrameTimestamps, fps: &rightFPS)
+    /// 移除图层
+    func removeLayer(_ id: Int) {
+        state.withLock { state in
+            state.layers[id] = nil
+            state.isDirty = true
+        }
     }
 
-    /// 从 CVPixelBuffer 创建 MTLTexture
-    private func createTexture(from pixelBuffer: CVPixelBuffer) -> MTLTexture? {
-        guard let cache = textureCache else { return nil }
-
-        let width = CVPixelBufferGetWidth(pixelBuffer)
-        let height = CVPixelBufferGetHeight(pixelBuffer)
+    /// 更新图层画面（从 CVPixelBuffer）
+    func updateTexture(forLayer id: Int, from pixelBuffer: CVPixelBuffer) {
+        // 纹理导入在锁外完成，锁内只替换引用
+        let texture = createTexture(from: pixelBuffer)
+        let now = CFAbsoluteTimeGetCurrent()
+        state.withLock { state in
+            guard state.layers[id] != nil else { return }
+            state.layers[id]?.texture = texture
+            state.layers[id]?.textureGeneration &+= 1
+            MetalRenderer.updateFPSStatistics(for: &state.layers[id]!, now: now)
+            state.isDirty = true
+        }
+    }
 
-        var cvTexture: CVMetalTexture?
-        let status = CVMetalTextureCacheCreateTextureFromImage(
-            kCFAllocatorDefault,
-            cache,
-            pixelBuffer,
-            nil,
-            .bgra8Unorm,
-            width,
-            height,
-            0,
-            &cvTexture
-        )
+    /// 设置图层的设备边框纹理（BGRA），绘制在画面下方，nil 表示不绘制边框
+    func setBezelTexture(_ texture: MTLTexture?, forLayer id: Int) {
+        state.withLock { state in
+            guard state.layers[id] != nil else { return }
+            state.layers[id]?.bezelTexture = texture
+            state.isDirty = true
+        }
+    }
 
-        guard status == kCVReturnSuccess, let texture = cvTexture else {
-            return nil
+    /// 设置图层的颜色补偿滤镜，nil 表示不补偿
+    /// 补偿在合成时随画面采样一并完成，不需要额外的中间纹理和渲染通道
+    func setColorFilter(_ filter: ColorCompensationFilter?, forLayer id: Int) {
+        state.withLock { state in
+            guard state.layers[id] != nil else { return }
+            state.layers[id]?.colorFilter = filter
+            state.isDirty = true
         }
+    }
+
+    /// 图层帧率
+    func fps(forLayer id: Int) -> Double {
+        state.withLock { $0.layers[id]?.fps ?? 0 }
+    }
 
-        return CVMetalTextureGetTexture(texture)
+    /// 从 CVPixelBuffer 创建帧纹理（BGRA 或 YCbCr 双平面）
+    private func createTexture(from pixelBuffer: CVPixelBuffer) -> FrameTexture? {
+        guard let cache = textureCache else { return nil }
+        return FrameTexture.make(from: pixelBuffer, cache: cache)
     }
 
     // MARK: - 渲染
 
+    /// 标记需要重新渲染（纹理或布局变化时调用）
+    func setNeedsRender() {
+        state.withLock { $0.isDirty = true }
+    }
+
     /// 渲染到 CAMetalLayer
-    func render(to layer: CAMetalLayer) {
+    /// 自上次渲染以来纹理、布局与 drawable 尺寸都没有变化时直接跳过，不获取 drawable、不编码命令
+    /// - Parameters:
+    ///   - layer: 目标图层
+    ///   - completion: GPU 执行完该帧后调用（仅在实际渲染时调用；离屏图层没有上屏时间，以此作为呈现时间）
+    /// - Returns: 是否实际渲染了一帧
+    @discardableResult
+    func render(to layer: CAMetalLayer, completion: (() -> Void)? = nil) -> Bool {
         // 检查 drawable size 是否有效
         let drawableSize = layer.drawableSize
         guard drawableSize.width > 0, drawableSize.height > 0 else {
             // drawable size 无效时跳过渲染（窗口可能尚未布局完成）
-            return
+            return false
+        }
+
+        // 取出图层快照并清除脏标记；drawable 尺寸变化同样需要重绘
+        let (isDirty, layers) = state.withLock { state -> (Bool, [LayerState]) in
+            defer { state.isDirty = false }
+            let layers = state.layers.values.sorted { $0.layout.zIndex < $1.layout.zIndex }
+            return (state.isDirty, layers)
+        }
+        guard isDirty || drawableSize != lastDrawableSize else {
+            return false
         }
 
         guard let drawable = layer.nextDrawable() else {
             // nextDrawable 返回 nil 通常是正常情况（窗口最小化、资源不足等）
             // 不需要记录错误日志，避免控制台输出过多
-            return
+            // 保留脏标记，下一次 vsync 重试
+            setNeedsRender()
+            return false
         }
-        guard let commandBuffer = commandQueue.makeCommandBuffer() else { return }
+        guard let commandBuffer = commandQueue.makeCommandBuffer() else {
+            setNeedsRender()
+            return false
+        }
+        lastDrawableSize = drawableSize
+
+        let viewSize = CGSize(
+            width: drawableSize.width / layer.contentsScale,
+            height: drawableSize.height / layer.contentsScale
+        )
+
+        // 在渲染通道之前把远大于屏幕区域的画面缩放到屏幕尺寸
+        let scaledLayers = downscaleLayers(layers, commandBuffer: commandBuffer, contentsScale: layer.contentsScale)
 
         let renderPassDescriptor = MTLRenderPassDescriptor()
         renderPassDescriptor.colorAttachments[0].texture = drawable.texture
@@ -181,180 +532,294 @@ final class MetalRenderer {
         renderPassDescriptor.colorAttachments[0].storeAction = .store
 
         guard let encoder = commandBuffer.makeRenderCommandEncoder(descriptor: renderPassDescriptor) else {
-            return
+            setNeedsRender()
+            return false
         }
 
-        encoder.setRenderPipelineState(pipelineState)
-        encoder.setFragmentSamplerState(samplerState, index: 0)
+        // 等待该帧的缓冲区空闲后再写入
+        inFlightSemaphore.wait()
+        let semaphore = inFlightSemaphore
+        commandBuffer.addCompletedHandler { _ in
+            semaphore.signal()
+            completion?()
+        }
 
-        // 渲染左右并排布局
-        renderSideBySide(encoder: encoder, drawableSize: drawableSize)
+        encodeLayers(scaledLayers, encoder: encoder, viewSize: viewSize)
 
         encoder.endEncoding()
         commandBuffer.present(drawable)
         commandBuffer.commit()
+
+        frameIndex = (frameIndex + 1) % MetalRenderer.maxFramesInFlight
+        return true
     }
 
-    // MARK: - 布局渲染
-
-    /// 左右并排渲染
-    private func renderSideBySide(encoder: MTLRenderCommandEncoder, drawableSize: CGSize) {
-        // 确定左右纹理和圆角
-        let (leftTex, rightTex) = isSwapped ? (rightTexture, leftTexture) : (leftTexture, rightTexture)
-        let (leftRadius, rightRadius) = isSwapped
-            ? (secondaryScreenCornerRadius, primaryScreenCornerRadius)
-            : (primaryScreenCornerRadius, secondaryScreenCornerRadius)
-
-        // 渲染左侧（主屏幕区域）
-        if let texture = leftTex {
-            renderTextureInScreenFrame(
-                texture,
-                encoder: encoder,
-                screenFrame: primaryScreenFrame,
-                drawableSize: drawableSize,
-                cornerRadius: leftRadius
-            )
-        }
+    // MARK: - 缩放
+
+    /// 把画面明显大于屏幕区域的图层缩放到屏幕像素尺寸
+    /// 中间纹理按图层缓存，只在目标尺寸（布局）变化时重新分配；源画面未变化时直接复用上次结果
+    /// - Returns: 画面替换为缩放结果后的图层
+    private func downscaleLayers(
+        _ layers: [LayerState],
+        commandBuffer: MTLCommandBuffer,
+        contentsScale: CGFloat
+    ) -> [LayerState] {
+        // 清理已移除图层的缓存
+        let layerIDs = Set(layers.map(\.id))
+        scaledTextures = scaledTextures.filter { layerIDs.contains($0.key) }
+
+        guard let lanczosScale else { return layers }
+
+        return layers.map { layer in
+            guard let texture = layer.texture else {
+                scaledTextures[layer.id] = nil
+                return layer
+            }
 
-        // 渲染右侧（次屏幕区域）
-        if let texture = rightTex {
-            renderTextureInScreenFrame(
-                texture,
-                encoder: encoder,
-                screenFrame: secondaryScreenFrame,
-                drawableSize: drawableSize,
-                cornerRadius: rightRadius
+            // 屏幕区域内画面的像素尺寸（计入图层变换的缩放）
+            let layout = layer.layout
+            let contentFrame = aspectFitFrame(
+                textureSize: CGSize(width: texture.width, height: texture.height),
+                in: layout.screenFrame
             )
+            let transformScale = sqrt(abs(layout.transform.a * layout.transform.d - layout.transform.b * layout.transform.c))
+            let targetWidth = Int((contentFrame.width * contentsScale * transformScale).rounded(.up))
+            let targetHeight = Int((contentFrame.height * contentsScale * transformScale).rounded(.up))
+
+            guard
+                targetWidth > 1, targetHeight > 1,
+                CGFloat(targetWidth) < CGFloat(texture.width) * MetalRenderer.downscaleThreshold,
+                CGFloat(targetHeight) < CGFloat(texture.height) * MetalRenderer.downscaleThreshold
+            else {
+                scaledTextures[layer.id] = nil
+                return layer
+            }
+
+            guard var scaled = scaledTexture(for: layer.id, source: texture, width: targetWidth, height: targetHeight) else {
+                return layer
+            }
+            if scaled.sourceGeneration != layer.textureGeneration {
+                for (source, destination) in zip(texture.planes, scaled.planes) {
+                    lanczosScale.encode(commandBuffer: commandBuffer, sourceTexture: source, destinationTexture: destination)
+                }
+                scaled.sourceGeneration = layer.textureGeneration
+                scaledTextures[layer.id] = scaled
+            }
+
+            var scaledLayer = layer
+            scaledLayer.texture = FrameTexture(scaledPlanes: scaled.planes, yCbCrConversion: texture.yCbCrConversion)
+            return scaledLayer
         }
     }
 
-    /// 渲染纹理到指定的屏幕区域
-    private func renderTextureInScreenFrame(
-        _ texture: MTLTexture,
-        encoder: MTLRenderCommandEncoder,
-        screenFrame: CGRect,
-        drawableSize: CGSize,
-        cornerRadius: CGFloat = 0
-    ) {
-        guard screenFrame.width > 0, screenFrame.height > 0 else { return }
-
-        // 计算视口比例（从视图坐标转换为 drawable 坐标）
-        let viewWidth = drawableSize.width / (NSScreen.main?.backingScaleFactor ?? 2.0)
-        let viewHeight = drawableSize.height / (NSScreen.main?.backingScaleFactor ?? 2.0)
+    /// 取得图层的缩放纹理，目标尺寸或平面格式变化时重新分配
+    private func scaledTexture(for id: Int, source: FrameTexture, width: Int, height: Int) -> ScaledTexture? {
+        if
+            let cached = scaledTextures[id],
+            cached.planes[0].width == width,
+            cached.planes[0].height == height,
+            cached.planes.map(\.pixelFormat) == source.planes.map(\.pixelFormat)
+        {
+            return cached
+        }
 
-        let scaleX = drawableSize.width / viewWidth
-        let scaleY = drawableSize.height / viewHeight
+        // YCbCr 的 CbCr 平面为 Y 平面的一半
+        var planes: [MTLTexture] = []
+        for (index, plane) in source.planes.enumerated() {
+            let divisor = index == 0 ? 1 : 2
+            let descriptor = MTLTextureDescriptor.texture2DDescriptor(
+                pixelFormat: plane.pixelFormat,
+                width: max(1, width / divisor),
+                height: max(1, height / divisor),
+                mipmapped: false
+            )
+            descriptor.usage = [.shaderRead, .shaderWrite]
+            descriptor.storageMode = .private
+            guard let texture = device.makeTexture(descriptor: descriptor) else {
+                return nil
+            }
+            planes.append(texture)
+        }
 
-        // Metal 坐标系原点在左下角，而 NSView 坐标系原点在左下角（但 Y 向上）
-        // 所以需要翻转 Y 坐标
-        let flippedY = viewHeight - screenFrame.maxY
+        // 新分配的纹理一定需要重新缩放
+        let scaled = ScaledTexture(planes: planes, sourceGeneration: .max)
+        scaledTextures[id] = scaled
+        return scaled
+    }
 
-        let viewport = MTLViewport(
-            originX: Double(screenFrame.minX * scaleX),
-            originY: Double(flippedY * scaleY),
-            width: Double(screenFrame.width * scaleX),
-            height: Double(screenFrame.height * scaleY),
-            znear: 0,
-            zfar: 1
-        )
+    // MARK: - 图层合成
 
-        renderTexture(
-            texture,
-            encoder: encoder,
-            viewport: viewport,
-            containerSize: screenFrame.size,
-            cornerRadius: cornerRadius
-        )
+    /// 实例类型（与着色器中的定义匹配）
+    private enum InstanceKind: UInt32 {
+        case bgra = 0
+        case yCbCr = 1
+        case bezel = 2
     }
 
-    /// 圆角参数结构体（与着色器中的定义匹配）
-    private struct RoundedRectParams {
+    /// 实例类型之外的标志位（与着色器中的定义匹配）
+    private static let colorCompensationFlag: UInt32 = 1 << 8
+
+    /// 单个实例的参数（与着色器中的定义匹配）
+    private struct LayerInstance {
+        /// 将单位四边形（-1...1）映射到裁剪空间的仿射变换
+        var positionTransform: simd_float3x3
+        /// YCbCr → RGB 转换参数（BGRA 实例不使用）
+        var conversion: YCbCrConversionParams
+        /// 画面半尺寸（点），用于计算圆角
+        var halfSize: SIMD2<Float>
+        /// 圆角半径（点）
         var cornerRadius: Float
-        var aspectRatio: Float
+        /// 低 8 位为实例类型，其余为标志位
+        var kind: UInt32
     }
 
-    /// 渲染单个纹理（保持纵横比）
-    private func renderTexture(
-        _ texture: MTLTexture,
-        encoder: MTLRenderCommandEncoder,
-        viewport: MTLViewport,
-        containerSize: CGSize,
-        cornerRadius: CGFloat = 0
-    ) {
-        encoder.setViewport(viewport)
+    /// 把所有图层写入实例缓冲区与纹理参数缓冲区，并以一次实例化绘制完成合成
+    private func encodeLayers(_ layers: [LayerState], encoder: MTLRenderCommandEncoder, viewSize: CGSize) {
+        guard viewSize.width > 0, viewSize.height > 0 else { return }
+
+        let instanceBuffer = instanceBuffers[frameIndex]
+        let argumentBuffer = argumentBuffers[frameIndex]
+        let instances = instanceBuffer.contents().bindMemory(to: LayerInstance.self, capacity: MetalRenderer.maxInstanceCount)
+        argumentEncoder.setArgumentBuffer(argumentBuffer, offset: 0)
+
+        var instanceCount = 0
+        var usedTextures: [MTLTexture] = []
+
+        func append(_ instance: LayerInstance, primary: MTLTexture, chroma: MTLTexture?, lut: MTLTexture? = nil) {
+            instances[instanceCount] = instance
+            argumentEncoder.setTexture(primary, index: instanceCount)
+            argumentEncoder.setTexture(chroma, index: MetalRenderer.maxInstanceCount + instanceCount)
+            argumentEncoder.setTexture(lut, index: MetalRenderer.maxInstanceCount * 2 + instanceCount)
+            usedTextures.append(primary)
+            usedTextures.append(contentsOf: [chroma, lut].compactMap { $0 })
+            instanceCount += 1
+        }
+
+        for layer in layers {
+            let layout = layer.layout
+            guard layout.screenFrame.width > 0, layout.screenFrame.height > 0 else { continue }
+            let center = CGPoint(x: layout.screenFrame.midX, y: layout.screenFrame.midY)
+
+            // 边框绘制在画面下方，铺满边框区域
+            if let bezelTexture = layer.bezelTexture {
+                let bezelFrame = layout.bezelFrame ?? layout.screenFrame
+                append(
+                    LayerInstance(
+                        positionTransform: positionTransform(
+                            for: bezelFrame,
+                            center: center,
+                            transform: layout.transform,
+                            viewSize: viewSize
+                        ),
+                        conversion: YCbCrConversionParams.identity,
+                        halfSize: SIMD2<Float>(Float(bezelFrame.width / 2), Float(bezelFrame.height / 2)),
+                        cornerRadius: 0,
+                        kind: InstanceKind.bezel.rawValue
+                    ),
+                    primary: bezelTexture,
+                    chroma: nil
+                )
+            }
+
+            guard let texture = layer.texture else { continue }
+
+            // 颜色补偿启用时附带 3D LUT
+            let lut = layer.colorFilter.flatMap { $0.isActive ? $0.getLUT3DTexture() : nil }
+            var kind = (texture.isYCbCr ? InstanceKind.yCbCr : InstanceKind.bgra).rawValue
+            if lut != nil {
+                kind |= MetalRenderer.colorCompensationFlag
+            }
+
+            // 保持纵横比，适配到屏幕区域内
+            let contentFrame = aspectFitFrame(
+                textureSize: CGSize(width: texture.width, height: texture.height),
+                in: layout.screenFrame
+            )
+            append(
+                LayerInstance(
+                    positionTransform: positionTransform(
+                        for: contentFrame,
+                        center: center,
+                        transform: layout.transform,
+                        viewSize: viewSize
+                    ),
+                    conversion: texture.yCbCrConversion ?? YCbCrConversionParams.identity,
+                    halfSize: SIMD2<Float>(Float(contentFrame.width / 2), Float(contentFrame.height / 2)),
+                    cornerRadius: Float(min(layout.cornerRadius, min(contentFrame.width, contentFrame.height) / 2)),
+                    kind: kind
+                ),
+                primary: texture.planes[0],
+                chroma: texture.isYCbCr ? texture.planes[1] : nil,
+                lut: lut
+            )
+        }
+
+        guard instanceCount > 0 else { return }
 
-        // 计算保持纵横比的顶点
-        let textureAspect = CGFloat(texture.width) / CGFloat(texture.height)
-        let containerAspect = containerSize.width / containerSize.height
+        encoder.setRenderPipelineState(pipelineState)
+        encoder.setVertexBuffer(instanceBuffer, offset: 0, index: 0)
+        encoder.setFragmentBuffer(instanceBuffer, offset: 0, index: 1)
+        encoder.setFragmentBuffer(argumentBuffer, offset: 0, index: 0)
+        encoder.setFragmentSamplerState(samplerState, index: 0)
+        encoder.setFragmentSamplerState(lutSamplerState, index: 1)
+        // 参数缓冲区中的纹理需要显式声明驻留
+        encoder.useResources(usedTextures, usage: .read, stages: .fragment)
+        encoder.drawPrimitives(type: .triangleStrip, vertexStart: 0, vertexCount: 4, instanceCount: instanceCount)
+    }
 
-        var scaleX: Float = 1.0
-        var scaleY: Float = 1.0
+    /// 按纵横比将纹理适配到容器区域中
+    private func aspectFitFrame(textureSize: CGSize, in container: CGRect) -> CGRect {
+        guard textureSize.width > 0, textureSize.height > 0 else { return container }
 
+        let textureAspect = textureSize.width / textureSize.height
+        let containerAspect = container.width / container.height
+
+        var size = container.size
         if textureAspect > containerAspect {
             // 纹理更宽，以宽度为准
-            scaleY = Float(containerAspect / textureAspect)
+            size.height = container.width / textureAspect
         } else {
             // 纹理更高，以高度为准
-            scaleX = Float(textureAspect / containerAspect)
-        }
-
-        // 更新顶点数据
-        let vertices: [Float] = [
-            // 位置 (x, y)       // 纹理坐标 (u, v)
-            -scaleX, -scaleY, 0.0, 1.0, // 左下
-            scaleX, -scaleY, 1.0, 1.0, // 右下
-            -scaleX, scaleY, 0.0, 0.0, // 左上
-            scaleX, scaleY, 1.0, 0.0, // 右上
-        ]
-
-        // 计算归一化的圆角半径
-        // 圆角半径相对于容器高度的比例，转换为 -1 到 1 坐标系
-        let normalizedCornerRadius = Float(cornerRadius / containerSize.height) * 2.0 * scaleY
-
-        // 设置圆角参数
-        var params = RoundedRectParams(
-            cornerRadius: normalizedCornerRadius,
-            aspectRatio: scaleX / scaleY
+            size.width = container.height * textureAspect
+        }
+        return CGRect(
+            x: container.midX - size.width / 2,
+            y: container.midY - size.height / 2,
+            width: size.width,
+            height: size.height
         )
-
-        encoder.setVertexBytes(vertices, length: vertices.count * MemoryLayout<Float>.size, index: 0)
-        encoder.setFragmentTexture(texture, index: 0)
-        encoder.setFragmentBytes(&params, length: MemoryLayout<RoundedRectParams>.size, index: 0)
-        encoder.drawPrimitives(type: .triangleStrip, vertexStart: 0, vertexCount: 4)
     }
 
-    // MARK: - 辅助方法
-
-    private func setupVertexBuffer() {
-        // 默认全屏四边形顶点
-        let vertices: [Float] = [
-            // 位置 (x, y)       // 纹理坐标 (u, v)
-            -1.0, -1.0, 0.0, 1.0, // 左下
-            1.0, -1.0, 1.0, 1.0, // 右下
-            -1.0, 1.0, 0.0, 0.0, // 左上
-            1.0, 1.0, 1.0, 0.0, // 右上
-        ]
-
-        vertexBuffer = device.makeBuffer(
-            bytes: vertices,
-            length: vertices.count * MemoryLayout<Float>.size,
-            options: .storageModeShared
+    /// 计算把单位四边形映射到裁剪空间中指定区域的仿射变换
+    /// 先映射到视图坐标，再绕图层中心施加图层变换，最后归一化到 -1...1
+    private func positionTransform(
+        for frame: CGRect,
+        center: CGPoint,
+        transform: CGAffineTransform,
+        viewSize: CGSize
+    ) -> simd_float3x3 {
+        let toView = CGAffineTransform(a: frame.width / 2, b: 0, c: 0, d: frame.height / 2, tx: frame.midX, ty: frame.midY)
+        let aroundCenter = CGAffineTransform(translationX: -center.x, y: -center.y)
+            .concatenating(transform)
+            .concatenating(CGAffineTransform(translationX: center.x, y: center.y))
+        // NSView 与 Metal 裁剪空间的 Y 轴都向上，无需翻转
+        let toClip = CGAffineTransform(a: 2 / viewSize.width, b: 0, c: 0, d: 2 / viewSize.height, tx: -1, ty: -1)
+        let m = toView.concatenating(aroundCenter).concatenating(toClip)
+
+        // 按列组织
+        return simd_float3x3(
+            SIMD3<Float>(Float(m.a), Float(m.b), 0),
+            SIMD3<Float>(Float(m.c), Float(m.d), 0),
+            SIMD3<Float>(Float(m.tx), Float(m.ty), 1)
         )
     }
 
-    private static func createPipelineState(device: MTLDevice) -> MTLRenderPipelineState? {
-        // 创建着色器库
-        guard let library = device.makeDefaultLibrary() ?? createShaderLibrary(device: device) else {
-            AppLogger.rendering.error("无法创建着色器库")
-            return nil
-        }
-
-        let vertexFunction = library.makeFunction(name: "vertexShader")
-        let fragmentFunction = library.makeFunction(name: "fragmentShader")
+    // MARK: - 辅助方法
 
+    private static func createPipelineState(device: MTLDevice, library: MTLLibrary) -> MTLRenderPipelineState? {
         let descriptor = MTLRenderPipelineDescriptor()
-        descriptor.vertexFunction = vertexFunction
-        descriptor.fragmentFunction = fragmentFunction
+        descriptor.vertexFunction = library.makeFunction(name: "compositorVertex")
+        descriptor.fragmentFunction = library.makeFunction(name: "compositorFragment")
         descriptor.colorAttachments[0].pixelFormat = .bgra8Unorm
         // 启用 alpha 混合以支持透明背景
         descriptor.colorAttachments[0].isBlendingEnabled = true
@@ -376,25 +841,45 @@ final class MetalRenderer {
         #include <metal_stdlib>
         using namespace metal;
 
+        #define MAX_INSTANCES \(maxInstanceCount)
+
+        \(YCbCrConversionParams.shaderSource)
+
+        // 实例参数（通过实例缓冲区传递）
+        struct LayerInstance {
+            float3x3 positionTransform;         // 单位四边形 → 裁剪空间
+            YCbCrConversionParams conversion;   // YCbCr → RGB 转换参数
+            float2 halfSize;                    // 画面半尺寸（点）
+            float cornerRadius;                 // 圆角半径（点）
+            uint kind;                          // 低 8 位 0: BGRA，1: YCbCr，2: 边框；第 8 位: 颜色补偿
+        };
+
+        // 所有实例的纹理（通过参数缓冲区传递，下标为实例序号）
+        struct LayerTextures {
+            array<texture2d<float>, MAX_INSTANCES> primary [[id(0)]];
+            array<texture2d<float>, MAX_INSTANCES> chroma [[id(MAX_INSTANCES)]];
+            array<texture3d<float>, MAX_INSTANCES> lut [[id(MAX_INSTANCES * 2)]];
+        };
+
         struct VertexOut {
             float4 position [[position]];
             float2 texCoord;
-            float2 localPos;  // 相对于视口的局部坐标 (-1 到 1)
+            float2 localPos;  // 相对于画面的局部坐标 (-1 到 1)
+            uint instance [[flat]];
         };
 
-        // 圆角参数（通过 buffer 传递）
-        struct RoundedRectParams {
-            float cornerRadius;     // 圆角半径（归一化到 -1 到 1 坐标系）
-            float aspectRatio;      // 视口宽高比
-        };
+        vertex VertexOut compositorVertex(uint vertexID [[vertex_id]],
+                                          uint instanceID [[instance_id]],
+                                          constant LayerInstance *instances [[buffer(0)]]) {
+            // 三角形带：左下、右下、左上、右上
+            float2 corner = float2((vertexID & 1) ? 1.0 : -1.0, (vertexID & 2) ? 1.0 : -1.0);
+            float3 position = instances[instanceID].positionTransform * float3(corner, 1.0);
 
-        vertex VertexOut vertexShader(uint vertexID [[vertex_id]],
-                                       constant float4 *vertices [[buffer(0)]]) {
             VertexOut out;
-            float4 v = vertices[vertexID];
-            out.position = float4(v.xy, 0.0, 1.0);
-            out.texCoord = v.zw;
-            out.localPos = v.xy;  // 保存局部坐标用于圆角计算
+            out.position = float4(position.xy, 0.0, 1.0);
+            out.texCoord = float2(corner.x + 1.0, 1.0 - corner.y) * 0.5;
+            out.localPos = corner;
+            out.instance = instanceID;
             return out;
         }
 
@@ -406,33 +891,44 @@ final class MetalRenderer {
             return min(max(q.x, q.y), 0.0) + length(max(q, 0.0)) - radius;
         }
 
-        fragment float4 fragmentShader(VertexOut in [[stage_in]],
-                                        texture2d<float> texture [[texture(0)]],
-                                        sampler textureSampler [[sampler(0)]],
-                                        constant RoundedRectParams &params [[buffer(0)]]) {
-            float4 color = texture.sample(textureSampler, in.texCoord);
-            
-            // 如果圆角半径为 0，直接返回颜色
-            if (params.cornerRadius <= 0.0) {
+        #define COLOR_COMPENSATION_FLAG (1u << 8)
+        #define LUT_SIZE \(LUTGenerator.lut3DSize).0
+
+        // 应用颜色补偿 3D LUT：整条补偿链路已折叠到格点上，只需一次三线性采样
+        float4 applyLUT3D(float4 color, texture3d<float> lut, sampler s) {
+            float3 coord = saturate(color.rgb) * ((LUT_SIZE - 1.0) / LUT_SIZE) + 0.5 / LUT_SIZE;
+            return float4(lut.sample(s, coord).rgb, color.a);
+        }
+
+        fragment float4 compositorFragment(VertexOut in [[stage_in]],
+                                           constant LayerTextures &textures [[buffer(0)]],
+                                           constant LayerInstance *instances [[buffer(1)]],
+                                           sampler textureSampler [[sampler(0)]],
+                                           sampler lutSampler [[sampler(1)]]) {
+            constant LayerInstance &instance = instances[in.instance];
+            uint kind = instance.kind & 0xFF;
+
+            float4 color;
+            if (kind == 1) {
+                color = sampleYCbCr(textures.primary[in.instance], textures.chroma[in.instance],
+                                    textureSampler, in.texCoord, instance.conversion);
+            } else {
+                color = textures.primary[in.instance].sample(textureSampler, in.texCoord);
+            }
+
+            if (instance.kind & COLOR_COMPENSATION_FLAG) {
+                color = applyLUT3D(color, textures.lut[in.instance], lutSampler);
+            }
+
+            // 边框不裁剪圆角
+            if (kind == 2 || instance.cornerRadius <= 0.0) {
                 return color;
             }
-            
-            // 考虑宽高比调整坐标
-            float2 adjustedPos = in.localPos;
-            adjustedPos.x *= params.aspectRatio;
-            
-            // 计算调整后的尺寸和圆角
-            float2 size = float2(params.aspectRatio, 1.0);
-            float adjustedRadius = params.cornerRadius * params.aspectRatio;
-            
-            // 计算有符号距离
-            float dist = roundedBoxSDF(adjustedPos, size, adjustedRadius);
-            
-            // 使用平滑过渡实现抗锯齿
+
+            // 以点为单位计算有符号距离，使用平滑过渡实现抗锯齿
+            float dist = roundedBoxSDF(in.localPos * instance.halfSize, instance.halfSize, instance.cornerRadius);
             float aa = fwidth(dist) * 1.5;
-            float alpha = 1.0 - smoothstep(-aa, aa, dist);
-            
-            color.a *= alpha;
+            color.a *= 1.0 - smoothstep(-aa, aa, dist);
             return color;
         }
         """
@@ -445,21 +941,32 @@ final class MetalRenderer {
         }
     }
 
-    private func updateFPSStatistics(for timestamps: inout [CFAbsoluteTime], fps: inout Double) {
-        let now = CFAbsoluteTimeGetCurrent()
-        timestamps.append(now)
-        timestamps = timestamps.filter { now - $0 < 1.0 }
-        fps = Double(timestamps.count)
+    private static func updateFPSStatistics(for layer: inout LayerState, now: CFAbsoluteTime) {
+        layer.frameTimestamps.append(now)
+        layer.frameTimestamps.removeAll { now - $0 >= 1.0 }
+        layer.fps = Double(layer.frameTimestamps.count)
     }
 
     // MARK: - 清理
 
+    /// 释放可以重建的缓存：缩放中间纹理与纹理缓存中未被引用的纹理（在渲染队列调用）
+    func trimCaches() {
+        scaledTextures.removeAll()
+        if let textureCache {
+            CVMetalTextureCacheFlush(textureCache, 0)
+        }
+    }
+
+    /// 清除所有图层的画面（保留布局）
     func clearTextures() {
-        leftTexture = nil
-        rightTexture = nil
-        leftFPS = 0
-        rightFPS = 0
-        leftFrameTimestamps.removeAll()
-        rightFrameTimestamps.removeAll()
+        state.withLock { state in
+            for id in state.layers.keys {
+                state.layers[id]?.textureGeneration &+= 1
+                state.layers[id]?.texture = nil
+                state.layers[id]?.frameTimestamps.removeAll()
+                state.layers[id]?.fps = 0
+            }
+            state.isDirty = true
+        }
     }
 }
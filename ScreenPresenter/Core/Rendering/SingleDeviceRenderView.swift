@@ -5,7 +5,7 @@
 //  Created by Sun on 2025/12/23.
 //
 //  单设备 Metal 渲染视图
-//  嵌入到 DeviceBezelView 的 screenContentView 中，画面跟随设备边框动画
+//  嵌入到 DeviceBezelView 中，画面、屏幕圆角遮罩与栅格化的设备边框在同一个 render pass 中绘制
 //
 
 import AppKit
@@ -22,6 +22,12 @@ final class SingleDeviceRenderView: NSView {
     private var device: MTLDevice?
     private var commandQueue: MTLCommandQueue?
     private var pipelineState: MTLRenderPipelineState?
+    /// YCbCr 双平面纹理的渲染管线（VideoToolbox 解码输出）
+    private var yCbCrPipelineState: MTLRenderPipelineState?
+    /// 设备边框的渲染管线（预乘 alpha 的边框栅格）
+    private var bezelPipelineState: MTLRenderPipelineState?
+    /// 屏幕背景的渲染管线（纯色填充）
+    private var solidPipelineState: MTLRenderPipelineState?
     private var textureCache: CVMetalTextureCache?
     private var samplerState: MTLSamplerState?
 
@@ -32,18 +38,79 @@ final class SingleDeviceRenderView: NSView {
     /// 颜色补偿滤镜（可外部注入，支持按设备独立设置）
     var colorFilter: ColorCompensationFilter?
 
-    // MARK: - 纹理（保持对 CVMetalTexture 的强引用，防止 MTLTexture 失效）
+    // MARK: - 纹理（FrameTexture 保持对 CVMetalTexture 的强引用，防止 MTLTexture 失效）
 
-    private var currentCVTexture: CVMetalTexture?
-    private var currentTexture: MTLTexture?
+    private var currentTexture: FrameTexture?
     private let textureLock = NSLock()
 
+    // MARK: - 延迟追踪
+
+    /// 帧延迟追踪器（可外部注入，记录呈现阶段）
+    var latencyTracer: FrameLatencyTracer?
+
+    /// 当前纹理对应的帧 ID，呈现后置为 nil，避免重绘同一帧时重复记录（受 textureLock 保护）
+    private var pendingPresentFrameID: Int64?
+
+    // MARK: - 启动耗时
+
+    /// 启动时间线的设备 ID（可外部注入），设置后呈现的第一帧记为该设备的首帧
+    var startupDeviceID: String? {
+        didSet {
+            guard startupDeviceID != oldValue else { return }
+            textureLock.lock()
+            pendingStartupDeviceID = startupDeviceID
+            textureLock.unlock()
+        }
+    }
+
+    /// 等待首帧呈现的设备 ID，呈现后置为 nil（受 textureLock 保护）
+    private var pendingStartupDeviceID: String?
+
+    // MARK: - 设备边框
+
+    /// 设备边框合成参数（本视图坐标系，单位为点）
+    struct BezelComposition {
+        /// 边框栅格
+        let raster: DeviceBezelRaster
+        /// 边框栅格覆盖的区域
+        let rasterFrame: CGRect
+        /// 屏幕区域（画面绘制在其中）
+        let screenFrame: CGRect
+        /// 屏幕圆角半径
+        let screenCornerRadius: CGFloat
+    }
+
+    /// 渲染线程使用的边框参数
+    private struct BezelPass {
+        let texture: MTLTexture
+        /// 边框栅格区域（归一化坐标，原点在左下）
+        let rasterRect: CGRect
+        /// 屏幕区域（归一化坐标，原点在左下）
+        let screenRect: CGRect
+        /// 屏幕圆角半径（相对视图宽度）
+        let cornerRadius: CGFloat
+    }
+
+    /// 设备边框（可外部注入）
+    /// 设置后画面绘制在屏幕区域并按圆角遮罩，边框叠加在画面之上；为 nil 时画面铺满视图
+    var bezel: BezelComposition? {
+        didSet { updateBezelPass() }
+    }
+
+    /// 当前边框参数（受 textureLock 保护）
+    private var bezelPass: BezelPass?
+
+    /// 屏幕背景颜色（与设备边框的屏幕黑边一致）
+    private static let screenBackgroundColor = SIMD4<Float>(0.02, 0.02, 0.02, 1.0)
+
     // MARK: - 渲染状态
 
     private(set) var isRendering = false
-    private let renderQueue = DispatchQueue(label: "com.screenPresenter.singleRender", qos: .userInteractive)
 
-    /// 标记是否有新帧需要渲染
+    /// 帧节奏控制（CAMetalDisplayLink，在专用渲染线程上按源帧率刷新并提供 drawable）
+    private var pacer: MetalDisplayLinkPacer?
+
+    /// 标记是否有新内容需要渲染（受 textureLock 保护）
     private var needsRender = false
 
     // MARK: - 配置
@@ -58,7 +125,9 @@ final class SingleDeviceRenderView: NSView {
 
     // MARK: - 统计
 
-    private var frameTimestamps: [CFAbsoluteTime] = []
+    /// FPS 统计窗口（渲染线程每帧计数，每秒结算一次；界面由主线程定时器低频拉取）
+    private var fpsWindowStart = CFAbsoluteTimeGetCurrent()
+    private var fpsWindowFrames = 0
     private var _fps: Double = 0
     private let fpsLock = NSLock()
 
@@ -119,6 +188,7 @@ final class SingleDeviceRenderView: NSView {
 
     deinit {
         stopRendering()
+        pacer?.invalidate()
         // 清理纹理缓存
         if let cache = textureCache {
             CVMetalTextureCacheFlush(cache, 0)
@@ -160,6 +230,7 @@ final class SingleDeviceRenderView: NSView {
     override func setFrameSize(_ newSize: NSSize) {
         super.setFrameSize(newSize)
         updateDrawableSize()
+        updateBezelPass()
         // 尺寸变化时需要重新渲染
         scheduleRender()
     }
@@ -167,6 +238,7 @@ final class SingleDeviceRenderView: NSView {
     override func setBoundsSize(_ newSize: NSSize) {
         super.setBoundsSize(newSize)
         updateDrawableSize()
+        updateBezelPass()
         scheduleRender()
     }
 
@@ -217,11 +289,23 @@ final class SingleDeviceRenderView: NSView {
         textureCache = cache
 
         // 创建渲染管线
-        guard let pipelineState = createPipelineState(device: device) else {
+        guard
+            let pipelineState = createPipelineState(device: device, fragmentFunctionName: "fragmentShader"),
+            let yCbCrPipelineState = createPipelineState(device: device, fragmentFunctionName: "fragmentShaderYCbCr"),
+            let bezelPipelineState = createPipelineState(
+                device: device,
+                fragmentFunctionName: "fragmentShaderBezel",
+                premultipliedAlpha: true
+            ),
+            let solidPipelineState = createPipelineState(device: device, fragmentFunctionName: "fragmentShaderSolid")
+        else {
             AppLogger.rendering.error("无法创建渲染管线")
             return
         }
         self.pipelineState = pipelineState
+        self.yCbCrPipelineState = yCbCrPipelineState
+        self.bezelPipelineState = bezelPipelineState
+        self.solidPipelineState = solidPipelineState
 
         // 创建采样器
         let samplerDescriptor = MTLSamplerDescriptor()
@@ -241,9 +325,27 @@ final class SingleDeviceRenderView: NSView {
         lutSamplerState = device.makeSamplerState(descriptor: lutSamplerDescriptor)
         samplerState = sampler
 
+        // 帧节奏控制：display link 提供 drawable，渲染在其线程上执行
+        let pacer = MetalDisplayLinkPacer(layer: metal)
+        pacer.onUpdate = { [weak self] drawable, interval in
+            self?.renderIfNeeded(into: drawable, presentationInterval: interval) ?? false
+        }
+        self.pacer = pacer
+
         AppLogger.rendering.info("SingleDeviceRenderView Metal 初始化成功")
     }
 
+    /// 当前绘制区域的像素尺寸（码流自适应据此估算实际显示尺寸）
+    /// 绘制设备边框时只计算屏幕区域
+    var drawablePixelSize: CGSize {
+        let size = metalLayer?.drawableSize ?? .zero
+        guard let bezel, bounds.width > 0, bounds.height > 0 else { return size }
+        return CGSize(
+            width: size.width * bezel.screenFrame.width / bounds.width,
+            height: size.height * bezel.screenFrame.height / bounds.height
+        )
+    }
+
     private func updateDrawableSize() {
         guard let metalLayer else { return }
 
@@ -258,6 +360,37 @@ final class SingleDeviceRenderView: NSView {
         }
     }
 
+    /// 把边框参数换算为归一化坐标，交给渲染线程（主线程调用）
+    private func updateBezelPass() {
+        var pass: BezelPass?
+        if let bezel, let device, bounds.width > 0, bounds.height > 0 {
+            // 栅格在首次合成时上传为纹理，同一尺寸档位内复用
+            if let texture = bezel.raster.texture(on: device) {
+                let normalize = { (rect: CGRect) in
+                    CGRect(
+                        x: rect.minX / self.bounds.width,
+                        y: rect.minY / self.bounds.height,
+                        width: rect.width / self.bounds.width,
+                        height: rect.height / self.bounds.height
+                    )
+                }
+                pass = BezelPass(
+                    texture: texture,
+                    rasterRect: normalize(bezel.rasterFrame),
+                    screenRect: normalize(bezel.screenFrame),
+                    cornerRadius: bezel.screenCornerRadius / bounds.width
+                )
+            } else {
+                AppLogger.rendering.error("无法创建边框纹理")
+            }
+        }
+
+        textureLock.lock()
+        bezelPass = pass
+        textureLock.unlock()
+        scheduleRender()
+    }
+
     // MARK: - 渲染控制
 
     func startRendering() {
@@ -274,19 +407,23 @@ final class SingleDeviceRenderView: NSView {
 
     private func scheduleRender() {
         guard isRendering else { return }
+        textureLock.lock()
         needsRender = true
-        renderQueue.async { [weak self] in
-            // 使用 autoreleasepool 确保每帧渲染过程中创建的临时对象及时释放
-            autoreleasepool {
-                self?.renderIfNeeded()
-            }
-        }
+        textureLock.unlock()
+        pacer?.wake()
     }
 
-    private func renderIfNeeded() {
-        guard needsRender else { return }
+    /// display link 刷新时调用（渲染线程）
+    /// - Returns: 是否渲染了新内容
+    private func renderIfNeeded(into drawable: CAMetalDrawable, presentationInterval: CFTimeInterval) -> Bool {
+        textureLock.lock()
+        let shouldRender = needsRender
         needsRender = false
-        renderFrame()
+        textureLock.unlock()
+        guard shouldRender else { return false }
+
+        renderFrame(into: drawable, presentationInterval: presentationInterval)
+        return true
     }
 
     // MARK: - 纹理更新
@@ -298,29 +435,14 @@ final class SingleDeviceRenderView: NSView {
             return
         }
 
-        let width = CVPixelBufferGetWidth(pixelBuffer)
-        let height = CVPixelBufferGetHeight(pixelBuffer)
-
-        var cvTexture: CVMetalTexture?
-        let status = CVMetalTextureCacheCreateTextureFromImage(
-            kCFAllocatorDefault,
-            cache,
-            pixelBuffer,
-            nil,
-            .bgra8Unorm,
-            width,
-            height,
-            0,
-            &cvTexture
-        )
+        // BGRA 导入为单个纹理，420v 分别导入 Y 与 CbCr 平面
+        guard let frameTexture = FrameTexture.make(from: pixelBuffer, cache: cache) else { return }
 
-        guard status == kCVReturnSuccess, let texture = cvTexture else { return }
-        guard let mtlTexture = CVMetalTextureGetTexture(texture) else { return }
+        let frameID = latencyTracer != nil ? FrameLatencyTracer.frameID(of: pixelBuffer) : nil
 
         textureLock.lock()
-        // 保持对 CVMetalTexture 的强引用，确保 MTLTexture 不会失效
-        currentCVTexture = texture
-        currentTexture = mtlTexture
+        currentTexture = frameTexture
+        pendingPresentFrameID = frameID
         textureLock.unlock()
 
         // 每帧刷新纹理缓存，立即释放不再使用的纹理
@@ -328,9 +450,7 @@ final class SingleDeviceRenderView: NSView {
 
         // 更新 FPS 统计
         let now = CFAbsoluteTimeGetCurrent()
-        frameTimestamps.append(now)
-        frameTimestamps = frameTimestamps.filter { now - $0 < 1.0 }
-        fps = Double(frameTimestamps.count)
+        countFrameForFPS(at: now)
 
         // 调试统计
         let updateTime = (now - updateStartTime) * 1000
@@ -363,14 +483,32 @@ final class SingleDeviceRenderView: NSView {
         scheduleRender()
     }
 
+    /// 计入一帧，满一秒时结算 FPS
+    private func countFrameForFPS(at now: CFAbsoluteTime) {
+        fpsLock.lock()
+        defer { fpsLock.unlock() }
+        fpsWindowFrames += 1
+        let elapsed = now - fpsWindowStart
+        if elapsed >= 1.0 {
+            _fps = Double(fpsWindowFrames) / elapsed
+            fpsWindowFrames = 0
+            fpsWindowStart = now
+            // 刷新率跟随源帧率
+            pacer?.setSourceFrameRate(_fps)
+        }
+    }
+
     func clearTexture() {
         textureLock.lock()
-        currentCVTexture = nil
         currentTexture = nil
+        pendingPresentFrameID = nil
         textureLock.unlock()
 
-        fps = 0
-        frameTimestamps.removeAll()
+        fpsLock.lock()
+        _fps = 0
+        fpsWindowFrames = 0
+        fpsWindowStart = CFAbsoluteTimeGetCurrent()
+        fpsLock.unlock()
 
         // 刷新纹理缓存
         if let cache = textureCache {
@@ -383,15 +521,21 @@ final class SingleDeviceRenderView: NSView {
 
     // MARK: - 渲染
 
-    private func renderFrame() {
+    /// 渲染到 display link 提供的 drawable
+    /// - Parameters:
+    ///   - drawable: 本次刷新的 drawable
+    ///   - presentationInterval: 与上一帧的最短呈现间隔（源帧率的帧间隔），使帧在可变刷新率屏幕上均匀呈现
+    private func renderFrame(into drawable: CAMetalDrawable, presentationInterval: CFTimeInterval) {
         let renderStartTime = CFAbsoluteTimeGetCurrent()
 
-        guard let metalLayer, let commandQueue, let pipelineState, let samplerState else { return }
+        guard
+            let commandQueue, let pipelineState, let yCbCrPipelineState,
+            let bezelPipelineState, let solidPipelineState, let samplerState
+        else { return }
 
-        let drawableSize = metalLayer.drawableSize
+        let drawableSize = CGSize(width: drawable.texture.width, height: drawable.texture.height)
         guard drawableSize.width > 0, drawableSize.height > 0 else { return }
 
-        guard let drawable = metalLayer.nextDrawable() else { return }
         guard let commandBuffer = commandQueue.makeCommandBuffer() else { return }
 
         let renderPassDescriptor = MTLRenderPassDescriptor()
@@ -404,34 +548,61 @@ final class SingleDeviceRenderView: NSView {
 
         textureLock.lock()
         let texture = currentTexture
+        let presentFrameID = pendingPresentFrameID
+        pendingPresentFrameID = nil
+        let startupDeviceID = texture != nil ? pendingStartupDeviceID : nil
+        if startupDeviceID != nil {
+            pendingStartupDeviceID = nil
+        }
+        let bezelPass = bezelPass
         textureLock.unlock()
 
+        // 画面区域（NDC）：有边框时为屏幕区域，否则为整个视图
+        let contentRect = bezelPass.map { Self.ndcRect($0.screenRect) } ?? CGRect(x: -1, y: -1, width: 2, height: 2)
+
+        // 屏幕圆角遮罩（片元坐标为像素，原点在左上）
+        var screenMask = ScreenMaskParams.none
+        if let bezelPass {
+            screenMask = ScreenMaskParams(
+                origin: SIMD2(Float(bezelPass.screenRect.minX * drawableSize.width), Float((1 - bezelPass.screenRect.maxY) * drawableSize.height)),
+                size: SIMD2(Float(bezelPass.screenRect.width * drawableSize.width), Float(bezelPass.screenRect.height * drawableSize.height)),
+                cornerRadius: Float(bezelPass.cornerRadius * drawableSize.width)
+            )
+
+            // 1. 屏幕背景（尚未收到帧或画面未铺满屏幕时可见）
+            var backgroundColor = Self.screenBackgroundColor
+            encoder.setRenderPipelineState(solidPipelineState)
+            setQuadVertices(contentRect, on: encoder)
+            encoder.setFragmentBytes(&screenMask, length: MemoryLayout<ScreenMaskParams>.stride, index: 2)
+            encoder.setFragmentBytes(&backgroundColor, length: MemoryLayout<SIMD4<Float>>.stride, index: 3)
+            encoder.drawPrimitives(type: .triangleStrip, vertexStart: 0, vertexCount: 4)
+        }
+
+        // 2. 画面
         if let texture {
-            encoder.setRenderPipelineState(pipelineState)
+            encoder.setRenderPipelineState(texture.isYCbCr ? yCbCrPipelineState : pipelineState)
             encoder.setFragmentSamplerState(samplerState, index: 0)
 
-            // 计算保持纵横比的顶点
+            // 在画面区域内保持纵横比居中
             let textureAspect = CGFloat(texture.width) / CGFloat(texture.height)
-            let viewAspect = drawableSize.width / drawableSize.height
-
-            var scaleX: Float = 1.0
-            var scaleY: Float = 1.0
-
-            if textureAspect > viewAspect {
-                scaleY = Float(viewAspect / textureAspect)
+            let contentAspect = (contentRect.width * drawableSize.width) / (contentRect.height * drawableSize.height)
+            var videoRect = contentRect
+            if textureAspect > contentAspect {
+                videoRect.size.height = contentRect.height * contentAspect / textureAspect
             } else {
-                scaleX = Float(textureAspect / viewAspect)
+                videoRect.size.width = contentRect.width * textureAspect / contentAspect
             }
+            videoRect.origin = CGPoint(x: contentRect.midX - videoRect.width / 2, y: contentRect.midY - videoRect.height / 2)
 
-            let vertices: [Float] = [
-                -scaleX, -scaleY, 0.0, 1.0,
-                scaleX, -scaleY, 1.0, 1.0,
-                -scaleX, scaleY, 0.0, 0.0,
-                scaleX, scaleY, 1.0, 0.0,
-            ]
+            setQuadVertices(videoRect, on: encoder)
+            encoder.setFragmentBytes(&screenMask, length: MemoryLayout<ScreenMaskParams>.stride, index: 2)
+            encoder.setFragmentTexture(texture.planes[0], index: 0)
 
-            encoder.setVertexBytes(vertices, length: vertices.count * MemoryLayout<Float>.size, index: 0)
-            encoder.setFragmentTexture(texture, index: 0)
+            // YCbCr 双平面：CbCr 平面与转换参数（LUT 占用 texture(1)）
+            if var conversion = texture.yCbCrConversion {
+                encoder.setFragmentTexture(texture.planes[1], index: 2)
+                encoder.setFragmentBytes(&conversion, length: MemoryLayout<YCbCrConversionParams>.size, index: 1)
+            }
 
             // 设置颜色补偿资源（使用注入的滤镜实例）
             if let colorFilter {
@@ -449,8 +620,37 @@ final class SingleDeviceRenderView: NSView {
             encoder.drawPrimitives(type: .triangleStrip, vertexStart: 0, vertexCount: 4)
         }
 
+        // 3. 设备边框（屏幕区域透明，顶部特征叠加在画面之上）
+        if let bezelPass {
+            encoder.setRenderPipelineState(bezelPipelineState)
+            encoder.setFragmentSamplerState(samplerState, index: 0)
+            setQuadVertices(Self.ndcRect(bezelPass.rasterRect), on: encoder)
+            encoder.setFragmentTexture(bezelPass.texture, index: 0)
+            encoder.drawPrimitives(type: .triangleStrip, vertexStart: 0, vertexCount: 4)
+        }
+
         encoder.endEncoding()
-        commandBuffer.present(drawable)
+
+        // 以 drawable 的实际上屏时间记录呈现阶段
+        if let presentFrameID, let tracer = latencyTracer {
+            drawable.addPresentedHandler { [weak tracer] presentedDrawable in
+                let presentedTime = presentedDrawable.presentedTime
+                tracer?.markPresented(frameID: presentFrameID, at: presentedTime > 0 ? presentedTime : CACurrentMediaTime())
+            }
+        }
+
+        if let startupDeviceID {
+            drawable.addPresentedHandler { presentedDrawable in
+                let presentedTime = presentedDrawable.presentedTime
+                DeviceStartupProfiler.shared.mark(
+                    .firstFrame,
+                    deviceID: startupDeviceID,
+                    at: presentedTime > 0 ? presentedTime : CACurrentMediaTime()
+                )
+            }
+        }
+
+        commandBuffer.present(drawable, afterMinimumDuration: presentationInterval)
         commandBuffer.commit()
 
         // 统计渲染耗时
@@ -460,9 +660,37 @@ final class SingleDeviceRenderView: NSView {
         maxRenderTime = max(maxRenderTime, renderTime)
     }
 
+    /// 设置矩形的四个顶点（NDC 坐标 + 纹理坐标，三角形带顺序）
+    private func setQuadVertices(_ rect: CGRect, on encoder: MTLRenderCommandEncoder) {
+        let minX = Float(rect.minX)
+        let maxX = Float(rect.maxX)
+        let minY = Float(rect.minY)
+        let maxY = Float(rect.maxY)
+        let vertices: [Float] = [
+            minX, minY, 0.0, 1.0,
+            maxX, minY, 1.0, 1.0,
+            minX, maxY, 0.0, 0.0,
+            maxX, maxY, 1.0, 0.0,
+        ]
+        encoder.setVertexBytes(vertices, length: vertices.count * MemoryLayout<Float>.size, index: 0)
+    }
+
+    /// 归一化坐标（0...1）转换为 NDC（-1...1），两者原点都在左下
+    private static func ndcRect(_ rect: CGRect) -> CGRect {
+        CGRect(x: rect.minX * 2 - 1, y: rect.minY * 2 - 1, width: rect.width * 2, height: rect.height * 2)
+    }
+
     // MARK: - 着色器
 
-    private func createPipelineState(device: MTLDevice) -> MTLRenderPipelineState? {
+    /// 创建渲染管线
+    /// - Parameters:
+    ///   - fragmentFunctionName: 片元着色器名称
+    ///   - premultipliedAlpha: 片元输出是否为预乘 alpha（边框栅格）
+    private func createPipelineState(
+        device: MTLDevice,
+        fragmentFunctionName: String,
+        premultipliedAlpha: Bool = false
+    ) -> MTLRenderPipelineState? {
         let shaderSource = """
         #include <metal_stdlib>
         using namespace metal;
@@ -558,6 +786,24 @@ final class SingleDeviceRenderView: NSView {
             return float4(color, inputColor.a);
         }
 
+        // 屏幕圆角遮罩参数（像素坐标，原点在左上）
+        struct ScreenMaskParams {
+            float2 origin;
+            float2 size;
+            float cornerRadius;
+        };
+
+        // 圆角矩形遮罩的覆盖率（带 1 像素抗锯齿），圆角为 0 时不遮罩
+        float screenMaskCoverage(float2 position, constant ScreenMaskParams &mask) {
+            if (mask.cornerRadius <= 0.0) {
+                return 1.0;
+            }
+            float2 halfSize = mask.size * 0.5;
+            float2 q = abs(position - (mask.origin + halfSize)) - (halfSize - mask.cornerRadius);
+            float distance = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - mask.cornerRadius;
+            return saturate(0.5 - distance);
+        }
+
         vertex VertexOut vertexShader(uint vertexID [[vertex_id]],
                                        constant float4 *vertices [[buffer(0)]]) {
             VertexOut out;
@@ -572,24 +818,58 @@ final class SingleDeviceRenderView: NSView {
                                         texture1d<float> lut [[texture(1)]],
                                         sampler textureSampler [[sampler(0)]],
                                         sampler lutSampler [[sampler(1)]],
-                                        constant ColorCompensationParams &colorParams [[buffer(0)]]) {
+                                        constant ColorCompensationParams &colorParams [[buffer(0)]],
+                                        constant ScreenMaskParams &mask [[buffer(2)]]) {
             float4 color = texture.sample(textureSampler, in.texCoord);
             color = applyColorCompensation(color, colorParams, lut, lutSampler);
+            color.a *= screenMaskCoverage(in.position.xy, mask);
             return color;
         }
+
+        \(YCbCrConversionParams.shaderSource)
+
+        // YCbCr 双平面（420v/420f）纹理：采样 Y 与 CbCr 平面后转换为 RGB，再做颜色补偿
+        fragment float4 fragmentShaderYCbCr(VertexOut in [[stage_in]],
+                                             texture2d<float> luma [[texture(0)]],
+                                             texture1d<float> lut [[texture(1)]],
+                                             texture2d<float> chroma [[texture(2)]],
+                                             sampler textureSampler [[sampler(0)]],
+                                             sampler lutSampler [[sampler(1)]],
+                                             constant ColorCompensationParams &colorParams [[buffer(0)]],
+                                             constant YCbCrConversionParams &conversion [[buffer(1)]],
+                                             constant ScreenMaskParams &mask [[buffer(2)]]) {
+            float4 color = sampleYCbCr(luma, chroma, textureSampler, in.texCoord, conversion);
+            color = applyColorCompensation(color, colorParams, lut, lutSampler);
+            color.a *= screenMaskCoverage(in.position.xy, mask);
+            return color;
+        }
+
+        // 屏幕背景：纯色，按屏幕圆角遮罩
+        fragment float4 fragmentShaderSolid(VertexOut in [[stage_in]],
+                                             constant ScreenMaskParams &mask [[buffer(2)]],
+                                             constant float4 &color [[buffer(3)]]) {
+            return float4(color.rgb, color.a * screenMaskCoverage(in.position.xy, mask));
+        }
+
+        // 设备边框栅格（预乘 alpha）
+        fragment float4 fragmentShaderBezel(VertexOut in [[stage_in]],
+                                             texture2d<float> bezel [[texture(0)]],
+                                             sampler textureSampler [[sampler(0)]]) {
+            return bezel.sample(textureSampler, in.texCoord);
+        }
         """
 
         do {
             let library = try device.makeLibrary(source: shaderSource, options: nil)
             let vertexFunction = library.makeFunction(name: "vertexShader")
-            let fragmentFunction = library.makeFunction(name: "fragmentShader")
+            let fragmentFunction = library.makeFunction(name: fragmentFunctionName)
 
             let descriptor = MTLRenderPipelineDescriptor()
             descriptor.vertexFunction = vertexFunction
             descriptor.fragmentFunction = fragmentFunction
             descriptor.colorAttachments[0].pixelFormat = .bgra8Unorm
             descriptor.colorAttachments[0].isBlendingEnabled = true
-            descriptor.colorAttachments[0].sourceRGBBlendFactor = .sourceAlpha
+            descriptor.colorAttachments[0].sourceRGBBlendFactor = premultipliedAlpha ? .one : .sourceAlpha
             descriptor.colorAttachments[0].destinationRGBBlendFactor = .oneMinusSourceAlpha
             descriptor.colorAttachments[0].sourceAlphaBlendFactor = .one
             descriptor.colorAttachments[0].destinationAlphaBlendFactor = .oneMinusSourceAlpha
@@ -601,3 +881,16 @@ final class SingleDeviceRenderView: NSView {
         }
     }
 }
+
+// MARK: - 屏幕圆角遮罩参数
+
+/// 屏幕圆角遮罩参数（与着色器中的 ScreenMaskParams 布局一致）
+/// 坐标为 drawable 像素，原点在左上，与片元的 position 一致
+private struct ScreenMaskParams {
+    var origin: SIMD2<Float>
+    var size: SIMD2<Float>
+    var cornerRadius: Float
+
+    /// 不遮罩（圆角为 0）
+    static let none = ScreenMaskParams(origin: .zero, size: .zero, cornerRadius: 0)
+}
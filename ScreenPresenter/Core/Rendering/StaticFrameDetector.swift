@@ -0,0 +1,151 @@
+//
+//  StaticFrameDetector.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  静止帧检测
+//  演示时画面大部分时间是静止的，但 scrcpy 编码器仍按间隔输出重复帧（几乎全部宏块跳过的 P 帧），
+//  iOS 捕获也持续交付内容相同的帧；检测出与上一帧内容相同的帧后，帧管道不再分发，
+//  渲染、缩略图等下游都不做任何工作
+//
+//  检测方式:
+//  1. 候选: 解码器为很小的非关键帧视频包标记提示；没有编码信息的帧（iOS 捕获）都是候选
+//  2. 确认: 对候选帧的像素平面计算 64 位哈希（只读锁定，不破坏零拷贝约定），与上一个分发的候选帧比较
+//  3. 非候选帧直接分发并清除基准，下一个候选帧一定会被分发一次，之后内容相同的帧才会被跳过
+//
+//  只在哈希完全相同时跳过，画面上任何一个像素的变化都会被分发
+//
+
+import CoreVideo
+import Foundation
+import os.lock
+
+// MARK: - 静止帧检测器
+
+/// 静止帧检测器
+///
+/// 线程安全：
+/// - isUnchanged() 由帧管道在推帧线程（解码队列 / 捕获队列）串行调用，哈希在锁外计算
+/// - reset() 可在任意线程调用（更换帧处理者时在主线程调用）
+final class StaticFrameDetector: @unchecked Sendable {
+    // MARK: - 常量
+
+    /// 不超过此大小（字节）的非关键帧视频包视为可能的重复帧
+    /// 只影响是否计算哈希，不影响正确性
+    static let staticPacketSizeLimit = 512
+
+    /// 解码器为像素缓冲标记的提示（值为 kCFBooleanTrue / kCFBooleanFalse）
+    /// 缓冲池中的像素缓冲会被复用，解码器每帧都会覆盖此附件
+    private static let candidateAttachmentKey = "com.screenPresenter.staticFrameCandidate" as CFString
+
+    // MARK: - 属性
+
+    private struct State {
+        /// 上一个分发的候选帧的哈希
+        var lastFingerprint: UInt64?
+        /// 被跳过的静止帧数
+        var unchangedFrameCount = 0
+    }
+
+    private let state = OSAllocatedUnfairLock(initialState: State())
+
+    /// 被跳过的静止帧数
+    var unchangedFrameCount: Int {
+        state.withLock { $0.unchangedFrameCount }
+    }
+
+    // MARK: - 提示
+
+    /// 标记像素缓冲是否来自可能的重复帧（由解码器在输出回调中调用）
+    /// - Parameters:
+    ///   - pixelBuffer: 解码输出的像素缓冲
+    ///   - isCandidate: 视频包是否足够小
+    @inline(__always)
+    static func markCandidate(_ pixelBuffer: CVPixelBuffer, _ isCandidate: Bool) {
+        CVBufferSetAttachment(
+            pixelBuffer,
+            candidateAttachmentKey,
+            isCandidate ? kCFBooleanTrue : kCFBooleanFalse,
+            .shouldNotPropagate
+        )
+    }
+
+    // MARK: - 检测
+
+    /// 判断帧是否与上一个分发的帧内容相同
+    /// - Parameter pixelBuffer: 待分发的像素缓冲
+    /// - Returns: 内容相同（可跳过）时为 true
+    func isUnchanged(_ pixelBuffer: CVPixelBuffer) -> Bool {
+        // 解码器明确标记为非候选（关键帧或较大的视频包）时不计算哈希
+        if let hint = CVBufferCopyAttachment(pixelBuffer, Self.candidateAttachmentKey, nil) as? NSNumber, !hint.boolValue {
+            reset()
+            return false
+        }
+
+        let fingerprint = Self.fingerprint(of: pixelBuffer)
+        return state.withLock { state in
+            guard let fingerprint, fingerprint == state.lastFingerprint else {
+                state.lastFingerprint = fingerprint
+                return false
+            }
+            state.unchangedFrameCount += 1
+            return true
+        }
+    }
+
+    /// 清除基准（下一帧一定会被分发）
+    func reset() {
+        state.withLock { $0.lastFingerprint = nil }
+    }
+
+    // MARK: - 哈希
+
+    /// 计算像素缓冲所有平面的 64 位哈希（包括行尾填充，填充不同只会导致漏检，不会误判）
+    private static func fingerprint(of pixelBuffer: CVPixelBuffer) -> UInt64? {
+        guard CVPixelBufferLockBaseAddress(pixelBuffer, .readOnly) == kCVReturnSuccess else { return nil }
+        defer { CVPixelBufferUnlockBaseAddress(pixelBuffer, .readOnly) }
+
+        var hash = UInt64(CVPixelBufferGetPixelFormatType(pixelBuffer))
+        hash = mix(hash, UInt64(CVPixelBufferGetWidth(pixelBuffer)) << 32 | UInt64(CVPixelBufferGetHeight(pixelBuffer)))
+
+        let planeCount = CVPixelBufferGetPlaneCount(pixelBuffer)
+        if planeCount == 0 {
+            guard let base = CVPixelBufferGetBaseAddress(pixelBuffer) else { return nil }
+            let length = CVPixelBufferGetBytesPerRow(pixelBuffer) * CVPixelBufferGetHeight(pixelBuffer)
+            return hashBytes(base, length: length, seed: hash)
+        }
+        for plane in 0..<planeCount {
+            guard let base = CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, plane) else { return nil }
+            let length = CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, plane) * CVPixelBufferGetHeightOfPlane(pixelBuffer, plane)
+            hash = hashBytes(base, length: length, seed: hash)
+        }
+        return hash
+    }
+
+    /// 四路并行的乘法-异或哈希，按 8 字节读取，吞吐接近内存带宽
+    private static func hashBytes(_ base: UnsafeMutableRawPointer, length: Int, seed: UInt64) -> UInt64 {
+        let wordCount = length / 8
+        var lanes: (UInt64, UInt64, UInt64, UInt64) = (seed, seed ^ 0x9E37_79B9_7F4A_7C15, seed ^ 0xC2B2_AE3D_27D4_EB4F, seed ^ 0x1656_67B1_9E37_79F9)
+        var index = 0
+        while index + 4 <= wordCount {
+            let offset = index * 8
+            lanes.0 = mix(lanes.0, base.loadUnaligned(fromByteOffset: offset, as: UInt64.self))
+            lanes.1 = mix(lanes.1, base.loadUnaligned(fromByteOffset: offset + 8, as: UInt64.self))
+            lanes.2 = mix(lanes.2, base.loadUnaligned(fromByteOffset: offset + 16, as: UInt64.self))
+            lanes.3 = mix(lanes.3, base.loadUnaligned(fromByteOffset: offset + 24, as: UInt64.self))
+            index += 4
+        }
+        var hash = mix(mix(mix(lanes.0, lanes.1), lanes.2), lanes.3)
+        for offset in stride(from: index * 8, to: length, by: 1) {
+            hash = mix(hash, UInt64(base.load(fromByteOffset: offset, as: UInt8.self)))
+        }
+        return mix(hash, UInt64(length))
+    }
+
+    @inline(__always)
+    private static func mix(_ hash: UInt64, _ value: UInt64) -> UInt64 {
+        let product = (hash ^ value) &* 0x9FB2_1C65_1E98_DF25
+        return product ^ (product >> 29)
+    }
+}
@@ -53,6 +53,281 @@ enum VideoToolboxDecoderError: LocalizedError {
     }
 }
 
+// MARK: - 重排序检测
+
+/// 从 SPS 判断码流是否存在输出重排序（B 帧）
+/// 无重排序的码流解码后可立即输出，不必等待重排序窗口；无法确定时按存在重排序处理
+enum VideoStreamReorderAnalyzer {
+    /// 含色度格式等扩展字段的 H.264 profile
+    private static let h264HighProfiles: Set<UInt32> = [100, 110, 122, 244, 44, 83, 86, 118, 128, 138, 139, 134, 135]
+
+    /// H.264 码流是否存在重排序
+    /// - Parameter sps: SPS NAL 单元（含 NAL 头，不含起始码）
+    static func h264HasFrameReordering(sps: Data) -> Bool {
+        guard let maxNumReorderFrames = try? h264MaxNumReorderFrames(sps: sps) else { return true }
+        return maxNumReorderFrames > 0
+    }
+
+    /// H.265 码流是否存在重排序
+    /// - Parameter sps: SPS NAL 单元（含 NAL 头，不含起始码）
+    static func h265HasFrameReordering(sps: Data) -> Bool {
+        guard let maxNumReorderPics = try? h265MaxNumReorderPics(sps: sps) else { return true }
+        return maxNumReorderPics > 0
+    }
+
+    // MARK: - H.264
+
+    /// 解析 H.264 SPS 的 max_num_reorder_frames（ITU-T H.264 7.3.2.1.1 / E.1.1）
+    private static func h264MaxNumReorderFrames(sps: Data) throws -> UInt32 {
+        var reader = RBSPBitReader(nalUnit: sps, headerLength: 1)
+        let profileIdc = try reader.bits(8)
+        // Baseline 不含 B 帧
+        if profileIdc == 66 {
+            return 0
+        }
+        try reader.skip(16) // constraint_set flags + level_idc
+        _ = try reader.ue() // seq_parameter_set_id
+        if h264HighProfiles.contains(profileIdc) {
+            let chromaFormatIdc = try reader.ue()
+            if chromaFormatIdc == 3 {
+                try reader.skip(1) // separate_colour_plane_flag
+            }
+            _ = try reader.ue() // bit_depth_luma_minus8
+            _ = try reader.ue() // bit_depth_chroma_minus8
+            try reader.skip(1) // qpprime_y_zero_transform_bypass_flag
+            if try reader.flag() { // seq_scaling_matrix_present_flag
+                for index in 0..<(chromaFormatIdc == 3 ? 12 : 8) {
+                    if try reader.flag() { // seq_scaling_list_present_flag
+                        try skipScalingList(&reader, size: index < 6 ? 16 : 64)
+                    }
+                }
+            }
+        }
+        _ = try reader.ue() // log2_max_frame_num_minus4
+        let picOrderCntType = try reader.ue()
+        if picOrderCntType == 0 {
+            _ = try reader.ue() // log2_max_pic_order_cnt_lsb_minus4
+        } else if picOrderCntType == 1 {
+            try reader.skip(1) // delta_pic_order_always_zero_flag
+            _ = try reader.se() // offset_for_non_ref_pic
+            _ = try reader.se() // offset_for_top_to_bottom_field
+            let cycleLength = try reader.ue()
+            guard cycleLength <= 255 else { throw RBSPBitReader.ReadError.invalidValue }
+            for _ in 0..<cycleLength {
+                _ = try reader.se() // offset_for_ref_frame
+            }
+        } else {
+            // POC 类型 2：显示顺序与解码顺序一致
+            return 0
+        }
+        _ = try reader.ue() // max_num_ref_frames
+        try reader.skip(1) // gaps_in_frame_num_value_allowed_flag
+        _ = try reader.ue() // pic_width_in_mbs_minus1
+        _ = try reader.ue() // pic_height_in_map_units_minus1
+        if try !reader.flag() { // frame_mbs_only_flag
+            try reader.skip(1) // mb_adaptive_frame_field_flag
+        }
+        try reader.skip(1) // direct_8x8_inference_flag
+        if try reader.flag() { // frame_cropping_flag
+            for _ in 0..<4 {
+                _ = try reader.ue()
+            }
+        }
+        guard try reader.flag() else { // vui_parameters_present_flag
+            throw RBSPBitReader.ReadError.missingField
+        }
+        if try reader.flag() { // aspect_ratio_info_present_flag
+            if try reader.bits(8) == 255 { // aspect_ratio_idc == Extended_SAR
+                try reader.skip(32)
+            }
+        }
+        if try reader.flag() { // overscan_info_present_flag
+            try reader.skip(1)
+        }
+        if try reader.flag() { // video_signal_type_present_flag
+            try reader.skip(4) // video_format + video_full_range_flag
+            if try reader.flag() { // colour_description_present_flag
+                try reader.skip(24)
+            }
+        }
+        if try reader.flag() { // chroma_loc_info_present_flag
+            _ = try reader.ue()
+            _ = try reader.ue()
+        }
+        if try reader.flag() { // timing_info_present_flag
+            try reader.skip(65)
+        }
+        let nalHRDPresent = try reader.flag()
+        if nalHRDPresent {
+            try skipHRDParameters(&reader)
+        }
+        let vclHRDPresent = try reader.flag()
+        if vclHRDPresent {
+            try skipHRDParameters(&reader)
+        }
+        if nalHRDPresent || vclHRDPresent {
+            try reader.skip(1) // low_delay_hrd_flag
+        }
+        try reader.skip(1) // pic_struct_present_flag
+        guard try reader.flag() else { // bitstream_restriction_flag
+            throw RBSPBitReader.ReadError.missingField
+        }
+        try reader.skip(1) // motion_vectors_over_pic_boundaries_flag
+        for _ in 0..<4 {
+            _ = try reader.ue() // max_bytes_per_pic_denom ... log2_max_mv_length_vertical
+        }
+        return try reader.ue() // max_num_reorder_frames
+    }
+
+    private static func skipScalingList(_ reader: inout RBSPBitReader, size: Int) throws {
+        var lastScale: Int32 = 8
+        var nextScale: Int32 = 8
+        for _ in 0..<size {
+            if nextScale != 0 {
+                let deltaScale = try reader.se()
+                nextScale = (lastScale + deltaScale + 256) % 256
+            }
+            lastScale = nextScale == 0 ? lastScale : nextScale
+        }
+    }
+
+    private static func skipHRDParameters(_ reader: inout RBSPBitReader) throws {
+        let cpbCount = try reader.ue() + 1
+        guard cpbCount <= 32 else { throw RBSPBitReader.ReadError.invalidValue }
+        try reader.skip(8) // bit_rate_scale + cpb_size_scale
+        for _ in 0..<cpbCount {
+            _ = try reader.ue() // bit_rate_value_minus1
+            _ = try reader.ue() // cpb_size_value_minus1
+            try reader.skip(1) // cbr_flag
+        }
+        try reader.skip(20) // 4 个 5 位的延迟长度字段
+    }
+
+    // MARK: - H.265
+
+    /// 解析 H.265 SPS 最高子层的 sps_max_num_reorder_pics（ITU-T H.265 7.3.2.2）
+    private static func h265MaxNumReorderPics(sps: Data) throws -> UInt32 {
+        var reader = RBSPBitReader(nalUnit: sps, headerLength: 2)
+        try reader.skip(4) // sps_video_parameter_set_id
+        let maxSubLayersMinus1 = try Int(reader.bits(3))
+        try reader.skip(1) // sps_temporal_id_nesting_flag
+
+        // profile_tier_level：通用 profile 88 位 + level 8 位
+        try reader.skip(96)
+        var subLayerProfilePresent: [Bool] = []
+        var subLayerLevelPresent: [Bool] = []
+        for _ in 0..<maxSubLayersMinus1 {
+            try subLayerProfilePresent.append(reader.flag())
+            try subLayerLevelPresent.append(reader.flag())
+        }
+        if maxSubLayersMinus1 > 0 {
+            try reader.skip(2 * (8 - maxSubLayersMinus1)) // reserved_zero_2bits
+        }
+        for index in 0..<maxSubLayersMinus1 {
+            if subLayerProfilePresent[index] {
+                try reader.skip(88)
+            }
+            if subLayerLevelPresent[index] {
+                try reader.skip(8)
+            }
+        }
+
+        _ = try reader.ue() // sps_seq_parameter_set_id
+        if try reader.ue() == 3 { // chroma_format_idc
+            try reader.skip(1) // separate_colour_plane_flag
+        }
+        _ = try reader.ue() // pic_width_in_luma_samples
+        _ = try reader.ue() // pic_height_in_luma_samples
+        if try reader.flag() { // conformance_window_flag
+            for _ in 0..<4 {
+                _ = try reader.ue()
+            }
+        }
+        _ = try reader.ue() // bit_depth_luma_minus8
+        _ = try reader.ue() // bit_depth_chroma_minus8
+        _ = try reader.ue() // log2_max_pic_order_cnt_lsb_minus4
+
+        // 子层排序信息：只存在最高子层时仅写一组，取最后一组即最高子层的值
+        let orderingInfoPresent = try reader.flag()
+        var maxNumReorderPics: UInt32 = 0
+        for _ in (orderingInfoPresent ? 0 : maxSubLayersMinus1)...maxSubLayersMinus1 {
+            _ = try reader.ue() // sps_max_dec_pic_buffering_minus1
+            maxNumReorderPics = try reader.ue()
+            _ = try reader.ue() // sps_max_latency_increase_plus1
+        }
+        return maxNumReorderPics
+    }
+}
+
+/// RBSP 位读取器（去除防竞争字节 0x000003 后按位读取）
+private struct RBSPBitReader {
+    enum ReadError: Error {
+        case endOfData
+        case invalidValue
+        case missingField
+    }
+
+    private let bytes: [UInt8]
+    private var bitOffset = 0
+
+    /// - Parameters:
+    ///   - nalUnit: NAL 单元（含 NAL 头，不含起始码）
+    ///   - headerLength: NAL 头长度（H.264 为 1，H.265 为 2）
+    init(nalUnit: Data, headerLength: Int) {
+        var rbsp: [UInt8] = []
+        rbsp.reserveCapacity(nalUnit.count)
+        var zeroCount = 0
+        for byte in nalUnit.dropFirst(headerLength) {
+            if zeroCount >= 2, byte == 0x03 {
+                zeroCount = 0
+                continue
+            }
+            zeroCount = byte == 0 ? zeroCount + 1 : 0
+            rbsp.append(byte)
+        }
+        bytes = rbsp
+    }
+
+    /// 读取至多 32 位无符号整数
+    mutating func bits(_ count: Int) throws -> UInt32 {
+        guard count <= 32, bitOffset + count <= bytes.count * 8 else { throw ReadError.endOfData }
+        var value: UInt32 = 0
+        for _ in 0..<count {
+            let bit = (bytes[bitOffset >> 3] >> (7 - UInt8(bitOffset & 7))) & 1
+            value = (value << 1) | UInt32(bit)
+            bitOffset += 1
+        }
+        return value
+    }
+
+    mutating func flag() throws -> Bool {
+        try bits(1) != 0
+    }
+
+    mutating func skip(_ count: Int) throws {
+        guard bitOffset + count <= bytes.count * 8 else { throw ReadError.endOfData }
+        bitOffset += count
+    }
+
+    /// 无符号指数哥伦布编码 ue(v)
+    mutating func ue() throws -> UInt32 {
+        var leadingZeros = 0
+        while try bits(1) == 0 {
+            leadingZeros += 1
+            guard leadingZeros < 32 else { throw ReadError.invalidValue }
+        }
+        guard leadingZeros > 0 else { return 0 }
+        let suffix = try bits(leadingZeros)
+        return (UInt32(1) << leadingZeros) - 1 + suffix
+    }
+
+    /// 有符号指数哥伦布编码 se(v)
+    mutating func se() throws -> Int32 {
+        let value = try ue()
+        return value & 1 == 1 ? Int32((value + 1) / 2) : -Int32(value / 2)
+    }
+}
+
 // MARK: - VideoToolbox 解码器
 
 /// VideoToolbox 硬件解码器
@@ -83,7 +358,57 @@ final class VideoToolboxDecoder {
     private let stateLock = NSLock()
 
     /// 解码后的帧回调（在 decodeQueue 上调用）
-    var onDecodedFrame: ((CVPixelBuffer) -> Void)?
+    /// 第二个参数为 VideoToolbox 输出回调触发时的主机时间
+    var onDecodedFrame: ((CVPixelBuffer, CMTime) -> Void)?
+
+    /// 帧延迟追踪器（可选，记录提交解码与解码输出阶段，并为输出的像素缓冲附加帧 ID）
+    var latencyTracer: FrameLatencyTracer?
+
+    // MARK: - 低延迟模式
+
+    /// 是否启用低延迟模式（实时解码标志 + RealTime 会话属性）
+    let isLowLatency: Bool
+
+    /// 低延迟模式下是否按实时播放调度（捕获策略在窗口不可见或过热时关闭，让系统降低解码优先级）
+    private let realTimeLock = NSLock()
+    private var isRealTimeEnabled = true
+
+    /// 解码调度器是否允许实时调度（有更高优先级的解码器时关闭），由 realTimeLock 保护
+    private var isRealTimeAllowed = true
+
+    /// 当前是否按实时播放调度解码
+    private var isRealTime: Bool {
+        realTimeLock.lock()
+        defer { realTimeLock.unlock() }
+        return isLowLatency && isRealTimeEnabled && isRealTimeAllowed
+    }
+
+    // MARK: - 仅关键帧模式
+
+    /// 内存紧张或硬件饱和且画面不可见时只解码关键帧，减少解码输出缓冲的占用与硬件争用
+    /// 退出后丢弃非关键帧直到下一个关键帧，避免在缺失参考帧的情况下解码出花屏
+    private let keyFrameLock = NSLock()
+    private var isKeyFrameOnly = false
+    /// 解码调度器要求的仅关键帧模式，与 isKeyFrameOnly 任一开启即生效
+    private var isScheduledKeyFrameOnly = false
+    private var isAwaitingKeyFrame = false
+
+    // MARK: - 解码调度
+
+    /// 解码优先级（设备源按窗口焦点与可见性设置，解码调度器据此在多个解码器之间分配硬件）
+    var priority: DecodePriority = .focused {
+        didSet {
+            guard priority != oldValue else { return }
+            DecodeScheduler.shared.setPriority(priority, for: self)
+        }
+    }
+
+    /// 是否已向调度器报告积压，受 pendingLock 保护
+    private var isBacklogged = false
+
+    /// 码流是否存在输出重排序（B 帧），由 SPS 判断
+    /// 无重排序时每帧解码后立即要求输出，解码阶段最多增加一帧延迟
+    private(set) var hasFrameReordering = true
 
     /// 回调状态锁
     private let callbackStateLock = NSLock()
@@ -111,6 +436,24 @@ final class VideoToolboxDecoder {
     /// 待解码帧计数锁
     private let pendingLock = NSLock()
 
+    /// 已提交、尚未解码完成的帧数（回放基准测试据此施加背压，避免触发丢帧策略）
+    var pendingDecodeCount: Int {
+        pendingLock.lock()
+        defer { pendingLock.unlock() }
+        return pendingFrameCount
+    }
+
+    /// 累计解码耗时（毫秒）与次数，受 pendingLock 保护，不随统计周期重置
+    private var cumulativeDecodeTimeMs: Double = 0
+    private var cumulativeDecodeCount = 0
+
+    /// 累计解码负载（码流自适应据此计算采样周期内的平均解码耗时）
+    var decodeLoad: (totalTimeMs: Double, count: Int) {
+        pendingLock.lock()
+        defer { pendingLock.unlock() }
+        return (cumulativeDecodeTimeMs, cumulativeDecodeCount)
+    }
+
     /// 上次统计日志时间
     private var lastStatsLogTime = CFAbsoluteTimeGetCurrent()
 
@@ -146,14 +489,19 @@ final class VideoToolboxDecoder {
     // MARK: - 初始化
 
     /// 初始化解码器
-    /// - Parameter codecType: 编解码类型（kCMVideoCodecType_H264 或 kCMVideoCodecType_HEVC）
-    init(codecType: CMVideoCodecType) {
+    /// - Parameters:
+    ///   - codecType: 编解码类型（kCMVideoCodecType_H264 或 kCMVideoCodecType_HEVC）
+    ///   - lowLatency: 是否启用低延迟模式（投屏默认启用）
+    init(codecType: CMVideoCodecType, lowLatency: Bool = true) {
         self.codecType = codecType
+        isLowLatency = lowLatency
         decodeQueue.setSpecific(key: Self.decodeQueueKey, value: ())
+        DecodeScheduler.shared.register(self, priority: priority)
         AppLogger.capture.info("[VTDecoder] 初始化，编解码器: \(codecType == kCMVideoCodecType_H264 ? "H.264" : "H.265")")
     }
 
     deinit {
+        DecodeScheduler.shared.unregister(self)
         invalidateSession()
         AppLogger.capture
             .info("[VTDecoder] 销毁，解码: \(decodedFrameCount), 失败: \(failedFrameCount), 丢弃: \(droppedFrameCount)")
@@ -174,10 +522,11 @@ final class VideoToolboxDecoder {
         }
 
         formatDescription = formatDesc
+        hasFrameReordering = VideoStreamReorderAnalyzer.h264HasFrameReordering(sps: sps)
         try createDecompressionSession(formatDescription: formatDesc)
 
         updateState(.ready)
-        AppLogger.capture.info("[VTDecoder] H.264 解码器初始化成功")
+        AppLogger.capture.info("[VTDecoder] H.264 解码器初始化成功，重排序: \(hasFrameReordering)")
     }
 
     /// 使用 H.265 参数集初始化解码器
@@ -194,10 +543,11 @@ final class VideoToolboxDecoder {
         }
 
         formatDescription = formatDesc
+        hasFrameReordering = VideoStreamReorderAnalyzer.h265HasFrameReordering(sps: sps)
         try createDecompressionSession(formatDescription: formatDesc)
 
         updateState(.ready)
-        AppLogger.capture.info("[VTDecoder] ✅ H.265 解码器初始化成功")
+        AppLogger.capture.info("[VTDecoder] ✅ H.265 解码器初始化成功，重排序: \(hasFrameReordering)")
     }
 
     /// 解码 NAL 单元
@@ -208,57 +558,20 @@ final class VideoToolboxDecoder {
         // 跳过参数集
         guard !nalUnit.isParameterSet else { return }
 
-        // 丢帧策略：如果待解码帧过多，丢弃非关键帧
-        pendingLock.lock()
-        let currentPending = pendingFrameCount
-        pendingLock.unlock()
-
-        if currentPending > maxPendingFrames, !nalUnit.isKeyFrame {
-            droppedFrameCount += 1
-            droppedInPeriod += 1
-            return
+        enqueueDecode(isKeyFrame: nalUnit.isKeyFrame) { decoder in
+            decoder.decodeNALUnitSync(nalUnit: nalUnit, presentationTime: presentationTime)
         }
+    }
 
-        pendingLock.lock()
-        pendingFrameCount += 1
-        pendingLock.unlock()
-
-        decodeCallsInPeriod += 1
-
-        // 定期重置统计（保留内部统计逻辑，移除日志输出）
-        let now = CFAbsoluteTimeGetCurrent()
-        if now - lastStatsLogTime >= 5.0 {
-            // 重置周期统计
-            lastStatsLogTime = now
-            decodedInPeriod = 0
-            droppedInPeriod = 0
-            decodeCallsInPeriod = 0
-            totalDecodeTime = 0
-            maxDecodeTime = 0
-            maxDecodeInterval = 0
-        }
+    /// 解码 scrcpy 视频包
+    /// 视频包的 block buffer 已是 AVCC 格式，直接包装为 CMSampleBuffer，不再复制
+    /// - Parameter packet: 视频包（配置包会被跳过）
+    func decode(packet: ScrcpyVideoPacket) {
+        // 参数集已在格式描述中
+        guard let blockBuffer = packet.blockBuffer else { return }
 
-        decodeQueue.async { [weak self] in
-            guard let self else { return }
-            
-            let decodeStartTime = CFAbsoluteTimeGetCurrent()
-            
-            defer {
-                pendingLock.lock()
-                pendingFrameCount -= 1
-                pendingLock.unlock()
-                
-                // 统计解码耗时
-                let decodeTime = (CFAbsoluteTimeGetCurrent() - decodeStartTime) * 1000
-                totalDecodeTime += decodeTime
-                maxDecodeTime = max(maxDecodeTime, decodeTime)
-                
-                // 统计解码间隔
-                let interval = (CFAbsoluteTimeGetCurrent() - lastDecodeCompleteTime) * 1000
-                maxDecodeInterval = max(maxDecodeInterval, interval)
-                lastDecodeCompleteTime = CFAbsoluteTimeGetCurrent()
-            }
-            decodeNALUnitSync(nalUnit: nalUnit, presentationTime: presentationTime)
+        enqueueDecode(isKeyFrame: packet.isKeyFrame) { decoder in
+            decoder.decodeBlockBufferSync(blockBuffer, isKeyFrame: packet.isKeyFrame, presentationTime: packet.presentationTime)
         }
     }
 
@@ -301,6 +614,24 @@ final class VideoToolboxDecoder {
         decodeQueueSync { }
     }
 
+    /// 切换实时解码调度（仅低延迟模式有效，对当前会话立即生效）
+    /// - Parameter enabled: 是否按实时播放调度
+    func setRealTime(_ enabled: Bool) {
+        updateRealTime { $0.isRealTimeEnabled = enabled }
+    }
+
+    /// 切换仅关键帧模式
+    /// - Parameter enabled: 是否只解码关键帧
+    func setKeyFrameOnly(_ enabled: Bool) {
+        updateKeyFrameOnly { $0.isKeyFrameOnly = enabled }
+    }
+
+    /// 应用解码调度器分配的限制（由 DecodeScheduler 调用）
+    func applySchedule(_ schedule: DecodeSchedule) {
+        updateRealTime { $0.isRealTimeAllowed = schedule.allowsRealTime }
+        updateKeyFrameOnly { $0.isScheduledKeyFrameOnly = schedule.keyFrameOnly }
+    }
+
     /// 重置解码器
     func reset() {
         stopAndDrain()
@@ -314,7 +645,15 @@ final class VideoToolboxDecoder {
         lastStatsLogTime = CFAbsoluteTimeGetCurrent()
         pendingLock.lock()
         pendingFrameCount = 0
+        let wasBacklogged = isBacklogged
+        isBacklogged = false
         pendingLock.unlock()
+        if wasBacklogged {
+            DecodeScheduler.shared.reportBacklog(false, for: self)
+        }
+        keyFrameLock.lock()
+        isAwaitingKeyFrame = false
+        keyFrameLock.unlock()
         updateState(.idle)
         AppLogger.capture.info("[VTDecoder] 已重置")
     }
@@ -328,6 +667,36 @@ final class VideoToolboxDecoder {
 
     // MARK: - 私有方法
 
+    /// 修改实时调度条件，实际调度变化时更新当前会话
+    private func updateRealTime(_ update: (VideoToolboxDecoder) -> Void) {
+        realTimeLock.lock()
+        let wasRealTime = isRealTimeEnabled && isRealTimeAllowed
+        update(self)
+        let enabled = isRealTimeEnabled && isRealTimeAllowed
+        realTimeLock.unlock()
+        guard wasRealTime != enabled, isLowLatency else { return }
+
+        decodeQueue.async { [weak self] in
+            guard let self, let session = decompressionSession else { return }
+            applyRealTimeProperty(to: session, enabled: enabled)
+        }
+        AppLogger.capture.info("[VTDecoder] 实时解码调度: \(enabled ? "开启" : "关闭")")
+    }
+
+    /// 修改仅关键帧条件，退出仅关键帧模式时等待下一个关键帧
+    private func updateKeyFrameOnly(_ update: (VideoToolboxDecoder) -> Void) {
+        keyFrameLock.lock()
+        let wasKeyFrameOnly = isKeyFrameOnly || isScheduledKeyFrameOnly
+        update(self)
+        let enabled = isKeyFrameOnly || isScheduledKeyFrameOnly
+        if wasKeyFrameOnly, !enabled {
+            isAwaitingKeyFrame = true
+        }
+        keyFrameLock.unlock()
+        guard wasKeyFrameOnly != enabled else { return }
+        AppLogger.capture.info("[VTDecoder] 仅关键帧模式: \(enabled ? "开启" : "关闭")")
+    }
+
     /// 更新状态
     private func updateState(_ newState: VideoToolboxDecoderState) {
         stateLock.lock()
@@ -357,10 +726,22 @@ final class VideoToolboxDecoder {
         }
     }
 
-    private func handleDecodedCallback(status: OSStatus, imageBuffer: CVImageBuffer?) {
+    private func handleDecodedCallback(
+        status: OSStatus,
+        imageBuffer: CVImageBuffer?,
+        presentationTime: CMTime,
+        isStaticCandidate: Bool
+    ) {
+        // 在输出回调中打时间戳，不计入转发到 decodeQueue 的排队时间
+        let outputTime = CMClockGetTime(CMClockGetHostTimeClock())
         let state = getCallbackState()
         guard state.enabled else { return }
 
+        if let tracer = latencyTracer, let buffer = imageBuffer, let frameID = FrameLatencyTracer.frameID(for: presentationTime) {
+            FrameLatencyTracer.attachFrameID(frameID, to: buffer)
+            tracer.mark(.decodeOutput, frameID: frameID, at: CMTimeGetSeconds(outputTime))
+        }
+
         if status != noErr || imageBuffer == nil {
             decodeQueue.async { [weak self] in
                 guard let self else { return }
@@ -372,6 +753,8 @@ final class VideoToolboxDecoder {
         }
 
         guard let buffer = imageBuffer else { return }
+        ZeroCopyFrameContract.markProduced(buffer)
+        StaticFrameDetector.markCandidate(buffer, isStaticCandidate)
         let retainedBufferRef = Unmanaged.passRetained(buffer).toOpaque()
 
         decodeQueue.async { [weak self] in
@@ -388,7 +771,7 @@ final class VideoToolboxDecoder {
 
             self.decodedFrameCount += 1
             self.decodedInPeriod += 1
-            self.onDecodedFrame?(buffer)
+            self.onDecodedFrame?(buffer, outputTime)
         }
     }
 
@@ -397,20 +780,29 @@ final class VideoToolboxDecoder {
         // 先销毁旧的会话
         invalidateSession()
 
-        // 输出配置
-        let outputPixelBufferAttributes: [String: Any] = [
-            kCVPixelBufferPixelFormatTypeKey as String: kCVPixelFormatType_32BGRA,
-            kCVPixelBufferMetalCompatibilityKey as String: true,
-        ]
+        // 输出配置：420v 双平面，省去 VideoToolbox 内部的 BGRA 颜色转换，输出带宽减半
+        // 宽高按码流尺寸设置，解码会话的输出缓冲池按此尺寸预分配；IOSurface 支撑的缓冲可被 Metal 零拷贝导入
+        let dimensions = CMVideoFormatDescriptionGetDimensions(formatDescription)
+        var outputPixelBufferAttributes = ZeroCopyFrameContract.pixelBufferAttributes(
+            pixelFormat: kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange
+        )
+        outputPixelBufferAttributes[kCVPixelBufferWidthKey as String] = Int(dimensions.width)
+        outputPixelBufferAttributes[kCVPixelBufferHeightKey as String] = Int(dimensions.height)
 
         // 创建回调
         var outputCallback = VTDecompressionOutputCallbackRecord(
-            decompressionOutputCallback: { refcon, _, status, _, imageBuffer, _, _ in
+            decompressionOutputCallback: { refcon, frameRefcon, status, _, imageBuffer, presentationTime, _ in
                 guard let refcon else { return }
 
                 let decoder = Unmanaged<VideoToolboxDecoder>.fromOpaque(refcon).takeUnretainedValue()
 
-                decoder.handleDecodedCallback(status: status, imageBuffer: imageBuffer)
+                // 帧 refcon 非空表示视频包足够小，可能是重复帧（见 decodeBlockBufferSync）
+                decoder.handleDecodedCallback(
+                    status: status,
+                    imageBuffer: imageBuffer,
+                    presentationTime: presentationTime,
+                    isStaticCandidate: frameRefcon != nil
+                )
             },
             decompressionOutputRefCon: Unmanaged.passUnretained(self).toOpaque()
         )
@@ -429,8 +821,22 @@ final class VideoToolboxDecoder {
             throw VideoToolboxDecoderError.sessionCreationFailed(status)
         }
 
+        // 低延迟模式：提示解码器按实时播放调度，优先降低单帧延迟
+        if isLowLatency {
+            applyRealTimeProperty(to: session, enabled: isRealTime)
+        }
+
         decompressionSession = session
-        AppLogger.capture.info("[VTDecoder] 解压缩会话已创建")
+        AppLogger.capture.info("[VTDecoder] 解压缩会话已创建，输出: 420v \(dimensions.width)x\(dimensions.height)")
+    }
+
+    /// 设置会话的 RealTime 属性
+    private func applyRealTimeProperty(to session: VTDecompressionSession, enabled: Bool) {
+        let value = enabled ? kCFBooleanTrue : kCFBooleanFalse
+        let status = VTSessionSetProperty(session, key: kVTDecompressionPropertyKey_RealTime, value: value)
+        if status != noErr {
+            AppLogger.capture.warning("[VTDecoder] 设置 RealTime 属性失败: \(status)")
+        }
     }
 
     /// 销毁解压缩会话
@@ -444,6 +850,97 @@ final class VideoToolboxDecoder {
         }
     }
 
+    /// 按丢帧策略将一帧加入解码队列
+    /// - Parameters:
+    ///   - isKeyFrame: 是否为关键帧（待解码帧过多时只保留关键帧）
+    ///   - work: 在解码队列上执行的解码操作
+    private func enqueueDecode(isKeyFrame: Bool, work: @escaping (VideoToolboxDecoder) -> Void) {
+        // 仅关键帧模式或等待恢复的关键帧时，非关键帧直接丢弃
+        keyFrameLock.lock()
+        if isKeyFrame {
+            isAwaitingKeyFrame = false
+        }
+        let skipsFrame = !isKeyFrame && (isKeyFrameOnly || isScheduledKeyFrameOnly || isAwaitingKeyFrame)
+        keyFrameLock.unlock()
+
+        if skipsFrame {
+            droppedFrameCount += 1
+            droppedInPeriod += 1
+            return
+        }
+
+        // 丢帧策略：如果待解码帧过多，丢弃非关键帧
+        pendingLock.lock()
+        let currentPending = pendingFrameCount
+        pendingLock.unlock()
+
+        if currentPending > maxPendingFrames, !isKeyFrame {
+            droppedFrameCount += 1
+            droppedInPeriod += 1
+            return
+        }
+
+        // 积压越过阈值时通知调度器，由它降级优先级较低的解码器
+        pendingLock.lock()
+        pendingFrameCount += 1
+        let becameBacklogged = !isBacklogged && pendingFrameCount >= queueWarningThreshold
+        if becameBacklogged {
+            isBacklogged = true
+        }
+        pendingLock.unlock()
+        if becameBacklogged {
+            DecodeScheduler.shared.reportBacklog(true, for: self)
+        }
+
+        decodeCallsInPeriod += 1
+
+        // 定期重置统计（保留内部统计逻辑，移除日志输出）
+        let now = CFAbsoluteTimeGetCurrent()
+        if now - lastStatsLogTime >= 5.0 {
+            // 重置周期统计
+            lastStatsLogTime = now
+            decodedInPeriod = 0
+            droppedInPeriod = 0
+            decodeCallsInPeriod = 0
+            totalDecodeTime = 0
+            maxDecodeTime = 0
+            maxDecodeInterval = 0
+        }
+
+        decodeQueue.async { [weak self] in
+            guard let self else { return }
+            
+            let decodeStartTime = CFAbsoluteTimeGetCurrent()
+            
+            defer {
+                // 统计解码耗时
+                let decodeTime = (CFAbsoluteTimeGetCurrent() - decodeStartTime) * 1000
+
+                pendingLock.lock()
+                pendingFrameCount -= 1
+                cumulativeDecodeTimeMs += decodeTime
+                cumulativeDecodeCount += 1
+                let backlogCleared = isBacklogged && pendingFrameCount == 0
+                if backlogCleared {
+                    isBacklogged = false
+                }
+                pendingLock.unlock()
+                if backlogCleared {
+                    DecodeScheduler.shared.reportBacklog(false, for: self)
+                }
+                
+                totalDecodeTime += decodeTime
+                maxDecodeTime = max(maxDecodeTime, decodeTime)
+                
+                // 统计解码间隔
+                let interval = (CFAbsoluteTimeGetCurrent() - lastDecodeCompleteTime) * 1000
+                maxDecodeInterval = max(maxDecodeInterval, interval)
+                lastDecodeCompleteTime = CFAbsoluteTimeGetCurrent()
+            }
+            work(self)
+        }
+    }
+
     /// 同步解码 NAL 单元
     private func decodeNALUnitSync(nalUnit: ParsedNALUnit, presentationTime: CMTime?) {
         // 转换为 AVCC 格式
@@ -453,12 +950,10 @@ final class VideoToolboxDecoder {
 
     /// 同步解码 AVCC 数据
     private func decodeAVCCDataSync(avccData: Data, isKeyFrame: Bool, presentationTime: CMTime?) {
-        guard let session = decompressionSession, let formatDesc = formatDescription else {
+        guard decompressionSession != nil, formatDescription != nil else {
             return
         }
 
-        updateState(.decoding)
-
         // 创建 CMBlockBuffer
         var blockBuffer: CMBlockBuffer?
 
@@ -499,6 +994,17 @@ final class VideoToolboxDecoder {
             return
         }
 
+        decodeBlockBufferSync(buffer, isKeyFrame: isKeyFrame, presentationTime: presentationTime)
+    }
+
+    /// 同步解码 AVCC 格式的 block buffer
+    private func decodeBlockBufferSync(_ buffer: CMBlockBuffer, isKeyFrame: Bool, presentationTime: CMTime?) {
+        guard let session = decompressionSession, let formatDesc = formatDescription else {
+            return
+        }
+
+        updateState(.decoding)
+
         // 创建 CMSampleBuffer
         var sampleBuffer: CMSampleBuffer?
         let pts = presentationTime ?? CMTime(value: Int64(CACurrentMediaTime() * 1_000_000), timescale: 1_000_000)
@@ -509,7 +1015,7 @@ final class VideoToolboxDecoder {
             decodeTimeStamp: CMTime.invalid
         )
 
-        var sampleSize = avccData.count
+        var sampleSize = CMBlockBufferGetDataLength(buffer)
         let sampleBufferStatus = CMSampleBufferCreateReady(
             allocator: kCFAllocatorDefault,
             dataBuffer: buffer,
@@ -540,21 +1046,36 @@ final class VideoToolboxDecoder {
             }
         }
 
-        // 解码
-        let decodeFlags: VTDecodeFrameFlags = [._EnableAsynchronousDecompression]
+        // 解码（未启用时间处理，解码器不会为重排序而延迟输出）
+        var decodeFlags: VTDecodeFrameFlags = [._EnableAsynchronousDecompression]
+        if isRealTime {
+            decodeFlags.insert(._1xRealTimePlayback)
+        }
         var infoFlags: VTDecodeInfoFlags = []
 
+        if let tracer = latencyTracer, let frameID = FrameLatencyTracer.frameID(for: pts) {
+            tracer.mark(.decodeSubmit, frameID: frameID)
+        }
+
+        // 很小的非关键帧可能是编码器的重复帧，通过帧 refcon 传给输出回调，由帧管道确认内容是否变化
+        let isStaticCandidate = !isKeyFrame && sampleSize <= StaticFrameDetector.staticPacketSizeLimit
         let decodeStatus = VTDecompressionSessionDecodeFrame(
             session,
             sampleBuffer: sample,
             flags: decodeFlags,
-            frameRefcon: nil,
+            frameRefcon: isStaticCandidate ? UnsafeMutableRawPointer(bitPattern: 1) : nil,
             infoFlagsOut: &infoFlags
         )
 
         if decodeStatus != noErr {
             failedFrameCount += 1
             AppLogger.capture.warning("[VTDecoder] 解码失败: \(decodeStatus)")
+            return
+        }
+
+        // 无重排序的码流：要求立即输出，不等待解码器的重排序窗口（SPS 缺少 VUI 时解码器会按 DPB 大小缓存帧）
+        if isLowLatency, !hasFrameReordering {
+            VTDecompressionSessionFinishDelayedFrames(session)
         }
     }
 }
@@ -0,0 +1,75 @@
+//
+//  ZeroCopyFrameContract.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/11.
+//
+//  零拷贝帧约定
+//  捕获/解码输出的像素缓冲必须由 IOSurface 承载且与 Metal 兼容，
+//  经 FramePipeline 直接交给 CVMetalTextureCache 导入为纹理，全程不经过 CPU
+//
+//  调试构建中，捕获时记录 IOSurface 的修改序号（seed），之后各阶段检查序号未变：
+//  任何阶段以可写方式锁定基地址并解锁后 seed 会递增，断言即可定位破坏约定的阶段
+//
+
+import CoreVideo
+import Foundation
+import IOSurface
+
+// MARK: - 零拷贝帧约定
+
+enum ZeroCopyFrameContract {
+    // MARK: - 像素缓冲属性
+
+    /// 零拷贝像素缓冲属性（IOSurface 承载、Metal 兼容）
+    /// - Parameter pixelFormat: 像素格式
+    /// - Returns: 用于 VTDecompressionSession 等输出的像素缓冲属性（iOS 捕获由 FBDeviceVideoStream 按同样的属性配置）
+    static func pixelBufferAttributes(pixelFormat: OSType) -> [String: Any] {
+        [
+            kCVPixelBufferPixelFormatTypeKey as String: pixelFormat,
+            kCVPixelBufferIOSurfacePropertiesKey as String: [String: Any](),
+            kCVPixelBufferMetalCompatibilityKey as String: true,
+        ]
+    }
+
+    // MARK: - 调试断言
+
+    /// 记录 IOSurface 修改序号的附件键
+    private static let surfaceSeedAttachmentKey = "com.screenPresenter.zeroCopySurfaceSeed" as CFString
+
+    /// 在帧进入管道时调用：检查像素缓冲由 IOSurface 承载，并记录其修改序号
+    /// 仅在调试构建中生效
+    /// - Parameter pixelBuffer: 捕获或解码得到的像素缓冲
+    @inline(__always)
+    static func markProduced(_ pixelBuffer: CVPixelBuffer) {
+        #if DEBUG
+            guard let surface = CVPixelBufferGetIOSurface(pixelBuffer)?.takeUnretainedValue() else {
+                assertionFailure("[ZeroCopy] 像素缓冲未由 IOSurface 承载，纹理导入需要复制")
+                return
+            }
+            let seed = NSNumber(value: IOSurfaceGetSeed(surface))
+            CVBufferSetAttachment(pixelBuffer, surfaceSeedAttachmentKey, seed, .shouldNotPropagate)
+        #endif
+    }
+
+    /// 在后续阶段调用：断言像素缓冲自进入管道以来未被 CPU 以可写方式锁定
+    /// 仅在调试构建中生效
+    /// - Parameters:
+    ///   - pixelBuffer: 像素缓冲
+    ///   - stage: 当前阶段（用于断言信息）
+    @inline(__always)
+    static func assertUntouched(_ pixelBuffer: CVPixelBuffer, stage: StaticString) {
+        #if DEBUG
+            guard
+                let recorded = CVBufferCopyAttachment(pixelBuffer, surfaceSeedAttachmentKey, nil) as? NSNumber,
+                let surface = CVPixelBufferGetIOSurface(pixelBuffer)?.takeUnretainedValue()
+            else {
+                return
+            }
+            assert(
+                IOSurfaceGetSeed(surface) == recorded.uint32Value,
+                "[ZeroCopy] 像素缓冲在 \(stage) 之前被 CPU 锁定并修改"
+            )
+        #endif
+    }
+}
@@ -6,15 +6,96 @@
 //
 //  协调捕获状态与休眠阻止
 //  监听设置变化与捕获状态，自动管理 SystemSleepBlocker
+//  同时根据温度、电源与窗口可见性生成捕获策略，限制帧率、解码调度与渲染
 //
 
+import AppKit
 import Combine
 import Foundation
+import IOKit.ps
+
+// MARK: - 捕获策略
+
+/// 捕获策略
+/// 窗口不可见或系统降频时不再做全帧率的工作
+struct CapturePolicy: Equatable {
+    /// 帧率上限（温度、电源与显示器刷新率共同决定）
+    var maxFrameRate: Int
+
+    /// 是否按实时播放调度解码
+    var decoderRealTime: Bool
+
+    /// 是否暂停渲染（主窗口被完全遮挡或最小化）
+    var rendersPaused: Bool
+
+    /// 主窗口是否为焦点窗口（决定解码调度器中的优先级）
+    var windowFocused: Bool
+
+    /// 暂停渲染期间 iOS 视频流的帧率（软件抽帧开销很小，保持画面不过于陈旧）
+    static let hiddenFrameRate = 5
+
+    /// 不做任何限制的策略
+    static let unrestricted = CapturePolicy(
+        maxFrameRate: 120,
+        decoderRealTime: true,
+        rendersPaused: false,
+        windowFocused: true
+    )
+
+    /// 根据系统状态生成策略
+    /// - Parameters:
+    ///   - preferredFrameRate: 偏好设置中的捕获帧率
+    ///   - thermalState: 系统温度状态
+    ///   - isLowPowerMode: 是否开启低电量模式
+    ///   - isOnBattery: 是否使用电池供电
+    ///   - isWindowVisible: 主窗口是否可见
+    ///   - isWindowFocused: 主窗口是否为焦点窗口
+    ///   - displayRefreshRate: 主窗口所在显示器的最大刷新率（0 表示未知）
+    static func make(
+        preferredFrameRate: Int,
+        thermalState: ProcessInfo.ThermalState,
+        isLowPowerMode: Bool,
+        isOnBattery: Bool,
+        isWindowVisible: Bool,
+        isWindowFocused: Bool,
+        displayRefreshRate: Int
+    ) -> CapturePolicy {
+        var frameRate = preferredFrameRate
+
+        // 超过显示器刷新率的帧无法被看到
+        if displayRefreshRate > 0 {
+            frameRate = min(frameRate, displayRefreshRate)
+        }
+
+        switch thermalState {
+        case .serious:
+            frameRate = min(frameRate, 30)
+        case .critical:
+            frameRate = min(frameRate, 15)
+        default:
+            break
+        }
+
+        if isLowPowerMode {
+            frameRate = min(frameRate, 30)
+        } else if isOnBattery {
+            frameRate = min(frameRate, 60)
+        }
+
+        let isThrottling = thermalState == .serious || thermalState == .critical
+        return CapturePolicy(
+            maxFrameRate: max(frameRate, 1),
+            decoderRealTime: isWindowVisible && !isThrottling,
+            rendersPaused: !isWindowVisible,
+            windowFocused: isWindowVisible && isWindowFocused
+        )
+    }
+}
 
 // MARK: - 捕获电源协调器
 
 /// 捕获电源协调器
-/// 监听设置与捕获状态，自动管理 SystemSleepBlocker
+/// 监听设置与捕获状态，自动管理 SystemSleepBlocker，并将捕获策略应用到设备源
 @MainActor
 final class CapturePowerCoordinator {
 
@@ -28,6 +109,12 @@ final class CapturePowerCoordinator {
     private let blocker = SystemSleepBlocker.shared
     private let preferences = UserPreferences.shared
 
+    /// 当前捕获策略（主窗口据此暂停或恢复渲染）
+    @Published private(set) var policy = CapturePolicy.unrestricted
+
+    /// 电源变化通知的 RunLoop 源（插拔电源时触发）
+    private var powerSourceRunLoopSource: CFRunLoopSource?
+
     // MARK: - Init
 
     private init() {
@@ -52,6 +139,45 @@ final class CapturePowerCoordinator {
                 self?.evaluateAndUpdate()
             }
             .store(in: &cancellables)
+
+        // 监听温度、低电量模式、窗口遮挡与显示器变化
+        let policyNotifications: [Notification.Name] = [
+            ProcessInfo.thermalStateDidChangeNotification,
+            .NSProcessInfoPowerStateDidChange,
+            NSWindow.didChangeOcclusionStateNotification,
+            NSWindow.didChangeScreenNotification,
+            NSApplication.didChangeScreenParametersNotification,
+            NSWindow.didBecomeKeyNotification,
+            NSWindow.didResignKeyNotification,
+            NSApplication.didBecomeActiveNotification,
+            NSApplication.didResignActiveNotification,
+        ]
+        for name in policyNotifications {
+            NotificationCenter.default.publisher(for: name)
+                .receive(on: DispatchQueue.main)
+                .sink { [weak self] _ in
+                    self?.updateCapturePolicy()
+                }
+                .store(in: &cancellables)
+        }
+
+        observePowerSource()
+    }
+
+    /// 监听电源切换（IOKit 没有对应的 NSNotification）
+    private func observePowerSource() {
+        let context = Unmanaged.passUnretained(self).toOpaque()
+        guard let source = IOPSNotificationCreateRunLoopSource({ context in
+            guard let context else { return }
+            let coordinator = Unmanaged<CapturePowerCoordinator>.fromOpaque(context).takeUnretainedValue()
+            MainActor.assumeIsolated {
+                coordinator.updateCapturePolicy()
+            }
+        }, context)?.takeRetainedValue() else {
+            return
+        }
+        CFRunLoopAddSource(CFRunLoopGetMain(), source, .defaultMode)
+        powerSourceRunLoopSource = source
     }
 
     // MARK: - Core Logic
@@ -78,6 +204,9 @@ final class CapturePowerCoordinator {
         } else {
             blocker.disable()
         }
+
+        // 捕获状态变化时设备源可能已重建，重新应用策略
+        updateCapturePolicy()
     }
 
     /// 是否有任一设备正在捕获
@@ -85,6 +214,49 @@ final class CapturePowerCoordinator {
         AppState.shared.iosCapturing || AppState.shared.androidCapturing
     }
 
+    // MARK: - Capture Policy
+
+    /// 重新生成捕获策略并应用到设备源
+    private func updateCapturePolicy() {
+        let window = presenterWindow
+        let newPolicy = CapturePolicy.make(
+            preferredFrameRate: preferences.captureFrameRate,
+            thermalState: ProcessInfo.processInfo.thermalState,
+            isLowPowerMode: ProcessInfo.processInfo.isLowPowerModeEnabled,
+            isOnBattery: isOnBatteryPower,
+            isWindowVisible: window?.occlusionState.contains(.visible) ?? true,
+            isWindowFocused: NSApp.isActive && (window?.isKeyWindow ?? true),
+            displayRefreshRate: window?.screen?.maximumFramesPerSecond ?? 0
+        )
+
+        if newPolicy != policy {
+            AppLogger.performance.info(
+                "捕获策略: 帧率上限 \(newPolicy.maxFrameRate) fps | " +
+                "实时解码: \(newPolicy.decoderRealTime) | 暂停渲染: \(newPolicy.rendersPaused) | " +
+                "焦点: \(newPolicy.windowFocused)"
+            )
+            policy = newPolicy
+        }
+
+        // 设备源对未变化的策略不做处理，这里每次都应用，覆盖新建的设备源
+        AppState.shared.iosDeviceSource?.applyCapturePolicy(newPolicy)
+        AppState.shared.androidDeviceSource?.applyCapturePolicy(newPolicy)
+    }
+
+    /// 主窗口
+    private var presenterWindow: NSWindow? {
+        NSApp.windows.first { $0.contentViewController is MainViewController }
+    }
+
+    /// 是否使用电池供电
+    private var isOnBatteryPower: Bool {
+        guard let snapshot = IOPSCopyPowerSourcesInfo()?.takeRetainedValue(),
+              let type = IOPSGetProvidingPowerSourceType(snapshot)?.takeUnretainedValue() else {
+            return false
+        }
+        return type as String == kIOPMBatteryPowerKey
+    }
+
     // MARK: - Lifecycle
 
     /// 应用启动时调用
@@ -96,6 +268,10 @@ final class CapturePowerCoordinator {
     /// 应用退出时调用
     func stop() {
         blocker.disable()
+        if let source = powerSourceRunLoopSource {
+            CFRunLoopRemoveSource(CFRunLoopGetMain(), source, .defaultMode)
+            powerSourceRunLoopSource = nil
+        }
         AppLogger.app.info("CapturePowerCoordinator 已停止")
     }
 }
@@ -7,6 +7,9 @@
 //  统一日志框架
 //  基于 os.log 实现分类日志记录
 //
+//  日志调用的消息参数均为 @autoclosure：级别被过滤时不会构建字符串，
+//  捕获、解析、解码等每帧调用的路径上，被禁用的日志只有一次整数比较
+//
 
 import Foundation
 import os.log
@@ -19,7 +22,9 @@ final class LogBuffer {
 
     static let shared = LogBuffer()
 
-    private init() {}
+    private init() {
+        MemoryPressureCoordinator.shared.register(self)
+    }
 
     // MARK: - Private Properties
 
@@ -27,13 +32,20 @@ final class LogBuffer {
     private let maxEntries = 5000
     private let lock = NSLock()
 
+    /// 时间戳格式化器（ISO8601DateFormatter 线程安全，创建开销较大，全局共享）
+    fileprivate static let timestampFormatter = ISO8601DateFormatter()
+
+    /// 内存压力下保留的条数（警告 / 严重）
+    private static let warningRetainedEntries = 1000
+    private static let criticalRetainedEntries = 200
+
     // MARK: - Public Methods
 
     func append(_ message: String) {
         lock.lock()
         defer { lock.unlock() }
 
-        let timestamp = ISO8601DateFormatter().string(from: Date())
+        let timestamp = Self.timestampFormatter.string(from: Date())
         let entry = "[\(timestamp)] \(message)"
         logs.append(entry)
 
@@ -58,12 +70,37 @@ final class LogBuffer {
         defer { lock.unlock() }
         logs.removeAll()
     }
+
+    /// 只保留最近的日志
+    /// - Parameter count: 保留的条数
+    func trim(keepingLast count: Int) {
+        lock.lock()
+        defer { lock.unlock() }
+        guard logs.count > count else { return }
+        // 重新分配存储，removeFirst 不会释放数组容量
+        logs = Array(logs.suffix(count))
+    }
+}
+
+// MARK: - 内存压力
+
+extension LogBuffer: MemoryPressureResponder {
+    func memoryPressureDidChange(to level: MemoryPressureLevel) {
+        switch level {
+        case .warning:
+            trim(keepingLast: Self.warningRetainedEntries)
+        case .critical:
+            trim(keepingLast: Self.criticalRetainedEntries)
+        case .normal:
+            break
+        }
+    }
 }
 
 // MARK: - 日志分类
 
 /// 应用日志分类枚举
-enum LogCategory: String {
+enum LogCategory: String, CaseIterable {
     case app = "App"
     case device = "Device"
     case capture = "Capture"
@@ -84,17 +121,40 @@ final class AppLogger {
 
     static let shared = AppLogger()
 
-    private init() {}
+    private init() {
+        let subsystem = Bundle.main.bundleIdentifier ?? "com.haptictide.ScreenPresenter"
+        loggers = Dictionary(uniqueKeysWithValues: LogCategory.allCases.map {
+            ($0, Logger(subsystem: subsystem, category: $0.rawValue))
+        })
+        minimumPriority = Self.logPriority(Self.defaultMinimumLevel)
+    }
 
     // MARK: - Private Properties
 
-    private let subsystem = Bundle.main.bundleIdentifier ?? "com.haptictide.ScreenPresenter"
+    /// 默认的最低级别（调试构建输出 debug，发布构建从 info 开始）
+    private static let defaultMinimumLevel: OSLogType = {
+        #if DEBUG
+            return .debug
+        #else
+            return .info
+        #endif
+    }()
+
+    /// 各分类的 Logger 实例（初始化时全部创建，之后只读，多线程访问无需加锁）
+    private let loggers: [LogCategory: Logger]
 
-    /// 缓存的 Logger 实例
-    private var loggers: [LogCategory: Logger] = [:]
+    /// 最低级别的优先级缓存，日志调用只比较整数
+    private var minimumPriority: Int
+
+    // MARK: - Public Properties
 
     /// 日志级别控制
-    var minimumLevel: OSLogType = .debug
+    /// 应在启动时设置，运行中修改不保证其他线程立即可见
+    var minimumLevel: OSLogType = AppLogger.defaultMinimumLevel {
+        didSet {
+            minimumPriority = Self.logPriority(minimumLevel)
+        }
+    }
 
     /// 是否在控制台输出
     var consoleOutputEnabled: Bool = true
@@ -103,17 +163,20 @@ final class AppLogger {
 
     /// 获取指定分类的 Logger
     func logger(for category: LogCategory) -> Logger {
-        if let cached = loggers[category] {
-            return cached
-        }
-        let logger = Logger(subsystem: subsystem, category: category.rawValue)
-        loggers[category] = logger
-        return logger
+        loggers[category] ?? Logger(subsystem: Bundle.main.bundleIdentifier ?? "com.haptictide.ScreenPresenter", category: category.rawValue)
+    }
+
+    /// 指定级别是否会被记录
+    /// 消息需要额外计算（而不仅是字符串插值）时，先用它判断
+    @inline(__always)
+    func isEnabled(_ level: OSLogType) -> Bool {
+        Self.logPriority(level) >= minimumPriority
     }
 
     /// Debug 级别日志
+    @inline(__always)
     func debug(
-        _ message: String,
+        _ message: @autoclosure () -> String,
         category: LogCategory = .app,
         file: String = #file,
         function: String = #function,
@@ -123,8 +186,9 @@ final class AppLogger {
     }
 
     /// Info 级别日志
+    @inline(__always)
     func info(
-        _ message: String,
+        _ message: @autoclosure () -> String,
         category: LogCategory = .app,
         file: String = #file,
         function: String = #function,
@@ -134,8 +198,9 @@ final class AppLogger {
     }
 
     /// Warning 级别日志（使用 default 类型）
+    @inline(__always)
     func warning(
-        _ message: String,
+        _ message: @autoclosure () -> String,
         category: LogCategory = .app,
         file: String = #file,
         function: String = #function,
@@ -145,8 +210,9 @@ final class AppLogger {
     }
 
     /// Error 级别日志
+    @inline(__always)
     func error(
-        _ message: String,
+        _ message: @autoclosure () -> String,
         category: LogCategory = .app,
         file: String = #file,
         function: String = #function,
@@ -156,8 +222,9 @@ final class AppLogger {
     }
 
     /// Fault 级别日志（严重错误）
+    @inline(__always)
     func fault(
-        _ message: String,
+        _ message: @autoclosure () -> String,
         category: LogCategory = .app,
         file: String = #file,
         function: String = #function,
@@ -168,16 +235,28 @@ final class AppLogger {
 
     // MARK: - Private Methods
 
+    @inline(__always)
     private func log(
-        _ message: String,
+        _ message: () -> String,
         level: OSLogType,
         category: LogCategory,
         file: String,
         function: String,
         line: Int
     ) {
-        guard shouldLog(level: level) else { return }
+        guard isEnabled(level) else { return }
+        write(message(), level: level, category: category, file: file, function: function, line: line)
+    }
 
+    /// 级别检查通过后才调用，消息已构建
+    private func write(
+        _ message: String,
+        level: OSLogType,
+        category: LogCategory,
+        file: String,
+        function: String,
+        line: Int
+    ) {
         let logger = logger(for: category)
         let fileName = (file as NSString).lastPathComponent
 
@@ -207,27 +286,17 @@ final class AppLogger {
         #if DEBUG
             if consoleOutputEnabled {
                 let emoji = levelEmoji(level)
-                let timestamp = ISO8601DateFormatter().string(from: Date())
+                let timestamp = LogBuffer.timestampFormatter.string(from: Date())
                 print("\(emoji) [\(timestamp)] [\(category.rawValue)] \(formattedMessage)")
             }
         #endif
     }
 
-    private func shouldLog(level: OSLogType) -> Bool {
-        // OSLogType.rawValue 的值:
-        // .debug = 0x02 (2)
-        // .info = 0x01 (1)
-        // .default = 0x00 (0)
-        // .error = 0x10 (16)
-        // .fault = 0x11 (17)
-        // 这些值不是按严重程度递增的，所以需要手动映射
-        let levelPriority = logPriority(level)
-        let minimumPriority = logPriority(minimumLevel)
-        return levelPriority >= minimumPriority
-    }
-
     /// 将 OSLogType 映射到严重程度优先级（数值越大越严重）
-    private func logPriority(_ level: OSLogType) -> Int {
+    /// OSLogType.rawValue 不是按严重程度递增的（debug = 2, info = 1, default = 0, error = 16, fault = 17），所以需要手动映射
+    /// 调用处的级别是常量时，内联后在编译期求值
+    @inline(__always)
+    private static func logPriority(_ level: OSLogType) -> Int {
         switch level {
         case .debug: 0
         case .info: 1
@@ -307,24 +376,29 @@ struct CategoryLogger {
         self.category = category
     }
 
-    func debug(_ message: String, file: String = #file, function: String = #function, line: Int = #line) {
-        AppLogger.shared.debug(message, category: category, file: file, function: function, line: line)
+    @inline(__always)
+    func debug(_ message: @autoclosure () -> String, file: String = #file, function: String = #function, line: Int = #line) {
+        AppLogger.shared.debug(message(), category: category, file: file, function: function, line: line)
     }
 
-    func info(_ message: String, file: String = #file, function: String = #function, line: Int = #line) {
-        AppLogger.shared.info(message, category: category, file: file, function: function, line: line)
+    @inline(__always)
+    func info(_ message: @autoclosure () -> String, file: String = #file, function: String = #function, line: Int = #line) {
+        AppLogger.shared.info(message(), category: category, file: file, function: function, line: line)
     }
 
-    func warning(_ message: String, file: String = #file, function: String = #function, line: Int = #line) {
-        AppLogger.shared.warning(message, category: category, file: file, function: function, line: line)
+    @inline(__always)
+    func warning(_ message: @autoclosure () -> String, file: String = #file, function: String = #function, line: Int = #line) {
+        AppLogger.shared.warning(message(), category: category, file: file, function: function, line: line)
     }
 
-    func error(_ message: String, file: String = #file, function: String = #function, line: Int = #line) {
-        AppLogger.shared.error(message, category: category, file: file, function: function, line: line)
+    @inline(__always)
+    func error(_ message: @autoclosure () -> String, file: String = #file, function: String = #function, line: Int = #line) {
+        AppLogger.shared.error(message(), category: category, file: file, function: function, line: line)
     }
 
-    func fault(_ message: String, file: String = #file, function: String = #function, line: Int = #line) {
-        AppLogger.shared.fault(message, category: category, file: file, function: function, line: line)
+    @inline(__always)
+    func fault(_ message: @autoclosure () -> String, file: String = #file, function: String = #function, line: Int = #line) {
+        AppLogger.shared.fault(message(), category: category, file: file, function: function, line: line)
     }
 }
 
@@ -332,57 +406,57 @@ struct CategoryLogger {
 
 /// 全局日志函数 - Debug
 func logDebug(
-    _ message: String,
+    _ message: @autoclosure () -> String,
     category: LogCategory = .app,
     file: String = #file,
     function: String = #function,
     line: Int = #line
 ) {
-    AppLogger.shared.debug(message, category: category, file: file, function: function, line: line)
+    AppLogger.shared.debug(message(), category: category, file: file, function: function, line: line)
 }
 
 /// 全局日志函数 - Info
 func logInfo(
-    _ message: String,
+    _ message: @autoclosure () -> String,
     category: LogCategory = .app,
     file: String = #file,
     function: String = #function,
     line: Int = #line
 ) {
-    AppLogger.shared.info(message, category: category, file: file, function: function, line: line)
+    AppLogger.shared.info(message(), category: category, file: file, function: function, line: line)
 }
 
 /// 全局日志函数 - Warning
 func logWarning(
-    _ message: String,
+    _ message: @autoclosure () -> String,
     category: LogCategory = .app,
     file: String = #file,
     function: String = #function,
     line: Int = #line
 ) {
-    AppLogger.shared.warning(message, category: category, file: file, function: function, line: line)
+    AppLogger.shared.warning(message(), category: category, file: file, function: function, line: line)
 }
 
 /// 全局日志函数 - Error
 func logError(
-    _ message: String,
+    _ message: @autoclosure () -> String,
     category: LogCategory = .app,
     file: String = #file,
     function: String = #function,
     line: Int = #line
 ) {
-    AppLogger.shared.error(message, category: category, file: file, function: function, line: line)
+    AppLogger.shared.error(message(), category: category, file: file, function: function, line: line)
 }
 
 /// 全局日志函数 - Fault
 func logFault(
-    _ message: String,
+    _ message: @autoclosure () -> String,
     category: LogCategory = .app,
     file: String = #file,
     function: String = #function,
     line: Int = #line
 ) {
-    AppLogger.shared.fault(message, category: category, file: file, function: function, line: line)
+    AppLogger.shared.fault(message(), category: category, file: file, function: function, line: line)
 }
 
 // MARK: - 性能日志扩展
@@ -0,0 +1,377 @@
+//
+//  MainThreadWatchdog.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  主线程卡顿检测
+//  后台线程定时向主队列投递探测任务，探测超过阈值未被执行时判定为卡顿：
+//  暂停主线程取一次调用栈，并记录卡顿前后各设备源的丢帧数与解码队列深度，
+//  投屏卡顿时可以据此区分是主线程、解码器还是设备的问题
+//
+//  调用栈采样:
+//  thread_suspend → thread_get_state 读取 pc/lr/fp → 沿帧指针链回溯 → thread_resume
+//  主线程暂停期间只读寄存器与栈内存（写入预先分配的缓冲），不分配内存、不加锁，避免与主线程持有的锁死锁；
+//  恢复主线程后再用 dladdr 符号化
+//
+
+import Darwin
+import Foundation
+import os.lock
+
+// MARK: - 卡顿关联数据
+
+/// 设备源在某一时刻的帧统计
+struct HangFrameSample {
+    /// 帧管道累计跳过的帧数（未被渲染就被新帧覆盖）
+    var skippedFrames: Int
+    /// 解码队列深度（不经过 VideoToolboxDecoder 的设备源为 nil）
+    var decodeQueueDepth: Int?
+}
+
+/// 为卡顿报告提供帧统计的设备源
+/// 实现此协议并向检测器注册（弱引用，无需注销）；在检测线程调用，实现需线程安全
+protocol HangCorrelationSource: AnyObject {
+    /// 报告中显示的名称
+    var hangCorrelationName: String { get }
+
+    /// 当前的帧统计
+    func hangFrameSample() -> HangFrameSample
+}
+
+// MARK: - 卡顿报告
+
+/// 主线程卡顿报告
+struct MainThreadHangReport {
+    /// 单个设备源在卡顿期间的帧统计
+    struct SourceStatistics {
+        let name: String
+        /// 卡顿期间新增的跳帧数
+        let skippedFrames: Int
+        /// 卡顿开始与结束时解码队列深度的较大值
+        let decodeQueueDepth: Int?
+    }
+
+    /// 卡顿开始时间（探测任务投递时间）
+    let startDate: Date
+
+    /// 卡顿时长（秒）
+    let duration: TimeInterval
+
+    /// 主线程调用栈（已符号化，最内层在前）
+    let stack: [String]
+
+    /// 各设备源的帧统计
+    let sources: [SourceStatistics]
+
+    /// 单行摘要
+    var summary: String {
+        let frames = sources.map { source in
+            var text = "\(source.name) 跳帧 +\(source.skippedFrames)"
+            if let depth = source.decodeQueueDepth {
+                text += " 解码队列 \(depth)"
+            }
+            return text
+        }
+        let top = stack.first { !$0.hasPrefix("libsystem_kernel") } ?? stack.first ?? "?"
+        return (["卡顿 \(Int(duration * 1000)) ms @ \(top)"] + frames).joined(separator: " · ")
+    }
+}
+
+// MARK: - 主线程卡顿检测器
+
+/// 主线程卡顿检测器
+///
+/// 线程安全：
+/// - register() 与 reports 可在任意线程调用
+/// - start() / stop() 在主线程调用
+final class MainThreadWatchdog: @unchecked Sendable {
+    // MARK: - Singleton
+
+    static let shared = MainThreadWatchdog()
+
+    // MARK: - 常量
+
+    /// 探测间隔（秒）
+    static let pingInterval: TimeInterval = 0.1
+
+    /// 卡顿阈值（秒）
+    static let hangThreshold: TimeInterval = 0.25
+
+    /// 保留的卡顿报告数
+    static let maxReports = 20
+
+    /// 调用栈最大深度
+    private static let maxStackDepth = 64
+
+    // MARK: - 类型定义
+
+    private struct WeakSource {
+        weak var source: HangCorrelationSource?
+    }
+
+    /// 进行中的卡顿
+    private struct PendingHang {
+        let pingTime: CFAbsoluteTime
+        let stack: [String]
+        let samples: [(HangCorrelationSource, HangFrameSample)]
+    }
+
+    private struct State {
+        var sources: [ObjectIdentifier: WeakSource] = [:]
+        var reports: [MainThreadHangReport] = []
+        /// 尚未被主线程响应的探测的投递时间
+        var outstandingPing: CFAbsoluteTime?
+        /// 主线程最近一次响应探测的时间
+        var lastResponseTime: CFAbsoluteTime = 0
+    }
+
+    // MARK: - 属性
+
+    /// 最近的卡顿报告（最新的在后）
+    var reports: [MainThreadHangReport] {
+        state.withLock { $0.reports }
+    }
+
+    private let state = OSAllocatedUnfairLock(initialState: State())
+
+    private let queue = DispatchQueue(label: "com.screenPresenter.mainThreadWatchdog", qos: .userInitiated)
+
+    /// 以下状态只在 queue 访问
+    private var timer: DispatchSourceTimer?
+    private var pendingHang: PendingHang?
+
+    /// 主线程的 Mach 端口（start() 在主线程取得）
+    private var mainThread: thread_act_t = 0
+
+    /// 回溯缓冲（预先分配，主线程暂停期间不能分配内存）
+    private let frameBuffer = UnsafeMutablePointer<UInt>.allocate(capacity: MainThreadWatchdog.maxStackDepth)
+
+    // MARK: - 初始化
+
+    private init() {}
+
+    // MARK: - 注册
+
+    /// 注册设备源
+    func register(_ source: HangCorrelationSource) {
+        state.withLock {
+            $0.sources[ObjectIdentifier(source)] = WeakSource(source: source)
+        }
+    }
+
+    // MARK: - Lifecycle
+
+    /// 应用启动时调用（主线程）
+    func start() {
+        dispatchPrecondition(condition: .onQueue(.main))
+        let mainThread = mach_thread_self()
+
+        queue.sync {
+            guard timer == nil else { return }
+            self.mainThread = mainThread
+
+            let timer = DispatchSource.makeTimerSource(queue: queue)
+            timer.schedule(
+                deadline: .now() + Self.pingInterval,
+                repeating: Self.pingInterval,
+                leeway: .milliseconds(20)
+            )
+            timer.setEventHandler { [weak self] in
+                self?.tick()
+            }
+            timer.activate()
+            self.timer = timer
+        }
+        AppLogger.app.info("MainThreadWatchdog 已启动")
+    }
+
+    /// 应用退出时调用
+    func stop() {
+        queue.sync {
+            timer?.cancel()
+            timer = nil
+            pendingHang = nil
+            if mainThread != 0 {
+                mach_port_deallocate(mach_task_self_, mainThread)
+                mainThread = 0
+            }
+        }
+        state.withLock { $0.outstandingPing = nil }
+        AppLogger.app.info("MainThreadWatchdog 已停止")
+    }
+
+    // MARK: - 探测
+
+    /// 在 queue 上执行
+    private func tick() {
+        let now = CFAbsoluteTimeGetCurrent()
+        let (outstanding, lastResponseTime) = state.withLock { ($0.outstandingPing, $0.lastResponseTime) }
+
+        guard let pingTime = outstanding else {
+            // 上一次探测已被响应：结束进行中的卡顿并投递新的探测
+            finishPendingHang(at: lastResponseTime)
+            state.withLock { $0.outstandingPing = now }
+            DispatchQueue.main.async { [weak self] in
+                self?.state.withLock {
+                    $0.outstandingPing = nil
+                    $0.lastResponseTime = CFAbsoluteTimeGetCurrent()
+                }
+            }
+            return
+        }
+
+        guard pendingHang == nil, now - pingTime >= Self.hangThreshold else { return }
+
+        // 超过阈值：记录卡顿开始时的调用栈与帧统计，等主线程恢复后生成报告
+        pendingHang = PendingHang(
+            pingTime: pingTime,
+            stack: sampleMainThreadStack(),
+            samples: currentSamples()
+        )
+    }
+
+    /// - Parameter endTime: 主线程恢复响应的时间
+    private func finishPendingHang(at endTime: CFAbsoluteTime) {
+        guard let hang = pendingHang else { return }
+        pendingHang = nil
+
+        let endSamples = Dictionary(
+            currentSamples().map { (ObjectIdentifier($0.0), $0.1) },
+            uniquingKeysWith: { first, _ in first }
+        )
+        let sources = hang.samples.map { source, start -> MainThreadHangReport.SourceStatistics in
+            let end = endSamples[ObjectIdentifier(source)]
+            let depths = [start.decodeQueueDepth, end?.decodeQueueDepth].compactMap { $0 }
+            return MainThreadHangReport.SourceStatistics(
+                name: source.hangCorrelationName,
+                skippedFrames: max(0, (end?.skippedFrames ?? start.skippedFrames) - start.skippedFrames),
+                decodeQueueDepth: depths.max()
+            )
+        }
+
+        let report = MainThreadHangReport(
+            startDate: Date(timeIntervalSinceReferenceDate: hang.pingTime),
+            duration: endTime - hang.pingTime,
+            stack: hang.stack,
+            sources: sources
+        )
+        state.withLock {
+            $0.reports.append(report)
+            if $0.reports.count > Self.maxReports {
+                $0.reports.removeFirst($0.reports.count - Self.maxReports)
+            }
+        }
+
+        AppLogger.performance.warning("主线程\(report.summary)\n\(report.stack.prefix(12).joined(separator: "\n"))")
+    }
+
+    private func currentSamples() -> [(HangCorrelationSource, HangFrameSample)] {
+        let sources = state.withLock { state -> [HangCorrelationSource] in
+            state.sources = state.sources.filter { $0.value.source != nil }
+            return state.sources.values.compactMap(\.source)
+        }
+        return sources.map { ($0, $0.hangFrameSample()) }
+    }
+
+    // MARK: - 调用栈采样
+
+    /// 暂停主线程并沿帧指针链回溯
+    private func sampleMainThreadStack() -> [String] {
+        guard mainThread != 0 else { return [] }
+
+        let mainPthread = pthread_main_thread_np()
+        let stackTop = UInt(bitPattern: pthread_get_stackaddr_np(mainPthread))
+        let stackBottom = stackTop - UInt(pthread_get_stacksize_np(mainPthread))
+
+        guard thread_suspend(mainThread) == KERN_SUCCESS else { return [] }
+        let depth = backtraceSuspendedThread(stackBottom: stackBottom, stackTop: stackTop)
+        thread_resume(mainThread)
+
+        return (0..<depth).map { Self.symbolicate(frameBuffer[$0]) }
+    }
+
+    /// 主线程暂停期间执行：只读寄存器与栈内存，结果写入预先分配的 frameBuffer
+    private func backtraceSuspendedThread(stackBottom: UInt, stackTop: UInt) -> Int {
+        guard let registers = threadRegisters() else { return 0 }
+
+        var depth = 0
+        frameBuffer[depth] = registers.pc
+        depth += 1
+        if let lr = registers.lr {
+            frameBuffer[depth] = lr
+            depth += 1
+        }
+
+        // 帧记录: [fp] = 上一帧的 fp，[fp + 8] = 返回地址；fp 必须在栈内、对齐且单调递增
+        var fp = registers.fp
+        while depth < Self.maxStackDepth, fp >= stackBottom, fp + 16 <= stackTop, fp & 0xF == 0 {
+            guard let record = UnsafePointer<UInt>(bitPattern: fp) else { break }
+            let returnAddress = Self.stripPointerAuthentication(record[1])
+            guard returnAddress != 0 else { break }
+            frameBuffer[depth] = returnAddress
+            depth += 1
+
+            let next = record[0]
+            guard next > fp else { break }
+            fp = next
+        }
+        return depth
+    }
+
+    /// 读取主线程的 pc、lr（仅 arm64）与 fp
+    private func threadRegisters() -> (pc: UInt, lr: UInt?, fp: UInt)? {
+        #if arch(arm64)
+        var threadState = arm_thread_state64_t()
+        var count = mach_msg_type_number_t(MemoryLayout<arm_thread_state64_t>.size / MemoryLayout<natural_t>.size)
+        let result = withUnsafeMutablePointer(to: &threadState) {
+            $0.withMemoryRebound(to: natural_t.self, capacity: Int(count)) {
+                thread_get_state(mainThread, thread_state_flavor_t(ARM_THREAD_STATE64), $0, &count)
+            }
+        }
+        guard result == KERN_SUCCESS else { return nil }
+        return (
+            Self.stripPointerAuthentication(UInt(threadState.__pc)),
+            Self.stripPointerAuthentication(UInt(threadState.__lr)),
+            UInt(threadState.__fp)
+        )
+        #elseif arch(x86_64)
+        var threadState = x86_thread_state64_t()
+        var count = mach_msg_type_number_t(MemoryLayout<x86_thread_state64_t>.size / MemoryLayout<natural_t>.size)
+        let result = withUnsafeMutablePointer(to: &threadState) {
+            $0.withMemoryRebound(to: natural_t.self, capacity: Int(count)) {
+                thread_get_state(mainThread, thread_state_flavor_t(x86_THREAD_STATE64), $0, &count)
+            }
+        }
+        guard result == KERN_SUCCESS else { return nil }
+        return (UInt(threadState.__rip), nil, UInt(threadState.__rbp))
+        #else
+        return nil
+        #endif
+    }
+
+    /// 去掉 arm64e 返回地址中的指针认证位（用户态地址不超过 47 位）
+    private static func stripPointerAuthentication(_ address: UInt) -> UInt {
+        #if arch(arm64)
+        address & 0x0000_7FFF_FFFF_FFFF
+        #else
+        address
+        #endif
+    }
+
+    /// 符号化单个地址，格式为 "镜像名 符号 + 偏移"
+    private static func symbolicate(_ address: UInt) -> String {
+        var info = Dl_info()
+        guard let pointer = UnsafeRawPointer(bitPattern: address), dladdr(pointer, &info) != 0 else {
+            return String(format: "0x%lx", address)
+        }
+
+        let image = info.dli_fname.map { (String(cString: $0) as NSString).lastPathComponent } ?? "?"
+        guard let symbolName = info.dli_sname, let symbolAddress = info.dli_saddr else {
+            return String(format: "%@ 0x%lx", image, address)
+        }
+        let symbol = String(cString: symbolName)
+        let offset = address - UInt(bitPattern: symbolAddress)
+        return "\(image) \(symbol) + \(offset)"
+    }
+}
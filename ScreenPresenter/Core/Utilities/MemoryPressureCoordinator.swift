@@ -0,0 +1,144 @@
+//
+//  MemoryPressureCoordinator.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  内存压力协调器
+//  监听系统内存压力，统一通知持有可回收内存的组件（纹理缓存、缩放纹理、缩略图缓冲池、解码器、日志缓存）
+//  多设备长时间投屏时，在系统开始换页之前主动释放可以重建的内存
+//
+//  响应策略:
+//  - warning: 清空可重建的缓存，不可见设备只解码关键帧，日志缓存裁剪到较小条数
+//  - critical: 在 warning 的基础上释放缓冲池等更大的常驻内存
+//  - normal: 恢复正常解码（缓存按需重建，无需恢复）
+//
+
+import Foundation
+import os.lock
+
+// MARK: - 内存压力级别
+
+/// 内存压力级别
+enum MemoryPressureLevel: Int, Comparable {
+    case normal = 0
+    case warning = 1
+    case critical = 2
+
+    static func < (lhs: MemoryPressureLevel, rhs: MemoryPressureLevel) -> Bool {
+        lhs.rawValue < rhs.rawValue
+    }
+
+    var description: String {
+        switch self {
+        case .normal: "正常"
+        case .warning: "警告"
+        case .critical: "严重"
+        }
+    }
+}
+
+// MARK: - 内存压力响应者
+
+/// 内存压力响应者
+/// 持有可回收内存的组件实现此协议并向协调器注册（弱引用，无需注销）
+protocol MemoryPressureResponder: AnyObject {
+    /// 内存压力级别变化（在主线程调用，实现需切换到组件自己的队列访问非线程安全的状态）
+    func memoryPressureDidChange(to level: MemoryPressureLevel)
+}
+
+// MARK: - 内存压力协调器
+
+/// 内存压力协调器
+///
+/// 线程安全：
+/// - register() 与 level 可在任意线程调用
+/// - 压力事件在主线程处理，响应者在主线程收到回调
+final class MemoryPressureCoordinator: @unchecked Sendable {
+    // MARK: - Singleton
+
+    static let shared = MemoryPressureCoordinator()
+
+    // MARK: - 类型定义
+
+    private struct WeakResponder {
+        weak var responder: MemoryPressureResponder?
+    }
+
+    private struct State {
+        var level = MemoryPressureLevel.normal
+        var responders: [ObjectIdentifier: WeakResponder] = [:]
+    }
+
+    // MARK: - 属性
+
+    /// 当前内存压力级别
+    var level: MemoryPressureLevel {
+        state.withLock { $0.level }
+    }
+
+    private let state = OSAllocatedUnfairLock(initialState: State())
+
+    /// 内存压力事件源（只在主线程访问）
+    private var source: DispatchSourceMemoryPressure?
+
+    // MARK: - 初始化
+
+    private init() {}
+
+    // MARK: - 注册
+
+    /// 注册响应者
+    func register(_ responder: MemoryPressureResponder) {
+        state.withLock {
+            $0.responders[ObjectIdentifier(responder)] = WeakResponder(responder: responder)
+        }
+    }
+
+    // MARK: - Lifecycle
+
+    /// 应用启动时调用
+    func start() {
+        guard source == nil else { return }
+
+        let source = DispatchSource.makeMemoryPressureSource(eventMask: [.normal, .warning, .critical], queue: .main)
+        source.setEventHandler { [weak self, weak source] in
+            guard let self, let event = source?.data else { return }
+            handle(event)
+        }
+        source.activate()
+        self.source = source
+        AppLogger.app.info("MemoryPressureCoordinator 已启动")
+    }
+
+    /// 应用退出时调用
+    func stop() {
+        source?.cancel()
+        source = nil
+        AppLogger.app.info("MemoryPressureCoordinator 已停止")
+    }
+
+    // MARK: - 事件处理
+
+    private func handle(_ event: DispatchSource.MemoryPressureEvent) {
+        let newLevel: MemoryPressureLevel = if event.contains(.critical) {
+            .critical
+        } else if event.contains(.warning) {
+            .warning
+        } else {
+            .normal
+        }
+
+        // 取出存活的响应者并清理已释放的条目，回调在锁外执行
+        let responders = state.withLock { state -> [MemoryPressureResponder] in
+            state.level = newLevel
+            state.responders = state.responders.filter { $0.value.responder != nil }
+            return state.responders.values.compactMap(\.responder)
+        }
+
+        AppLogger.performance.warning("内存压力: \(newLevel.description)，通知 \(responders.count) 个组件")
+        for responder in responders {
+            responder.memoryPressureDidChange(to: newLevel)
+        }
+    }
+}
@@ -0,0 +1,567 @@
+//
+//  DeviceBezelRasterizer.swift
+//  ScreenPresenter
+//
+//  Created by Sun on 2026/2/12.
+//
+//  设备边框栅格化
+//  按（型号、屏幕宽高比、尺寸档位、缩放）把设备边框绘制为位图并缓存：
+//  静止时由 DeviceBezelView 以单个图层显示，捕获时作为纹理与画面在同一个 Metal pass 中合成，
+//  窗口缩放时只在跨过尺寸档位时重新绘制，其余尺寸由图层/纹理拉伸
+//
+
+import AppKit
+import Metal
+
+// MARK: - 边框布局
+
+/// 设备边框各层的几何布局（坐标系与 DeviceBezelView 一致，原点在左下）
+struct DeviceBezelLayout {
+    // MARK: - 属性
+
+    /// 设备整体区域（金属边框外边界）
+    let deviceRect: CGRect
+
+    /// 屏幕黑色边框区域（金属边框内边界）
+    let metalInnerRect: CGRect
+
+    /// 屏幕区域
+    let screenRect: CGRect
+
+    /// 设备的物理短边（边框宽度与圆角的基准）
+    let physicalShortSide: CGFloat
+
+    /// 金属边框外圆角
+    let metalOuterCornerRadius: CGFloat
+
+    /// 屏幕黑色边框外圆角（= 金属边框内圆角）
+    let screenBezelCornerRadius: CGFloat
+
+    /// 屏幕圆角
+    let screenCornerRadius: CGFloat
+
+    /// 是否为横屏模式（屏幕宽高比 > 1）
+    let isLandscape: Bool
+
+    /// 顶部特征（刘海/灵动岛/摄像头开孔/Home 键）
+    let topFeature: DeviceModel.TopFeature
+
+    // MARK: - 初始化
+
+    /// 计算边框布局
+    /// - Parameters:
+    ///   - model: 设备型号
+    ///   - screenAspectRatio: 屏幕内容区域的宽高比
+    ///   - deviceRect: 设备整体区域（宽高比应为 deviceAspectRatio(model:screenAspectRatio:)）
+    init(model: DeviceModel, screenAspectRatio: CGFloat, deviceRect: CGRect) {
+        self.deviceRect = deviceRect
+        isLandscape = screenAspectRatio > 1.0
+        topFeature = model.topFeature
+
+        // 设备的物理短边（无论横竖屏，物理短边始终是较小的那个）
+        physicalShortSide = min(deviceRect.width, deviceRect.height)
+
+        // 两层边框的宽度（各自独立计算）
+        // 边框宽度基于设备物理短边，确保横竖屏时边框宽度一致
+        let metalFrameWidth = physicalShortSide * model.metalFrameWidthRatio
+        let screenBezelWidth = physicalShortSide * model.screenBezelWidthRatio
+
+        // 圆角从外向内推导，保持同心圆关系，使边框在角落处的视觉宽度与边缘一致
+        metalOuterCornerRadius = physicalShortSide * model.screenCornerRadiusRatio
+        screenBezelCornerRadius = max(0, metalOuterCornerRadius - metalFrameWidth)
+        screenCornerRadius = max(0, screenBezelCornerRadius - screenBezelWidth)
+
+        var metalInnerRect = deviceRect.insetBy(dx: metalFrameWidth, dy: metalFrameWidth)
+        var screenRect = metalInnerRect.insetBy(dx: screenBezelWidth, dy: screenBezelWidth)
+
+        // iPhone SE / Legacy 需要更大的顶部和底部边框
+        let extraBezel = physicalShortSide * Self.extraBezelRatio(model: model, isLandscape: isLandscape)
+        if extraBezel > 0 {
+            metalInnerRect = CGRect(
+                x: metalInnerRect.minX,
+                y: metalInnerRect.minY + extraBezel * 0.4,
+                width: metalInnerRect.width,
+                height: metalInnerRect.height - extraBezel * 0.8
+            )
+            screenRect = CGRect(
+                x: screenRect.minX,
+                y: screenRect.minY + extraBezel,
+                width: screenRect.width,
+                height: screenRect.height - extraBezel * 2
+            )
+        }
+        self.metalInnerRect = metalInnerRect
+        self.screenRect = screenRect
+    }
+
+    // MARK: - 顶部特征
+
+    /// 灵动岛距离屏幕顶部的间距（预留展开空间）
+    /// iPhone 14/15/16/17 Pro: 约 14pt / 393pt ≈ 0.035
+    var islandTopMargin: CGFloat {
+        screenRect.width * 0.035
+    }
+
+    /// 打孔摄像头距离屏幕边缘的间距
+    var punchHoleMargin: CGFloat {
+        screenRect.width * 0.045
+    }
+
+    /// 顶部特征的底部距离屏幕顶部的偏移（向下为正，横屏时不显示顶部特征）
+    var topFeatureBottomInset: CGFloat {
+        guard !isLandscape else { return 0 }
+        switch topFeature {
+        case .none, .homeButton:
+            return 0
+        case let .dynamicIsland(_, heightRatio):
+            return islandTopMargin + screenRect.width * heightRatio
+        case let .notch(_, heightRatio):
+            // 刘海从屏幕顶部开始向下延伸
+            return screenRect.width * heightRatio
+        case let .punchHole(_, sizeRatio):
+            return punchHoleMargin + screenRect.width * sizeRatio
+        }
+    }
+
+    // MARK: - 宽高比
+
+    /// 设备整体的宽高比（包含边框）
+    ///
+    /// 以屏幕内容区域的宽高比为基准反推设备整体尺寸，确保屏幕区域与视频宽高比一致，避免黑边
+    ///
+    /// 数学推导（竖屏）：
+    /// 设 r = screenAspectRatio, b = bezelRatio, e = extraBezelRatio
+    /// 由于 bezelWidth = deviceWidth * b，边框是按设备宽度计算的：
+    ///   screenWidth = deviceWidth * (1 - 2*b)
+    ///   screenHeight = deviceHeight - 2*deviceWidth*(b + e)
+    /// 设 da = deviceWidth/deviceHeight，解出 da = r / [(1 - 2*b) + 2*r*(b + e)]
+    ///
+    /// 横屏时边框宽度基于设备高度（物理短边）：
+    ///   deviceHeight = screenHeight / (1 - 2*b)
+    ///   deviceWidth = screenHeight * r + 2 * b * deviceHeight
+    /// 解出 da = r * (1 - 2*b) + 2*b
+    static func deviceAspectRatio(model: DeviceModel, screenAspectRatio r: CGFloat) -> CGFloat {
+        let isLandscape = r > 1.0
+        let b = model.metalFrameWidthRatio + model.screenBezelWidthRatio
+        if isLandscape {
+            return r * (1 - 2 * b) + 2 * b
+        }
+        let e = extraBezelRatio(model: model, isLandscape: isLandscape)
+        return r / ((1 - 2 * b) + 2 * r * (b + e))
+    }
+
+    /// Home 键机型的额外边框比例（只在竖屏时生效）
+    static func extraBezelRatio(model: DeviceModel, isLandscape: Bool) -> CGFloat {
+        if case .homeButton = model.topFeature, !isLandscape {
+            return 0.10
+        }
+        return 0
+    }
+}
+
+// MARK: - 边框栅格
+
+/// 栅格化后的设备边框
+///
+/// 屏幕区域是透明的，顶部特征（刘海/灵动岛/摄像头开孔）绘制在其中，合成时叠加在画面之上
+final class DeviceBezelRaster {
+    // MARK: - 属性
+
+    /// 边框位图（BGRA 预乘 alpha，原点在左下）
+    let image: CGImage
+
+    /// 栅格在设备区域左右两侧的外扩（相对设备宽度的比例，用于容纳侧边按钮）
+    let horizontalInsetRatio: CGFloat
+
+    /// 已上传的纹理（首次合成时创建，之后复用）
+    private var texture: MTLTexture?
+    private let textureLock = NSLock()
+
+    // MARK: - 初始化
+
+    fileprivate init(image: CGImage, horizontalInsetRatio: CGFloat) {
+        self.image = image
+        self.horizontalInsetRatio = horizontalInsetRatio
+    }
+
+    // MARK: - 公开方法
+
+    /// 栅格在视图中覆盖的区域
+    /// - Parameter deviceRect: 设备整体区域
+    func canvasRect(for deviceRect: CGRect) -> CGRect {
+        let inset = deviceRect.width * horizontalInsetRatio
+        return deviceRect.insetBy(dx: -inset, dy: 0)
+    }
+
+    /// 边框纹理（线程安全，每个栅格只上传一次）
+    func texture(on device: MTLDevice) -> MTLTexture? {
+        textureLock.lock()
+        defer { textureLock.unlock() }
+
+        if let texture, texture.device === device {
+            return texture
+        }
+
+        let descriptor = MTLTextureDescriptor.texture2DDescriptor(
+            pixelFormat: .bgra8Unorm,
+            width: image.width,
+            height: image.height,
+            mipmapped: false
+        )
+        descriptor.usage = .shaderRead
+        guard
+            let data = image.dataProvider?.data,
+            let bytes = CFDataGetBytePtr(data),
+            let newTexture = device.makeTexture(descriptor: descriptor)
+        else {
+            return nil
+        }
+        newTexture.replace(
+            region: MTLRegionMake2D(0, 0, image.width, image.height),
+            mipmapLevel: 0,
+            withBytes: bytes,
+            bytesPerRow: image.bytesPerRow
+        )
+        texture = newTexture
+        return newTexture
+    }
+}
+
+// MARK: - 边框栅格化
+
+/// 设备边框栅格化器
+///
+/// 栅格按设备宽度的像素档位生成（向上取整到 sizeStep），显示时拉伸到实际尺寸，
+/// 窗口连续缩放时只在跨过档位时重新绘制
+///
+/// 线程安全：所有方法都可在任意线程调用
+final class DeviceBezelRasterizer {
+    // MARK: - 单例
+
+    static let shared = DeviceBezelRasterizer()
+
+    // MARK: - 常量
+
+    /// 尺寸档位（像素）
+    static let sizeStep: CGFloat = 32
+
+    /// 缓存的栅格数量上限
+    static let cacheLimit = 16
+
+    // MARK: - 类型定义
+
+    /// 缓存键
+    private struct Key: Hashable {
+        let model: DeviceModel
+        let screenAspectRatio: CGFloat
+        let pixelWidth: Int
+        let scale: CGFloat
+    }
+
+    // MARK: - 属性
+
+    private let lock = NSLock()
+    private var cache: [Key: DeviceBezelRaster] = [:]
+    /// 最近使用顺序（最新的在最后）
+    private var recentKeys: [Key] = []
+
+    // MARK: - 公开方法
+
+    /// 获取边框栅格（缓存未命中时绘制）
+    /// - Parameters:
+    ///   - model: 设备型号
+    ///   - screenAspectRatio: 屏幕内容区域的宽高比
+    ///   - deviceSize: 设备整体尺寸（点）
+    ///   - scale: 屏幕缩放
+    func raster(
+        model: DeviceModel,
+        screenAspectRatio: CGFloat,
+        deviceSize: CGSize,
+        scale: CGFloat
+    ) -> DeviceBezelRaster? {
+        guard deviceSize.width > 0, deviceSize.height > 0, scale > 0 else { return nil }
+
+        let pixelWidth = Int((deviceSize.width * scale / Self.sizeStep).rounded(.up) * Self.sizeStep)
+        let key = Key(model: model, screenAspectRatio: screenAspectRatio, pixelWidth: pixelWidth, scale: scale)
+
+        lock.lock()
+        if let raster = cache[key] {
+            recentKeys.removeAll { $0 == key }
+            recentKeys.append(key)
+            lock.unlock()
+            return raster
+        }
+        lock.unlock()
+
+        guard let raster = draw(key) else { return nil }
+
+        lock.lock()
+        defer { lock.unlock() }
+        cache[key] = raster
+        recentKeys.removeAll { $0 == key }
+        recentKeys.append(key)
+        while recentKeys.count > Self.cacheLimit {
+            cache[recentKeys.removeFirst()] = nil
+        }
+        return raster
+    }
+
+    // MARK: - 绘制
+
+    private func draw(_ key: Key) -> DeviceBezelRaster? {
+        let model = key.model
+        let deviceAspect = DeviceBezelLayout.deviceAspectRatio(model: model, screenAspectRatio: key.screenAspectRatio)
+        let deviceWidth = CGFloat(key.pixelWidth) / key.scale
+        let deviceHeight = deviceWidth / deviceAspect
+
+        // 侧边按钮画在设备区域之外，横屏时不显示
+        let isLandscape = key.screenAspectRatio > 1.0
+        let buttons = model.sideButtons
+        let buttonMargin = isLandscape ? 0 : (buttons.left + buttons.right).map(\.width).max() ?? 0
+
+        let canvasSize = CGSize(width: deviceWidth + buttonMargin * 2, height: deviceHeight)
+        let pixelWidth = Int((canvasSize.width * key.scale).rounded(.up))
+        let pixelHeight = Int((canvasSize.height * key.scale).rounded(.up))
+        guard
+            pixelWidth > 0, pixelHeight > 0,
+            let context = CGContext(
+                data: nil,
+                width: pixelWidth,
+                height: pixelHeight,
+                bitsPerComponent: 8,
+                bytesPerRow: 0,
+                space: CGColorSpace(name: CGColorSpace.sRGB) ?? CGColorSpaceCreateDeviceRGB(),
+                bitmapInfo: CGImageAlphaInfo.premultipliedFirst.rawValue | CGBitmapInfo.byteOrder32Little.rawValue
+            )
+        else {
+            AppLogger.rendering.error("无法创建边框位图: \(pixelWidth)x\(pixelHeight)")
+            return nil
+        }
+        context.scaleBy(x: key.scale, y: key.scale)
+
+        let layout = DeviceBezelLayout(
+            model: model,
+            screenAspectRatio: key.screenAspectRatio,
+            deviceRect: CGRect(x: buttonMargin, y: 0, width: deviceWidth, height: deviceHeight)
+        )
+        drawFrame(layout: layout, model: model, in: context)
+        if !isLandscape {
+            drawSideButtons(layout: layout, model: model, in: context)
+            drawTopFeature(layout: layout, model: model, in: context)
+        }
+
+        guard let image = context.makeImage() else { return nil }
+        AppLogger.rendering.debug("边框栅格化: \(model.displayName) \(pixelWidth)x\(pixelHeight)")
+        return DeviceBezelRaster(image: image, horizontalInsetRatio: buttonMargin / deviceWidth)
+    }
+
+    /// 金属外壳与屏幕黑色边框，屏幕区域保持透明
+    private func drawFrame(layout: DeviceBezelLayout, model: DeviceModel, in context: CGContext) {
+        // 1. 金属外壳边框（最外层）
+        let frameColor = if model.isIOS {
+            // iOS 设备 - 钛金属银灰色（调暗以降低饱和度）
+            NSColor(red: 0.45, green: 0.45, blue: 0.47, alpha: 1.0)
+        } else {
+            // Android 设备 - 深绿色（调暗并降低饱和度）
+            NSColor(red: 0.15, green: 0.40, blue: 0.28, alpha: 1.0)
+        }
+        context.setFillColor(frameColor.cgColor)
+        context.addPath(roundedRectPath(layout.deviceRect, radius: layout.metalOuterCornerRadius))
+        context.fillPath()
+
+        // 2. 屏幕黑色边框（中间层）
+        context.setFillColor(NSColor(red: 0.02, green: 0.02, blue: 0.02, alpha: 1.0).cgColor)
+        context.addPath(roundedRectPath(layout.metalInnerRect, radius: layout.screenBezelCornerRadius))
+        context.fillPath()
+
+        // 3. 屏幕区域挖空（画面在其下方合成，遮罩与着色器中的圆角一致）
+        context.saveGState()
+        context.setBlendMode(.clear)
+        context.addPath(roundedRectPath(layout.screenRect, radius: layout.screenCornerRadius))
+        context.fillPath()
+        context.restoreGState()
+    }
+
+    private func drawSideButtons(layout: DeviceBezelLayout, model: DeviceModel, in context: CGContext) {
+        // 按钮使用与金属边框一致的颜色
+        let buttonColor: NSColor
+        let highlightColor: NSColor
+        if model.isIOS {
+            // iOS 设备：深银灰色（与边框一致）
+            buttonColor = NSColor(red: 0.42, green: 0.42, blue: 0.44, alpha: 1.0)
+            highlightColor = NSColor(white: 0.55, alpha: 0.3)
+        } else {
+            // Android 设备：深绿色（与边框一致，降低饱和度）
+            buttonColor = NSColor(red: 0.12, green: 0.35, blue: 0.24, alpha: 1.0)
+            highlightColor = NSColor(red: 0.20, green: 0.45, blue: 0.32, alpha: 0.3)
+        }
+
+        let deviceRect = layout.deviceRect
+        let buttons = model.sideButtons
+        let specs = buttons.left.map { ($0, true) } + buttons.right.map { ($0, false) }
+        for (spec, isLeft) in specs {
+            let buttonHeight = deviceRect.height * spec.heightRatio
+            let buttonRect = CGRect(
+                x: isLeft ? deviceRect.minX - spec.width : deviceRect.maxX,
+                y: deviceRect.maxY - deviceRect.height * spec.topRatio - buttonHeight,
+                width: spec.width,
+                height: buttonHeight
+            )
+
+            // 静音开关是药丸形状，其余按钮（包括 actionButton）使用小圆角
+            let cornerRadius: CGFloat = spec.type == .silentSwitch ? buttonHeight / 2 : 1.5
+            let path = CGPath(
+                roundedRect: buttonRect,
+                cornerWidth: min(cornerRadius, buttonRect.width / 2),
+                cornerHeight: min(cornerRadius, buttonRect.height / 2),
+                transform: nil
+            )
+            context.setFillColor(buttonColor.cgColor)
+            context.setStrokeColor(highlightColor.cgColor)
+            context.setLineWidth(0.5)
+            context.addPath(path)
+            context.drawPath(using: .fillStroke)
+        }
+    }
+
+    /// 顶部特征（刘海/灵动岛/摄像头开孔/Home 键）
+    private func drawTopFeature(layout: DeviceBezelLayout, model: DeviceModel, in context: CGContext) {
+        let screenRect = layout.screenRect
+
+        switch layout.topFeature {
+        case .none:
+            break
+
+        case let .dynamicIsland(widthRatio, heightRatio):
+            let islandWidth = screenRect.width * widthRatio
+            let islandHeight = screenRect.width * heightRatio
+            let islandRect = CGRect(
+                x: screenRect.midX - islandWidth / 2,
+                y: screenRect.maxY - islandHeight - layout.islandTopMargin,
+                width: islandWidth,
+                height: islandHeight
+            )
+            context.saveGState()
+            context.setShadow(
+                offset: CGSize(width: 0, height: -0.5),
+                blur: 0.5,
+                color: NSColor.white.withAlphaComponent(0.1).cgColor
+            )
+            context.setFillColor(NSColor.black.cgColor)
+            context.addPath(CGPath(
+                roundedRect: islandRect,
+                cornerWidth: islandHeight / 2,
+                cornerHeight: islandHeight / 2,
+                transform: nil
+            ))
+            context.fillPath()
+            context.restoreGState()
+
+        case let .notch(widthRatio, heightRatio):
+            let notchHeight = screenRect.width * heightRatio
+            context.setFillColor(NSColor.black.cgColor)
+            context.addPath(notchPath(
+                centerX: screenRect.midX,
+                topY: screenRect.maxY,
+                width: screenRect.width * widthRatio,
+                height: notchHeight,
+                cornerRadius: notchHeight * 0.45
+            ))
+            context.fillPath()
+
+        case let .punchHole(position, sizeRatio):
+            let holeSize = screenRect.width * sizeRatio
+            let margin = layout.punchHoleMargin
+            let holeX: CGFloat = switch position {
+            case .center:
+                screenRect.midX - holeSize / 2
+            case .topLeft:
+                screenRect.minX + margin
+            case .topRight:
+                screenRect.maxX - margin - holeSize
+            }
+            let holeRect = CGRect(x: holeX, y: screenRect.maxY - margin - holeSize, width: holeSize, height: holeSize)
+            context.setFillColor(NSColor.black.cgColor)
+            context.setStrokeColor(NSColor(white: 0.15, alpha: 1.0).cgColor)
+            context.setLineWidth(0.5)
+            context.addEllipse(in: holeRect)
+            context.drawPath(using: .fillStroke)
+
+        case .homeButton:
+            let deviceWidth = layout.physicalShortSide
+            let buttonSize = deviceWidth * 0.14
+            let buttonRect = CGRect(
+                x: screenRect.midX - buttonSize / 2,
+                y: screenRect.minY - (deviceWidth * 0.10 + buttonSize) / 2 - buttonSize * 0.15,
+                width: buttonSize,
+                height: buttonSize
+            )
+            context.setFillColor(NSColor(white: 0.06, alpha: 1.0).cgColor)
+            context.setStrokeColor(NSColor(white: 0.22, alpha: 1.0).cgColor)
+            context.setLineWidth(1.0)
+            context.addEllipse(in: buttonRect)
+            context.drawPath(using: .fillStroke)
+
+            let innerSize = buttonSize * 0.35
+            let innerRect = CGRect(
+                x: buttonRect.midX - innerSize / 2,
+                y: buttonRect.midY - innerSize / 2,
+                width: innerSize,
+                height: innerSize
+            )
+            context.setStrokeColor(NSColor(white: 0.25, alpha: 1.0).cgColor)
+            context.addPath(CGPath(
+                roundedRect: innerRect,
+                cornerWidth: innerSize * 0.2,
+                cornerHeight: innerSize * 0.2,
+                transform: nil
+            ))
+            context.strokePath()
+        }
+    }
+
+    /// 刘海路径（从屏幕顶部向下延伸，两侧以曲线过渡到屏幕顶边）
+    private func notchPath(
+        centerX: CGFloat,
+        topY: CGFloat,
+        width: CGFloat,
+        height: CGFloat,
+        cornerRadius: CGFloat
+    ) -> CGPath {
+        let path = CGMutablePath()
+
+        let leftX = centerX - width / 2
+        let rightX = centerX + width / 2
+        let bottomY = topY - height
+
+        path.move(to: CGPoint(x: leftX - cornerRadius, y: topY))
+        path.addQuadCurve(
+            to: CGPoint(x: leftX, y: topY - cornerRadius * 0.5),
+            control: CGPoint(x: leftX, y: topY)
+        )
+        path.addLine(to: CGPoint(x: leftX, y: bottomY + cornerRadius))
+        path.addQuadCurve(
+            to: CGPoint(x: leftX + cornerRadius, y: bottomY),
+            control: CGPoint(x: leftX, y: bottomY)
+        )
+        path.addLine(to: CGPoint(x: rightX - cornerRadius, y: bottomY))
+        path.addQuadCurve(
+            to: CGPoint(x: rightX, y: bottomY + cornerRadius),
+            control: CGPoint(x: rightX, y: bottomY)
+        )
+        path.addLine(to: CGPoint(x: rightX, y: topY - cornerRadius * 0.5))
+        path.addQuadCurve(
+            to: CGPoint(x: rightX + cornerRadius, y: topY),
+            control: CGPoint(x: rightX, y: topY)
+        )
+        path.closeSubpath()
+
+        return path
+    }
+
+    /// 圆角矩形路径（圆角不超过短边的一半）
+    private func roundedRectPath(_ rect: CGRect, radius: CGFloat) -> CGPath {
+        let radius = min(radius, rect.width / 2, rect.height / 2)
+        return CGPath(roundedRect: rect, cornerWidth: radius, cornerHeight: radius, transform: nil)
+    }
+}
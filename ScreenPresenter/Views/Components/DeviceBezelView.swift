@@ -28,23 +28,37 @@ final class DeviceBezelView: NSView {
     /// 相对于 screenContentView 的顶部（向下为正），用于 captureBar 定位
     private(set) var topFeatureBottomInset: CGFloat = 0
 
-    // MARK: - UI 组件（使用嵌套 CALayer 实现连续曲率圆角）
-
-    /// 金属外壳边框图层（最外层，使用 continuous 圆角）
-    private let metalFrameLayer = CALayer()
-    /// 屏幕黑色边框图层（中间层，使用 continuous 圆角）
-    private let screenBezelLayer = CALayer()
-    /// 顶部特征层（刘海/灵动岛/摄像头开孔）
-    private var featureLayer: CAShapeLayer?
-    /// Home 按钮层
-    private var homeButtonLayer: CAShapeLayer?
-    /// 侧边按钮层
-    private var sideButtonLayers: [CALayer] = []
+    // MARK: - UI 组件
+
+    /// 屏幕背景图层（边框栅格的屏幕区域是透明的，未显示画面时由它填充黑色）
+    private let screenBackgroundLayer = CALayer()
+    /// 边框图层（显示 DeviceBezelRasterizer 栅格化的边框，包含侧边按钮与顶部特征）
+    private let bezelLayer = CALayer()
 
     private(set) var screenContentView = NSView()
 
-    /// 顶部特征覆盖视图（在 screenContentView 之上，用于显示刘海/灵动岛等）
-    private let featureOverlayView = FeatureOverlayView()
+    // MARK: - 栅格
+
+    /// 当前尺寸的边框栅格
+    private(set) var raster: DeviceBezelRaster?
+
+    /// 边框栅格覆盖的区域（本视图坐标系）
+    private(set) var rasterFrame: CGRect = .zero
+
+    /// 是否隐藏边框图层（画面视图在同一个 Metal pass 中绘制边框时隐藏，减少合成的图层）
+    var isRasterHidden = false {
+        didSet {
+            guard isRasterHidden != oldValue else { return }
+            CATransaction.begin()
+            CATransaction.setDisableActions(true)
+            screenBackgroundLayer.isHidden = isRasterHidden
+            bezelLayer.isHidden = isRasterHidden
+            CATransaction.commit()
+        }
+    }
+
+    /// 布局变化回调（边框栅格或屏幕区域变化后调用）
+    var onLayoutChange: (() -> Void)?
 
     // MARK: - 初始化
 
@@ -110,46 +124,39 @@ final class DeviceBezelView: NSView {
         updateLayersAndSubviews()
     }
 
-    /// 是否为横屏模式（宽高比 > 1）
-    private var isLandscape: Bool {
-        screenAspectRatio > 1.0
-    }
-
     // MARK: - UI 设置
 
     private func setupUI() {
         wantsLayer = true
         layer?.backgroundColor = NSColor.clear.cgColor
 
-        // 使用嵌套的 CALayer 结构实现边框，所有圆角都使用 .continuous
-        // 结构：metalFrameLayer > screenBezelLayer > screenContentView
+        // 边框在栅格化时绘制一次（DeviceBezelRasterizer），这里只负责显示与布局
+        // 结构：screenBackgroundLayer < bezelLayer < 画面视图 < screenContentView
 
-        // 1. 金属外壳边框（最外层）
-        metalFrameLayer.masksToBounds = true
-        metalFrameLayer.cornerCurve = .continuous
-        layer?.addSublayer(metalFrameLayer)
+        // 1. 屏幕背景（屏幕黑色边框的颜色）
+        screenBackgroundLayer.backgroundColor = NSColor(red: 0.02, green: 0.02, blue: 0.02, alpha: 1.0).cgColor
+        layer?.addSublayer(screenBackgroundLayer)
 
-        // 2. 屏幕黑色边框（中间层，嵌套在金属边框内）
-        screenBezelLayer.masksToBounds = true
-        screenBezelLayer.cornerCurve = .continuous
-        metalFrameLayer.addSublayer(screenBezelLayer)
+        // 2. 边框栅格（拉伸到实际尺寸）
+        bezelLayer.contentsGravity = .resize
+        layer?.addSublayer(bezelLayer)
 
-        // 3. 屏幕内容区域（最内层）
+        // 3. 屏幕内容区域（状态视图与捕获信息视图）
         screenContentView.wantsLayer = true
         screenContentView.layer?.backgroundColor = NSColor.clear.cgColor
         screenContentView.layer?.masksToBounds = true
         screenContentView.layer?.cornerCurve = .continuous
         addSubview(screenContentView)
 
-        // 4. 顶部特征覆盖视图（在 screenContentView 之上）
-        // 使用独立的 view 确保顶部特征始终在屏幕内容之上
-        featureOverlayView.wantsLayer = true
-        featureOverlayView.layer?.backgroundColor = NSColor.clear.cgColor
-        addSubview(featureOverlayView)
-
         updateLayers()
     }
 
+    /// 添加画面视图（位于屏幕内容区域之下，铺满本视图，边框由画面视图在同一个 pass 中绘制）
+    func addRenderView(_ view: NSView) {
+        addSubview(view, positioned: .below, relativeTo: screenContentView)
+        view.frame = bounds
+    }
+
     // MARK: - 布局
 
     override func layout() {
@@ -157,6 +164,12 @@ final class DeviceBezelView: NSView {
         updateLayers()
     }
 
+    override func viewDidChangeBackingProperties() {
+        super.viewDidChangeBackingProperties()
+        // 缩放变化后需要重新栅格化
+        needsLayout = true
+    }
+
     private func updateLayers() {
         guard bounds.width > 0, bounds.height > 0 else { return }
 
@@ -165,62 +178,10 @@ final class DeviceBezelView: NSView {
         CATransaction.setDisableActions(true)
         defer { CATransaction.commit() }
 
-        // 核心思路：以屏幕内容区域的宽高比 (screenAspectRatio) 为基准，反推设备整体尺寸
-        // 这样确保 screenRect 的宽高比与视频一致，避免渲染时产生黑边
-        //
-        // 数学推导：
-        // 设 r = screenAspectRatio, b = bezelRatio, e = extraBezelRatio
-        // 由于 bezelWidth = deviceWidth * b，边框是按设备宽度计算的：
-        //   screenWidth = deviceWidth * (1 - 2*b)
-        //   screenHeight = deviceHeight - 2*bezelWidth - 2*extraBezel
-        //                = deviceHeight - 2*deviceWidth*(b + e)
-        // 设 da = deviceWidth/deviceHeight，则：
-        //   r = screenWidth/screenHeight
-        //     = [da * (1 - 2*b)] / [1 - 2*da*(b + e)]
-        // 解出 da：
-        //   da = r / [(1 - 2*b) + 2*r*(b + e)]
-
+        // 以屏幕内容区域的宽高比为基准反推设备整体尺寸，确保屏幕区域与视频宽高比一致
+        let deviceAspect = DeviceBezelLayout.deviceAspectRatio(model: deviceModel, screenAspectRatio: screenAspectRatio)
         let containerAspect = bounds.width / bounds.height
 
-        // 边框相关比例（金属边框 + 屏幕黑边框）
-        let metalFrameRatio = deviceModel.metalFrameWidthRatio
-        let screenBezelRatio = deviceModel.screenBezelWidthRatio
-        let totalBezelRatio = metalFrameRatio + screenBezelRatio
-
-        let hasHomeButton = if case .homeButton = deviceModel.topFeature {
-            true
-        } else {
-            false
-        }
-        // Home 键机型的额外边框只在竖屏时生效
-        let extraBezelRatio: CGFloat = (hasHomeButton && !isLandscape) ? 0.10 : 0
-
-        // 计算设备整体的宽高比
-        // 边框宽度始终基于物理短边（竖屏时为设备宽度，横屏时为设备高度）
-        let deviceAspect: CGFloat
-        let r = screenAspectRatio
-        let b = totalBezelRatio
-        let e = extraBezelRatio
-        
-        if isLandscape {
-            // 横屏：边框宽度基于设备高度（物理短边）
-            // 屏幕宽度 = screenHeight * screenAspectRatio
-            // 设备高度 = screenHeight + 2 * (b * deviceHeight)
-            // 解方程: deviceHeight = screenHeight / (1 - 2*b)
-            // 设备宽度 = screenWidth + 2 * (b * deviceHeight)
-            //         = screenHeight * r + 2 * b * screenHeight / (1 - 2*b)
-            //         = screenHeight * (r + 2*b / (1 - 2*b))
-            //         = screenHeight * (r * (1-2*b) + 2*b) / (1-2*b)
-            // deviceAspect = deviceWidth / deviceHeight
-            //              = (r * (1-2*b) + 2*b) / (1-2*b) / (1 / (1-2*b))
-            //              = r * (1-2*b) + 2*b
-            deviceAspect = r * (1 - 2 * b) + 2 * b
-        } else {
-            // 竖屏：边框宽度基于设备宽度（物理短边）
-            // 原始公式
-            deviceAspect = r / ((1 - 2 * b) + 2 * r * (b + e))
-        }
-
         let deviceWidth: CGFloat
         let deviceHeight: CGFloat
 
@@ -245,103 +206,51 @@ final class DeviceBezelView: NSView {
         // 更新设备整体宽高比（供外部布局使用）
         aspectRatio = deviceAspect
 
-        // 设备的物理短边（无论横竖屏，物理短边始终是较小的那个）
-        let physicalShortSide = min(deviceWidth, deviceHeight)
-
-        // 两层边框的宽度（各自独立计算）
-        // 边框宽度基于设备物理短边，确保横竖屏时边框宽度一致
-        let metalFrameWidth = physicalShortSide * metalFrameRatio
-        let screenBezelWidth = physicalShortSide * screenBezelRatio
-
-        // 圆角计算（从外向内，确保协调的同心圆角关系）：
-        // 方案：基于设备物理短边计算外圆角，然后向内推导
-        // 这样可以确保边框在角落处的视觉宽度与边缘一致
-        
-        // 1. 金属边框外圆角 - 基于设备物理短边
-        let metalOuterCornerRadius = physicalShortSide * deviceModel.screenCornerRadiusRatio
-        
-        // 2. 金属边框内圆角 = 外圆角 - 金属边框宽度（同心圆关系）
-        let metalInnerCornerRadius = max(0, metalOuterCornerRadius - metalFrameWidth)
-        
-        // 3. 屏幕黑边框外圆角 = 金属边框内圆角（两层紧密贴合）
-        let screenBezelOuterCornerRadius = metalInnerCornerRadius
-        
-        // 4. 屏幕圆角（最内层）= 屏幕黑边框外圆角 - 黑边框宽度
-        let screenCornerRadius = max(0, screenBezelOuterCornerRadius - screenBezelWidth)
-
-        // 计算各层区域
-        // 金属边框内边界（也是屏幕黑色边框外边界）
-        var metalInnerRect = deviceRect.insetBy(dx: metalFrameWidth, dy: metalFrameWidth)
-
-        // 屏幕区域（最内层）
-        var screenRect = metalInnerRect.insetBy(dx: screenBezelWidth, dy: screenBezelWidth)
-
-        // iPhone SE / Legacy 需要更大的顶部和底部边框
-        if case .homeButton = deviceModel.topFeature {
-            let extraBezel = physicalShortSide * extraBezelRatio
-            metalInnerRect = CGRect(
-                x: metalInnerRect.minX,
-                y: metalInnerRect.minY + extraBezel * 0.4,
-                width: metalInnerRect.width,
-                height: metalInnerRect.height - extraBezel * 0.8
-            )
-            screenRect = CGRect(
-                x: screenRect.minX,
-                y: screenRect.minY + extraBezel,
-                width: screenRect.width,
-                height: screenRect.height - extraBezel * 2
-            )
-        }
+        let layout = DeviceBezelLayout(model: deviceModel, screenAspectRatio: screenAspectRatio, deviceRect: deviceRect)
+        topFeatureBottomInset = layout.topFeatureBottomInset
 
         // 像素对齐：确保 screenRect 对齐到整像素
         let scale = window?.backingScaleFactor ?? 2.0
-        screenRect = CGRect(
-            x: round(screenRect.minX * scale) / scale,
-            y: round(screenRect.minY * scale) / scale,
-            width: round(screenRect.width * scale) / scale,
-            height: round(screenRect.height * scale) / scale
+        let screenRect = CGRect(
+            x: round(layout.screenRect.minX * scale) / scale,
+            y: round(layout.screenRect.minY * scale) / scale,
+            width: round(layout.screenRect.width * scale) / scale,
+            height: round(layout.screenRect.height * scale) / scale
         )
 
-        // 使用嵌套 CALayer 实现边框（所有圆角都使用 .continuous）
-
-        // 1. 金属外壳边框（最外层）
-        metalFrameLayer.frame = deviceRect
-        metalFrameLayer.cornerRadius = metalOuterCornerRadius
-        if deviceModel.isIOS {
-            // iOS 设备 - 钛金属银灰色（调暗以降低饱和度）
-            metalFrameLayer.backgroundColor = NSColor(red: 0.45, green: 0.45, blue: 0.47, alpha: 1.0).cgColor
-        } else {
-            // Android 设备 - 深绿色（调暗并降低饱和度）
-            metalFrameLayer.backgroundColor = NSColor(red: 0.15, green: 0.40, blue: 0.28, alpha: 1.0).cgColor
-        }
+        // 1. 屏幕背景
+        screenBackgroundLayer.frame = screenRect
+        screenBackgroundLayer.cornerRadius = layout.screenCornerRadius
 
-        // 2. 屏幕黑色边框（中间层）- 相对于 metalFrameLayer 的坐标
-        let screenBezelFrame = CGRect(
-            x: metalFrameWidth,
-            y: metalFrameWidth + (hasHomeButton ? physicalShortSide * extraBezelRatio * 0.4 : 0),
-            width: metalInnerRect.width,
-            height: metalInnerRect.height
+        // 2. 边框栅格（尺寸档位内复用缓存，只更新 frame）
+        raster = DeviceBezelRasterizer.shared.raster(
+            model: deviceModel,
+            screenAspectRatio: screenAspectRatio,
+            deviceSize: deviceRect.size,
+            scale: scale
         )
-        screenBezelLayer.frame = screenBezelFrame
-        screenBezelLayer.cornerRadius = screenBezelOuterCornerRadius
-        screenBezelLayer.backgroundColor = NSColor(red: 0.02, green: 0.02, blue: 0.02, alpha: 1.0).cgColor
+        rasterFrame = raster?.canvasRect(for: deviceRect) ?? .zero
+        bezelLayer.frame = rasterFrame
+        bezelLayer.contentsScale = scale
+        bezelLayer.contents = raster?.image
 
-        // 3. 屏幕内容区域（最内层）- 使用绝对坐标
+        // 3. 屏幕内容区域
         screenContentView.frame = screenRect
-        screenContentView.layer?.cornerRadius = screenCornerRadius
+        screenContentView.layer?.cornerRadius = layout.screenCornerRadius
 
-        // 4. 顶部特征覆盖视图 - 覆盖整个视图区域（与 self 相同坐标系）
-        featureOverlayView.frame = bounds
+        // 画面视图铺满本视图
+        for subview in subviews where subview !== screenContentView {
+            subview.frame = bounds
+        }
 
-        updateTopFeature(screenRect: screenRect, deviceWidth: physicalShortSide)
-        updateSideButtons(deviceRect: deviceRect, deviceWidth: physicalShortSide, deviceHeight: deviceHeight)
+        onLayoutChange?()
     }
 
     /// 更新布局并同步子视图的 frame
-    /// 这确保 screenContentView 的子视图（如 renderView）能跟随 screenContentView 的 bounds 变化
+    /// 这确保 screenContentView 的子视图（如状态视图）能跟随 screenContentView 的 bounds 变化
     private func updateLayersAndSubviews() {
         updateLayers()
-        
+
         // 同步 screenContentView 所有子视图的 frame
         // 子视图应该填满整个 screenContentView
         screenContentView.subviews.forEach { subview in
@@ -349,299 +258,6 @@ final class DeviceBezelView: NSView {
         }
     }
 
-    /// 添加顶部特征 layer（添加到 featureOverlayView 确保在 screenContentView 之上）
-    /// featureOverlayView 是在 screenContentView 之后添加的子视图，
-    /// AppKit 会确保它始终在 screenContentView 之上
-    private func addFeatureLayer(_ layer: CALayer) {
-        featureOverlayView.layer?.addSublayer(layer)
-    }
-
-    private func updateTopFeature(screenRect: CGRect, deviceWidth: CGFloat) {
-        featureLayer?.removeFromSuperlayer()
-        featureLayer = nil
-        homeButtonLayer?.removeFromSuperlayer()
-        homeButtonLayer = nil
-
-        // 重置顶部特征的底部位置
-        topFeatureBottomInset = 0
-
-        // 横屏模式下不显示顶部特征（刘海/灵动岛/摄像头开孔）
-        // 这些特征在物理设备横屏时会移到侧边，但由于复杂性暂不实现
-        if isLandscape {
-            return
-        }
-
-        switch deviceModel.topFeature {
-        case .none:
-            break
-
-        case let .dynamicIsland(widthRatio, heightRatio):
-            let islandWidth = screenRect.width * widthRatio
-            let islandHeight = screenRect.width * heightRatio
-            let islandCornerRadius = islandHeight / 2
-            // 灵动岛距离屏幕顶部的间距（预留展开空间）
-            // iPhone 14/15/16/17 Pro: 约 14pt / 393pt ≈ 0.035，但需要预留展开空间
-            let islandTopMargin = screenRect.width * 0.035
-
-            let islandRect = CGRect(
-                x: screenRect.midX - islandWidth / 2,
-                y: screenRect.maxY - islandHeight - islandTopMargin,
-                width: islandWidth,
-                height: islandHeight
-            )
-
-            // 计算顶部特征底部距离屏幕顶部的偏移
-            topFeatureBottomInset = islandTopMargin + islandHeight
-
-            let layer = CAShapeLayer()
-            layer.fillColor = NSColor.black.cgColor
-            layer.shadowColor = NSColor.white.cgColor
-            layer.shadowOffset = CGSize(width: 0, height: -0.5)
-            layer.shadowRadius = 0.5
-            layer.shadowOpacity = 0.1
-            layer.path = NSBezierPath(
-                roundedRect: islandRect,
-                xRadius: islandCornerRadius,
-                yRadius: islandCornerRadius
-            ).cgPath
-            addFeatureLayer(layer)
-            featureLayer = layer
-
-        case let .notch(widthRatio, heightRatio):
-            let notchWidth = screenRect.width * widthRatio
-            let notchHeight = screenRect.width * heightRatio
-            let notchCornerRadius = notchHeight * 0.45
-
-            // 刘海从屏幕顶部开始向下延伸
-            topFeatureBottomInset = notchHeight
-
-            let notchPath = createNotchPath(
-                centerX: screenRect.midX,
-                topY: screenRect.maxY,
-                width: notchWidth,
-                height: notchHeight,
-                cornerRadius: notchCornerRadius
-            )
-
-            let layer = CAShapeLayer()
-            layer.fillColor = NSColor.black.cgColor
-            layer.path = notchPath
-            addFeatureLayer(layer)
-            featureLayer = layer
-
-        case let .punchHole(position, sizeRatio):
-            let holeSize = screenRect.width * sizeRatio
-            let margin = screenRect.width * 0.045
-
-            // 计算顶部特征底部距离屏幕顶部的偏移
-            topFeatureBottomInset = margin + holeSize
-
-            let holeX: CGFloat = switch position {
-            case .center:
-                screenRect.midX - holeSize / 2
-            case .topLeft:
-                screenRect.minX + margin
-            case .topRight:
-                screenRect.maxX - margin - holeSize
-            }
-
-            let holeRect = CGRect(
-                x: holeX,
-                y: screenRect.maxY - margin - holeSize,
-                width: holeSize,
-                height: holeSize
-            )
-
-            let layer = CAShapeLayer()
-            layer.fillColor = NSColor.black.cgColor
-            layer.strokeColor = NSColor(white: 0.15, alpha: 1.0).cgColor
-            layer.lineWidth = 0.5
-            layer.path = NSBezierPath(ovalIn: holeRect).cgPath
-            addFeatureLayer(layer)
-            featureLayer = layer
-
-        case .homeButton:
-            let buttonSize = deviceWidth * 0.14
-            let buttonY = screenContentView.frame.minY - (deviceWidth * 0.10 + buttonSize) / 2 - buttonSize * 0.15
-
-            let buttonRect = CGRect(
-                x: screenContentView.frame.midX - buttonSize / 2,
-                y: buttonY,
-                width: buttonSize,
-                height: buttonSize
-            )
-
-            let outerLayer = CAShapeLayer()
-            outerLayer.fillColor = NSColor(white: 0.06, alpha: 1.0).cgColor
-            outerLayer.strokeColor = NSColor(white: 0.22, alpha: 1.0).cgColor
-            outerLayer.lineWidth = 1.0
-            outerLayer.path = NSBezierPath(ovalIn: buttonRect).cgPath
-
-            let innerSize = buttonSize * 0.35
-            let innerRect = CGRect(
-                x: buttonRect.midX - innerSize / 2,
-                y: buttonRect.midY - innerSize / 2,
-                width: innerSize,
-                height: innerSize
-            )
-            let innerLayer = CAShapeLayer()
-            innerLayer.fillColor = nil
-            innerLayer.strokeColor = NSColor(white: 0.25, alpha: 1.0).cgColor
-            innerLayer.lineWidth = 1.0
-            innerLayer.path = NSBezierPath(
-                roundedRect: innerRect,
-                xRadius: innerSize * 0.2,
-                yRadius: innerSize * 0.2
-            ).cgPath
-
-            layer?.addSublayer(outerLayer)
-            layer?.addSublayer(innerLayer)
-            homeButtonLayer = outerLayer
-        }
-    }
-
-    private func createNotchPath(
-        centerX: CGFloat,
-        topY: CGFloat,
-        width: CGFloat,
-        height: CGFloat,
-        cornerRadius: CGFloat
-    ) -> CGPath {
-        let path = CGMutablePath()
-
-        let leftX = centerX - width / 2
-        let rightX = centerX + width / 2
-        let bottomY = topY - height
-
-        path.move(to: CGPoint(x: leftX - cornerRadius, y: topY))
-
-        path.addQuadCurve(
-            to: CGPoint(x: leftX, y: topY - cornerRadius * 0.5),
-            control: CGPoint(x: leftX, y: topY)
-        )
-
-        path.addLine(to: CGPoint(x: leftX, y: bottomY + cornerRadius))
-
-        path.addQuadCurve(
-            to: CGPoint(x: leftX + cornerRadius, y: bottomY),
-            control: CGPoint(x: leftX, y: bottomY)
-        )
-
-        path.addLine(to: CGPoint(x: rightX - cornerRadius, y: bottomY))
-
-        path.addQuadCurve(
-            to: CGPoint(x: rightX, y: bottomY + cornerRadius),
-            control: CGPoint(x: rightX, y: bottomY)
-        )
-
-        path.addLine(to: CGPoint(x: rightX, y: topY - cornerRadius * 0.5))
-
-        path.addQuadCurve(
-            to: CGPoint(x: rightX + cornerRadius, y: topY),
-            control: CGPoint(x: rightX, y: topY)
-        )
-
-        path.closeSubpath()
-
-        return path
-    }
-
-    private func updateSideButtons(deviceRect: CGRect, deviceWidth _: CGFloat, deviceHeight: CGFloat) {
-        sideButtonLayers.forEach { $0.removeFromSuperlayer() }
-        sideButtonLayers.removeAll()
-
-        // 横屏模式下不显示侧边按钮
-        // 因为侧边按钮在横屏时的位置会发生变化
-        if isLandscape {
-            return
-        }
-
-        let buttons = deviceModel.sideButtons
-
-        for spec in buttons.left {
-            let buttonLayer = createButtonLayer(
-                spec: spec,
-                deviceRect: deviceRect,
-                deviceHeight: deviceHeight,
-                isLeft: true
-            )
-            layer?.addSublayer(buttonLayer)
-            sideButtonLayers.append(buttonLayer)
-        }
-
-        for spec in buttons.right {
-            let buttonLayer = createButtonLayer(
-                spec: spec,
-                deviceRect: deviceRect,
-                deviceHeight: deviceHeight,
-                isLeft: false
-            )
-            layer?.addSublayer(buttonLayer)
-            sideButtonLayers.append(buttonLayer)
-        }
-    }
-
-    private func createButtonLayer(
-        spec: DeviceModel.SideButtons.ButtonSpec,
-        deviceRect: CGRect,
-        deviceHeight: CGFloat,
-        isLeft: Bool
-    ) -> CALayer {
-        let buttonHeight = deviceHeight * spec.heightRatio
-        let buttonY = deviceRect.maxY - deviceHeight * spec.topRatio - buttonHeight
-
-        let buttonRect = if isLeft {
-            CGRect(
-                x: deviceRect.minX - spec.width,
-                y: buttonY,
-                width: spec.width,
-                height: buttonHeight
-            )
-        } else {
-            CGRect(
-                x: deviceRect.maxX,
-                y: buttonY,
-                width: spec.width,
-                height: buttonHeight
-            )
-        }
-
-        let layer = CAShapeLayer()
-
-        // 圆角半径：
-        // - silentSwitch: 药丸形状（小开关）
-        // - actionButton / volumeUp / volumeDown / power: 统一使用小圆角矩形样式
-        let cornerRadius: CGFloat = switch spec.type {
-        case .silentSwitch:
-            buttonHeight / 2 // 静音开关是药丸形状
-        default:
-            1.5 // 所有其他按钮（包括 actionButton）使用小圆角
-        }
-
-        let path = NSBezierPath(roundedRect: buttonRect, xRadius: cornerRadius, yRadius: cornerRadius)
-        layer.path = path.cgPath
-
-        // 按钮使用与金属边框一致的颜色
-        let buttonColor: NSColor
-        let highlightColor: NSColor
-
-        if deviceModel.isIOS {
-            // iOS 设备：深银灰色（与边框一致）
-            buttonColor = NSColor(red: 0.42, green: 0.42, blue: 0.44, alpha: 1.0)
-            highlightColor = NSColor(white: 0.55, alpha: 0.3)
-        } else {
-            // Android 设备：深绿色（与边框一致，降低饱和度）
-            buttonColor = NSColor(red: 0.12, green: 0.35, blue: 0.24, alpha: 1.0)
-            highlightColor = NSColor(red: 0.20, green: 0.45, blue: 0.32, alpha: 0.3)
-        }
-
-        layer.fillColor = buttonColor.cgColor
-        layer.strokeColor = highlightColor.cgColor
-        layer.lineWidth = 0.5
-
-        return layer
-    }
-
     // MARK: - 屏幕区域
 
     var screenFrame: CGRect {
@@ -654,17 +270,6 @@ final class DeviceBezelView: NSView {
     }
 }
 
-// MARK: - 顶部特征覆盖视图
-
-/// 透明的覆盖视图，用于显示顶部特征（刘海/灵动岛/打孔摄像头）
-/// 重写 hitTest 方法使鼠标事件穿透到下层视图
-private final class FeatureOverlayView: NSView {
-    override func hitTest(_ point: NSPoint) -> NSView? {
-        // 返回 nil 使鼠标事件穿透到下层视图
-        nil
-    }
-}
-
 // MARK: - NSBezierPath CGPath 扩展
 
 extension NSBezierPath {
@@ -25,6 +25,12 @@ final class DeviceCaptureInfoView: NSView {
     private let resolutionLabel = NSTextField(labelWithString: "")
     /// FPS
     private let fpsLabel = NSTextField(labelWithString: "")
+    /// 帧延迟（总延迟百分位、直方图与各阶段耗时）
+    private let latencyLabel = NSTextField(labelWithString: "")
+    /// 启动耗时（最近一次启动的各阶段耗时与历史）
+    private let startupLabel = NSTextField(labelWithString: "")
+    /// 主线程卡顿（次数与最近一次的调用栈位置、帧统计）
+    private let hangLabel = NSTextField(labelWithString: "")
     /// 停止按钮容器
     private let stopButtonContainer = NSView()
     /// 停止按钮图标
@@ -115,6 +121,31 @@ final class DeviceCaptureInfoView: NSView {
         fpsLabel.textColor = .white
         fpsLabel.alignment = .center
         topStatusBar.addSubview(fpsLabel)
+
+        // 帧延迟（FPS 下方，无数据时隐藏）
+        latencyLabel.font = NSFont.monospacedSystemFont(ofSize: 11, weight: .regular)
+        latencyLabel.textColor = NSColor.white.withAlphaComponent(0.8)
+        latencyLabel.alignment = .center
+        latencyLabel.maximumNumberOfLines = 3
+        latencyLabel.isHidden = true
+        contentContainer.addSubview(latencyLabel)
+
+        // 启动耗时（帧延迟下方，无数据时隐藏）
+        startupLabel.font = NSFont.monospacedSystemFont(ofSize: 11, weight: .regular)
+        startupLabel.textColor = NSColor.white.withAlphaComponent(0.8)
+        startupLabel.alignment = .center
+        startupLabel.maximumNumberOfLines = 2
+        startupLabel.isHidden = true
+        contentContainer.addSubview(startupLabel)
+
+        // 主线程卡顿
+        hangLabel.font = NSFont.monospacedSystemFont(ofSize: 11, weight: .regular)
+        hangLabel.textColor = NSColor.systemOrange.withAlphaComponent(0.9)
+        hangLabel.alignment = .center
+        hangLabel.maximumNumberOfLines = 2
+        hangLabel.lineBreakMode = .byTruncatingMiddle
+        hangLabel.isHidden = true
+        contentContainer.addSubview(hangLabel)
     }
 
     private func setupDeviceLabels() {
@@ -265,6 +296,21 @@ final class DeviceCaptureInfoView: NSView {
         let fpsWidth = max(fpsSize.width, 80) // 最小宽度 80
         let topStatusWidth = min(availableWidth, max(200, fpsWidth))
 
+        let latencySize = latencyLabel.isHidden ? CGSize.zero : latencyLabel.intrinsicContentSize
+        let latencyHeight = latencySize.height
+        let latencyWidth = min(availableWidth, latencySize.width)
+        let latencySpacing: CGFloat = latencyLabel.isHidden ? 0 : 8
+
+        let startupSize = startupLabel.isHidden ? CGSize.zero : startupLabel.intrinsicContentSize
+        let startupHeight = startupSize.height
+        let startupWidth = min(availableWidth, startupSize.width)
+        let startupSpacing: CGFloat = startupLabel.isHidden ? 0 : 8
+
+        let hangSize = hangLabel.isHidden ? CGSize.zero : hangLabel.intrinsicContentSize
+        let hangHeight = hangSize.height
+        let hangWidth = min(availableWidth, hangSize.width)
+        let hangSpacing: CGFloat = hangLabel.isHidden ? 0 : 8
+
         let resolutionSize = resolutionLabel.intrinsicContentSize
         let resolutionHeight = max(resolutionSize.height, 20) // 最小高度 20
         let resolutionWidth = max(min(availableWidth, resolutionSize.width), 120) // 最小宽度 120
@@ -290,9 +336,12 @@ final class DeviceCaptureInfoView: NSView {
             44
         }
 
-        let contentWidth = max(topStatusWidth, resolutionWidth, deviceNameWidth, deviceInfoWidth, audioControlWidth, 48)
+        let contentWidth = max(topStatusWidth, latencyWidth, startupWidth, hangWidth, resolutionWidth, deviceNameWidth, deviceInfoWidth, audioControlWidth, 48)
         let audioSpacing: CGFloat = audioControlContainer.isHidden ? 0 : 16
-        let totalHeight = topStatusHeight + 20
+        let totalHeight = topStatusHeight + latencySpacing
+            + latencyHeight + startupSpacing
+            + startupHeight + hangSpacing
+            + hangHeight + 20
             + resolutionHeight + 16
             + deviceNameSize.height + 16
             + deviceInfoSize.height + audioSpacing
@@ -324,6 +373,42 @@ final class DeviceCaptureInfoView: NSView {
             width: fpsWidth,
             height: topStatusHeight
         )
+
+        // 帧延迟
+        if !latencyLabel.isHidden {
+            y -= latencySpacing
+            y -= latencyHeight
+            latencyLabel.frame = CGRect(
+                x: (contentWidth - latencyWidth) / 2,
+                y: y,
+                width: latencyWidth,
+                height: latencyHeight
+            )
+        }
+
+        // 启动耗时
+        if !startupLabel.isHidden {
+            y -= startupSpacing
+            y -= startupHeight
+            startupLabel.frame = CGRect(
+                x: (contentWidth - startupWidth) / 2,
+                y: y,
+                width: startupWidth,
+                height: startupHeight
+            )
+        }
+
+        // 主线程卡顿
+        if !hangLabel.isHidden {
+            y -= hangSpacing
+            y -= hangHeight
+            hangLabel.frame = CGRect(
+                x: (contentWidth - hangWidth) / 2,
+                y: y,
+                width: hangWidth,
+                height: hangHeight
+            )
+        }
         y -= 20
 
         // 分辨率
@@ -465,6 +550,88 @@ final class DeviceCaptureInfoView: NSView {
         }
     }
 
+    /// 更新帧延迟
+    /// - Parameter snapshot: 延迟统计快照，nil 或无已呈现帧时隐藏
+    func updateLatency(_ snapshot: FrameLatencySnapshot?) {
+        guard let snapshot, snapshot.presentedCount > 0 else {
+            if !latencyLabel.isHidden {
+                latencyLabel.isHidden = true
+                needsLayout = true
+            }
+            return
+        }
+
+        let total = snapshot.total
+        let summary = String(
+            format: "延迟 p50 %.0f · p95 %.0f · max %.0f ms",
+            total.percentile(0.5),
+            total.percentile(0.95),
+            total.maximum
+        )
+
+        // 总延迟直方图：每个字符对应一个 2 的幂毫秒区间（<1ms … ≥256ms）
+        let levels: [Character] = ["▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"]
+        let peak = max(total.buckets.max() ?? 0, 1)
+        let histogram = String(total.buckets.map { count -> Character in
+            count == 0 ? " " : levels[min(levels.count - 1, count * levels.count / (peak + 1))]
+        })
+
+        let stages = snapshot.stages
+            .map { String(format: "%@ %.1f", $0.stage.name, $0.histogram.average) }
+            .joined(separator: " ")
+
+        let text = "\(summary)\n<1 \(histogram) 256+\n\(stages)"
+        if latencyLabel.stringValue != text || latencyLabel.isHidden {
+            latencyLabel.stringValue = text
+            latencyLabel.isHidden = false
+            needsLayout = true
+        }
+    }
+
+    /// 更新启动耗时
+    /// - Parameter history: 当前设备已完成的启动时间线（最新的在最后），为空时隐藏
+    func updateStartup(_ history: [DeviceStartupTimeline]) {
+        guard let latest = history.last else {
+            if !startupLabel.isHidden {
+                startupLabel.isHidden = true
+                needsLayout = true
+            }
+            return
+        }
+
+        // 第二行：最近几次启动的总耗时，便于判断本次是否异常
+        let recent = history.suffix(5)
+            .compactMap(\.captureDuration)
+            .map { String(format: "%.0f", $0 * 1000) }
+            .joined(separator: " ")
+        let text = "\(latest.summary)\n最近 \(recent) ms"
+        if startupLabel.stringValue != text || startupLabel.isHidden {
+            startupLabel.stringValue = text
+            startupLabel.isHidden = false
+            needsLayout = true
+        }
+    }
+
+    /// 更新主线程卡顿
+    /// - Parameter reports: 卡顿报告（最新的在最后），为空时隐藏
+    func updateHangs(_ reports: [MainThreadHangReport]) {
+        guard let latest = reports.last else {
+            if !hangLabel.isHidden {
+                hangLabel.isHidden = true
+                needsLayout = true
+            }
+            return
+        }
+
+        let longest = reports.map(\.duration).max() ?? 0
+        let text = String(format: "主线程卡顿 %d 次 · 最长 %.0f ms\n", reports.count, longest * 1000) + latest.summary
+        if hangLabel.stringValue != text || hangLabel.isHidden {
+            hangLabel.stringValue = text
+            hangLabel.isHidden = false
+            needsLayout = true
+        }
+    }
+
     // MARK: - 显示/隐藏控制
 
     /// 显示视图（带淡入动画）
@@ -46,7 +46,7 @@ final class DevicePanelView: NSView {
     /// 设备边框视图
     private let bezelView = DeviceBezelView()
 
-    /// Metal 渲染视图（显示设备画面，嵌入到 screenContentView 中）
+    /// Metal 渲染视图（显示设备画面，捕获时在同一个 pass 中绘制设备边框）
     private(set) var renderView = SingleDeviceRenderView()
 
     /// 状态视图（显示在边框屏幕区域内）
@@ -143,8 +143,11 @@ final class DevicePanelView: NSView {
     private func setupBezelView() {
         addSubview(bezelView)
 
-        // 添加 Metal 渲染视图到 screenContentView（画面会跟随 bezel 动画）
-        bezelView.screenContentView.addSubview(renderView)
+        // 添加 Metal 渲染视图到 bezelView（位于 screenContentView 之下，画面会跟随 bezel 动画）
+        bezelView.addRenderView(renderView)
+        bezelView.onLayoutChange = { [weak self] in
+            self?.updateBezelComposition()
+        }
 
         // 设置默认的色彩滤镜
         renderView.colorFilter = ColorProfileManager.shared.filter(for: currentPlatform)
@@ -326,7 +329,7 @@ final class DevicePanelView: NSView {
         configureBezel(for: platform, deviceName: nil)
 
         // 隐藏渲染视图，显示状态容器
-        renderView.isHidden = true
+        setRenderViewVisible(false)
         statusView.isHidden = false
         captureInfoView.isHidden = true
 
@@ -419,7 +422,7 @@ final class DevicePanelView: NSView {
         // 如果是从捕获状态切换过来，保留当前 bezel 的 aspectRatio，不重新配置
 
         // 隐藏渲染视图，显示状态容器
-        renderView.isHidden = true
+        setRenderViewVisible(false)
         statusView.isHidden = false
         captureInfoView.isHidden = true
 
@@ -559,7 +562,7 @@ final class DevicePanelView: NSView {
         }
 
         // 显示渲染视图，隐藏状态容器
-        renderView.isHidden = false
+        setRenderViewVisible(true)
         statusView.isHidden = true
 
         // 更新捕获状态文本：显示设备型号和名称
@@ -641,7 +644,7 @@ final class DevicePanelView: NSView {
         }
 
         // 显示渲染视图，隐藏状态容器
-        renderView.isHidden = false
+        setRenderViewVisible(true)
         statusView.isHidden = true
 
         // 更新捕获状态文本：显示设备型号和名称
@@ -673,7 +676,7 @@ final class DevicePanelView: NSView {
         configureBezel(for: platform, deviceName: nil)
 
         // 隐藏渲染视图，显示状态容器
-        renderView.isHidden = true
+        setRenderViewVisible(false)
         statusView.isHidden = false
         captureInfoView.isHidden = true
 
@@ -694,7 +697,7 @@ final class DevicePanelView: NSView {
         configureBezel(for: .android, deviceName: nil)
 
         // 隐藏渲染视图，显示状态容器
-        renderView.isHidden = true
+        setRenderViewVisible(false)
         statusView.isHidden = false
         captureInfoView.isHidden = true
 
@@ -705,6 +708,11 @@ final class DevicePanelView: NSView {
         )
     }
 
+    /// 设置已连接状态的预览图（最近一次投屏画面的缩略图，nil 时不显示）
+    func setStatusPreview(_ image: CGImage?) {
+        statusView.setPreviewImage(image)
+    }
+
     // MARK: - 按钮控制
 
     /// 设置操作按钮的启用状态
@@ -718,6 +726,24 @@ final class DevicePanelView: NSView {
         captureInfoView.updateFPS(fps)
     }
 
+    /// 更新帧延迟统计
+    func updateLatency(_ snapshot: FrameLatencySnapshot?) {
+        guard currentState == .capturing else { return }
+        captureInfoView.updateLatency(snapshot)
+    }
+
+    /// 更新启动耗时
+    func updateStartup(_ history: [DeviceStartupTimeline]) {
+        guard currentState == .capturing else { return }
+        captureInfoView.updateStartup(history)
+    }
+
+    /// 更新主线程卡顿报告
+    func updateHangs(_ reports: [MainThreadHangReport]) {
+        guard currentState == .capturing else { return }
+        captureInfoView.updateHangs(reports)
+    }
+
     /// 更新捕获分辨率（在捕获过程中分辨率变化时调用）
     /// 只更新 bezel 的 aspectRatio 和分辨率标签，避免重新配置整个 UI
     func updateCaptureResolution(_ resolution: CGSize) {
@@ -790,7 +816,7 @@ final class DevicePanelView: NSView {
             bezelView.isHidden = false
 
             renderView.removeFromSuperview()
-            bezelView.screenContentView.addSubview(renderView)
+            bezelView.addRenderView(renderView)
 
             statusView.removeFromSuperview()
             bezelView.screenContentView.addSubview(statusView)
@@ -819,9 +845,34 @@ final class DevicePanelView: NSView {
     private func updateContentFrames() {
         let containerView: NSView = showBezel ? bezelView.screenContentView : self
         let targetFrame = containerView.bounds
-        renderView.frame = targetFrame
+        renderView.frame = showBezel ? bezelView.bounds : bounds
         statusView.frame = targetFrame
         captureInfoView.frame = targetFrame
+        updateBezelComposition()
+    }
+
+    /// 显示/隐藏画面视图
+    private func setRenderViewVisible(_ visible: Bool) {
+        renderView.isHidden = !visible
+        updateBezelComposition()
+    }
+
+    /// 同步设备边框的合成方式
+    /// 画面可见时边框由 renderView 与画面在同一个 Metal pass 中绘制，隐藏 bezelView 自己的边框图层；
+    /// 否则由 bezelView 以图层显示
+    private func updateBezelComposition() {
+        if showBezel, !renderView.isHidden, let raster = bezelView.raster {
+            renderView.bezel = SingleDeviceRenderView.BezelComposition(
+                raster: raster,
+                rasterFrame: bezelView.rasterFrame,
+                screenFrame: bezelView.screenFrame,
+                screenCornerRadius: bezelView.screenCornerRadius
+            )
+            bezelView.isRasterHidden = true
+        } else {
+            renderView.bezel = nil
+            bezelView.isRasterHidden = false
+        }
     }
 
     override func layout() {
@@ -909,6 +960,9 @@ final class DevicePanelView: NSView {
         fpsUpdateTimer = Timer.scheduledTimer(withTimeInterval: 0.5, repeats: true) { [weak self] _ in
             guard let self else { return }
             updateFPS(renderView.fps)
+            updateLatency(renderView.latencyTracer?.snapshot())
+            updateStartup(renderView.startupDeviceID.map { DeviceStartupProfiler.shared.history(deviceID: $0) } ?? [])
+            updateHangs(MainThreadWatchdog.shared.reports)
         }
     }
 
@@ -30,6 +30,8 @@ final class DeviceStatusView: NSView {
 
     // MARK: - UI 组件
 
+    /// 预览图（最近一次投屏画面的缩略图，暗化后作为背景）
+    private let previewImageView = NSImageView()
     /// 内容居中容器
     private let contentContainer = NSView()
     /// 加载指示器（菊花）
@@ -88,6 +90,7 @@ final class DeviceStatusView: NSView {
         wantsLayer = true
         layer?.backgroundColor = NSColor(white: 0.05, alpha: 1.0).cgColor
 
+        setupPreviewImageView()
         setupContentContainer()
         setupLoadingIndicator()
         setupTitleLabel()
@@ -98,6 +101,13 @@ final class DeviceStatusView: NSView {
         setupStatusGesture()
     }
 
+    private func setupPreviewImageView() {
+        previewImageView.imageScaling = .scaleProportionallyUpOrDown
+        previewImageView.alphaValue = 0.2
+        previewImageView.isHidden = true
+        addSubview(previewImageView)
+    }
+
     private func setupContentContainer() {
         addSubview(contentContainer)
     }
@@ -197,6 +207,7 @@ final class DeviceStatusView: NSView {
 
     /// 显示加载状态
     func showLoading(title: String) {
+        setPreviewImage(nil)
         loadingIndicator.isHidden = false
         loadingIndicator.startAnimation(nil)
 
@@ -213,6 +224,7 @@ final class DeviceStatusView: NSView {
 
     /// 显示断开状态
     func showDisconnected(title: String, subtitle: String) {
+        setPreviewImage(nil)
         loadingIndicator.stopAnimation(nil)
         loadingIndicator.isHidden = true
 
@@ -271,6 +283,7 @@ final class DeviceStatusView: NSView {
 
     /// 显示工具链缺失状态
     func showToolchainMissing(toolName: String, hint: String) {
+        setPreviewImage(nil)
         loadingIndicator.stopAnimation(nil)
         loadingIndicator.isHidden = true
 
@@ -296,6 +309,17 @@ final class DeviceStatusView: NSView {
         needsLayout = true
     }
 
+    /// 设置预览图（nil 时隐藏）
+    func setPreviewImage(_ image: CGImage?) {
+        if let image {
+            previewImageView.image = NSImage(cgImage: image, size: NSSize(width: image.width, height: image.height))
+            previewImageView.isHidden = false
+        } else {
+            previewImageView.image = nil
+            previewImageView.isHidden = true
+        }
+    }
+
     /// 设置操作按钮的启用状态
     func setActionButtonEnabled(_ enabled: Bool) {
         actionButton.isEnabled = enabled
@@ -414,6 +438,8 @@ final class DeviceStatusView: NSView {
     }
 
     private func layoutContent() {
+        previewImageView.frame = bounds.insetBy(dx: 20, dy: 20)
+
         let availableWidth = max(0, bounds.width - 40)
         updateFontsForWidth(availableWidth)
 
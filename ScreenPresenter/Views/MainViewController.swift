@@ -291,6 +291,22 @@ final class MainViewController: NSViewController {
         // 注意：纹理更新由数据源的帧回调驱动，而不是渲染请求
         // 这在 updateIOSPanel/updateAndroidPanel 中设置
 
+        // 捕获策略：主窗口不可见时暂停渲染
+        CapturePowerCoordinator.shared.$policy
+            .map(\.rendersPaused)
+            .removeDuplicates()
+            .dropFirst()
+            .receive(on: DispatchQueue.main)
+            .sink { [weak self] rendersPaused in
+                if rendersPaused {
+                    self?.stopRendering()
+                } else {
+                    self?.startRendering()
+                    self?.refreshLatestFrames()
+                }
+            }
+            .store(in: &cancellables)
+
         // 监听背景色变化
         NotificationCenter.default.addObserver(
             self,
@@ -345,6 +361,13 @@ final class MainViewController: NSViewController {
         androidPanelView.renderView.stopRendering()
     }
 
+    /// 恢复渲染后立即显示最新帧（画面静止时短时间内不会有新帧到来）
+    private func refreshLatestFrames() {
+        if let pixelBuffer = AppState.shared.androidDeviceSource?.latestPixelBuffer {
+            androidPanelView.renderView.updateTexture(from: pixelBuffer)
+        }
+    }
+
     // MARK: - UI 更新
 
     /// 记录上次的 aspectRatio，用于检测变化
@@ -391,6 +414,11 @@ final class MainViewController: NSViewController {
             appState.androidDeviceSource?.onFrame = { [weak panel] pixelBuffer in
                 panel?.renderView.updateTexture(from: pixelBuffer)
             }
+            panel.renderView.latencyTracer = appState.androidDeviceSource?.latencyTracer
+            panel.renderView.startupDeviceID = appState.androidDeviceSource?.startupDeviceID
+            appState.androidDeviceSource?.displaySizeProvider = { [weak panel] in
+                panel?.renderView.drawablePixelSize ?? .zero
+            }
 
             panel.showCapturing(
                 deviceName: appState.androidDeviceName ?? "Android",
@@ -408,6 +436,9 @@ final class MainViewController: NSViewController {
         } else if appState.androidConnected {
             // 清除帧回调
             appState.androidDeviceSource?.onFrame = nil
+            appState.androidDeviceSource?.displaySizeProvider = nil
+            panel.renderView.latencyTracer = nil
+            panel.renderView.startupDeviceID = nil
             // 检查设备是否已授权（state == .device）
             let isDeviceReady = appState.androidDeviceReady
             let userPrompt = appState.androidDeviceUserPrompt
@@ -436,10 +467,14 @@ final class MainViewController: NSViewController {
                 panel.setActionButtonEnabled(false)
             }
 
+            // 停止投屏后用最后的画面缩略图作为背景
+            panel.setStatusPreview(appState.androidDeviceSource?.thumbnailTap?.latestThumbnail?.makeCGImage())
+
             panel.renderView.clearTexture()
         } else {
             panel.showDisconnected(platform: .android, connectionGuide: L10n.overlayUI.connectAndroid)
             panel.renderView.clearTexture()
+            panel.renderView.startupDeviceID = nil
         }
     }
 
@@ -457,6 +492,7 @@ final class MainViewController: NSViewController {
             appState.iosDeviceSource?.onFrame = { [weak panel] pixelBuffer in
                 panel?.renderView.updateTexture(from: pixelBuffer)
             }
+            panel.renderView.startupDeviceID = appState.iosDeviceSource?.startupDeviceID
 
             // 使用 IOSDevice 的 productType 精确识别设备型号
             panel.showCapturing(
@@ -470,6 +506,7 @@ final class MainViewController: NSViewController {
         } else if let device = appState.currentIOSDevice {
             // 清除帧回调
             appState.iosDeviceSource?.onFrame = nil
+            panel.renderView.startupDeviceID = nil
 
             // 获取设备详细信息
             // 使用 IOSDevice 的 productType 精确识别设备型号
@@ -482,10 +519,13 @@ final class MainViewController: NSViewController {
                     self?.refreshIOSDeviceInfo(completion: completion)
                 }
             )
+            // 停止投屏后用最后的画面缩略图作为背景
+            panel.setStatusPreview(appState.iosDeviceSource?.thumbnailTap?.latestThumbnail?.makeCGImage())
             panel.renderView.clearTexture()
         } else {
             panel.showDisconnected(platform: .ios, connectionGuide: L10n.overlayUI.connectIOS)
             panel.renderView.clearTexture()
+            panel.renderView.startupDeviceID = nil
         }
     }
 
@@ -8,6 +8,11 @@
 
 import AppKit
 
+// 回放基准测试模式：重放录制的 scrcpy 码流后退出，不启动界面
+if let options = ScrcpyReplayBenchmark.Options(arguments: CommandLine.arguments) {
+    ScrcpyReplayBenchmark.runAndExit(options)
+}
+
 // 创建应用实例
 let app = NSApplication.shared
 
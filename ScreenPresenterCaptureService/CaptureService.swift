@@ -0,0 +1,182 @@
+//
+//  CaptureService.swift
+//  ScreenPresenterCaptureService
+//
+//  Created by Sun on 2026/2/12.
+//
+//  捕获服务
+//  每个应用连接对应一个 CaptureService：转发 FBDeviceControlBridge 的设备变化，管理该连接打开的捕获会话
+//  连接断开（应用退出或崩溃）时关闭所有会话、停止观察设备
+//
+
+import FBDeviceControlKit
+import Foundation
+import IOSurface
+import os.lock
+
+// MARK: - 监听代理
+
+final class CaptureServiceListenerDelegate: NSObject, NSXPCListenerDelegate {
+    func listener(_: NSXPCListener, shouldAcceptNewConnection connection: NSXPCConnection) -> Bool {
+        let service = CaptureService(connection: connection)
+        connection.exportedInterface = CaptureServiceInterfaces.makeServiceInterface()
+        connection.exportedObject = service
+        connection.remoteObjectInterface = CaptureServiceInterfaces.makeClientInterface()
+        connection.invalidationHandler = { [weak service] in
+            service?.invalidate()
+        }
+        connection.resume()
+        AppLogger.app.info("[捕获服务] 已接受应用连接，pid: \(connection.processIdentifier)")
+        return true
+    }
+}
+
+// MARK: - 捕获服务
+
+final class CaptureService: NSObject, CaptureServiceProtocol {
+    // MARK: - 属性
+
+    private weak var connection: NSXPCConnection?
+
+    /// 已打开的捕获会话
+    private let sessions = OSAllocatedUnfairLock(initialState: [String: CaptureServiceSession]())
+
+    /// 应用端代理（单向消息，不等待回复）
+    private var client: CaptureServiceClientProtocol? {
+        connection?.remoteObjectProxyWithErrorHandler { error in
+            AppLogger.app.error("[捕获服务] 回调应用失败: \(error.localizedDescription)")
+        } as? CaptureServiceClientProtocol
+    }
+
+    // MARK: - 初始化
+
+    init(connection: NSXPCConnection) {
+        self.connection = connection
+        super.init()
+    }
+
+    /// 连接断开时调用
+    func invalidate() {
+        let closed = sessions.withLock { sessions in
+            defer { sessions.removeAll() }
+            return Array(sessions.values)
+        }
+        closed.forEach { $0.invalidate() }
+        FBDeviceControlBridge.shared.stopObserving()
+        AppLogger.app.info("[捕获服务] 应用连接已断开，关闭 \(closed.count) 个捕获会话")
+    }
+
+    // MARK: - 设备发现
+
+    func waitUntilReady(reply: @escaping (Bool, String?) -> Void) {
+        let bridge = FBDeviceControlBridge.shared
+        bridge.whenReady { available in
+            reply(available, bridge.initializationError)
+        }
+    }
+
+    func startObservingDevices(reply: @escaping ([[AnyHashable: Any]], [String: Double]) -> Void) {
+        let bridge = FBDeviceControlBridge.shared
+        bridge.whenReady { [weak self] _ in
+            let devices = bridge.listDevices()
+            reply(devices, Self.attachTimes(of: devices))
+
+            // 桥接层的首次差量把当前设备再报告为新增，应用端按已知设备合并
+            bridge.startObservingChanges { added, removed, updated in
+                self?.client?.devicesDidChange(
+                    added: added,
+                    removed: removed,
+                    updated: updated,
+                    attachTimes: Self.attachTimes(of: added)
+                )
+            }
+        }
+    }
+
+    func stopObservingDevices() {
+        FBDeviceControlBridge.shared.stopObserving()
+    }
+
+    func refreshDevices(reply: @escaping ([[AnyHashable: Any]]) -> Void) {
+        let bridge = FBDeviceControlBridge.shared
+        bridge.whenReady { _ in
+            reply(bridge.refresh())
+        }
+    }
+
+    /// 设备的接入时间（CACurrentMediaTime 时基，跨进程可比）
+    private static func attachTimes(of devices: [[AnyHashable: Any]]) -> [String: Double] {
+        var attachTimes: [String: Double] = [:]
+        for device in devices {
+            guard let udid = device[kFBDeviceInfoUDID] as? String else { continue }
+            let attachTime = FBDeviceControlBridge.shared.attachTime(forUDID: udid)
+            if attachTime > 0 {
+                attachTimes[udid] = attachTime
+            }
+        }
+        return attachTimes
+    }
+
+    // MARK: - 捕获
+
+    func openCapture(
+        captureID: String,
+        avUniqueID: String,
+        framesPerSecond: Int,
+        audioEnabled: Bool,
+        audioVolume: Float,
+        reply: @escaping (FileHandle?, Error?) -> Void
+    ) {
+        do {
+            let session = try CaptureServiceSession(
+                captureID: captureID,
+                avUniqueID: avUniqueID,
+                framesPerSecond: framesPerSecond,
+                audioEnabled: audioEnabled,
+                audioVolume: audioVolume
+            ) { [weak self] surface, sequence in
+                self?.client?.didPublishFrame(surface, captureID: captureID, sequence: sequence)
+            }
+            let replaced = sessions.withLock { $0.updateValue(session, forKey: captureID) }
+            replaced?.invalidate()
+            reply(session.timingRing.fileHandle, nil)
+        } catch {
+            reply(nil, error)
+        }
+    }
+
+    func startCapture(captureID: String, reply: @escaping (Error?) -> Void) {
+        guard let session = session(for: captureID) else {
+            reply(CaptureServiceErrorCode.captureNotFound.error(captureID))
+            return
+        }
+        session.start {
+            reply(nil)
+        }
+    }
+
+    func stopCapture(captureID: String, reply: @escaping () -> Void) {
+        guard let session = session(for: captureID) else {
+            reply()
+            return
+        }
+        session.stop(completion: reply)
+    }
+
+    func closeCapture(captureID: String) {
+        let session = sessions.withLock { $0.removeValue(forKey: captureID) }
+        session?.invalidate()
+    }
+
+    func setFrameRateLimit(_ framesPerSecond: Int, captureID: String) {
+        session(for: captureID)?.limitFramesPerSecond(framesPerSecond > 0 ? framesPerSecond : nil)
+    }
+
+    func setAudio(enabled: Bool, volume: Float, captureID: String) {
+        session(for: captureID)?.setAudio(enabled: enabled, volume: volume)
+    }
+
+    private func session(for captureID: String) -> CaptureServiceSession? {
+        sessions.withLock { $0[captureID] }
+    }
+}
@@ -0,0 +1,270 @@
+//
+//  CaptureServiceSession.swift
+//  ScreenPresenterCaptureService
+//
+//  Created by Sun on 2026/2/12.
+//
+//  服务进程中的 iOS 捕获会话
+//  会话配置与应用内的 IOSDeviceSource 一致（FBDeviceVideo 创建会话，FBDeviceVideoStream 分发画面），
+//  画面不转换也不复制，直接把像素缓冲背后的 IOSurface 发布给应用
+//
+
+@preconcurrency import AVFoundation
+import CoreMedia
+import CoreVideo
+import FBDeviceControlKit
+import Foundation
+import os.lock
+
+// MARK: - 捕获会话
+
+final class CaptureServiceSession: @unchecked Sendable {
+    // MARK: - 属性
+
+    /// 应用分配的捕获 ID
+    let captureID: String
+
+    /// 帧时间环
+    let timingRing: CaptureFrameTimingRing
+
+    private let session: AVCaptureSession
+    private let videoStream: FBDeviceVideoStream
+    private var frameConsumer: (any FBVideoSurfaceConsumerProtocol & FBDataConsumerLifecycle)?
+    private let captureQueue = DispatchQueue(label: "com.screenPresenter.captureService.capture", qos: .userInteractive)
+    private let audioQueue = DispatchQueue(label: "com.screenPresenter.captureService.audio", qos: .userInteractive)
+
+    /// 发布画面（在捕获队列调用）
+    private let publish: (IOSurface, UInt64) -> Void
+
+    /// 音频输出代理
+    private var audioDelegate: AudioCaptureDelegate?
+
+    /// 音频播放器
+    private var audioPlayer: AudioPlayer?
+
+    /// 音频开关与是否正在捕获
+    private struct State {
+        var isCapturing = false
+        var audioEnabled = false
+    }
+
+    private let state = OSAllocatedUnfairLock(initialState: State())
+
+    /// 帧序号，只在捕获队列访问
+    private var sequence: UInt64 = 0
+
+    /// 各槽位对应的像素缓冲，只在捕获队列访问
+    /// 槽位被复用前一直持有，保证 IOSurface 在应用包装为像素缓冲之前不会被缓冲池回收
+    private var slotBuffers = [CVPixelBuffer?](repeating: nil, count: CaptureFrameTimingRing.slotCount)
+
+    // MARK: - 初始化
+
+    init(
+        captureID: String,
+        avUniqueID: String,
+        framesPerSecond: Int,
+        audioEnabled: Bool,
+        audioVolume: Float,
+        publish: @escaping (IOSurface, UInt64) -> Void
+    ) throws {
+        if !IOSScreenMirrorActivator.shared.isDALEnabled {
+            IOSScreenMirrorActivator.shared.enableDALDevices()
+        }
+
+        guard let captureDevice = AVCaptureDevice(uniqueID: avUniqueID) else {
+            AppLogger.capture.error("[捕获服务] 无法获取捕获设备: \(avUniqueID)")
+            throw CaptureServiceErrorCode.deviceNotFound.error(avUniqueID)
+        }
+
+        // 检测设备是否被其他应用占用（如 QuickTime）
+        if captureDevice.isInUseByAnotherApplication {
+            AppLogger.capture.warning("[捕获服务] 设备被其他应用占用: \(captureDevice.localizedName)")
+            throw CaptureServiceErrorCode.deviceInUse.error(captureDevice.localizedName)
+        }
+
+        do {
+            session = try FBDeviceVideo.captureSession(for: captureDevice)
+        } catch {
+            // "无法使用 XXX" 通常是因为 iPhone 未解锁或未信任（AVCaptureDeviceInput 的原始错误）
+            let underlyingError = (error as NSError).userInfo[NSUnderlyingErrorKey] as? Error ?? error
+            let errorMessage = underlyingError.localizedDescription
+            AppLogger.capture.error("[捕获服务] 创建视频输入失败: \(errorMessage)")
+            if errorMessage.contains("无法使用") || errorMessage.contains("Cannot use") {
+                throw CaptureServiceErrorCode.deviceNotReady.error(errorMessage)
+            }
+            throw CaptureServiceErrorCode.inputFailed.error(errorMessage)
+        }
+
+        guard let timingRing = CaptureFrameTimingRing.create() else {
+            throw CaptureServiceErrorCode.timingRingUnavailable.error("无法创建帧时间环")
+        }
+
+        videoStream = try Self.makeVideoStream(session: session, framesPerSecond: framesPerSecond)
+        self.captureID = captureID
+        self.timingRing = timingRing
+        self.publish = publish
+        state.withLock { $0.audioEnabled = audioEnabled }
+
+        frameConsumer = FBVideoSurfaceConsumer.consumer(on: captureQueue) { [weak self] pixelBuffer, presentationTime in
+            self?.handleVideoPixelBuffer(pixelBuffer, presentationTime: presentationTime)
+        }
+        setupAudioCapture(videoDevice: captureDevice, volume: audioVolume, enabled: audioEnabled)
+
+        AppLogger.capture.info("[捕获服务] 捕获会话已配置: \(captureDevice.localizedName)")
+    }
+
+    /// 创建视频流，优先使用 420v，设备不支持时回退为 BGRA（两者都由 IOSurface 承载）
+    private static func makeVideoStream(session: AVCaptureSession, framesPerSecond: Int) throws -> FBDeviceVideoStream {
+        let baseConfiguration = FBVideoStreamConfiguration(
+            encoding: .BGRA,
+            framesPerSecond: NSNumber(value: framesPerSecond),
+            compressionQuality: nil,
+            scaleFactor: nil,
+            avgBitrate: nil,
+            keyFrameRate: nil
+        )
+        let logger = FBControlCoreGlobalConfiguration.defaultLogger
+
+        var lastError: Error?
+        for pixelFormat in [FBVideoStreamPixelFormat.format420VideoRange, .BGRA] {
+            do {
+                let configuration = baseConfiguration.withPixelFormat(pixelFormat, maxDimension: nil)
+                return try FBDeviceVideoStream(session: session, configuration: configuration, logger: logger)
+            } catch {
+                AppLogger.capture.warning("[捕获服务] 视频流不支持像素格式 \(pixelFormat.rawValue): \(error.localizedDescription)")
+                lastError = error
+            }
+        }
+        throw CaptureServiceErrorCode.cannotAddOutput.error(lastError?.localizedDescription ?? "")
+    }
+
+    // MARK: - 控制
+
+    /// 启动捕获（在捕获队列上启动会话，完成后回调）
+    func start(completion: @escaping () -> Void) {
+        state.withLock { $0.isCapturing = true }
+        captureQueue.async { [self] in
+            if let frameConsumer {
+                videoStream.attachConsumer(frameConsumer, policy: .dropOldest, maxPendingFrames: 1)
+            }
+            if !session.isRunning {
+                session.startRunning()
+            }
+            completion()
+        }
+    }
+
+    /// 停止捕获（会话保留）
+    func stop(completion: @escaping () -> Void) {
+        state.withLock { $0.isCapturing = false }
+        let frameConsumer = frameConsumer
+        captureQueue.async { [self] in
+            if let frameConsumer {
+                videoStream.detachConsumer(frameConsumer)
+            }
+            session.stopRunning()
+            slotBuffers = slotBuffers.map { _ in nil }
+            completion()
+        }
+    }
+
+    /// 关闭捕获并释放会话
+    func invalidate() {
+        stop {}
+        audioPlayer?.stop()
+        audioPlayer = nil
+        audioDelegate = nil
+        frameConsumer = nil
+    }
+
+    /// 设置帧率上限（nil 表示按偏好设置帧率）
+    func limitFramesPerSecond(_ framesPerSecond: Int?) {
+        videoStream.limitFramesPerSecond(framesPerSecond.map { NSNumber(value: $0) })
+    }
+
+    /// 设置音频播放
+    func setAudio(enabled: Bool, volume: Float) {
+        state.withLock { $0.audioEnabled = enabled }
+        audioPlayer?.isMuted = !enabled
+        audioPlayer?.volume = volume
+    }
+
+    // MARK: - 画面发布
+
+    private func handleVideoPixelBuffer(_ pixelBuffer: CVPixelBuffer, presentationTime: CMTime) {
+        guard state.withLock({ $0.isCapturing }) else { return }
+        guard let surface = CVPixelBufferGetIOSurface(pixelBuffer)?.takeUnretainedValue() else {
+            AppLogger.capture.error("[捕获服务] 像素缓冲没有 IOSurface，无法跨进程共享")
+            return
+        }
+
+        // 应用来不及消费时丢帧（如主线程卡顿），保证被复用的槽位里的画面已经被应用接管
+        guard timingRing.pendingFrameCount < UInt64(CaptureFrameTimingRing.slotCount - 1) else {
+            timingRing.recordDroppedFrame()
+            return
+        }
+
+        sequence += 1
+        slotBuffers[Int(sequence % UInt64(CaptureFrameTimingRing.slotCount))] = pixelBuffer
+        timingRing.publish(CaptureFrameTiming(sequence: sequence, presentationTime: presentationTime))
+        publish(surface, sequence)
+    }
+
+    // MARK: - 音频
+
+    /// 设置音频捕获（iOS 设备通过 CoreMediaIO 暴露时通常是 muxed 类型，音频与视频共享同一个输入）
+    /// 音频在服务进程中直接播放，与画面一样不受应用卡顿影响
+    private func setupAudioCapture(videoDevice: AVCaptureDevice, volume: Float, enabled: Bool) {
+        guard videoDevice.hasMediaType(.muxed) || videoDevice.hasMediaType(.audio) else {
+            AppLogger.capture.info("[捕获服务] 设备不支持音频捕获")
+            return
+        }
+
+        let audioOutput = AVCaptureAudioDataOutput()
+        let audioDelegate = AudioCaptureDelegate { [weak self] sampleBuffer in
+            self?.handleAudioSampleBuffer(sampleBuffer)
+        }
+        audioOutput.setSampleBufferDelegate(audioDelegate, queue: audioQueue)
+
+        guard session.canAddOutput(audioOutput) else {
+            AppLogger.capture.warning("[捕获服务] 无法添加音频输出到会话")
+            return
+        }
+
+        session.addOutput(audioOutput)
+        self.audioDelegate = audioDelegate
+
+        let audioPlayer = AudioPlayer()
+        audioPlayer.volume = volume
+        audioPlayer.isMuted = !enabled
+        self.audioPlayer = audioPlayer
+    }
+
+    private func handleAudioSampleBuffer(_ sampleBuffer: CMSampleBuffer) {
+        let shouldPlay = state.withLock { $0.isCapturing && $0.audioEnabled }
+        guard shouldPlay else { return }
+
+        autoreleasepool {
+            audioPlayer?.processSampleBuffer(sampleBuffer)
+        }
+    }
+}
+
+// MARK: - 音频捕获代理
+
+private final class AudioCaptureDelegate: NSObject, AVCaptureAudioDataOutputSampleBufferDelegate {
+    private let handler: (CMSampleBuffer) -> Void
+
+    init(handler: @escaping (CMSampleBuffer) -> Void) {
+        self.handler = handler
+        super.init()
+    }
+
+    func captureOutput(
+        _: AVCaptureOutput,
+        didOutput sampleBuffer: CMSampleBuffer,
+        from _: AVCaptureConnection
+    ) {
+        handler(sampleBuffer)
+    }
+}
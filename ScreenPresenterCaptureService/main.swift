@@ -0,0 +1,21 @@
+//
+//  main.swift
+//  ScreenPresenterCaptureService
+//
+//  Created by Sun on 2026/2/12.
+//
+//  捕获服务入口点
+//  承载 FBDeviceSet 与 iOS 捕获会话，应用卡顿或服务崩溃都不会互相拖垮
+//
+
+import Foundation
+
+let delegate = CaptureServiceListenerDelegate()
+let listener = NSXPCListener.service()
+listener.delegate = delegate
+
+// 服务进程的日志缓存同样在内存压力下裁剪
+MemoryPressureCoordinator.shared.start()
+
+// 不会返回，之后由 Info.plist 中的 RunLoopType 运行主线程 RunLoop（FBDeviceSet 的设备通知在主线程交付）
+listener.resume()